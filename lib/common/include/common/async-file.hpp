@@ -0,0 +1,179 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+
+namespace file
+{
+	///
+	/// @brief File content read by `AsyncReader`, aligned for direct I/O
+	///
+	class Buffer
+	{
+	  public:
+
+		[[nodiscard]]
+		std::span<const std::byte> span() const noexcept
+		{
+			return {storage.get() + offset, size};
+		}
+
+	  private:
+
+		struct Deleter
+		{
+			void operator()(std::byte* ptr) const noexcept;
+		};
+
+		std::unique_ptr<std::byte[], Deleter> storage;
+		size_t offset = 0;  // Start of the content, non-zero when the read is widened for direct I/O
+		size_t size = 0;
+
+		friend class AsyncReader;
+
+		explicit Buffer(size_t capacity);
+
+	  public:
+
+		Buffer(const Buffer&) = delete;
+		Buffer(Buffer&&) = default;
+		Buffer& operator=(const Buffer&) = delete;
+		Buffer& operator=(Buffer&&) = default;
+	};
+
+	///
+	/// @brief Asynchronous file reader, reads are awaited from coroutines
+	/// @details Each read is split into chunks, at most @p Option::queue_depth chunks of all reads are in
+	/// flight at once. The backend is selected at compile time:
+	/// - Windows: overlapped I/O completed through an I/O completion port
+	/// - Linux with `COMMON_IO_URING`: io_uring
+	/// - Otherwise: blocking `pread` on a small pool of I/O threads
+	///
+	/// @note Coroutines resume on an I/O thread, hop back to a worker pool before heavy processing
+	///
+	class AsyncReader
+	{
+	  public:
+
+		enum class Hint : uint8_t
+		{
+			Sequential,  // Whole-file or streaming reads, reads ahead and may use direct I/O
+			Random,      // Small reads at scattered offsets, disables read-ahead
+		};
+
+		struct Option
+		{
+			size_t queue_depth = 64;                         // Chunks in flight across all reads
+			size_t chunk_size = 1024 * 1024;                 // Size of each chunk, rounded to the alignment
+			size_t direct_io_threshold = 64 * 1024 * 1024;  // Sequential reads at least this large bypass
+			                                                 // the page cache, 0 to disable
+		};
+
+		using Result = std::expected<Buffer, Error>;
+
+	  private:
+
+		struct Request;
+		struct Chunk;
+		class Backend;
+
+		std::unique_ptr<Backend> backend;
+
+		explicit AsyncReader(std::unique_ptr<Backend> backend) noexcept;
+
+	  public:
+
+		///
+		/// @brief Awaitable of a read, see @p read and @p read_range
+		///
+		class ReadAwaitable
+		{
+		  public:
+
+			bool await_ready() const noexcept { return false; }
+
+			// Returns `false` to resume immediately if the read fails or completes before submission
+			bool await_suspend(std::coroutine_handle<> handle) noexcept;
+
+			Result await_resume() noexcept;
+
+		  private:
+
+			Backend& backend;
+			std::unique_ptr<Request> request;
+
+			explicit ReadAwaitable(Backend& backend, std::unique_ptr<Request> request) noexcept;
+
+			friend AsyncReader;
+
+		  public:
+
+			~ReadAwaitable() noexcept;
+
+			ReadAwaitable(const ReadAwaitable&) = delete;
+			ReadAwaitable(ReadAwaitable&&) noexcept;
+			ReadAwaitable& operator=(const ReadAwaitable&) = delete;
+			ReadAwaitable& operator=(ReadAwaitable&&) = delete;
+		};
+
+		///
+		/// @brief Create an asynchronous reader, starting its I/O threads
+		///
+		/// @param option Reader options
+		/// @return Created reader, or error if the backend fails to initialize
+		///
+		[[nodiscard]]
+		static std::expected<AsyncReader, Error> create(const Option& option) noexcept;
+
+		///
+		/// @brief Read a whole file, e.g. `auto result = co_await reader.read(path);`
+		///
+		/// @param path Path to the file
+		/// @param hint Access pattern hint
+		/// @param size_limit Maximum file size, larger files fail to read
+		/// @return Awaitable resulting in the file content
+		///
+		[[nodiscard]]
+		ReadAwaitable read(
+			std::filesystem::path path,
+			Hint hint = Hint::Sequential,
+			size_t size_limit = 1024 * 1024 * 1024
+		) noexcept;
+
+		///
+		/// @brief Read a range of a file
+		///
+		/// @param path Path to the file
+		/// @param offset Offset of the range in bytes
+		/// @param size Size of the range in bytes, the range must lie within the file
+		/// @param hint Access pattern hint
+		/// @return Awaitable resulting in the content of the range
+		///
+		[[nodiscard]]
+		ReadAwaitable read_range(
+			std::filesystem::path path,
+			size_t offset,
+			size_t size,
+			Hint hint = Hint::Random
+		) noexcept;
+
+		///
+		/// @brief Stop the I/O threads
+		/// @note All reads must have completed
+		///
+		~AsyncReader() noexcept;
+
+		AsyncReader(const AsyncReader&) = delete;
+		AsyncReader(AsyncReader&&) noexcept;
+		AsyncReader& operator=(const AsyncReader&) = delete;
+		AsyncReader& operator=(AsyncReader&&) noexcept;
+	};
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace util
+{
+	///
+	/// @brief Memory resource for the large, short-lived buffers of model and image import
+	/// @details
+	/// - Requests of at least `large_threshold` bytes get blocks of whole 2 MiB huge pages, cutting the page
+	/// faults and TLB misses of multi-GB loads. Explicit huge pages are tried first, falling back to
+	/// transparent huge pages on Linux, and to regular pages elsewhere.
+	/// - Freed blocks are kept and handed out again to requests fitting them, up to `max_cached` bytes.
+	/// Their pages are already faulted in, and are never cleared.
+	/// - Smaller requests are forwarded to the upstream resource
+	///
+	/// Thread-safe, can be shared by the tasks of a thread pool. Pair with `UninitializedAllocator` to also
+	/// skip the value-initialization of containers.
+	///
+	class ImportArena : public std::pmr::memory_resource
+	{
+	  public:
+
+		static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+		///
+		/// @brief Statistics of an import arena
+		///
+		struct Stat
+		{
+			size_t mapped_bytes;     // Bytes of the mapped blocks, in use or cached
+			size_t huge_page_bytes;  // Part of `mapped_bytes` on explicit huge pages, THP is not counted
+			size_t cached_bytes;     // Bytes of the freed blocks kept for reuse
+		};
+
+		///
+		/// @brief Create an import arena
+		///
+		/// @param large_threshold Requests of at least this many bytes get huge page blocks
+		/// @param max_cached Maximum bytes of freed blocks kept for reuse
+		/// @param upstream Resource of smaller requests
+		///
+		explicit ImportArena(
+			size_t large_threshold = HUGE_PAGE_SIZE / 2,
+			size_t max_cached = 512 * 1024 * 1024,
+			std::pmr::memory_resource& upstream = *std::pmr::new_delete_resource()
+		) noexcept :
+			upstream(&upstream),
+			large_threshold(large_threshold),
+			max_cached(max_cached)
+		{}
+
+		~ImportArena() noexcept override;
+
+		///
+		/// @brief Release the cached blocks to the OS
+		///
+		void trim() noexcept;
+
+		///
+		/// @brief Get the statistics of the arena
+		///
+		/// @return Statistics
+		///
+		[[nodiscard]]
+		Stat stat() const noexcept;
+
+	  private:
+
+		struct Block
+		{
+			void* pointer;
+			size_t size;  // Multiple of `HUGE_PAGE_SIZE`
+			bool huge;    // Mapped on explicit huge pages
+		};
+
+		std::pmr::memory_resource* upstream;
+		size_t large_threshold;
+		size_t max_cached;
+
+		mutable std::mutex mutex;
+		std::unordered_map<void*, Block> live_blocks;
+		std::vector<Block> cached_blocks;
+		Stat block_stat = {.mapped_bytes = 0, .huge_page_bytes = 0, .cached_bytes = 0};
+
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+
+		[[nodiscard]]
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+		void release_block(const Block& block) noexcept;
+
+	  public:
+
+		ImportArena(const ImportArena&) = delete;
+		ImportArena(ImportArena&&) = delete;
+		ImportArena& operator=(const ImportArena&) = delete;
+		ImportArena& operator=(ImportArena&&) = delete;
+	};
+
+	///
+	/// @brief Polymorphic allocator default-initializing instead of value-initializing
+	/// @details `resize(n)` and `vector(n)` then leave trivial elements uninitialized, for buffers that are
+	/// overwritten right after. Construction with arguments is unchanged.
+	///
+	/// @tparam T Element type
+	///
+	template <typename T>
+	class UninitializedAllocator : public std::pmr::polymorphic_allocator<T>
+	{
+	  public:
+
+		using std::pmr::polymorphic_allocator<T>::polymorphic_allocator;
+
+		template <typename U>
+		struct rebind
+		{
+			using other = UninitializedAllocator<U>;
+		};
+
+		template <typename U>
+		void construct(U* pointer) noexcept(std::is_nothrow_default_constructible_v<U>)
+		{
+			::new (static_cast<void*>(pointer)) U;
+		}
+
+		template <typename U, typename... Args>
+		void construct(U* pointer, Args&&... args)
+		{
+			std::pmr::polymorphic_allocator<T>::construct(pointer, std::forward<Args>(args)...);
+		}
+
+		// Copies of a container use the default resource, as with `std::pmr::polymorphic_allocator`
+		[[nodiscard]]
+		UninitializedAllocator select_on_container_copy_construction() const noexcept
+		{
+			return {};
+		}
+	};
+
+	///
+	/// @brief Vector of scratch data, see `UninitializedAllocator`
+	///
+	template <typename T>
+	using ScratchVector = std::vector<T, UninitializedAllocator<T>>;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace util::cpu
+{
+	///
+	/// @brief Type of a logical core, in hybrid designs (e.g. Intel P/E-cores, ARM big.LITTLE)
+	///
+	enum class CoreType
+	{
+		Performance,
+		Efficiency
+	};
+
+	///
+	/// @brief Logical core the process is allowed to run on
+	///
+	struct LogicalCore
+	{
+		uint32_t index;  // Index of the logical core, as used by the OS affinity API
+		CoreType type;
+	};
+
+	///
+	/// @brief Query the logical cores the process is allowed to run on
+	/// @details
+	/// - Linux: the affinity mask of the process. Efficiency cores are the `cpu_atom` PMU's cores on Intel
+	/// hybrid CPUs, or the cores below the highest `cpu_capacity` on ARM.
+	/// - Windows: the cores of the first processor group, efficiency cores are the ones below the highest
+	/// `EfficiencyClass`
+	/// - Elsewhere, or if the query fails: `std::thread::hardware_concurrency()` performance cores
+	///
+	/// @return Logical cores sorted by index, never empty
+	///
+	[[nodiscard]]
+	std::vector<LogicalCore> query_cores() noexcept;
+
+	///
+	/// @brief Parse a Linux CPU list, e.g. `0-7,16-23`
+	///
+	/// @param list CPU list, trailing whitespace is ignored
+	/// @return Sorted indices of the listed cores, or `std::nullopt` if malformed
+	///
+	[[nodiscard]]
+	std::optional<std::vector<uint32_t>> parse_cpu_list(std::string_view list) noexcept;
+
+	///
+	/// @brief Restrict the calling thread to a set of logical cores
+	///
+	/// @param cores Indices of the logical cores, see `LogicalCore::index`
+	/// @return `void` if success, or error if unsupported on the platform or rejected by the OS
+	///
+	[[nodiscard]]
+	std::expected<void, Error> set_thread_affinity(std::span<const uint32_t> cores) noexcept;
+
+	///
+	/// @brief Cores the workers of a thread pool may run on
+	///
+	enum class Affinity
+	{
+		Any,         // Left to the OS scheduler, only excluding the reserved core
+		Performance  // Performance cores only, so that long tasks don't straggle on efficiency cores
+	};
+
+	///
+	/// @brief Sizing and affinity of a thread pool
+	///
+	struct PoolConfig
+	{
+		std::optional<uint32_t> worker_count = std::nullopt;  // Defaults to the count of worker cores
+		Affinity affinity = Affinity::Performance;
+
+		// Keep a performance core for the render/submit thread, not shared with the workers
+		bool reserve_render_core = false;
+	};
+
+	///
+	/// @brief Cores planned for a thread pool and the render thread
+	///
+	struct PoolLayout
+	{
+		uint32_t worker_count;
+		std::vector<uint32_t> worker_cores;  // Affinity of every worker, empty to leave them unpinned
+		std::optional<uint32_t> render_core;  // Core reserved for the render thread, if any
+	};
+
+	///
+	/// @brief Plan the layout of a thread pool
+	/// @details
+	/// - The render core is the last performance core, not reserved if it would leave no core to the
+	/// workers
+	/// - Workers are pinned to the cores matching @p config's affinity, except the render core. Without
+	/// any matching core, they fall back to all the cores but the render core.
+	/// - Workers are unpinned if that set contains all the cores
+	///
+	/// @param cores Logical cores, see `query_cores`
+	/// @param config Config of the pool
+	/// @return Layout of the pool, with at least one worker
+	///
+	[[nodiscard]]
+	PoolLayout plan_pool(std::span<const LogicalCore> cores, const PoolConfig& config) noexcept;
+}
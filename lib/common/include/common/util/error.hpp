@@ -48,6 +48,14 @@
 ///   > Note: for custom type support, specialize `Error::from::operator<T>()`
 ///   > By default, types supported by `std::to_string`, and `vk::Result` are supported.
 ///
+/// - Return a preallocated error on hot paths, costing no heap allocation:
+///   ```cpp
+///   static const Error::Interned INVALID_STATE("Present failed", "Swapchain is not in a valid state");
+///   return Error(INVALID_STATE);
+///   ```
+///   > Note: `Error::from(vk::Result)` interns its record per call site and result code, so firing repeatedly
+///   > only formats the detail once.
+///
 /// #### Visiting
 ///
 /// Visit detailed information through `->` operator:
@@ -156,6 +164,8 @@ class Error
 {
   public:
 
+	class Interned;
+
 	///
 	/// @brief Information block for an error
 	///
@@ -172,6 +182,7 @@ class Error
 	  private:
 
 		friend class Error;
+		friend class Interned;
 
 		std::shared_ptr<const Record> cause;  // Chain to next error information block
 
@@ -227,6 +238,13 @@ class Error
 		std::source_location location = std::source_location::current()
 	) noexcept;
 
+	///
+	/// @brief Create an error from a preallocated record, without heap allocation or reference counting
+	///
+	/// @param interned Preallocated error, must outlive the created error and all errors forwarded from it
+	///
+	explicit Error(const Interned& interned) noexcept;
+
 	Error(const Error&) = default;
 	Error(Error&&) = default;
 	Error& operator=(const Error&) = default;
@@ -464,6 +482,38 @@ class Error
 	Json to_json() const noexcept;
 };
 
+///
+/// @brief Preallocated error for hot paths, see `Error(const Interned&)`
+/// @details Declare with static storage duration. The message, detail and location (where the `Interned` is
+/// declared) are allocated once, every error created from it shares the same record.
+///
+class Error::Interned
+{
+	std::shared_ptr<const Record> storage;
+
+	friend class Error;
+
+  public:
+
+	///
+	/// @brief Create a preallocated error
+	///
+	/// @param message Brief message describing the error
+	/// @param detail Optional detailed message
+	/// @param location Source location where the error is declared (default: current location)
+	///
+	explicit Interned(
+		std::string message,
+		std::optional<std::string> detail = std::nullopt,
+		std::source_location location = std::source_location::current()
+	) noexcept;
+
+	Interned(const Interned&) = delete;
+	Interned(Interned&&) = delete;
+	Interned& operator=(const Interned&) = delete;
+	Interned& operator=(Interned&&) = delete;
+};
+
 class Error::Iterator
 {
 	std::optional<Error> current;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common/util/span.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace util
+{
+	///
+	/// @brief Hash a byte span into a 64-bit value
+	/// @details Non-cryptographic, word-at-a-time hash intended for content fingerprints (e.g. cache
+	/// invalidation). The result is stable across runs and platforms with the same endianness.
+	///
+	/// @param data Bytes to hash
+	/// @param seed Initial value, use the result of a previous call to chain multiple spans
+	/// @return 64-bit hash value
+	///
+	[[nodiscard]]
+	uint64_t hash_bytes(std::span<const std::byte> data, uint64_t seed = 0) noexcept;
+
+	///
+	/// @brief Hash the object representation of a trivially copyable object
+	/// @warning Padding bytes are hashed as well, value-initialize objects with padding before hashing
+	///
+	/// @param object Object to hash
+	/// @param seed Initial value, see `hash_bytes`
+	/// @return 64-bit hash value
+	///
+	template <typename T>
+		requires(std::is_trivially_copyable_v<T>)
+	[[nodiscard]]
+	uint64_t hash_object(const T& object, uint64_t seed = 0) noexcept
+	{
+		return hash_bytes(object_as_bytes(object), seed);
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace util
+{
+	///
+	/// @brief Lock-free multi-producer single-consumer queue
+	/// @details Producers push onto an intrusive stack with a CAS loop, and the consumer takes the whole
+	/// stack at once with a single exchange, so producers never block each other nor the consumer. Taking
+	/// all items at once also rules out the ABA problem of popping nodes one by one.
+	///
+	/// @note @p push is thread-safe, @p take_all must be called by a single consumer at a time
+	///
+	/// @tparam T Type of the item
+	///
+	template <typename T>
+	class MpscQueue
+	{
+	  public:
+
+		MpscQueue() = default;
+
+		~MpscQueue() noexcept { destroy(head.exchange(nullptr, std::memory_order_acquire)); }
+
+		///
+		/// @brief Push an item
+		/// @note Thread-safe
+		///
+		/// @param item Item to push
+		///
+		void push(T item)
+		{
+			auto* const node = new Node{
+				.item = std::move(item),
+				.next = head.load(std::memory_order_relaxed),
+			};
+			while (!head.compare_exchange_weak(
+				node->next,
+				node,
+				std::memory_order_release,
+				std::memory_order_relaxed
+			));
+		}
+
+		///
+		/// @brief Take all pushed items
+		/// @note Items pushed by the same producer keep their order, items of different producers are ordered
+		/// by their completed pushes
+		///
+		/// @return Items in push order
+		///
+		[[nodiscard]]
+		std::vector<T> take_all()
+		{
+			auto* node = head.exchange(nullptr, std::memory_order_acquire);
+
+			std::vector<T> items;
+			for (auto* it = node; it != nullptr; it = it->next) items.push_back(std::move(it->item));
+			destroy(node);
+
+			std::ranges::reverse(items);
+			return items;
+		}
+
+		///
+		/// @brief Check if the queue is empty
+		/// @note The result may be outdated immediately in presence of producers
+		///
+		/// @return `true` if no item is pushed
+		///
+		[[nodiscard]]
+		bool empty() const noexcept
+		{
+			return head.load(std::memory_order_relaxed) == nullptr;
+		}
+
+	  private:
+
+		struct Node
+		{
+			T item;
+			Node* next;
+		};
+
+		std::atomic<Node*> head = nullptr;  // Most recently pushed node
+
+		static void destroy(Node* node) noexcept
+		{
+			while (node != nullptr) delete std::exchange(node, node->next);
+		}
+
+	  public:
+
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue(MpscQueue&&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+		MpscQueue& operator=(MpscQueue&&) = delete;
+	};
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Live profiling with Tracy, enabled by the "tracy" build option. Without it, all macros expand to nothing
+// (or to the plain declaration for `PROFILE_LOCKABLE`), so they can stay in hot paths of release builds.
+//
+// - `PROFILE_FRAME()`: marks the end of a frame
+// - `PROFILE_ZONE(name)`: CPU zone until the end of the enclosing scope, `name` must be a string literal
+// - `PROFILE_ALLOC(ptr, size, pool)`/`PROFILE_FREE(ptr, pool)`: tracks a memory allocation in a named pool,
+//   `pool` must be a string with static storage, compared by address
+// - `PROFILE_LOCKABLE(type, name, description)`: declares a mutex `name` of `type`, whose contention shows
+//   up in the profiler. Works with the standard lock types, but not with `std::condition_variable`
+
+#ifdef TRACY_ENABLE
+
+#include <tracy/Tracy.hpp>  // IWYU pragma: export
+
+#define PROFILE_FRAME() FrameMark
+#define PROFILE_ZONE(name) ZoneScopedN(name)
+#define PROFILE_ALLOC(ptr, size, pool) TracyAllocN(ptr, size, pool)
+#define PROFILE_FREE(ptr, pool) TracyFreeN(ptr, pool)
+#define PROFILE_LOCKABLE(type, name, description) TracyLockableN(type, name, description)
+
+#else
+
+#define PROFILE_FRAME()
+#define PROFILE_ZONE(name)
+#define PROFILE_ALLOC(ptr, size, pool)
+#define PROFILE_FREE(ptr, pool)
+#define PROFILE_LOCKABLE(type, name, description) type name
+
+#endif
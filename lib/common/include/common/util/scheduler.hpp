@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace util
+{
+	///
+	/// @brief Work-stealing job scheduler with priority lanes
+	/// @details Each worker owns a deque per lane, popping its own jobs LIFO while idle workers steal FIFO
+	/// from the others. Jobs submitted from outside the workers go to a shared injection queue. Workers
+	/// always take the most urgent lane available, and background jobs occupy all but one worker at most, so
+	/// that frame-critical jobs never queue behind long bakes.
+	///
+	/// @note Jobs are not preempted, split long work with @p parallel_for or by awaiting @p schedule
+	///
+	class Scheduler
+	{
+	  public:
+
+		enum class Priority : uint8_t
+		{
+			Frame,       // Latency-critical work of the current frame
+			Streaming,   // Streaming of textures and geometry, needed within a few frames
+			Background,  // Long-running work, e.g. baking and texture compression
+		};
+
+		static constexpr size_t PRIORITY_COUNT = 3;
+
+		// Jobs must not throw
+		using Job = std::move_only_function<void()>;
+
+		///
+		/// @brief Awaitable resuming the awaiting coroutine on a worker, see @p schedule
+		///
+		class ScheduleAwaitable
+		{
+		  public:
+
+			bool await_ready() const noexcept { return false; }
+
+			void await_suspend(std::coroutine_handle<> handle)
+			{
+				scheduler.submit(priority, [handle] { handle.resume(); });
+			}
+
+			void await_resume() const noexcept {}
+
+		  private:
+
+			Scheduler& scheduler;
+			Priority priority;
+
+			explicit ScheduleAwaitable(Scheduler& scheduler, Priority priority) noexcept :
+				scheduler(scheduler),
+				priority(priority)
+			{}
+
+			friend Scheduler;
+		};
+
+		///
+		/// @brief Start a scheduler
+		///
+		/// @param worker_count Number of worker threads, clamped to at least 1
+		///
+		explicit Scheduler(size_t worker_count = std::thread::hardware_concurrency());
+
+		///
+		/// @brief Run all remaining jobs, then join the workers
+		/// @note Jobs must not submit new jobs once destruction begins
+		///
+		~Scheduler() noexcept;
+
+		///
+		/// @brief Submit a job
+		/// @note Thread-safe. Jobs submitted from a worker go to its own deque, and are likely to run on the
+		/// same worker with a warm cache
+		///
+		/// @param priority Lane of the job
+		/// @param job Job to run
+		///
+		void submit(Priority priority, Job job);
+
+		///
+		/// @brief Resume the awaiting coroutine on a worker, e.g. `co_await scheduler.schedule(priority)`
+		/// @details Independent of the promise type, so that it composes with `coro::task` coroutines
+		///
+		/// @param priority Lane of the resumption
+		/// @return Awaitable
+		///
+		[[nodiscard]]
+		ScheduleAwaitable schedule(Priority priority) noexcept
+		{
+			return ScheduleAwaitable(*this, priority);
+		}
+
+		///
+		/// @brief Run a function over each element of a range in parallel, blocking until all are done
+		/// @details The range is split into chunks of @p grain elements. The calling thread runs chunks too,
+		/// so this neither deadlocks when called from a worker nor waits for busy workers to pick up chunks.
+		///
+		/// @param priority Lane of the chunks run by workers
+		/// @param range Range to iterate, must outlive the call
+		/// @param func Function called with each element, concurrently from multiple threads
+		/// @param grain Elements per chunk, clamped to at least 1
+		///
+		template <std::ranges::random_access_range R, typename F>
+			requires std::ranges::sized_range<R> && std::invocable<F&, std::ranges::range_reference_t<R>>
+		void parallel_for(Priority priority, R&& range, F&& func, size_t grain = 1)
+		{
+			const auto count = static_cast<size_t>(std::ranges::size(range));
+			if (count == 0) return;
+
+			grain = std::max<size_t>(grain, 1);
+			const auto begin = std::ranges::begin(range);
+
+			const std::function<void(size_t)> chunk_func = [begin, count, grain, &func](size_t chunk) {
+				const auto chunk_end = std::min((chunk + 1) * grain, count);
+				for (auto idx = chunk * grain; idx < chunk_end; idx++)
+					std::invoke(func, *std::next(begin, static_cast<std::ptrdiff_t>(idx)));
+			};
+
+			run_chunks(priority, (count + grain - 1) / grain, chunk_func);
+		}
+
+		///
+		/// @brief Get the number of worker threads
+		///
+		/// @return Number of workers
+		///
+		[[nodiscard]]
+		size_t get_worker_count() const noexcept
+		{
+			return workers.size();
+		}
+
+		///
+		/// @brief Check if the calling thread is a worker of this scheduler
+		///
+		/// @return `true` if called from a worker
+		///
+		[[nodiscard]]
+		bool in_worker() const noexcept;
+
+	  private:
+
+		struct Worker
+		{
+			std::mutex mutex;
+			std::array<std::deque<Job>, PRIORITY_COUNT> lanes;  // Indexed by `Priority`
+			std::jthread thread;
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		std::mutex injection_mutex;
+		std::array<std::deque<Job>, PRIORITY_COUNT> injection_lanes;  // Jobs submitted from outside
+
+		// Queued jobs of each lane, including those in worker deques
+		std::array<std::atomic<size_t>, PRIORITY_COUNT> pending = {};
+
+		// Background jobs running, limited to `background_limit`
+		std::atomic<size_t> running_background = 0;
+		size_t background_limit;
+
+		std::mutex sleep_mutex;
+		std::condition_variable sleep_cv;
+		std::atomic<size_t> sleeping = 0;
+		std::atomic<bool> stopping = false;
+
+		void worker_loop(size_t index) noexcept;
+
+		// Take the most urgent job available to a worker, also returns its priority
+		[[nodiscard]]
+		std::optional<std::pair<Job, Priority>> take_job(size_t index) noexcept;
+
+		// Check under `sleep_mutex` if a sleeping worker could take a job
+		[[nodiscard]]
+		bool has_available_job() const noexcept;
+
+		void wake_one() noexcept;
+
+		void run_chunks(Priority priority, size_t chunk_count, const std::function<void(size_t)>& chunk_func);
+
+	  public:
+
+		Scheduler(const Scheduler&) = delete;
+		Scheduler(Scheduler&&) = delete;
+		Scheduler& operator=(const Scheduler&) = delete;
+		Scheduler& operator=(Scheduler&&) = delete;
+	};
+}
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <functional>
@@ -11,6 +12,7 @@
 #include <stdexcept>
 #include <type_traits>
 #include <variant>
+#include <vector>
 
 namespace util
 {
@@ -572,4 +574,274 @@ namespace util
 		SyncedEnumVariant(SyncedEnumVariant&&) = default;
 		SyncedEnumVariant& operator=(SyncedEnumVariant&&) = default;
 	};
+
+	///
+	/// @brief A variant type that holds a value associated with a compile-time tag, read lock-free from any
+	/// thread. Meant for progress trees polled every frame, with nested progress as
+	/// `std::shared_ptr<const AtomicEnumVariant<...>>` values and counters as `util::ProgressRef` values.
+	/// @details Each write publishes a new immutable state through an atomic pointer. Published states are
+	/// kept until destruction, so references obtained by readers stay valid while the variant is alive.
+	/// Writers are serialized by a mutex, which readers never take.
+	///
+	/// @note Every write allocates and retains a state, use for values changing a bounded number of times
+	/// and put fast-changing counters in a `util::ProgressRef` value instead
+	///
+	/// @tparam Tags A list of `Tag` types that define the possible values and their associated tags.
+	/// The tags must be unique and of the same type.
+	///
+	template <TagType... Tags>
+		requires(EnumVariantValid<Tags...>)
+	class AtomicEnumVariant
+	{
+		using State = EnumVariant<Tags...>;
+
+		std::unique_ptr<std::mutex> write_mutex;
+		std::vector<std::unique_ptr<const State>> states;  // All published states, the last is current
+		std::atomic<const State*> current;
+
+		void publish(State state)
+		{
+			auto new_state = std::make_unique<const State>(std::move(state));
+
+			const std::scoped_lock lock(*write_mutex);
+			states.push_back(std::move(new_state));
+			current.store(states.back().get(), std::memory_order_release);
+		}
+
+	  public:
+
+		///
+		/// @brief Type of the tags
+		///
+		using EnumType = util::EnumType<Tags::tag...>;
+
+		///
+		/// @brief Type of the value associated with the given `Tag`
+		///
+		template <EnumType TagValue>
+		using DeducedType = impl::DeducedType<TagValue, Tags...>;
+
+		///
+		/// @brief Construct a new `AtomicEnumVariant` from an existing `EnumVariant`, the new
+		/// `AtomicEnumVariant` will have the same active tag and value as the original `EnumVariant`
+		///
+		/// @param other The `EnumVariant` to take the active tag and value from.
+		///
+		explicit AtomicEnumVariant(State other) :
+			write_mutex(std::make_unique<std::mutex>()),
+			current(nullptr)
+		{
+			states.push_back(std::make_unique<const State>(std::move(other)));
+			current.store(states.back().get(), std::memory_order_release);
+		}
+
+		///
+		/// @brief Construct an `AtomicEnumVariant` from a tagged value directly
+		///
+		/// @tparam TagValue The tag associated with the value. Must be one of the tags defined in `Tags...`.
+		/// @param tagged_value The tagged value to be stored in the variant.
+		///
+		template <EnumType TagValue>
+		AtomicEnumVariant(Tag<TagValue, DeducedType<TagValue>> tagged_value) :
+			AtomicEnumVariant(State(std::move(tagged_value)))
+		{}
+
+		///
+		/// @brief Construct an `AtomicEnumVariant` from a value associated with a specific tag.
+		///
+		/// @tparam TagValue The tag associated with the value. Must be one of the tags defined in `Tags...`.
+		/// @param value The value to be stored in the variant, associated with the specified tag. The type is
+		/// automatically deduced from `Tag`
+		///
+		/// @return An `AtomicEnumVariant` instance containing the provided value associated with the
+		/// specified tag.
+		///
+		template <EnumType TagValue>
+		[[nodiscard]]
+		static AtomicEnumVariant from(DeducedType<TagValue> value)
+		{
+			return AtomicEnumVariant(State::template from<TagValue>(std::move(value)));
+		}
+
+		///
+		/// @brief Construct an `AtomicEnumVariant` from a tag with no associated value (i.e., the value is
+		/// `std::monostate`).
+		///
+		/// @tparam TagValue The tag to be set in the variant. Must be one of the tags defined in `Tags...`,
+		/// and the associated value type must be `std::monostate`.
+		///
+		/// @return An `AtomicEnumVariant` instance containing the specified tag with an associated value of
+		/// `std::monostate`.
+		///
+		template <EnumType TagValue>
+			requires(std::same_as<DeducedType<TagValue>, std::monostate>)
+		[[nodiscard]]
+		static AtomicEnumVariant from()
+		{
+			return AtomicEnumVariant(State::template from<TagValue>());
+		}
+
+		///
+		/// @brief Set the value associated with a specific tag in the variant
+		///
+		/// @tparam TagValue The tag associated with the value to be set. Must be one of the tags defined in
+		/// `Tags...`.
+		/// @param value The value to be set in the variant, associated with the specified tag. The type is
+		/// automatically deduced from `Tag`
+		/// @note This function is thread-safe.
+		///
+		template <EnumType Tag>
+		void set(DeducedType<Tag> value)
+		{
+			publish(State::template from<Tag>(std::move(value)));
+		}
+
+		///
+		/// @brief Set the value associated with a specific tag in the variant to `std::monostate`
+		///
+		/// @tparam TagValue The tag associated with the value to be set. Must be one of the tags defined in
+		/// `Tags...`, and the associated value type must be `std::monostate`.
+		/// @note This function is thread-safe.
+		///
+		template <EnumType Tag>
+			requires(std::same_as<DeducedType<Tag>, std::monostate>)
+		void set()
+		{
+			publish(State::template from<Tag>());
+		}
+
+		///
+		/// @brief Get the current state as a whole, for reading the tag and the value consistently
+		///
+		/// @return Reference to the current state, valid until the `AtomicEnumVariant` is destroyed
+		/// @note This function is lock-free and thread-safe.
+		///
+		[[nodiscard]]
+		const State& load() const noexcept
+		{
+			return *current.load(std::memory_order_acquire);
+		}
+
+		///
+		/// @brief Get the value (optional) associated with a specific tag in the variant
+		///
+		/// @tparam TagValue The tag associated with the value to be retrieved. Must be one of the tags
+		/// defined in `Tags...`.
+		///
+		/// @return An optional containing a reference to the value if the tag is currently active, or
+		/// std::nullopt otherwise.
+		/// @note This function is lock-free and thread-safe.
+		///
+		template <EnumType TagValue>
+		[[nodiscard]]
+		auto get_if() const noexcept
+		{
+			return load().template get_if<TagValue>();
+		}
+
+		///
+		/// @brief Get the value associated with a specific tag in the variant. Terminates if the tag is not
+		/// currently active.
+		/// @warning Only use if the caller can guarantee that the tag is active, otherwise use
+		/// `get_if` and check the result.
+		///
+		/// @tparam TagValue The tag associated with the value to be retrieved. Must be one of the tags
+		/// defined in `Tags...`.
+		///
+		/// @return A reference to the value associated with the specified tag if it is currently active.
+		/// Terminates with `std::bad_variant_access` if the tag is not currently active.
+		/// @note This function is lock-free and thread-safe.
+		///
+		template <EnumType TagValue>
+			requires(!std::same_as<DeducedType<TagValue>, std::monostate>)
+		[[nodiscard]]
+		const DeducedType<TagValue>& get() const noexcept
+		{
+			return load().template get<TagValue>();
+		}
+
+		///
+		/// @brief Get the tag of the currently active value in the variant
+		///
+		/// @return The tag of the currently active value in the variant.
+		/// @note This function is lock-free and thread-safe.
+		///
+		[[nodiscard]]
+		EnumType tag() const noexcept
+		{
+			return load().tag();
+		}
+
+		///
+		/// @brief Visit the underlying value in the variant with a visitor function.
+		/// @note The visitor directly takes the `Tag` type as an argument
+		///
+		/// @param f The visitor function to be applied to the active value in the variant
+		/// @note This function is lock-free and thread-safe.
+		///
+		[[nodiscard]]
+		auto visit(auto&& f) const
+		{
+			return load().visit(std::forward<decltype(f)>(f));
+		}
+
+		///
+		/// @brief Get the index of the currently active value in the variant.
+		///
+		/// @return The index of the currently active value in the variant, corresponding to the order of
+		/// `Tags...`.
+		/// @note This function is lock-free and thread-safe.
+		///
+		[[nodiscard]]
+		size_t index() const noexcept
+		{
+			return load().index();
+		}
+
+		///
+		/// @brief Get the number of tags defined in the variant type
+		///
+		/// @return The number of tags defined in the variant type, which corresponds to the number of
+		/// possible values
+		///
+		[[nodiscard]]
+		constexpr size_t tag_count() const noexcept
+		{
+			return sizeof...(Tags);
+		}
+
+		///
+		/// @brief Convert the `AtomicEnumVariant` to a shared pointer. This allows multiple threads to share
+		/// ownership of the same `AtomicEnumVariant` instance
+		///
+		/// @return A `std::shared_ptr` to the current `AtomicEnumVariant` instance
+		///
+		std::shared_ptr<AtomicEnumVariant> share() &&
+		{
+			return std::make_shared<AtomicEnumVariant>(std::move(*this));
+		}
+
+		AtomicEnumVariant(const AtomicEnumVariant&) = delete;
+		AtomicEnumVariant& operator=(const AtomicEnumVariant&) = delete;
+
+		// Moving is not thread-safe, only move before sharing with readers
+		AtomicEnumVariant(AtomicEnumVariant&& other) noexcept :
+			write_mutex(std::move(other.write_mutex)),
+			states(std::move(other.states)),
+			current(other.current.exchange(nullptr, std::memory_order_acq_rel))
+		{}
+
+		AtomicEnumVariant& operator=(AtomicEnumVariant&& other) noexcept
+		{
+			if (this == &other) return *this;
+
+			write_mutex = std::move(other.write_mutex);
+			states = std::move(other.states);
+			current.store(
+				other.current.exchange(nullptr, std::memory_order_acq_rel),
+				std::memory_order_release
+			);
+			return *this;
+		}
+	};
 }
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+
+namespace util::trace
+{
+	///
+	/// @brief Start recording trace events, discarding events recorded before
+	/// @details Recording is process-wide. While not recording, `Scope` costs a single atomic load.
+	///
+	void start() noexcept;
+
+	///
+	/// @brief Check if trace events are being recorded
+	///
+	/// @return `true` if recording
+	///
+	[[nodiscard]]
+	bool recording() noexcept;
+
+	///
+	/// @brief Stop recording, and write the recorded events as a Chrome trace JSON
+	/// @details The output is an object with a `traceEvents` array of complete (`"X"`) events, openable in
+	/// `chrome://tracing` or Perfetto. Events carry the sequential ID of the thread they began on.
+	///
+	/// @param path Output file path
+	/// @return Nothing, or error if writing fails
+	///
+	[[nodiscard]]
+	std::expected<void, Error> stop_and_write(const std::filesystem::path& path) noexcept;
+
+	///
+	/// @brief Trace event covering the lifetime of the scope
+	/// @details Records the begin time and thread on construction, and submits the event on destruction.
+	/// A scope may span a `co_await` resuming on another thread, the event is kept on the beginning thread.
+	///
+	class Scope
+	{
+	  public:
+
+		///
+		/// @brief Begin a trace event
+		///
+		/// @param name Name of the event, must be a string literal or otherwise outlive the recording
+		/// @param index Optional index of the processed item, e.g. a texture or mesh index, shown in the
+		/// arguments of the event
+		///
+		explicit Scope(const char* name, std::optional<uint64_t> index = std::nullopt) noexcept;
+
+		~Scope() noexcept;
+
+	  private:
+
+		const char* name;
+		std::optional<uint64_t> index;
+		std::optional<std::chrono::steady_clock::time_point> begin_time;  // Empty if not recording
+		uint32_t thread_id = 0;
+
+	  public:
+
+		Scope(const Scope&) = delete;
+		Scope(Scope&&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		Scope& operator=(Scope&&) = delete;
+	};
+}
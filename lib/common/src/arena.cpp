@@ -0,0 +1,195 @@
+#include "common/util/arena.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace util
+{
+	namespace
+	{
+		constexpr size_t align_up(size_t size, size_t alignment) noexcept
+		{
+			return (size + alignment - 1) / alignment * alignment;
+		}
+
+		// Map a block of `size` bytes, a multiple of `HUGE_PAGE_SIZE`, throws `std::bad_alloc` on failure
+		std::pair<void*, bool> map_huge_block(size_t size)
+		{
+#if defined(_WIN32)
+			// Large pages need the "Lock pages in memory" privilege, regular pages otherwise
+			const auto large_page_size = GetLargePageMinimum();
+			if (large_page_size != 0 && size % large_page_size == 0)
+			{
+				constexpr auto large_flags = MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES;
+				auto* const pointer = VirtualAlloc(nullptr, size, large_flags, PAGE_READWRITE);
+				if (pointer != nullptr) return {pointer, true};
+			}
+
+			auto* const pointer = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (pointer == nullptr) throw std::bad_alloc();
+
+			return {pointer, false};
+#elif defined(__linux__)
+			// Explicit huge pages, only available if reserved by `vm.nr_hugepages`
+			constexpr int huge_flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB
+#if defined(MAP_HUGE_SHIFT)
+				| (21 << MAP_HUGE_SHIFT)
+#endif
+				;
+			if (auto* const pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, huge_flags, -1, 0);
+				pointer != MAP_FAILED)
+				return {pointer, true};
+
+			// Transparent huge pages only back 2 MiB aligned ranges, over-map and trim to alignment
+			const auto padded_size = size + ImportArena::HUGE_PAGE_SIZE;
+			auto* const base =
+				mmap(nullptr, padded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (base == MAP_FAILED) throw std::bad_alloc();
+
+			const auto address = reinterpret_cast<uintptr_t>(base);
+			const auto head = align_up(address, ImportArena::HUGE_PAGE_SIZE) - address;
+			const auto tail = padded_size - head - size;
+
+			auto* const pointer = static_cast<std::byte*>(base) + head;
+			if (head != 0) munmap(base, head);
+			if (tail != 0) munmap(pointer + size, tail);
+
+			// Advisory, falls back to regular pages if THP is disabled
+			madvise(pointer, size, MADV_HUGEPAGE);
+
+			return {pointer, false};
+#else
+			return {::operator new(size, std::align_val_t(ImportArena::HUGE_PAGE_SIZE)), false};
+#endif
+		}
+	}
+
+	ImportArena::~ImportArena() noexcept
+	{
+		for (const auto& block : cached_blocks) release_block(block);
+		for (const auto& block : live_blocks | std::views::values) release_block(block);
+	}
+
+	void ImportArena::trim() noexcept
+	{
+		auto blocks = std::vector<Block>();
+
+		{
+			const auto lock = std::scoped_lock(mutex);
+			blocks = std::exchange(cached_blocks, {});
+
+			for (const auto& block : blocks)
+			{
+				block_stat.mapped_bytes -= block.size;
+				if (block.huge) block_stat.huge_page_bytes -= block.size;
+			}
+			block_stat.cached_bytes = 0;
+		}
+
+		for (const auto& block : blocks) release_block(block);
+	}
+
+	ImportArena::Stat ImportArena::stat() const noexcept
+	{
+		const auto lock = std::scoped_lock(mutex);
+		return block_stat;
+	}
+
+	void* ImportArena::do_allocate(size_t bytes, size_t alignment)
+	{
+		if (bytes < large_threshold || alignment > HUGE_PAGE_SIZE)
+			return upstream->allocate(bytes, alignment);
+
+		const auto size = align_up(bytes, HUGE_PAGE_SIZE);
+
+		{
+			const auto lock = std::scoped_lock(mutex);
+
+			// Smallest cached block fitting, wasting at most half of it
+			const auto fits = [size](const Block& block) {
+				return block.size >= size && block.size <= size * 2;
+			};
+			auto reusable = cached_blocks | std::views::filter(fits);
+
+			const auto best = std::ranges::min_element(reusable, {}, &Block::size);
+			if (best != reusable.end())
+			{
+				const auto block = *best;
+				*best.base() = cached_blocks.back();
+				cached_blocks.pop_back();
+
+				block_stat.cached_bytes -= block.size;
+				live_blocks.emplace(block.pointer, block);
+				return block.pointer;
+			}
+		}
+
+		const auto [pointer, huge] = map_huge_block(size);
+
+		const auto lock = std::scoped_lock(mutex);
+		live_blocks.emplace(pointer, Block{.pointer = pointer, .size = size, .huge = huge});
+		block_stat.mapped_bytes += size;
+		if (huge) block_stat.huge_page_bytes += size;
+
+		return pointer;
+	}
+
+	void ImportArena::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+	{
+		if (bytes < large_threshold || alignment > HUGE_PAGE_SIZE)
+		{
+			upstream->deallocate(pointer, bytes, alignment);
+			return;
+		}
+
+		auto released = std::optional<Block>();
+
+		{
+			const auto lock = std::scoped_lock(mutex);
+
+			const auto node = live_blocks.extract(pointer);
+			if (node.empty()) return;
+			const auto& block = node.mapped();
+
+			if (block_stat.cached_bytes + block.size <= max_cached)
+			{
+				cached_blocks.push_back(block);
+				block_stat.cached_bytes += block.size;
+			}
+			else
+			{
+				block_stat.mapped_bytes -= block.size;
+				if (block.huge) block_stat.huge_page_bytes -= block.size;
+				released = block;
+			}
+		}
+
+		if (released.has_value()) release_block(*released);
+	}
+
+	void ImportArena::release_block(const Block& block) noexcept
+	{
+#if defined(_WIN32)
+		VirtualFree(block.pointer, 0, MEM_RELEASE);
+#elif defined(__linux__)
+		munmap(block.pointer, block.size);
+#else
+		::operator delete(block.pointer, std::align_val_t(HUGE_PAGE_SIZE));
+#endif
+	}
+}
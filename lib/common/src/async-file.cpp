@@ -0,0 +1,752 @@
+#include "common/async-file.hpp"
+#include "common/util/error.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(COMMON_IO_URING)
+#include <liburing.h>
+#endif
+#endif
+
+namespace file
+{
+	namespace
+	{
+		// Alignment of offsets, sizes and buffers required by direct I/O
+		constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+		constexpr size_t align_down(size_t value) noexcept
+		{
+			return value / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+		}
+
+		constexpr size_t align_up(size_t value) noexcept
+		{
+			return align_down(value + DIRECT_IO_ALIGNMENT - 1);
+		}
+
+#if defined(_WIN32)
+		using FileHandle = HANDLE;
+		const FileHandle INVALID_FILE = INVALID_HANDLE_VALUE;
+
+		Error last_system_error(std::string message) noexcept
+		{
+			const auto code = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+			return Error::from(code).forward(std::move(message));
+		}
+#else
+		using FileHandle = int;
+		constexpr FileHandle INVALID_FILE = -1;
+
+		Error system_error(int code, std::string message) noexcept
+		{
+			return Error::from(std::error_code(code, std::system_category())).forward(std::move(message));
+		}
+
+		Error last_system_error(std::string message) noexcept
+		{
+			return system_error(errno, std::move(message));
+		}
+#endif
+	}
+
+	void Buffer::Deleter::operator()(std::byte* ptr) const noexcept
+	{
+		::operator delete[](ptr, std::align_val_t(DIRECT_IO_ALIGNMENT));
+	}
+
+	Buffer::Buffer(size_t capacity) :
+		storage(
+			static_cast<std::byte*>(
+				::operator new[](std::max<size_t>(capacity, 1), std::align_val_t(DIRECT_IO_ALIGNMENT))
+			)
+		)
+	{}
+
+	// Part of a read in flight, resubmitted with the remainder after short reads
+	struct AsyncReader::Chunk
+	{
+#if defined(_WIN32)
+		OVERLAPPED overlapped;  // First member, the completion port returns a pointer to it
+#endif
+		Request* request;
+		std::byte* destination;
+		size_t offset;    // Offset in the file
+		size_t size;      // Bytes left to read
+		size_t required;  // Bytes left before the end of the requested range, the rest is alignment padding
+	};
+
+	struct AsyncReader::Request
+	{
+		std::filesystem::path path;
+		size_t offset;
+		std::optional<size_t> size;  // Whole file if empty
+		size_t size_limit;
+		Hint hint;
+
+		FileHandle file = INVALID_FILE;
+		std::optional<Buffer> buffer;
+		std::vector<Chunk> chunks;
+		std::atomic<size_t> remaining_chunks = 0;
+
+		std::mutex error_mutex;
+		std::optional<Error> error;  // First error of the chunks
+
+		std::coroutine_handle<> handle;
+		std::optional<Result> result;
+	};
+
+	class AsyncReader::Backend
+	{
+	  public:
+
+		Option option;
+
+		[[nodiscard]]
+		static std::expected<std::unique_ptr<Backend>, Error> create(const Option& option) noexcept;
+
+		// Open the file and split the request into chunks
+		[[nodiscard]]
+		std::expected<void, Error> open(Request& request) noexcept;
+
+		// Queue all chunks of an opened request
+		void enqueue(Request& request) noexcept;
+
+		// Finish the request, setting its result and closing the file
+		static void finish(Request& request) noexcept;
+
+		~Backend() noexcept;
+
+	  private:
+
+		std::mutex queue_mutex;
+		std::deque<Chunk*> waiting;  // Chunks waiting for a free slot
+		size_t in_flight = 0;
+
+#if defined(_WIN32)
+		HANDLE completion_port = nullptr;
+		std::vector<std::jthread> threads;
+#elif defined(COMMON_IO_URING)
+		io_uring ring;
+		std::mutex submit_mutex;
+		std::jthread completion_thread;
+#else
+		std::mutex job_mutex;
+		std::condition_variable job_cv;
+		std::deque<Chunk*> jobs;
+		bool stopping = false;
+		std::vector<std::jthread> threads;
+#endif
+
+		Backend() = default;
+
+		// Platform-specific, starts the I/O of a chunk
+		void submit(Chunk& chunk) noexcept;
+
+		// Platform-specific, opens a file for reading
+		[[nodiscard]]
+		std::expected<FileHandle, Error> open_file(const Request& request, bool direct) noexcept;
+
+		// Called from the I/O threads when a chunk completes
+		void complete(Chunk& chunk, std::expected<size_t, Error> read) noexcept;
+
+		// Move waiting chunks into free slots, returns the chunks to submit
+		[[nodiscard]]
+		std::vector<Chunk*> take_ready() noexcept;
+
+	  public:
+
+		Backend(const Backend&) = delete;
+		Backend(Backend&&) = delete;
+		Backend& operator=(const Backend&) = delete;
+		Backend& operator=(Backend&&) = delete;
+	};
+
+	/* Platform-independent */
+
+	std::expected<void, Error> AsyncReader::Backend::open(Request& request) noexcept
+	{
+		const auto buffered_result = open_file(request, false);
+		if (!buffered_result)
+			return buffered_result.error().forward(
+				std::format("Open file '{}' failed", request.path.string())
+			);
+		request.file = *buffered_result;
+
+		const auto file_size_result = [&] -> std::expected<size_t, Error> {
+#if defined(_WIN32)
+			LARGE_INTEGER file_size;
+			if (!GetFileSizeEx(request.file, &file_size)) return last_system_error("Get file size failed");
+			return static_cast<size_t>(file_size.QuadPart);
+#else
+			struct stat file_stat;
+			if (fstat(request.file, &file_stat) != 0) return last_system_error("Get file size failed");
+			return static_cast<size_t>(file_stat.st_size);
+#endif
+		}();
+		if (!file_size_result) return file_size_result.error().forward(request.path.string());
+		const auto file_size = *file_size_result;
+
+		if (!request.size.has_value())
+		{
+			if (file_size > request.size_limit)
+				return Error(
+					std::format("Read file '{}' failed: file size exceeds limit", request.path.string()),
+					std::format("File size: {}, limit: {}", file_size, request.size_limit)
+				);
+			request.size = file_size - std::min(request.offset, file_size);
+		}
+		else if (request.offset > file_size || *request.size > file_size - request.offset)
+			return Error(
+				std::format("Read file '{}' failed: range exceeds file", request.path.string()),
+				std::format("Range: {}+{}, file size: {}", request.offset, *request.size, file_size)
+			);
+
+		const auto begin = request.offset;
+		const auto end = request.offset + *request.size;
+
+		// Direct I/O reads whole aligned blocks, the content starts inside the first block
+		const auto direct = request.hint == Hint::Sequential
+			&& option.direct_io_threshold != 0
+			&& *request.size >= option.direct_io_threshold;
+		const auto read_begin = direct ? align_down(begin) : begin;
+		const auto read_end = direct ? align_up(end) : end;
+
+		if (direct)
+		{
+			// Not all file systems support direct I/O, keep the buffered file if unsupported
+			if (const auto direct_result = open_file(request, true))
+			{
+#if defined(_WIN32)
+				CloseHandle(request.file);
+#else
+				close(request.file);
+#endif
+				request.file = *direct_result;
+			}
+		}
+
+		request.buffer.emplace(Buffer(read_end - read_begin));
+		request.buffer->offset = begin - read_begin;
+		request.buffer->size = *request.size;
+
+		const auto chunk_size = align_up(std::max<size_t>(option.chunk_size, 1));
+		for (auto offset = read_begin; offset < read_end; offset += chunk_size)
+		{
+			const auto chunk_end = std::min(offset + chunk_size, read_end);
+			request.chunks.push_back(
+				Chunk{
+					.request = &request,
+					.destination = request.buffer->storage.get() + (offset - read_begin),
+					.offset = offset,
+					.size = chunk_end - offset,
+					.required = std::min(chunk_end, end) - offset,
+				}
+			);
+		}
+
+		request.remaining_chunks.store(request.chunks.size(), std::memory_order_release);
+		return {};
+	}
+
+	std::vector<AsyncReader::Chunk*> AsyncReader::Backend::take_ready() noexcept
+	{
+		std::vector<Chunk*> ready;
+
+		const std::scoped_lock lock(queue_mutex);
+		while (in_flight < option.queue_depth && !waiting.empty())
+		{
+			ready.push_back(waiting.front());
+			waiting.pop_front();
+			in_flight++;
+		}
+
+		return ready;
+	}
+
+	void AsyncReader::Backend::enqueue(Request& request) noexcept
+	{
+		{
+			const std::scoped_lock lock(queue_mutex);
+			for (auto& chunk : request.chunks) waiting.push_back(&chunk);
+		}
+
+		for (auto* chunk : take_ready()) submit(*chunk);
+	}
+
+	void AsyncReader::Backend::complete(Chunk& chunk, std::expected<size_t, Error> read) noexcept
+	{
+		auto& request = *chunk.request;
+
+		const auto fail = [&request](Error error) {
+			const std::scoped_lock lock(request.error_mutex);
+			if (!request.error.has_value()) request.error = std::move(error);
+		};
+
+		if (!read)
+			fail(read.error().forward(std::format("Read file '{}' failed", request.path.string())));
+		else if (*read < chunk.required)
+		{
+			if (*read == 0)
+			{
+				fail(
+					Error(
+						std::format("Read file '{}' failed", request.path.string()),
+						"Unexpected end of file"
+					)
+				);
+			}
+			else
+			{
+				// Short read, resubmit the rest in the same slot
+				chunk.destination += *read;
+				chunk.offset += *read;
+				chunk.size -= *read;
+				chunk.required -= *read;
+				submit(chunk);
+				return;
+			}
+		}
+
+		{
+			const std::scoped_lock lock(queue_mutex);
+			in_flight--;
+		}
+		for (auto* next : take_ready()) submit(*next);
+
+		// The request may be destroyed once resumed
+		if (request.remaining_chunks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			finish(request);
+			request.handle.resume();
+		}
+	}
+
+	void AsyncReader::Backend::finish(Request& request) noexcept
+	{
+		if (request.file != INVALID_FILE)
+		{
+#if defined(_WIN32)
+			CloseHandle(request.file);
+#else
+			close(request.file);
+#endif
+			request.file = INVALID_FILE;
+		}
+
+		if (request.error.has_value())
+			request.result.emplace(std::unexpected(std::move(*request.error)));
+		else if (request.buffer.has_value())
+			request.result.emplace(std::move(*request.buffer));
+	}
+
+	/* Platform-specific */
+
+#if defined(_WIN32)
+
+	std::expected<std::unique_ptr<AsyncReader::Backend>, Error> AsyncReader::Backend::create(
+		const Option& option
+	) noexcept
+	{
+		auto backend = std::unique_ptr<Backend>(new Backend());
+		backend->option = option;
+		backend->option.queue_depth = std::max<size_t>(option.queue_depth, 1);
+
+		backend->completion_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 0);
+		if (backend->completion_port == nullptr)
+			return last_system_error("Create I/O completion port failed");
+
+		const auto thread_count = std::clamp<size_t>(std::thread::hardware_concurrency() / 4, 1, 4);
+		for (size_t idx = 0; idx < thread_count; idx++)
+			backend->threads.emplace_back([backend = backend.get()] {
+				while (true)
+				{
+					DWORD bytes = 0;
+					ULONG_PTR key = 0;
+					OVERLAPPED* overlapped = nullptr;
+					const auto success = GetQueuedCompletionStatus(
+						backend->completion_port,
+						&bytes,
+						&key,
+						&overlapped,
+						INFINITE
+					);
+
+					if (overlapped == nullptr) return;  // Stop packet
+
+					auto& chunk = *reinterpret_cast<Chunk*>(overlapped);
+					if (success || GetLastError() == ERROR_HANDLE_EOF)
+						backend->complete(chunk, static_cast<size_t>(bytes));
+					else
+					{
+						auto error = last_system_error("Overlapped read failed");
+						backend->complete(chunk, std::unexpected(std::move(error)));
+					}
+				}
+			});
+
+		return backend;
+	}
+
+	std::expected<FileHandle, Error> AsyncReader::Backend::open_file(
+		const Request& request,
+		bool direct
+	) noexcept
+	{
+		DWORD flags = FILE_FLAG_OVERLAPPED;
+		flags |= request.hint == Hint::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+		if (direct) flags |= FILE_FLAG_NO_BUFFERING;
+
+		const auto file = CreateFileW(
+			request.path.c_str(),
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			OPEN_EXISTING,
+			flags,
+			nullptr
+		);
+		if (file == INVALID_HANDLE_VALUE) return last_system_error("Open file failed");
+
+		if (CreateIoCompletionPort(file, completion_port, 0, 0) == nullptr)
+		{
+			auto error = last_system_error("Associate file with I/O completion port failed");
+			CloseHandle(file);
+			return error;
+		}
+
+		return file;
+	}
+
+	void AsyncReader::Backend::submit(Chunk& chunk) noexcept
+	{
+		chunk.overlapped = {};
+		chunk.overlapped.Offset = static_cast<DWORD>(chunk.offset);
+		chunk.overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(chunk.offset) >> 32);
+
+		const auto size = static_cast<DWORD>(std::min<size_t>(chunk.size, 1024 * 1024 * 1024));
+		if (!ReadFile(chunk.request->file, chunk.destination, size, nullptr, &chunk.overlapped))
+		{
+			const auto error = GetLastError();
+			if (error == ERROR_IO_PENDING) return;
+			if (error == ERROR_HANDLE_EOF)
+			{
+				complete(chunk, 0zu);
+				return;
+			}
+
+			complete(chunk, std::unexpected(last_system_error("Submit overlapped read failed")));
+		}
+	}
+
+	AsyncReader::Backend::~Backend() noexcept
+	{
+		for ([[maybe_unused]] const auto& _ : threads)
+			PostQueuedCompletionStatus(completion_port, 0, 0, nullptr);
+		threads.clear();
+
+		if (completion_port != nullptr) CloseHandle(completion_port);
+	}
+
+#elif defined(COMMON_IO_URING)
+
+	std::expected<std::unique_ptr<AsyncReader::Backend>, Error> AsyncReader::Backend::create(
+		const Option& option
+	) noexcept
+	{
+		auto backend = std::unique_ptr<Backend>(new Backend());
+		backend->option = option;
+		backend->option.queue_depth = std::max<size_t>(option.queue_depth, 1);
+
+		// One extra entry for the stop request
+		const auto entries = static_cast<unsigned>(backend->option.queue_depth + 1);
+		if (const auto result = io_uring_queue_init(entries, &backend->ring, 0); result < 0)
+			return system_error(-result, "Setup io_uring failed");
+
+		backend->completion_thread = std::jthread([backend = backend.get()] {
+			while (true)
+			{
+				io_uring_cqe* cqe = nullptr;
+				const auto wait_result = io_uring_wait_cqe(&backend->ring, &cqe);
+				if (wait_result == -EINTR) continue;
+				if (wait_result < 0) return;
+
+				auto* const chunk = static_cast<Chunk*>(io_uring_cqe_get_data(cqe));
+				const auto result = cqe->res;
+				io_uring_cqe_seen(&backend->ring, cqe);
+
+				if (chunk == nullptr) return;  // Stop request
+
+				if (result < 0)
+					backend->complete(*chunk, std::unexpected(system_error(-result, "Read failed")));
+				else
+					backend->complete(*chunk, static_cast<size_t>(result));
+			}
+		});
+
+		return backend;
+	}
+
+	std::expected<FileHandle, Error> AsyncReader::Backend::open_file(
+		const Request& request,
+		bool direct
+	) noexcept
+	{
+		const auto file = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC | (direct ? O_DIRECT : 0));
+		if (file < 0) return last_system_error("Open file failed");
+
+		// Direct I/O bypasses the page cache, hints only apply to buffered reads
+		if (!direct)
+			posix_fadvise(
+				file,
+				0,
+				0,
+				request.hint == Hint::Sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM
+			);
+
+		return file;
+	}
+
+	void AsyncReader::Backend::submit(Chunk& chunk) noexcept
+	{
+		const auto result = [&] {
+			const std::scoped_lock lock(submit_mutex);
+
+			// Never empty, as chunks in flight are limited to the queue depth
+			auto* const sqe = io_uring_get_sqe(&ring);
+			io_uring_prep_read(
+				sqe,
+				chunk.request->file,
+				chunk.destination,
+				static_cast<unsigned>(std::min<size_t>(chunk.size, 1024 * 1024 * 1024)),
+				chunk.offset
+			);
+			io_uring_sqe_set_data(sqe, &chunk);
+			return io_uring_submit(&ring);
+		}();
+
+		if (result < 0)
+			complete(chunk, std::unexpected(system_error(-result, "Submit read failed")));
+	}
+
+	AsyncReader::Backend::~Backend() noexcept
+	{
+		{
+			const std::scoped_lock lock(submit_mutex);
+			auto* const sqe = io_uring_get_sqe(&ring);
+			io_uring_prep_nop(sqe);
+			io_uring_sqe_set_data(sqe, nullptr);
+			io_uring_submit(&ring);
+		}
+
+		completion_thread.join();
+		io_uring_queue_exit(&ring);
+	}
+
+#else
+
+	std::expected<std::unique_ptr<AsyncReader::Backend>, Error> AsyncReader::Backend::create(
+		const Option& option
+	) noexcept
+	{
+		auto backend = std::unique_ptr<Backend>(new Backend());
+		backend->option = option;
+		backend->option.queue_depth = std::max<size_t>(option.queue_depth, 1);
+
+		// Blocking reads, each thread keeps one chunk in flight
+		const auto thread_count = std::min<size_t>(backend->option.queue_depth, 8);
+		for (size_t idx = 0; idx < thread_count; idx++)
+			backend->threads.emplace_back([backend = backend.get()] {
+				while (true)
+				{
+					Chunk* chunk = nullptr;
+					{
+						std::unique_lock lock(backend->job_mutex);
+						backend->job_cv.wait(lock, [backend] {
+							return backend->stopping || !backend->jobs.empty();
+						});
+						if (backend->jobs.empty()) return;
+
+						chunk = backend->jobs.front();
+						backend->jobs.pop_front();
+					}
+
+					const auto result = pread(
+						chunk->request->file,
+						chunk->destination,
+						chunk->size,
+						static_cast<off_t>(chunk->offset)
+					);
+
+					if (result < 0)
+						backend->complete(*chunk, std::unexpected(last_system_error("Read failed")));
+					else
+						backend->complete(*chunk, static_cast<size_t>(result));
+				}
+			});
+
+		return backend;
+	}
+
+	std::expected<FileHandle, Error> AsyncReader::Backend::open_file(
+		const Request& request,
+		bool direct
+	) noexcept
+	{
+		auto flags = O_RDONLY | O_CLOEXEC;
+#if defined(O_DIRECT)
+		if (direct) flags |= O_DIRECT;
+#else
+		if (direct) return Error("Direct I/O not supported");
+#endif
+
+		const auto file = ::open(request.path.c_str(), flags);
+		if (file < 0) return last_system_error("Open file failed");
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+		// Direct I/O bypasses the page cache, hints only apply to buffered reads
+		if (!direct)
+			posix_fadvise(
+				file,
+				0,
+				0,
+				request.hint == Hint::Sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM
+			);
+#endif
+
+		return file;
+	}
+
+	void AsyncReader::Backend::submit(Chunk& chunk) noexcept
+	{
+		{
+			const std::scoped_lock lock(job_mutex);
+			jobs.push_back(&chunk);
+		}
+		job_cv.notify_one();
+	}
+
+	AsyncReader::Backend::~Backend() noexcept
+	{
+		{
+			const std::scoped_lock lock(job_mutex);
+			stopping = true;
+		}
+		job_cv.notify_all();
+
+		threads.clear();
+	}
+
+#endif
+
+	/* AsyncReader */
+
+	AsyncReader::AsyncReader(std::unique_ptr<Backend> backend) noexcept :
+		backend(std::move(backend))
+	{}
+
+	AsyncReader::~AsyncReader() noexcept = default;
+	AsyncReader::AsyncReader(AsyncReader&&) noexcept = default;
+	AsyncReader& AsyncReader::operator=(AsyncReader&&) noexcept = default;
+
+	std::expected<AsyncReader, Error> AsyncReader::create(const Option& option) noexcept
+	{
+		auto backend_result = Backend::create(option);
+		if (!backend_result) return backend_result.error().forward("Create async file reader failed");
+
+		return AsyncReader(std::move(*backend_result));
+	}
+
+	AsyncReader::ReadAwaitable AsyncReader::read(
+		std::filesystem::path path,
+		Hint hint,
+		size_t size_limit
+	) noexcept
+	{
+		auto request = std::make_unique<Request>();
+		request->path = std::move(path);
+		request->offset = 0;
+		request->size_limit = size_limit;
+		request->hint = hint;
+
+		return ReadAwaitable(*backend, std::move(request));
+	}
+
+	AsyncReader::ReadAwaitable AsyncReader::read_range(
+		std::filesystem::path path,
+		size_t offset,
+		size_t size,
+		Hint hint
+	) noexcept
+	{
+		auto request = std::make_unique<Request>();
+		request->path = std::move(path);
+		request->offset = offset;
+		request->size = size;
+		request->size_limit = size;
+		request->hint = hint;
+
+		return ReadAwaitable(*backend, std::move(request));
+	}
+
+	/* ReadAwaitable */
+
+	AsyncReader::ReadAwaitable::ReadAwaitable(Backend& backend, std::unique_ptr<Request> request) noexcept :
+		backend(backend),
+		request(std::move(request))
+	{}
+
+	AsyncReader::ReadAwaitable::~ReadAwaitable() noexcept = default;
+	AsyncReader::ReadAwaitable::ReadAwaitable(ReadAwaitable&&) noexcept = default;
+
+	bool AsyncReader::ReadAwaitable::await_suspend(std::coroutine_handle<> handle) noexcept
+	{
+		if (const auto open_result = backend.open(*request); !open_result)
+		{
+			request->error = open_result.error();
+			Backend::finish(*request);
+			return false;
+		}
+
+		if (request->chunks.empty())
+		{
+			Backend::finish(*request);
+			return false;
+		}
+
+		request->handle = handle;
+		backend.enqueue(*request);
+		return true;
+	}
+
+	AsyncReader::Result AsyncReader::ReadAwaitable::await_resume() noexcept
+	{
+		return std::move(*request->result);
+	}
+}
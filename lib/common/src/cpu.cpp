@@ -0,0 +1,286 @@
+#include "common/util/cpu.hpp"
+#include "common/util/error.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <fstream>
+#include <sched.h>
+#include <string>
+#endif
+
+namespace util::cpu
+{
+	namespace
+	{
+		std::vector<LogicalCore> fallback_cores() noexcept
+		{
+			const auto count = std::max(std::thread::hardware_concurrency(), 1u);
+			return std::views::iota(0u, count)
+				| std::views::transform([](uint32_t index) {
+					   return LogicalCore{.index = index, .type = CoreType::Performance};
+				   })
+				| std::ranges::to<std::vector>();
+		}
+
+#if defined(_WIN32)
+		std::optional<std::vector<LogicalCore>> query_platform_cores() noexcept
+		{
+			DWORD_PTR process_mask = 0, system_mask = 0;
+			if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+				return std::nullopt;
+
+			DWORD length = 0;
+			GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+			if (length == 0) return std::nullopt;
+
+			// Aligned storage for the variable-sized entries
+			std::vector<uint64_t> buffer((length + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+			const auto info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+			if (!GetLogicalProcessorInformationEx(RelationProcessorCore, info, &length)) return std::nullopt;
+
+			struct Core
+			{
+				uint32_t index;
+				BYTE efficiency_class;
+			};
+
+			std::vector<Core> cores;
+			BYTE max_efficiency_class = 0;
+
+			for (DWORD offset = 0; offset < length;)
+			{
+				const auto& entry = *reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(
+					reinterpret_cast<const std::byte*>(info) + offset
+				);
+				offset += entry.Size;
+
+				const auto efficiency_class = entry.Processor.EfficiencyClass;
+				const auto group_masks = std::span(entry.Processor.GroupMask, entry.Processor.GroupCount);
+
+				// Affinity masks only address the first processor group
+				for (const auto& group_mask : group_masks)
+				{
+					if (group_mask.Group != 0) continue;
+
+					for (uint32_t bit = 0; bit < sizeof(KAFFINITY) * 8; bit++)
+						if ((group_mask.Mask & process_mask & (KAFFINITY(1) << bit)) != 0)
+							cores.push_back({.index = bit, .efficiency_class = efficiency_class});
+				}
+
+				max_efficiency_class = std::max(max_efficiency_class, entry.Processor.EfficiencyClass);
+			}
+
+			if (cores.empty()) return std::nullopt;
+
+			// Higher efficiency class means higher performance, all zero on non-hybrid CPUs
+			return cores
+				| std::views::transform([max_efficiency_class](const Core& core) {
+					   return LogicalCore{
+						   .index = core.index,
+						   .type = core.efficiency_class < max_efficiency_class
+							   ? CoreType::Efficiency
+							   : CoreType::Performance,
+					   };
+				   })
+				| std::ranges::to<std::vector>();
+		}
+#elif defined(__linux__)
+		std::optional<std::string> read_line(const char* path) noexcept
+		{
+			auto stream = std::ifstream(path);
+			std::string line;
+			if (!stream || !std::getline(stream, line)) return std::nullopt;
+			return line;
+		}
+
+		std::optional<std::vector<LogicalCore>> query_platform_cores() noexcept
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			if (sched_getaffinity(0, sizeof(set), &set) != 0) return std::nullopt;
+
+			auto cores = std::views::iota(0u, uint32_t(CPU_SETSIZE))
+				| std::views::filter([&set](uint32_t index) { return CPU_ISSET(index, &set); })
+				| std::views::transform([](uint32_t index) {
+					  return LogicalCore{.index = index, .type = CoreType::Performance};
+				  })
+				| std::ranges::to<std::vector>();
+			if (cores.empty()) return std::nullopt;
+
+			// Intel hybrid: E-cores are listed by their own PMU
+			if (const auto atom_list = read_line("/sys/devices/cpu_atom/cpus"))
+			{
+				if (const auto atom_cores = parse_cpu_list(*atom_list))
+				{
+					for (auto& core : cores)
+						if (std::ranges::binary_search(*atom_cores, core.index))
+							core.type = CoreType::Efficiency;
+
+					return cores;
+				}
+			}
+
+			// ARM big.LITTLE: cores below the highest capacity, all equal on symmetric CPUs
+			std::vector<uint32_t> capacities;
+			for (const auto& core : cores)
+			{
+				const auto path = std::format("/sys/devices/system/cpu/cpu{}/cpu_capacity", core.index);
+				const auto line = read_line(path.c_str());
+
+				uint32_t capacity = 0;
+				if (!line
+					|| std::from_chars(line->data(), line->data() + line->size(), capacity).ec != std::errc())
+					return cores;
+
+				capacities.push_back(capacity);
+			}
+
+			const auto max_capacity = std::ranges::max(capacities);
+			for (const auto [core, capacity] : std::views::zip(cores, capacities))
+				if (capacity < max_capacity) core.type = CoreType::Efficiency;
+
+			return cores;
+		}
+#else
+		std::optional<std::vector<LogicalCore>> query_platform_cores() noexcept
+		{
+			return std::nullopt;
+		}
+#endif
+	}
+
+	std::vector<LogicalCore> query_cores() noexcept
+	{
+		return query_platform_cores().value_or(fallback_cores());
+	}
+
+	std::optional<std::vector<uint32_t>> parse_cpu_list(std::string_view list) noexcept
+	{
+		while (!list.empty() && (list.back() == '\n' || list.back() == ' ')) list.remove_suffix(1);
+
+		std::vector<uint32_t> cores;
+		if (list.empty()) return cores;
+
+		const auto parse_index = [](std::string_view text) -> std::optional<uint32_t> {
+			uint32_t value = 0;
+			const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+			if (ec != std::errc() || end != text.data() + text.size()) return std::nullopt;
+			return value;
+		};
+
+		for (const auto range : std::views::split(list, ','))
+		{
+			const auto range_text = std::string_view(range);
+			const auto dash = range_text.find('-');
+
+			const auto first = parse_index(range_text.substr(0, dash));
+			const auto last =
+				dash == std::string_view::npos ? first : parse_index(range_text.substr(dash + 1));
+			if (!first || !last || *last < *first) return std::nullopt;
+
+			for (auto index = *first; index <= *last; index++) cores.push_back(index);
+		}
+
+		std::ranges::sort(cores);
+		const auto [unique_end, _] = std::ranges::unique(cores);
+		cores.erase(unique_end, cores.end());
+
+		return cores;
+	}
+
+	std::expected<void, Error> set_thread_affinity(std::span<const uint32_t> cores) noexcept
+	{
+		if (cores.empty()) return Error("Empty core set");
+
+#if defined(_WIN32)
+		DWORD_PTR mask = 0;
+		for (const auto core : cores)
+		{
+			if (core >= sizeof(DWORD_PTR) * 8) return Error("Core out of the first processor group");
+			mask |= DWORD_PTR(1) << core;
+		}
+
+		if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+			return Error("Set thread affinity failed", std::format("Error code {}", GetLastError()));
+
+		return {};
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (const auto core : cores)
+		{
+			if (core >= CPU_SETSIZE) return Error("Core index out of range", std::format("Core {}", core));
+			CPU_SET(core, &set);
+		}
+
+		// Thread ID 0 refers to the calling thread
+		if (sched_setaffinity(0, sizeof(set), &set) != 0)
+			return Error(
+				"Set thread affinity failed",
+				std::error_code(errno, std::system_category()).message()
+			);
+
+		return {};
+#else
+		return Error("Thread affinity is not supported on this platform");
+#endif
+	}
+
+	PoolLayout plan_pool(std::span<const LogicalCore> cores, const PoolConfig& config) noexcept
+	{
+		const auto indices_of = [](auto&& filtered) {
+			return filtered
+				| std::views::transform([](const LogicalCore& core) { return core.index; })
+				| std::ranges::to<std::vector>();
+		};
+
+		const auto is_performance = [](const LogicalCore& core) {
+			return core.type == CoreType::Performance;
+		};
+
+		const auto performance_cores = indices_of(cores | std::views::filter(is_performance));
+
+		auto render_core = std::optional<uint32_t>();
+		if (config.reserve_render_core && cores.size() > 1 && !performance_cores.empty())
+			render_core = performance_cores.back();
+
+		const auto is_worker_core = [&render_core](const LogicalCore& core) {
+			return !render_core.has_value() || core.index != *render_core;
+		};
+
+		auto worker_cores = std::vector<uint32_t>();
+		if (config.affinity == Affinity::Performance)
+			worker_cores = indices_of(
+				cores | std::views::filter(is_performance) | std::views::filter(is_worker_core)
+			);
+		if (worker_cores.empty()) worker_cores = indices_of(cores | std::views::filter(is_worker_core));
+
+		const auto worker_count = std::max(config.worker_count.value_or(uint32_t(worker_cores.size())), 1u);
+
+		// Nothing excluded, leave the workers to the OS scheduler
+		if (worker_cores.size() == cores.size()) worker_cores.clear();
+
+		return {
+			.worker_count = worker_count,
+			.worker_cores = std::move(worker_cores),
+			.render_core = render_core,
+		};
+	}
+}
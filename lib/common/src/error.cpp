@@ -3,14 +3,19 @@
 #include "common/formatter.hpp"
 #include "common/json.hpp"
 
+#include <cstdint>
 #include <exception>
 #include <format>
 #include <libassert/assert.hpp>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <source_location>
 #include <string>
+#include <string_view>
 #include <system_error>
+#include <tuple>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_to_string.hpp>  // Silent clang-tidy include cleaners
@@ -38,6 +43,23 @@ Error::Error(
 	)
 {}
 
+Error::Error(const Interned& interned) noexcept :
+	// Aliasing an empty owner, copies never touch a reference count
+	storage(std::shared_ptr<const Record>(), interned.storage.get())
+{
+	DEBUG_ASSERT(storage != nullptr);
+}
+
+Error::Interned::Interned(
+	std::string message,
+	std::optional<std::string> detail,
+	std::source_location location
+) noexcept :
+	storage(
+		std::make_shared<Record>(Record(std::move(message), std::move(detail), {}, location, nullptr))
+	)
+{}
+
 Error::Error(std::shared_ptr<const Record> storage) :
 	storage(std::move(storage))
 {
@@ -122,9 +144,40 @@ Json Error::to_json() const noexcept
 	};
 }
 
+namespace
+{
+	// Interned `vk::Result` errors, keyed by call site and result code
+	using InternKey = std::tuple<std::string_view, uint_least32_t, uint_least32_t, int32_t>;
+
+	std::mutex intern_mutex;
+	std::map<InternKey, std::unique_ptr<const Error::Interned>> interned_results;
+}
+
 template <>
 Error Error::from(const vk::Result& e, Json diagnostics, std::source_location location) noexcept
 {
+	// Diagnostics are specific to the failure, only plain results are interned
+	if (diagnostics.is_null())
+	{
+		const auto key = InternKey(
+			location.file_name(),
+			location.line(),
+			location.column(),
+			static_cast<int32_t>(e)
+		);
+
+		const std::scoped_lock lock(intern_mutex);
+		auto& interned = interned_results[key];
+		if (interned == nullptr)
+			interned = std::make_unique<const Interned>(
+				"Vulkan-related error occurred",
+				std::format("Error code: {}", e),
+				location
+			);
+
+		return Error(*interned);
+	}
+
 	return Error(
 		"Vulkan-related error occurred",
 		std::format("Error code: {}", e),
@@ -0,0 +1,55 @@
+#include "common/util/hash.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace util
+{
+	// Multipliers and finalizer borrowed from the MurmurHash3/SplitMix64 family
+	static constexpr uint64_t MULTIPLIER_0 = 0x9E3779B97F4A7C15;
+	static constexpr uint64_t MULTIPLIER_1 = 0xBF58476D1CE4E5B9;
+	static constexpr uint64_t MULTIPLIER_2 = 0x94D049BB133111EB;
+
+	static uint64_t mix(uint64_t state, uint64_t word) noexcept
+	{
+		state ^= word * MULTIPLIER_1;
+		state = std::rotl(state, 31) * MULTIPLIER_0;
+		return state;
+	}
+
+	static uint64_t finalize(uint64_t state) noexcept
+	{
+		state ^= state >> 30;
+		state *= MULTIPLIER_1;
+		state ^= state >> 27;
+		state *= MULTIPLIER_2;
+		state ^= state >> 31;
+		return state;
+	}
+
+	uint64_t hash_bytes(std::span<const std::byte> data, uint64_t seed) noexcept
+	{
+		uint64_t state = seed ^ (data.size() * MULTIPLIER_0);
+
+		const auto word_count = data.size() / sizeof(uint64_t);
+		for (size_t i = 0; i < word_count; i++)
+		{
+			uint64_t word;
+			std::memcpy(&word, data.data() + i * sizeof(uint64_t), sizeof(uint64_t));
+			state = mix(state, word);
+		}
+
+		// Tail bytes, zero-padded into a single word
+		if (const auto tail = data.subspan(word_count * sizeof(uint64_t)); !tail.empty())
+		{
+			uint64_t word = 0;
+			std::memcpy(&word, tail.data(), tail.size());
+			state = mix(state, word);
+		}
+
+		return finalize(state);
+	}
+}
@@ -0,0 +1,243 @@
+#include "common/util/scheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <utility>
+
+namespace util
+{
+	namespace
+	{
+		// Worker running on the calling thread, null if not a worker
+		thread_local const Scheduler* current_scheduler = nullptr;
+		thread_local size_t current_worker_index = 0;
+
+		constexpr size_t BACKGROUND_LANE = static_cast<size_t>(Scheduler::Priority::Background);
+	}
+
+	Scheduler::Scheduler(size_t worker_count)
+	{
+		worker_count = std::max<size_t>(worker_count, 1);
+		background_limit = std::max<size_t>(worker_count - 1, 1);
+
+		workers.reserve(worker_count);
+		for (size_t idx = 0; idx < worker_count; idx++) workers.push_back(std::make_unique<Worker>());
+
+		// Started after all workers exist, as they steal from each other
+		for (size_t idx = 0; idx < worker_count; idx++)
+			workers[idx]->thread = std::jthread([this, idx] { worker_loop(idx); });
+	}
+
+	Scheduler::~Scheduler() noexcept
+	{
+		{
+			const std::lock_guard lock(sleep_mutex);
+			stopping.store(true);
+		}
+		sleep_cv.notify_all();
+
+		for (const auto& worker : workers) worker->thread.join();
+	}
+
+	void Scheduler::submit(Priority priority, Job job)
+	{
+		const auto lane = static_cast<size_t>(priority);
+
+		if (in_worker())
+		{
+			auto& worker = *workers[current_worker_index];
+			const std::lock_guard lock(worker.mutex);
+			worker.lanes[lane].push_back(std::move(job));
+		}
+		else
+		{
+			const std::lock_guard lock(injection_mutex);
+			injection_lanes[lane].push_back(std::move(job));
+		}
+
+		pending[lane].fetch_add(1);
+		wake_one();
+	}
+
+	bool Scheduler::in_worker() const noexcept
+	{
+		return current_scheduler == this;
+	}
+
+	void Scheduler::worker_loop(size_t index) noexcept
+	{
+		current_scheduler = this;
+		current_worker_index = index;
+
+		while (true)
+		{
+			if (auto job = take_job(index))
+			{
+				auto& [func, priority] = *job;
+				func();
+
+				if (priority == Priority::Background)
+				{
+					// Frees a slot for another background job
+					running_background.fetch_sub(1);
+					if (pending[BACKGROUND_LANE].load() > 0) wake_one();
+				}
+
+				// Sleeping workers exit once the last job is done
+				if (stopping.load())
+				{
+					{
+						const std::lock_guard lock(sleep_mutex);
+					}
+					sleep_cv.notify_all();
+				}
+
+				continue;
+			}
+
+			// Remaining jobs are drained before exiting
+			const auto drained = [this] {
+				return stopping.load()
+					&& std::ranges::all_of(pending, [](const auto& count) { return count.load() == 0; });
+			};
+
+			std::unique_lock lock(sleep_mutex);
+			sleeping.fetch_add(1);
+			sleep_cv.wait(lock, [&] { return has_available_job() || drained(); });
+			sleeping.fetch_sub(1);
+
+			if (drained()) return;
+		}
+	}
+
+	std::optional<std::pair<Scheduler::Job, Scheduler::Priority>> Scheduler::take_job(size_t index) noexcept
+	{
+		const auto pop_front = [](std::mutex& mutex, std::deque<Job>& lane) -> std::optional<Job> {
+			const std::lock_guard lock(mutex);
+			if (lane.empty()) return std::nullopt;
+
+			auto job = std::move(lane.front());
+			lane.pop_front();
+			return job;
+		};
+
+		for (const auto lane : std::views::iota(0zu, PRIORITY_COUNT))
+		{
+			if (pending[lane].load() == 0) continue;
+
+			// Reserve a background slot before taking, released if nothing is found
+			if (lane == BACKGROUND_LANE)
+			{
+				auto running = running_background.load();
+				while (running < background_limit
+					   && !running_background.compare_exchange_weak(running, running + 1));
+
+				if (running >= background_limit) continue;
+			}
+
+			auto job = [&] -> std::optional<Job> {
+				// Own deque, newest first
+				{
+					auto& worker = *workers[index];
+					const std::lock_guard lock(worker.mutex);
+					if (!worker.lanes[lane].empty())
+					{
+						auto job = std::move(worker.lanes[lane].back());
+						worker.lanes[lane].pop_back();
+						return job;
+					}
+				}
+
+				if (auto job = pop_front(injection_mutex, injection_lanes[lane])) return job;
+
+				// Steal from the others, oldest first
+				for (const auto offset : std::views::iota(1zu, workers.size()))
+				{
+					auto& victim = *workers[(index + offset) % workers.size()];
+					if (auto job = pop_front(victim.mutex, victim.lanes[lane])) return job;
+				}
+
+				return std::nullopt;
+			}();
+
+			if (job.has_value())
+			{
+				pending[lane].fetch_sub(1);
+				return std::pair(std::move(*job), static_cast<Priority>(lane));
+			}
+
+			if (lane == BACKGROUND_LANE) running_background.fetch_sub(1);
+		}
+
+		return std::nullopt;
+	}
+
+	bool Scheduler::has_available_job() const noexcept
+	{
+		for (const auto lane : std::views::iota(0zu, PRIORITY_COUNT))
+		{
+			if (pending[lane].load() == 0) continue;
+			if (lane != BACKGROUND_LANE || running_background.load() < background_limit) return true;
+		}
+
+		return false;
+	}
+
+	void Scheduler::wake_one() noexcept
+	{
+		// Pairs with the increment of `sleeping` in `worker_loop`, no wakeup is lost as both are sequentially
+		// consistent and the predicate is checked under the lock
+		if (sleeping.load() == 0) return;
+
+		{
+			const std::lock_guard lock(sleep_mutex);
+		}
+		sleep_cv.notify_one();
+	}
+
+	void Scheduler::run_chunks(
+		Priority priority,
+		size_t chunk_count,
+		const std::function<void(size_t)>& chunk_func
+	)
+	{
+		struct ChunkState
+		{
+			std::atomic<size_t> next = 0;
+			std::atomic<size_t> done = 0;
+			size_t count;
+			const std::function<void(size_t)>* func;  // Only accessed while chunks remain
+		};
+
+		const auto state = std::make_shared<ChunkState>();
+		state->count = chunk_count;
+		state->func = &chunk_func;
+
+		const auto run = [](ChunkState& state) {
+			for (auto chunk = state.next.fetch_add(1); chunk < state.count; chunk = state.next.fetch_add(1))
+			{
+				(*state.func)(chunk);
+				if (state.done.fetch_add(1, std::memory_order_acq_rel) + 1 == state.count)
+					state.done.notify_all();
+			}
+		};
+
+		// Helpers arriving after the last chunk is claimed return immediately, the caller may be gone by then
+		const auto helper_count = std::min(chunk_count - 1, workers.size());
+		for ([[maybe_unused]] const auto _ : std::views::iota(0zu, helper_count))
+			submit(priority, [state, run] { run(*state); });
+
+		run(*state);
+
+		for (auto done = state->done.load(std::memory_order_acquire); done < chunk_count;
+			 done = state->done.load(std::memory_order_acquire))
+			state->done.wait(done, std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,120 @@
+#include "common/util/trace.hpp"
+#include "common/file.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "common/util/mpsc-queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+namespace util::trace
+{
+	namespace
+	{
+		struct Event
+		{
+			const char* name;
+			std::optional<uint64_t> index;
+			std::chrono::steady_clock::time_point begin_time;
+			std::chrono::steady_clock::time_point end_time;
+			uint32_t thread_id;
+		};
+
+		std::atomic<bool> is_recording = false;
+		std::atomic<std::chrono::steady_clock::rep> origin_ticks = 0;  // Start of the recording
+		MpscQueue<Event> events;
+
+		std::atomic<uint32_t> next_thread_id = 0;
+
+		// Sequential ID of the calling thread, assigned on first use
+		uint32_t get_thread_id() noexcept
+		{
+			thread_local const auto thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+			return thread_id;
+		}
+
+		// Microseconds since the start of the recording, unit of Chrome trace timestamps
+		double to_microseconds(std::chrono::steady_clock::duration duration) noexcept
+		{
+			return std::chrono::duration<double, std::micro>(duration).count();
+		}
+	}
+
+	void start() noexcept
+	{
+		is_recording.store(false, std::memory_order_relaxed);
+		std::ignore = events.take_all();
+
+		origin_ticks.store(
+			std::chrono::steady_clock::now().time_since_epoch().count(),
+			std::memory_order_relaxed
+		);
+		is_recording.store(true, std::memory_order_release);
+	}
+
+	bool recording() noexcept
+	{
+		return is_recording.load(std::memory_order_acquire);
+	}
+
+	std::expected<void, Error> stop_and_write(const std::filesystem::path& path) noexcept
+	{
+		is_recording.store(false, std::memory_order_relaxed);
+
+		const auto origin = std::chrono::steady_clock::time_point(
+			std::chrono::steady_clock::duration(origin_ticks.load(std::memory_order_relaxed))
+		);
+
+		auto trace_events = Json::array();
+		for (const auto& event : events.take_all())
+		{
+			auto json_event = Json{
+				{"name", event.name},
+				{"cat", "load"},
+				{"ph", "X"},
+				{"ts", to_microseconds(event.begin_time - origin)},
+				{"dur", to_microseconds(event.end_time - event.begin_time)},
+				{"pid", 0},
+				{"tid", event.thread_id},
+			};
+			if (event.index.has_value()) json_event["args"] = {{"index", *event.index}};
+
+			trace_events.push_back(std::move(json_event));
+		}
+
+		const auto content = Json{{"traceEvents", std::move(trace_events)}}.dump();
+		if (auto result = file::write(path, content); !result)
+			return result.error().forward("Write trace file failed");
+
+		return {};
+	}
+
+	Scope::Scope(const char* name, std::optional<uint64_t> index) noexcept :
+		name(name),
+		index(index)
+	{
+		if (!recording()) return;
+
+		begin_time = std::chrono::steady_clock::now();
+		thread_id = get_thread_id();
+	}
+
+	Scope::~Scope() noexcept
+	{
+		if (!begin_time.has_value()) return;
+
+		events.push({
+			.name = name,
+			.index = index,
+			.begin_time = *begin_time,
+			.end_time = std::chrono::steady_clock::now(),
+			.thread_id = thread_id,
+		});
+	}
+}
@@ -0,0 +1,106 @@
+#include "common/util/arena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <memory_resource>
+#include <vector>
+
+TEST_CASE("Import arena")
+{
+	constexpr auto HUGE_PAGE_SIZE = util::ImportArena::HUGE_PAGE_SIZE;
+
+	SUBCASE("Large blocks are huge page aligned")
+	{
+		auto arena = util::ImportArena();
+
+		auto* const pointer = arena.allocate(HUGE_PAGE_SIZE + 1, alignof(std::max_align_t));
+		CHECK(reinterpret_cast<uintptr_t>(pointer) % HUGE_PAGE_SIZE == 0);
+		CHECK(arena.stat().mapped_bytes == 2 * HUGE_PAGE_SIZE);
+
+		// Whole block is writable
+		static_cast<std::byte*>(pointer)[2 * HUGE_PAGE_SIZE - 1] = std::byte(1);
+
+		arena.deallocate(pointer, HUGE_PAGE_SIZE + 1, alignof(std::max_align_t));
+		CHECK(arena.stat().cached_bytes == 2 * HUGE_PAGE_SIZE);
+	}
+
+	SUBCASE("Freed blocks are reused")
+	{
+		auto arena = util::ImportArena();
+
+		auto* const first = arena.allocate(3 * HUGE_PAGE_SIZE, 16);
+		arena.deallocate(first, 3 * HUGE_PAGE_SIZE, 16);
+
+		auto* const second = arena.allocate(2 * HUGE_PAGE_SIZE, 16);
+		CHECK(second == first);
+		CHECK(arena.stat().mapped_bytes == 3 * HUGE_PAGE_SIZE);
+		CHECK(arena.stat().cached_bytes == 0);
+
+		arena.deallocate(second, 2 * HUGE_PAGE_SIZE, 16);
+	}
+
+	SUBCASE("Blocks much larger than the request are not reused")
+	{
+		auto arena = util::ImportArena();
+
+		auto* const large = arena.allocate(8 * HUGE_PAGE_SIZE, 16);
+		arena.deallocate(large, 8 * HUGE_PAGE_SIZE, 16);
+
+		auto* const small = arena.allocate(HUGE_PAGE_SIZE, 16);
+		CHECK(small != large);
+
+		arena.deallocate(small, HUGE_PAGE_SIZE, 16);
+	}
+
+	SUBCASE("Trim and cache limit")
+	{
+		auto arena = util::ImportArena(HUGE_PAGE_SIZE / 2, HUGE_PAGE_SIZE);
+
+		auto* const first = arena.allocate(HUGE_PAGE_SIZE, 16);
+		auto* const second = arena.allocate(HUGE_PAGE_SIZE, 16);
+		arena.deallocate(first, HUGE_PAGE_SIZE, 16);
+		arena.deallocate(second, HUGE_PAGE_SIZE, 16);
+
+		// Second block exceeds the cache limit
+		CHECK(arena.stat().cached_bytes == HUGE_PAGE_SIZE);
+		CHECK(arena.stat().mapped_bytes == HUGE_PAGE_SIZE);
+
+		arena.trim();
+		CHECK(arena.stat().cached_bytes == 0);
+		CHECK(arena.stat().mapped_bytes == 0);
+	}
+
+	SUBCASE("Small requests go upstream")
+	{
+		auto upstream = std::pmr::monotonic_buffer_resource();
+		auto arena = util::ImportArena(HUGE_PAGE_SIZE / 2, HUGE_PAGE_SIZE, upstream);
+
+		auto* const pointer = arena.allocate(64, 8);
+		CHECK(pointer != nullptr);
+		CHECK(arena.stat().mapped_bytes == 0);
+
+		arena.deallocate(pointer, 64, 8);
+	}
+}
+
+TEST_CASE("Scratch vector")
+{
+	auto arena = util::ImportArena();
+
+	auto values = util::ScratchVector<uint32_t>(&arena);
+	values.resize(util::ImportArena::HUGE_PAGE_SIZE / sizeof(uint32_t));
+	values.back() = 7;
+	CHECK(values.get_allocator().resource() == &arena);
+	CHECK(arena.stat().mapped_bytes == util::ImportArena::HUGE_PAGE_SIZE);
+
+	// Construction with a value still initializes
+	auto filled = util::ScratchVector<uint32_t>(16, 3, &arena);
+	CHECK(filled.front() == 3);
+	CHECK(filled.back() == 3);
+
+	// Copies use the default resource
+	const auto copy = filled;
+	CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+	CHECK(copy == filled);
+}
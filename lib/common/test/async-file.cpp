@@ -0,0 +1,134 @@
+#include "common/async-file.hpp"
+#include "common/file.hpp"
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <doctest.h>
+#include <filesystem>
+#include <iterator>
+#include <latch>
+#include <limits>
+#include <optional>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// Minimal eagerly started coroutine, stands in for `coro::task`
+	struct DetachedTask
+	{
+		struct promise_type
+		{
+			DetachedTask get_return_object() noexcept { return {}; }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept {}
+		};
+	};
+
+	DetachedTask await_read(
+		file::AsyncReader::ReadAwaitable awaitable,
+		std::optional<file::AsyncReader::Result>& result,
+		std::latch& done
+	)
+	{
+		result = co_await std::move(awaitable);
+		done.count_down();
+	}
+
+	// Run a read to completion on the calling thread
+	file::AsyncReader::Result wait(file::AsyncReader::ReadAwaitable awaitable)
+	{
+		std::optional<file::AsyncReader::Result> result;
+		std::latch done(1);
+		await_read(std::move(awaitable), result, done);
+		done.wait();
+
+		return std::move(*result);
+	}
+
+	bool equal(std::span<const std::byte> span, std::span<const uint8_t> expected)
+	{
+		const auto to_u8 = [](std::byte value) {
+			return static_cast<uint8_t>(value);
+		};
+		return std::ranges::equal(span, expected, {}, to_u8);
+	}
+}
+
+TEST_CASE("Async read")
+{
+	/* Generate Random Data */
+
+	std::mt19937_64 rng(114514);  // NOLINT
+	std::uniform_int_distribution<uint16_t> dist(0, std::numeric_limits<uint8_t>::max());
+
+	// Not a multiple of the chunk size nor the alignment
+	std::vector<uint8_t> random_data;
+	random_data.reserve(300007);
+	std::generate_n(std::back_inserter(random_data), 300007, [&rng, &dist]() { return dist(rng); });
+
+	const auto env = std::getenv("TEMP_DIR");
+	REQUIRE(env != nullptr);
+
+	const auto temp_file = std::filesystem::path(env) / "lib.common-async-file-test.bin";
+	REQUIRE(file::write(temp_file, random_data));
+
+	/* Read */
+
+	auto reader_result = file::AsyncReader::create({.queue_depth = 4, .chunk_size = 16384});
+	REQUIRE(reader_result);
+	auto& reader = *reader_result;
+
+	SUBCASE("Whole file")
+	{
+		const auto result = wait(reader.read(temp_file));
+		REQUIRE(result);
+		CHECK(equal(result->span(), random_data));
+	}
+
+	SUBCASE("Range")
+	{
+		const auto result = wait(reader.read_range(temp_file, 12345, 100000));
+		REQUIRE(result);
+		CHECK(equal(result->span(), std::span(random_data).subspan(12345, 100000)));
+	}
+
+	SUBCASE("Direct I/O")
+	{
+		auto direct_reader_result =
+			file::AsyncReader::create({.queue_depth = 4, .chunk_size = 16384, .direct_io_threshold = 1});
+		REQUIRE(direct_reader_result);
+
+		const auto result = wait(
+			direct_reader_result->read_range(temp_file, 777, 200000, file::AsyncReader::Hint::Sequential)
+		);
+		REQUIRE(result);
+		CHECK(equal(result->span(), std::span(random_data).subspan(777, 200000)));
+	}
+
+	SUBCASE("Concurrent reads")
+	{
+		std::vector<std::optional<file::AsyncReader::Result>> results(8);
+		std::latch done(static_cast<std::ptrdiff_t>(results.size()));
+		for (auto& result : results) await_read(reader.read(temp_file), result, done);
+		done.wait();
+
+		CHECK(std::ranges::all_of(results, [&random_data](const auto& result) {
+			return result.has_value() && result->has_value() && equal((*result)->span(), random_data);
+		}));
+	}
+
+	SUBCASE("Errors")
+	{
+		CHECK_FALSE(wait(reader.read(temp_file.string() + ".missing")));
+		CHECK_FALSE(wait(reader.read(temp_file, file::AsyncReader::Hint::Sequential, 1024)));
+		CHECK_FALSE(wait(reader.read_range(temp_file, 300000, 100)));
+	}
+}
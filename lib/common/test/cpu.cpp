@@ -0,0 +1,114 @@
+#include "common/util/cpu.hpp"
+
+#include <cstdint>
+#include <doctest.h>
+#include <optional>
+#include <vector>
+
+using util::cpu::Affinity;
+using util::cpu::CoreType;
+using util::cpu::LogicalCore;
+
+TEST_CASE("Parse CPU list")
+{
+	SUBCASE("Ranges and singles")
+	{
+		CHECK(util::cpu::parse_cpu_list("0-3,8,10-11\n") == std::vector<uint32_t>{0, 1, 2, 3, 8, 10, 11});
+	}
+
+	SUBCASE("Unordered and overlapping")
+	{
+		CHECK(util::cpu::parse_cpu_list("4-5,0,4") == std::vector<uint32_t>{0, 4, 5});
+	}
+
+	SUBCASE("Empty list")
+	{
+		CHECK(util::cpu::parse_cpu_list("\n") == std::vector<uint32_t>{});
+	}
+
+	SUBCASE("Malformed")
+	{
+		CHECK_FALSE(util::cpu::parse_cpu_list("0-").has_value());
+		CHECK_FALSE(util::cpu::parse_cpu_list("3-1").has_value());
+		CHECK_FALSE(util::cpu::parse_cpu_list("a,1").has_value());
+	}
+}
+
+TEST_CASE("Query cores")
+{
+	const auto cores = util::cpu::query_cores();
+	REQUIRE_FALSE(cores.empty());
+
+	for (size_t i = 1; i < cores.size(); i++) CHECK(cores[i - 1].index < cores[i].index);
+}
+
+TEST_CASE("Plan thread pool")
+{
+	// 4 P-cores followed by 4 E-cores
+	std::vector<LogicalCore> hybrid;
+	for (uint32_t i = 0; i < 8; i++)
+		hybrid.push_back({.index = i, .type = i < 4 ? CoreType::Performance : CoreType::Efficiency});
+
+	std::vector<LogicalCore> symmetric;
+	for (uint32_t i = 0; i < 4; i++) symmetric.push_back({.index = i, .type = CoreType::Performance});
+
+	SUBCASE("Performance cores only")
+	{
+		const auto layout = util::cpu::plan_pool(hybrid, {.affinity = Affinity::Performance});
+		CHECK(layout.worker_count == 4);
+		CHECK(layout.worker_cores == std::vector<uint32_t>{0, 1, 2, 3});
+		CHECK_FALSE(layout.render_core.has_value());
+	}
+
+	SUBCASE("Reserved render core")
+	{
+		const auto layout =
+			util::cpu::plan_pool(hybrid, {.affinity = Affinity::Performance, .reserve_render_core = true});
+		CHECK(layout.render_core == std::optional<uint32_t>(3));
+		CHECK(layout.worker_count == 3);
+		CHECK(layout.worker_cores == std::vector<uint32_t>{0, 1, 2});
+	}
+
+	SUBCASE("Any core with reserved render core")
+	{
+		const auto layout =
+			util::cpu::plan_pool(hybrid, {.affinity = Affinity::Any, .reserve_render_core = true});
+		CHECK(layout.render_core == std::optional<uint32_t>(3));
+		CHECK(layout.worker_cores == std::vector<uint32_t>{0, 1, 2, 4, 5, 6, 7});
+	}
+
+	SUBCASE("Symmetric cores stay unpinned")
+	{
+		const auto layout = util::cpu::plan_pool(symmetric, {.affinity = Affinity::Performance});
+		CHECK(layout.worker_count == 4);
+		CHECK(layout.worker_cores.empty());
+	}
+
+	SUBCASE("Explicit worker count")
+	{
+		const auto layout = util::cpu::plan_pool(symmetric, {.worker_count = 16});
+		CHECK(layout.worker_count == 16);
+	}
+
+	SUBCASE("Single core is never reserved")
+	{
+		const auto layout = util::cpu::plan_pool(
+			std::vector<LogicalCore>{{.index = 0, .type = CoreType::Performance}},
+			{.reserve_render_core = true}
+		);
+		CHECK_FALSE(layout.render_core.has_value());
+		CHECK(layout.worker_count == 1);
+		CHECK(layout.worker_cores.empty());
+	}
+
+	SUBCASE("Falls back without matching cores")
+	{
+		std::vector<LogicalCore> efficiency_only;
+		for (uint32_t i = 0; i < 2; i++)
+			efficiency_only.push_back({.index = i, .type = CoreType::Efficiency});
+
+		const auto layout = util::cpu::plan_pool(efficiency_only, {.affinity = Affinity::Performance});
+		CHECK(layout.worker_count == 2);
+		CHECK(layout.worker_cores.empty());
+	}
+}
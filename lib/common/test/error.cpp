@@ -55,6 +55,23 @@ Error Error::from(const FooStruct&, Json diagnostics, std::source_location locat
 	return Error("FooStruct error", std::nullopt, std::move(diagnostics), location);
 }
 
+TEST_CASE("Interned error")
+{
+	static const Error::Interned interned("Interned error", "Shared detail");
+
+	const auto first = Error(interned);
+	const auto second = Error(interned);
+
+	CHECK_EQ(first->message, "Interned error");
+	CHECK_EQ(first->detail, "Shared detail");
+	CHECK_EQ(first.operator->(), second.operator->());
+
+	const auto forwarded = first.forward("Forwarded");
+	REQUIRE(forwarded.next().has_value());
+	CHECK_EQ(forwarded.next()->operator->(), first.operator->());
+	CHECK_FALSE(first.next().has_value());
+}
+
 TEST_CASE("Error::from")
 {
 	SUBCASE("vk::Result")
@@ -63,6 +80,21 @@ TEST_CASE("Error::from")
 		const auto err = Error::from(vk_res);
 	}
 
+	SUBCASE("vk::Result interned per call site")
+	{
+		const auto make = [](vk::Result result) {
+			return Error::from(result);
+		};
+
+		const auto first = make(vk::Result::eErrorOutOfDateKHR);
+		const auto second = make(vk::Result::eErrorOutOfDateKHR);
+		const auto other = make(vk::Result::eErrorDeviceLost);
+
+		CHECK_EQ(first.operator->(), second.operator->());
+		CHECK_NE(first.operator->(), other.operator->());
+		CHECK_EQ(first->detail, std::format("Error code: {}", vk::Result::eErrorOutOfDateKHR));
+	}
+
 	SUBCASE("Custom type specialization")
 	{
 		Json diagnostics = {
@@ -0,0 +1,52 @@
+#include "common/util/hash.hpp"
+#include "common/util/span.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <numeric>
+#include <vector>
+
+TEST_CASE("Hash bytes")
+{
+	std::vector<uint8_t> data(37);
+	std::iota(data.begin(), data.end(), uint8_t(0));
+	const auto bytes = util::as_bytes(data);
+
+	SUBCASE("Deterministic")
+	{
+		CHECK(util::hash_bytes(bytes) == util::hash_bytes(bytes));
+	}
+
+	SUBCASE("Sensitive to content")
+	{
+		auto modified = data;
+		modified[35] ^= 1;
+		CHECK(util::hash_bytes(bytes) != util::hash_bytes(util::as_bytes(modified)));
+	}
+
+	SUBCASE("Sensitive to length")
+	{
+		// Zero-padded tail must not collide with explicit zeros
+		auto extended = data;
+		extended.push_back(0);
+		CHECK(util::hash_bytes(bytes) != util::hash_bytes(util::as_bytes(extended)));
+	}
+
+	SUBCASE("Sensitive to seed")
+	{
+		CHECK(util::hash_bytes(bytes, 1) != util::hash_bytes(bytes, 2));
+	}
+
+	SUBCASE("Empty input")
+	{
+		CHECK(util::hash_bytes({}) == util::hash_bytes({}));
+		CHECK(util::hash_bytes({}, 1) != util::hash_bytes({}, 2));
+	}
+}
+
+TEST_CASE("Hash object")
+{
+	const uint64_t value = 0x0123456789ABCDEF;
+	CHECK(util::hash_object(value) == util::hash_bytes(util::object_as_bytes(value)));
+}
@@ -0,0 +1,81 @@
+#include "common/util/mpsc-queue.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <doctest.h>
+#include <memory>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Push and take")
+{
+	util::MpscQueue<int> queue;
+	CHECK(queue.empty());
+
+	queue.push(1);
+	queue.push(2);
+	queue.push(3);
+	CHECK_FALSE(queue.empty());
+
+	CHECK_EQ(queue.take_all(), std::vector{1, 2, 3});
+	CHECK(queue.empty());
+	CHECK(queue.take_all().empty());
+}
+
+TEST_CASE("Move-only items")
+{
+	util::MpscQueue<std::unique_ptr<int>> queue;
+	queue.push(std::make_unique<int>(42));
+
+	const auto items = queue.take_all();
+	REQUIRE_EQ(items.size(), 1);
+	CHECK_EQ(*items[0], 42);
+}
+
+TEST_CASE("Destroyed with items")
+{
+	const auto item = std::make_shared<int>(0);
+
+	{
+		util::MpscQueue<std::shared_ptr<int>> queue;
+		queue.push(item);
+		queue.push(item);
+		CHECK_EQ(item.use_count(), 3);
+	}
+
+	CHECK_EQ(item.use_count(), 1);
+}
+
+TEST_CASE("Concurrent producers")
+{
+	constexpr size_t PRODUCER_COUNT = 8;
+	constexpr size_t ITEMS_PER_PRODUCER = 10000;
+
+	util::MpscQueue<size_t> queue;
+	std::vector<size_t> taken;
+
+	{
+		std::vector<std::jthread> producers;
+		for (const auto producer : std::views::iota(0zu, PRODUCER_COUNT))
+			producers.emplace_back([&queue, producer] {
+				for (const auto i : std::views::iota(0zu, ITEMS_PER_PRODUCER))
+					queue.push(producer * ITEMS_PER_PRODUCER + i);
+			});
+
+		// Consume concurrently with the producers
+		while (taken.size() < PRODUCER_COUNT * ITEMS_PER_PRODUCER) taken.append_range(queue.take_all());
+	}
+
+	// Items of the same producer keep their order
+	for (const auto producer : std::views::iota(0zu, PRODUCER_COUNT))
+	{
+		const auto own = taken | std::views::filter([producer](size_t item) {
+							 return item / ITEMS_PER_PRODUCER == producer;
+						 });
+		CHECK(std::ranges::is_sorted(own));
+	}
+
+	std::ranges::sort(taken);
+	CHECK(std::ranges::equal(taken, std::views::iota(0zu, PRODUCER_COUNT * ITEMS_PER_PRODUCER)));
+}
@@ -0,0 +1,139 @@
+#include "common/util/scheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <doctest.h>
+#include <latch>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+using Priority = util::Scheduler::Priority;
+
+namespace
+{
+	// Minimal eagerly started coroutine, stands in for `coro::task`
+	struct DetachedTask
+	{
+		struct promise_type
+		{
+			DetachedTask get_return_object() noexcept { return {}; }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept {}
+		};
+	};
+
+	DetachedTask resume_on_worker(
+		util::Scheduler& scheduler,
+		std::optional<bool>& in_worker,
+		std::latch& done
+	)
+	{
+		co_await scheduler.schedule(Priority::Streaming);
+		in_worker = scheduler.in_worker();
+		done.count_down();
+	}
+}
+
+TEST_CASE("Submit jobs of all priorities")
+{
+	std::atomic<size_t> count = 0;
+
+	{
+		util::Scheduler scheduler(4);
+		CHECK_EQ(scheduler.get_worker_count(), 4);
+		CHECK_FALSE(scheduler.in_worker());
+
+		for (const auto idx : std::views::iota(0zu, 1000zu))
+			scheduler.submit(static_cast<Priority>(idx % util::Scheduler::PRIORITY_COUNT), [&count] {
+				count.fetch_add(1);
+			});
+	}
+
+	// Destruction drains the remaining jobs
+	CHECK_EQ(count.load(), 1000);
+}
+
+TEST_CASE("Parallel for")
+{
+	util::Scheduler scheduler(4);
+
+	std::vector<size_t> values(10007);
+	std::iota(values.begin(), values.end(), 0);
+
+	SUBCASE("Visits every element once")
+	{
+		std::vector<std::atomic<size_t>> visits(values.size());
+		const auto visit = [&visits](size_t value) {
+			visits[value].fetch_add(1);
+		};
+		scheduler.parallel_for(Priority::Frame, values, visit, 13);
+
+		CHECK(std::ranges::all_of(visits, [](const auto& count) { return count.load() == 1; }));
+	}
+
+	SUBCASE("Nested in a job")
+	{
+		std::atomic<size_t> sum = 0;
+		std::latch done(1);
+
+		scheduler.submit(Priority::Background, [&] {
+			const auto add = [&sum](size_t value) {
+				sum.fetch_add(value);
+			};
+			scheduler.parallel_for(Priority::Background, values, add);
+			done.count_down();
+		});
+
+		done.wait();
+		CHECK_EQ(sum.load(), values.size() * (values.size() - 1) / 2);
+	}
+
+	SUBCASE("Empty range")
+	{
+		const std::vector<size_t> empty;
+		scheduler.parallel_for(Priority::Frame, empty, [](size_t) { FAIL("Called for empty range"); });
+	}
+}
+
+TEST_CASE("Frame jobs bypass background jobs")
+{
+	// Background jobs occupy at most one of the two workers
+	util::Scheduler scheduler(2);
+
+	std::counting_semaphore<2> release(0);
+	std::atomic<size_t> background_started = 0;
+
+	for ([[maybe_unused]] const auto _ : std::views::iota(0, 2))
+		scheduler.submit(Priority::Background, [&] {
+			background_started.fetch_add(1);
+			release.acquire();
+		});
+
+	std::latch frame_done(1);
+	scheduler.submit(Priority::Frame, [&frame_done] { frame_done.count_down(); });
+	frame_done.wait();
+
+	CHECK_LE(background_started.load(), 1);
+	release.release(2);
+}
+
+TEST_CASE("Schedule coroutine on worker")
+{
+	util::Scheduler scheduler(2);
+
+	std::optional<bool> in_worker;
+	std::latch done(1);
+	resume_on_worker(scheduler, in_worker, done);
+	done.wait();
+
+	REQUIRE(in_worker.has_value());
+	CHECK(*in_worker);
+}
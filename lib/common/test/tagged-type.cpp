@@ -1,8 +1,11 @@
 #include "common/util/tagged-type.hpp"
 
+#include <atomic>
 #include <concepts>
 #include <doctest.h>
 #include <memory>
+#include <ranges>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -126,3 +129,75 @@ TEST_CASE("EnumVariant move-only type")
 		CHECK_EQ(*val->get(), 7);
 	}
 }
+
+TEST_CASE("AtomicEnumVariant")
+{
+	enum class Stage
+	{
+		Preparing,
+		Counting,
+		Nested,
+	};
+
+	using Inner = util::AtomicEnumVariant<util::Tag<Stage::Preparing>, util::Tag<Stage::Counting, int>>;
+	using Outer = util::AtomicEnumVariant<
+		util::Tag<Stage::Preparing>,
+		util::Tag<Stage::Counting, int>,
+		util::Tag<Stage::Nested, std::shared_ptr<const Inner>>
+	>;
+
+	auto progress = Outer::from<Stage::Preparing>();
+	CHECK_EQ(progress.tag(), Stage::Preparing);
+	CHECK_EQ(progress.index(), 0);
+	CHECK_EQ(progress.tag_count(), 3);
+
+	SUBCASE("set and get")
+	{
+		progress.set<Stage::Counting>(3);
+		CHECK_EQ(progress.tag(), Stage::Counting);
+		CHECK_EQ(progress.get<Stage::Counting>(), 3);
+		CHECK_FALSE(progress.get_if<Stage::Nested>().has_value());
+	}
+
+	SUBCASE("references outlive later writes")
+	{
+		progress.set<Stage::Counting>(1);
+		const auto& first = progress.load();
+
+		progress.set<Stage::Counting>(2);
+		CHECK_EQ(first.get<Stage::Counting>(), 1);
+		CHECK_EQ(progress.get<Stage::Counting>(), 2);
+	}
+
+	SUBCASE("nested")
+	{
+		auto inner = Inner::from<Stage::Preparing>().share();
+		progress.set<Stage::Nested>(inner);
+		inner->set<Stage::Counting>(5);
+
+		const auto visited = progress.visit([]<auto e, typename T>(const util::Tag<e, T>& value) {
+			if constexpr (e == Stage::Nested)
+				return value.value->template get<Stage::Counting>();
+			else
+				return -1;
+		});
+		CHECK_EQ(visited, 5);
+	}
+
+	SUBCASE("concurrent reads")
+	{
+		std::atomic<bool> done = false;
+		std::jthread reader([&] {
+			auto last = 0;
+			while (!done.load())
+				if (const auto value = progress.get_if<Stage::Counting>())
+				{
+					CHECK_GE(value->get(), last);
+					last = value->get();
+				}
+		});
+
+		for (const auto idx : std::views::iota(0, 1000)) progress.set<Stage::Counting>(idx);
+		done.store(true);
+	}
+}
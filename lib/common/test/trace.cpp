@@ -0,0 +1,110 @@
+#include "common/file.hpp"
+#include "common/json.hpp"
+#include "common/util/span.hpp"
+#include "common/util/trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <doctest.h>
+#include <filesystem>
+#include <ranges>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+static Json write_and_parse(const std::string& file_name)
+{
+	const auto env = std::getenv("TEMP_DIR");
+	REQUIRE(env != nullptr);
+
+	const auto temp_file = std::filesystem::path(env) / file_name;
+	REQUIRE(util::trace::stop_and_write(temp_file));
+	CHECK_FALSE(util::trace::recording());
+
+	const auto content = file::read(temp_file);
+	REQUIRE(content);
+
+	const auto bytes = util::as_bytes(*content);
+	auto json = Json::parse(
+		reinterpret_cast<const char*>(bytes.data()),
+		reinterpret_cast<const char*>(bytes.data() + bytes.size()),
+		nullptr,
+		false
+	);
+	REQUIRE_FALSE(json.is_discarded());
+	REQUIRE(json.contains("traceEvents"));
+	REQUIRE(json["traceEvents"].is_array());
+
+	return json["traceEvents"];
+}
+
+TEST_CASE("Events of scopes")
+{
+	util::trace::start();
+	CHECK(util::trace::recording());
+
+	{
+		const auto outer = util::trace::Scope("Outer");
+		const auto inner = util::trace::Scope("Inner", 7);
+	}
+
+	const auto events = write_and_parse("lib.common-trace-test-scope.json");
+	REQUIRE_EQ(events.size(), 2);
+
+	// Inner scope ends first
+	CHECK_EQ(events[0]["name"], "Inner");
+	CHECK_EQ(events[0]["ph"], "X");
+	CHECK_EQ(events[0]["args"]["index"], 7);
+	CHECK_EQ(events[1]["name"], "Outer");
+	CHECK_FALSE(events[1].contains("args"));
+
+	CHECK_GE(events[0]["ts"].get<double>(), events[1]["ts"].get<double>());
+	CHECK_LE(events[0]["dur"].get<double>(), events[1]["dur"].get<double>());
+	CHECK_EQ(events[0]["tid"], events[1]["tid"]);
+}
+
+TEST_CASE("Scopes outside of recording")
+{
+	{
+		const auto ignored = util::trace::Scope("Ignored");
+	}
+
+	util::trace::start();
+	{
+		const auto recorded = util::trace::Scope("Recorded");
+	}
+
+	const auto events = write_and_parse("lib.common-trace-test-recording.json");
+	REQUIRE_EQ(events.size(), 1);
+	CHECK_EQ(events[0]["name"], "Recorded");
+}
+
+TEST_CASE("Events from multiple threads")
+{
+	constexpr uint32_t thread_count = 4;
+	constexpr uint32_t events_per_thread = 100;
+
+	util::trace::start();
+	{
+		auto threads = std::views::iota(0u, thread_count)
+			| std::views::transform([](uint32_t) {
+				  return std::jthread([] {
+					  for (const auto i : std::views::iota(0u, events_per_thread))
+					  {
+						  const auto scope = util::trace::Scope("Work", i);
+					  }
+				  });
+			  })
+			| std::ranges::to<std::vector>();
+	}
+
+	const auto events = write_and_parse("lib.common-trace-test-threads.json");
+	CHECK_EQ(events.size(), thread_count * events_per_thread);
+
+	const auto thread_ids =
+		events | std::views::transform([](const Json& event) { return event["tid"].get<uint32_t>(); })
+		| std::ranges::to<std::set>();
+	CHECK_EQ(thread_ids.size(), thread_count);
+}
@@ -8,6 +8,18 @@ target("lib.common")
 	add_headerfiles("include/(**.hpp)")
 	add_packages("libassert", "nlohmann_json", "vulkan-hpp", {public = true})
 
+	-- Profiler macros of "common/util/profile.hpp" expand to Tracy zones, see option "tracy"
+	if has_config("tracy") then
+		add_packages("tracy", {public = true})
+		add_defines("TRACY_ENABLE", "TRACY_VK_USE_SYMBOL_TABLE", {public = true})
+	end
+
+	-- Backend of "common/async-file.hpp", see option "io_uring"
+	if is_plat("linux") and has_config("io_uring") then
+		add_packages("liburing")
+		add_defines("COMMON_IO_URING")
+	end
+
 target("lib.common.test")
 	set_kind("binary")
 	set_default(false)
@@ -0,0 +1,272 @@
+#define ANKERL_NANOBENCH_IMPLEMENT
+
+#include "common/file.hpp"
+#include "common/util/error.hpp"
+#include "image/bc-image.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "test-asset.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <format>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <iostream>
+#include <nanobench.h>
+#include <print>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using ImageType = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+
+// Square sizes of the source images, covering both sides of `BCnImage::PARALLEL_BLOCK_THRESHOLD`
+static constexpr auto IMAGE_SIZES = std::to_array<uint32_t>({256, 1024, 2048});
+
+static constexpr auto BCN_FORMATS = std::to_array<std::pair<image::BCnFormat, std::string_view>>({
+	{image::BCnFormat::BC3, "BC3"},
+	{image::BCnFormat::BC5, "BC5"},
+	{image::BCnFormat::BC7, "BC7"},
+});
+
+// Throughput of every benchmark is reported in megapixels of the source image per second
+static void set_pixel_count(ankerl::nanobench::Bench& bench, glm::u32vec2 size) noexcept
+{
+	bench.batch(static_cast<double>(size.x) * size.y / 1e6);
+}
+
+// Counts of concurrent encodes, from one up to the hardware concurrency
+static std::vector<uint32_t> get_thread_counts() noexcept
+{
+	const auto hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	auto counts = std::views::iota(0u, 4u)
+		| std::views::transform([hardware_threads](uint32_t shift) {
+			  return std::min(1u << shift, hardware_threads);
+		  })
+		| std::ranges::to<std::vector>();
+	counts.push_back(hardware_threads);
+
+	std::ranges::sort(counts);
+	const auto [first, last] = std::ranges::unique(counts);
+	counts.erase(first, last);
+
+	return counts;
+}
+
+// Source images of each size, resized from the bundled photo so that the content stays natural
+static std::expected<std::vector<ImageType>, Error> create_source_images() noexcept
+{
+	auto photo_result = ImageType::decode(complex_image_data);
+	if (!photo_result) return photo_result.error().forward("Decode source image failed");
+	const auto photo = std::move(*photo_result);
+
+	return IMAGE_SIZES
+		| std::views::transform([&photo](uint32_t size) { return photo.resize(glm::u32vec2(size)); })
+		| std::ranges::to<std::vector>();
+}
+
+static std::expected<void, Error> bench_decode(
+	ankerl::nanobench::Bench& bench,
+	std::span<const ImageType> sources
+) noexcept
+{
+	const auto encode_formats = std::to_array<std::pair<image::EncodeFormat, std::string_view>>({
+		{image::encode_format::Png{}, "PNG"},
+		{image::encode_format::Jpg{}, "JPG"},
+		{image::encode_format::Bmp{}, "BMP"},
+	});
+
+	bench.title("Decode");
+
+	for (const auto& source : sources)
+		for (const auto& [format, format_name] : encode_formats)
+		{
+			auto encoded_result = source.encode(format);
+			if (!encoded_result) return encoded_result.error().forward("Encode source image failed");
+			const auto encoded = std::move(*encoded_result);
+
+			set_pixel_count(bench, source.size);
+			bench.run(std::format("{} {}x{}", format_name, source.size.x, source.size.y), [&encoded] {
+				ankerl::nanobench::doNotOptimizeAway(ImageType::decode(encoded));
+			});
+
+			// Reduced decoding, as used when a texture is going to be downscaled anyway
+			const auto max_size = source.size.x / 4;
+			set_pixel_count(bench, source.size);
+			bench.run(
+				std::format("{} {}x{} (max {})", format_name, source.size.x, source.size.y, max_size),
+				[&encoded, max_size] {
+					ankerl::nanobench::doNotOptimizeAway(ImageType::decode(encoded, max_size));
+				}
+			);
+		}
+
+	return {};
+}
+
+static void bench_resize(ankerl::nanobench::Bench& bench, std::span<const ImageType> sources) noexcept
+{
+	bench.title("Resize");
+
+	for (const auto& source : sources)
+	{
+		for (const auto new_size : {source.size / 2u, source.size * 3u / 4u})
+		{
+			set_pixel_count(bench, source.size);
+			bench.run(
+				std::format("{}x{} to {}x{}", source.size.x, source.size.y, new_size.x, new_size.y),
+				[&source, new_size] { ankerl::nanobench::doNotOptimizeAway(source.resize(new_size)); }
+			);
+		}
+
+		// Non power-of-two source, rounded up
+		const auto unaligned = source.resize(source.size * 3u / 4u);
+		set_pixel_count(bench, unaligned.size);
+		bench.run(std::format("{}x{} to POT", unaligned.size.x, unaligned.size.y), [&unaligned] {
+			ankerl::nanobench::doNotOptimizeAway(unaligned.resize_to_pot(true));
+		});
+	}
+}
+
+static void bench_mipmap(ankerl::nanobench::Bench& bench, std::span<const ImageType> sources) noexcept
+{
+	bench.title("Mipmap");
+
+	for (const auto& source : sources)
+	{
+		set_pixel_count(bench, source.size);
+		bench.run(std::format("{}x{}", source.size.x, source.size.y), [&source] {
+			ankerl::nanobench::doNotOptimizeAway(source.generate_mipmap(0));
+		});
+	}
+}
+
+// Conversions run on every loaded texture, e.g. normal maps reduced to RG and alpha scanned for masking
+static void bench_convert(ankerl::nanobench::Bench& bench, std::span<const ImageType> sources) noexcept
+{
+	bench.title("Convert");
+
+	for (const auto& source : sources)
+	{
+		const auto source16 = source.convert<image::Format::Unorm16, image::Layout::RGBA>();
+		const auto size_name = std::format("{}x{}", source.size.x, source.size.y);
+
+		set_pixel_count(bench, source.size);
+		bench.run(std::format("RGBA8 to RG8 {}", size_name), [&source] {
+			ankerl::nanobench::doNotOptimizeAway(source.convert<image::Format::Unorm8, image::Layout::RG>());
+		});
+
+		set_pixel_count(bench, source.size);
+		bench.run(std::format("RGBA16 to RGBA8 {}", size_name), [&source16] {
+			ankerl::nanobench::doNotOptimizeAway(
+				source16.convert<image::Format::Unorm8, image::Layout::RGBA>()
+			);
+		});
+
+		set_pixel_count(bench, source.size);
+		bench.run(std::format("Min alpha {}", size_name), [&source] {
+			ankerl::nanobench::doNotOptimizeAway(source.min_alpha());
+		});
+	}
+}
+
+// Encode an image on each of the threads concurrently, as texture loading does
+static void encode_concurrently(
+	const ImageType& source,
+	image::BCnFormat format,
+	uint32_t thread_count
+) noexcept
+{
+	auto threads = std::views::iota(0u, thread_count)
+		| std::views::transform([&source, format](uint32_t) {
+			  return std::jthread([&source, format] {
+				  ankerl::nanobench::doNotOptimizeAway(image::BCnImage::encode(source, format));
+			  });
+		  })
+		| std::ranges::to<std::vector>();
+}
+
+// Images at or above `BCnImage::PARALLEL_BLOCK_THRESHOLD` are split across workers inside the encoder, and
+// are measured on a single calling thread. Smaller images are encoded serially, and are measured with
+// concurrent encodes to show the scaling across threads.
+static void bench_bcn_encode(ankerl::nanobench::Bench& bench, std::span<const ImageType> sources) noexcept
+{
+	const auto thread_counts = get_thread_counts();
+
+	// Larger encodes take seconds each, fewer epochs keep the total time reasonable
+	bench.epochs(3);
+
+	for (const auto& [format, format_name] : BCN_FORMATS)
+	{
+		bench.title(std::format("{} Encode", format_name));
+
+		for (const auto& source : sources)
+		{
+			const auto block_count = size_t(source.size.x / 4) * (source.size.y / 4);
+			const auto parallel = block_count >= image::BCnImage::PARALLEL_BLOCK_THRESHOLD;
+
+			for (const auto thread_count : parallel ? std::vector<uint32_t>{1} : thread_counts)
+			{
+				set_pixel_count(bench, source.size * glm::u32vec2(thread_count, 1));
+				bench.run(
+					std::format("{}x{}, {} thread(s)", source.size.x, source.size.y, thread_count),
+					[&source, format, thread_count] { encode_concurrently(source, format, thread_count); }
+				);
+			}
+		}
+	}
+}
+
+int main(int argc, const char* argv[]) noexcept
+{
+	if (argc > 2)
+	{
+		std::println(std::cerr, "Usage: {} [output.json]", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const auto sources_result = create_source_images();
+	if (!sources_result)
+	{
+		std::println(std::cerr, "Error: {}", sources_result.error().root());
+		return EXIT_FAILURE;
+	}
+	const auto& sources = *sources_result;
+
+	auto bench = ankerl::nanobench::Bench();
+	bench.unit("MPix").warmup(1).minEpochIterations(1).performanceCounters(false);
+
+	if (const auto result = bench_decode(bench, sources); !result)
+	{
+		std::println(std::cerr, "Error: {}", result.error().root());
+		return EXIT_FAILURE;
+	}
+	bench_resize(bench, sources);
+	bench_mipmap(bench, sources);
+	bench_convert(bench, sources);
+	bench_bcn_encode(bench, sources);
+
+	if (argc < 2) return EXIT_SUCCESS;
+
+	// Machine-readable results, one entry per benchmark with its timings and batch size in megapixels
+	auto json = std::ostringstream();
+	ankerl::nanobench::render(ankerl::nanobench::templates::json(), bench, json);
+
+	if (const auto result = file::write(argv[1], json.view()); !result)
+	{
+		std::println(std::cerr, "Error: {}", result.error().root());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
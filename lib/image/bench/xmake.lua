@@ -0,0 +1,8 @@
+-- Throughput benchmark of decoding, resizing, mipmap generation, conversion and BCn encoding
+target("lib.image.bench")
+	set_kind("binary")
+	set_default(false)
+
+	add_files("src/*.cpp")
+	add_packages("nanobench")
+	add_deps("lib.image", "lib.image.test.asset")
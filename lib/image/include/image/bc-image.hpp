@@ -6,9 +6,11 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <libassert/assert.hpp>
+#include <span>
 #include <vector>
 
 namespace image
@@ -25,11 +27,41 @@ namespace image
 	template <>
 	inline constexpr bool indexable_pixel_type_flag<BCnBlock> = false;
 
+	///
+	/// @brief Compression formats of 16-byte 4x4 blocks, including the ETC2/EAC and ASTC formats of devices
+	/// without BC support
+	///
 	enum class BCnFormat
 	{
 		BC3,
 		BC5,
-		BC7
+		BC7,
+		ETC2,      // ETC2 RGBA8, an EAC alpha block followed by an ETC2 color block
+		EAC_RG11,  // EAC RG11 unsigned, two-channel counterpart of BC5
+		ASTC4x4    // ASTC 4x4 LDR, only transcoded from KTX2 as no encoder is available
+	};
+
+	///
+	/// @brief Mipmap level of a pre-encoded BCn texture, see `Ktx2Image` and `DdsImage`
+	///
+	struct BCnLevel
+	{
+		glm::u32vec2 extent;           // Extent in pixels, not necessarily a multiple of the block size
+		std::vector<BCnBlock> blocks;  // Blocks of the level, row-major
+	};
+
+	///
+	/// @brief Quality options of BC7 encoding, trading encoding speed for quality
+	///
+	struct BC7Quality
+	{
+		// Uber level of the encoder, from `0` (fastest) to `4` (best quality)
+		uint32_t uber_level = 0;
+
+		// Max partition patterns evaluated, from `1` (fastest) to `64` (best quality)
+		uint32_t max_partitions = 64;
+
+		auto operator<=>(const BC7Quality&) const = default;
 	};
 
 	///
@@ -43,16 +75,54 @@ namespace image
 		///
 		/// @brief Encode a raw image into a BCn compressed image
 		///
+		/// @details Block rows of large images are encoded in parallel on the calling thread and a few worker
+		/// threads, see `PARALLEL_BLOCK_THRESHOLD`
+		///
 		/// @param raw_image Raw image to encode
 		/// @param format BCn compression format to use
-		/// @return Encoded block compressed image or an error
+		/// @param bc7_quality Quality options, only used when @p format is `BCnFormat::BC7`
+		/// @return Encoded block compressed image, or error if @p format is `BCnFormat::ASTC4x4`
 		///
 		[[nodiscard]]
 		static std::expected<BCnImage, Error> encode(
 			const Image<Format::Unorm8, Layout::RGBA>& raw_image,
-			BCnFormat format
+			BCnFormat format,
+			BC7Quality bc7_quality = {}
 		) noexcept;
 
+		///
+		/// @brief Encode a raw image into caller-provided block storage, e.g. mapped staging memory
+		/// @note Each block is written exactly once and never read back
+		///
+		/// @param raw_image Raw image to encode
+		/// @param format BCn compression format to use
+		/// @param destination Block storage, exactly `(raw_image.size.x / 4) * (raw_image.size.y / 4)` blocks
+		/// in row-major order
+		/// @param bc7_quality Quality options, only used when @p format is `BCnFormat::BC7`
+		/// @return Nothing, or error
+		///
+		[[nodiscard]]
+		static std::expected<void, Error> encode_into(
+			const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+			BCnFormat format,
+			std::span<BCnBlock> destination,
+			BC7Quality bc7_quality = {}
+		) noexcept;
+
+		///
+		/// @brief Decode the blocks back into a raw image, e.g. to measure the encoding error
+		/// @note BC5 and EAC RG11 decode into the red and green channels, with blue `0` and alpha `255`
+		///
+		/// @return Decoded image of `size * 4` pixels, or error if the format is `BCnFormat::BC7` or
+		/// `BCnFormat::ASTC4x4`, which have no decoder available, or if an ETC2 block uses a mode the encoder
+		/// never produces
+		///
+		[[nodiscard]]
+		std::expected<Image<Format::Unorm8, Layout::RGBA>, Error> decode() const noexcept;
+
+		// Images with at least this many blocks are encoded in parallel
+		static constexpr size_t PARALLEL_BLOCK_THRESHOLD = 128 * 128;
+
 	  private:
 
 		BCnImage(BCnFormat format, glm::u32vec2 block_dim) noexcept :
@@ -60,33 +130,46 @@ namespace image
 			format(format)
 		{}
 
-		// (Helper) Get block at specified block coordinates
-		[[nodiscard]]
-		auto& block_at(this auto& self, glm::u32vec2 block_coord) noexcept
-		{
-			ASSUME(block_coord.x < self.size.x && block_coord.y < self.size.y);
-			return self.data[block_coord.y * self.size.x + block_coord.x];
-		}
+		// Block rows claimed at once by a worker when encoding in parallel
+		static constexpr uint32_t ROWS_PER_BATCH = 4;
 
-		// (Helper) Iterate over all blocks in the image and apply a function
-		void iterate_blocks(const Image<Format::Unorm8, Layout::RGBA>& raw_image, auto func) noexcept;
+		// (Helper) Iterate over all blocks of the image and apply a function to the matching destination
+		// block, `func` must be thread-safe
+		static void iterate_blocks(
+			const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+			std::span<BCnBlock> destination,
+			auto func
+		) noexcept;
 
-		/// (Helper) Encode a single BC3 block
-		[[nodiscard]]
-		static std::expected<BCnImage, Error> encode_bc3(
-			const Image<Format::Unorm8, Layout::RGBA>& raw_image
+		// (Helper) Encode all blocks in BC3
+		static void encode_bc3(
+			const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+			std::span<BCnBlock> destination
 		) noexcept;
 
-		// (Helper) Encode a single BC5 block
-		[[nodiscard]]
-		static std::expected<BCnImage, Error> encode_bc5(
-			const Image<Format::Unorm8, Layout::RGBA>& raw_image
+		// (Helper) Encode all blocks in BC5
+		static void encode_bc5(
+			const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+			std::span<BCnBlock> destination
 		) noexcept;
 
-		// (Helper) Encode a single BC7 block
-		[[nodiscard]]
-		static std::expected<BCnImage, Error> encode_bc7(
-			const Image<Format::Unorm8, Layout::RGBA>& raw_image
+		// (Helper) Encode all blocks in BC7
+		static void encode_bc7(
+			const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+			std::span<BCnBlock> destination,
+			BC7Quality quality
+		) noexcept;
+
+		// (Helper) Encode all blocks in ETC2 RGBA8
+		static void encode_etc2(
+			const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+			std::span<BCnBlock> destination
+		) noexcept;
+
+		// (Helper) Encode all blocks in EAC RG11
+		static void encode_eac_rg11(
+			const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+			std::span<BCnBlock> destination
 		) noexcept;
 
 	  public:
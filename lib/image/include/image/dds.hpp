@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "image/bc-image.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <vector>
+
+namespace image
+{
+	///
+	/// @brief Mipmap chain of a BCn compressed DDS file
+	/// @details Supports BC3 (`DXT5`), BC5 (`ATI2`, `BC5U`) and the DX10 extended header with BC3, BC5 or BC7
+	/// in unorm or sRGB. The blocks are copied as-is, no pixel is decoded
+	///
+	struct DdsImage
+	{
+		BCnFormat format;
+		std::vector<BCnLevel> levels;  // Mipmap levels, from largest to smallest
+
+		///
+		/// @brief Check if the data is a DDS file, by its magic
+		///
+		/// @param encoded_data Encoded data
+		/// @return `true` if the data starts with the DDS magic
+		///
+		[[nodiscard]]
+		static bool is_dds(std::span<const std::byte> encoded_data) noexcept;
+
+		///
+		/// @brief Read the mipmap chain of a DDS file
+		/// @note Only the first surface of texture arrays and cubemaps is read
+		///
+		/// @param encoded_data Data of the DDS file
+		/// @param max_size Levels whose larger dimension exceeds this are skipped, keeping at least the
+		/// smallest one. `0` for no limit
+		/// @return Read image, or error if the file is invalid or not in a supported BCn format
+		///
+		[[nodiscard]]
+		static std::expected<DdsImage, Error> read(
+			std::span<const std::byte> encoded_data,
+			uint32_t max_size = 0
+		) noexcept;
+	};
+}
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "common/number-literals.hpp"
+#include "common/util/arena.hpp"
 #include "common/util/error.hpp"
 #include "common/util/span.hpp"
 #include "image/common.hpp"
+#include "image/impl/convert.hpp"
 #include "image/impl/decode.hpp"
 #include "image/impl/encode.hpp"
 
@@ -16,6 +18,7 @@
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <glm/glm.hpp>
 #include <libassert/assert.hpp>
+#include <memory_resource>
 #include <ranges>
 #include <span>
 #include <stb_image_resize2.h>
@@ -119,22 +122,46 @@ namespace image
 
 		///
 		/// @brief Decode an image from encoded data
+		/// @details With a non-zero @p max_size, the image is decoded at a reduced resolution: it is reduced
+		/// by the largest power of two keeping its larger dimension at least @p max_size. JPEG images are
+		/// reduced while decoding (up to 1/8), other images are box-downsampled right after decoding. Use it
+		/// when the image is going to be downscaled anyway.
 		/// @note Layout of RG is not supported
 		///
 		/// @param encoded_data Encoded image data
+		/// @param max_size Hint of the larger dimension wanted, `0` for full resolution
+		/// @param scratch_resource Memory resource of the decoded image before the box reduction, left
+		/// uninitialized before decoding, e.g. `util::ImportArena`
 		/// @return Decoded Image or Error
 		///
 		[[nodiscard]]
-		static std::expected<Image, Error> decode(std::span<const std::byte> encoded_data) noexcept
+		static std::expected<Image, Error> decode(
+			std::span<const std::byte> encoded_data,
+			uint32_t max_size = 0,
+			std::pmr::memory_resource& scratch_resource = *std::pmr::new_delete_resource()
+		) noexcept
 			requires(L != Layout::RG)
 		{
-			const auto result = impl::decode_img<T>(encoded_data, L);
-			if (!result) return result.error();
+			const auto info = impl::decode_info(encoded_data, T, L, max_size);
+			if (!info) return info.error();
+
+			if (info->box_reduction_log > 0)
+			{
+				auto decoded_data =
+					util::ScratchVector<Pixel<T, L>>(info->size.x * info->size.y, &scratch_resource);
+				const auto destination = util::as_writable_bytes(decoded_data);
+				if (const auto result = impl::decode_img(encoded_data, T, L, *info, destination); !result)
+					return result.error();
+
+				return downsample_box(decoded_data, info->size, info->box_reduction_log);
+			}
 
-			std::vector<Pixel<T, L>> decoded_data(result->width * result->height);
-			std::ranges::copy(util::as_bytes(result->data), util::as_writable_bytes(decoded_data).begin());
+			std::vector<Pixel<T, L>> decoded_data(info->size.x * info->size.y);
+			const auto destination = util::as_writable_bytes(decoded_data);
+			if (const auto result = impl::decode_img(encoded_data, T, L, *info, destination); !result)
+				return result.error();
 
-			return Image<T, L>(glm::u32vec2(result->width, result->height), std::move(decoded_data));
+			return Image<T, L>(info->size, std::move(decoded_data));
 		}
 
 		///
@@ -182,6 +209,67 @@ namespace image
 			return resized_image;
 		}
 
+		///
+		/// @brief Downsample by a power-of-two factor with a box filter
+		/// @details Each dimension is divided by `2^factor_log` and floored to at least 1, trailing rows and
+		/// columns not filling a whole box are dropped
+		///
+		/// @param factor_log `log2` of the downsample factor
+		/// @return Downsampled image
+		///
+		[[nodiscard]]
+		Image downsample_box(uint32_t factor_log) const noexcept
+		{
+			return downsample_box(this->data, this->size, factor_log);
+		}
+
+		///
+		/// @brief Downsample pixels by a power-of-two factor with a box filter, see `downsample_box`
+		///
+		/// @param pixels Row-major pixels to downsample
+		/// @param size Size of @p pixels
+		/// @param factor_log `log2` of the downsample factor
+		/// @return Downsampled image
+		///
+		[[nodiscard]]
+		static Image downsample_box(
+			std::span<const Pixel<T, L>> pixels,
+			glm::u32vec2 size,
+			uint32_t factor_log
+		) noexcept
+		{
+			using Accumulator = glm::vec<std::to_underlying(L), float>;
+
+			ASSUME(pixels.size() == size.x * size.y);
+
+			const auto factor = 1_u32 << factor_log;
+			const auto new_size = glm::max(size / factor, glm::u32vec2(1));
+			const auto box_size = glm::min(size, glm::u32vec2(factor));
+			const auto box_area = static_cast<float>(box_size.x * box_size.y);
+
+			Image<T, L> downsampled_image(new_size);
+
+			for (const auto y : std::views::iota(0_u32, new_size.y))
+				for (const auto x : std::views::iota(0_u32, new_size.x))
+				{
+					auto sum = Accumulator(0.0f);
+					for (const auto box_y : std::views::iota(0_u32, box_size.y))
+					{
+						const auto source_row =
+							pixels.subspan((y * factor + box_y) * size.x + x * factor, box_size.x);
+						for (const auto& pixel : source_row) sum += Accumulator(pixel);
+					}
+
+					const auto average = sum / box_area;
+					if constexpr (T == Format::Float32)
+						downsampled_image[x, y] = average;
+					else
+						downsampled_image[x, y] = Pixel<T, L>(glm::round(average));
+				}
+
+			return downsampled_image;
+		}
+
 		///
 		/// @brief Map every pixel through a function and produce a new image
 		/// @note The resulting image type is automatically deduced by the return type of `MapFunc`
@@ -202,6 +290,48 @@ namespace image
 			);
 		}
 
+		///
+		/// @brief Convert into another format and layout, keeping the leading channels
+		/// @details Unorm8 to Unorm16 replicates the bits, Unorm16 to Unorm8 keeps the high byte. RGBA to RG
+		/// and Unorm8/Unorm16 RGBA conversions run vectorized kernels (AVX2 or NEON), others go through `map`
+		///
+		/// @tparam Ty Target format
+		/// @tparam Ly Target layout, at most as many channels as the source
+		/// @return Converted image
+		///
+		template <Format Ty, Layout Ly>
+		[[nodiscard]]
+		Image<Ty, Ly> convert() const noexcept
+			requires(std::to_underlying(Ly) <= std::to_underlying(L))
+		{
+			if constexpr (T == Ty && L == Ly)
+				return *this;
+			else if constexpr (impl::has_convert_kernel<T, L, Ty, Ly>)
+			{
+				auto converted = Image<Ty, Ly>(this->size);
+				impl::convert_pixels(std::span(this->data), std::span(converted.data));
+				return converted;
+			}
+			else
+				return map(impl::convert_pixel<T, L, Ty, Ly>);
+		}
+
+		///
+		/// @brief Get the minimum alpha of all pixels
+		/// @note Unorm8 images are scanned with a vectorized kernel (AVX2 or NEON)
+		///
+		/// @return Minimum alpha
+		///
+		[[nodiscard]]
+		FormatType<T> min_alpha() const noexcept
+			requires(L == Layout::RGBA)
+		{
+			if constexpr (T == Format::Unorm8)
+				return impl::min_alpha(this->data);
+			else
+				return std::ranges::min(this->data | std::views::transform(&Pixel<T, L>::a));
+		}
+
 		///
 		/// @brief Tell if the image is POT (Power-of-two)
 		///
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "image/common.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <utility>
+
+namespace image::impl
+{
+	/* Vectorized Kernels */
+
+	// Kernels run with AVX2 or NEON when available, sizes of the source and destination must match
+
+	// RGBA -> RG, Unorm8
+	void convert_pixels(std::span<const glm::u8vec4> source, std::span<glm::u8vec2> destination) noexcept;
+
+	// RGBA -> RG, Unorm16
+	void convert_pixels(std::span<const glm::u16vec4> source, std::span<glm::u16vec2> destination) noexcept;
+
+	// Unorm16 -> Unorm8, RGBA
+	void convert_pixels(std::span<const glm::u16vec4> source, std::span<glm::u8vec4> destination) noexcept;
+
+	// Unorm8 -> Unorm16, RGBA
+	void convert_pixels(std::span<const glm::u8vec4> source, std::span<glm::u16vec4> destination) noexcept;
+
+	// Minimum alpha of RGBA Unorm8 pixels, `255` if empty
+	[[nodiscard]]
+	uint8_t min_alpha(std::span<const glm::u8vec4> pixels) noexcept;
+
+	// Whether a format and layout conversion has a vectorized kernel
+	template <Format T, Layout L, Format Ty, Layout Ly>
+	inline constexpr bool has_convert_kernel = false;
+
+	template <>
+	inline constexpr bool has_convert_kernel<Format::Unorm8, Layout::RGBA, Format::Unorm8, Layout::RG> = true;
+
+	template <>
+	inline constexpr bool has_convert_kernel<Format::Unorm16, Layout::RGBA, Format::Unorm16, Layout::RG> =
+		true;
+
+	template <>
+	inline constexpr bool has_convert_kernel<Format::Unorm16, Layout::RGBA, Format::Unorm8, Layout::RGBA> =
+		true;
+
+	template <>
+	inline constexpr bool has_convert_kernel<Format::Unorm8, Layout::RGBA, Format::Unorm16, Layout::RGBA> =
+		true;
+
+	/* Scalar Conversion */
+
+	// Rescale a component between formats. Unorm8 -> Unorm16 replicates the bits, Unorm16 -> Unorm8 keeps
+	// the high byte, floats are clamped to `[0, 1]` when converted to Unorm
+	template <Format T, Format Ty>
+	[[nodiscard]]
+	constexpr FormatType<Ty> convert_component(FormatType<T> value) noexcept
+	{
+		if constexpr (T == Ty)
+			return value;
+		else if constexpr (T == Format::Unorm8 && Ty == Format::Unorm16)
+			return static_cast<uint16_t>(value * 0x0101);
+		else if constexpr (T == Format::Unorm16 && Ty == Format::Unorm8)
+			return static_cast<uint8_t>(value >> 8);
+		else if constexpr (Ty == Format::Float32)
+			return static_cast<float>(value) / static_cast<float>(std::numeric_limits<FormatType<T>>::max());
+		else
+		{
+			constexpr auto max = static_cast<float>(std::numeric_limits<FormatType<Ty>>::max());
+			return static_cast<FormatType<Ty>>(std::round(std::clamp(value, 0.0f, 1.0f) * max));
+		}
+	}
+
+	// Convert a pixel between formats and layouts, keeping the leading channels
+	template <Format T, Layout L, Format Ty, Layout Ly>
+		requires(std::to_underlying(Ly) <= std::to_underlying(L))
+	[[nodiscard]]
+	constexpr Pixel<Ty, Ly> convert_pixel(const Pixel<T, L>& pixel) noexcept
+	{
+		Pixel<Ty, Ly> result;
+		for (const auto channel : std::views::iota(0, static_cast<int>(Ly)))
+			result[channel] = convert_component<T, Ty>(pixel[channel]);
+		return result;
+	}
+}
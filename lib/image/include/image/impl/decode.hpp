@@ -6,42 +6,60 @@
 #include <cstddef>
 #include <cstdint>
 #include <expected>
-#include <glm/glm.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
 #include <span>
-#include <vector>
 
 namespace image::impl
 {
-	template <Format T>
-	struct DecodeResult
+	///
+	/// @brief Size and reduction of a decoded image, see `decode_info`
+	///
+	struct DecodeInfo
 	{
-		std::vector<FormatType<T>> data;
-		uint32_t width;
-		uint32_t height;
+		glm::u32vec2 size;              // Size of the decoded data
+		uint32_t native_reduction_log;  // Power-of-two reduction done by the backend while decoding
+		uint32_t box_reduction_log;     // Remaining power-of-two reduction, done with a box filter afterwards
 	};
 
-	template <Format T>
+	///
+	/// @brief Get the size of an encoded image, and how it is to be reduced
+	/// @details
+	/// - The decoder backend is selected by the magic bytes of @p encoded_data and whether it supports
+	/// @p format and @p layout, falling back to stb_image. The same backend is used in `decode_img`
+	/// - With a non-zero @p max_size, the image is reduced by the largest power of two keeping its larger
+	/// dimension at least @p max_size. Backends able to decode at a reduced scale (e.g. JPEG with DCT-domain
+	/// scaling) do as much of it as they can, the rest is left in `box_reduction_log`
+	///
+	/// @param encoded_data Encoded image data
+	/// @param format Format to be decoded into
+	/// @param layout Layout to be decoded into
+	/// @param max_size Hint of the larger dimension wanted, `0` for full resolution
+	/// @return Decode info, or error if the data is not a supported image
+	///
 	[[nodiscard]]
-	std::expected<DecodeResult<T>, Error> decode_img(
+	std::expected<DecodeInfo, Error> decode_info(
 		std::span<const std::byte> encoded_data,
-		Layout layout
+		Format format,
+		Layout layout,
+		uint32_t max_size
 	) noexcept;
 
-	template <>
-	std::expected<DecodeResult<Format::Unorm8>, Error> decode_img<Format::Unorm8>(
-		std::span<const std::byte> encoded_data,
-		Layout layout
-	) noexcept;
-
-	template <>
-	std::expected<DecodeResult<Format::Unorm16>, Error> decode_img<Format::Unorm16>(
-		std::span<const std::byte> encoded_data,
-		Layout layout
-	) noexcept;
-
-	template <>
-	std::expected<DecodeResult<Format::Float32>, Error> decode_img<Format::Float32>(
+	///
+	/// @brief Decode an image directly into caller-provided storage
+	///
+	/// @param encoded_data Encoded image data
+	/// @param format Format to be decoded into
+	/// @param layout Layout to be decoded into
+	/// @param info Decode info, see `decode_info`
+	/// @param destination Tightly packed pixel storage, exactly `info.size.x * info.size.y` pixels
+	/// @return Nothing, or error
+	///
+	[[nodiscard]]
+	std::expected<void, Error> decode_img(
 		std::span<const std::byte> encoded_data,
-		Layout layout
+		Format format,
+		Layout layout,
+		const DecodeInfo& info,
+		std::span<std::byte> destination
 	) noexcept;
 }
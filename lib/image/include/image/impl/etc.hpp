@@ -0,0 +1,51 @@
+#pragma once
+
+#include "image/bc-image.hpp"
+
+#include <array>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <optional>
+
+namespace image::impl
+{
+	// Pixels of a 4x4 block, row-major
+	using PixelBlock = std::array<glm::u8vec4, 16>;
+
+	///
+	/// @brief Encode a block in ETC2 RGBA8, an EAC alpha block followed by an ETC2 color block
+	/// @note Colors only use the individual and differential modes shared with ETC1
+	///
+	/// @param pixels Pixels of the block
+	/// @return Encoded block
+	///
+	[[nodiscard]]
+	BCnBlock encode_etc2_rgba_block(const PixelBlock& pixels) noexcept;
+
+	///
+	/// @brief Encode the red and green channels of a block in EAC RG11 (unsigned)
+	///
+	/// @param pixels Pixels of the block
+	/// @return Encoded block
+	///
+	[[nodiscard]]
+	BCnBlock encode_eac_rg11_block(const PixelBlock& pixels) noexcept;
+
+	///
+	/// @brief Decode an ETC2 RGBA8 block
+	///
+	/// @param block Encoded block
+	/// @return Decoded pixels, or `std::nullopt` if the color block uses the T, H or planar modes, which
+	/// `encode_etc2_rgba_block` never produces
+	///
+	[[nodiscard]]
+	std::optional<PixelBlock> decode_etc2_rgba_block(const BCnBlock& block) noexcept;
+
+	///
+	/// @brief Decode an EAC RG11 block into the red and green channels, with blue `0` and alpha `255`
+	///
+	/// @param block Encoded block
+	/// @return Decoded pixels, rounded to 8 bits
+	///
+	[[nodiscard]]
+	PixelBlock decode_eac_rg11_block(const BCnBlock& block) noexcept;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <span>
+
+namespace image::impl
+{
+	///
+	/// @brief Get the extent of the base level of a KTX2 container
+	///
+	/// @param encoded_data Data of the KTX2 container
+	/// @return Extent in pixels, or error
+	///
+	[[nodiscard]]
+	std::expected<glm::u32vec2, Error> get_ktx2_extent(std::span<const std::byte> encoded_data) noexcept;
+
+	///
+	/// @brief Transcode the base level of a KTX2 container into RGBA Unorm8 pixels
+	///
+	/// @param encoded_data Data of the KTX2 container
+	/// @param destination Tightly packed pixel storage of the extent returned by `get_ktx2_extent`
+	/// @return Nothing, or error
+	///
+	[[nodiscard]]
+	std::expected<void, Error> transcode_ktx2_rgba8(
+		std::span<const std::byte> encoded_data,
+		std::span<std::byte> destination
+	) noexcept;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "image/bc-image.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <vector>
+
+namespace image
+{
+	///
+	/// @brief Mipmap chain of a Basis Universal texture (ETC1S or UASTC) in a KTX2 container, transcoded into
+	/// a BCn format
+	/// @details Transcoding is a cheap per-block conversion, much faster than encoding the BCn blocks from
+	/// decoded pixels, and keeps the mipmap levels stored in the container
+	///
+	struct Ktx2Image
+	{
+		BCnFormat format;
+		bool has_alpha;                // Whether the texture has an alpha channel
+		std::vector<BCnLevel> levels;  // Mipmap levels, from largest to smallest
+
+		///
+		/// @brief Check if the data is a KTX2 container, by its identifier
+		///
+		/// @param encoded_data Encoded data
+		/// @return `true` if the data starts with a KTX2 identifier
+		///
+		[[nodiscard]]
+		static bool is_ktx2(std::span<const std::byte> encoded_data) noexcept;
+
+		///
+		/// @brief Transcode the mipmap chain of a KTX2 container
+		/// @note Only the first layer and face is transcoded. `BCnFormat::BC5` and `BCnFormat::EAC_RG11` take
+		/// the red and green channels
+		///
+		/// @param encoded_data Data of the KTX2 container
+		/// @param format Target BCn format
+		/// @param max_size Levels whose larger dimension exceeds this are skipped, keeping at least the
+		/// smallest one. `0` for no limit
+		/// @return Transcoded image, or error
+		///
+		[[nodiscard]]
+		static std::expected<Ktx2Image, Error> transcode(
+			std::span<const std::byte> encoded_data,
+			BCnFormat format,
+			uint32_t max_size = 0
+		) noexcept;
+	};
+}
@@ -0,0 +1,18 @@
+package("basisu")
+
+	set_urls("https://github.com/BinomialLLC/basis_universal.git")
+
+	on_install(function(package)
+		io.writefile("xmake.lua", [[
+			add_rules("mode.release")
+			set_languages("c++17")
+			target("basisu")
+				set_kind("static")
+				add_files("transcoder/basisu_transcoder.cpp", "zstd/zstddeclib.c")
+				add_defines("BASISD_SUPPORT_KTX2=1", "BASISD_SUPPORT_KTX2_ZSTD=1")
+				add_headerfiles("transcoder/(*.h)", "transcoder/(*.inc)", {prefixdir = "basisu"})
+		]])
+		import("package.tools.xmake").install(package)
+	end)
+
+package_end()
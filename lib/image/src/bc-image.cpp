@@ -4,10 +4,13 @@
 #include "common/util/error.hpp"
 #include "image/common.hpp"
 #include "image/image.hpp"
+#include "image/impl/etc.hpp"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bc7enc.h>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
@@ -17,6 +20,9 @@
 #include <rgbcx.h>
 #include <span>
 #include <stb_dxt/stb_dxt.h>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 namespace image
 {
@@ -55,18 +61,62 @@ namespace image
 
 	void BCnImage::iterate_blocks(
 		const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+		std::span<BCnBlock> destination,
 		auto process_func
 	) noexcept
 	{
-		for (
-			const auto [y, x] :
-			std::views::cartesian_product(std::views::iota(0_u32, size.y), std::views::iota(0_u32, size.x))
-		)
+		const auto size = raw_image.size / 4_u32;
+		ASSUME(destination.size() == size_t(size.x) * size.y);
+
+		const auto process_rows =
+			[size, destination, &raw_image, &process_func](uint32_t begin, uint32_t end) {
+				const auto rows = std::views::iota(begin, end);
+				const auto columns = std::views::iota(0_u32, size.x);
+
+				for (const auto [y, x] : std::views::cartesian_product(rows, columns))
+				{
+					const glm::u32vec2 coord{x, y};
+					const auto pixel_block = slice_block(raw_image, coord);
+					std::invoke(process_func, destination[coord.y * size.x + coord.x], pixel_block);
+				}
+			};
+
+		const auto batch_count = (size.y + ROWS_PER_BATCH - 1) / ROWS_PER_BATCH;
+		const auto worker_count =
+			size_t(size.x) * size.y >= PARALLEL_BLOCK_THRESHOLD
+				? std::min(std::thread::hardware_concurrency(), batch_count)
+				: 1;
+
+		if (worker_count <= 1)
 		{
-			const glm::u32vec2 coord{x, y};
-			const auto pixel_block = slice_block(raw_image, coord);
-			std::invoke(process_func, this->block_at(coord), pixel_block);
+			process_rows(0, size.y);
+			return;
 		}
+
+		// Batches are claimed from a shared counter, so that workers finishing early take over the rest
+		std::atomic<uint32_t> next_batch = 0;
+		const auto worker = [size, &next_batch, &process_rows] {
+			while (true)
+			{
+				const auto batch = next_batch.fetch_add(1, std::memory_order_relaxed);
+				if (batch * ROWS_PER_BATCH >= size.y) break;
+				process_rows(batch * ROWS_PER_BATCH, std::min((batch + 1) * ROWS_PER_BATCH, size.y));
+			}
+		};
+
+		std::vector<std::jthread> threads;
+		threads.reserve(worker_count - 1);
+
+		try
+		{
+			for (uint32_t i = 1; i < worker_count; i++) threads.emplace_back(worker);
+		}
+		catch (const std::system_error&)
+		{
+			// Out of threads, the remaining rows are still processed by existing workers
+		}
+
+		worker();
 	}
 
 	static void encode_bc3_block(
@@ -93,41 +143,39 @@ namespace image
 		);
 	}
 
-	std::expected<BCnImage, Error> BCnImage::encode_bc3(
-		const Image<Format::Unorm8, Layout::RGBA>& raw_image
+	void BCnImage::encode_bc3(
+		const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+		std::span<BCnBlock> destination
 	) noexcept
 	{
 		std::call_once(rgbcx_init_flag, [] { rgbcx::init(); });
-
-		BCnImage bc3_image(BCnFormat::BC3, raw_image.size / 4_u32);
-		bc3_image.iterate_blocks(raw_image, encode_bc3_block);
-		return bc3_image;
+		iterate_blocks(raw_image, destination, encode_bc3_block);
 	}
 
-	std::expected<BCnImage, Error> BCnImage::encode_bc5(
-		const Image<Format::Unorm8, Layout::RGBA>& raw_image
+	void BCnImage::encode_bc5(
+		const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+		std::span<BCnBlock> destination
 	) noexcept
 	{
 		std::call_once(rgbcx_init_flag, [] { rgbcx::init(); });
-
-		BCnImage bc5_image(BCnFormat::BC5, raw_image.size / 4_u32);
-		bc5_image.iterate_blocks(raw_image, encode_bc5_block);
-		return bc5_image;
+		iterate_blocks(raw_image, destination, encode_bc5_block);
 	}
 
-	std::expected<BCnImage, Error> BCnImage::encode_bc7(
-		const Image<Format::Unorm8, Layout::RGBA>& raw_image
+	void BCnImage::encode_bc7(
+		const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+		std::span<BCnBlock> destination,
+		BC7Quality quality
 	) noexcept
 	{
 		static std::once_flag bc7_init_flag;
 
-		BCnImage bc7_image(BCnFormat::BC7, raw_image.size / 4_u32);
-
 		std::call_once(bc7_init_flag, [] { bc7enc_compress_block_init(); });
 
 		bc7enc_compress_block_params params{};
 		bc7enc_compress_block_params_init(&params);
 		bc7enc_compress_block_params_init_perceptual_weights(&params);
+		params.m_uber_level = quality.uber_level;
+		params.m_max_partitions = quality.max_partitions;
 
 		const auto encode_bc7_block =
 			[&params](
@@ -141,31 +189,151 @@ namespace image
 				);
 			};
 
-		bc7_image.iterate_blocks(raw_image, encode_bc7_block);
-		return bc7_image;
+		iterate_blocks(raw_image, destination, encode_bc7_block);
+	}
+
+	void BCnImage::encode_etc2(
+		const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+		std::span<BCnBlock> destination
+	) noexcept
+	{
+		iterate_blocks(raw_image, destination, [](BCnBlock& block, const impl::PixelBlock& pixel_block) {
+			block = impl::encode_etc2_rgba_block(pixel_block);
+		});
+	}
+
+	void BCnImage::encode_eac_rg11(
+		const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+		std::span<BCnBlock> destination
+	) noexcept
+	{
+		iterate_blocks(raw_image, destination, [](BCnBlock& block, const impl::PixelBlock& pixel_block) {
+			block = impl::encode_eac_rg11_block(pixel_block);
+		});
 	}
 
 	std::expected<BCnImage, Error> BCnImage::encode(
 		const Image<Format::Unorm8, Layout::RGBA>& raw_image,
-		BCnFormat format
+		BCnFormat format,
+		BC7Quality bc7_quality
 	) noexcept
 	{
+		BCnImage image(format, raw_image.size / 4_u32);
+		if (const auto result = encode_into(raw_image, format, image.data, bc7_quality); !result)
+			return result.error();
+
+		return image;
+	}
+
+	std::expected<void, Error> BCnImage::encode_into(
+		const Image<Format::Unorm8, Layout::RGBA>& raw_image,
+		BCnFormat format,
+		std::span<BCnBlock> destination,
+		BC7Quality bc7_quality
+	) noexcept
+	{
+		if (format == BCnFormat::ASTC4x4)
+			return Error("Encoding ASTC images is not supported", "ASTC is only transcoded from KTX2");
+
 		if (raw_image.size.x % 4 != 0 || raw_image.size.y % 4 != 0)
 			return Error(
 				"Unsupported image dimensions for BCn compression",
 				std::format("Must be multiples of 4, got {}", raw_image.size)
 			);
 
+		if (bc7_quality.uber_level > BC7ENC_MAX_UBER_LEVEL)
+			return Error(
+				"Invalid BC7 uber level",
+				std::format("Must be at most {}, got {}", BC7ENC_MAX_UBER_LEVEL, bc7_quality.uber_level)
+			);
+
+		if (bc7_quality.max_partitions < 1 || bc7_quality.max_partitions > BC7ENC_MAX_PARTITIONS)
+			return Error(
+				"Invalid BC7 partition count",
+				std::format(
+					"Must be within [1, {}], got {}",
+					BC7ENC_MAX_PARTITIONS,
+					bc7_quality.max_partitions
+				)
+			);
+
+		const auto block_count = size_t(raw_image.size.x / 4) * (raw_image.size.y / 4);
+		if (destination.size() != block_count)
+			return Error(
+				"Destination size mismatches image blocks",
+				std::format("{} != {}", destination.size(), block_count)
+			);
+
 		switch (format)
 		{
 		case BCnFormat::BC3:
-			return encode_bc3(raw_image);
+			encode_bc3(raw_image, destination);
+			break;
 		case BCnFormat::BC5:
-			return encode_bc5(raw_image);
+			encode_bc5(raw_image, destination);
+			break;
 		case BCnFormat::BC7:
-			return encode_bc7(raw_image);
+			encode_bc7(raw_image, destination, bc7_quality);
+			break;
+		case BCnFormat::ETC2:
+			encode_etc2(raw_image, destination);
+			break;
+		case BCnFormat::EAC_RG11:
+			encode_eac_rg11(raw_image, destination);
+			break;
 		default:
 			UNREACHABLE("Invalid BCnFormat", format);
 		}
+
+		return {};
+	}
+
+	std::expected<Image<Format::Unorm8, Layout::RGBA>, Error> BCnImage::decode() const noexcept
+	{
+		if (format == BCnFormat::BC7) return Error("Decoding BC7 images is not supported");
+		if (format == BCnFormat::ASTC4x4) return Error("Decoding ASTC images is not supported");
+
+		std::call_once(rgbcx_init_flag, [] { rgbcx::init(); });
+
+		auto image = Image<Format::Unorm8, Layout::RGBA>(size * 4_u32, {0, 0, 0, 255});
+
+		for (const auto [y, x] :
+			 std::views::cartesian_product(std::views::iota(0_u32, size.y), std::views::iota(0_u32, size.x)))
+		{
+			const auto& block = data[y * size.x + x];
+			auto pixel_block = std::array<Pixel<Format::Unorm8, Layout::RGBA>, 16>();
+			pixel_block.fill({0, 0, 0, 255});
+
+			switch (format)
+			{
+			case BCnFormat::BC3:
+				rgbcx::unpack_bc3(block.data.data(), pixel_block.data());
+				break;
+			case BCnFormat::BC5:
+				rgbcx::unpack_bc5(block.data.data(), pixel_block.data());
+				break;
+			case BCnFormat::ETC2:
+			{
+				const auto decoded = impl::decode_etc2_rgba_block(block);
+				if (!decoded)
+					return Error("Unsupported ETC2 block mode", std::format("Block ({}, {})", x, y));
+				pixel_block = *decoded;
+				break;
+			}
+			case BCnFormat::EAC_RG11:
+				pixel_block = impl::decode_eac_rg11_block(block);
+				break;
+			default:
+				UNREACHABLE("Invalid BCnFormat", format);
+			}
+
+			for (const auto row : std::views::iota(0_u32, 4_u32))
+				std::ranges::copy(
+					std::span(pixel_block).subspan(row * 4, 4),
+					image.data.begin() + (y * 4 + row) * image.size.x + x * 4
+				);
+		}
+
+		return image;
 	}
 }
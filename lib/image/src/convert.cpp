@@ -0,0 +1,203 @@
+#include "image/impl/convert.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <libassert/assert.hpp>
+#include <span>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace image::impl
+{
+	// Kernels reinterpret the pixels as tightly packed components
+	static_assert(sizeof(glm::u8vec2) == 2 && sizeof(glm::u8vec4) == 4);
+	static_assert(sizeof(glm::u16vec2) == 4 && sizeof(glm::u16vec4) == 8);
+
+	void convert_pixels(std::span<const glm::u8vec4> source, std::span<glm::u8vec2> destination) noexcept
+	{
+		ASSUME(source.size() == destination.size());
+
+		size_t index = 0;
+
+#if defined(__AVX2__)
+		// Red and green of the 4 pixels of each 128-bit lane, gathered into its low 64 bits
+		const auto shuffle = _mm256_setr_epi8(
+			0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+			0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1
+		);
+
+		for (; index + 8 <= source.size(); index += 8)
+		{
+			const auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source.data() + index));
+			const auto packed = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(pixels, shuffle), 0b1000);
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(destination.data() + index),
+				_mm256_castsi256_si128(packed)
+			);
+		}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+		for (; index + 8 <= source.size(); index += 8)
+		{
+			const auto pixels = vld4_u8(reinterpret_cast<const uint8_t*>(source.data() + index));
+			vst2_u8(
+				reinterpret_cast<uint8_t*>(destination.data() + index),
+				uint8x8x2_t{{pixels.val[0], pixels.val[1]}}
+			);
+		}
+#endif
+
+		for (; index < source.size(); index++) destination[index] = glm::u8vec2(source[index]);
+	}
+
+	void convert_pixels(std::span<const glm::u16vec4> source, std::span<glm::u16vec2> destination) noexcept
+	{
+		ASSUME(source.size() == destination.size());
+
+		size_t index = 0;
+
+#if defined(__AVX2__)
+		// Red and green of the 2 pixels of each 128-bit lane, gathered into its low 64 bits
+		const auto shuffle = _mm256_setr_epi8(
+			0, 1, 2, 3, 8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1,
+			0, 1, 2, 3, 8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1
+		);
+
+		for (; index + 4 <= source.size(); index += 4)
+		{
+			const auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source.data() + index));
+			const auto packed = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(pixels, shuffle), 0b1000);
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(destination.data() + index),
+				_mm256_castsi256_si128(packed)
+			);
+		}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+		for (; index + 4 <= source.size(); index += 4)
+		{
+			const auto pixels = vld4_u16(reinterpret_cast<const uint16_t*>(source.data() + index));
+			vst2_u16(
+				reinterpret_cast<uint16_t*>(destination.data() + index),
+				uint16x4x2_t{{pixels.val[0], pixels.val[1]}}
+			);
+		}
+#endif
+
+		for (; index < source.size(); index++) destination[index] = glm::u16vec2(source[index]);
+	}
+
+	void convert_pixels(std::span<const glm::u16vec4> source, std::span<glm::u8vec4> destination) noexcept
+	{
+		ASSUME(source.size() == destination.size());
+
+		size_t index = 0;
+
+#if defined(__AVX2__)
+		// High bytes of the 8 components of each 128-bit lane, gathered into its low 64 bits
+		const auto shuffle = _mm256_setr_epi8(
+			1, 3, 5, 7, 9, 11, 13, 15, -1, -1, -1, -1, -1, -1, -1, -1,
+			1, 3, 5, 7, 9, 11, 13, 15, -1, -1, -1, -1, -1, -1, -1, -1
+		);
+
+		for (; index + 4 <= source.size(); index += 4)
+		{
+			const auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source.data() + index));
+			const auto packed = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(pixels, shuffle), 0b1000);
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(destination.data() + index),
+				_mm256_castsi256_si128(packed)
+			);
+		}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+		for (; index + 4 <= source.size(); index += 4)
+		{
+			const auto* const components = reinterpret_cast<const uint16_t*>(source.data() + index);
+			const auto high_bytes = vcombine_u8(
+				vshrn_n_u16(vld1q_u16(components), 8),
+				vshrn_n_u16(vld1q_u16(components + 8), 8)
+			);
+			vst1q_u8(reinterpret_cast<uint8_t*>(destination.data() + index), high_bytes);
+		}
+#endif
+
+		for (; index < source.size(); index++)
+			destination[index] = convert_pixel<Format::Unorm16, Layout::RGBA, Format::Unorm8, Layout::RGBA>(
+				source[index]
+			);
+	}
+
+	void convert_pixels(std::span<const glm::u8vec4> source, std::span<glm::u16vec4> destination) noexcept
+	{
+		ASSUME(source.size() == destination.size());
+
+		size_t index = 0;
+
+#if defined(__AVX2__)
+		// Widened components are replicated into the high bytes, same as multiplying by `0x0101`
+		for (; index + 4 <= source.size(); index += 4)
+		{
+			const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + index));
+			const auto widened = _mm256_cvtepu8_epi16(pixels);
+			_mm256_storeu_si256(
+				reinterpret_cast<__m256i*>(destination.data() + index),
+				_mm256_or_si256(widened, _mm256_slli_epi16(widened, 8))
+			);
+		}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+		for (; index + 4 <= source.size(); index += 4)
+		{
+			const auto pixels = vld1q_u8(reinterpret_cast<const uint8_t*>(source.data() + index));
+			const auto low = vmovl_u8(vget_low_u8(pixels));
+			const auto high = vmovl_u8(vget_high_u8(pixels));
+
+			auto* const components = reinterpret_cast<uint16_t*>(destination.data() + index);
+			vst1q_u16(components, vorrq_u16(low, vshlq_n_u16(low, 8)));
+			vst1q_u16(components + 8, vorrq_u16(high, vshlq_n_u16(high, 8)));
+		}
+#endif
+
+		for (; index < source.size(); index++)
+			destination[index] = convert_pixel<Format::Unorm8, Layout::RGBA, Format::Unorm16, Layout::RGBA>(
+				source[index]
+			);
+	}
+
+	uint8_t min_alpha(std::span<const glm::u8vec4> pixels) noexcept
+	{
+		uint8_t result = 255;
+		size_t index = 0;
+
+#if defined(__AVX2__)
+		// All components are reduced together, only the alpha bytes are read back
+		auto minimum = _mm256_set1_epi8(-1);
+		for (; index + 8 <= pixels.size(); index += 8)
+			minimum = _mm256_min_epu8(
+				minimum,
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels.data() + index))
+			);
+
+		alignas(32) std::array<uint8_t, 32> lanes;
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lanes.data()), minimum);
+		for (size_t lane = 3; lane < lanes.size(); lane += 4) result = std::min(result, lanes[lane]);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+		auto minimum = vdupq_n_u8(255);
+		for (; index + 16 <= pixels.size(); index += 16)
+		{
+			const auto channels = vld4q_u8(reinterpret_cast<const uint8_t*>(pixels.data() + index));
+			minimum = vminq_u8(minimum, channels.val[3]);
+		}
+
+		result = vminvq_u8(minimum);
+#endif
+
+		for (; index < pixels.size(); index++) result = std::min(result, pixels[index].a);
+		return result;
+	}
+}
@@ -0,0 +1,145 @@
+#include "image/dds.hpp"
+#include "common/util/error.hpp"
+#include "image/bc-image.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <format>
+#include <glm/common.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace image
+{
+	// Byte offsets of the DDS header fields, from the start of the file
+	namespace dds_offset
+	{
+		static constexpr size_t HEADER_SIZE = 4;
+		static constexpr size_t FLAGS = 8;
+		static constexpr size_t HEIGHT = 12;
+		static constexpr size_t WIDTH = 16;
+		static constexpr size_t MIPMAP_COUNT = 28;
+		static constexpr size_t FOURCC = 84;
+		static constexpr size_t DATA = 128;
+
+		static constexpr size_t DX10_FORMAT = 128;
+		static constexpr size_t DX10_DATA = 148;
+	}
+
+	static constexpr uint32_t DDS_HEADER_SIZE = 124;
+	static constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+
+	[[nodiscard]]
+	static uint32_t read_u32(std::span<const std::byte> data, size_t offset) noexcept
+	{
+		uint32_t value;
+		std::memcpy(&value, data.data() + offset, sizeof(value));
+		return value;
+	}
+
+	[[nodiscard]]
+	static bool match_fourcc(std::span<const std::byte> data, size_t offset, std::string_view fourcc) noexcept
+	{
+		return std::memcmp(data.data() + offset, fourcc.data(), 4) == 0;
+	}
+
+	// (Helper) Get BCn format from a DXGI format, `std::nullopt` if unsupported
+	[[nodiscard]]
+	static std::optional<BCnFormat> get_dxgi_format(uint32_t dxgi_format) noexcept
+	{
+		switch (dxgi_format)
+		{
+		case 77:  // DXGI_FORMAT_BC3_UNORM
+		case 78:  // DXGI_FORMAT_BC3_UNORM_SRGB
+			return BCnFormat::BC3;
+		case 83:  // DXGI_FORMAT_BC5_UNORM
+			return BCnFormat::BC5;
+		case 98:  // DXGI_FORMAT_BC7_UNORM
+		case 99:  // DXGI_FORMAT_BC7_UNORM_SRGB
+			return BCnFormat::BC7;
+		default:
+			return std::nullopt;
+		}
+	}
+
+	bool DdsImage::is_dds(std::span<const std::byte> encoded_data) noexcept
+	{
+		return encoded_data.size() >= 4 && match_fourcc(encoded_data, 0, "DDS ");
+	}
+
+	std::expected<DdsImage, Error> DdsImage::read(
+		std::span<const std::byte> encoded_data,
+		uint32_t max_size
+	) noexcept
+	{
+		if (!is_dds(encoded_data)) return Error("Data is not a DDS file");
+		if (encoded_data.size() < dds_offset::DATA) return Error("DDS header is truncated");
+
+		if (read_u32(encoded_data, dds_offset::HEADER_SIZE) != DDS_HEADER_SIZE)
+			return Error("Invalid DDS header size");
+
+		const auto extent = glm::u32vec2(
+			read_u32(encoded_data, dds_offset::WIDTH),
+			read_u32(encoded_data, dds_offset::HEIGHT)
+		);
+		if (extent.x == 0 || extent.y == 0)
+			return Error("Invalid DDS extent", std::format("{}x{}", extent.x, extent.y));
+
+		const bool has_mipmap_count = (read_u32(encoded_data, dds_offset::FLAGS) & DDSD_MIPMAPCOUNT) != 0;
+		const auto level_count =
+			has_mipmap_count ? std::max(read_u32(encoded_data, dds_offset::MIPMAP_COUNT), 1u) : 1u;
+		if (level_count > 32) return Error("Invalid DDS mipmap count", std::format("{}", level_count));
+
+		std::optional<BCnFormat> format;
+		size_t data_offset = dds_offset::DATA;
+
+		if (match_fourcc(encoded_data, dds_offset::FOURCC, "DX10"))
+		{
+			if (encoded_data.size() < dds_offset::DX10_DATA) return Error("DDS DX10 header is truncated");
+
+			const auto dxgi_format = read_u32(encoded_data, dds_offset::DX10_FORMAT);
+			format = get_dxgi_format(dxgi_format);
+			if (!format) return Error("Unsupported DDS format", std::format("DXGI format {}", dxgi_format));
+
+			data_offset = dds_offset::DX10_DATA;
+		}
+		else if (match_fourcc(encoded_data, dds_offset::FOURCC, "DXT5"))
+			format = BCnFormat::BC3;
+		else if (match_fourcc(encoded_data, dds_offset::FOURCC, "ATI2")
+				 || match_fourcc(encoded_data, dds_offset::FOURCC, "BC5U"))
+			format = BCnFormat::BC5;
+		else
+			return Error("Unsupported DDS format", "Only BC3, BC5 and BC7 are supported");
+
+		auto image = DdsImage{.format = *format, .levels = {}};
+
+		for (const auto level : std::views::iota(0u, level_count))
+		{
+			const auto level_extent = glm::max(extent >> level, glm::u32vec2(1));
+			const auto block_dim = (level_extent + 3u) / 4u;
+			const auto level_size = static_cast<size_t>(block_dim.x) * block_dim.y * sizeof(BCnBlock);
+
+			if (encoded_data.size() - data_offset < level_size)
+				return Error("DDS data is truncated", std::format("Level {}", level));
+
+			const auto level_data = encoded_data.subspan(data_offset, level_size);
+			data_offset += level_size;
+
+			const bool too_large = max_size != 0 && std::max(level_extent.x, level_extent.y) > max_size;
+			if (too_large && level + 1 < level_count) continue;
+
+			auto blocks = std::vector<BCnBlock>(block_dim.x * block_dim.y);
+			std::memcpy(blocks.data(), level_data.data(), level_size);
+			image.levels.push_back({.extent = level_extent, .blocks = std::move(blocks)});
+		}
+
+		return image;
+	}
+}
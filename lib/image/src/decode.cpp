@@ -1,194 +1,610 @@
 #include "image/impl/decode.hpp"
 #include "common/util/error.hpp"
 #include "image/common.hpp"
+#include "image/impl/ktx2.hpp"
+#include "image/ktx2.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <expected>
+#include <format>
+#include <glm/common.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
 #include <libassert/assert.hpp>
+#include <memory>
 #include <ranges>
 #include <span>
+#include <spng.h>
 #include <stb_image.h>
+#include <string_view>
+#include <turbojpeg.h>
 #include <utility>
-#include <vector>
 #include <webp/decode.h>
 
 namespace image::impl
 {
-	static std::expected<std::vector<uint8_t>, Error> decode_webp(
-		std::span<const std::byte> encoded_data,
-		int width,
-		int height,
-		Layout layout
-	) noexcept
+	namespace
 	{
-		std::vector<uint8_t> decoded_data(width * height * std::to_underlying(layout));
+		///
+		/// @brief Decoder backend, see `BACKENDS`
+		///
+		struct Backend
+		{
+			// Check the magic bytes of the encoded data
+			bool (*match)(std::span<const std::byte> encoded_data) noexcept;
+
+			// Check if the backend can decode into the format and layout
+			bool (*supports)(Format format, Layout layout) noexcept;
 
-		const uint8_t* decode_result;
+			// Get the size of the image decoded at `1 / 2^reduction_log` scale
+			std::expected<glm::u32vec2, Error> (*get_size)(
+				std::span<const std::byte> encoded_data,
+				uint32_t reduction_log
+			) noexcept;
 
-		switch (layout)
+			// Decode into tightly packed storage of exactly the size returned by `get_size`
+			std::expected<void, Error> (*decode)(
+				std::span<const std::byte> encoded_data,
+				Format format,
+				Layout layout,
+				glm::u32vec2 size,
+				uint32_t reduction_log,
+				std::span<std::byte> destination
+			) noexcept;
+
+			// Maximum reduction the backend can do while decoding
+			uint32_t max_reduction_log;
+		};
+
+		size_t get_component_size(Format format) noexcept
 		{
-		case Layout::Grey:
-		case Layout::RG:
-			return Error("WebP does not support this layout");
-
-		case Layout::RGB:
-			decode_result = WebPDecodeRGBInto(
-				reinterpret_cast<const uint8_t*>(encoded_data.data()),
-				encoded_data.size(),
-				decoded_data.data(),
-				decoded_data.size(),
-				width * 3
-			);
-			break;
-
-		case Layout::RGBA:
-			decode_result = WebPDecodeRGBAInto(
-				reinterpret_cast<const uint8_t*>(encoded_data.data()),
-				encoded_data.size(),
-				decoded_data.data(),
-				decoded_data.size(),
-				width * 4
-			);
-			break;
+			switch (format)
+			{
+			case Format::Unorm8:
+				return sizeof(FormatType<Format::Unorm8>);
+			case Format::Unorm16:
+				return sizeof(FormatType<Format::Unorm16>);
+			case Format::Float32:
+				return sizeof(FormatType<Format::Float32>);
+			default:
+				UNREACHABLE("Invalid format", format);
+			}
+		}
 
-		default:
-			UNREACHABLE("Invalid layout", layout);
+		bool match_magic(
+			std::span<const std::byte> encoded_data,
+			size_t offset,
+			std::string_view magic
+		) noexcept
+		{
+			return encoded_data.size() >= offset + magic.size()
+				&& std::memcmp(encoded_data.data() + offset, magic.data(), magic.size()) == 0;
 		}
 
-		if (decode_result == nullptr) return Error("Decode WebP image failed");
+		const uint8_t* as_uint8(std::span<const std::byte> encoded_data) noexcept
+		{
+			return reinterpret_cast<const uint8_t*>(encoded_data.data());
+		}
 
-		return decoded_data;
-	}
+		///
+		/// @brief Expand Unorm8 components to Unorm16 in place
+		/// @details The Unorm8 components are expected in the upper half of @p destination. Expanding from
+		/// the front never overwrites a component that is not read yet, so no intermediate buffer is needed
+		///
+		void expand_unorm8_in_place(std::span<std::byte> destination) noexcept
+		{
+			const auto component_count = destination.size() / sizeof(uint16_t);
+			const auto source = destination.subspan(component_count);
 
-	template <>
-	std::expected<DecodeResult<Format::Unorm8>, Error> decode_img<Format::Unorm8>(
-		std::span<const std::byte> encoded_data,
-		Layout layout
-	) noexcept
-	{
-		int width, height, channels;
-		const int desired_channels = static_cast<int>(layout);
-
-		const bool is_webp =
-			WebPGetInfo(
-				reinterpret_cast<const uint8_t*>(encoded_data.data()),
-				encoded_data.size(),
-				&width,
-				&height
-			)
-			!= 0;
-
-		if (is_webp)
+			for (const auto i : std::views::iota(0zu, component_count))
+			{
+				const auto value = static_cast<uint16_t>(std::to_integer<uint8_t>(source[i]) * 0x0101);
+				std::memcpy(destination.data() + i * sizeof(uint16_t), &value, sizeof(uint16_t));
+			}
+		}
+
+		///
+		/// @brief Decode into Unorm8 storage, then expand to Unorm16 in place if needed
+		///
+		/// @param destination Destination storage of @p format
+		/// @param decode_unorm8 Function decoding Unorm8 components into a given span
+		///
+		std::expected<void, Error> decode_unorm8_or_unorm16(
+			Format format,
+			std::span<std::byte> destination,
+			const auto& decode_unorm8
+		) noexcept
 		{
-			auto result = decode_webp(encoded_data, width, height, layout);
-			if (!result) return result.error();
+			if (format == Format::Unorm8) return decode_unorm8(destination);
 
-			return DecodeResult<Format::Unorm8>{
-				.data = std::move(*result),
-				.width = static_cast<uint32_t>(width),
-				.height = static_cast<uint32_t>(height)
-			};
+			const auto unorm8_storage = destination.subspan(destination.size() / 2);
+			if (const auto result = decode_unorm8(unorm8_storage); !result) return result;
+
+			expand_unorm8_in_place(destination);
+			return {};
 		}
 
-		stbi_uc* data = stbi_load_from_memory(
-			reinterpret_cast<const stbi_uc*>(encoded_data.data()),
-			static_cast<int>(encoded_data.size()),
-			&width,
-			&height,
-			&channels,
-			desired_channels
-		);
-		if (data == nullptr) return Error("Decode image failed", stbi_failure_reason());
+		/* WebP */
 
-		auto result = DecodeResult<Format::Unorm8>{
-			.data = std::vector<uint8_t>(std::from_range, std::span(data, width * height * desired_channels)),
-			.width = static_cast<uint32_t>(width),
-			.height = static_cast<uint32_t>(height)
-		};
-		stbi_image_free(data);
-		return result;
-	}
+		namespace webp
+		{
+			bool match(std::span<const std::byte> encoded_data) noexcept
+			{
+				return match_magic(encoded_data, 0, "RIFF") && match_magic(encoded_data, 8, "WEBP");
+			}
 
-	template <>
-	std::expected<DecodeResult<Format::Unorm16>, Error> decode_img<Format::Unorm16>(
-		std::span<const std::byte> encoded_data,
-		Layout layout
-	) noexcept
-	{
-		int width, height, channels;
-		const int desired_channels = static_cast<int>(layout);
-
-		const bool is_webp =
-			WebPGetInfo(
-				reinterpret_cast<const uint8_t*>(encoded_data.data()),
-				encoded_data.size(),
-				&width,
-				&height
-			)
-			!= 0;
-
-		if (is_webp)
+			bool supports(Format format, Layout) noexcept
+			{
+				return format == Format::Unorm8 || format == Format::Unorm16;
+			}
+
+			std::expected<glm::u32vec2, Error> get_size(
+				std::span<const std::byte> encoded_data,
+				uint32_t
+			) noexcept
+			{
+				int width, height;
+				if (WebPGetInfo(as_uint8(encoded_data), encoded_data.size(), &width, &height) == 0)
+					return Error("Read WebP header failed");
+
+				return glm::u32vec2(width, height);
+			}
+
+			std::expected<void, Error> decode(
+				std::span<const std::byte> encoded_data,
+				Format format,
+				Layout layout,
+				glm::u32vec2 size,
+				uint32_t,
+				std::span<std::byte> destination
+			) noexcept
+			{
+				if (layout == Layout::Grey || layout == Layout::RG)
+					return Error("WebP does not support this layout");
+
+				const auto decode_unorm8 = [&](std::span<std::byte> storage) -> std::expected<void, Error> {
+					const auto decode_into = layout == Layout::RGB ? WebPDecodeRGBInto : WebPDecodeRGBAInto;
+					const auto* const decode_result = decode_into(
+						as_uint8(encoded_data),
+						encoded_data.size(),
+						reinterpret_cast<uint8_t*>(storage.data()),
+						storage.size(),
+						static_cast<int>(size.x) * std::to_underlying(layout)
+					);
+					if (decode_result == nullptr) return Error("Decode WebP image failed");
+
+					return {};
+				};
+
+				return decode_unorm8_or_unorm16(format, destination, decode_unorm8);
+			}
+		}
+
+		/* JPEG, libjpeg-turbo with SIMD-accelerated IDCT and color conversion */
+
+		namespace jpeg
 		{
-			const auto result = decode_webp(encoded_data, width, height, layout);
-			if (!result) return result.error();
-
-			return DecodeResult<Format::Unorm16>{
-				.data = *result | std::views::transform([](uint8_t byte) -> uint16_t {
-					return static_cast<uint16_t>(byte) * 0x0101;
-				}) | std::ranges::to<std::vector>(),
-				.width = static_cast<uint32_t>(width),
-				.height = static_cast<uint32_t>(height)
+			struct HandleDeleter
+			{
+				void operator()(void* handle) const noexcept { tj3Destroy(handle); }
 			};
+
+			using Handle = std::unique_ptr<void, HandleDeleter>;
+
+			std::expected<Handle, Error> create_handle(std::span<const std::byte> encoded_data) noexcept
+			{
+				auto handle = Handle(tj3Init(TJINIT_DECOMPRESS));
+				if (handle == nullptr)
+					return Error("Create TurboJPEG handle failed", tj3GetErrorStr(nullptr));
+
+				if (tj3DecompressHeader(handle.get(), as_uint8(encoded_data), encoded_data.size()) != 0)
+					return Error("Read JPEG header failed", tj3GetErrorStr(handle.get()));
+
+				return handle;
+			}
+
+			bool match(std::span<const std::byte> encoded_data) noexcept
+			{
+				return match_magic(encoded_data, 0, "\xFF\xD8\xFF");
+			}
+
+			bool supports(Format format, Layout layout) noexcept
+			{
+				return (format == Format::Unorm8 || format == Format::Unorm16) && layout != Layout::RG;
+			}
+
+			// DCT-domain scaling, the IDCT directly outputs 1/1, 1/2, 1/4 or 1/8 of the full size
+			constexpr uint32_t MAX_REDUCTION_LOG = 3;
+
+			tjscalingfactor get_scaling_factor(uint32_t reduction_log) noexcept
+			{
+				return {.num = 1, .denom = 1 << reduction_log};
+			}
+
+			std::expected<glm::u32vec2, Error> get_size(
+				std::span<const std::byte> encoded_data,
+				uint32_t reduction_log
+			) noexcept
+			{
+				const auto handle = create_handle(encoded_data);
+				if (!handle) return handle.error();
+
+				const auto scaling_factor = get_scaling_factor(reduction_log);
+				return glm::u32vec2(
+					TJSCALED(tj3Get(handle->get(), TJPARAM_JPEGWIDTH), scaling_factor),
+					TJSCALED(tj3Get(handle->get(), TJPARAM_JPEGHEIGHT), scaling_factor)
+				);
+			}
+
+			std::expected<void, Error> decode(
+				std::span<const std::byte> encoded_data,
+				Format format,
+				Layout layout,
+				glm::u32vec2 size,
+				uint32_t reduction_log,
+				std::span<std::byte> destination
+			) noexcept
+			{
+				const auto handle = create_handle(encoded_data);
+				if (!handle) return handle.error();
+
+				if (tj3SetScalingFactor(handle->get(), get_scaling_factor(reduction_log)) != 0)
+					return Error("Set JPEG scaling factor failed", tj3GetErrorStr(handle->get()));
+
+				int pixel_format;
+				switch (layout)
+				{
+				case Layout::Grey:
+					pixel_format = TJPF_GRAY;
+					break;
+				case Layout::RGB:
+					pixel_format = TJPF_RGB;
+					break;
+				case Layout::RGBA:
+					pixel_format = TJPF_RGBA;
+					break;
+				default:
+					UNREACHABLE("Unsupported layout", layout);
+				}
+
+				const auto decode_unorm8 = [&](std::span<std::byte> storage) -> std::expected<void, Error> {
+					const auto result = tj3Decompress8(
+						handle->get(),
+						as_uint8(encoded_data),
+						encoded_data.size(),
+						reinterpret_cast<uint8_t*>(storage.data()),
+						static_cast<int>(size.x) * std::to_underlying(layout),
+						pixel_format
+					);
+
+					// Warnings, e.g. for truncated data, still produce a usable image
+					if (result != 0 && tj3GetErrorCode(handle->get()) == TJERR_FATAL)
+						return Error("Decode JPEG image failed", tj3GetErrorStr(handle->get()));
+
+					return {};
+				};
+
+				return decode_unorm8_or_unorm16(format, destination, decode_unorm8);
+			}
 		}
 
-		stbi_us* data = stbi_load_16_from_memory(
-			reinterpret_cast<const stbi_uc*>(encoded_data.data()),
-			static_cast<int>(encoded_data.size()),
-			&width,
-			&height,
-			&channels,
-			desired_channels
-		);
-		if (data == nullptr) return Error("Decode image failed", stbi_failure_reason());
+		/* PNG, libspng with SIMD-accelerated filtering and zlib inflating */
 
-		auto result = DecodeResult<Format::Unorm16>{
-			.data =
-				std::vector<uint16_t>(std::from_range, std::span(data, width * height * desired_channels)),
-			.width = static_cast<uint32_t>(width),
-			.height = static_cast<uint32_t>(height)
-		};
-		stbi_image_free(data);
+		namespace png
+		{
+			struct ContextDeleter
+			{
+				void operator()(spng_ctx* context) const noexcept { spng_ctx_free(context); }
+			};
 
-		return result;
+			using Context = std::unique_ptr<spng_ctx, ContextDeleter>;
+
+			std::expected<Context, Error> create_context(std::span<const std::byte> encoded_data) noexcept
+			{
+				auto context = Context(spng_ctx_new(0));
+				if (context == nullptr) return Error("Create libspng context failed");
+
+				const auto result =
+					spng_set_png_buffer(context.get(), encoded_data.data(), encoded_data.size());
+				if (result != 0) return Error("Set PNG buffer failed", spng_strerror(result));
+
+				return context;
+			}
+
+			// libspng can only convert any PNG into these formats
+			int get_spng_format(Format format, Layout layout) noexcept
+			{
+				if (format == Format::Unorm8 && layout == Layout::RGBA) return SPNG_FMT_RGBA8;
+				if (format == Format::Unorm8 && layout == Layout::RGB) return SPNG_FMT_RGB8;
+				if (format == Format::Unorm16 && layout == Layout::RGBA) return SPNG_FMT_RGBA16;
+				return 0;
+			}
+
+			bool match(std::span<const std::byte> encoded_data) noexcept
+			{
+				return match_magic(encoded_data, 0, "\x89PNG\r\n\x1A\n");
+			}
+
+			bool supports(Format format, Layout layout) noexcept
+			{
+				return get_spng_format(format, layout) != 0;
+			}
+
+			std::expected<glm::u32vec2, Error> get_size(
+				std::span<const std::byte> encoded_data,
+				uint32_t
+			) noexcept
+			{
+				const auto context = create_context(encoded_data);
+				if (!context) return context.error();
+
+				spng_ihdr header;
+				if (const auto result = spng_get_ihdr(context->get(), &header); result != 0)
+					return Error("Read PNG header failed", spng_strerror(result));
+
+				return glm::u32vec2(header.width, header.height);
+			}
+
+			std::expected<void, Error> decode(
+				std::span<const std::byte> encoded_data,
+				Format format,
+				Layout layout,
+				glm::u32vec2,
+				uint32_t,
+				std::span<std::byte> destination
+			) noexcept
+			{
+				const auto context = create_context(encoded_data);
+				if (!context) return context.error();
+
+				const auto spng_format = get_spng_format(format, layout);
+
+				size_t decoded_size;
+				if (const auto result = spng_decoded_image_size(context->get(), spng_format, &decoded_size);
+					result != 0)
+					return Error("Get decoded PNG size failed", spng_strerror(result));
+
+				if (decoded_size != destination.size())
+					return Error(
+						"Decoded PNG size mismatches destination",
+						std::format("{} != {}", decoded_size, destination.size())
+					);
+
+				if (const auto result = spng_decode_image(
+						context->get(),
+						destination.data(),
+						destination.size(),
+						spng_format,
+						SPNG_DECODE_TRNS
+					);
+					result != 0)
+					return Error("Decode PNG image failed", spng_strerror(result));
+
+				return {};
+			}
+		}
+
+		/* KTX2, Basis Universal transcoded into pixels, for sources that can't be used block-compressed */
+
+		namespace ktx2
+		{
+			bool match(std::span<const std::byte> encoded_data) noexcept
+			{
+				return Ktx2Image::is_ktx2(encoded_data);
+			}
+
+			bool supports(Format format, Layout layout) noexcept
+			{
+				return (format == Format::Unorm8 || format == Format::Unorm16) && layout == Layout::RGBA;
+			}
+
+			std::expected<glm::u32vec2, Error> get_size(
+				std::span<const std::byte> encoded_data,
+				uint32_t
+			) noexcept
+			{
+				return get_ktx2_extent(encoded_data);
+			}
+
+			std::expected<void, Error> decode(
+				std::span<const std::byte> encoded_data,
+				Format format,
+				Layout,
+				glm::u32vec2,
+				uint32_t,
+				std::span<std::byte> destination
+			) noexcept
+			{
+				return decode_unorm8_or_unorm16(format, destination, [&](std::span<std::byte> storage) {
+					return transcode_ktx2_rgba8(encoded_data, storage);
+				});
+			}
+		}
+
+		/* stb_image, fallback for all other formats and layouts */
+
+		namespace stb
+		{
+			bool match(std::span<const std::byte>) noexcept
+			{
+				return true;
+			}
+
+			bool supports(Format, Layout) noexcept
+			{
+				return true;
+			}
+
+			std::expected<glm::u32vec2, Error> get_size(
+				std::span<const std::byte> encoded_data,
+				uint32_t
+			) noexcept
+			{
+				int width, height, channels;
+				if (stbi_info_from_memory(
+						reinterpret_cast<const stbi_uc*>(encoded_data.data()),
+						static_cast<int>(encoded_data.size()),
+						&width,
+						&height,
+						&channels
+					)
+					== 0)
+					return Error("Decode image failed", stbi_failure_reason());
+
+				return glm::u32vec2(width, height);
+			}
+
+			// stb_image always allocates its own output, which is copied into the destination
+			std::expected<void, Error> decode(
+				std::span<const std::byte> encoded_data,
+				Format format,
+				Layout layout,
+				glm::u32vec2,
+				uint32_t,
+				std::span<std::byte> destination
+			) noexcept
+			{
+				int width, height, channels;
+				const int desired_channels = static_cast<int>(layout);
+				const auto* const encoded = reinterpret_cast<const stbi_uc*>(encoded_data.data());
+				const auto encoded_size = static_cast<int>(encoded_data.size());
+
+				const auto load = [&](auto load_function) -> void* {
+					return load_function(encoded, encoded_size, &width, &height, &channels, desired_channels);
+				};
+
+				void* data;
+				switch (format)
+				{
+				case Format::Unorm8:
+					data = load(stbi_load_from_memory);
+					break;
+				case Format::Unorm16:
+					data = load(stbi_load_16_from_memory);
+					break;
+				case Format::Float32:
+					data = load(stbi_loadf_from_memory);
+					break;
+				default:
+					UNREACHABLE("Invalid format", format);
+				}
+				if (data == nullptr) return Error("Decode image failed", stbi_failure_reason());
+
+				const auto decoded_size = static_cast<size_t>(width) * height * desired_channels
+					* get_component_size(format);
+				if (decoded_size != destination.size())
+				{
+					stbi_image_free(data);
+					return Error(
+						"Decoded image size mismatches destination",
+						std::format("{} != {}", decoded_size, destination.size())
+					);
+				}
+
+				std::memcpy(destination.data(), data, decoded_size);
+				stbi_image_free(data);
+
+				return {};
+			}
+		}
+
+		// Backends in order of preference, the first one matching and supporting the request is used
+		constexpr auto BACKENDS = std::to_array<Backend>({
+			{webp::match, webp::supports, webp::get_size, webp::decode, 0},
+			{jpeg::match, jpeg::supports, jpeg::get_size, jpeg::decode, jpeg::MAX_REDUCTION_LOG},
+			{png::match,  png::supports,  png::get_size,  png::decode,  0},
+			{ktx2::match, ktx2::supports, ktx2::get_size, ktx2::decode, 0},
+			{stb::match,  stb::supports,  stb::get_size,  stb::decode,  0},
+		});
+
+		const Backend& select_backend(
+			std::span<const std::byte> encoded_data,
+			Format format,
+			Layout layout
+		) noexcept
+		{
+			const auto backend = std::ranges::find_if(BACKENDS, [&](const Backend& backend) {
+				return backend.match(encoded_data) && backend.supports(format, layout);
+			});
+
+			// The stb backend accepts everything
+			ASSERT(backend != BACKENDS.end());
+			return *backend;
+		}
+
+		// Largest power-of-two reduction keeping the larger dimension at least `max_size`
+		uint32_t get_reduction_log(glm::u32vec2 size, uint32_t max_size) noexcept
+		{
+			if (max_size == 0) return 0;
+
+			uint32_t reduction_log = 0;
+			while (std::max(size.x, size.y) / 2 >= max_size)
+			{
+				size = glm::max(size / 2u, glm::u32vec2(1));
+				reduction_log++;
+			}
+
+			return reduction_log;
+		}
 	}
 
-	template <>
-	std::expected<DecodeResult<Format::Float32>, Error> decode_img<Format::Float32>(
+	std::expected<DecodeInfo, Error> decode_info(
 		std::span<const std::byte> encoded_data,
-		Layout layout
+		Format format,
+		Layout layout,
+		uint32_t max_size
 	) noexcept
 	{
-		int width, height, channels;
-		const int desired_channels = static_cast<int>(layout);
-
-		float* data = stbi_loadf_from_memory(
-			reinterpret_cast<const stbi_uc*>(encoded_data.data()),
-			static_cast<int>(encoded_data.size()),
-			&width,
-			&height,
-			&channels,
-			desired_channels
-		);
-		if (data == nullptr) return Error("Decode image failed", stbi_failure_reason());
+		const auto& backend = select_backend(encoded_data, format, layout);
+
+		const auto size = backend.get_size(encoded_data, 0);
+		if (!size) return size.error();
+
+		if (size->x == 0 || size->y == 0)
+			return Error("Invalid image size", std::format("{}x{}", size->x, size->y));
+
+		const auto reduction_log = get_reduction_log(*size, max_size);
+		const auto native_reduction_log = std::min(reduction_log, backend.max_reduction_log);
+		if (native_reduction_log == 0)
+			return DecodeInfo{.size = *size, .native_reduction_log = 0, .box_reduction_log = reduction_log};
+
+		const auto reduced_size = backend.get_size(encoded_data, native_reduction_log);
+		if (!reduced_size) return reduced_size.error();
 
-		auto result = DecodeResult<Format::Float32>{
-			.data = std::vector<float>(std::from_range, std::span(data, width * height * desired_channels)),
-			.width = static_cast<uint32_t>(width),
-			.height = static_cast<uint32_t>(height)
+		return DecodeInfo{
+			.size = *reduced_size,
+			.native_reduction_log = native_reduction_log,
+			.box_reduction_log = reduction_log - native_reduction_log
 		};
-		stbi_image_free(data);
+	}
 
-		return result;
+	std::expected<void, Error> decode_img(
+		std::span<const std::byte> encoded_data,
+		Format format,
+		Layout layout,
+		const DecodeInfo& info,
+		std::span<std::byte> destination
+	) noexcept
+	{
+		const auto expected_size = static_cast<size_t>(info.size.x) * info.size.y * std::to_underlying(layout)
+			* get_component_size(format);
+		if (destination.size() != expected_size)
+			return Error(
+				"Destination size mismatches image size",
+				std::format("{} != {}", destination.size(), expected_size)
+			);
+
+		const auto& backend = select_backend(encoded_data, format, layout);
+		return backend.decode(
+			encoded_data,
+			format,
+			layout,
+			info.size,
+			info.native_reduction_log,
+			destination
+		);
 	}
 }
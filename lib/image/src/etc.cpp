@@ -0,0 +1,434 @@
+#include "image/impl/etc.hpp"
+#include "image/bc-image.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/ext/vector_int3.hpp>
+#include <glm/ext/vector_uint3_sized.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vector_relational.hpp>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <utility>
+
+namespace image::impl
+{
+	// Intensity modifiers of ETC1/ETC2 color subblocks, indexed by table and pixel index
+	static constexpr std::array<std::array<int32_t, 4>, 8> ETC_MODIFIERS = {
+		{
+         {2, 8, -2, -8},
+         {5, 17, -5, -17},
+         {9, 29, -9, -29},
+         {13, 42, -13, -42},
+         {18, 60, -18, -60},
+         {24, 80, -24, -80},
+         {33, 106, -33, -106},
+         {47, 183, -47, -183},
+		 }
+	};
+
+	// Modifiers of EAC alpha and R11/RG11 blocks, indexed by table and pixel index
+	static constexpr std::array<std::array<int32_t, 8>, 16> EAC_MODIFIERS = {
+		{
+         {-3, -6, -9, -15, 2, 5, 8, 14},
+         {-3, -7, -10, -13, 2, 6, 9, 12},
+         {-2, -5, -8, -13, 1, 4, 7, 12},
+         {-2, -4, -6, -13, 1, 3, 5, 12},
+         {-3, -6, -8, -12, 2, 5, 7, 11},
+         {-3, -7, -9, -11, 2, 6, 8, 10},
+         {-4, -7, -8, -11, 3, 6, 7, 10},
+         {-3, -5, -8, -11, 2, 4, 7, 10},
+         {-2, -6, -8, -10, 1, 5, 7, 9},
+         {-2, -5, -8, -10, 1, 4, 7, 9},
+         {-2, -4, -8, -10, 1, 3, 7, 9},
+         {-2, -5, -7, -10, 1, 4, 6, 9},
+         {-3, -4, -7, -10, 2, 3, 6, 9},
+         {-1, -2, -3, -10, 0, 1, 2, 9},
+         {-4, -6, -8, -9, 3, 5, 7, 8},
+         {-3, -5, -7, -9, 2, 4, 6, 8},
+		 }
+	};
+
+	// Index of a pixel within ETC and EAC blocks, which order pixels column-major
+	[[nodiscard]]
+	static constexpr uint32_t column_major(uint32_t row_major_index) noexcept
+	{
+		return (row_major_index % 4) * 4 + row_major_index / 4;
+	}
+
+	// Blocks store 64-bit halves in big-endian byte order
+	[[nodiscard]]
+	static uint64_t read_half(const BCnBlock& block, size_t offset) noexcept
+	{
+		uint64_t value = 0;
+		for (const auto idx : std::views::iota(0zu, 8zu))
+			value = value << 8 | static_cast<uint64_t>(block.data[offset + idx]);
+		return value;
+	}
+
+	static void write_half(BCnBlock& block, size_t offset, uint64_t value) noexcept
+	{
+		for (const auto idx : std::views::iota(0zu, 8zu))
+			block.data[offset + idx] = static_cast<std::byte>(value >> ((7 - idx) * 8));
+	}
+
+	/* ETC2 Color */
+
+	[[nodiscard]]
+	static constexpr int32_t expand4(int32_t value) noexcept
+	{
+		return value << 4 | value;
+	}
+
+	[[nodiscard]]
+	static constexpr int32_t expand5(int32_t value) noexcept
+	{
+		return value << 3 | value >> 2;
+	}
+
+	// Fit of a base color and modifier table to a subblock
+	struct SubblockFit
+	{
+		uint32_t error = std::numeric_limits<uint32_t>::max();
+		uint32_t table = 0;
+		std::array<uint32_t, 16> indices = {};  // Pixel indices, row-major, only set for the subblock
+	};
+
+	// Pick the modifier table and pixel indices of a subblock, @p in_subblock selects its pixels
+	[[nodiscard]]
+	static SubblockFit fit_subblock(const PixelBlock& pixels, glm::ivec3 base, auto in_subblock) noexcept
+	{
+		SubblockFit best;
+
+		for (const auto [table, modifiers] : ETC_MODIFIERS | std::views::enumerate)
+		{
+			SubblockFit fit{.error = 0, .table = static_cast<uint32_t>(table), .indices = {}};
+
+			for (const auto idx : std::views::iota(0u, 16u))
+			{
+				if (!in_subblock(idx)) continue;
+				const auto pixel = glm::ivec3(pixels[idx]);
+
+				auto best_error = std::numeric_limits<uint32_t>::max();
+				for (const auto [modifier_idx, modifier] : modifiers | std::views::enumerate)
+				{
+					const auto color = glm::clamp(base + modifier, 0, 255);
+					const auto diff = color - pixel;
+					const auto error = static_cast<uint32_t>(glm::dot(diff, diff));
+					if (error >= best_error) continue;
+
+					best_error = error;
+					fit.indices[idx] = static_cast<uint32_t>(modifier_idx);
+				}
+
+				fit.error += best_error;
+			}
+
+			if (fit.error < best.error) best = fit;
+		}
+
+		return best;
+	}
+
+	// Encode the color half of an ETC2 block in the individual or differential mode
+	[[nodiscard]]
+	static uint64_t encode_etc2_color(const PixelBlock& pixels) noexcept
+	{
+		uint64_t best_bits = 0;
+		auto best_error = std::numeric_limits<uint64_t>::max();
+
+		for (const bool flip : {false, true})
+		{
+			// Left and right 2x4 halves, or top and bottom 4x2 halves if flipped
+			const auto in_second = [flip](uint32_t idx) {
+				return (flip ? idx / 4 : idx % 4) >= 2;
+			};
+
+			std::array<glm::ivec3, 2> sums = {};
+			for (const auto idx : std::views::iota(0u, 16u))
+				sums[in_second(idx) ? 1 : 0] += glm::ivec3(pixels[idx]);
+
+			const auto quantize = [](glm::ivec3 sum, int32_t max) {
+				return glm::ivec3(glm::round(glm::vec3(sum) / 8.0f * static_cast<float>(max) / 255.0f));
+			};
+
+			const auto try_mode = [&](bool differential, glm::ivec3 color0, glm::ivec3 color1) {
+				const auto expand = [differential](glm::ivec3 color) {
+					return differential
+						? glm::ivec3(expand5(color.x), expand5(color.y), expand5(color.z))
+						: glm::ivec3(expand4(color.x), expand4(color.y), expand4(color.z));
+				};
+
+				const auto in_first = [&in_second](uint32_t idx) {
+					return !in_second(idx);
+				};
+				const auto fit0 = fit_subblock(pixels, expand(color0), in_first);
+				const auto fit1 = fit_subblock(pixels, expand(color1), in_second);
+
+				const auto error = uint64_t(fit0.error) + fit1.error;
+				if (error >= best_error) return;
+
+				uint64_t bits = 0;
+				if (differential)
+				{
+					const auto delta = (color1 - color0) & 0x7;
+					bits |= uint64_t(color0.x) << 59 | uint64_t(delta.x) << 56;
+					bits |= uint64_t(color0.y) << 51 | uint64_t(delta.y) << 48;
+					bits |= uint64_t(color0.z) << 43 | uint64_t(delta.z) << 40;
+				}
+				else
+				{
+					bits |= uint64_t(color0.x) << 60 | uint64_t(color1.x) << 56;
+					bits |= uint64_t(color0.y) << 52 | uint64_t(color1.y) << 48;
+					bits |= uint64_t(color0.z) << 44 | uint64_t(color1.z) << 40;
+				}
+				bits |= uint64_t(fit0.table) << 37 | uint64_t(fit1.table) << 34;
+				bits |= uint64_t(differential) << 33 | uint64_t(flip) << 32;
+
+				for (const auto idx : std::views::iota(0u, 16u))
+				{
+					const auto index = in_second(idx) ? fit1.indices[idx] : fit0.indices[idx];
+					const auto position = column_major(idx);
+					bits |= uint64_t(index >> 1) << (16 + position) | uint64_t(index & 1) << position;
+				}
+
+				best_error = error;
+				best_bits = bits;
+			};
+
+			// Differential mode has more precision, but only if the second color is within its reach.
+			// Overflowing the delta would select the T, H or planar modes instead
+			const auto diff_color0 = quantize(sums[0], 31);
+			const auto diff_color1 = quantize(sums[1], 31);
+			const auto delta = diff_color1 - diff_color0;
+			if (glm::all(glm::greaterThanEqual(delta, glm::ivec3(-4)))
+				&& glm::all(glm::lessThanEqual(delta, glm::ivec3(3))))
+				try_mode(true, diff_color0, diff_color1);
+
+			try_mode(false, quantize(sums[0], 15), quantize(sums[1], 15));
+		}
+
+		return best_bits;
+	}
+
+	[[nodiscard]]
+	static std::optional<std::array<glm::u8vec3, 16>> decode_etc2_color(uint64_t bits) noexcept
+	{
+		const bool differential = (bits >> 33 & 1) != 0;
+		const bool flip = (bits >> 32 & 1) != 0;
+
+		std::array<glm::ivec3, 2> colors;
+		if (differential)
+		{
+			const auto get_channel = [bits](uint32_t shift) -> std::optional<std::pair<int32_t, int32_t>> {
+				const auto base = static_cast<int32_t>(bits >> (shift + 3) & 0x1F);
+				const auto raw_delta = static_cast<int32_t>(bits >> shift & 0x7);
+				const auto second = base + (raw_delta >= 4 ? raw_delta - 8 : raw_delta);
+				if (second < 0 || second > 31) return std::nullopt;
+				return std::pair(expand5(base), expand5(second));
+			};
+
+			const auto red = get_channel(56);
+			const auto green = get_channel(48);
+			const auto blue = get_channel(40);
+			if (!red || !green || !blue) return std::nullopt;
+
+			colors[0] = {red->first, green->first, blue->first};
+			colors[1] = {red->second, green->second, blue->second};
+		}
+		else
+		{
+			const auto get_channel = [bits](uint32_t shift) {
+				return expand4(static_cast<int32_t>(bits >> shift & 0xF));
+			};
+
+			colors[0] = {get_channel(60), get_channel(52), get_channel(44)};
+			colors[1] = {get_channel(56), get_channel(48), get_channel(40)};
+		}
+
+		const auto tables = std::array{bits >> 37 & 0x7, bits >> 34 & 0x7};
+
+		std::array<glm::u8vec3, 16> result;
+		for (const auto idx : std::views::iota(0u, 16u))
+		{
+			const auto subblock = (flip ? idx / 4 : idx % 4) >= 2 ? 1 : 0;
+			const auto position = column_major(idx);
+			const auto index = (bits >> (16 + position) & 1) << 1 | (bits >> position & 1);
+			const auto modifier = ETC_MODIFIERS[tables[subblock]][index];
+			result[idx] = glm::u8vec3(glm::clamp(colors[subblock] + modifier, 0, 255));
+		}
+
+		return result;
+	}
+
+	/* EAC */
+
+	// Fit an EAC block to the values, `decode(base, multiplier, modifier)` maps to the value range
+	[[nodiscard]]
+	static uint64_t encode_eac(
+		const std::array<int32_t, 16>& values,
+		int32_t value_scale,
+		bool allow_zero_multiplier,
+		auto decode
+	) noexcept
+	{
+		const auto [min_value, max_value] = std::ranges::minmax(values);
+		const auto mid_value = static_cast<float>(min_value + max_value) / 2.0f;
+
+		uint64_t best_bits = 0;
+		auto best_error = std::numeric_limits<uint64_t>::max();
+
+		for (const auto [table, modifiers] : EAC_MODIFIERS | std::views::enumerate)
+		{
+			const auto [min_modifier, max_modifier] = std::ranges::minmax(modifiers);
+			const auto mid_modifier = static_cast<float>(min_modifier + max_modifier) / 2.0f;
+
+			// Stretch the modifiers over the value range, in units of the base value
+			const auto span = static_cast<float>(max_value - min_value) / static_cast<float>(value_scale);
+			const auto ideal_multiplier = span / static_cast<float>(max_modifier - min_modifier);
+			const auto lower_multiplier = static_cast<int32_t>(std::floor(ideal_multiplier));
+
+			for (const auto multiplier : {lower_multiplier, lower_multiplier + 1})
+			{
+				if (multiplier > 15 || (multiplier < 1 && !allow_zero_multiplier)) continue;
+
+				// Center the modifiers on the value range, a zero multiplier steps in single units
+				const auto step = multiplier == 0 ? 1.0f : static_cast<float>(multiplier * value_scale);
+				const auto center = (mid_value - mid_modifier * step) / static_cast<float>(value_scale);
+				const auto center_base = static_cast<int32_t>(std::round(center));
+
+				for (const auto base : {center_base - 1, center_base, center_base + 1})
+				{
+					if (base < 0 || base > 255) continue;
+
+					uint64_t bits = uint64_t(base) << 56 | uint64_t(multiplier) << 52 | uint64_t(table) << 48;
+					uint64_t error = 0;
+
+					for (const auto [idx, value] : values | std::views::enumerate)
+					{
+						auto best_value_error = std::numeric_limits<uint64_t>::max();
+						uint64_t best_index = 0;
+
+						for (const auto [modifier_idx, modifier] : modifiers | std::views::enumerate)
+						{
+							const auto diff = decode(base, multiplier, modifier) - value;
+							const auto value_error = static_cast<uint64_t>(diff * diff);
+							if (value_error >= best_value_error) continue;
+
+							best_value_error = value_error;
+							best_index = static_cast<uint64_t>(modifier_idx);
+						}
+
+						error += best_value_error;
+						bits |= best_index << (45 - 3 * column_major(static_cast<uint32_t>(idx)));
+					}
+
+					if (error >= best_error) continue;
+					best_error = error;
+					best_bits = bits;
+				}
+			}
+		}
+
+		return best_bits;
+	}
+
+	// Decode the values of an EAC block, see `encode_eac`
+	[[nodiscard]]
+	static std::array<int32_t, 16> decode_eac(uint64_t bits, auto decode) noexcept
+	{
+		const auto base = static_cast<int32_t>(bits >> 56 & 0xFF);
+		const auto multiplier = static_cast<int32_t>(bits >> 52 & 0xF);
+		const auto& modifiers = EAC_MODIFIERS[bits >> 48 & 0xF];
+
+		std::array<int32_t, 16> values;
+		for (const auto idx : std::views::iota(0u, 16u))
+		{
+			const auto index = bits >> (45 - 3 * column_major(idx)) & 0x7;
+			values[idx] = decode(base, multiplier, modifiers[index]);
+		}
+
+		return values;
+	}
+
+	// 8-bit alpha of ETC2 RGBA8
+	[[nodiscard]]
+	static int32_t decode_alpha(int32_t base, int32_t multiplier, int32_t modifier) noexcept
+	{
+		return std::clamp(base + modifier * multiplier, 0, 255);
+	}
+
+	// 11-bit unsigned channel of EAC R11/RG11, a zero multiplier steps in single 11-bit units
+	[[nodiscard]]
+	static int32_t decode_r11(int32_t base, int32_t multiplier, int32_t modifier) noexcept
+	{
+		const auto step = multiplier == 0 ? modifier : modifier * multiplier * 8;
+		return std::clamp(base * 8 + 4 + step, 0, 2047);
+	}
+
+	// Values of a channel, rescaled from 8 bits to `[0, max_value]`
+	[[nodiscard]]
+	static std::array<int32_t, 16> get_channel_values(
+		const PixelBlock& pixels,
+		uint32_t channel,
+		int32_t max_value
+	) noexcept
+	{
+		std::array<int32_t, 16> values;
+		for (const auto [value, pixel] : std::views::zip(values, pixels))
+			value = (static_cast<int32_t>(pixel[channel]) * max_value + 127) / 255;
+		return values;
+	}
+
+	/* Public */
+
+	BCnBlock encode_etc2_rgba_block(const PixelBlock& pixels) noexcept
+	{
+		BCnBlock block;
+		write_half(block, 0, encode_eac(get_channel_values(pixels, 3, 255), 1, false, decode_alpha));
+		write_half(block, 8, encode_etc2_color(pixels));
+		return block;
+	}
+
+	BCnBlock encode_eac_rg11_block(const PixelBlock& pixels) noexcept
+	{
+		BCnBlock block;
+		write_half(block, 0, encode_eac(get_channel_values(pixels, 0, 2047), 8, true, decode_r11));
+		write_half(block, 8, encode_eac(get_channel_values(pixels, 1, 2047), 8, true, decode_r11));
+		return block;
+	}
+
+	std::optional<PixelBlock> decode_etc2_rgba_block(const BCnBlock& block) noexcept
+	{
+		const auto colors = decode_etc2_color(read_half(block, 8));
+		if (!colors) return std::nullopt;
+
+		const auto alphas = decode_eac(read_half(block, 0), decode_alpha);
+
+		PixelBlock pixels;
+		for (const auto [pixel, color, alpha] : std::views::zip(pixels, *colors, alphas))
+			pixel = glm::u8vec4(color, static_cast<uint8_t>(alpha));
+		return pixels;
+	}
+
+	PixelBlock decode_eac_rg11_block(const BCnBlock& block) noexcept
+	{
+		const auto reds = decode_eac(read_half(block, 0), decode_r11);
+		const auto greens = decode_eac(read_half(block, 8), decode_r11);
+
+		const auto to_unorm8 = [](int32_t value) {
+			return static_cast<uint8_t>((value * 255 + 1023) / 2047);
+		};
+
+		PixelBlock pixels;
+		for (const auto [pixel, red, green] : std::views::zip(pixels, reds, greens))
+			pixel = glm::u8vec4(to_unorm8(red), to_unorm8(green), 0, 255);
+		return pixels;
+	}
+}
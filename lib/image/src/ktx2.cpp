@@ -0,0 +1,173 @@
+#include "image/ktx2.hpp"
+#include "common/util/error.hpp"
+#include "image/bc-image.hpp"
+#include "image/impl/ktx2.hpp"
+
+#include <algorithm>
+#include <array>
+#include <basisu/basisu_transcoder.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <format>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace image
+{
+	static std::once_flag basisu_init_flag;
+
+	static constexpr auto KTX2_IDENTIFIER = std::to_array<uint8_t>(
+		{0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A}
+	);
+
+	// (Helper) Initialize the KTX2 transcoder on the data, the data must outlive the transcoder
+	[[nodiscard]]
+	static std::expected<void, Error> init_transcoder(
+		basist::ktx2_transcoder& transcoder,
+		std::span<const std::byte> encoded_data
+	) noexcept
+	{
+		std::call_once(basisu_init_flag, basist::basisu_transcoder_init);
+
+		if (!Ktx2Image::is_ktx2(encoded_data)) return Error("Data is not a KTX2 container");
+
+		if (!transcoder.init(encoded_data.data(), static_cast<uint32_t>(encoded_data.size())))
+			return Error("Read KTX2 header failed", "Only ETC1S and UASTC supercompressed data is supported");
+
+		if (transcoder.get_width() == 0 || transcoder.get_height() == 0)
+			return Error(
+				"Invalid KTX2 extent",
+				std::format("{}x{}", transcoder.get_width(), transcoder.get_height())
+			);
+
+		if (!transcoder.start_transcoding()) return Error("Start KTX2 transcoding failed");
+
+		return {};
+	}
+
+	[[nodiscard]]
+	static basist::transcoder_texture_format get_transcoder_format(BCnFormat format) noexcept
+	{
+		switch (format)
+		{
+		case BCnFormat::BC3:
+			return basist::transcoder_texture_format::cTFBC3_RGBA;
+		case BCnFormat::BC5:
+			return basist::transcoder_texture_format::cTFBC5_RG;
+		case BCnFormat::BC7:
+			return basist::transcoder_texture_format::cTFBC7_RGBA;
+		case BCnFormat::ETC2:
+			return basist::transcoder_texture_format::cTFETC2_RGBA;
+		case BCnFormat::EAC_RG11:
+			return basist::transcoder_texture_format::cTFETC2_EAC_RG11;
+		case BCnFormat::ASTC4x4:
+			return basist::transcoder_texture_format::cTFASTC_4x4_RGBA;
+		default:
+			UNREACHABLE("Invalid BCn format", format);
+		}
+	}
+
+	bool Ktx2Image::is_ktx2(std::span<const std::byte> encoded_data) noexcept
+	{
+		return encoded_data.size() >= KTX2_IDENTIFIER.size()
+			&& std::memcmp(encoded_data.data(), KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) == 0;
+	}
+
+	std::expected<Ktx2Image, Error> Ktx2Image::transcode(
+		std::span<const std::byte> encoded_data,
+		BCnFormat format,
+		uint32_t max_size
+	) noexcept
+	{
+		basist::ktx2_transcoder transcoder;
+		if (const auto result = init_transcoder(transcoder, encoded_data); !result)
+			return result.error().forward("Initialize KTX2 transcoder failed");
+
+		const auto level_count = std::max(transcoder.get_levels(), 1u);
+		const auto transcoder_format = get_transcoder_format(format);
+
+		// Two-channel formats take the red and green channels, as glTF normal maps do
+		const bool two_channel = format == BCnFormat::BC5 || format == BCnFormat::EAC_RG11;
+		const int channel0 = two_channel ? 0 : -1;
+		const int channel1 = two_channel ? 1 : -1;
+
+		auto image = Ktx2Image{.format = format, .has_alpha = transcoder.get_has_alpha(), .levels = {}};
+
+		for (const auto level : std::views::iota(0u, level_count))
+		{
+			basist::ktx2_image_level_info level_info;
+			if (!transcoder.get_image_level_info(level_info, level, 0, 0))
+				return Error("Get KTX2 level info failed", std::format("Level {}", level));
+
+			const auto extent = glm::u32vec2(level_info.m_orig_width, level_info.m_orig_height);
+			if (max_size != 0 && std::max(extent.x, extent.y) > max_size && level + 1 < level_count)
+				continue;
+
+			auto blocks = std::vector<BCnBlock>(level_info.m_total_blocks);
+			if (!transcoder.transcode_image_level(
+					level,
+					0,
+					0,
+					blocks.data(),
+					static_cast<uint32_t>(blocks.size()),
+					transcoder_format,
+					0,
+					0,
+					0,
+					channel0,
+					channel1
+				))
+				return Error("Transcode KTX2 level failed", std::format("Level {}", level));
+
+			image.levels.push_back({.extent = extent, .blocks = std::move(blocks)});
+		}
+
+		return image;
+	}
+}
+
+namespace image::impl
+{
+	std::expected<glm::u32vec2, Error> get_ktx2_extent(std::span<const std::byte> encoded_data) noexcept
+	{
+		basist::ktx2_transcoder transcoder;
+		if (const auto result = init_transcoder(transcoder, encoded_data); !result) return result.error();
+
+		return glm::u32vec2(transcoder.get_width(), transcoder.get_height());
+	}
+
+	std::expected<void, Error> transcode_ktx2_rgba8(
+		std::span<const std::byte> encoded_data,
+		std::span<std::byte> destination
+	) noexcept
+	{
+		basist::ktx2_transcoder transcoder;
+		if (const auto result = init_transcoder(transcoder, encoded_data); !result) return result.error();
+
+		const auto pixel_count = static_cast<size_t>(transcoder.get_width()) * transcoder.get_height();
+		if (destination.size() != pixel_count * 4)
+			return Error(
+				"Destination size mismatches KTX2 extent",
+				std::format("{} != {}", destination.size(), pixel_count * 4)
+			);
+
+		if (!transcoder.transcode_image_level(
+				0,
+				0,
+				0,
+				destination.data(),
+				static_cast<uint32_t>(pixel_count),
+				basist::transcoder_texture_format::cTFRGBA32
+			))
+			return Error("Transcode KTX2 base level failed");
+
+		return {};
+	}
+}
@@ -1,5 +1,13 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <doctest/doctest.h>
+#include <functional>
+#include <glm/common.hpp>
+#include <glm/ext/vector_int4.hpp>
 #include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <ranges>
 #include <span>
 #include <utility>
 
@@ -53,6 +61,44 @@ TEST_CASE("BC7")
 	CHECK_VEC2_EQ(bc7_image_result->size, 64, 64);
 }
 
+TEST_CASE("ETC2")
+{
+	auto decoded_image_result = ImageType::decode(checker_image_data);
+	EXPECT_SUCCESS(decoded_image_result);
+
+	const auto decoded_image = std::move(decoded_image_result.value());
+	REQUIRE_VEC2_EQ(decoded_image.size, 256, 256);
+
+	auto etc2_image_result = image::BCnImage::encode(decoded_image, image::BCnFormat::ETC2);
+	EXPECT_SUCCESS(etc2_image_result);
+	CHECK_EQ(etc2_image_result->format, image::BCnFormat::ETC2);
+	CHECK_VEC2_EQ(etc2_image_result->size, 64, 64);
+}
+
+TEST_CASE("EAC RG11")
+{
+	auto decoded_image_result = ImageType::decode(checker_image_data);
+	EXPECT_SUCCESS(decoded_image_result);
+
+	const auto decoded_image = std::move(decoded_image_result.value());
+	REQUIRE_VEC2_EQ(decoded_image.size, 256, 256);
+
+	auto eac_image_result = image::BCnImage::encode(decoded_image, image::BCnFormat::EAC_RG11);
+	EXPECT_SUCCESS(eac_image_result);
+	CHECK_EQ(eac_image_result->format, image::BCnFormat::EAC_RG11);
+	CHECK_VEC2_EQ(eac_image_result->size, 64, 64);
+}
+
+TEST_CASE("ASTC")
+{
+	auto decoded_image_result = ImageType::decode(checker_image_data);
+	EXPECT_SUCCESS(decoded_image_result);
+
+	// Only transcoded from KTX2, no encoder is available
+	auto astc_image_result = image::BCnImage::encode(*decoded_image_result, image::BCnFormat::ASTC4x4);
+	EXPECT_FAIL(astc_image_result);
+}
+
 TEST_CASE("BC3 Complex")
 {
 	auto decoded_image_result = ImageType::decode(complex_image_data);
@@ -107,4 +153,179 @@ TEST_CASE("Invalid dimension")
 
 	auto bc7_image_result = image::BCnImage::encode(invalid_image, image::BCnFormat::BC7);
 	EXPECT_FAIL(bc7_image_result);
+
+	auto etc2_image_result = image::BCnImage::encode(invalid_image, image::BCnFormat::ETC2);
+	EXPECT_FAIL(etc2_image_result);
+}
+
+TEST_CASE("Parallel")
+{
+	auto decoded_image_result = ImageType::decode(checker_image_data);
+	EXPECT_SUCCESS(decoded_image_result);
+
+	const auto decoded_image = std::move(decoded_image_result.value());
+	REQUIRE_VEC2_EQ(decoded_image.size, 256, 256);
+
+	// Tile the image so that it's large enough to be encoded in parallel
+	ImageType tiled_image(glm::u32vec2(1024, 1024));
+	for (uint32_t y = 0; y < tiled_image.size.y; y++)
+		for (uint32_t x = 0; x < tiled_image.size.x; x++)
+			tiled_image[x, y] = decoded_image[x % 256, y % 256];
+
+	for (const auto format :
+		 {image::BCnFormat::BC3, image::BCnFormat::BC5, image::BCnFormat::BC7, image::BCnFormat::ETC2})
+	{
+		auto image_result = image::BCnImage::encode(decoded_image, format);
+		EXPECT_SUCCESS(image_result);
+
+		auto tiled_result = image::BCnImage::encode(tiled_image, format);
+		EXPECT_SUCCESS(tiled_result);
+		REQUIRE_VEC2_EQ(tiled_result->size, 256, 256);
+		const auto block_count = size_t(tiled_result->size.x) * tiled_result->size.y;
+		REQUIRE_GE(block_count, image::BCnImage::PARALLEL_BLOCK_THRESHOLD);
+
+		// Every block is encoded independently, tiles must encode identically
+		bool all_equal = true;
+		for (uint32_t y = 0; y < tiled_result->size.y; y++)
+			for (uint32_t x = 0; x < tiled_result->size.x; x++)
+			{
+				const auto& tiled_block = tiled_result->data[y * 256 + x];
+				const auto& block = image_result->data[(y % 64) * 64 + x % 64];
+				all_equal &= tiled_block.data == block.data;
+			}
+		CHECK(all_equal);
+	}
+}
+
+TEST_CASE("BC7 Quality")
+{
+	auto decoded_image_result = ImageType::decode(checker_image_data);
+	EXPECT_SUCCESS(decoded_image_result);
+
+	const auto decoded_image = std::move(decoded_image_result.value());
+
+	auto high_quality_result = image::BCnImage::encode(
+		decoded_image,
+		image::BCnFormat::BC7,
+		{.uber_level = 4, .max_partitions = 64}
+	);
+	EXPECT_SUCCESS(high_quality_result);
+	CHECK_VEC2_EQ(high_quality_result->size, 64, 64);
+
+	auto fast_result =
+		image::BCnImage::encode(decoded_image, image::BCnFormat::BC7, {.uber_level = 0, .max_partitions = 1});
+	EXPECT_SUCCESS(fast_result);
+
+	auto invalid_uber_result =
+		image::BCnImage::encode(decoded_image, image::BCnFormat::BC7, {.uber_level = 5});
+	EXPECT_FAIL(invalid_uber_result);
+
+	auto invalid_partition_result =
+		image::BCnImage::encode(decoded_image, image::BCnFormat::BC7, {.max_partitions = 0});
+	EXPECT_FAIL(invalid_partition_result);
+}
+
+TEST_CASE("Decode")
+{
+	auto decoded_image_result = ImageType::decode(checker_image_data);
+	EXPECT_SUCCESS(decoded_image_result);
+	const auto decoded_image = std::move(decoded_image_result.value());
+
+	SUBCASE("BC3")
+	{
+		auto bc3_image_result = image::BCnImage::encode(decoded_image, image::BCnFormat::BC3);
+		EXPECT_SUCCESS(bc3_image_result);
+
+		auto roundtrip_result = bc3_image_result->decode();
+		EXPECT_SUCCESS(roundtrip_result);
+		REQUIRE_VEC2_EQ(roundtrip_result->size, 256, 256);
+
+		const auto total_error = std::ranges::fold_left(
+			std::views::zip_transform(
+				[](glm::u8vec4 a, glm::u8vec4 b) {
+					const auto diff = glm::abs(glm::ivec4(a) - glm::ivec4(b));
+					return size_t(diff.r + diff.g + diff.b + diff.a);
+				},
+				decoded_image.data,
+				roundtrip_result->data
+			),
+			0zu,
+			std::plus()
+		);
+		const auto mean_error = double(total_error) / (decoded_image.data.size() * 4);
+		CHECK_LT(mean_error, 8.0);
+	}
+
+	SUBCASE("BC5")
+	{
+		auto bc5_image_result = image::BCnImage::encode(decoded_image, image::BCnFormat::BC5);
+		EXPECT_SUCCESS(bc5_image_result);
+
+		auto roundtrip_result = bc5_image_result->decode();
+		EXPECT_SUCCESS(roundtrip_result);
+		REQUIRE_VEC2_EQ(roundtrip_result->size, 256, 256);
+		CHECK_EQ(roundtrip_result->data[0].b, 0);
+		CHECK_EQ(roundtrip_result->data[0].a, 255);
+	}
+
+	SUBCASE("BC7")
+	{
+		auto bc7_image_result = image::BCnImage::encode(decoded_image, image::BCnFormat::BC7);
+		EXPECT_SUCCESS(bc7_image_result);
+
+		auto roundtrip_result = bc7_image_result->decode();
+		EXPECT_FAIL(roundtrip_result);
+	}
+
+	SUBCASE("ETC2")
+	{
+		auto etc2_image_result = image::BCnImage::encode(decoded_image, image::BCnFormat::ETC2);
+		EXPECT_SUCCESS(etc2_image_result);
+
+		auto roundtrip_result = etc2_image_result->decode();
+		EXPECT_SUCCESS(roundtrip_result);
+		REQUIRE_VEC2_EQ(roundtrip_result->size, 256, 256);
+
+		const auto total_error = std::ranges::fold_left(
+			std::views::zip_transform(
+				[](glm::u8vec4 a, glm::u8vec4 b) {
+					const auto diff = glm::abs(glm::ivec4(a) - glm::ivec4(b));
+					return size_t(diff.r + diff.g + diff.b + diff.a);
+				},
+				decoded_image.data,
+				roundtrip_result->data
+			),
+			0zu,
+			std::plus()
+		);
+		const auto mean_error = double(total_error) / (decoded_image.data.size() * 4);
+		CHECK_LT(mean_error, 12.0);
+	}
+
+	SUBCASE("EAC RG11")
+	{
+		auto eac_image_result = image::BCnImage::encode(decoded_image, image::BCnFormat::EAC_RG11);
+		EXPECT_SUCCESS(eac_image_result);
+
+		auto roundtrip_result = eac_image_result->decode();
+		EXPECT_SUCCESS(roundtrip_result);
+		REQUIRE_VEC2_EQ(roundtrip_result->size, 256, 256);
+		CHECK_EQ(roundtrip_result->data[0].b, 0);
+		CHECK_EQ(roundtrip_result->data[0].a, 255);
+
+		const auto total_error = std::ranges::fold_left(
+			std::views::zip_transform(
+				[](glm::u8vec4 a, glm::u8vec4 b) {
+					const auto diff = glm::abs(glm::ivec4(a) - glm::ivec4(b));
+					return size_t(diff.r + diff.g);
+				},
+				decoded_image.data,
+				roundtrip_result->data
+			),
+			0zu,
+			std::plus()
+		);
+		const auto mean_error = double(total_error) / (decoded_image.data.size() * 2);
+		CHECK_LT(mean_error, 4.0);
+	}
 }
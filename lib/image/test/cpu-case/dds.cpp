@@ -0,0 +1,99 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "common/test-macro.hpp"
+#include "image/bc-image.hpp"
+#include "image/dds.hpp"
+
+// Build a DDS file of `block_count` blocks, each filled with its index
+static std::vector<std::byte> make_dds(
+	uint32_t width,
+	uint32_t height,
+	uint32_t mipmap_count,
+	std::string_view fourcc,
+	uint32_t dxgi_format,
+	size_t block_count
+) noexcept
+{
+	const bool dx10 = fourcc == "DX10";
+	auto data = std::vector<std::byte>((dx10 ? 148 : 128) + block_count * 16);
+
+	const auto write_u32 = [&data](size_t offset, uint32_t value) {
+		std::memcpy(data.data() + offset, &value, sizeof(value));
+	};
+
+	std::memcpy(data.data(), "DDS ", 4);
+	write_u32(4, 124);
+	write_u32(8, 0x1007 | 0x20000);
+	write_u32(12, height);
+	write_u32(16, width);
+	write_u32(28, mipmap_count);
+	write_u32(76, 32);
+	std::memcpy(data.data() + 84, fourcc.data(), 4);
+	if (dx10) write_u32(128, dxgi_format);
+
+	const auto blocks = std::span(data).subspan(dx10 ? 148 : 128);
+	for (size_t i = 0; i < block_count; i++) blocks[i * 16] = static_cast<std::byte>(i);
+
+	return data;
+}
+
+TEST_CASE("Read DDS")
+{
+	// 8x8 -> 2x2 blocks, then 1 block for each of 4x4, 2x2 and 1x1
+	const auto bc7_data = make_dds(8, 8, 4, "DX10", 98, 7);
+	CHECK(image::DdsImage::is_dds(bc7_data));
+
+	SUBCASE("Full chain")
+	{
+		auto dds_result = image::DdsImage::read(bc7_data);
+		EXPECT_SUCCESS(dds_result);
+		CHECK_EQ(dds_result->format, image::BCnFormat::BC7);
+
+		REQUIRE_EQ(dds_result->levels.size(), 4);
+		CHECK_VEC2_EQ(dds_result->levels[0].extent, 8, 8);
+		CHECK_VEC2_EQ(dds_result->levels[3].extent, 1, 1);
+		CHECK_EQ(dds_result->levels[0].blocks.size(), 4);
+		CHECK_EQ(dds_result->levels[1].blocks[0].data[0], std::byte(4));
+	}
+
+	SUBCASE("Size limited")
+	{
+		auto dds_result = image::DdsImage::read(bc7_data, 2);
+		EXPECT_SUCCESS(dds_result);
+
+		REQUIRE_EQ(dds_result->levels.size(), 2);
+		CHECK_VEC2_EQ(dds_result->levels[0].extent, 2, 2);
+		CHECK_EQ(dds_result->levels[0].blocks[0].data[0], std::byte(5));
+	}
+
+	SUBCASE("Legacy FourCC")
+	{
+		auto dds_result = image::DdsImage::read(make_dds(4, 4, 1, "ATI2", 0, 1));
+		EXPECT_SUCCESS(dds_result);
+		CHECK_EQ(dds_result->format, image::BCnFormat::BC5);
+		CHECK_EQ(dds_result->levels.size(), 1);
+	}
+}
+
+TEST_CASE("Invalid DDS")
+{
+	auto truncated_result = image::DdsImage::read(make_dds(8, 8, 4, "DX10", 98, 6));
+	EXPECT_FAIL(truncated_result);
+
+	auto bc1_result = image::DdsImage::read(make_dds(4, 4, 1, "DXT1", 0, 1));
+	EXPECT_FAIL(bc1_result);
+
+	auto bc1_dx10_result = image::DdsImage::read(make_dds(4, 4, 1, "DX10", 71, 1));
+	EXPECT_FAIL(bc1_dx10_result);
+
+	auto empty_result = image::DdsImage::read(make_dds(0, 4, 1, "DXT5", 0, 1));
+	EXPECT_FAIL(empty_result);
+
+	CHECK_FALSE(image::DdsImage::is_dds(std::vector<std::byte>(3)));
+}
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <doctest/doctest.h>
 #include <functional>
+#include <glm/ext/vector_uint1_sized.hpp>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <glm/ext/vector_uint4_sized.hpp>
 #include <glm/fwd.hpp>
@@ -110,6 +111,34 @@ TEST_SUITE("Decode")
 		CHECK_VEC4_EQ((decoded_image[8, 8]), 255, 255, 255, 255);
 	}
 
+	TEST_CASE("16bit JPG")
+	{
+		using Image8Type = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+		using Image16Type = image::Image<image::Format::Unorm16, image::Layout::RGBA>;
+
+		auto decoded_image8_result = Image8Type::decode(load8_jpg_data);
+		EXPECT_SUCCESS(decoded_image8_result);
+		auto decoded_image16_result = Image16Type::decode(load8_jpg_data);
+		EXPECT_SUCCESS(decoded_image16_result);
+
+		// 8-bit components are expanded to the full 16-bit range
+		REQUIRE_VEC2_EQ(decoded_image16_result->size, 16, 16);
+		const auto& data8 = decoded_image8_result->data;
+		const auto& data16 = decoded_image16_result->data;
+		for (const auto [pixel8, pixel16] : std::views::zip(data8, data16))
+			CHECK(glm::all(glm::equal(glm::u16vec4(pixel8) * uint16_t(0x0101), pixel16)));
+	}
+
+	TEST_CASE("Grey JPG")
+	{
+		using ImageType = image::Image<image::Format::Unorm8, image::Layout::Grey>;
+
+		auto decoded_image_result = ImageType::decode(load8_jpg_data);
+		EXPECT_SUCCESS(decoded_image_result);
+		REQUIRE_VEC2_EQ(decoded_image_result->size, 16, 16);
+		CHECK_GE(((*decoded_image_result)[8, 8].x), 250);
+	}
+
 	TEST_CASE("Large image PNG")
 	{
 		using ImageType = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
@@ -132,6 +161,34 @@ TEST_SUITE("Decode")
 		REQUIRE_VEC2_EQ(decoded_image.size, 256, 256);
 	}
 
+	TEST_CASE("Reduced resolution")
+	{
+		using ImageType = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+
+		SUBCASE("JPG")
+		{
+			// Reduced while decoding, the larger dimension stays at least the hint
+			auto decoded_image_result = ImageType::decode(load8_jpg_data, 6);
+			EXPECT_SUCCESS(decoded_image_result);
+			REQUIRE_VEC2_EQ(decoded_image_result->size, 8, 8);
+			CHECK_GE((*decoded_image_result)[4, 4].r, 250);
+		}
+
+		SUBCASE("PNG")
+		{
+			auto decoded_image_result = ImageType::decode(checker_image_data, 64);
+			EXPECT_SUCCESS(decoded_image_result);
+			REQUIRE_VEC2_EQ(decoded_image_result->size, 64, 64);
+		}
+
+		SUBCASE("Already small")
+		{
+			auto decoded_image_result = ImageType::decode(load8_png_data, 4);
+			EXPECT_SUCCESS(decoded_image_result);
+			REQUIRE_VEC2_EQ(decoded_image_result->size, 2, 2);
+		}
+	}
+
 	TEST_CASE("Invalid Image")
 	{
 		using ImageType = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
@@ -258,6 +315,23 @@ TEST_SUITE("Resize")
 		CHECK_VEC4_EQ((resized_image[3, 3]), 255, 255, 255, 255);
 	}
 
+	TEST_CASE("Box downsample")
+	{
+		using ImageType = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+
+		auto decoded_image_result = ImageType::decode(load8_png_data);
+		EXPECT_SUCCESS(decoded_image_result);
+
+		const auto downsampled_image = decoded_image_result->downsample_box(1);
+		REQUIRE_VEC2_EQ(downsampled_image.size, 1, 1);
+
+		// Average of red, green, blue and white, rounded
+		CHECK_VEC4_EQ((downsampled_image[0, 0]), 128, 128, 128, 255);
+
+		// Factors larger than the image keep at least one pixel
+		CHECK_VEC2_EQ(decoded_image_result->downsample_box(3).size, 1, 1);
+	}
+
 	TEST_CASE("Big")
 	{
 		using ImageType = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
@@ -436,3 +510,64 @@ TEST_CASE("Flip Y")
 		for (const auto x : std::views::iota(0_u32, img.size.x))
 			if (img[x, y] != flipped_img[x, img.size.y - 1 - y]) FAIL("Pixel mismatched");
 }
+
+TEST_CASE("Convert")
+{
+	using Unorm8Image = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+	using Unorm16Image = image::Image<image::Format::Unorm16, image::Layout::RGBA>;
+
+	auto img_result = Unorm8Image::decode(complex_image_data);
+	EXPECT_SUCCESS(img_result);
+
+	// Odd size, so that the vectorized kernels leave a scalar tail
+	const auto img = img_result->resize({37, 5});
+	const auto img16 = img.map([](glm::u8vec4 pixel) { return glm::u16vec4(pixel) * 0x0101_u16; });
+
+	SUBCASE("Unorm8 RGBA to RG")
+	{
+		const auto converted = img.convert<image::Format::Unorm8, image::Layout::RG>();
+		REQUIRE_VEC2_EQ_ALT(converted.size, img.size);
+		CHECK(std::ranges::equal(converted.data, img.data, {}, {}, [](glm::u8vec4 pixel) {
+			return glm::u8vec2(pixel);
+		}));
+	}
+
+	SUBCASE("Unorm16 RGBA to RG")
+	{
+		const auto converted = img16.convert<image::Format::Unorm16, image::Layout::RG>();
+		CHECK(std::ranges::equal(converted.data, img16.data, {}, {}, [](glm::u16vec4 pixel) {
+			return glm::u16vec2(pixel);
+		}));
+	}
+
+	SUBCASE("Unorm8 to Unorm16")
+	{
+		const auto converted = img.convert<image::Format::Unorm16, image::Layout::RGBA>();
+		CHECK(std::ranges::equal(converted.data, img16.data));
+	}
+
+	SUBCASE("Unorm16 to Unorm8")
+	{
+		const auto converted = img16.convert<image::Format::Unorm8, image::Layout::RGBA>();
+		CHECK(std::ranges::equal(converted.data, img.data));
+	}
+
+	SUBCASE("Without kernel")
+	{
+		const auto converted = img16.convert<image::Format::Unorm8, image::Layout::Grey>();
+		CHECK(std::ranges::equal(converted.data, img.data, {}, {}, [](glm::u8vec4 pixel) {
+			return glm::u8vec1(pixel.r);
+		}));
+	}
+
+	SUBCASE("Min alpha")
+	{
+		auto transparent = img;
+		transparent[36, 4].a = 3;
+		transparent[5, 0].a = 7;
+
+		CHECK_EQ(Unorm8Image({37, 5}, {0, 0, 0, 200}).min_alpha(), 200);
+		CHECK_EQ(transparent.min_alpha(), 3);
+		CHECK_EQ(transparent.convert<image::Format::Unorm16, image::Layout::RGBA>().min_alpha(), 0x0303);
+	}
+}
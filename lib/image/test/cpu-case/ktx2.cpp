@@ -0,0 +1,39 @@
+#include <cstddef>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <span>
+#include <vector>
+
+#include "common/test-macro.hpp"
+#include "common/util/span.hpp"
+#include "image/bc-image.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "image/ktx2.hpp"
+#include "test-asset.hpp"
+
+// KTX2 identifier followed by a header truncated to nothing
+static const std::vector<uint8_t> truncated_ktx2_data =
+	{0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x00};
+
+TEST_CASE("Detect KTX2")
+{
+	CHECK(image::Ktx2Image::is_ktx2(util::as_bytes(truncated_ktx2_data)));
+	CHECK_FALSE(image::Ktx2Image::is_ktx2(checker_image_data));
+	CHECK_FALSE(image::Ktx2Image::is_ktx2(util::as_bytes(std::span(truncated_ktx2_data).first(8))));
+}
+
+TEST_CASE("Invalid KTX2")
+{
+	auto transcode_result =
+		image::Ktx2Image::transcode(util::as_bytes(truncated_ktx2_data), image::BCnFormat::BC7);
+	EXPECT_FAIL(transcode_result);
+
+	auto non_ktx2_result = image::Ktx2Image::transcode(checker_image_data, image::BCnFormat::BC7);
+	EXPECT_FAIL(non_ktx2_result);
+
+	// Decoding dispatches to the KTX2 backend by the identifier
+	using ImageType = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+	auto decode_result = ImageType::decode(util::as_bytes(truncated_ktx2_data));
+	EXPECT_FAIL(decode_result);
+}
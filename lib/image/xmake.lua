@@ -1,14 +1,19 @@
 -- Third-party libraries
 includes("package/*.lua")
-add_requires("stb_dxt", "bc7enc")
+add_requires("stb_dxt", "bc7enc", "basisu")
 add_requires(
 	"stb 2025.03.14",
-	"libwebp v1.3.0"
+	"libwebp v1.3.0",
+	"libjpeg-turbo 3.0.1",
+	"libspng v0.7.4"
 )
 
 -- Unit tests
 includes("test")
 
+-- Benchmarks
+includes("bench")
+
 -- Image decoding library
 target("lib.image")
 	set_kind("static")
@@ -18,6 +23,6 @@ target("lib.image")
 	add_deps("lib.common", {public = true})
 	
 	add_packages("stb", "glm", {public = true})
-	add_packages("stb_dxt", "bc7enc", "libwebp")
+	add_packages("stb_dxt", "bc7enc", "basisu", "libwebp", "libjpeg-turbo", "libspng")
 
 	add_files("asset/blue-noise.png", {rules = "utils.bin2obj"})
\ No newline at end of file
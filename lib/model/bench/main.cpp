@@ -0,0 +1,209 @@
+#define ANKERL_NANOBENCH_IMPLEMENT
+
+#include "common/file.hpp"
+#include "common/util/error.hpp"
+#include "model/hierarchy.hpp"
+#include "model/mesh.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <format>
+#include <functional>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/trigonometric.hpp>
+#include <iostream>
+#include <nanobench.h>
+#include <optional>
+#include <print>
+#include <ranges>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Node counts of the synthetic hierarchies, for scaling curves up to a million nodes
+static constexpr auto NODE_COUNTS = std::to_array<uint32_t>({1024, 16384, 262144, 1048576});
+
+// Quads along each side of the synthetic grid meshes, two triangles each
+static constexpr auto GRID_SIZES = std::to_array<uint32_t>({64, 256, 1024});
+
+// Distinct meshes referenced by the nodes, which carries over to the drawcalls
+static constexpr uint32_t MESH_COUNT = 16;
+
+///
+/// @brief Shape of the synthetic hierarchy
+///
+struct HierarchyShape
+{
+	std::string_view name;
+	std::function<std::optional<uint32_t>(uint32_t)> parent_of;  // Parent of each node, root is node 0
+};
+
+static const auto HIERARCHY_SHAPES = std::to_array<HierarchyShape>({
+	{"Chain", [](uint32_t i) { return i == 0 ? std::nullopt : std::optional(i - 1); }},
+	{"Fan", [](uint32_t i) { return i == 0 ? std::nullopt : std::optional(0u); }},
+	{"Tree", [](uint32_t i) { return i == 0 ? std::nullopt : std::optional((i - 1) / 8); }},
+});
+
+// Every node carries a slightly different transform and one of `MESH_COUNT` meshes
+static std::vector<model::ParentOnlyNode> create_nodes(const HierarchyShape& shape, uint32_t count) noexcept
+{
+	return std::views::iota(0u, count)
+		| std::views::transform([&shape](uint32_t i) {
+			  const auto phase = static_cast<float>(i) * 0.01f;
+
+			  return model::ParentOnlyNode{
+				  .parent_index = shape.parent_of(i),
+				  .data = {
+					  .transform =
+						  {.scale = glm::vec3(1.0f),
+						   .rotation = glm::angleAxis(phase, glm::vec3(0.0f, 1.0f, 0.0f)),
+						   .translation = glm::vec3(0.1f, 0.0f, 0.0f)},
+					  .mesh_index = i % MESH_COUNT,
+				  },
+			  };
+		  })
+		| std::ranges::to<std::vector>();
+}
+
+// Undulating grid in the XZ plane, with vertices shared between neighboring quads
+static std::pair<std::vector<model::NormalOnlyVertex>, std::vector<uint32_t>> create_grid(
+	uint32_t size
+) noexcept
+{
+	const auto stride = size + 1;
+
+	auto vertices = std::views::iota(0u, stride * stride)
+		| std::views::transform([size, stride](uint32_t i) {
+			  const auto uv = glm::vec2(i % stride, i / stride) / static_cast<float>(size);
+			  const auto height = 0.05f * glm::sin(uv.x * 20.0f) * glm::cos(uv.y * 20.0f);
+
+			  return model::NormalOnlyVertex{
+				  .position = glm::vec3(uv.x, height, uv.y),
+				  .texcoord = uv,
+				  .normal = glm::vec3(0.0f, 1.0f, 0.0f),
+			  };
+		  })
+		| std::ranges::to<std::vector>();
+
+	auto indices = std::vector<uint32_t>();
+	indices.reserve(size_t(size) * size * 6);
+
+	for (const auto y : std::views::iota(0u, size))
+		for (const auto x : std::views::iota(0u, size))
+		{
+			const auto base = y * stride + x;
+			indices.append_range(std::to_array({base, base + stride, base + 1}));
+			indices.append_range(std::to_array({base + 1, base + stride, base + stride + 1}));
+		}
+
+	return {std::move(vertices), std::move(indices)};
+}
+
+static std::expected<void, Error> bench_hierarchy(ankerl::nanobench::Bench& bench) noexcept
+{
+	for (const auto& shape : HIERARCHY_SHAPES)
+		for (const auto count : NODE_COUNTS)
+		{
+			const auto nodes = create_nodes(shape, count);
+			auto hierarchy_result = model::Hierarchy::create(nodes);
+			if (!hierarchy_result) return hierarchy_result.error().forward("Create hierarchy failed");
+			const auto hierarchy = std::move(*hierarchy_result);
+
+			bench.unit("node").batch(count);
+
+			bench.title("Hierarchy::create").run(std::format("{} {}", shape.name, count), [&nodes] {
+				ankerl::nanobench::doNotOptimizeAway(model::Hierarchy::create(nodes));
+			});
+
+			bench.title("Hierarchy::compute_transforms")
+				.run(std::format("{} {}", shape.name, count), [&hierarchy] {
+					ankerl::nanobench::doNotOptimizeAway(hierarchy.compute_transforms(glm::mat4(1.0f)));
+				});
+
+			bench.title("Hierarchy::get_drawcalls")
+				.run(std::format("{} {}", shape.name, count), [&hierarchy] {
+					ankerl::nanobench::doNotOptimizeAway(hierarchy.get_drawcalls());
+				});
+		}
+
+	return {};
+}
+
+static std::expected<void, Error> bench_geometry(ankerl::nanobench::Bench& bench) noexcept
+{
+	for (const auto size : GRID_SIZES)
+	{
+		const auto [vertices, indices] = create_grid(size);
+		const auto triangle_count = indices.size() / 3;
+		const auto name = std::format("Grid {}x{}", size, size);
+
+		bench.unit("triangle").batch(triangle_count);
+
+		// Per-triangle tangents of the expanded geometry, as loaders do without indexed tangent generation
+		const auto triangles = indices
+			| std::views::chunk(3)
+			| std::views::transform([&vertices](auto triangle) {
+				  return std::to_array({vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]]});
+			  })
+			| std::ranges::to<std::vector>();
+
+		bench.title("NormalOnlyVertex::construct_tangent").run(name, [&triangles] {
+			for (const auto& triangle : triangles)
+				ankerl::nanobench::doNotOptimizeAway(model::NormalOnlyVertex::construct_tangent(triangle));
+		});
+
+		bench.title("util::generate_tangents").run(name, [&vertices, &indices] {
+			ankerl::nanobench::doNotOptimizeAway(model::util::generate_tangents(vertices, indices));
+		});
+
+		const auto full_vertices_result = model::util::generate_tangents(vertices, indices);
+		if (!full_vertices_result) return full_vertices_result.error().forward("Generate tangents failed");
+		const auto& full_vertices = *full_vertices_result;
+
+		bench.title("Geometry::create").run(name, [&full_vertices, &indices] {
+			ankerl::nanobench::doNotOptimizeAway(model::Geometry::create(full_vertices, indices));
+		});
+	}
+
+	return {};
+}
+
+int main(int argc, const char* argv[]) noexcept
+{
+	if (argc > 2)
+	{
+		std::println(std::cerr, "Usage: {} [output.json]", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	auto bench = ankerl::nanobench::Bench();
+	bench.warmup(1).minEpochIterations(1).performanceCounters(false);
+
+	for (const auto run : {bench_hierarchy, bench_geometry})
+		if (const auto result = run(bench); !result)
+		{
+			std::println(std::cerr, "Error: {}", result.error().root());
+			return EXIT_FAILURE;
+		}
+
+	if (argc < 2) return EXIT_SUCCESS;
+
+	// Machine-readable results, one entry per benchmark with its timings and batch size
+	auto json = std::ostringstream();
+	ankerl::nanobench::render(ankerl::nanobench::templates::json(), bench, json);
+
+	if (const auto result = file::write(argv[1], json.view()); !result)
+	{
+		std::println(std::cerr, "Error: {}", result.error().root());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "hierarchy.hpp"
+
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <span>
+#include <vector>
+
+namespace model
+{
+	///
+	/// @brief Skin, binding the vertices of skinned primitives to joint nodes
+	/// @details The skinned vertices are in the space of the node referencing the skin and the mesh, so they
+	/// go through the node transform like static vertices
+	///
+	struct Skin
+	{
+		std::vector<uint32_t> joints;                  // Node index of each joint
+		std::vector<glm::mat4> inverse_bind_matrices;  // From mesh space to each joint, one per joint
+
+		///
+		/// @brief Compute the matrix of each joint, from bind-pose vertices to the space of a skinned node
+		///
+		/// @param world_transforms World transforms of all nodes, see `Hierarchy::compute_transforms`
+		/// @param node_index Node referencing the skin
+		/// @return Joint matrices, one-to-one corresponding to `joints`
+		///
+		[[nodiscard]]
+		std::vector<glm::mat4> compute_joint_matrices(
+			std::span<const glm::mat4> world_transforms,
+			uint32_t node_index
+		) const noexcept;
+	};
+
+	///
+	/// @brief Animation channel, animating a property of a node with keyframes
+	///
+	struct AnimationChannel
+	{
+		///
+		/// @brief Animated property
+		///
+		enum class Path
+		{
+			Translation,  // `Transform::translation`, 3 components
+			Rotation,     // `Transform::rotation`, 4 components in XYZW order
+			Scale,        // `Transform::scale`, 3 components
+			Weights       // Morph target weights of the node's mesh, one component per target
+		};
+
+		///
+		/// @brief Interpolation between keyframes, as defined by glTF
+		///
+		enum class Interpolation
+		{
+			Step,        // Value of the previous keyframe
+			Linear,      // Linear, spherical linear for rotations
+			CubicSpline  // Cubic Hermite spline, keyframes hold in-tangent, value and out-tangent
+		};
+
+		uint32_t node_index;
+		Path path;
+		Interpolation interpolation;
+		uint32_t component_count;  // Components of a value, see `Path`
+
+		std::vector<float> times;  // Keyframe times in seconds, increasing
+
+		// `component_count` floats per keyframe, three times as many for `Interpolation::CubicSpline`
+		std::vector<float> values;
+
+		///
+		/// @brief Check that the keyframes are consistent with the path and interpolation
+		///
+		/// @return `true` if valid
+		///
+		[[nodiscard]]
+		bool valid() const noexcept;
+	};
+
+	///
+	/// @brief Animation, a set of channels sampled at the same time
+	///
+	struct Animation
+	{
+		std::vector<AnimationChannel> channels;
+
+		///
+		/// @brief Get the duration of the animation, the time of its last keyframe
+		///
+		/// @return Duration in seconds
+		///
+		[[nodiscard]]
+		float duration() const noexcept;
+
+		///
+		/// @brief Sample the animation, overwriting the animated properties
+		/// @details Times before the first keyframe or after the last keyframe of a channel are clamped.
+		/// Nodes and properties without a channel are left unchanged.
+		///
+		/// @param time Time in seconds
+		/// @param transforms Local transforms of all nodes, indexed by node index
+		/// @param morph_weights Morph target weights of all nodes, indexed by node index. Weights beyond
+		/// the size of a node's array are dropped.
+		///
+		void sample(
+			float time,
+			std::span<Transform> transforms,
+			std::span<std::vector<float>> morph_weights = {}
+		) const noexcept;
+	};
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "hierarchy.hpp"
+#include "mesh.hpp"
+
+#include <array>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace model
+{
+	///
+	/// @brief Axis-aligned bounding box
+	/// @details An empty box has `min` greater than `max` on every axis, and intersects nothing
+	///
+	struct Aabb
+	{
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::infinity());
+		glm::vec3 max = glm::vec3(-std::numeric_limits<float>::infinity());
+
+		[[nodiscard]]
+		bool empty() const noexcept;
+
+		[[nodiscard]]
+		glm::vec3 center() const noexcept;
+
+		[[nodiscard]]
+		float surface_area() const noexcept;
+
+		///
+		/// @brief Get the union of two boxes
+		///
+		[[nodiscard]]
+		Aabb merge(const Aabb& other) const noexcept;
+
+		///
+		/// @brief Get the box bounding this box after a transform
+		///
+		/// @param transform Affine transform
+		/// @return Transformed box, empty if this box is empty
+		///
+		[[nodiscard]]
+		Aabb transform(const glm::mat4& transform) const noexcept;
+	};
+
+	///
+	/// @brief Ray for `SceneBvh::query`, hitting boxes between `t_min` and `t_max`
+	///
+	struct Ray
+	{
+		glm::vec3 origin;
+		glm::vec3 direction;  // Need not be normalized, distances are in multiples of its length
+		float t_min = 0.0f;
+		float t_max = std::numeric_limits<float>::infinity();
+	};
+
+	///
+	/// @brief Sphere for `SceneBvh::query`
+	///
+	struct Sphere
+	{
+		glm::vec3 center;
+		float radius;
+	};
+
+	///
+	/// @brief View frustum, as six planes facing inward
+	///
+	struct Frustum
+	{
+		// `xyz` as normal and `w` as offset, a point `p` is inside if `dot(xyz, p) + w >= 0` for all planes
+		std::array<glm::vec4, 6> planes;
+
+		///
+		/// @brief Extract the frustum planes from a view-projection matrix with a `[0, 1]` depth range
+		/// @note Works with reverse-Z and infinite far projections, the degenerate far plane then never
+		/// culls anything
+		///
+		/// @param view_projection View-projection matrix, from world space to clip space
+		/// @return Frustum in world space
+		///
+		[[nodiscard]]
+		static Frustum from_matrix(const glm::mat4& view_projection) noexcept;
+	};
+
+	///
+	/// @brief Bounding volume hierarchy over world-space boxes of scene items, e.g. nodes
+	/// @details
+	/// - Built top-down with the binned surface area heuristic. Items with empty boxes on creation are not
+	/// tracked
+	/// - Boxes of single items can be updated in place, refitting their ancestors. Tree quality degrades
+	/// as items move far, recreate the BVH after large changes
+	///
+	class SceneBvh
+	{
+	  public:
+
+		///
+		/// @brief Hit of `query` with a ray
+		///
+		struct RayHit
+		{
+			uint32_t item;  // Item index
+			float t;        // Distance at which the ray enters the box of the item
+		};
+
+		///
+		/// @brief Compute the world-space box of each node, bounding the geometry of its mesh
+		///
+		/// @param hierarchy Hierarchy of the model
+		/// @param meshes Meshes of the model
+		/// @param world_transforms World transforms of all nodes, see `Hierarchy::compute_transforms`
+		/// @return Box of each node, empty for nodes without mesh
+		///
+		[[nodiscard]]
+		static std::vector<Aabb> compute_node_bounds(
+			const Hierarchy& hierarchy,
+			std::span<const Mesh> meshes,
+			std::span<const glm::mat4> world_transforms
+		) noexcept;
+
+		///
+		/// @brief Build a BVH
+		///
+		/// @param bounds World-space box of each item, indexed by item index
+		/// @return Built BVH
+		///
+		[[nodiscard]]
+		static SceneBvh create(std::span<const Aabb> bounds) noexcept;
+
+		///
+		/// @brief Update the box of an item and refit its ancestors
+		/// @note Untracked items are ignored
+		///
+		/// @param item Item index
+		/// @param bound New world-space box of the item
+		///
+		void update(uint32_t item, const Aabb& bound) noexcept;
+
+		///
+		/// @brief Find items whose boxes are hit by a ray
+		///
+		/// @param ray Ray
+		/// @return Hits in order of increasing distance
+		///
+		[[nodiscard]]
+		std::vector<RayHit> query(const Ray& ray) const noexcept;
+
+		///
+		/// @brief Find items whose boxes intersect a frustum, subtrees fully inside are accepted as a whole
+		/// @note Conservative, boxes near the frustum edges may be reported although outside
+		///
+		/// @param frustum Frustum
+		/// @return Item indices
+		///
+		[[nodiscard]]
+		std::vector<uint32_t> query(const Frustum& frustum) const noexcept;
+
+		///
+		/// @brief Find items whose boxes intersect a sphere
+		///
+		/// @param sphere Sphere
+		/// @return Item indices
+		///
+		[[nodiscard]]
+		std::vector<uint32_t> query(const Sphere& sphere) const noexcept;
+
+		///
+		/// @brief Get the box bounding all tracked items
+		///
+		/// @return Box, empty if no item is tracked
+		///
+		[[nodiscard]]
+		Aabb get_bound() const noexcept;
+
+	  private:
+
+		// Maximum number of items in a leaf
+		static constexpr uint32_t MAX_LEAF_SIZE = 4;
+
+		static constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+
+		struct Node
+		{
+			Aabb bound;
+			uint32_t first;  // First child for interior nodes, second child follows. First item for leaves
+			uint32_t count;  // Number of items for leaves, `0` for interior nodes
+			uint32_t parent;
+		};
+
+		std::vector<Node> nodes;          // Root first if not empty
+		std::vector<uint32_t> items;      // Item indices, leaves reference ranges of it
+		std::vector<Aabb> item_bounds;    // Box of each item, indexed by item index
+		std::vector<uint32_t> item_leaf;  // Leaf containing each item, `NO_PARENT` if untracked
+
+		SceneBvh() = default;
+
+		void collect(uint32_t node_index, std::vector<uint32_t>& output) const noexcept;
+
+	  public:
+
+		SceneBvh(const SceneBvh&) = default;
+		SceneBvh(SceneBvh&&) = default;
+		SceneBvh& operator=(const SceneBvh&) = default;
+		SceneBvh& operator=(SceneBvh&&) = default;
+	};
+}
@@ -47,6 +47,8 @@ namespace model
 	{
 		Transform transform = {};
 		std::optional<uint32_t> mesh_index = std::nullopt;
+		std::optional<uint32_t> light_index = std::nullopt;
+		std::optional<uint32_t> skin_index = std::nullopt;  // Skin deforming the mesh, see `Skin`
 	};
 
 	///
@@ -165,6 +167,8 @@ namespace model
 
 		///
 		/// @brief Compute absolute transforms of all nodes
+		/// @details Local matrices are cached in BFS order on creation, so this only walks the BFS order and
+		/// multiplies each cached local matrix with its parent's absolute matrix.
 		///
 		/// @param root_transform Transform applied to the root node in addition to its own transform
 		/// @param memory_resource Memory resource to use for allocating the output vector, defaulting to the
@@ -177,6 +181,23 @@ namespace model
 			std::pmr::memory_resource& memory_resource = *std::pmr::new_delete_resource()
 		) const noexcept;
 
+		///
+		/// @brief Compute absolute transforms of all nodes from overridden local transforms, e.g. sampled
+		/// from an animation
+		///
+		/// @param root_transform Transform applied to the root node in addition to its own transform
+		/// @param local_transforms Local transform of each node, indexed by node index
+		/// @param memory_resource Memory resource to use for allocating the output vector, defaulting to the
+		/// new/delete memory resource
+		/// @return List of transform 4x4 matrices, one-to-one corresponding to the nodes
+		///
+		[[nodiscard]]
+		std::pmr::vector<glm::mat4> compute_transforms(
+			const glm::mat4& root_transform,
+			std::span<const Transform> local_transforms,
+			std::pmr::memory_resource& memory_resource = *std::pmr::new_delete_resource()
+		) const noexcept;
+
 		///
 		/// @brief Get renderable nodes in the hierarchy
 		///
@@ -200,6 +221,18 @@ namespace model
 			return nodes;
 		}
 
+		///
+		/// @brief Get the node indices in BFS order, starting from the root node
+		/// @note Parents always precede their children, and nodes of the same depth are contiguous
+		///
+		/// @return Node indices in BFS order
+		///
+		[[nodiscard]]
+		std::span<const uint32_t> get_bfs_order() const noexcept
+		{
+			return bfs_indices;
+		}
+
 		///
 		/// @brief Get all renderable nodes/drawcalls, regardless of their runtime visibility
 		///
@@ -217,6 +250,10 @@ namespace model
 		std::vector<uint32_t> bfs_indices;
 		std::vector<Drawcall> renderable_nodes;
 
+		// Cached per-node data in BFS order, one-to-one corresponding to `bfs_indices`
+		std::vector<glm::mat4> bfs_local_transforms;
+		std::vector<uint32_t> bfs_parent_indices;  // Node index of the parent, ignored for the root node
+
 		explicit Hierarchy(
 			std::vector<FullNode> nodes,
 			std::vector<uint32_t> bfs_indices,
@@ -224,13 +261,25 @@ namespace model
 		) :
 			nodes(std::move(nodes)),
 			bfs_indices(std::move(bfs_indices)),
-			renderable_nodes(std::move(renderable_nodes))
+			renderable_nodes(std::move(renderable_nodes)),
+			bfs_local_transforms(get_bfs_local_transforms(this->nodes, this->bfs_indices)),
+			bfs_parent_indices(get_bfs_parent_indices(this->nodes, this->bfs_indices))
 		{}
 
 		static std::vector<Drawcall> find_renderable_nodes(
 			const std::vector<FullNode>& double_linked_nodes
 		) noexcept;
 
+		static std::vector<glm::mat4> get_bfs_local_transforms(
+			const std::vector<FullNode>& nodes,
+			const std::vector<uint32_t>& bfs_indices
+		) noexcept;
+
+		static std::vector<uint32_t> get_bfs_parent_indices(
+			const std::vector<FullNode>& nodes,
+			const std::vector<uint32_t>& bfs_indices
+		) noexcept;
+
 	  public:
 
 		Hierarchy(const Hierarchy&) = default;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint2.hpp>
+
+namespace model
+{
+	///
+	/// @brief Options for baking impostors, see `bake_impostors`
+	///
+	struct ImpostorOption
+	{
+		uint32_t frame_count = 8;          // Frames along each axis of an atlas
+		uint32_t frame_size = 64;          // Texels along each axis of a frame, a power of two
+		uint32_t min_mesh_references = 8;  // Meshes referenced by fewer nodes are skipped unless alpha masked
+		uint32_t max_impostor_count = 32;  // Most referenced meshes are baked first
+		uint32_t max_texture_size = 256;   // Decode size hint of the albedo textures sampled while baking
+	};
+
+	///
+	/// @brief Get the direction a frame of an impostor atlas is viewed from
+	/// @details Frame centers are laid out on the octahedral mapping of the unit sphere, the same mapping as
+	/// `oct_encode` in shaders
+	///
+	/// @param frame Frame coordinate within the atlas
+	/// @param frame_count Frames along each axis of the atlas
+	/// @return Unit direction from the center of the mesh toward the viewer, in mesh space
+	///
+	[[nodiscard]]
+	glm::vec3 get_impostor_frame_direction(glm::uvec2 frame, uint32_t frame_count) noexcept;
+
+	///
+	/// @brief Get the frame of an impostor atlas nearest to a view direction
+	///
+	/// @param direction Direction from the center of the mesh toward the viewer, in mesh space
+	/// @param frame_count Frames along each axis of the atlas
+	/// @return Frame coordinate within the atlas
+	///
+	[[nodiscard]]
+	glm::uvec2 get_impostor_frame(glm::vec3 direction, uint32_t frame_count) noexcept;
+
+	///
+	/// @brief Bake octahedral impostors of the meshes instanced many times, e.g. vegetation and props
+	/// @details
+	/// - A mesh is baked if it's referenced by at least `min_mesh_references` nodes, or has alpha-masked
+	/// primitives. Deformable meshes, meshes with blended primitives and HLOD proxies are never baked.
+	/// - Each frame is rasterized on the CPU, viewing the bounding sphere of the mesh orthographically from
+	/// its frame direction. Frames store the albedo, mesh-space normal and depth of the nearest surface, and
+	/// alpha-masked texels are tested as they would be when rendered. Uncovered texels take the colors of
+	/// their covered neighbors, so filtering doesn't bleed the background into the silhouette.
+	/// - The frame basis is `right = normalize(cross(reference, direction))` and
+	/// `up = cross(direction, right)`, with `reference` being +Y, or +Z for directions within 2.5 degrees of
+	/// the Y axis. Texel rows go from `+up` to `-up`.
+	///
+	/// @note Bake after `merge_static_geometry` and `build_hlod`, which drop the impostors of their input.
+	/// Roughness, metalness and emission are not baked.
+	///
+	/// @param model Source model, consumed. Existing impostors are replaced
+	/// @param option Bake options
+	/// @return Model with `Model::impostors` filled, or error
+	///
+	[[nodiscard]]
+	std::expected<Model, Error> bake_impostors(Model model, const ImpostorOption& option = {}) noexcept;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/ext/scalar_constants.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <optional>
+
+namespace model
+{
+	enum class LightType : uint8_t
+	{
+		Directional,
+		Point,
+		Spot
+	};
+
+	///
+	/// @brief Punctual light, placed in the scene by the nodes referencing it
+	/// @details
+	/// - Mostly follows glTF's `KHR_lights_punctual` extension
+	/// - Lights are located at the origin of the node, and point and spot lights emit towards -Z of the
+	/// node
+	///
+	struct Light
+	{
+		LightType type = LightType::Point;
+
+		///
+		/// @brief Linear RGB color of the light
+		///
+		glm::vec3 color = glm::vec3(1.0f);
+
+		///
+		/// @brief Brightness of the light
+		/// @details In candela (lm/sr) for point and spot lights, in lux (lm/m^2) for directional lights
+		///
+		float intensity = 1.0f;
+
+		///
+		/// @brief Distance cutoff of the light, infinite if `std::nullopt`
+		/// @note Ignored for directional lights
+		///
+		std::optional<float> range = std::nullopt;
+
+		///
+		/// @brief Angles from the spot direction where the falloff starts and ends, in radians
+		/// @note Only used for spot lights
+		///
+		float inner_cone_angle = 0.0f;
+		float outer_cone_angle = glm::pi<float>() / 4.0f;
+	};
+}
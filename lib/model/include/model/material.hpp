@@ -138,6 +138,18 @@ namespace model
 		Param param = Param();
 		Mode mode = Mode();
 		TextureSet texture_set = TextureSet();
+
+		///
+		/// @brief Get the canonical form of the material, resetting fields with no effect on rendering
+		/// @details
+		/// - `alpha_cutoff` is reset unless the alpha mode is `AlphaMode::Mask`
+		/// - The emissive texture is dropped if `emissive_factor` is zero
+		/// - `normal_scale` is reset if there's no normal texture
+		///
+		/// @return Canonical material, rendering the same as this material
+		///
+		[[nodiscard]]
+		Material canonicalize() const noexcept;
 	};
 
 	///
@@ -170,6 +182,17 @@ namespace model
 			std::vector<Material> materials
 		) noexcept;
 
+		///
+		/// @brief Canonicalize all materials and merge those with equal parameters, modes and texture
+		/// references, see `Material::canonicalize`
+		/// @note Materials keep their relative order, the first of equal materials is kept. Textures are
+		/// unchanged.
+		///
+		/// @return New index of each original material
+		///
+		[[nodiscard]]
+		std::vector<uint32_t> deduplicate() noexcept;
+
 	  private:
 
 		explicit MaterialList(
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <vector>
+
+namespace model
+{
+	///
+	/// @brief Options for merging static geometry, see `merge_static_geometry`
+	///
+	struct MergeOption
+	{
+		uint32_t max_source_vertices = 1024;    // Meshes with more vertices in total are kept as they are
+		uint32_t max_mesh_references = 16;      // Meshes referenced by more nodes are kept for instancing
+		uint32_t max_cluster_vertices = 65536;  // Maximum vertex count of a merged primitive
+		float max_cluster_extent = 0.0f;        // Maximum AABB diagonal of a merged primitive, `0` for none
+	};
+
+	///
+	/// @brief Triangles of a merged primitive, coming from one primitive of one source node
+	///
+	struct MergeSource
+	{
+		uint32_t node_index;       // Node of the source model, also the same node in the merged model
+		uint32_t mesh_index;       // Mesh of the source model
+		uint32_t primitive_index;  // Primitive within the source mesh
+		uint32_t triangle_offset;  // First triangle in the merged primitive
+		uint32_t triangle_count;
+	};
+
+	///
+	/// @brief A merged primitive and the sources it is made of
+	///
+	struct MergedPrimitive
+	{
+		uint32_t node_index;  // Node of the merged model referencing the merged mesh
+		uint32_t mesh_index;  // Mesh of the merged model, containing only the merged primitive
+
+		// Sources in order of increasing `triangle_offset`
+		std::vector<MergeSource> sources;
+	};
+
+	///
+	/// @brief Result of `merge_static_geometry`
+	///
+	struct MergeResult
+	{
+		Model model;
+
+		// Merged primitives, for mapping triangles of the merged model back to the source model
+		std::vector<MergedPrimitive> merged_primitives;
+
+		///
+		/// @brief Find the source of a triangle in the merged model, e.g. for picking
+		///
+		/// @param node_index Node of the merged model
+		/// @param triangle_index Triangle within the merged primitive of the node
+		/// @return Source of the triangle, or `std::nullopt` if the node is not a merged node
+		///
+		[[nodiscard]]
+		std::optional<MergeSource> find_source(uint32_t node_index, uint32_t triangle_index) const noexcept;
+	};
+
+	///
+	/// @brief Merge small static meshes sharing a material into larger pre-transformed primitives
+	/// @details
+	/// - A mesh is merged if it has at most `max_source_vertices` vertices and is referenced by at most
+	/// `max_mesh_references` nodes. Its primitives are transformed into the space of the root node, and
+	/// removed from the referencing nodes. Other meshes are kept unchanged.
+	/// - Skinned or morphed meshes, and meshes of nodes moved by an animation, are never merged
+	/// - Merged primitives are grouped by material, then clustered spatially along the Morton order of their
+	/// centers, so that culling stays effective on the merged primitives. A cluster is closed when it
+	/// reaches `max_cluster_vertices` or `max_cluster_extent`.
+	/// - Each cluster becomes a mesh with a single primitive, referenced by a new child node of the root.
+	/// Existing nodes keep their indices, so lights and node references stay valid.
+	///
+	/// @note Levels of detail of the merged primitives are dropped, regenerate them after merging if needed.
+	/// Reordering the triangles of a merged primitive, e.g. with `Geometry::optimize`, invalidates
+	/// `MergeSource::triangle_offset`.
+	///
+	/// @param model Source model, consumed
+	/// @param option Merge options
+	/// @return Merged model and the mapping to the source model, or error
+	///
+	[[nodiscard]]
+	std::expected<MergeResult, Error> merge_static_geometry(
+		Model model,
+		const MergeOption& option = {}
+	) noexcept;
+
+	///
+	/// @brief Options for building hierarchical levels of detail, see `build_hlod`
+	///
+	struct HlodOption
+	{
+		float cell_size = 0.0f;          // Edge of the clustering grid cells, `0` for 1/8 of the model extent
+		uint32_t min_cluster_nodes = 4;  // Cells with fewer nodes are left without a proxy
+		float index_ratio = 0.1f;        // Target index count of a proxy primitive, relative to its sources
+		float max_error = 0.1f;          // Maximum simplification error, see `GeometryLod::error`
+	};
+
+	///
+	/// @brief Build proxies drawn in place of clusters of small static nodes far away
+	/// @details
+	/// - Nodes referencing a mesh are clustered in a uniform grid in the space of the root node, by the
+	/// center of their bounds. Skinned or morphed meshes, and nodes moved by an animation, are never
+	/// clustered.
+	/// - Each cell of at least `min_cluster_nodes` nodes becomes an `HlodCluster`. The primitives of its
+	/// nodes are pre-transformed into the root space and merged by material, then simplified regardless of
+	/// topology (see `Geometry::SimplifyOption::sloppy`) into the proxy mesh, one primitive per material.
+	/// - The proxy mesh is referenced by a new child node of the root. Existing nodes and meshes keep their
+	/// indices, the renderer draws either the sources or the proxy of a cluster by its projected size.
+	///
+	/// @note Proxies keep the materials of their sources, no texture atlas is baked. Build after
+	/// `merge_static_geometry`, which drops the levels of detail of its input.
+	///
+	/// @param model Source model without HLOD, consumed
+	/// @param option Build options
+	/// @return Model with proxies and `Model::hlod` filled, or error
+	///
+	[[nodiscard]]
+	std::expected<Model, Error> build_hlod(Model model, const HlodOption& option = {}) noexcept;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/util/arena.hpp"
 #include "common/util/error.hpp"
 
 #include <algorithm>
@@ -9,7 +10,12 @@
 #include <glm/ext/vector_float2.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <glm/ext/vector_float4.hpp>
+#include <glm/ext/vector_int2_sized.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint3_sized.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
 #include <glm/glm.hpp>
+#include <memory_resource>
 #include <optional>
 #include <ranges>
 #include <span>
@@ -170,6 +176,91 @@ namespace model
 		}
 	};
 
+	///
+	/// @brief Quantized vertex, compact GPU-side representation of `FullVertex`
+	/// @details Layout, 20 bytes in total:
+	/// - `position`: XYZ as UNORM16 relative to the AABB of the owning geometry, W as the tangent handedness
+	///   (`0` for `-1.0`, `0xFFFF` for `1.0`)
+	/// - `texcoord`: Half-float texture coordinate
+	/// - `normal`, `tangent`: SNORM16 octahedral encoded unit vectors
+	///
+	struct PackedVertex
+	{
+		glm::u16vec4 position;
+		glm::u16vec2 texcoord;
+		glm::i16vec2 normal;
+		glm::i16vec2 tangent;
+
+		///
+		/// @brief Quantize a full vertex
+		/// @note Positions outside of the AABB are clamped
+		///
+		/// @param vertex Full vertex
+		/// @param aabb_min Minimum corner of the AABB of the owning geometry
+		/// @param aabb_max Maximum corner of the AABB of the owning geometry
+		/// @return Packed vertex
+		///
+		[[nodiscard]]
+		static PackedVertex pack(const FullVertex& vertex, glm::vec3 aabb_min, glm::vec3 aabb_max) noexcept;
+
+		///
+		/// @brief Dequantize to a full vertex, mirrors the decoding done in shaders
+		///
+		/// @param aabb_min Minimum corner of the AABB of the owning geometry
+		/// @param aabb_max Maximum corner of the AABB of the owning geometry
+		/// @return Full vertex, with normalized normal and tangent
+		///
+		[[nodiscard]]
+		FullVertex unpack(glm::vec3 aabb_min, glm::vec3 aabb_max) const noexcept;
+	};
+
+	static_assert(sizeof(PackedVertex) == 20);
+
+	///
+	/// @brief Meshlet, a small cluster of triangles of a geometry
+	/// @details A meshlet references a range of `Geometry::meshlet_vertices` and a range of
+	/// `Geometry::meshlet_triangles`. Triangles index into the meshlet-local vertex range, which in turn
+	/// indexes into `Geometry::vertices`. The bounding sphere and the normal cone are used for culling.
+	///
+	struct Meshlet
+	{
+		static constexpr uint32_t MAX_VERTICES = 64;
+		static constexpr uint32_t MAX_TRIANGLES = 124;
+
+		uint32_t vertex_offset;    // Offset into `Geometry::meshlet_vertices`
+		uint32_t triangle_offset;  // Offset into `Geometry::meshlet_triangles`, in triangles
+		uint32_t vertex_count;
+		uint32_t triangle_count;
+
+		glm::vec3 center;  // Center of the bounding sphere
+		float radius;      // Radius of the bounding sphere
+
+		///
+		/// @brief Normal cone of the meshlet
+		/// @details The meshlet is entirely back-facing when viewed from @p camera if
+		/// `dot(normalize(center - camera), cone_axis) >= cone_cutoff`, which never holds if the cutoff is
+		/// `1.0`, i.e. the cone is degenerated
+		///
+		glm::vec3 cone_axis;
+		float cone_cutoff;
+	};
+
+	///
+	/// @brief A simplified level of detail of a geometry
+	/// @details Shares vertices with the source geometry, only the triangle list differs
+	///
+	struct GeometryLod
+	{
+		std::vector<uint32_t> indices;  // Indices into `Geometry::vertices` of the source geometry
+
+		///
+		/// @brief Simplification error, relative to the extent of the source geometry
+		/// @details Multiplied by the projected size of the geometry, gives the approximate projected
+		/// deviation from the source geometry
+		///
+		float error;
+	};
+
 	///
 	/// @brief Geometry object, describes a triangle-list geometry without material
 	/// @note Visit its members through `operator->`
@@ -182,12 +273,51 @@ namespace model
 		std::vector<uint32_t> indices;
 		glm::vec3 aabb_min, aabb_max;
 
-		// PLANNED: Support LOD generation
+		std::vector<Meshlet> meshlets;
+		std::vector<uint32_t> meshlet_vertices;     // Meshlet-local vertices, indexing into `vertices`
+		std::vector<glm::u8vec3> meshlet_triangles;  // Meshlet triangles, indexing into `meshlet_vertices`
+
+		///
+		/// @brief Options for generating a LOD chain, see `simplify`
+		///
+		struct SimplifyOption
+		{
+			uint32_t max_levels = 3;     // Maximum number of levels, excluding the source geometry
+			float index_ratio = 0.5f;    // Target index count of a level, relative to the previous level
+			float max_error = 0.05f;     // Maximum relative error of a level, see `GeometryLod::error`
+			float min_reduction = 0.9f;  // Stop if a level keeps more than this ratio of previous indices
+
+			// Ignore the topology and merge nearby vertices, reaching the target on many disconnected parts
+			// at the cost of attribute seams
+			bool sloppy = false;
+		};
+
+		///
+		/// @brief Generate a discrete LOD chain of the geometry
+		/// @details Each level is simplified from the previous one, and optimized for vertex cache. The
+		/// chain ends early when the error limit is exceeded or the simplifier no longer makes progress.
+		/// Attribute seams are preserved, as vertices are shared across levels.
+		///
+		/// @param option Simplify options
+		/// @return Generated levels in order of decreasing detail, may be empty
+		///
+		[[nodiscard]]
+		std::vector<GeometryLod> simplify(const SimplifyOption& option) const noexcept;
+
+		///
+		/// @brief Reorder the geometry for GPU rasterization efficiency
+		/// @details Optimizes in order: triangle order for post-transform vertex cache, triangle order for
+		/// overdraw, then vertex order for vertex fetch. Unreferenced vertices are removed, rendered
+		/// triangles and AABB stay unchanged. Meshlets are rebuilt from the reordered geometry.
+		///
+		/// @return Optimized geometry
+		///
 		[[nodiscard]]
-		Geometry simplify() const noexcept;
+		Geometry optimize() const noexcept;
 
 		///
 		/// @brief Create and verify a primitive from vertex and index data
+		/// @details Meshlets are built from the indices, see `Meshlet`
 		///
 		/// @param vertices Input vertices
 		/// @param indices Input indices. All indices should be a valid index referencing an element in
@@ -200,18 +330,39 @@ namespace model
 			std::span<const uint32_t> indices
 		) noexcept;
 
+		///
+		/// @brief Create and verify a primitive, taking over the vertex and index buffers without copying
+		/// @details Same as the span overload, prefer this one in loaders producing large primitives
+		///
+		/// @param vertices Input vertices, consumed
+		/// @param indices Input indices, consumed. All indices should be a valid index referencing an element
+		/// in vertices, or verification will fail
+		/// @return Verified geometry, or error
+		///
+		[[nodiscard]]
+		static std::expected<Geometry, Error> create(
+			std::vector<FullVertex>&& vertices,
+			std::vector<uint32_t>&& indices
+		) noexcept;
+
 	  private:
 
 		explicit Geometry(
 			std::vector<FullVertex> vertices,
 			std::vector<uint32_t> indices,
 			glm::vec3 min_bound,
-			glm::vec3 max_bound
+			glm::vec3 max_bound,
+			std::vector<Meshlet> meshlets,
+			std::vector<uint32_t> meshlet_vertices,
+			std::vector<glm::u8vec3> meshlet_triangles
 		) noexcept :
 			vertices(std::move(vertices)),
 			indices(std::move(indices)),
 			aabb_min(min_bound),
-			aabb_max(max_bound)
+			aabb_max(max_bound),
+			meshlets(std::move(meshlets)),
+			meshlet_vertices(std::move(meshlet_vertices)),
+			meshlet_triangles(std::move(meshlet_triangles))
 		{}
 
 	  public:
@@ -222,6 +373,46 @@ namespace model
 		Geometry& operator=(Geometry&&) = default;
 	};
 
+	///
+	/// @brief Skin binding of a vertex, from the glTF `JOINTS_0` and `WEIGHTS_0` attributes
+	///
+	struct VertexSkin
+	{
+		glm::u16vec4 joints;  // Indices into `Skin::joints` of the skin of the referencing node
+		glm::vec4 weights;    // Weight of each joint, summing to `1`
+	};
+
+	///
+	/// @brief Morph target of a geometry, displacing its vertices by the weighted deltas
+	///
+	struct MorphTarget
+	{
+		std::vector<glm::vec3> position_deltas;  // One per vertex of the geometry
+		std::vector<glm::vec3> normal_deltas;    // One per vertex of the geometry, or empty if none
+	};
+
+	///
+	/// @brief Vertex deformation of a primitive, applied before the node transform
+	/// @details Morph targets are applied first, then the morphed vertices are skinned if `skin` is not
+	/// empty. Tangents follow the skinning but not the morph targets.
+	///
+	struct Deformation
+	{
+		std::vector<VertexSkin> skin;            // One per vertex of the geometry, or empty if not skinned
+		std::vector<MorphTarget> morph_targets;  // Weighted by `Mesh::morph_weights`
+
+		///
+		/// @brief Check whether the primitive is deformed at all
+		///
+		/// @return `true` if neither skinned nor morphed
+		///
+		[[nodiscard]]
+		bool empty() const noexcept
+		{
+			return skin.empty() && morph_targets.empty();
+		}
+	};
+
 	///
 	/// @brief Primitive object, describes a geometry with material reference
 	/// @note Implementation need not verify the material index, as it will be verified together with the
@@ -232,7 +423,8 @@ namespace model
 	{
 		Geometry geometry;
 
-		// PLANNED: Lod levels
+		// Coarser levels of detail following `geometry`, see `Geometry::simplify`
+		std::vector<GeometryLod> lods;
 
 		///
 		/// @brief Optional material index
@@ -241,6 +433,12 @@ namespace model
 		///
 		///
 		std::optional<uint32_t> material_index;
+
+		///
+		/// @brief Vertex deformation, indexing into the vertices of `geometry`
+		/// @warning Reordering the vertices of `geometry` (e.g. `Geometry::optimize`) invalidates it
+		///
+		Deformation deformation = {};
 	};
 
 	///
@@ -249,6 +447,22 @@ namespace model
 	struct Mesh
 	{
 		std::vector<Primitive> primitives;
+
+		// Default weights of the morph targets, shared by all primitives. Animated per node, see `Animation`
+		std::vector<float> morph_weights = {};
+
+		///
+		/// @brief Check whether any primitive of the mesh is deformed
+		///
+		/// @return `true` if any primitive is skinned or morphed
+		///
+		[[nodiscard]]
+		bool deformable() const noexcept
+		{
+			return std::ranges::any_of(primitives, [](const Primitive& primitive) {
+				return !primitive.deformation.empty();
+			});
+		}
 	};
 
 	namespace util
@@ -309,5 +523,81 @@ namespace model
 				| std::views::transform([&](uint32_t idx) { return vertices[idx]; })
 				| std::ranges::to<std::vector>();
 		}
+
+		///
+		/// @brief Expand indices to vertices into a scratch buffer, for temporaries of import
+		///
+		/// @tparam T Vertex type
+		/// @param indices Input indices, see `expand_indices`
+		/// @param vertices Input vertices
+		/// @param memory_resource Memory resource of the expanded vertices, e.g. `::util::ImportArena`
+		/// @return Expanded vertices, or an Error if the input is invalid
+		///
+		template <typename T>
+		std::expected<::util::ScratchVector<T>, Error> expand_indices(
+			std::span<const uint32_t> indices,
+			std::span<const T> vertices,
+			std::pmr::memory_resource& memory_resource
+		) noexcept
+		{
+			if (!std::ranges::all_of(indices, [total = vertices.size()](uint32_t idx) {
+					return idx < total;
+				}))
+				return Error("Invalid index found");
+
+			auto expanded = ::util::ScratchVector<T>(indices.size(), &memory_resource);
+			std::ranges::transform(indices, expanded.begin(), [&](uint32_t idx) { return vertices[idx]; });
+
+			return expanded;
+		}
+
+		///
+		/// @brief Vertices and indices of an indexed triangle list
+		///
+		struct IndexedVertices
+		{
+			std::vector<FullVertex> vertices;
+			std::vector<uint32_t> indices;
+		};
+
+		///
+		/// @brief Weld duplicated vertices of a triangle list, e.g. after expanding indices to generate
+		/// per-triangle attributes
+		/// @details Positions and texture coordinates are compared exactly, while normals and tangents are
+		/// compared with a tolerance of `WELD_TOLERANCE` per component, as generated values of coplanar
+		/// triangles may differ in the last bits. Triangle order is preserved.
+		///
+		/// @param vertices Input vertices
+		/// @param indices Input indices, all indices should reference an element in @p vertices
+		/// @param memory_resource Memory resource of the temporaries, defaulting to the new-delete resource
+		/// @return Welded vertices and remapped indices
+		///
+		IndexedVertices weld_vertices(
+			std::span<const FullVertex> vertices,
+			std::span<const uint32_t> indices,
+			std::pmr::memory_resource& memory_resource = *std::pmr::new_delete_resource()
+		) noexcept;
+
+		// Per-component tolerance of normals and tangents in `weld_vertices`
+		inline constexpr float WELD_TOLERANCE = 1.0f / 4096.0f;
+
+		///
+		/// @brief Generate smooth tangents for an indexed triangle list
+		/// @details Tangents of all triangles sharing a vertex are accumulated, weighted by the corner angle,
+		/// then orthogonalized against the vertex normal, similar to MikkTSpace. This keeps the indexing of
+		/// the input, unlike `NormalOnlyVertex::construct_tangent` which works on separate triangles.
+		/// @note Vertices with no valid tangent, e.g. only referenced by triangles with degenerate texture
+		/// coordinates, fall back to an arbitrary tangent perpendicular to the normal
+		///
+		/// @param vertices Input vertices with normals
+		/// @param indices Input triangle list indices
+		/// @param memory_resource Memory resource of the temporaries, defaulting to the new-delete resource
+		/// @return Vertices with tangents, or an Error if the indices are invalid
+		///
+		std::expected<std::vector<FullVertex>, Error> generate_tangents(
+			std::span<const NormalOnlyVertex> vertices,
+			std::span<const uint32_t> indices,
+			std::pmr::memory_resource& memory_resource = *std::pmr::new_delete_resource()
+		) noexcept;
 	}
 }
@@ -1,16 +1,76 @@
 #pragma once
 
+#include "animation.hpp"
 #include "common/util/error.hpp"
 #include "hierarchy.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "light.hpp"
 #include "material.hpp"
 #include "mesh.hpp"
 
+#include <cstdint>
 #include <expected>
+#include <glm/ext/vector_float3.hpp>
 #include <utility>
 #include <vector>
 
 namespace model
 {
+	///
+	/// @brief A cluster of nodes drawn as a single proxy node beyond a projected size, see `build_hlod`
+	///
+	struct HlodCluster
+	{
+		uint32_t proxy_node_index;     // Node referencing the proxy mesh, shown in place of the sources
+		uint32_t source_offset;        // First source node in `HlodList::source_nodes`
+		uint32_t source_count;         // Count of source nodes
+		glm::vec3 aabb_min, aabb_max;  // Bounds of the source nodes, in the space of the root node
+	};
+
+	///
+	/// @brief Hierarchical levels of detail of a model
+	///
+	struct HlodList
+	{
+		std::vector<HlodCluster> clusters;
+
+		// Source nodes of all clusters, each cluster references a consecutive range. A node is the source of
+		// at most one cluster
+		std::vector<uint32_t> source_nodes;
+	};
+
+	///
+	/// @brief Octahedral impostor of a mesh, drawn as a single quad in place of its distant instances, see
+	/// `bake_impostors`
+	/// @details Each atlas holds `frame_count * frame_count` frames of `frame_size` texels along each axis.
+	/// Frame `(x, y)` views the bounding sphere orthographically from the direction given by
+	/// `get_impostor_frame_direction`, so that every view direction maps to its nearest frame.
+	///
+	struct Impostor
+	{
+		uint32_t mesh_index;
+		glm::vec3 center;  // Bounding sphere of the mesh, in mesh space
+		float radius;
+
+		// RGB: albedo in sRGB, A: coverage
+		image::Image<image::Format::Unorm8, image::Layout::RGBA> albedo;
+
+		// RGB: mesh-space normal mapped to `[0, 1]`, A: depth along the view direction across the bounding
+		// sphere, `0` at its front and `1` at its back
+		image::Image<image::Format::Unorm8, image::Layout::RGBA> normal_depth;
+	};
+
+	///
+	/// @brief Impostors of a model, all sharing the same atlas layout
+	///
+	struct ImpostorList
+	{
+		uint32_t frame_count = 0;  // Frames along each axis of an atlas
+		uint32_t frame_size = 0;   // Texels along each axis of a frame
+		std::vector<Impostor> impostors;  // At most one for each mesh
+	};
+
 	///
 	/// @brief Model class, represents a verified and immutable model, with all its index being valid
 	/// @note Visit its members through `operator->`
@@ -35,26 +95,75 @@ namespace model
 		Hierarchy hierarchy;
 
 		///
-		/// @brief Create and verify a model from materials, meshes and hierarchy
+		/// @brief Punctual lights of the model, referenced by `NodeData::light_index`
+		///
+		std::vector<Light> lights;
+
+		///
+		/// @brief Skins of the model, referenced by `NodeData::skin_index`
+		///
+		std::vector<Skin> skins;
+
+		///
+		/// @brief Animations of the model, animating the nodes of `hierarchy`
+		///
+		std::vector<Animation> animations;
+
+		///
+		/// @brief Hierarchical levels of detail of the model, empty unless built by `build_hlod`
+		///
+		HlodList hlod;
+
+		///
+		/// @brief Octahedral impostors of the model, empty unless baked by `bake_impostors`
+		///
+		ImpostorList impostors;
+
+		///
+		/// @brief Create and verify a model from materials, meshes, hierarchy, lights and animations
 		///
 		/// @param material_list Input material set
 		/// @param meshes Input meshes, stored in a `std::vector`
 		/// @param hierarchy Input hierarchy
+		/// @param lights Input lights, stored in a `std::vector`
+		/// @param skins Input skins, stored in a `std::vector`
+		/// @param animations Input animations, stored in a `std::vector`
+		/// @param hlod Input hierarchical levels of detail
+		/// @param impostors Input impostors
 		/// @return Verified model, or `Error`
 		///
 		[[nodiscard]]
 		static std::expected<Model, Error> assemble(
 			MaterialList material_list,
 			std::vector<Mesh> meshes,
-			Hierarchy hierarchy
+			Hierarchy hierarchy,
+			std::vector<Light> lights = {},
+			std::vector<Skin> skins = {},
+			std::vector<Animation> animations = {},
+			HlodList hlod = {},
+			ImpostorList impostors = {}
 		) noexcept;
 
 	  private:
 
-		explicit Model(MaterialList material_list, std::vector<Mesh> meshes, Hierarchy hierarchy) :
+		explicit Model(
+			MaterialList material_list,
+			std::vector<Mesh> meshes,
+			Hierarchy hierarchy,
+			std::vector<Light> lights,
+			std::vector<Skin> skins,
+			std::vector<Animation> animations,
+			HlodList hlod,
+			ImpostorList impostors
+		) :
 			material_list(std::move(material_list)),
 			meshes(std::move(meshes)),
-			hierarchy(std::move(hierarchy))
+			hierarchy(std::move(hierarchy)),
+			lights(std::move(lights)),
+			skins(std::move(skins)),
+			animations(std::move(animations)),
+			hlod(std::move(hlod)),
+			impostors(std::move(impostors))
 		{}
 
 	  public:
@@ -64,4 +173,14 @@ namespace model
 		Model& operator=(const Model&) = delete;
 		Model& operator=(Model&&) = default;
 	};
+
+	///
+	/// @brief Merge duplicated materials of a model and remap the material indices of its primitives, see
+	/// `MaterialList::deduplicate`
+	///
+	/// @param model Source model, consumed
+	/// @return Model with deduplicated materials
+	///
+	[[nodiscard]]
+	Model deduplicate_materials(Model model) noexcept;
 }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace model
+{
+	///
+	/// @brief Codec of a compressed payload, see `encode_payload`
+	///
+	enum class PayloadCodec : uint32_t
+	{
+		None,           // Stored as-is
+		Vertex,         // Arrays of fixed-size elements, e.g. vertices, positions and texels
+		IndexSequence,  // Arrays of 16-bit or 32-bit indices
+	};
+
+	///
+	/// @brief Size of the raw data covered by each independently decodable chunk of a payload
+	///
+	constexpr size_t PAYLOAD_CHUNK_SIZE = 1 << 20;
+
+	///
+	/// @brief Encode an array into a compressed payload
+	/// @details The array is split into chunks of about `PAYLOAD_CHUNK_SIZE` bytes, which are encoded in
+	/// parallel with the meshoptimizer codecs and decoded in parallel by `decode_payloads`. The payload
+	/// starts with the chunk count, followed by the end offset of each chunk within the chunk data.
+	///
+	/// @param data Raw array
+	/// @param codec Codec, other than @p PayloadCodec::None
+	/// @param stride Size of an element in bytes. A multiple of 4 up to 256 for @p PayloadCodec::Vertex, 2
+	/// or 4 for @p PayloadCodec::IndexSequence
+	/// @return Encoded payload, `std::nullopt` if it isn't smaller than @p data
+	///
+	[[nodiscard]]
+	std::optional<std::vector<std::byte>> encode_payload(
+		std::span<const std::byte> data,
+		PayloadCodec codec,
+		uint32_t stride
+	) noexcept;
+
+	///
+	/// @brief Compressed payload to decode, see `decode_payloads`
+	///
+	struct Payload
+	{
+		PayloadCodec codec;
+		uint32_t stride;
+		std::span<const std::byte> encoded;  // Encoded payload, see `encode_payload`
+		std::span<std::byte> decoded;        // Destination, exactly the size of the raw array
+	};
+
+	///
+	/// @brief Decode compressed payloads into their destinations
+	/// @details Chunks of all payloads are decoded in parallel, with one worker per hardware thread
+	///
+	/// @param payloads Payloads, with non-overlapping destinations
+	/// @return `void` on success, or error if a payload is malformed
+	///
+	[[nodiscard]]
+	std::expected<void, Error> decode_payloads(std::span<const Payload> payloads) noexcept;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model.hpp"
+
+#include <cstdint>
+#include <expected>
+
+namespace model
+{
+	///
+	/// @brief Options for generating a synthetic scene, see `synthetic`
+	///
+	struct SyntheticOption
+	{
+		uint32_t node_count = 1024;              // Renderable nodes, in a cubic grid under the root
+		uint32_t instances_per_mesh = 1;         // Nodes sharing each mesh, `1` for no instancing
+		uint32_t primitives_per_mesh = 1;        // Primitives of each mesh, tiled side by side
+		uint32_t triangles_per_primitive = 128;  // Triangles of each primitive
+		uint32_t material_count = 16;            // Materials of the primitives, `0` for default material
+		uint32_t texture_count = 0;              // Albedo textures assigned to the materials in turn
+		uint32_t texture_size = 256;             // Width and height of each texture
+		float alpha_mask_ratio = 0.0f;           // Ratio of materials using `AlphaMode::Mask`, in `[0, 1]`
+		float spacing = 2.0f;                    // Distance between nodes, meshes span a unit square
+		uint32_t seed = 0;                       // Seed of the geometry, transforms and material assignment
+	};
+
+	///
+	/// @brief Generate a synthetic scene in memory, for sweeping the scaling of culling, drawcalls, BLAS
+	/// builds and texture loading without large model files
+	/// @details Each mesh is a set of undulating grid primitives with a distinct shape. Renderable node `i`
+	/// references mesh `i / instances_per_mesh`. Textures are checkerboards with distinct colors, masked
+	/// materials cut out half of every checker tile through the alpha channel.
+	/// @note Deterministic, identical options always generate the identical model
+	///
+	/// @param option Generation options
+	/// @return Generated model, or error if the options are invalid
+	///
+	[[nodiscard]]
+	std::expected<Model, Error> synthetic(const SyntheticOption& option) noexcept;
+}
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <filesystem>
 #include <glm/glm.hpp>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <variant>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -53,6 +57,7 @@ namespace model
 	/// @details Stores the source data in one of these types:
 	/// - `std::filesystem::path`: Load the texture from a file path
 	/// - `std::vector<std::byte>`: Load the texture from memory data
+	/// - `SharedData`: Load the texture from memory data borrowed from a shared owner, e.g. a mapped file
 	/// - `image::Image`: Load the texture from an already decoded image (8-bit or 16-bit)
 	///
 	/// Additionally, the flip options ( @p flip_x and @p flip_y) can be used to specify whether to flip the
@@ -62,9 +67,21 @@ namespace model
 	///
 	struct Texture
 	{
+		///
+		/// @brief Encoded data borrowed from a shared owner, read in-place without copying
+		/// @details Used for data embedded in a larger storage, e.g. an image in a memory mapped glTF buffer.
+		/// The owner keeps @p data valid for as long as any copy of the texture is alive
+		///
+		struct SharedData
+		{
+			std::shared_ptr<const void> owner;  // Owner of the storage referenced by `data`
+			std::span<const std::byte> data;    // Encoded data
+		};
+
 		using SourceType = std::variant<
 			std::filesystem::path,
 			std::vector<std::byte>,
+			SharedData,
 			image::Image<image::Format::Unorm8, image::Layout::RGBA>,
 			image::Image<image::Format::Unorm16, image::Layout::RGBA>
 		>;
@@ -81,7 +98,11 @@ namespace model
 
 		///
 		/// @brief Load the texture data
+		/// @note Already decoded sources are returned as-is, regardless of @p max_size
 		///
+		/// @param max_size Decode hint of the larger dimension wanted, see `image::Image::decode`. `0` for
+		/// full resolution
+		/// @param scratch_resource Memory resource of the decoding temporaries, see `image::Image::decode`
 		/// @retval image::Image<image::Format::Unorm8, image::Layout::RGBA> if the texture is in 8-bit
 		/// format
 		/// @retval image::Image<image::Format::Unorm16, image::Layout::RGBA> if the texture is in
@@ -89,28 +110,60 @@ namespace model
 		/// @retval Error if the texture data is invalid or failed to decode
 		///
 		[[nodiscard]]
-		std::expected<ImageVariant, Error> load() const noexcept;
+		std::expected<ImageVariant, Error> load(
+			uint32_t max_size = 0,
+			std::pmr::memory_resource& scratch_resource = *std::pmr::new_delete_resource()
+		) const noexcept;
 
 		///
 		/// @brief Load the texture data in 8bit format
 		///
+		/// @param max_size Decode hint of the larger dimension wanted, see `load`
+		/// @param scratch_resource Memory resource of the decoding temporaries, see `load`
 		/// @return Loaded 8bit image or error
 		///
 		[[nodiscard]]
 		std::expected<
 			image::Image<image::Format::Unorm8, image::Layout::RGBA>,
 			Error
-		> load_8bit() const noexcept;
+		> load_8bit(
+			uint32_t max_size = 0,
+			std::pmr::memory_resource& scratch_resource = *std::pmr::new_delete_resource()
+		) const noexcept;
 
 		///
 		/// @brief Load the texture data in 16bit format
 		///
+		/// @param max_size Decode hint of the larger dimension wanted, see `load`
+		/// @param scratch_resource Memory resource of the decoding temporaries, see `load`
 		/// @return Loaded 16bit image or error
 		///
 		[[nodiscard]]
 		std::expected<
 			image::Image<image::Format::Unorm16, image::Layout::RGBA>,
 			Error
-		> load_16bit() const noexcept;
+		> load_16bit(
+			uint32_t max_size = 0,
+			std::pmr::memory_resource& scratch_resource = *std::pmr::new_delete_resource()
+		) const noexcept;
+
+		///
+		/// @brief Hash the source data, without decoding it
+		/// @details Encoded sources are hashed by their bytes, so a file and in-memory data with identical
+		/// content hash the same. Decoded sources are hashed by their format, size and pixels
+		/// @note Flip options and sample mode are not part of the hash
+		///
+		/// @return 64-bit content hash, or error if the source file can't be read
+		///
+		[[nodiscard]]
+		std::expected<uint64_t, Error> hash_source() const noexcept;
+
+		///
+		/// @brief Copy borrowed source data (`SharedData`) into an owned byte vector
+		/// @details Releases the reference to the shared owner, so a texture kept alive long after loading
+		/// (e.g. for streaming) no longer pins the whole storage it was embedded in, such as a glTF buffer
+		/// holding geometry as well. Other sources are left untouched
+		///
+		void detach_source() noexcept;
 	};
 }
@@ -0,0 +1,209 @@
+#include "model/animation.hpp"
+#include "model/hierarchy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/quaternion_common.hpp>
+#include <glm/ext/quaternion_geometric.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/matrix.hpp>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace model
+{
+	std::vector<glm::mat4> Skin::compute_joint_matrices(
+		std::span<const glm::mat4> world_transforms,
+		uint32_t node_index
+	) const noexcept
+	{
+		const auto inverse_node_transform = glm::inverse(world_transforms[node_index]);
+
+		return std::views::zip_transform(
+				   [&](uint32_t joint, const glm::mat4& inverse_bind_matrix) {
+					   return inverse_node_transform * world_transforms[joint] * inverse_bind_matrix;
+				   },
+				   joints,
+				   inverse_bind_matrices
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	bool AnimationChannel::valid() const noexcept
+	{
+		switch (path)
+		{
+		case Path::Translation:
+		case Path::Scale:
+			if (component_count != 3) return false;
+			break;
+		case Path::Rotation:
+			if (component_count != 4) return false;
+			break;
+		case Path::Weights:
+			if (component_count == 0) return false;
+			break;
+		default:
+			return false;
+		}
+
+		if (times.empty() || !std::ranges::is_sorted(times)) return false;
+
+		const auto values_per_keyframe =
+			static_cast<size_t>(component_count) * (interpolation == Interpolation::CubicSpline ? 3 : 1);
+		return values.size() == times.size() * values_per_keyframe;
+	}
+
+	float Animation::duration() const noexcept
+	{
+		return std::ranges::fold_left(channels, 0.0f, [](float duration, const AnimationChannel& channel) {
+			return std::max(duration, channel.times.back());
+		});
+	}
+
+	namespace
+	{
+		// Keyframes around a time, and the interpolation factor between them
+		struct KeyframeSpan
+		{
+			size_t first, second;
+			float factor;
+			float interval;  // Time between the keyframes
+		};
+
+		KeyframeSpan find_keyframes(std::span<const float> times, float time) noexcept
+		{
+			if (time <= times.front()) return {.first = 0, .second = 0, .factor = 0.0f, .interval = 0.0f};
+			if (time >= times.back())
+			{
+				const auto last = times.size() - 1;
+				return {.first = last, .second = last, .factor = 0.0f, .interval = 0.0f};
+			}
+
+			const auto second = static_cast<size_t>(std::ranges::upper_bound(times, time) - times.begin());
+			const auto first = second - 1;
+			const auto interval = times[second] - times[first];
+
+			return {
+				.first = first,
+				.second = second,
+				.factor = interval > 0.0f ? (time - times[first]) / interval : 0.0f,
+				.interval = interval,
+			};
+		}
+
+		// Interpolate all components of a channel into `output`, component-wise
+		void interpolate(
+			const AnimationChannel& channel,
+			const KeyframeSpan& span,
+			std::span<float> output
+		) noexcept
+		{
+			const auto count = channel.component_count;
+			const auto values = std::span(channel.values);
+
+			if (channel.interpolation != AnimationChannel::Interpolation::CubicSpline)
+			{
+				const auto first = values.subspan(span.first * count, count);
+				const auto second = values.subspan(span.second * count, count);
+				const auto factor =
+					channel.interpolation == AnimationChannel::Interpolation::Step ? 0.0f : span.factor;
+
+				for (const auto [target, a, b] : std::views::zip(output, first, second))
+					target = a + (b - a) * factor;
+				return;
+			}
+
+			// Keyframes are laid out as in-tangent, value, out-tangent
+			const auto first = values.subspan(span.first * count * 3, count * 3);
+			const auto second = values.subspan(span.second * count * 3, count * 3);
+
+			const auto t = span.factor;
+			const auto t2 = t * t;
+			const auto t3 = t2 * t;
+			const auto value_first = 2.0f * t3 - 3.0f * t2 + 1.0f;
+			const auto tangent_first = (t3 - 2.0f * t2 + t) * span.interval;
+			const auto value_second = -2.0f * t3 + 3.0f * t2;
+			const auto tangent_second = (t3 - t2) * span.interval;
+
+			for (const auto component : std::views::iota(0u, count))
+			{
+				output[component] = value_first * first[count + component]
+					+ tangent_first * first[count * 2 + component]
+					+ value_second * second[count + component]
+					+ tangent_second * second[component];
+			}
+		}
+
+		glm::quat sample_rotation(const AnimationChannel& channel, const KeyframeSpan& span) noexcept
+		{
+			std::array<float, 4> components;
+
+			if (channel.interpolation == AnimationChannel::Interpolation::Linear)
+			{
+				const auto load = [&channel](size_t keyframe) {
+					const auto* const value = channel.values.data() + keyframe * 4;
+					return glm::quat(value[3], value[0], value[1], value[2]);
+				};
+
+				return glm::normalize(glm::slerp(load(span.first), load(span.second), span.factor));
+			}
+
+			interpolate(channel, span, components);
+			return glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+		}
+	}
+
+	void Animation::sample(
+		float time,
+		std::span<Transform> transforms,
+		std::span<std::vector<float>> morph_weights
+	) const noexcept
+	{
+		for (const auto& channel : channels)
+		{
+			const auto span = find_keyframes(channel.times, time);
+			std::array<float, 3> components;
+
+			switch (channel.path)
+			{
+			case AnimationChannel::Path::Translation:
+				interpolate(channel, span, components);
+				transforms[channel.node_index].translation = std::bit_cast<glm::vec3>(components);
+				break;
+
+			case AnimationChannel::Path::Scale:
+				interpolate(channel, span, components);
+				transforms[channel.node_index].scale = std::bit_cast<glm::vec3>(components);
+				break;
+
+			case AnimationChannel::Path::Rotation:
+				transforms[channel.node_index].rotation = sample_rotation(channel, span);
+				break;
+
+			case AnimationChannel::Path::Weights:
+			{
+				if (channel.node_index >= morph_weights.size()) break;
+
+				auto& weights = morph_weights[channel.node_index];
+				if (weights.size() >= channel.component_count)
+				{
+					interpolate(channel, span, std::span(weights).first(channel.component_count));
+					break;
+				}
+
+				auto sampled = std::vector<float>(channel.component_count);
+				interpolate(channel, span, sampled);
+				std::ranges::copy(sampled | std::views::take(weights.size()), weights.begin());
+				break;
+			}
+			}
+		}
+	}
+}
@@ -0,0 +1,460 @@
+#include "model/bvh.hpp"
+#include "model/hierarchy.hpp"
+#include "model/mesh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vector_relational.hpp>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace model
+{
+	bool Aabb::empty() const noexcept
+	{
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	glm::vec3 Aabb::center() const noexcept
+	{
+		return (min + max) * 0.5f;
+	}
+
+	float Aabb::surface_area() const noexcept
+	{
+		if (empty()) return 0.0f;
+
+		const auto extent = max - min;
+		return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	}
+
+	Aabb Aabb::merge(const Aabb& other) const noexcept
+	{
+		return {.min = glm::min(min, other.min), .max = glm::max(max, other.max)};
+	}
+
+	Aabb Aabb::transform(const glm::mat4& transform) const noexcept
+	{
+		if (empty()) return {};
+
+		// Transform the center and the half extent separately, the latter with the absolute matrix
+		const auto center = glm::vec3(transform * glm::vec4(this->center(), 1.0f));
+		const auto half_extent = (max - min) * 0.5f;
+		const auto world_half_extent = glm::abs(glm::vec3(transform[0])) * half_extent.x
+			+ glm::abs(glm::vec3(transform[1])) * half_extent.y
+			+ glm::abs(glm::vec3(transform[2])) * half_extent.z;
+
+		return {.min = center - world_half_extent, .max = center + world_half_extent};
+	}
+
+	Frustum Frustum::from_matrix(const glm::mat4& view_projection) noexcept
+	{
+		const auto row = [&view_projection](int index) {
+			return glm::vec4(
+				view_projection[0][index],
+				view_projection[1][index],
+				view_projection[2][index],
+				view_projection[3][index]
+			);
+		};
+
+		// Clip space bounds are `-w <= x, y <= w` and `0 <= z <= w`
+		auto planes = std::to_array({
+			row(3) + row(0),
+			row(3) - row(0),
+			row(3) + row(1),
+			row(3) - row(1),
+			row(2),
+			row(3) - row(2),
+		});
+
+		for (auto& plane : planes)
+		{
+			const auto length = glm::length(glm::vec3(plane));
+			if (length > 0.0f) plane /= length;
+		}
+
+		return {.planes = planes};
+	}
+
+	namespace
+	{
+		constexpr uint32_t BIN_COUNT = 12;
+
+		struct Split
+		{
+			int axis;
+			float position;  // Centroids below go to the first child
+		};
+
+		// Find the split of a range of items with the lowest surface area heuristic cost
+		std::optional<Split> find_split(
+			std::span<const uint32_t> items,
+			std::span<const Aabb> bounds,
+			const Aabb& centroid_bound
+		) noexcept
+		{
+			struct Bin
+			{
+				Aabb bound;
+				uint32_t count = 0;
+			};
+
+			std::optional<Split> best_split;
+			auto best_cost = std::numeric_limits<float>::infinity();
+
+			for (const auto axis : std::views::iota(0, 3))
+			{
+				const auto axis_min = centroid_bound.min[axis];
+				const auto extent = centroid_bound.max[axis] - axis_min;
+				if (extent <= 0.0f) continue;
+
+				const auto get_bin = [=](const Aabb& bound) {
+					const auto relative = (bound.center()[axis] - axis_min) / extent;
+					return std::min(static_cast<uint32_t>(relative * BIN_COUNT), BIN_COUNT - 1);
+				};
+
+				std::array<Bin, BIN_COUNT> bins{};
+				for (const auto item : items)
+				{
+					auto& bin = bins[get_bin(bounds[item])];
+					bin.bound = bin.bound.merge(bounds[item]);
+					bin.count++;
+				}
+
+				// Sweep from the right to get the cost of the right side of each split plane
+				std::array<float, BIN_COUNT> right_costs{};
+				Aabb right_bound;
+				uint32_t right_count = 0;
+				for (const auto bin_index : std::views::iota(1u, BIN_COUNT) | std::views::reverse)
+				{
+					right_bound = right_bound.merge(bins[bin_index].bound);
+					right_count += bins[bin_index].count;
+					right_costs[bin_index] = right_bound.surface_area() * static_cast<float>(right_count);
+				}
+
+				Aabb left_bound;
+				uint32_t left_count = 0;
+				for (const auto bin_index : std::views::iota(1u, BIN_COUNT))
+				{
+					left_bound = left_bound.merge(bins[bin_index - 1].bound);
+					left_count += bins[bin_index - 1].count;
+					if (left_count == 0 || left_count == items.size()) continue;
+
+					const auto cost =
+						left_bound.surface_area() * static_cast<float>(left_count) + right_costs[bin_index];
+					if (cost >= best_cost) continue;
+
+					best_cost = cost;
+					best_split = Split{
+						.axis = axis,
+						.position = axis_min + extent * static_cast<float>(bin_index) / BIN_COUNT,
+					};
+				}
+			}
+
+			return best_split;
+		}
+
+		std::optional<float> intersect(
+			const Aabb& bound,
+			const Ray& ray,
+			glm::vec3 inverse_direction
+		) noexcept
+		{
+			if (bound.empty()) return std::nullopt;
+
+			const auto t0 = (bound.min - ray.origin) * inverse_direction;
+			const auto t1 = (bound.max - ray.origin) * inverse_direction;
+			const auto t_near = glm::min(t0, t1);
+			const auto t_far = glm::max(t0, t1);
+
+			const auto enter = std::max({t_near.x, t_near.y, t_near.z, ray.t_min});
+			const auto exit = std::min({t_far.x, t_far.y, t_far.z, ray.t_max});
+			if (enter > exit) return std::nullopt;
+
+			return enter;
+		}
+
+		enum class Containment
+		{
+			Outside,
+			Intersect,
+			Inside
+		};
+
+		Containment classify(const Frustum& frustum, const Aabb& bound) noexcept
+		{
+			if (bound.empty()) return Containment::Outside;
+
+			auto result = Containment::Inside;
+			for (const auto& plane : frustum.planes)
+			{
+				const auto normal = glm::vec3(plane);
+
+				// Corners furthest along and against the plane normal
+				const auto facing = glm::greaterThanEqual(normal, glm::vec3(0.0f));
+				const auto positive = glm::mix(bound.min, bound.max, facing);
+				const auto negative = glm::mix(bound.max, bound.min, facing);
+
+				if (glm::dot(normal, positive) + plane.w < 0.0f) return Containment::Outside;
+				if (glm::dot(normal, negative) + plane.w < 0.0f) result = Containment::Intersect;
+			}
+
+			return result;
+		}
+
+		bool intersect(const Aabb& bound, const Sphere& sphere) noexcept
+		{
+			if (bound.empty()) return false;
+
+			const auto offset = glm::clamp(sphere.center, bound.min, bound.max) - sphere.center;
+			return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+		}
+	}
+
+	std::vector<Aabb> SceneBvh::compute_node_bounds(
+		const Hierarchy& hierarchy,
+		std::span<const Mesh> meshes,
+		std::span<const glm::mat4> world_transforms
+	) noexcept
+	{
+		return hierarchy.get_nodes()
+			| std::views::enumerate
+			| std::views::transform([&](const auto& pair) -> Aabb {
+				  const auto& [node_index, node] = pair;
+				  if (!node.data.mesh_index.has_value() || *node.data.mesh_index >= meshes.size()) return {};
+
+				  Aabb local_bound;
+				  for (const auto& primitive : meshes[*node.data.mesh_index].primitives)
+					  local_bound = local_bound.merge(
+						  Aabb{.min = primitive.geometry.aabb_min, .max = primitive.geometry.aabb_max}
+					  );
+
+				  return local_bound.transform(world_transforms[node_index]);
+			  })
+			| std::ranges::to<std::vector>();
+	}
+
+	SceneBvh SceneBvh::create(std::span<const Aabb> bounds) noexcept
+	{
+		SceneBvh bvh;
+		bvh.item_bounds = std::vector(std::from_range, bounds);
+		bvh.item_leaf = std::vector(bounds.size(), NO_PARENT);
+		bvh.items = std::views::iota(0u, static_cast<uint32_t>(bounds.size()))
+			| std::views::filter([bounds](uint32_t item) { return !bounds[item].empty(); })
+			| std::ranges::to<std::vector>();
+
+		if (bvh.items.empty()) return bvh;
+
+		bvh.nodes.push_back(
+			Node{
+				.bound = {},
+				.first = 0,
+				.count = static_cast<uint32_t>(bvh.items.size()),
+				.parent = NO_PARENT,
+			}
+		);
+
+		std::vector<uint32_t> stack = {0};
+		while (!stack.empty())
+		{
+			const auto node_index = stack.back();
+			stack.pop_back();
+
+			const auto first = bvh.nodes[node_index].first;
+			const auto count = bvh.nodes[node_index].count;
+			const auto range = std::span(bvh.items).subspan(first, count);
+
+			Aabb bound, centroid_bound;
+			for (const auto item : range)
+			{
+				bound = bound.merge(bounds[item]);
+				const auto center = bounds[item].center();
+				centroid_bound = centroid_bound.merge({.min = center, .max = center});
+			}
+			bvh.nodes[node_index].bound = bound;
+
+			if (count <= MAX_LEAF_SIZE) continue;
+
+			// Fall back to splitting in the middle if all centroids coincide
+			uint32_t left_count = count / 2;
+			if (const auto split = find_split(range, bounds, centroid_bound); split.has_value())
+			{
+				const auto middle = std::ranges::partition(range, [&](uint32_t item) {
+					return bounds[item].center()[split->axis] < split->position;
+				});
+				left_count = static_cast<uint32_t>(middle.begin() - range.begin());
+			}
+			if (left_count == 0 || left_count == count) left_count = count / 2;
+
+			const auto child_index = static_cast<uint32_t>(bvh.nodes.size());
+			bvh.nodes[node_index].first = child_index;
+			bvh.nodes[node_index].count = 0;
+
+			bvh.nodes.push_back(Node{.bound = {}, .first = first, .count = left_count, .parent = node_index});
+			bvh.nodes.push_back(
+				Node{
+					.bound = {},
+					.first = first + left_count,
+					.count = count - left_count,
+					.parent = node_index,
+				}
+			);
+
+			stack.push_back(child_index);
+			stack.push_back(child_index + 1);
+		}
+
+		for (const auto [node_index, node] : bvh.nodes | std::views::enumerate)
+			for (const auto item : std::span(bvh.items).subspan(node.first, node.count))
+				bvh.item_leaf[item] = static_cast<uint32_t>(node_index);
+
+		return bvh;
+	}
+
+	void SceneBvh::update(uint32_t item, const Aabb& bound) noexcept
+	{
+		if (item >= item_leaf.size() || item_leaf[item] == NO_PARENT) return;
+
+		item_bounds[item] = bound;
+
+		auto& leaf = nodes[item_leaf[item]];
+		leaf.bound = {};
+		for (const auto leaf_item : std::span(items).subspan(leaf.first, leaf.count))
+			leaf.bound = leaf.bound.merge(item_bounds[leaf_item]);
+
+		for (auto node_index = leaf.parent; node_index != NO_PARENT; node_index = nodes[node_index].parent)
+		{
+			auto& node = nodes[node_index];
+			node.bound = nodes[node.first].bound.merge(nodes[node.first + 1].bound);
+		}
+	}
+
+	std::vector<SceneBvh::RayHit> SceneBvh::query(const Ray& ray) const noexcept
+	{
+		if (nodes.empty()) return {};
+
+		const auto inverse_direction = 1.0f / ray.direction;
+
+		std::vector<RayHit> hits;
+		std::vector<uint32_t> stack = {0};
+
+		while (!stack.empty())
+		{
+			const auto& node = nodes[stack.back()];
+			stack.pop_back();
+
+			if (!intersect(node.bound, ray, inverse_direction).has_value()) continue;
+
+			if (node.count == 0)
+			{
+				stack.push_back(node.first);
+				stack.push_back(node.first + 1);
+				continue;
+			}
+
+			for (const auto item : std::span(items).subspan(node.first, node.count))
+				if (const auto t = intersect(item_bounds[item], ray, inverse_direction); t.has_value())
+					hits.push_back({.item = item, .t = *t});
+		}
+
+		std::ranges::sort(hits, {}, &RayHit::t);
+		return hits;
+	}
+
+	std::vector<uint32_t> SceneBvh::query(const Frustum& frustum) const noexcept
+	{
+		if (nodes.empty()) return {};
+
+		std::vector<uint32_t> result;
+		std::vector<uint32_t> stack = {0};
+
+		while (!stack.empty())
+		{
+			const auto node_index = stack.back();
+			stack.pop_back();
+
+			const auto& node = nodes[node_index];
+			const auto containment = classify(frustum, node.bound);
+
+			if (containment == Containment::Outside) continue;
+			if (containment == Containment::Inside)
+			{
+				collect(node_index, result);
+				continue;
+			}
+
+			if (node.count == 0)
+			{
+				stack.push_back(node.first);
+				stack.push_back(node.first + 1);
+				continue;
+			}
+
+			for (const auto item : std::span(items).subspan(node.first, node.count))
+				if (classify(frustum, item_bounds[item]) != Containment::Outside) result.push_back(item);
+		}
+
+		return result;
+	}
+
+	std::vector<uint32_t> SceneBvh::query(const Sphere& sphere) const noexcept
+	{
+		if (nodes.empty()) return {};
+
+		std::vector<uint32_t> result;
+		std::vector<uint32_t> stack = {0};
+
+		while (!stack.empty())
+		{
+			const auto& node = nodes[stack.back()];
+			stack.pop_back();
+
+			if (!intersect(node.bound, sphere)) continue;
+
+			if (node.count == 0)
+			{
+				stack.push_back(node.first);
+				stack.push_back(node.first + 1);
+				continue;
+			}
+
+			for (const auto item : std::span(items).subspan(node.first, node.count))
+				if (intersect(item_bounds[item], sphere)) result.push_back(item);
+		}
+
+		return result;
+	}
+
+	Aabb SceneBvh::get_bound() const noexcept
+	{
+		return nodes.empty() ? Aabb{} : nodes.front().bound;
+	}
+
+	void SceneBvh::collect(uint32_t node_index, std::vector<uint32_t>& output) const noexcept
+	{
+		const auto& node = nodes[node_index];
+
+		if (node.count == 0)
+		{
+			collect(node.first, output);
+			collect(node.first + 1, output);
+			return;
+		}
+
+		// Items whose boxes became empty after an update are skipped
+		for (const auto item : std::span(items).subspan(node.first, node.count))
+			if (!item_bounds[item].empty()) output.push_back(item);
+	}
+}
@@ -19,6 +19,10 @@
 #include <utility>
 #include <vector>
 
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
 namespace model
 {
 	glm::mat4 Transform::to_matrix() const noexcept
@@ -30,6 +34,41 @@ namespace model
 		return trs;
 	}
 
+	// Same as `a * b`, computing two columns per iteration with AVX when available
+	static glm::mat4 multiply(const glm::mat4& a, const glm::mat4& b) noexcept
+	{
+#ifdef __AVX__
+		const float* const a_ptr = &a[0][0];
+		const float* const b_ptr = &b[0][0];
+
+		// Each column of `a`, duplicated in both 128-bit lanes
+		const auto a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a_ptr + 0));
+		const auto a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a_ptr + 4));
+		const auto a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a_ptr + 8));
+		const auto a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a_ptr + 12));
+
+		glm::mat4 result;
+		float* const result_ptr = &result[0][0];
+
+		for (size_t column = 0; column < 4; column += 2)
+		{
+			// Columns `column` and `column + 1` of `b`, one per 128-bit lane
+			const auto b_columns = _mm256_loadu_ps(b_ptr + column * 4);
+
+			auto sum = _mm256_mul_ps(a0, _mm256_shuffle_ps(b_columns, b_columns, 0x00));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(a1, _mm256_shuffle_ps(b_columns, b_columns, 0x55)));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(a2, _mm256_shuffle_ps(b_columns, b_columns, 0xAA)));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(a3, _mm256_shuffle_ps(b_columns, b_columns, 0xFF)));
+
+			_mm256_storeu_ps(result_ptr + column * 4, sum);
+		}
+
+		return result;
+#else
+		return a * b;
+#endif
+	}
+
 	static std::expected<std::vector<uint32_t>, Error> get_bfs(
 		const std::vector<FullNode>& double_linked_nodes
 	) noexcept
@@ -130,6 +169,26 @@ namespace model
 			| std::ranges::to<std::vector>();
 	}
 
+	std::vector<glm::mat4> Hierarchy::get_bfs_local_transforms(
+		const std::vector<FullNode>& nodes,
+		const std::vector<uint32_t>& bfs_indices
+	) noexcept
+	{
+		return bfs_indices
+			| std::views::transform([&nodes](uint32_t idx) { return nodes[idx].data.transform.to_matrix(); })
+			| std::ranges::to<std::vector>();
+	}
+
+	std::vector<uint32_t> Hierarchy::get_bfs_parent_indices(
+		const std::vector<FullNode>& nodes,
+		const std::vector<uint32_t>& bfs_indices
+	) noexcept
+	{
+		return bfs_indices
+			| std::views::transform([&nodes](uint32_t idx) { return nodes[idx].parent_index.value_or(0); })
+			| std::ranges::to<std::vector>();
+	}
+
 	template <>
 	std::expected<Hierarchy, Error> Hierarchy::create(std::span<const ParentOnlyNode> nodes) noexcept
 	{
@@ -260,15 +319,35 @@ namespace model
 	{
 		std::pmr::vector<glm::mat4> transforms(nodes.size(), &memory_resource);
 
-		for (const auto idx : bfs_indices)
+		// The root node always comes first in BFS order
+		transforms[bfs_indices[0]] = multiply(root_transform, bfs_local_transforms[0]);
+
+		for (const auto position : std::views::iota(1zu, bfs_indices.size()))
 		{
-			const auto& node = nodes[idx];
-			const auto curr_transform = node.data.transform.to_matrix();
-			const auto parent_transform =
-				node.parent_index.transform([&transforms](uint32_t parent) { return transforms[parent]; })
-					.value_or(root_transform);
+			const auto& parent_transform = transforms[bfs_parent_indices[position]];
+			transforms[bfs_indices[position]] = multiply(parent_transform, bfs_local_transforms[position]);
+		}
 
-			transforms[idx] = parent_transform * curr_transform;
+		return transforms;
+	}
+
+	std::pmr::vector<glm::mat4> Hierarchy::compute_transforms(
+		const glm::mat4& root_transform,
+		std::span<const Transform> local_transforms,
+		std::pmr::memory_resource& memory_resource
+	) const noexcept
+	{
+		DEBUG_ASSERT(local_transforms.size() == nodes.size());
+
+		std::pmr::vector<glm::mat4> transforms(nodes.size(), &memory_resource);
+
+		transforms[bfs_indices[0]] = multiply(root_transform, local_transforms[bfs_indices[0]].to_matrix());
+
+		for (const auto position : std::views::iota(1zu, bfs_indices.size()))
+		{
+			const auto node_index = bfs_indices[position];
+			const auto& parent_transform = transforms[bfs_parent_indices[position]];
+			transforms[node_index] = multiply(parent_transform, local_transforms[node_index].to_matrix());
 		}
 
 		return transforms;
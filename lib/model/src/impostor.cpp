@@ -0,0 +1,445 @@
+#include "model/impostor.hpp"
+#include "common/util/error.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "model/material.hpp"
+#include "model/mesh.hpp"
+#include "model/model.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <functional>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/ext/vector_uint2.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <glm/glm.hpp>
+#include <limits>
+#include <map>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace model
+{
+	namespace
+	{
+		using AtlasImage = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+
+		// Passes of filling uncovered texels with their covered neighbors
+		constexpr uint32_t DILATION_PASSES = 4;
+
+		// Same as `oct_encode` in shaders
+		glm::vec2 oct_encode(glm::vec3 normal) noexcept
+		{
+			normal /= std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+			if (normal.z > 0.0f) return {normal.x, normal.y};
+
+			return {
+				std::copysign(1.0f - std::abs(normal.y), normal.x),
+				std::copysign(1.0f - std::abs(normal.x), normal.y)
+			};
+		}
+
+		// Same as `oct_decode` in shaders
+		glm::vec3 oct_decode(glm::vec2 oct) noexcept
+		{
+			auto normal = glm::vec3(oct, 1.0f - std::abs(oct.x) - std::abs(oct.y));
+			if (normal.z < 0.0f)
+				normal = glm::vec3(
+					std::copysign(1.0f - std::abs(oct.y), oct.x),
+					std::copysign(1.0f - std::abs(oct.x), oct.y),
+					normal.z
+				);
+
+			return glm::normalize(normal);
+		}
+
+		// Orthographic view of a frame, see `bake_impostors` for the basis
+		struct FrameView
+		{
+			glm::vec3 direction, right, up;
+
+			static FrameView from(glm::vec3 direction) noexcept
+			{
+				const auto near_pole = std::abs(direction.y) > 0.999f;
+				const auto reference = near_pole ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+				const auto right = glm::normalize(glm::cross(reference, direction));
+				return {.direction = direction, .right = right, .up = glm::cross(direction, right)};
+			}
+		};
+
+		float srgb_to_linear(float value) noexcept
+		{
+			return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		float linear_to_srgb(float value) noexcept
+		{
+			return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		}
+
+		glm::u8vec4 to_unorm8(glm::vec4 value) noexcept
+		{
+			return glm::u8vec4(glm::round(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
+		}
+
+		// Nearest sample with repeat addressing, in linear color
+		glm::vec4 sample_albedo(const AtlasImage& texture, glm::vec2 texcoord) noexcept
+		{
+			const auto texel = glm::floor(glm::fract(texcoord) * glm::vec2(texture.size));
+			const auto coord = glm::min(glm::u32vec2(texel), texture.size - 1u);
+			const auto value = glm::vec4(texture[coord]) / 255.0f;
+
+			return {srgb_to_linear(value.r), srgb_to_linear(value.g), srgb_to_linear(value.b), value.a};
+		}
+
+		// Signed area of the parallelogram of `(a, b, p)`, positive if `p` is left of `a -> b`
+		float edge(glm::vec2 a, glm::vec2 b, glm::vec2 p) noexcept
+		{
+			return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+		}
+
+		// Primitive to rasterize, with its material resolved
+		struct Surface
+		{
+			const Primitive* primitive;
+			Material material;
+			const AtlasImage* albedo;  // `nullptr` for the white fallback
+		};
+
+		// Rasterize every surface into a frame of the atlas, keeping the nearest fragment of each texel
+		void rasterize_frame(
+			std::span<const Surface> surfaces,
+			glm::vec3 center,
+			float radius,
+			const FrameView& view,
+			glm::uvec2 frame_offset,
+			uint32_t frame_size,
+			Impostor& impostor
+		) noexcept
+		{
+			auto depth_buffer = std::vector(frame_size * frame_size, std::numeric_limits<float>::max());
+			const auto size = static_cast<float>(frame_size);
+
+			// Texel position and depth of a point
+			const auto project = [&](glm::vec3 position) {
+				const auto offset = position - center;
+				return glm::vec3(
+					(glm::dot(offset, view.right) / radius * 0.5f + 0.5f) * size,
+					(0.5f - glm::dot(offset, view.up) / radius * 0.5f) * size,
+					(radius - glm::dot(offset, view.direction)) / (2.0f * radius)
+				);
+			};
+
+			for (const auto& surface : surfaces)
+			{
+				const auto& geometry = surface.primitive->geometry;
+				const auto& param = surface.material.param;
+				const bool masked = surface.material.mode.alpha_mode == AlphaMode::Mask;
+
+				for (const auto triangle : geometry.indices | std::views::chunk(3))
+				{
+					const auto vertices = std::to_array({
+						&geometry.vertices[triangle[0]],
+						&geometry.vertices[triangle[1]],
+						&geometry.vertices[triangle[2]],
+					});
+					const auto projected = std::to_array({
+						project(vertices[0]->position),
+						project(vertices[1]->position),
+						project(vertices[2]->position),
+					});
+					const auto screen = std::to_array({
+						glm::vec2(projected[0]),
+						glm::vec2(projected[1]),
+						glm::vec2(projected[2]),
+					});
+
+					const auto area = edge(screen[0], screen[1], screen[2]);
+					if (std::abs(area) < 1e-12f) continue;
+
+					const auto screen_min = glm::min(glm::min(screen[0], screen[1]), screen[2]);
+					const auto screen_max = glm::max(glm::max(screen[0], screen[1]), screen[2]);
+					const auto texel_min = glm::uvec2(glm::clamp(screen_min, 0.0f, size));
+					const auto texel_max = glm::uvec2(glm::clamp(glm::ceil(screen_max), 0.0f, size));
+
+					for (const auto y : std::views::iota(texel_min.y, texel_max.y))
+						for (const auto x : std::views::iota(texel_min.x, texel_max.x))
+						{
+							const auto point = glm::vec2(x, y) + 0.5f;
+							const auto weight_0 = edge(screen[1], screen[2], point) / area;
+							const auto weight_1 = edge(screen[2], screen[0], point) / area;
+							const auto weight_2 = 1.0f - weight_0 - weight_1;
+							if (weight_0 < 0.0f || weight_1 < 0.0f || weight_2 < 0.0f) continue;
+
+							const auto depth = weight_0 * projected[0].z
+								+ weight_1 * projected[1].z
+								+ weight_2 * projected[2].z;
+							auto& nearest = depth_buffer[y * frame_size + x];
+							if (depth >= nearest) continue;
+
+							const auto texcoord = weight_0 * vertices[0]->texcoord
+								+ weight_1 * vertices[1]->texcoord
+								+ weight_2 * vertices[2]->texcoord;
+
+							auto albedo = param.base_color_factor;
+							if (surface.albedo != nullptr) albedo *= sample_albedo(*surface.albedo, texcoord);
+							if (masked && albedo.a < param.alpha_cutoff) continue;
+
+							// Faces toward the viewer, as double-sided surfaces are seen from both sides
+							auto normal = weight_0 * vertices[0]->normal
+								+ weight_1 * vertices[1]->normal
+								+ weight_2 * vertices[2]->normal;
+							normal = glm::length(normal) > 0.0f ? glm::normalize(normal) : view.direction;
+							if (glm::dot(normal, view.direction) < 0.0f) normal = -normal;
+
+							nearest = depth;
+
+							const auto coord = frame_offset + glm::uvec2(x, y);
+							impostor.albedo[coord] = to_unorm8(
+								glm::vec4(
+									linear_to_srgb(albedo.r),
+									linear_to_srgb(albedo.g),
+									linear_to_srgb(albedo.b),
+									1.0f
+								)
+							);
+							impostor.normal_depth[coord] = to_unorm8(glm::vec4(normal * 0.5f + 0.5f, depth));
+						}
+				}
+			}
+		}
+
+		// Fill uncovered texels with the colors of their covered neighbors within the same frame, keeping
+		// them uncovered
+		void dilate(Impostor& impostor, uint32_t frame_size) noexcept
+		{
+			const auto atlas_size = impostor.albedo.size;
+			auto covered = std::vector<bool>(atlas_size.x * atlas_size.y);
+			for (const auto [index, texel] : impostor.albedo.data | std::views::enumerate)
+				covered[index] = texel.a != 0;
+
+			for (uint32_t pass = 0; pass < DILATION_PASSES; pass++)
+			{
+				auto next_covered = covered;
+
+				for (const auto y : std::views::iota(0u, atlas_size.y))
+					for (const auto x : std::views::iota(0u, atlas_size.x))
+					{
+						if (covered[y * atlas_size.x + x]) continue;
+
+						const auto frame_min = glm::uvec2(x, y) / frame_size * frame_size;
+						const auto frame_max = frame_min + frame_size - 1u;
+						const auto neighbors = std::to_array<glm::uvec2>({
+							{std::max(x, frame_min.x + 1) - 1, y},
+							{std::min(x + 1, frame_max.x), y},
+							{x, std::max(y, frame_min.y + 1) - 1},
+							{x, std::min(y + 1, frame_max.y)},
+						});
+
+						for (const auto neighbor : neighbors)
+						{
+							if (!covered[neighbor.y * atlas_size.x + neighbor.x]) continue;
+
+							const auto coord = glm::uvec2(x, y);
+							impostor.albedo[coord] = glm::u8vec4(glm::u8vec3(impostor.albedo[neighbor]), 0);
+							impostor.normal_depth[coord] = impostor.normal_depth[neighbor];
+							next_covered[y * atlas_size.x + x] = true;
+							break;
+						}
+					}
+
+				covered = std::move(next_covered);
+			}
+		}
+
+		std::expected<Impostor, Error> bake_impostor(
+			const Model& model,
+			uint32_t mesh_index,
+			const ImpostorOption& option,
+			std::map<uint32_t, AtlasImage>& texture_cache
+		) noexcept
+		{
+			const auto& mesh = model.meshes[mesh_index];
+
+			/* Bounding sphere */
+
+			auto aabb_min = glm::vec3(std::numeric_limits<float>::max());
+			auto aabb_max = glm::vec3(std::numeric_limits<float>::lowest());
+			for (const auto& primitive : mesh.primitives)
+			{
+				aabb_min = glm::min(aabb_min, primitive.geometry.aabb_min);
+				aabb_max = glm::max(aabb_max, primitive.geometry.aabb_max);
+			}
+
+			const auto center = (aabb_min + aabb_max) * 0.5f;
+			float radius = 0.0f;
+			for (const auto& primitive : mesh.primitives)
+				for (const auto& vertex : primitive.geometry.vertices)
+					radius = std::max(radius, glm::distance(vertex.position, center));
+
+			if (!(radius > 0.0f))
+				return Error(
+					"Mesh is degenerated",
+					std::format("Mesh #{} has an empty bounding sphere", mesh_index)
+				);
+
+			/* Surfaces */
+
+			std::vector<Surface> surfaces;
+			for (const auto& primitive : mesh.primitives)
+			{
+				const auto& material = primitive.material_index.has_value()
+					? model.material_list.materials[*primitive.material_index]
+					: MaterialList::DEFAULT_MATERIAL;
+
+				const AtlasImage* albedo = nullptr;
+				if (const auto texture_index = material.texture_set.albedo; texture_index.has_value())
+				{
+					auto cached = texture_cache.find(*texture_index);
+					if (cached == texture_cache.end())
+					{
+						const auto& texture = model.material_list.textures[*texture_index].first;
+						auto texture_result = texture.load_8bit(option.max_texture_size);
+						if (!texture_result)
+							return texture_result.error().forward(
+								"Load albedo texture failed",
+								std::format("Texture #{}", *texture_index)
+							);
+						cached = texture_cache.emplace(*texture_index, std::move(*texture_result)).first;
+					}
+					albedo = &cached->second;
+				}
+
+				surfaces.push_back({.primitive = &primitive, .material = material, .albedo = albedo});
+			}
+
+			/* Frames */
+
+			const auto atlas_size = glm::uvec2(option.frame_count * option.frame_size);
+			auto impostor = Impostor{
+				.mesh_index = mesh_index,
+				.center = center,
+				.radius = radius,
+				.albedo = AtlasImage(atlas_size, {0, 0, 0, 0}),
+				.normal_depth = AtlasImage(atlas_size, {128, 128, 255, 255})
+			};
+
+			for (const auto frame_y : std::views::iota(0u, option.frame_count))
+				for (const auto frame_x : std::views::iota(0u, option.frame_count))
+				{
+					const auto frame = glm::uvec2(frame_x, frame_y);
+					const auto direction = get_impostor_frame_direction(frame, option.frame_count);
+					const auto view = FrameView::from(direction);
+					rasterize_frame(
+						surfaces,
+						center,
+						radius,
+						view,
+						frame * option.frame_size,
+						option.frame_size,
+						impostor
+					);
+				}
+
+			dilate(impostor, option.frame_size);
+
+			return impostor;
+		}
+	}
+
+	glm::vec3 get_impostor_frame_direction(glm::uvec2 frame, uint32_t frame_count) noexcept
+	{
+		const auto oct = (glm::vec2(frame) + 0.5f) / static_cast<float>(frame_count) * 2.0f - 1.0f;
+		return oct_decode(oct);
+	}
+
+	glm::uvec2 get_impostor_frame(glm::vec3 direction, uint32_t frame_count) noexcept
+	{
+		const auto oct = oct_encode(glm::normalize(direction)) * 0.5f + 0.5f;
+		const auto frame = glm::floor(oct * static_cast<float>(frame_count));
+		return glm::uvec2(glm::clamp(frame, 0.0f, static_cast<float>(frame_count - 1)));
+	}
+
+	std::expected<Model, Error> bake_impostors(Model model, const ImpostorOption& option) noexcept
+	{
+		if (option.frame_count == 0 || option.frame_size == 0) return Error("Impostor atlas layout is empty");
+
+		/* Select meshes */
+
+		std::vector<uint32_t> reference_counts(model.meshes.size(), 0);
+		for (const auto& [node_index, mesh_index] : model.hierarchy.get_renderables())
+			reference_counts[mesh_index]++;
+
+		std::vector<bool> proxy_meshes(model.meshes.size(), false);
+		for (const auto& cluster : model.hlod.clusters)
+		{
+			const auto& proxy_mesh = model.hierarchy.get_nodes()[cluster.proxy_node_index].data.mesh_index;
+			if (proxy_mesh.has_value()) proxy_meshes[*proxy_mesh] = true;
+		}
+
+		const auto get_alpha_mode = [&model](const Primitive& primitive) {
+			if (!primitive.material_index.has_value()) return MaterialList::DEFAULT_MATERIAL.mode.alpha_mode;
+			return model.material_list.materials[*primitive.material_index].mode.alpha_mode;
+		};
+
+		std::vector<uint32_t> selected_meshes;
+		for (const auto [mesh_index, mesh] : model.meshes | std::views::enumerate)
+		{
+			const auto reference_count = reference_counts[mesh_index];
+			if (reference_count == 0 || proxy_meshes[mesh_index]) continue;
+			if (mesh.primitives.empty() || mesh.deformable()) continue;
+
+			const auto alpha_modes = mesh.primitives | std::views::transform(get_alpha_mode);
+			if (std::ranges::contains(alpha_modes, AlphaMode::Blend)) continue;
+
+			const bool masked = std::ranges::contains(alpha_modes, AlphaMode::Mask);
+			if (reference_count >= option.min_mesh_references || masked)
+				selected_meshes.push_back(static_cast<uint32_t>(mesh_index));
+		}
+
+		std::ranges::stable_sort(selected_meshes, std::greater(), [&reference_counts](uint32_t mesh_index) {
+			return reference_counts[mesh_index];
+		});
+		if (selected_meshes.size() > option.max_impostor_count)
+			selected_meshes.resize(option.max_impostor_count);
+		std::ranges::sort(selected_meshes);
+
+		/* Bake */
+
+		auto impostors = ImpostorList{.frame_count = option.frame_count, .frame_size = option.frame_size};
+		auto texture_cache = std::map<uint32_t, AtlasImage>();
+
+		for (const auto mesh_index : selected_meshes)
+		{
+			auto impostor_result = bake_impostor(model, mesh_index, option, texture_cache);
+			if (!impostor_result)
+				return impostor_result.error().forward(
+					"Bake impostor failed",
+					std::format("Mesh #{}", mesh_index)
+				);
+			impostors.impostors.push_back(std::move(*impostor_result));
+		}
+
+		auto model_result = Model::assemble(
+			std::move(model.material_list),
+			std::move(model.meshes),
+			std::move(model.hierarchy),
+			std::move(model.lights),
+			std::move(model.skins),
+			std::move(model.animations),
+			std::move(model.hlod),
+			std::move(impostors)
+		);
+		if (!model_result) return model_result.error().forward("Assemble model with impostors failed");
+
+		return std::move(*model_result);
+	}
+}
@@ -8,6 +8,8 @@
 #include <cstdint>
 #include <expected>
 #include <format>
+#include <glm/ext/vector_float3.hpp>
+#include <map>
 #include <optional>
 #include <ranges>
 #include <string_view>
@@ -86,4 +88,71 @@ namespace model
 
 		return MaterialList(std::move(texture_pair), std::move(materials));
 	}
+
+	Material Material::canonicalize() const noexcept
+	{
+		constexpr auto default_param = Param();
+		auto result = *this;
+
+		if (mode.alpha_mode != AlphaMode::Mask) result.param.alpha_cutoff = default_param.alpha_cutoff;
+		if (param.emissive_factor == glm::vec3(0.0f)) result.texture_set.emissive = std::nullopt;
+		if (!texture_set.normal.has_value()) result.param.normal_scale = default_param.normal_scale;
+
+		return result;
+	}
+
+	namespace
+	{
+		// Key ordering materials by all of their fields, equal keys render identically
+		auto get_material_key(const Material& material) noexcept
+		{
+			const auto& param = material.param;
+			const auto& texture_set = material.texture_set;
+
+			return std::tuple(
+				std::to_array({
+					param.base_color_factor.r,
+					param.base_color_factor.g,
+					param.base_color_factor.b,
+					param.base_color_factor.a,
+					param.emissive_factor.r,
+					param.emissive_factor.g,
+					param.emissive_factor.b,
+					param.alpha_cutoff,
+					param.metallic_factor,
+					param.roughness_factor,
+					param.normal_scale.x,
+					param.normal_scale.y,
+				}),
+				material.mode,
+				texture_set.albedo,
+				texture_set.emissive,
+				texture_set.roughness_metallic,
+				texture_set.normal
+			);
+		}
+	}
+
+	std::vector<uint32_t> MaterialList::deduplicate() noexcept
+	{
+		std::map<decltype(get_material_key(Material())), uint32_t> unique_indices;
+		std::vector<Material> unique_materials;
+		std::vector<uint32_t> remap;
+		remap.reserve(materials.size());
+
+		for (const auto& material : materials)
+		{
+			const auto canonical = material.canonicalize();
+			const auto [iter, inserted] = unique_indices.try_emplace(
+				get_material_key(canonical),
+				static_cast<uint32_t>(unique_materials.size())
+			);
+
+			if (inserted) unique_materials.push_back(canonical);
+			remap.push_back(iter->second);
+		}
+
+		materials = std::move(unique_materials);
+		return remap;
+	}
 }
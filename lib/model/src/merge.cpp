@@ -0,0 +1,566 @@
+#include "model/merge.hpp"
+#include "common/util/error.hpp"
+#include "model/animation.hpp"
+#include "model/hierarchy.hpp"
+#include "model/mesh.hpp"
+#include "model/model.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <glm/ext/matrix_float3x3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint3.hpp>
+#include <glm/glm.hpp>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace model
+{
+	namespace
+	{
+		// A primitive of a merged mesh, placed by a node
+		struct Instance
+		{
+			uint32_t node_index;
+			uint32_t mesh_index;
+			uint32_t primitive_index;
+			glm::mat4 transform;  // Relative to the root node
+			glm::vec3 aabb_min, aabb_max;
+			uint64_t morton_code = 0;
+		};
+
+		const Geometry& get_geometry(const std::vector<Mesh>& meshes, const Instance& instance) noexcept
+		{
+			return meshes[instance.mesh_index].primitives[instance.primitive_index].geometry;
+		}
+
+		std::pair<glm::vec3, glm::vec3> transform_aabb(
+			const glm::mat4& transform,
+			glm::vec3 aabb_min,
+			glm::vec3 aabb_max
+		) noexcept
+		{
+			auto result_min = glm::vec3(std::numeric_limits<float>::max());
+			auto result_max = glm::vec3(std::numeric_limits<float>::lowest());
+
+			for (const auto corner : std::views::iota(0u, 8u))
+			{
+				const auto local = glm::vec3(
+					(corner & 1) != 0 ? aabb_max.x : aabb_min.x,
+					(corner & 2) != 0 ? aabb_max.y : aabb_min.y,
+					(corner & 4) != 0 ? aabb_max.z : aabb_min.z
+				);
+				const auto world = glm::vec3(transform * glm::vec4(local, 1.0f));
+
+				result_min = glm::min(result_min, world);
+				result_max = glm::max(result_max, world);
+			}
+
+			return {result_min, result_max};
+		}
+
+		// Spread the lower 21 bits of `value` to every third bit
+		uint64_t expand_bits(uint64_t value) noexcept
+		{
+			value &= 0x1FFFFF;
+			value = (value | value << 32) & 0x1F00000000FFFF;
+			value = (value | value << 16) & 0x1F0000FF0000FF;
+			value = (value | value << 8) & 0x100F00F00F00F00F;
+			value = (value | value << 4) & 0x10C30C30C30C30C3;
+			value = (value | value << 2) & 0x1249249249249249;
+			return value;
+		}
+
+		uint64_t morton_code(glm::vec3 point, glm::vec3 bound_min, glm::vec3 bound_max) noexcept
+		{
+			constexpr auto MAX_COORD = static_cast<float>((1u << 21) - 1);
+
+			const auto extent = glm::max(bound_max - bound_min, glm::vec3(1e-20f));
+			const auto coord = glm::clamp((point - bound_min) / extent, 0.0f, 1.0f) * MAX_COORD;
+
+			return expand_bits(static_cast<uint64_t>(coord.x))
+				| expand_bits(static_cast<uint64_t>(coord.y)) << 1
+				| expand_bits(static_cast<uint64_t>(coord.z)) << 2;
+		}
+
+		// Split instances sorted in Morton order into clusters, greedily
+		std::vector<std::span<const Instance>> cluster_instances(
+			std::span<const Instance> instances,
+			const std::vector<Mesh>& meshes,
+			const MergeOption& option
+		) noexcept
+		{
+			std::vector<std::span<const Instance>> clusters;
+
+			size_t cluster_begin = 0;
+			uint64_t cluster_vertices = 0;
+			auto cluster_min = glm::vec3(std::numeric_limits<float>::max());
+			auto cluster_max = glm::vec3(std::numeric_limits<float>::lowest());
+
+			for (const auto index : std::views::iota(0zu, instances.size()))
+			{
+				const auto& instance = instances[index];
+				const auto& geometry = get_geometry(meshes, instance);
+				const auto vertex_count = geometry.vertices.size();
+
+				const auto merged_min = glm::min(cluster_min, instance.aabb_min);
+				const auto merged_max = glm::max(cluster_max, instance.aabb_max);
+
+				const auto exceeds_vertices = cluster_vertices + vertex_count > option.max_cluster_vertices;
+				const auto exceeds_extent =
+					option.max_cluster_extent > 0.0f
+					&& glm::length(merged_max - merged_min) > option.max_cluster_extent;
+
+				if (cluster_vertices > 0 && (exceeds_vertices || exceeds_extent))
+				{
+					clusters.push_back(instances.subspan(cluster_begin, index - cluster_begin));
+
+					cluster_begin = index;
+					cluster_vertices = 0;
+					cluster_min = instance.aabb_min;
+					cluster_max = instance.aabb_max;
+				}
+				else
+				{
+					cluster_min = merged_min;
+					cluster_max = merged_max;
+				}
+
+				cluster_vertices += vertex_count;
+			}
+
+			if (cluster_begin < instances.size()) clusters.push_back(instances.subspan(cluster_begin));
+
+			return clusters;
+		}
+
+		// Nodes moved by an animation, directly or through an ancestor, are not static
+		std::vector<bool> get_animated_nodes(const Model& model) noexcept
+		{
+			const auto nodes = model.hierarchy.get_nodes();
+
+			std::vector<bool> animated(nodes.size(), false);
+			for (const auto& animation : model.animations)
+				for (const auto& channel : animation.channels)
+					if (channel.path != AnimationChannel::Path::Weights) animated[channel.node_index] = true;
+			for (const auto node_index : model.hierarchy.get_bfs_order())
+				if (const auto parent = nodes[node_index].parent_index;
+					parent.has_value() && animated[*parent])
+					animated[node_index] = true;
+
+			return animated;
+		}
+
+		// Pre-transform the instances of a cluster into a single geometry
+		std::expected<std::pair<Geometry, std::vector<MergeSource>>, Error> merge_cluster(
+			std::span<const Instance> cluster,
+			const std::vector<Mesh>& meshes
+		) noexcept
+		{
+			std::vector<FullVertex> vertices;
+			std::vector<uint32_t> indices;
+			std::vector<MergeSource> sources;
+
+			for (const auto& instance : cluster)
+			{
+				const auto& geometry = get_geometry(meshes, instance);
+
+				const auto linear = glm::mat3(instance.transform);
+				const auto normal_matrix = glm::transpose(glm::inverse(linear));
+				const auto mirrored = glm::determinant(linear) < 0.0f;
+
+				const auto safe_normalize = [](glm::vec3 vector) {
+					const auto length = glm::length(vector);
+					return length > 0.0f ? vector / length : vector;
+				};
+
+				const auto vertex_base = static_cast<uint32_t>(vertices.size());
+				for (const auto& vertex : geometry.vertices)
+				{
+					const auto tangent = safe_normalize(linear * glm::vec3(vertex.tangent));
+
+					vertices.push_back({
+						.position = glm::vec3(instance.transform * glm::vec4(vertex.position, 1.0f)),
+						.texcoord = vertex.texcoord,
+						.normal = safe_normalize(normal_matrix * vertex.normal),
+						.tangent = glm::vec4(tangent, mirrored ? -vertex.tangent.w : vertex.tangent.w),
+					});
+				}
+
+				// Mirroring flips the winding, swap two vertices of each triangle to keep the front faces
+				const auto triangle_offset = static_cast<uint32_t>(indices.size() / 3);
+				for (const auto triangle : geometry.indices | std::views::chunk(3))
+				{
+					indices.push_back(vertex_base + triangle[0]);
+					indices.push_back(vertex_base + triangle[mirrored ? 2 : 1]);
+					indices.push_back(vertex_base + triangle[mirrored ? 1 : 2]);
+				}
+
+				sources.push_back({
+					.node_index = instance.node_index,
+					.mesh_index = instance.mesh_index,
+					.primitive_index = instance.primitive_index,
+					.triangle_offset = triangle_offset,
+					.triangle_count = static_cast<uint32_t>(geometry.indices.size() / 3),
+				});
+			}
+
+			auto geometry_result = Geometry::create(std::move(vertices), std::move(indices));
+			if (!geometry_result) return geometry_result.error().forward("Create merged geometry failed");
+
+			return std::pair(std::move(*geometry_result), std::move(sources));
+		}
+	}
+
+	std::optional<MergeSource> MergeResult::find_source(
+		uint32_t node_index,
+		uint32_t triangle_index
+	) const noexcept
+	{
+		const auto merged = std::ranges::find(merged_primitives, node_index, &MergedPrimitive::node_index);
+		if (merged == merged_primitives.end()) return std::nullopt;
+
+		// First source starting after the triangle, the one before it contains the triangle
+		const auto next = std::ranges::upper_bound(
+			merged->sources,
+			triangle_index,
+			std::less{},
+			&MergeSource::triangle_offset
+		);
+		if (next == merged->sources.begin()) return std::nullopt;
+
+		const auto& source = *std::prev(next);
+		if (triangle_index >= source.triangle_offset + source.triangle_count) return std::nullopt;
+
+		return source;
+	}
+
+	std::expected<MergeResult, Error> merge_static_geometry(Model model, const MergeOption& option) noexcept
+	{
+		const auto nodes = model.hierarchy.get_nodes();
+		const auto root_index = model.hierarchy.get_bfs_order()[0];
+
+		/* Select meshes to merge */
+
+		const auto animated = get_animated_nodes(model);
+
+		std::vector<uint32_t> reference_counts(model.meshes.size(), 0);
+		std::vector<bool> referenced_by_animated(model.meshes.size(), false);
+		for (const auto& [node_index, mesh_index] : model.hierarchy.get_renderables())
+		{
+			reference_counts[mesh_index]++;
+			if (animated[node_index]) referenced_by_animated[mesh_index] = true;
+		}
+
+		const auto mergeable =
+			std::views::zip(model.meshes, reference_counts, referenced_by_animated)
+			| std::views::transform([&option](const auto& tuple) {
+				  const auto& [mesh, reference_count, dynamic] = tuple;
+				  if (reference_count == 0 || reference_count > option.max_mesh_references) return false;
+				  if (dynamic || mesh.deformable()) return false;
+
+				  const auto vertex_count = std::ranges::fold_left(
+					  mesh.primitives | std::views::transform([](const Primitive& primitive) {
+						  return primitive.geometry.vertices.size();
+					  }),
+					  0zu,
+					  std::plus{}
+				  );
+				  return vertex_count <= option.max_source_vertices;
+			  })
+			| std::ranges::to<std::vector>();
+
+		/* Collect instances, grouped by material */
+
+		// Merged geometry lives in the space of the root node, so the root transform is still applied
+		const auto transforms = model.hierarchy.compute_transforms(glm::mat4(1.0f));
+		const auto root_inverse = glm::inverse(transforms[root_index]);
+
+		std::map<std::optional<uint32_t>, std::vector<Instance>> material_groups;
+		for (const auto& [node_index, mesh_index] : model.hierarchy.get_renderables())
+		{
+			if (!mergeable[mesh_index]) continue;
+
+			const auto transform = root_inverse * transforms[node_index];
+			const auto& primitives = model.meshes[mesh_index].primitives;
+			for (const auto [primitive_index, primitive] : primitives | std::views::enumerate)
+			{
+				const auto [aabb_min, aabb_max] =
+					transform_aabb(transform, primitive.geometry.aabb_min, primitive.geometry.aabb_max);
+
+				material_groups[primitive.material_index].push_back({
+					.node_index = node_index,
+					.mesh_index = mesh_index,
+					.primitive_index = static_cast<uint32_t>(primitive_index),
+					.transform = transform,
+					.aabb_min = aabb_min,
+					.aabb_max = aabb_max,
+				});
+			}
+		}
+
+		/* Build output meshes, kept meshes first */
+
+		std::vector<Mesh> meshes;
+		std::vector<std::optional<uint32_t>> mesh_remap(model.meshes.size(), std::nullopt);
+		for (const auto [mesh_index, mesh] : model.meshes | std::views::enumerate)
+		{
+			if (mergeable[mesh_index] || reference_counts[mesh_index] == 0) continue;
+
+			mesh_remap[mesh_index] = static_cast<uint32_t>(meshes.size());
+			meshes.push_back(std::move(mesh));
+		}
+
+		auto output_nodes =
+			nodes
+			| std::views::transform([&mesh_remap](const FullNode& node) {
+				  auto data = node.data;
+				  if (data.mesh_index.has_value()) data.mesh_index = mesh_remap[*data.mesh_index];
+				  return ParentOnlyNode{.parent_index = node.parent_index, .data = data};
+			  })
+			| std::ranges::to<std::vector>();
+
+		/* Cluster and merge */
+
+		std::vector<MergedPrimitive> merged_primitives;
+		for (auto& [material_index, instances] : material_groups)
+		{
+			auto bound_min = glm::vec3(std::numeric_limits<float>::max());
+			auto bound_max = glm::vec3(std::numeric_limits<float>::lowest());
+			for (const auto& instance : instances)
+			{
+				bound_min = glm::min(bound_min, instance.aabb_min);
+				bound_max = glm::max(bound_max, instance.aabb_max);
+			}
+
+			for (auto& instance : instances)
+				instance.morton_code =
+					morton_code((instance.aabb_min + instance.aabb_max) * 0.5f, bound_min, bound_max);
+			std::ranges::stable_sort(instances, std::less{}, &Instance::morton_code);
+
+			for (const auto cluster : cluster_instances(instances, model.meshes, option))
+			{
+				auto merge_result = merge_cluster(cluster, model.meshes);
+				if (!merge_result) return merge_result.error().forward("Merge cluster failed");
+				auto [geometry, sources] = std::move(*merge_result);
+
+				const auto mesh_index = static_cast<uint32_t>(meshes.size());
+				const auto node_index = static_cast<uint32_t>(output_nodes.size());
+
+				auto primitive = Primitive{
+					.geometry = std::move(geometry),
+					.lods = {},
+					.material_index = material_index,
+				};
+				meshes.push_back(Mesh{.primitives = {std::move(primitive)}});
+				output_nodes.push_back(
+					ParentOnlyNode{.parent_index = root_index, .data = NodeData{.mesh_index = mesh_index}}
+				);
+
+				merged_primitives.push_back({
+					.node_index = node_index,
+					.mesh_index = mesh_index,
+					.sources = std::move(sources),
+				});
+			}
+		}
+
+		/* Assemble */
+
+		auto hierarchy_result = Hierarchy::create(output_nodes);
+		if (!hierarchy_result) return hierarchy_result.error().forward("Create merged hierarchy failed");
+
+		auto model_result = Model::assemble(
+			std::move(model.material_list),
+			std::move(meshes),
+			std::move(*hierarchy_result),
+			std::move(model.lights),
+			std::move(model.skins),
+			std::move(model.animations)
+		);
+		if (!model_result) return model_result.error().forward("Assemble merged model failed");
+
+		return MergeResult{
+			.model = std::move(*model_result),
+			.merged_primitives = std::move(merged_primitives),
+		};
+	}
+
+	std::expected<Model, Error> build_hlod(Model model, const HlodOption& option) noexcept
+	{
+		if (!model.hlod.clusters.empty()) return Error("Model already has HLOD");
+
+		const auto nodes = model.hierarchy.get_nodes();
+		const auto root_index = model.hierarchy.get_bfs_order()[0];
+		const auto animated = get_animated_nodes(model);
+
+		/* Collect static nodes */
+
+		// Proxies live in the space of the root node, like merged geometry
+		const auto transforms = model.hierarchy.compute_transforms(glm::mat4(1.0f));
+		const auto root_inverse = glm::inverse(transforms[root_index]);
+
+		struct StaticNode
+		{
+			uint32_t node_index;
+			uint32_t mesh_index;
+			glm::mat4 transform;  // Relative to the root node
+			glm::vec3 aabb_min, aabb_max;
+		};
+
+		std::vector<StaticNode> static_nodes;
+		auto bound_min = glm::vec3(std::numeric_limits<float>::max());
+		auto bound_max = glm::vec3(std::numeric_limits<float>::lowest());
+
+		for (const auto& [node_index, mesh_index] : model.hierarchy.get_renderables())
+		{
+			const auto& mesh = model.meshes[mesh_index];
+			if (animated[node_index] || mesh.deformable() || mesh.primitives.empty()) continue;
+
+			auto node = StaticNode{
+				.node_index = node_index,
+				.mesh_index = mesh_index,
+				.transform = root_inverse * transforms[node_index],
+				.aabb_min = glm::vec3(std::numeric_limits<float>::max()),
+				.aabb_max = glm::vec3(std::numeric_limits<float>::lowest()),
+			};
+			for (const auto& primitive : mesh.primitives)
+			{
+				const auto [aabb_min, aabb_max] =
+					transform_aabb(node.transform, primitive.geometry.aabb_min, primitive.geometry.aabb_max);
+				node.aabb_min = glm::min(node.aabb_min, aabb_min);
+				node.aabb_max = glm::max(node.aabb_max, aabb_max);
+			}
+
+			bound_min = glm::min(bound_min, node.aabb_min);
+			bound_max = glm::max(bound_max, node.aabb_max);
+			static_nodes.push_back(node);
+		}
+
+		if (static_nodes.empty()) return model;
+
+		/* Cluster in a grid, ordered for a deterministic output */
+
+		const auto bound_extent = bound_max - bound_min;
+		const auto cell_size = option.cell_size > 0.0f
+			? option.cell_size
+			: std::max(std::max(bound_extent.x, std::max(bound_extent.y, bound_extent.z)) / 8.0f, 1e-20f);
+
+		std::map<std::array<uint32_t, 3>, std::vector<uint32_t>> cells;
+		for (const auto [static_index, node] : static_nodes | std::views::enumerate)
+		{
+			const auto center = (node.aabb_min + node.aabb_max) * 0.5f;
+			const auto cell = glm::uvec3(glm::floor((center - bound_min) / cell_size));
+			cells[{cell.x, cell.y, cell.z}].push_back(static_cast<uint32_t>(static_index));
+		}
+
+		/* Build proxies */
+
+		auto output_nodes =
+			nodes
+			| std::views::transform([](const FullNode& node) {
+				  return ParentOnlyNode{.parent_index = node.parent_index, .data = node.data};
+			  })
+			| std::ranges::to<std::vector>();
+
+		HlodList hlod;
+		const auto min_cluster_nodes = std::max(option.min_cluster_nodes, 2u);
+
+		for (const auto& members : cells | std::views::values)
+		{
+			if (members.size() < min_cluster_nodes) continue;
+
+			auto cluster = HlodCluster{
+				.proxy_node_index = static_cast<uint32_t>(output_nodes.size()),
+				.source_offset = static_cast<uint32_t>(hlod.source_nodes.size()),
+				.source_count = static_cast<uint32_t>(members.size()),
+				.aabb_min = glm::vec3(std::numeric_limits<float>::max()),
+				.aabb_max = glm::vec3(std::numeric_limits<float>::lowest()),
+			};
+
+			std::map<std::optional<uint32_t>, std::vector<Instance>> material_groups;
+			for (const auto static_index : members)
+			{
+				const auto& node = static_nodes[static_index];
+				cluster.aabb_min = glm::min(cluster.aabb_min, node.aabb_min);
+				cluster.aabb_max = glm::max(cluster.aabb_max, node.aabb_max);
+				hlod.source_nodes.push_back(node.node_index);
+
+				const auto& primitives = model.meshes[node.mesh_index].primitives;
+				for (const auto [primitive_index, primitive] : primitives | std::views::enumerate)
+					material_groups[primitive.material_index].push_back({
+						.node_index = node.node_index,
+						.mesh_index = node.mesh_index,
+						.primitive_index = static_cast<uint32_t>(primitive_index),
+						.transform = node.transform,
+						.aabb_min = node.aabb_min,
+						.aabb_max = node.aabb_max,
+					});
+			}
+
+			auto proxy = Mesh{};
+			for (const auto& [material_index, instances] : material_groups)
+			{
+				auto merge_result = merge_cluster(instances, model.meshes);
+				if (!merge_result) return merge_result.error().forward("Merge HLOD cluster failed");
+				auto geometry = std::move(merge_result->first);
+
+				// Geometry is kept in full if it can't be simplified
+				auto lods = geometry.simplify({
+					.max_levels = 1,
+					.index_ratio = option.index_ratio,
+					.max_error = option.max_error,
+					.min_reduction = 1.0f,
+					.sloppy = true,
+				});
+				if (!lods.empty())
+				{
+					auto simplified_result =
+						Geometry::create(std::move(geometry.vertices), std::move(lods[0].indices));
+					if (!simplified_result)
+						return simplified_result.error().forward("Create proxy geometry failed");
+					geometry = simplified_result->optimize();
+				}
+
+				proxy.primitives.push_back(
+					Primitive{.geometry = std::move(geometry), .lods = {}, .material_index = material_index}
+				);
+			}
+
+			const auto mesh_index = static_cast<uint32_t>(model.meshes.size());
+			model.meshes.push_back(std::move(proxy));
+			output_nodes.push_back(
+				ParentOnlyNode{.parent_index = root_index, .data = NodeData{.mesh_index = mesh_index}}
+			);
+			hlod.clusters.push_back(cluster);
+		}
+
+		/* Assemble */
+
+		auto hierarchy_result = Hierarchy::create(output_nodes);
+		if (!hierarchy_result) return hierarchy_result.error().forward("Create HLOD hierarchy failed");
+
+		auto model_result = Model::assemble(
+			std::move(model.material_list),
+			std::move(model.meshes),
+			std::move(*hierarchy_result),
+			std::move(model.lights),
+			std::move(model.skins),
+			std::move(model.animations),
+			std::move(hlod)
+		);
+		if (!model_result) return model_result.error().forward("Assemble HLOD model failed");
+
+		return std::move(*model_result);
+	}
+}
@@ -1,9 +1,12 @@
 #include "model/mesh.hpp"
+#include "common/number-literals.hpp"
+#include "common/util/arena.hpp"
 #include "common/util/array.hpp"
 #include "common/util/error.hpp"
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <expected>
@@ -13,13 +16,18 @@
 #include <glm/ext/matrix_float2x3.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <glm/ext/vector_float4.hpp>
+#include <glm/ext/vector_uint3_sized.hpp>
 #include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtx/vector_angle.hpp>
 #include <glm/matrix.hpp>
 #include <glm/vector_relational.hpp>
+#include <limits>
+#include <memory_resource>
 #include <meshoptimizer.h>
 #include <ranges>
 #include <span>
+#include <utility>
 #include <vector>
 
 namespace model
@@ -90,10 +98,298 @@ namespace model
 			   });
 	}
 
+	namespace
+	{
+		// Octahedral encoding of unit vectors, must match `algorithm/octahedral.slang`
+		glm::vec2 oct_encode(glm::vec3 normal) noexcept
+		{
+			normal /= glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+			if (normal.z <= 0.0f)
+			{
+				return {
+					std::copysign(1.0f - glm::abs(normal.y), normal.x),
+					std::copysign(1.0f - glm::abs(normal.x), normal.y)
+				};
+			}
+
+			return {normal.x, normal.y};
+		}
+
+		glm::vec3 oct_decode(glm::vec2 oct) noexcept
+		{
+			auto normal = glm::vec3(oct, 1.0f - glm::abs(oct.x) - glm::abs(oct.y));
+			if (normal.z < 0.0f)
+			{
+				normal = glm::vec3(
+					std::copysign(1.0f - glm::abs(oct.y), oct.x),
+					std::copysign(1.0f - glm::abs(oct.x), oct.y),
+					normal.z
+				);
+			}
+
+			return glm::normalize(normal);
+		}
+
+		// Inverse of the AABB extent, zero on degenerated axes so that they quantize to `aabb_min`
+		glm::vec3 inverse_extent(glm::vec3 aabb_min, glm::vec3 aabb_max) noexcept
+		{
+			const auto extent = aabb_max - aabb_min;
+			return glm::vec3(
+				extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+				extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+				extent.z > 0.0f ? 1.0f / extent.z : 0.0f
+			);
+		}
+	}
+
+	PackedVertex PackedVertex::pack(const FullVertex& vertex, glm::vec3 aabb_min, glm::vec3 aabb_max) noexcept
+	{
+		const auto relative_position = (vertex.position - aabb_min) * inverse_extent(aabb_min, aabb_max);
+		const auto handedness = vertex.tangent.w < 0.0f ? 0.0f : 1.0f;
+
+		return {
+			.position = glm::packUnorm<uint16_t>(glm::vec4(relative_position, handedness)),
+			.texcoord = glm::packHalf(vertex.texcoord),
+			.normal = glm::packSnorm<int16_t>(oct_encode(vertex.normal)),
+			.tangent = glm::packSnorm<int16_t>(oct_encode(glm::vec3(vertex.tangent)))
+		};
+	}
+
+	FullVertex PackedVertex::unpack(glm::vec3 aabb_min, glm::vec3 aabb_max) const noexcept
+	{
+		const auto relative_position = glm::unpackUnorm<float>(position);
+
+		return {
+			.position = aabb_min + glm::vec3(relative_position) * (aabb_max - aabb_min),
+			.texcoord = glm::unpackHalf(texcoord),
+			.normal = oct_decode(glm::unpackSnorm<float>(normal)),
+			.tangent = glm::vec4(
+				oct_decode(glm::unpackSnorm<float>(tangent)),
+				relative_position.w > 0.5f ? 1.0f : -1.0f
+			)
+		};
+	}
+
+	namespace
+	{
+		struct MeshletBuildResult
+		{
+			std::vector<Meshlet> meshlets;
+			std::vector<uint32_t> vertices;
+			std::vector<glm::u8vec3> triangles;
+		};
+
+		// Weight of the normal cone when building meshlets, favors better cone culling over compactness
+		constexpr float MESHLET_CONE_WEIGHT = 0.25f;
+
+		MeshletBuildResult build_meshlets(
+			std::span<const FullVertex> vertices,
+			std::span<const uint32_t> indices
+		) noexcept
+		{
+			const auto max_meshlet_count =
+				meshopt_buildMeshletsBound(indices.size(), Meshlet::MAX_VERTICES, Meshlet::MAX_TRIANGLES);
+
+			std::vector<meshopt_Meshlet> raw_meshlets(max_meshlet_count);
+			std::vector<uint32_t> raw_vertices(max_meshlet_count * Meshlet::MAX_VERTICES);
+			std::vector<uint8_t> raw_triangles(max_meshlet_count * Meshlet::MAX_TRIANGLES * 3);
+
+			const auto meshlet_count = meshopt_buildMeshlets(
+				raw_meshlets.data(),
+				raw_vertices.data(),
+				raw_triangles.data(),
+				indices.data(),
+				indices.size(),
+				&vertices[0].position.x,
+				vertices.size(),
+				sizeof(FullVertex),
+				Meshlet::MAX_VERTICES,
+				Meshlet::MAX_TRIANGLES,
+				MESHLET_CONE_WEIGHT
+			);
+			raw_meshlets.resize(meshlet_count);
+
+			// Repack into tightly packed ranges, `meshopt` pads triangle ranges to 4 bytes
+			MeshletBuildResult result;
+			result.meshlets.reserve(meshlet_count);
+			result.vertices.reserve(indices.size());
+			result.triangles.reserve(indices.size() / 3);
+
+			for (const auto& raw_meshlet : raw_meshlets)
+			{
+				const auto meshlet_vertices = std::span(raw_vertices).subspan(raw_meshlet.vertex_offset);
+				const auto meshlet_triangles = std::span(raw_triangles).subspan(raw_meshlet.triangle_offset);
+
+				meshopt_optimizeMeshlet(
+					meshlet_vertices.data(),
+					meshlet_triangles.data(),
+					raw_meshlet.triangle_count,
+					raw_meshlet.vertex_count
+				);
+
+				const auto bounds = meshopt_computeMeshletBounds(
+					meshlet_vertices.data(),
+					meshlet_triangles.data(),
+					raw_meshlet.triangle_count,
+					&vertices[0].position.x,
+					vertices.size(),
+					sizeof(FullVertex)
+				);
+
+				result.meshlets.push_back(
+					Meshlet{
+						.vertex_offset = static_cast<uint32_t>(result.vertices.size()),
+						.triangle_offset = static_cast<uint32_t>(result.triangles.size()),
+						.vertex_count = raw_meshlet.vertex_count,
+						.triangle_count = raw_meshlet.triangle_count,
+						.center = {bounds.center[0], bounds.center[1], bounds.center[2]},
+						.radius = bounds.radius,
+						.cone_axis = {bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]},
+						.cone_cutoff = bounds.cone_cutoff
+					}
+				);
+
+				result.vertices.append_range(meshlet_vertices.first(raw_meshlet.vertex_count));
+				result.triangles.append_range(
+					std::views::iota(0_u32, raw_meshlet.triangle_count)
+					| std::views::transform([&meshlet_triangles](uint32_t triangle) {
+						  return glm::u8vec3(
+							  meshlet_triangles[triangle * 3 + 0],
+							  meshlet_triangles[triangle * 3 + 1],
+							  meshlet_triangles[triangle * 3 + 2]
+						  );
+					  })
+				);
+			}
+
+			return result;
+		}
+	}
+
+	Geometry Geometry::optimize() const noexcept
+	{
+		// Allowed ACMR degradation when reordering for overdraw, see meshoptimizer docs
+		constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+		std::vector<uint32_t> optimized_indices(indices.size());
+		meshopt_optimizeVertexCache(
+			optimized_indices.data(),
+			indices.data(),
+			indices.size(),
+			vertices.size()
+		);
+		meshopt_optimizeOverdraw(
+			optimized_indices.data(),
+			optimized_indices.data(),
+			optimized_indices.size(),
+			&vertices[0].position.x,
+			vertices.size(),
+			sizeof(FullVertex),
+			OVERDRAW_THRESHOLD
+		);
+
+		std::vector<FullVertex> optimized_vertices(vertices.size());
+		const auto unique_vertex_count = meshopt_optimizeVertexFetch(
+			optimized_vertices.data(),
+			optimized_indices.data(),
+			optimized_indices.size(),
+			vertices.data(),
+			vertices.size(),
+			sizeof(FullVertex)
+		);
+		optimized_vertices.resize(unique_vertex_count);
+
+		auto [meshlets, meshlet_vertices, meshlet_triangles] =
+			build_meshlets(optimized_vertices, optimized_indices);
+
+		return Geometry(
+			std::move(optimized_vertices),
+			std::move(optimized_indices),
+			aabb_min,
+			aabb_max,
+			std::move(meshlets),
+			std::move(meshlet_vertices),
+			std::move(meshlet_triangles)
+		);
+	}
+
+	std::vector<GeometryLod> Geometry::simplify(const SimplifyOption& option) const noexcept
+	{
+		std::vector<GeometryLod> lods;
+		lods.reserve(option.max_levels);
+
+		auto source_indices = std::span<const uint32_t>(indices);
+		float source_error = 0.0f;
+
+		for (const auto _ : std::views::iota(0u, option.max_levels))
+		{
+			const auto source_index_count = static_cast<float>(source_indices.size());
+			const auto target_index_count =
+				static_cast<size_t>(source_index_count * option.index_ratio) / 3 * 3;  // Whole triangles
+			if (target_index_count < 3) break;
+
+			// Errors accumulate along the chain, remaining budget is given to the next level
+			std::vector<uint32_t> lod_indices(source_indices.size());
+			float lod_error = 0.0f;
+			const auto lod_index_count = option.sloppy
+				? meshopt_simplifySloppy(
+					  lod_indices.data(),
+					  source_indices.data(),
+					  source_indices.size(),
+					  &vertices[0].position.x,
+					  vertices.size(),
+					  sizeof(FullVertex),
+					  target_index_count,
+					  option.max_error - source_error,
+					  &lod_error
+				  )
+				: meshopt_simplify(
+					  lod_indices.data(),
+					  source_indices.data(),
+					  source_indices.size(),
+					  &vertices[0].position.x,
+					  vertices.size(),
+					  sizeof(FullVertex),
+					  target_index_count,
+					  option.max_error - source_error,
+					  0,
+					  &lod_error
+				  );
+
+			if (lod_index_count == 0) break;
+			if (static_cast<float>(lod_index_count) > source_index_count * option.min_reduction) break;
+
+			lod_indices.resize(lod_index_count);
+			meshopt_optimizeVertexCache(
+				lod_indices.data(),
+				lod_indices.data(),
+				lod_indices.size(),
+				vertices.size()
+			);
+
+			source_error += lod_error;
+			lods.push_back(GeometryLod{.indices = std::move(lod_indices), .error = source_error});
+			source_indices = lods.back().indices;
+		}
+
+		return lods;
+	}
+
 	std::expected<Geometry, Error> Geometry::create(
 		std::span<const FullVertex> vertices,
 		std::span<const uint32_t> indices
 	) noexcept
+	{
+		return create(
+			std::vector<FullVertex>(vertices.begin(), vertices.end()),
+			std::vector<uint32_t>(indices.begin(), indices.end())
+		);
+	}
+
+	std::expected<Geometry, Error> Geometry::create(
+		std::vector<FullVertex>&& vertices,
+		std::vector<uint32_t>&& indices
+	) noexcept
 	{
 		if (vertices.empty()) return Error("Invalid primitive with no vertices");
 		if (indices.empty()) return Error("Invalid primitive with no indices");
@@ -103,10 +399,13 @@ namespace model
 				std::format("Index count: {}", indices.size())
 			);
 
+		// Validate indices and compute bounds of the referenced vertices in a single pass
 		const auto vertex_count = vertices.size();
+		auto min_bound = glm::vec3(std::numeric_limits<float>::max());
+		auto max_bound = glm::vec3(std::numeric_limits<float>::lowest());
 		for (const auto [index, vertex_index] : std::views::enumerate(indices))
 		{
-			if (vertex_index >= vertex_count)
+			if (vertex_index >= vertex_count) [[unlikely]]
 				return Error(
 					"Invalid primitive with out-of-bounds index",
 					std::format(
@@ -116,25 +415,22 @@ namespace model
 						vertex_count
 					)
 				);
-		}
 
-		const auto min_bound =
-			std::ranges::fold_left_first(
-				indices | std::views::transform([&](uint32_t index) { return vertices[index].position; }),
-				[](const glm::vec3& a, const glm::vec3& b) { return glm::min(a, b); }
-			).value_or(glm::vec3(0.0f));
+			const auto& position = vertices[vertex_index].position;
+			min_bound = glm::min(min_bound, position);
+			max_bound = glm::max(max_bound, position);
+		}
 
-		const auto max_bound =
-			std::ranges::fold_left_first(
-				indices | std::views::transform([&](uint32_t index) { return vertices[index].position; }),
-				[](const glm::vec3& a, const glm::vec3& b) { return glm::max(a, b); }
-			).value_or(glm::vec3(0.0f));
+		auto [meshlets, meshlet_vertices, meshlet_triangles] = build_meshlets(vertices, indices);
 
 		return Geometry(
-			std::vector<FullVertex>(vertices.begin(), vertices.end()),
-			std::vector<uint32_t>(indices.begin(), indices.end()),
+			std::move(vertices),
+			std::move(indices),
 			min_bound,
-			max_bound
+			max_bound,
+			std::move(meshlets),
+			std::move(meshlet_vertices),
+			std::move(meshlet_triangles)
 		);
 	}
 }
@@ -186,4 +482,132 @@ namespace model::util
 			| std::views::join
 			| std::ranges::to<std::vector>();
 	}
+
+	IndexedVertices weld_vertices(
+		std::span<const FullVertex> vertices,
+		std::span<const uint32_t> indices,
+		std::pmr::memory_resource& memory_resource
+	) noexcept
+	{
+		// Snap normals and tangents onto a grid, so that nearly identical values share the same bits
+		const auto snap = [](auto value) {
+			return glm::round(value / WELD_TOLERANCE) * WELD_TOLERANCE;
+		};
+		const auto snap_vertex = [&snap](const FullVertex& vertex) {
+			return FullVertex{
+				.position = vertex.position,
+				.texcoord = vertex.texcoord,
+				.normal = snap(vertex.normal),
+				.tangent = glm::vec4(snap(glm::vec3(vertex.tangent)), vertex.tangent.w)
+			};
+		};
+		auto keys = ::util::ScratchVector<FullVertex>(vertices.size(), &memory_resource);
+		std::ranges::transform(vertices, keys.begin(), snap_vertex);
+
+		auto remap = ::util::ScratchVector<uint32_t>(vertices.size(), &memory_resource);
+		const auto vertex_count = meshopt_generateVertexRemap(
+			remap.data(),
+			indices.data(),
+			indices.size(),
+			keys.data(),
+			keys.size(),
+			sizeof(FullVertex)
+		);
+
+		IndexedVertices result{
+			.vertices = std::vector<FullVertex>(vertex_count),
+			.indices = std::vector<uint32_t>(indices.size())
+		};
+		meshopt_remapVertexBuffer(
+			result.vertices.data(),
+			vertices.data(),
+			vertices.size(),
+			sizeof(FullVertex),
+			remap.data()
+		);
+		meshopt_remapIndexBuffer(result.indices.data(), indices.data(), indices.size(), remap.data());
+
+		return result;
+	}
+
+	std::expected<std::vector<FullVertex>, Error> generate_tangents(
+		std::span<const NormalOnlyVertex> vertices,
+		std::span<const uint32_t> indices,
+		std::pmr::memory_resource& memory_resource
+	) noexcept
+	{
+		if (indices.size() % 3 != 0)
+			return Error(
+				"Index count is not a multiple of 3",
+				std::format("Index count: {}", indices.size())
+			);
+
+		if (!std::ranges::all_of(indices, [total = vertices.size()](uint32_t idx) { return idx < total; }))
+			return Error("Invalid index found");
+
+		using Accumulator = ::util::ScratchVector<glm::vec3>;
+		auto tangents = Accumulator(vertices.size(), glm::vec3(0.0f), &memory_resource);
+		auto bitangents = Accumulator(vertices.size(), glm::vec3(0.0f), &memory_resource);
+
+		for (const auto triangle : indices | std::views::chunk(3))
+		{
+			const std::array<const NormalOnlyVertex*, 3> corners = {
+				&vertices[triangle[0]],
+				&vertices[triangle[1]],
+				&vertices[triangle[2]]
+			};
+
+			const glm::mat2x3 pos_delta(
+				corners[1]->position - corners[0]->position,
+				corners[2]->position - corners[0]->position
+			);
+			const glm::mat2 texcoord_delta(
+				corners[1]->texcoord - corners[0]->texcoord,
+				corners[2]->texcoord - corners[0]->texcoord
+			);
+
+			// Degenerate texture coordinates contribute nothing
+			const float determinant = glm::determinant(texcoord_delta);
+			if (!std::isnormal(determinant)) continue;
+
+			const glm::mat2x3 tangent_mat = pos_delta * glm::inverse(texcoord_delta);
+			const auto tangent = glm::normalize(tangent_mat[0]);
+			const auto bitangent = glm::normalize(tangent_mat[1]);
+			if (glm::any(glm::isnan(tangent)) || glm::any(glm::isnan(bitangent))) continue;
+
+			for (const auto corner : std::views::iota(0zu, 3zu))
+			{
+				const auto edge1 = corners[(corner + 1) % 3]->position - corners[corner]->position;
+				const auto edge2 = corners[(corner + 2) % 3]->position - corners[corner]->position;
+				const auto angle = glm::angle(glm::normalize(edge1), glm::normalize(edge2));
+				if (std::isnan(angle)) continue;
+
+				tangents[triangle[corner]] += tangent * angle;
+				bitangents[triangle[corner]] += bitangent * angle;
+			}
+		}
+
+		const auto finalize = [](const NormalOnlyVertex& vertex, glm::vec3 tangent, glm::vec3 bitangent) {
+			// Gram-Schmidt orthogonalization against the vertex normal
+			const auto projected = tangent - vertex.normal * glm::dot(vertex.normal, tangent);
+			const auto orthogonal = glm::normalize(projected);
+
+			if (glm::any(glm::isinf(orthogonal)) || glm::any(glm::isnan(orthogonal))) [[unlikely]]
+			{
+				const auto fallback = glm::cross(
+					vertex.normal,
+					vertex.normal.y > 0.8 ? glm::vec3(1.0, 0.0, 0.0) : glm::vec3(0.0, 1.0, 0.0)
+				);
+				return FullVertex::from(vertex, glm::vec4(fallback, 1.0f));
+			}
+
+			const auto right_handed_bitangent = glm::cross(vertex.normal, orthogonal);
+			const float handedness = glm::dot(right_handed_bitangent, bitangent) < 0.0f ? -1.0f : 1.0f;
+
+			return FullVertex::from(vertex, glm::vec4(orthogonal, handedness));
+		};
+
+		return std::views::zip_transform(finalize, vertices, tangents, bitangents)
+			| std::ranges::to<std::vector>();
+	}
 }
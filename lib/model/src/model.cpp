@@ -1,12 +1,20 @@
 #include "model/model.hpp"
 #include "common/util/error.hpp"
+#include "model/animation.hpp"
 #include "model/hierarchy.hpp"
+#include "model/light.hpp"
 #include "model/material.hpp"
 #include "model/mesh.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <expected>
 #include <format>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint4.hpp>
+#include <glm/vector_relational.hpp>
 #include <ranges>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -15,7 +23,12 @@ namespace model
 	std::expected<Model, Error> Model::assemble(
 		MaterialList material_list,
 		std::vector<Mesh> meshes,
-		Hierarchy hierarchy
+		Hierarchy hierarchy,
+		std::vector<Light> lights,
+		std::vector<Skin> skins,
+		std::vector<Animation> animations,
+		HlodList hlod,
+		ImpostorList impostors
 	) noexcept
 	{
 		/* Verify Meshes */
@@ -39,10 +52,36 @@ namespace model
 					);
 			}
 
+		/* Verify Deformations */
+
+		for (const auto [mesh_idx, mesh] : meshes | std::views::enumerate)
+			for (const auto [primitive_idx, primitive] : mesh.primitives | std::views::enumerate)
+			{
+				const auto vertex_count = primitive.geometry.vertices.size();
+				const auto& deformation = primitive.deformation;
+
+				const auto target_valid = [vertex_count](const MorphTarget& target) {
+					return target.position_deltas.size() == vertex_count
+						&& (target.normal_deltas.empty() || target.normal_deltas.size() == vertex_count);
+				};
+
+				if ((!deformation.skin.empty() && deformation.skin.size() != vertex_count)
+					|| !std::ranges::all_of(deformation.morph_targets, target_valid))
+					return Error(
+						"Deformation of a primitive mismatches its vertices",
+						std::format(
+							"Primitive #{} of mesh #{} has {} vertices",
+							primitive_idx,
+							mesh_idx,
+							vertex_count
+						)
+					);
+			}
+
 		/* Verify Hierarchy */
 
 		const auto mesh_count = meshes.size();
-		for (const auto& [node_idx, mesh_idx] : hierarchy.get_drawcalls())
+		for (const auto& [node_idx, mesh_idx] : hierarchy.get_renderables())
 			if (mesh_idx >= mesh_count)
 				return Error(
 					"Mesh index of a node is out of bound",
@@ -54,6 +93,202 @@ namespace model
 					)
 				);
 
-		return Model(std::move(material_list), std::move(meshes), std::move(hierarchy));
+		const auto light_count = lights.size();
+		for (const auto& [node_idx, node] : hierarchy.get_nodes() | std::views::enumerate)
+			if (node.data.light_index.has_value() && node.data.light_index.value() >= light_count)
+				return Error(
+					"Light index of a node is out of bound",
+					std::format(
+						"Node #{} has a light index of #{} which goes out of bound (total {})",
+						node_idx,
+						node.data.light_index.value(),
+						light_count
+					)
+				);
+
+		/* Verify Skins */
+
+		const auto node_count = hierarchy.get_nodes().size();
+		for (const auto& [skin_idx, skin] : skins | std::views::enumerate)
+		{
+			if (skin.inverse_bind_matrices.size() != skin.joints.size())
+				return Error(
+					"Inverse bind matrices of a skin mismatch its joints",
+					std::format(
+						"Skin #{} has {} joints but {} inverse bind matrices",
+						skin_idx,
+						skin.joints.size(),
+						skin.inverse_bind_matrices.size()
+					)
+				);
+
+			for (const auto joint : skin.joints)
+				if (joint >= node_count)
+					return Error(
+						"Joint of a skin is out of bound",
+						std::format("Skin #{} has joint node #{} (total {})", skin_idx, joint, node_count)
+					);
+		}
+
+		const auto skin_count = skins.size();
+		for (const auto& [node_idx, node] : hierarchy.get_nodes() | std::views::enumerate)
+			if (node.data.skin_index.has_value() && node.data.skin_index.value() >= skin_count)
+				return Error(
+					"Skin index of a node is out of bound",
+					std::format(
+						"Node #{} has a skin index of #{} which goes out of bound (total {})",
+						node_idx,
+						node.data.skin_index.value(),
+						skin_count
+					)
+				);
+
+		for (const auto& [node_idx, mesh_idx] : hierarchy.get_renderables())
+		{
+			const auto& skin_index = hierarchy.get_nodes()[node_idx].data.skin_index;
+			if (!skin_index.has_value()) continue;
+
+			const auto joint_count = skins[skin_index.value()].joints.size();
+			const auto joints_valid = [joint_count](const VertexSkin& vertex) {
+				return glm::all(glm::lessThan(glm::uvec4(vertex.joints), glm::uvec4(joint_count)));
+			};
+			const auto primitive_valid = [&joints_valid](const Primitive& primitive) {
+				return std::ranges::all_of(primitive.deformation.skin, joints_valid);
+			};
+
+			if (!std::ranges::all_of(meshes[mesh_idx].primitives, primitive_valid))
+				return Error(
+					"Joint index of a skinned vertex is out of bound",
+					std::format("Node #{} is skinned with {} joints", node_idx, joint_count)
+				);
+		}
+
+		/* Verify Animations */
+
+		for (const auto& [animation_idx, animation] : animations | std::views::enumerate)
+			for (const auto& [channel_idx, channel] : animation.channels | std::views::enumerate)
+			{
+				if (channel.node_index >= node_count)
+					return Error(
+						"Animated node is out of bound",
+						std::format(
+							"Channel #{} of animation #{} animates node #{} (total {})",
+							channel_idx,
+							animation_idx,
+							channel.node_index,
+							node_count
+						)
+					);
+
+				if (!channel.valid())
+					return Error(
+						"Invalid keyframes of an animation channel",
+						std::format("Channel #{} of animation #{}", channel_idx, animation_idx)
+					);
+			}
+
+		/* Verify HLOD */
+
+		std::vector<bool> hlod_node_used(node_count, false);
+		for (const auto& [cluster_idx, cluster] : hlod.clusters | std::views::enumerate)
+		{
+			if (cluster.proxy_node_index >= node_count
+				|| !hierarchy.get_nodes()[cluster.proxy_node_index].data.mesh_index.has_value())
+				return Error(
+					"Proxy node of an HLOD cluster is invalid",
+					std::format(
+						"Cluster #{} has proxy node #{}, which is out of bound or without mesh (total {})",
+						cluster_idx,
+						cluster.proxy_node_index,
+						node_count
+					)
+				);
+
+			if (uint64_t(cluster.source_offset) + cluster.source_count > hlod.source_nodes.size())
+				return Error(
+					"Source nodes of an HLOD cluster are out of bound",
+					std::format("Cluster #{}", cluster_idx)
+				);
+
+			const auto sources =
+				std::span(hlod.source_nodes).subspan(cluster.source_offset, cluster.source_count);
+			for (const auto node_idx : sources)
+			{
+				const auto node_valid = node_idx < node_count
+					&& node_idx != cluster.proxy_node_index
+					&& !hlod_node_used[node_idx];
+				if (!node_valid)
+					return Error(
+						"Source node of an HLOD cluster is invalid",
+						std::format(
+							"Cluster #{} has source node #{}, which is out of bound, its proxy, or a source "
+							"of another cluster (total {})",
+							cluster_idx,
+							node_idx,
+							node_count
+						)
+					);
+				hlod_node_used[node_idx] = true;
+			}
+		}
+
+		/* Verify Impostors */
+
+		const auto atlas_size = impostors.frame_count * impostors.frame_size;
+		if (!impostors.impostors.empty() && atlas_size == 0)
+			return Error("Impostor atlas layout is empty");
+
+		std::vector<bool> impostor_mesh_used(mesh_count, false);
+		for (const auto& [impostor_idx, impostor] : impostors.impostors | std::views::enumerate)
+		{
+			if (impostor.mesh_index >= mesh_count || impostor_mesh_used[impostor.mesh_index])
+				return Error(
+					"Mesh of an impostor is invalid",
+					std::format(
+						"Impostor #{} has mesh #{}, which is out of bound or has another impostor (total {})",
+						impostor_idx,
+						impostor.mesh_index,
+						mesh_count
+					)
+				);
+			impostor_mesh_used[impostor.mesh_index] = true;
+
+			const auto expected_size = glm::u32vec2(atlas_size);
+			if (impostor.albedo.size != expected_size || impostor.normal_depth.size != expected_size)
+				return Error(
+					"Atlas of an impostor mismatches the layout",
+					std::format("Impostor #{}, expected {} texels along each axis", impostor_idx, atlas_size)
+				);
+
+			if (!(impostor.radius > 0.0f))
+				return Error(
+					"Bounding sphere of an impostor is empty",
+					std::format("Impostor #{}", impostor_idx)
+				);
+		}
+
+		return Model(
+			std::move(material_list),
+			std::move(meshes),
+			std::move(hierarchy),
+			std::move(lights),
+			std::move(skins),
+			std::move(animations),
+			std::move(hlod),
+			std::move(impostors)
+		);
+	}
+
+	Model deduplicate_materials(Model model) noexcept
+	{
+		const auto remap = model.material_list.deduplicate();
+
+		for (auto& mesh : model.meshes)
+			for (auto& primitive : mesh.primitives)
+				primitive.material_index = primitive.material_index.transform([&remap](uint32_t index) {
+					return remap[index];
+				});
+
+		return model;
 	}
 }
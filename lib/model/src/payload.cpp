@@ -0,0 +1,269 @@
+#include "model/payload.hpp"
+#include "common/util/error.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <format>
+#include <meshoptimizer.h>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace model
+{
+	namespace
+	{
+		bool is_valid_stride(PayloadCodec codec, uint32_t stride) noexcept
+		{
+			switch (codec)
+			{
+			case PayloadCodec::Vertex:
+				return stride > 0 && stride <= 256 && stride % 4 == 0;
+			case PayloadCodec::IndexSequence:
+				return stride == 2 || stride == 4;
+			default:
+				return false;
+			}
+		}
+
+		size_t get_chunk_element_count(uint32_t stride) noexcept
+		{
+			return std::max<size_t>(PAYLOAD_CHUNK_SIZE / stride, 1);
+		}
+
+		// Run `job(index)` for every index in `[0, count)` on all hardware threads. Jobs are claimed from a
+		// shared counter, so that workers finishing early take over the rest
+		template <typename F>
+		void run_parallel(size_t count, const F& job) noexcept
+		{
+			const auto hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+			const auto worker_count = std::min<size_t>(hardware_threads, count);
+
+			std::atomic<size_t> next_job = 0;
+			const auto worker = [count, &next_job, &job] {
+				while (true)
+				{
+					const auto index = next_job.fetch_add(1, std::memory_order_relaxed);
+					if (index >= count) break;
+					job(index);
+				}
+			};
+
+			std::vector<std::jthread> threads;
+			threads.reserve(worker_count > 0 ? worker_count - 1 : 0);
+
+			try
+			{
+				for (size_t i = 1; i < worker_count; i++) threads.emplace_back(worker);
+			}
+			catch (const std::system_error&)
+			{
+				// Out of threads, the remaining jobs are still run by existing workers
+			}
+
+			worker();
+		}
+
+		std::vector<std::byte> encode_chunk(
+			std::span<const std::byte> data,
+			PayloadCodec codec,
+			uint32_t stride
+		) noexcept
+		{
+			const auto element_count = data.size() / stride;
+			std::vector<std::byte> encoded;
+
+			if (codec == PayloadCodec::Vertex)
+			{
+				encoded.resize(meshopt_encodeVertexBufferBound(element_count, stride));
+				encoded.resize(
+					meshopt_encodeVertexBuffer(
+						reinterpret_cast<unsigned char*>(encoded.data()),
+						encoded.size(),
+						data.data(),
+						element_count,
+						stride
+					)
+				);
+				return encoded;
+			}
+
+			// Index sequences are encoded from 32-bit indices regardless of the stored width
+			auto indices = std::vector<uint32_t>(element_count);
+			if (stride == sizeof(uint16_t))
+			{
+				for (const auto index : std::views::iota(0zu, element_count))
+				{
+					uint16_t short_index;
+					std::memcpy(&short_index, data.data() + index * sizeof(uint16_t), sizeof(uint16_t));
+					indices[index] = short_index;
+				}
+			}
+			else
+				std::memcpy(indices.data(), data.data(), data.size());
+
+			const auto vertex_count = indices.empty() ? 0zu : size_t(std::ranges::max(indices)) + 1;
+			encoded.resize(meshopt_encodeIndexSequenceBound(element_count, vertex_count));
+			encoded.resize(
+				meshopt_encodeIndexSequence(
+					reinterpret_cast<unsigned char*>(encoded.data()),
+					encoded.size(),
+					indices.data(),
+					element_count
+				)
+			);
+			return encoded;
+		}
+
+		bool decode_chunk(
+			std::span<const std::byte> encoded,
+			PayloadCodec codec,
+			uint32_t stride,
+			std::span<std::byte> decoded
+		) noexcept
+		{
+			const auto buffer = reinterpret_cast<const unsigned char*>(encoded.data());
+			const auto element_count = decoded.size() / stride;
+
+			const auto result = codec == PayloadCodec::Vertex
+				? meshopt_decodeVertexBuffer(decoded.data(), element_count, stride, buffer, encoded.size())
+				: meshopt_decodeIndexSequence(decoded.data(), element_count, stride, buffer, encoded.size());
+			return result == 0;
+		}
+
+		// Chunk of a payload, located within the encoded payload and its destination
+		struct Chunk
+		{
+			const Payload* payload;
+			std::span<const std::byte> encoded;
+			std::span<std::byte> decoded;
+		};
+
+		std::expected<void, Error> locate_chunks(const Payload& payload, std::vector<Chunk>& chunks) noexcept
+		{
+			if (payload.codec == PayloadCodec::None)
+			{
+				if (payload.encoded.size() != payload.decoded.size()) return Error("Payload size mismatch");
+				chunks.push_back(
+					{.payload = &payload, .encoded = payload.encoded, .decoded = payload.decoded}
+				);
+				return {};
+			}
+
+			if (!is_valid_stride(payload.codec, payload.stride))
+				return Error("Invalid payload stride", std::format("Stride: {}", payload.stride));
+			if (payload.decoded.size() % payload.stride != 0)
+				return Error("Payload size isn't a multiple of its stride");
+
+			const auto chunk_size = get_chunk_element_count(payload.stride) * payload.stride;
+			const auto chunk_count = (payload.decoded.size() + chunk_size - 1) / chunk_size;
+			const auto table_size = (chunk_count + 1) * sizeof(uint64_t);
+
+			uint64_t stored_chunk_count = 0;
+			if (payload.encoded.size() < table_size) return Error("Payload chunk table out of range");
+			std::memcpy(&stored_chunk_count, payload.encoded.data(), sizeof(uint64_t));
+			if (stored_chunk_count != chunk_count)
+				return Error(
+					"Payload chunk count mismatch",
+					std::format("Expected {}, got {}", chunk_count, stored_chunk_count)
+				);
+
+			const auto data = payload.encoded.subspan(table_size);
+			uint64_t begin = 0;
+			for (const auto index : std::views::iota(0zu, chunk_count))
+			{
+				uint64_t end;
+				std::memcpy(&end, payload.encoded.data() + (index + 1) * sizeof(uint64_t), sizeof(uint64_t));
+				if (end < begin || end > data.size())
+					return Error("Payload chunk out of range", std::format("Chunk: {}", index));
+
+				const auto decoded_offset = index * chunk_size;
+				chunks.push_back({
+					.payload = &payload,
+					.encoded = data.subspan(begin, end - begin),
+					.decoded = payload.decoded.subspan(
+						decoded_offset,
+						std::min(chunk_size, payload.decoded.size() - decoded_offset)
+					),
+				});
+				begin = end;
+			}
+
+			return {};
+		}
+	}
+
+	std::optional<std::vector<std::byte>> encode_payload(
+		std::span<const std::byte> data,
+		PayloadCodec codec,
+		uint32_t stride
+	) noexcept
+	{
+		if (data.empty() || !is_valid_stride(codec, stride) || data.size() % stride != 0) return std::nullopt;
+
+		const auto chunk_size = get_chunk_element_count(stride) * stride;
+		const auto chunk_count = (data.size() + chunk_size - 1) / chunk_size;
+
+		auto encoded_chunks = std::vector<std::vector<std::byte>>(chunk_count);
+		run_parallel(chunk_count, [&](size_t index) {
+			const auto offset = index * chunk_size;
+			const auto chunk = data.subspan(offset, std::min(chunk_size, data.size() - offset));
+			encoded_chunks[index] = encode_chunk(chunk, codec, stride);
+		});
+
+		// Encoders return an empty buffer if the bound is exceeded, which never happens for valid input
+		const auto is_empty = [](const std::vector<std::byte>& chunk) { return chunk.empty(); };
+		if (std::ranges::any_of(encoded_chunks, is_empty)) return std::nullopt;
+
+		std::vector<uint64_t> table;
+		table.reserve(chunk_count + 1);
+		table.push_back(chunk_count);
+		uint64_t end = 0;
+		for (const auto& chunk : encoded_chunks)
+		{
+			end += chunk.size();
+			table.push_back(end);
+		}
+
+		const auto table_bytes = std::as_bytes(std::span(table));
+		if (table_bytes.size() + end >= data.size()) return std::nullopt;
+
+		std::vector<std::byte> payload;
+		payload.reserve(table_bytes.size() + end);
+		payload.append_range(table_bytes);
+		for (const auto& chunk : encoded_chunks) payload.append_range(chunk);
+
+		return payload;
+	}
+
+	std::expected<void, Error> decode_payloads(std::span<const Payload> payloads) noexcept
+	{
+		std::vector<Chunk> chunks;
+		for (const auto [index, payload] : payloads | std::views::enumerate)
+			if (const auto result = locate_chunks(payload, chunks); !result)
+				return result.error().forward("Invalid payload", std::format("Payload: {}", index));
+
+		std::atomic<bool> failed = false;
+		run_parallel(chunks.size(), [&chunks, &failed](size_t index) {
+			const auto& chunk = chunks[index];
+			if (chunk.payload->codec == PayloadCodec::None)
+			{
+				std::ranges::copy(chunk.encoded, chunk.decoded.begin());
+				return;
+			}
+
+			if (!decode_chunk(chunk.encoded, chunk.payload->codec, chunk.payload->stride, chunk.decoded))
+				failed.store(true, std::memory_order_relaxed);
+		});
+
+		if (failed.load()) return Error("Decode payload failed", "Malformed chunk data");
+		return {};
+	}
+}
@@ -0,0 +1,333 @@
+#include "model/synthetic.hpp"
+#include "common/util/error.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "model/hierarchy.hpp"
+#include "model/material.hpp"
+#include "model/mesh.hpp"
+#include "model/model.hpp"
+#include "model/texture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace model
+{
+	namespace
+	{
+		// Spatial frequency of the grid undulation, in radians per unit
+		constexpr float GRID_FREQUENCY = 4.0f * std::numbers::pi_v<float>;
+
+		// Checker tiles along each side of the synthetic textures
+		constexpr uint32_t CHECKER_TILES = 8;
+
+		///
+		/// @brief Random number source, only uses the raw engine output
+		/// @note Standard distributions are implementation-defined, the engine output is not. Draw values in
+		/// separate statements, as the evaluation order of function arguments is unspecified
+		///
+		class Random
+		{
+		  public:
+
+			explicit Random(uint32_t seed) noexcept :
+				engine(seed)
+			{}
+
+			// Uniform float in `[min, max)`
+			[[nodiscard]]
+			float uniform(float min, float max) noexcept
+			{
+				const auto unit = static_cast<float>(static_cast<uint32_t>(engine()) >> 8) * 0x1p-24f;
+				return min + (max - min) * unit;
+			}
+
+			// Uniform integer in `[0, count)`
+			[[nodiscard]]
+			uint32_t index(uint32_t count) noexcept
+			{
+				const auto value = static_cast<uint64_t>(static_cast<uint32_t>(engine()));
+				return static_cast<uint32_t>((value * count) >> 32);
+			}
+
+		  private:
+
+			std::mt19937 engine;
+		};
+
+		std::expected<void, Error> validate(const SyntheticOption& option) noexcept
+		{
+			if (option.instances_per_mesh == 0) return Error("Invalid instances per mesh", "Got 0");
+			if (option.primitives_per_mesh == 0) return Error("Invalid primitives per mesh", "Got 0");
+			if (option.triangles_per_primitive == 0) return Error("Invalid triangles per primitive", "Got 0");
+			if (option.texture_count > 0 && option.texture_size == 0)
+				return Error("Invalid texture size", "Got 0");
+
+			if (!(option.alpha_mask_ratio >= 0.0f && option.alpha_mask_ratio <= 1.0f))
+				return Error("Invalid alpha mask ratio", std::format("Got {}", option.alpha_mask_ratio));
+
+			if (!(option.spacing > 0.0f) || !std::isfinite(option.spacing))
+				return Error("Invalid node spacing", std::format("Got {}", option.spacing));
+
+			return {};
+		}
+
+		// Undulating grid in the XZ plane covering `[origin, origin + size]`, filled row by row with exactly
+		// `triangle_count` triangles
+		std::expected<Geometry, Error> create_grid(
+			Random& random,
+			uint32_t triangle_count,
+			glm::vec2 origin,
+			float size
+		) noexcept
+		{
+			const auto quad_count = (triangle_count + 1) / 2;
+			const auto columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(quad_count))));
+			const auto rows = (quad_count + columns - 1) / columns;
+			const auto stride = columns + 1;
+
+			const auto amplitude = random.uniform(0.02f, 0.1f);
+			const auto phase_x = random.uniform(0.0f, 6.3f);
+			const auto phase = glm::vec2(phase_x, random.uniform(0.0f, 6.3f));
+
+			auto vertices = std::views::iota(0u, stride * (rows + 1))
+				| std::views::transform([=](uint32_t i) {
+					  const auto uv = glm::vec2(i % stride, i / stride) / glm::vec2(columns, rows);
+					  const auto angle = uv * GRID_FREQUENCY + phase;
+
+					  // Height and slope relative to the size of the grid
+					  const auto height = amplitude * glm::sin(angle.x) * glm::cos(angle.y);
+					  const auto slope = amplitude * GRID_FREQUENCY
+						  * glm::vec2(
+							  glm::cos(angle.x) * glm::cos(angle.y),
+							  -glm::sin(angle.x) * glm::sin(angle.y)
+						  );
+
+					  const auto planar = origin + uv * size;
+
+					  return NormalOnlyVertex{
+						  .position = glm::vec3(planar.x, height * size, planar.y),
+						  .texcoord = uv,
+						  .normal = glm::normalize(glm::vec3(-slope.x, 1.0f, -slope.y)),
+					  };
+				  })
+				| std::ranges::to<std::vector>();
+
+			auto indices = std::vector<uint32_t>();
+			indices.reserve(static_cast<size_t>(triangle_count) * 3);
+
+			for (const auto triangle : std::views::iota(0u, triangle_count))
+			{
+				const auto quad = triangle / 2;
+				const auto base = (quad / columns) * stride + quad % columns;
+
+				if (triangle % 2 == 0)
+					indices.append_range(std::to_array({base, base + stride, base + 1}));
+				else
+					indices.append_range(std::to_array({base + 1, base + stride, base + stride + 1}));
+			}
+
+			// Drop the vertices after the last partially filled row
+			vertices.resize(std::ranges::max(indices) + 1);
+
+			auto full_vertices_result = util::generate_tangents(vertices, indices);
+			if (!full_vertices_result)
+				return full_vertices_result.error().forward("Generate tangents failed");
+
+			return Geometry::create(std::move(*full_vertices_result), std::move(indices));
+		}
+
+		// Primitives are tiled in a square covering `[-0.5, 0.5]` on the XZ plane
+		std::expected<Mesh, Error> create_mesh(Random& random, const SyntheticOption& option) noexcept
+		{
+			const auto columns =
+				static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(option.primitives_per_mesh))));
+			const auto tile_size = 1.0f / static_cast<float>(columns);
+
+			auto mesh = Mesh();
+			mesh.primitives.reserve(option.primitives_per_mesh);
+
+			for (const auto primitive_idx : std::views::iota(0u, option.primitives_per_mesh))
+			{
+				const auto origin =
+					glm::vec2(primitive_idx % columns, primitive_idx / columns) * tile_size - glm::vec2(0.5f);
+
+				auto geometry_result = create_grid(random, option.triangles_per_primitive, origin, tile_size);
+				if (!geometry_result) return geometry_result.error().forward("Create grid geometry failed");
+
+				const auto material_index = option.material_count > 0
+					? std::optional(random.index(option.material_count))
+					: std::nullopt;
+
+				mesh.primitives.push_back(
+					Primitive{
+						.geometry = std::move(*geometry_result),
+						.lods = {},
+						.material_index = material_index,
+					}
+				);
+			}
+
+			return mesh;
+		}
+
+		// Checkerboard of a random color, the alpha channel cuts out a triangle in every tile
+		Texture create_texture(Random& random, uint32_t size) noexcept
+		{
+			using Pixel = image::Pixel<image::Format::Unorm8, image::Layout::RGBA>;
+
+			auto color = glm::u8vec3();
+			for (const auto channel : std::views::iota(0, 3))
+				color[channel] = static_cast<uint8_t>(random.uniform(64.0f, 256.0f));
+			const auto tile = std::max(size / CHECKER_TILES, 1u);
+
+			auto pixels = std::views::iota(0u, size * size)
+				| std::views::transform([=](uint32_t i) {
+					  const auto x = i % size, y = i / size;
+					  const bool dark = ((x / tile + y / tile) % 2) != 0;
+					  const bool opaque = x % tile + y % tile < tile;
+
+					  return Pixel(dark ? color / uint8_t(2) : color, opaque ? 255 : 0);
+				  })
+				| std::ranges::to<std::vector>();
+
+			return Texture{
+				.source =
+					image::Image<image::Format::Unorm8, image::Layout::RGBA>({size, size}, std::move(pixels))
+			};
+		}
+
+		// The first materials are masked, primitives pick materials at random so they are spread evenly
+		std::vector<Material> create_materials(Random& random, const SyntheticOption& option) noexcept
+		{
+			const auto mask_count = static_cast<uint32_t>(
+				std::round(static_cast<float>(option.material_count) * option.alpha_mask_ratio)
+			);
+
+			return std::views::iota(0u, option.material_count)
+				| std::views::transform([&random, &option, mask_count](uint32_t i) {
+					  auto base_color = glm::vec4(1.0f);
+					  for (const auto channel : std::views::iota(0, 3))
+						  base_color[channel] = random.uniform(0.2f, 1.0f);
+
+					  const auto albedo = option.texture_count > 0
+						  ? std::optional(i % option.texture_count)
+						  : std::nullopt;
+
+					  return Material{
+						  .param = {
+							  .base_color_factor = base_color,
+							  .roughness_factor = random.uniform(0.2f, 0.9f),
+						  },
+						  .mode = {.alpha_mode = i < mask_count ? AlphaMode::Mask : AlphaMode::Opaque},
+						  .texture_set = {.albedo = albedo},
+					  };
+				  })
+				| std::ranges::to<std::vector>();
+		}
+
+		// Smallest side length of a cube holding `count` cells
+		uint32_t get_grid_side(uint32_t count) noexcept
+		{
+			auto side = static_cast<uint64_t>(std::cbrt(static_cast<double>(count)));
+			while (side * side * side < count) side++;
+			return static_cast<uint32_t>(side);
+		}
+
+		// Root node at index 0, renderable nodes follow as its children
+		std::vector<ParentOnlyNode> create_nodes(Random& random, const SyntheticOption& option) noexcept
+		{
+			const auto side = get_grid_side(option.node_count);
+			const auto center = glm::vec3(static_cast<float>(side - 1) / 2.0f);
+
+			auto nodes = std::vector<ParentOnlyNode>();
+			nodes.reserve(static_cast<size_t>(option.node_count) + 1);
+			nodes.push_back(ParentOnlyNode{.parent_index = std::nullopt, .data = {}});
+
+			for (const auto i : std::views::iota(0u, option.node_count))
+			{
+				const auto cell = glm::vec3(i % side, (i / side) % side, i / side / side);
+
+				nodes.push_back(
+					ParentOnlyNode{
+						.parent_index = 0,
+						.data = {
+							.transform = {
+								.scale = glm::vec3(random.uniform(0.6f, 1.0f)),
+								.rotation =
+									glm::angleAxis(random.uniform(0.0f, 6.3f), glm::vec3(0.0f, 1.0f, 0.0f)),
+								.translation = (cell - center) * option.spacing,
+							},
+							.mesh_index = i / option.instances_per_mesh,
+						},
+					}
+				);
+			}
+
+			return nodes;
+		}
+	}
+
+	std::expected<Model, Error> synthetic(const SyntheticOption& option) noexcept
+	{
+		if (const auto result = validate(option); !result) return result.error().forward("Invalid option");
+
+		auto random = Random(option.seed);
+
+		/* Meshes */
+
+		const auto mesh_count =
+			(option.node_count + option.instances_per_mesh - 1) / option.instances_per_mesh;
+
+		auto meshes = std::vector<Mesh>();
+		meshes.reserve(mesh_count);
+
+		for (const auto mesh_idx : std::views::iota(0u, mesh_count))
+		{
+			auto mesh_result = create_mesh(random, option);
+			if (!mesh_result)
+				return mesh_result.error().forward(std::format("Create mesh #{} failed", mesh_idx));
+			meshes.push_back(std::move(*mesh_result));
+		}
+
+		/* Materials */
+
+		auto textures = std::views::iota(0u, option.texture_count)
+			| std::views::transform([&random, &option](uint32_t) {
+				  return create_texture(random, option.texture_size);
+			  })
+			| std::ranges::to<std::vector>();
+		auto materials = create_materials(random, option);
+
+		auto material_list_result = MaterialList::create(std::move(textures), std::move(materials));
+		if (!material_list_result) return material_list_result.error().forward("Create material list failed");
+
+		/* Hierarchy */
+
+		const auto nodes = create_nodes(random, option);
+		auto hierarchy_result = Hierarchy::create(nodes);
+		if (!hierarchy_result) return hierarchy_result.error().forward("Create hierarchy failed");
+
+		return Model::assemble(
+			std::move(*material_list_result),
+			std::move(meshes),
+			std::move(*hierarchy_result)
+		);
+	}
+}
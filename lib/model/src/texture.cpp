@@ -1,14 +1,19 @@
 #include "model/texture.hpp"
 #include "common/util/error.hpp"
+#include "common/util/hash.hpp"
+#include "common/util/span.hpp"
+#include "common/util/trace.hpp"
 #include "image/common.hpp"
 #include "image/image.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <filesystem>
 #include <format>
-#include <glm/ext/vector_uint4_sized.hpp>
+#include <memory_resource>
 #include <mio/mmap.hpp>
+#include <ranges>
 #include <span>
 #include <system_error>
 #include <utility>
@@ -23,21 +28,24 @@ namespace model
 		{
 			using ReturnType = std::expected<Texture::ImageVariant, Error>;
 
-			static ReturnType decode(std::span<const std::byte> encoded_data) noexcept
+			uint32_t max_size;  // Decode hint, see `image::Image::decode`
+			std::pmr::memory_resource* scratch_resource;
+
+			ReturnType decode(std::span<const std::byte> encoded_data) const noexcept
 			{
 				if (encoded_data.empty()) return Error("Texture source is empty");
 
 				if (image::encoded_data_is_16bit(encoded_data))
 				{
-					auto result =
-						image::Image<image::Format::Unorm16, image::Layout::RGBA>::decode(encoded_data);
+					using ImageType = image::Image<image::Format::Unorm16, image::Layout::RGBA>;
+					auto result = ImageType::decode(encoded_data, max_size, *scratch_resource);
 					if (!result) return result.error().forward("Failed to decode texture from encoded data");
 					return std::move(*result);
 				}
 				else
 				{
-					auto result =
-						image::Image<image::Format::Unorm8, image::Layout::RGBA>::decode(encoded_data);
+					using ImageType = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+					auto result = ImageType::decode(encoded_data, max_size, *scratch_resource);
 					if (!result) return result.error().forward("Failed to decode texture from encoded data");
 					return std::move(*result);
 				}
@@ -64,6 +72,11 @@ namespace model
 				return decode(encoded_data);
 			}
 
+			ReturnType operator()(const Texture::SharedData& shared_data) const noexcept
+			{
+				return decode(shared_data.data);
+			}
+
 			ReturnType operator()(
 				const image::Image<image::Format::Unorm8, image::Layout::RGBA>& raw_image
 			) const noexcept
@@ -79,16 +92,83 @@ namespace model
 			}
 		};
 
+		struct HashVisitor
+		{
+			using ReturnType = std::expected<uint64_t, Error>;
+
+			// Seeds separating decoded sources from encoded ones, and 8-bit pixels from 16-bit ones
+			static constexpr uint64_t UNORM8_SEED = 1;
+			static constexpr uint64_t UNORM16_SEED = 2;
+
+			ReturnType operator()(const std::filesystem::path& path) const noexcept
+			{
+				std::error_code error_code;
+				const auto file_size = std::filesystem::file_size(path, error_code);
+				if (error_code)
+					return Error(
+						"Get size of texture file failed",
+						std::format("Path: {}, {}", path.string(), error_code.message())
+					);
+
+				// Empty files can't be mapped
+				if (file_size == 0) return util::hash_bytes({});
+
+				try
+				{
+					const auto mapped_file = mio::basic_mmap_source<std::byte>(path.string());
+					return util::hash_bytes(std::span(mapped_file.begin(), mapped_file.size()));
+				}
+				catch (const std::system_error& e)
+				{
+					return Error("Mapping texture file failed", std::format("what(): {}", e.what()));
+				}
+			}
+
+			ReturnType operator()(const std::vector<std::byte>& encoded_data) const noexcept
+			{
+				return util::hash_bytes(encoded_data);
+			}
+
+			ReturnType operator()(const Texture::SharedData& shared_data) const noexcept
+			{
+				return util::hash_bytes(shared_data.data);
+			}
+
+			ReturnType operator()(
+				const image::Image<image::Format::Unorm8, image::Layout::RGBA>& raw_image
+			) const noexcept
+			{
+				return util::hash_bytes(
+					util::as_bytes(raw_image.data),
+					util::hash_object(raw_image.size, UNORM8_SEED)
+				);
+			}
+
+			ReturnType operator()(
+				const image::Image<image::Format::Unorm16, image::Layout::RGBA>& raw_image
+			) const noexcept
+			{
+				return util::hash_bytes(
+					util::as_bytes(raw_image.data),
+					util::hash_object(raw_image.size, UNORM16_SEED)
+				);
+			}
+		};
+
 		template <image::Format T>
 		struct FixedFormatVisitor
 		{
-			static std::expected<image::Image<T, image::Layout::RGBA>, Error> decode(
+			uint32_t max_size;  // Decode hint, see `image::Image::decode`
+			std::pmr::memory_resource* scratch_resource;
+
+			std::expected<image::Image<T, image::Layout::RGBA>, Error> decode(
 				std::span<const std::byte> encoded_data
-			) noexcept
+			) const noexcept
 			{
 				if (encoded_data.empty()) return Error("Texture source is empty");
 
-				auto result = image::Image<T, image::Layout::RGBA>::decode(encoded_data);
+				auto result =
+					image::Image<T, image::Layout::RGBA>::decode(encoded_data, max_size, *scratch_resource);
 				if (!result) return result.error().forward("Failed to decode texture from encoded data");
 				return std::move(*result);
 			}
@@ -118,6 +198,13 @@ namespace model
 				return decode(encoded_data);
 			}
 
+			std::expected<image::Image<T, image::Layout::RGBA>, Error> operator()(
+				const Texture::SharedData& shared_data
+			) const noexcept
+			{
+				return decode(shared_data.data);
+			}
+
 			std::expected<image::Image<T, image::Layout::RGBA>, Error> operator()(
 				const image::Image<image::Format::Unorm8, image::Layout::RGBA>& raw_image
 			) const noexcept
@@ -128,11 +215,7 @@ namespace model
 				}
 				else
 				{
-					const auto unorm8_to_unorm16 = [](glm::u8vec4 pix) {
-						return glm::u16vec4(pix) * glm::u16vec4(0x0101);
-					};
-
-					return raw_image.map(unorm8_to_unorm16);
+					return raw_image.convert<T, image::Layout::RGBA>();
 				}
 			}
 
@@ -146,18 +229,19 @@ namespace model
 				}
 				else
 				{
-					const auto unorm16_to_unorm8 = [](glm::u16vec4 pix) {
-						return glm::u8vec4(pix >> glm::u16vec4(8));
-					};
-
-					return raw_image.map(unorm16_to_unorm8);
+					return raw_image.convert<T, image::Layout::RGBA>();
 				}
 			}
 		};
 	}
 
-	std::expected<Texture::ImageVariant, Error> Texture::load() const noexcept
+	std::expected<Texture::ImageVariant, Error> Texture::load(
+		uint32_t max_size,
+		std::pmr::memory_resource& scratch_resource
+	) const noexcept
 	{
+		const auto trace = util::trace::Scope("Decode texture");
+
 		const auto post_process = [this](ImageVariant result) -> ImageVariant {
 			if (std::holds_alternative<image::Image<image::Format::Unorm8, image::Layout::RGBA>>(result))
 			{
@@ -181,13 +265,22 @@ namespace model
 			}
 		};
 
-		return std::visit(VariableFormatVisitor(), source).transform(post_process);
+		const auto visitor = VariableFormatVisitor{
+			.max_size = max_size,
+			.scratch_resource = &scratch_resource,
+		};
+		return std::visit(visitor, source).transform(post_process);
 	}
 
 	std::expected<image::Image<image::Format::Unorm8, image::Layout::RGBA>, Error>
-	Texture::load_8bit() const noexcept
+	Texture::load_8bit(uint32_t max_size, std::pmr::memory_resource& scratch_resource) const noexcept
 	{
-		return std::visit(FixedFormatVisitor<image::Format::Unorm8>(), source).transform([this](auto image) {
+		const auto trace = util::trace::Scope("Decode texture");
+		const auto visitor = FixedFormatVisitor<image::Format::Unorm8>{
+			.max_size = max_size,
+			.scratch_resource = &scratch_resource,
+		};
+		return std::visit(visitor, source).transform([this](auto image) {
 			if (flip_x) image = image.flip_x();
 			if (flip_y) image = image.flip_y();
 			return image;
@@ -195,12 +288,28 @@ namespace model
 	}
 
 	std::expected<image::Image<image::Format::Unorm16, image::Layout::RGBA>, Error>
-	Texture::load_16bit() const noexcept
+	Texture::load_16bit(uint32_t max_size, std::pmr::memory_resource& scratch_resource) const noexcept
 	{
-		return std::visit(FixedFormatVisitor<image::Format::Unorm16>(), source).transform([this](auto image) {
+		const auto trace = util::trace::Scope("Decode texture");
+		const auto visitor = FixedFormatVisitor<image::Format::Unorm16>{
+			.max_size = max_size,
+			.scratch_resource = &scratch_resource,
+		};
+		return std::visit(visitor, source).transform([this](auto image) {
 			if (flip_x) image = image.flip_x();
 			if (flip_y) image = image.flip_y();
 			return image;
 		});
 	}
+
+	std::expected<uint64_t, Error> Texture::hash_source() const noexcept
+	{
+		return std::visit(HashVisitor(), source);
+	}
+
+	void Texture::detach_source() noexcept
+	{
+		if (const auto* const shared_data = std::get_if<SharedData>(&source))
+			source = std::vector<std::byte>(std::from_range, shared_data->data);
+	}
 }
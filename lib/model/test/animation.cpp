@@ -0,0 +1,265 @@
+#include "model/animation.hpp"
+#include "model/hierarchy.hpp"
+
+#include <cstdint>
+#include <doctest.h>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/quaternion_trigonometric.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/vector_relational.hpp>
+#include <span>
+#include <vector>
+
+using Path = model::AnimationChannel::Path;
+using Interpolation = model::AnimationChannel::Interpolation;
+
+static model::AnimationChannel make_translation_channel(Interpolation interpolation)
+{
+	return {
+		.node_index = 0,
+		.path = Path::Translation,
+		.interpolation = interpolation,
+		.component_count = 3,
+		.times = {1.0f, 3.0f},
+		.values = {0.0f, 0.0f, 0.0f, 4.0f, 2.0f, -2.0f},
+	};
+}
+
+static bool vec3_near(glm::vec3 a, glm::vec3 b) noexcept
+{
+	return glm::all(glm::epsilonEqual(a, b, 1.0e-4f));
+}
+
+TEST_SUITE("Animation Channel Validation")
+{
+	TEST_CASE("Valid channels")
+	{
+		CHECK(make_translation_channel(Interpolation::Linear).valid());
+		CHECK(make_translation_channel(Interpolation::Step).valid());
+
+		auto cubic = make_translation_channel(Interpolation::CubicSpline);
+		cubic.values = std::vector<float>(18, 0.0f);
+		CHECK(cubic.valid());
+	}
+
+	TEST_CASE("Invalid channels")
+	{
+		SUBCASE("Wrong component count")
+		{
+			auto channel = make_translation_channel(Interpolation::Linear);
+			channel.component_count = 4;
+			CHECK_FALSE(channel.valid());
+		}
+
+		SUBCASE("Empty keyframes")
+		{
+			auto channel = make_translation_channel(Interpolation::Linear);
+			channel.times.clear();
+			channel.values.clear();
+			CHECK_FALSE(channel.valid());
+		}
+
+		SUBCASE("Unsorted times")
+		{
+			auto channel = make_translation_channel(Interpolation::Linear);
+			channel.times = {3.0f, 1.0f};
+			CHECK_FALSE(channel.valid());
+		}
+
+		SUBCASE("Value count mismatch")
+		{
+			auto channel = make_translation_channel(Interpolation::CubicSpline);
+			CHECK_FALSE(channel.valid());
+		}
+
+		SUBCASE("Weights without components")
+		{
+			auto channel = make_translation_channel(Interpolation::Linear);
+			channel.path = Path::Weights;
+			channel.component_count = 0;
+			CHECK_FALSE(channel.valid());
+		}
+	}
+}
+
+TEST_SUITE("Animation Sampling")
+{
+	TEST_CASE("Duration")
+	{
+		auto late = make_translation_channel(Interpolation::Linear);
+		late.times = {0.0f, 5.0f};
+
+		const auto animation = model::Animation{
+			.channels = {make_translation_channel(Interpolation::Linear), late}
+		};
+		CHECK_EQ(animation.duration(), doctest::Approx(5.0f));
+	}
+
+	TEST_CASE("Linear translation")
+	{
+		const auto animation =
+			model::Animation{.channels = {make_translation_channel(Interpolation::Linear)}};
+		auto transforms = std::vector<model::Transform>(1);
+
+		SUBCASE("Middle")
+		{
+			animation.sample(2.0f, transforms);
+			CHECK(vec3_near(transforms[0].translation, {2.0f, 1.0f, -1.0f}));
+		}
+
+		SUBCASE("Clamped before first keyframe")
+		{
+			animation.sample(0.0f, transforms);
+			CHECK(vec3_near(transforms[0].translation, {0.0f, 0.0f, 0.0f}));
+		}
+
+		SUBCASE("Clamped after last keyframe")
+		{
+			animation.sample(10.0f, transforms);
+			CHECK(vec3_near(transforms[0].translation, {4.0f, 2.0f, -2.0f}));
+		}
+
+		// Unanimated properties are left unchanged
+		CHECK(vec3_near(transforms[0].scale, glm::vec3(1.0f)));
+	}
+
+	TEST_CASE("Step translation")
+	{
+		const auto animation = model::Animation{.channels = {make_translation_channel(Interpolation::Step)}};
+		auto transforms = std::vector<model::Transform>(1);
+
+		animation.sample(2.9f, transforms);
+		CHECK(vec3_near(transforms[0].translation, {0.0f, 0.0f, 0.0f}));
+
+		animation.sample(3.0f, transforms);
+		CHECK(vec3_near(transforms[0].translation, {4.0f, 2.0f, -2.0f}));
+	}
+
+	TEST_CASE("Cubic spline translation")
+	{
+		// Zero tangents, the curve passes the keyframe values with a smoothstep in between
+		auto channel = make_translation_channel(Interpolation::CubicSpline);
+		channel.values = {
+			0.0f, 0.0f, 0.0f,   // In-tangent of keyframe 0
+			0.0f, 0.0f, 0.0f,   // Value of keyframe 0
+			0.0f, 0.0f, 0.0f,   // Out-tangent of keyframe 0
+			0.0f, 0.0f, 0.0f,   // In-tangent of keyframe 1
+			4.0f, 2.0f, -2.0f,  // Value of keyframe 1
+			0.0f, 0.0f, 0.0f,   // Out-tangent of keyframe 1
+		};
+		REQUIRE(channel.valid());
+
+		const auto animation = model::Animation{.channels = {channel}};
+		auto transforms = std::vector<model::Transform>(1);
+
+		animation.sample(2.0f, transforms);
+		CHECK(vec3_near(transforms[0].translation, {2.0f, 1.0f, -1.0f}));
+
+		animation.sample(1.5f, transforms);
+		CHECK(vec3_near(transforms[0].translation, glm::vec3(4.0f, 2.0f, -2.0f) * 0.15625f));
+	}
+
+	TEST_CASE("Linear rotation")
+	{
+		const auto quarter_turn = glm::angleAxis(glm::half_pi<float>(), glm::vec3(0.0f, 0.0f, 1.0f));
+
+		const auto animation = model::Animation{
+			.channels = {
+				model::AnimationChannel{
+					.node_index = 0,
+					.path = Path::Rotation,
+					.interpolation = Interpolation::Linear,
+					.component_count = 4,
+					.times = {0.0f, 1.0f},
+					.values = {
+						0.0f, 0.0f, 0.0f, 1.0f,
+						quarter_turn.x, quarter_turn.y, quarter_turn.z, quarter_turn.w,
+					},
+				}
+			}
+		};
+		auto transforms = std::vector<model::Transform>(1);
+
+		animation.sample(0.5f, transforms);
+
+		const auto expected = glm::angleAxis(glm::quarter_pi<float>(), glm::vec3(0.0f, 0.0f, 1.0f));
+		CHECK(glm::all(glm::epsilonEqual(transforms[0].rotation, expected, 1.0e-4f)));
+	}
+
+	TEST_CASE("Morph weights")
+	{
+		const auto animation = model::Animation{
+			.channels = {
+				model::AnimationChannel{
+					.node_index = 1,
+					.path = Path::Weights,
+					.interpolation = Interpolation::Linear,
+					.component_count = 2,
+					.times = {0.0f, 1.0f},
+					.values = {0.0f, 1.0f, 1.0f, 0.0f},
+				}
+			}
+		};
+		auto transforms = std::vector<model::Transform>(2);
+
+		SUBCASE("Matching size")
+		{
+			auto weights = std::vector<std::vector<float>>{{}, {0.0f, 0.0f}};
+			animation.sample(0.25f, transforms, weights);
+
+			CHECK(weights[0].empty());
+			CHECK_EQ(weights[1][0], doctest::Approx(0.25f));
+			CHECK_EQ(weights[1][1], doctest::Approx(0.75f));
+		}
+
+		SUBCASE("Excess weights dropped")
+		{
+			auto weights = std::vector<std::vector<float>>{{}, {0.0f}};
+			animation.sample(0.25f, transforms, weights);
+
+			REQUIRE_EQ(weights[1].size(), 1);
+			CHECK_EQ(weights[1][0], doctest::Approx(0.25f));
+		}
+	}
+}
+
+TEST_SUITE("Skin")
+{
+	TEST_CASE("Joint matrices")
+	{
+		// Node 0 references the skin, node 1 is the joint
+		const auto node_transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 5.0f));
+		const auto bind_transform = glm::translate(node_transform, glm::vec3(1.0f, 0.0f, 0.0f));
+		const auto posed_transform = glm::translate(node_transform, glm::vec3(1.0f, 2.0f, 0.0f));
+
+		const auto skin = model::Skin{
+			.joints = {1},
+			.inverse_bind_matrices = {glm::inverse(glm::inverse(node_transform) * bind_transform)},
+		};
+
+		SUBCASE("Bind pose")
+		{
+			const std::vector world_transforms = {node_transform, bind_transform};
+			const auto matrices = skin.compute_joint_matrices(world_transforms, 0);
+
+			REQUIRE_EQ(matrices.size(), 1);
+			const auto position = glm::vec3(matrices[0] * glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+			CHECK(vec3_near(position, {1.0f, 1.0f, 1.0f}));
+		}
+
+		SUBCASE("Posed")
+		{
+			const std::vector world_transforms = {node_transform, posed_transform};
+			const auto matrices = skin.compute_joint_matrices(world_transforms, 0);
+
+			REQUIRE_EQ(matrices.size(), 1);
+			const auto position = glm::vec3(matrices[0] * glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+			CHECK(vec3_near(position, {1.0f, 3.0f, 1.0f}));
+		}
+	}
+}
@@ -0,0 +1,246 @@
+#include "model/bvh.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <doctest.h>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <glm/vector_relational.hpp>
+#include <ranges>
+#include <vector>
+
+static bool vec3_near(glm::vec3 a, glm::vec3 b) noexcept
+{
+	return glm::all(glm::epsilonEqual(a, b, 1.0e-4f));
+}
+
+// Unit boxes along the X axis, item `i` spans `[2i, 2i + 1]` on X and `[0, 1]` on Y and Z
+static std::vector<model::Aabb> make_row(uint32_t count)
+{
+	return std::views::iota(0u, count)
+		| std::views::transform([](uint32_t i) {
+			  const auto min = glm::vec3(2.0f * static_cast<float>(i), 0.0f, 0.0f);
+			  return model::Aabb{.min = min, .max = min + glm::vec3(1.0f)};
+		  })
+		| std::ranges::to<std::vector>();
+}
+
+// Deterministic pseudo-random boxes scattered in a 100-unit cube
+static std::vector<model::Aabb> make_scattered(uint32_t count)
+{
+	uint32_t state = 12345;
+	const auto next = [&state] {
+		state = state * 1664525u + 1013904223u;
+		return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+	};
+
+	std::vector<model::Aabb> bounds;
+	for (const auto _ : std::views::iota(0u, count))
+	{
+		const auto min = glm::vec3(next(), next(), next()) * 100.0f;
+		const auto size = glm::vec3(next(), next(), next()) * 5.0f;
+		bounds.push_back({.min = min, .max = min + size});
+	}
+	return bounds;
+}
+
+static std::vector<uint32_t> sorted(std::vector<uint32_t> items)
+{
+	std::ranges::sort(items);
+	return items;
+}
+
+TEST_SUITE("Aabb")
+{
+	TEST_CASE("Empty")
+	{
+		const auto empty = model::Aabb{};
+		const auto box = model::Aabb{.min = glm::vec3(0.0f), .max = glm::vec3(1.0f)};
+
+		CHECK(empty.empty());
+		CHECK_FALSE(box.empty());
+		CHECK_EQ(empty.surface_area(), 0.0f);
+		CHECK(empty.transform(glm::mat4(1.0f)).empty());
+
+		const auto merged = empty.merge(box);
+		CHECK(vec3_near(merged.min, box.min));
+		CHECK(vec3_near(merged.max, box.max));
+	}
+
+	TEST_CASE("Transform")
+	{
+		const auto box =
+			model::Aabb{.min = glm::vec3(-1.0f, -2.0f, -3.0f), .max = glm::vec3(1.0f, 2.0f, 3.0f)};
+
+		SUBCASE("Translation")
+		{
+			const auto moved = box.transform(glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, 0.0f)));
+			CHECK(vec3_near(moved.min, {9.0f, -2.0f, -3.0f}));
+			CHECK(vec3_near(moved.max, {11.0f, 2.0f, 3.0f}));
+		}
+
+		SUBCASE("Quarter turn")
+		{
+			const auto rotation =
+				glm::rotate(glm::mat4(1.0f), glm::half_pi<float>(), glm::vec3(0.0f, 0.0f, 1.0f));
+			const auto rotated = box.transform(rotation);
+			CHECK(vec3_near(rotated.min, {-2.0f, -1.0f, -3.0f}));
+			CHECK(vec3_near(rotated.max, {2.0f, 1.0f, 3.0f}));
+		}
+	}
+}
+
+TEST_SUITE("Scene BVH")
+{
+	TEST_CASE("Empty")
+	{
+		const auto bvh = model::SceneBvh::create(std::vector<model::Aabb>(3));
+
+		CHECK(bvh.get_bound().empty());
+		const auto ray = model::Ray{.origin = glm::vec3(0.0f), .direction = glm::vec3(1.0f, 0.0f, 0.0f)};
+		CHECK(bvh.query(ray).empty());
+		CHECK(bvh.query(model::Sphere{.center = glm::vec3(0.0f), .radius = 100.0f}).empty());
+	}
+
+	TEST_CASE("Ray query")
+	{
+		const auto bvh = model::SceneBvh::create(make_row(20));
+
+		SUBCASE("Along the row")
+		{
+			const auto hits = bvh.query(
+				model::Ray{.origin = glm::vec3(-10.0f, 0.5f, 0.5f), .direction = glm::vec3(1.0f, 0.0f, 0.0f)}
+			);
+
+			REQUIRE_EQ(hits.size(), 20);
+			for (const auto [index, hit] : hits | std::views::enumerate)
+			{
+				CHECK_EQ(hit.item, index);
+				CHECK_EQ(hit.t, doctest::Approx(10.0f + 2.0f * static_cast<float>(index)));
+			}
+		}
+
+		SUBCASE("Across the row")
+		{
+			const auto hits = bvh.query(
+				model::Ray{.origin = glm::vec3(4.5f, -10.0f, 0.5f), .direction = glm::vec3(0.0f, 1.0f, 0.0f)}
+			);
+
+			REQUIRE_EQ(hits.size(), 1);
+			CHECK_EQ(hits[0].item, 2);
+		}
+
+		SUBCASE("Limited distance")
+		{
+			const auto hits = bvh.query(
+				model::Ray{
+					.origin = glm::vec3(-10.0f, 0.5f, 0.5f),
+					.direction = glm::vec3(1.0f, 0.0f, 0.0f),
+					.t_max = 13.0f,
+				}
+			);
+
+			REQUIRE_EQ(hits.size(), 2);
+			CHECK_EQ(hits[0].item, 0);
+			CHECK_EQ(hits[1].item, 1);
+		}
+	}
+
+	TEST_CASE("Sphere query")
+	{
+		const auto bvh = model::SceneBvh::create(make_row(20));
+
+		CHECK_EQ(
+			sorted(bvh.query(model::Sphere{.center = glm::vec3(10.5f, 0.5f, 0.5f), .radius = 0.1f})),
+			std::vector<uint32_t>{5}
+		);
+		CHECK_EQ(
+			sorted(bvh.query(model::Sphere{.center = glm::vec3(10.5f, 0.5f, 0.5f), .radius = 2.0f})),
+			std::vector<uint32_t>{4, 5, 6}
+		);
+		CHECK(bvh.query(model::Sphere{.center = glm::vec3(10.5f, 5.0f, 0.5f), .radius = 1.0f}).empty());
+	}
+
+	TEST_CASE("Frustum query")
+	{
+		const auto bvh = model::SceneBvh::create(make_row(20));
+
+		SUBCASE("Identity clip space")
+		{
+			// Clip space itself, spanning `[-1, 1]` on X and Y and `[0, 1]` on Z
+			const auto frustum = model::Frustum::from_matrix(glm::mat4(1.0f));
+			CHECK_EQ(sorted(bvh.query(frustum)), std::vector<uint32_t>{0});
+		}
+
+		SUBCASE("Scaled clip space")
+		{
+			// Covers `[-9.5, 9.5]` on X
+			const auto frustum =
+				model::Frustum::from_matrix(glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / 9.5f, 1.0f, 1.0f)));
+			CHECK_EQ(sorted(bvh.query(frustum)), std::vector<uint32_t>{0, 1, 2, 3, 4});
+		}
+	}
+
+	TEST_CASE("Matches brute force")
+	{
+		const auto bounds = make_scattered(500);
+		const auto bvh = model::SceneBvh::create(bounds);
+
+		SUBCASE("Sphere")
+		{
+			const auto sphere = model::Sphere{.center = glm::vec3(50.0f), .radius = 20.0f};
+
+			const auto intersects = [&sphere](const model::Aabb& bound) {
+				const auto offset = glm::clamp(sphere.center, bound.min, bound.max) - sphere.center;
+				return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+			};
+
+			std::vector<uint32_t> expected;
+			for (const auto [item, bound] : bounds | std::views::enumerate)
+				if (intersects(bound)) expected.push_back(static_cast<uint32_t>(item));
+
+			CHECK_EQ(sorted(bvh.query(sphere)), expected);
+		}
+
+		SUBCASE("Ray")
+		{
+			const auto ray = model::Ray{.origin = glm::vec3(0.0f), .direction = glm::vec3(1.0f, 1.0f, 1.0f)};
+			const auto hits = bvh.query(ray);
+
+			CHECK(std::ranges::is_sorted(hits, {}, &model::SceneBvh::RayHit::t));
+
+			// Every box containing a point on the diagonal is hit
+			for (const auto [item, bound] : bounds | std::views::enumerate)
+			{
+				const auto enter = std::max({bound.min.x, bound.min.y, bound.min.z});
+				const auto exit = std::min({bound.max.x, bound.max.y, bound.max.z});
+				const bool hit =
+					std::ranges::contains(hits, static_cast<uint32_t>(item), &model::SceneBvh::RayHit::item);
+				CHECK_EQ(hit, enter <= exit);
+			}
+		}
+	}
+
+	TEST_CASE("Update")
+	{
+		auto bvh = model::SceneBvh::create(make_row(20));
+
+		const auto moved =
+			model::Aabb{.min = glm::vec3(0.0f, 50.0f, 0.0f), .max = glm::vec3(1.0f, 51.0f, 1.0f)};
+		bvh.update(7, moved);
+
+		CHECK(bvh.query(model::Sphere{.center = glm::vec3(14.5f, 0.5f, 0.5f), .radius = 0.1f}).empty());
+		CHECK_EQ(
+			bvh.query(model::Sphere{.center = glm::vec3(0.5f, 50.5f, 0.5f), .radius = 0.1f}),
+			std::vector<uint32_t>{7}
+		);
+		CHECK(vec3_near(bvh.get_bound().max, {39.0f, 51.0f, 1.0f}));
+
+		// Untracked items are ignored
+		bvh.update(100, moved);
+		CHECK_EQ(bvh.query(model::Sphere{.center = glm::vec3(0.5f, 50.5f, 0.5f), .radius = 0.1f}).size(), 1);
+	}
+}
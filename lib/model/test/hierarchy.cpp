@@ -617,4 +617,36 @@ TEST_SUITE("Transformation")
 		CHECK(check_matrix(transforms[1], glm::vec3(0.0, 1.0, 0.0), rot_z_90, glm::vec3(1.0)));
 		CHECK(check_matrix(transforms[2], glm::vec3(0.0), rot_z_90, glm::vec3(0.5)));
 	}
+
+	TEST_CASE("Overridden local transforms")
+	{
+		/* [0] (root)
+		 *  |
+		 * [1]
+		 *
+		 * Stored: [0] scale 2.0, [1] translate (1, 0, 0)
+		 * Overridden: [0] translate (0, 0, 1), [1] translate (0, 1, 0)
+		 */
+
+		const std::vector<model::ParentOnlyNode> nodes = {
+			{.parent_index = std::nullopt, .data = {.transform = {.scale = {2.0, 2.0, 2.0}}}      },
+			{.parent_index = 0,            .data = {.transform = {.translation = {1.0, 0.0, 0.0}}}}
+		};
+
+		auto hierarchy_result = model::Hierarchy::create(nodes);
+		EXPECT_SUCCESS(hierarchy_result);
+		auto hierarchy = std::move(*hierarchy_result);
+
+		const std::vector<model::Transform> local_transforms = {
+			{.translation = {0.0, 0.0, 1.0}},
+			{.translation = {0.0, 1.0, 0.0}}
+		};
+		const auto transforms = hierarchy.compute_transforms(glm::mat4(1.0), local_transforms);
+
+		constexpr glm::quat unit_quat = {1.0, 0.0, 0.0, 0.0};
+
+		// Stored transforms are ignored
+		CHECK(check_matrix(transforms[0], glm::vec3(0.0, 0.0, 1.0), unit_quat, glm::vec3(1.0)));
+		CHECK(check_matrix(transforms[1], glm::vec3(0.0, 1.0, 1.0), unit_quat, glm::vec3(1.0)));
+	}
 }
@@ -0,0 +1,157 @@
+#include "model/impostor.hpp"
+#include "common/test-macro.hpp"
+#include "common/util/error.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "model/hierarchy.hpp"
+#include "model/material.hpp"
+#include "model/mesh.hpp"
+#include "model/model.hpp"
+#include "model/texture.hpp"
+
+#include <cstdint>
+#include <doctest.h>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint2.hpp>
+#include <glm/geometric.hpp>
+#include <utility>
+#include <vector>
+
+static model::MaterialList get_material_list(model::AlphaMode alpha_mode, float alpha) noexcept
+{
+	const auto texture = std::vector<model::Texture>(
+		4,
+		model::Texture{
+			.source = image::Image<image::Format::Unorm8, image::Layout::RGBA>({1, 1}, {255, 255, 255, 255})
+		}
+	);
+
+	const auto texture_set =
+		model::TextureSet{.albedo = 0, .emissive = 1, .roughness_metallic = 2, .normal = 3};
+
+	auto material = model::Material{.texture_set = texture_set};
+	material.mode.alpha_mode = alpha_mode;
+	material.param.base_color_factor.a = alpha;
+
+	return model::MaterialList::create(texture, {material}) | Error::unwrap();
+}
+
+// Unit quad on the XY plane, facing +Z
+static model::Mesh get_quad_mesh() noexcept
+{
+	const std::vector<model::FullVertex> vertices = {
+		{.position = {-1.0f, -1.0f, 0.0f}, .texcoord = {}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {}},
+		{.position = {1.0f, -1.0f, 0.0f}, .texcoord = {}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {}},
+		{.position = {1.0f, 1.0f, 0.0f}, .texcoord = {}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {}},
+		{.position = {-1.0f, 1.0f, 0.0f}, .texcoord = {}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {}}
+	};
+	const std::vector<uint32_t> indices = {0, 1, 2, 0, 2, 3};
+
+	auto geometry = model::Geometry::create(vertices, indices) | Error::unwrap();
+	return model::Mesh{
+		.primitives = {model::Primitive{.geometry = std::move(geometry), .lods = {}, .material_index = 0}}
+	};
+}
+
+// Model with the quad mesh referenced by @p count nodes
+static model::Model get_model(
+	uint32_t count,
+	model::AlphaMode alpha_mode = model::AlphaMode::Opaque,
+	float alpha = 1.0f
+) noexcept
+{
+	std::vector<model::ParentOnlyNode> nodes;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const auto transform = model::Transform{.translation = {static_cast<float>(i) * 4.0f, 0.0f, 0.0f}};
+		nodes.push_back({.parent_index = {}, .data = {.transform = transform, .mesh_index = 0}});
+	}
+
+	auto hierarchy = model::Hierarchy::create(nodes) | Error::unwrap();
+	auto material_list = get_material_list(alpha_mode, alpha);
+	return model::Model::assemble(std::move(material_list), {get_quad_mesh()}, std::move(hierarchy))
+		| Error::unwrap();
+}
+
+TEST_CASE("Impostor frame directions")
+{
+	constexpr uint32_t frame_count = 8;
+
+	for (uint32_t y = 0; y < frame_count; y++)
+		for (uint32_t x = 0; x < frame_count; x++)
+		{
+			const auto direction = model::get_impostor_frame_direction({x, y}, frame_count);
+			CHECK_EQ(glm::length(direction), doctest::Approx(1.0f));
+
+			const auto frame = model::get_impostor_frame(direction, frame_count);
+			CHECK_EQ(frame.x, x);
+			CHECK_EQ(frame.y, y);
+		}
+}
+
+TEST_CASE("Bake impostors")
+{
+	const auto option = model::ImpostorOption{.frame_count = 4, .frame_size = 8, .min_mesh_references = 2};
+	const auto atlas_size = option.frame_count * option.frame_size;
+
+	SUBCASE("Instanced mesh")
+	{
+		const auto model = model::bake_impostors(get_model(2), option) | Error::unwrap();
+
+		REQUIRE_EQ(model.impostors.impostors.size(), 1);
+		CHECK_EQ(model.impostors.frame_count, option.frame_count);
+		CHECK_EQ(model.impostors.frame_size, option.frame_size);
+
+		const auto& impostor = model.impostors.impostors[0];
+		CHECK_EQ(impostor.mesh_index, 0);
+		CHECK_VEC3_EQ(impostor.center, 0.0f, 0.0f, 0.0f);
+		CHECK_EQ(impostor.radius, doctest::Approx(glm::sqrt(2.0f)));
+		CHECK_EQ(impostor.albedo.size.x, atlas_size);
+		CHECK_EQ(impostor.albedo.size.y, atlas_size);
+		CHECK_EQ(impostor.normal_depth.size.x, atlas_size);
+		CHECK_EQ(impostor.normal_depth.size.y, atlas_size);
+
+		// Center of the frame viewing the quad from the front
+		const auto frame = model::get_impostor_frame({0.0f, 0.0f, 1.0f}, option.frame_count);
+		const auto center = frame * option.frame_size + option.frame_size / 2;
+
+		const auto albedo = impostor.albedo[center];
+		CHECK_EQ(albedo.r, 255);
+		CHECK_EQ(albedo.g, 255);
+		CHECK_EQ(albedo.b, 255);
+		CHECK_EQ(albedo.a, 255);
+
+		const auto normal_depth = impostor.normal_depth[center];
+		CHECK_LE(glm::abs(int(normal_depth.r) - 128), 2);
+		CHECK_LE(glm::abs(int(normal_depth.g) - 128), 2);
+		CHECK_EQ(normal_depth.b, 255);
+		CHECK_LE(glm::abs(int(normal_depth.a) - 128), 2);
+	}
+
+	SUBCASE("Rarely referenced mesh")
+	{
+		const auto model = model::bake_impostors(get_model(1), option) | Error::unwrap();
+		CHECK(model.impostors.impostors.empty());
+	}
+
+	SUBCASE("Alpha masked mesh")
+	{
+		const auto model =
+			model::bake_impostors(get_model(1, model::AlphaMode::Mask, 0.0f), option)
+			| Error::unwrap();
+		REQUIRE_EQ(model.impostors.impostors.size(), 1);
+
+		// Every texel of the fully transparent quad is discarded
+		const auto& albedo = model.impostors.impostors[0].albedo;
+		for (uint32_t y = 0; y < atlas_size; y++)
+			for (uint32_t x = 0; x < atlas_size; x++) CHECK_EQ(albedo[x, y].a, 0);
+	}
+
+	SUBCASE("Blended mesh")
+	{
+		const auto model =
+			model::bake_impostors(get_model(2, model::AlphaMode::Blend, 0.5f), option)
+			| Error::unwrap();
+		CHECK(model.impostors.impostors.empty());
+	}
+}
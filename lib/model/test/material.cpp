@@ -1,10 +1,15 @@
 #include "model/material.hpp"
 #include "common/test-macro.hpp"
+#include "common/util/error.hpp"
 #include "image/common.hpp"
 #include "image/image.hpp"
 #include "model/texture.hpp"
 
+#include <cstdint>
 #include <doctest.h>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
 #include <ranges>
 #include <utility>
 #include <vector>
@@ -73,3 +78,69 @@ TEST_CASE("Out of bound Material Set")
 	auto material_list_result = model::MaterialList::create(texture, {material});
 	EXPECT_FAIL(material_list_result);
 }
+
+TEST_CASE("Material Canonicalization")
+{
+	SUBCASE("Alpha cutoff")
+	{
+		const auto opaque = model::Material{.param = {.alpha_cutoff = 0.9f}};
+		CHECK_EQ(opaque.canonicalize().param.alpha_cutoff, doctest::Approx(0.5f));
+
+		auto masked = opaque;
+		masked.mode.alpha_mode = model::AlphaMode::Mask;
+		CHECK_EQ(masked.canonicalize().param.alpha_cutoff, doctest::Approx(0.9f));
+	}
+
+	SUBCASE("Emissive texture")
+	{
+		const auto dark = model::Material{.texture_set = {.emissive = 0}};
+		CHECK_FALSE(dark.canonicalize().texture_set.emissive.has_value());
+
+		auto glowing = dark;
+		glowing.param.emissive_factor = glm::vec3(1.0f);
+		CHECK_EQ(glowing.canonicalize().texture_set.emissive, 0);
+	}
+
+	SUBCASE("Normal scale")
+	{
+		const auto flat = model::Material{.param = {.normal_scale = glm::vec2(2.0f)}};
+		CHECK_EQ(flat.canonicalize().param.normal_scale.x, doctest::Approx(1.0f));
+
+		auto bumpy = flat;
+		bumpy.texture_set.normal = 0;
+		CHECK_EQ(bumpy.canonicalize().param.normal_scale.x, doctest::Approx(2.0f));
+	}
+}
+
+TEST_CASE("Material Deduplication")
+{
+	const auto texture = std::vector<model::Texture>(
+		2,
+		model::Texture{
+			.source = image::Image<image::Format::Unorm8, image::Layout::RGBA>({1, 1}, {255, 255, 255, 255})
+		}
+	);
+
+	const auto red = model::Material{.param = {.base_color_factor = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)}};
+	const auto textured = model::Material{.texture_set = {.albedo = 0}};
+	const auto other_textured = model::Material{.texture_set = {.albedo = 1}};
+
+	// Differs from `red` only in a field without effect
+	auto red_cutoff = red;
+	red_cutoff.param.alpha_cutoff = 0.9f;
+
+	auto red_masked = red_cutoff;
+	red_masked.mode.alpha_mode = model::AlphaMode::Mask;
+
+	const std::vector materials = {red, textured, red_cutoff, red_masked, other_textured, textured};
+	auto material_list = model::MaterialList::create(texture, materials) | Error::unwrap();
+
+	const auto remap = material_list.deduplicate();
+
+	CHECK_EQ(remap, std::vector<uint32_t>{0, 1, 0, 2, 3, 1});
+	REQUIRE_EQ(material_list.materials.size(), 4);
+	CHECK_EQ(material_list.materials[1].texture_set.albedo, 0);
+	CHECK_EQ(material_list.materials[2].mode.alpha_mode, model::AlphaMode::Mask);
+	CHECK_EQ(material_list.materials[3].texture_set.albedo, 1);
+	CHECK_EQ(material_list.textures.size(), 2);
+}
@@ -0,0 +1,288 @@
+#include "model/merge.hpp"
+#include "common/number-literals.hpp"
+#include "common/test-macro.hpp"
+#include "common/util/error.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "model/animation.hpp"
+#include "model/hierarchy.hpp"
+#include "model/material.hpp"
+#include "model/mesh.hpp"
+#include "model/model.hpp"
+#include "model/texture.hpp"
+
+#include <array>
+#include <cstdint>
+#include <doctest.h>
+#include <glm/ext/vector_float3.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+static model::MaterialList get_material_list() noexcept
+{
+	const auto texture = std::vector<model::Texture>(
+		4,
+		model::Texture{
+			.source = image::Image<image::Format::Unorm8, image::Layout::RGBA>({1, 1}, {255, 255, 255, 255})
+		}
+	);
+
+	const auto texture_set =
+		model::TextureSet{.albedo = 0, .emissive = 1, .roughness_metallic = 2, .normal = 3};
+
+	const auto material = model::Material{.texture_set = texture_set};
+
+	return model::MaterialList::create(texture, {material}) | Error::unwrap();
+}
+
+static model::Mesh get_triangle_mesh() noexcept
+{
+	const std::vector<model::FullVertex> vertices = {
+		{.position = {0.0f, 0.0f, 0.0f}, .texcoord = {}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {}},
+		{.position = {1.0f, 0.0f, 0.0f}, .texcoord = {}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {}},
+		{.position = {0.0f, 1.0f, 0.0f}, .texcoord = {}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {}}
+	};
+	const auto indices = std::vector<uint32_t>(std::from_range, std::views::iota(0_u32, 3_u32));
+
+	auto geometry = model::Geometry::create(vertices, indices) | Error::unwrap();
+	return model::Mesh{
+		.primitives = {model::Primitive{.geometry = std::move(geometry), .lods = {}, .material_index = 0}}
+	};
+}
+
+// Root node translated by 10 on X, with one child per transform referencing the triangle mesh
+static model::Model get_model(std::span<const model::Transform> transforms) noexcept
+{
+	const auto root_transform = model::Transform{.translation = {10.0f, 0.0f, 0.0f}};
+
+	std::vector nodes = {
+		model::ParentOnlyNode{.parent_index = {}, .data = {.transform = root_transform}}
+	};
+	for (const auto& transform : transforms)
+		nodes.push_back({.parent_index = 0, .data = {.transform = transform, .mesh_index = 0}});
+
+	auto hierarchy = model::Hierarchy::create(nodes) | Error::unwrap();
+	return model::Model::assemble(get_material_list(), {get_triangle_mesh()}, std::move(hierarchy))
+		| Error::unwrap();
+}
+
+static std::vector<model::Transform> get_row_transforms(uint32_t count) noexcept
+{
+	return std::views::iota(0_u32, count)
+		| std::views::transform([](uint32_t i) {
+			   return model::Transform{.translation = {static_cast<float>(i), 0.0f, 0.0f}};
+		   })
+		| std::ranges::to<std::vector>();
+}
+
+TEST_CASE("Merge small meshes")
+{
+	const auto transforms = get_row_transforms(3);
+	auto merge_result = model::merge_static_geometry(get_model(transforms));
+	EXPECT_SUCCESS(merge_result);
+	const auto& [merged_model, merged_primitives] = *merge_result;
+
+	// Source meshes are replaced by a single merged mesh, referenced by a new child of the root
+	REQUIRE_EQ(merged_primitives.size(), 1);
+	REQUIRE_EQ(merged_model.meshes.size(), 1);
+	CHECK_EQ(merged_primitives[0].mesh_index, 0);
+	CHECK_EQ(merged_primitives[0].node_index, 4);
+
+	const auto nodes = merged_model.hierarchy.get_nodes();
+	REQUIRE_EQ(nodes.size(), 5);
+	for (const auto& node : nodes | std::views::take(4)) CHECK_FALSE(node.data.mesh_index.has_value());
+	CHECK_EQ(nodes[4].parent_index, 0);
+	CHECK_EQ(nodes[4].data.mesh_index, 0);
+
+	// Geometry is pre-transformed into the root space
+	const auto& primitive = merged_model.meshes[0].primitives[0];
+	CHECK_EQ(primitive.material_index, 0);
+	CHECK_EQ(primitive.geometry.vertices.size(), 9);
+	CHECK_EQ(primitive.geometry.indices.size(), 9);
+	CHECK_EQ(primitive.geometry.aabb_min.x, doctest::Approx(0.0f));
+	CHECK_EQ(primitive.geometry.aabb_max.x, doctest::Approx(3.0f));
+
+	const auto& sources = merged_primitives[0].sources;
+	REQUIRE_EQ(sources.size(), 3);
+	for (const auto [index, source] : sources | std::views::enumerate)
+	{
+		CHECK_EQ(source.node_index, static_cast<uint32_t>(index + 1));
+		CHECK_EQ(source.triangle_offset, static_cast<uint32_t>(index));
+		CHECK_EQ(source.triangle_count, 1);
+	}
+}
+
+TEST_CASE("Keep large and instanced meshes")
+{
+	const auto transforms = get_row_transforms(3);
+
+	SUBCASE("Too many vertices")
+	{
+		auto merge_result = model::merge_static_geometry(get_model(transforms), {.max_source_vertices = 2});
+		EXPECT_SUCCESS(merge_result);
+
+		CHECK(merge_result->merged_primitives.empty());
+		CHECK_EQ(merge_result->model.meshes.size(), 1);
+		for (const auto& node : merge_result->model.hierarchy.get_nodes() | std::views::drop(1))
+			CHECK_EQ(node.data.mesh_index, 0);
+	}
+
+	SUBCASE("Too many references")
+	{
+		auto merge_result = model::merge_static_geometry(get_model(transforms), {.max_mesh_references = 2});
+		EXPECT_SUCCESS(merge_result);
+
+		CHECK(merge_result->merged_primitives.empty());
+		CHECK_EQ(merge_result->model.hierarchy.get_renderables().size(), 3);
+	}
+}
+
+TEST_CASE("Keep animated and deformable meshes")
+{
+	const auto transforms = get_row_transforms(3);
+	auto model = get_model(transforms);
+
+	SUBCASE("Animated ancestor")
+	{
+		model.animations = {
+			model::Animation{
+				.channels = {
+					model::AnimationChannel{
+						.node_index = 0,
+						.path = model::AnimationChannel::Path::Translation,
+						.interpolation = model::AnimationChannel::Interpolation::Linear,
+						.component_count = 3,
+						.times = {0.0f},
+						.values = {0.0f, 0.0f, 0.0f},
+					}
+				}
+			}
+		};
+	}
+
+	SUBCASE("Morph targets")
+	{
+		auto& primitive = model.meshes[0].primitives[0];
+		primitive.deformation.morph_targets = {
+			model::MorphTarget{
+				.position_deltas = std::vector(3, glm::vec3(0.0f, 0.0f, 1.0f)),
+				.normal_deltas = {}
+			}
+		};
+		model.meshes[0].morph_weights = {1.0f};
+	}
+
+	auto merge_result = model::merge_static_geometry(std::move(model));
+	EXPECT_SUCCESS(merge_result);
+
+	CHECK(merge_result->merged_primitives.empty());
+	CHECK_EQ(merge_result->model.hierarchy.get_renderables().size(), 3);
+}
+
+TEST_CASE("Split clusters by vertex count")
+{
+	const auto transforms = get_row_transforms(3);
+	auto merge_result = model::merge_static_geometry(get_model(transforms), {.max_cluster_vertices = 6});
+	EXPECT_SUCCESS(merge_result);
+
+	const auto& merged_primitives = merge_result->merged_primitives;
+	REQUIRE_EQ(merged_primitives.size(), 2);
+	CHECK_EQ(merged_primitives[0].sources.size(), 2);
+	CHECK_EQ(merged_primitives[1].sources.size(), 1);
+	CHECK_EQ(merge_result->model.meshes.size(), 2);
+}
+
+TEST_CASE("Mirrored transform keeps winding")
+{
+	const auto transforms = std::to_array({model::Transform{.scale = {-1.0f, 1.0f, 1.0f}}});
+	auto merge_result = model::merge_static_geometry(get_model(transforms));
+	EXPECT_SUCCESS(merge_result);
+
+	const auto& geometry = merge_result->model.meshes[0].primitives[0].geometry;
+	REQUIRE_EQ(geometry.indices.size(), 3);
+	CHECK_EQ(geometry.indices[0], 0);
+	CHECK_EQ(geometry.indices[1], 2);
+	CHECK_EQ(geometry.indices[2], 1);
+	CHECK_EQ(geometry.aabb_min.x, doctest::Approx(-1.0f));
+}
+
+TEST_CASE("Find merge source")
+{
+	const auto transforms = get_row_transforms(3);
+	auto merge_result = model::merge_static_geometry(get_model(transforms));
+	EXPECT_SUCCESS(merge_result);
+
+	const auto merged_node = merge_result->merged_primitives[0].node_index;
+
+	const auto source = merge_result->find_source(merged_node, 1);
+	REQUIRE(source.has_value());
+	CHECK_EQ(source->node_index, 2);
+	CHECK_EQ(source->primitive_index, 0);
+
+	CHECK_FALSE(merge_result->find_source(merged_node, 3).has_value());
+	CHECK_FALSE(merge_result->find_source(1, 0).has_value());
+}
+
+TEST_CASE("Build HLOD")
+{
+	// Two cells of 4 nodes each
+	const auto transforms = get_row_transforms(8);
+
+	SUBCASE("Clusters and proxies")
+	{
+		auto hlod_result = model::build_hlod(get_model(transforms), {.cell_size = 4.0f});
+		EXPECT_SUCCESS(hlod_result);
+		const auto& hlod = hlod_result->hlod;
+
+		REQUIRE_EQ(hlod.clusters.size(), 2);
+		REQUIRE_EQ(hlod.source_nodes.size(), 8);
+
+		// Source nodes are kept, proxies are new children of the root
+		const auto nodes = hlod_result->hierarchy.get_nodes();
+		REQUIRE_EQ(nodes.size(), 11);
+		for (const auto& node : nodes | std::views::drop(1) | std::views::take(8))
+			CHECK_EQ(node.data.mesh_index, 0);
+
+		for (const auto [index, cluster] : hlod.clusters | std::views::enumerate)
+		{
+			CHECK_EQ(cluster.proxy_node_index, static_cast<uint32_t>(9 + index));
+			CHECK_EQ(cluster.source_offset, static_cast<uint32_t>(4 * index));
+			CHECK_EQ(cluster.source_count, 4);
+
+			const auto& proxy_node = nodes[cluster.proxy_node_index];
+			CHECK_EQ(proxy_node.parent_index, 0);
+			REQUIRE(proxy_node.data.mesh_index.has_value());
+
+			// Disjoint triangles are too few to simplify, the proxy keeps them in the root space
+			const auto& proxy = hlod_result->meshes[*proxy_node.data.mesh_index];
+			REQUIRE_EQ(proxy.primitives.size(), 1);
+			CHECK_EQ(proxy.primitives[0].material_index, 0);
+			CHECK_EQ(proxy.primitives[0].geometry.indices.size(), 12);
+			CHECK_EQ(proxy.primitives[0].geometry.aabb_min.x, doctest::Approx(4.0f * index));
+			CHECK_EQ(cluster.aabb_min.x, doctest::Approx(4.0f * index));
+			CHECK_EQ(cluster.aabb_max.x, doctest::Approx(4.0f * index + 4.0f));
+		}
+
+		for (const auto [index, node_index] : hlod.source_nodes | std::views::enumerate)
+			CHECK_EQ(node_index, static_cast<uint32_t>(index + 1));
+	}
+
+	SUBCASE("Sparse cells")
+	{
+		auto hlod_result =
+			model::build_hlod(get_model(transforms), {.cell_size = 4.0f, .min_cluster_nodes = 5});
+		EXPECT_SUCCESS(hlod_result);
+
+		CHECK(hlod_result->hlod.clusters.empty());
+		CHECK_EQ(hlod_result->hierarchy.get_nodes().size(), 9);
+	}
+
+	SUBCASE("Already built")
+	{
+		auto hlod_result = model::build_hlod(get_model(transforms), {.cell_size = 4.0f});
+		EXPECT_SUCCESS(hlod_result);
+		EXPECT_FAIL(model::build_hlod(std::move(*hlod_result)));
+	}
+}
@@ -1,14 +1,21 @@
 #include "model/mesh.hpp"
 #include "common/number-literals.hpp"
+#include "common/util/arena.hpp"
 #include "common/test-macro.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <doctest.h>
+#include <glm/common.hpp>
 #include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
 #include <glm/gtc/epsilon.hpp>
 #include <glm/vector_relational.hpp>
 #include <ranges>
+#include <span>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -146,7 +153,7 @@ TEST_CASE("Geometry Validation")
 
 	SUBCASE("Empty geometry")
 	{
-		EXPECT_FAIL(model::Geometry::create({}, {}));
+		EXPECT_FAIL(model::Geometry::create(std::vector<model::FullVertex>(), std::vector<uint32_t>()));
 	}
 
 	SUBCASE("Not triangle")
@@ -172,6 +179,107 @@ TEST_CASE("Geometry Validation")
 		CHECK(glm::all(glm::epsilonEqual(primitive.aabb_min, glm::vec3(0.0f), 0.0001f)));
 		CHECK(glm::all(glm::epsilonEqual(primitive.aabb_max, glm::vec3(1.0f, 1.0f, 0.0f), 0.0001f)));
 	}
+
+	SUBCASE("Move-in construction")
+	{
+		// The vertex at index 3 is not referenced, and should not contribute to the bounds
+		auto vertices = std::vector<model::FullVertex>{
+			{.position = {0.0f, 0.0f, 0.0f}, .texcoord = {}, .normal = {}, .tangent = {}},
+			{.position = {1.0f, 0.0f, 0.0f}, .texcoord = {}, .normal = {}, .tangent = {}},
+			{.position = {0.0f, 1.0f, 0.0f}, .texcoord = {}, .normal = {}, .tangent = {}},
+			{.position = {5.0f, 5.0f, 5.0f}, .texcoord = {}, .normal = {}, .tangent = {}}
+		};
+		auto indices = std::vector<uint32_t>{0, 1, 2};
+		const auto* const vertex_data = vertices.data();
+
+		auto geometry_result = model::Geometry::create(std::move(vertices), std::move(indices));
+		EXPECT_SUCCESS(geometry_result);
+		const auto primitive = std::move(*geometry_result);
+
+		CHECK_EQ(primitive.vertices.data(), vertex_data);
+		CHECK(glm::all(glm::epsilonEqual(primitive.aabb_min, glm::vec3(0.0f), 0.0001f)));
+		CHECK(glm::all(glm::epsilonEqual(primitive.aabb_max, glm::vec3(1.0f, 1.0f, 0.0f), 0.0001f)));
+	}
+}
+
+TEST_CASE("Meshlet Generation")
+{
+	// 32x32 grid of quads, enough to split into multiple meshlets
+	constexpr uint32_t grid_size = 32;
+
+	const auto vertices =
+		std::views::cartesian_product(
+			std::views::iota(0_u32, grid_size + 1),
+			std::views::iota(0_u32, grid_size + 1)
+		)
+		| std::views::transform([](const auto& coord) {
+			  const auto [y, x] = coord;
+			  return model::FullVertex{
+				  .position = {static_cast<float>(x), static_cast<float>(y), 0.0f},
+				  .texcoord = {},
+				  .normal = {0.0f, 0.0f, 1.0f},
+				  .tangent = {}
+			  };
+		  })
+		| std::ranges::to<std::vector>();
+
+	std::vector<uint32_t> indices;
+	const auto quads =
+		std::views::cartesian_product(std::views::iota(0_u32, grid_size), std::views::iota(0_u32, grid_size));
+	for (const auto [y, x] : quads)
+	{
+		const auto v00 = y * (grid_size + 1) + x;
+		const auto v01 = v00 + 1;
+		const auto v10 = v00 + grid_size + 1;
+		const auto v11 = v10 + 1;
+		indices.append_range(std::to_array({v00, v01, v11, v00, v11, v10}));
+	}
+
+	auto geometry_result = model::Geometry::create(vertices, indices);
+	EXPECT_SUCCESS(geometry_result);
+	const auto geometry = std::move(*geometry_result);
+
+	REQUIRE_GT(geometry.meshlets.size(), 1zu);
+
+	// Collect triangles referenced by meshlets, sorted per-triangle to ignore winding rotation
+	const auto sort_triangle = [](std::array<uint32_t, 3> triangle) {
+		std::ranges::sort(triangle);
+		return triangle;
+	};
+
+	std::vector<std::array<uint32_t, 3>> meshlet_triangles;
+	for (const auto& meshlet : geometry.meshlets)
+	{
+		CHECK_LE(meshlet.vertex_count, model::Meshlet::MAX_VERTICES);
+		CHECK_LE(meshlet.triangle_count, model::Meshlet::MAX_TRIANGLES);
+		CHECK_LT(meshlet.cone_cutoff, 1.0f);  // Flat grid, normal cone should be valid
+
+		for (const auto triangle_idx : std::views::iota(0_u32, meshlet.triangle_count))
+		{
+			const auto triangle = geometry.meshlet_triangles[meshlet.triangle_offset + triangle_idx];
+			REQUIRE_LT(triangle.x, meshlet.vertex_count);
+			REQUIRE_LT(triangle.y, meshlet.vertex_count);
+			REQUIRE_LT(triangle.z, meshlet.vertex_count);
+
+			const auto local_vertices = std::span(geometry.meshlet_vertices).subspan(meshlet.vertex_offset);
+			meshlet_triangles.push_back(sort_triangle({
+				local_vertices[triangle.x],
+				local_vertices[triangle.y],
+				local_vertices[triangle.z],
+			}));
+		}
+	}
+
+	auto expected_triangles =
+		std::views::iota(0zu, indices.size() / 3)
+		| std::views::transform([&](size_t i) {
+			  return sort_triangle({indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]});
+		  })
+		| std::ranges::to<std::vector>();
+
+	std::ranges::sort(meshlet_triangles);
+	std::ranges::sort(expected_triangles);
+	CHECK_EQ(meshlet_triangles, expected_triangles);
 }
 
 TEST_CASE("Indices Expansion")
@@ -209,4 +317,323 @@ TEST_CASE("Indices Expansion")
 			CHECK_EQ(*result, std::vector<uint32_t>{1, 2, 0, 2, 3, 0});
 		}
 	}
+
+	SUBCASE("Scratch vertices")
+	{
+		auto arena = util::ImportArena();
+		const auto vertices =
+			std::vector<glm::vec3>{{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+
+		SUBCASE("Invalid input")
+		{
+			const auto indices = std::vector<uint32_t>{0, 3};
+			EXPECT_FAIL(model::util::expand_indices<glm::vec3>(indices, vertices, arena));
+		}
+
+		SUBCASE("Valid input")
+		{
+			const auto indices = std::vector<uint32_t>{2, 0, 1, 1};
+			auto result = model::util::expand_indices<glm::vec3>(indices, vertices, arena);
+			EXPECT_SUCCESS(result);
+			REQUIRE_EQ(result->size(), 4);
+			CHECK_EQ(result->get_allocator().resource(), &arena);
+
+			for (const auto [index, vertex] : std::views::zip(indices, *result))
+				CHECK_EQ(vertex, vertices[index]);
+		}
+	}
+}
+
+TEST_CASE("Vertex Welding")
+{
+	// Quad with texcoords matching the XY position
+	const auto get_corner = [](float x, float y, float z) {
+		return model::MinimumVertex{.position = {x, y, z}, .texcoord = {x, y}};
+	};
+
+	const auto expand_triangle = [](const std::array<model::MinimumVertex, 3>& triangle) {
+		return model::NormalOnlyVertex::construct_tangent(model::MinimumVertex::construct_normal(triangle));
+	};
+
+	SUBCASE("Coplanar triangles")
+	{
+		const auto triangles = std::to_array({
+			expand_triangle({get_corner(0, 0, 0), get_corner(1, 0, 0), get_corner(1, 1, 0)}),
+			expand_triangle({get_corner(0, 0, 0), get_corner(1, 1, 0), get_corner(0, 1, 0)})
+		});
+		const auto vertices = triangles | std::views::join | std::ranges::to<std::vector>();
+		const auto indices = std::vector(std::from_range, std::views::iota(0_u32, 6_u32));
+
+		const auto [welded_vertices, welded_indices] = model::util::weld_vertices(vertices, indices);
+
+		// Shared corners of the diagonal are welded
+		CHECK_EQ(welded_vertices.size(), 4);
+		REQUIRE_EQ(welded_indices.size(), 6);
+		CHECK_EQ(welded_indices[0], welded_indices[3]);
+		CHECK_EQ(welded_indices[2], welded_indices[4]);
+
+		for (const auto [index, welded_index] : welded_indices | std::views::enumerate)
+			CHECK_EQ(welded_vertices[welded_index].position, vertices[index].position);
+	}
+
+	SUBCASE("Folded triangles")
+	{
+		const auto triangles = std::to_array({
+			expand_triangle({get_corner(0, 0, 0), get_corner(1, 0, 0), get_corner(1, 1, 0)}),
+			expand_triangle({get_corner(0, 0, 0), get_corner(1, 1, 0), get_corner(0, 1, 1)})
+		});
+		const auto vertices = triangles | std::views::join | std::ranges::to<std::vector>();
+		const auto indices = std::vector(std::from_range, std::views::iota(0_u32, 6_u32));
+
+		// Flat normals differ across the fold, no vertex can be welded
+		const auto [welded_vertices, welded_indices] = model::util::weld_vertices(vertices, indices);
+		CHECK_EQ(welded_vertices.size(), 6);
+	}
+}
+
+TEST_CASE("Smooth Tangent Generation")
+{
+	const auto get_quad = [](float texcoord_sign) {
+		return std::views::cartesian_product(std::to_array({0.0f, 1.0f}), std::to_array({0.0f, 1.0f}))
+			| std::views::transform([texcoord_sign](const auto& corner) {
+				   const auto [y, x] = corner;
+				   return model::NormalOnlyVertex{
+					   .position = {x, y, 0.0f},
+					   .texcoord = {texcoord_sign * x, y},
+					   .normal = {0.0f, 0.0f, 1.0f}
+				   };
+			   })
+			| std::ranges::to<std::vector>();
+	};
+	const auto indices = std::vector<uint32_t>{0, 1, 3, 0, 3, 2};
+
+	SUBCASE("Right-handed")
+	{
+		auto result = model::util::generate_tangents(get_quad(1.0f), indices);
+		EXPECT_SUCCESS(result);
+		REQUIRE_EQ(result->size(), 4);
+
+		const auto expected_tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+		for (const auto& vertex : *result)
+		{
+			CHECK(glm::all(glm::epsilonEqual(glm::vec3(vertex.tangent), expected_tangent, 0.0001f)));
+			CHECK_EQ(vertex.tangent.w, 1.0f);
+		}
+	}
+
+	SUBCASE("Mirrored texcoords")
+	{
+		auto result = model::util::generate_tangents(get_quad(-1.0f), indices);
+		EXPECT_SUCCESS(result);
+		REQUIRE_EQ(result->size(), 4);
+
+		const auto expected_tangent = glm::vec3(-1.0f, 0.0f, 0.0f);
+		for (const auto& vertex : *result)
+		{
+			CHECK(glm::all(glm::epsilonEqual(glm::vec3(vertex.tangent), expected_tangent, 0.0001f)));
+			CHECK_EQ(vertex.tangent.w, -1.0f);
+		}
+	}
+
+	SUBCASE("Invalid indices")
+	{
+		EXPECT_FAIL(model::util::generate_tangents(get_quad(1.0f), std::vector<uint32_t>{0, 1, 4}));
+		EXPECT_FAIL(model::util::generate_tangents(get_quad(1.0f), std::vector<uint32_t>{0, 1}));
+	}
+}
+
+TEST_CASE("Vertex Packing")
+{
+	const auto aabb_min = glm::vec3(-2.0f, 0.0f, 5.0f);
+	const auto aabb_max = glm::vec3(2.0f, 10.0f, 5.0f);  // Degenerated on Z
+
+	const auto directions = std::to_array<glm::vec3>({
+		{0.0f, 0.0f, 1.0f},
+		{0.0f, 0.0f, -1.0f},
+		{1.0f, 0.0f, 0.0f},
+		{-0.6f, 0.0f, -0.8f},
+		{0.48f, -0.6f, 0.64f},
+	});
+
+	for (const auto& [index, direction] : directions | std::views::enumerate)
+	{
+		const auto vertex = model::FullVertex{
+			.position = glm::mix(aabb_min, aabb_max, static_cast<float>(index) / 4.0f),
+			.texcoord = {0.25f * static_cast<float>(index), -1.5f},
+			.normal = direction,
+			.tangent = glm::vec4(-direction, index % 2 == 0 ? 1.0f : -1.0f)
+		};
+
+		const auto packed = model::PackedVertex::pack(vertex, aabb_min, aabb_max);
+		const auto unpacked = packed.unpack(aabb_min, aabb_max);
+
+		CHECK(glm::all(glm::epsilonEqual(unpacked.position, vertex.position, 0.001f)));
+		CHECK(glm::all(glm::epsilonEqual(unpacked.texcoord, vertex.texcoord, 0.001f)));
+		CHECK(glm::all(glm::epsilonEqual(unpacked.normal, vertex.normal, 0.001f)));
+		CHECK(glm::all(glm::epsilonEqual(glm::vec3(unpacked.tangent), glm::vec3(vertex.tangent), 0.001f)));
+		CHECK(unpacked.tangent.w == vertex.tangent.w);
+	}
+}
+
+TEST_CASE("Geometry Optimization")
+{
+	constexpr uint32_t grid_size = 8;
+
+	auto vertices =
+		std::views::cartesian_product(
+			std::views::iota(0_u32, grid_size + 1),
+			std::views::iota(0_u32, grid_size + 1)
+		)
+		| std::views::transform([](const auto& coord) {
+			  const auto [y, x] = coord;
+			  return model::FullVertex{
+				  .position = {static_cast<float>(x), static_cast<float>(y), 0.0f},
+				  .texcoord = {},
+				  .normal = {0.0f, 0.0f, 1.0f},
+				  .tangent = {}
+			  };
+		  })
+		| std::ranges::to<std::vector>();
+	const auto referenced_vertex_count = vertices.size();
+
+	// Unreferenced vertex, should be removed
+	vertices.push_back({.position = {-1.0f, -1.0f, -1.0f}, .texcoord = {}, .normal = {}, .tangent = {}});
+
+	// Column-major quad order, unfriendly to the vertex cache
+	std::vector<uint32_t> indices;
+	const auto quads =
+		std::views::cartesian_product(std::views::iota(0_u32, grid_size), std::views::iota(0_u32, grid_size));
+	for (const auto [x, y] : quads)
+	{
+		const auto v00 = y * (grid_size + 1) + x;
+		const auto v01 = v00 + 1;
+		const auto v10 = v00 + grid_size + 1;
+		const auto v11 = v10 + 1;
+		indices.append_range(std::to_array({v00, v01, v11, v00, v11, v10}));
+	}
+
+	auto geometry_result = model::Geometry::create(vertices, indices);
+	EXPECT_SUCCESS(geometry_result);
+	const auto geometry = std::move(*geometry_result);
+	const auto optimized = geometry.optimize();
+
+	CHECK_EQ(optimized.vertices.size(), referenced_vertex_count);
+	CHECK_EQ(optimized.indices.size(), geometry.indices.size());
+	CHECK(glm::all(glm::epsilonEqual(optimized.aabb_min, geometry.aabb_min, 0.0001f)));
+	CHECK(glm::all(glm::epsilonEqual(optimized.aabb_max, geometry.aabb_max, 0.0001f)));
+	CHECK_FALSE(optimized.meshlets.empty());
+
+	// Triangles are compared by positions, as vertices are reordered
+	const auto collect_triangles = [](const model::Geometry& geometry) {
+		auto triangles =
+			std::views::iota(0zu, geometry.indices.size() / 3)
+			| std::views::transform([&geometry](size_t i) {
+				  auto triangle = std::to_array({
+					  geometry.vertices[geometry.indices[i * 3 + 0]].position,
+					  geometry.vertices[geometry.indices[i * 3 + 1]].position,
+					  geometry.vertices[geometry.indices[i * 3 + 2]].position,
+				  });
+				  const auto position_less = [](const glm::vec3& a, const glm::vec3& b) {
+					  return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+				  };
+				  std::ranges::sort(triangle, position_less);
+				  return std::to_array({
+					  triangle[0].x, triangle[0].y, triangle[0].z,
+					  triangle[1].x, triangle[1].y, triangle[1].z,
+					  triangle[2].x, triangle[2].y, triangle[2].z,
+				  });
+			  })
+			| std::ranges::to<std::vector>();
+		std::ranges::sort(triangles);
+		return triangles;
+	};
+
+	CHECK_EQ(collect_triangles(optimized), collect_triangles(geometry));
+}
+
+TEST_CASE("Geometry Simplification")
+{
+	constexpr uint32_t grid_size = 32;
+
+	// Planar grid, can be simplified without error
+	const auto vertices =
+		std::views::cartesian_product(
+			std::views::iota(0_u32, grid_size + 1),
+			std::views::iota(0_u32, grid_size + 1)
+		)
+		| std::views::transform([](const auto& coord) {
+			  const auto [y, x] = coord;
+			  return model::FullVertex{
+				  .position = {static_cast<float>(x), static_cast<float>(y), 0.0f},
+				  .texcoord = {},
+				  .normal = {0.0f, 0.0f, 1.0f},
+				  .tangent = {}
+			  };
+		  })
+		| std::ranges::to<std::vector>();
+
+	std::vector<uint32_t> indices;
+	const auto quads =
+		std::views::cartesian_product(std::views::iota(0_u32, grid_size), std::views::iota(0_u32, grid_size));
+	for (const auto [y, x] : quads)
+	{
+		const auto v00 = y * (grid_size + 1) + x;
+		const auto v01 = v00 + 1;
+		const auto v10 = v00 + grid_size + 1;
+		const auto v11 = v10 + 1;
+		indices.append_range(std::to_array({v00, v01, v11, v00, v11, v10}));
+	}
+
+	auto geometry_result = model::Geometry::create(vertices, indices);
+	EXPECT_SUCCESS(geometry_result);
+	const auto geometry = std::move(*geometry_result);
+
+	SUBCASE("LOD chain")
+	{
+		const auto option = model::Geometry::SimplifyOption{};
+		const auto lods = geometry.simplify(option);
+
+		REQUIRE_FALSE(lods.empty());
+		CHECK_LE(lods.size(), option.max_levels);
+
+		auto prev_index_count = geometry.indices.size();
+		auto prev_error = 0.0f;
+		for (const auto& lod : lods)
+		{
+			CHECK_EQ(lod.indices.size() % 3, 0);
+			CHECK_LT(lod.indices.size(), prev_index_count);
+			CHECK_GE(lod.error, prev_error);
+			CHECK_LE(lod.error, option.max_error);
+			CHECK(std::ranges::all_of(lod.indices, [&geometry](uint32_t index) {
+				return index < geometry.vertices.size();
+			}));
+
+			prev_index_count = lod.indices.size();
+			prev_error = lod.error;
+		}
+	}
+
+	SUBCASE("Level limit")
+	{
+		const auto lods = geometry.simplify({.max_levels = 1});
+		CHECK_EQ(lods.size(), 1);
+	}
+
+	SUBCASE("Sloppy")
+	{
+		const auto lods = geometry.simplify(
+			{.max_levels = 1, .index_ratio = 0.1f, .max_error = 1.0f, .min_reduction = 1.0f, .sloppy = true}
+		);
+		REQUIRE_EQ(lods.size(), 1);
+		CHECK_EQ(lods[0].indices.size() % 3, 0);
+		CHECK_LE(lods[0].indices.size(), geometry.indices.size() / 2);
+	}
+
+	SUBCASE("Single triangle")
+	{
+		const auto triangle_indices = std::to_array<uint32_t>({0, 1, grid_size + 2});
+		auto triangle_result = model::Geometry::create(vertices, triangle_indices);
+		EXPECT_SUCCESS(triangle_result);
+		CHECK(triangle_result->simplify({}).empty());
+	}
 }
@@ -2,15 +2,20 @@
 #include "common/number-literals.hpp"
 #include "common/test-macro.hpp"
 #include "common/util/error.hpp"
+#include "model/animation.hpp"
 #include "image/common.hpp"
 #include "image/image.hpp"
 #include "model/hierarchy.hpp"
+#include "model/light.hpp"
 #include "model/material.hpp"
 #include "model/mesh.hpp"
 #include "model/texture.hpp"
 
 #include <cstdint>
 #include <doctest.h>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <optional>
 #include <ranges>
 #include <utility>
 #include <vector>
@@ -49,8 +54,9 @@ TEST_CASE("Mesh material index OOB")
 	auto material_list = get_valid_material_list();
 
 	// OOB at index 1
-	auto invalid_mesh =
-		model::Mesh{.primitives = {model::Primitive{.geometry = get_valid_geometry(), .material_index = 1}}};
+	auto invalid_mesh = model::Mesh{
+		.primitives = {model::Primitive{.geometry = get_valid_geometry(), .lods = {}, .material_index = 1}}
+	};
 
 	const std::vector nodes = {
 		model::ParentOnlyNode{.parent_index = {}, .data = {}}
@@ -66,8 +72,9 @@ TEST_CASE("Node mesh index OOB")
 {
 	auto material_list = get_valid_material_list();
 	const auto valid_geometry = get_valid_geometry();
-	const auto valid_mesh =
-		model::Mesh{.primitives = {model::Primitive{.geometry = valid_geometry, .material_index = {}}}};
+	const auto valid_mesh = model::Mesh{
+		.primitives = {model::Primitive{.geometry = valid_geometry, .lods = {}, .material_index = {}}}
+	};
 
 	SUBCASE("Single node with OOB mesh index")
 	{
@@ -152,3 +159,270 @@ TEST_CASE("Node mesh index OOB")
 		EXPECT_FAIL(model_result);
 	}
 }
+
+TEST_CASE("Node light index OOB")
+{
+	auto material_list = get_valid_material_list();
+	const auto lights = std::vector{model::Light{.type = model::LightType::Point}};
+
+	SUBCASE("Valid light index")
+	{
+		const std::vector nodes = {
+			model::ParentOnlyNode{.parent_index = {}, .data = {}                },
+			model::ParentOnlyNode{.parent_index = 0,  .data = {.light_index = 0}}
+		};
+		auto hierarchy = model::Hierarchy::create(nodes) | Error::unwrap();
+
+		auto model_result =
+			model::Model::assemble(std::move(material_list), {}, std::move(hierarchy), lights);
+		EXPECT_SUCCESS(model_result);
+	}
+
+	SUBCASE("OOB light index")
+	{
+		// Light index 1 is OOB, only 1 light exists
+		const std::vector nodes = {
+			model::ParentOnlyNode{.parent_index = {}, .data = {}                },
+			model::ParentOnlyNode{.parent_index = 0,  .data = {.light_index = 1}}
+		};
+		auto hierarchy = model::Hierarchy::create(nodes) | Error::unwrap();
+
+		auto model_result =
+			model::Model::assemble(std::move(material_list), {}, std::move(hierarchy), lights);
+		EXPECT_FAIL(model_result);
+	}
+}
+
+TEST_CASE("Skin validation")
+{
+	auto material_list = get_valid_material_list();
+
+	auto mesh = model::Mesh{
+		.primitives = {model::Primitive{.geometry = get_valid_geometry(), .lods = {}, .material_index = 0}}
+	};
+	mesh.primitives[0].deformation.skin = std::vector(
+		3,
+		model::VertexSkin{.joints = {0, 0, 0, 0}, .weights = {1.0f, 0.0f, 0.0f, 0.0f}}
+	);
+
+	const auto skin = model::Skin{.joints = {1}, .inverse_bind_matrices = {glm::mat4(1.0f)}};
+
+	const std::vector nodes = {
+		model::ParentOnlyNode{.parent_index = {}, .data = {.mesh_index = 0, .skin_index = 0}},
+		model::ParentOnlyNode{.parent_index = 0,  .data = {}                               }
+	};
+	auto hierarchy = model::Hierarchy::create(nodes) | Error::unwrap();
+
+	SUBCASE("Valid skin")
+	{
+		auto model_result =
+			model::Model::assemble(std::move(material_list), {mesh}, std::move(hierarchy), {}, {skin});
+		EXPECT_SUCCESS(model_result);
+	}
+
+	SUBCASE("OOB skin index")
+	{
+		auto model_result = model::Model::assemble(std::move(material_list), {mesh}, std::move(hierarchy));
+		EXPECT_FAIL(model_result);
+	}
+
+	SUBCASE("OOB joint node")
+	{
+		const auto invalid_skin = model::Skin{.joints = {2}, .inverse_bind_matrices = {glm::mat4(1.0f)}};
+		auto model_result = model::Model::assemble(
+			std::move(material_list),
+			{mesh},
+			std::move(hierarchy),
+			{},
+			{invalid_skin}
+		);
+		EXPECT_FAIL(model_result);
+	}
+
+	SUBCASE("Inverse bind matrix count mismatch")
+	{
+		const auto invalid_skin = model::Skin{.joints = {1}, .inverse_bind_matrices = {}};
+		auto model_result = model::Model::assemble(
+			std::move(material_list),
+			{mesh},
+			std::move(hierarchy),
+			{},
+			{invalid_skin}
+		);
+		EXPECT_FAIL(model_result);
+	}
+
+	SUBCASE("OOB vertex joint")
+	{
+		mesh.primitives[0].deformation.skin[1].joints = {1, 0, 0, 0};
+		auto model_result =
+			model::Model::assemble(std::move(material_list), {mesh}, std::move(hierarchy), {}, {skin});
+		EXPECT_FAIL(model_result);
+	}
+
+	SUBCASE("Skin size mismatch")
+	{
+		mesh.primitives[0].deformation.skin.pop_back();
+		auto model_result =
+			model::Model::assemble(std::move(material_list), {mesh}, std::move(hierarchy), {}, {skin});
+		EXPECT_FAIL(model_result);
+	}
+}
+
+TEST_CASE("Animation validation")
+{
+	auto material_list = get_valid_material_list();
+
+	const std::vector nodes = {
+		model::ParentOnlyNode{.parent_index = {}, .data = {}}
+	};
+	auto hierarchy = model::Hierarchy::create(nodes) | Error::unwrap();
+
+	auto channel = model::AnimationChannel{
+		.node_index = 0,
+		.path = model::AnimationChannel::Path::Scale,
+		.interpolation = model::AnimationChannel::Interpolation::Step,
+		.component_count = 3,
+		.times = {0.0f, 1.0f},
+		.values = {1.0f, 1.0f, 1.0f, 2.0f, 2.0f, 2.0f},
+	};
+
+	SUBCASE("Valid animation")
+	{
+		const auto animations = std::vector{model::Animation{.channels = {channel}}};
+		auto model_result =
+			model::Model::assemble(std::move(material_list), {}, std::move(hierarchy), {}, {}, animations);
+		EXPECT_SUCCESS(model_result);
+	}
+
+	SUBCASE("OOB animated node")
+	{
+		channel.node_index = 1;
+		const auto animations = std::vector{model::Animation{.channels = {channel}}};
+		auto model_result =
+			model::Model::assemble(std::move(material_list), {}, std::move(hierarchy), {}, {}, animations);
+		EXPECT_FAIL(model_result);
+	}
+
+	SUBCASE("Invalid keyframes")
+	{
+		channel.values.pop_back();
+		const auto animations = std::vector{model::Animation{.channels = {channel}}};
+		auto model_result =
+			model::Model::assemble(std::move(material_list), {}, std::move(hierarchy), {}, {}, animations);
+		EXPECT_FAIL(model_result);
+	}
+}
+
+TEST_CASE("HLOD validation")
+{
+	auto material_list = get_valid_material_list();
+	auto meshes = std::vector<model::Mesh>();
+	meshes.push_back(
+		model::Mesh{
+			.primitives = {
+				model::Primitive{.geometry = get_valid_geometry(), .lods = {}, .material_index = 0}
+			}
+		}
+	);
+
+	// Root with two source nodes and a proxy node
+	const std::vector nodes = {
+		model::ParentOnlyNode{.parent_index = {}, .data = {}},
+		model::ParentOnlyNode{.parent_index = 0, .data = {.mesh_index = 0}},
+		model::ParentOnlyNode{.parent_index = 0, .data = {.mesh_index = 0}},
+		model::ParentOnlyNode{.parent_index = 0, .data = {.mesh_index = 0}}
+	};
+	auto hierarchy = model::Hierarchy::create(nodes) | Error::unwrap();
+
+	auto hlod = model::HlodList{
+		.clusters = {
+			model::HlodCluster{
+				.proxy_node_index = 3,
+				.source_offset = 0,
+				.source_count = 2,
+				.aabb_min = glm::vec3(0.0f),
+				.aabb_max = glm::vec3(1.0f),
+			}
+		},
+		.source_nodes = {1, 2},
+	};
+
+	SUBCASE("Valid HLOD") {}
+
+	SUBCASE("Proxy without mesh")
+	{
+		hlod.clusters[0].proxy_node_index = 0;
+	}
+
+	SUBCASE("OOB source range")
+	{
+		hlod.clusters[0].source_count = 3;
+	}
+
+	SUBCASE("Proxy as source")
+	{
+		hlod.source_nodes[1] = 3;
+	}
+
+	SUBCASE("Source of two clusters")
+	{
+		hlod.clusters.push_back(hlod.clusters[0]);
+		hlod.clusters[1].source_count = 1;
+	}
+
+	const bool valid = hlod.clusters.size() == 1
+		&& hlod.clusters[0].proxy_node_index == 3
+		&& hlod.clusters[0].source_count == 2
+		&& hlod.source_nodes[1] == 2;
+
+	auto model_result = model::Model::assemble(
+		std::move(material_list),
+		std::move(meshes),
+		std::move(hierarchy),
+		{},
+		{},
+		{},
+		std::move(hlod)
+	);
+	CHECK_EQ(model_result.has_value(), valid);
+}
+
+TEST_CASE("Material deduplication")
+{
+	const auto texture = std::vector<model::Texture>(
+		1,
+		model::Texture{
+			.source = image::Image<image::Format::Unorm8, image::Layout::RGBA>({1, 1}, {255, 255, 255, 255})
+		}
+	);
+
+	const auto plain = model::Material{};
+	const auto textured = model::Material{.texture_set = {.albedo = 0}};
+	auto material_list = model::MaterialList::create(texture, {plain, textured, plain}) | Error::unwrap();
+
+	const auto geometry = get_valid_geometry();
+	const auto mesh = model::Mesh{
+		.primitives = {
+			model::Primitive{.geometry = geometry, .lods = {}, .material_index = 2},
+			model::Primitive{.geometry = geometry, .lods = {}, .material_index = 1},
+			model::Primitive{.geometry = geometry, .lods = {}, .material_index = {}},
+		}
+	};
+
+	const std::vector nodes = {
+		model::ParentOnlyNode{.parent_index = {}, .data = {.mesh_index = 0}}
+	};
+	auto hierarchy = model::Hierarchy::create(nodes) | Error::unwrap();
+
+	auto model_result = model::Model::assemble(std::move(material_list), {mesh}, std::move(hierarchy));
+	EXPECT_SUCCESS(model_result);
+
+	const auto deduplicated = model::deduplicate_materials(std::move(*model_result));
+
+	CHECK_EQ(deduplicated.material_list.materials.size(), 2);
+	const auto& primitives = deduplicated.meshes[0].primitives;
+	CHECK_EQ(primitives[0].material_index, 0);
+	CHECK_EQ(primitives[1].material_index, 1);
+	CHECK_EQ(primitives[2].material_index, std::nullopt);
+}
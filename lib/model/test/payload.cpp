@@ -0,0 +1,117 @@
+#include "model/payload.hpp"
+#include "common/test-macro.hpp"
+#include "model/mesh.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <ranges>
+#include <span>
+#include <vector>
+
+// Grid of vertices in a row-major order, smooth enough for the vertex codec to compress well
+static std::vector<model::FullVertex> get_grid_vertices(uint32_t size) noexcept
+{
+	std::vector<model::FullVertex> vertices;
+	const auto axis = std::views::iota(0u, size);
+	for (const auto [y, x] : std::views::cartesian_product(axis, axis))
+	{
+		vertices.push_back({
+			.position = {float(x), float(y), 0.0f},
+			.texcoord = {float(x) / float(size), float(y) / float(size)},
+			.normal = {0.0f, 0.0f, 1.0f},
+			.tangent = {1.0f, 0.0f, 0.0f, 1.0f},
+		});
+	}
+	return vertices;
+}
+
+TEST_CASE("Vertex payload round trip")
+{
+	// Spans multiple chunks
+	const auto vertices = get_grid_vertices(256);
+	const auto data = std::as_bytes(std::span(vertices));
+	REQUIRE_GT(data.size(), model::PAYLOAD_CHUNK_SIZE);
+
+	const auto encoded = model::encode_payload(data, model::PayloadCodec::Vertex, sizeof(model::FullVertex));
+	REQUIRE(encoded.has_value());
+	CHECK_LT(encoded->size(), data.size());
+
+	auto decoded = std::vector<std::byte>(data.size());
+	const auto payload = model::Payload{
+		.codec = model::PayloadCodec::Vertex,
+		.stride = sizeof(model::FullVertex),
+		.encoded = *encoded,
+		.decoded = decoded
+	};
+	const auto result = model::decode_payloads({&payload, 1});
+	EXPECT_SUCCESS(result);
+	CHECK(std::ranges::equal(decoded, data));
+}
+
+TEST_CASE("Index payload round trip")
+{
+	auto indices = std::vector<uint16_t>();
+	for (const auto quad : std::views::iota(0u, 4096u))
+		for (const auto corner : {0u, 1u, 2u, 2u, 1u, 3u})
+			indices.push_back(static_cast<uint16_t>(quad + corner));
+	const auto data = std::as_bytes(std::span(indices));
+
+	const auto encoded = model::encode_payload(data, model::PayloadCodec::IndexSequence, sizeof(uint16_t));
+	REQUIRE(encoded.has_value());
+	CHECK_LT(encoded->size(), data.size());
+
+	auto decoded = std::vector<std::byte>(data.size());
+	const auto payload = model::Payload{
+		.codec = model::PayloadCodec::IndexSequence,
+		.stride = sizeof(uint16_t),
+		.encoded = *encoded,
+		.decoded = decoded
+	};
+	const auto result = model::decode_payloads({&payload, 1});
+	EXPECT_SUCCESS(result);
+	CHECK(std::ranges::equal(decoded, data));
+}
+
+TEST_CASE("Incompressible payload")
+{
+	// Too small to amortize the chunk table
+	const auto data = std::vector<std::byte>(16, std::byte(0x5A));
+	CHECK_FALSE(model::encode_payload(data, model::PayloadCodec::Vertex, 16).has_value());
+	CHECK_FALSE(model::encode_payload(data, model::PayloadCodec::Vertex, 6).has_value());
+}
+
+TEST_CASE("Malformed payload")
+{
+	const auto vertices = get_grid_vertices(16);
+	const auto data = std::as_bytes(std::span(vertices));
+	const auto encoded = model::encode_payload(data, model::PayloadCodec::Vertex, sizeof(model::FullVertex));
+	REQUIRE(encoded.has_value());
+
+	auto decoded = std::vector<std::byte>(data.size());
+
+	SUBCASE("Truncated")
+	{
+		const auto payload = model::Payload{
+			.codec = model::PayloadCodec::Vertex,
+			.stride = sizeof(model::FullVertex),
+			.encoded = std::span(*encoded).first(encoded->size() / 2),
+			.decoded = decoded
+		};
+		const auto result = model::decode_payloads({&payload, 1});
+		EXPECT_FAIL(result);
+	}
+
+	SUBCASE("Wrong codec")
+	{
+		const auto payload = model::Payload{
+			.codec = model::PayloadCodec::IndexSequence,
+			.stride = sizeof(uint32_t),
+			.encoded = *encoded,
+			.decoded = decoded
+		};
+		const auto result = model::decode_payloads({&payload, 1});
+		EXPECT_FAIL(result);
+	}
+}
@@ -0,0 +1,103 @@
+#include "model/synthetic.hpp"
+#include "common/test-macro.hpp"
+#include "model/material.hpp"
+#include "model/mesh.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <doctest.h>
+#include <ranges>
+
+TEST_CASE("Synthetic model counts")
+{
+	const auto option = model::SyntheticOption{
+		.node_count = 100,
+		.instances_per_mesh = 8,
+		.primitives_per_mesh = 3,
+		.triangles_per_primitive = 37,
+		.material_count = 10,
+		.texture_count = 4,
+		.texture_size = 16,
+		.alpha_mask_ratio = 0.3f,
+	};
+
+	const auto model_result = model::synthetic(option);
+	EXPECT_SUCCESS(model_result);
+	const auto& model = *model_result;
+
+	// Root node is not renderable
+	CHECK_EQ(model.hierarchy.get_nodes().size(), 101);
+	CHECK_EQ(model.hierarchy.get_renderables().size(), 100);
+
+	REQUIRE_EQ(model.meshes.size(), 13);
+	for (const auto& mesh : model.meshes)
+	{
+		REQUIRE_EQ(mesh.primitives.size(), 3);
+		for (const auto& primitive : mesh.primitives)
+		{
+			CHECK_EQ(primitive.geometry.indices.size(), 37 * 3);
+			REQUIRE(primitive.material_index.has_value());
+			CHECK_LT(*primitive.material_index, 10);
+		}
+	}
+
+	CHECK_EQ(model.material_list.textures.size(), 4);
+	REQUIRE_EQ(model.material_list.materials.size(), 10);
+
+	const auto mask_count = std::ranges::count_if(model.material_list.materials, [](const auto& material) {
+		return material.mode.alpha_mode == model::AlphaMode::Mask;
+	});
+	CHECK_EQ(mask_count, 3);
+}
+
+TEST_CASE("Synthetic model is deterministic")
+{
+	const auto option = model::SyntheticOption{.node_count = 16, .triangles_per_primitive = 8, .seed = 42};
+
+	const auto first_result = model::synthetic(option);
+	const auto second_result = model::synthetic(option);
+	EXPECT_SUCCESS(first_result);
+	EXPECT_SUCCESS(second_result);
+
+	for (const auto& [first_mesh, second_mesh] : std::views::zip(first_result->meshes, second_result->meshes))
+	{
+		const auto& first_geometry = first_mesh.primitives[0].geometry;
+		const auto& second_geometry = second_mesh.primitives[0].geometry;
+
+		REQUIRE_EQ(first_geometry.vertices.size(), second_geometry.vertices.size());
+		for (const auto& [first, second] : std::views::zip(first_geometry.vertices, second_geometry.vertices))
+			CHECK_VEC3_EQ_ALT(first.position, second.position);
+
+		CHECK_EQ(first_mesh.primitives[0].material_index, second_mesh.primitives[0].material_index);
+	}
+}
+
+TEST_CASE("Synthetic model without materials")
+{
+	const auto model_result = model::synthetic({.node_count = 4, .material_count = 0});
+	EXPECT_SUCCESS(model_result);
+
+	for (const auto& mesh : model_result->meshes)
+		for (const auto& primitive : mesh.primitives) CHECK_FALSE(primitive.material_index.has_value());
+}
+
+TEST_CASE("Synthetic model with invalid option")
+{
+	SUBCASE("No instance per mesh")
+	{
+		const auto model_result = model::synthetic({.instances_per_mesh = 0});
+		EXPECT_FAIL(model_result);
+	}
+
+	SUBCASE("No triangle per primitive")
+	{
+		const auto model_result = model::synthetic({.triangles_per_primitive = 0});
+		EXPECT_FAIL(model_result);
+	}
+
+	SUBCASE("Alpha mask ratio out of range")
+	{
+		const auto model_result = model::synthetic({.alpha_mask_ratio = 1.5f});
+		EXPECT_FAIL(model_result);
+	}
+}
@@ -10,7 +10,10 @@
 #include <cstdint>
 #include <doctest.h>
 #include <filesystem>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <memory>
 #include <ranges>
+#include <span>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -61,6 +64,48 @@ TEST_CASE("From Encoded Data")
 	CHECK_VEC4_EQ(pixel, 255, 255, 255, 255);
 }
 
+TEST_CASE("From Shared Data")
+{
+	// Embed the image in a larger storage, as images in a glTF buffer are
+	auto storage = std::make_shared<std::vector<std::byte>>(16, std::byte{0xCD});
+	storage->insert_range(storage->begin() + 8, util::as_bytes(test_bmp));
+	const auto data = std::span<const std::byte>(*storage).subspan(8, test_bmp.size());
+
+	const auto texture = model::Texture{.source = model::Texture::SharedData{.owner = storage, .data = data}};
+	storage.reset();
+
+	auto load_result = texture.load_8bit();
+	EXPECT_SUCCESS(load_result);
+	REQUIRE_VEC2_EQ(load_result->size, 1, 1);
+	CHECK_VEC4_EQ(load_result->data[0], 255, 255, 255, 255);
+
+	const auto shared_hash = texture.hash_source();
+	const auto data_hash =
+		model::Texture{.source = std::vector<std::byte>(std::from_range, util::as_bytes(test_bmp))}
+			.hash_source();
+	EXPECT_SUCCESS(shared_hash);
+	EXPECT_SUCCESS(data_hash);
+	CHECK(*shared_hash == *data_hash);
+}
+
+TEST_CASE("Detach Shared Data")
+{
+	auto storage = std::make_shared<std::vector<std::byte>>(std::from_range, util::as_bytes(test_bmp));
+	const auto data = std::span<const std::byte>(*storage);
+
+	auto texture = model::Texture{.source = model::Texture::SharedData{.owner = storage, .data = data}};
+	texture.detach_source();
+
+	REQUIRE(std::holds_alternative<std::vector<std::byte>>(texture.source));
+	CHECK(storage.use_count() == 1);
+	storage.reset();
+
+	auto load_result = texture.load_8bit();
+	EXPECT_SUCCESS(load_result);
+	REQUIRE_VEC2_EQ(load_result->size, 1, 1);
+	CHECK_VEC4_EQ(load_result->data[0], 255, 255, 255, 255);
+}
+
 TEST_CASE("From Raw RGBA8 Image")
 {
 	const image::Image<image::Format::Unorm8, image::Layout::RGBA> raw_image(
@@ -160,3 +205,51 @@ TEST_CASE("From Raw RGBA16 Image")
 		CHECK_VEC4_EQ(pixel, 0x1234, 0x1234, 0x1234, 0x1234);
 	}
 }
+
+TEST_CASE("Hash Source")
+{
+	const auto temp_file = std::filesystem::temp_directory_path() / "test_texture_hash.bmp";
+	EXPECT_SUCCESS(file::write(temp_file, util::as_bytes(test_bmp)));
+
+	const auto encoded_data = std::vector<std::byte>(std::from_range, util::as_bytes(test_bmp));
+	const auto raw_image = image::Image<image::Format::Unorm8, image::Layout::RGBA>({1, 1}, {1, 2, 3, 4});
+
+	const auto file_hash = model::Texture{.source = temp_file}.hash_source();
+	const auto data_hash = model::Texture{.source = encoded_data}.hash_source();
+	const auto flipped_hash = model::Texture{.source = encoded_data, .flip_y = true}.hash_source();
+	const auto image_hash = model::Texture{.source = raw_image}.hash_source();
+	EXPECT_SUCCESS(file_hash);
+	EXPECT_SUCCESS(data_hash);
+	EXPECT_SUCCESS(flipped_hash);
+	EXPECT_SUCCESS(image_hash);
+
+	CHECK(*file_hash == *data_hash);
+	CHECK(*flipped_hash == *data_hash);
+	CHECK(*image_hash != *data_hash);
+
+	SUBCASE("Different Content")
+	{
+		auto modified_data = encoded_data;
+		modified_data.back() = std::byte{0x01};
+
+		const auto modified_hash = model::Texture{.source = modified_data}.hash_source();
+		EXPECT_SUCCESS(modified_hash);
+		CHECK(*modified_hash != *data_hash);
+	}
+
+	SUBCASE("Different Pixel Format")
+	{
+		const auto raw_image_16bit = raw_image.map([](glm::u8vec4 pixel) { return glm::u16vec4(pixel); });
+
+		const auto image_16bit_hash = model::Texture{.source = raw_image_16bit}.hash_source();
+		EXPECT_SUCCESS(image_16bit_hash);
+		CHECK(*image_16bit_hash != *image_hash);
+	}
+
+	SUBCASE("Missing File")
+	{
+		const auto missing_hash =
+			model::Texture{.source = std::filesystem::path("nonexistent_texture.bmp")}.hash_source();
+		EXPECT_FAIL(missing_hash);
+	}
+}
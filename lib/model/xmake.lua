@@ -21,4 +21,13 @@ target("lib.model.test")
 
 	for _, testfile in ipairs(os.files("test/*.cpp")) do
 		add_tests(path.basename(testfile), {files = {testfile}})
-	end
\ No newline at end of file
+	end
+
+-- Throughput benchmark of hierarchy traversal and geometry processing, on synthetic scenes
+target("lib.model.bench")
+	set_kind("binary")
+	set_default(false)
+
+	add_files("bench/*.cpp")
+	add_deps("lib.model")
+	add_packages("nanobench")
\ No newline at end of file
@@ -151,6 +151,76 @@ namespace scene::camera
 		///
 		[[nodiscard]]
 		glm::dmat4 matrix(double aspect_ratio) const noexcept;
+
+		///
+		/// @brief Calculate the projection matrix of a sub-rectangle of the viewport, e.g. a tile of an image
+		/// too large to render at once
+		/// @details The sub-rectangle is stretched over the whole NDC range, so that rendering each tile of a
+		/// grid with its sub-projection and stitching the results reproduces the full projection
+		///
+		/// @param aspect_ratio Aspect ratio of the full viewport, which is `width / height`
+		/// @param ndc_min Lower corner of the sub-rectangle in NDC of the full viewport
+		/// @param ndc_max Upper corner of the sub-rectangle in NDC of the full viewport
+		/// @return Calculated projection matrix of the sub-rectangle
+		///
+		[[nodiscard]]
+		glm::dmat4 sub_matrix(double aspect_ratio, glm::dvec2 ndc_min, glm::dvec2 ndc_max) const noexcept;
+	};
+
+	///
+	/// @brief Stereo camera rig, offsetting the two eyes of a center view horizontally
+	/// @details
+	/// Both eyes share the projection of the center view. The drawcalls of a multiview pass are culled once
+	/// against `cull_view` and `cull_projection`, whose frustum is pulled back behind the center so that it
+	/// encloses the frusta of both eyes.
+	///
+	struct StereoRig
+	{
+		enum class Eye
+		{
+			Left,
+			Right
+		};
+
+		double eye_separation;  // Distance between the eyes in world units
+
+		///
+		/// @brief Calculate the view matrix of an eye
+		///
+		/// @param center_view View matrix of the center between the eyes
+		/// @param eye Eye to calculate
+		/// @return View matrix of the eye
+		///
+		[[nodiscard]]
+		glm::dmat4 eye_view(const glm::dmat4& center_view, Eye eye) const noexcept;
+
+		///
+		/// @brief Calculate the view matrix to cull both eyes at once
+		///
+		/// @param center_view View matrix of the center between the eyes
+		/// @param projection Projection shared by both eyes
+		/// @param aspect_ratio Aspect ratio of the viewport of each eye, which is `width / height`
+		/// @return View matrix of the culling frustum
+		///
+		[[nodiscard]]
+		glm::dmat4 cull_view(
+			const glm::dmat4& center_view,
+			const PerspectiveProjection& projection,
+			double aspect_ratio
+		) const noexcept;
+
+		///
+		/// @brief Calculate the projection to cull both eyes at once, used with `cull_view`
+		///
+		/// @param projection Projection shared by both eyes
+		/// @param aspect_ratio Aspect ratio of the viewport of each eye, which is `width / height`
+		/// @return Projection of the culling frustum, with the far plane moved back by the pull-back distance
+		///
+		[[nodiscard]]
+		PerspectiveProjection cull_projection(
+			const PerspectiveProjection& projection,
+			double aspect_ratio
+		) const noexcept;
 	};
 
 	///
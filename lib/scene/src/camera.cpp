@@ -137,6 +137,68 @@ namespace scene::camera
 			return glm::infinitePerspective(glm::radians(fov_degrees), aspect_ratio, near);
 	}
 
+	glm::dmat4 PerspectiveProjection::sub_matrix(
+		double aspect_ratio,
+		glm::dvec2 ndc_min,
+		glm::dvec2 ndc_max
+	) const noexcept
+	{
+		const auto center = (ndc_min + ndc_max) * 0.5;
+		const auto half_size = (ndc_max - ndc_min) * 0.5;
+
+		// `ndc' = (ndc - center) / half_size`, applied in clip space before the perspective division
+		auto crop = glm::dmat4(1.0);
+		crop[0][0] = 1.0 / half_size.x;
+		crop[1][1] = 1.0 / half_size.y;
+		crop[3][0] = -center.x / half_size.x;
+		crop[3][1] = -center.y / half_size.y;
+
+		return crop * matrix(aspect_ratio);
+	}
+
+	glm::dmat4 StereoRig::eye_view(const glm::dmat4& center_view, Eye eye) const noexcept
+	{
+		// The left eye sits at negative X in view space, which moves the scene towards positive X
+		const auto offset = (eye == Eye::Left ? 0.5 : -0.5) * eye_separation;
+		return glm::translate(glm::dmat4(1.0), glm::dvec3(offset, 0.0, 0.0)) * center_view;
+	}
+
+	// Distance the culling frustum is pulled back behind the center, where the outer planes of both eyes meet
+	static double pull_back(
+		double eye_separation,
+		const PerspectiveProjection& projection,
+		double aspect_ratio
+	) noexcept
+	{
+		const auto tan_half_fov_x = std::tan(glm::radians(projection.fov_degrees) * 0.5) * aspect_ratio;
+		return 0.5 * eye_separation / tan_half_fov_x;
+	}
+
+	glm::dmat4 StereoRig::cull_view(
+		const glm::dmat4& center_view,
+		const PerspectiveProjection& projection,
+		double aspect_ratio
+	) const noexcept
+	{
+		// Views look towards negative Z, pulling back moves the scene towards negative Z
+		const auto distance = pull_back(eye_separation, projection, aspect_ratio);
+		return glm::translate(glm::dmat4(1.0), glm::dvec3(0.0, 0.0, -distance)) * center_view;
+	}
+
+	PerspectiveProjection StereoRig::cull_projection(
+		const PerspectiveProjection& projection,
+		double aspect_ratio
+	) const noexcept
+	{
+		// The near plane is kept, which only makes the frustum more conservative
+		const auto distance = pull_back(eye_separation, projection, aspect_ratio);
+		return PerspectiveProjection{
+			.fov_degrees = projection.fov_degrees,
+			.near = projection.near,
+			.far = projection.far.transform([distance](double far) { return far + distance; })
+		};
+	}
+
 	glm::dmat4 reverse_z(bool reverse) noexcept
 	{
 		if (reverse)
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "asset.hpp"
+#include "common/util/error.hpp"
+#include "model/animation.hpp"
+
+#include <expected>
+#include <fastgltf/types.hpp>
+#include <vector>
+
+namespace model::gltf::impl
+{
+	[[nodiscard]]
+	std::expected<Skin, Error> parse_skin(Asset& asset, const fastgltf::Skin& skin) noexcept;
+
+	[[nodiscard]]
+	std::expected<std::vector<Skin>, Error> parse_skins(Asset& asset) noexcept;
+
+	[[nodiscard]]
+	std::expected<Animation, Error> parse_animation(
+		Asset& asset,
+		const fastgltf::Animation& animation
+	) noexcept;
+
+	[[nodiscard]]
+	std::expected<std::vector<Animation>, Error> parse_animations(Asset& asset) noexcept;
+}
@@ -1,14 +1,17 @@
 #pragma once
 
 #include "buffer.hpp"
+#include "common/util/arena.hpp"
 #include "common/util/error.hpp"
 #include "file-cache.hpp"
+#include "model/texture.hpp"
 
 #include <cstddef>
 #include <expected>
 #include <fastgltf/types.hpp>
 #include <filesystem>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <span>
 #include <utility>
@@ -23,13 +26,26 @@ namespace model::gltf::impl
 		std::shared_ptr<FileCache> file_cache;
 		std::vector<Buffer> unified_buffers;
 
+		// Resource of the scratch buffers freed once the model is loaded, shared by the parsing tasks
+		std::pmr::memory_resource* scratch_resource;
+
+		// Decoded data of the buffer views compressed with `EXT_meshopt_compression`, indexed by buffer view.
+		// Filled by `decode_meshopt_views`, empty for uncompressed buffer views. Allocated from
+		// `scratch_resource`
+		std::vector<::util::ScratchVector<std::byte>> decoded_views;
+
+		// `input` is the parser input the asset was parsed from, its byte views share its owner. `file_cache`
+		// is the cache the input was mapped through, created if null
 		[[nodiscard]]
 		static std::expected<Asset, Error> create(
 			fastgltf::Asset asset,
-			std::optional<std::filesystem::path> directory = std::nullopt
+			const Texture::SharedData& input = {},
+			std::shared_ptr<FileCache> file_cache = nullptr,
+			std::optional<std::filesystem::path> directory = std::nullopt,
+			std::pmr::memory_resource& scratch_resource = *std::pmr::new_delete_resource()
 		) noexcept;
 
-		// Used in accessor tools
+		// Used in accessor tools, reads the decoded data of compressed buffer views
 		[[nodiscard]]
 		std::span<const std::byte> accessor_interface(
 			const fastgltf::Asset&,
@@ -42,13 +58,19 @@ namespace model::gltf::impl
 			fastgltf::Asset asset,
 			std::optional<std::filesystem::path> directory,
 			std::shared_ptr<FileCache> file_cache,
-			std::vector<Buffer> unified_buffers
+			std::vector<Buffer> unified_buffers,
+			std::pmr::memory_resource& scratch_resource
 		) :
 			fastgltf::Asset(std::move(asset)),
 			directory(std::move(directory)),
 			file_cache(std::move(file_cache)),
-			unified_buffers(std::move(unified_buffers))
-		{}
+			unified_buffers(std::move(unified_buffers)),
+			scratch_resource(&scratch_resource)
+		{
+			// Sharing the resource, decoded views are moved in without a copy
+			decoded_views.reserve(bufferViews.size());
+			for (size_t i = 0; i < bufferViews.size(); i++) decoded_views.emplace_back(&scratch_resource);
+		}
 
 	  public:
 
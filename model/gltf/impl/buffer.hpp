@@ -2,6 +2,7 @@
 
 #include "common/util/error.hpp"
 #include "file-cache.hpp"
+#include "model/texture.hpp"
 
 #include <cstddef>
 #include <expected>
@@ -33,10 +34,25 @@ namespace model::gltf::impl
 		[[nodiscard]]
 		std::expected<std::span<const std::byte>, Error> get_span(const fastgltf::BufferView& view) noexcept;
 
+		// Get a span of the buffer data for the given byte range.
+		// The span stays valid throughout lifetime of buffer
+		[[nodiscard]]
+		std::expected<std::span<const std::byte>, Error> get_span(
+			size_t byte_offset,
+			size_t byte_length
+		) noexcept;
+
+		// Get the buffer data for the given buffer view, sharing ownership of the underlying storage instead
+		// of copying it. Data not owned by the buffer (borrowed byte views) is copied once
+		[[nodiscard]]
+		std::expected<Texture::SharedData, Error> get_shared(const fastgltf::BufferView& view) noexcept;
+
+		// Byte views into @p input, e.g. the GLB binary chunk, share its owner instead of borrowing it
 		[[nodiscard]]
 		static std::expected<Buffer, Error> create(
 			const fastgltf::Buffer& buffer,
 			std::shared_ptr<FileCache> file_cache,
+			const Texture::SharedData& input = {},
 			const std::optional<std::filesystem::path>& directory = std::nullopt
 		) noexcept;
 
@@ -45,8 +61,9 @@ namespace model::gltf::impl
 		using Data = std::variant<
 			std::span<const std::byte>,
 			std::filesystem::path,
-			std::unique_ptr<std::vector<std::byte>>,
-			std::shared_ptr<mio::basic_mmap_source<std::byte>>
+			std::shared_ptr<const std::vector<std::byte>>,
+			std::shared_ptr<mio::basic_mmap_source<std::byte>>,
+			Texture::SharedData
 		>;
 
 		std::unique_ptr<std::mutex> mutex;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/util/error.hpp"
+#include "common/util/profile.hpp"
 
 #include <cstddef>
 #include <expected>
@@ -18,7 +19,7 @@ namespace model::gltf::impl
 	  public:
 
 		FileCache() :
-			mutex(std::make_unique<std::mutex>())
+			mutex(std::make_unique<Mutex>())
 		{}
 
 		[[nodiscard]]
@@ -28,7 +29,13 @@ namespace model::gltf::impl
 
 	  private:
 
-		std::unique_ptr<std::mutex> mutex;
+		// Wrapped to declare it through `PROFILE_LOCKABLE`, and kept on the heap for the cache to be movable
+		struct Mutex
+		{
+			PROFILE_LOCKABLE(std::mutex, value, "glTF file cache");
+		};
+
+		std::unique_ptr<Mutex> mutex;
 		std::unordered_map<std::filesystem::path, std::shared_ptr<mio::basic_mmap_source<std::byte>>> cache;
 
 	  public:
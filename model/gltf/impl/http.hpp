@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace model::gltf::impl::http
+{
+	// Requests in flight at once, further requests are queued
+	inline constexpr size_t MAX_PARALLEL_REQUESTS = 8;
+
+	// Byte range of a resource
+	struct Range
+	{
+		size_t offset;
+		size_t size;
+	};
+
+	struct Request
+	{
+		std::string url;
+		std::optional<Range> range;  // Whole resource if empty
+	};
+
+	// Whether @p uri is an HTTP or HTTPS URL
+	[[nodiscard]]
+	bool is_url(std::string_view uri) noexcept;
+
+	// Resolve a relative URI reference against @p base_url, references that are URLs are returned as is
+	[[nodiscard]]
+	std::string resolve(std::string_view base_url, std::string_view reference) noexcept;
+
+	// Perform @p requests in parallel, returns the body of each request. Fails if the library was built
+	// without HTTP support, see option "http"
+	[[nodiscard]]
+	std::expected<std::vector<std::vector<std::byte>>, Error> fetch(
+		std::span<const Request> requests,
+		std::stop_token stop_token = {}
+	) noexcept;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "model/light.hpp"
+
+#include <fastgltf/types.hpp>
+#include <vector>
+
+namespace model::gltf::impl
+{
+	[[nodiscard]]
+	Light parse_light(const fastgltf::Light& light) noexcept;
+
+	[[nodiscard]]
+	std::vector<Light> parse_lights(const fastgltf::Asset& asset) noexcept;
+}
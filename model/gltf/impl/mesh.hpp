@@ -9,6 +9,7 @@
 #include <coro/thread_pool.hpp>
 #include <expected>
 #include <fastgltf/types.hpp>
+#include <stop_token>
 #include <vector>
 
 namespace model::gltf::impl
@@ -23,6 +24,7 @@ namespace model::gltf::impl
 	coro::task<std::expected<Primitive, Error>> parse_primitive(
 		coro::thread_pool& thread_pool,
 		::util::Progress& progress,
+		std::stop_token stop_token,
 		Asset& asset,
 		const fastgltf::Primitive& primitive
 	) noexcept;
@@ -31,15 +33,17 @@ namespace model::gltf::impl
 	coro::task<std::expected<Mesh, Error>> parse_mesh(
 		coro::thread_pool& thread_pool,
 		::util::Progress& progress,
+		std::stop_token stop_token,
 		Asset& asset,
 		const fastgltf::Mesh& mesh
 	) noexcept;
 
-	// Note: computationally heavy
+	// Note: computationally heavy. Primitives not yet started fail once a stop is requested
 	[[nodiscard]]
 	coro::task<std::expected<std::vector<Mesh>, Error>> parse_meshes(
 		coro::thread_pool& thread_pool,
 		::util::Progress& progress,
+		std::stop_token stop_token,
 		Asset& asset
 	) noexcept;
 }
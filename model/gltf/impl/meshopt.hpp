@@ -0,0 +1,19 @@
+#pragma once
+
+#include "asset.hpp"
+#include "common/util/error.hpp"
+
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <expected>
+
+namespace model::gltf::impl
+{
+	// Decode the buffer views compressed with `EXT_meshopt_compression` into `Asset::decoded_views`, in
+	// parallel
+	[[nodiscard]]
+	coro::task<std::expected<void, Error>> decode_meshopt_views(
+		coro::thread_pool& thread_pool,
+		Asset& asset
+	) noexcept;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <expected>
+#include <fastgltf/types.hpp>
+#include <optional>
+#include <stop_token>
+#include <string>
+
+namespace model::gltf::impl
+{
+	// Fetch the buffers and images of @p asset referenced by URL, replacing their sources with the fetched
+	// data. Buffers are fetched in parallel range requests of only the ranges read by buffer views, other
+	// bytes are left zero. Relative URIs are resolved against @p base_url if given, and kept as local paths
+	// otherwise
+	[[nodiscard]]
+	std::expected<void, Error> fetch_remote_sources(
+		fastgltf::Asset& asset,
+		const std::optional<std::string>& base_url,
+		std::stop_token stop_token
+	) noexcept;
+}
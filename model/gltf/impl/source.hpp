@@ -0,0 +1,50 @@
+#pragma once
+
+#include "model/texture.hpp"
+
+#include <cstddef>
+#include <fastgltf/core.hpp>
+#include <utility>
+#include <vector>
+
+namespace model::gltf::impl
+{
+	// Parser input read in place from memory, e.g. a file mapped by `FileCache`. The GLB binary chunk is
+	// returned as a span into the input, which fastgltf keeps as a `sources::ByteView`
+	class SourceGetter : public fastgltf::GltfDataGetter
+	{
+	  public:
+
+		explicit SourceGetter(Texture::SharedData source) noexcept :
+			source(std::move(source))
+		{}
+
+		void read(void* ptr, std::size_t count) override;
+
+		[[nodiscard]]
+		fastgltf::span<std::byte> read(std::size_t count, std::size_t padding) override;
+
+		void reset() override;
+
+		[[nodiscard]]
+		std::size_t bytesRead() override;
+
+		[[nodiscard]]
+		std::size_t totalSize() override;
+
+	  private:
+
+		Texture::SharedData source;
+		size_t position = 0;
+
+		// Copy of the last read whose padding runs past the end of the input, e.g. a whole JSON file
+		std::vector<std::byte> padded_copy;
+
+	  public:
+
+		SourceGetter(const SourceGetter&) = delete;
+		SourceGetter(SourceGetter&&) = delete;
+		SourceGetter& operator=(const SourceGetter&) = delete;
+		SourceGetter& operator=(SourceGetter&&) = delete;
+	};
+}
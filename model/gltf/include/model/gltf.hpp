@@ -12,6 +12,10 @@
 #include <expected>
 #include <filesystem>
 #include <memory>
+#include <memory_resource>
+#include <stop_token>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -29,7 +33,7 @@ namespace model::gltf
 		Hierarchy  // Parsing hierarchy
 	};
 
-	using Progress = ::util::SyncedEnumVariant<
+	using Progress = ::util::AtomicEnumVariant<
 		::util::Tag<ProgressState::Parsing>,
 		::util::Tag<ProgressState::Material>,
 		::util::Tag<ProgressState::Mesh, ::util::ProgressRef>,
@@ -41,13 +45,20 @@ namespace model::gltf
 	///
 	/// @param thread_pool Thread pool to use for asynchronous loading
 	/// @param path File path to the glTF model
+	/// @param stop_token Stop token, loading fails early once a stop is requested
+	/// @param scratch_resource Memory resource of the decoding temporaries, shared by the tasks on
+	/// @p thread_pool, e.g. `util::ImportArena`
 	/// @return A pair of a task that will yield the loaded model or an error, and a shared pointer to the
 	/// progress state
 	///
+	/// @warning @p scratch_resource must outlive the task
+	///
 	[[nodiscard]]
 	std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Progress>> load_from_file(
 		coro::thread_pool& thread_pool,
-		const std::filesystem::path& path
+		const std::filesystem::path& path,
+		std::stop_token stop_token = {},
+		std::pmr::memory_resource& scratch_resource = *std::pmr::new_delete_resource()
 	) noexcept;
 
 	///
@@ -55,12 +66,51 @@ namespace model::gltf
 	///
 	/// @param thread_pool Thread pool to use for asynchronous loading
 	/// @param data Binary data containing the glTF model
+	/// @param stop_token Stop token, loading fails early once a stop is requested
+	/// @param scratch_resource Memory resource of the decoding temporaries, see `load_from_file`
 	/// @return A pair of a task that will yield the loaded model or an error, and a shared pointer to the
 	/// progress state
 	///
+	/// @warning @p scratch_resource must outlive the task
+	///
 	[[nodiscard]]
 	std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Progress>> load_from_binary(
 		coro::thread_pool& thread_pool,
-		const std::vector<std::byte>& data
+		const std::vector<std::byte>& data,
+		std::stop_token stop_token = {},
+		std::pmr::memory_resource& scratch_resource = *std::pmr::new_delete_resource()
+	) noexcept;
+
+	///
+	/// @brief Load a glTF model from an HTTP or HTTPS URL, e.g. an object store
+	/// @details The glTF JSON or GLB is fetched first. Buffers and images referenced by the asset are then
+	/// fetched at once in parallel requests, with only the buffer ranges read by buffer views requested.
+	/// Relative URIs are resolved against @p url. URLs referenced by local models are fetched the same way.
+	/// @note Fails unless built with option "http"
+	///
+	/// @param thread_pool Thread pool to use for asynchronous loading
+	/// @param url URL of the glTF model
+	/// @param stop_token Stop token, loading fails early once a stop is requested
+	/// @param scratch_resource Memory resource of the decoding temporaries, see `load_from_file`
+	/// @return A pair of a task that will yield the loaded model or an error, and a shared pointer to the
+	/// progress state
+	///
+	/// @warning @p scratch_resource must outlive the task
+	///
+	[[nodiscard]]
+	std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Progress>> load_from_url(
+		coro::thread_pool& thread_pool,
+		const std::string& url,
+		std::stop_token stop_token = {},
+		std::pmr::memory_resource& scratch_resource = *std::pmr::new_delete_resource()
 	) noexcept;
+
+	///
+	/// @brief Check whether a model source is a URL to load with `load_from_url`
+	///
+	/// @param uri Model source
+	/// @return `true` if @p uri is an HTTP or HTTPS URL
+	///
+	[[nodiscard]]
+	bool is_url(std::string_view uri) noexcept;
 }
@@ -1,11 +1,18 @@
 #include "model/gltf.hpp"
+#include "animation.hpp"
 #include "asset.hpp"
 #include "common/util/async.hpp"
 #include "common/util/error.hpp"
+#include "file-cache.hpp"
 #include "hierarchy.hpp"
+#include "http.hpp"
+#include "light.hpp"
 #include "material.hpp"
 #include "mesh.hpp"
 #include "model/model.hpp"
+#include "model/texture.hpp"
+#include "remote.hpp"
+#include "source.hpp"
 #include "texture.hpp"
 
 #include <coro/task.hpp>
@@ -17,6 +24,12 @@
 #include <filesystem>
 #include <format>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -24,16 +37,66 @@ namespace model::gltf
 {
 	namespace
 	{
+		constexpr auto EXTENSIONS =
+			fastgltf::Extensions::EXT_texture_webp
+			| fastgltf::Extensions::KHR_texture_basisu
+			| fastgltf::Extensions::KHR_lights_punctual
+			| fastgltf::Extensions::EXT_meshopt_compression
+			| fastgltf::Extensions::KHR_mesh_quantization
+			| fastgltf::Extensions::KHR_texture_transform;
+
+		// Parse a glTF or GLB from memory, the binary chunk is kept in place as a `sources::ByteView`
+		std::expected<fastgltf::Asset, Error> parse_gltf(
+			const Texture::SharedData& input,
+			const std::filesystem::path& directory
+		) noexcept
+		{
+			auto getter = impl::SourceGetter(input);
+
+			auto result =
+				fastgltf::Parser(EXTENSIONS)
+					.loadGltf(getter, directory, fastgltf::Options::DecomposeNodeMatrices);
+			if (!result)
+			{
+				return Error(
+					"Parse glTF failed",
+					std::format(
+						"({}) {}",
+						fastgltf::getErrorName(result.error()),
+						fastgltf::getErrorMessage(result.error())
+					)
+				);
+			}
+
+			return std::move(result.get());
+		}
+
 		coro::task<std::expected<Model, Error>> load_asset(
 			coro::thread_pool& thread_pool,
 			std::shared_ptr<Progress> progress,
+			std::stop_token stop_token,
 			fastgltf::Asset asset,
-			std::filesystem::path path
+			Texture::SharedData input,
+			std::shared_ptr<impl::FileCache> file_cache,
+			std::filesystem::path path,
+			std::optional<std::string> base_url,
+			std::pmr::memory_resource& scratch_resource
 		) noexcept
 		{
+			/* Fetch remote sources */
+
+			auto fetch_result = impl::fetch_remote_sources(asset, base_url, stop_token);
+			if (!fetch_result) co_return fetch_result.error().forward("Fetch remote sources failed");
+
 			/* Augment the asset */
 
-			auto augmented_asset_result = impl::Asset::create(std::move(asset), path.parent_path());
+			auto augmented_asset_result = impl::Asset::create(
+				std::move(asset),
+				input,
+				std::move(file_cache),
+				path.parent_path(),
+				scratch_resource
+			);
 			if (!augmented_asset_result)
 				co_return augmented_asset_result.error().forward("Create asset failed");
 			auto augmented_asset = std::move(*augmented_asset_result);
@@ -58,7 +121,8 @@ namespace model::gltf
 			::util::Progress mesh_progress;
 			progress->set<ProgressState::Mesh>(mesh_progress.get_ref());
 
-			auto meshes_result = co_await impl::parse_meshes(thread_pool, mesh_progress, augmented_asset);
+			auto meshes_result =
+				co_await impl::parse_meshes(thread_pool, mesh_progress, stop_token, augmented_asset);
 			if (!meshes_result) co_return meshes_result.error().forward("Parse meshes failed");
 			auto meshes = std::move(*meshes_result);
 
@@ -70,115 +134,196 @@ namespace model::gltf
 			if (!hierarchy_result) co_return hierarchy_result.error().forward("Create hierarchy failed");
 			auto hierarchy = std::move(*hierarchy_result);
 
-			co_return Model::assemble(std::move(material_list), std::move(meshes), std::move(hierarchy));
+			auto lights = impl::parse_lights(augmented_asset);
+
+			/* Parse skins and animations */
+
+			auto skins_result = impl::parse_skins(augmented_asset);
+			if (!skins_result) co_return skins_result.error().forward("Parse skins failed");
+			auto skins = std::move(*skins_result);
+
+			auto animations_result = impl::parse_animations(augmented_asset);
+			if (!animations_result) co_return animations_result.error().forward("Parse animations failed");
+			auto animations = std::move(*animations_result);
+
+			// Exporters often emit identical materials differing only by name
+			co_return Model::assemble(
+				std::move(material_list),
+				std::move(meshes),
+				std::move(hierarchy),
+				std::move(lights),
+				std::move(skins),
+				std::move(animations)
+			)
+				.transform(deduplicate_materials);
 		}
 
 		coro::task<std::expected<Model, Error>> load_from_file_impl(
 			coro::thread_pool& thread_pool,
 			std::shared_ptr<Progress> progress,
-			std::filesystem::path path
+			std::stop_token stop_token,
+			std::filesystem::path path,
+			std::pmr::memory_resource& scratch_resource
 		) noexcept
 		{
 			co_await thread_pool.schedule();
 
 			progress->set<ProgressState::Parsing>();
 
-			/* Validate path */
+			/* Map file */
 
-			if (!std::filesystem::exists(path))
-				co_return Error("File doesn't exist", std::format("Path: {}", path.string()));
+			// Shared with the external buffers, a GLB is parsed and read in place without copying
+			auto file_cache = std::make_shared<impl::FileCache>();
 
-			if (!std::filesystem::is_regular_file(path))
-				co_return Error("Path is not a regular file", std::format("Path: {}", path.string()));
+			auto mapping_result = file_cache->get(path);
+			if (!mapping_result) co_return mapping_result.error().forward("Map glTF file failed");
+			const auto input = Texture::SharedData{
+				.owner = *mapping_result,
+				.data = std::span((*mapping_result)->data(), (*mapping_result)->size())
+			};
 
 			/* Load glTF */
 
-			auto file_stream = fastgltf::GltfFileStream(path);
-			if (!file_stream.isOpen())
-				co_return Error("Open file failed", std::format("Path: {}", path.string()));
+			auto asset_result = parse_gltf(input, path.parent_path());
+			if (!asset_result) co_return asset_result.error();
+			auto asset = std::move(*asset_result);
 
-			auto result =
-				fastgltf::Parser(fastgltf::Extensions::EXT_texture_webp)
-					.loadGltf(file_stream, path.parent_path(), fastgltf::Options::DecomposeNodeMatrices);
-			if (!result)
-			{
-				co_return Error(
-					"Parse glTF failed",
-					std::format(
-						"({}) {}",
-						fastgltf::getErrorName(result.error()),
-						fastgltf::getErrorMessage(result.error())
-					)
-				);
-			}
-			auto asset = std::move(result.get());
+			if (stop_token.stop_requested()) co_return Error("Cancelled");
 
-			co_return co_await load_asset(thread_pool, progress, std::move(asset), std::move(path));
+			co_return co_await load_asset(
+				thread_pool,
+				progress,
+				std::move(stop_token),
+				std::move(asset),
+				input,
+				std::move(file_cache),
+				std::move(path),
+				std::nullopt,
+				scratch_resource
+			);
 		}
 
 		coro::task<std::expected<Model, Error>> load_from_binary_impl(
 			coro::thread_pool& thread_pool,
 			std::shared_ptr<Progress> progress,
-			std::vector<std::byte> data
+			std::stop_token stop_token,
+			std::vector<std::byte> data,
+			std::pmr::memory_resource& scratch_resource
 		) noexcept
 		{
 			co_await thread_pool.schedule();
 
 			progress->set<ProgressState::Parsing>();
 
-			auto binary_stream_result = fastgltf::GltfDataBuffer::FromSpan(data);
-			if (!binary_stream_result)
-				co_return Error(
-					"Create binary stream failed",
-					std::format(
-						"({}) {}",
-						fastgltf::getErrorName(binary_stream_result.error()),
-						fastgltf::getErrorMessage(binary_stream_result.error())
-					)
-				);
-			auto binary_stream = std::move(binary_stream_result.get());
+			// Parsed in place, the buffers and textures share ownership of the data
+			const auto owner = std::make_shared<const std::vector<std::byte>>(std::move(data));
+			const auto input = Texture::SharedData{.owner = owner, .data = std::span(*owner)};
 
-			auto result =
-				fastgltf::Parser(fastgltf::Extensions::EXT_texture_webp)
-					.loadGltf(
-						binary_stream,
-						std::filesystem::path(),
-						fastgltf::Options::DecomposeNodeMatrices
-					);
-			if (!result)
-			{
-				co_return Error(
-					"Parse glTF failed",
-					std::format(
-						"({}) {}",
-						fastgltf::getErrorName(result.error()),
-						fastgltf::getErrorMessage(result.error())
-					)
-				);
-			}
-			auto asset = std::move(result.get());
+			auto asset_result = parse_gltf(input, std::filesystem::path());
+			if (!asset_result) co_return asset_result.error();
+			auto asset = std::move(*asset_result);
+
+			if (stop_token.stop_requested()) co_return Error("Cancelled");
+
+			co_return co_await load_asset(
+				thread_pool,
+				progress,
+				std::move(stop_token),
+				std::move(asset),
+				input,
+				nullptr,
+				std::filesystem::path(),
+				std::nullopt,
+				scratch_resource
+			);
+		}
+
+		coro::task<std::expected<Model, Error>> load_from_url_impl(
+			coro::thread_pool& thread_pool,
+			std::shared_ptr<Progress> progress,
+			std::stop_token stop_token,
+			std::string url,
+			std::pmr::memory_resource& scratch_resource
+		) noexcept
+		{
+			co_await thread_pool.schedule();
+
+			progress->set<ProgressState::Parsing>();
+
+			/* Fetch the glTF JSON or GLB */
+
+			const auto request = impl::http::Request{.url = url, .range = std::nullopt};
+			auto fetch_result = impl::http::fetch(std::span(&request, 1), stop_token);
+			if (!fetch_result) co_return fetch_result.error().forward("Fetch glTF file failed");
 
-			co_return co_await load_asset(thread_pool, progress, std::move(asset), std::filesystem::path());
+			auto& body = fetch_result->front();
+			const auto owner = std::make_shared<const std::vector<std::byte>>(std::move(body));
+			const auto input = Texture::SharedData{.owner = owner, .data = std::span(*owner)};
+
+			/* Load glTF, fetching only the buffer ranges read by buffer views */
+
+			auto asset_result = parse_gltf(input, std::filesystem::path());
+			if (!asset_result) co_return asset_result.error();
+			auto asset = std::move(*asset_result);
+
+			if (stop_token.stop_requested()) co_return Error("Cancelled");
+
+			co_return co_await load_asset(
+				thread_pool,
+				progress,
+				std::move(stop_token),
+				std::move(asset),
+				input,
+				nullptr,
+				std::filesystem::path(),
+				std::move(url),
+				scratch_resource
+			);
 		}
 	}
 
 	[[nodiscard]]
 	std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Progress>> load_from_file(
 		coro::thread_pool& thread_pool,
-		const std::filesystem::path& path
+		const std::filesystem::path& path,
+		std::stop_token stop_token,
+		std::pmr::memory_resource& scratch_resource
 	) noexcept
 	{
 		auto progress = std::make_shared<Progress>(Progress::from<ProgressState::Parsing>());
-		return std::make_pair(load_from_file_impl(thread_pool, progress, path), progress);
+		auto task = load_from_file_impl(thread_pool, progress, std::move(stop_token), path, scratch_resource);
+		return std::make_pair(std::move(task), progress);
 	}
 
 	[[nodiscard]]
 	std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Progress>> load_from_binary(
 		coro::thread_pool& thread_pool,
-		const std::vector<std::byte>& data
+		const std::vector<std::byte>& data,
+		std::stop_token stop_token,
+		std::pmr::memory_resource& scratch_resource
 	) noexcept
 	{
 		auto progress = std::make_shared<Progress>(Progress::from<ProgressState::Parsing>());
-		return std::make_pair(load_from_binary_impl(thread_pool, progress, data), progress);
+		auto task =
+			load_from_binary_impl(thread_pool, progress, std::move(stop_token), data, scratch_resource);
+		return std::make_pair(std::move(task), progress);
+	}
+
+	[[nodiscard]]
+	std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Progress>> load_from_url(
+		coro::thread_pool& thread_pool,
+		const std::string& url,
+		std::stop_token stop_token,
+		std::pmr::memory_resource& scratch_resource
+	) noexcept
+	{
+		auto progress = std::make_shared<Progress>(Progress::from<ProgressState::Parsing>());
+		auto task = load_from_url_impl(thread_pool, progress, std::move(stop_token), url, scratch_resource);
+		return std::make_pair(std::move(task), progress);
+	}
+
+	bool is_url(std::string_view uri) noexcept
+	{
+		return impl::http::is_url(uri);
 	}
 }
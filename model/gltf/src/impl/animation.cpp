@@ -0,0 +1,207 @@
+#include "animation.hpp"
+#include "asset.hpp"
+#include "common/util/error.hpp"
+#include "model/animation.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <fastgltf/glm_element_traits.hpp>
+#include <fastgltf/tools.hpp>
+#include <fastgltf/types.hpp>
+#include <format>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace model::gltf::impl
+{
+	// (Helper) Read an accessor of element type `T` into tightly packed floats
+	template <typename T>
+	[[nodiscard]]
+	static std::vector<float> read_floats(Asset& asset, const fastgltf::Accessor& accessor) noexcept
+	{
+		auto values = std::vector<float>(accessor.count * fastgltf::getNumComponents(accessor.type));
+
+		fastgltf::copyFromAccessor<T>(
+			asset,
+			accessor,
+			values.data(),
+			[&asset](const fastgltf::Asset&, size_t buffer_view_idx) {
+				return asset.accessor_interface(asset, buffer_view_idx);
+			}
+		);
+
+		return values;
+	}
+
+	std::expected<Skin, Error> parse_skin(Asset& asset, const fastgltf::Skin& skin) noexcept
+	{
+		const auto joint_count = skin.joints.size();
+		auto joints = std::vector<uint32_t>(
+			std::from_range,
+			skin.joints | std::views::transform([](size_t idx) { return static_cast<uint32_t>(idx); })
+		);
+
+		// Missing inverse bind matrices are identity matrices
+		if (!skin.inverseBindMatrices.has_value())
+			return Skin{
+				.joints = std::move(joints),
+				.inverse_bind_matrices = std::vector(joint_count, glm::mat4(1.0f)),
+			};
+
+		const auto& accessor = asset.accessors[*skin.inverseBindMatrices];
+		if (accessor.type != fastgltf::AccessorType::Mat4 || accessor.count != joint_count)
+			return Error(
+				"Invalid inverse bind matrices",
+				std::format("Expect {} MAT4 elements, got {}", joint_count, accessor.count)
+			);
+
+		auto inverse_bind_matrices = std::vector<glm::mat4>(joint_count);
+		fastgltf::copyFromAccessor<glm::mat4>(
+			asset,
+			accessor,
+			inverse_bind_matrices.data(),
+			[&asset](const fastgltf::Asset&, size_t buffer_view_idx) {
+				return asset.accessor_interface(asset, buffer_view_idx);
+			}
+		);
+
+		return Skin{.joints = std::move(joints), .inverse_bind_matrices = std::move(inverse_bind_matrices)};
+	}
+
+	std::expected<std::vector<Skin>, Error> parse_skins(Asset& asset) noexcept
+	{
+		return asset.skins
+			| std::views::transform([&asset](const fastgltf::Skin& skin) { return parse_skin(asset, skin); })
+			| Error::collect();
+	}
+
+	// (Helper) Parse an animation channel with its sampler
+	[[nodiscard]]
+	static std::expected<AnimationChannel, Error> parse_channel(
+		Asset& asset,
+		const fastgltf::AnimationChannel& channel,
+		const fastgltf::AnimationSampler& sampler
+	) noexcept
+	{
+		const auto path = [&channel] {
+			switch (channel.path)
+			{
+			case fastgltf::AnimationPath::Translation:
+				return AnimationChannel::Path::Translation;
+			case fastgltf::AnimationPath::Rotation:
+				return AnimationChannel::Path::Rotation;
+			case fastgltf::AnimationPath::Scale:
+				return AnimationChannel::Path::Scale;
+			default:
+				return AnimationChannel::Path::Weights;
+			}
+		}();
+
+		const auto component_type = [path] {
+			switch (path)
+			{
+			case AnimationChannel::Path::Rotation:
+				return fastgltf::AccessorType::Vec4;
+			case AnimationChannel::Path::Weights:
+				return fastgltf::AccessorType::Scalar;
+			default:
+				return fastgltf::AccessorType::Vec3;
+			}
+		}();
+
+		const auto interpolation = [&sampler] {
+			switch (sampler.interpolation)
+			{
+			case fastgltf::AnimationInterpolation::Step:
+				return AnimationChannel::Interpolation::Step;
+			case fastgltf::AnimationInterpolation::CubicSpline:
+				return AnimationChannel::Interpolation::CubicSpline;
+			default:
+				return AnimationChannel::Interpolation::Linear;
+			}
+		}();
+
+		const auto& input_accessor = asset.accessors[sampler.inputAccessor];
+		const auto& output_accessor = asset.accessors[sampler.outputAccessor];
+
+		if (input_accessor.type != fastgltf::AccessorType::Scalar || input_accessor.count == 0)
+			return Error("Invalid animation sampler input");
+		if (output_accessor.type != component_type)
+			return Error(
+				"Animation sampler output mismatches the path",
+				std::format("Path: {}", std::to_underlying(channel.path))
+			);
+
+		// Weights store all targets of a keyframe as consecutive scalars
+		const auto values_per_keyframe =
+			(interpolation == AnimationChannel::Interpolation::CubicSpline ? 3 : 1) * input_accessor.count;
+		const auto component_count = path == AnimationChannel::Path::Weights
+			? output_accessor.count / values_per_keyframe
+			: fastgltf::getNumComponents(component_type);
+
+		auto times = read_floats<float>(asset, input_accessor);
+		auto values = [&] {
+			switch (component_type)
+			{
+			case fastgltf::AccessorType::Vec3:
+				return read_floats<glm::vec3>(asset, output_accessor);
+			case fastgltf::AccessorType::Vec4:
+				return read_floats<glm::vec4>(asset, output_accessor);
+			default:
+				return read_floats<float>(asset, output_accessor);
+			}
+		}();
+
+		return AnimationChannel{
+			.node_index = static_cast<uint32_t>(*channel.nodeIndex),
+			.path = path,
+			.interpolation = interpolation,
+			.component_count = static_cast<uint32_t>(component_count),
+			.times = std::move(times),
+			.values = std::move(values),
+		};
+	}
+
+	std::expected<Animation, Error> parse_animation(
+		Asset& asset,
+		const fastgltf::Animation& animation
+	) noexcept
+	{
+		Animation result;
+
+		for (const auto& [channel_idx, channel] : animation.channels | std::views::enumerate)
+		{
+			// Channels targeting properties other than nodes (`KHR_animation_pointer`) are ignored
+			if (!channel.nodeIndex.has_value()) continue;
+
+			if (channel.samplerIndex >= animation.samplers.size())
+				return Error(
+					"Sampler index of an animation channel is out of bound",
+					std::format("Channel #{}", channel_idx)
+				);
+
+			auto channel_result = parse_channel(asset, channel, animation.samplers[channel.samplerIndex]);
+			if (!channel_result)
+				return channel_result.error().forward(
+					"Parse animation channel failed",
+					std::format("Channel #{}", channel_idx)
+				);
+
+			result.channels.push_back(std::move(*channel_result));
+		}
+
+		return result;
+	}
+
+	std::expected<std::vector<Animation>, Error> parse_animations(Asset& asset) noexcept
+	{
+		return asset.animations
+			| std::views::transform([&asset](const fastgltf::Animation& animation) {
+				  return parse_animation(asset, animation);
+			  })
+			| Error::collect();
+	}
+}
@@ -2,12 +2,14 @@
 #include "buffer.hpp"
 #include "common/util/error.hpp"
 #include "file-cache.hpp"
+#include "model/texture.hpp"
 
 #include <cstddef>
 #include <expected>
 #include <fastgltf/types.hpp>
 #include <filesystem>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <ranges>
 #include <span>
@@ -17,21 +19,30 @@ namespace model::gltf::impl
 {
 	std::expected<Asset, Error> Asset::create(
 		fastgltf::Asset asset,
-		std::optional<std::filesystem::path> directory
+		const Texture::SharedData& input,
+		std::shared_ptr<FileCache> file_cache,
+		std::optional<std::filesystem::path> directory,
+		std::pmr::memory_resource& scratch_resource
 	) noexcept
 	{
-		auto file_cache = std::make_shared<FileCache>();
+		if (file_cache == nullptr) file_cache = std::make_shared<FileCache>();
 
 		auto buffers_result =
 			asset.buffers
-			| std::views::transform([&directory, &file_cache](const fastgltf::Buffer& buffer) {
-				  return Buffer::create(buffer, file_cache, directory);
+			| std::views::transform([&input, &directory, &file_cache](const fastgltf::Buffer& buffer) {
+				  return Buffer::create(buffer, file_cache, input, directory);
 			  })
 			| Error::collect();
 		if (!buffers_result) return buffers_result.error().forward("Create buffers failed");
 		auto buffers = std::move(*buffers_result);
 
-		return Asset(std::move(asset), std::move(directory), file_cache, std::move(buffers));
+		return Asset(
+			std::move(asset),
+			std::move(directory),
+			file_cache,
+			std::move(buffers),
+			scratch_resource
+		);
 	}
 
 	std::span<const std::byte> Asset::accessor_interface(
@@ -40,6 +51,8 @@ namespace model::gltf::impl
 	) noexcept
 	{
 		const auto& buffer_view = bufferViews[buffer_view_idx];
+		if (buffer_view.meshoptCompression != nullptr) return decoded_views[buffer_view_idx];
+
 		return unified_buffers[buffer_view.bufferIndex].get_span(buffer_view).value();
 	}
 }
@@ -2,12 +2,14 @@
 #include "common/util/error.hpp"
 #include "common/util/overload.hpp"
 #include "file-cache.hpp"
+#include "model/texture.hpp"
 
 #include <cstddef>
 #include <expected>
 #include <fastgltf/types.hpp>
 #include <filesystem>
 #include <format>
+#include <functional>
 #include <libassert/assert.hpp>
 #include <memory>
 #include <mio/mmap.hpp>
@@ -83,7 +85,7 @@ namespace model::gltf::impl
 		const std::optional<std::filesystem::path>&
 	) noexcept
 	{
-		return std::make_unique<std::vector<std::byte>>(std::from_range, array.bytes);
+		return std::make_shared<std::vector<std::byte>>(std::from_range, array.bytes);
 	}
 
 	[[nodiscard]]
@@ -119,12 +121,14 @@ namespace model::gltf::impl
 		const std::optional<std::filesystem::path>&
 	) noexcept
 	{
-		return Error("Fallback buffer sources are not supported");
+		// Fallback buffers of `EXT_meshopt_compression` have no data, only their compressed views are read
+		return std::span<const std::byte>();
 	}
 
 	std::expected<Buffer, Error> Buffer::create(
 		const fastgltf::Buffer& buffer,
 		std::shared_ptr<FileCache> file_cache,
+		const Texture::SharedData& input,
 		const std::optional<std::filesystem::path>& directory
 	) noexcept
 	{
@@ -132,12 +136,32 @@ namespace model::gltf::impl
 			std::visit([&](const auto& source) { return get_data(source, directory); }, buffer.data);
 		if (!data_result) return data_result.error().forward("Acquire buffer data failed");
 
+		if (const auto* const bytes = std::get_if<std::span<const std::byte>>(&*data_result);
+			bytes != nullptr && input.owner != nullptr && !bytes->empty())
+		{
+			const auto* const input_begin = input.data.data();
+			const auto* const input_end = input_begin + input.data.size();
+			const auto* const bytes_end = bytes->data() + bytes->size();
+
+			// Pointers of unrelated storage are only ordered by `std::less`
+			if (!std::less()(bytes->data(), input_begin) && !std::less()(input_end, bytes_end))
+				*data_result = Texture::SharedData{.owner = input.owner, .data = *bytes};
+		}
+
 		return Buffer(std::make_unique<std::mutex>(), std::move(file_cache), std::move(*data_result));
 	}
 
 	std::expected<std::span<const std::byte>, Error> Buffer::get_span(
 		const fastgltf::BufferView& view
 	) noexcept
+	{
+		return get_span(view.byteOffset, view.byteLength);
+	}
+
+	std::expected<std::span<const std::byte>, Error> Buffer::get_span(
+		size_t byte_offset,
+		size_t byte_length
+	) noexcept
 	{
 		const std::scoped_lock lock(*mutex);
 
@@ -150,27 +174,65 @@ namespace model::gltf::impl
 
 		const auto overload = util::Overload(
 			[&](std::span<const std::byte> bytes) -> std::expected<std::span<const std::byte>, Error> {
-				if (view.byteOffset + view.byteLength > bytes.size())
+				if (byte_offset + byte_length > bytes.size())
 					return Error("Byte range out of bounds");
 
-				return bytes.subspan(view.byteOffset, view.byteLength);
+				return bytes.subspan(byte_offset, byte_length);
 			},
 			[&](const std::filesystem::path&) -> std::expected<std::span<const std::byte>, Error> {
 				UNREACHABLE("Data should never be a path here");
 			},
-			[&](const std::unique_ptr<std::vector<std::byte>>& vector)
+			[&](const std::shared_ptr<const std::vector<std::byte>>& vector)
 				-> std::expected<std::span<const std::byte>, Error> {
-				if (view.byteOffset + view.byteLength > vector->size())
+				if (byte_offset + byte_length > vector->size())
 					return Error("Byte range out of bounds");
 
-				return std::span(*vector).subspan(view.byteOffset, view.byteLength);
+				return std::span(*vector).subspan(byte_offset, byte_length);
 			},
 			[&](const std::shared_ptr<mio::basic_mmap_source<std::byte>>& mmap)
 				-> std::expected<std::span<const std::byte>, Error> {
-				if (view.byteOffset + view.byteLength > mmap->size())
+				if (byte_offset + byte_length > mmap->size())
 					return Error("Byte range out of bounds");
 
-				return std::span(mmap->data(), mmap->size()).subspan(view.byteOffset, view.byteLength);
+				return std::span(mmap->data(), mmap->size()).subspan(byte_offset, byte_length);
+			},
+			[&](const Texture::SharedData& shared) -> std::expected<std::span<const std::byte>, Error> {
+				if (byte_offset + byte_length > shared.data.size())
+					return Error("Byte range out of bounds");
+
+				return shared.data.subspan(byte_offset, byte_length);
+			}
+		);
+
+		return std::visit(overload, data);
+	}
+
+	std::expected<Texture::SharedData, Error> Buffer::get_shared(const fastgltf::BufferView& view) noexcept
+	{
+		const auto span_result = get_span(view);
+		if (!span_result) return span_result.error();
+		const auto span = *span_result;
+
+		const std::scoped_lock lock(*mutex);
+
+		const auto overload = util::Overload(
+			[span](std::span<const std::byte>) -> Texture::SharedData {
+				// Byte views are borrowed from the parser input, which may not outlive the buffer
+				auto copy = std::make_shared<std::vector<std::byte>>(std::from_range, span);
+				const auto data = std::span(*copy);
+				return {.owner = std::move(copy), .data = data};
+			},
+			[](const std::filesystem::path&) -> Texture::SharedData {
+				UNREACHABLE("Data should never be a path here");
+			},
+			[span](const std::shared_ptr<const std::vector<std::byte>>& vector) -> Texture::SharedData {
+				return {.owner = vector, .data = span};
+			},
+			[span](const std::shared_ptr<mio::basic_mmap_source<std::byte>>& mmap) -> Texture::SharedData {
+				return {.owner = mmap, .data = span};
+			},
+			[span](const Texture::SharedData& shared) -> Texture::SharedData {
+				return {.owner = shared.owner, .data = span};
 			}
 		);
 
@@ -16,7 +16,7 @@ namespace model::gltf::impl
 		const std::filesystem::path& path
 	) noexcept
 	{
-		const std::scoped_lock lock(*mutex);
+		const std::scoped_lock lock(mutex->value);
 
 		auto it = cache.find(path);
 		if (it != cache.end()) return it->second;
@@ -60,7 +60,14 @@ namespace model::gltf::impl
 
 		const auto transform = std::visit(transform_visitor, node.transform);
 		const auto mesh_index = node.meshIndex.transform([](auto idx) { return uint32_t(idx); });
-		const auto data = NodeData{.transform = transform, .mesh_index = mesh_index};
+		const auto light_index = node.lightIndex.transform([](auto idx) { return uint32_t(idx); });
+		const auto skin_index = node.skinIndex.transform([](auto idx) { return uint32_t(idx); });
+		const auto data = NodeData{
+			.transform = transform,
+			.mesh_index = mesh_index,
+			.light_index = light_index,
+			.skin_index = skin_index,
+		};
 
 		return ChildOnlyNode{.child_indices = std::move(child_indices), .data = data};
 	}
@@ -0,0 +1,190 @@
+#include "http.hpp"
+#include "common/util/error.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef MODEL_GLTF_HTTP
+#include <curl/curl.h>
+#endif
+
+namespace model::gltf::impl::http
+{
+	bool is_url(std::string_view uri) noexcept
+	{
+		return uri.starts_with("http://") || uri.starts_with("https://");
+	}
+
+	std::string resolve(std::string_view base_url, std::string_view reference) noexcept
+	{
+		if (is_url(reference)) return std::string(reference);
+
+		// Absolute path, relative to the authority of the base
+		if (reference.starts_with('/'))
+		{
+			const auto authority_begin = base_url.find("://") + 3;
+			const auto path_begin = base_url.find('/', authority_begin);
+			return std::format("{}{}", base_url.substr(0, path_begin), reference);
+		}
+
+		// Relative path, replaces the last segment of the base without its query
+		const auto base_path = base_url.substr(0, base_url.find_first_of("?#"));
+		return std::format("{}{}", base_path.substr(0, base_path.rfind('/') + 1), reference);
+	}
+
+#ifdef MODEL_GLTF_HTTP
+	namespace
+	{
+		size_t write_body(char* data, size_t size, size_t count, void* user_data) noexcept
+		{
+			auto& body = *static_cast<std::vector<std::byte>*>(user_data);
+			const auto bytes = std::as_bytes(std::span(data, size * count));
+			body.insert(body.end(), bytes.begin(), bytes.end());
+			return bytes.size();
+		}
+
+		using MultiHandle = std::unique_ptr<CURLM, decltype(&curl_multi_cleanup)>;
+		using EasyHandle = std::unique_ptr<CURL, decltype(&curl_easy_cleanup)>;
+	}
+
+	std::expected<std::vector<std::vector<std::byte>>, Error> fetch(
+		std::span<const Request> requests,
+		std::stop_token stop_token
+	) noexcept
+	{
+		static const auto global_result = curl_global_init(CURL_GLOBAL_DEFAULT);
+		if (global_result != CURLE_OK)
+			return Error("Initialize libcurl failed", curl_easy_strerror(global_result));
+
+		auto bodies = std::vector<std::vector<std::byte>>(requests.size());
+
+		const auto multi = MultiHandle(curl_multi_init(), curl_multi_cleanup);
+		if (multi == nullptr) return Error("Create libcurl multi handle failed");
+
+		constexpr auto max_connections = static_cast<long>(MAX_PARALLEL_REQUESTS);
+		curl_multi_setopt(multi.get(), CURLMOPT_MAX_TOTAL_CONNECTIONS, max_connections);
+		curl_multi_setopt(multi.get(), CURLMOPT_MAX_HOST_CONNECTIONS, max_connections);
+
+		// Removed from the multi handle on cleanup, before it
+		auto handles = std::vector<EasyHandle>();
+		handles.reserve(requests.size());
+
+		for (const auto [index, request] : std::views::enumerate(requests))
+		{
+			auto handle = EasyHandle(curl_easy_init(), curl_easy_cleanup);
+			if (handle == nullptr) return Error("Create libcurl handle failed");
+
+			curl_easy_setopt(handle.get(), CURLOPT_URL, request.url.c_str());
+			curl_easy_setopt(handle.get(), CURLOPT_FOLLOWLOCATION, 1L);
+			curl_easy_setopt(handle.get(), CURLOPT_FAILONERROR, 1L);
+			curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, write_body);
+			curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, &bodies[index]);
+			curl_easy_setopt(handle.get(), CURLOPT_PRIVATE, reinterpret_cast<void*>(uintptr_t(index)));
+
+			if (request.range.has_value())
+			{
+				const auto& [offset, size] = *request.range;
+				if (size == 0) continue;
+
+				// Copied by libcurl
+				const auto range = std::format("{}-{}", offset, offset + size - 1);
+				curl_easy_setopt(handle.get(), CURLOPT_RANGE, range.c_str());
+				bodies[index].reserve(size);
+			}
+
+			const auto add_result = curl_multi_add_handle(multi.get(), handle.get());
+			if (add_result != CURLM_OK)
+				return Error("Add HTTP request failed", curl_multi_strerror(add_result));
+
+			handles.push_back(std::move(handle));
+		}
+
+		/* Perform */
+
+		int running = 1;
+		while (running > 0)
+		{
+			if (stop_token.stop_requested()) return Error("Cancelled");
+
+			const auto perform_result = curl_multi_perform(multi.get(), &running);
+			if (perform_result != CURLM_OK)
+				return Error("Perform HTTP requests failed", curl_multi_strerror(perform_result));
+
+			int queued = 0;
+			while (const auto* message = curl_multi_info_read(multi.get(), &queued))
+			{
+				if (message->msg != CURLMSG_DONE || message->data.result == CURLE_OK) continue;
+
+				char* private_data = nullptr;
+				curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &private_data);
+				const auto& request = requests[reinterpret_cast<uintptr_t>(private_data)];
+
+				return Error(
+					"HTTP request failed",
+					std::format("URL: {}, {}", request.url, curl_easy_strerror(message->data.result))
+				);
+			}
+
+			// Wakes up early on activity, the timeout bounds the latency of a stop request
+			if (running > 0) curl_multi_poll(multi.get(), nullptr, 0, 100, nullptr);
+		}
+
+		/* Validate ranges */
+
+		for (const auto& handle : handles)
+		{
+			char* private_data = nullptr;
+			curl_easy_getinfo(handle.get(), CURLINFO_PRIVATE, &private_data);
+			const auto index = reinterpret_cast<uintptr_t>(private_data);
+
+			const auto& request = requests[index];
+			if (!request.range.has_value()) continue;
+			const auto& [offset, size] = *request.range;
+
+			long response_code = 0;
+			curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &response_code);
+
+			auto& body = bodies[index];
+
+			// Servers without range support send the whole resource, keep the requested range of it
+			if (response_code == 200 && body.size() >= offset + size)
+			{
+				body.erase(body.begin() + offset + size, body.end());
+				body.erase(body.begin(), body.begin() + offset);
+			}
+
+			if (body.size() != size)
+			{
+				return Error(
+					"HTTP range response size mismatch",
+					std::format("URL: {}, expected {} bytes, got {}", request.url, size, body.size())
+				);
+			}
+		}
+
+		return bodies;
+	}
+#else
+	std::expected<std::vector<std::vector<std::byte>>, Error> fetch(
+		std::span<const Request> requests,
+		std::stop_token
+	) noexcept
+	{
+		if (requests.empty()) return {};
+
+		return Error(
+			"Built without HTTP support, enable option \"http\"",
+			std::format("URL: {}", requests.front().url)
+		);
+	}
+#endif
+}
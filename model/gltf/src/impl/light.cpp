@@ -0,0 +1,42 @@
+#include "light.hpp"
+#include "fastgltf-vec.hpp"
+#include "model/light.hpp"
+
+#include <fastgltf/types.hpp>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+namespace model::gltf::impl
+{
+	Light parse_light(const fastgltf::Light& light) noexcept
+	{
+		const auto type = [&light] {
+			switch (light.type)
+			{
+			case fastgltf::LightType::Directional:
+				return LightType::Directional;
+			case fastgltf::LightType::Spot:
+				return LightType::Spot;
+			default:
+				return LightType::Point;
+			}
+		}();
+
+		const auto default_light = Light{};
+
+		return Light{
+			.type = type,
+			.color = to_glm(light.color),
+			.intensity = light.intensity,
+			.range = light.range.has_value() ? std::optional(float(*light.range)) : std::nullopt,
+			.inner_cone_angle = light.innerConeAngle.value_or(default_light.inner_cone_angle),
+			.outer_cone_angle = light.outerConeAngle.value_or(default_light.outer_cone_angle),
+		};
+	}
+
+	std::vector<Light> parse_lights(const fastgltf::Asset& asset) noexcept
+	{
+		return asset.lights | std::views::transform(parse_light) | std::ranges::to<std::vector>();
+	}
+}
@@ -1,31 +1,398 @@
 #include "mesh.hpp"
 #include "asset.hpp"
 #include "common/number-literals.hpp"
+#include "common/util/arena.hpp"
 #include "common/util/async.hpp"
 #include "common/util/construct.hpp"
 #include "common/util/error.hpp"
+#include "common/util/trace.hpp"
+#include "fastgltf-vec.hpp"
+#include "meshopt.hpp"
 #include "model/mesh.hpp"
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <coro/task.hpp>
 #include <coro/thread_pool.hpp>
 #include <coro/when_all.hpp>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <expected>
 #include <fastgltf/glm_element_traits.hpp>
 #include <fastgltf/tools.hpp>
 #include <fastgltf/types.hpp>
 #include <format>
 #include <functional>
+#include <glm/ext/matrix_float3x2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
 #include <glm/fwd.hpp>
+#include <limits>
+#include <numeric>
 #include <ranges>
+#include <span>
+#include <stop_token>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 namespace model::gltf::impl
 {
+	// (Helper) Get the `KHR_texture_transform` of the primitive's material, from its first transformed
+	// texture. `nullptr` if none is transformed
+	[[nodiscard]]
+	static const fastgltf::TextureTransform* get_texture_transform(
+		const Asset& asset,
+		const fastgltf::Primitive& primitive
+	) noexcept
+	{
+		if (!primitive.materialIndex.has_value() || *primitive.materialIndex >= asset.materials.size())
+			return nullptr;
+
+		const auto& material = asset.materials[*primitive.materialIndex];
+		const auto get_transform = [](const auto& texture_info) -> const fastgltf::TextureTransform* {
+			return texture_info.has_value() ? texture_info->transform.get() : nullptr;
+		};
+
+		const auto transforms = std::to_array({
+			get_transform(material.pbrData.baseColorTexture),
+			get_transform(material.normalTexture),
+			get_transform(material.pbrData.metallicRoughnessTexture),
+			get_transform(material.emissiveTexture),
+		});
+
+		const auto transform_it = std::ranges::find_if(transforms, [](const auto* transform) {
+			return transform != nullptr;
+		});
+		return transform_it == transforms.end() ? nullptr : *transform_it;
+	}
+
+	// (Helper) Get the matrix of a texture transform, as `translation * rotation * scale`
+	[[nodiscard]]
+	static glm::mat3x2 get_texture_transform_matrix(const fastgltf::TextureTransform& transform) noexcept
+	{
+		const auto offset = to_glm<2>(transform.uvOffset);
+		const auto scale = to_glm<2>(transform.uvScale);
+		const auto cos = std::cos(transform.rotation);
+		const auto sin = std::sin(transform.rotation);
+
+		return {
+			glm::vec2(cos * scale.x, -sin * scale.x),
+			glm::vec2(sin * scale.y, cos * scale.y),
+			offset,
+		};
+	}
+
+	// (Helper) Bake a texture transform into texcoords, no-op if `transform` is `nullptr`
+	static void apply_texture_transform(
+		const fastgltf::TextureTransform* transform,
+		auto&& texcoords
+	) noexcept
+	{
+		if (transform == nullptr) return;
+
+		const auto matrix = get_texture_transform_matrix(*transform);
+		for (glm::vec2& texcoord : texcoords) texcoord = matrix * glm::vec3(texcoord, 1.0f);
+	}
+
+#ifdef __AVX2__
+	// (Helper) Load the first 4 components of two elements, widened to 32-bit integers
+	template <typename C>
+	[[nodiscard]]
+	static __m256i load_element_pair(const std::byte* first, const std::byte* second) noexcept
+	{
+		if constexpr (sizeof(C) == 1)
+		{
+			int32_t first_bits;
+			int32_t second_bits;
+			std::memcpy(&first_bits, first, sizeof(first_bits));
+			std::memcpy(&second_bits, second, sizeof(second_bits));
+
+			const auto packed = _mm_setr_epi32(first_bits, second_bits, 0, 0);
+			return std::is_signed_v<C> ? _mm256_cvtepi8_epi32(packed) : _mm256_cvtepu8_epi32(packed);
+		}
+		else
+		{
+			int64_t first_bits;
+			int64_t second_bits;
+			std::memcpy(&first_bits, first, sizeof(first_bits));
+			std::memcpy(&second_bits, second, sizeof(second_bits));
+
+			const auto packed = _mm_set_epi64x(second_bits, first_bits);
+			return std::is_signed_v<C> ? _mm256_cvtepi16_epi32(packed) : _mm256_cvtepu16_epi32(packed);
+		}
+	}
+#endif
+
+	// (Helper) Convert elements of `N` integer components of type `C` into floats, written `Stride` bytes
+	// apart. Two elements are converted per iteration with AVX2 when available
+	template <typename C, bool Normalized, glm::length_t N, size_t Stride>
+	static void convert_components(
+		std::span<const std::byte> source,
+		size_t source_stride,
+		size_t count,
+		std::byte* destination
+	) noexcept
+	{
+		static constexpr float SCALE =
+			Normalized ? 1.0f / static_cast<float>(std::numeric_limits<C>::max()) : 1.0f;
+
+		// The smallest signed normalized value is below -1, clamped as glTF specifies
+		static constexpr bool CLAMP = Normalized && std::is_signed_v<C>;
+
+		size_t index = 0;
+
+#ifdef __AVX2__
+		const auto scale = _mm256_set1_ps(SCALE);
+		const auto lower_bound = _mm256_set1_ps(CLAMP ? -1.0f : std::numeric_limits<float>::lowest());
+		const auto mask = _mm_setr_epi32(-1, -1, N >= 3 ? -1 : 0, N >= 4 ? -1 : 0);
+
+		// 4 components are loaded per element, stop before a load runs past the source
+		static constexpr size_t LOAD_SIZE = 4 * sizeof(C);
+
+		for (; index + 1 < count && (index + 1) * source_stride + LOAD_SIZE <= source.size(); index += 2)
+		{
+			const auto* const element = source.data() + index * source_stride;
+			const auto integers = load_element_pair<C>(element, element + source_stride);
+			const auto scaled = _mm256_mul_ps(_mm256_cvtepi32_ps(integers), scale);
+			const auto floats = _mm256_max_ps(scaled, lower_bound);
+
+			auto* const first_target = reinterpret_cast<float*>(destination + index * Stride);
+			auto* const second_target = reinterpret_cast<float*>(destination + (index + 1) * Stride);
+			_mm_maskstore_ps(first_target, mask, _mm256_castps256_ps128(floats));
+			_mm_maskstore_ps(second_target, mask, _mm256_extractf128_ps(floats, 1));
+		}
+#endif
+
+		for (; index < count; index++)
+		{
+			const auto* const element = source.data() + index * source_stride;
+			auto* const target = destination + index * Stride;
+
+			for (const auto component : std::views::iota(0, N))
+			{
+				C value;
+				std::memcpy(&value, element + component * sizeof(C), sizeof(C));
+
+				auto converted = static_cast<float>(value) * SCALE;
+				if constexpr (CLAMP) converted = std::max(converted, -1.0f);
+
+				std::memcpy(target + component * sizeof(float), &converted, sizeof(float));
+			}
+		}
+	}
+
+	// (Helper) Convert an integer accessor (`KHR_mesh_quantization`) of `N` components with
+	// `convert_components`. Returns `false` if the accessor isn't one, e.g. float or sparse accessors
+	template <glm::length_t N, size_t Stride>
+	[[nodiscard]]
+	static std::expected<bool, Error> convert_integer_accessor(
+		Asset& asset,
+		const fastgltf::Accessor& accessor,
+		std::byte* destination
+	) noexcept
+	{
+		if (accessor.sparse.has_value() || !accessor.bufferViewIndex.has_value()) return false;
+		if (std::cmp_not_equal(fastgltf::getNumComponents(accessor.type), N)) return false;
+
+		const auto view_index = *accessor.bufferViewIndex;
+		const auto view_data = asset.accessor_interface(asset, view_index);
+		const auto element_size = fastgltf::getElementByteSize(accessor.type, accessor.componentType);
+		const auto source_stride = asset.bufferViews[view_index].byteStride.value_or(element_size);
+
+		if (accessor.count > 0
+			&& accessor.byteOffset + (accessor.count - 1) * source_stride + element_size > view_data.size())
+			return Error("Accessor out of bounds of its buffer view");
+
+		const auto source = view_data.subspan(std::min(accessor.byteOffset, view_data.size()));
+
+		const auto convert = [&]<typename C>(std::type_identity<C>) {
+			if (accessor.normalized)
+				convert_components<C, true, N, Stride>(source, source_stride, accessor.count, destination);
+			else
+				convert_components<C, false, N, Stride>(source, source_stride, accessor.count, destination);
+			return true;
+		};
+
+		switch (accessor.componentType)
+		{
+		case fastgltf::ComponentType::Byte:
+			return convert(std::type_identity<int8_t>());
+		case fastgltf::ComponentType::UnsignedByte:
+			return convert(std::type_identity<uint8_t>());
+		case fastgltf::ComponentType::Short:
+			return convert(std::type_identity<int16_t>());
+		case fastgltf::ComponentType::UnsignedShort:
+			return convert(std::type_identity<uint16_t>());
+		default:
+			return false;
+		}
+	}
+
+	// (Helper) Read an accessor into elements of type `T` placed `Stride` bytes apart, converting and
+	// interleaving in a single pass
+	template <typename T, size_t Stride>
+	[[nodiscard]]
+	static std::expected<void, Error> read_accessor_strided(
+		Asset& asset,
+		const fastgltf::Accessor& accessor,
+		std::byte* destination
+	) noexcept
+	{
+		const auto converted_result =
+			convert_integer_accessor<T::length(), Stride>(asset, accessor, destination);
+		if (!converted_result) return converted_result.error();
+		if (*converted_result) return {};
+
+		fastgltf::copyFromAccessor<T, Stride>(
+			asset,
+			accessor,
+			destination,
+			[&asset](const fastgltf::Asset&, size_t buffer_view_idx) {
+				return asset.accessor_interface(asset, buffer_view_idx);
+			}
+		);
+
+		return {};
+	}
+
+	// (Helper) Read an accessor into a member of each vertex, sized to the accessor count
+	template <typename V, typename T, typename A>
+	[[nodiscard]]
+	static std::expected<void, Error> read_accessor(
+		Asset& asset,
+		const fastgltf::Accessor& accessor,
+		std::vector<V, A>& vertices,
+		T V::* member
+	) noexcept
+	{
+		if (vertices.empty()) return {};
+
+		auto* const destination = reinterpret_cast<std::byte*>(&(vertices.front().*member));
+		return read_accessor_strided<T, sizeof(V)>(asset, accessor, destination);
+	}
+
+	// (Helper) Read an accessor into tightly packed elements, sized to the accessor count
+	template <typename T, typename A>
+	[[nodiscard]]
+	static std::expected<void, Error> read_accessor(
+		Asset& asset,
+		const fastgltf::Accessor& accessor,
+		std::vector<T, A>& elements
+	) noexcept
+	{
+		auto* const destination = reinterpret_cast<std::byte*>(elements.data());
+		return read_accessor_strided<T, sizeof(T)>(asset, accessor, destination);
+	}
+
+	// (Helper) Check whether `parse_geometry` keeps the vertices in the order of the accessors, which
+	// deformations index into. Other primitives are expanded and welded
+	[[nodiscard]]
+	static bool keeps_vertex_order(const fastgltf::Primitive& primitive) noexcept
+	{
+		return primitive.findAttribute("NORMAL") != primitive.attributes.end()
+			&& primitive.findAttribute("TEXCOORD_0") != primitive.attributes.end();
+	}
+
+	// (Helper) Read the skin binding (`JOINTS_0`, `WEIGHTS_0`) and morph targets of a primitive
+	[[nodiscard]]
+	static std::expected<Deformation, Error> parse_deformation(
+		Asset& asset,
+		const fastgltf::Primitive& primitive,
+		size_t vertex_count
+	) noexcept
+	{
+		const auto adapter = [&asset](const fastgltf::Asset&, size_t buffer_view_idx) {
+			return asset.accessor_interface(asset, buffer_view_idx);
+		};
+
+		Deformation deformation;
+
+		/* Skin */
+
+		const auto joints_attribute = primitive.findAttribute("JOINTS_0");
+		const auto weights_attribute = primitive.findAttribute("WEIGHTS_0");
+
+		if (joints_attribute != primitive.attributes.end() && weights_attribute != primitive.attributes.end())
+		{
+			const auto& joints_accessor = asset.accessors[joints_attribute->accessorIndex];
+			const auto& weights_accessor = asset.accessors[weights_attribute->accessorIndex];
+
+			if (joints_accessor.count != vertex_count || weights_accessor.count != vertex_count)
+				return Error(
+					"Skin attribute count mismatches POSITION",
+					std::format(
+						"POSITION: {}, JOINTS_0: {}, WEIGHTS_0: {}",
+						vertex_count,
+						joints_accessor.count,
+						weights_accessor.count
+					)
+				);
+
+			deformation.skin.resize(vertex_count);
+
+			// Joint indices are integers, read without the normalizing conversion of `read_accessor`
+			fastgltf::copyFromAccessor<glm::u16vec4, sizeof(VertexSkin)>(
+				asset,
+				joints_accessor,
+				&deformation.skin.front().joints,
+				adapter
+			);
+
+			const auto weights_result =
+				read_accessor(asset, weights_accessor, deformation.skin, &VertexSkin::weights);
+			if (!weights_result) return weights_result.error().forward("Read WEIGHTS_0 failed");
+		}
+
+		/* Morph targets */
+
+		for (const auto target_idx : std::views::iota(0zu, primitive.targets.size()))
+		{
+			const auto find_target_accessor = [&](std::string_view name) -> const fastgltf::Accessor* {
+				const auto attribute = primitive.findTargetAttribute(target_idx, name);
+				if (attribute == primitive.targets[target_idx].end()) return nullptr;
+				return &asset.accessors[attribute->accessorIndex];
+			};
+
+			const auto* const position_accessor = find_target_accessor("POSITION");
+			const auto* const normal_accessor = find_target_accessor("NORMAL");
+
+			if ((position_accessor != nullptr && position_accessor->count != vertex_count)
+				|| (normal_accessor != nullptr && normal_accessor->count != vertex_count))
+				return Error(
+					"Morph target attribute count mismatches POSITION",
+					std::format("Morph target #{}, POSITION: {}", target_idx, vertex_count)
+				);
+
+			// Targets without POSITION only displace normals
+			auto target = MorphTarget{.position_deltas = std::vector(vertex_count, glm::vec3(0.0f))};
+
+			if (position_accessor != nullptr)
+			{
+				const auto result = read_accessor(asset, *position_accessor, target.position_deltas);
+				if (!result) return result.error().forward("Read morph target POSITION failed");
+			}
+
+			if (normal_accessor != nullptr)
+			{
+				target.normal_deltas.resize(vertex_count);
+				if (const auto result = read_accessor(asset, *normal_accessor, target.normal_deltas); !result)
+					return result.error().forward("Read morph target NORMAL failed");
+			}
+
+			deformation.morph_targets.push_back(std::move(target));
+		}
+
+		return deformation;
+	}
+
 	std::expected<Geometry, Error> parse_geometry(Asset& asset, const fastgltf::Primitive& primitive) noexcept
 	{
 		/* Validate supported types */
@@ -56,22 +423,14 @@ namespace model::gltf::impl
 			return Error("Missing POSITION attribute in primitive");
 
 		const auto& position_accessor = asset.accessors[position_attribute->accessorIndex];
-		std::vector<glm::vec3> positions(position_accessor.count);
-		fastgltf::copyFromAccessor<glm::vec3>(
-			asset,
-			position_accessor,
-			positions.data(),
-			[&asset](const fastgltf::Asset&, size_t buffer_view_idx) {
-				return asset.accessor_interface(asset, buffer_view_idx);
-			}
-		);
+		const auto vertex_count = position_accessor.count;
 
 		/* Indices */
 
 		std::vector<uint32_t> indices;
 		if (!primitive.indicesAccessor.has_value())
 		{
-			indices = std::vector(std::from_range, std::views::iota(0_u32, position_accessor.count));
+			indices = std::vector(std::from_range, std::views::iota(0_u32, vertex_count));
 		}
 		else
 		{
@@ -109,35 +468,143 @@ namespace model::gltf::impl
 			);
 		}
 
-		auto expanded_indices =
-			std::vector(std::from_range, std::views::iota(0_u32, static_cast<uint32_t>(indices.size())));
+		/* TEXCOORD, NORMAL and TANGENT */
+
+		const auto find_accessor = [&asset, &primitive](std::string_view name) -> const fastgltf::Accessor* {
+			const auto attribute = primitive.findAttribute(name);
+			if (attribute == primitive.attributes.end()) return nullptr;
+			return &asset.accessors[attribute->accessorIndex];
+		};
+
+		const auto* const texcoord_accessor = find_accessor("TEXCOORD_0");
+		const auto* const normal_accessor = find_accessor("NORMAL");
+		const auto* const tangent_accessor = find_accessor("TANGENT");
+
+		const bool has_texcoord = texcoord_accessor != nullptr;
+		const bool has_normal = normal_accessor != nullptr;
+		const bool has_tangent = tangent_accessor != nullptr;
+
+		/* Validate attribute counts */
 
-		/* Expand POSITION */
+		const auto get_count = [](const fastgltf::Accessor* accessor) {
+			return accessor == nullptr ? 0zu : accessor->count;
+		};
+
+		if ((has_texcoord && texcoord_accessor->count != vertex_count)
+			|| (has_normal && normal_accessor->count != vertex_count)
+			|| (has_tangent && tangent_accessor->count != vertex_count))
+		{
+			return Error(
+				"Attribute count mismatches POSITION",
+				std::format(
+					"POSITION: {}, TEXCOORD_0: {}, NORMAL: {}, TANGENT: {}",
+					vertex_count,
+					get_count(texcoord_accessor),
+					get_count(normal_accessor),
+					get_count(tangent_accessor)
+				)
+			);
+		}
 
-		auto expanded_positions_result = util::expand_indices<glm::vec3>(indices, positions);
+		// Textures are sampled untransformed, so the transform is baked into the texcoords. This also
+		// dequantizes texcoords stored in integers (`KHR_mesh_quantization`)
+		const auto* const texture_transform = get_texture_transform(asset, primitive);
+
+		// Temporaries are freed once the geometry is created, allocated from the scratch resource
+		auto& scratch_resource = *asset.scratch_resource;
+
+		/* Keep indexing when no per-triangle attribute is needed */
+
+		// Attributes are converted and interleaved straight into the vertices
+		if (has_normal && has_texcoord)
+		{
+			if (has_tangent)
+			{
+				auto vertices = std::vector<FullVertex>(vertex_count);
+
+				const auto read_result =
+					read_accessor(asset, position_accessor, vertices, &FullVertex::position)
+						.and_then([&] {
+							return read_accessor(asset, *texcoord_accessor, vertices, &FullVertex::texcoord);
+						})
+						.and_then([&] {
+							return read_accessor(asset, *normal_accessor, vertices, &FullVertex::normal);
+						})
+						.and_then([&] {
+							return read_accessor(asset, *tangent_accessor, vertices, &FullVertex::tangent);
+						});
+				if (!read_result) return read_result.error().forward("Read vertex attributes failed");
+
+				auto vertex_texcoords = vertices | std::views::transform(&FullVertex::texcoord);
+				apply_texture_transform(texture_transform, vertex_texcoords);
+
+				return Geometry::create(std::move(vertices), std::move(indices));
+			}
+
+			auto vertices = ::util::ScratchVector<NormalOnlyVertex>(vertex_count, &scratch_resource);
+
+			const auto read_result =
+				read_accessor(asset, position_accessor, vertices, &NormalOnlyVertex::position)
+					.and_then([&] {
+						return read_accessor(
+							asset,
+							*texcoord_accessor,
+							vertices,
+							&NormalOnlyVertex::texcoord
+						);
+					})
+					.and_then([&] {
+						return read_accessor(asset, *normal_accessor, vertices, &NormalOnlyVertex::normal);
+					});
+			if (!read_result) return read_result.error().forward("Read vertex attributes failed");
+
+			auto vertex_texcoords = vertices | std::views::transform(&NormalOnlyVertex::texcoord);
+			apply_texture_transform(texture_transform, vertex_texcoords);
+
+			auto full_vertices_result = util::generate_tangents(vertices, indices, scratch_resource);
+			if (!full_vertices_result)
+				return full_vertices_result.error().forward("Generate tangents failed");
+
+			return Geometry::create(std::move(*full_vertices_result), std::move(indices));
+		}
+
+		/* Generate per-triangle attributes */
+
+		// Flat normals (as required by glTF when NORMAL is missing) and fallback texcoords differ between
+		// triangles sharing a vertex, so indices are expanded first and the result is welded afterwards
+
+		auto positions = ::util::ScratchVector<glm::vec3>(vertex_count, &scratch_resource);
+		if (const auto result = read_accessor(asset, position_accessor, positions); !result)
+			return result.error().forward("Read POSITION failed");
+
+		auto texcoords = ::util::ScratchVector<glm::vec2>(&scratch_resource);
+		if (has_texcoord)
+		{
+			texcoords.resize(vertex_count);
+			if (const auto result = read_accessor(asset, *texcoord_accessor, texcoords); !result)
+				return result.error().forward("Read TEXCOORD_0 failed");
+
+			apply_texture_transform(texture_transform, texcoords);
+		}
+
+		auto normals = ::util::ScratchVector<glm::vec3>(&scratch_resource);
+		if (has_normal)
+		{
+			normals.resize(vertex_count);
+			if (const auto result = read_accessor(asset, *normal_accessor, normals); !result)
+				return result.error().forward("Read NORMAL failed");
+		}
+
+		auto expanded_positions_result =
+			util::expand_indices<glm::vec3>(indices, positions, scratch_resource);
 		if (!expanded_positions_result)
 			return expanded_positions_result.error().forward("Expand position indices failed");
 		positions = std::move(*expanded_positions_result);
 
-		/* TEXCOORD, NORMAL and TANGENT */
-
-		const auto texcoord_attribute = primitive.findAttribute("TEXCOORD_0");
-		const bool has_texcoord = texcoord_attribute != primitive.attributes.end();
-		std::vector<glm::vec2> texcoords;
 		if (has_texcoord)
 		{
-			const auto& texcoord_accessor = asset.accessors[texcoord_attribute->accessorIndex];
-			texcoords.resize(texcoord_accessor.count);
-			fastgltf::copyFromAccessor<glm::vec2>(
-				asset,
-				texcoord_accessor,
-				texcoords.data(),
-				[&asset](const fastgltf::Asset&, size_t buffer_view_idx) {
-					return asset.accessor_interface(asset, buffer_view_idx);
-				}
-			);
-
-			auto expanded_texcoords_result = util::expand_indices<glm::vec2>(indices, texcoords);
+			auto expanded_texcoords_result =
+				util::expand_indices<glm::vec2>(indices, texcoords, scratch_resource);
 			if (!expanded_texcoords_result)
 				return expanded_texcoords_result.error().forward("Expand texcoord indices failed");
 			texcoords = std::move(*expanded_texcoords_result);
@@ -154,130 +621,101 @@ namespace model::gltf::impl
 			);
 		}
 
-		const auto normal_attribute = primitive.findAttribute("NORMAL");
-		const bool has_normal = normal_attribute != primitive.attributes.end();
-		std::vector<glm::vec3> normals;
+		auto expanded_indices = ::util::ScratchVector<uint32_t>(indices.size(), &scratch_resource);
+		std::ranges::iota(expanded_indices, 0_u32);
+
+		auto vertices = ::util::ScratchVector<FullVertex>(&scratch_resource);
+
 		if (has_normal)
 		{
-			const auto& normal_accessor = asset.accessors[normal_attribute->accessorIndex];
-			normals.resize(normal_accessor.count);
-			fastgltf::copyFromAccessor<glm::vec3>(
-				asset,
-				normal_accessor,
-				normals.data(),
-				[&asset](const fastgltf::Asset&, size_t buffer_view_idx) {
-					return asset.accessor_interface(asset, buffer_view_idx);
-				}
-			);
-
-			auto expanded_normals_result = util::expand_indices<glm::vec3>(indices, normals);
+			auto expanded_normals_result =
+				util::expand_indices<glm::vec3>(indices, normals, scratch_resource);
 			if (!expanded_normals_result)
 				return expanded_normals_result.error().forward("Expand normal indices failed");
 			normals = std::move(*expanded_normals_result);
-		}
-
-		const auto tangent_attribute = primitive.findAttribute("TANGENT");
-		const bool has_tangent = tangent_attribute != primitive.attributes.end();
-		std::vector<glm::vec4> tangents;
-		if (has_tangent)
-		{
-			const auto& tangent_accessor = asset.accessors[tangent_attribute->accessorIndex];
-			tangents.resize(tangent_accessor.count);
-			fastgltf::copyFromAccessor<glm::vec4>(
-				asset,
-				tangent_accessor,
-				tangents.data(),
-				[&asset](const fastgltf::Asset&, size_t buffer_view_idx) {
-					return asset.accessor_interface(asset, buffer_view_idx);
-				}
-			);
-
-			auto expanded_tangents_result = util::expand_indices<glm::vec4>(indices, tangents);
-			if (!expanded_tangents_result)
-				return expanded_tangents_result.error().forward("Expand tangent indices failed");
-			tangents = std::move(*expanded_tangents_result);
-		}
-
-		/* Calculate missing values */
-
-		// Full vertex
-		if (has_tangent && has_normal && has_texcoord)
-		{
-			auto vertices =
-				std::views::zip_transform(CTOR_LAMBDA(FullVertex), positions, texcoords, normals, tangents)
-				| std::ranges::to<std::vector>();
 
-			return Geometry::create(std::move(vertices), std::move(expanded_indices));
+			vertices = std::views::zip_transform(CTOR_LAMBDA(NormalOnlyVertex), positions, texcoords, normals)
+				| std::views::chunk(3)
+				| std::views::transform([](const auto& triangle) {
+					  return NormalOnlyVertex::construct_tangent(
+						  std::to_array({triangle[0], triangle[1], triangle[2]})
+					  );
+				  })
+				| std::views::join
+				| std::ranges::to<::util::ScratchVector<FullVertex>>(&scratch_resource);
 		}
-
-		// Normal only vertex
-		if (has_normal)
+		else
 		{
-			auto vertices =
-				std::views::zip_transform(CTOR_LAMBDA(NormalOnlyVertex), positions, texcoords, normals)
+			vertices = std::views::zip_transform(CTOR_LAMBDA(MinimumVertex), positions, texcoords)
 				| std::views::chunk(3)
 				| std::views::transform([](const auto& triangle) {
 					  return NormalOnlyVertex::construct_tangent(
-						  std::to_array({triangle[0], triangle[1], triangle[2]})
+						  MinimumVertex::construct_normal(
+							  std::to_array({triangle[0], triangle[1], triangle[2]})
+						  )
 					  );
 				  })
 				| std::views::join
-				| std::ranges::to<std::vector>();
-
-			return Geometry::create(std::move(vertices), std::move(expanded_indices));
+				| std::ranges::to<::util::ScratchVector<FullVertex>>(&scratch_resource);
 		}
 
-		// Minimum vertex
-
-		auto vertices =
-			std::views::zip_transform(CTOR_LAMBDA(MinimumVertex), positions, texcoords)
-			| std::views::adjacent<3>
-			| std::views::transform([](const auto& triangle) {
-				  return NormalOnlyVertex::construct_tangent(
-					  MinimumVertex::construct_normal(
-						  std::to_array({std::get<0>(triangle), std::get<1>(triangle), std::get<2>(triangle)})
-					  )
-				  );
-			  })
-			| std::views::join
-			| std::ranges::to<std::vector>();
-
-		return Geometry::create(std::move(vertices), std::move(expanded_indices));
+		auto welded = util::weld_vertices(vertices, expanded_indices, scratch_resource);
+		return Geometry::create(std::move(welded.vertices), std::move(welded.indices));
 	}
 
 	coro::task<std::expected<Primitive, Error>> parse_primitive(
 		coro::thread_pool& thread_pool,
 		::util::Progress& progress,
+		std::stop_token stop_token,
 		Asset& asset,
 		const fastgltf::Primitive& primitive
 	) noexcept
 	{
 		co_await thread_pool.schedule();
 
+		if (stop_token.stop_requested()) co_return Error("Cancelled");
+
+		const auto trace = ::util::trace::Scope("Parse primitive");
+
 		auto geometry_result = parse_geometry(asset, primitive);
 		progress.increment();
 		if (!geometry_result) co_return geometry_result.error().forward("Parse geometry failed");
 
+		// Welded primitives no longer match the accessors, and are left undeformed
+		auto deformation = Deformation();
+		if (keeps_vertex_order(primitive))
+		{
+			auto deformation_result = parse_deformation(asset, primitive, geometry_result->vertices.size());
+			if (!deformation_result) co_return deformation_result.error().forward("Parse deformation failed");
+			deformation = std::move(*deformation_result);
+		}
+
 		co_return Primitive{
 			.geometry = std::move(*geometry_result),
+			.lods = {},
 			.material_index =
 				primitive.materialIndex.transform([](size_t idx) { return static_cast<uint32_t>(idx); }),
+			.deformation = std::move(deformation),
 		};
 	}
 
 	coro::task<std::expected<Mesh, Error>> parse_mesh(
 		coro::thread_pool& thread_pool,
 		::util::Progress& progress,
+		std::stop_token stop_token,
 		Asset& asset,
 		const fastgltf::Mesh& mesh
 	) noexcept
 	{
 		co_await thread_pool.schedule();
 
+		// Spans the primitives parsed in parallel, until the last of them finishes
+		const auto trace = ::util::trace::Scope("Parse mesh");
+
 		auto primitive_tasks =
 			mesh.primitives
-			| std::views::transform([&thread_pool, &progress, &asset](const auto& primitive) {
-				  return parse_primitive(thread_pool, progress, asset, primitive);
+			| std::views::transform([&thread_pool, &progress, &stop_token, &asset](const auto& primitive) {
+				  return parse_primitive(thread_pool, progress, stop_token, asset, primitive);
 			  })
 			| std::ranges::to<std::vector>();
 
@@ -287,15 +725,25 @@ namespace model::gltf::impl
 
 		if (!primitive_result) co_return primitive_result.error().forward("Parse primitives failed");
 
-		co_return Mesh{.primitives = std::move(*primitive_result)};
+		// Targets default to zero weights when the mesh has none
+		auto morph_weights = std::vector<float>(std::from_range, mesh.weights);
+		if (morph_weights.empty() && !mesh.primitives.empty())
+			morph_weights.resize(mesh.primitives.front().targets.size(), 0.0f);
+
+		co_return Mesh{.primitives = std::move(*primitive_result), .morph_weights = std::move(morph_weights)};
 	}
 
 	coro::task<std::expected<std::vector<Mesh>, Error>> parse_meshes(
 		coro::thread_pool& thread_pool,
 		::util::Progress& progress,
+		std::stop_token stop_token,
 		Asset& asset
 	) noexcept
 	{
+		// Compressed buffer views are decoded upfront, accessors then read them like any other buffer view
+		if (const auto result = co_await decode_meshopt_views(thread_pool, asset); !result)
+			co_return result.error().forward("Decode meshopt compressed buffer views failed");
+
 		const auto total_primitives = std::ranges::fold_left(
 			asset.meshes | std::views::transform([](const auto& mesh) { return mesh.primitives.size(); }),
 			0zu,
@@ -306,7 +754,7 @@ namespace model::gltf::impl
 		auto mesh_tasks =
 			asset.meshes
 			| std::views::transform([&](const auto& mesh) {
-				  return parse_mesh(thread_pool, progress, asset, mesh);
+				  return parse_mesh(thread_pool, progress, stop_token, asset, mesh);
 			  })
 			| std::ranges::to<std::vector>();
 
@@ -0,0 +1,187 @@
+#include "meshopt.hpp"
+#include "asset.hpp"
+#include "common/util/arena.hpp"
+#include "common/util/error.hpp"
+
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+#include <cstddef>
+#include <expected>
+#include <fastgltf/types.hpp>
+#include <format>
+#include <meshoptimizer.h>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace model::gltf::impl
+{
+	// (Helper) Validate the stride and count of a compressed buffer view against its mode and filter, the
+	// decoders assert on these
+	[[nodiscard]]
+	static std::expected<void, Error> validate_compressed_view(
+		const fastgltf::CompressedBufferView& compressed
+	) noexcept
+	{
+		const auto stride = compressed.byteStride;
+
+		switch (compressed.mode)
+		{
+		case fastgltf::MeshoptCompressionMode::Attributes:
+			if (stride == 0 || stride % 4 != 0 || stride > 256)
+				return Error("Invalid stride for attributes", std::format("Stride: {}", stride));
+			break;
+
+		case fastgltf::MeshoptCompressionMode::Triangles:
+			if (compressed.count % 3 != 0)
+				return Error("Invalid count for triangles", std::format("Count: {}", compressed.count));
+			[[fallthrough]];
+
+		case fastgltf::MeshoptCompressionMode::Indices:
+			if (stride != 2 && stride != 4)
+				return Error("Invalid stride for indices", std::format("Stride: {}", stride));
+			if (compressed.filter != fastgltf::MeshoptCompressionFilter::None)
+				return Error("Indices can't be filtered");
+			break;
+
+		default:
+			return Error(
+				"Unsupported compression mode",
+				std::format("Mode: {}", std::to_underlying(compressed.mode))
+			);
+		}
+
+		switch (compressed.filter)
+		{
+		case fastgltf::MeshoptCompressionFilter::None:
+			return {};
+
+		case fastgltf::MeshoptCompressionFilter::Octahedral:
+			if (stride != 4 && stride != 8)
+				return Error("Invalid stride for octahedral filter", std::format("Stride: {}", stride));
+			return {};
+
+		case fastgltf::MeshoptCompressionFilter::Quaternion:
+			if (stride != 8)
+				return Error("Invalid stride for quaternion filter", std::format("Stride: {}", stride));
+			return {};
+
+		case fastgltf::MeshoptCompressionFilter::Exponential:
+			if (stride % 4 != 0)
+				return Error("Invalid stride for exponential filter", std::format("Stride: {}", stride));
+			return {};
+
+		default:
+			return Error(
+				"Unsupported compression filter",
+				std::format("Filter: {}", std::to_underlying(compressed.filter))
+			);
+		}
+	}
+
+	[[nodiscard]]
+	static std::expected<::util::ScratchVector<std::byte>, Error> decode_view(
+		Asset& asset,
+		const fastgltf::CompressedBufferView& compressed
+	) noexcept
+	{
+		if (const auto result = validate_compressed_view(compressed); !result)
+			return result.error().forward("Invalid compressed buffer view");
+
+		if (compressed.bufferIndex >= asset.unified_buffers.size())
+			return Error("Buffer index out of bounds", std::format("Index: {}", compressed.bufferIndex));
+
+		auto& buffer = asset.unified_buffers[compressed.bufferIndex];
+		auto source_result = buffer.get_span(compressed.byteOffset, compressed.byteLength);
+		if (!source_result) return source_result.error().forward("Acquire compressed data failed");
+		const auto source = *source_result;
+
+		const auto count = compressed.count;
+		const auto stride = compressed.byteStride;
+		auto decoded = ::util::ScratchVector<std::byte>(count * stride, asset.scratch_resource);
+
+		const auto decode_result = [&] {
+			const auto* source_data = reinterpret_cast<const unsigned char*>(source.data());
+
+			switch (compressed.mode)
+			{
+			case fastgltf::MeshoptCompressionMode::Attributes:
+				return meshopt_decodeVertexBuffer(decoded.data(), count, stride, source_data, source.size());
+			case fastgltf::MeshoptCompressionMode::Triangles:
+				return meshopt_decodeIndexBuffer(decoded.data(), count, stride, source_data, source.size());
+			case fastgltf::MeshoptCompressionMode::Indices:
+			default:
+				return meshopt_decodeIndexSequence(decoded.data(), count, stride, source_data, source.size());
+			}
+		}();
+		if (decode_result != 0)
+			return Error("Decode compressed data failed", std::format("Error code: {}", decode_result));
+
+		switch (compressed.filter)
+		{
+		case fastgltf::MeshoptCompressionFilter::Octahedral:
+			meshopt_decodeFilterOct(decoded.data(), count, stride);
+			break;
+		case fastgltf::MeshoptCompressionFilter::Quaternion:
+			meshopt_decodeFilterQuat(decoded.data(), count, stride);
+			break;
+		case fastgltf::MeshoptCompressionFilter::Exponential:
+			meshopt_decodeFilterExp(decoded.data(), count, stride);
+			break;
+		case fastgltf::MeshoptCompressionFilter::None:
+		default:
+			break;
+		}
+
+		return decoded;
+	}
+
+	[[nodiscard]]
+	static coro::task<std::expected<::util::ScratchVector<std::byte>, Error>> decode_view_async(
+		coro::thread_pool& thread_pool,
+		Asset& asset,
+		size_t view_index
+	) noexcept
+	{
+		co_await thread_pool.schedule();
+
+		auto result = decode_view(asset, *asset.bufferViews[view_index].meshoptCompression);
+		if (!result)
+			co_return result.error().forward("Decode failed", std::format("Buffer view {}", view_index));
+
+		co_return std::move(*result);
+	}
+
+	coro::task<std::expected<void, Error>> decode_meshopt_views(
+		coro::thread_pool& thread_pool,
+		Asset& asset
+	) noexcept
+	{
+		const auto compressed_indices =
+			std::views::iota(0zu, asset.bufferViews.size())
+			| std::views::filter([&asset](size_t view_index) {
+				  return asset.bufferViews[view_index].meshoptCompression != nullptr;
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto decode_tasks =
+			compressed_indices
+			| std::views::transform([&thread_pool, &asset](size_t view_index) {
+				  return decode_view_async(thread_pool, asset, view_index);
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto decoded_result = co_await coro::when_all(std::move(decode_tasks))
+			| std::views::transform([](auto&& result) { return std::move(result).return_value(); })
+			| Error::collect();
+		if (!decoded_result)
+			co_return decoded_result.error().forward("Decode compressed buffer views failed");
+
+		for (auto&& [view_index, decoded] : std::views::zip(compressed_indices, *decoded_result))
+			asset.decoded_views[view_index] = std::move(decoded);
+
+		co_return {};
+	}
+}
@@ -0,0 +1,176 @@
+#include "remote.hpp"
+#include "common/util/error.hpp"
+#include "http.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <expected>
+#include <fastgltf/types.hpp>
+#include <format>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace model::gltf::impl
+{
+	namespace
+	{
+		// Largest range of a single request, larger ranges are split to be fetched in parallel
+		constexpr size_t MAX_RANGE_SIZE = 4 * 1024 * 1024;
+
+		// Ranges closer than this are fetched as one, trading a few unused bytes for fewer requests
+		constexpr size_t MERGE_GAP = 64 * 1024;
+
+		// Get the URL of a data source, if it is a remote URI
+		std::optional<std::string> get_url(
+			const fastgltf::DataSource& source,
+			const std::optional<std::string>& base_url
+		) noexcept
+		{
+			const auto* const uri = std::get_if<fastgltf::sources::URI>(&source);
+			if (uri == nullptr) return std::nullopt;
+
+			const auto reference = std::string(uri->uri.string());
+			if (http::is_url(reference)) return reference;
+			if (base_url.has_value() && uri->uri.isLocalPath()) return http::resolve(*base_url, reference);
+
+			return std::nullopt;
+		}
+
+		// Get the byte ranges of a buffer read by buffer views, sorted and merged
+		std::vector<http::Range> get_view_ranges(const fastgltf::Asset& asset, size_t buffer_index) noexcept
+		{
+			auto ranges = std::vector<http::Range>();
+
+			for (const auto& view : asset.bufferViews)
+			{
+				// Compressed views only read their compressed data, their own buffer is a fallback
+				if (view.meshoptCompression != nullptr)
+				{
+					const auto& compressed = *view.meshoptCompression;
+					if (compressed.bufferIndex == buffer_index)
+						ranges.push_back({.offset = compressed.byteOffset, .size = compressed.byteLength});
+					continue;
+				}
+
+				if (view.bufferIndex == buffer_index)
+					ranges.push_back({.offset = view.byteOffset, .size = view.byteLength});
+			}
+
+			std::ranges::sort(ranges, {}, &http::Range::offset);
+
+			auto merged = std::vector<http::Range>();
+			for (const auto& range : ranges)
+			{
+				if (range.size == 0) continue;
+
+				if (merged.empty() || range.offset > merged.back().offset + merged.back().size + MERGE_GAP)
+				{
+					merged.push_back(range);
+					continue;
+				}
+
+				auto& last = merged.back();
+				last.size = std::max(last.offset + last.size, range.offset + range.size) - last.offset;
+			}
+
+			return merged;
+		}
+	}
+
+	std::expected<void, Error> fetch_remote_sources(
+		fastgltf::Asset& asset,
+		const std::optional<std::string>& base_url,
+		std::stop_token stop_token
+	) noexcept
+	{
+		// Destination of a request, the buffer or image at `index`
+		struct Target
+		{
+			bool image;
+			size_t index;
+			size_t offset;  // Offset of the fetched bytes in the buffer
+		};
+
+		auto requests = std::vector<http::Request>();
+		auto targets = std::vector<Target>();
+
+		/* Collect requests */
+
+		for (const auto [buffer_index, buffer] : std::views::enumerate(asset.buffers))
+		{
+			const auto url = get_url(buffer.data, base_url);
+			if (!url.has_value()) continue;
+
+			const auto file_offset = std::get<fastgltf::sources::URI>(buffer.data).fileByteOffset;
+			const auto request_count = requests.size();
+
+			for (const auto& range : get_view_ranges(asset, buffer_index))
+			{
+				if (range.offset + range.size > buffer.byteLength)
+					return Error("Buffer view out of buffer bounds", std::format("URL: {}", *url));
+
+				const auto range_end = range.offset + range.size;
+				for (size_t offset = range.offset; offset < range_end; offset += MAX_RANGE_SIZE)
+				{
+					const auto size = std::min(MAX_RANGE_SIZE, range_end - offset);
+					requests.push_back({.url = *url, .range = http::Range{file_offset + offset, size}});
+					targets.push_back({.image = false, .index = size_t(buffer_index), .offset = offset});
+				}
+			}
+
+			// Buffers without views are still replaced, as empty data
+			if (requests.size() == request_count)
+				asset.buffers[buffer_index].data = fastgltf::sources::Vector{
+					.bytes = std::vector<std::byte>(buffer.byteLength),
+					.mimeType = fastgltf::MimeType::GltfBuffer
+				};
+		}
+
+		for (const auto [image_index, image] : std::views::enumerate(asset.images))
+		{
+			const auto url = get_url(image.data, base_url);
+			if (!url.has_value()) continue;
+
+			requests.push_back({.url = *url, .range = std::nullopt});
+			targets.push_back({.image = true, .index = size_t(image_index), .offset = 0});
+		}
+
+		if (requests.empty()) return {};
+
+		/* Fetch */
+
+		auto bodies_result = http::fetch(requests, std::move(stop_token));
+		if (!bodies_result) return bodies_result.error().forward("Fetch remote sources failed");
+		auto& bodies = *bodies_result;
+
+		/* Replace sources */
+
+		for (const auto [target, body] : std::views::zip(targets, bodies))
+		{
+			if (target.image)
+			{
+				auto& image = asset.images[target.index];
+				const auto mime_type = std::get<fastgltf::sources::URI>(image.data).mimeType;
+				image.data = fastgltf::sources::Vector{.bytes = std::move(body), .mimeType = mime_type};
+				continue;
+			}
+
+			auto& buffer = asset.buffers[target.index];
+			if (std::holds_alternative<fastgltf::sources::URI>(buffer.data))
+				buffer.data = fastgltf::sources::Vector{
+					.bytes = std::vector<std::byte>(buffer.byteLength),
+					.mimeType = fastgltf::MimeType::GltfBuffer
+				};
+
+			auto& bytes = std::get<fastgltf::sources::Vector>(buffer.data).bytes;
+			std::ranges::copy(body, bytes.begin() + target.offset);
+		}
+
+		return {};
+	}
+}
@@ -0,0 +1,51 @@
+#include "source.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fastgltf/core.hpp>
+
+namespace model::gltf::impl
+{
+	void SourceGetter::read(void* ptr, std::size_t count)
+	{
+		count = std::min(count, source.data.size() - position);
+		std::memcpy(ptr, source.data.data() + position, count);
+		position += count;
+	}
+
+	fastgltf::span<std::byte> SourceGetter::read(std::size_t count, std::size_t padding)
+	{
+		count = std::min(count, source.data.size() - position);
+		const auto offset = position;
+		position += count;
+
+		// The padding is only read by the JSON parser, any readable bytes following the chunk do
+		if (offset + count + padding <= source.data.size())
+		{
+			// fastgltf never writes through the returned span
+			auto* const data = const_cast<std::byte*>(source.data.data()) + offset;
+			return {data, count + padding};
+		}
+
+		padded_copy.assign(count + padding, std::byte(0));
+		std::memcpy(padded_copy.data(), source.data.data() + offset, count);
+
+		return {padded_copy.data(), padded_copy.size()};
+	}
+
+	void SourceGetter::reset()
+	{
+		position = 0;
+	}
+
+	std::size_t SourceGetter::bytesRead()
+	{
+		return position;
+	}
+
+	std::size_t SourceGetter::totalSize()
+	{
+		return source.data.size();
+	}
+}
@@ -31,7 +31,7 @@ namespace model::gltf::impl
 		const auto& buffer_view = asset.bufferViews[buffer_view_source.bufferViewIndex];
 		auto& buffer = asset.unified_buffers[buffer_view.bufferIndex];
 
-		auto data_result = buffer.get_copy(buffer_view);
+		auto data_result = buffer.get_shared(buffer_view);
 		if (!data_result) return data_result.error().forward("Acquire image data from buffer view failed");
 		return std::move(*data_result);
 	}
@@ -191,12 +191,11 @@ namespace model::gltf::impl
 		if (texture.samplerIndex.has_value() && texture.samplerIndex.value() >= asset.samplers.size())
 			return Error("Sampler index out of bounds");
 
-		std::optional<size_t> image_index = texture.imageIndex;
+		// KTX2 is preferred, its mipmap chain is transcoded into BCn without encoding
+		std::optional<size_t> image_index = texture.basisuImageIndex;
 
-		if (!texture.imageIndex.has_value())
-		{
-			if (texture.webpImageIndex.has_value()) image_index = texture.webpImageIndex;
-		}
+		if (!image_index.has_value()) image_index = texture.imageIndex;
+		if (!image_index.has_value()) image_index = texture.webpImageIndex;
 
 		if (!image_index.has_value()) return Error("Texture missing image index");
 		if (image_index.value() >= asset.images.size()) return Error("Image index out of bounds");
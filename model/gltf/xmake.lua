@@ -9,5 +9,11 @@ target("model.gltf")
 	add_includedirs("impl")
 	
 	add_deps("lib.model", {public = true})
-	add_packages("fastgltf", "mio")
-	add_packages("libcoro", {public = true})
\ No newline at end of file
+	add_packages("fastgltf", "mio", "meshoptimizer")
+	add_packages("libcoro", {public = true})
+
+	-- Backend of `load_from_url`, see option "http"
+	if has_config("http") then
+		add_packages("libcurl")
+		add_defines("MODEL_GLTF_HTTP")
+	end
\ No newline at end of file
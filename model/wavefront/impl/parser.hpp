@@ -0,0 +1,30 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <expected>
+#include <filesystem>
+#include <tiny_obj_loader.h>
+#include <vector>
+
+namespace model::obj::impl
+{
+	// Geometry and materials of an obj file, in the layout of tinyobj
+	struct ParsedObj
+	{
+		tinyobj::attrib_t attributes;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+	};
+
+	// Parse an obj file and the material libraries it references. The file is memory mapped and split at line
+	// boundaries into chunks parsed in parallel, then merged in file order. Faces are triangulated as fans,
+	// smoothing groups, lines and points are ignored
+	[[nodiscard]]
+	coro::task<std::expected<ParsedObj, Error>> parse_obj_async(
+		coro::thread_pool& thread_pool,
+		const std::filesystem::path& file_path
+	) noexcept;
+}
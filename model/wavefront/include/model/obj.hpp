@@ -41,7 +41,7 @@ namespace model::obj
 		ProcessingTextures,  // Processing the textures
 	};
 
-	using Progress = ::util::SyncedEnumVariant<
+	using Progress = ::util::AtomicEnumVariant<
 		::util::Tag<ProgressState::Parsing>,
 		::util::Tag<ProgressState::ProcessingMesh, ::util::ProgressRef>,
 		::util::Tag<ProgressState::ProcessingTextures>
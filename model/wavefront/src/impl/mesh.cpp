@@ -156,10 +156,10 @@ namespace model::obj::impl
 			full_vertices.append_range(full);
 		}
 
-		const auto full_indices = std::views::iota(0_u32, static_cast<uint32_t>(full_vertices.size()))
+		auto full_indices = std::views::iota(0_u32, static_cast<uint32_t>(full_vertices.size()))
 			| std::ranges::to<std::vector>();
 
-		auto geometry_result = Geometry::create(full_vertices, full_indices);
+		auto geometry_result = Geometry::create(std::move(full_vertices), std::move(full_indices));
 		if (!geometry_result) return geometry_result.error().forward("Create geometry failed");
 		return std::move(*geometry_result);
 	}
@@ -184,7 +184,7 @@ namespace model::obj::impl
 			auto geometry = std::move(*geometry_result);
 
 			primitives.emplace_back(
-				Primitive{.geometry = std::move(geometry), .material_index = material_id}
+				Primitive{.geometry = std::move(geometry), .lods = {}, .material_index = material_id}
 			);
 		}
 
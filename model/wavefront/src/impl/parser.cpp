@@ -0,0 +1,529 @@
+#include "parser.hpp"
+#include "common/util/error.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mio/mmap.hpp>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tiny_obj_loader.h>
+#include <utility>
+#include <vector>
+
+namespace model::obj::impl
+{
+	namespace
+	{
+		// Smallest chunk to split the file into, smaller files are parsed in fewer chunks
+		constexpr size_t MIN_CHUNK_SIZE = 4 * 1024 * 1024;
+
+		// Chunks per thread of the pool, evens out chunks of uneven parse cost
+		constexpr size_t CHUNKS_PER_THREAD = 4;
+
+		// Flags of face index components given relative to the end of the attribute lists
+		constexpr uint8_t RELATIVE_VERTEX = 0b001;
+		constexpr uint8_t RELATIVE_TEXCOORD = 0b010;
+		constexpr uint8_t RELATIVE_NORMAL = 0b100;
+
+		// Run of faces in a chunk sharing the same shape and material
+		struct Segment
+		{
+			std::optional<std::string> shape_name;     // Starts a new shape if set (`o` or `g`)
+			std::optional<std::string> material_name;  // Switches the material if set (`usemtl`)
+			size_t index_begin;                          // First index in `Chunk::indices`
+		};
+
+		// Face index with components relative to the end of the attribute lists (negative in the file).
+		// Resolved against the chunk's own attributes, then offset once the preceding chunks are known
+		struct RelativeIndex
+		{
+			size_t position;     // Position in `Chunk::indices`
+			uint8_t components;  // Combination of `RELATIVE_*` flags
+		};
+
+		// Parsed data of a chunk of lines
+		struct Chunk
+		{
+			std::vector<float> vertices;
+			std::vector<float> texcoords;
+			std::vector<float> normals;
+
+			std::vector<tinyobj::index_t> indices;  // Triangulated faces, 3 per triangle
+			std::vector<Segment> segments;          // Segments, the first one continues the previous chunk
+			std::vector<RelativeIndex> relative_indices;
+			std::vector<std::string> material_libraries;
+		};
+
+		using Polygon = std::vector<std::pair<tinyobj::index_t, uint8_t>>;
+	}
+
+	// (Helper) Remove leading and trailing whitespaces
+	[[nodiscard]]
+	static std::string_view trim(std::string_view text) noexcept
+	{
+		const auto begin = text.find_first_not_of(" \t");
+		if (begin == std::string_view::npos) return {};
+
+		const auto end = text.find_last_not_of(" \t");
+		return text.substr(begin, end - begin + 1);
+	}
+
+	// (Helper) Pop the next whitespace separated token off the front of the line, empty if none is left
+	[[nodiscard]]
+	static std::string_view pop_token(std::string_view& line) noexcept
+	{
+		const auto begin = line.find_first_not_of(" \t");
+		if (begin == std::string_view::npos)
+		{
+			line = {};
+			return {};
+		}
+		line.remove_prefix(begin);
+
+		const auto end = std::min(line.find_first_of(" \t"), line.size());
+		const auto token = line.substr(0, end);
+		line.remove_prefix(end);
+
+		return token;
+	}
+
+	[[nodiscard]]
+	static std::optional<float> parse_float(std::string_view token) noexcept
+	{
+		// `std::from_chars` rejects the leading plus sign
+		if (token.starts_with('+')) token.remove_prefix(1);
+
+		float value;
+		const auto [end, error_code] = std::from_chars(token.data(), token.data() + token.size(), value);
+		if (error_code != std::errc() || end != token.data() + token.size()) return std::nullopt;
+
+		return value;
+	}
+
+	// (Helper) Parse the leading floats of a line. The first `required` ones must exist, missing ones up to
+	// `count` are zero, and extra ones (e.g. vertex colors) are ignored
+	[[nodiscard]]
+	static std::expected<void, const char*> parse_floats(
+		std::string_view line,
+		size_t count,
+		size_t required,
+		std::vector<float>& output
+	) noexcept
+	{
+		for (const auto component : std::views::iota(0zu, count))
+		{
+			const auto token = pop_token(line);
+			if (token.empty())
+			{
+				if (component < required) return std::unexpected("Too few components");
+				output.push_back(0.0f);
+				continue;
+			}
+
+			const auto value = parse_float(token);
+			if (!value) return std::unexpected("Invalid number");
+			output.push_back(*value);
+		}
+
+		return {};
+	}
+
+	// (Helper) Resolve a 1-based face index component into a 0-based one, `-1` if the component is absent.
+	// Negative indices are resolved against `count` and flagged in `relative`
+	[[nodiscard]]
+	static std::expected<int, const char*> resolve_index(
+		std::string_view token,
+		size_t count,
+		uint8_t flag,
+		uint8_t& relative
+	) noexcept
+	{
+		if (token.empty()) return -1;
+
+		int value;
+		const auto [end, error_code] = std::from_chars(token.data(), token.data() + token.size(), value);
+		if (error_code != std::errc() || end != token.data() + token.size())
+			return std::unexpected("Invalid index");
+
+		if (value == 0) return std::unexpected("Zero index");
+		if (value > 0) return value - 1;
+
+		relative |= flag;
+		return static_cast<int>(count) + value;
+	}
+
+	// (Helper) Parse a face vertex in the form of `v`, `v/vt`, `v//vn` or `v/vt/vn`
+	[[nodiscard]]
+	static std::expected<std::pair<tinyobj::index_t, uint8_t>, const char*> parse_face_vertex(
+		std::string_view token,
+		const Chunk& chunk
+	) noexcept
+	{
+		const auto vertex_end = token.find('/');
+		const auto vertex_token = token.substr(0, vertex_end);
+
+		std::string_view texcoord_token;
+		std::string_view normal_token;
+		if (vertex_end != std::string_view::npos)
+		{
+			const auto rest = token.substr(vertex_end + 1);
+			const auto texcoord_end = rest.find('/');
+
+			texcoord_token = rest.substr(0, texcoord_end);
+			if (texcoord_end != std::string_view::npos) normal_token = rest.substr(texcoord_end + 1);
+		}
+
+		if (vertex_token.empty()) return std::unexpected("Missing position index");
+
+		uint8_t relative = 0;
+
+		const auto vertex_index =
+			resolve_index(vertex_token, chunk.vertices.size() / 3, RELATIVE_VERTEX, relative);
+		const auto texcoord_index =
+			resolve_index(texcoord_token, chunk.texcoords.size() / 2, RELATIVE_TEXCOORD, relative);
+		const auto normal_index =
+			resolve_index(normal_token, chunk.normals.size() / 3, RELATIVE_NORMAL, relative);
+
+		if (!vertex_index) return std::unexpected(vertex_index.error());
+		if (!texcoord_index) return std::unexpected(texcoord_index.error());
+		if (!normal_index) return std::unexpected(normal_index.error());
+
+		const auto index = tinyobj::index_t{
+			.vertex_index = *vertex_index,
+			.normal_index = *normal_index,
+			.texcoord_index = *texcoord_index
+		};
+
+		return std::make_pair(index, relative);
+	}
+
+	// (Helper) Parse a face and append it to the chunk, triangulated as a fan
+	[[nodiscard]]
+	static std::expected<void, const char*> parse_face(
+		std::string_view line,
+		Chunk& chunk,
+		Polygon& polygon
+	) noexcept
+	{
+		polygon.clear();
+
+		for (auto token = pop_token(line); !token.empty(); token = pop_token(line))
+		{
+			const auto vertex_result = parse_face_vertex(token, chunk);
+			if (!vertex_result) return std::unexpected(vertex_result.error());
+			polygon.push_back(*vertex_result);
+		}
+
+		if (polygon.size() < 3) return std::unexpected("Face with less than 3 vertices");
+
+		for (const auto second : std::views::iota(1zu, polygon.size() - 1))
+		{
+			for (const auto& [index, relative] : {polygon[0], polygon[second], polygon[second + 1]})
+			{
+				if (relative != 0)
+					chunk.relative_indices.push_back(
+						RelativeIndex{.position = chunk.indices.size(), .components = relative}
+					);
+
+				chunk.indices.push_back(index);
+			}
+		}
+
+		return {};
+	}
+
+	// (Helper) Get the segment to put the following faces in, a new one if the current one has faces
+	[[nodiscard]]
+	static Segment& next_segment(Chunk& chunk) noexcept
+	{
+		if (chunk.segments.back().index_begin != chunk.indices.size())
+			chunk.segments.push_back(Segment{.index_begin = chunk.indices.size()});
+
+		return chunk.segments.back();
+	}
+
+	[[nodiscard]]
+	static std::expected<void, const char*> parse_line(
+		std::string_view line,
+		Chunk& chunk,
+		Polygon& polygon
+	) noexcept
+	{
+		const auto keyword = pop_token(line);
+
+		if (keyword == "v") return parse_floats(line, 3, 3, chunk.vertices);
+		if (keyword == "vt") return parse_floats(line, 2, 1, chunk.texcoords);
+		if (keyword == "vn") return parse_floats(line, 3, 3, chunk.normals);
+		if (keyword == "f") return parse_face(line, chunk, polygon);
+
+		if (keyword == "o" || keyword == "g")
+		{
+			next_segment(chunk).shape_name = std::string(trim(line));
+			return {};
+		}
+
+		if (keyword == "usemtl")
+		{
+			next_segment(chunk).material_name = std::string(trim(line));
+			return {};
+		}
+
+		if (keyword == "mtllib")
+		{
+			for (auto token = pop_token(line); !token.empty(); token = pop_token(line))
+				chunk.material_libraries.emplace_back(token);
+			return {};
+		}
+
+		// Comments, empty lines and unsupported statements (e.g. `s`, `l`, `p`)
+		return {};
+	}
+
+	[[nodiscard]]
+	static std::expected<Chunk, Error> parse_chunk(std::string_view text) noexcept
+	{
+		auto chunk = Chunk{.segments = {Segment{.index_begin = 0}}};
+		Polygon polygon;
+
+		while (!text.empty())
+		{
+			const auto line_end = std::min(text.find('\n'), text.size());
+			auto line = text.substr(0, line_end);
+			text.remove_prefix(std::min(line_end + 1, text.size()));
+
+			if (line.ends_with('\r')) line.remove_suffix(1);
+
+			if (const auto result = parse_line(line, chunk, polygon); !result)
+				return Error("Parse line failed", std::format("{}, line: {:?}", result.error(), line));
+		}
+
+		return chunk;
+	}
+
+	[[nodiscard]]
+	static coro::task<std::expected<Chunk, Error>> parse_chunk_async(
+		coro::thread_pool& thread_pool,
+		std::string_view text
+	) noexcept
+	{
+		co_await thread_pool.schedule();
+		co_return parse_chunk(text);
+	}
+
+	// (Helper) Split the text at line boundaries into about `chunk_count` chunks
+	[[nodiscard]]
+	static std::vector<std::string_view> split_lines(std::string_view text, size_t chunk_count) noexcept
+	{
+		const auto chunk_size = std::max(MIN_CHUNK_SIZE, (text.size() + chunk_count - 1) / chunk_count);
+
+		std::vector<std::string_view> chunks;
+		while (!text.empty())
+		{
+			const auto line_end = text.find('\n', std::min(chunk_size, text.size()));
+			const auto chunk_end = line_end == std::string_view::npos ? text.size() : line_end + 1;
+
+			chunks.push_back(text.substr(0, chunk_end));
+			text.remove_prefix(chunk_end);
+		}
+
+		return chunks;
+	}
+
+	// (Helper) Offset the relative indices of a chunk by the attribute counts of the preceding chunks
+	[[nodiscard]]
+	static std::expected<void, Error> resolve_relative_indices(
+		Chunk& chunk,
+		size_t vertex_base,
+		size_t texcoord_base,
+		size_t normal_base
+	) noexcept
+	{
+		const auto offset = [](int& component, size_t base) {
+			component += static_cast<int>(base);
+			return component >= 0;
+		};
+
+		for (const auto& [position, components] : chunk.relative_indices)
+		{
+			auto& index = chunk.indices[position];
+
+			if ((components & RELATIVE_VERTEX) != 0 && !offset(index.vertex_index, vertex_base))
+				return Error("Relative position index out of bound");
+			if ((components & RELATIVE_TEXCOORD) != 0 && !offset(index.texcoord_index, texcoord_base))
+				return Error("Relative texcoord index out of bound");
+			if ((components & RELATIVE_NORMAL) != 0 && !offset(index.normal_index, normal_base))
+				return Error("Relative normal index out of bound");
+		}
+
+		return {};
+	}
+
+	// (Helper) Load the material libraries by name, skipping the ones that can't be opened as tinyobj does
+	[[nodiscard]]
+	static std::pair<std::vector<tinyobj::material_t>, std::map<std::string, int>> load_material_libraries(
+		std::span<const std::string> names,
+		const std::filesystem::path& search_directory
+	) noexcept
+	{
+		std::vector<tinyobj::material_t> materials;
+		std::map<std::string, int> material_map;
+
+		for (const auto& name : names)
+		{
+			auto replaced_name = name;
+			std::ranges::replace(replaced_name, '\\', '/');  // Handle windows path
+
+			auto stream = std::ifstream(search_directory / replaced_name);
+			if (!stream.is_open()) continue;
+
+			std::string warning;
+			std::string error;
+			tinyobj::LoadMtl(&material_map, &materials, &stream, &warning, &error);
+		}
+
+		return {std::move(materials), std::move(material_map)};
+	}
+
+	// (Helper) Merge the chunks in file order
+	[[nodiscard]]
+	static std::expected<ParsedObj, Error> merge_chunks(
+		std::vector<Chunk> chunks,
+		const std::filesystem::path& search_directory
+	) noexcept
+	{
+		/* Load materials */
+
+		std::vector<std::string> library_names;
+		for (const auto& name : chunks | std::views::transform(&Chunk::material_libraries) | std::views::join)
+			if (!std::ranges::contains(library_names, name)) library_names.push_back(name);
+
+		auto [materials, material_map] = load_material_libraries(library_names, search_directory);
+
+		/* Merge attributes and faces */
+
+		auto parsed = ParsedObj{.attributes = {}, .shapes = {}, .materials = std::move(materials)};
+
+		const auto total_size = [&chunks](std::vector<float> Chunk::* member) {
+			const auto get_size = [member](const Chunk& chunk) {
+				return (chunk.*member).size();
+			};
+			return std::ranges::fold_left(chunks | std::views::transform(get_size), 0zu, std::plus());
+		};
+
+		parsed.attributes.vertices.reserve(total_size(&Chunk::vertices));
+		parsed.attributes.texcoords.reserve(total_size(&Chunk::texcoords));
+		parsed.attributes.normals.reserve(total_size(&Chunk::normals));
+
+		auto shape = tinyobj::shape_t();
+		int material_id = -1;
+
+		for (auto& chunk : chunks)
+		{
+			if (const auto result = resolve_relative_indices(
+					chunk,
+					parsed.attributes.vertices.size() / 3,
+					parsed.attributes.texcoords.size() / 2,
+					parsed.attributes.normals.size() / 3
+				);
+				!result)
+				return result.error().forward("Resolve relative face indices failed");
+
+			parsed.attributes.vertices.append_range(std::exchange(chunk.vertices, {}));
+			parsed.attributes.texcoords.append_range(std::exchange(chunk.texcoords, {}));
+			parsed.attributes.normals.append_range(std::exchange(chunk.normals, {}));
+
+			for (const auto [segment_index, segment] : chunk.segments | std::views::enumerate)
+			{
+				if (segment.shape_name.has_value())
+				{
+					if (!shape.mesh.indices.empty()) parsed.shapes.push_back(std::move(shape));
+
+					shape = tinyobj::shape_t();
+					shape.name = *segment.shape_name;
+				}
+
+				if (segment.material_name.has_value())
+				{
+					const auto material_it = material_map.find(*segment.material_name);
+					material_id = material_it == material_map.end() ? -1 : material_it->second;
+				}
+
+				const auto index_end = std::cmp_less(segment_index + 1, chunk.segments.size())
+					? chunk.segments[segment_index + 1].index_begin
+					: chunk.indices.size();
+				const auto indices =
+					std::span(chunk.indices).subspan(segment.index_begin, index_end - segment.index_begin);
+				const auto face_count = indices.size() / 3;
+
+				shape.mesh.indices.append_range(indices);
+				shape.mesh.num_face_vertices.append_range(std::views::repeat(3u, face_count));
+				shape.mesh.material_ids.append_range(std::views::repeat(material_id, face_count));
+			}
+
+			chunk.indices = {};
+		}
+
+		if (!shape.mesh.indices.empty()) parsed.shapes.push_back(std::move(shape));
+
+		return parsed;
+	}
+
+	coro::task<std::expected<ParsedObj, Error>> parse_obj_async(
+		coro::thread_pool& thread_pool,
+		const std::filesystem::path& file_path
+	) noexcept
+	{
+		std::error_code error_code;
+		const auto file_size = std::filesystem::file_size(file_path, error_code);
+		if (error_code)
+			co_return Error(
+				"Get size of model file failed",
+				std::format("Path: {}, {}", file_path.string(), error_code.message())
+			);
+
+		// Empty files can't be mapped
+		if (file_size == 0) co_return ParsedObj();
+
+		mio::mmap_source mapped_file;
+		try
+		{
+			mapped_file = mio::mmap_source(file_path.string());
+		}
+		catch (const std::system_error& e)
+		{
+			co_return Error("Mapping model file failed", std::format("what(): {}", e.what()));
+		}
+
+		const auto text = std::string_view(mapped_file.data(), mapped_file.size());
+
+		auto chunk_tasks =
+			split_lines(text, thread_pool.thread_count() * CHUNKS_PER_THREAD)
+			| std::views::transform([&thread_pool](std::string_view chunk_text) {
+				  return parse_chunk_async(thread_pool, chunk_text);
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto chunks_result = co_await coro::when_all(std::move(chunk_tasks))
+			| std::views::transform([](auto&& result) { return std::move(result).return_value(); })
+			| Error::collect();
+		if (!chunks_result) co_return chunks_result.error().forward("Parse chunks failed");
+
+		co_return merge_chunks(std::move(*chunks_result), file_path.parent_path());
+	}
+}
@@ -6,6 +6,7 @@
 #include "material.hpp"
 #include "mesh.hpp"
 #include "model/model.hpp"
+#include "parser.hpp"
 
 #include <algorithm>
 #include <coro/task.hpp>
@@ -31,13 +32,13 @@ namespace model::obj
 		coro::task<std::expected<Model, Error>> load_from_parsed_data(
 			coro::thread_pool& thread_pool,
 			Progress& progress,
-			const tinyobj::ObjReader& reader,
+			const impl::ParsedObj& parsed,
 			const std::function<TextureLoader>& texture_loader
 		) noexcept
 		{
-			const auto& attributes = reader.GetAttrib();
-			const auto& shapes = reader.GetShapes();
-			const auto& materials = reader.GetMaterials();
+			const auto& attributes = parsed.attributes;
+			const auto& shapes = parsed.shapes;
+			const auto& materials = parsed.materials;
 
 			/*===== Convert meshes =====*/
 
@@ -115,19 +116,9 @@ namespace model::obj
 
 			/* Parse */
 
-			tinyobj::ObjReaderConfig reader_config;
-			reader_config.triangulate = true;
-			reader_config.mtl_search_path = search_directory.string();
-			reader_config.vertex_color = false;
-
-			tinyobj::ObjReader reader;
-			if (!reader.ParseFromFile(file_path.string(), reader_config))
-			{
-				if (!reader.Error().empty())
-					co_return Error("Parse model file failed", reader.Error());
-				else
-					co_return Error("Parse model file failed");
-			}
+			auto parse_result = co_await impl::parse_obj_async(thread_pool, file_path);
+			if (!parse_result) co_return parse_result.error().forward("Parse model file failed");
+			const auto parsed = std::move(*parse_result);
 
 			const auto texture_loader = [&search_directory](const std::string& path)
 				-> std::variant<std::monostate, std::filesystem::path, std::vector<std::byte>> {
@@ -141,7 +132,7 @@ namespace model::obj
 				return full_path;
 			};
 
-			co_return co_await load_from_parsed_data(thread_pool, *progress, reader, texture_loader);
+			co_return co_await load_from_parsed_data(thread_pool, *progress, parsed, texture_loader);
 		}
 	}
 
@@ -10,5 +10,5 @@ target("model.wavefront")
 	add_headerfiles("include/(**.hpp)")
 
 	add_deps("lib.model", {public = true})
-	add_packages("tinyobjloader")
+	add_packages("tinyobjloader", "mio")
 	add_packages("libcoro", {public = true})
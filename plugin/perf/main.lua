@@ -0,0 +1,212 @@
+import("core.base.option")
+import("core.base.json")
+import("core.base.task")
+import("core.project.config")
+import("core.project.project")
+
+-- Gets fixed paths of the plugin
+function _get_paths()
+	local script_dir = os.scriptdir()
+
+	return {
+		suite = path.join(script_dir, "suite.json"),
+		baseline = path.join(script_dir, "baseline"),
+		output = path.join(config.builddir(), "perf")
+	}
+end
+
+-- Builds a target and gets the path to its binary
+function _build_target(name)
+	task.run("build", {target = name})
+
+	local target = project.target(name)
+	assert(target, "Target " .. name .. " not found")
+
+	return path.absolute(target:targetfile())
+end
+
+-- Runs a nanobench target, metrics are the median time per iteration in seconds
+function _run_nanobench(case, output_file)
+	local binary = _build_target(case.target)
+	os.execv(binary, {output_file}, {curdir = os.projectdir()})
+
+	local metrics = {}
+	for _, result in ipairs(json.loadfile(output_file).results) do
+		metrics[result.title .. " / " .. result.name] = result["median(elapsed)"]
+	end
+
+	return metrics
+end
+
+-- Runs the render benchmark on a model, metrics are median and P95 frame times and median pass times in
+-- milliseconds. Returns nil if the model is missing.
+function _run_render(case, output_file, renderer, assets_dir)
+	local model_path = path.absolute(path.join(assets_dir, case.model))
+	if not os.isfile(model_path) then
+		cprint("${color.warning}Skipped %s, model %s not found", case.name, model_path)
+		return nil
+	end
+
+	local args = {model_path, "--output", output_file}
+	table.join2(args, case.args or {})
+	os.execv(renderer, args, {curdir = os.projectdir()})
+
+	local report = json.loadfile(output_file)
+	local metrics = {
+		["CPU frame p50"] = report.cpu_frame_ms.p50,
+		["Frame p50"] = report.frame_ms.p50,
+		["Frame p95"] = report.frame_ms.p95
+	}
+	for pass, statistics in pairs(report.gpu_pass_ms) do
+		metrics["GPU " .. pass .. " p50"] = statistics.p50
+	end
+
+	return metrics, report.device
+end
+
+-- Gets the cases selected with `--suite`, all cases if not specified
+function _select_cases(suite)
+	local names = option.get("suite")
+	if not names then return suite.cases end
+
+	local selected = {}
+	for _, name in ipairs(names:split(",")) do
+		local found = false
+		for _, case in ipairs(suite.cases) do
+			if case.name == name then
+				table.insert(selected, case)
+				found = true
+			end
+		end
+		assert(found, "Case " .. name .. " not found in the suite")
+	end
+
+	return selected
+end
+
+-- Baseline names are file names, derived from the device name by default
+function _baseline_name(device)
+	local name = option.get("baseline") or device
+	if not name then raise("No render case reported the device, specify the baseline with `--baseline`") end
+
+	return (name:lower():gsub("[^%w]+", "-"):gsub("^%-+", ""):gsub("%-+$", ""))
+end
+
+-- Compares the metrics of a case against its baseline, returns the count of regressions
+function _compare_case(case_name, metrics, baseline_metrics, tolerance)
+	local regression_count = 0
+
+	local keys = table.orderkeys(metrics)
+	for _, key in ipairs(keys) do
+		local value = metrics[key]
+		local baseline = baseline_metrics[key]
+
+		if baseline == nil then
+			cprint("  ${color.warning}new${clear}      %s: %.4g", key, value)
+		else
+			local ratio = baseline > 0 and value / baseline or 1.0
+			local change = (ratio - 1.0) * 100.0
+			local line = string.format("%s: %.4g -> %.4g (%+.1f%%)", key, baseline, value, change)
+
+			if ratio > 1.0 + tolerance then
+				regression_count = regression_count + 1
+				cprint("  ${color.failure}slower${clear}   %s", line)
+			elseif ratio < 1.0 - tolerance then
+				cprint("  ${color.success}faster${clear}   %s", line)
+			elseif option.get("verbose") then
+				print("  ok       %s", line)
+			end
+		end
+	end
+
+	for key, _ in pairs(baseline_metrics) do
+		if metrics[key] == nil then cprint("  ${color.warning}missing${clear}  %s", key) end
+	end
+
+	if regression_count == 0 then
+		cprint("${color.success}%s: no regression${clear} (tolerance %.0f%%)", case_name, tolerance * 100.0)
+	else
+		cprint(
+			"${color.failure}%s: %d regression(s)${clear} (tolerance %.0f%%)",
+			case_name,
+			regression_count,
+			tolerance * 100.0
+		)
+	end
+
+	return regression_count
+end
+
+function main()
+	config.load()
+
+	local paths = _get_paths()
+	local suite = json.loadfile(paths.suite)
+	local cases = _select_cases(suite)
+	local assets_dir = option.get("assets")
+
+	os.mkdir(paths.output)
+
+	-- Run all cases first, the GPU name reported by the render benchmark selects the baseline
+	local results = {}
+	local device = nil
+	local renderer = nil
+
+	for _, case in ipairs(cases) do
+		cprint("${bright}Running %s", case.name)
+		local output_file = path.join(paths.output, case.name .. ".json")
+
+		local metrics = nil
+		if case.kind == "nanobench" then
+			metrics = _run_nanobench(case, output_file)
+		elseif case.kind == "render" then
+			renderer = renderer or _build_target("bench.render")
+			local case_device
+			metrics, case_device = _run_render(case, output_file, renderer, assets_dir)
+			device = device or case_device
+		else
+			raise("Unknown kind %s of case %s", tostring(case.kind), case.name)
+		end
+
+		if metrics then table.insert(results, {case = case, metrics = metrics}) end
+	end
+
+	local baseline_file = path.join(paths.baseline, _baseline_name(device) .. ".json")
+
+	-- Update mode merges the results into the baseline, cases not run keep their previous values
+	if option.get("update") then
+		local baseline = os.isfile(baseline_file) and json.loadfile(baseline_file) or {cases = {}}
+		baseline.device = device or baseline.device
+		for _, result in ipairs(results) do
+			baseline.cases[result.case.name] = result.metrics
+		end
+
+		os.mkdir(paths.baseline)
+		json.savefile(baseline_file, baseline)
+		cprint("${color.success}Baseline written to %s", path.relative(baseline_file, os.projectdir()))
+		return
+	end
+
+	if not os.isfile(baseline_file) then
+		raise("Baseline %s not found, create it with `xmake perf --update`", baseline_file)
+	end
+	local baseline = json.loadfile(baseline_file)
+
+	local regression_count = 0
+	for _, result in ipairs(results) do
+		local case = result.case
+		local tolerance = tonumber(option.get("tolerance") or case.tolerance or suite.tolerance)
+
+		local baseline_metrics = baseline.cases[case.name]
+		if baseline_metrics == nil then
+			cprint("${color.warning}%s: not in the baseline, skipped", case.name)
+		else
+			regression_count = regression_count
+				+ _compare_case(case.name, result.metrics, baseline_metrics, tolerance)
+		end
+	end
+
+	if regression_count > 0 then
+		raise("%d performance regression(s) against %s", regression_count, path.filename(baseline_file))
+	end
+end
@@ -0,0 +1,17 @@
+-- Performance regression test, runs the benchmarks and compares them against stored baselines
+
+task("perf")
+	set_category("plugin")
+	on_run("main")
+
+	set_menu({
+		usage = "xmake perf [options]",
+		description = "Run the benchmarks and compare the results against the baseline of the device",
+		options = {
+			{"b", "baseline", "kv", nil, "Name of the baseline, defaults to the GPU name from bench.render"},
+			{"t", "tolerance", "kv", nil, "Allowed relative slowdown, overrides the tolerances of the suite"},
+			{"a", "assets", "kv", "asset", "Directory holding the models of the render cases"},
+			{"s", "suite", "kv", nil, "Only run the named cases, separated by commas"},
+			{"u", "update", "k", nil, "Write the results into the baseline instead of comparing"}
+		}
+	})
@@ -0,0 +1 @@
+includes("*")
\ No newline at end of file
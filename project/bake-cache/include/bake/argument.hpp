@@ -0,0 +1,41 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/context/capability.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bake
+{
+	///
+	/// @brief Command line arguments of the cache baker
+	///
+	struct Argument
+	{
+		std::vector<std::string> model_paths;  // glTF models to bake
+
+		// Device tier of the preset to bake for, probes the device if not given. See `logic::Preset`
+		std::optional<vulkan::DeviceCapability::Tier> tier = std::nullopt;
+
+		bool merge_static = false;  // Bake models with merged static geometry, same as the renderer option
+		bool hlod = false;          // Bake models with HLOD proxies, same as the renderer option
+		bool impostor = false;      // Bake models with impostors, same as the renderer option
+		bool force = false;         // Re-bake models whose cache is already valid
+		bool compress = false;      // Compress the bulk arrays of the caches, see `render::ModelCache::write`
+		uint32_t job_count = 2;     // Models baked at the same time, sharing the worker threads
+
+		///
+		/// @brief Parse the argument
+		///
+		/// @param arguments Input argument
+		/// @return Parsed argument or error
+		///
+		[[nodiscard]]
+		static std::expected<Argument, Error> parse(std::span<const char*> arguments) noexcept;
+	};
+}
@@ -0,0 +1,73 @@
+#include "bake/argument.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/context/capability.hpp"
+
+#include <argparse/argparse.hpp>
+#include <cstdint>
+#include <exception>
+#include <expected>
+#include <format>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bake
+{
+	std::expected<Argument, Error> Argument::parse(std::span<const char*> arguments) noexcept
+	{
+		Argument argument;
+
+		auto job_count = static_cast<int>(argument.job_count);
+
+		argparse::ArgumentParser parser("bake.cache");
+		parser.add_argument("models")
+			.help("Paths to the glTF models to bake")
+			.nargs(argparse::nargs_pattern::at_least_one);
+		parser.add_argument("--tier")
+			.help("Bake for the performance preset of the given device tier, instead of probing the device")
+			.choices("low", "medium", "high")
+			.action([&argument](const std::string& value) {
+				using Tier = vulkan::DeviceCapability::Tier;
+				argument.tier = value == "low" ? Tier::Low : value == "medium" ? Tier::Medium : Tier::High;
+			});
+		parser.add_argument("--merge-static")
+			.help("Bake with static geometry merged, for renderers started with --merge-static")
+			.flag()
+			.store_into(argument.merge_static);
+		parser.add_argument("--hlod")
+			.help("Bake with HLOD proxies built, for renderers started with --hlod")
+			.flag()
+			.store_into(argument.hlod);
+		parser.add_argument("--impostor")
+			.help("Bake with impostors of instanced meshes, for renderers started with --impostor")
+			.flag()
+			.store_into(argument.impostor);
+		parser.add_argument("--force")
+			.help("Re-bake models whose cache is already up to date")
+			.flag()
+			.store_into(argument.force);
+		parser.add_argument("--compress")
+			.help("Compress geometry and texture data, smaller caches decoded on load")
+			.flag()
+			.store_into(argument.compress);
+		parser.add_argument("--jobs")
+			.help("Number of models baked at the same time")
+			.store_into(job_count);
+
+		try
+		{
+			parser.parse_args(arguments.size(), arguments.data());
+		}
+		catch (const std::exception& e)
+		{
+			return Error(e.what(), parser.usage());
+		}
+
+		if (job_count <= 0) return Error("Invalid job count", std::format("Got {}", job_count));
+
+		argument.model_paths = parser.get<std::vector<std::string>>("models");
+		argument.job_count = static_cast<uint32_t>(job_count);
+
+		return argument;
+	}
+}
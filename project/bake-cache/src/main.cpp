@@ -0,0 +1,236 @@
+#include "bake/argument.hpp"
+#include "common/util/error.hpp"
+#include "logic/model-cache.hpp"
+#include "logic/preset.hpp"
+#include "model/gltf.hpp"
+#include "model/impostor.hpp"
+#include "model/merge.hpp"
+#include "model/model.hpp"
+#include "render/model/model-cache.hpp"
+#include "render/model/model.hpp"
+#include "render/model/texture.hpp"
+#include "vulkan/context/capability.hpp"
+#include "vulkan/context/device.hpp"
+#include "vulkan/context/instance.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coro/sync_wait.hpp>
+#include <coro/thread_pool.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <print>
+#include <ranges>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class BakeOutcome
+{
+	Baked,
+	UpToDate  // A valid cache exists, skipped
+};
+
+static std::expected<model::Model, Error> parse_model(
+	coro::thread_pool& thread_pool,
+	const std::filesystem::path& model_path,
+	bool merge_static,
+	bool build_hlod,
+	bool build_impostors
+) noexcept
+{
+	auto [parsing_task, parsing_progress] = model::gltf::load_from_file(thread_pool, model_path);
+	auto parsing_result = coro::sync_wait(std::move(parsing_task));
+	if (!parsing_result) return parsing_result.error().forward("Parse gltf model failed");
+	auto parsed_model = std::move(*parsing_result);
+
+	if (merge_static)
+	{
+		auto merge_result = model::merge_static_geometry(std::move(parsed_model));
+		if (!merge_result) return merge_result.error().forward("Merge static geometry failed");
+		parsed_model = std::move(merge_result->model);
+	}
+
+	if (build_hlod)
+	{
+		auto hlod_result = model::build_hlod(std::move(parsed_model));
+		if (!hlod_result) return hlod_result.error().forward("Build HLOD failed");
+		parsed_model = std::move(*hlod_result);
+	}
+
+	if (build_impostors)
+	{
+		auto impostor_result = model::bake_impostors(std::move(parsed_model));
+		if (!impostor_result) return impostor_result.error().forward("Bake impostors failed");
+		parsed_model = std::move(*impostor_result);
+	}
+
+	return parsed_model;
+}
+
+// Bake a model into its cache file, unless a valid cache exists. Caches are written to a temporary file and
+// renamed, so an interrupted bake never leaves a partial cache and the next run resumes from the models
+// without a valid one.
+static std::expected<BakeOutcome, Error> bake_model(
+	coro::thread_pool& thread_pool,
+	const std::filesystem::path& model_path,
+	const render::Model::Option& model_option,
+	const bake::Argument& argument
+) noexcept
+{
+	const auto source_hash_result = render::ModelCache::hash_file(model_path);
+	if (!source_hash_result) return source_hash_result.error().forward("Hash model file failed");
+
+	const auto cache_key = render::ModelCache::get_key(*source_hash_result, model_option);
+	const auto cache_path = logic::get_model_cache_path(
+		*source_hash_result,
+		argument.merge_static,
+		argument.hlod,
+		argument.impostor
+	);
+
+	if (!argument.force && render::ModelCache::open(cache_path, cache_key)) return BakeOutcome::UpToDate;
+
+	auto model_result =
+		parse_model(thread_pool, model_path, argument.merge_static, argument.hlod, argument.impostor);
+	if (!model_result) return model_result.error().forward("Load model failed");
+	const auto model = std::move(*model_result);
+
+	auto [bake_task, bake_progress] = render::Model::bake(thread_pool, model, model_option);
+	auto bake_result = coro::sync_wait(std::move(bake_task));
+	if (!bake_result) return bake_result.error().forward("Bake model failed");
+
+	const auto write_result =
+		render::ModelCache::write(cache_path, cache_key, bake_result->view(), argument.compress);
+	if (!write_result) return write_result.error().forward("Write model cache failed");
+
+	return BakeOutcome::Baked;
+}
+
+// Get the model option the renderer uses on this machine, the texture strategies of the preset are fitted
+// to the best device, the one a headless context picks
+static std::expected<render::Model::Option, Error> get_model_option(const bake::Argument& argument) noexcept
+{
+	auto instance_result = vulkan::HeadlessInstanceContext::create({.application_name = "Vulkan-RT Bake"});
+	if (!instance_result) return instance_result.error().forward("Create instance context failed");
+	const auto instance = std::move(*instance_result);
+
+	auto device_result = vulkan::HeadlessDeviceContext::create(instance, {});
+	if (!device_result) return device_result.error().forward("Create device context failed");
+	const auto device = std::move(*device_result);
+
+	const auto& phy_device = device.get().phy_device;
+
+	const auto tier = argument.tier.value_or(vulkan::DeviceCapability::probe(phy_device).get_tier());
+	auto preset = logic::Preset::from_tier(tier);
+	preset.fit_textures(render::Texture::CompressionSupport::query(phy_device));
+
+	std::println(
+		"Baking for {} tier preset on {}",
+		logic::get_tier_name(tier),
+		phy_device.getProperties().deviceName.data()
+	);
+
+	return logic::get_model_option(preset, false, false, false);
+}
+
+static std::expected<void, Error> run(const bake::Argument& argument) noexcept
+{
+	auto model_option_result = get_model_option(argument);
+	if (!model_option_result) return model_option_result.error().forward("Get model option failed");
+	const auto model_option = std::move(*model_option_result);
+
+	// Jobs share the worker threads, e.g. one job parses while another encodes textures
+	const auto thread_pool = coro::thread_pool::make_unique();
+
+	const auto model_count = argument.model_paths.size();
+	std::vector<std::optional<std::expected<BakeOutcome, Error>>> results(model_count);
+	std::atomic<size_t> next_model = 0;
+	std::mutex print_mutex;
+
+	const auto start_time = std::chrono::steady_clock::now();
+
+	{
+		const auto job = [&] {
+			for (auto index = next_model++; index < model_count; index = next_model++)
+			{
+				const auto& model_path = argument.model_paths[index];
+				const auto model_start_time = std::chrono::steady_clock::now();
+
+				auto result = bake_model(*thread_pool, model_path, model_option, argument);
+
+				const auto seconds =
+					std::chrono::duration<double>(std::chrono::steady_clock::now() - model_start_time)
+						.count();
+				const auto label = std::format("[{}/{}] {}", index + 1, model_count, model_path);
+
+				{
+					const std::scoped_lock lock(print_mutex);
+					if (!result)
+						std::println(std::cerr, "{}: {:msg}", label, result.error().root());
+					else if (*result == BakeOutcome::UpToDate)
+						std::println("{}: up to date", label);
+					else
+						std::println("{}: baked in {:.1f}s", label, seconds);
+				}
+
+				results[index] = std::move(result);
+			}
+		};
+
+		const auto job_count = std::min<size_t>(argument.job_count, model_count);
+		std::vector<std::jthread> jobs;
+		jobs.reserve(job_count);
+		for ([[maybe_unused]] const auto _ : std::views::iota(0uz, job_count)) jobs.emplace_back(job);
+	}
+
+	const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	const auto count_outcome = [&results](BakeOutcome outcome) {
+		return std::ranges::count_if(results, [outcome](const auto& result) {
+			return result->has_value() && result->value() == outcome;
+		});
+	};
+	const auto failed_count =
+		std::ranges::count_if(results, [](const auto& result) { return !result->has_value(); });
+
+	std::println(
+		"Baked {}, up to date {}, failed {}, in {:.1f}s",
+		count_outcome(BakeOutcome::Baked),
+		count_outcome(BakeOutcome::UpToDate),
+		failed_count,
+		seconds
+	);
+
+	if (failed_count > 0) return Error("Some models failed to bake", "Run again to resume");
+
+	return {};
+}
+
+int main(int argc, const char* argv[]) noexcept
+{
+	const auto argument_result = bake::Argument::parse(std::span<const char*>(argv, argc));
+	if (!argument_result)
+	{
+		std::println(std::cerr, "{}", argument_result.error()->message);
+		if (argument_result.error()->detail) std::println(std::cerr, "{}", *argument_result.error()->detail);
+		return EXIT_FAILURE;
+	}
+
+	if (const auto result = run(*argument_result); !result)
+	{
+		std::println(std::cerr, "Error: {}", result.error().root());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,22 @@
+-- Offline model cache baker, pre-bakes a library of models into the cache files loaded by the renderer
+
+target("bake.cache")
+	set_kind("binary")
+	set_default(false)
+
+	add_deps(
+		"lib.common",
+		"lib.model",
+		"vulkan.util",
+		"vulkan.alloc",
+		"vulkan.context",
+		"model.gltf",
+		"render",
+		"main.common"
+	)
+
+	add_files("src/**.cpp")
+	add_includedirs("include")
+	add_headerfiles("include/**.hpp")
+
+	add_packages("argparse")
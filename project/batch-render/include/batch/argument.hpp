@@ -0,0 +1,35 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <span>
+#include <string>
+
+namespace batch
+{
+	///
+	/// @brief Command line arguments of the batch renderer
+	///
+	struct Argument
+	{
+		std::string model_path;
+		std::string view_file;               // JSON list of views, see `View::load`
+		std::string output_directory = ".";  // Directory receiving one PPM image per view
+
+		glm::u32vec2 extent = {512, 512};
+		uint32_t frame_count = 16;   // Frames accumulated by TAA and auto exposure for each view
+		bool packed_vertex = false;  // Upload vertices as `render::VertexFormat::Packed`
+
+		///
+		/// @brief Parse the argument
+		///
+		/// @param arguments Input argument
+		/// @return Parsed argument or error
+		///
+		[[nodiscard]]
+		static std::expected<Argument, Error> parse(std::span<const char*> arguments) noexcept;
+	};
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace batch
+{
+	///
+	/// @brief Writes read back images to disk on a background thread, see `still::ImageWriter`
+	/// @details Rendering only copies the data into the queue. A full queue blocks `push` until the writer
+	/// catches up, bounding the memory held by pending images.
+	///
+	class ImageQueue
+	{
+	  public:
+
+		///
+		/// @brief An image waiting to be written
+		///
+		struct Image
+		{
+			std::filesystem::path path;
+			glm::u32vec2 extent;
+			std::vector<std::byte> data;  // Tightly packed RGBA8 rows
+		};
+
+		///
+		/// @brief Create an image queue, starting its writer thread
+		///
+		/// @param capacity Maximum number of pending images
+		/// @return Created queue
+		///
+		[[nodiscard]]
+		static ImageQueue create(size_t capacity) noexcept;
+
+		///
+		/// @brief Queue an image, blocking while the queue is full
+		///
+		/// @param image Image to write
+		///
+		void push(Image image) noexcept;
+
+		///
+		/// @brief Write the pending images and stop the writer thread
+		///
+		/// @return Number of written images, or the first error
+		///
+		[[nodiscard]]
+		std::expected<uint32_t, Error> finish() noexcept;
+
+	  private:
+
+		// Shared with the writer thread, heap allocated to stay in place when the queue is moved
+		struct Shared
+		{
+			size_t capacity;
+			std::mutex mutex;
+			std::condition_variable_any condition;
+			std::deque<Image> queue;
+			uint32_t written_images = 0;
+			std::optional<Error> error = std::nullopt;  // First failure, later images are discarded
+		};
+
+		std::unique_ptr<Shared> shared;
+		std::jthread writer;  // Declared last to join first
+
+		static void write_loop(std::stop_token stop_token, Shared& shared) noexcept;
+
+		explicit ImageQueue(std::unique_ptr<Shared> shared) :
+			shared(std::move(shared)),
+			writer(write_loop, std::ref(*this->shared))
+		{}
+
+	  public:
+
+		ImageQueue(const ImageQueue&) = delete;
+		ImageQueue(ImageQueue&&) = default;
+		ImageQueue& operator=(const ImageQueue&) = delete;
+		ImageQueue& operator=(ImageQueue&&) = delete;
+	};
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "bench/camera-path.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+
+#include <expected>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace batch
+{
+	///
+	/// @brief A view to render, one point of a camera path
+	///
+	struct View
+	{
+		bench::CameraPath camera_path;
+		std::string name;  // Name of the output image, without extension
+		double time;       // Position along the camera path, in `[0, 1]`
+
+		///
+		/// @brief Parse a list of views
+		/// @details Each view is a camera path object, see `bench::CameraPath::from_json`, with an optional
+		/// `"name"` (defaults to the index of the view) and an optional `"time"` (defaults to `0`). A view
+		/// with a single keyframe is a fixed camera, e.g.
+		/// ```json
+		/// [
+		///     {"name": "front", "fov": 45, "lookat": [{"position": [0, 1, 3], "look_at": [0, 0, 0]}]},
+		///     {"center": [{"center": [0, 0, 0], "distance": 4, "pitch": 20, "yaw": 0},
+		///                 {"center": [0, 0, 0], "distance": 4, "pitch": 20, "yaw": 360}], "time": 0.25}
+		/// ]
+		/// ```
+		///
+		/// @param json Parsed JSON, must be a non-empty array
+		/// @return Parsed views or error
+		///
+		[[nodiscard]]
+		static std::expected<std::vector<View>, Error> load(const Json& json) noexcept;
+	};
+}
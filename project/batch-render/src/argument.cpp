@@ -0,0 +1,60 @@
+#include "batch/argument.hpp"
+#include "common/util/error.hpp"
+
+#include <argparse/argparse.hpp>
+#include <cstdint>
+#include <exception>
+#include <expected>
+#include <format>
+#include <span>
+
+namespace batch
+{
+	std::expected<Argument, Error> Argument::parse(std::span<const char*> arguments) noexcept
+	{
+		Argument argument;
+
+		auto width = static_cast<int>(argument.extent.x);
+		auto height = static_cast<int>(argument.extent.y);
+		auto frame_count = static_cast<int>(argument.frame_count);
+
+		argparse::ArgumentParser parser("batch.render");
+		parser.add_argument("model")
+			.help("Path to the glTF model to render")
+			.required()
+			.store_into(argument.model_path);
+		parser.add_argument("views")
+			.help("JSON file listing the views to render")
+			.required()
+			.store_into(argument.view_file);
+		parser.add_argument("--width").help("Width of each image").store_into(width);
+		parser.add_argument("--height").help("Height of each image").store_into(height);
+		parser.add_argument("--frames")
+			.help("Number of frames accumulated for each view")
+			.store_into(frame_count);
+		parser.add_argument("--output-dir")
+			.help("Directory receiving the PPM image of each view")
+			.store_into(argument.output_directory);
+		parser.add_argument("--packed-vertex")
+			.help("Use quantized vertex format")
+			.store_into(argument.packed_vertex);
+
+		try
+		{
+			parser.parse_args(arguments.size(), arguments.data());
+		}
+		catch (const std::exception& e)
+		{
+			return Error(e.what(), parser.usage());
+		}
+
+		if (width <= 0 || height <= 0)
+			return Error("Invalid resolution", std::format("Got {}x{}", width, height));
+		if (frame_count <= 0) return Error("Invalid frame count", std::format("Got {}", frame_count));
+
+		argument.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+		argument.frame_count = static_cast<uint32_t>(frame_count);
+
+		return argument;
+	}
+}
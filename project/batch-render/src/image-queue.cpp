@@ -0,0 +1,77 @@
+#include "batch/image-queue.hpp"
+#include "common/util/error.hpp"
+#include "still/image-writer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <utility>
+
+namespace batch
+{
+	ImageQueue ImageQueue::create(size_t capacity) noexcept
+	{
+		auto shared = std::make_unique<Shared>();
+		shared->capacity = capacity;
+
+		return ImageQueue(std::move(shared));
+	}
+
+	void ImageQueue::write_loop(std::stop_token stop_token, Shared& shared) noexcept
+	{
+		while (true)
+		{
+			auto lock = std::unique_lock(shared.mutex);
+
+			// Images queued before stopping are still written
+			shared.condition.wait(lock, stop_token, [&shared] { return !shared.queue.empty(); });
+			if (shared.queue.empty()) return;
+
+			auto image = std::move(shared.queue.front());
+			shared.queue.pop_front();
+			const bool failed = shared.error.has_value();
+			lock.unlock();
+
+			// Wake a producer waiting for space
+			shared.condition.notify_all();
+			if (failed) continue;
+
+			const auto result = [&image]() -> std::expected<void, Error> {
+				auto writer_result = still::ImageWriter::create(image.path, image.extent);
+				if (!writer_result) return writer_result.error().forward("Create image file failed");
+
+				writer_result->write({0, 0}, image.extent, image.data, image.extent.x);
+				return writer_result->finish();
+			}();
+
+			lock.lock();
+			if (result)
+				shared.written_images++;
+			else
+				shared.error = result.error().forward(std::format("Write '{}' failed", image.path.string()));
+		}
+	}
+
+	void ImageQueue::push(Image image) noexcept
+	{
+		{
+			auto lock = std::unique_lock(shared->mutex);
+			shared->condition.wait(lock, [this] { return shared->queue.size() < shared->capacity; });
+			shared->queue.push_back(std::move(image));
+		}
+		shared->condition.notify_all();
+	}
+
+	std::expected<uint32_t, Error> ImageQueue::finish() noexcept
+	{
+		writer.request_stop();
+		if (writer.joinable()) writer.join();
+
+		if (shared->error.has_value()) return *shared->error;
+		return shared->written_images;
+	}
+}
@@ -0,0 +1,214 @@
+#include "batch/argument.hpp"
+#include "batch/image-queue.hpp"
+#include "batch/view.hpp"
+#include "common/file.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "render/model/mesh.hpp"
+#include "server/scene.hpp"
+#include "still/tile-renderer.hpp"
+#include "vulkan/context/device.hpp"
+#include "vulkan/context/instance.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <print>
+#include <ranges>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Exposure adaptation step of every frame, the exposure of the previous view converges over the frames
+static constexpr float VIEW_DELTA_TIME = 0.1f;
+
+// Images read back but not yet written by each device, bounds the memory held by a slow disk
+static constexpr size_t IMAGE_QUEUE_CAPACITY = 8;
+
+struct DeviceReport
+{
+	std::string device_name;
+	uint32_t rendered_views = 0;
+	uint32_t written_images = 0;
+	double seconds = 0.0;
+};
+
+// Render views on one device until none is left. Views are taken one at a time from the shared counter, so
+// faster devices take more of them. The renderer keeps `TileRenderer::FRAME_RESOURCE_COUNT` frames in
+// flight, and the images are written by the queue without stalling the device.
+static std::expected<DeviceReport, Error> render_views(
+	const vulkan::HeadlessDeviceContext& device,
+	const batch::Argument& argument,
+	std::span<batch::View> views,
+	std::atomic<size_t>& next_view
+) noexcept
+{
+	const auto context = device.get();
+
+	auto report = DeviceReport{.device_name = std::string(context.phy_device.getProperties().deviceName)};
+
+	auto scene_result = server::Scene::create(
+		context,
+		argument.model_path,
+		argument.packed_vertex ? render::VertexFormat::Packed : render::VertexFormat::Full,
+		false
+	);
+	if (!scene_result) return scene_result.error().forward("Load scene failed");
+	const auto scene = std::move(*scene_result);
+
+	auto renderer_result = still::TileRenderer::create(context, scene, argument.extent);
+	if (!renderer_result) return renderer_result.error().forward("Create renderer failed");
+	auto renderer = std::move(*renderer_result);
+
+	auto image_queue = batch::ImageQueue::create(IMAGE_QUEUE_CAPACITY);
+
+	const auto start_time = std::chrono::steady_clock::now();
+
+	for (auto view_index = next_view++; view_index < views.size(); view_index = next_view++)
+	{
+		auto& view = views[view_index];
+		const auto output_path = std::filesystem::path(argument.output_directory) / (view.name + ".ppm");
+
+		for (const auto frame_index : std::views::iota(0u, argument.frame_count))
+		{
+			const auto camera = view.camera_path.sample(view.time, argument.extent);
+
+			auto readback = std::optional<vulkan::ReadbackRing::Callback>();
+			if (frame_index + 1 == argument.frame_count)
+				readback = [&image_queue, output_path, extent = argument.extent](
+							   std::span<const std::byte> data
+						   ) {
+					image_queue.push({
+						.path = output_path,
+						.extent = extent,
+						.data = std::vector(data.begin(), data.end()),
+					});
+				};
+
+			const auto result =
+				renderer.render_frame(context, camera, VIEW_DELTA_TIME, frame_index > 0, std::move(readback));
+			if (!result) return result.error().forward(std::format("Render view '{}' failed", view.name));
+		}
+
+		report.rendered_views++;
+	}
+
+	if (const auto result = renderer.finish(context); !result)
+		return result.error().forward("Finish renderer failed");
+
+	const auto written_result = image_queue.finish();
+	if (!written_result) return written_result.error().forward("Write images failed");
+	report.written_images = *written_result;
+
+	report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	return report;
+}
+
+static std::expected<Json, Error> run(const batch::Argument& argument) noexcept
+{
+	/* Views */
+
+	const auto content_result = file::read(argument.view_file);
+	if (!content_result) return content_result.error().forward("Read view file failed");
+
+	const auto json = Json::parse(*content_result, nullptr, false);
+	if (json.is_discarded()) return Error("Parse view file failed", "Invalid JSON");
+
+	auto views_result = batch::View::load(json);
+	if (!views_result) return views_result.error().forward("Load views failed");
+	auto views = std::move(*views_result);
+
+	std::error_code error_code;
+	std::filesystem::create_directories(argument.output_directory, error_code);
+	if (error_code) return Error("Create output directory failed", error_code.message());
+
+	/* Context */
+
+	auto instance_result =
+		vulkan::HeadlessInstanceContext::create({.application_name = "Vulkan-RT Batch Render"});
+	if (!instance_result) return instance_result.error().forward("Create instance context failed");
+	auto instance = std::move(*instance_result);
+
+	auto devices_result = vulkan::HeadlessDeviceContext::create_all(instance, {.raytracing = true}, ".cache");
+	if (!devices_result) return devices_result.error().forward("Create device contexts failed");
+	const auto devices = std::move(*devices_result);
+
+	/* Render, one thread per device */
+
+	const auto start_time = std::chrono::steady_clock::now();
+
+	std::atomic<size_t> next_view = 0;
+	std::vector<std::optional<std::expected<DeviceReport, Error>>> results(devices.size());
+
+	{
+		std::vector<std::jthread> threads;
+		threads.reserve(devices.size());
+
+		for (const auto device_index : std::views::iota(0uz, devices.size()))
+			threads.emplace_back([&devices, &results, &argument, &views, &next_view, device_index] {
+				results[device_index] = render_views(devices[device_index], argument, views, next_view);
+			});
+	}
+
+	const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	/* Summarize */
+
+	auto json_report = Json::object();
+	json_report["model"] = argument.model_path;
+	json_report["resolution"] = {argument.extent.x, argument.extent.y};
+	json_report["views"] = views.size();
+	json_report["seconds"] = seconds;
+	json_report["views_per_second"] = static_cast<double>(views.size()) / seconds;
+
+	auto& device_reports = json_report["devices"] = Json::array();
+	for (const auto& result : results)
+	{
+		if (!result->has_value()) return result->error().forward("Render on device failed");
+
+		const auto& report = result->value();
+		device_reports.push_back(
+			Json{
+				{"device", report.device_name},
+				{"rendered_views", report.rendered_views},
+				{"written_images", report.written_images},
+				{"seconds", report.seconds},
+			}
+		);
+	}
+
+	return json_report;
+}
+
+int main(int argc, const char* argv[]) noexcept
+{
+	const auto argument_result = batch::Argument::parse(std::span<const char*>(argv, argc));
+	if (!argument_result)
+	{
+		std::println(std::cerr, "{}", argument_result.error()->message);
+		if (argument_result.error()->detail) std::println(std::cerr, "{}", *argument_result.error()->detail);
+		return EXIT_FAILURE;
+	}
+
+	const auto report_result = run(*argument_result);
+	if (!report_result)
+	{
+		std::println(std::cerr, "Error: {}", report_result.error().root());
+		return EXIT_FAILURE;
+	}
+
+	std::println("{}", report_result->dump(4));
+	return EXIT_SUCCESS;
+}
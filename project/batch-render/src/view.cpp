@@ -0,0 +1,60 @@
+#include "batch/view.hpp"
+#include "bench/camera-path.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <format>
+#include <ranges>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace batch
+{
+	std::expected<std::vector<View>, Error> View::load(const Json& json) noexcept
+	{
+		if (!json.is_array() || json.empty()) return Error("Views must be a non-empty array");
+
+		std::vector<View> views;
+		views.reserve(json.size());
+
+		for (const auto& [index, view_json] : json | std::views::enumerate)
+		{
+			auto camera_path_result = bench::CameraPath::from_json(view_json);
+			if (!camera_path_result)
+				return camera_path_result.error().forward(
+					std::format("Parse camera path of view {} failed", index)
+				);
+
+			auto name = std::format("view-{:05}", index);
+			if (view_json.contains("name"))
+			{
+				if (!view_json["name"].is_string() || view_json["name"].get<std::string>().empty())
+					return Error(std::format("Invalid name of view {}", index), "Expects a non-empty string");
+				name = view_json["name"].get<std::string>();
+			}
+
+			auto time = 0.0;
+			if (view_json.contains("time"))
+			{
+				if (!view_json["time"].is_number())
+					return Error(std::format("Invalid time of view {}", index), "Expects a number");
+				time = view_json["time"].get<double>();
+				if (time < 0.0 || time > 1.0)
+					return Error(std::format("Invalid time of view {}", index), "Expects [0, 1]");
+			}
+
+			views.push_back(
+				View{
+					.camera_path = std::move(*camera_path_result),
+					.name = std::move(name),
+					.time = time,
+				}
+			);
+		}
+
+		return views;
+	}
+}
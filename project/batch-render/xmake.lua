@@ -0,0 +1,25 @@
+-- Batch view renderer, renders a list of views of one model spread across every suitable GPU
+
+target("batch.render")
+	set_kind("binary")
+	set_default(false)
+
+	add_deps(
+		"lib.common",
+		"lib.scene",
+		"vulkan.util",
+		"vulkan.alloc",
+		"vulkan.context",
+		"model.gltf",
+		"render",
+		"main.common",
+		"bench.render.common",
+		"server.render.common",
+		"still.render.common"
+	)
+
+	add_files("src/**.cpp")
+	add_includedirs("include")
+	add_headerfiles("include/**.hpp")
+
+	add_packages("argparse")
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace bench
+{
+	///
+	/// @brief Command line arguments of the benchmark
+	///
+	struct Argument
+	{
+		std::string model_path;                  // Path to the glTF model
+		std::optional<std::string> path_file;    // Camera path JSON file, orbits the origin if empty
+		std::optional<std::string> output_file;  // Report output file, prints to stdout if empty
+
+		// Input capture of the main renderer (`--capture-input`), replaces the camera path, frame count and
+		// extent by the recorded views, frames and extent
+		std::optional<std::string> replay_file;
+
+		uint32_t frame_count = 600;   // Measured frames
+		uint32_t warmup_frames = 60;  // Frames rendered before measuring, excluded from the report
+		glm::u32vec2 extent = {1920, 1080};
+		bool packed_vertex = false;  // Upload vertices as `render::VertexFormat::Packed`
+		float lod_error = 0.0f;      // Maximum projected LOD error in pixels, LOD generation disabled if `0`
+
+		bool full_resolution_shadow = false;  // Trace the shadow mask at full instead of half resolution
+		bool fragment_lighting = false;       // Light with a fullscreen draw instead of compute
+
+		///
+		/// @brief Parse the argument
+		///
+		/// @param arguments Input argument
+		/// @return Parsed argument or error
+		///
+		[[nodiscard]]
+		static std::expected<Argument, Error> parse(std::span<const char*> arguments) noexcept;
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "scene/camera.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_double4x4.hpp>
+#include <glm/ext/vector_double2.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace bench
+{
+	///
+	/// @brief Scripted camera path, interpolated linearly between evenly spaced keyframes
+	/// @details The path is described in JSON with either `CenterView` or `LookatView` keyframes:
+	/// ```json
+	/// {"fov": 50.0, "center": [{"center": [0, 0, 0], "distance": 3.0, "pitch": 30.0, "yaw": 0.0}, ...]}
+	/// {"fov": 50.0, "lookat": [{"position": [0, 1, 3], "look_at": [0, 0, 0], "up": [0, 1, 0]}, ...]}
+	/// ```
+	/// `fov` is optional. Repeat the first keyframe at the end to get a closed path.
+	///
+	class CameraPath
+	{
+	  public:
+
+		///
+		/// @brief Create a closed path orbiting around the origin
+		///
+		/// @param distance Distance from the origin
+		/// @param pitch_degrees Pitch angle of the camera
+		/// @return Created path
+		///
+		[[nodiscard]]
+		static CameraPath orbit(double distance = 3.0, double pitch_degrees = 30.0) noexcept;
+
+		///
+		/// @brief Parse a path from JSON, see class description for the format
+		///
+		/// @param json Input JSON
+		/// @return Parsed path or error
+		///
+		[[nodiscard]]
+		static std::expected<CameraPath, Error> from_json(const Json& json) noexcept;
+
+		///
+		/// @brief Create a path through the given views, e.g. the frames of a recorded input
+		/// @note Sample at `i / (n - 1)` to get the `i`-th of `n` views exactly
+		///
+		/// @param views Views of the path, at least one
+		/// @param projection Projection of the path
+		/// @return Created path
+		///
+		[[nodiscard]]
+		static CameraPath from_views(
+			std::vector<scene::camera::CenterView> views,
+			scene::camera::PerspectiveProjection projection
+		) noexcept;
+
+		///
+		/// @brief Get the camera parameters at a point of the path
+		/// @note Previous-frame matrices are taken from the last call, this function is expected to be
+		/// called once per rendered frame
+		///
+		/// @param t Position along the path, `0` for the first keyframe and `1` for the last
+		/// @param extent Extent of the render target
+		/// @return Camera parameters
+		///
+		[[nodiscard]]
+		render::Camera sample(double t, glm::u32vec2 extent) noexcept;
+
+		///
+		/// @brief Get the camera parameters of a tile of the image at a point of the path
+		/// @note Like `sample`, previous-frame matrices are taken from the last call
+		///
+		/// @param t Position along the path, `0` for the first keyframe and `1` for the last
+		/// @param image_extent Extent of the whole image, sets the aspect ratio
+		/// @param ndc_min Lower corner of the tile in NDC of the whole image
+		/// @param ndc_max Upper corner of the tile in NDC of the whole image
+		/// @param tile_extent Extent of the render target of the tile, scales the jitter
+		/// @return Camera parameters, see `scene::camera::PerspectiveProjection::sub_matrix`
+		///
+		[[nodiscard]]
+		render::Camera sample_tile(
+			double t,
+			glm::u32vec2 image_extent,
+			glm::dvec2 ndc_min,
+			glm::dvec2 ndc_max,
+			glm::u32vec2 tile_extent
+		) noexcept;
+
+	  private:
+
+		using Keyframes =
+			std::variant<std::vector<scene::camera::CenterView>, std::vector<scene::camera::LookatView>>;
+
+		Keyframes keyframes;
+		scene::camera::PerspectiveProjection projection;
+
+		std::optional<render::Camera> prev_camera = std::nullopt;
+		uint32_t frame_index = 0;  // Selects the jitter of the frame
+
+		[[nodiscard]]
+		render::Camera sample_projection(
+			double t,
+			const glm::dmat4& proj_matrix,
+			glm::u32vec2 extent
+		) noexcept;
+
+		explicit CameraPath(Keyframes keyframes, scene::camera::PerspectiveProjection projection) :
+			keyframes(std::move(keyframes)),
+			projection(projection)
+		{}
+
+	  public:
+
+		CameraPath(const CameraPath&) = delete;
+		CameraPath(CameraPath&&) = default;
+		CameraPath& operator=(const CameraPath&) = delete;
+		CameraPath& operator=(CameraPath&&) = default;
+	};
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "logic/param/auto-exposure.hpp"
+#include "logic/param/primary-light.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/util/per-render-state.hpp"
+#include "resource/aux-resource.hpp"
+#include "resource/pipeline.hpp"
+#include "resource/render-resource.hpp"
+#include "resource/sync-primitive.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/container/host/cycle.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/pipeline-statistics-query.hpp"
+#include "vulkan/util/timestamp-query.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace bench
+{
+	///
+	/// @brief Offscreen renderer running the same passes as the main render page
+	/// @details Frames are rendered synchronously: each call to `render_frame()` waits for the GPU to finish
+	/// before returning, so that CPU and GPU timings of a frame can be reported together. Two sets of frame
+	/// resources are still alternated, as HiZ culling and auto exposure read the previous frame.
+	///
+	class Renderer
+	{
+	  public:
+
+		static constexpr auto TARGET_FORMAT = vk::Format::eR8G8B8A8Unorm;
+		static constexpr uint32_t FRAME_RESOURCE_COUNT = 2;
+
+		///
+		/// @brief Timings and statistics of a single frame
+		///
+		struct FrameResult
+		{
+			double cpu_ms;    // Time spent updating, recording and submitting on CPU
+			double frame_ms;  // Wall time from start of update to GPU completion
+			std::vector<vulkan::TimestampQuery::Result> gpu_results;
+
+			render::PerRenderState<render::IndirectCount> culling;  // Counts of the culled main camera
+			std::vector<vulkan::PipelineStatisticsQuery::Result> pipeline_statistics;
+		};
+
+		///
+		/// @brief Create an offscreen renderer
+		///
+		/// @param context Vulkan context
+		/// @param material_layout Material layout of the model
+		/// @param model Model to render
+		/// @param tlas Top-level acceleration structure of the model
+		/// @param extent Extent of the offscreen target
+		/// @param lod_pixel_error Maximum projected LOD error in pixels, `0` always draws the full geometry
+		/// @param half_resolution_shadow Whether to trace the shadow mask at half resolution
+		/// @param compute_lighting Whether to perform direct lighting with a compute dispatch, see
+		/// `render::DirectLightingPipeline::compute`
+		/// @return Created renderer or error
+		///
+		[[nodiscard]]
+		static std::expected<Renderer, Error> create(
+			const vulkan::Context& context,
+			render::MaterialLayout material_layout,
+			render::Model model,
+			render::Tlas tlas,
+			glm::u32vec2 extent,
+			float lod_pixel_error,
+			bool half_resolution_shadow,
+			bool compute_lighting
+		) noexcept;
+
+		///
+		/// @brief Render a frame and wait for its completion
+		///
+		/// @param context Vulkan context
+		/// @param camera Camera parameters of the frame
+		/// @param delta_time Simulated frame time in seconds, drives the exposure adaptation
+		/// @return Timings of the frame or error
+		///
+		[[nodiscard]]
+		std::expected<FrameResult, Error> render_frame(
+			const vulkan::Context& context,
+			const render::Camera& camera,
+			float delta_time
+		) noexcept;
+
+	  private:
+
+		struct FrameResource
+		{
+			vk::raii::CommandBuffer command_buffer;
+			resource::RenderResource render_resource;
+			resource::ResourceSet resource_set;
+			resource::FrameSyncPrimitive sync_primitive;
+			vulkan::TimestampQuery timestamp_query;
+			vulkan::PipelineStatisticsQuery statistics_query;
+
+			explicit FrameResource(
+				vk::raii::CommandBuffer command_buffer,
+				resource::RenderResource render_resource,
+				resource::ResourceSet resource_set,
+				resource::FrameSyncPrimitive sync_primitive,
+				vulkan::TimestampQuery timestamp_query,
+				vulkan::PipelineStatisticsQuery statistics_query
+			) :
+				command_buffer(std::move(command_buffer)),
+				render_resource(std::move(render_resource)),
+				resource_set(std::move(resource_set)),
+				sync_primitive(std::move(sync_primitive)),
+				timestamp_query(std::move(timestamp_query)),
+				statistics_query(std::move(statistics_query))
+			{}
+
+			FrameResource(const FrameResource&) = delete;
+			FrameResource(FrameResource&&) = default;
+			FrameResource& operator=(const FrameResource&) = delete;
+			FrameResource& operator=(FrameResource&&) = default;
+		};
+
+		vk::raii::CommandPool command_pool;
+
+		render::MaterialLayout material_layout;
+		render::Model model;
+		render::Tlas tlas;
+
+		resource::Pipeline pipeline;
+		vulkan::Cycle<FrameResource> frame_resources;
+		vulkan::DeletionQueue deletion_queue = vulkan::DeletionQueue(FRAME_RESOURCE_COUNT);
+		resource::AuxResource aux_resource;
+		render::GiProbeVolume gi_probe_volume;  // Never updated, global illumination is not benchmarked
+
+		// Black placeholder, environment lighting is not benchmarked either
+		render::EnvironmentLighting environment_lighting;
+
+		vulkan::Attachment target;
+		glm::u32vec2 extent;
+		float lod_threshold;  // See `render::IndirectPipeline::compute`
+		bool compute_lighting;
+
+		logic::PrimaryLight primary_light;
+		logic::Exposure exposure;
+
+		bool history_valid = false;  // Whether HiZ and TAA output of previous frame hold valid content
+
+		explicit Renderer(
+			vk::raii::CommandPool command_pool,
+			render::MaterialLayout material_layout,
+			render::Model model,
+			render::Tlas tlas,
+			resource::Pipeline pipeline,
+			vulkan::Cycle<FrameResource> frame_resources,
+			resource::AuxResource aux_resource,
+			render::GiProbeVolume gi_probe_volume,
+			render::EnvironmentLighting environment_lighting,
+			vulkan::Attachment target,
+			glm::u32vec2 extent,
+			float lod_threshold,
+			bool compute_lighting
+		) :
+			command_pool(std::move(command_pool)),
+			material_layout(std::move(material_layout)),
+			model(std::move(model)),
+			tlas(std::move(tlas)),
+			pipeline(std::move(pipeline)),
+			frame_resources(std::move(frame_resources)),
+			aux_resource(std::move(aux_resource)),
+			gi_probe_volume(std::move(gi_probe_volume)),
+			environment_lighting(std::move(environment_lighting)),
+			target(std::move(target)),
+			extent(extent),
+			lod_threshold(lod_threshold),
+			compute_lighting(compute_lighting)
+		{}
+
+		void record(FrameResource& frame, const FrameResource& prev_frame, bool history_valid) const noexcept;
+
+		void record_phase(FrameResource& frame, render::DrawPhase phase, bool history_valid) const noexcept;
+
+		void record_lighting(FrameResource& frame) const noexcept;
+
+		void record_composite(FrameResource& frame) const noexcept;
+
+	  public:
+
+		Renderer(const Renderer&) = delete;
+		Renderer(Renderer&&) = default;
+		Renderer& operator=(const Renderer&) = delete;
+		Renderer& operator=(Renderer&&) = default;
+	};
+}
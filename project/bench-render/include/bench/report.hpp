@@ -0,0 +1,92 @@
+#pragma once
+
+#include "bench/renderer.hpp"
+#include "common/json.hpp"
+#include "vulkan/alloc/allocator.hpp"
+
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+	///
+	/// @brief Accumulates per-frame measurements and summarizes them into a JSON report
+	///
+	class Report
+	{
+	  public:
+
+		///
+		/// @brief Summary statistics of a series of samples, timings are in milliseconds
+		///
+		struct Statistics
+		{
+			double average, min, p50, p95, p99, max;
+
+			///
+			/// @brief Compute statistics of the samples
+			///
+			/// @param samples Input samples
+			/// @return Computed statistics, all zero if @p samples is empty
+			///
+			[[nodiscard]]
+			static Statistics from(std::span<const double> samples) noexcept;
+
+			[[nodiscard]]
+			Json to_json() const noexcept;
+		};
+
+		///
+		/// @brief Record a measured frame
+		///
+		/// @param frame Timings and statistics of the frame
+		/// @param memory_usage Device memory usage sampled after the frame
+		///
+		void push(
+			const Renderer::FrameResult& frame,
+			const vulkan::Allocator::DeviceMemoryUsage& memory_usage
+		) noexcept;
+
+		///
+		/// @brief Summarize recorded frames
+		///
+		/// @return JSON object holding `cpu_frame_ms`, `frame_ms`, `gpu_pass_ms`, `culling`,
+		/// `pipeline_statistics` and `vram`
+		///
+		[[nodiscard]]
+		Json to_json() const noexcept;
+
+	  private:
+
+		std::vector<double> cpu_times;
+		std::vector<double> frame_times;
+
+		// Pass timings, kept in the order the passes first appear
+		std::vector<std::pair<std::string, std::vector<double>>> pass_times;
+
+		// Counts of the main camera summed over the render states
+		struct CullingSamples
+		{
+			std::vector<double> early_draws, late_draws, commands, triangles;
+		};
+
+		struct PipelineSamples
+		{
+			std::vector<double> input_primitives, clipping_primitives, fragment_invocations,
+				compute_invocations;
+		};
+
+		CullingSamples culling_samples;
+
+		// Pipeline statistics, kept in the order the slots first appear
+		std::vector<std::pair<std::string, PipelineSamples>> pipeline_samples;
+
+		vulkan::Allocator::DeviceMemoryUsage peak_memory_usage = {
+			.allocation_bytes = 0,
+			.usage_bytes = 0,
+			.budget_bytes = 0
+		};
+	};
+}
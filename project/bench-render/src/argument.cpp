@@ -0,0 +1,86 @@
+#include "bench/argument.hpp"
+#include "common/util/error.hpp"
+
+#include <argparse/argparse.hpp>
+#include <cstdint>
+#include <exception>
+#include <expected>
+#include <format>
+#include <span>
+#include <string>
+#include <utility>
+
+namespace bench
+{
+	std::expected<Argument, Error> Argument::parse(std::span<const char*> arguments) noexcept
+	{
+		Argument argument;
+
+		auto frame_count = static_cast<int>(argument.frame_count);
+		auto warmup_frames = static_cast<int>(argument.warmup_frames);
+		auto width = static_cast<int>(argument.extent.x);
+		auto height = static_cast<int>(argument.extent.y);
+		std::string path_file, output_file, replay_file;
+
+		argparse::ArgumentParser parser("bench.render");
+		parser.add_argument("model")
+			.help("Path to the glTF model to render")
+			.required()
+			.store_into(argument.model_path);
+		parser.add_argument("--frames").help("Number of measured frames").store_into(frame_count);
+		parser.add_argument("--warmup")
+			.help("Number of frames rendered before measuring")
+			.store_into(warmup_frames);
+		parser.add_argument("--width").help("Width of the offscreen target").store_into(width);
+		parser.add_argument("--height").help("Height of the offscreen target").store_into(height);
+		parser.add_argument("--path")
+			.help("Camera path JSON file, orbits the origin if omitted")
+			.store_into(path_file);
+		parser.add_argument("--replay")
+			.help("Replay the camera views and delta times recorded by --capture-input of the main renderer")
+			.store_into(replay_file);
+		parser.add_argument("--output")
+			.help("Write the JSON report to file instead of stdout")
+			.store_into(output_file);
+		parser.add_argument("--packed-vertex")
+			.help("Use quantized vertex format")
+			.store_into(argument.packed_vertex);
+		parser.add_argument("--lod-error")
+			.help("Generate LODs and select them with the maximum projected error in pixels")
+			.store_into(argument.lod_error);
+		parser.add_argument("--full-res-shadow")
+			.help("Trace the shadow mask at full resolution")
+			.store_into(argument.full_resolution_shadow);
+		parser.add_argument("--fragment-lighting")
+			.help("Perform direct lighting in a fragment shader instead of a compute shader")
+			.store_into(argument.fragment_lighting);
+
+		try
+		{
+			parser.parse_args(arguments.size(), arguments.data());
+		}
+		catch (const std::exception& e)
+		{
+			return Error(e.what(), parser.usage());
+		}
+
+		if (frame_count <= 0) return Error("Invalid frame count", std::format("Got {}", frame_count));
+		if (warmup_frames < 0)
+			return Error("Invalid warmup frame count", std::format("Got {}", warmup_frames));
+		if (width <= 0 || height <= 0)
+			return Error("Invalid resolution", std::format("Got {}x{}", width, height));
+		if (!path_file.empty() && !replay_file.empty())
+			return Error("Invalid arguments", "--path and --replay can't be combined");
+		if (argument.lod_error < 0.0f)
+			return Error("Invalid LOD error", std::format("Got {}", argument.lod_error));
+
+		argument.frame_count = static_cast<uint32_t>(frame_count);
+		argument.warmup_frames = static_cast<uint32_t>(warmup_frames);
+		argument.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+		if (!path_file.empty()) argument.path_file = std::move(path_file);
+		if (!output_file.empty()) argument.output_file = std::move(output_file);
+		if (!replay_file.empty()) argument.replay_file = std::move(replay_file);
+
+		return argument;
+	}
+}
@@ -0,0 +1,236 @@
+#include "bench/camera-path.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/pipeline/taa.hpp"
+#include "scene/camera.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <expected>
+#include <glm/common.hpp>
+#include <glm/ext/matrix_double4x4.hpp>
+#include <glm/ext/vector_double2.hpp>
+#include <glm/ext/vector_double3.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <libassert/assert.hpp>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace bench
+{
+	namespace
+	{
+		constexpr auto DEFAULT_PROJECTION = scene::camera::PerspectiveProjection{
+			.fov_degrees = 50.0,
+			.near = 0.01,
+			.far = std::nullopt,
+		};
+
+		std::optional<glm::dvec3> parse_vec3(const Json& json) noexcept
+		{
+			if (!json.is_array() || json.size() != 3) return std::nullopt;
+			if (!std::ranges::all_of(json, [](const Json& element) { return element.is_number(); }))
+				return std::nullopt;
+
+			return glm::dvec3(json[0].get<double>(), json[1].get<double>(), json[2].get<double>());
+		}
+
+		std::optional<double> parse_number(const Json& json, const char* key) noexcept
+		{
+			if (!json.contains(key) || !json[key].is_number()) return std::nullopt;
+			return json[key].get<double>();
+		}
+
+		std::expected<scene::camera::CenterView, Error> parse_center_view(const Json& json) noexcept
+		{
+			const auto center = json.contains("center") ? parse_vec3(json["center"]) : std::nullopt;
+			const auto distance = parse_number(json, "distance");
+			const auto pitch = parse_number(json, "pitch");
+			const auto yaw = parse_number(json, "yaw");
+
+			if (!center || !distance || !pitch || !yaw)
+				return Error("Invalid center keyframe", "Expects 'center', 'distance', 'pitch' and 'yaw'");
+
+			return scene::camera::CenterView{
+				.center_position = *center,
+				.distance = *distance,
+				.pitch_degrees = *pitch,
+				.yaw_degrees = *yaw,
+			};
+		}
+
+		std::expected<scene::camera::LookatView, Error> parse_lookat_view(const Json& json) noexcept
+		{
+			const auto position = json.contains("position") ? parse_vec3(json["position"]) : std::nullopt;
+			const auto look_at = json.contains("look_at") ? parse_vec3(json["look_at"]) : std::nullopt;
+			const auto up =
+				json.contains("up") ? parse_vec3(json["up"]) : std::optional(glm::dvec3(0.0, 1.0, 0.0));
+
+			if (!position || !look_at || !up)
+				return Error("Invalid lookat keyframe", "Expects 'position', 'look_at' and optional 'up'");
+
+			return scene::camera::LookatView{
+				.position = *position,
+				.look_position = *look_at,
+				.up_direction = *up,
+			};
+		}
+
+		template <typename T, typename F>
+		std::expected<std::vector<T>, Error> parse_keyframes(const Json& json, F&& parse_fn) noexcept
+		{
+			if (!json.is_array() || json.empty()) return Error("Keyframes must be a non-empty array");
+
+			return json
+				| std::views::transform([&parse_fn](const Json& keyframe) { return parse_fn(keyframe); })
+				| Error::collect();
+		}
+
+		scene::camera::LookatView mix(
+			const scene::camera::LookatView& x,
+			const scene::camera::LookatView& y,
+			double a
+		) noexcept
+		{
+			return {
+				.position = glm::mix(x.position, y.position, a),
+				.look_position = glm::mix(x.look_position, y.look_position, a),
+				.up_direction = glm::normalize(glm::mix(x.up_direction, y.up_direction, a)),
+			};
+		}
+
+		scene::camera::CenterView mix(
+			const scene::camera::CenterView& x,
+			const scene::camera::CenterView& y,
+			double a
+		) noexcept
+		{
+			return scene::camera::CenterView::mix(x, y, a);
+		}
+
+		// Interpolate between evenly spaced keyframes, `t` is clamped to [0, 1]
+		template <scene::camera::ViewType T>
+		T interpolate(std::span<const T> keyframes, double t) noexcept
+		{
+			if (keyframes.size() == 1) return keyframes.front();
+
+			const auto segment_count = static_cast<double>(keyframes.size() - 1);
+			const auto position = glm::clamp(t, 0.0, 1.0) * segment_count;
+			const auto segment = std::min(static_cast<size_t>(position), keyframes.size() - 2);
+
+			return mix(keyframes[segment], keyframes[segment + 1], position - static_cast<double>(segment));
+		}
+	}
+
+	CameraPath CameraPath::orbit(double distance, double pitch_degrees) noexcept
+	{
+		auto keyframes =
+			std::views::iota(0, 5)
+			| std::views::transform([distance, pitch_degrees](int i) {
+				  return scene::camera::CenterView{
+					  .center_position = glm::dvec3(0.0),
+					  .distance = distance,
+					  .pitch_degrees = pitch_degrees,
+					  .yaw_degrees = 90.0 * i,
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+
+		return CameraPath(std::move(keyframes), DEFAULT_PROJECTION);
+	}
+
+	std::expected<CameraPath, Error> CameraPath::from_json(const Json& json) noexcept
+	{
+		if (!json.is_object()) return Error("Camera path must be a JSON object");
+
+		auto projection = DEFAULT_PROJECTION;
+		if (json.contains("fov"))
+		{
+			const auto fov = parse_number(json, "fov");
+			if (!fov || *fov <= 0.0 || *fov >= 180.0)
+				return Error("Invalid 'fov'", "Expects (0, 180) degrees");
+			projection.fov_degrees = *fov;
+		}
+
+		if (json.contains("center"))
+		{
+			auto keyframes_result =
+				parse_keyframes<scene::camera::CenterView>(json["center"], parse_center_view);
+			if (!keyframes_result) return keyframes_result.error().forward("Parse center keyframes failed");
+			return CameraPath(std::move(*keyframes_result), projection);
+		}
+
+		if (json.contains("lookat"))
+		{
+			auto keyframes_result =
+				parse_keyframes<scene::camera::LookatView>(json["lookat"], parse_lookat_view);
+			if (!keyframes_result) return keyframes_result.error().forward("Parse lookat keyframes failed");
+			return CameraPath(std::move(*keyframes_result), projection);
+		}
+
+		return Error("Camera path has no keyframes", "Expects either 'center' or 'lookat'");
+	}
+
+	CameraPath CameraPath::from_views(
+		std::vector<scene::camera::CenterView> views,
+		scene::camera::PerspectiveProjection projection
+	) noexcept
+	{
+		DEBUG_ASSERT(!views.empty());
+		return CameraPath(std::move(views), projection);
+	}
+
+	render::Camera CameraPath::sample(double t, glm::u32vec2 extent) noexcept
+	{
+		const auto aspect_ratio = static_cast<double>(extent.x) / static_cast<double>(extent.y);
+		return sample_projection(t, projection.matrix(aspect_ratio), extent);
+	}
+
+	render::Camera CameraPath::sample_tile(
+		double t,
+		glm::u32vec2 image_extent,
+		glm::dvec2 ndc_min,
+		glm::dvec2 ndc_max,
+		glm::u32vec2 tile_extent
+	) noexcept
+	{
+		const auto aspect_ratio = static_cast<double>(image_extent.x) / static_cast<double>(image_extent.y);
+		return sample_projection(t, projection.sub_matrix(aspect_ratio, ndc_min, ndc_max), tile_extent);
+	}
+
+	render::Camera CameraPath::sample_projection(
+		double t,
+		const glm::dmat4& proj_matrix,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		const auto [view_matrix, camera_pos] = std::visit(
+			[t]<typename T>(const std::vector<T>& keyframes) {
+				const auto view = interpolate(std::span<const T>(keyframes), t);
+				return std::pair(view.matrix(), view.view_position());
+			},
+			keyframes
+		);
+
+		const auto view_proj_matrix = scene::camera::reverse_z() * proj_matrix * view_matrix;
+
+		const auto camera = render::Camera{
+			.inv_view_projection = glm::inverse(view_proj_matrix),
+			.prev_view_projection = prev_camera ? prev_camera->view_projection : glm::mat4(view_proj_matrix),
+			.view_projection = view_proj_matrix,
+			.camera_pos = camera_pos,
+			.prev_camera_pos = prev_camera ? prev_camera->camera_pos : glm::vec3(camera_pos),
+			.jitter = render::TaaPipeline::get_jitter(frame_index++, extent),
+		};
+		prev_camera = camera;
+
+		return camera;
+	}
+}
@@ -0,0 +1,255 @@
+#include "bench/argument.hpp"
+#include "bench/camera-path.hpp"
+#include "bench/renderer.hpp"
+#include "bench/report.hpp"
+#include "common/file.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "logic/input-record.hpp"
+#include "logic/param.hpp"
+#include "model/gltf.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/texture-list.hpp"
+#include "render/model/texture.hpp"
+#include "render/model/tlas.hpp"
+#include "vulkan/context/device.hpp"
+#include "vulkan/context/instance.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <chrono>
+#include <coro/sync_wait.hpp>
+#include <coro/thread_pool.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <filesystem>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <iostream>
+#include <optional>
+#include <print>
+#include <ranges>
+#include <span>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Fixed simulated frame time, keeps exposure adaptation independent of the measured performance
+static constexpr float SIMULATED_DELTA_TIME = 1.0f / 60.0f;
+
+static std::expected<bench::CameraPath, Error> load_camera_path(
+	const bench::Argument& argument,
+	const std::optional<logic::InputReplay>& replay
+) noexcept
+{
+	// Recorded views are already smoothed, the projection is taken from the parameters of the first frame
+	if (replay)
+	{
+		const auto frames = replay->get_frames();
+
+		auto param = logic::Param();
+		if (frames.front().param) logic::apply_recorded_param(*frames.front().param, param);
+
+		auto views =
+			frames | std::views::transform(&logic::InputFrame::view) | std::ranges::to<std::vector>();
+		return bench::CameraPath::from_views(std::move(views), param.camera.projection);
+	}
+
+	if (!argument.path_file) return bench::CameraPath::orbit();
+
+	const auto content_result = file::read(*argument.path_file);
+	if (!content_result) return content_result.error().forward("Read camera path file failed");
+
+	const auto json = Json::parse(*content_result, nullptr, false);
+	if (json.is_discarded()) return Error("Parse camera path file failed", "Invalid JSON");
+
+	return bench::CameraPath::from_json(json);
+}
+
+static std::expected<std::tuple<render::MaterialLayout, render::Model, render::Tlas>, Error> load_model(
+	const vulkan::Context& context,
+	const std::string& model_path,
+	render::VertexFormat vertex_format,
+	bool generate_lod
+) noexcept
+{
+	auto thread_pool = coro::thread_pool::make_unique();
+
+	auto [gltf_parsing_task, gltf_parsing_progress] =
+		model::gltf::load_from_file(*thread_pool, std::filesystem::path(model_path));
+	auto gltf_parsing_result = coro::sync_wait(std::move(gltf_parsing_task));
+	if (!gltf_parsing_result) return gltf_parsing_result.error().forward("Parse gltf model failed");
+	auto gltf_model = std::move(*gltf_parsing_result);
+
+	auto material_layout_result = render::MaterialLayout::create(context);
+	if (!material_layout_result)
+		return material_layout_result.error().forward("Create material layout failed");
+	auto material_layout = std::move(*material_layout_result);
+
+	const auto texture_load_opt = render::TextureList::LoadOption{
+		.color_load_strategy = render::Texture::ColorLoadStrategy::BalancedBC,
+		.exit_on_failed_load = true
+	};
+
+	auto [model_task, model_progress] = render::Model::create(
+		*thread_pool,
+		context,
+		material_layout,
+		gltf_model,
+		{
+			.texture_load_option = texture_load_opt,
+			.compact_blas = true,
+			.vertex_format = vertex_format,
+			.optimize_mesh = true,
+			.generate_lod = generate_lod,
+		}
+	);
+	auto model_result = coro::sync_wait(std::move(model_task));
+	if (!model_result) return model_result.error().forward("Load model failed");
+	auto model = std::move(*model_result);
+
+	const auto transforms = model.hierarchy.compute_transforms(glm::mat4(1.0));
+	auto tlas_result = render::Tlas::build(context, model, transforms);
+	if (!tlas_result) return tlas_result.error().forward("Build TLAS failed");
+
+	return std::make_tuple(std::move(material_layout), std::move(model), std::move(*tlas_result));
+}
+
+static std::expected<Json, Error> run(const bench::Argument& argument) noexcept
+{
+	std::optional<logic::InputReplay> replay;
+	if (argument.replay_file)
+	{
+		auto replay_result = logic::InputReplay::load(*argument.replay_file);
+		if (!replay_result) return replay_result.error().forward("Load input replay failed");
+		replay.emplace(std::move(*replay_result));
+	}
+
+	auto camera_path_result = load_camera_path(argument, replay);
+	if (!camera_path_result) return camera_path_result.error().forward("Load camera path failed");
+	auto camera_path = std::move(*camera_path_result);
+
+	// Replays render every recorded frame at the extent of the capture
+	const auto frame_count =
+		replay ? static_cast<uint32_t>(replay->get_frames().size()) : argument.frame_count;
+	const auto extent = replay ? replay->get_frames().front().extent : argument.extent;
+
+	/* Context */
+
+	auto instance_result = vulkan::HeadlessInstanceContext::create({.application_name = "Vulkan-RT Bench"});
+	if (!instance_result) return instance_result.error().forward("Create instance context failed");
+	auto instance = std::move(*instance_result);
+
+	auto device_result = vulkan::HeadlessDeviceContext::create(instance, {.raytracing = true}, ".cache");
+	if (!device_result) return device_result.error().forward("Create device context failed");
+	auto device = std::move(*device_result);
+
+	const auto context = device.get();
+
+	/* Load */
+
+	const auto load_start_time = std::chrono::steady_clock::now();
+
+	auto load_result = load_model(
+		context,
+		argument.model_path,
+		argument.packed_vertex ? render::VertexFormat::Packed : render::VertexFormat::Full,
+		argument.lod_error > 0.0f
+	);
+	if (!load_result) return load_result.error().forward("Load model failed");
+	auto [material_layout, model, tlas] = std::move(*load_result);
+
+	const auto load_seconds =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - load_start_time).count();
+
+	auto renderer_result = bench::Renderer::create(
+		context,
+		std::move(material_layout),
+		std::move(model),
+		std::move(tlas),
+		extent,
+		argument.lod_error,
+		!argument.full_resolution_shadow,
+		!argument.fragment_lighting
+	);
+	if (!renderer_result) return renderer_result.error().forward("Create renderer failed");
+	auto renderer = std::move(*renderer_result);
+
+	/* Render */
+
+	for ([[maybe_unused]] const auto _ : std::views::iota(0u, argument.warmup_frames))
+	{
+		const auto camera = camera_path.sample(0.0, extent);
+		if (const auto result = renderer.render_frame(context, camera, SIMULATED_DELTA_TIME); !result)
+			return result.error().forward("Render warmup frame failed");
+	}
+
+	bench::Report report;
+
+	for (const auto frame_idx : std::views::iota(0u, frame_count))
+	{
+		const auto t =
+			frame_count > 1 ? static_cast<double>(frame_idx) / static_cast<double>(frame_count - 1) : 0.0;
+		const auto camera = camera_path.sample(t, extent);
+		const auto delta_time = replay ? replay->get_frames()[frame_idx].delta_time : SIMULATED_DELTA_TIME;
+
+		const auto frame_result = renderer.render_frame(context, camera, delta_time);
+		if (!frame_result) return frame_result.error().forward("Render frame failed");
+
+		report.push(*frame_result, context.allocator.get_device_memory_usage());
+	}
+
+	if (const auto result = context.device.waitIdle(); !result) return Error::from(result);
+
+	/* Summarize */
+
+	const auto device_properties = context.phy_device.getProperties();
+
+	auto json = report.to_json();
+	json["device"] = std::string(device_properties.deviceName);
+	json["model"] = argument.model_path;
+	json["resolution"] = {extent.x, extent.y};
+	json["frames"] = frame_count;
+	json["warmup_frames"] = argument.warmup_frames;
+	json["load_seconds"] = load_seconds;
+
+	return json;
+}
+
+int main(int argc, const char* argv[]) noexcept
+{
+	const auto argument_result = bench::Argument::parse(std::span<const char*>(argv, argc));
+	if (!argument_result)
+	{
+		std::println(std::cerr, "{}", argument_result.error()->message);
+		if (argument_result.error()->detail) std::println(std::cerr, "{}", *argument_result.error()->detail);
+		return EXIT_FAILURE;
+	}
+	const auto& argument = *argument_result;
+
+	const auto report_result = run(argument);
+	if (!report_result)
+	{
+		std::println(std::cerr, "Error: {}", report_result.error().root());
+		return EXIT_FAILURE;
+	}
+
+	const auto report = report_result->dump(4);
+
+	if (!argument.output_file)
+	{
+		std::println("{}", report);
+		return EXIT_SUCCESS;
+	}
+
+	if (const auto result = file::write(*argument.output_file, util::as_bytes(report)); !result)
+	{
+		std::println(std::cerr, "Error: {}", result.error().root());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,516 @@
+#include "bench/renderer.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/material.hpp"
+#include "render/model/model.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/model/tlas.hpp"
+#include "render/pipeline/bloom.hpp"
+#include "render/pipeline/hiz.hpp"
+#include "render/pipeline/indirect.hpp"
+#include "render/resource/ambient-occlusion.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "render/resource/indirect.hpp"
+#include "resource/aux-resource.hpp"
+#include "resource/pipeline.hpp"
+#include "resource/render-resource.hpp"
+#include "resource/sync-primitive.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/container/host/cycle.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/glm.hpp"
+#include "vulkan/util/pipeline-statistics-query.hpp"
+#include "vulkan/util/timestamp-query.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint3_sized.hpp>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace bench
+{
+	namespace
+	{
+		// Pipeline statistics slots, the G-Buffer slots are indexed by `render::DrawPhase`
+		constexpr auto STATISTICS_SLOT_NAMES =
+			std::to_array<std::string_view>({"G-Buffer (Early)", "G-Buffer (Late)", "Direct Lighting"});
+		constexpr uint32_t LIGHTING_STATISTICS_SLOT = 2;
+	}
+
+	std::expected<Renderer, Error> Renderer::create(
+		const vulkan::Context& context,
+		render::MaterialLayout material_layout,
+		render::Model model,
+		render::Tlas tlas,
+		glm::u32vec2 extent,
+		float lod_pixel_error,
+		bool half_resolution_shadow,
+		bool compute_lighting
+	) noexcept
+	{
+		auto command_pool_result = context.device.createCommandPool({
+			.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+			.queueFamilyIndex = context.family,
+		});
+		if (!command_pool_result) return Error::from(command_pool_result);
+		auto command_pool = std::move(*command_pool_result);
+
+		auto command_buffers_result = context.device.allocateCommandBuffers({
+			.commandPool = command_pool,
+			.commandBufferCount = FRAME_RESOURCE_COUNT,
+		});
+		if (!command_buffers_result) return Error::from(command_buffers_result);
+		auto command_buffers = std::move(*command_buffers_result);
+
+		auto render_resources_result =
+			std::views::repeat(resource::RenderResource::create, FRAME_RESOURCE_COUNT)
+			| std::views::transform([&context](auto f) { return f(context); })
+			| Error::collect();
+		if (!render_resources_result)
+			return render_resources_result.error().forward("Create render resources failed");
+		auto render_resources = std::move(*render_resources_result);
+
+		// No attachments exist yet, nothing is retired
+		auto deletion_queue = vulkan::DeletionQueue(FRAME_RESOURCE_COUNT);
+		for (auto& render_resource : render_resources)
+		{
+			const auto result = render_resource.resize_attachments(
+				context,
+				deletion_queue,
+				extent,
+				extent,
+				half_resolution_shadow,
+				render::AmbientOcclusionAttachment::Resolution::Quarter
+			);
+			if (!result) return result.error().forward("Create render attachments failed");
+		}
+
+		auto sync_primitives_result =
+			std::views::repeat(resource::FrameSyncPrimitive::create, FRAME_RESOURCE_COUNT)
+			| std::views::transform([&context](auto f) { return f(context); })
+			| Error::collect();
+		if (!sync_primitives_result)
+			return sync_primitives_result.error().forward("Create sync primitives failed");
+		auto sync_primitives = std::move(*sync_primitives_result);
+
+		auto timestamp_queries_result =
+			std::views::repeat(
+				[&context] { return vulkan::TimestampQuery::create(context); },
+				FRAME_RESOURCE_COUNT
+			)
+			| std::views::transform([](const auto& f) { return f(); })
+			| Error::collect();
+		if (!timestamp_queries_result)
+			return timestamp_queries_result.error().forward("Create timestamp queries failed");
+		auto timestamp_queries = std::move(*timestamp_queries_result);
+
+		auto statistics_queries_result =
+			std::views::repeat(
+				[&context] {
+					return vulkan::PipelineStatisticsQuery::create(context, STATISTICS_SLOT_NAMES);
+				},
+				FRAME_RESOURCE_COUNT
+			)
+			| std::views::transform([](const auto& f) { return f(); })
+			| Error::collect();
+		if (!statistics_queries_result)
+			return statistics_queries_result.error().forward("Create pipeline statistics queries failed");
+		auto statistics_queries = std::move(*statistics_queries_result);
+
+		auto pipeline_result = resource::Pipeline::create(
+			context,
+			material_layout,
+			model.mesh_list->vertex_format,
+			TARGET_FORMAT
+		);
+		if (!pipeline_result) return pipeline_result.error().forward("Create pipelines failed");
+		auto pipeline = std::move(*pipeline_result);
+
+		auto resource_sets_result = pipeline.create_resource_sets(context, FRAME_RESOURCE_COUNT);
+		if (!resource_sets_result) return resource_sets_result.error().forward("Create resource sets failed");
+		auto resource_sets = std::move(*resource_sets_result);
+
+		auto frame_resources =
+			std::views::zip_transform(
+				CTOR_LAMBDA(FrameResource),
+				command_buffers | std::views::as_rvalue,
+				render_resources | std::views::as_rvalue,
+				resource_sets | std::views::as_rvalue,
+				sync_primitives | std::views::as_rvalue,
+				timestamp_queries | std::views::as_rvalue,
+				statistics_queries | std::views::as_rvalue
+			)
+			| vulkan::Cycle<FrameResource>::into;
+
+		auto aux_resource_result = resource::AuxResource::create(context);
+		if (!aux_resource_result)
+			return aux_resource_result.error().forward("Create auxiliary resources failed");
+		auto aux_resource = std::move(*aux_resource_result);
+
+		// Smallest volume to bind to the direct lighting, only sampled with global illumination enabled
+		auto gi_probe_volume_result = render::GiProbeVolume::create(
+			context,
+			{.origin = glm::vec3(-0.5f), .spacing = glm::vec3(1.0f), .count = glm::u32vec3(2)},
+			1
+		);
+		if (!gi_probe_volume_result)
+			return gi_probe_volume_result.error().forward("Create probe volume failed");
+		auto gi_probe_volume = std::move(*gi_probe_volume_result);
+
+		// Bound to the direct lighting as well, only sampled with environment lighting enabled
+		auto environment_lighting_result =
+			render::EnvironmentLighting::create_uniform(context, glm::vec3(0.0f));
+		if (!environment_lighting_result)
+			return environment_lighting_result.error().forward("Create environment lighting failed");
+		auto environment_lighting = std::move(*environment_lighting_result);
+
+		auto target_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			TARGET_FORMAT,
+			vk::ImageUsageFlagBits::eTransferSrc
+		);
+		if (!target_result) return target_result.error().forward("Create offscreen target failed");
+		auto target = std::move(*target_result);
+
+		return Renderer(
+			std::move(command_pool),
+			std::move(material_layout),
+			std::move(model),
+			std::move(tlas),
+			std::move(pipeline),
+			std::move(frame_resources),
+			std::move(aux_resource),
+			std::move(gi_probe_volume),
+			std::move(environment_lighting),
+			std::move(target),
+			extent,
+			render::IndirectPipeline::lod_threshold_from_pixels(lod_pixel_error, extent.y),
+			compute_lighting
+		);
+	}
+
+	std::expected<Renderer::FrameResult, Error> Renderer::render_frame(
+		const vulkan::Context& context,
+		const render::Camera& camera,
+		float delta_time
+	) noexcept
+	{
+		const auto start_time = std::chrono::steady_clock::now();
+
+		frame_resources.cycle();
+		auto& frame = frame_resources.current();
+		const auto& prev_frame = frame_resources.prev();
+
+		// Frames are waited for synchronously, all previous frames have completed
+		deletion_queue.advance();
+
+		/* Update & Bind */
+
+		const auto render_data = resource::RenderData{
+			.drawcall_counts = model.scene_graph.drawcall_counts(),
+			.blended_drawcall_counts = model.scene_graph.drawcall_counts(render::SceneGraph::Bucket::Blended),
+			.node_count = model.scene_graph->node_count,
+			.primitive_count = model.mesh_list->primitive_attr_array.size(),
+			.material_count = model.material_list.material_count(),
+			.transform_updates = {},
+			.root_transform = glm::mat4(1.0f),
+			.camera = camera,
+			.primary_light = primary_light.get(),
+			.exposure_param = exposure.get(delta_time, extent),
+		};
+
+		if (const auto result = frame.render_resource.update(context, deletion_queue, render_data); !result)
+			return result.error().forward("Update render resource failed");
+
+		frame.resource_set.update(
+			context,
+			model,
+			tlas,
+			frame.render_resource,
+			prev_frame.render_resource,
+			aux_resource,
+			gi_probe_volume,
+			environment_lighting,
+			pipeline.atmosphere.get_lut_view(),
+			std::nullopt,
+			std::nullopt
+		);
+
+		/* Record & Submit */
+
+		if (const auto result = frame.command_buffer.begin({}); !result) return Error::from(result);
+		record(frame, prev_frame, std::exchange(history_valid, true));
+		if (const auto result = frame.command_buffer.end(); !result) return Error::from(result);
+
+		const auto command_buffer_submit_info = vk::CommandBufferSubmitInfo{
+			.commandBuffer = frame.command_buffer,
+		};
+		const auto submit_info = vk::SubmitInfo2().setCommandBufferInfos(command_buffer_submit_info);
+
+		if (const auto result = context.device.resetFences(*frame.sync_primitive.draw_fence); !result)
+			return Error::from(result);
+
+		{
+			const std::scoped_lock lock(context.submit_mutex);
+			if (const auto result = context.queue.submit2(submit_info, frame.sync_primitive.draw_fence);
+				!result)
+				return Error::from(result);
+		}
+
+		const auto submit_time = std::chrono::steady_clock::now();
+
+		/* Wait & Read back */
+
+		if (const auto wait_result =
+				context.device.waitForFences(*frame.sync_primitive.draw_fence, vk::True, UINT64_MAX);
+			wait_result != vk::Result::eSuccess)
+			return Error::from(wait_result);
+
+		const auto end_time = std::chrono::steady_clock::now();
+
+		auto timestamp_result = frame.timestamp_query.read_results();
+		if (!timestamp_result) return timestamp_result.error().forward("Read timestamp queries failed");
+
+		auto statistics_result = frame.statistics_query.read_results();
+		if (!statistics_result)
+			return statistics_result.error().forward("Read pipeline statistics queries failed");
+
+		const auto culling_result = frame.render_resource.indirect.read_stat();
+		if (!culling_result) return culling_result.error().forward("Read culling statistics failed");
+
+		using Milliseconds = std::chrono::duration<double, std::milli>;
+
+		return FrameResult{
+			.cpu_ms = Milliseconds(submit_time - start_time).count(),
+			.frame_ms = Milliseconds(end_time - start_time).count(),
+			.gpu_results = std::move(*timestamp_result),
+			.culling = *culling_result,
+			.pipeline_statistics = std::move(*statistics_result),
+		};
+	}
+
+	void Renderer::record(FrameResource& frame, const FrameResource& prev_frame, bool history_valid)
+		const noexcept
+	{
+		const auto& command_buffer = frame.command_buffer;
+
+		frame.timestamp_query.begin_frame(command_buffer);
+		frame.statistics_query.begin_frame(command_buffer);
+
+		const auto total_scope = frame.timestamp_query.scope(command_buffer, "Total");
+
+		{
+			const auto scope = frame.timestamp_query.scope(command_buffer, "Upload");
+			frame.render_resource.upload(command_buffer);
+		}
+
+		// Previous HiZ is never built, transition it so that it can still be bound
+		if (!history_valid)
+			render::HizPipeline::discard(command_buffer, prev_frame.render_resource.attachments->hiz);
+
+		{
+			const auto scope = frame.timestamp_query.scope(command_buffer, "Transform");
+			pipeline.transform.compute(command_buffer, frame.resource_set.transform);
+		}
+
+		// Variable rate shading is not benchmarked, the cleared rates shade every pixel at full rate
+		pipeline.shading_rate.clear(command_buffer, frame.resource_set.shading_rate);
+
+		record_phase(frame, render::DrawPhase::Early, history_valid);
+		record_phase(frame, render::DrawPhase::Late, history_valid);
+
+		{
+			const auto scope = frame.timestamp_query.scope(command_buffer, "Light Culling");
+			pipeline.light_cluster.compute(command_buffer, frame.resource_set.light_cluster);
+		}
+
+		{
+			const auto scope = frame.timestamp_query.scope(command_buffer, "Shadow");
+			pipeline.shadow.compute(command_buffer, frame.resource_set.shadow);
+		}
+
+		// Ambient occlusion is not benchmarked, the cleared output keeps the lighting bindings valid
+		pipeline.ambient_occlusion.clear(command_buffer, frame.resource_set.ambient_occlusion);
+
+		{
+			const auto scope = frame.timestamp_query.scope(command_buffer, "Direct Lighting");
+			const auto statistics_scope =
+				frame.statistics_query.scope(command_buffer, LIGHTING_STATISTICS_SLOT);
+			record_lighting(frame);
+		}
+
+		{
+			const auto scope = frame.timestamp_query.scope(command_buffer, "Transparent");
+			for (const auto phase : {render::DrawPhase::Early, render::DrawPhase::Late})
+				pipeline.indirect.compute(
+					command_buffer,
+					frame.resource_set.blended_indirect,
+					phase,
+					history_valid,
+					lod_threshold
+				);
+			pipeline.transparent.render(command_buffer, frame.resource_set.transparent);
+		}
+
+		{
+			const auto scope = frame.timestamp_query.scope(command_buffer, "Auto Exposure");
+			pipeline.auto_exposure.compute(command_buffer, frame.resource_set.auto_exposure);
+		}
+
+		{
+			const auto scope = frame.timestamp_query.scope(command_buffer, "TAA");
+			pipeline.taa.compute(command_buffer, frame.resource_set.taa, history_valid);
+		}
+
+		// Composited without bloom, the chain is only transitioned so that it can still be bound
+		render::BloomPipeline::discard(command_buffer, frame.render_resource.attachments->bloom);
+
+		const auto scope = frame.timestamp_query.scope(command_buffer, "Composite");
+		record_composite(frame);
+	}
+
+	void Renderer::record_phase(FrameResource& frame, render::DrawPhase phase, bool history_valid)
+		const noexcept
+	{
+		const auto& command_buffer = frame.command_buffer;
+		const auto phase_name = phase == render::DrawPhase::Early ? "Early" : "Late";
+
+		{
+			const auto scope =
+				frame.timestamp_query.scope(command_buffer, std::format("Culling ({})", phase_name));
+			pipeline.indirect.compute(
+				command_buffer,
+				frame.resource_set.indirect,
+				phase,
+				history_valid,
+				lod_threshold
+			);
+
+			// Counts of the main camera are final after the late phase
+			if (phase == render::DrawPhase::Late)
+				frame.render_resource.indirect.record_stat_copy(command_buffer);
+		}
+
+		{
+			const auto scope =
+				frame.timestamp_query.scope(command_buffer, std::format("G-Buffer ({})", phase_name));
+			const auto statistics_scope =
+				frame.statistics_query.scope(command_buffer, static_cast<uint32_t>(phase));
+			pipeline.deferred.render(command_buffer, frame.resource_set.deferred, phase);
+		}
+
+		{
+			const auto scope =
+				frame.timestamp_query.scope(command_buffer, std::format("HiZ ({})", phase_name));
+			pipeline.hiz.compute(command_buffer, frame.resource_set.hiz);
+		}
+	}
+
+	void Renderer::record_lighting(FrameResource& frame) const noexcept
+	{
+		const auto& command_buffer = frame.command_buffer;
+		const auto& hdr = frame.render_resource.attachments->hdr;
+
+		if (compute_lighting)
+		{
+			pipeline.direct_lighting.compute(command_buffer, frame.resource_set.direct_lighting);
+			return;
+		}
+
+		const auto rendering_area = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(extent)
+		};
+
+		const auto hdr_attachment_info = vk::RenderingAttachmentInfo{
+			.imageView = hdr->attachment.view,
+			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.loadOp = vk::AttachmentLoadOp::eLoad,
+			.storeOp = vk::AttachmentStoreOp::eStore,
+		};
+
+		const auto rendering_info =
+			vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
+				.setColorAttachments(hdr_attachment_info);
+
+		command_buffer.beginRendering(rendering_info);
+		pipeline.direct_lighting.render(command_buffer, frame.resource_set.direct_lighting);
+		command_buffer.endRendering();
+
+		const auto post_lighting_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+			.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = hdr->attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_lighting_barrier));
+	}
+
+	void Renderer::record_composite(FrameResource& frame) const noexcept
+	{
+		const auto& command_buffer = frame.command_buffer;
+		const auto target_view = vulkan::AttachmentView(target);
+
+		// Previous content of the target is never read
+		const auto pre_composite_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = target_view.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_composite_barrier));
+
+		const auto rendering_area = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(extent)
+		};
+
+		const auto target_attachment = vk::RenderingAttachmentInfo{
+			.imageView = target_view.view,
+			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.loadOp = vk::AttachmentLoadOp::eClear,
+			.storeOp = vk::AttachmentStoreOp::eStore,
+			.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f)
+		};
+
+		const auto rendering_info =
+			vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
+				.setColorAttachments(target_attachment);
+
+		command_buffer.beginRendering(rendering_info);
+		pipeline.composite.render(command_buffer, frame.resource_set.composite);
+		command_buffer.endRendering();
+	}
+}
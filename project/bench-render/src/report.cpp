@@ -0,0 +1,154 @@
+#include "bench/report.hpp"
+#include "bench/renderer.hpp"
+#include "common/json.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "vulkan/alloc/allocator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace bench
+{
+	Report::Statistics Report::Statistics::from(std::span<const double> samples) noexcept
+	{
+		if (samples.empty()) return {.average = 0, .min = 0, .p50 = 0, .p95 = 0, .p99 = 0, .max = 0};
+
+		auto sorted = std::vector(std::from_range, samples);
+		std::ranges::sort(sorted);
+
+		const auto percentile = [&sorted](double p) {
+			const auto index = static_cast<size_t>(std::round(p * static_cast<double>(sorted.size() - 1)));
+			return sorted[index];
+		};
+
+		const auto sum = std::ranges::fold_left(sorted, 0.0, std::plus());
+
+		return {
+			.average = sum / static_cast<double>(sorted.size()),
+			.min = sorted.front(),
+			.p50 = percentile(0.50),
+			.p95 = percentile(0.95),
+			.p99 = percentile(0.99),
+			.max = sorted.back(),
+		};
+	}
+
+	Json Report::Statistics::to_json() const noexcept
+	{
+		return Json{
+			{"average", average},
+			{"min",     min    },
+			{"p50",     p50    },
+			{"p95",     p95    },
+			{"p99",     p99    },
+			{"max",     max    },
+		};
+	}
+
+	void Report::push(
+		const Renderer::FrameResult& frame,
+		const vulkan::Allocator::DeviceMemoryUsage& memory_usage
+	) noexcept
+	{
+		cpu_times.push_back(frame.cpu_ms);
+		frame_times.push_back(frame.frame_ms);
+
+		for (const auto& result : frame.gpu_results)
+		{
+			auto entry =
+				std::ranges::find(pass_times, result.name, [](const auto& pair) { return pair.first; });
+			if (entry == pass_times.end())
+			{
+				pass_times.emplace_back(result.name, std::vector<double>());
+				entry = std::prev(pass_times.end());
+			}
+
+			entry->second.push_back(result.duration_ms);
+		}
+
+		const auto culling_counts = frame.culling.as_array();
+		const auto sum_counts = [&culling_counts](auto member) {
+			return static_cast<double>(std::ranges::fold_left(
+				culling_counts | std::views::transform(member),
+				uint64_t(0),
+				std::plus()
+			));
+		};
+
+		culling_samples.early_draws.push_back(sum_counts(&render::IndirectCount::early_draw_count));
+		culling_samples.late_draws.push_back(sum_counts(&render::IndirectCount::late_draw_count));
+		culling_samples.commands.push_back(
+			sum_counts(&render::IndirectCount::early_command_count)
+			+ sum_counts(&render::IndirectCount::late_command_count)
+		);
+		culling_samples.triangles.push_back(
+			sum_counts(&render::IndirectCount::early_triangle_count)
+			+ sum_counts(&render::IndirectCount::late_triangle_count)
+		);
+
+		for (const auto& result : frame.pipeline_statistics)
+		{
+			auto entry =
+				std::ranges::find(pipeline_samples, result.name, [](const auto& pair) { return pair.first; });
+			if (entry == pipeline_samples.end())
+			{
+				pipeline_samples.emplace_back(result.name, PipelineSamples());
+				entry = std::prev(pipeline_samples.end());
+			}
+
+			auto& samples = entry->second;
+			samples.input_primitives.push_back(static_cast<double>(result.input_primitives));
+			samples.clipping_primitives.push_back(static_cast<double>(result.clipping_primitives));
+			samples.fragment_invocations.push_back(static_cast<double>(result.fragment_invocations));
+			samples.compute_invocations.push_back(static_cast<double>(result.compute_invocations));
+		}
+
+		peak_memory_usage.allocation_bytes =
+			std::max(peak_memory_usage.allocation_bytes, memory_usage.allocation_bytes);
+		peak_memory_usage.usage_bytes = std::max(peak_memory_usage.usage_bytes, memory_usage.usage_bytes);
+		peak_memory_usage.budget_bytes = std::max(peak_memory_usage.budget_bytes, memory_usage.budget_bytes);
+	}
+
+	Json Report::to_json() const noexcept
+	{
+		auto gpu_pass_json = Json::object();
+		for (const auto& [name, samples] : pass_times)
+			gpu_pass_json[name] = Statistics::from(samples).to_json();
+
+		auto pipeline_statistics_json = Json::object();
+		for (const auto& [name, samples] : pipeline_samples)
+			pipeline_statistics_json[name] = Json{
+				{"input_primitives", Statistics::from(samples.input_primitives).to_json()},
+				{"clipping_primitives", Statistics::from(samples.clipping_primitives).to_json()},
+				{"fragment_invocations", Statistics::from(samples.fragment_invocations).to_json()},
+				{"compute_invocations", Statistics::from(samples.compute_invocations).to_json()},
+			};
+
+		return Json{
+			{"cpu_frame_ms", Statistics::from(cpu_times).to_json()},
+			{"frame_ms", Statistics::from(frame_times).to_json()},
+			{"gpu_pass_ms", gpu_pass_json},
+			{"culling",
+			 Json{
+				 {"early_draws", Statistics::from(culling_samples.early_draws).to_json()},
+				 {"late_draws", Statistics::from(culling_samples.late_draws).to_json()},
+				 {"commands", Statistics::from(culling_samples.commands).to_json()},
+				 {"triangles", Statistics::from(culling_samples.triangles).to_json()},
+			 }},
+			{"pipeline_statistics", pipeline_statistics_json},
+			{"vram",
+			 Json{
+				 {"peak_allocation_bytes", peak_memory_usage.allocation_bytes},
+				 {"peak_usage_bytes", peak_memory_usage.usage_bytes},
+				 {"budget_bytes", peak_memory_usage.budget_bytes},
+			 }},
+		};
+	}
+}
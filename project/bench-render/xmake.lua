@@ -0,0 +1,34 @@
+-- Headless benchmark, replays a camera path over a model and reports frame timings
+
+-- Scripted camera paths, shared with the other offline renderers
+target("bench.render.common")
+	set_kind("static")
+	set_default(false)
+
+	add_deps("lib.common", "lib.scene", "render", {public = true})
+
+	add_files("src/camera-path.cpp")
+	add_includedirs("include", {public = true})
+	add_headerfiles("include/bench/camera-path.hpp")
+
+target("bench.render")
+	set_kind("binary")
+	set_default(false)
+
+	add_deps(
+		"lib.common",
+		"lib.scene",
+		"vulkan.util",
+		"vulkan.alloc",
+		"vulkan.context",
+		"model.gltf",
+		"render",
+		"main.common",
+		"bench.render.common"
+	)
+
+	add_files("src/**.cpp|camera-path.cpp")
+	add_includedirs("include")
+	add_headerfiles("include/**.hpp")
+
+	add_packages("argparse")
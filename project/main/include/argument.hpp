@@ -1,8 +1,13 @@
 #pragma once
 
+#include "common/util/cpu.hpp"
 #include "common/util/error.hpp"
+#include "resource/pipeline.hpp"
+#include "vulkan/context/capability.hpp"
 
+#include <cstdint>
 #include <expected>
+#include <optional>
 #include <span>
 #include <string>
 
@@ -10,6 +15,66 @@ struct Argument
 {
 	std::string model_path;
 
+	// Load low-resolution textures up front and stream full-resolution textures while rendering
+	bool stream_textures = false;
+
+	// Load coarse geometry up front and stream full-detail geometry from the model cache while rendering
+	bool stream_geometry = false;
+
+	// Merge small static meshes into larger pre-transformed primitives, see `model::merge_static_geometry`
+	bool merge_static = false;
+
+	// Replace distant clusters of static nodes by simplified proxies, see `model::build_hlod`
+	bool hlod = false;
+
+	// Bake octahedral impostors of instanced meshes, drawn in their place when far away, see
+	// `model::bake_impostors`
+	bool impostor = false;
+
+	// Play the animations of the model, posing its skinned and morphed meshes on GPU. Bypasses the model
+	// cache, as baked models drop the deformation data
+	bool animate = false;
+
+	// Build BLASes for fast build to start rendering sooner, then rebuild them for fast trace while rendering
+	bool fast_build_blas = false;
+
+	// Record the loading stages and write them to this path as a Chrome trace, see `util::trace`
+	std::optional<std::string> load_trace_path = std::nullopt;
+
+	// Light the ambient by this equirectangular HDR map (`.hdr`), see `render::EnvironmentLighting`
+	std::optional<std::string> environment_path = std::nullopt;
+
+	// Technique filling the G-buffer, `Meshlet` requires mesh shaders on the device
+	resource::Pipeline::GBufferPath gbuffer_path = resource::Pipeline::GBufferPath::Raster;
+
+	// Override the device tier picking the performance preset, see `logic::Preset`
+	std::optional<vulkan::DeviceCapability::Tier> tier = std::nullopt;
+
+	// Stream the composited frames into the stdin of this encoder command, see `resource::FrameCapture`
+	std::optional<std::string> capture_command = std::nullopt;
+
+	// Record the inputs of every frame into this file, see `logic::InputCapture`
+	std::optional<std::string> capture_input_path = std::nullopt;
+
+	// Replay the inputs recorded in this file instead of the live input, see `logic::InputReplay`
+	std::optional<std::string> replay_input_path = std::nullopt;
+
+	/* Threads, overriding the preset, see `util::cpu::PoolConfig` */
+
+	std::optional<uint32_t> worker_threads = std::nullopt;
+	std::optional<util::cpu::Affinity> thread_affinity = std::nullopt;
+	std::optional<bool> reserve_render_core = std::nullopt;
+
+	///
+	/// @brief Get the config of the thread pools, the given options overriding @p fallback
+	/// @note Pools created before the device is probed fall back to the default config
+	///
+	/// @param fallback Config of the preset
+	/// @return Config of the thread pools
+	///
+	[[nodiscard]]
+	util::cpu::PoolConfig get_pool_config(const util::cpu::PoolConfig& fallback = {}) const noexcept;
+
 	///
 	/// @brief Parse the argument
 	///
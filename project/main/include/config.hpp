@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <string_view>
 
 namespace config
 {
@@ -8,4 +10,96 @@ namespace config
 	/// @brief In-flight frames
 	///
 	static constexpr uint32_t INFLIGHT_FRAMES = 3;
+
+	///
+	/// @brief Initial capacity of the per-frame arena for host-side scratch data, grows to the peak usage
+	///
+	static constexpr size_t FRAME_ARENA_SIZE = 256 * 1024;
+
+	///
+	/// @brief Directory to persist the pipeline cache, relative to the working directory
+	///
+	static constexpr std::string_view PIPELINE_CACHE_DIRECTORY = ".cache";
+
+	///
+	/// @brief Maximum projected error of the selected level of detail, in pixels
+	///
+	static constexpr float LOD_PIXEL_ERROR = 1.0f;
+
+	///
+	/// @brief Projected size of an HLOD cluster below which its proxy is drawn, in pixels
+	///
+	static constexpr float HLOD_PIXEL_SIZE = 64.0f;
+
+	///
+	/// @brief Projected size of a mesh below which its impostor is drawn, in pixels
+	///
+	static constexpr float IMPOSTOR_PIXEL_SIZE = 96.0f;
+
+	///
+	/// @brief Larger dimension limit of textures loaded up front when streaming textures
+	///
+	static constexpr uint32_t STREAMING_BASE_TEXTURE_SIZE = 64;
+
+	///
+	/// @brief Size of the pool for full-detail geometry when streaming geometry, in bytes
+	///
+	static constexpr size_t GEOMETRY_POOL_SIZE = 512 * 1048576;
+
+	///
+	/// @brief Count of global illumination probes along the longest axis of the scene bounds
+	///
+	static constexpr uint32_t GI_PROBE_MAX_COUNT = 16;
+
+	///
+	/// @brief Upper limit of the global illumination ray budget, sizes the probe ray buffer
+	///
+	static constexpr uint32_t GI_PROBE_RAY_CAPACITY = 524288;
+
+	///
+	/// @brief Radius around the camera of the instances traced by local ray traced effects, e.g. ambient
+	/// occlusion, in world units. See `render::Tlas::cull()`
+	///
+	static constexpr float RT_NEAR_INSTANCE_RADIUS = 500.0f;
+
+	///
+	/// @brief Frames of ambient occlusion accumulated while the view and the scene are static, after which
+	/// its last result is reused instead of tracing further rays
+	///
+	static constexpr uint32_t STATIC_VIEW_AMBIENT_OCCLUSION_FRAMES = 64;
+
+	///
+	/// @brief Updates of each global illumination probe while the view and the scene are static, after
+	/// which the probes stop updating. See `render::GiProbePipeline::get_frame_count`
+	///
+	static constexpr uint32_t STATIC_VIEW_GI_PASSES = 16;
+
+	///
+	/// @brief Perform direct lighting with a tiled compute dispatch instead of a fullscreen draw
+	///
+	static constexpr bool COMPUTE_LIGHTING = true;
+
+	///
+	/// @brief Pull vertices from the vertex buffer in the deferred pass, instead of fixed-function input
+	///
+	static constexpr bool DEFERRED_VERTEX_PULLING = false;
+
+	///
+	/// @brief Pixels per thread along each axis of the auto-exposure histogram, if the device supports
+	/// subgroup operations
+	///
+	static constexpr uint32_t AUTO_EXPOSURE_HISTOGRAM_DOWNSCALE = 2;
+
+	///
+	/// @brief Unused bytes in the device-local memory blocks that start a defragmentation in idle frames,
+	/// both as a fraction of the block bytes and in absolute bytes
+	///
+	static constexpr double DEFRAGMENT_UNUSED_RATIO = 0.25;
+	static constexpr size_t DEFRAGMENT_MIN_UNUSED_SIZE = 64 * 1048576;
+
+	///
+	/// @brief Readback buffers of the frame capture beyond the in-flight frames, frames queue up in them
+	/// while the encoder falls behind
+	///
+	static constexpr uint32_t CAPTURE_QUEUE_FRAMES = 3;
 }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common/util/trace.hpp"
+
+#include <chrono>
+#include <optional>
+
+namespace helper
+{
+	///
+	/// @brief Timed bring-up step, prints its duration and its end time since the process started
+	/// @details Also recorded as a trace event while a load trace is recorded. Steps may overlap on
+	/// different threads.
+	///
+	class StartupStep
+	{
+	  public:
+
+		///
+		/// @brief Begin a bring-up step
+		///
+		/// @param name Name of the step, must be a string literal
+		///
+		explicit StartupStep(const char* name) noexcept;
+
+		///
+		/// @brief End the step before its destruction, later calls have no effect
+		///
+		void end() noexcept;
+
+		~StartupStep() noexcept;
+
+	  private:
+
+		const char* name;
+		std::chrono::steady_clock::time_point start_time;
+		std::optional<util::trace::Scope> trace_scope;  // Empty once ended
+
+	  public:
+
+		StartupStep(const StartupStep&) = delete;
+		StartupStep(StartupStep&&) = delete;
+		StartupStep& operator=(const StartupStep&) = delete;
+		StartupStep& operator=(StartupStep&&) = delete;
+	};
+
+	///
+	/// @brief Print the time since the process started, only the first call prints
+	/// @note Call after the first frame is presented
+	///
+	void mark_first_frame() noexcept;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "common/util/cpu.hpp"
+
+#include <coro/thread_pool.hpp>
+#include <memory>
+
+namespace helper
+{
+	///
+	/// @brief Create a thread pool sized and pinned by `util::cpu::plan_pool`
+	/// @details Pinning failures are printed and leave the worker unpinned
+	///
+	/// @param config Config of the pool
+	/// @return Created thread pool
+	///
+	[[nodiscard]]
+	std::unique_ptr<coro::thread_pool> create_thread_pool(const util::cpu::PoolConfig& config) noexcept;
+
+	///
+	/// @brief Pin the calling thread to the render core of @p config, see `util::cpu::PoolLayout`
+	/// @details Does nothing if @p config reserves no render core. Call on the render/submit thread, with
+	/// the same config as the pools created after.
+	///
+	/// @param config Config of the pools
+	///
+	void pin_render_thread(const util::cpu::PoolConfig& config) noexcept;
+}
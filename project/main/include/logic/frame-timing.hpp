@@ -0,0 +1,136 @@
+#pragma once
+
+#include "vulkan/util/timestamp-query.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace logic
+{
+	///
+	/// @brief Frame timing recorder (Logic Layer), keeps ring buffers of per-frame timings, and logs the
+	/// frames exceeding a threshold as hitches
+	/// @details Each frame pushes its fence wait, the GPU results of the waited frame and finally its CPU
+	/// time, in this order. GPU timings lag behind the CPU timings by the frames in flight.
+	///
+	class FrameTiming
+	{
+	  public:
+
+		using Clock = std::chrono::steady_clock;
+
+		// Number of frames kept in the ring buffers
+		static constexpr size_t HISTORY_SIZE = 600;
+
+		// Number of hitches kept in the log, oldest are dropped first
+		static constexpr size_t HITCH_LOG_SIZE = 64;
+
+		enum class Metric : uint8_t
+		{
+			Cpu,              // CPU time from the start of the frame to its present
+			Gpu,              // GPU time of the "Total" timestamp scope
+			FenceWait,        // CPU time waiting for the frame in flight to complete
+			PresentInterval,  // CPU time between the presents of consecutive frames
+		};
+
+		static constexpr size_t METRIC_COUNT = 4;
+
+		struct Statistics
+		{
+			double p50, p95, p99, max;  // In milliseconds
+		};
+
+		///
+		/// @brief Push the fence wait time of the current frame
+		///
+		/// @param duration_ms Time waited for the fences of the frame in flight, in milliseconds
+		///
+		void push_fence_wait(double duration_ms) noexcept;
+
+		///
+		/// @brief Push the timestamp query results of the waited frame
+		///
+		/// @param results Timestamp query results, the "Total" scope is the GPU time
+		///
+		void push_gpu(std::span<const vulkan::TimestampQuery::Result> results) noexcept;
+
+		///
+		/// @brief End the current frame, recording it into the history and checking for a hitch
+		///
+		/// @param cpu_ms CPU time of the frame, in milliseconds
+		/// @param present_time Time at which the frame was presented
+		///
+		void end_frame(double cpu_ms, Clock::time_point present_time) noexcept;
+
+		///
+		/// @brief Drop the present interval of the next frame, called when frames are skipped while idling
+		///
+		void skip_interval() noexcept;
+
+		///
+		/// @brief Get the statistics of a metric over the history, computed once per frame in `end_frame`
+		///
+		/// @param metric Metric to get
+		/// @return Statistics, all zeros if nothing is recorded
+		///
+		[[nodiscard]]
+		Statistics get_statistics(Metric metric) const noexcept;
+
+		///
+		/// @brief Frame timing window, shows the statistics, a frame-time graph and the hitch log
+		///
+		void ui() noexcept;
+
+	  private:
+
+		struct PassSpike
+		{
+			std::string name;
+			double duration_ms;
+			double average_ms;
+		};
+
+		struct PassAverage
+		{
+			std::string name;
+			double average_ms;  // Exponential moving average
+		};
+
+		struct Hitch
+		{
+			uint64_t frame;
+			std::array<float, METRIC_COUNT> sample;  // Indexed by `Metric`
+			std::optional<PassSpike> spike;          // GPU pass of the waited frame most above its average
+		};
+
+		std::array<std::array<float, HISTORY_SIZE>, METRIC_COUNT> history = {};  // In milliseconds
+		size_t history_head = 0;   // Next slot to write
+		size_t history_count = 0;  // Valid samples, up to `HISTORY_SIZE`
+
+		// Statistics of the history, indexed by `Metric`
+		std::array<Statistics, METRIC_COUNT> statistics = {};
+
+		// Reusable buffer partially reordered by the percentile selection, avoids per-frame allocations
+		std::array<float, HISTORY_SIZE> selection = {};
+
+		void update_statistics() noexcept;
+
+		// Partial sample of the current frame, committed in `end_frame`
+		std::array<float, METRIC_COUNT> current = {};
+		std::optional<PassSpike> current_spike = std::nullopt;
+
+		std::vector<PassAverage> pass_averages;
+		std::optional<Clock::time_point> last_present_time = std::nullopt;
+		uint64_t frame_count = 0;
+
+		float hitch_threshold_ms = 33.3f;
+		std::deque<Hitch> hitches;  // Newest at back
+	};
+}
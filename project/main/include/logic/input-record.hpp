@@ -0,0 +1,231 @@
+#pragma once
+
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "logic/param.hpp"
+#include "scene/camera.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace logic
+{
+	///
+	/// @brief Inputs of a rendered frame, see `InputCapture`
+	///
+	struct InputFrame
+	{
+		float delta_time;                // Time since the previous frame, in seconds
+		glm::u32vec2 extent;             // Swapchain extent
+		float render_scale;              // Render scale of the frame, see `Resolution::scale`
+		scene::camera::CenterView view;  // View of the frame camera, after smoothing and late latch
+
+		// Recorded parameters (see `get_recorded_param`), only present if changed since the previous frame
+		std::optional<Json> param = std::nullopt;
+
+		[[nodiscard]]
+		Json to_json() const noexcept;
+
+		///
+		/// @brief Parse the inputs of a frame
+		///
+		/// @param json Input JSON, see `to_json`
+		/// @return Parsed inputs or error
+		///
+		[[nodiscard]]
+		static std::expected<InputFrame, Error> from_json(const Json& json) noexcept;
+	};
+
+	///
+	/// @brief Get the parameters changing the rendered frames, i.e. everything adjustable in the UI except
+	/// the frame pacing (`Latency`, `Idle` and `Overlay`)
+	///
+	/// @param param Parameters
+	/// @return Recorded parameters, as a flat JSON object
+	///
+	[[nodiscard]]
+	Json get_recorded_param(const Param& param) noexcept;
+
+	///
+	/// @brief Apply recorded parameters, see `get_recorded_param`
+	/// @note Missing or mistyped entries are skipped, so that records stay readable when parameters are
+	/// added or removed
+	///
+	/// @param json Recorded parameters
+	/// @param param Parameters to apply to
+	///
+	void apply_recorded_param(const Json& json, Param& param) noexcept;
+
+	///
+	/// @brief Input capture (Logic Layer), records the inputs of every rendered frame into a compact file
+	/// @details
+	/// - The results of the inputs are recorded instead of the raw SDL events, i.e. the delta time, the
+	/// camera view and the parameters changed through the UI. Replays are thus independent of the window
+	/// focus, the UI layout and the timing of the events within a frame.
+	/// - The dynamic render scale is recorded per frame, as it follows the measured GPU time
+	/// - The file holds a header, then a length-prefixed MessagePack record for each frame. Parameters are
+	/// only recorded in the frames changing them.
+	///
+	class InputCapture
+	{
+	  public:
+
+		///
+		/// @brief Create a capture, writing the header of the file
+		///
+		/// @param path Path of the file, overwritten if existing
+		/// @return Created capture or error
+		///
+		[[nodiscard]]
+		static std::expected<InputCapture, Error> create(const std::filesystem::path& path) noexcept;
+
+		///
+		/// @brief Record the inputs of a rendered frame
+		///
+		/// @param param Parameters after the frame has been submitted
+		/// @param delta_time Delta time the frame was prepared with
+		/// @param extent Swapchain extent of the frame
+		/// @param render_scale Render scale the attachments of the frame were sized by
+		/// @return Void, or error if writing failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> push(
+			const Param& param,
+			float delta_time,
+			glm::u32vec2 extent,
+			float render_scale
+		) noexcept;
+
+		///
+		/// @brief Flush the records written so far into the file, e.g. before quitting
+		///
+		/// @return Void, or error if writing failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> flush() noexcept;
+
+		///
+		/// @brief Get the number of frames recorded
+		///
+		[[nodiscard]]
+		uint64_t get_frame_count() const noexcept { return frame_count; }
+
+	  private:
+
+		std::ofstream stream;
+		std::optional<Json> last_param = std::nullopt;
+		uint64_t frame_count = 0;
+
+		explicit InputCapture(std::ofstream stream) :
+			stream(std::move(stream))
+		{}
+
+	  public:
+
+		InputCapture(const InputCapture&) = delete;
+		InputCapture(InputCapture&&) = default;
+		InputCapture& operator=(const InputCapture&) = delete;
+		InputCapture& operator=(InputCapture&&) = default;
+	};
+
+	///
+	/// @brief Input replay (Logic Layer), feeds the frames of an `InputCapture` file back in order
+	/// @details Replayed frames take the recorded delta time, view, render scale and parameters in place of
+	/// the clock, the UI and the dynamic resolution. Late latching and idling are turned off, as both depend
+	/// on the live input and timing.
+	/// @note The window should have the extent of the capture, a mismatch is reported by `extent_matches`
+	///
+	class InputReplay
+	{
+	  public:
+
+		///
+		/// @brief Load a capture file
+		///
+		/// @param path Path of the file
+		/// @return Loaded replay or error
+		///
+		[[nodiscard]]
+		static std::expected<InputReplay, Error> load(const std::filesystem::path& path) noexcept;
+
+		///
+		/// @brief Parse the frames of a capture file
+		///
+		/// @param data Content of the file
+		/// @return Parsed frames or error
+		///
+		[[nodiscard]]
+		static std::expected<std::vector<InputFrame>, Error> parse(std::span<const std::byte> data) noexcept;
+
+		///
+		/// @brief Whether all frames have been replayed
+		///
+		[[nodiscard]]
+		bool finished() const noexcept { return current_frame >= frames.size(); }
+
+		///
+		/// @brief Get the inputs of the current frame
+		/// @warning The replay must not be finished
+		///
+		[[nodiscard]]
+		const InputFrame& current() const noexcept;
+
+		///
+		/// @brief Apply the parameters and the render scale of the current frame
+		/// @details Parameters of earlier frames are applied by earlier calls, call once per attempted frame
+		/// @warning The replay must not be finished
+		///
+		/// @param param Parameters to apply to
+		///
+		void apply(Param& param) const noexcept;
+
+		///
+		/// @brief Advance to the next frame, once the current frame has been rendered
+		///
+		void advance() noexcept { current_frame++; }
+
+		///
+		/// @brief Whether the swapchain extent matches the current frame
+		///
+		[[nodiscard]]
+		bool extent_matches(glm::u32vec2 extent) const noexcept;
+
+		///
+		/// @brief Get the progress of the replay
+		///
+		/// @return Index of the current frame and total number of frames
+		///
+		[[nodiscard]]
+		std::pair<size_t, size_t> get_progress() const noexcept { return {current_frame, frames.size()}; }
+
+		///
+		/// @brief Get all frames of the replay
+		///
+		[[nodiscard]]
+		std::span<const InputFrame> get_frames() const noexcept { return frames; }
+
+	  private:
+
+		std::vector<InputFrame> frames;
+		size_t current_frame = 0;
+
+		explicit InputReplay(std::vector<InputFrame> frames) :
+			frames(std::move(frames))
+		{}
+
+	  public:
+
+		InputReplay(const InputReplay&) = delete;
+		InputReplay(InputReplay&&) = default;
+		InputReplay& operator=(const InputReplay&) = delete;
+		InputReplay& operator=(InputReplay&&) = default;
+	};
+}
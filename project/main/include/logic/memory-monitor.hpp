@@ -0,0 +1,30 @@
+#pragma once
+
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/category.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace logic
+{
+	///
+	/// @brief GPU memory monitor (Logic Layer), displays per-heap budgets and per-category allocations in
+	/// an ImGui panel
+	///
+	class MemoryMonitor
+	{
+	  public:
+
+		///
+		/// @brief Memory monitor window, queries the allocator on every call
+		///
+		/// @param allocator Allocator to query
+		///
+		void ui(const vulkan::Allocator& allocator) noexcept;
+
+	  private:
+
+		std::array<size_t, vulkan::MEMORY_CATEGORY_COUNT> peak_bytes = {};
+	};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "logic/preset.hpp"
+#include "render/model/model.hpp"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace logic
+{
+	///
+	/// @brief Get the model loading option of the renderer
+	/// @note Shared with the bake tool, which must produce the same `render::ModelCache::Key`
+	///
+	/// @param preset Performance preset, with texture strategies fitted to the device
+	/// @param stream_textures Whether textures are streamed, only low-resolution textures are loaded
+	/// @param fast_build_blas Whether BLASes are built for fast build first, see `render::Model::Option`
+	/// @param animate Whether the deformable meshes are posed on GPU, see `render::DeformPipeline`
+	/// @return Model loading option
+	///
+	[[nodiscard]]
+	render::Model::Option get_model_option(
+		const Preset& preset,
+		bool stream_textures,
+		bool fast_build_blas,
+		bool animate
+	) noexcept;
+
+	///
+	/// @brief Get the path of the model cache of a source model, see `render::ModelCache`
+	///
+	/// @param source_hash Hash of the source model, see `render::ModelCache::hash_file`
+	/// @param merge_static Whether static geometry of the model is merged, see `model::merge_static_geometry`
+	/// @param hlod Whether HLOD proxies are built for the model, see `model::build_hlod`
+	/// @param impostor Whether impostors are baked for the model, see `model::bake_impostors`
+	/// @return Path of the cache file
+	///
+	[[nodiscard]]
+	std::filesystem::path get_model_cache_path(
+		uint64_t source_hash,
+		bool merge_static,
+		bool hlod,
+		bool impostor
+	) noexcept;
+}
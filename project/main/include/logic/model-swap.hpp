@@ -0,0 +1,55 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <array>
+#include <optional>
+#include <string>
+
+namespace logic
+{
+	///
+	/// @brief Model swap panel (Logic Layer), requests another model to be loaded while rendering
+	/// @note Only holds the panel state, the render page loads the model and swaps it in
+	///
+	class ModelSwap
+	{
+	  public:
+
+		///
+		/// @brief Create a model swap panel
+		///
+		/// @param model_path Path of the model initially rendered
+		///
+		explicit ModelSwap(std::string model_path) noexcept;
+
+		///
+		/// @brief Model swap window
+		///
+		/// @param loading Whether a model is being loaded, disables further requests
+		/// @return Path of the model requested to load, `std::nullopt` if none is requested
+		///
+		[[nodiscard]]
+		std::optional<std::string> ui(bool loading) noexcept;
+
+		///
+		/// @brief Record a requested model as swapped in
+		///
+		/// @param model_path Path of the model now rendered
+		///
+		void loaded(std::string model_path) noexcept;
+
+		///
+		/// @brief Record a failed request, shown until the next request
+		///
+		/// @param error Error of the loading
+		///
+		void failed(const Error& error) noexcept;
+
+	  private:
+
+		std::string current_path;
+		std::array<char, 1024> path_input = {};
+		std::optional<std::string> last_error = std::nullopt;
+	};
+}
@@ -1,8 +1,23 @@
 #pragma once
 
+#include "param/ambient-occlusion.hpp"
+#include "param/animation.hpp"
 #include "param/auto-exposure.hpp"
+#include "param/bloom.hpp"
 #include "param/camera.hpp"
+#include "param/contact-shadow.hpp"
+#include "param/geometry.hpp"
+#include "param/global-illumination.hpp"
+#include "param/idle.hpp"
+#include "param/latency.hpp"
+#include "param/overlay.hpp"
+#include "param/path-trace.hpp"
 #include "param/primary-light.hpp"
+#include "param/reflection.hpp"
+#include "param/resolution.hpp"
+#include "param/restir.hpp"
+#include "param/shadow-map.hpp"
+#include "param/variable-rate-shading.hpp"
 
 #include <glm/ext/vector_uint2_sized.hpp>
 
@@ -16,6 +31,21 @@ namespace logic
 		Camera camera;
 		PrimaryLight primary_light;
 		Exposure exposure;
+		Bloom bloom;
+		Resolution resolution;
+		Latency latency;
+		Geometry geometry;
+		Animation animation;
+		ContactShadow contact_shadow;
+		ShadowMap shadow_map;
+		AmbientOcclusion ambient_occlusion;
+		GlobalIllumination global_illumination;
+		Restir restir;
+		Reflection reflection;
+		VariableRateShading variable_rate_shading;
+		PathTrace path_trace;
+		Idle idle;
+		Overlay overlay;
 
 		///
 		/// @brief UI configuration window
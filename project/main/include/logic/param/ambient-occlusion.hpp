@@ -0,0 +1,33 @@
+#pragma once
+
+#include "render/pipeline/ambient-occlusion.hpp"
+
+#include <cstdint>
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Ambient occlusion parameters
+	///
+	struct AmbientOcclusion
+	{
+		bool enabled = true;
+		float ray_budget_mrays = 2.0f;  // Rays per frame, in millions
+		int max_rays_per_pixel = 4;
+		float radius = 1.0f;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get ambient occlusion options
+		///
+		/// @return Ambient occlusion options, or `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<render::AmbientOcclusionPipeline::Option> get() const noexcept;
+	};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Animation playback parameters, only effective for models loaded with their animations, see
+	/// `Argument::animate`
+	///
+	struct Animation
+	{
+		bool playing = true;
+		int animation_index = 0;
+		float speed = 1.0f;
+
+		///
+		/// @brief Playback of a frame
+		///
+		struct Playback
+		{
+			uint32_t animation_index;  // Index into `render::Model::animations`
+			float speed;               // Animation time advanced per second
+		};
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get the playback of the frame
+		///
+		/// @param animation_count Number of animations of the model
+		/// @return Playback with the index clamped to the animations, or `std::nullopt` if paused or the
+		/// model has no animation
+		///
+		[[nodiscard]]
+		std::optional<Playback> get(size_t animation_count) const noexcept;
+	};
+}
@@ -24,7 +24,7 @@ namespace logic
 		/// @brief Get exposure parameters
 		///
 		/// @param dt Delta-time since last frame
-		/// @param extent Swapchain extent
+		/// @param extent Render extent
 		/// @return Exposure parameters
 		///
 		[[nodiscard]]
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Bloom parameters
+	///
+	struct Bloom
+	{
+		bool enabled = true;
+		float intensity = 0.04f;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get bloom intensity
+		///
+		/// @return Blend factor of the bloom chain, see `render::CompositePipeline::render`, or
+		/// `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<float> get() const noexcept;
+	};
+}
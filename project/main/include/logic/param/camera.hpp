@@ -3,7 +3,9 @@
 #include "render/interface/camera.hpp"
 #include "scene/camera.hpp"
 
+#include <cstdint>
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float2.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <optional>
@@ -34,19 +36,38 @@ namespace logic
 
 		std::optional<glm::mat4> prev_view_proj_matrix = std::nullopt;
 		std::optional<glm::vec3> prev_camera_pos = std::nullopt;
+		uint32_t frame_index = 0;  // Selects the jitter of the frame
 
 		std::optional<scene::camera::CenterView> curr_view = std::nullopt;
 		double smooth_factor = 10;
 
+		bool late_latch_enabled = true;  // Apply mouse motion arriving until submit to the frame camera
+
+		// Inputs of the last smoothing step and camera, recomputed by `late_latch`
+		std::optional<scene::camera::CenterView> smooth_origin = std::nullopt;
+		double smooth_weight = 1.0;
+		std::optional<render::Camera> last_camera = std::nullopt;
+
+		// Mouse motion applied by `late_latch`, since included in the ImGui mouse delta of the next frame
+		glm::vec2 latched_mouse_delta = {0.0f, 0.0f};
+
 		/*===== Functions =====*/
 
 		///
-		/// @brief Update the parameters based in mouse/keyboard input
+		/// @brief Update the target view based in mouse/keyboard input
+		/// @note Only called in frames running the UI, see `Overlay`
 		///
 		/// @param extent Swapchain extent
 		///
 		void update_view(glm::u32vec2 extent) noexcept;
 
+		///
+		/// @brief Move the current view towards the target view, called every frame
+		///
+		/// @param delta_time Time since the last frame, in seconds
+		///
+		void update_smoothing(double delta_time) noexcept;
+
 		///
 		/// @brief Configuration UI
 		///
@@ -56,9 +77,33 @@ namespace logic
 		/// @brief Get camera parameters and update internal state
 		///
 		/// @param extent Swapchain extent
+		/// @param render_extent Render extent, selects the scale of the jitter
+		/// @param jitter Whether to jitter the projection for TAA
 		/// @return Camera parameters
 		///
 		[[nodiscard]]
-		render::Camera get_and_update(glm::u32vec2 extent) noexcept;
+		render::Camera get_and_update(glm::u32vec2 extent, glm::u32vec2 render_extent, bool jitter) noexcept;
+
+		///
+		/// @brief Mouse motion arriving after the UI of the frame
+		///
+		struct MouseMotion
+		{
+			glm::vec2 delta;  // In pixels
+			bool rotate;      // Right button held
+			bool pan;         // Left button held
+		};
+
+		///
+		/// @brief Apply late mouse motion and recompute the camera of the last `get_and_update`
+		/// @details The motion is applied to the target view as if it arrived before the smoothing step of
+		/// the frame, the jitter and the previous matrices of the frame are kept
+		///
+		/// @param extent Swapchain extent, same as the last `get_and_update`
+		/// @param motion Mouse motion, also a part of the ImGui mouse delta of the next frame
+		/// @return Camera parameters replacing the last returned ones, or `std::nullopt` if unchanged
+		///
+		[[nodiscard]]
+		std::optional<render::Camera> late_latch(glm::u32vec2 extent, const MouseMotion& motion) noexcept;
 	};
 }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "render/pipeline/contact-shadow.hpp"
+
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Contact shadow parameters
+	///
+	struct ContactShadow
+	{
+		bool enabled = true;
+		int step_count = 12;
+		float max_distance = 0.25f;
+		float thickness = 0.02f;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get contact shadow options
+		///
+		/// @return Contact shadow options, or `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<render::ContactShadowPipeline::Option> get() const noexcept;
+	};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "render/pipeline/deferred.hpp"
+
+namespace logic
+{
+	///
+	/// @brief Geometry pass parameters
+	///
+	struct Geometry
+	{
+		// Render states drawn with a depth prepass, switchable at runtime for profiling
+		render::DeferredPipeline::DepthPrepass depth_prepass = render::DeferredPipeline::DepthPrepass::None;
+
+		// Order the draws front to back by coarse depth buckets before the geometry pass
+		bool depth_sort = false;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+	};
+}
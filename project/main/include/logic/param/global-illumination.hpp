@@ -0,0 +1,45 @@
+#pragma once
+
+#include "render/pipeline/gi-probe.hpp"
+
+#include <cstdint>
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Probe-based diffuse global illumination parameters
+	///
+	struct GlobalIllumination
+	{
+		bool enabled = false;
+		float ray_budget_mrays = 0.125f;  // Probe rays per frame, in millions
+		int rays_per_probe = 128;
+		float hysteresis = 0.9f;
+
+		// Converge the probes once for a static scene, then stop updating them
+		bool bake = false;
+		int bake_passes = 32;  // Updates of each probe in a bake
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get probe update options
+		///
+		/// @return Probe update options, or `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<render::GiProbePipeline::Option> get() const noexcept;
+
+		///
+		/// @brief Get the pass count of a static bake
+		///
+		/// @return Updates of each probe in the bake, or `std::nullopt` if not baking
+		///
+		[[nodiscard]]
+		std::optional<uint32_t> get_bake_pass_count() const noexcept;
+	};
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "logic/param/auto-exposure.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Idle parameters, skips rendering while nothing on screen changes
+	/// @details Rendering stops once no event arrived for a settle time, which covers the auto-exposure
+	/// adaptation and the camera smoothing. The event loop then blocks until the next event or the wake
+	/// interval. Render pages additionally keep rendering while progressive work is pending.
+	///
+	struct Idle
+	{
+		using Clock = std::chrono::steady_clock;
+
+		/*===== Parameters =====*/
+
+		bool enabled = true;
+		float min_settle_seconds = 1.0f;  // Lower bound of the settle time, TAA and UI need a few frames
+		int32_t wake_interval_ms = 100;   // Longest block waiting for events, re-checks the idle state
+
+		/*===== States =====*/
+
+		std::optional<Clock::time_point> last_activity = std::nullopt;  // Empty until the first frame
+
+		/*===== Functions =====*/
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Record an activity which needs rendering, e.g. an input event
+		///
+		/// @param now Time of the activity
+		///
+		void mark_active(Clock::time_point now) noexcept;
+
+		///
+		/// @brief Check if the screen has settled since the last activity
+		///
+		/// @param now Current time
+		/// @param exposure Exposure parameters, the adaptation rate extends the settle time
+		/// @return `true` if rendering may be skipped
+		///
+		[[nodiscard]]
+		bool settled(Clock::time_point now, const Exposure& exposure) const noexcept;
+	};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Latency parameters, paces the CPU start of frames and measures the latency of presented frames
+	/// @details
+	/// - With `low_latency` on, at most `max_queued_frames` frames are queued ahead of the display. The CPU
+	/// start of each frame waits for the display of an earlier frame if present wait is supported, or for
+	/// the GPU completion of it otherwise.
+	/// - Latency is measured from the CPU start of a frame to its display, only if present wait is supported
+	///
+	struct Latency
+	{
+		using Clock = std::chrono::steady_clock;
+
+		/*===== Parameters =====*/
+
+		bool low_latency = false;                              // Pace the CPU start of frames
+		uint32_t max_queued_frames = config::INFLIGHT_FRAMES;  // Frames queued ahead, up to in-flight frames
+
+		/*===== States =====*/
+
+		struct PendingPresent
+		{
+			uint64_t present_id;
+			Clock::time_point frame_start;
+		};
+
+		std::deque<PendingPresent> pending;  // Presented but not yet displayed, sorted by ID
+		float smoothed_latency_ms = 0.0f;    // Zero if nothing was measured
+
+		/*===== Functions =====*/
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Track a presented frame until it is displayed
+		///
+		/// @param present_id Present ID of the frame
+		/// @param frame_start CPU start time of the frame
+		///
+		void push(uint64_t present_id, Clock::time_point frame_start) noexcept;
+
+		///
+		/// @brief Get the oldest tracked present that has not been displayed
+		///
+		/// @return Present ID, or `std::nullopt` if none
+		///
+		[[nodiscard]]
+		std::optional<uint64_t> oldest_pending() const noexcept;
+
+		///
+		/// @brief Mark a present and all presents before it as displayed, updating the measured latency
+		///
+		/// @param present_id Present ID of the displayed frame
+		/// @param display_time Time at which the display was observed
+		///
+		void complete(uint64_t present_id, Clock::time_point display_time) noexcept;
+	};
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief UI overlay parameters
+	/// @details In cached mode, the UI is recorded into an overlay layer which is blended over the following
+	/// frames, see `render::OverlayPipeline`. The ImGui frame, the UI logic and its draw only run after
+	/// input, for a few frames to let hovering and window layout settle, and at a reduced rate otherwise to
+	/// refresh the statistics text.
+	///
+	struct Overlay
+	{
+		using Clock = std::chrono::steady_clock;
+
+		/*===== Parameters =====*/
+
+		bool cached = true;
+		float refresh_interval = 0.25f;  // Longest time between two records without input, in seconds
+		int32_t settle_frames = 4;       // Frames recorded after each input
+
+		/*===== States =====*/
+
+		std::optional<Clock::time_point> last_record = std::nullopt;  // Empty until the first record
+		int32_t pending_frames = 0;  // Frames left to record for the last input
+
+		/*===== Functions =====*/
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Record an input event, the UI is recorded in the next `settle_frames` frames
+		///
+		void mark_input() noexcept;
+
+		///
+		/// @brief Check if the UI is recorded in the current frame, and account for it if so
+		///
+		/// @param now Current time
+		/// @param layer_valid Whether the overlay layer holds a recorded UI at the current extent
+		/// @return `true` if the UI is recorded, either directly or into the layer
+		///
+		[[nodiscard]]
+		bool begin_frame(Clock::time_point now, bool layer_valid) noexcept;
+	};
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "render/pipeline/path-trace.hpp"
+
+#include <cstdint>
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Path tracing reference parameters
+	///
+	struct PathTrace
+	{
+		bool enabled = false;
+		float sample_budget_mpaths = 1.0f;  // Paths per frame, in millions
+		int max_samples_per_pixel = 4;
+		int max_bounces = 4;
+		int max_samples = 4096;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get path tracing options
+		///
+		/// @return Path tracing options, or `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<render::PathTracePipeline::Option> get() const noexcept;
+	};
+}
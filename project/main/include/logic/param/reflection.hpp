@@ -0,0 +1,48 @@
+#pragma once
+
+#include "render/pipeline/denoise.hpp"
+#include "render/pipeline/reflection.hpp"
+
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Glossy reflection parameters
+	///
+	struct Reflection
+	{
+		bool enabled = false;
+		float max_roughness = 0.4f;
+		float max_distance = 50.0f;
+		int max_steps = 32;
+		float thickness = 0.05f;
+
+		// Denoising of the traced signal, see `render::DenoisePipeline::Option`
+		float denoise_alpha = 0.2f;
+		float denoise_phi_color = 4.0f;
+		float denoise_phi_normal = 128.0f;
+		float denoise_phi_distance = 0.05f;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get reflection options
+		///
+		/// @return Reflection options, or `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<render::ReflectionPipeline::Option> get() const noexcept;
+
+		///
+		/// @brief Get denoise options of the reflection signal
+		///
+		/// @return Denoise options
+		///
+		[[nodiscard]]
+		render::DenoisePipeline::Option get_denoise() const noexcept;
+	};
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Render resolution parameters, scales the render extent to keep the GPU frame time in budget
+	/// @details
+	/// - The scale is quantized into `SCALE_STEP` steps, so that the attachments are only recreated when the
+	/// frame time drifts by a noticeable amount
+	/// - After each change, the scale holds for `COOLDOWN_FRAMES` frames, so that the in-flight frames
+	/// rendered at the old scale do not push it further
+	/// - In checkerboard mode, renders at the swapchain extent but lights only half of the pixels per frame,
+	/// the TAA pass reconstructs the others
+	/// - The render extent is upscaled to the swapchain extent either temporally by TAA, or spatially by an
+	/// edge-adaptive filter, which needs no jitter and keeps no history
+	///
+	struct Resolution
+	{
+		static constexpr float SCALE_STEP = 0.05f;
+		static constexpr uint32_t COOLDOWN_FRAMES = 15;
+
+		enum class Mode
+		{
+			Fixed,         // Render at `fixed_scale`
+			Dynamic,       // Adjust the scale from the GPU frame time
+			Checkerboard,  // Render at full scale, light alternating halves of the pixels
+		};
+
+		enum class Upscaler
+		{
+			Temporal,  // TAA, accumulates jittered frames
+			Spatial,   // Edge-adaptive filter of the current frame only, unavailable in checkerboard mode
+		};
+
+		/*===== Parameters =====*/
+
+		Mode mode = Mode::Dynamic;
+		Upscaler upscaler = Upscaler::Temporal;
+		float target_frame_ms = 1000.0f / 60.0f;  // GPU frame time budget
+		float min_scale = 0.5f;                    // Lower bound of the scale when adjusting
+		float fixed_scale = 1.0f;                  // Scale used in `Mode::Fixed`
+		float sharpness = 0.0f;                    // Strength of the sharpening after upscaling, 0 to disable
+
+		/*===== States =====*/
+
+		float scale = 1.0f;  // Current scale, a multiple of `SCALE_STEP`
+		float smoothed_frame_ms = 0.0f;
+		uint32_t cooldown = 0;
+
+		/*===== Functions =====*/
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Update the scale from the GPU time of a finished frame
+		///
+		/// @param frame_ms GPU time of the frame, in milliseconds
+		///
+		void update(double frame_ms) noexcept;
+
+		///
+		/// @brief Get the render extent
+		///
+		/// @param extent Swapchain extent
+		/// @return Render extent, at most @p extent and at least 1x1
+		///
+		[[nodiscard]]
+		glm::u32vec2 get_extent(glm::u32vec2 extent) const noexcept;
+
+		///
+		/// @brief Whether the frame is upscaled spatially instead of by TAA
+		///
+		[[nodiscard]]
+		bool spatial_upscale() const noexcept;
+
+		///
+		/// @brief Get the checkerboard parity of a frame
+		///
+		/// @param frame_index Index of the frame
+		/// @return Parity of the pixels lit in the frame, or `std::nullopt` if not in checkerboard mode
+		///
+		[[nodiscard]]
+		std::optional<uint32_t> get_checkerboard(uint64_t frame_index) const noexcept;
+	};
+}
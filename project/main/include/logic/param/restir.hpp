@@ -0,0 +1,33 @@
+#pragma once
+
+#include "render/pipeline/restir.hpp"
+
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief ReSTIR direct illumination parameters
+	///
+	struct Restir
+	{
+		bool enabled = false;
+		int candidate_count = 8;
+		int spatial_samples = 4;
+		float spatial_radius = 16.0f;
+		int max_history = 20;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get ReSTIR options
+		///
+		/// @return ReSTIR options, or `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<render::RestirPipeline::Option> get() const noexcept;
+	};
+}
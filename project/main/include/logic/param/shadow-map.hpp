@@ -0,0 +1,38 @@
+#pragma once
+
+#include "render/util/cascade.hpp"
+
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Cascaded shadow map parameters, rasterized in place of the ray traced shadow of the primary
+	/// light
+	///
+	struct ShadowMap
+	{
+		bool enabled = false;
+		int cascade_count = 4;
+		int resolution_index = 1;  // Index into the resolution choices, see `config_ui`
+		float shadow_distance = 100.0f;
+		float split_lambda = 0.75f;
+
+		// Keep the cascades whose matrix and casters are unchanged, see
+		// `render::CascadeShadowAttachment::acquire_dirty_cascades`
+		bool cached = true;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get cascade fitting options
+		///
+		/// @return Cascade fitting options, or `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<render::CascadeOption> get() const noexcept;
+	};
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "render/pipeline/shading-rate.hpp"
+
+#include <optional>
+
+namespace logic
+{
+	///
+	/// @brief Variable rate shading parameters
+	///
+	struct VariableRateShading
+	{
+		bool enabled = false;
+		bool visualize = false;
+		float contrast_threshold = 0.03f;
+		float motion_scale = 0.25f;
+
+		///
+		/// @brief Configuration UI
+		///
+		void config_ui() noexcept;
+
+		///
+		/// @brief Get shading rate options
+		///
+		/// @return Shading rate options, or `std::nullopt` if disabled
+		///
+		[[nodiscard]]
+		std::optional<render::ShadingRatePipeline::Option> get() const noexcept;
+	};
+}
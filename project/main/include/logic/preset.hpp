@@ -0,0 +1,98 @@
+#pragma once
+
+#include "common/util/cpu.hpp"
+#include "logic/param.hpp"
+#include "render/model/texture.hpp"
+#include "render/pipeline/deferred.hpp"
+#include "render/resource/ambient-occlusion.hpp"
+#include "render/resource/hdr.hpp"
+#include "vulkan/context/capability.hpp"
+
+#include <cstdint>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace logic
+{
+	///
+	/// @brief Performance preset (Logic Layer), startup settings scaled to the tier of the device
+	/// @details Resolutions of the shadow mask and the ambient occlusion, the HDR format, the texture loading
+	/// and the thread pools are fixed for the session. The rest is applied to `Param` once, and stays
+	/// adjustable in the UI.
+	///
+	struct Preset
+	{
+		using Tier = vulkan::DeviceCapability::Tier;
+
+		Tier tier;
+
+		/* Render Scale */
+
+		float initial_scale;  // Also the scale used when the dynamic scale is turned off
+		float min_scale;      // Lower bound of the dynamic scale
+
+		/* Textures */
+
+		render::Texture::ColorLoadStrategy color_load_strategy;
+		render::Texture::NormalLoadStrategy normal_load_strategy;
+		uint32_t max_texture_size;  // Larger dimension limit of loaded textures, `0` for unlimited
+		float max_anisotropy;       // Anisotropic filtering level of material samplers, `1` to disable
+
+		/* Shadow & Lighting */
+
+		bool half_resolution_shadow;  // Trace the shadow mask at half resolution
+		render::AmbientOcclusionAttachment::Resolution ambient_occlusion_resolution;
+		bool global_illumination;
+		bool variable_rate_shading;  // Only takes effect if the device supports it
+		vk::Format hdr_format;       // Format of the HDR attachments, see `render::HdrAttachment::format`
+
+		/* Culling */
+
+		render::DeferredPipeline::DepthPrepass depth_prepass;
+		bool depth_sort;
+
+		/* Threads */
+
+		util::cpu::PoolConfig pool_config;  // Overridden by the thread arguments, see `Argument`
+
+		///
+		/// @brief Get the preset of a tier
+		///
+		/// @param tier Device tier
+		/// @return Preset of the tier
+		///
+		[[nodiscard]]
+		static Preset from_tier(Tier tier) noexcept;
+
+		///
+		/// @brief Fit the texture load strategies to the block compression formats of the device
+		/// @details E.g. mobile devices without BC load textures in ETC2/EAC, and KTX2 textures in ASTC
+		///
+		/// @param support Block compression formats supported by the device
+		///
+		void fit_textures(const render::Texture::CompressionSupport& support) noexcept;
+
+		///
+		/// @brief Fall back to the full HDR format if the device doesn't support the packed one
+		///
+		/// @param phy_device Physical device
+		///
+		void fit_hdr_format(const vk::raii::PhysicalDevice& phy_device) noexcept;
+
+		///
+		/// @brief Apply the adjustable settings to the parameters
+		///
+		/// @param param Parameters to apply to
+		///
+		void apply(Param& param) const noexcept;
+	};
+
+	///
+	/// @brief Get the display name of a device tier
+	///
+	/// @param tier Device tier
+	/// @return Name of the tier
+	///
+	[[nodiscard]]
+	const char* get_tier_name(Preset::Tier tier) noexcept;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/util/timestamp-query.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace logic
+{
+	///
+	/// @brief GPU profiler (Logic Layer), keeps a rolling history of the timestamp query results of each
+	/// pass, and displays statistics in an ImGui panel
+	///
+	class Profiler
+	{
+	  public:
+
+		// Number of frames kept in the history
+		static constexpr size_t HISTORY_SIZE = 300;
+
+		///
+		/// @brief Push results of a frame
+		///
+		/// @param results Timestamp query results of a frame
+		///
+		void push(std::span<const vulkan::TimestampQuery::Result> results) noexcept;
+
+		///
+		/// @brief Profiler window, shows statistics and allows dumping them to files
+		///
+		void ui() noexcept;
+
+		///
+		/// @brief Dump statistics of each pass to a CSV file
+		///
+		/// @param path Path to the CSV file
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> dump_csv(const std::filesystem::path& path) const noexcept;
+
+		///
+		/// @brief Dump statistics and the full history of each pass to a JSON file
+		///
+		/// @param path Path to the JSON file
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> dump_json(const std::filesystem::path& path) const noexcept;
+
+	  private:
+
+		struct Statistics
+		{
+			double average, p50, p95, p99, max;
+		};
+
+		struct Entry
+		{
+			std::string name;
+			std::deque<double> history;  // In milliseconds, newest at back
+
+			[[nodiscard]]
+			Statistics statistics() const noexcept;
+		};
+
+		std::vector<Entry> entries;  // In recording order of the first appearance
+		std::optional<std::string> dump_message = std::nullopt;
+	};
+}
@@ -3,6 +3,7 @@
 #include "argument.hpp"
 #include "common/util/async.hpp"
 #include "common/util/error.hpp"
+#include "page/load.hpp"
 #include "resource/context.hpp"
 #include "scene/page.hpp"
 
@@ -13,6 +14,8 @@ namespace page
 {
 	///
 	/// @brief Starting state, creates basic vulkan context
+	/// @details The CPU-side model loading is prefetched in the background meanwhile, see
+	/// `LoadPage::prefetch`
 	///
 	class InitPage : public scene::Page
 	{
@@ -34,10 +37,16 @@ namespace page
 
 		util::Future<std::expected<resource::Context, Error>> task;
 		Argument argument;
+		LoadPage::Prefetch prefetch;
 
-		explicit InitPage(util::Future<std::expected<resource::Context, Error>> task, Argument argument) :
+		explicit InitPage(
+			util::Future<std::expected<resource::Context, Error>> task,
+			Argument argument,
+			LoadPage::Prefetch prefetch
+		) :
 			task(std::move(task)),
-			argument(std::move(argument))
+			argument(std::move(argument)),
+			prefetch(std::move(prefetch))
 		{}
 
 	  public:
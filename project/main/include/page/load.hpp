@@ -2,20 +2,33 @@
 
 #include "argument.hpp"
 #include "common/util/async.hpp"
+#include "common/util/cpu.hpp"
 #include "common/util/error.hpp"
 #include "common/util/tagged-type.hpp"
 #include "helper/imgui-page.hpp"
+#include "logic/preset.hpp"
 #include "model/gltf.hpp"
+#include "model/model.hpp"
+#include "render/model/geometry-streamer.hpp"
 #include "render/model/material.hpp"
 #include "render/model/model.hpp"
+#include "render/model/texture-streamer.hpp"
 #include "render/model/tlas.hpp"
 #include "resource/context.hpp"
+#include "resource/pipeline.hpp"
 #include "scene/page.hpp"
+#include "vulkan/interface/context.hpp"
 
+#include <coro/thread_pool.hpp>
+#include <cstdint>
 #include <expected>
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <stop_token>
 #include <tuple>
 #include <utility>
+#include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace page
@@ -28,15 +41,64 @@ namespace page
 	{
 	  public:
 
+		// CPU-side model loading started before the Vulkan context is created, see `prefetch`
+		struct Prefetch;
+
+		// Model loading running behind a render page, see `load_in_background`
+		struct BackgroundLoad;
+
+		using LoadResult = std::tuple<
+			render::Model,
+			render::Tlas,
+			std::optional<render::TextureStreamer>,
+			std::optional<render::GeometryStreamer>
+		>;
+
+		///
+		/// @brief Start the CPU-side model loading in the background, overlapping the Vulkan bring-up
+		/// @details Opens the model cache, or parses the glTF model if the cache misses or textures are
+		/// streamed. Baking and uploading wait for the Vulkan context in `from`.
+		///
+		/// @param argument Argument input
+		/// @return Started prefetch
+		///
+		[[nodiscard]]
+		static Prefetch prefetch(const Argument& argument) noexcept;
+
 		///
 		/// @brief Create a loading page
 		///
 		/// @param context Vulkan context
 		/// @param argument Argument input
+		/// @param prefetch Prefetch started with the same arguments
 		/// @return Created load page or error
 		///
 		[[nodiscard]]
-		static std::expected<LoadPage, Error> from(resource::Context context, Argument argument) noexcept;
+		static std::expected<LoadPage, Error> from(
+			resource::Context context,
+			Argument argument,
+			Prefetch prefetch
+		) noexcept;
+
+		///
+		/// @brief Load another model in the background, while the current model keeps rendering
+		/// @details Loads the same way as the loading page, see `prefetch` and `from`. The model is created
+		/// for @p material_layout and the vertex format of @p preset, so that the running pipelines stay
+		/// valid for it.
+		///
+		/// @param context Vulkan context
+		/// @param material_layout Material layout of the running pipelines, must outlive the loading
+		/// @param argument Argument input, the model path being the one to load
+		/// @param preset Performance preset of the running pipelines
+		/// @return Started loading
+		///
+		[[nodiscard]]
+		static BackgroundLoad load_in_background(
+			std::shared_ptr<const resource::Context> context,
+			const render::MaterialLayout& material_layout,
+			Argument argument,
+			const logic::Preset& preset
+		) noexcept;
 
 		[[nodiscard]]
 		std::expected<ResultType, Error> run_frame() noexcept override;
@@ -58,24 +120,45 @@ namespace page
 			Success
 		};
 
-		using TaskProgress = util::SyncedEnumVariant<
+		using TaskProgress = util::AtomicEnumVariant<
 			util::Tag<TaskProgressState::Preparing>,
 			util::Tag<TaskProgressState::Parsing, std::shared_ptr<const model::gltf::Progress>>,
 			util::Tag<TaskProgressState::Processing, std::shared_ptr<const render::Model::Progress>>
 		>;
 
+		// Model source prepared by the prefetch, owns the thread pool used for the rest of the loading. The
+		// cache key depends on the loading options, so the cache is only opened once the device is known
+		struct ModelSource
+		{
+			std::unique_ptr<coro::thread_pool> thread_pool;
+			std::optional<model::Model> gltf_model;  // Empty if a cache file exists
+
+			// Hash of the source file and where the baked model is cached, unused with texture streaming
+			uint64_t source_hash;
+			std::filesystem::path cache_path;
+		};
+
 		struct Task
 		{
+			// Requested when quitting, so that the loading tasks return early instead of running to the end
+			std::stop_source stop_source;
+
 			std::unique_ptr<render::MaterialLayout> material_layout;
 			std::unique_ptr<TaskProgress> progress;
-			util::Future<std::expected<std::tuple<render::Model, render::Tlas>, Error>> model_future;
+			util::Future<std::expected<LoadResult, Error>> model_future;
+
+			// Pipelines are created alongside the model, referencing `material_layout`
+			util::Future<std::expected<resource::Pipeline, Error>> pipeline_future;
 		};
 
 		struct TaskResult
 		{
 			render::Model model;
 			render::Tlas tlas;
+			std::optional<render::TextureStreamer> texture_streamer;
+			std::optional<render::GeometryStreamer> geometry_streamer;
 			std::unique_ptr<render::MaterialLayout> material_layout;
+			resource::Pipeline pipeline;
 		};
 
 		using StateData = util::EnumVariant<
@@ -87,12 +170,92 @@ namespace page
 
 		std::shared_ptr<resource::Context> context;
 		helper::ImGuiPage imgui_page;
+		Argument argument;  // Handed to the render page, which reloads models with it
+		logic::Preset preset;
 		StateData state_data;
 
-		static std::expected<std::tuple<render::Model, render::Tlas>, Error> load_model_task(
+		// Get the model loading option from the arguments and the performance preset
+		static render::Model::Option get_model_option(
+			const Argument& argument,
+			const logic::Preset& preset
+		) noexcept;
+
+		static std::expected<ModelSource, Error> prefetch_model_task(
+			Argument argument,
+			util::cpu::PoolConfig pool_config,
+			std::stop_token stop_token,
+			TaskProgress& progress
+		) noexcept;
+
+		static std::expected<LoadResult, Error> load_model_task(
 			std::shared_ptr<const resource::Context> context,
 			const render::MaterialLayout& material_layout,
 			Argument argument,
+			render::Model::Option model_option,
+			util::Future<std::expected<ModelSource, Error>> source_future,
+			std::stop_token stop_token,
+			TaskProgress& progress
+		) noexcept;
+
+		static std::expected<resource::Pipeline, Error> load_pipeline_task(
+			std::shared_ptr<const resource::Context> context,
+			const render::MaterialLayout& material_layout,
+			render::VertexFormat vertex_format,
+			vk::Format composite_format,
+			vk::Format hdr_format,
+			resource::Pipeline::GBufferPath gbuffer_path,
+			util::cpu::PoolConfig pool_config
+		) noexcept;
+
+		// Parse a glTF model, optionally merging its small static meshes, building HLOD proxies and baking
+		// impostors
+		static std::expected<model::Model, Error> parse_model(
+			coro::thread_pool& thread_pool,
+			const std::filesystem::path& model_path,
+			bool merge_static,
+			bool build_hlod,
+			bool build_impostors,
+			std::stop_token stop_token,
+			TaskProgress& progress
+		) noexcept;
+
+		// Load a model through the model cache, baking and caching it on miss. With `stream_geometry`, only
+		// coarse geometry is loaded, with a streamer for the full geometry in the cache
+		static std::expected<std::pair<render::Model, std::optional<render::GeometryStreamer>>, Error>
+		load_cached_model(
+			coro::thread_pool& thread_pool,
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			ModelSource source,
+			const std::filesystem::path& model_path,
+			const render::Model::Option& model_option,
+			bool merge_static,
+			bool build_hlod,
+			bool build_impostors,
+			bool stream_geometry,
+			std::stop_token stop_token,
+			TaskProgress& progress
+		) noexcept;
+
+		// Load a parsed model with low-resolution textures, and a streamer for full-resolution textures
+		static std::expected<std::pair<render::Model, render::TextureStreamer>, Error> load_streamed_model(
+			coro::thread_pool& thread_pool,
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			model::Model gltf_model,
+			const render::Model::Option& model_option,
+			std::stop_token stop_token,
+			TaskProgress& progress
+		) noexcept;
+
+		// Load a parsed model with its animations and deformation data, which baked models drop
+		static std::expected<render::Model, Error> load_animated_model(
+			coro::thread_pool& thread_pool,
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			const model::Model& gltf_model,
+			const render::Model::Option& model_option,
+			std::stop_token stop_token,
 			TaskProgress& progress
 		) noexcept;
 
@@ -103,10 +266,14 @@ namespace page
 		explicit LoadPage(
 			std::shared_ptr<resource::Context> context,
 			helper::ImGuiPage imgui_page,
+			Argument argument,
+			logic::Preset preset,
 			Task task
 		) :
 			context(std::move(context)),
 			imgui_page(std::move(imgui_page)),
+			argument(std::move(argument)),
+			preset(preset),
 			state_data(util::tag_value<State::Loading>(std::move(task)))
 		{}
 
@@ -117,4 +284,22 @@ namespace page
 		LoadPage& operator=(const LoadPage&) = delete;
 		LoadPage& operator=(LoadPage&&) = default;
 	};
+
+	struct LoadPage::Prefetch
+	{
+		std::stop_source stop_source;  // Moved into `Task` by `from`
+		std::unique_ptr<TaskProgress> progress;
+		util::Future<std::expected<ModelSource, Error>> source_future;
+	};
+
+	struct LoadPage::BackgroundLoad
+	{
+		Argument argument;  // Argument of the loading, adopted by the page once swapped in
+
+		// Requested when the page quits, so that the loading returns early
+		std::stop_source stop_source;
+
+		std::unique_ptr<TaskProgress> progress;
+		util::Future<std::expected<LoadResult, Error>> model_future;
+	};
 }
@@ -1,30 +1,82 @@
 #pragma once
 
+#include "argument.hpp"
+#include "common/util/async.hpp"
 #include "common/util/error.hpp"
-#include "logic/drawcall-gen.hpp"
+#include "config.hpp"
+#include "helper/thread-pool.hpp"
+#include "logic/frame-timing.hpp"
+#include "logic/input-record.hpp"
+#include "logic/memory-monitor.hpp"
+#include "logic/model-swap.hpp"
 #include "logic/param.hpp"
+#include "logic/preset.hpp"
+#include "logic/profiler.hpp"
+#include "model/hierarchy.hpp"
+#include "page/load.hpp"
 #include "render/interface/auto-exposure.hpp"
 #include "render/interface/camera.hpp"
+#include "render/interface/cull-view.hpp"
 #include "render/interface/direct-light.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/interface/node-transform.hpp"
 #include "render/interface/primitive-drawcall.hpp"
+#include "render/model/blas.hpp"
+#include "render/model/deform-list.hpp"
+#include "render/model/geometry-streamer.hpp"
 #include "render/model/material.hpp"
 #include "render/model/model.hpp"
+#include "render/model/texture-streamer.hpp"
 #include "render/model/tlas.hpp"
+#include "render/pipeline/ambient-occlusion.hpp"
+#include "render/pipeline/contact-shadow.hpp"
+#include "render/pipeline/deferred.hpp"
+#include "render/pipeline/denoise.hpp"
+#include "render/pipeline/gi-probe.hpp"
+#include "render/pipeline/path-trace.hpp"
+#include "render/pipeline/reflection.hpp"
+#include "render/pipeline/restir.hpp"
+#include "render/pipeline/shading-rate.hpp"
+#include "render/resource/cascade-shadow.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/overlay.hpp"
+#include "render/resource/path-trace.hpp"
+#include "render/util/cascade.hpp"
 #include "render/util/per-render-state.hpp"
+#include "render/util/render-graph.hpp"
 #include "resource/aux-resource.hpp"
 #include "resource/context.hpp"
+#include "resource/frame-capture.hpp"
 #include "resource/pipeline.hpp"
 #include "resource/render-resource.hpp"
 #include "resource/sync-primitive.hpp"
 #include "scene/page.hpp"
+#include "vulkan/container/device/readback-ring.hpp"
 #include "vulkan/container/host/cycle.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
+#include "vulkan/container/host/frame-arena.hpp"
+#include "vulkan/alloc/defragmentation.hpp"
 #include "vulkan/context/swapchain.hpp"
-
+#include "vulkan/util/command-runner.hpp"
+#include "vulkan/util/gpu-profiler.hpp"
+#include "vulkan/util/pipeline-statistics-query.hpp"
+#include "vulkan/util/secondary-recorder.hpp"
+#include "vulkan/util/timestamp-query.hpp"
+
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/scalar_constants.hpp>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -50,6 +102,12 @@ namespace page
 		/// @param context Vulkan context
 		/// @param model Model instance
 		/// @param material_layout Material layout for model
+		/// @param tlas TLAS of the model
+		/// @param texture_streamer Texture streamer of the model, `std::nullopt` if textures are fully loaded
+		/// @param geometry_streamer Geometry streamer of the model, `std::nullopt` if fully loaded
+		/// @param pipeline Pipelines created for the material layout and vertex format of the model
+		/// @param argument Argument the model was loaded with, models swapped in are loaded the same way
+		/// @param preset Performance preset, applied to the initial parameters
 		/// @return Created render page or error
 		///
 		[[nodiscard]]
@@ -57,30 +115,77 @@ namespace page
 			std::shared_ptr<resource::Context> context,
 			render::MaterialLayout material_layout,
 			render::Model model,
-			render::Tlas tlas
+			render::Tlas tlas,
+			std::optional<render::TextureStreamer> texture_streamer,
+			std::optional<render::GeometryStreamer> geometry_streamer,
+			resource::Pipeline pipeline,
+			Argument argument,
+			logic::Preset preset
 		) noexcept;
 
 	  private:
 
 		/* Struct Definition */
 
+		// Passes recorded in parallel into secondary command buffers, in execution order
+		enum class ParallelPass : uint32_t
+		{
+			Transform,
+			ShadingRate,   // Derives the shading rates of this frame from the previous frame
+			CullingEarly,  // Early phase: draw objects visible in previous frame, then build HiZ
+			GBufferEarly,
+			HizEarly,
+			CullingLate,  // Late phase: draw objects falsely culled in early phase, then rebuild HiZ
+			GBufferLate,
+			HizLate,
+			LightCulling,
+			Shadow,
+			AmbientOcclusion,
+			GlobalIllumination,
+			DirectLighting,
+			Restir,       // Adds the resampled direct lighting to the lit HDR attachment, if enabled
+			Reflection,   // Adds the denoised glossy reflections to the lit HDR attachment, if enabled
+			PathTrace,    // Overwrites the lit HDR attachment while path tracing, records nothing otherwise
+			Transparent,  // Culls and draws the blended drawcalls, composited after TAA
+		};
+
+		static constexpr uint32_t PARALLEL_PASS_COUNT = 17;
+
 		struct FrameResource
 		{
 			vk::raii::CommandBuffer command_buffer;
+			vk::raii::CommandBuffer compute_command_buffer;  // Recorded for the async compute queue
 			resource::RenderResource render_resource;
 			resource::ResourceSet resource_set;
 			resource::FrameSyncPrimitive sync_primitive;
+			vulkan::TimestampQuery timestamp_query;
+			vulkan::PipelineStatisticsQuery statistics_query;  // A slot for each `ParallelPass`
+			vulkan::SecondaryRecorder secondary_recorder;      // A slot for each `ParallelPass`
+			render::RenderGraph::TransientCache transient_cache;
+			bool stale_feedback = false;  // Last recorded with a model since swapped out, feedback is ignored
+
+			// Host-side scratch data of the frame, reset once the frame has been waited for
+			std::unique_ptr<vulkan::FrameArena> frame_arena =
+				std::make_unique<vulkan::FrameArena>(config::FRAME_ARENA_SIZE);
 
 			explicit FrameResource(
 				vk::raii::CommandBuffer command_buffer,
+				vk::raii::CommandBuffer compute_command_buffer,
 				resource::RenderResource render_resource,
 				resource::ResourceSet resource_set,
-				resource::FrameSyncPrimitive sync_primitive
+				resource::FrameSyncPrimitive sync_primitive,
+				vulkan::TimestampQuery timestamp_query,
+				vulkan::PipelineStatisticsQuery statistics_query,
+				vulkan::SecondaryRecorder secondary_recorder
 			) :
 				command_buffer(std::move(command_buffer)),
+				compute_command_buffer(std::move(compute_command_buffer)),
 				render_resource(std::move(render_resource)),
 				resource_set(std::move(resource_set)),
-				sync_primitive(std::move(sync_primitive))
+				sync_primitive(std::move(sync_primitive)),
+				timestamp_query(std::move(timestamp_query)),
+				statistics_query(std::move(statistics_query)),
+				secondary_recorder(std::move(secondary_recorder))
 			{}
 
 			FrameResource(const FrameResource&) = delete;
@@ -92,28 +197,136 @@ namespace page
 		struct Frame
 		{
 			const vk::raii::CommandBuffer& command_buffer;
-			const resource::RenderResource& render_resource;
+			const vk::raii::CommandBuffer& compute_command_buffer;
+			resource::RenderResource& render_resource;
 			const resource::RenderResource& prev_render_resource;
 			const resource::ResourceSet& resource_set;
 			const resource::FrameSyncPrimitive& sync_primitive;
+			const resource::FrameSyncPrimitive& prev_sync_primitive;
+			vulkan::TimestampQuery& timestamp_query;
+			vulkan::PipelineStatisticsQuery& statistics_query;
+			vulkan::SecondaryRecorder& secondary_recorder;
+			render::RenderGraph::TransientCache& transient_cache;
+			std::pmr::memory_resource& frame_arena;
 			vk::Semaphore render_complete_semaphore;
 			vulkan::SwapchainContext::Frame swapchain;
+			glm::u32vec2 render_extent;  // Extent of the attachments except TAA, at most the swapchain extent
+			bool hiz_history_valid;      // Whether HiZ of previous frame holds valid content
+			bool taa_history_valid;      // Whether TAA output of previous frame holds valid content
+			bool exposure_valid;         // Whether auto-exposure of previous frame has been submitted
+			render::DeferredPipeline::DepthPrepass depth_prepass;
+			bool depth_sort;  // Whether to order the main camera draws front to back
+			bool deform;      // Whether the deformable meshes are posed in this frame, their BLASes refit
+
+			// Cascades to rasterize, bit `i` for cascade `i`. Shadow rays are traced instead if empty
+			std::optional<uint32_t> shadow_map_dirty_mask;
+
+			std::optional<render::ContactShadowPipeline::Option> contact_shadow;  // Disabled if empty
+			std::optional<float> bloom_intensity;                                  // Disabled if empty
+
+			// Whether ambient occlusion of previous frame is at the same extent, cleared output of frames
+			// with ambient occlusion disabled is rejected by the pipeline itself
+			bool ambient_occlusion_history_valid;
+			std::optional<render::AmbientOcclusionPipeline::Option> ambient_occlusion;  // Disabled if empty
+			bool ambient_occlusion_converged;  // Whether the output of the last trace is reused, not traced
+			std::optional<render::GiProbePipeline::Option> global_illumination;       // Disabled if empty
+			std::optional<uint32_t> global_illumination_frame;  // Frame index of the probe update, if any
+			std::optional<render::RestirPipeline::Option> restir;  // Disabled if empty
+			bool restir_history_valid;  // Whether the reservoirs of previous frame are at the same extent
+			std::optional<render::ReflectionPipeline::Option> reflection;  // Disabled if empty
+			bool reflection_history_valid;  // Whether the denoised reflections of previous frame are valid
+			render::DenoisePipeline::Option reflection_denoise;
+			uint64_t frame_index;
+
+			// Shading rates of the frame, derived from the previous frame. Shades at full rate if empty
+			std::optional<render::ShadingRatePipeline::Option> variable_rate_shading;
+			bool shading_rate_visualize;  // Whether to tint the lit HDR attachment by the shading rates
+
+			std::optional<render::PathTracePipeline::Option> path_trace;  // Disabled if empty
+			uint32_t path_trace_frame;  // Frames accumulated before this one
+
+			bool atmosphere;  // Whether to shade the sky and the sun by the atmosphere
+			std::optional<render::DirectLight> atmosphere_sun;  // Sun to recompute the sky view for, if moved
+
+			// Parity of the pixels lit in the frame, reconstructed by TAA. Lights all pixels if empty
+			std::optional<uint32_t> checkerboard;
+
+			bool spatial_upscale;  // Whether the frame is upscaled spatially instead of by TAA
+			float sharpness;       // Strength of the sharpening in the composite, 0 if disabled
+
+			// Pixel of the render extent to pick the object of, see `render::ObjectPickPipeline`
+			std::optional<glm::u32vec2> object_pick;
+
+			// Cached UI layer, the UI is drawn directly over the composite if empty
+			std::optional<render::OverlayAttachment::View> overlay;
+			bool ui_recorded;  // Whether the UI has been recorded in this frame, see `logic::Overlay`
 		};
 
 		struct SceneData
 		{
-			render::PerRenderState<std::pmr::vector<render::PrimitiveDrawcall>> drawcalls;
-			std::pmr::vector<glm::mat4> transforms;
+			render::PerRenderState<size_t> drawcall_counts;
+			render::PerRenderState<size_t> blended_drawcall_counts;
+			size_t node_count;
+			size_t primitive_count;
+			size_t material_count;
+			std::pmr::vector<render::NodeTransformUpdate> transform_updates;
+			std::optional<render::DeformList::Parameters> deform_parameters;  // Empty if no mesh is posed
+			std::vector<render::ShadowCascade> shadow_cascades;  // Empty if shadow maps are disabled
+			std::pmr::vector<render::CullView> cull_views;       // Cascades culled along with the camera
+			glm::mat4 root_transform;
 			render::Camera camera;
 			render::DirectLight primary_light;
 			render::ExposureParam exposure_param;
 
+			// Whether nodes or deformable meshes moved in this frame
+			bool moved() const noexcept
+			{
+				return !transform_updates.empty() || deform_parameters.has_value();
+			}
+
 			operator resource::RenderData() const noexcept;
 		};
 
+		// Inputs of the path traced image, the accumulation restarts when any of them changes
+		struct PathTraceHistory
+		{
+			glm::mat4 view_projection;  // Unjittered
+			glm::vec3 camera_pos;
+			render::DirectLight primary_light;
+			render::PathTracePipeline::Option option;
+			glm::u32vec2 extent;
+
+			bool operator==(const PathTraceHistory&) const noexcept = default;
+		};
+
+		// Inputs of the stochastic ray traced passes, they converge and stop while none of them changes
+		struct StaticViewHistory
+		{
+			glm::mat4 view_projection;  // Unjittered
+			glm::vec3 camera_pos;
+			render::DirectLight primary_light;
+			std::optional<render::AmbientOcclusionPipeline::Option> ambient_occlusion;
+			std::optional<render::GiProbePipeline::Option> global_illumination;
+			glm::u32vec2 extent;
+			size_t texture_resident_count;   // Streamed textures change the albedo bounced by the probes
+			size_t geometry_resident_count;  // Streamed geometry changes the occluders
+
+			bool operator==(const StaticViewHistory&) const noexcept = default;
+		};
+
+		struct GiBakeHistory
+		{
+			render::GiProbePipeline::Option option;
+			render::DirectLight primary_light;
+			uint32_t pass_count;
+
+			bool operator==(const GiBakeHistory&) const noexcept = default;
+		};
+
 		enum class Event
 		{
 			None,
+			Input,  // Any event arrived, e.g. input or window events
 			Quit
 		};
 
@@ -121,46 +334,290 @@ namespace page
 
 		std::shared_ptr<resource::Context> context;
 		vk::raii::CommandPool command_pool;
+		vk::raii::CommandPool compute_command_pool;
 
 		render::MaterialLayout material_layout;
 		render::Model model;
 		render::Tlas tlas;
+		std::optional<render::TextureStreamer> texture_streamer;    // Declared after `model` to destroy first
+		std::optional<render::GeometryStreamer> geometry_streamer;  // Declared after `model` to destroy first
+
+		// Fast-trace rebuild of fast-built BLASes, running on a background thread. Declared after `model` to
+		// join first
+		std::optional<util::Future<std::expected<render::BlasList, Error>>> blas_rebuild;
+		bool blas_rebuild_started = false;
+		bool tlas_rebuild_pending = false;  // BLASes replaced, TLAS is rebuilt in the next recorded frame
+		glm::vec3 tlas_cull_origin = glm::vec3(0.0f);  // Camera position of the last prepared scene
+
+		// Model loading in the background, swapped in at a frame boundary once loaded. References
+		// `material_layout`, declared after it to join first
+		Argument argument;
+		std::optional<LoadPage::BackgroundLoad> model_load;
 
 		resource::Pipeline pipeline;
+		vulkan::GpuProfiler gpu_profiler;  // Shared by the frames in flight, no-op without the "tracy" option
 		vulkan::Cycle<FrameResource> frame_resources;
+		vulkan::DeletionQueue deletion_queue = vulkan::DeletionQueue(config::INFLIGHT_FRAMES);
 		std::vector<vk::raii::Semaphore> render_complete_semaphores;  // Indexed by swapchain image indices
+		vulkan::ReadbackRing readback_ring;  // A slot for each frame in flight, only reads object picks
 		resource::AuxResource aux_resource;
 
-		logic::DrawcallGenerator drawcall_generator;
+		// Probes of the global illumination. Shared by the frames in flight, as they execute in submission
+		// order on the same queue
+		render::GiProbeVolume gi_probe_volume;
+
+		// Ambient lighting of the environment map, a black placeholder without `--environment`. Shared by
+		// the frames in flight, never written after creation
+		render::EnvironmentLighting environment_lighting;
+
+		// Runs host work of a frame concurrently with the main thread, declared last to join first. Sized and
+		// pinned by the pool config of the preset, see `helper::create_thread_pool`
+		std::unique_ptr<coro::thread_pool> thread_pool;
+
+		logic::Preset preset;
 		logic::Param param = {};
+		logic::Profiler profiler = {};
+		logic::FrameTiming frame_timing = {};
 
-		void ui(glm::u32vec2 extent) noexcept;
+		// Culling counts and pipeline statistics of the last waited frame, shown in the overlay
+		render::PerRenderState<render::IndirectCount> culling_stat = {};
+		std::vector<vulkan::PipelineStatisticsQuery::Result> pipeline_stat = {};
+		logic::MemoryMonitor memory_monitor = {};
+		logic::ModelSwap model_swap;
+
+		// Defragmentation of device memory in progress, a pass runs in each idle frame
+		struct Defragment
+		{
+			vulkan::Defragmentation defragmentation;
+			vulkan::CommandRunner command_runner;
+		};
+
+		std::optional<Defragment> defragment;
+		bool defragment_requested = false;  // Set by model swaps, starts a defragmentation once idle
+
+		bool hiz_history_valid = false;  // Invalidated when attachments are recreated
+		bool taa_history_valid = false;  // Invalidated when the TAA attachments are recreated
+		bool ambient_occlusion_history_valid = false;  // Invalidated when attachments are resized
+
+		// Invalidated when attachments are resized, or by frames without ReSTIR
+		bool restir_history_valid = false;
+
+		// Invalidated when attachments are resized, or by frames without reflections
+		bool reflection_history_valid = false;
+		uint64_t frame_index = 0;
+
+		// Only allocated while path tracing. A single accumulation is shared by the frames in flight, as they
+		// execute in submission order on the same queue
+		std::optional<render::PathTraceAttachment> path_trace_attachment;
+		std::optional<PathTraceHistory> path_trace_history;  // Inputs of the last path traced frame
+		uint32_t path_trace_frame = 0;
+
+		// Only allocated with shadow maps enabled. Shared by the frames in flight, as they execute in
+		// submission order on the same queue, so that cascades unchanged since any frame are kept
+		std::optional<render::CascadeShadowAttachment> shadow_map_attachment;
+		uint64_t shadow_map_geometry_version = 0;  // Bumped when casters change, invalidates cached cascades
+		size_t shadow_map_resident_count = 0;      // Streamed geometry the version was last bumped for
+		std::optional<uint32_t> shadow_map_dirty_mask;  // Cascades to rasterize in the frame being prepared
+
+		// Playback of the model animations, reset by model swaps. The last pose stays in place while paused,
+		// as the local transforms and the deformed vertices on GPU persist across frames
+		float animation_time = 0.0f;
+		std::vector<model::Transform> animation_pose;             // Local transform of each node
+		std::vector<std::vector<float>> animation_morph_weights;  // Morph weights of each node
+		std::vector<glm::mat4> animation_transforms;              // World transforms of the last pose
+		bool animation_deform = false;  // Whether the frame being prepared poses the deformable meshes
+
+		// Whether the TLAS lags behind the last pose. The refit waits for the previous frame to finish
+		// reading the staging buffer of the TLAS, see `render::Tlas::update`
+		bool animation_tlas_pending = false;
+
+		// Inputs of the frames since the view and the scene became static, reset by any change of them and by
+		// the loss of the ambient occlusion output. See `update_static_view`
+		std::optional<StaticViewHistory> static_view_history;
+		uint32_t static_view_frame = 0;  // Frames recorded with the current static view
+
+		// Inputs of the running static bake of the probes, restarted when they change or the model is swapped
+		std::optional<GiBakeHistory> gi_bake_history;
+		uint32_t gi_bake_frame = 0;
+
+		// Elevation of the sun the sky-view LUT was last computed for, shared by the frames in flight as they
+		// execute in submission order on the same queue
+		std::optional<float> atmosphere_sun_height;
+
+		// Created by the first composite with `--capture`, at the swapchain extent of that frame
+		std::optional<resource::FrameCapture> frame_capture;
+
+		// Only allocated with the cached overlay, at the swapchain extent. Shared by the frames in flight, as
+		// they execute in submission order on the same queue
+		std::optional<render::OverlayAttachment> overlay_layer;
+		bool overlay_layer_valid = false;  // Whether the layer holds a recorded UI
+
+		// Time of the last prepared frame. ImGui's delta time only advances in frames recording the UI
+		std::optional<logic::Overlay::Clock::time_point> last_frame_time;
+
+		// Opened by the first frame with `--capture-input` or `--replay-input`
+		std::optional<logic::InputCapture> input_capture;
+		std::optional<logic::InputReplay> input_replay;
+		float frame_delta_time = 0.0f;  // Delta time the last prepared frame advanced by
+
+		// Middle click on the scene, in swapchain pixels, picked by the next frame
+		std::optional<glm::vec2> pick_request;
+
+		// Drawcall under the last picked pixel, read back a few frames after the pick. Both indices are
+		// `render::PrimitiveDrawcall::HIDDEN` if nothing pickable was there. Allocated so that the readback
+		// callbacks keep a stable address while the page moves.
+		std::unique_ptr<std::optional<render::PrimitiveDrawcall>> picked_object =
+			std::make_unique<std::optional<render::PrimitiveDrawcall>>();
+
+		void ui(
+			glm::u32vec2 extent,
+			std::optional<render::TextureStreamer::Stat> streaming_stat,
+			std::optional<render::GeometryStreamer::Stat> geometry_stat,
+			std::pmr::memory_resource& frame_arena
+		) noexcept;
 
 		[[nodiscard]]
 		Event handle_events() noexcept;
 
+		// Whether progressive work still changes the screen without input, prevents idling
+		[[nodiscard]]
+		bool has_pending_work() const noexcept;
+
+		// Centers the target view on the node whose box is under @p position, in swapchain pixels, or on the
+		// whole scene if there is none. Queries a `model::SceneBvh` built from the current pose.
+		void focus_view(
+			glm::vec2 position,
+			glm::u32vec2 extent,
+			std::pmr::memory_resource& frame_arena
+		) noexcept;
+
+		// Opens the input capture or replay requested by the arguments, if not yet open
+		[[nodiscard]]
+		std::expected<void, Error> open_input_record() noexcept;
+
 		/*===== Prepare =====*/
 
+		// Waits for earlier frames according to `param.latency`, before any input of the frame is sampled
+		[[nodiscard]]
+		std::expected<void, Error> pace_frame() noexcept;
+
 		struct FrameAcquireResult
 		{
 			FrameResource &curr_resource, &prev_resource;
 			vulkan::SwapchainContext::Frame swapchain_frame;
+			glm::u32vec2 render_extent;
+			bool hiz_history_valid;
+			bool taa_history_valid;
+			bool ambient_occlusion_history_valid;
+			bool restir_history_valid;
+			bool reflection_history_valid;
 		};
 
 		[[nodiscard]]
 		std::expected<std::optional<FrameAcquireResult>, Error> acquire_frame() noexcept;
 
 		[[nodiscard]]
-		SceneData prepare_scene(glm::u32vec2 extent) noexcept;
+		SceneData prepare_scene(
+			glm::u32vec2 extent,
+			glm::u32vec2 render_extent,
+			float delta_time,
+			std::pmr::memory_resource& frame_arena
+		) noexcept;
+
+		// Runs on `thread_pool`, only touches the texture streamer and the feedback of the waited frame
+		[[nodiscard]]
+		coro::task<std::expected<void, Error>> update_texture_streaming(FrameResource& resource) noexcept;
+
+		// Runs on `thread_pool`, only touches the geometry streamer and the feedback of the waited frame
+		[[nodiscard]]
+		coro::task<std::expected<void, Error>> update_geometry_streaming(
+			FrameResource& resource,
+			glm::u32vec2 render_extent
+		) noexcept;
+
+		// Runs on the main thread, concurrently with the streaming updates
+		[[nodiscard]]
+		coro::task<std::expected<void, Error>> prepare_ui_and_scene(
+			FrameAcquireResult frame,
+			std::optional<render::TextureStreamer::Stat> streaming_stat,
+			std::optional<render::GeometryStreamer::Stat> geometry_stat,
+			bool record_ui
+		) noexcept;
+
+		// Runs on the main thread before the UI, (re)allocates or releases the cached overlay layer
+		[[nodiscard]]
+		std::expected<void, Error> update_overlay_layer(glm::u32vec2 extent) noexcept;
+
+		// Runs on the main thread after the scene is prepared, (re)allocates or releases the accumulation and
+		// restarts it if the inputs changed
+		[[nodiscard]]
+		std::expected<void, Error> update_path_trace(
+			const SceneData& scene_data,
+			glm::u32vec2 render_extent
+		) noexcept;
+
+		// Runs on the main thread after the scene is prepared, (re)allocates or releases the cascades and
+		// finds the ones to rasterize
+		[[nodiscard]]
+		std::expected<void, Error> update_shadow_map(
+			const SceneData& scene_data,
+			const std::optional<render::GeometryStreamer::Stat>& geometry_stat
+		) noexcept;
+
+		// Runs on the main thread after the scene is prepared, restarts the convergence of the ray traced
+		// passes if the view or the scene changed
+		void update_static_view(
+			const SceneData& scene_data,
+			glm::u32vec2 render_extent,
+			const std::optional<render::TextureStreamer::Stat>& streaming_stat,
+			const std::optional<render::GeometryStreamer::Stat>& geometry_stat
+		) noexcept;
+
+		// Starts rebuilding fast-built BLASes on the first frame, swaps them into the model once built
+		[[nodiscard]]
+		std::expected<void, Error> update_blas_rebuild() noexcept;
+
+		// Runs before the frame is acquired, swaps in the model loaded in the background and retires the
+		// previous one, with its TLAS, streamers and probe volume
+		[[nodiscard]]
+		std::expected<void, Error> update_model_load() noexcept;
+
+		// Runs in idle frames, starts a defragmentation when requested or when device memory blocks are
+		// mostly unused, and runs a pass of it with the device idle. Failed passes only end the
+		// defragmentation, failing to rebind the moved textures is fatal
+		[[nodiscard]]
+		std::expected<void, Error> update_defragmentation() noexcept;
 
 		[[nodiscard]]
 		std::expected<std::optional<Frame>, Error> prepare_frame() noexcept;
 
 		/*===== Render =====*/
 
-		void render_objects(const Frame& frame) const noexcept;
-		void render_lighting(const Frame& frame) const noexcept;
-		void render_post_processing(const Frame& frame) const noexcept;
+		void record_pass(
+			const Frame& frame,
+			const vk::raii::CommandBuffer& command_buffer,
+			ParallelPass pass
+		) const noexcept;
+
+		void render_lighting(
+			const Frame& frame,
+			const vk::raii::CommandBuffer& command_buffer
+		) const noexcept;
+
+		// Runs on `thread_pool`, records a pass into its slot of the secondary recorder
+		[[nodiscard]]
+		coro::task<std::expected<void, Error>> record_parallel_pass(
+			const Frame& frame,
+			ParallelPass pass
+		) const noexcept;
+
+		// Records all `ParallelPass`es concurrently, to be executed in order by the primary command buffer
+		[[nodiscard]]
+		std::expected<void, Error> record_parallel_passes(const Frame& frame) const noexcept;
+
+		// Runs on the async compute queue after the frame, exposure is consumed by the next frame
+		[[nodiscard]]
+		std::expected<void, Error> record_auto_exposure(const Frame& frame) const noexcept;
 
 		[[nodiscard]]
 		std::expected<void, Error> render_composite(const Frame& frame) noexcept;
@@ -170,6 +627,10 @@ namespace page
 
 		/*===== Present =====*/
 
+		// Runs right before submit, applies the mouse motion arriving during recording to the camera buffer
+		[[nodiscard]]
+		std::expected<void, Error> late_latch_camera(const Frame& frame) noexcept;
+
 		[[nodiscard]]
 		std::expected<void, Error> present_frame(const Frame& frame) noexcept;
 
@@ -178,24 +639,46 @@ namespace page
 		explicit RenderPage(
 			std::shared_ptr<resource::Context> context,
 			vk::raii::CommandPool command_pool,
+			vk::raii::CommandPool compute_command_pool,
 			render::MaterialLayout material_layout,
 			render::Model model,
 			render::Tlas tlas,
+			std::optional<render::TextureStreamer> texture_streamer,
+			std::optional<render::GeometryStreamer> geometry_streamer,
 			resource::Pipeline pipeline,
+			vulkan::GpuProfiler gpu_profiler,
 			vulkan::Cycle<FrameResource> frame_resources,
 			std::vector<vk::raii::Semaphore> render_complete_semaphores,
-			resource::AuxResource aux_resource
+			vulkan::ReadbackRing readback_ring,
+			resource::AuxResource aux_resource,
+			render::GiProbeVolume gi_probe_volume,
+			render::EnvironmentLighting environment_lighting,
+			Argument argument,
+			logic::Preset preset
 		) :
 			context(std::move(context)),
 			command_pool(std::move(command_pool)),
+			compute_command_pool(std::move(compute_command_pool)),
 			material_layout(std::move(material_layout)),
 			model(std::move(model)),
 			tlas(std::move(tlas)),
+			texture_streamer(std::move(texture_streamer)),
+			geometry_streamer(std::move(geometry_streamer)),
+			argument(std::move(argument)),
 			pipeline(std::move(pipeline)),
+			gpu_profiler(std::move(gpu_profiler)),
 			frame_resources(std::move(frame_resources)),
 			render_complete_semaphores(std::move(render_complete_semaphores)),
-			aux_resource(std::move(aux_resource))
-		{}
+			readback_ring(std::move(readback_ring)),
+			aux_resource(std::move(aux_resource)),
+			gi_probe_volume(std::move(gi_probe_volume)),
+			environment_lighting(std::move(environment_lighting)),
+			thread_pool(helper::create_thread_pool(this->argument.get_pool_config(preset.pool_config))),
+			preset(preset),
+			model_swap(this->argument.model_path)
+		{
+			this->preset.apply(param);
+		}
 
 	  public:
 
@@ -17,6 +17,8 @@ namespace resource
 	{
 		vulkan::Image exposure_mask;             // Exposure mask
 		vk::raii::ImageView exposure_mask_view;  // Image view of exposure mask
+		vulkan::Image blue_noise;                // Blue noise, see `image::get_blue_noise`
+		vk::raii::ImageView blue_noise_view;     // Image view of blue noise
 
 		///
 		/// @brief Create auxiliary resource
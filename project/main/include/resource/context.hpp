@@ -23,9 +23,10 @@ namespace resource
 		///
 		/// @brief Create vulkan contexts
 		///
+		/// @param mesh_shader Enable the mesh shader feature, failing on devices without it
 		/// @return Created context or error
 		///
 		[[nodiscard]]
-		static std::expected<Context, Error> create() noexcept;
+		static std::expected<Context, Error> create(bool mesh_shader = false) noexcept;
 	};
 }
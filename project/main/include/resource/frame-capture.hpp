@@ -0,0 +1,190 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace resource
+{
+	///
+	/// @brief Capture sink streaming composited frames into the stdin of an external encoder process
+	/// @details
+	/// - Frames are composited a second time into a capture target of the swapchain format, without the UI,
+	/// and copied into one of the persistently mapped readback buffers
+	/// - `begin_frame` hands the buffers of the frame that completed on the GPU to a writer thread, which
+	/// writes them to the encoder as raw video straight from the mapped memory
+	/// - A frame finding no free buffer, i.e. the encoder falling behind by more than the queued frames, is
+	/// dropped from the capture. Rendering never waits for the encoder.
+	///
+	/// The command is run by the shell, with `{width}`, `{height}` and `{format}` replaced by the extent and
+	/// the FFmpeg pixel format of the frames, e.g.
+	/// ```
+	/// ffmpeg -f rawvideo -pix_fmt {format} -s {width}x{height} -r 60 -i - -c:v hevc_nvenc out.mp4
+	/// ```
+	///
+	class FrameCapture
+	{
+	  public:
+
+		///
+		/// @brief Statistics of a capture
+		///
+		struct Stat
+		{
+			uint64_t written_frames;  // Frames written to the encoder
+			uint64_t dropped_frames;  // Frames rendered but not captured
+			bool failed;              // Writing to the encoder failed, e.g. the process exited
+		};
+
+		///
+		/// @brief Create a capture, launching the encoder process
+		///
+		/// @param context Vulkan context
+		/// @param command Encoder command, see class description for the placeholders
+		/// @param extent Extent of the captured frames, frames of other extents are dropped
+		/// @param format Format of the capture target, the format of the composite pipeline
+		/// @param frame_count Number of frames in flight
+		/// @param queue_count Number of readback buffers beyond @p frame_count
+		/// @return Created capture or error
+		///
+		[[nodiscard]]
+		static std::expected<FrameCapture, Error> create(
+			const vulkan::Context& context,
+			std::string_view command,
+			glm::u32vec2 extent,
+			vk::Format format,
+			uint32_t frame_count,
+			uint32_t queue_count
+		) noexcept;
+
+		///
+		/// @brief Advance to the next frame in flight, handing its captured frame to the writer thread
+		/// @warning The frame last recorded with the same frame in flight, @p frame_count frames ago, must
+		/// have completed on the GPU. E.g. call right after waiting for its fence
+		///
+		/// @return Void, or error if invalidating the readback buffer failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> begin_frame() noexcept;
+
+		///
+		/// @brief Begin capturing the current frame, beginning dynamic rendering over the capture target
+		/// @details If `true` is returned, record the composite into the capture target, then call
+		/// `end_capture`. Nothing is recorded if `false` is returned, the frame is dropped.
+		///
+		/// @param command_buffer Command buffer of the frame
+		/// @param extent Extent of the frame
+		/// @return Whether the frame is captured
+		///
+		[[nodiscard]]
+		bool begin_capture(const vk::raii::CommandBuffer& command_buffer, glm::u32vec2 extent) noexcept;
+
+		///
+		/// @brief End capturing the current frame, recording the copy into its readback buffer
+		///
+		/// @param command_buffer Command buffer of the frame
+		///
+		void end_capture(const vk::raii::CommandBuffer& command_buffer) noexcept;
+
+		///
+		/// @brief Hand every captured frame to the writer thread, e.g. before quitting
+		/// @warning The device must be idle
+		///
+		/// @return Void, or error if invalidating the readback buffers failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> flush() noexcept;
+
+		///
+		/// @brief Get the statistics of the capture
+		///
+		[[nodiscard]]
+		Stat get_stat() const noexcept;
+
+	  private:
+
+		enum class SlotState
+		{
+			Free,
+			Recorded,  // Copy recorded by a frame in flight
+			Writing    // Queued or being written by the writer thread
+		};
+
+		struct PipeCloser
+		{
+			void operator()(std::FILE* pipe) const noexcept;
+		};
+
+		// Shared with the writer thread, heap allocated to stay in place when the capture is moved
+		struct Shared
+		{
+			std::vector<vulkan::Buffer> buffers;
+			std::unique_ptr<std::FILE, PipeCloser> pipe;
+			size_t frame_size;
+
+			std::mutex mutex;
+			std::condition_variable_any condition;
+			std::vector<SlotState> states;  // Indexed as `buffers`
+			std::deque<size_t> queue;       // Slots to write, in capture order
+			uint64_t written_frames = 0;
+			bool failed = false;
+		};
+
+		std::unique_ptr<Shared> shared;
+		vulkan::Attachment target;
+		glm::u32vec2 extent;
+
+		std::vector<std::optional<size_t>> frame_slots;  // Slot recorded by each frame in flight, if any
+		size_t current_frame = 0;
+		std::optional<size_t> capturing_slot = std::nullopt;  // Between `begin_capture` and `end_capture`
+		uint64_t dropped_frames = 0;
+
+		std::jthread writer;  // Declared last to join first
+
+		static void write_loop(std::stop_token stop_token, Shared& shared) noexcept;
+
+		[[nodiscard]]
+		std::expected<void, Error> submit_slot(size_t slot) noexcept;
+
+		explicit FrameCapture(
+			std::unique_ptr<Shared> shared,
+			vulkan::Attachment target,
+			glm::u32vec2 extent,
+			uint32_t frame_count
+		) :
+			shared(std::move(shared)),
+			target(std::move(target)),
+			extent(extent),
+			frame_slots(frame_count, std::nullopt),
+			writer(write_loop, std::ref(*this->shared))
+		{}
+
+	  public:
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture(FrameCapture&&) = default;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		// Assigning would free the shared state of the assigned capture while its writer is running
+		FrameCapture& operator=(FrameCapture&&) = delete;
+	};
+}
@@ -5,15 +5,47 @@
 #include "render-resource.hpp"
 #include "render/model/material.hpp"
 #include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/pipeline/ambient-occlusion.hpp"
+#include "render/pipeline/atmosphere.hpp"
 #include "render/pipeline/auto-exposure.hpp"
+#include "render/pipeline/bloom.hpp"
+#include "render/pipeline/cascade-shadow.hpp"
 #include "render/pipeline/composite.hpp"
+#include "render/pipeline/contact-shadow.hpp"
+#include "render/pipeline/deferred-meshlet.hpp"
 #include "render/pipeline/deferred.hpp"
+#include "render/pipeline/deform.hpp"
+#include "render/pipeline/denoise.hpp"
 #include "render/pipeline/direct.hpp"
+#include "render/pipeline/gi-probe.hpp"
+#include "render/pipeline/hiz.hpp"
+#include "render/pipeline/impostor.hpp"
 #include "render/pipeline/indirect.hpp"
+#include "render/pipeline/light-cluster.hpp"
+#include "render/pipeline/object-pick.hpp"
+#include "render/pipeline/overlay.hpp"
+#include "render/pipeline/path-trace.hpp"
+#include "render/pipeline/reflection.hpp"
+#include "render/pipeline/restir.hpp"
+#include "render/pipeline/shading-rate.hpp"
+#include "render/pipeline/shadow.hpp"
+#include "render/pipeline/spatial-upscale.hpp"
+#include "render/pipeline/taa.hpp"
+#include "render/pipeline/transform.hpp"
+#include "render/pipeline/transparent.hpp"
+#include "render/pipeline/visibility.hpp"
+#include "render/resource/cascade-shadow.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/path-trace.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <coro/thread_pool.hpp>
 #include <cstdint>
 #include <expected>
+#include <optional>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
@@ -26,25 +58,71 @@ namespace resource
 	///
 	struct Pipeline
 	{
+		///
+		/// @brief Technique filling the G-buffer, picked at startup
+		///
+		enum class GBufferPath
+		{
+			Raster,      // Indirect vertex pipeline, see `render::DeferredPipeline`
+			Meshlet,     // Task and mesh shaders culling per meshlet, requires mesh shaders
+			Visibility,  // Visibility buffer shaded once per pixel, see `render::VisibilityPipeline`
+		};
+
+		render::TransformPipeline transform;
+		render::DeformPipeline deform;  // Poses the deformable meshes of animated models
+		render::ShadingRatePipeline shading_rate;
 		render::IndirectPipeline indirect;
 		render::DeferredPipeline deferred;
+		render::ImpostorPipeline impostor;
+		render::ObjectPickPipeline object_pick;
+		render::HizPipeline hiz;
+		render::LightClusterPipeline light_cluster;
+		render::ShadowPipeline shadow;
+		render::CascadeShadowPipeline cascade_shadow;  // Rasterized in place of `shadow` when enabled
+		render::ContactShadowPipeline contact_shadow;
+		render::AmbientOcclusionPipeline ambient_occlusion;
+		render::GiProbePipeline gi_probe;
+		render::AtmospherePipeline atmosphere;
 		render::DirectLightingPipeline direct_lighting;
+		render::RestirPipeline restir;  // Shades the punctual lights in place of the light cluster
+		render::ReflectionPipeline reflection;
+		render::DenoisePipeline denoise;
+		render::TransparentPipeline transparent;
+		render::PathTracePipeline path_trace;
 		render::AutoExposurePipeline auto_exposure;
+		render::TaaPipeline taa;
+		render::SpatialUpscalePipeline spatial_upscale;
+		render::BloomPipeline bloom;
 		render::CompositePipeline composite;
+		render::OverlayPipeline overlay;
+
+		// Only created with `GBufferPath::Meshlet`, replacing `deferred` in the G-buffer passes
+		std::optional<render::MeshletDeferredPipeline> meshlet_deferred = std::nullopt;
+
+		// Only created with `GBufferPath::Visibility`, replacing `deferred` in the G-buffer passes
+		std::optional<render::VisibilityPipeline> visibility = std::nullopt;
 
 		///
-		/// @brief Create pipelines
+		/// @brief Create pipelines, in parallel on the thread pool
 		///
+		/// @param thread_pool Thread pool to create pipelines on
 		/// @param context Vulkan context
 		/// @param material_layout Material layout from model
+		/// @param vertex_format Vertex format of the model
 		/// @param composite_format Format of output attachment
+		/// @param hdr_format Format of the HDR attachments, see `render::HdrAttachment::format`
+		/// @param gbuffer_path Technique filling the G-buffer, the device must enable its features
 		/// @return Created pipelines or error
 		///
 		[[nodiscard]]
 		static std::expected<Pipeline, Error> create(
+			coro::thread_pool& thread_pool,
 			const vulkan::Context& context,
 			const render::MaterialLayout& material_layout,
-			vk::Format composite_format
+			render::VertexFormat vertex_format,
+			vk::Format composite_format,
+			vk::Format hdr_format = render::HdrAttachment::HDR_FORMAT,
+			GBufferPath gbuffer_path = GBufferPath::Raster
 		) noexcept;
 
 		///
@@ -66,28 +144,65 @@ namespace resource
 	///
 	struct ResourceSet
 	{
+		render::TransformPipeline::ResourceSet transform;
+		render::DeformPipeline::ResourceSet deform;  // Bound once the deform resource is first updated
+		render::ShadingRatePipeline::ResourceSet shading_rate;
 		render::IndirectPipeline::ResourceSet indirect;
+		render::IndirectPipeline::ResourceSet blended_indirect;  // Culls the blended bucket
 		render::DeferredPipeline::ResourceSet deferred;
+		render::ImpostorPipeline::ResourceSet impostor;
+		render::ObjectPickPipeline::ResourceSet object_pick;
+		render::HizPipeline::ResourceSet hiz;
+		render::LightClusterPipeline::ResourceSet light_cluster;
+		render::ShadowPipeline::ResourceSet shadow;
+		render::CascadeShadowPipeline::ResourceSet cascade_shadow;
+		render::ContactShadowPipeline::ResourceSet contact_shadow;
+		render::AmbientOcclusionPipeline::ResourceSet ambient_occlusion;
+		render::GiProbePipeline::ResourceSet gi_probe;
 		render::DirectLightingPipeline::ResourceSet direct_lighting;
+		render::RestirPipeline::ResourceSet restir;  // Bound once the ReSTIR attachments are allocated
+		render::ReflectionPipeline::ResourceSet reflection;
+		render::DenoisePipeline::ResourceSet reflection_denoise;  // Denoises the reflection signal
+		render::TransparentPipeline::ResourceSet transparent;
+		render::PathTracePipeline::ResourceSet path_trace;
 		render::AutoExposurePipeline::ResourceSet auto_exposure;
+		render::TaaPipeline::ResourceSet taa;
+		render::SpatialUpscalePipeline::ResourceSet spatial_upscale;
+		render::BloomPipeline::ResourceSet bloom;
 		render::CompositePipeline::ResourceSet composite;
+		render::OverlayPipeline::ResourceSet overlay;  // Updated by the render page, which owns the layer
+
+		// Only exists with the matching optional pipeline of `Pipeline`
+		std::optional<render::MeshletDeferredPipeline::ResourceSet> meshlet_deferred = std::nullopt;
+		std::optional<render::VisibilityPipeline::ResourceSet> visibility = std::nullopt;
 
 		///
 		/// @brief Update the resource sets
 		///
 		/// @param context Vulkan context
 		/// @param model Model instance
+		/// @param tlas TLAS of the model
 		/// @param curr_resource Render resource of current frame
 		/// @param prev_resource Render resource of previous frame
 		/// @param aux_resource Auxiliary resource
-		/// @param swapchain_frame Swapchain frame of current frame
+		/// @param gi_probe_volume Probe volume of the global illumination, shared by all frames
+		/// @param environment_lighting Precomputed environment lighting, shared by all frames
+		/// @param atmosphere LUTs of the atmosphere, shared by all frames
+		/// @param path_trace_accumulation Accumulation of the path tracer, `std::nullopt` if disabled
+		/// @param shadow_map Cascaded shadow map, `std::nullopt` if disabled
 		///
 		void update(
 			const vulkan::Context& context,
 			const render::Model& model,
+			const render::Tlas& tlas,
 			const resource::RenderResource& curr_resource,
 			const resource::RenderResource& prev_resource,
-			const resource::AuxResource& aux_resource
+			const resource::AuxResource& aux_resource,
+			const render::GiProbeVolume& gi_probe_volume,
+			const render::EnvironmentLighting& environment_lighting,
+			render::AtmospherePipeline::LutView atmosphere,
+			std::optional<render::PathTraceAttachment::View> path_trace_accumulation,
+			std::optional<render::CascadeShadowAttachment::View> shadow_map
 		) noexcept;
 	};
 }
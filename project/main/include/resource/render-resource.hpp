@@ -3,16 +3,39 @@
 #include "common/util/error.hpp"
 #include "render/interface/auto-exposure.hpp"
 #include "render/interface/camera.hpp"
+#include "render/interface/cull-view.hpp"
 #include "render/interface/direct-light.hpp"
-#include "render/interface/primitive-drawcall.hpp"
+#include "render/interface/node-transform.hpp"
+#include "render/model/deform-list.hpp"
+#include "render/resource/ambient-occlusion.hpp"
 #include "render/resource/auto-exposure.hpp"
+#include "render/resource/bloom.hpp"
 #include "render/resource/deferred.hpp"
+#include "render/resource/deform.hpp"
+#include "render/resource/denoise.hpp"
+#include "render/resource/feedback.hpp"
 #include "render/resource/hdr.hpp"
+#include "render/resource/hiz.hpp"
 #include "render/resource/host.hpp"
 #include "render/resource/indirect.hpp"
+#include "render/resource/light-cluster.hpp"
+#include "render/resource/luminance-pyramid.hpp"
+#include "render/resource/object-pick.hpp"
+#include "render/resource/reflection.hpp"
+#include "render/resource/restir.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "render/resource/shadow.hpp"
+#include "render/resource/taa.hpp"
+#include "render/resource/transform.hpp"
+#include "render/resource/transparent.hpp"
+#include "render/resource/visibility.hpp"
 #include "render/util/per-render-state.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/vector_uint2_sized.hpp>
@@ -27,11 +50,33 @@ namespace resource
 	///
 	struct RenderData
 	{
-		// Drawcalls for different render modes
-		render::PerRenderState<std::span<const render::PrimitiveDrawcall>> drawcalls;
+		// Drawcall counts for different render modes, see `render::SceneGraph::drawcall_counts()`
+		render::PerRenderState<size_t> drawcall_counts;
 
-		// Transform matrices for all nodes
-		std::span<const glm::mat4> transforms;
+		// Drawcall counts of the blended bucket, see `render::SceneGraph::Bucket::Blended`
+		render::PerRenderState<size_t> blended_drawcall_counts;
+
+		// Total node count of the hierarchy
+		size_t node_count;
+
+		// Primitive count of the model, drawcalls of the same primitive are drawn as instances
+		size_t primitive_count;
+
+		// Material count of the model, excluding the default material
+		size_t material_count;
+
+		// Dirty local transforms of this frame
+		std::span<const render::NodeTransformUpdate> transform_updates;
+
+		// Pose of the deformable meshes in this frame, see `render::DeformList::compute_parameters`.
+		// `std::nullopt` if no mesh is deformed
+		std::optional<render::DeformList::Parameters> deform_parameters = std::nullopt;
+
+		// Views culled along with the camera, see `render::IndirectResource::upload_views`
+		std::span<const render::CullView> cull_views = {};
+
+		// Transform applied to the root node
+		glm::mat4 root_transform;
 
 		render::Camera camera;                 // Camera parameters
 		render::DirectLight primary_light;     // Primary light parameters
@@ -44,15 +89,53 @@ namespace resource
 	///
 	struct RenderResource
 	{
+		// Initial capacity of the upload ring, grows to the peak per-frame upload size
+		static constexpr size_t UPLOAD_RING_CAPACITY = 64 * 1024;
+
+		// Render attachments are allocated larger than the render extent by this factor, so that the window
+		// or the render scale can grow within the margin without reallocation
+		static constexpr float ATTACHMENT_GROWTH_FACTOR = 1.25f;
+
+		// Render attachments are shrunk once the render extent covers less than this fraction of their area
+		// for `ATTACHMENT_SHRINK_FRAMES` consecutive frames of this resource, see `trim_attachments`
+		static constexpr float ATTACHMENT_SHRINK_THRESHOLD = 0.5f;
+		static constexpr uint32_t ATTACHMENT_SHRINK_FRAMES = 120;
+
+		vulkan::UploadRing upload_ring;
 		render::HostParamResource param;
-		render::HostDrawcallResource drawcall;
+		render::TransformResource transform;
+		render::DeformResource deform;  // Written only by the frames deforming the meshes
 		render::IndirectResource indirect;
+		render::IndirectResource blended_indirect;  // Culled drawcalls of the blended bucket
 		render::AutoExposureResource auto_exposure;
+		render::TextureFeedbackResource feedback;
+		render::GeometryFeedbackResource geometry_feedback;
+		render::ObjectPickResource object_pick;  // Written only by the frames picking an object
 
 		struct Attachments
 		{
 			render::DeferredAttachment deferred;
 			render::HdrAttachment hdr;
+			render::HizAttachment hiz;
+			render::LuminancePyramidAttachment luminance_pyramid;
+			render::ShadowMaskAttachment shadow_mask;
+			render::AmbientOcclusionAttachment ambient_occlusion;
+			render::LightClusterAttachment light_cluster;
+			render::ShadingRateAttachment shading_rate;
+			render::TransparentAttachment transparent;
+			render::ReflectionAttachment reflection;
+			render::DenoiseAttachment reflection_denoise;  // Denoised `reflection`, history of the next frame
+			render::TaaAttachment taa;
+			render::BloomAttachment bloom;  // Built from `taa`, shares its extent
+
+			// Only allocated for `render::VisibilityPipeline`, at the render extent
+			std::optional<render::VisibilityAttachment> visibility;
+
+			// Only allocated while ReSTIR is enabled, at the render extent
+			std::optional<render::RestirAttachment> restir;
+
+			// Consecutive frames the render extent has stayed below `ATTACHMENT_SHRINK_THRESHOLD`
+			uint32_t undersized_frames = 0;
 		};
 
 		std::optional<Attachments> attachments = std::nullopt;
@@ -67,33 +150,104 @@ namespace resource
 		static std::expected<RenderResource, Error> create(const vulkan::Context& context) noexcept;
 
 		///
-		/// @brief Update render resource
+		/// @brief Update render resource, scheduling the host uploads of this frame into the upload ring
+		/// @warning The command buffer previously recorded with this resource must have finished
 		///
 		/// @param context Vulkan context
+		/// @param deletion_queue Deletion queue retiring replaced buffers still read by the next frame
 		/// @param data Render data input
 		/// @return `void` if success, or error
 		///
 		[[nodiscard]]
-		std::expected<void, Error> update(const vulkan::Context& context, const RenderData& data) noexcept;
+		std::expected<void, Error> update(
+			const vulkan::Context& context,
+			vulkan::DeletionQueue& deletion_queue,
+			const RenderData& data
+		) noexcept;
 
 		///
 		/// @brief Resize the attachments
+		/// @details The TAA attachment is always recreated at @p extent. The other attachments are only
+		/// recreated if @p render_extent exceeds their capacity, see @p resize_render_attachments
 		///
 		/// @param context Vulkan context
-		/// @param extent Swapchain extent
+		/// @param deletion_queue Deletion queue retiring the old attachments, which may still be used by
+		/// frames in flight
+		/// @param extent Swapchain extent, extent of the TAA attachment
+		/// @param render_extent Render extent, extent in use of the other attachments
+		/// @param half_resolution_shadow Whether to trace the shadow mask at half resolution
+		/// @param ambient_occlusion_resolution Resolution to trace the ambient occlusion at
+		/// @param hdr_format Format of the HDR attachment, see `render::HdrAttachment::format`
+		/// @param visibility_buffer Whether to allocate the visibility attachment
+		/// @param restir Whether to allocate the ReSTIR attachment
 		/// @return `void` if success, or error
 		///
 		[[nodiscard]]
 		std::expected<void, Error> resize_attachments(
 			const vulkan::Context& context,
-			glm::u32vec2 extent
+			vulkan::DeletionQueue& deletion_queue,
+			glm::u32vec2 extent,
+			glm::u32vec2 render_extent,
+			bool half_resolution_shadow,
+			render::AmbientOcclusionAttachment::Resolution ambient_occlusion_resolution,
+			vk::Format hdr_format = render::HdrAttachment::HDR_FORMAT,
+			bool visibility_buffer = false,
+			bool restir = false
+		) noexcept;
+
+		///
+		/// @brief Resize the attachments rendered at the render extent, keeping the TAA attachment and its
+		/// content
+		/// @details Attachments are only recreated if @p render_extent exceeds their capacity, at
+		/// `ATTACHMENT_GROWTH_FACTOR` times @p render_extent. Otherwise only the top-left @p render_extent
+		/// sub-rectangle is used from then on.
+		/// @note Attachments must have been created with @p resize_attachments
+		///
+		/// @param context Vulkan context
+		/// @param deletion_queue Deletion queue retiring the old attachments
+		/// @param render_extent Render extent
+		/// @param half_resolution_shadow Whether to trace the shadow mask at half resolution
+		/// @param ambient_occlusion_resolution Resolution to trace the ambient occlusion at
+		/// @param hdr_format Format of the HDR attachment, see `render::HdrAttachment::format`
+		/// @param visibility_buffer Whether to allocate the visibility attachment
+		/// @param restir Whether to allocate the ReSTIR attachment
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> resize_render_attachments(
+			const vulkan::Context& context,
+			vulkan::DeletionQueue& deletion_queue,
+			glm::u32vec2 render_extent,
+			bool half_resolution_shadow,
+			render::AmbientOcclusionAttachment::Resolution ambient_occlusion_resolution,
+			vk::Format hdr_format = render::HdrAttachment::HDR_FORMAT,
+			bool visibility_buffer = false,
+			bool restir = false
+		) noexcept;
+
+		///
+		/// @brief Shrink the attachments rendered at the render extent once they have been oversized for a
+		/// while
+		/// @details Called once per frame of this resource. Attachments are recreated at
+		/// `ATTACHMENT_GROWTH_FACTOR` times the render extent in use once it has covered less than
+		/// `ATTACHMENT_SHRINK_THRESHOLD` of their area for `ATTACHMENT_SHRINK_FRAMES` consecutive calls.
+		///
+		/// @param context Vulkan context
+		/// @param deletion_queue Deletion queue retiring the old attachments
+		/// @return Whether the attachments were recreated, discarding their content, or error
+		///
+		[[nodiscard]]
+		std::expected<bool, Error> trim_attachments(
+			const vulkan::Context& context,
+			vulkan::DeletionQueue& deletion_queue
 		) noexcept;
 
 		///
-		/// @brief Record upload and barrier commands
+		/// @brief Record the upload commands and a single barrier covering all of them, after the copy of the
+		/// late-latched camera, see `render::HostParamResource::latch_camera`
 		///
 		/// @param command_buffer Command buffer
 		///
-		void upload(const vk::raii::CommandBuffer& command_buffer) const noexcept;
+		void upload(const vk::raii::CommandBuffer& command_buffer) noexcept;
 	};
 }
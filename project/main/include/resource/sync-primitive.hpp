@@ -3,6 +3,7 @@
 #include "common/util/error.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <vulkan/vulkan_core.h>
 #include <vulkan/vulkan_raii.hpp>
@@ -20,6 +21,26 @@ namespace resource
 		// Signaled when last frame has finished present
 		vk::raii::Semaphore image_available_semaphore;
 
+		// Timeline of the frames using this primitive, see `render_value()` and `exposure_value()`
+		vk::raii::Semaphore timeline_semaphore;
+
+		// Frames submitted with this primitive, increment before submitting a new frame
+		uint64_t frame_count = 0;
+
+		///
+		/// @brief Timeline value signaled when the main queue finishes rendering the latest frame
+		/// @note Only valid after a frame has been submitted
+		///
+		[[nodiscard]]
+		uint64_t render_value() const noexcept { return frame_count * 2 - 1; }
+
+		///
+		/// @brief Timeline value signaled when the compute queue finishes auto-exposure of the latest frame
+		/// @note Zero if no frame has been submitted, which never blocks a wait
+		///
+		[[nodiscard]]
+		uint64_t exposure_value() const noexcept { return frame_count * 2; }
+
 		///
 		/// @brief Create a set of  sync primitive
 		///
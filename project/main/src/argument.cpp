@@ -1,10 +1,16 @@
 #include "argument.hpp"
+#include "common/util/cpu.hpp"
 #include "common/util/error.hpp"
+#include "resource/pipeline.hpp"
+#include "vulkan/context/capability.hpp"
 
 #include <argparse/argparse.hpp>
+#include <cstdint>
 #include <exception>
 #include <expected>
+#include <optional>
 #include <span>
+#include <string>
 
 std::expected<Argument, Error> Argument::parse(std::span<const char*> arguments) noexcept
 {
@@ -12,9 +18,93 @@ std::expected<Argument, Error> Argument::parse(std::span<const char*> arguments)
 
 	argparse::ArgumentParser parser("main");
 	parser.add_argument("model")
-		.help("Path to the model to render")
+		.help("Path or HTTP URL of the model to render")
 		.required()
 		.store_into(argument.model_path);
+	parser.add_argument("--stream-textures")
+		.help("Stream full-resolution textures while rendering, instead of loading them up front")
+		.flag()
+		.store_into(argument.stream_textures);
+	parser.add_argument("--stream-geometry")
+		.help("Stream full-detail geometry while rendering, keeping only coarse geometry resident up front")
+		.flag()
+		.store_into(argument.stream_geometry);
+	parser.add_argument("--merge-static")
+		.help("Merge small static meshes sharing a material, reducing drawcalls for small-mesh-heavy scenes")
+		.flag()
+		.store_into(argument.merge_static);
+	parser.add_argument("--hlod")
+		.help("Build simplified proxies for clusters of static meshes, drawn in their place when far away")
+		.flag()
+		.store_into(argument.hlod);
+	parser.add_argument("--impostor")
+		.help("Bake impostors of meshes instanced many times, drawn as camera-facing quads when far away")
+		.flag()
+		.store_into(argument.impostor);
+	parser.add_argument("--animate")
+		.help("Play the animations of the model, skinning and morphing its meshes on GPU. Bypasses the model "
+			  "cache")
+		.flag()
+		.store_into(argument.animate);
+	parser.add_argument("--fast-build-blas")
+		.help("Build BLASes quickly to show the first frame sooner, then rebuild them for fast trace")
+		.flag()
+		.store_into(argument.fast_build_blas);
+	parser.add_argument("--load-trace")
+		.help("Write a Chrome trace (chrome://tracing, Perfetto) of the model loading to the given path")
+		.metavar("PATH")
+		.action([&argument](const std::string& value) { argument.load_trace_path = value; });
+	parser.add_argument("--environment")
+		.help("Light the scene by the given equirectangular HDR environment map (.hdr)")
+		.metavar("PATH")
+		.action([&argument](const std::string& value) { argument.environment_path = value; });
+	parser.add_argument("--gbuffer")
+		.help("Fill the G-buffer by the raster pipeline, by mesh shaders culling each meshlet, or by "
+			  "rasterizing a visibility buffer shaded once per pixel")
+		.choices("raster", "meshlet", "visibility")
+		.action([&argument](const std::string& value) {
+			using GBufferPath = resource::Pipeline::GBufferPath;
+			if (value == "meshlet")
+				argument.gbuffer_path = GBufferPath::Meshlet;
+			else if (value == "visibility")
+				argument.gbuffer_path = GBufferPath::Visibility;
+		});
+	parser.add_argument("--tier")
+		.help("Use the performance preset of the given device tier, instead of probing the device")
+		.choices("low", "medium", "high")
+		.action([&argument](const std::string& value) {
+			using Tier = vulkan::DeviceCapability::Tier;
+			argument.tier = value == "low" ? Tier::Low : value == "medium" ? Tier::Medium : Tier::High;
+		});
+	parser.add_argument("--capture")
+		.help("Pipe the composited frames, without the UI, as raw video into the given encoder command. "
+			  "{width}, {height} and {format} are replaced by the frame size and FFmpeg pixel format")
+		.metavar("COMMAND")
+		.action([&argument](const std::string& value) { argument.capture_command = value; });
+	parser.add_argument("--capture-input")
+		.help("Record the inputs of every frame, i.e. delta times, camera views and parameter changes, into "
+			  "the given file, for replaying with --replay-input")
+		.metavar("PATH")
+		.action([&argument](const std::string& value) { argument.capture_input_path = value; });
+	parser.add_argument("--replay-input")
+		.help("Replay the inputs recorded by --capture-input, then quit")
+		.metavar("PATH")
+		.action([&argument](const std::string& value) { argument.replay_input_path = value; });
+	parser.add_argument("--worker-threads")
+		.help("Number of worker threads of each thread pool, instead of one per worker core")
+		.metavar("COUNT")
+		.action([&argument](const std::string& value) { argument.worker_threads = std::stoul(value); });
+	parser.add_argument("--thread-affinity")
+		.help("Cores the worker threads run on, \"performance\" keeps them off efficiency cores")
+		.choices("any", "performance")
+		.action([&argument](const std::string& value) {
+			using Affinity = util::cpu::Affinity;
+			argument.thread_affinity = value == "any" ? Affinity::Any : Affinity::Performance;
+		});
+	parser.add_argument("--reserve-render-core")
+		.help("Pin the render thread to a performance core, not shared with the worker threads")
+		.choices("on", "off")
+		.action([&argument](const std::string& value) { argument.reserve_render_core = value == "on"; });
 
 	try
 	{
@@ -25,5 +115,27 @@ std::expected<Argument, Error> Argument::parse(std::span<const char*> arguments)
 		return Error(e.what(), parser.usage());
 	}
 
+	// Geometry is streamed from the model cache, which streamed textures bypass
+	if (argument.stream_textures && argument.stream_geometry)
+		return Error("Invalid arguments", "--stream-textures and --stream-geometry can't be combined");
+
+	// Geometry is streamed from the model cache, which animated models bypass
+	if (argument.animate && argument.stream_geometry)
+		return Error("Invalid arguments", "--animate and --stream-geometry can't be combined");
+
+	if (argument.capture_input_path && argument.replay_input_path)
+		return Error("Invalid arguments", "--capture-input and --replay-input can't be combined");
+
+	if (argument.worker_threads == 0) return Error("Invalid arguments", "--worker-threads must be positive");
+
 	return argument;
 }
+
+util::cpu::PoolConfig Argument::get_pool_config(const util::cpu::PoolConfig& fallback) const noexcept
+{
+	return {
+		.worker_count = worker_threads.has_value() ? worker_threads : fallback.worker_count,
+		.affinity = thread_affinity.value_or(fallback.affinity),
+		.reserve_render_core = reserve_render_core.value_or(fallback.reserve_render_core),
+	};
+}
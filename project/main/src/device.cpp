@@ -1,5 +1,7 @@
 #include "vulkan/context/device.hpp"
 #include "common/util/error.hpp"
+#include "config.hpp"
+#include "helper/startup.hpp"
 #include "resource/context.hpp"
 #include "vulkan/context/imgui.hpp"
 #include "vulkan/context/instance.hpp"
@@ -12,7 +14,7 @@
 
 namespace resource
 {
-	std::expected<Context, Error> Context::create() noexcept
+	std::expected<Context, Error> Context::create(bool mesh_shader) noexcept
 	{
 		const auto window_config = vulkan::WindowConfig{
 			.title = "Vulkan-RT",
@@ -21,17 +23,27 @@ namespace resource
 			.initial_fullscreen = false
 		};
 		const auto instance_config = vulkan::InstanceConfig{};
+
+		auto instance_step = helper::StartupStep("Create instance");
 		auto instance_result = vulkan::SurfaceInstanceContext::create(window_config, instance_config);
 		if (!instance_result) return instance_result.error().forward("Create instance context failed");
 		auto instance = std::move(*instance_result);
+		instance_step.end();
 
 		const auto device_option = vulkan::DeviceFeature{
 			.raytracing = true,
+			.mesh_shader = mesh_shader,
+			.fragment_shading_rate = true,
 		};
-		auto device_result = vulkan::SurfaceDeviceContext::create(instance, device_option);
+		// Includes loading the pipeline cache
+		auto device_step = helper::StartupStep("Create device");
+		auto device_result =
+			vulkan::SurfaceDeviceContext::create(instance, device_option, config::PIPELINE_CACHE_DIRECTORY);
 		if (!device_result) return device_result.error().forward("Create device context failed");
 		auto device = std::move(*device_result);
+		device_step.end();
 
+		auto swapchain_step = helper::StartupStep("Create swapchain");
 		auto swapchain_result = vulkan::SwapchainContext::create(
 			instance,
 			device,
@@ -42,6 +54,7 @@ namespace resource
 		);
 		if (!swapchain_result) return swapchain_result.error().forward("Create swapchain context failed");
 		auto swapchain = std::move(*swapchain_result);
+		swapchain_step.end();
 
 		const auto format = swapchain->surface_format.format;
 		const auto pipeline_rendering_info =
@@ -50,9 +63,11 @@ namespace resource
 			.render_scheme =
 				vulkan::ImGuiContext::Config::DynamicRendering{.rendering_info = pipeline_rendering_info}
 		};
+		auto imgui_step = helper::StartupStep("Create ImGui context");
 		auto imgui_result = vulkan::ImGuiContext::create(instance, device.get(), imgui_config);
 		if (!imgui_result) return imgui_result.error().forward("Create ImGui context failed");
 		auto imgui = std::move(*imgui_result);
+		imgui_step.end();
 
 		return Context{
 			.instance = std::move(instance),
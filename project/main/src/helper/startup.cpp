@@ -0,0 +1,54 @@
+#include "helper/startup.hpp"
+#include "common/util/trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <print>
+
+namespace helper
+{
+	namespace
+	{
+		// Initialized before `main`, close enough to the process start
+		const auto process_start_time = std::chrono::steady_clock::now();
+
+		double get_elapsed_ms(std::chrono::steady_clock::time_point since) noexcept
+		{
+			const auto elapsed = std::chrono::steady_clock::now() - since;
+			return std::chrono::duration<double, std::milli>(elapsed).count();
+		}
+	}
+
+	StartupStep::StartupStep(const char* name) noexcept :
+		name(name),
+		start_time(std::chrono::steady_clock::now())
+	{
+		trace_scope.emplace(name);
+	}
+
+	void StartupStep::end() noexcept
+	{
+		if (!trace_scope.has_value()) return;
+		trace_scope.reset();
+
+		std::println(
+			"[Startup] {}: {:.1f} ms (at {:.1f} ms)",
+			name,
+			get_elapsed_ms(start_time),
+			get_elapsed_ms(process_start_time)
+		);
+	}
+
+	StartupStep::~StartupStep() noexcept
+	{
+		end();
+	}
+
+	void mark_first_frame() noexcept
+	{
+		static auto marked = std::atomic_flag();
+		if (marked.test_and_set(std::memory_order_relaxed)) return;
+
+		std::println("[Startup] Time to first frame: {:.1f} ms", get_elapsed_ms(process_start_time));
+	}
+}
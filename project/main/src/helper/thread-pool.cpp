@@ -0,0 +1,39 @@
+#include "helper/thread-pool.hpp"
+#include "common/util/cpu.hpp"
+
+#include <coro/thread_pool.hpp>
+#include <cstddef>
+#include <memory>
+#include <print>
+#include <span>
+
+namespace helper
+{
+	std::unique_ptr<coro::thread_pool> create_thread_pool(const util::cpu::PoolConfig& config) noexcept
+	{
+		auto layout = util::cpu::plan_pool(util::cpu::query_cores(), config);
+
+		auto options = coro::thread_pool::options{.thread_count = layout.worker_count};
+		if (!layout.worker_cores.empty())
+			options.on_thread_start_functor = [worker_cores = std::move(layout.worker_cores)](size_t) {
+				if (const auto result = util::cpu::set_thread_affinity(worker_cores); !result)
+					std::println("Pin worker thread failed: {:msg}", result.error().root());
+			};
+
+		return coro::thread_pool::make_unique(std::move(options));
+	}
+
+	void pin_render_thread(const util::cpu::PoolConfig& config) noexcept
+	{
+		const auto layout = util::cpu::plan_pool(util::cpu::query_cores(), config);
+		if (!layout.render_core.has_value()) return;
+
+		if (const auto result = util::cpu::set_thread_affinity(std::span(&*layout.render_core, 1)); !result)
+		{
+			std::println("Pin render thread failed: {:msg}", result.error().root());
+			return;
+		}
+
+		std::println("Render thread pinned to core {}", *layout.render_core);
+	}
+}
@@ -0,0 +1,207 @@
+#include "logic/frame-timing.hpp"
+#include "vulkan/util/timestamp-query.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <imgui.h>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+
+namespace logic
+{
+	namespace
+	{
+		constexpr auto METRIC_NAMES =
+			std::to_array<const char*>({"CPU Frame", "GPU Frame", "Fence Wait", "Present Interval"});
+		static_assert(METRIC_NAMES.size() == FrameTiming::METRIC_COUNT);
+
+		// Weight of the newest sample in the moving average of each pass
+		constexpr double PASS_AVERAGE_WEIGHT = 0.05;
+	}
+
+	void FrameTiming::push_fence_wait(double duration_ms) noexcept
+	{
+		current[static_cast<size_t>(Metric::FenceWait)] = static_cast<float>(duration_ms);
+	}
+
+	void FrameTiming::push_gpu(std::span<const vulkan::TimestampQuery::Result> results) noexcept
+	{
+		current_spike = std::nullopt;
+
+		for (const auto& result : results)
+		{
+			if (result.name == "Total")
+			{
+				current[static_cast<size_t>(Metric::Gpu)] = static_cast<float>(result.duration_ms);
+				continue;
+			}
+
+			auto average = std::ranges::find(pass_averages, result.name, &PassAverage::name);
+			if (average == pass_averages.end())
+			{
+				pass_averages.push_back(PassAverage{.name = result.name, .average_ms = result.duration_ms});
+				continue;
+			}
+
+			// Spike is measured against the average before this sample
+			const auto excess = result.duration_ms - average->average_ms;
+			if (!current_spike.has_value() || excess > current_spike->duration_ms - current_spike->average_ms)
+				current_spike = PassSpike{
+					.name = result.name,
+					.duration_ms = result.duration_ms,
+					.average_ms = average->average_ms,
+				};
+
+			average->average_ms += (result.duration_ms - average->average_ms) * PASS_AVERAGE_WEIGHT;
+		}
+	}
+
+	void FrameTiming::end_frame(double cpu_ms, Clock::time_point present_time) noexcept
+	{
+		current[static_cast<size_t>(Metric::Cpu)] = static_cast<float>(cpu_ms);
+		current[static_cast<size_t>(Metric::PresentInterval)] = last_present_time.has_value()
+			? std::chrono::duration<float, std::milli>(present_time - *last_present_time).count()
+			: 0.0f;
+		last_present_time = present_time;
+
+		for (const auto [metric_history, value] : std::views::zip(history, current))
+			metric_history[history_head] = value;
+		history_head = (history_head + 1) % HISTORY_SIZE;
+		history_count = std::min(history_count + 1, HISTORY_SIZE);
+
+		if (std::ranges::any_of(current, [this](float value) { return value > hitch_threshold_ms; }))
+		{
+			hitches.push_back(Hitch{.frame = frame_count, .sample = current, .spike = current_spike});
+			if (hitches.size() > HITCH_LOG_SIZE) hitches.pop_front();
+		}
+
+		update_statistics();
+
+		frame_count++;
+		current = {};
+		current_spike = std::nullopt;
+	}
+
+	void FrameTiming::skip_interval() noexcept
+	{
+		last_present_time = std::nullopt;
+	}
+
+	FrameTiming::Statistics FrameTiming::get_statistics(Metric metric) const noexcept
+	{
+		return statistics[static_cast<size_t>(metric)];
+	}
+
+	void FrameTiming::update_statistics() noexcept
+	{
+		const auto samples = std::span(selection).first(history_count);
+
+		for (const auto [metric_history, stat] : std::views::zip(history, statistics))
+		{
+			std::ranges::copy(std::span(metric_history).first(history_count), samples.begin());
+
+			// Percentiles are selected in increasing order, each selection only reorders the range above the
+			// previous one
+			auto lower = samples.begin();
+			const auto last_index = static_cast<double>(samples.size() - 1);
+			const auto percentile = [&samples, &lower, last_index](double p) {
+				const auto index = static_cast<ptrdiff_t>(std::round(p * last_index));
+				const auto nth = std::next(samples.begin(), index);
+				std::nth_element(lower, nth, samples.end());
+				lower = nth;
+				return static_cast<double>(*nth);
+			};
+
+			stat.p50 = percentile(0.50);
+			stat.p95 = percentile(0.95);
+			stat.p99 = percentile(0.99);
+			stat.max = static_cast<double>(*std::max_element(lower, samples.end()));
+		}
+	}
+
+	void FrameTiming::ui() noexcept
+	{
+		if (ImGui::Begin("Frame Timing"))
+		{
+			constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+			if (ImGui::BeginTable("Metrics", 5, table_flags))
+			{
+				ImGui::TableSetupColumn("Metric");
+				ImGui::TableSetupColumn("P50 (ms)");
+				ImGui::TableSetupColumn("P95");
+				ImGui::TableSetupColumn("P99");
+				ImGui::TableSetupColumn("Max");
+				ImGui::TableHeadersRow();
+
+				for (const auto [metric_idx, name] : std::views::enumerate(METRIC_NAMES))
+				{
+					const auto stat = get_statistics(static_cast<Metric>(metric_idx));
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(name);
+					for (const auto value : {stat.p50, stat.p95, stat.p99, stat.max})
+					{
+						ImGui::TableNextColumn();
+						ImGui::Text("%.3f", value);
+					}
+				}
+
+				ImGui::EndTable();
+			}
+
+			ImGui::Text("Statistics over the last %zu frames", history_count);
+
+			// Oldest sample is at the head once the ring buffer is full
+			const auto& cpu_history = history[static_cast<size_t>(Metric::Cpu)];
+			const auto graph_offset = history_count == HISTORY_SIZE ? history_head : 0;
+			ImGui::PlotLines(
+				"##CPU Frame",
+				cpu_history.data(),
+				static_cast<int>(history_count),
+				static_cast<int>(graph_offset),
+				"CPU Frame (ms)",
+				0.0f,
+				hitch_threshold_ms * 1.5f,
+				ImVec2(0, 80)
+			);
+
+			ImGui::SeparatorText("Hitches");
+
+			ImGui::SliderFloat("Threshold (ms)", &hitch_threshold_ms, 4.0f, 100.0f, "%.1f");
+			ImGui::SameLine();
+			if (ImGui::Button("Clear")) hitches.clear();
+
+			if (ImGui::BeginChild("Hitch Log", ImVec2(0, 160), ImGuiChildFlags_Borders))
+			{
+				for (const auto& hitch : hitches | std::views::reverse)
+				{
+					ImGui::Text(
+						"#%llu: CPU %.2f, GPU %.2f, fence %.2f, interval %.2f ms",
+						static_cast<unsigned long long>(hitch.frame),
+						hitch.sample[static_cast<size_t>(Metric::Cpu)],
+						hitch.sample[static_cast<size_t>(Metric::Gpu)],
+						hitch.sample[static_cast<size_t>(Metric::FenceWait)],
+						hitch.sample[static_cast<size_t>(Metric::PresentInterval)]
+					);
+
+					if (hitch.spike.has_value())
+						ImGui::TextDisabled(
+							"    %s: %.2f ms (avg %.2f ms)",
+							hitch.spike->name.c_str(),
+							hitch.spike->duration_ms,
+							hitch.spike->average_ms
+						);
+				}
+			}
+			ImGui::EndChild();
+		}
+		ImGui::End();
+	}
+}
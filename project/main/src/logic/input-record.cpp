@@ -0,0 +1,407 @@
+#include "logic/input-record.hpp"
+#include "common/file.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "logic/param.hpp"
+#include "scene/camera.hpp"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <ios>
+#include <libassert/assert.hpp>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * File layout, all integers in native endianness:
+ *
+ * - `Header` at offset 0
+ * - For each frame, a `uint32_t` size followed by the MessagePack encoding of `InputFrame::to_json`
+ */
+
+namespace logic
+{
+	namespace
+	{
+		constexpr auto MAGIC = std::to_array<char>({'V', 'R', 'T', 'I', 'N', 'P', 'U', 'T'});
+		constexpr uint32_t VERSION = 1;
+
+		struct Header
+		{
+			std::array<char, 8> magic;
+			uint32_t version;
+			uint32_t reserved;
+		};
+	}
+
+	// Single list of the recorded parameters, shared by recording and applying
+	template <typename P, typename F>
+	static void visit_recorded_params(P& param, const F& visit) noexcept
+	{
+		visit("light_yaw_deg", param.primary_light.light_yaw_deg);
+		visit("light_pitch_deg", param.primary_light.light_pitch_deg);
+		visit("light_color", param.primary_light.light_color);
+		visit("light_intensity", param.primary_light.light_intensity);
+		visit("atmosphere", param.primary_light.atmosphere);
+
+		visit("exposure_adaptation_rate", param.exposure.adaptation_rate);
+		visit("exposure_ev", param.exposure.exposure_ev);
+
+		visit("bloom_enabled", param.bloom.enabled);
+		visit("bloom_intensity", param.bloom.intensity);
+
+		visit("fov_degrees", param.camera.projection.fov_degrees);
+		visit("near", param.camera.projection.near);
+		visit("smooth_factor", param.camera.smooth_factor);
+
+		visit("resolution_mode", param.resolution.mode);
+		visit("upscaler", param.resolution.upscaler);
+		visit("target_frame_ms", param.resolution.target_frame_ms);
+		visit("min_scale", param.resolution.min_scale);
+		visit("fixed_scale", param.resolution.fixed_scale);
+		visit("sharpness", param.resolution.sharpness);
+
+		visit("depth_prepass", param.geometry.depth_prepass);
+		visit("depth_sort", param.geometry.depth_sort);
+
+		visit("animation_playing", param.animation.playing);
+		visit("animation_index", param.animation.animation_index);
+		visit("animation_speed", param.animation.speed);
+
+		visit("contact_shadow_enabled", param.contact_shadow.enabled);
+		visit("contact_shadow_step_count", param.contact_shadow.step_count);
+		visit("contact_shadow_max_distance", param.contact_shadow.max_distance);
+		visit("contact_shadow_thickness", param.contact_shadow.thickness);
+
+		visit("shadow_map_enabled", param.shadow_map.enabled);
+		visit("shadow_map_cascade_count", param.shadow_map.cascade_count);
+		visit("shadow_map_resolution_index", param.shadow_map.resolution_index);
+		visit("shadow_map_shadow_distance", param.shadow_map.shadow_distance);
+		visit("shadow_map_split_lambda", param.shadow_map.split_lambda);
+		visit("shadow_map_cached", param.shadow_map.cached);
+
+		visit("ao_enabled", param.ambient_occlusion.enabled);
+		visit("ao_ray_budget_mrays", param.ambient_occlusion.ray_budget_mrays);
+		visit("ao_max_rays_per_pixel", param.ambient_occlusion.max_rays_per_pixel);
+		visit("ao_radius", param.ambient_occlusion.radius);
+
+		visit("gi_enabled", param.global_illumination.enabled);
+		visit("gi_ray_budget_mrays", param.global_illumination.ray_budget_mrays);
+		visit("gi_rays_per_probe", param.global_illumination.rays_per_probe);
+		visit("gi_hysteresis", param.global_illumination.hysteresis);
+		visit("gi_bake", param.global_illumination.bake);
+		visit("gi_bake_passes", param.global_illumination.bake_passes);
+
+		visit("restir_enabled", param.restir.enabled);
+		visit("restir_candidate_count", param.restir.candidate_count);
+		visit("restir_spatial_samples", param.restir.spatial_samples);
+		visit("restir_spatial_radius", param.restir.spatial_radius);
+		visit("restir_max_history", param.restir.max_history);
+
+		visit("reflection_enabled", param.reflection.enabled);
+		visit("reflection_max_roughness", param.reflection.max_roughness);
+		visit("reflection_max_distance", param.reflection.max_distance);
+		visit("reflection_max_steps", param.reflection.max_steps);
+		visit("reflection_thickness", param.reflection.thickness);
+		visit("reflection_denoise_alpha", param.reflection.denoise_alpha);
+		visit("reflection_denoise_phi_color", param.reflection.denoise_phi_color);
+		visit("reflection_denoise_phi_normal", param.reflection.denoise_phi_normal);
+		visit("reflection_denoise_phi_distance", param.reflection.denoise_phi_distance);
+
+		visit("vrs_enabled", param.variable_rate_shading.enabled);
+		visit("vrs_visualize", param.variable_rate_shading.visualize);
+		visit("vrs_contrast_threshold", param.variable_rate_shading.contrast_threshold);
+		visit("vrs_motion_scale", param.variable_rate_shading.motion_scale);
+
+		visit("path_trace_enabled", param.path_trace.enabled);
+		visit("path_trace_sample_budget_mpaths", param.path_trace.sample_budget_mpaths);
+		visit("path_trace_max_samples_per_pixel", param.path_trace.max_samples_per_pixel);
+		visit("path_trace_max_bounces", param.path_trace.max_bounces);
+		visit("path_trace_max_samples", param.path_trace.max_samples);
+	}
+
+	Json get_recorded_param(const Param& param) noexcept
+	{
+		auto json = Json::object();
+		visit_recorded_params(param, [&json]<typename T>(const char* name, const T& value) {
+			if constexpr (std::is_enum_v<T>)
+				json[name] = std::to_underlying(value);
+			else if constexpr (std::same_as<T, glm::vec3>)
+				json[name] = {value.x, value.y, value.z};
+			else
+				json[name] = value;
+		});
+		return json;
+	}
+
+	void apply_recorded_param(const Json& json, Param& param) noexcept
+	{
+		if (!json.is_object()) return;
+
+		visit_recorded_params(param, [&json]<typename T>(const char* name, T& value) {
+			const auto it = json.find(name);
+			if (it == json.end()) return;
+
+			if constexpr (std::is_enum_v<T>)
+			{
+				if (it->is_number_integer()) value = static_cast<T>(it->get<std::underlying_type_t<T>>());
+			}
+			else if constexpr (std::same_as<T, glm::vec3>)
+			{
+				if (!it->is_array() || it->size() != 3) return;
+				if (!(*it)[0].is_number() || !(*it)[1].is_number() || !(*it)[2].is_number()) return;
+				value = glm::vec3((*it)[0].get<float>(), (*it)[1].get<float>(), (*it)[2].get<float>());
+			}
+			else if constexpr (std::same_as<T, bool>)
+			{
+				if (it->is_boolean()) value = it->get<bool>();
+			}
+			else
+			{
+				if (it->is_number()) value = it->get<T>();
+			}
+		});
+	}
+
+	Json InputFrame::to_json() const noexcept
+	{
+		auto json = Json{
+			{"dt", delta_time},
+			{"extent", {extent.x, extent.y}},
+			{"scale", render_scale},
+			{"view",
+			 {view.center_position.x,
+			  view.center_position.y,
+			  view.center_position.z,
+			  view.distance,
+			  view.pitch_degrees,
+			  view.yaw_degrees}},
+		};
+		if (param) json["param"] = *param;
+		return json;
+	}
+
+	std::expected<InputFrame, Error> InputFrame::from_json(const Json& json) noexcept
+	{
+		if (!json.is_object()) return Error("Frame must be an object");
+
+		const auto dt = json.find("dt");
+		const auto extent = json.find("extent");
+		const auto scale = json.find("scale");
+		const auto view = json.find("view");
+
+		if (dt == json.end() || !dt->is_number()) return Error("Invalid 'dt'");
+		if (scale == json.end() || !scale->is_number()) return Error("Invalid 'scale'");
+		if (extent == json.end() || !extent->is_array() || extent->size() != 2)
+			return Error("Invalid 'extent'", "Expects 2 integers");
+		if (!(*extent)[0].is_number_unsigned() || !(*extent)[1].is_number_unsigned())
+			return Error("Invalid 'extent'", "Expects 2 integers");
+		if (view == json.end() || !view->is_array() || view->size() != 6)
+			return Error("Invalid 'view'", "Expects 6 numbers");
+
+		std::array<double, 6> view_values;
+		for (const auto index : std::views::iota(0uz, view_values.size()))
+		{
+			if (!(*view)[index].is_number()) return Error("Invalid 'view'", "Expects 6 numbers");
+			view_values[index] = (*view)[index].get<double>();
+		}
+
+		auto frame = InputFrame{
+			.delta_time = dt->get<float>(),
+			.extent = {(*extent)[0].get<uint32_t>(), (*extent)[1].get<uint32_t>()},
+			.render_scale = scale->get<float>(),
+			.view = {
+				.center_position = {view_values[0], view_values[1], view_values[2]},
+				.distance = view_values[3],
+				.pitch_degrees = view_values[4],
+				.yaw_degrees = view_values[5],
+			},
+		};
+
+		if (const auto param = json.find("param"); param != json.end())
+		{
+			if (!param->is_object()) return Error("Invalid 'param'", "Expects an object");
+			frame.param = *param;
+		}
+
+		return frame;
+	}
+
+	std::expected<InputCapture, Error> InputCapture::create(const std::filesystem::path& path) noexcept
+	{
+		const auto header = Header{.magic = MAGIC, .version = VERSION, .reserved = 0};
+		const auto header_bytes = util::object_as_bytes(header);
+
+		std::ofstream stream;
+		stream.exceptions(std::ios::failbit | std::ios::badbit);
+
+		try
+		{
+			stream.open(path, std::ios::binary | std::ios::trunc);
+			stream.write(
+				reinterpret_cast<const char*>(header_bytes.data()),
+				static_cast<std::streamsize>(header_bytes.size())
+			);
+		}
+		catch (const std::ios::failure& e)
+		{
+			return Error(std::format("Create capture file '{}' failed", path.string()), e.what());
+		}
+
+		return InputCapture(std::move(stream));
+	}
+
+	std::expected<void, Error> InputCapture::push(
+		const Param& param,
+		float delta_time,
+		glm::u32vec2 extent,
+		float render_scale
+	) noexcept
+	{
+		const auto view = param.camera.curr_view.value_or(param.camera.target_view);
+
+		auto frame = InputFrame{
+			.delta_time = delta_time,
+			.extent = extent,
+			.render_scale = render_scale,
+			.view = view,
+		};
+
+		// Parameters mostly stay unchanged, only record the frames changing them
+		auto recorded_param = get_recorded_param(param);
+		if (!last_param || *last_param != recorded_param)
+		{
+			frame.param = recorded_param;
+			last_param = std::move(recorded_param);
+		}
+
+		const auto record = Json::to_msgpack(frame.to_json());
+		const auto record_size = static_cast<uint32_t>(record.size());
+
+		try
+		{
+			stream.write(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+			stream.write(
+				reinterpret_cast<const char*>(record.data()),
+				static_cast<std::streamsize>(record.size())
+			);
+		}
+		catch (const std::ios::failure& e)
+		{
+			return Error("Write capture file failed", e.what());
+		}
+
+		frame_count++;
+		return {};
+	}
+
+	std::expected<void, Error> InputCapture::flush() noexcept
+	{
+		try
+		{
+			stream.flush();
+		}
+		catch (const std::ios::failure& e)
+		{
+			return Error("Flush capture file failed", e.what());
+		}
+
+		return {};
+	}
+
+	std::expected<InputReplay, Error> InputReplay::load(const std::filesystem::path& path) noexcept
+	{
+		const auto content_result = file::read(path);
+		if (!content_result) return content_result.error().forward("Read capture file failed");
+
+		auto frames_result = parse(*content_result);
+		if (!frames_result) return frames_result.error().forward("Parse capture file failed");
+		if (frames_result->empty()) return Error("Capture file has no frames");
+
+		// Parameters are applied incrementally, the first frame must hold all of them
+		if (!frames_result->front().param)
+			return Error("Invalid capture file", "First frame lacks parameters");
+
+		return InputReplay(std::move(*frames_result));
+	}
+
+	std::expected<std::vector<InputFrame>, Error> InputReplay::parse(std::span<const std::byte> data) noexcept
+	{
+		if (data.size() < sizeof(Header)) return Error("Invalid capture file", "File too small");
+
+		Header header;
+		std::memcpy(&header, data.data(), sizeof(Header));
+
+		if (header.magic != MAGIC) return Error("Invalid capture file", "Magic mismatch");
+		if (header.version != VERSION)
+			return Error(
+				"Unsupported capture file",
+				std::format("Version {}, expected {}", header.version, VERSION)
+			);
+
+		std::vector<InputFrame> frames;
+		auto remaining = data.subspan(sizeof(Header));
+
+		while (!remaining.empty())
+		{
+			uint32_t record_size;
+			if (remaining.size() < sizeof(record_size))
+				return Error("Invalid capture file", std::format("Truncated at frame {}", frames.size()));
+			std::memcpy(&record_size, remaining.data(), sizeof(record_size));
+			remaining = remaining.subspan(sizeof(record_size));
+
+			if (remaining.size() < record_size)
+				return Error("Invalid capture file", std::format("Truncated at frame {}", frames.size()));
+			const auto record = remaining.first(record_size);
+			remaining = remaining.subspan(record_size);
+
+			const auto* record_begin = reinterpret_cast<const uint8_t*>(record.data());
+			const auto json = Json::from_msgpack(record_begin, record_begin + record.size(), true, false);
+			if (json.is_discarded())
+				return Error("Invalid capture file", std::format("Malformed frame {}", frames.size()));
+
+			auto frame_result = InputFrame::from_json(json);
+			if (!frame_result)
+				return frame_result.error().forward(std::format("Parse frame {} failed", frames.size()));
+
+			frames.push_back(std::move(*frame_result));
+		}
+
+		return frames;
+	}
+
+	const InputFrame& InputReplay::current() const noexcept
+	{
+		DEBUG_ASSERT(!finished());
+		return frames[current_frame];
+	}
+
+	void InputReplay::apply(Param& param) const noexcept
+	{
+		const auto& frame = current();
+		if (frame.param) apply_recorded_param(*frame.param, param);
+
+		param.resolution.scale = frame.render_scale;
+		param.camera.late_latch_enabled = false;
+		param.idle.enabled = false;
+	}
+
+	bool InputReplay::extent_matches(glm::u32vec2 extent) const noexcept
+	{
+		return current().extent == extent;
+	}
+}
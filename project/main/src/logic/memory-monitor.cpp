@@ -0,0 +1,91 @@
+#include "logic/memory-monitor.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/category.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <imgui.h>
+#include <ranges>
+
+namespace logic
+{
+	static double to_mib(size_t bytes) noexcept
+	{
+		return static_cast<double>(bytes) / 1048576.0;
+	}
+
+	void MemoryMonitor::ui(const vulkan::Allocator& allocator) noexcept
+	{
+		const auto category_usage = allocator.get_category_usage();
+		for (const auto [peak, usage] : std::views::zip(peak_bytes, category_usage))
+			peak = std::max(peak, usage);
+
+		if (ImGui::Begin("GPU Memory"))
+		{
+			constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+
+			if (ImGui::BeginTable("Heaps", 5, table_flags))
+			{
+				ImGui::TableSetupColumn("Heap");
+				ImGui::TableSetupColumn("Allocated (MiB)");
+				ImGui::TableSetupColumn("Usage (MiB)");
+				ImGui::TableSetupColumn("Budget (MiB)");
+				ImGui::TableSetupColumn("Usage %");
+				ImGui::TableHeadersRow();
+
+				for (const auto [heap_idx, heap] : allocator.get_heap_budgets() | std::views::enumerate)
+				{
+					const auto usage_ratio = heap.budget_bytes == 0
+						? 0.0
+						: static_cast<double>(heap.usage_bytes) / static_cast<double>(heap.budget_bytes);
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::Text(
+						"%zu (%s)",
+						static_cast<size_t>(heap_idx),
+						heap.device_local ? "Device" : "Host"
+					);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", to_mib(heap.allocation_bytes));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", to_mib(heap.usage_bytes));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", to_mib(heap.budget_bytes));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", usage_ratio * 100.0);
+				}
+
+				ImGui::EndTable();
+			}
+
+			if (!allocator.has_memory_budget())
+				ImGui::TextUnformatted("VK_EXT_memory_budget unavailable, usage and budget are estimated");
+
+			if (ImGui::BeginTable("Categories", 3, table_flags))
+			{
+				ImGui::TableSetupColumn("Category");
+				ImGui::TableSetupColumn("Allocated (MiB)");
+				ImGui::TableSetupColumn("Peak (MiB)");
+				ImGui::TableHeadersRow();
+
+				for (const auto category_idx : std::views::iota(0zu, vulkan::MEMORY_CATEGORY_COUNT))
+				{
+					const auto name =
+						vulkan::get_memory_category_name(static_cast<vulkan::MemoryCategory>(category_idx));
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(name.data(), name.data() + name.size());
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", to_mib(category_usage[category_idx]));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", to_mib(peak_bytes[category_idx]));
+				}
+
+				ImGui::EndTable();
+			}
+		}
+		ImGui::End();
+	}
+}
@@ -0,0 +1,60 @@
+#include "logic/model-cache.hpp"
+#include "config.hpp"
+#include "logic/preset.hpp"
+#include "render/model/model.hpp"
+#include "render/model/sampler-cache.hpp"
+#include "render/model/texture-list.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <memory>
+
+namespace logic
+{
+	render::Model::Option get_model_option(
+		const Preset& preset,
+		bool stream_textures,
+		bool fast_build_blas,
+		bool animate
+	) noexcept
+	{
+		const auto texture_load_opt = render::TextureList::LoadOption{
+			.color_load_strategy = preset.color_load_strategy,
+			.normal_load_strategy = preset.normal_load_strategy,
+			.exit_on_failed_load = true,
+			.max_size = stream_textures ? config::STREAMING_BASE_TEXTURE_SIZE : preset.max_texture_size
+		};
+
+		// Shared by every model loaded in the session, e.g. models hot-swapped in the background
+		static const auto sampler_cache = std::make_shared<render::SamplerCache>();
+
+		return render::Model::Option{
+			.texture_load_option = texture_load_opt,
+			.sampler_option = {.cache = sampler_cache, .policy = {.max_anisotropy = preset.max_anisotropy}},
+			.compact_blas = true,
+			.fast_build_blas = fast_build_blas,
+			// The separate position stream isn't rewritten by the deformation, and would go stale
+			.split_positions = !animate,
+			.optimize_mesh = true,
+			.generate_lod = true,
+		};
+	}
+
+	std::filesystem::path get_model_cache_path(
+		uint64_t source_hash,
+		bool merge_static,
+		bool hlod,
+		bool impostor
+	) noexcept
+	{
+		return std::filesystem::path(config::PIPELINE_CACHE_DIRECTORY)
+			/ std::format(
+				"{:016x}{}{}{}.vrtcache",
+				source_hash,
+				merge_static ? "-merged" : "",
+				hlod ? "-hlod" : "",
+				impostor ? "-impostor" : ""
+			);
+	}
+}
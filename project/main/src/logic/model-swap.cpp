@@ -0,0 +1,55 @@
+#include "logic/model-swap.hpp"
+#include "common/util/error.hpp"
+
+#include <format>
+#include <imgui.h>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace logic
+{
+	ModelSwap::ModelSwap(std::string model_path) noexcept :
+		current_path(std::move(model_path))
+	{}
+
+	std::optional<std::string> ModelSwap::ui(bool loading) noexcept
+	{
+		auto request = std::optional<std::string>();
+
+		if (ImGui::Begin("Model"))
+		{
+			ImGui::TextWrapped("Current: %s", current_path.c_str());
+			ImGui::InputText("Path", path_input.data(), path_input.size());
+
+			ImGui::BeginDisabled(loading || path_input.front() == '\0');
+			if (ImGui::Button("Load"))
+			{
+				request.emplace(path_input.data());
+				last_error.reset();
+			}
+			ImGui::EndDisabled();
+
+			if (loading)
+			{
+				ImGui::SameLine();
+				ImGui::TextUnformatted("Loading in background...");
+			}
+
+			if (last_error.has_value()) ImGui::TextWrapped("Load failed: %s", last_error->c_str());
+		}
+		ImGui::End();
+
+		return request;
+	}
+
+	void ModelSwap::loaded(std::string model_path) noexcept
+	{
+		current_path = std::move(model_path);
+	}
+
+	void ModelSwap::failed(const Error& error) noexcept
+	{
+		last_error = std::format("{:msg}", error.root());
+	}
+}
@@ -17,8 +17,53 @@ namespace logic
 			ImGui::SeparatorText("Exposure");
 			exposure.config_ui();
 
+			ImGui::SeparatorText("Bloom");
+			bloom.config_ui();
+
 			ImGui::SeparatorText("Camera");
 			camera.config_ui();
+
+			ImGui::SeparatorText("Resolution");
+			resolution.config_ui();
+
+			ImGui::SeparatorText("Latency");
+			latency.config_ui();
+
+			ImGui::SeparatorText("Geometry");
+			geometry.config_ui();
+
+			ImGui::SeparatorText("Animation");
+			animation.config_ui();
+
+			ImGui::SeparatorText("Contact Shadow");
+			contact_shadow.config_ui();
+
+			ImGui::SeparatorText("Shadow Map");
+			shadow_map.config_ui();
+
+			ImGui::SeparatorText("Ambient Occlusion");
+			ambient_occlusion.config_ui();
+
+			ImGui::SeparatorText("Global Illumination");
+			global_illumination.config_ui();
+
+			ImGui::SeparatorText("ReSTIR");
+			restir.config_ui();
+
+			ImGui::SeparatorText("Reflection");
+			reflection.config_ui();
+
+			ImGui::SeparatorText("Variable Rate Shading");
+			variable_rate_shading.config_ui();
+
+			ImGui::SeparatorText("Path Tracing");
+			path_trace.config_ui();
+
+			ImGui::SeparatorText("Idle");
+			idle.config_ui();
+
+			ImGui::SeparatorText("Overlay");
+			overlay.config_ui();
 		}
 		ImGui::End();
 	}
@@ -0,0 +1,36 @@
+#include "logic/param/ambient-occlusion.hpp"
+#include "render/pipeline/ambient-occlusion.hpp"
+
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void AmbientOcclusion::config_ui() noexcept
+	{
+		ImGui::Checkbox("Enabled", &enabled);
+
+		ImGui::SliderFloat(
+			"Ray Budget (MRays)",
+			&ray_budget_mrays,
+			0.1f,
+			32.0f,
+			"%.2f",
+			ImGuiSliderFlags_Logarithmic
+		);
+		ImGui::SliderInt("Max Rays per Pixel", &max_rays_per_pixel, 1, 16);
+		ImGui::SliderFloat("Radius", &radius, 0.05f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+	}
+
+	std::optional<render::AmbientOcclusionPipeline::Option> AmbientOcclusion::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		return render::AmbientOcclusionPipeline::Option{
+			.ray_budget = static_cast<uint32_t>(ray_budget_mrays * 1e6f),
+			.max_rays_per_pixel = static_cast<uint32_t>(max_rays_per_pixel),
+			.radius = radius,
+		};
+	}
+}
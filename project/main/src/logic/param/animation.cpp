@@ -0,0 +1,30 @@
+#include "logic/param/animation.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void Animation::config_ui() noexcept
+	{
+		ImGui::Checkbox("Playing##Animation", &playing);
+
+		ImGui::InputInt("Index##Animation", &animation_index);
+		ImGui::SliderFloat("Speed##Animation", &speed, 0.1f, 4.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+	}
+
+	std::optional<Animation::Playback> Animation::get(size_t animation_count) const noexcept
+	{
+		if (!playing || animation_count == 0) return std::nullopt;
+
+		return Playback{
+			.animation_index = static_cast<uint32_t>(
+				std::clamp<int>(animation_index, 0, static_cast<int>(animation_count) - 1)
+			),
+			.speed = speed,
+		};
+	}
+}
@@ -0,0 +1,21 @@
+#include "logic/param/bloom.hpp"
+
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void Bloom::config_ui() noexcept
+	{
+		ImGui::Checkbox("Enabled", &enabled);
+
+		ImGui::SliderFloat("Intensity", &intensity, 0.001f, 0.5f, "%.3f", ImGuiSliderFlags_Logarithmic);
+	}
+
+	std::optional<float> Bloom::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		return intensity;
+	}
+}
@@ -1,5 +1,6 @@
 #include "logic/param/camera.hpp"
 #include "render/interface/camera.hpp"
+#include "render/pipeline/taa.hpp"
 #include "scene/camera.hpp"
 
 #include <glm/common.hpp>
@@ -17,7 +18,9 @@ namespace logic
 
 		if (!io.WantCaptureMouse)
 		{
-			const auto mouse_delta = glm::vec2(io.MouseDelta.x, io.MouseDelta.y) / glm::vec2(extent);
+			// Motion already applied by `late_latch` in the previous frame
+			const auto mouse_delta =
+				(glm::vec2(io.MouseDelta.x, io.MouseDelta.y) - latched_mouse_delta) / glm::vec2(extent);
 			const auto mouse_scroll = io.MouseWheel;
 
 			if (ImGui::IsMouseDown(ImGuiMouseButton_Right))
@@ -30,11 +33,14 @@ namespace logic
 			target_view = target_view.mouse_scroll(mouse_scroll);
 		}
 
-		curr_view = scene::camera::CenterView::mix(
-			curr_view.value_or(target_view),
-			target_view,
-			glm::clamp(smooth_factor * io.DeltaTime, 0.0, 1.0)
-		);
+		latched_mouse_delta = {0.0f, 0.0f};
+	}
+
+	void Camera::update_smoothing(double delta_time) noexcept
+	{
+		smooth_origin = curr_view.value_or(target_view);
+		smooth_weight = glm::clamp(smooth_factor * delta_time, 0.0, 1.0);
+		curr_view = scene::camera::CenterView::mix(*smooth_origin, target_view, smooth_weight);
 	}
 
 	void Camera::config_ui() noexcept
@@ -46,12 +52,21 @@ namespace logic
 
 		projection.fov_degrees = temp_fov;
 		projection.near = temp_near;
+
+		ImGui::Checkbox("Late Latch", &late_latch_enabled);
 	}
 
-	render::Camera Camera::get_and_update(glm::u32vec2 extent) noexcept
+	render::Camera Camera::get_and_update(
+		glm::u32vec2 extent,
+		glm::u32vec2 render_extent,
+		bool jitter
+	) noexcept
 	{
 		DEBUG_ASSERT(curr_view.has_value());
 
+		const auto frame_jitter =
+			jitter ? render::TaaPipeline::get_jitter(frame_index++, render_extent) : glm::vec2(0.0f);
+
 		const auto aspect_ratio = static_cast<double>(extent.x) / static_cast<double>(extent.y);
 		const auto view_matrix = curr_view->matrix();
 		const auto proj_matrix = projection.matrix(aspect_ratio);
@@ -64,12 +79,43 @@ namespace logic
 		const auto prev_camera_pos = this->prev_camera_pos.value_or(camera_pos);
 		this->prev_camera_pos = camera_pos;
 
-		return {
+		last_camera = render::Camera{
 			.inv_view_projection = glm::inverse(view_proj_matrix),
 			.prev_view_projection = prev_view_proj_matrix,
 			.view_projection = view_proj_matrix,
 			.camera_pos = camera_pos,
 			.prev_camera_pos = prev_camera_pos,
+			.jitter = frame_jitter,
 		};
+
+		return *last_camera;
+	}
+
+	std::optional<render::Camera> Camera::late_latch(glm::u32vec2 extent, const MouseMotion& motion) noexcept
+	{
+		if (!late_latch_enabled || !last_camera.has_value() || !smooth_origin.has_value())
+			return std::nullopt;
+		if (!motion.rotate && !motion.pan) return std::nullopt;
+
+		const auto mouse_delta = motion.delta / glm::vec2(extent);
+		if (motion.rotate) target_view = target_view.mouse_rotate(mouse_delta);
+		if (motion.pan)
+			target_view = target_view.mouse_pan(mouse_delta, extent.x / static_cast<double>(extent.y), 1.0);
+		latched_mouse_delta += motion.delta;
+
+		curr_view = scene::camera::CenterView::mix(*smooth_origin, target_view, smooth_weight);
+
+		const auto aspect_ratio = static_cast<double>(extent.x) / static_cast<double>(extent.y);
+		const auto view_proj_matrix =
+			scene::camera::reverse_z() * projection.matrix(aspect_ratio) * curr_view->matrix();
+		const auto camera_pos = curr_view->view_position();
+		prev_view_proj_matrix = view_proj_matrix;
+		prev_camera_pos = camera_pos;
+
+		last_camera->inv_view_projection = glm::inverse(view_proj_matrix);
+		last_camera->view_projection = view_proj_matrix;
+		last_camera->camera_pos = camera_pos;
+
+		return *last_camera;
 	}
 }
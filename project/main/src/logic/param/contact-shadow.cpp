@@ -0,0 +1,29 @@
+#include "logic/param/contact-shadow.hpp"
+#include "render/pipeline/contact-shadow.hpp"
+
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void ContactShadow::config_ui() noexcept
+	{
+		ImGui::Checkbox("Enabled", &enabled);
+
+		ImGui::SliderInt("Steps", &step_count, 4, 32);
+		ImGui::SliderFloat("Distance", &max_distance, 0.01f, 2.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
+		ImGui::SliderFloat("Thickness", &thickness, 0.001f, 0.2f, "%.3f", ImGuiSliderFlags_Logarithmic);
+	}
+
+	std::optional<render::ContactShadowPipeline::Option> ContactShadow::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		return render::ContactShadowPipeline::Option{
+			.step_count = static_cast<uint32_t>(step_count),
+			.max_distance = max_distance,
+			.thickness = thickness,
+		};
+	}
+}
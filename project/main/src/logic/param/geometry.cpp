@@ -0,0 +1,24 @@
+#include "logic/param/geometry.hpp"
+#include "render/pipeline/deferred.hpp"
+
+#include <array>
+#include <imgui.h>
+
+namespace logic
+{
+	void Geometry::config_ui() noexcept
+	{
+		static constexpr auto DEPTH_PREPASS_NAMES = std::to_array({"None", "Masked Only", "All"});
+
+		auto depth_prepass_index = static_cast<int>(depth_prepass);
+		if (ImGui::Combo(
+				"Depth Prepass",
+				&depth_prepass_index,
+				DEPTH_PREPASS_NAMES.data(),
+				static_cast<int>(DEPTH_PREPASS_NAMES.size())
+			))
+			depth_prepass = static_cast<render::DeferredPipeline::DepthPrepass>(depth_prepass_index);
+
+		ImGui::Checkbox("Front-to-back Sort", &depth_sort);
+	}
+}
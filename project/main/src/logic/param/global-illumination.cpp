@@ -0,0 +1,53 @@
+#include "logic/param/global-illumination.hpp"
+#include "config.hpp"
+#include "render/pipeline/gi-probe.hpp"
+
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void GlobalIllumination::config_ui() noexcept
+	{
+		ImGui::Checkbox("Enabled##GlobalIllumination", &enabled);
+
+		ImGui::SliderFloat(
+			"Ray Budget (MRays)",
+			&ray_budget_mrays,
+			0.01f,
+			config::GI_PROBE_RAY_CAPACITY / 1e6f,
+			"%.3f",
+			ImGuiSliderFlags_Logarithmic
+		);
+		ImGui::SliderInt(
+			"Rays per Probe",
+			&rays_per_probe,
+			32,
+			static_cast<int>(render::GiProbePipeline::MAX_RAYS_PER_PROBE)
+		);
+		ImGui::BeginDisabled(bake);
+		ImGui::SliderFloat("Hysteresis", &hysteresis, 0.5f, 0.99f, "%.2f");
+		ImGui::EndDisabled();
+
+		ImGui::Checkbox("Bake (Static Scene)", &bake);
+		if (bake) ImGui::SliderInt("Bake Passes", &bake_passes, 1, 256);
+	}
+
+	std::optional<render::GiProbePipeline::Option> GlobalIllumination::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		return render::GiProbePipeline::Option{
+			.ray_budget = static_cast<uint32_t>(ray_budget_mrays * 1e6f),
+			.rays_per_probe = static_cast<uint32_t>(rays_per_probe),
+			.hysteresis = hysteresis,
+		};
+	}
+
+	std::optional<uint32_t> GlobalIllumination::get_bake_pass_count() const noexcept
+	{
+		if (!enabled || !bake) return std::nullopt;
+		return static_cast<uint32_t>(bake_passes);
+	}
+}
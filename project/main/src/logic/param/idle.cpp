@@ -0,0 +1,45 @@
+#include "logic/param/idle.hpp"
+#include "logic/param/auto-exposure.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <imgui.h>
+
+namespace logic
+{
+	// Residual of the exponential exposure adaptation considered converged
+	static constexpr float EXPOSURE_RESIDUAL = 0.01f;
+
+	void Idle::config_ui() noexcept
+	{
+		ImGui::Checkbox("Idle When Static", &enabled);
+
+		if (enabled)
+			ImGui::SliderFloat(
+				"Min Settle Time",
+				&min_settle_seconds,
+				0.1f,
+				10.0f,
+				"%.1f s",
+				ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp
+			);
+	}
+
+	void Idle::mark_active(Clock::time_point now) noexcept
+	{
+		last_activity = now;
+	}
+
+	bool Idle::settled(Clock::time_point now, const Exposure& exposure) const noexcept
+	{
+		if (!enabled || !last_activity.has_value()) return false;
+
+		// Exposure approaches its target by `exp(-rate * t)`
+		const auto exposure_rate = std::max(exposure.adaptation_rate, 0.01f);
+		const auto exposure_seconds = -std::log(EXPOSURE_RESIDUAL) / exposure_rate;
+		const auto settle_seconds = std::max(min_settle_seconds, exposure_seconds);
+
+		return std::chrono::duration<float>(now - *last_activity).count() >= settle_seconds;
+	}
+}
@@ -0,0 +1,72 @@
+#include "logic/param/latency.hpp"
+#include "config.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	// Weight of the newest frame in the smoothed latency
+	static constexpr float LATENCY_SMOOTHING = 0.1f;
+
+	// Presents never observed as displayed, e.g. discarded on swapchain recreation, are dropped beyond this
+	static constexpr size_t MAX_PENDING_PRESENTS = config::INFLIGHT_FRAMES * 4;
+
+	static constexpr uint32_t MIN_QUEUED_FRAMES = 1;
+
+	void Latency::config_ui() noexcept
+	{
+		ImGui::Checkbox("Low Latency", &low_latency);
+
+		if (low_latency)
+			ImGui::SliderScalar(
+				"Max Queued Frames",
+				ImGuiDataType_U32,
+				&max_queued_frames,
+				&MIN_QUEUED_FRAMES,
+				&config::INFLIGHT_FRAMES,
+				nullptr,
+				ImGuiSliderFlags_AlwaysClamp
+			);
+
+		if (smoothed_latency_ms > 0.0f)
+			ImGui::Text("Latency: %.1f ms", smoothed_latency_ms);
+		else
+			ImGui::TextDisabled("Latency: N/A (present wait unsupported)");
+	}
+
+	void Latency::push(uint64_t present_id, Clock::time_point frame_start) noexcept
+	{
+		if (!pending.empty() && pending.back().present_id >= present_id) return;
+
+		pending.push_back({.present_id = present_id, .frame_start = frame_start});
+		if (pending.size() > MAX_PENDING_PRESENTS) pending.pop_front();
+	}
+
+	std::optional<uint64_t> Latency::oldest_pending() const noexcept
+	{
+		if (pending.empty()) return std::nullopt;
+		return pending.front().present_id;
+	}
+
+	void Latency::complete(uint64_t present_id, Clock::time_point display_time) noexcept
+	{
+		std::optional<Clock::time_point> frame_start;
+		while (!pending.empty() && pending.front().present_id <= present_id)
+		{
+			if (pending.front().present_id == present_id) frame_start = pending.front().frame_start;
+			pending.pop_front();
+		}
+		if (!frame_start) return;
+
+		const auto latency_ms =
+			std::chrono::duration<float, std::milli>(display_time - *frame_start).count();
+		smoothed_latency_ms = smoothed_latency_ms == 0.0f
+			? latency_ms
+			: std::lerp(smoothed_latency_ms, latency_ms, LATENCY_SMOOTHING);
+	}
+}
@@ -0,0 +1,43 @@
+#include "logic/param/overlay.hpp"
+
+#include <chrono>
+#include <imgui.h>
+
+namespace logic
+{
+	void Overlay::config_ui() noexcept
+	{
+		ImGui::Checkbox("Cached Layer", &cached);
+
+		if (cached)
+		{
+			ImGui::SliderFloat(
+				"Refresh Interval",
+				&refresh_interval,
+				0.02f,
+				2.0f,
+				"%.2f s",
+				ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp
+			);
+			ImGui::SliderInt("Settle Frames", &settle_frames, 1, 16, "%d", ImGuiSliderFlags_AlwaysClamp);
+		}
+	}
+
+	void Overlay::mark_input() noexcept
+	{
+		pending_frames = settle_frames;
+	}
+
+	bool Overlay::begin_frame(Clock::time_point now, bool layer_valid) noexcept
+	{
+		const auto refresh_due = !last_record.has_value()
+			|| std::chrono::duration<float>(now - *last_record).count() >= refresh_interval;
+
+		if (cached && layer_valid && pending_frames <= 0 && !refresh_due) return false;
+
+		if (pending_frames > 0) pending_frames--;
+		last_record = now;
+
+		return true;
+	}
+}
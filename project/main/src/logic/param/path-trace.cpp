@@ -0,0 +1,38 @@
+#include "logic/param/path-trace.hpp"
+#include "render/pipeline/path-trace.hpp"
+
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void PathTrace::config_ui() noexcept
+	{
+		ImGui::Checkbox("Enabled##PathTrace", &enabled);
+
+		ImGui::SliderFloat(
+			"Sample Budget (MPaths)",
+			&sample_budget_mpaths,
+			0.05f,
+			32.0f,
+			"%.2f",
+			ImGuiSliderFlags_Logarithmic
+		);
+		ImGui::SliderInt("Max Samples per Pixel", &max_samples_per_pixel, 1, 16);
+		ImGui::SliderInt("Max Bounces", &max_bounces, 0, 16);
+		ImGui::SliderInt("Max Samples", &max_samples, 1, 65536, "%d", ImGuiSliderFlags_Logarithmic);
+	}
+
+	std::optional<render::PathTracePipeline::Option> PathTrace::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		return render::PathTracePipeline::Option{
+			.sample_budget = static_cast<uint32_t>(sample_budget_mpaths * 1e6f),
+			.max_samples_per_pixel = static_cast<uint32_t>(max_samples_per_pixel),
+			.max_bounces = static_cast<uint32_t>(max_bounces),
+			.max_samples = static_cast<uint32_t>(max_samples),
+		};
+	}
+}
@@ -20,6 +20,7 @@ namespace logic
 			"%.4g",
 			ImGuiSliderFlags_Logarithmic
 		);
+		ImGui::Checkbox("Atmosphere", &atmosphere);
 	}
 
 	render::DirectLight PrimaryLight::get() const noexcept
@@ -0,0 +1,95 @@
+#include "logic/param/reflection.hpp"
+#include "render/pipeline/denoise.hpp"
+#include "render/pipeline/reflection.hpp"
+
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void Reflection::config_ui() noexcept
+	{
+		ImGui::Checkbox("Enabled##Reflection", &enabled);
+
+		ImGui::SliderFloat("Max Roughness", &max_roughness, 0.05f, 1.0f);
+		ImGui::SliderFloat(
+			"Distance##Reflection",
+			&max_distance,
+			1.0f,
+			500.0f,
+			"%.1f",
+			ImGuiSliderFlags_Logarithmic
+		);
+		ImGui::SliderInt("Steps##Reflection", &max_steps, 8, 128);
+		ImGui::SliderFloat(
+			"Thickness##Reflection",
+			&thickness,
+			0.005f,
+			0.5f,
+			"%.3f",
+			ImGuiSliderFlags_Logarithmic
+		);
+
+		if (ImGui::TreeNode("Denoise##Reflection"))
+		{
+			// Lower weights keep longer histories, smoother but slower to respond to changes
+			ImGui::SliderFloat(
+				"Temporal Weight",
+				&denoise_alpha,
+				0.02f,
+				1.0f,
+				"%.2f",
+				ImGuiSliderFlags_Logarithmic
+			);
+			ImGui::SliderFloat(
+				"Color Phi",
+				&denoise_phi_color,
+				0.5f,
+				16.0f,
+				"%.1f",
+				ImGuiSliderFlags_Logarithmic
+			);
+			ImGui::SliderFloat(
+				"Normal Phi",
+				&denoise_phi_normal,
+				1.0f,
+				256.0f,
+				"%.0f",
+				ImGuiSliderFlags_Logarithmic
+			);
+			ImGui::SliderFloat(
+				"Distance Phi",
+				&denoise_phi_distance,
+				0.005f,
+				0.5f,
+				"%.3f",
+				ImGuiSliderFlags_Logarithmic
+			);
+			ImGui::TreePop();
+		}
+	}
+
+	std::optional<render::ReflectionPipeline::Option> Reflection::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		return render::ReflectionPipeline::Option{
+			.max_roughness = max_roughness,
+			.max_distance = max_distance,
+			.max_steps = static_cast<uint32_t>(max_steps),
+			.thickness = thickness,
+		};
+	}
+
+	render::DenoisePipeline::Option Reflection::get_denoise() const noexcept
+	{
+		return render::DenoisePipeline::Option{
+			.color_alpha = denoise_alpha,
+			.moments_alpha = denoise_alpha,
+			.phi_color = denoise_phi_color,
+			.phi_normal = denoise_phi_normal,
+			.phi_distance = denoise_phi_distance,
+		};
+	}
+}
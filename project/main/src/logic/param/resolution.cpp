@@ -0,0 +1,130 @@
+#include "logic/param/resolution.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	// Keep some headroom below the budget, so that small spikes do not drop frames
+	static constexpr float FRAME_BUDGET_HEADROOM = 0.9f;
+
+	// Weight of the newest frame in the smoothed frame time
+	static constexpr float FRAME_TIME_SMOOTHING = 0.1f;
+
+	static float quantize_scale(float scale) noexcept
+	{
+		return std::round(scale / Resolution::SCALE_STEP) * Resolution::SCALE_STEP;
+	}
+
+	void Resolution::config_ui() noexcept
+	{
+		static constexpr auto MODE_NAMES = std::to_array({"Fixed", "Dynamic", "Checkerboard"});
+
+		auto mode_index = static_cast<int>(mode);
+		if (ImGui::Combo("Resolution", &mode_index, MODE_NAMES.data(), static_cast<int>(MODE_NAMES.size())))
+			mode = static_cast<Mode>(mode_index);
+
+		switch (mode)
+		{
+		case Mode::Dynamic:
+			ImGui::SliderFloat(
+				"Target Frame Time",
+				&target_frame_ms,
+				4.0f,
+				50.0f,
+				"%.1f ms",
+				ImGuiSliderFlags_AlwaysClamp
+			);
+			ImGui::SliderFloat("Min Scale", &min_scale, 0.25f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+			break;
+
+		case Mode::Fixed:
+			ImGui::SliderFloat("Scale", &fixed_scale, 0.25f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+			break;
+
+		case Mode::Checkerboard:
+			break;
+		}
+
+		static constexpr auto UPSCALER_NAMES = std::to_array({"Temporal", "Spatial"});
+
+		// Checkerboard frames are reconstructed by TAA
+		ImGui::BeginDisabled(mode == Mode::Checkerboard);
+		auto upscaler_index = static_cast<int>(upscaler);
+		if (ImGui::Combo(
+				"Upscaler",
+				&upscaler_index,
+				UPSCALER_NAMES.data(),
+				static_cast<int>(UPSCALER_NAMES.size())
+			))
+			upscaler = static_cast<Upscaler>(upscaler_index);
+		ImGui::EndDisabled();
+
+		ImGui::SliderFloat("Sharpness", &sharpness, 0.0f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+
+		ImGui::Text("Current Scale: %.0f%%", scale * 100.0f);
+	}
+
+	void Resolution::update(double frame_ms) noexcept
+	{
+		if (mode != Mode::Dynamic)
+		{
+			scale = mode == Mode::Fixed ? quantize_scale(fixed_scale) : 1.0f;
+			cooldown = 0;
+			return;
+		}
+
+		const auto frame_time = static_cast<float>(frame_ms);
+		smoothed_frame_ms = smoothed_frame_ms == 0.0f
+			? frame_time
+			: std::lerp(smoothed_frame_ms, frame_time, FRAME_TIME_SMOOTHING);
+
+		if (cooldown > 0)
+		{
+			cooldown--;
+			return;
+		}
+
+		// Frame time is roughly proportional to the pixel count, i.e. the square of the scale
+		const auto ideal_scale =
+			scale * std::sqrt(target_frame_ms * FRAME_BUDGET_HEADROOM / std::max(smoothed_frame_ms, 0.01f));
+
+		// Hysteresis of a full step, so that the scale does not flip between two steps
+		if (std::abs(ideal_scale - scale) < SCALE_STEP) return;
+
+		const auto new_scale = std::clamp(quantize_scale(ideal_scale), quantize_scale(min_scale), 1.0f);
+
+		if (new_scale == scale) return;
+
+		// Predict the frame time at the new scale, instead of waiting for the average to catch up
+		smoothed_frame_ms *= (new_scale * new_scale) / (scale * scale);
+		scale = new_scale;
+		cooldown = COOLDOWN_FRAMES;
+	}
+
+	glm::u32vec2 Resolution::get_extent(glm::u32vec2 extent) const noexcept
+	{
+		if (mode == Mode::Checkerboard) return extent;
+
+		const auto scaled = glm::round(glm::vec2(extent) * scale);
+		return glm::clamp(glm::u32vec2(scaled), glm::u32vec2(1), extent);
+	}
+
+	bool Resolution::spatial_upscale() const noexcept
+	{
+		return upscaler == Upscaler::Spatial && mode != Mode::Checkerboard;
+	}
+
+	std::optional<uint32_t> Resolution::get_checkerboard(uint64_t frame_index) const noexcept
+	{
+		if (mode != Mode::Checkerboard) return std::nullopt;
+		return static_cast<uint32_t>(frame_index % 2);
+	}
+}
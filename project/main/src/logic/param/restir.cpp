@@ -0,0 +1,32 @@
+#include "logic/param/restir.hpp"
+#include "render/pipeline/restir.hpp"
+
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void Restir::config_ui() noexcept
+	{
+		// Shadows the punctual lights itself, the light cluster is left empty meanwhile
+		ImGui::Checkbox("Enabled##ReSTIR", &enabled);
+
+		ImGui::SliderInt("Candidates##ReSTIR", &candidate_count, 1, 32);
+		ImGui::SliderInt("Spatial Samples##ReSTIR", &spatial_samples, 0, 8);
+		ImGui::SliderFloat("Spatial Radius##ReSTIR", &spatial_radius, 1.0f, 64.0f, "%.0f px");
+		ImGui::SliderInt("Max History##ReSTIR", &max_history, 1, 50);
+	}
+
+	std::optional<render::RestirPipeline::Option> Restir::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		return render::RestirPipeline::Option{
+			.candidate_count = static_cast<uint32_t>(candidate_count),
+			.spatial_samples = static_cast<uint32_t>(spatial_samples),
+			.spatial_radius = spatial_radius,
+			.max_history = static_cast<uint32_t>(max_history),
+		};
+	}
+}
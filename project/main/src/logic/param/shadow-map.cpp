@@ -0,0 +1,67 @@
+#include "logic/param/shadow-map.hpp"
+#include "render/resource/cascade-shadow.hpp"
+#include "render/util/cascade.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	namespace
+	{
+		constexpr auto RESOLUTIONS = std::to_array<uint32_t>({1024, 2048, 4096});
+		constexpr auto RESOLUTION_NAMES = std::to_array({"1024", "2048", "4096"});
+	}
+
+	void ShadowMap::config_ui() noexcept
+	{
+		ImGui::Checkbox("Enabled##ShadowMap", &enabled);
+
+		ImGui::SliderInt(
+			"Cascades",
+			&cascade_count,
+			1,
+			static_cast<int>(render::CascadeShadowAttachment::MAX_CASCADES)
+		);
+		ImGui::Combo(
+			"Resolution##ShadowMap",
+			&resolution_index,
+			RESOLUTION_NAMES.data(),
+			static_cast<int>(RESOLUTION_NAMES.size())
+		);
+		ImGui::SliderFloat(
+			"Distance##ShadowMap",
+			&shadow_distance,
+			10.0f,
+			1000.0f,
+			"%.0f",
+			ImGuiSliderFlags_Logarithmic
+		);
+		ImGui::SliderFloat("Split Lambda", &split_lambda, 0.0f, 1.0f);
+		ImGui::Checkbox("Cache Static Cascades", &cached);
+	}
+
+	std::optional<render::CascadeOption> ShadowMap::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		// Recorded inputs may hold out-of-range values
+		const auto cascade_count_clamped = std::clamp<int>(
+			cascade_count,
+			1,
+			static_cast<int>(render::CascadeShadowAttachment::MAX_CASCADES)
+		);
+		const auto resolution_index_clamped =
+			std::clamp<int>(resolution_index, 0, static_cast<int>(RESOLUTIONS.size()) - 1);
+
+		return render::CascadeOption{
+			.cascade_count = static_cast<uint32_t>(cascade_count_clamped),
+			.resolution = RESOLUTIONS[resolution_index_clamped],
+			.shadow_distance = shadow_distance,
+			.split_lambda = split_lambda,
+		};
+	}
+}
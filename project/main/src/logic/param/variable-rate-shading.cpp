@@ -0,0 +1,34 @@
+#include "logic/param/variable-rate-shading.hpp"
+#include "render/pipeline/shading-rate.hpp"
+
+#include <imgui.h>
+#include <optional>
+
+namespace logic
+{
+	void VariableRateShading::config_ui() noexcept
+	{
+		ImGui::Checkbox("Enabled##VariableRateShading", &enabled);
+
+		ImGui::Checkbox("Visualize Rates", &visualize);
+		ImGui::SliderFloat(
+			"Contrast Threshold",
+			&contrast_threshold,
+			0.005f,
+			0.2f,
+			"%.3f",
+			ImGuiSliderFlags_Logarithmic
+		);
+		ImGui::SliderFloat("Motion Scale", &motion_scale, 0.0f, 2.0f, "%.2f");
+	}
+
+	std::optional<render::ShadingRatePipeline::Option> VariableRateShading::get() const noexcept
+	{
+		if (!enabled) return std::nullopt;
+
+		return render::ShadingRatePipeline::Option{
+			.contrast_threshold = contrast_threshold,
+			.motion_scale = motion_scale,
+		};
+	}
+}
@@ -0,0 +1,127 @@
+#include "logic/preset.hpp"
+#include "common/util/cpu.hpp"
+#include "logic/param.hpp"
+#include "render/model/texture.hpp"
+#include "render/pipeline/deferred.hpp"
+#include "render/resource/ambient-occlusion.hpp"
+#include "render/resource/hdr.hpp"
+
+#include <libassert/assert.hpp>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace logic
+{
+	Preset Preset::from_tier(Tier tier) noexcept
+	{
+		using ColorLoadStrategy = render::Texture::ColorLoadStrategy;
+		using NormalLoadStrategy = render::Texture::NormalLoadStrategy;
+		using DepthPrepass = render::DeferredPipeline::DepthPrepass;
+		using AmbientOcclusionResolution = render::AmbientOcclusionAttachment::Resolution;
+		using Affinity = util::cpu::Affinity;
+
+		switch (tier)
+		{
+		// Bandwidth and memory bound, trade resolution for frame rate and keep overdraw low
+		case Tier::Low:
+			return {
+				.tier = tier,
+				.initial_scale = 0.75f,
+				.min_scale = 0.5f,
+				.color_load_strategy = ColorLoadStrategy::AllBC3,
+				.normal_load_strategy = NormalLoadStrategy::AllBC5,
+				.max_texture_size = 2048,
+				.max_anisotropy = 2.0f,
+				.half_resolution_shadow = true,
+				.ambient_occlusion_resolution = AmbientOcclusionResolution::Quarter,
+				.global_illumination = false,
+				.variable_rate_shading = true,
+				.hdr_format = render::HdrAttachment::PACKED_HDR_FORMAT,
+				.depth_prepass = DepthPrepass::Masked,
+				.depth_sort = true,
+				.pool_config = {.affinity = Affinity::Performance, .reserve_render_core = true},
+			};
+
+		case Tier::Medium:
+			return {
+				.tier = tier,
+				.initial_scale = 1.0f,
+				.min_scale = 0.65f,
+				.color_load_strategy = ColorLoadStrategy::BalancedBC,
+				.normal_load_strategy = NormalLoadStrategy::AllBC5,
+				.max_texture_size = 4096,
+				.max_anisotropy = 8.0f,
+				.half_resolution_shadow = true,
+				.ambient_occlusion_resolution = AmbientOcclusionResolution::Half,
+				.global_illumination = false,
+				.variable_rate_shading = true,
+				.hdr_format = render::HdrAttachment::HDR_FORMAT,
+				.depth_prepass = DepthPrepass::None,
+				.depth_sort = true,
+				.pool_config = {.affinity = Affinity::Performance, .reserve_render_core = true},
+			};
+
+		case Tier::High:
+			return {
+				.tier = tier,
+				.initial_scale = 1.0f,
+				.min_scale = 0.75f,
+				.color_load_strategy = ColorLoadStrategy::BalancedBC,
+				.normal_load_strategy = NormalLoadStrategy::AllBC5,
+				.max_texture_size = 0,
+				.max_anisotropy = 16.0f,
+				.half_resolution_shadow = false,
+				.ambient_occlusion_resolution = AmbientOcclusionResolution::Half,
+				.global_illumination = true,
+				.variable_rate_shading = false,
+				.hdr_format = render::HdrAttachment::HDR_FORMAT,
+				.depth_prepass = DepthPrepass::None,
+				.depth_sort = false,
+				.pool_config = {.affinity = Affinity::Performance, .reserve_render_core = false},
+			};
+
+		default:
+			UNREACHABLE("Invalid tier", tier);
+		}
+	}
+
+	void Preset::fit_textures(const render::Texture::CompressionSupport& support) noexcept
+	{
+		color_load_strategy = support.fit(color_load_strategy);
+		normal_load_strategy = support.fit(normal_load_strategy);
+	}
+
+	void Preset::fit_hdr_format(const vk::raii::PhysicalDevice& phy_device) noexcept
+	{
+		if (!render::HdrAttachment::is_format_supported(phy_device, hdr_format))
+			hdr_format = render::HdrAttachment::HDR_FORMAT;
+	}
+
+	void Preset::apply(Param& param) const noexcept
+	{
+		param.resolution.scale = initial_scale;
+		param.resolution.fixed_scale = initial_scale;
+		param.resolution.min_scale = min_scale;
+
+		param.global_illumination.enabled = global_illumination;
+		param.variable_rate_shading.enabled = variable_rate_shading;
+
+		param.geometry.depth_prepass = depth_prepass;
+		param.geometry.depth_sort = depth_sort;
+	}
+
+	const char* get_tier_name(Preset::Tier tier) noexcept
+	{
+		switch (tier)
+		{
+		case Preset::Tier::Low:
+			return "Low";
+		case Preset::Tier::Medium:
+			return "Medium";
+		case Preset::Tier::High:
+			return "High";
+		default:
+			UNREACHABLE("Invalid tier", tier);
+		}
+	}
+}
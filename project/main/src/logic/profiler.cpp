@@ -0,0 +1,153 @@
+#include "logic/profiler.hpp"
+#include "common/file.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "vulkan/util/timestamp-query.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <imgui.h>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace logic
+{
+	Profiler::Statistics Profiler::Entry::statistics() const noexcept
+	{
+		if (history.empty()) return {.average = 0, .p50 = 0, .p95 = 0, .p99 = 0, .max = 0};
+
+		auto sorted = std::vector(std::from_range, history);
+		std::ranges::sort(sorted);
+
+		const auto percentile = [&sorted](double p) {
+			const auto index = static_cast<size_t>(std::round(p * static_cast<double>(sorted.size() - 1)));
+			return sorted[index];
+		};
+
+		const auto sum = std::ranges::fold_left(sorted, 0.0, std::plus());
+
+		return {
+			.average = sum / static_cast<double>(sorted.size()),
+			.p50 = percentile(0.50),
+			.p95 = percentile(0.95),
+			.p99 = percentile(0.99),
+			.max = sorted.back(),
+		};
+	}
+
+	void Profiler::push(std::span<const vulkan::TimestampQuery::Result> results) noexcept
+	{
+		for (const auto& result : results)
+		{
+			auto entry = std::ranges::find(entries, result.name, &Entry::name);
+			if (entry == entries.end())
+			{
+				entries.push_back(Entry{.name = result.name, .history = {}});
+				entry = std::prev(entries.end());
+			}
+
+			entry->history.push_back(result.duration_ms);
+			if (entry->history.size() > HISTORY_SIZE) entry->history.pop_front();
+		}
+	}
+
+	void Profiler::ui() noexcept
+	{
+		if (ImGui::Begin("GPU Profiler"))
+		{
+			constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+			if (ImGui::BeginTable("Passes", 6, table_flags))
+			{
+				ImGui::TableSetupColumn("Pass");
+				ImGui::TableSetupColumn("Avg (ms)");
+				ImGui::TableSetupColumn("P50");
+				ImGui::TableSetupColumn("P95");
+				ImGui::TableSetupColumn("P99");
+				ImGui::TableSetupColumn("Max");
+				ImGui::TableHeadersRow();
+
+				for (const auto& entry : entries)
+				{
+					const auto stat = entry.statistics();
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(entry.name.c_str());
+					for (const auto value : {stat.average, stat.p50, stat.p95, stat.p99, stat.max})
+					{
+						ImGui::TableNextColumn();
+						ImGui::Text("%.3f", value);
+					}
+				}
+
+				ImGui::EndTable();
+			}
+
+			ImGui::Text("Statistics over the last %zu frames", HISTORY_SIZE);
+
+			const auto dump = [this](const char* path, const std::expected<void, Error>& result) {
+				dump_message = result ? std::format("Dumped to {}", path)
+									  : std::format("Dump failed: {:msg}", result.error().root());
+			};
+
+			if (ImGui::Button("Dump CSV")) dump("gpu-profile.csv", dump_csv("gpu-profile.csv"));
+			ImGui::SameLine();
+			if (ImGui::Button("Dump JSON")) dump("gpu-profile.json", dump_json("gpu-profile.json"));
+
+			if (dump_message.has_value()) ImGui::TextUnformatted(dump_message->c_str());
+		}
+		ImGui::End();
+	}
+
+	std::expected<void, Error> Profiler::dump_csv(const std::filesystem::path& path) const noexcept
+	{
+		std::string csv = "pass,samples,avg_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+		for (const auto& entry : entries)
+		{
+			const auto stat = entry.statistics();
+			csv += std::format(
+				"{},{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f}\n",
+				entry.name,
+				entry.history.size(),
+				stat.average,
+				stat.p50,
+				stat.p95,
+				stat.p99,
+				stat.max
+			);
+		}
+
+		return file::write(path, util::as_bytes(csv));
+	}
+
+	std::expected<void, Error> Profiler::dump_json(const std::filesystem::path& path) const noexcept
+	{
+		auto json = Json::array();
+		for (const auto& entry : entries)
+		{
+			const auto stat = entry.statistics();
+			json.push_back(
+				Json{
+					{"pass",    entry.name                        },
+					{"avg_ms",  stat.average                      },
+					{"p50_ms",  stat.p50                          },
+					{"p95_ms",  stat.p95                          },
+					{"p99_ms",  stat.p99                          },
+					{"max_ms",  stat.max                          },
+					{"samples", std::vector(std::from_range, entry.history)}
+				}
+			);
+		}
+
+		return file::write(path, util::as_bytes(json.dump(4)));
+	}
+}
@@ -2,8 +2,10 @@
 #include "argument.hpp"
 #include "common/util/async.hpp"
 #include "common/util/error.hpp"
+#include "helper/startup.hpp"
 #include "page/load.hpp"
 #include "resource/context.hpp"
+#include "resource/pipeline.hpp"
 
 #include <expected>
 #include <future>
@@ -14,19 +16,31 @@ namespace page
 {
 	InitPage InitPage::from(Argument argument) noexcept
 	{
+		// Parsing only needs the arguments, start it before the context. The context is still created on the
+		// main thread in `run_frame`, as the window must be
+		auto prefetch = LoadPage::prefetch(argument);
+
 		auto task = util::Future(std::async(std::launch::deferred, [argument]() {
-			return resource::Context::create();
+			const auto mesh_shader = argument.gbuffer_path == resource::Pipeline::GBufferPath::Meshlet;
+			return resource::Context::create(mesh_shader);
 		}));
-		return InitPage(std::move(task), std::move(argument));
+		return InitPage(std::move(task), std::move(argument), std::move(prefetch));
 	}
 
 	std::expected<InitPage::ResultType, Error> InitPage::run_frame() noexcept
 	{
+		auto step = helper::StartupStep("Create context");
 		auto context_result = std::move(task).get();
-		if (!context_result) return context_result.error().forward("Initialize context failed");
+		if (!context_result)
+		{
+			// Don't wait for the model nobody will use
+			prefetch.stop_source.request_stop();
+			return context_result.error().forward("Initialize context failed");
+		}
 		auto context = std::move(*context_result);
+		step.end();
 
-		auto load_page_result = LoadPage::from(std::move(context), std::move(argument));
+		auto load_page_result = LoadPage::from(std::move(context), std::move(argument), std::move(prefetch));
 		if (!load_page_result) return load_page_result.error().forward("Initialize load page failed");
 
 		return ResultType::from<Result::SwitchPage>(std::make_unique<LoadPage>(std::move(*load_page_result)));
@@ -1,74 +1,323 @@
 #include "page/load.hpp"
 #include "argument.hpp"
+#include "common/util/arena.hpp"
 #include "common/util/async.hpp"
+#include "common/util/cpu.hpp"
 #include "common/util/error.hpp"
 #include "common/util/overload.hpp"
+#include "common/util/profile.hpp"
 #include "common/util/tagged-type.hpp"
+#include "common/util/trace.hpp"
+#include "config.hpp"
 #include "helper/imgui-page.hpp"
+#include "helper/startup.hpp"
+#include "helper/thread-pool.hpp"
 #include "model/gltf.hpp"
+#include "model/impostor.hpp"
+#include "model/material.hpp"
+#include "model/merge.hpp"
+#include "model/model.hpp"
+#include "logic/model-cache.hpp"
+#include "logic/preset.hpp"
 #include "page/error.hpp"
 #include "page/render.hpp"
+#include "render/model/blas-cache.hpp"
+#include "render/model/blas.hpp"
+#include "render/model/geometry-streamer.hpp"
 #include "render/model/material.hpp"
+#include "render/model/model-cache.hpp"
 #include "render/model/model.hpp"
 #include "render/model/texture-list.hpp"
+#include "render/model/texture-streamer.hpp"
 #include "render/model/texture.hpp"
 #include "render/model/tlas.hpp"
 #include "resource/context.hpp"
+#include "resource/pipeline.hpp"
+#include "vulkan/context/capability.hpp"
+#include "vulkan/interface/context.hpp"
 
-#include <chrono>
 #include <coro/sync_wait.hpp>
 #include <coro/thread_pool.hpp>
 #include <expected>
 #include <filesystem>
+#include <format>
 #include <functional>
 #include <future>
 #include <glm/ext/matrix_float4x4.hpp>
 #include <imgui.h>
 #include <libassert/assert.hpp>
 #include <memory>
+#include <optional>
 #include <print>
+#include <ranges>
+#include <stop_token>
 #include <string>
+#include <system_error>
 #include <tuple>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 namespace page
 {
-	std::expected<std::tuple<render::Model, render::Tlas>, Error> LoadPage::load_model_task(
-		std::shared_ptr<const resource::Context> context,  // NOLINT: intended to own
-		const render::MaterialLayout& material_layout,
-		Argument argument,
+	std::expected<model::Model, Error> LoadPage::parse_model(
+		coro::thread_pool& thread_pool,
+		const std::filesystem::path& model_path,
+		bool merge_static,
+		bool build_hlod,
+		bool build_impostors,
+		std::stop_token stop_token,
 		TaskProgress& progress
 	) noexcept
 	{
-		const auto start_time = std::chrono::high_resolution_clock::now();
+		PROFILE_ZONE("Parse model");
 
-		const auto arg = std::move(argument);
-		auto thread_pool = coro::thread_pool::make_unique();
-
-		/* Load gltf model */
+		// Decoding temporaries of the whole model, released once parsed
+		auto scratch_arena = util::ImportArena();
 
-		auto [gltf_parsing_task, gltf_parsing_progress] =
-			model::gltf::load_from_file(*thread_pool, std::filesystem::path(arg.model_path));
+		// Remote models are fetched with range requests
+		const auto model_source = model_path.string();
+		auto [gltf_parsing_task, gltf_parsing_progress] = model::gltf::is_url(model_source)
+			? model::gltf::load_from_url(thread_pool, model_source, std::move(stop_token), scratch_arena)
+			: model::gltf::load_from_file(thread_pool, model_path, std::move(stop_token), scratch_arena);
 		progress.set<TaskProgressState::Parsing>(gltf_parsing_progress);
 		auto gltf_parsing_result = coro::sync_wait(std::move(gltf_parsing_task));
 
 		if (!gltf_parsing_result) return gltf_parsing_result.error().forward("Parse gltf model failed");
-		auto gltf_model = std::move(*gltf_parsing_result);
+		auto parsed_model = std::move(*gltf_parsing_result);
+
+		if (merge_static)
+		{
+			const auto source_mesh_count = parsed_model.hierarchy.get_renderables().size();
+
+			auto merge_result = model::merge_static_geometry(std::move(parsed_model));
+			if (!merge_result) return merge_result.error().forward("Merge static geometry failed");
+
+			std::println(
+				"Merged static geometry: {} -> {} mesh references",
+				source_mesh_count,
+				merge_result->model.hierarchy.get_renderables().size()
+			);
+
+			parsed_model = std::move(merge_result->model);
+		}
+
+		if (build_hlod)
+		{
+			auto hlod_result = model::build_hlod(std::move(parsed_model));
+			if (!hlod_result) return hlod_result.error().forward("Build HLOD failed");
+
+			std::println("Built HLOD: {} clusters", hlod_result->hlod.clusters.size());
+
+			parsed_model = std::move(*hlod_result);
+		}
+
+		if (build_impostors)
+		{
+			auto impostor_result = model::bake_impostors(std::move(parsed_model));
+			if (!impostor_result) return impostor_result.error().forward("Bake impostors failed");
+
+			std::println("Baked impostors: {} meshes", impostor_result->impostors.impostors.size());
+
+			parsed_model = std::move(*impostor_result);
+		}
+
+		return parsed_model;
+	}
+
+	std::expected<std::pair<render::Model, std::optional<render::GeometryStreamer>>, Error>
+	LoadPage::load_cached_model(
+		coro::thread_pool& thread_pool,
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		ModelSource source,
+		const std::filesystem::path& model_path,
+		const render::Model::Option& model_option,
+		bool merge_static,
+		bool build_hlod,
+		bool build_impostors,
+		bool stream_geometry,
+		std::stop_token stop_token,
+		TaskProgress& progress
+	) noexcept
+	{
+		PROFILE_ZONE("Load cached model");
+
+		/* Open model cache */
+
+		const auto cache_key = render::ModelCache::get_key(source.source_hash, model_option);
+		const auto& cache_path = source.cache_path;
+
+		// One of these holds the baked model, keep alive until the model is loaded. The cache is shared with
+		// the geometry streamer, if any
+		std::shared_ptr<const render::ModelCache> model_cache;
+		std::optional<render::Model::Baked> baked_model;
+
+		// The prefetch only parses the model if no cache file exists
+		if (source.gltf_model.has_value())
+			std::println("Model cache not found, baking model");
+		else if (auto cache_result = render::ModelCache::open(cache_path, cache_key))
+			model_cache = std::make_shared<const render::ModelCache>(std::move(*cache_result));
+		else
+			std::println("Model cache unavailable ({:msg}), baking model", cache_result.error().root());
+
+		if (!model_cache)
+		{
+			/* Load gltf model, unless parsed by the prefetch */
+
+			if (!source.gltf_model.has_value())
+			{
+				auto gltf_parsing_result = parse_model(
+					thread_pool,
+					model_path,
+					merge_static,
+					build_hlod,
+					build_impostors,
+					stop_token,
+					progress
+				);
+				if (!gltf_parsing_result)
+					return gltf_parsing_result.error().forward("Load gltf model failed");
+				source.gltf_model.emplace(std::move(*gltf_parsing_result));
+			}
+			const auto gltf_model = std::move(*source.gltf_model);
+
+			/* Bake model */
+
+			auto [bake_task, bake_progress] =
+				render::Model::bake(thread_pool, gltf_model, model_option, stop_token);
+			progress.set<TaskProgressState::Processing>(bake_progress);
+
+			auto bake_result = coro::sync_wait(std::move(bake_task));
+			if (!bake_result) return bake_result.error().forward("Bake model failed");
+			baked_model.emplace(std::move(*bake_result));
+
+			// Failing to write the cache only costs the next load, not fatal. Remote models have no cache
+			// path
+			bool cache_written = false;
+			if (!cache_path.empty())
+			{
+				const auto write_result =
+					render::ModelCache::write(cache_path, cache_key, baked_model->view());
+				if (!write_result)
+					std::println("Write model cache failed: {:msg}", write_result.error().root());
+				cache_written = write_result.has_value();
+			}
+
+			// Geometry is streamed from the mapped cache, reopen the written one
+			if (cache_written && stream_geometry)
+			{
+				if (auto cache_result = render::ModelCache::open(cache_path, cache_key))
+					model_cache = std::make_shared<const render::ModelCache>(std::move(*cache_result));
+				else
+					std::println("Reopen model cache failed: {:msg}", cache_result.error().root());
+			}
+		}
 
 		/* Load render model */
 
-		const auto texture_load_opt = render::TextureList::LoadOption{
-			.color_load_strategy = render::Texture::ColorLoadStrategy::BalancedBC,
-			.exit_on_failed_load = true
-		};
+		auto baked_view = model_cache ? model_cache->view() : baked_model->view();
+
+		auto option = model_option;
+		if (stream_geometry && model_cache)
+			option.geometry_pool =
+				render::GeometryStreamer::get_pool_capacity(baked_view.mesh, config::GEOMETRY_POOL_SIZE);
+		else if (stream_geometry)
+			std::println("Model cache unavailable, geometry is loaded in full");
+
+		/* Open BLAS cache */
+
+		const auto blas_cache_key = render::BlasCache::get_key(cache_key, option);
+		const auto blas_cache_path = render::BlasCache::get_path(cache_path);
+
+		// BLASes cached for a re-baked model may come from an older cache format with the same key
+		std::optional<render::BlasCache> blas_cache;
+		if (!cache_path.empty() && !baked_model.has_value())
+		{
+			if (auto cache_result = render::BlasCache::open(blas_cache_path, blas_cache_key))
+			{
+				blas_cache.emplace(std::move(*cache_result));
+				baked_view.blas = blas_cache->view();
+			}
+			else
+				std::println("BLAS cache unavailable ({:msg}), building BLAS", cache_result.error().root());
+		}
+
+		auto [model_task, model_progress] =
+			render::Model::create(thread_pool, context, material_layout, baked_view, option, stop_token);
+		progress.set<TaskProgressState::Processing>(model_progress);
+
+		auto model_loading_result = coro::sync_wait(std::move(model_task));
+		if (!model_loading_result) return model_loading_result.error().forward("Load model failed");
+		auto model = std::move(*model_loading_result);
+
+		/* Write BLAS cache */
+
+		// Fast-built BLASes are replaced while rendering, only cache the ones kept. Failing to write the
+		// cache only costs the next load, not fatal
+		if (!cache_path.empty()
+			&& !model.blas_list.is_deserialized()
+			&& model.blas_list.get_build_preference() == render::BlasList::BuildPreference::FastTrace)
+		{
+			blas_cache.reset();
+
+			const auto write_result = model.blas_list.serialize(context).and_then(
+				[&blas_cache_path, &blas_cache_key](const render::BlasList::Serialized& serialized) {
+					return render::BlasCache::write(blas_cache_path, blas_cache_key, serialized.view());
+				}
+			);
+			if (!write_result) std::println("Write BLAS cache failed: {:msg}", write_result.error().root());
+		}
+
+		if (!option.geometry_pool.has_value()) return std::make_pair(std::move(model), std::nullopt);
+
+		/* Stream full-detail geometry from the cache */
+
+		auto geometry_streamer_result = render::GeometryStreamer::create(
+			context,
+			model_cache,
+			model.mesh_list,
+			{.frames_in_flight = config::INFLIGHT_FRAMES}
+		);
+		if (!geometry_streamer_result)
+			return geometry_streamer_result.error().forward("Create geometry streamer failed");
+
+		return std::make_pair(std::move(model), std::optional(std::move(*geometry_streamer_result)));
+	}
+
+	// (Helper) Return freed heap memory to the system. Source geometry and textures are freed after upload,
+	// but the allocator keeps the pages mapped, which would otherwise stay in the resident set
+	static void release_heap_memory() noexcept
+	{
+#ifdef __GLIBC__
+		malloc_trim(0);
+#endif
+	}
+
+	std::expected<std::pair<render::Model, render::TextureStreamer>, Error> LoadPage::load_streamed_model(
+		coro::thread_pool& thread_pool,
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		model::Model gltf_model,
+		const render::Model::Option& model_option,
+		std::stop_token stop_token,
+		TaskProgress& progress
+	) noexcept
+	{
+		PROFILE_ZONE("Load streamed model");
+
+		/* Load render model, the cache is bypassed as textures are low-resolution */
 
 		auto [model_task, model_progress] = render::Model::create(
-			*thread_pool,
-			context->device.get(),
+			thread_pool,
+			context,
 			material_layout,
 			gltf_model,
-			{.texture_load_option = texture_load_opt}
+			model_option,
+			std::move(stop_token)
 		);
 		progress.set<TaskProgressState::Processing>(model_progress);
 
@@ -76,19 +325,383 @@ namespace page
 		if (!model_loading_result) return model_loading_result.error().forward("Load model failed");
 		auto model = std::move(*model_loading_result);
 
-		const auto transforms = model.hierarchy.compute_transforms(glm::mat4(1.0));
-		auto tlas_result = render::Tlas::build(context->device.get(), model, transforms);
+		/* Stream full-resolution textures from the source */
+
+		// Detach borrowed texture data, so the gltf buffers (and the geometry and mappings within) are
+		// released with `gltf_model` instead of living as long as the streamer
+		for (auto& texture : gltf_model.material_list.textures | std::views::keys) texture.detach_source();
+
+		const auto source = std::make_shared<const model::MaterialList>(std::move(gltf_model.material_list));
+
+		// Up to half of the device-local budget, given back at runtime when other allocations need it
+		const auto device_budget = context.allocator.get_device_memory_usage().budget_bytes;
+
+		auto texture_streamer_result = render::TextureStreamer::create(
+			context,
+			source,
+			model.material_list,
+			model_option.texture_load_option,
+			{.memory_budget = device_budget / 2, .frames_in_flight = config::INFLIGHT_FRAMES}
+		);
+		if (!texture_streamer_result)
+			return texture_streamer_result.error().forward("Create texture streamer failed");
+
+		return std::make_pair(std::move(model), std::move(*texture_streamer_result));
+	}
+
+	std::expected<render::Model, Error> LoadPage::load_animated_model(
+		coro::thread_pool& thread_pool,
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		const model::Model& gltf_model,
+		const render::Model::Option& model_option,
+		std::stop_token stop_token,
+		TaskProgress& progress
+	) noexcept
+	{
+		PROFILE_ZONE("Load animated model");
+
+		/* Load render model, the cache is bypassed as baked models have no deformation data */
+
+		auto [model_task, model_progress] = render::Model::create(
+			thread_pool,
+			context,
+			material_layout,
+			gltf_model,
+			model_option,
+			std::move(stop_token)
+		);
+		progress.set<TaskProgressState::Processing>(model_progress);
+
+		auto model_loading_result = coro::sync_wait(std::move(model_task));
+		if (!model_loading_result) return model_loading_result.error().forward("Load model failed");
+
+		return std::move(*model_loading_result);
+	}
+
+	render::Model::Option LoadPage::get_model_option(
+		const Argument& argument,
+		const logic::Preset& preset
+	) noexcept
+	{
+		return logic::get_model_option(
+			preset,
+			argument.stream_textures,
+			argument.fast_build_blas,
+			argument.animate
+		);
+	}
+
+	std::expected<LoadPage::ModelSource, Error> LoadPage::prefetch_model_task(
+		Argument argument,
+		util::cpu::PoolConfig pool_config,
+		std::stop_token stop_token,
+		TaskProgress& progress
+	) noexcept
+	{
+		PROFILE_ZONE("Prefetch model task");
+
+		const auto step = helper::StartupStep("Prefetch model");
+
+		auto thread_pool = helper::create_thread_pool(pool_config);
+		const auto model_path = std::filesystem::path(argument.model_path);
+
+		// Textures are streamed from the parsed source, animated models need the deformation data dropped by
+		// baking, and remote models can't be hashed without fetching them in full. The cache is bypassed
+		if (argument.stream_textures || argument.animate || model::gltf::is_url(argument.model_path))
+		{
+			auto gltf_parsing_result = parse_model(
+				*thread_pool,
+				model_path,
+				argument.merge_static,
+				argument.hlod,
+				argument.impostor,
+				stop_token,
+				progress
+			);
+			if (!gltf_parsing_result) return gltf_parsing_result.error().forward("Load gltf model failed");
+
+			return ModelSource{
+				.thread_pool = std::move(thread_pool),
+				.gltf_model = std::move(*gltf_parsing_result),
+				.source_hash = 0,
+				.cache_path = {},
+			};
+		}
+
+		/* Locate model cache */
+
+		const auto source_hash_result = render::ModelCache::hash_file(model_path);
+		if (!source_hash_result) return source_hash_result.error().forward("Hash model file failed");
+
+		auto cache_path = logic::get_model_cache_path(
+			*source_hash_result,
+			argument.merge_static,
+			argument.hlod,
+			argument.impostor
+		);
+
+		// The cache file probably holds the model, validated against the key in `load_cached_model`
+		auto error_code = std::error_code();
+		if (std::filesystem::exists(cache_path, error_code))
+			return ModelSource{
+				.thread_pool = std::move(thread_pool),
+				.gltf_model = std::nullopt,
+				.source_hash = *source_hash_result,
+				.cache_path = std::move(cache_path),
+			};
+
+		/* Load gltf model, the cache is known to miss */
+
+		auto gltf_parsing_result = parse_model(
+			*thread_pool,
+			model_path,
+			argument.merge_static,
+			argument.hlod,
+			argument.impostor,
+			stop_token,
+			progress
+		);
+		if (!gltf_parsing_result) return gltf_parsing_result.error().forward("Load gltf model failed");
+
+		return ModelSource{
+			.thread_pool = std::move(thread_pool),
+			.gltf_model = std::move(*gltf_parsing_result),
+			.source_hash = *source_hash_result,
+			.cache_path = std::move(cache_path),
+		};
+	}
+
+	std::expected<LoadPage::LoadResult, Error> LoadPage::load_model_task(
+		std::shared_ptr<const resource::Context> context,  // NOLINT: intended to own
+		const render::MaterialLayout& material_layout,
+		Argument argument,
+		render::Model::Option model_option,
+		util::Future<std::expected<ModelSource, Error>> source_future,
+		std::stop_token stop_token,
+		TaskProgress& progress
+	) noexcept
+	{
+		PROFILE_ZONE("Load model task");
+
+		auto step = helper::StartupStep("Load model");
+
+		const auto arg = std::move(argument);
+
+		auto source_result = std::move(source_future).get();
+		if (!source_result) return source_result.error().forward("Prefetch model failed");
+		auto source = std::move(*source_result);
+		auto thread_pool = std::move(source.thread_pool);
+
+		std::optional<render::Model> model;
+		std::optional<render::TextureStreamer> texture_streamer;
+		std::optional<render::GeometryStreamer> geometry_streamer;
+
+		if (arg.stream_textures)
+		{
+			auto load_result = load_streamed_model(
+				*thread_pool,
+				context->device.get(),
+				material_layout,
+				std::move(*source.gltf_model),
+				model_option,
+				stop_token,
+				progress
+			);
+			if (!load_result) return load_result.error().forward("Load streamed model failed");
+
+			model.emplace(std::move(load_result->first));
+			texture_streamer.emplace(std::move(load_result->second));
+		}
+		else if (arg.animate)
+		{
+			auto load_result = load_animated_model(
+				*thread_pool,
+				context->device.get(),
+				material_layout,
+				*source.gltf_model,
+				model_option,
+				stop_token,
+				progress
+			);
+			if (!load_result) return load_result.error().forward("Load animated model failed");
+
+			model.emplace(std::move(*load_result));
+		}
+		else
+		{
+			auto load_result = load_cached_model(
+				*thread_pool,
+				context->device.get(),
+				material_layout,
+				std::move(source),
+				std::filesystem::path(arg.model_path),
+				model_option,
+				arg.merge_static,
+				arg.hlod,
+				arg.impostor,
+				arg.stream_geometry,
+				stop_token,
+				progress
+			);
+			if (!load_result) return load_result.error().forward("Load cached model failed");
+
+			model.emplace(std::move(load_result->first));
+			geometry_streamer = std::move(load_result->second);
+		}
+
+		if (stop_token.stop_requested()) return Error("Cancelled");
+
+		/* Release CPU-side loading resources, only GPU resources and the hierarchy are kept */
+
+		thread_pool.reset();
+		release_heap_memory();
+
+		const auto transforms = model->hierarchy.compute_transforms(glm::mat4(1.0));
+		auto tlas_result = render::Tlas::build(context->device.get(), *model, transforms);
 		if (!tlas_result) return tlas_result.error().forward("Create TLAS for scene failed");
 		auto tlas = std::move(*tlas_result);
 
-		const auto end_time = std::chrono::high_resolution_clock::now();
-		const std::chrono::duration<double> elapsed = end_time - start_time;
-		std::println("Model loaded in {:.3f} seconds", elapsed.count());
+		step.end();
 
-		return std::make_tuple(std::move(model), std::move(tlas));
+		// The trace is a diagnostic, failing to write it doesn't fail the load
+		if (arg.load_trace_path.has_value())
+		{
+			if (const auto result = util::trace::stop_and_write(*arg.load_trace_path); result)
+				std::println("Load trace written to {}", *arg.load_trace_path);
+			else
+				std::println("Write load trace failed: {:msg}", result.error().root());
+		}
+
+		const auto blas_memory = model->blas_list.get_memory_stat();
+		std::println(
+			"BLAS memory: {:.2f} MiB -> {:.2f} MiB after compaction",
+			static_cast<double>(blas_memory.original_size) / 1048576.0,
+			static_cast<double>(blas_memory.compacted_size) / 1048576.0
+		);
+		std::println(
+			"BLAS count: {} for {} meshes",
+			model->blas_list->blas.size(),
+			model->blas_list->mesh_blas_index.size()
+		);
+
+		return std::make_tuple(
+			std::move(*model),
+			std::move(tlas),
+			std::move(texture_streamer),
+			std::move(geometry_streamer)
+		);
 	}
 
-	std::expected<LoadPage, Error> LoadPage::from(resource::Context context, Argument argument) noexcept
+	std::expected<resource::Pipeline, Error> LoadPage::load_pipeline_task(
+		std::shared_ptr<const resource::Context> context,  // NOLINT: intended to own
+		const render::MaterialLayout& material_layout,
+		render::VertexFormat vertex_format,
+		vk::Format composite_format,
+		vk::Format hdr_format,
+		resource::Pipeline::GBufferPath gbuffer_path,
+		util::cpu::PoolConfig pool_config
+	) noexcept
+	{
+		PROFILE_ZONE("Load pipeline task");
+
+		const auto step = helper::StartupStep("Create pipelines");
+
+		auto thread_pool = helper::create_thread_pool(pool_config);
+
+		auto pipeline_result = resource::Pipeline::create(
+			*thread_pool,
+			context->device.get(),
+			material_layout,
+			vertex_format,
+			composite_format,
+			hdr_format,
+			gbuffer_path
+		);
+		if (!pipeline_result) return pipeline_result.error().forward("Create pipelines failed");
+
+		return std::move(*pipeline_result);
+	}
+
+	LoadPage::Prefetch LoadPage::prefetch(const Argument& argument) noexcept
+	{
+		// Started first, so that the trace also covers the Vulkan bring-up
+		if (argument.load_trace_path.has_value()) util::trace::start();
+
+		auto stop_source = std::stop_source();
+		auto progress = std::make_unique<TaskProgress>(TaskProgress::from<TaskProgressState::Preparing>());
+
+		// The device isn't probed yet, only a tier given by `--tier` picks the pool config of its preset
+		const auto pool_config = argument.get_pool_config(
+			argument.tier.has_value() ? logic::Preset::from_tier(*argument.tier).pool_config
+									  : util::cpu::PoolConfig()
+		);
+
+		auto source_future = std::async(
+			std::launch::async,
+			prefetch_model_task,
+			argument,
+			pool_config,
+			stop_source.get_token(),
+			std::ref(*progress)
+		);
+
+		return Prefetch{
+			.stop_source = std::move(stop_source),
+			.progress = std::move(progress),
+			.source_future = util::Future(std::move(source_future)),
+		};
+	}
+
+	LoadPage::BackgroundLoad LoadPage::load_in_background(
+		std::shared_ptr<const resource::Context> context,
+		const render::MaterialLayout& material_layout,
+		Argument argument,
+		const logic::Preset& preset
+	) noexcept
+	{
+		// The load trace only covers the startup
+		argument.load_trace_path = std::nullopt;
+
+		auto stop_source = std::stop_source();
+		auto progress = std::make_unique<TaskProgress>(TaskProgress::from<TaskProgressState::Preparing>());
+		auto model_option = get_model_option(argument, preset);
+
+		// No bring-up to overlap with, the prefetch runs on the loading thread once the source is awaited
+		auto source_future = std::async(
+			std::launch::deferred,
+			prefetch_model_task,
+			argument,
+			argument.get_pool_config(preset.pool_config),
+			stop_source.get_token(),
+			std::ref(*progress)
+		);
+
+		auto model_future = std::async(
+			std::launch::async,
+			load_model_task,
+			std::move(context),
+			std::cref(material_layout),
+			argument,
+			std::move(model_option),
+			util::Future(std::move(source_future)),
+			stop_source.get_token(),
+			std::ref(*progress)
+		);
+
+		return BackgroundLoad{
+			.argument = std::move(argument),
+			.stop_source = std::move(stop_source),
+			.progress = std::move(progress),
+			.model_future = util::Future(std::move(model_future)),
+		};
+	}
+
+	std::expected<LoadPage, Error> LoadPage::from(
+		resource::Context context,
+		Argument argument,
+		Prefetch prefetch
+	) noexcept
 	{
 		auto material_layout_result = render::MaterialLayout::create(context.device.get());
 		if (!material_layout_result)
@@ -100,25 +713,73 @@ namespace page
 		if (!imgui_page_result) return imgui_page_result.error().forward("Create ImGui page failed");
 		auto imgui_page = std::move(*imgui_page_result);
 
-		auto progress = std::make_unique<TaskProgress>(TaskProgress::from<TaskProgressState::Preparing>());
+		const auto composite_format = context.swapchain->surface_format.format;
 		auto context_res = std::make_shared<resource::Context>(std::move(context));
 
+		/* Pick performance preset */
+
+		const auto capability = vulkan::DeviceCapability::probe(context_res->device.get().phy_device);
+		const auto tier = argument.tier.value_or(capability.get_tier());
+		auto preset = logic::Preset::from_tier(tier);
+		preset.fit_textures(render::Texture::CompressionSupport::query(context_res->device.get().phy_device));
+		preset.fit_hdr_format(context_res->device.get().phy_device);
+
+		// The main thread renders and submits the frames
+		const auto pool_config = argument.get_pool_config(preset.pool_config);
+		helper::pin_render_thread(pool_config);
+
+		std::println(
+			"Device tier: {}{} (VRAM {:.1f} GiB, ray query {}, mesh shader {}, VRS {}, ReBAR {}, "
+			"subgroup {})",
+			logic::get_tier_name(tier),
+			argument.tier.has_value() ? ", overridden" : "",
+			static_cast<double>(capability.device_local_size) / (1024.0 * 1024.0 * 1024.0),
+			capability.ray_query,
+			capability.mesh_shader,
+			capability.fragment_shading_rate,
+			capability.resizable_bar,
+			capability.subgroup_size
+		);
+
+		auto model_option = get_model_option(argument, preset);
+		const auto vertex_format = model_option.vertex_format;
+
 		auto model_future = std::async(
 			std::launch::async,
 			load_model_task,
 			context_res,
 			std::cref(*material_layout),
-			std::move(argument),
-			std::ref(*progress)
+			argument,
+			std::move(model_option),
+			std::move(prefetch.source_future),
+			prefetch.stop_source.get_token(),
+			std::ref(*prefetch.progress)
+		);
+
+		// Pipelines only depend on the material layout and vertex format, overlap their creation with loading
+		auto pipeline_future = std::async(
+			std::launch::async,
+			load_pipeline_task,
+			context_res,
+			std::cref(*material_layout),
+			vertex_format,
+			composite_format,
+			preset.hdr_format,
+			argument.gbuffer_path,
+			pool_config
 		);
 
 		return LoadPage(
 			std::move(context_res),
 			std::move(imgui_page),
+			std::move(argument),
+			preset,
 			Task{
+				.stop_source = std::move(prefetch.stop_source),
 				.material_layout = std::move(material_layout),
-				.progress = std::move(progress),
+				.progress = std::move(prefetch.progress),
 				.model_future = util::Future(std::move(model_future)),
+				.pipeline_future = util::Future(std::move(pipeline_future)),
 			}
 		);
 	}
@@ -144,9 +805,14 @@ namespace page
 				return ResultType::from<Result::Continue>();
 
 			case helper::ImGuiPage::ResultState::Quit:
-				std::ignore = std::move(state_data).get<State::Loading>().model_future.get();
+			{
+				auto task = std::move(state_data).get<State::Loading>();
+				task.stop_source.request_stop();
+				std::ignore = std::move(task.model_future).get();
+				std::ignore = std::move(task.pipeline_future).get();
 				if (const auto result = context->device->waitIdle(); !result) return Error::from(result);
 				return ResultType::from<Result::Quit>();
+			}
 
 			case helper::ImGuiPage::ResultState::Error:
 				if (const auto result = context->device->waitIdle(); !result) return Error::from(result);
@@ -185,7 +851,12 @@ namespace page
 				context,
 				std::move(*success_data.material_layout),
 				std::move(success_data.model),
-				std::move(success_data.tlas)
+				std::move(success_data.tlas),
+				std::move(success_data.texture_streamer),
+				std::move(success_data.geometry_streamer),
+				std::move(success_data.pipeline),
+				argument,
+				preset
 			);
 			if (!render_page_result) return render_page_result.error().forward("Create render page failed");
 
@@ -269,7 +940,10 @@ namespace page
 	LoadPage::StateData LoadPage::ui(Task task) noexcept
 	{
 		begin_centered_window("Loading");
-		switch (task.progress->tag())
+
+		// Read the state once, the tag and the value of the snapshot stay consistent
+		const auto& progress = task.progress->load();
+		switch (progress.tag())
 		{
 		case TaskProgressState::Preparing:
 			ImGui::Text("Preparing...");
@@ -278,7 +952,7 @@ namespace page
 
 		case TaskProgressState::Parsing:
 		{
-			const auto& state = *task.progress->get<TaskProgressState::Parsing>();
+			const auto& state = progress.get<TaskProgressState::Parsing>()->load();
 			ImGui::Text(
 				"(%zu/%zu) %s",
 				state.index() + 1,
@@ -290,7 +964,7 @@ namespace page
 		}
 		case TaskProgressState::Processing:
 		{
-			const auto& state = *task.progress->get<TaskProgressState::Processing>();
+			const auto& state = progress.get<TaskProgressState::Processing>()->load();
 			ImGui::Text(
 				"(%zu/%zu) %s",
 				state.index() + 1,
@@ -310,17 +984,24 @@ namespace page
 		}
 		ImGui::End();
 
-		if (task.model_future.ready())
+		// Both tasks reference the material layout, wait for both before leaving the loading state
+		if (task.model_future.ready() && task.pipeline_future.ready())
 		{
 			auto result = std::move(task.model_future).get();
 			if (!result) return StateData::from<State::Error>(result.error());
 
-			auto [model, tlas] = std::move(*result);
+			auto pipeline_result = std::move(task.pipeline_future).get();
+			if (!pipeline_result) return StateData::from<State::Error>(pipeline_result.error());
+
+			auto [model, tlas, texture_streamer, geometry_streamer] = std::move(*result);
 
 			return StateData::from<State::Success>({
 				.model = std::move(model),
 				.tlas = std::move(tlas),
+				.texture_streamer = std::move(texture_streamer),
+				.geometry_streamer = std::move(geometry_streamer),
 				.material_layout = std::move(task.material_layout),
+				.pipeline = std::move(*pipeline_result),
 			});
 		}
 
@@ -1,45 +1,180 @@
 #include "page/render.hpp"
+#include "argument.hpp"
+#include "common/file.hpp"
+#include "common/util/async.hpp"
 #include "common/util/construct.hpp"
 #include "common/util/error.hpp"
+#include "common/util/profile.hpp"
 #include "config.hpp"
-#include "render/interface/primitive-drawcall.hpp"
+#include "helper/startup.hpp"
+#include "helper/thread-pool.hpp"
+#include "model/bvh.hpp"
+#include "page/load.hpp"
+#include "render/model/blas.hpp"
 #include "render/model/material.hpp"
 #include "render/model/model.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/interface/cull-view.hpp"
+#include "render/interface/primitive-drawcall.hpp"
 #include "render/model/tlas.hpp"
+#include "render/pipeline/ambient-occlusion.hpp"
+#include "render/pipeline/bloom.hpp"
+#include "render/pipeline/hiz.hpp"
+#include "render/pipeline/indirect.hpp"
+#include "render/pipeline/path-trace.hpp"
+#include "render/resource/ambient-occlusion.hpp"
+#include "render/resource/cascade-shadow.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/path-trace.hpp"
+#include "render/util/cascade.hpp"
 #include "render/util/per-render-state.hpp"
+#include "render/util/render-graph.hpp"
 #include "resource/aux-resource.hpp"
 #include "resource/context.hpp"
 #include "resource/pipeline.hpp"
 #include "resource/render-resource.hpp"
 #include "resource/sync-primitive.hpp"
+#include "vulkan/container/device/readback-ring.hpp"
 #include "vulkan/container/host/cycle.hpp"
+#include "vulkan/container/host/frame-arena.hpp"
 #include "vulkan/numeric/base-level.hpp"
 #include "vulkan/numeric/glm.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/gpu-profiler.hpp"
+#include "vulkan/util/secondary-recorder.hpp"
+#include "vulkan/util/timestamp-query.hpp"
 
 #include <SDL3/SDL_events.h>
+#include <SDL3/SDL_mouse.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <format>
+#include <future>
+#include <glm/common.hpp>
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
 #include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
 #include <imgui.h>
 #include <imgui_impl_sdl3.h>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <print>
 #include <ranges>
 #include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <utility>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_structs.hpp>
 
 namespace page
 {
+	namespace
+	{
+		// Timestamp scope, debug label and pipeline statistics slot names of `RenderPage::ParallelPass`,
+		// null-terminated as they view string literals
+		constexpr auto PARALLEL_PASS_NAMES = std::to_array<std::string_view>({
+			"Transform",
+			"Shading Rate",
+			"Culling (Early)",
+			"G-Buffer (Early)",
+			"HiZ (Early)",
+			"Culling (Late)",
+			"G-Buffer (Late)",
+			"HiZ (Late)",
+			"Light Culling",
+			"Shadow",
+			"Ambient Occlusion",
+			"Global Illumination",
+			"Direct Lighting",
+			"ReSTIR",
+			"Reflection",
+			"Path Trace",
+			"Transparent",
+		});
+
+		// World-space box of each node, bounding the primitives of its mesh. HLOD proxies are left empty, as
+		// they only stand in for their source nodes
+		std::vector<model::Aabb> get_node_bounds(
+			const render::Model& model,
+			std::span<const glm::mat4> transforms
+		) noexcept
+		{
+			std::vector<model::Aabb> bounds(transforms.size());
+
+			for (const auto& drawcall : model.hierarchy.get_renderables())
+			{
+				if (model.scene_graph.is_hlod_proxy(drawcall.node_index)) continue;
+
+				const auto range = model.mesh_list->mesh_ranges_array[drawcall.mesh_index];
+				const auto attributes =
+					model.mesh_list->primitive_attr_array.subspan(range.offset, range.count);
+
+				auto mesh_bound = model::Aabb();
+				for (const auto& attribute : attributes)
+					mesh_bound = mesh_bound.merge({.min = attribute.aabb_min, .max = attribute.aabb_max});
+
+				auto& bound = bounds[drawcall.node_index];
+				bound = bound.merge(mesh_bound.transform(transforms[drawcall.node_index]));
+			}
+
+			return bounds;
+		}
+
+		// Environment lighting of the map at `path`, or a black placeholder without one
+		std::expected<render::EnvironmentLighting, Error> create_environment_lighting(
+			const vulkan::Context& context,
+			const std::optional<std::string>& path
+		) noexcept
+		{
+			if (!path.has_value())
+				return render::EnvironmentLighting::create_uniform(context, glm::vec3(0.0f));
+
+			auto file_result = file::read(*path);
+			if (!file_result) return file_result.error().forward("Read environment map failed");
+
+			auto image_result = render::EnvironmentLighting::EquirectImage::decode(
+				*file_result,
+				render::EnvironmentLighting::EQUIRECT_DECODE_SIZE
+			);
+			if (!image_result) return image_result.error().forward("Decode environment map failed");
+
+			return render::EnvironmentLighting::create(context, *image_result);
+		}
+	}
+
 	std::expected<RenderPage, Error> RenderPage::create(
 		std::shared_ptr<resource::Context> context,
 		render::MaterialLayout material_layout,
 		render::Model model,
-		render::Tlas tlas
+		render::Tlas tlas,
+		std::optional<render::TextureStreamer> texture_streamer,
+		std::optional<render::GeometryStreamer> geometry_streamer,
+		resource::Pipeline pipeline,
+		Argument argument,
+		logic::Preset preset
 	) noexcept
 	{
 		auto command_pool_result = context->device->createCommandPool({
@@ -56,6 +191,20 @@ namespace page
 		if (!command_buffers_result) return Error::from(command_buffers_result);
 		auto command_buffers = std::move(*command_buffers_result);
 
+		auto compute_command_pool_result = context->device->createCommandPool({
+			.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+			.queueFamilyIndex = context->device.get().compute_family,
+		});
+		if (!compute_command_pool_result) return Error::from(compute_command_pool_result);
+		auto compute_command_pool = std::move(*compute_command_pool_result);
+
+		auto compute_command_buffers_result = context->device->allocateCommandBuffers({
+			.commandPool = compute_command_pool,
+			.commandBufferCount = config::INFLIGHT_FRAMES,
+		});
+		if (!compute_command_buffers_result) return Error::from(compute_command_buffers_result);
+		auto compute_command_buffers = std::move(*compute_command_buffers_result);
+
 		auto render_buffers_result =
 			std::views::repeat(resource::RenderResource::create, config::INFLIGHT_FRAMES)
 			| std::views::transform([&context](auto f) { return f(context->device.get()); })
@@ -72,13 +221,50 @@ namespace page
 			return sync_primitives_result.error().forward("Create sync primitives failed");
 		auto sync_primitives = std::move(*sync_primitives_result);
 
-		auto pipeline_result = resource::Pipeline::create(
-			context->device.get(),
-			material_layout,
-			context->swapchain->surface_format.format
-		);
-		if (!pipeline_result) return pipeline_result.error().forward("Create pipelines failed");
-		auto pipeline = std::move(*pipeline_result);
+		auto timestamp_queries_result =
+			std::views::repeat(
+				[&context] { return vulkan::TimestampQuery::create(context->device.get()); },
+				config::INFLIGHT_FRAMES
+			)
+			| std::views::transform([](const auto& f) { return f(); })
+			| Error::collect();
+		if (!timestamp_queries_result)
+			return timestamp_queries_result.error().forward("Create timestamp queries failed");
+		auto timestamp_queries = std::move(*timestamp_queries_result);
+
+		auto statistics_queries_result =
+			std::views::repeat(
+				[&context] {
+					return vulkan::PipelineStatisticsQuery::create(
+						context->device.get(),
+						PARALLEL_PASS_NAMES
+					);
+				},
+				config::INFLIGHT_FRAMES
+			)
+			| std::views::transform([](const auto& f) { return f(); })
+			| Error::collect();
+		if (!statistics_queries_result)
+			return statistics_queries_result.error().forward("Create pipeline statistics queries failed");
+		auto statistics_queries = std::move(*statistics_queries_result);
+
+		auto gpu_profiler_result =
+			vulkan::GpuProfiler::create(context->instance->instance, context->device.get());
+		if (!gpu_profiler_result) return gpu_profiler_result.error().forward("Create GPU profiler failed");
+		auto gpu_profiler = std::move(*gpu_profiler_result);
+
+		auto secondary_recorders_result =
+			std::views::repeat(
+				[&context] {
+					return vulkan::SecondaryRecorder::create(context->device.get(), PARALLEL_PASS_COUNT);
+				},
+				config::INFLIGHT_FRAMES
+			)
+			| std::views::transform([](const auto& f) { return f(); })
+			| Error::collect();
+		if (!secondary_recorders_result)
+			return secondary_recorders_result.error().forward("Create secondary recorders failed");
+		auto secondary_recorders = std::move(*secondary_recorders_result);
 
 		auto resource_sets_result =
 			pipeline.create_resource_sets(context->device.get(), config::INFLIGHT_FRAMES);
@@ -89,9 +275,13 @@ namespace page
 			std::views::zip_transform(
 				CTOR_LAMBDA(FrameResource),
 				command_buffers | std::views::as_rvalue,
+				compute_command_buffers | std::views::as_rvalue,
 				render_buffers | std::views::as_rvalue,
 				resource_sets | std::views::as_rvalue,
-				sync_primitives | std::views::as_rvalue
+				sync_primitives | std::views::as_rvalue,
+				timestamp_queries | std::views::as_rvalue,
+				statistics_queries | std::views::as_rvalue,
+				secondary_recorders | std::views::as_rvalue
 			)
 			| vulkan::Cycle<FrameResource>::into;
 
@@ -110,33 +300,117 @@ namespace page
 			);
 		auto render_complete_semaphores = std::move(*render_complete_semaphores_result);
 
+		// Object picks read back a single drawcall per frame
+		auto readback_ring_result = vulkan::ReadbackRing::create(
+			context->device.get(),
+			config::INFLIGHT_FRAMES,
+			sizeof(render::PrimitiveDrawcall)
+		);
+		if (!readback_ring_result) return readback_ring_result.error().forward("Create readback ring failed");
+
 		auto aux_resource_result = resource::AuxResource::create(context->device.get());
 		if (!aux_resource_result)
 			return aux_resource_result.error().forward("Create auxiliary resources failed");
 		auto aux_resource = std::move(*aux_resource_result);
 
+		const auto gi_probe_grid = render::GiProbeVolume::fit_grid(
+			model,
+			model.hierarchy.compute_transforms(glm::mat4(1.0)),
+			config::GI_PROBE_MAX_COUNT
+		);
+		auto gi_probe_volume_result = render::GiProbeVolume::create(
+			context->device.get(),
+			gi_probe_grid,
+			config::GI_PROBE_RAY_CAPACITY
+		);
+		if (!gi_probe_volume_result)
+			return gi_probe_volume_result.error().forward("Create probe volume failed");
+		auto gi_probe_volume = std::move(*gi_probe_volume_result);
+
+		auto environment_lighting_result =
+			create_environment_lighting(context->device.get(), argument.environment_path);
+		if (!environment_lighting_result)
+			return environment_lighting_result.error().forward("Create environment lighting failed");
+		auto environment_lighting = std::move(*environment_lighting_result);
+
+		// Drawn with the generic variant until the variants of the model are compiled
+		pipeline.deferred.request_variants(model.material_list);
+
 		return RenderPage(
 			std::move(context),
 			std::move(command_pool),
+			std::move(compute_command_pool),
 			std::move(material_layout),
 			std::move(model),
 			std::move(tlas),
+			std::move(texture_streamer),
+			std::move(geometry_streamer),
 			std::move(pipeline),
+			std::move(gpu_profiler),
 			std::move(frame_resources),
 			std::move(render_complete_semaphores),
-			std::move(aux_resource)
+			std::move(*readback_ring_result),
+			std::move(aux_resource),
+			std::move(gi_probe_volume),
+			std::move(environment_lighting),
+			std::move(argument),
+			preset
 		);
 	}
 
 	std::expected<RenderPage::ResultType, Error> RenderPage::run_frame() noexcept
 	{
+		PROFILE_ZONE("Run frame");
+
+		if (const auto pace_result = pace_frame(); !pace_result)
+		{
+			if (const auto result = context->device->waitIdle(); !result) return Error::from(result);
+			return pace_result.error().forward("Pace frame failed");
+		}
+		const auto frame_start = logic::Latency::Clock::now();
+
+		if (const auto result = open_input_record(); !result)
+			return result.error().forward("Open input record failed");
+
 		const auto event = handle_events();
-		if (event == Event::Quit)
+		const auto replay_finished = input_replay.has_value() && input_replay->finished();
+		if (event == Event::Quit || replay_finished)
 		{
+			if (model_load.has_value()) model_load->stop_source.request_stop();
 			if (const auto result = context->device->waitIdle(); !result) return Error::from(result);
+
+			// Frames still in flight are written before the encoder is closed
+			if (frame_capture.has_value())
+				if (const auto result = frame_capture->flush(); !result)
+					return result.error().forward("Flush frame capture failed");
+
+			if (input_capture.has_value())
+				if (const auto result = input_capture->flush(); !result)
+					return result.error().forward("Flush input capture failed");
+
 			return ResultType::from<Result::Quit>();
 		}
 
+		// Replayed frames never idle, and render at the recorded scale
+		if (input_replay.has_value()) input_replay->apply(param);
+
+		const auto now = logic::Idle::Clock::now();
+		if (event == Event::Input || !param.idle.last_activity.has_value()) param.idle.mark_active(now);
+		if (event == Event::Input) param.overlay.mark_input();
+
+		// Nothing changes on screen, block until the next event instead of rendering
+		if (param.idle.settled(now, param.exposure) && !has_pending_work())
+		{
+			if (const auto result = update_defragmentation(); !result)
+				return result.error().forward("Update defragmentation failed");
+
+			SDL_WaitEventTimeout(nullptr, param.idle.wake_interval_ms);
+			frame_timing.skip_interval();
+			return ResultType::from<Result::Continue>();
+		}
+
+		const auto render_scale = param.resolution.scale;
+
 		auto prepare_frame_result = prepare_frame();
 		if (!prepare_frame_result)
 		{
@@ -158,15 +432,113 @@ namespace page
 			return present_result.error().forward("Present frame failed");
 		}
 
+		if (const auto present_id = context->swapchain.last_present_id())
+			param.latency.push(*present_id, frame_start);
+
+		if (input_capture.has_value())
+			if (const auto result =
+					input_capture->push(param, frame_delta_time, frame.swapchain.extent, render_scale);
+				!result)
+				return result.error().forward("Record input failed");
+
+		if (input_replay.has_value()) input_replay->advance();
+
+		helper::mark_first_frame();
+
+		const auto present_time = logic::FrameTiming::Clock::now();
+		frame_timing.end_frame(
+			std::chrono::duration<double, std::milli>(present_time - frame_start).count(),
+			present_time
+		);
+
+		PROFILE_FRAME();
+
 		return ResultType::from<Result::Continue>();
 	}
 
+	std::expected<void, Error> RenderPage::open_input_record() noexcept
+	{
+		if (argument.capture_input_path.has_value() && !input_capture.has_value())
+		{
+			auto input_capture_result = logic::InputCapture::create(*argument.capture_input_path);
+			if (!input_capture_result)
+				return input_capture_result.error().forward("Create input capture failed");
+			input_capture.emplace(std::move(*input_capture_result));
+		}
+
+		if (argument.replay_input_path.has_value() && !input_replay.has_value())
+		{
+			auto input_replay_result = logic::InputReplay::load(*argument.replay_input_path);
+			if (!input_replay_result) return input_replay_result.error().forward("Load input replay failed");
+			input_replay.emplace(std::move(*input_replay_result));
+		}
+
+		return {};
+	}
+
+	std::expected<void, Error> RenderPage::pace_frame() noexcept
+	{
+		PROFILE_ZONE("Pace frame");
+
+		// Bounded, so that an occluded window which never displays does not stall the frame loop
+		static constexpr uint64_t PRESENT_WAIT_TIMEOUT = 100'000'000;  // 100 ms
+
+		const auto& swapchain = context->swapchain;
+		const auto present_wait = context->device.supports_present_wait();
+		const auto max_queued_frames =
+			std::clamp(param.latency.max_queued_frames, 1u, config::INFLIGHT_FRAMES);
+
+		/* Wait */
+
+		if (param.latency.low_latency)
+		{
+			// The upcoming frame starts once the frame `max_queued_frames` before it is displayed
+			const auto last_present_id = swapchain.last_present_id();
+			if (present_wait && last_present_id && *last_present_id >= max_queued_frames)
+			{
+				const auto wait_id = *last_present_id + 1 - max_queued_frames;
+
+				const auto wait_result = swapchain.wait_present(wait_id, PRESENT_WAIT_TIMEOUT);
+				if (!wait_result) return wait_result.error().forward("Wait for present failed");
+				if (*wait_result) param.latency.complete(wait_id, logic::Latency::Clock::now());
+			}
+			else if (!present_wait)
+			{
+				// Fallback to GPU completion, `history(0)` holds the latest submitted frame before cycling
+				const auto& frame_resource = frame_resources.history(max_queued_frames - 1);
+				const auto& fence = frame_resource.sync_primitive.draw_fence;
+				if (const auto wait_result = context->device->waitForFences(*fence, vk::True, UINT64_MAX);
+					wait_result != vk::Result::eSuccess)
+					return Error::from(wait_result);
+			}
+		}
+
+		/* Measure */
+
+		if (!present_wait) return {};
+
+		while (const auto present_id = param.latency.oldest_pending())
+		{
+			const auto poll_result = swapchain.wait_present(*present_id, 0);
+			if (!poll_result) return poll_result.error().forward("Poll present failed");
+			if (!*poll_result) break;
+
+			param.latency.complete(*present_id, logic::Latency::Clock::now());
+		}
+
+		return {};
+	}
+
 	std::expected<std::optional<RenderPage::FrameAcquireResult>, Error> RenderPage::acquire_frame() noexcept
 	{
+		PROFILE_ZONE("Acquire frame");
+
 		/* Cycle & Wait */
 
 		frame_resources.cycle();
 
+		const auto wait_start = logic::FrameTiming::Clock::now();
+
 		if (const auto wait_result = context->device->waitForFences(
 				*frame_resources.current().sync_primitive.draw_fence,
 				vk::True,
@@ -175,6 +547,31 @@ namespace page
 			wait_result != vk::Result::eSuccess)
 			return Error::from(wait_result);
 
+		// Async auto-exposure of the frame also reads its resources
+		const auto exposure_semaphore = *frame_resources.current().sync_primitive.timeline_semaphore;
+		const auto exposure_value = frame_resources.current().sync_primitive.exposure_value();
+		if (const auto wait_result = context->device->waitSemaphores(
+				vk::SemaphoreWaitInfo().setSemaphores(exposure_semaphore).setValues(exposure_value),
+				UINT64_MAX
+			);
+			wait_result != vk::Result::eSuccess)
+			return Error::from(wait_result);
+
+		frame_timing.push_fence_wait(
+			std::chrono::duration<double, std::milli>(logic::FrameTiming::Clock::now() - wait_start).count()
+		);
+
+		// Every frame recorded before the last `INFLIGHT_FRAMES` frames has completed
+		deletion_queue.advance();
+		frame_resources.current().frame_arena->reset();
+
+		if (const auto result = readback_ring.begin_frame(); !result)
+			return result.error().forward("Read back frame results failed");
+
+		if (frame_capture.has_value())
+			if (const auto result = frame_capture->begin_frame(); !result)
+				return result.error().forward("Advance frame capture failed");
+
 		auto& curr_resource = frame_resources.current();
 		auto& prev_resource = frame_resources.prev();
 
@@ -191,76 +588,435 @@ namespace page
 
 		/* Check, recreate attachments if needed */
 
+		const auto render_extent = param.resolution.get_extent(swapchain_frame.extent);
+
 		if (swapchain_frame.extent_changed || !curr_resource.render_resource.attachments)
 		{
-			if (const auto result = context->device->waitIdle(); !result) return Error::from(result);
-
-			// NOTE: recreating every set is intended
+			// NOTE: recreating every set is intended, old attachments used by frames in flight are retired
 			for (auto& resource : frame_resources.iterate())
 			{
 				auto render_target_result = resource.render_resource.resize_attachments(
 					context->device.get(),
-					swapchain_frame.extent
+					deletion_queue,
+					swapchain_frame.extent,
+					render_extent,
+					preset.half_resolution_shadow,
+					preset.ambient_occlusion_resolution,
+					preset.hdr_format,
+					pipeline.visibility.has_value(),
+					param.restir.enabled
 				);
 				if (!render_target_result)
 					return render_target_result.error().forward("Create render target failed");
 			}
+
+			hiz_history_valid = false;
+			taa_history_valid = false;
+			ambient_occlusion_history_valid = false;
+			restir_history_valid = false;
+			reflection_history_valid = false;
+			static_view_history.reset();
+		}
+		else if (curr_resource.render_resource.attachments->hdr->extent != render_extent
+			|| curr_resource.render_resource.attachments->restir.has_value() != param.restir.enabled)
+		{
+			// Render scale changed or ReSTIR toggled, TAA attachments stay at the swapchain extent and keep
+			// the history. Render attachments are only reallocated if the new extent exceeds their capacity,
+			// or to allocate or free the ReSTIR attachment
+			for (auto& resource : frame_resources.iterate())
+			{
+				auto render_target_result = resource.render_resource.resize_render_attachments(
+					context->device.get(),
+					deletion_queue,
+					render_extent,
+					preset.half_resolution_shadow,
+					preset.ambient_occlusion_resolution,
+					preset.hdr_format,
+					pipeline.visibility.has_value(),
+					param.restir.enabled
+				);
+				if (!render_target_result)
+					return render_target_result.error().forward("Resize render target failed");
+			}
+
+			hiz_history_valid = false;
+			ambient_occlusion_history_valid = false;
+			restir_history_valid = false;
+			reflection_history_valid = false;
+			static_view_history.reset();
 		}
 
+		// Render attachments oversized for the render extent are shrunk after a while. The extent in use is
+		// unchanged, so the history stays valid
+		const auto trim_result =
+			curr_resource.render_resource.trim_attachments(context->device.get(), deletion_queue);
+		if (!trim_result) return trim_result.error().forward("Trim render target failed");
+
+		// Converged ambient occlusion of the frame resource is lost, trace it again
+		if (*trim_result) static_view_history.reset();
+
+		// HiZ, TAA, ambient occlusion and reflection outputs of this frame are the history of the next frame
+		const auto curr_hiz_history_valid = std::exchange(hiz_history_valid, true);
+		const auto curr_taa_history_valid = std::exchange(taa_history_valid, true);
+		const auto curr_ambient_occlusion_history_valid =
+			std::exchange(ambient_occlusion_history_valid, true);
+		const auto curr_restir_history_valid = std::exchange(restir_history_valid, true);
+		const auto curr_reflection_history_valid = std::exchange(reflection_history_valid, true);
+
 		return FrameAcquireResult{
 			.curr_resource = curr_resource,
 			.prev_resource = prev_resource,
 			.swapchain_frame = swapchain_frame,
+			.render_extent = render_extent,
+			.hiz_history_valid = curr_hiz_history_valid,
+			.taa_history_valid = curr_taa_history_valid,
+			.ambient_occlusion_history_valid = curr_ambient_occlusion_history_valid,
+			.restir_history_valid = curr_restir_history_valid,
+			.reflection_history_valid = curr_reflection_history_valid,
 		};
 	}
 
 	RenderPage::SceneData::operator resource::RenderData() const noexcept
 	{
 		return {
-			.drawcalls = drawcalls.to<std::span<const render::PrimitiveDrawcall>>(),
-			.transforms = transforms,
+			.drawcall_counts = drawcall_counts,
+			.blended_drawcall_counts = blended_drawcall_counts,
+			.node_count = node_count,
+			.primitive_count = primitive_count,
+			.material_count = material_count,
+			.transform_updates = transform_updates,
+			.deform_parameters = deform_parameters,
+			.cull_views = cull_views,
+			.root_transform = root_transform,
 			.camera = camera,
 			.primary_light = primary_light,
 			.exposure_param = exposure_param
 		};
 	}
 
-	RenderPage::SceneData RenderPage::prepare_scene(glm::u32vec2 extent) noexcept
+	RenderPage::SceneData RenderPage::prepare_scene(
+		glm::u32vec2 extent,
+		glm::u32vec2 render_extent,
+		float delta_time,
+		std::pmr::memory_resource& frame_arena
+	) noexcept
 	{
-		auto [drawcalls, transforms] = drawcall_generator.compute(model, glm::mat4(1.0f));
-		const auto camera = param.camera.get_and_update(extent);
+		// Spatially upscaled frames have no history to resolve the jitter against
+		const auto camera =
+			param.camera.get_and_update(extent, render_extent, !param.resolution.spatial_upscale());
 		const auto primary_light = param.primary_light.get();
-		const auto exposure_param = param.exposure.get(ImGui::GetIO().DeltaTime, extent);
+		const auto exposure_param = param.exposure.get(delta_time, render_extent);
+
+		// Cascades are culled by the indirect pipeline of the main camera, as its additional views
+		const auto shadow_map = param.shadow_map.get();
+		auto shadow_cascades = shadow_map.has_value()
+			? render::fit_cascades(camera, primary_light.direction, *shadow_map)
+			: std::vector<render::ShadowCascade>();
+		auto cull_views = std::pmr::vector<render::CullView>(&frame_arena);
+		std::ranges::transform(
+			shadow_cascades,
+			std::back_inserter(cull_views),
+			[](const render::ShadowCascade& cascade) {
+				return render::CullView{.view_projection = cascade.view_projection};
+			}
+		);
+
+		/* Animation */
+
+		// Animated nodes are posed on host, only their local transforms are uploaded. The deformable meshes
+		// are posed from the world transforms
+		auto transform_updates = std::pmr::vector<render::NodeTransformUpdate>(&frame_arena);
+		auto deform_parameters = std::optional<render::DeformList::Parameters>();
+		animation_deform = false;
+
+		if (const auto playback = param.animation.get(model.animations.size()); playback.has_value())
+		{
+			const auto& animation = model.animations[playback->animation_index];
+
+			if (animation_pose.empty())
+			{
+				animation_pose = model.hierarchy.get_nodes()
+					| std::views::transform([](const model::FullNode& node) { return node.data.transform; })
+					| std::ranges::to<std::vector>();
+				animation_morph_weights.resize(animation_pose.size());
+			}
+
+			const auto duration = animation.duration();
+			animation_time =
+				duration > 0.0f ? std::fmod(animation_time + delta_time * playback->speed, duration) : 0.0f;
+
+			// Sampling drops weights beyond the size of a node's array
+			for (const auto& channel : animation.channels)
+			{
+				if (channel.path != model::AnimationChannel::Path::Weights) continue;
+
+				auto& weights = animation_morph_weights[channel.node_index];
+				if (weights.size() < channel.component_count) weights.resize(channel.component_count, 0.0f);
+			}
+
+			animation.sample(animation_time, animation_pose, animation_morph_weights);
+
+			// At most one update per node, while a node may have a channel for each property
+			auto animated_nodes = animation.channels
+				| std::views::filter([](const model::AnimationChannel& channel) {
+					  return channel.path != model::AnimationChannel::Path::Weights;
+				  })
+				| std::views::transform(&model::AnimationChannel::node_index)
+				| std::ranges::to<std::pmr::vector<uint32_t>>(&frame_arena);
+			std::ranges::sort(animated_nodes);
+			const auto [first, last] = std::ranges::unique(animated_nodes);
+			animated_nodes.erase(first, last);
+
+			for (const auto node_index : animated_nodes)
+				transform_updates.push_back({
+					.local_transform = animation_pose[node_index].to_matrix(),
+					.node_index = node_index,
+				});
+
+			const auto world_transforms =
+				model.hierarchy.compute_transforms(glm::mat4(1.0f), animation_pose, frame_arena);
+			animation_transforms.assign(world_transforms.begin(), world_transforms.end());
+			animation_tlas_pending = true;
+
+			if (model.deform_list.has_value())
+			{
+				deform_parameters =
+					model.deform_list->compute_parameters(world_transforms, animation_morph_weights);
+				animation_deform = true;
+			}
+		}
 
 		return {
-			.drawcalls = std::move(drawcalls),
-			.transforms = std::move(transforms),
+			.drawcall_counts = model.scene_graph.drawcall_counts(),
+			.blended_drawcall_counts = model.scene_graph.drawcall_counts(render::SceneGraph::Bucket::Blended),
+			.node_count = model.scene_graph->node_count,
+			.primitive_count = model.mesh_list->primitive_attr_array.size(),
+			.material_count = model.material_list.material_count(),
+			.transform_updates = std::move(transform_updates),
+			.deform_parameters = std::move(deform_parameters),
+			.shadow_cascades = std::move(shadow_cascades),
+			.cull_views = std::move(cull_views),
+			.root_transform = glm::mat4(1.0f),
 			.camera = camera,
 			.primary_light = primary_light,
 			.exposure_param = exposure_param
 		};
 	}
 
-	void RenderPage::ui(glm::u32vec2 extent) noexcept
+	void RenderPage::ui(
+		glm::u32vec2 extent,
+		std::optional<render::TextureStreamer::Stat> streaming_stat,
+		std::optional<render::GeometryStreamer::Stat> geometry_stat,
+		std::pmr::memory_resource& frame_arena
+	) noexcept
 	{
 		auto& io = ImGui::GetIO();
 
 		auto background_drawlist = ImGui::GetBackgroundDrawList();
-		const auto fps_text = std::format("{:.1f} FPS", io.Framerate);
+		auto fps_text = std::pmr::string(&frame_arena);
+		const auto cpu_stat = frame_timing.get_statistics(logic::FrameTiming::Metric::Cpu);
+		std::format_to(
+			std::back_inserter(fps_text),
+			"{:.1f} FPS, P99 {:.2f} ms, Max {:.2f} ms",
+			io.Framerate,
+			cpu_stat.p99,
+			cpu_stat.max
+		);
+
+		// Overlay lines are stacked from the top, each with a drop shadow
+		auto y = 10.0f;
+		const auto add_line = [background_drawlist, &y](const std::pmr::string& text) {
+			background_drawlist->AddText({12, y + 2}, IM_COL32(0, 0, 0, 255), text.c_str());
+			background_drawlist->AddText({10, y}, IM_COL32(255, 255, 255, 255), text.c_str());
+			y += 20.0f;
+		};
+
+		add_line(fps_text);
+
+		if (streaming_stat.has_value())
+		{
+			const auto& stat = *streaming_stat;
+			auto streaming_text = std::pmr::string(&frame_arena);
+			std::format_to(
+				std::back_inserter(streaming_text),
+				"Textures: {}/{} streamed, {} pending ({:.1f}/{:.1f} MiB)",
+				stat.resident_count,
+				stat.texture_count,
+				stat.pending_count,
+				static_cast<double>(stat.resident_size) / 1048576.0,
+				static_cast<double>(stat.budget) / 1048576.0
+			);
+
+			add_line(streaming_text);
+		}
+
+		if (geometry_stat.has_value())
+		{
+			const auto& stat = *geometry_stat;
+			auto streaming_text = std::pmr::string(&frame_arena);
+			std::format_to(
+				std::back_inserter(streaming_text),
+				"Geometry: {}/{} streamed, {} pending ({:.1f}/{:.1f} MiB)",
+				stat.resident_count,
+				stat.primitive_count,
+				stat.pending_count,
+				static_cast<double>(stat.resident_size) / 1048576.0,
+				static_cast<double>(stat.pool_size) / 1048576.0
+			);
+
+			add_line(streaming_text);
+		}
+
+		if (path_trace_history.has_value())
+		{
+			// Samples of a pixel on average, pixels stop at the sample limit
+			const auto& history = *path_trace_history;
+			const auto dispatch = render::PathTracePipeline::get_dispatch(history.option, history.extent);
+			const auto samples = std::min(
+				static_cast<double>(path_trace_frame) * dispatch.samples_per_pixel / dispatch.pixel_stride,
+				static_cast<double>(history.option.max_samples)
+			);
+
+			auto path_trace_text = std::pmr::string(&frame_arena);
+			std::format_to(
+				std::back_inserter(path_trace_text),
+				"Path Tracing: {} frames, {:.1f} samples per pixel",
+				path_trace_frame,
+				samples
+			);
+
+			add_line(path_trace_text);
+		}
+
+		if (frame_capture.has_value())
+		{
+			const auto stat = frame_capture->get_stat();
+
+			auto capture_text = std::pmr::string(&frame_arena);
+			std::format_to(
+				std::back_inserter(capture_text),
+				"Capture: {} frames written, {} dropped{}",
+				stat.written_frames,
+				stat.dropped_frames,
+				stat.failed ? ", encoder failed" : ""
+			);
+
+			add_line(capture_text);
+		}
+
+		if (input_capture.has_value())
+		{
+			auto input_text = std::pmr::string(&frame_arena);
+			std::format_to(
+				std::back_inserter(input_text),
+				"Input Capture: {} frames recorded",
+				input_capture->get_frame_count()
+			);
+
+			add_line(input_text);
+		}
+
+		if (input_replay.has_value() && !input_replay->finished())
+		{
+			const auto [current_frame, frame_count] = input_replay->get_progress();
+
+			auto input_text = std::pmr::string(&frame_arena);
+			std::format_to(
+				std::back_inserter(input_text),
+				"Input Replay: frame {} of {}{}",
+				current_frame + 1,
+				frame_count,
+				input_replay->extent_matches(extent) ? "" : ", window extent differs from capture"
+			);
+
+			add_line(input_text);
+		}
+
+		if (picked_object->has_value())
+		{
+			const auto& drawcall = **picked_object;
+
+			auto pick_text = std::pmr::string(&frame_arena);
+			if (drawcall.node_index == render::PrimitiveDrawcall::HIDDEN)
+				pick_text = "Picked: nothing";
+			else
+				std::format_to(
+					std::back_inserter(pick_text),
+					"Picked: node {}, primitive {}",
+					drawcall.node_index,
+					drawcall.primitive_index
+				);
+
+			add_line(pick_text);
+		}
+
+		// Statistics of the main camera, summed over the render states
+		{
+			const auto stat = std::ranges::fold_left(
+				culling_stat.all(),
+				render::IndirectCount{},
+				[](render::IndirectCount sum, const render::IndirectCount& count) {
+					sum.early_draw_count += count.early_draw_count;
+					sum.late_draw_count += count.late_draw_count;
+					sum.early_command_count += count.early_command_count;
+					sum.late_command_count += count.late_command_count;
+					sum.early_triangle_count += count.early_triangle_count;
+					sum.late_triangle_count += count.late_triangle_count;
+					return sum;
+				}
+			);
+
+			auto culling_text = std::pmr::string(&frame_arena);
+			std::format_to(
+				std::back_inserter(culling_text),
+				"Visible: {} + {} draws in {} commands, {:.2f}M + {:.2f}M triangles",
+				stat.early_draw_count,
+				stat.late_draw_count,
+				stat.early_command_count + stat.late_command_count,
+				static_cast<double>(stat.early_triangle_count) / 1e6,
+				static_cast<double>(stat.late_triangle_count) / 1e6
+			);
+			add_line(culling_text);
+		}
 
-		background_drawlist->AddText({12, 12}, IM_COL32(0, 0, 0, 255), fps_text.c_str());
-		background_drawlist->AddText({10, 10}, IM_COL32(255, 255, 255, 255), fps_text.c_str());
+		for (const auto& result : pipeline_stat)
+		{
+			auto statistics_text = std::pmr::string(&frame_arena);
+			std::format_to(
+				std::back_inserter(statistics_text),
+				"{}: {:.2f}M primitives, {:.2f}M fragments, {:.2f}M compute invocations",
+				result.name,
+				static_cast<double>(result.clipping_primitives) / 1e6,
+				static_cast<double>(result.fragment_invocations) / 1e6,
+				static_cast<double>(result.compute_invocations) / 1e6
+			);
+			add_line(statistics_text);
+		}
 
 		param.ui(extent);
+		profiler.ui();
+		frame_timing.ui();
+		memory_monitor.ui(context->device.get().allocator);
+
+		if (auto model_path = model_swap.ui(model_load.has_value()))
+		{
+			auto load_argument = argument;
+			load_argument.model_path = std::move(*model_path);
+			model_load.emplace(
+				LoadPage::load_in_background(context, material_layout, std::move(load_argument), preset)
+			);
+		}
 	}
 
 	RenderPage::Event RenderPage::handle_events() noexcept
 	{
 		SDL_Event event;
+		auto result = Event::None;
 
 		while (SDL_PollEvent(&event))
 		{
 			context->imgui.process_event(event);
+			result = Event::Input;
 
 			switch (event.type)
 			{
@@ -271,83 +1027,1150 @@ namespace page
 			}
 		}
 
-		return Event::None;
+		return result;
 	}
 
-	std::expected<std::optional<RenderPage::Frame>, Error> RenderPage::prepare_frame() noexcept
+	bool RenderPage::has_pending_work() const noexcept
 	{
-		const auto acquire_result = acquire_frame();
-		if (!acquire_result) return acquire_result.error().forward("Acquire frame failed");
-		if (!*acquire_result) return std::nullopt;  // Soft failed, retry next frame
-		const auto frame = **acquire_result;
+		// Models are loaded in the background and swapped in by a later frame
+		if (model_load.has_value()) return true;
 
-		/* UI & Scene */
+		// Render states are drawn with the generic variant until theirs is compiled
+		if (pipeline.deferred.compiling_variants()) return true;
 
-		if (const auto new_frame_result = context->imgui.new_frame(); !new_frame_result)
-			return new_frame_result.error().forward("Start new ImGui frame failed");
+		// BLASes are rebuilt in the background and swapped in by a later frame
+		if (!blas_rebuild_started || blas_rebuild.has_value() || tlas_rebuild_pending) return true;
 
-		ui(frame.swapchain_frame.extent);
+		// Streaming progresses with the feedback of rendered frames
+		if (texture_streamer.has_value() && texture_streamer->get_stat().pending_count > 0) return true;
+		if (geometry_streamer.has_value() && geometry_streamer->get_stat().pending_count > 0) return true;
 
-		if (const auto render_result = context->imgui.render(); !render_result)
-			return render_result.error().forward("Render ImGui frame failed");
+		if (path_trace_history.has_value())
+		{
+			const auto& history = *path_trace_history;
+			const auto dispatch = render::PathTracePipeline::get_dispatch(history.option, history.extent);
+			const auto samples =
+				static_cast<double>(path_trace_frame) * dispatch.samples_per_pixel / dispatch.pixel_stride;
+			if (samples < static_cast<double>(history.option.max_samples)) return true;
+		}
 
-		auto scene_data = prepare_scene(frame.swapchain_frame.extent);
+		return false;
+	}
 
-		/* Update & Bind */
+	void RenderPage::focus_view(
+		glm::vec2 position,
+		glm::u32vec2 extent,
+		std::pmr::memory_resource& frame_arena
+	) noexcept
+	{
+		if (!param.camera.last_camera.has_value()) return;
+		const auto& camera = *param.camera.last_camera;
+
+		// Built on demand, as animations move the nodes every frame
+		const auto transforms = animation_transforms.empty()
+			? model.hierarchy.compute_transforms(glm::mat4(1.0f), frame_arena)
+			: std::pmr::vector<glm::mat4>(std::from_range, animation_transforms, &frame_arena);
+		const auto bounds = get_node_bounds(model, transforms);
+		const auto bvh = model::SceneBvh::create(bounds);
+
+		// Camera ray through the cursor, onto the near plane of the reverse-Z projection
+		const auto texcoord = position / glm::vec2(extent);
+		const auto ndc = glm::vec2(texcoord.x * 2.0f - 1.0f, 1.0f - texcoord.y * 2.0f);
+		const auto near_point = camera.inv_view_projection * glm::vec4(ndc, 1.0f, 1.0f);
+		const auto ray = model::Ray{
+			.origin = camera.camera_pos,
+			.direction = glm::vec3(near_point) / near_point.w - camera.camera_pos,
+		};
 
-		if (const auto buffer_update_result =
-				frame.curr_resource.render_resource.update(context->device.get(), scene_data);
-			!buffer_update_result)
-			return buffer_update_result.error().forward("Update render buffer failed");
+		// Boxes around the camera, e.g. of a ground plane or a room, are entered at once and skipped
+		const auto hits = bvh.query(ray);
+		const auto hit = std::ranges::find_if(hits, [](const auto& entry) { return entry.t > 0.0f; });
+		const auto bound = hit != hits.end() ? bounds[hit->item] : bvh.get_bound();
+		if (bound.empty()) return;
+
+		// Fits the bounding sphere of the box vertically, keeping the orientation of the view
+		const auto radius = static_cast<double>(glm::distance(bound.min, bound.max)) * 0.5;
+		const auto half_fov = glm::radians(param.camera.projection.fov_degrees) * 0.5;
+		param.camera.target_view.center_position = glm::dvec3(bound.center());
+		param.camera.target_view.distance =
+			std::max(radius / std::sin(half_fov), param.camera.projection.near * 2.0);
+	}
 
-		frame.curr_resource.resource_set.update(
+	coro::task<std::expected<void, Error>> RenderPage::update_texture_streaming(
+		FrameResource& resource
+	) noexcept
+	{
+		if (!texture_streamer.has_value()) co_return {};
+
+		co_await thread_pool->schedule();
+
+		// Prioritized by the feedback of the waited frame
+		const auto feedback_result = resource.render_resource.feedback.read_and_clear();
+		if (!feedback_result) co_return feedback_result.error().forward("Read texture feedback failed");
+		if (resource.stale_feedback) co_return {};
+
+		const auto update_result = texture_streamer->update(
 			context->device.get(),
-			model,
-			frame.curr_resource.render_resource,
-			frame.prev_resource.render_resource,
-			aux_resource
+			feedback_result->material_usage,
+			feedback_result->material_resolution
 		);
+		if (!update_result) co_return update_result.error().forward("Update texture streaming failed");
 
-		return Frame{
-			.command_buffer = frame.curr_resource.command_buffer,
-			.render_resource = frame.curr_resource.render_resource,
-			.prev_render_resource = frame.prev_resource.render_resource,
-			.resource_set = frame.curr_resource.resource_set,
-			.sync_primitive = frame.curr_resource.sync_primitive,
-			.render_complete_semaphore = render_complete_semaphores[frame.swapchain_frame.index],
-			.swapchain = frame.swapchain_frame,
-		};
+		co_return {};
 	}
 
-	void RenderPage::render_objects(const Frame& frame) const noexcept
+	coro::task<std::expected<void, Error>> RenderPage::update_geometry_streaming(
+		FrameResource& resource,
+		glm::u32vec2 render_extent
+	) noexcept
 	{
-		pipeline.indirect.compute(frame.command_buffer, frame.resource_set.indirect);
-		pipeline.deferred.render(frame.command_buffer, frame.resource_set.deferred);
+		if (!geometry_streamer.has_value()) co_return {};
+
+		co_await thread_pool->schedule();
+
+		// Same threshold as the culling passes, assuming the render extent of the waited frame is unchanged
+		const auto feedback_result = resource.render_resource.geometry_feedback.read_and_clear();
+		if (!feedback_result) co_return feedback_result.error().forward("Read geometry feedback failed");
+		if (resource.stale_feedback) co_return {};
+
+		const auto update_result = geometry_streamer->update(
+			context->device.get(),
+			feedback_result->primitive_size,
+			render::IndirectPipeline::lod_threshold_from_pixels(config::LOD_PIXEL_ERROR, render_extent.y)
+		);
+		if (!update_result) co_return update_result.error().forward("Update geometry streaming failed");
+
+		co_return {};
 	}
 
-	void RenderPage::render_lighting(const Frame& frame) const noexcept
+	coro::task<std::expected<void, Error>> RenderPage::prepare_ui_and_scene(
+		FrameAcquireResult frame,
+		std::optional<render::TextureStreamer::Stat> streaming_stat,
+		std::optional<render::GeometryStreamer::Stat> geometry_stat,
+		bool record_ui
+	) noexcept
 	{
-		const auto rendering_area = vk::Rect2D{
-			.offset = vk::Offset2D{.x = 0, .y = 0},
-			.extent = vulkan::to<vk::Extent2D>(frame.swapchain.extent)
-		};
+		auto& frame_arena = *frame.curr_resource.frame_arena;
 
-		const auto hdr_attachment_info = vk::RenderingAttachmentInfo{
-			.imageView = frame.render_resource.attachments->hdr->attachment.view,
-			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+		const auto now = logic::Overlay::Clock::now();
+		const auto measured_delta_time =
+			last_frame_time.has_value() ? std::chrono::duration<float>(now - *last_frame_time).count() : 0.0f;
+		last_frame_time = now;
+
+		// Replayed frames advance by the recorded time, so that smoothing and adaptation match the capture
+		const auto delta_time =
+			input_replay.has_value() ? input_replay->current().delta_time : measured_delta_time;
+		frame_delta_time = delta_time;
+
+		// Skipped frames keep showing the UI cached in the overlay layer, no input arrived since
+		if (record_ui)
+		{
+			if (const auto new_frame_result = context->imgui.new_frame(); !new_frame_result)
+				co_return new_frame_result.error().forward("Start new ImGui frame failed");
+
+			ui(frame.swapchain_frame.extent, streaming_stat, geometry_stat, frame_arena);
+
+			if (const auto render_result = context->imgui.render(); !render_result)
+				co_return render_result.error().forward("Render ImGui frame failed");
+
+			// Left and right buttons move the camera, the middle button picks the object under the cursor.
+			// Double clicking the middle button also focuses the camera on it.
+			const auto& io = ImGui::GetIO();
+			const auto cursor = glm::vec2(io.MousePos.x, io.MousePos.y)
+				* glm::vec2(io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
+			if (!io.WantCaptureMouse && ImGui::IsMouseClicked(ImGuiMouseButton_Middle)) pick_request = cursor;
+			if (!io.WantCaptureMouse && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Middle))
+				focus_view(cursor, frame.swapchain_frame.extent, frame_arena);
+		}
+
+		param.camera.update_smoothing(delta_time);
+
+		// Recorded view is already smoothed and late latched, and overrides the live input
+		if (input_replay.has_value())
+		{
+			param.camera.target_view = input_replay->current().view;
+			param.camera.curr_view = input_replay->current().view;
+		}
+
+		const auto scene_data =
+			prepare_scene(frame.swapchain_frame.extent, frame.render_extent, delta_time, frame_arena);
+		tlas_cull_origin = scene_data.camera.camera_pos;
+
+		if (const auto buffer_update_result = frame.curr_resource.render_resource.update(
+				context->device.get(),
+				deletion_queue,
+				scene_data
+			);
+			!buffer_update_result)
+			co_return buffer_update_result.error().forward("Update render buffer failed");
+
+		if (const auto path_trace_result = update_path_trace(scene_data, frame.render_extent);
+			!path_trace_result)
+			co_return path_trace_result.error().forward("Update path tracing failed");
+
+		if (const auto shadow_map_result = update_shadow_map(scene_data, geometry_stat); !shadow_map_result)
+			co_return shadow_map_result.error().forward("Update shadow map failed");
+
+		update_static_view(scene_data, frame.render_extent, streaming_stat, geometry_stat);
+
+		co_return {};
+	}
+
+	std::expected<void, Error> RenderPage::update_overlay_layer(glm::u32vec2 extent) noexcept
+	{
+		if (!param.overlay.cached)
+		{
+			// Frames in flight may still be blending it
+			if (overlay_layer.has_value())
+			{
+				deletion_queue.retire(std::move(*overlay_layer));
+				overlay_layer.reset();
+			}
+			overlay_layer_valid = false;
+			return {};
+		}
+
+		if (overlay_layer.has_value() && (*overlay_layer)->extent == extent) return {};
+
+		// Same format as the swapchain, which the ImGui pipeline is created for
+		auto attachment_result = render::OverlayAttachment::create(
+			context->device.get(),
+			extent,
+			context->swapchain->surface_format.format
+		);
+		if (!attachment_result) return attachment_result.error().forward("Create overlay layer failed");
+
+		if (overlay_layer.has_value()) deletion_queue.retire(std::move(*overlay_layer));
+		overlay_layer = std::move(*attachment_result);
+		overlay_layer_valid = false;
+
+		return {};
+	}
+
+	std::expected<void, Error> RenderPage::update_path_trace(
+		const SceneData& scene_data,
+		glm::u32vec2 render_extent
+	) noexcept
+	{
+		const auto option = param.path_trace.get();
+
+		if (!option.has_value())
+		{
+			// Frames in flight may still be accumulating
+			if (path_trace_attachment.has_value())
+			{
+				deletion_queue.retire(std::move(*path_trace_attachment));
+				path_trace_attachment.reset();
+			}
+
+			path_trace_history.reset();
+			return {};
+		}
+
+		if (!path_trace_attachment.has_value() || (*path_trace_attachment)->extent != render_extent)
+		{
+			auto attachment_result =
+				render::PathTraceAttachment::create(context->device.get(), render_extent);
+			if (!attachment_result)
+				return attachment_result.error().forward("Create path trace accumulation failed");
+
+			if (path_trace_attachment.has_value()) deletion_queue.retire(std::move(*path_trace_attachment));
+			path_trace_attachment = std::move(*attachment_result);
+		}
+
+		const auto history = PathTraceHistory{
+			.view_projection = scene_data.camera.view_projection,
+			.camera_pos = scene_data.camera.camera_pos,
+			.primary_light = scene_data.primary_light,
+			.option = *option,
+			.extent = render_extent,
+		};
+
+		// Also restarts when the previous frame was rasterized, or when the scene moved
+		if (path_trace_history != history || scene_data.moved()) path_trace_frame = 0;
+		path_trace_history = history;
+
+		return {};
+	}
+
+	std::expected<void, Error> RenderPage::update_shadow_map(
+		const SceneData& scene_data,
+		const std::optional<render::GeometryStreamer::Stat>& geometry_stat
+	) noexcept
+	{
+		const auto option = param.shadow_map.get();
+
+		if (!option.has_value())
+		{
+			// Frames in flight may still be sampling it
+			if (shadow_map_attachment.has_value())
+			{
+				deletion_queue.retire(std::move(*shadow_map_attachment));
+				shadow_map_attachment.reset();
+			}
+
+			shadow_map_dirty_mask.reset();
+			return {};
+		}
+
+		if (!shadow_map_attachment.has_value() || (*shadow_map_attachment)->resolution != option->resolution
+			|| shadow_map_attachment->cascade_count() != option->cascade_count)
+		{
+			auto attachment_result = render::CascadeShadowAttachment::create(
+				context->device.get(),
+				option->resolution,
+				option->cascade_count
+			);
+			if (!attachment_result)
+				return attachment_result.error().forward("Create cascaded shadow map failed");
+
+			if (shadow_map_attachment.has_value()) deletion_queue.retire(std::move(*shadow_map_attachment));
+			shadow_map_attachment = std::move(*attachment_result);
+		}
+
+		// Streamed in geometry adds casters to the cascades
+		const auto resident_count = geometry_stat.transform(&render::GeometryStreamer::Stat::resident_count);
+		if (resident_count.has_value() && *resident_count != shadow_map_resident_count)
+		{
+			shadow_map_resident_count = *resident_count;
+			shadow_map_geometry_version++;
+		}
+
+		// Animated nodes and meshes move the casters
+		if (scene_data.moved()) shadow_map_geometry_version++;
+
+		shadow_map_dirty_mask = shadow_map_attachment->acquire_dirty_cascades(
+			scene_data.shadow_cascades,
+			shadow_map_geometry_version,
+			param.shadow_map.cached
+		);
+
+		return {};
+	}
+
+	void RenderPage::update_static_view(
+		const SceneData& scene_data,
+		glm::u32vec2 render_extent,
+		const std::optional<render::TextureStreamer::Stat>& streaming_stat,
+		const std::optional<render::GeometryStreamer::Stat>& geometry_stat
+	) noexcept
+	{
+		// Moving nodes and meshes, rebuilt BLASes and pending streaming uploads change the traced scene
+		const bool streaming_pending =
+			(streaming_stat.has_value() && streaming_stat->pending_count > 0)
+			|| (geometry_stat.has_value() && geometry_stat->pending_count > 0);
+		if (scene_data.moved() || tlas_rebuild_pending || streaming_pending)
+		{
+			static_view_history.reset();
+			return;
+		}
+
+		const auto history = StaticViewHistory{
+			.view_projection = scene_data.camera.view_projection,
+			.camera_pos = scene_data.camera.camera_pos,
+			.primary_light = scene_data.primary_light,
+			.ambient_occlusion = param.ambient_occlusion.get(),
+			.global_illumination = param.global_illumination.get(),
+			.extent = render_extent,
+			.texture_resident_count = streaming_stat.transform(&render::TextureStreamer::Stat::resident_count)
+				.value_or(0),
+			.geometry_resident_count =
+				geometry_stat.transform(&render::GeometryStreamer::Stat::resident_count).value_or(0),
+		};
+
+		if (static_view_history != history) static_view_frame = 0;
+		static_view_history = history;
+	}
+
+	std::expected<void, Error> RenderPage::update_blas_rebuild() noexcept
+	{
+		using BuildPreference = render::BlasList::BuildPreference;
+
+		// Started here instead of in `create`, as the page is moved after creation while the build references
+		// its model
+		if (!blas_rebuild_started)
+		{
+			blas_rebuild_started = true;
+			if (model.blas_list.get_build_preference() != BuildPreference::FastBuild) return {};
+
+			auto future = std::async(std::launch::async, [this] {
+				// A pool of its own, leaving `thread_pool` to the host work of frames
+				const auto rebuild_thread_pool =
+					helper::create_thread_pool(argument.get_pool_config(preset.pool_config));
+				return coro::sync_wait(
+					render::BlasList::create(
+						*rebuild_thread_pool,
+						context->device.get(),
+						model.mesh_list,
+						model.material_list,
+						true,
+						BuildPreference::FastTrace
+					)
+				);
+			});
+			blas_rebuild.emplace(std::move(future));
+			return {};
+		}
+
+		if (!blas_rebuild.has_value() || !blas_rebuild->ready()) return {};
+
+		auto rebuild_result = std::move(*blas_rebuild).get();
+		blas_rebuild.reset();
+		if (!rebuild_result) return rebuild_result.error().forward("Rebuild BLAS for fast trace failed");
+
+		// Frames in flight still trace the fast-built BLASes through the TLAS
+		deletion_queue.retire(std::exchange(model.blas_list, std::move(*rebuild_result)));
+		tlas_rebuild_pending = true;
+
+		const auto blas_memory = model.blas_list.get_memory_stat();
+		std::println(
+			"BLAS rebuilt for fast trace: {:.2f} MiB -> {:.2f} MiB after compaction",
+			static_cast<double>(blas_memory.original_size) / 1048576.0,
+			static_cast<double>(blas_memory.compacted_size) / 1048576.0
+		);
+
+		return {};
+	}
+
+	std::expected<void, Error> RenderPage::update_model_load() noexcept
+	{
+		if (!model_load.has_value() || !model_load->model_future.ready()) return {};
+
+		// The BLAS rebuild references the current model, swapped in by `update_blas_rebuild` first
+		if (blas_rebuild.has_value()) return {};
+
+		auto load = std::move(*model_load);
+		model_load.reset();
+
+		auto load_result = std::move(load.model_future).get();
+		if (!load_result)
+		{
+			// Not fatal, the current model keeps rendering
+			std::println("Load model in background failed: {:msg}", load_result.error().root());
+			model_swap.failed(load_result.error());
+			return {};
+		}
+		auto [new_model, new_tlas, new_texture_streamer, new_geometry_streamer] = std::move(*load_result);
+
+		const auto gi_probe_grid = render::GiProbeVolume::fit_grid(
+			new_model,
+			new_model.hierarchy.compute_transforms(glm::mat4(1.0)),
+			config::GI_PROBE_MAX_COUNT
+		);
+		auto gi_probe_volume_result = render::GiProbeVolume::create(
+			context->device.get(),
+			gi_probe_grid,
+			config::GI_PROBE_RAY_CAPACITY
+		);
+		if (!gi_probe_volume_result)
+			return gi_probe_volume_result.error().forward("Create probe volume failed");
+
+		/* Swap, frames in flight still render the previous model */
+
+		// Streamers reference the model, retired first to be destroyed first
+		if (texture_streamer.has_value()) deletion_queue.retire(std::move(*texture_streamer));
+		if (geometry_streamer.has_value()) deletion_queue.retire(std::move(*geometry_streamer));
+		texture_streamer = std::move(new_texture_streamer);
+		geometry_streamer = std::move(new_geometry_streamer);
+
+		deletion_queue.retire(std::exchange(tlas, std::move(new_tlas)));
+		deletion_queue.retire(std::exchange(model, std::move(new_model)));
+		deletion_queue.retire(std::exchange(gi_probe_volume, std::move(*gi_probe_volume_result)));
+		pipeline.deferred.request_variants(model.material_list);
+
+		// Pipelines and attachments are kept, the resource sets bind the new model from this frame on
+		for (auto& resource : frame_resources.iterate()) resource.stale_feedback = true;
+
+		// Fast-built BLASes of the new model are rebuilt the same way as the first model
+		blas_rebuild_started = false;
+		tlas_rebuild_pending = false;
+
+		hiz_history_valid = false;
+		taa_history_valid = false;
+		ambient_occlusion_history_valid = false;
+		restir_history_valid = false;
+		reflection_history_valid = false;
+		static_view_history.reset();
+		path_trace_history.reset();  // Restarts the accumulation
+		gi_bake_history.reset();     // Restarts the bake on the new probe volume
+		shadow_map_geometry_version++;  // Cached cascades hold the casters of the previous model
+
+		// The poses index the nodes of the previous model
+		animation_time = 0.0f;
+		animation_pose.clear();
+		animation_morph_weights.clear();
+		animation_transforms.clear();
+		animation_tlas_pending = false;
+
+		// Picked drawcalls index the previous model
+		readback_ring.discard();
+		picked_object->reset();
+
+		// Memory of the previous model is freed piecewise, compacted once idle
+		defragment_requested = true;
+
+		argument = std::move(load.argument);
+		model_swap.loaded(argument.model_path);
+		std::println("Model swapped in: {}", argument.model_path);
+
+		return {};
+	}
+
+	std::expected<void, Error> RenderPage::update_defragmentation() noexcept
+	{
+		const auto& device_context = context->device.get();
+
+		if (!defragment.has_value())
+		{
+			const auto usage = device_context.allocator.get_device_block_usage();
+			const auto unused_size = usage.block_bytes - std::min(usage.block_bytes, usage.allocation_bytes);
+			const bool fragmented =
+				unused_size >= config::DEFRAGMENT_MIN_UNUSED_SIZE
+				&& static_cast<double>(unused_size)
+					>= static_cast<double>(usage.block_bytes) * config::DEFRAGMENT_UNUSED_RATIO;
+			if (!defragment_requested && !fragmented) return {};
+			defragment_requested = false;
+
+			auto defragmentation_result = device_context.allocator.begin_defragmentation();
+			auto command_runner_result = vulkan::CommandRunner::create(device_context);
+			if (!defragmentation_result || !command_runner_result)
+			{
+				const auto& error = !defragmentation_result ? defragmentation_result.error()
+															: command_runner_result.error();
+				std::println("Begin defragmentation failed: {:msg}", error.root());
+				return {};
+			}
+
+			defragment.emplace(std::move(*defragmentation_result), std::move(*command_runner_result));
+		}
+
+		// Frames in flight may still sample the moved textures
+		if (const auto result = context->device->waitIdle(); !result) return Error::from(result);
+
+		auto& defragmentation = defragment->defragmentation;
+
+		auto record_result = std::expected<bool, Error>(false);
+		const auto record_pass = [&](const vk::raii::CommandBuffer& command_buffer) {
+			record_result = defragmentation.record_pass(device_context.device, command_buffer);
+		};
+		const auto run_result = defragment->command_runner.run(device_context, record_pass);
+
+		// Not fatal, memory stays where it is. An abandoned pass keeps the moved textures in place
+		if (!run_result || !record_result)
+		{
+			const auto& error = !run_result ? run_result.error() : record_result.error();
+			std::println("Defragmentation pass failed: {:msg}", error.root());
+			defragment.reset();
+			return {};
+		}
+
+		if (!*record_result)
+		{
+			const auto stat = defragmentation.get_stat();
+			std::println(
+				"Defragmentation finished: {} images moved ({:.1f} MiB) in {} passes",
+				stat.moved_count,
+				static_cast<double>(stat.moved_bytes) / 1048576.0,
+				stat.pass_count
+			);
+			defragment.reset();
+			return {};
+		}
+
+		if (const auto result = defragmentation.end_pass(device_context.device); !result)
+			return result.error().forward("End defragmentation pass failed");
+
+		// The moved images have new handles from here on
+		if (texture_streamer.has_value())
+			if (const auto result = texture_streamer->rebind_relocated(device_context); !result)
+				return result.error().forward("Rebind relocated textures failed");
+
+		return {};
+	}
+
+	std::expected<std::optional<RenderPage::Frame>, Error> RenderPage::prepare_frame() noexcept
+	{
+		PROFILE_ZONE("Prepare frame");
+
+		if (const auto result = update_model_load(); !result)
+			return result.error().forward("Update model load failed");
+
+		const auto acquire_result = acquire_frame();
+		if (!acquire_result) return acquire_result.error().forward("Acquire frame failed");
+		if (!*acquire_result) return std::nullopt;  // Soft failed, retry next frame
+		const auto frame = **acquire_result;
+
+		/* Profiling results, the frame has been waited for in `acquire_frame()` */
+
+		const auto timestamp_result = frame.curr_resource.timestamp_query.read_results();
+		if (!timestamp_result) return timestamp_result.error().forward("Read timestamp queries failed");
+		profiler.push(*timestamp_result);
+		frame_timing.push_gpu(*timestamp_result);
+
+		// Render scale of the next frame follows the GPU time of the waited frame
+		const auto total_result = std::ranges::find(
+			*timestamp_result,
+			"Total",
+			&vulkan::TimestampQuery::Result::name
+		);
+		// Render scale holds while path tracing, any change of the extent restarts the accumulation
+		if (total_result != timestamp_result->end() && !path_trace_history.has_value())
+			param.resolution.update(total_result->duration_ms);
+
+		auto statistics_result = frame.curr_resource.statistics_query.read_results();
+		if (!statistics_result)
+			return statistics_result.error().forward("Read pipeline statistics queries failed");
+		pipeline_stat = std::move(*statistics_result);
+
+		const auto culling_result = frame.curr_resource.render_resource.indirect.read_stat();
+		if (!culling_result) return culling_result.error().forward("Read culling statistics failed");
+		culling_stat = *culling_result;
+
+		/* BLAS Rebuild, the swapped BLASes are referenced once the TLAS is rebuilt in this frame */
+
+		if (const auto result = update_blas_rebuild(); !result)
+			return result.error().forward("Update BLAS rebuild failed");
+
+		/* Pipeline Variants, adopted before any pass of this frame is recorded */
+
+		// Not fatal, render states of the failed variant keep drawing with the generic variant
+		if (const auto result = pipeline.deferred.update_variants(); !result)
+			std::println("Compile deferred pipeline variant failed: {:msg}", result.error().root());
+
+		/* Texture Streaming & UI & Scene */
+
+		// Statistics are sampled before the streamer updates on the thread pool, shown one frame late
+		const auto streaming_stat = texture_streamer.transform(&render::TextureStreamer::get_stat);
+		const auto geometry_stat = geometry_streamer.transform(&render::GeometryStreamer::get_stat);
+
+		// A recorded UI is drawn into the layer in this frame, a new layer is recorded right away
+		if (const auto result = update_overlay_layer(frame.swapchain_frame.extent); !result)
+			return result.error().forward("Update overlay layer failed");
+		const auto record_ui = param.overlay.begin_frame(logic::Overlay::Clock::now(), overlay_layer_valid);
+		if (overlay_layer.has_value() && record_ui) overlay_layer_valid = true;
+
+		// The streaming tasks are started first and move to the thread pool right away, so that the UI and
+		// scene are prepared on the calling thread meanwhile. All finish before the frame is recorded, as
+		// the streamers record into the frame command buffer.
+		auto [streaming_result, geometry_result, scene_result] = coro::sync_wait(
+			coro::when_all(
+				update_texture_streaming(frame.curr_resource),
+				update_geometry_streaming(frame.curr_resource, frame.render_extent),
+				prepare_ui_and_scene(frame, streaming_stat, geometry_stat, record_ui)
+			)
+		);
+		if (const auto& result = streaming_result.return_value(); !result)
+			return result.error().forward("Texture streaming failed");
+		if (const auto& result = geometry_result.return_value(); !result)
+			return result.error().forward("Geometry streaming failed");
+		if (const auto& result = scene_result.return_value(); !result)
+			return result.error().forward("Prepare UI and scene failed");
+
+		frame.curr_resource.stale_feedback = false;
+
+		/* Bind */
+
+		frame.curr_resource.resource_set.update(
+			context->device.get(),
+			model,
+			tlas,
+			frame.curr_resource.render_resource,
+			frame.prev_resource.render_resource,
+			aux_resource,
+			gi_probe_volume,
+			environment_lighting,
+			pipeline.atmosphere.get_lut_view(),
+			path_trace_attachment.transform(
+				[](const render::PathTraceAttachment& attachment) -> render::PathTraceAttachment::View {
+					return attachment;
+				}
+			),
+			shadow_map_attachment.transform([](const render::CascadeShadowAttachment& attachment) {
+				return static_cast<render::CascadeShadowAttachment::View>(attachment);
+			})
+		);
+		if (overlay_layer.has_value())
+			frame.curr_resource.resource_set.overlay.update(context->device.get(), *overlay_layer);
+
+		frame.curr_resource.sync_primitive.frame_count++;
+
+		// The sky view only depends on the elevation of the sun
+		const auto sun = param.primary_light.get();
+		const auto sun_moved = param.primary_light.atmosphere && atmosphere_sun_height != sun.direction.y;
+		if (sun_moved) atmosphere_sun_height = sun.direction.y;
+
+		// Path traced frames light every pixel, checkerboard frames shade without coarse rates
+		const auto checkerboard = path_trace_history.has_value()
+			? std::nullopt
+			: param.resolution.get_checkerboard(frame_index);
+
+		// Probes stop updating once baked, the lighting keeps sampling them
+		auto global_illumination = param.global_illumination.get();
+		auto global_illumination_frame = std::optional(static_cast<uint32_t>(frame_index));
+		if (const auto bake_pass_count = param.global_illumination.get_bake_pass_count();
+			global_illumination.has_value() && bake_pass_count.has_value())
+		{
+			const auto history = GiBakeHistory{
+				.option = *global_illumination,
+				.primary_light = sun,
+				.pass_count = *bake_pass_count,
+			};
+			if (gi_bake_history != history) gi_bake_frame = 0;
+			gi_bake_history = history;
+
+			const auto bake_option = render::GiProbePipeline::get_bake_option(
+				*global_illumination,
+				gi_probe_volume,
+				*bake_pass_count,
+				gi_bake_frame
+			);
+			if (bake_option.has_value())
+			{
+				*global_illumination = *bake_option;
+				global_illumination_frame = gi_bake_frame++;
+			}
+			else
+				global_illumination_frame = std::nullopt;
+		}
+		else
+			gi_bake_history.reset();
+
+		// Stochastic ray traced passes stop once converged on a static view, their last output is reused
+		const auto static_frame = static_view_history.has_value() ? static_view_frame++ : 0;
+		const auto ambient_occlusion_converged = static_view_history.has_value()
+			&& static_frame >= config::STATIC_VIEW_AMBIENT_OCCLUSION_FRAMES;
+		if (static_view_history.has_value() && !gi_bake_history.has_value() && global_illumination.has_value()
+			&& static_frame
+				>= render::GiProbePipeline::get_frame_count(
+					*global_illumination,
+					gi_probe_volume,
+					config::STATIC_VIEW_GI_PASSES
+				))
+			global_illumination_frame = std::nullopt;
+
+		// Path traced frames include the direct lighting. Attachments follow the toggle from next frame on
+		const bool restir_allocated = frame.curr_resource.render_resource.attachments->restir.has_value();
+		const auto restir =
+			path_trace_history.has_value() || !restir_allocated ? std::nullopt : param.restir.get();
+		if (!restir.has_value()) restir_history_valid = false;
+
+		// Path traced frames include the reflections, the next traced frame has no denoise history
+		const auto reflection = path_trace_history.has_value() ? std::nullopt : param.reflection.get();
+		if (!reflection.has_value()) reflection_history_valid = false;
+
+		return Frame{
+			.command_buffer = frame.curr_resource.command_buffer,
+			.compute_command_buffer = frame.curr_resource.compute_command_buffer,
+			.render_resource = frame.curr_resource.render_resource,
+			.prev_render_resource = frame.prev_resource.render_resource,
+			.resource_set = frame.curr_resource.resource_set,
+			.sync_primitive = frame.curr_resource.sync_primitive,
+			.prev_sync_primitive = frame.prev_resource.sync_primitive,
+			.timestamp_query = frame.curr_resource.timestamp_query,
+			.statistics_query = frame.curr_resource.statistics_query,
+			.secondary_recorder = frame.curr_resource.secondary_recorder,
+			.transient_cache = frame.curr_resource.transient_cache,
+			.frame_arena = *frame.curr_resource.frame_arena,
+			.render_complete_semaphore = render_complete_semaphores[frame.swapchain_frame.index],
+			.swapchain = frame.swapchain_frame,
+			.render_extent = frame.render_extent,
+			.hiz_history_valid = frame.hiz_history_valid,
+			// Path traced frames are shown unfiltered, TAA passes them through without history
+			.taa_history_valid = frame.taa_history_valid && !path_trace_history.has_value(),
+			.exposure_valid = frame.prev_resource.sync_primitive.frame_count > 0,
+			.depth_prepass = param.geometry.depth_prepass,
+			.depth_sort = param.geometry.depth_sort,
+			.deform = animation_deform,
+			.shadow_map_dirty_mask = shadow_map_dirty_mask,
+			.contact_shadow = param.contact_shadow.get(),
+			.bloom_intensity = param.bloom.get(),
+			.ambient_occlusion_history_valid = frame.ambient_occlusion_history_valid,
+			.ambient_occlusion = param.ambient_occlusion.get(),
+			.ambient_occlusion_converged = ambient_occlusion_converged,
+			.global_illumination = global_illumination,
+			.global_illumination_frame = global_illumination_frame,
+			.restir = restir,
+			.restir_history_valid = frame.restir_history_valid && restir.has_value(),
+			.reflection = reflection,
+			.reflection_history_valid = frame.reflection_history_valid && reflection.has_value(),
+			.reflection_denoise = param.reflection.get_denoise(),
+			.frame_index = frame_index++,
+			.variable_rate_shading =
+				checkerboard.has_value() ? std::nullopt : param.variable_rate_shading.get(),
+			.shading_rate_visualize =
+				param.variable_rate_shading.enabled && param.variable_rate_shading.visualize,
+			.path_trace = path_trace_history.has_value()
+				? std::optional(path_trace_history->option)
+				: std::nullopt,
+			.path_trace_frame = path_trace_history.has_value() ? path_trace_frame++ : 0,
+			.atmosphere = param.primary_light.atmosphere,
+			.atmosphere_sun = sun_moved ? std::optional(sun) : std::nullopt,
+			.checkerboard = checkerboard,
+			.spatial_upscale = param.resolution.spatial_upscale(),
+			.sharpness = param.resolution.sharpness,
+			.object_pick = std::exchange(pick_request, std::nullopt).transform([&frame](glm::vec2 position) {
+				// Attachments are rendered at the render extent, scaled over the whole swapchain
+				const auto scale = glm::vec2(frame.render_extent) / glm::vec2(frame.swapchain_frame.extent);
+				return glm::u32vec2(glm::max(position * scale, glm::vec2(0.0f)));
+			}),
+			.overlay = overlay_layer.transform(
+				[](const render::OverlayAttachment& attachment) -> render::OverlayAttachment::View {
+					return attachment;
+				}
+			),
+			.ui_recorded = record_ui,
+		};
+	}
+
+	void RenderPage::record_pass(
+		const Frame& frame,
+		const vk::raii::CommandBuffer& command_buffer,
+		ParallelPass pass
+	) const noexcept
+	{
+		const auto phase =
+			pass <= ParallelPass::HizEarly ? render::DrawPhase::Early : render::DrawPhase::Late;
+
+		switch (pass)
+		{
+		case ParallelPass::Transform:
+			pipeline.transform.compute(command_buffer, frame.resource_set.transform);
+			break;
+
+		case ParallelPass::ShadingRate:
+			if (frame.variable_rate_shading.has_value())
+				pipeline.shading_rate.compute(
+					command_buffer,
+					frame.resource_set.shading_rate,
+					*frame.variable_rate_shading,
+					frame.hiz_history_valid
+				);
+			else
+				pipeline.shading_rate.clear(command_buffer, frame.resource_set.shading_rate);
+			break;
+
+		case ParallelPass::CullingEarly:
+		case ParallelPass::CullingLate:
+		{
+			// Visibility buffer can't hold impostors, whose instances are then drawn as meshes
+			const auto impostor_threshold = pipeline.visibility.has_value()
+				? 0.0f
+				: render::IndirectPipeline::lod_threshold_from_pixels(
+					  config::IMPOSTOR_PIXEL_SIZE,
+					  frame.render_extent.y
+				  );
+
+			pipeline.indirect.compute(
+				command_buffer,
+				frame.resource_set.indirect,
+				phase,
+				frame.hiz_history_valid,
+				render::IndirectPipeline::lod_threshold_from_pixels(
+					config::LOD_PIXEL_ERROR,
+					frame.render_extent.y
+				),
+				frame.depth_sort,
+				render::IndirectPipeline::lod_threshold_from_pixels(
+					config::HLOD_PIXEL_SIZE,
+					frame.render_extent.y
+				),
+				impostor_threshold
+			);
+
+			// Counts of the main camera are final after the late phase
+			if (phase == render::DrawPhase::Late)
+				frame.render_resource.indirect.record_stat_copy(command_buffer);
+			break;
+		}
+
+		case ParallelPass::GBufferEarly:
+		case ParallelPass::GBufferLate:
+		{
+			const auto statistics_scope =
+				frame.statistics_query.scope(command_buffer, static_cast<uint32_t>(pass));
+			// Alternative paths cull per meshlet or shade once per pixel, which replaces the depth prepass
+			if (pipeline.meshlet_deferred.has_value())
+				pipeline.meshlet_deferred->render(
+					command_buffer,
+					*frame.resource_set.meshlet_deferred,
+					phase
+				);
+			else if (pipeline.visibility.has_value())
+			{
+				pipeline.visibility->render(command_buffer, *frame.resource_set.visibility, phase);
+
+				// G-buffer is shaded from the complete visibility buffer, before anything reads it
+				if (phase == render::DrawPhase::Late)
+					pipeline.visibility->resolve(command_buffer, *frame.resource_set.visibility);
+			}
+			else
+				pipeline.deferred.render(
+					command_buffer,
+					frame.resource_set.deferred,
+					phase,
+					frame.depth_prepass
+				);
+
+			// Impostors are appended by the early culling, and occlude in the late phase through the HiZ
+			if (phase == render::DrawPhase::Early && !pipeline.visibility.has_value())
+				pipeline.impostor.render(command_buffer, frame.resource_set.impostor);
+
+			// Object IDs are complete after the late phase, and index the drawcalls of this frame
+			if (phase == render::DrawPhase::Late && frame.object_pick.has_value())
+				pipeline.object_pick.compute(
+					command_buffer,
+					frame.resource_set.object_pick,
+					*frame.object_pick
+				);
+			break;
+		}
+
+		case ParallelPass::HizEarly:
+		case ParallelPass::HizLate:
+			pipeline.hiz.compute(command_buffer, frame.resource_set.hiz);
+			break;
+
+		case ParallelPass::LightCulling:
+			// Punctual lights are shaded by ReSTIR instead, the grid is left empty
+			pipeline.light_cluster.compute(
+				command_buffer,
+				frame.resource_set.light_cluster,
+				!frame.restir.has_value()
+			);
+			break;
+
+		case ParallelPass::Shadow:
+			if (frame.shadow_map_dirty_mask.has_value())
+			{
+				pipeline.cascade_shadow.render(
+					command_buffer,
+					frame.resource_set.cascade_shadow,
+					*frame.shadow_map_dirty_mask
+				);
+				pipeline.cascade_shadow.resolve(command_buffer, frame.resource_set.cascade_shadow);
+			}
+			else
+				pipeline.shadow.compute(command_buffer, frame.resource_set.shadow);
+			if (frame.contact_shadow.has_value())
+				pipeline.contact_shadow.compute(
+					command_buffer,
+					frame.resource_set.contact_shadow,
+					*frame.contact_shadow,
+					frame.frame_index
+				);
+			break;
+
+		case ParallelPass::AmbientOcclusion:
+			// Converged output is kept in the attachment, which serves as the history of the next frame
+			if (frame.ambient_occlusion_converged) break;
+
+			if (frame.ambient_occlusion.has_value())
+				pipeline.ambient_occlusion.compute(
+					command_buffer,
+					frame.resource_set.ambient_occlusion,
+					*frame.ambient_occlusion,
+					frame.frame_index,
+					frame.ambient_occlusion_history_valid
+				);
+			else
+				pipeline.ambient_occlusion.clear(command_buffer, frame.resource_set.ambient_occlusion);
+			break;
+
+		case ParallelPass::GlobalIllumination:
+			if (frame.global_illumination.has_value() && frame.global_illumination_frame.has_value())
+				pipeline.gi_probe.compute(
+					command_buffer,
+					frame.resource_set.gi_probe,
+					*frame.global_illumination,
+					*frame.global_illumination_frame
+				);
+			break;
+
+		case ParallelPass::DirectLighting:
+		{
+			// Outside of the rendering session of the fragment path
+			if (frame.atmosphere_sun.has_value())
+				pipeline.atmosphere.compute(command_buffer, *frame.atmosphere_sun);
+
+			const auto statistics_scope =
+				frame.statistics_query.scope(command_buffer, static_cast<uint32_t>(pass));
+			if constexpr (config::COMPUTE_LIGHTING)
+				pipeline.direct_lighting.compute(
+					command_buffer,
+					frame.resource_set.direct_lighting,
+					frame.ambient_occlusion.has_value(),
+					frame.global_illumination.has_value(),
+					frame.variable_rate_shading.has_value(),
+					argument.environment_path.has_value(),
+					frame.atmosphere,
+					frame.checkerboard
+				);
+			else
+				render_lighting(frame, command_buffer);
+
+			if (frame.shading_rate_visualize)
+				pipeline.shading_rate.visualize(command_buffer, frame.resource_set.shading_rate);
+			break;
+		}
+
+		case ParallelPass::Restir:
+			if (frame.restir.has_value())
+				pipeline.restir.compute(
+					command_buffer,
+					frame.resource_set.restir,
+					*frame.restir,
+					static_cast<uint32_t>(frame.frame_index),
+					frame.restir_history_valid
+				);
+			break;
+
+		case ParallelPass::Reflection:
+			if (!frame.reflection.has_value()) break;
+
+			pipeline.reflection.trace(
+				command_buffer,
+				frame.resource_set.reflection,
+				*frame.reflection,
+				static_cast<uint32_t>(frame.frame_index),
+				frame.taa_history_valid,
+				argument.environment_path.has_value()
+			);
+			pipeline.denoise.compute(
+				command_buffer,
+				frame.resource_set.reflection_denoise,
+				frame.reflection_denoise,
+				frame.reflection_history_valid
+			);
+			pipeline.reflection.composite(
+				command_buffer,
+				frame.resource_set.reflection,
+				*frame.reflection,
+				argument.environment_path.has_value()
+			);
+			break;
+
+		case ParallelPass::PathTrace:
+			if (frame.path_trace.has_value())
+				pipeline.path_trace.compute(
+					command_buffer,
+					frame.resource_set.path_trace,
+					*frame.path_trace,
+					frame.path_trace_frame
+				);
+			break;
+
+		case ParallelPass::Transparent:
+		{
+			// Path traced frames cover the blended surfaces already
+			if (frame.path_trace.has_value())
+			{
+				pipeline.transparent.clear(command_buffer, frame.resource_set.transparent);
+				break;
+			}
+
+			// Both phases are culled at once, the HiZ of this frame is complete
+			const auto lod_threshold = render::IndirectPipeline::lod_threshold_from_pixels(
+				config::LOD_PIXEL_ERROR,
+				frame.render_extent.y
+			);
+			const auto hlod_threshold = render::IndirectPipeline::lod_threshold_from_pixels(
+				config::HLOD_PIXEL_SIZE,
+				frame.render_extent.y
+			);
+			for (const auto cull_phase : {render::DrawPhase::Early, render::DrawPhase::Late})
+				pipeline.indirect.compute(
+					command_buffer,
+					frame.resource_set.blended_indirect,
+					cull_phase,
+					frame.hiz_history_valid,
+					lod_threshold,
+					false,
+					hlod_threshold
+				);
+
+			pipeline.transparent.render(command_buffer, frame.resource_set.transparent);
+			break;
+		}
+		}
+	}
+
+	coro::task<std::expected<void, Error>> RenderPage::record_parallel_pass(
+		const Frame& frame,
+		ParallelPass pass
+	) const noexcept
+	{
+		co_await thread_pool->schedule();
+
+		PROFILE_ZONE("Record pass");
+
+		co_return frame.secondary_recorder.record(
+			static_cast<uint32_t>(pass),
+			[this, &frame, pass](const vk::raii::CommandBuffer& command_buffer) {
+				record_pass(frame, command_buffer, pass);
+			}
+		);
+	}
+
+	std::expected<void, Error> RenderPage::record_parallel_passes(const Frame& frame) const noexcept
+	{
+		static_assert(PARALLEL_PASS_NAMES.size() == PARALLEL_PASS_COUNT);
+
+		auto tasks = std::views::iota(0u, PARALLEL_PASS_COUNT)
+			| std::views::transform([this, &frame](uint32_t pass) {
+				  return record_parallel_pass(frame, static_cast<ParallelPass>(pass));
+			  })
+			| std::ranges::to<std::vector>();
+
+		const auto results = coro::sync_wait(coro::when_all(std::move(tasks)));
+
+		for (const auto [pass, result] : std::views::enumerate(results))
+			if (!result.return_value())
+				return result.return_value().error().forward(
+					std::format("Record pass \"{}\" failed", PARALLEL_PASS_NAMES[pass])
+				);
+
+		return {};
+	}
+
+	void RenderPage::render_lighting(
+		const Frame& frame,
+		const vk::raii::CommandBuffer& command_buffer
+	) const noexcept
+	{
+		const auto rendering_area = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(frame.render_extent)
+		};
+
+		const auto hdr_attachment_info = vk::RenderingAttachmentInfo{
+			.imageView = frame.render_resource.attachments->hdr->attachment.view,
+			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
 			.loadOp = vk::AttachmentLoadOp::eLoad,
 			.storeOp = vk::AttachmentStoreOp::eStore,
 		};
 
-		const auto rendering_info =
+		auto rendering_info =
 			vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
 				.setColorAttachments(hdr_attachment_info);
 
-		frame.command_buffer.beginRendering(rendering_info);
+		// Coarse shading in hardware, when the device supports shading rate attachments
+		const auto shading_rate_info =
+			pipeline.direct_lighting.get_shading_rate_attachment_info(frame.resource_set.direct_lighting);
+		if (shading_rate_info.has_value()) rendering_info.setPNext(&*shading_rate_info);
+
+		command_buffer.beginRendering(rendering_info);
 		{
-			pipeline.direct_lighting.render(frame.command_buffer, frame.resource_set.direct_lighting);
+			pipeline.direct_lighting.render(
+				command_buffer,
+				frame.resource_set.direct_lighting,
+				frame.ambient_occlusion.has_value(),
+				frame.global_illumination.has_value(),
+				argument.environment_path.has_value(),
+				frame.atmosphere,
+				frame.checkerboard
+			);
 		}
-		frame.command_buffer.endRendering();
+		command_buffer.endRendering();
 
 		const auto post_lighting_barrier = vk::ImageMemoryBarrier2{
 			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
@@ -362,122 +2185,467 @@ namespace page
 			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
 		};
 
-		frame.command_buffer.pipelineBarrier2(
-			vk::DependencyInfo().setImageMemoryBarriers(post_lighting_barrier)
-		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_lighting_barrier));
 	}
 
-	void RenderPage::render_post_processing(const Frame& frame) const noexcept
+	std::expected<void, Error> RenderPage::record_auto_exposure(const Frame& frame) const noexcept
 	{
-		pipeline.auto_exposure.compute(frame.command_buffer, frame.resource_set.auto_exposure);
+		if (const auto result = frame.compute_command_buffer.begin({}); !result) return Error::from(result);
+
+		pipeline.auto_exposure.compute(
+			frame.compute_command_buffer,
+			frame.resource_set.auto_exposure,
+			vk::PipelineStageFlagBits2::eNone
+		);
+
+		if (const auto result = frame.compute_command_buffer.end(); !result) return Error::from(result);
+
+		return {};
 	}
 
 	std::expected<void, Error> RenderPage::render_composite(const Frame& frame) noexcept
 	{
-		const auto pre_composite_barrier = vk::ImageMemoryBarrier2{
-			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-			.srcAccessMask = vk::AccessFlagBits2::eNone,
-			.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-			.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
-			.oldLayout = vk::ImageLayout::eUndefined,
-			.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
-			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.image = frame.swapchain.attachment.image,
-			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
-		};
-
-		frame.command_buffer.pipelineBarrier2(
-			vk::DependencyInfo().setImageMemoryBarriers(pre_composite_barrier)
+		auto graph = render::RenderGraph(frame.frame_arena);
+
+		// Swapchain image is acquired before the color attachment output stage, see `present_frame`
+		const auto swapchain_image = graph.import_image(
+			frame.swapchain.attachment,
+			vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor),
+			{.stage = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			 .access = vk::AccessFlagBits2::eNone,
+			 .layout = vk::ImageLayout::eUndefined},
+			render::RenderGraph::ImageAccess{
+				.stage = vk::PipelineStageFlagBits2::eBottomOfPipe,
+				.access = vk::AccessFlagBits2::eNone,
+				.layout = vk::ImageLayout::ePresentSrcKHR
+			}
 		);
 
-		const auto rendering_area = vk::Rect2D{
-			.offset = vk::Offset2D{.x = 0, .y = 0},
-			.extent = vulkan::to<vk::Extent2D>(frame.swapchain.extent)
+		const auto overlay_read_access = render::RenderGraph::ImageAccess{
+			.stage = vk::PipelineStageFlagBits2::eFragmentShader,
+			.access = vk::AccessFlagBits2::eShaderSampledRead,
+			.layout = vk::ImageLayout::eShaderReadOnlyOptimal
 		};
 
-		const auto swapchain_attachment = vk::RenderingAttachmentInfo{
-			.imageView = frame.swapchain.attachment.view,
-			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
-			.loadOp = vk::AttachmentLoadOp::eClear,
-			.storeOp = vk::AttachmentStoreOp::eStore,
-			.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f)
+		// Recording discards the previous UI, which earlier frames blend before in submission order
+		auto overlay_image = std::optional<render::RenderGraph::ImageHandle>();
+		if (frame.overlay.has_value())
+			overlay_image = graph.import_image(
+				frame.overlay->attachment,
+				vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor),
+				frame.ui_recorded
+					? render::RenderGraph::ImageAccess{.stage = vk::PipelineStageFlagBits2::eFragmentShader,
+													   .access = vk::AccessFlagBits2::eNone,
+													   .layout = vk::ImageLayout::eUndefined}
+					: overlay_read_access,
+				overlay_read_access
+			);
+
+		if (overlay_image.has_value() && frame.ui_recorded)
+		{
+			const auto setup_overlay = [overlay_image](render::RenderGraph::PassBuilder& builder) {
+				builder.write(
+					*overlay_image,
+					{.stage = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+					 .access = vk::AccessFlagBits2::eColorAttachmentWrite,
+					 .layout = vk::ImageLayout::eColorAttachmentOptimal}
+				);
+			};
+
+			const auto execute_overlay = [this, &frame, overlay_image](
+											 const vk::raii::CommandBuffer& command_buffer,
+											 const render::RenderGraph::Resources& resources
+										 ) -> std::expected<void, Error> {
+				// Cleared transparent, the UI is then drawn as premultiplied color
+				const auto overlay_attachment = vk::RenderingAttachmentInfo{
+					.imageView = resources.image(*overlay_image).view,
+					.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+					.loadOp = vk::AttachmentLoadOp::eClear,
+					.storeOp = vk::AttachmentStoreOp::eStore,
+					.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 0.0f)
+				};
+
+				const auto rendering_area = vk::Rect2D{
+					.offset = vk::Offset2D{.x = 0, .y = 0},
+					.extent = vulkan::to<vk::Extent2D>(frame.overlay->extent)
+				};
+				const auto rendering_info =
+					vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
+						.setColorAttachments(overlay_attachment);
+
+				command_buffer.beginRendering(rendering_info);
+
+				if (const auto draw_result = context->imgui.draw(command_buffer); !draw_result)
+				{
+					command_buffer.endRendering();
+					return draw_result.error().forward("Draw ImGui failed");
+				}
+
+				command_buffer.endRendering();
+
+				return {};
+			};
+
+			graph.add_pass("Overlay", setup_overlay, execute_overlay);
+		}
+
+		const auto setup_composite =
+			[swapchain_image, overlay_image, overlay_read_access](render::RenderGraph::PassBuilder& builder) {
+				builder.write(
+					swapchain_image,
+					{.stage = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+					 .access = vk::AccessFlagBits2::eColorAttachmentWrite,
+					 .layout = vk::ImageLayout::eColorAttachmentOptimal}
+				);
+				if (overlay_image.has_value()) builder.read(*overlay_image, overlay_read_access);
+			};
+
+		const auto execute_composite = [this, &frame, swapchain_image](
+										   const vk::raii::CommandBuffer& command_buffer,
+										   const render::RenderGraph::Resources& resources
+									   ) -> std::expected<void, Error> {
+			const auto rendering_area = vk::Rect2D{
+				.offset = vk::Offset2D{.x = 0, .y = 0},
+				.extent = vulkan::to<vk::Extent2D>(frame.swapchain.extent)
+			};
+
+			const auto swapchain_attachment = vk::RenderingAttachmentInfo{
+				.imageView = resources.image(swapchain_image).view,
+				.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.loadOp = vk::AttachmentLoadOp::eClear,
+				.storeOp = vk::AttachmentStoreOp::eStore,
+				.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f)
+			};
+
+			const auto rendering_info =
+				vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
+					.setColorAttachments(swapchain_attachment);
+
+			command_buffer.beginRendering(rendering_info);
+
+			pipeline.composite.render(
+				command_buffer,
+				frame.resource_set.composite,
+				frame.bloom_intensity.value_or(0.0f),
+				frame.sharpness
+			);
+
+			// The cached layer is blended every frame, it holds the UI of the last recording
+			if (frame.overlay.has_value())
+				pipeline.overlay.render(command_buffer, frame.resource_set.overlay);
+			else if (const auto draw_result = context->imgui.draw(command_buffer); !draw_result)
+			{
+				command_buffer.endRendering();
+				return draw_result.error().forward("Draw ImGui failed");
+			}
+
+			command_buffer.endRendering();
+
+			return {};
 		};
 
-		const auto rendering_info =
-			vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
-				.setColorAttachments(swapchain_attachment);
+		graph.add_pass("Composite", setup_composite, execute_composite);
+
+		if (const auto result =
+				graph.execute(context->device.get(), frame.command_buffer, frame.transient_cache);
+			!result)
+			return result;
 
-		frame.command_buffer.beginRendering(rendering_info);
+		/* Capture */
 
-		pipeline.composite.render(frame.command_buffer, frame.resource_set.composite);
+		if (!argument.capture_command.has_value()) return {};
 
-		if (const auto draw_result = context->imgui.draw(frame.command_buffer); !draw_result)
+		if (!frame_capture.has_value())
 		{
-			frame.command_buffer.endRendering();
-			return draw_result.error().forward("Draw ImGui failed");
+			auto frame_capture_result = resource::FrameCapture::create(
+				context->device.get(),
+				*argument.capture_command,
+				frame.swapchain.extent,
+				context->swapchain->surface_format.format,
+				config::INFLIGHT_FRAMES,
+				config::CAPTURE_QUEUE_FRAMES
+			);
+			if (!frame_capture_result)
+				return frame_capture_result.error().forward("Create frame capture failed");
+			frame_capture.emplace(std::move(*frame_capture_result));
 		}
 
-		frame.command_buffer.endRendering();
-
-		const auto post_composite_barrier = vk::ImageMemoryBarrier2{
-			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-			.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
-			.dstStageMask = vk::PipelineStageFlagBits2::eBottomOfPipe,
-			.dstAccessMask = vk::AccessFlagBits2::eNone,
-			.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
-			.newLayout = vk::ImageLayout::ePresentSrcKHR,
-			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.image = frame.swapchain.attachment.image,
-			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
-		};
-
-		frame.command_buffer.pipelineBarrier2(
-			vk::DependencyInfo().setImageMemoryBarriers(post_composite_barrier)
-		);
+		// Composited again without the UI, the composite only samples the attachments of the frame
+		if (frame_capture->begin_capture(frame.command_buffer, frame.swapchain.extent))
+		{
+			pipeline.composite.render(
+				frame.command_buffer,
+				frame.resource_set.composite,
+				frame.bloom_intensity.value_or(0.0f),
+				frame.sharpness
+			);
+			frame_capture->end_capture(frame.command_buffer);
+		}
 
 		return {};
 	}
 
 	std::expected<void, Error> RenderPage::draw_frame(const Frame& frame) noexcept
 	{
+		PROFILE_ZONE("Draw frame");
+
+		if (const auto result = record_parallel_passes(frame); !result)
+			return result.error().forward("Record parallel passes failed");
+
 		if (const auto result = frame.command_buffer.begin({}); !result) return Error::from(result);
 
-		frame.render_resource.upload(frame.command_buffer);
+		frame.timestamp_query.begin_frame(frame.command_buffer);
+		frame.statistics_query.begin_frame(frame.command_buffer);
+		gpu_profiler.collect(frame.command_buffer);
+
+		// GPU zones of the profiler and debug labels mirror the timestamp scopes
+		{
+			const auto total_scope = frame.timestamp_query.scope(frame.command_buffer, "Total");
+			const auto total_zone = gpu_profiler.zone(frame.command_buffer, "Total");
+			const auto total_label = vulkan::DebugLabel(frame.command_buffer, "Total");
+
+			{
+				const auto scope = frame.timestamp_query.scope(frame.command_buffer, "Upload");
+				const auto zone = gpu_profiler.zone(frame.command_buffer, "Upload");
+				const auto label = vulkan::DebugLabel(frame.command_buffer, "Upload");
+				frame.render_resource.upload(frame.command_buffer);
+				if (texture_streamer.has_value()) texture_streamer->record(frame.command_buffer);
+				if (geometry_streamer.has_value()) geometry_streamer->record(frame.command_buffer);
+
+				// Posed vertices are refit into the BLASes before the TLAS is built over them
+				if (frame.deform)
+				{
+					pipeline.deform.compute(frame.command_buffer, frame.resource_set.deform);
+					model.blas_list.refit(frame.command_buffer);
+				}
+
+				if (tlas_rebuild_pending)
+				{
+					const auto result = tlas.replace_blas(context->device.get(), frame.command_buffer, model);
+					if (!result) return result.error().forward("Replace BLAS in TLAS failed");
+					tlas_rebuild_pending = false;
+				}
+				else
+				{
+					// Skipped while the previous frame may still copy from the staging buffer. Instances are
+					// compared against the last written ones, so a later update catches up with the last pose
+					bool tlas_updated = false;
+					if (animation_tlas_pending
+						&& frame.prev_sync_primitive.draw_fence.getStatus() == vk::Result::eSuccess)
+					{
+						const auto result =
+							tlas.update(context->device.get(), frame.command_buffer, animation_transforms);
+						if (!result) return result.error().forward("Update TLAS failed");
+						tlas_updated = *result;
+						animation_tlas_pending = false;
+					}
+
+					// Refit BLASes change the bounds of their instances even if no instance moved
+					if (frame.deform && !tlas_updated)
+						tlas.refit(context->device.get(), frame.command_buffer);
+
+					const auto cull = render::Tlas::InstanceCull{
+						.origin = tlas_cull_origin,
+						.radius = config::RT_NEAR_INSTANCE_RADIUS,
+					};
+					std::ignore = tlas.cull(context->device.get(), frame.command_buffer, cull);
+				}
+			}
 
-		render_objects(frame);
-		render_lighting(frame);
-		render_post_processing(frame);
+			// Previous HiZ is never built, transition it so that it can still be bound
+			if (!frame.hiz_history_valid)
+				render::HizPipeline::discard(
+					frame.command_buffer,
+					frame.prev_render_resource.attachments->hiz
+				);
 
-		if (const auto composite_result = render_composite(frame); !composite_result)
-			return composite_result.error().forward("Render final composite failed");
+			// Timestamps are written by the primary around each pass, secondary buffers only hold the pass
+			for (const auto pass : std::views::iota(0u, PARALLEL_PASS_COUNT))
+			{
+				const auto scope =
+					frame.timestamp_query.scope(frame.command_buffer, PARALLEL_PASS_NAMES[pass]);
+				const auto zone = gpu_profiler.zone(frame.command_buffer, PARALLEL_PASS_NAMES[pass]);
+				const auto label = vulkan::DebugLabel(frame.command_buffer, PARALLEL_PASS_NAMES[pass].data());
+				frame.secondary_recorder.execute(frame.command_buffer, pass);
+			}
+
+			// Resolved by the late G-buffer pass, delivered once this frame has completed
+			if (frame.object_pick.has_value())
+			{
+				const auto read_result = readback_ring.read_buffer(
+					context->device.get(),
+					frame.command_buffer,
+					frame.render_resource.object_pick.ref(),
+					0,
+					sizeof(render::PrimitiveDrawcall),
+					[picked_object = picked_object.get()](std::span<const std::byte> data) {
+						auto drawcall = render::PrimitiveDrawcall();
+						std::memcpy(&drawcall, data.data(), sizeof(drawcall));
+						*picked_object = drawcall;
+					}
+				);
+				if (!read_result) return read_result.error().forward("Record object pick readback failed");
+
+				if (const auto barrier = readback_ring.host_barrier())
+					frame.command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(*barrier));
+			}
+
+			// Auto-exposure of previous frame is missing, composite and upscale with unit exposure instead
+			if (!frame.exposure_valid)
+			{
+				const auto exposure_result_buffer =
+					frame.prev_render_resource.auto_exposure->exposure_result_buffer;
+				frame.command_buffer
+					.fillBuffer(exposure_result_buffer, 0, vk::WholeSize, std::bit_cast<uint32_t>(1.0f));
+
+				const auto fill_barrier = vk::BufferMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eClear,
+					.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+					.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader
+						| vk::PipelineStageFlagBits2::eFragmentShader,
+					.dstAccessMask = vk::AccessFlagBits2::eUniformRead,
+					.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+					.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+					.buffer = exposure_result_buffer,
+					.offset = 0,
+					.size = vk::WholeSize
+				};
+				frame.command_buffer.pipelineBarrier2(
+					vk::DependencyInfo().setBufferMemoryBarriers(fill_barrier)
+				);
+			}
+
+			if (frame.spatial_upscale)
+			{
+				const auto scope = frame.timestamp_query.scope(frame.command_buffer, "Spatial Upscale");
+				const auto zone = gpu_profiler.zone(frame.command_buffer, "Spatial Upscale");
+				pipeline.spatial_upscale.compute(frame.command_buffer, frame.resource_set.spatial_upscale);
+			}
+			else
+			{
+				const auto scope = frame.timestamp_query.scope(frame.command_buffer, "TAA");
+				const auto zone = gpu_profiler.zone(frame.command_buffer, "TAA");
+				const auto label = vulkan::DebugLabel(frame.command_buffer, "TAA");
+				pipeline.taa.compute(
+					frame.command_buffer,
+					frame.resource_set.taa,
+					frame.taa_history_valid,
+					frame.checkerboard
+				);
+			}
+
+			if (frame.bloom_intensity.has_value())
+			{
+				const auto scope = frame.timestamp_query.scope(frame.command_buffer, "Bloom");
+				const auto zone = gpu_profiler.zone(frame.command_buffer, "Bloom");
+				pipeline.bloom.compute(frame.command_buffer, frame.resource_set.bloom);
+			}
+			else
+				render::BloomPipeline::discard(
+					frame.command_buffer,
+					frame.render_resource.attachments->bloom
+				);
+
+			const auto scope = frame.timestamp_query.scope(frame.command_buffer, "Composite & UI");
+			const auto zone = gpu_profiler.zone(frame.command_buffer, "Composite & UI");
+			const auto label = vulkan::DebugLabel(frame.command_buffer, "Composite & UI");
+			if (const auto composite_result = render_composite(frame); !composite_result)
+				return composite_result.error().forward("Render final composite failed");
+		}
 
 		if (const auto result = frame.command_buffer.end(); !result) return Error::from(result);
 
+		if (const auto exposure_result = record_auto_exposure(frame); !exposure_result)
+			return exposure_result.error().forward("Record auto-exposure failed");
+
+		return {};
+	}
+
+	std::expected<void, Error> RenderPage::late_latch_camera(const Frame& frame) noexcept
+	{
+		// Path traced frames are compared against the camera of their history, which is not latched
+		if (!param.camera.late_latch_enabled || frame.path_trace.has_value()) return {};
+
+		// Dragging over the UI doesn't move the camera, see `logic::Camera::update_view`
+		if (ImGui::GetIO().WantCaptureMouse) return {};
+
+		SDL_PumpEvents();
+
+		auto events = std::array<SDL_Event, 64>();
+		const auto event_count = SDL_PeepEvents(
+			events.data(),
+			static_cast<int>(events.size()),
+			SDL_GETEVENT,
+			SDL_EVENT_MOUSE_MOTION,
+			SDL_EVENT_MOUSE_MOTION
+		);
+		if (event_count <= 0) return {};
+
+		auto motion = logic::Camera::MouseMotion{.delta = {0.0f, 0.0f}, .rotate = false, .pan = false};
+		for (const auto& event : events | std::views::take(event_count))
+		{
+			// Still delivered to ImGui, the camera discounts the motion from its next mouse delta
+			context->imgui.process_event(event);
+			motion.delta += glm::vec2(event.motion.xrel, event.motion.yrel);
+			motion.rotate |= (event.motion.state & SDL_BUTTON_RMASK) != 0;
+			motion.pan |= (event.motion.state & SDL_BUTTON_LMASK) != 0;
+		}
+
+		// Consumed here instead of by `handle_events` of the next frame
+		param.idle.mark_active(logic::Idle::Clock::now());
+		param.overlay.mark_input();
+
+		const auto camera = param.camera.late_latch(frame.swapchain.extent, motion);
+		if (!camera.has_value()) return {};
+
+		if (const auto result = frame.render_resource.param.latch_camera(*camera); !result)
+			return result.error().forward("Write latched camera failed");
+
 		return {};
 	}
 
 	std::expected<void, Error> RenderPage::present_frame(const Frame& frame) noexcept
 	{
+		PROFILE_ZONE("Present frame");
+
 		const auto command_buffer_submit_info = vk::CommandBufferSubmitInfo{
 			.commandBuffer = frame.command_buffer,
 		};
 
-		const auto wait_semaphore_info = vk::SemaphoreSubmitInfo{
-			.semaphore = frame.sync_primitive.image_available_semaphore,
-			.stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput
-		};
+		// Composite and spatial upscale apply the exposure computed from previous frame on the async compute
+		// queue
+		const auto wait_semaphore_infos = std::to_array({
+			vk::SemaphoreSubmitInfo{
+				.semaphore = frame.sync_primitive.image_available_semaphore,
+				.stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput
+			},
+			vk::SemaphoreSubmitInfo{
+				.semaphore = frame.prev_sync_primitive.timeline_semaphore,
+				.value = frame.prev_sync_primitive.exposure_value(),
+				.stageMask =
+					vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eFragmentShader
+			},
+		});
 
-		const auto signal_semaphore_info = vk::SemaphoreSubmitInfo{
-			.semaphore = frame.render_complete_semaphore,
-		};
+		const auto signal_semaphore_infos = std::to_array({
+			vk::SemaphoreSubmitInfo{
+				.semaphore = frame.render_complete_semaphore,
+			},
+			vk::SemaphoreSubmitInfo{
+				.semaphore = frame.sync_primitive.timeline_semaphore,
+				.value = frame.sync_primitive.render_value(),
+				.stageMask = vk::PipelineStageFlagBits2::eAllCommands
+			},
+		});
 
 		const auto submit_info =
 			vk::SubmitInfo2()
 				.setCommandBufferInfos(command_buffer_submit_info)
-				.setWaitSemaphoreInfos(wait_semaphore_info)
-				.setSignalSemaphoreInfos(signal_semaphore_info);
+				.setWaitSemaphoreInfos(wait_semaphore_infos)
+				.setSignalSemaphoreInfos(signal_semaphore_infos);
+
+		if (const auto result = late_latch_camera(frame); !result)
+			return result.error().forward("Late-latch camera failed");
 
 		if (const auto result = context->device->resetFences(*frame.sync_primitive.draw_fence); !result)
 			return Error::from(result);
@@ -487,6 +2655,37 @@ namespace page
 			!result)
 			return Error::from(result);
 
+		/* Async auto-exposure, overlaps with the next frame */
+
+		const auto compute_command_buffer_submit_info = vk::CommandBufferSubmitInfo{
+			.commandBuffer = frame.compute_command_buffer,
+		};
+
+		const auto compute_wait_semaphore_info = vk::SemaphoreSubmitInfo{
+			.semaphore = frame.sync_primitive.timeline_semaphore,
+			.value = frame.sync_primitive.render_value(),
+			.stageMask = vk::PipelineStageFlagBits2::eComputeShader
+		};
+
+		const auto compute_signal_semaphore_info = vk::SemaphoreSubmitInfo{
+			.semaphore = frame.sync_primitive.timeline_semaphore,
+			.value = frame.sync_primitive.exposure_value(),
+			.stageMask = vk::PipelineStageFlagBits2::eComputeShader
+		};
+
+		const auto compute_submit_info =
+			vk::SubmitInfo2()
+				.setCommandBufferInfos(compute_command_buffer_submit_info)
+				.setWaitSemaphoreInfos(compute_wait_semaphore_info)
+				.setSignalSemaphoreInfos(compute_signal_semaphore_info);
+
+		{
+			// Compute queue may be shared with `CommandRunner` of other threads, or alias the main queue
+			const std::scoped_lock lock(context->device.get().submit_mutex);
+			if (const auto result = context->device.get().compute_queue.submit2(compute_submit_info); !result)
+				return Error::from(result);
+		}
+
 		const auto present_result =
 			context->swapchain.present(context->device, frame.swapchain, frame.render_complete_semaphore);
 		if (!present_result) return present_result.error().forward("Present frame failed");
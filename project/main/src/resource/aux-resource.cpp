@@ -2,6 +2,7 @@
 #include "common/util/error.hpp"
 #include "image/common.hpp"
 #include "image/image.hpp"
+#include "image/noise.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/numeric/base-level.hpp"
 #include "vulkan/util/static-resource-creator.hpp"
@@ -33,6 +34,11 @@ namespace resource
 			return exposure_mask_image_result.error().forward("Decode exposure mask image failed");
 		auto exposure_mask_image = std::move(*exposure_mask_image_result);
 
+		auto blue_noise_image_result = image::get_blue_noise();
+		if (!blue_noise_image_result)
+			return blue_noise_image_result.error().forward("Load blue noise image failed");
+		auto blue_noise_image = std::move(*blue_noise_image_result);
+
 		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
 		if (!resource_creator_result)
 			return resource_creator_result.error().forward("Create resource creator failed");
@@ -48,8 +54,18 @@ namespace resource
 			return exposure_mask_texture_result.error().forward("Create exposure mask texture failed");
 		auto exposure_mask_texture = std::move(*exposure_mask_texture_result);
 
+		auto blue_noise_texture_result = resource_creator.create_image(
+			context,
+			blue_noise_image,
+			vk::Format::eR16G16B16A16Unorm,
+			vk::ImageUsageFlagBits::eSampled
+		);
+		if (!blue_noise_texture_result)
+			return blue_noise_texture_result.error().forward("Create blue noise texture failed");
+		auto blue_noise_texture = std::move(*blue_noise_texture_result);
+
 		if (const auto result = resource_creator.execute_uploads(context); !result)
-			return result.error().forward("Upload exposure mask texture failed");
+			return result.error().forward("Upload auxiliary textures failed");
 
 		auto exposure_mask_view_result = context.device.createImageView(
 			vk::ImageViewCreateInfo{
@@ -62,9 +78,22 @@ namespace resource
 		if (!exposure_mask_view_result) return Error::from(exposure_mask_view_result);
 		auto exposure_mask_view = std::move(*exposure_mask_view_result);
 
+		auto blue_noise_view_result = context.device.createImageView(
+			vk::ImageViewCreateInfo{
+				.image = blue_noise_texture,
+				.viewType = vk::ImageViewType::e2D,
+				.format = vk::Format::eR16G16B16A16Unorm,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			}
+		);
+		if (!blue_noise_view_result) return Error::from(blue_noise_view_result);
+		auto blue_noise_view = std::move(*blue_noise_view_result);
+
 		return AuxResource{
 			.exposure_mask = std::move(exposure_mask_texture),
 			.exposure_mask_view = std::move(exposure_mask_view),
+			.blue_noise = std::move(blue_noise_texture),
+			.blue_noise_view = std::move(blue_noise_view),
 		};
 	}
 }
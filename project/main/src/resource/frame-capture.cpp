@@ -0,0 +1,338 @@
+#include "resource/frame-capture.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/alloc/category.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/glm.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#if !defined(_WIN32)
+#include <csignal>
+#endif
+
+namespace resource
+{
+	namespace
+	{
+		struct CaptureFormat
+		{
+			std::string_view name;  // FFmpeg pixel format
+			size_t texel_size;
+		};
+
+		std::optional<CaptureFormat> get_capture_format(vk::Format format) noexcept
+		{
+			switch (format)
+			{
+			case vk::Format::eB8G8R8A8Unorm:
+			case vk::Format::eB8G8R8A8Srgb:
+				return CaptureFormat{.name = "bgra", .texel_size = 4};
+			case vk::Format::eR8G8B8A8Unorm:
+			case vk::Format::eR8G8B8A8Srgb:
+				return CaptureFormat{.name = "rgba", .texel_size = 4};
+			case vk::Format::eA2B10G10R10UnormPack32:
+				return CaptureFormat{.name = "x2bgr10le", .texel_size = 4};
+			case vk::Format::eR16G16B16A16Sfloat:
+				return CaptureFormat{.name = "rgbaf16le", .texel_size = 8};
+			default:
+				return std::nullopt;
+			}
+		}
+
+		std::string replace_all(std::string text, std::string_view pattern, std::string_view value) noexcept
+		{
+			for (auto pos = text.find(pattern); pos != std::string::npos;
+				 pos = text.find(pattern, pos + value.size()))
+				text.replace(pos, pattern.size(), value);
+
+			return text;
+		}
+
+		std::FILE* open_pipe(const std::string& command) noexcept
+		{
+#if defined(_WIN32)
+			return _popen(command.c_str(), "wb");
+#else
+			return popen(command.c_str(), "w");
+#endif
+		}
+	}
+
+	void FrameCapture::PipeCloser::operator()(std::FILE* pipe) const noexcept
+	{
+#if defined(_WIN32)
+		_pclose(pipe);
+#else
+		pclose(pipe);
+#endif
+	}
+
+	std::expected<FrameCapture, Error> FrameCapture::create(
+		const vulkan::Context& context,
+		std::string_view command,
+		glm::u32vec2 extent,
+		vk::Format format,
+		uint32_t frame_count,
+		uint32_t queue_count
+	) noexcept
+	{
+		const auto capture_format = get_capture_format(format);
+		if (!capture_format)
+			return Error("Unsupported capture format", vk::to_string(format));
+
+		const auto frame_size = size_t(extent.x) * extent.y * capture_format->texel_size;
+
+		std::vector<vulkan::Buffer> buffers;
+		for ([[maybe_unused]] const auto _ : std::views::iota(0u, frame_count + queue_count))
+		{
+			auto buffer_result = context.allocator.create_buffer(
+				vk::BufferCreateInfo{.size = frame_size, .usage = vk::BufferUsageFlagBits::eTransferDst},
+				vulkan::MemoryUsage::GpuToCpu,
+				vulkan::MemoryCategory::Staging
+			);
+			if (!buffer_result) return buffer_result.error().forward("Create capture readback buffer failed");
+			buffers.emplace_back(std::move(*buffer_result));
+		}
+
+		auto target_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			format,
+			vk::ImageUsageFlagBits::eTransferSrc,
+			{},
+			"Capture Target"
+		);
+		if (!target_result) return target_result.error().forward("Create capture target failed");
+
+#if !defined(_WIN32)
+		// An exiting encoder must fail the writes instead of terminating the renderer
+		std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+		auto full_command = replace_all(std::string(command), "{width}", std::to_string(extent.x));
+		full_command = replace_all(std::move(full_command), "{height}", std::to_string(extent.y));
+		full_command = replace_all(std::move(full_command), "{format}", capture_format->name);
+
+		auto pipe = std::unique_ptr<std::FILE, PipeCloser>(open_pipe(full_command));
+		if (pipe == nullptr) return Error("Launch encoder process failed", full_command);
+
+		auto shared = std::make_unique<Shared>();
+		shared->states.assign(buffers.size(), SlotState::Free);
+		shared->buffers = std::move(buffers);
+		shared->pipe = std::move(pipe);
+		shared->frame_size = frame_size;
+
+		return FrameCapture(std::move(shared), std::move(*target_result), extent, frame_count);
+	}
+
+	void FrameCapture::write_loop(std::stop_token stop_token, Shared& shared) noexcept
+	{
+		while (true)
+		{
+			auto lock = std::unique_lock(shared.mutex);
+
+			// Frames queued before stopping are still written
+			shared.condition.wait(lock, stop_token, [&shared] { return !shared.queue.empty(); });
+			if (shared.queue.empty()) return;
+
+			const auto slot = shared.queue.front();
+			shared.queue.pop_front();
+			const bool failed = shared.failed;
+			lock.unlock();
+
+			// The slot is only touched by this thread while `Writing`
+			const auto data = shared.buffers[slot].mapped().subspan(0, shared.frame_size);
+			const bool written =
+				!failed && std::fwrite(data.data(), 1, data.size(), shared.pipe.get()) == data.size();
+
+			lock.lock();
+			shared.states[slot] = SlotState::Free;
+			if (written)
+				shared.written_frames++;
+			else
+				shared.failed = true;
+		}
+	}
+
+	std::expected<void, Error> FrameCapture::submit_slot(size_t slot) noexcept
+	{
+		if (const auto result = shared->buffers[slot].invalidate(0, shared->frame_size); !result)
+			return result.error().forward("Invalidate capture readback buffer failed");
+
+		{
+			const std::scoped_lock lock(shared->mutex);
+			shared->states[slot] = SlotState::Writing;
+			shared->queue.push_back(slot);
+		}
+		shared->condition.notify_one();
+
+		return {};
+	}
+
+	std::expected<void, Error> FrameCapture::begin_frame() noexcept
+	{
+		current_frame = (current_frame + 1) % frame_slots.size();
+
+		if (const auto slot = std::exchange(frame_slots[current_frame], std::nullopt))
+			return submit_slot(*slot);
+
+		return {};
+	}
+
+	bool FrameCapture::begin_capture(
+		const vk::raii::CommandBuffer& command_buffer,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		if (extent != this->extent)
+		{
+			dropped_frames++;
+			return false;
+		}
+
+		{
+			const std::scoped_lock lock(shared->mutex);
+			const auto free_slot = std::ranges::find(shared->states, SlotState::Free);
+			if (free_slot == shared->states.end())
+			{
+				dropped_frames++;
+				return false;
+			}
+
+			*free_slot = SlotState::Recorded;
+			capturing_slot = std::ranges::distance(shared->states.begin(), free_slot);
+		}
+
+		const auto target_view = vulkan::AttachmentView(target);
+
+		// Previous content is never read, but its copy into a readback buffer must complete first
+		const auto pre_capture_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = target_view.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_capture_barrier));
+
+		const auto rendering_area = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(extent)
+		};
+
+		const auto target_attachment = vk::RenderingAttachmentInfo{
+			.imageView = target_view.view,
+			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.loadOp = vk::AttachmentLoadOp::eClear,
+			.storeOp = vk::AttachmentStoreOp::eStore,
+			.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f)
+		};
+
+		command_buffer.beginRendering(
+			vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
+				.setColorAttachments(target_attachment)
+		);
+
+		return true;
+	}
+
+	void FrameCapture::end_capture(const vk::raii::CommandBuffer& command_buffer) noexcept
+	{
+		command_buffer.endRendering();
+
+		const auto slot = std::exchange(capturing_slot, std::nullopt);
+		DEBUG_ASSERT(slot.has_value(), "`end_capture` called without a successful `begin_capture`");
+
+		const auto target_view = vulkan::AttachmentView(target);
+
+		const auto copy_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eCopy,
+			.dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+			.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.newLayout = vk::ImageLayout::eTransferSrcOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = target_view.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(copy_barrier));
+
+		const auto copy_region = vk::BufferImageCopy{
+			.bufferOffset = 0,
+			.imageSubresource = {
+				.aspectMask = vk::ImageAspectFlagBits::eColor,
+				.mipLevel = 0,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			},
+			.imageOffset = {.x = 0,            .y = 0,             .z = 0    },
+			.imageExtent = {.width = extent.x, .height = extent.y, .depth = 1}
+		};
+		command_buffer.copyImageToBuffer(
+			target_view.image,
+			vk::ImageLayout::eTransferSrcOptimal,
+			shared->buffers[*slot],
+			copy_region
+		);
+
+		const auto host_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eHost,
+			.dstAccessMask = vk::AccessFlagBits2::eHostRead
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(host_barrier));
+
+		frame_slots[current_frame] = *slot;
+	}
+
+	std::expected<void, Error> FrameCapture::flush() noexcept
+	{
+		// Oldest first, keeping the capture order
+		for ([[maybe_unused]] const auto _ : std::views::iota(0zu, frame_slots.size()))
+			if (const auto result = begin_frame(); !result) return result;
+
+		return {};
+	}
+
+	FrameCapture::Stat FrameCapture::get_stat() const noexcept
+	{
+		const std::scoped_lock lock(shared->mutex);
+
+		return {
+			.written_frames = shared->written_frames,
+			.dropped_frames = dropped_frames,
+			.failed = shared->failed,
+		};
+	}
+}
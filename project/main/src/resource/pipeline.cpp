@@ -1,64 +1,430 @@
 #include "resource/pipeline.hpp"
 #include "common/util/construct.hpp"
 #include "common/util/error.hpp"
+#include "config.hpp"
 #include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
 #include "render/model/model.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/model/tlas.hpp"
+#include "render/pipeline/ambient-occlusion.hpp"
+#include "render/pipeline/atmosphere.hpp"
 #include "render/pipeline/auto-exposure.hpp"
+#include "render/pipeline/bloom.hpp"
+#include "render/pipeline/cascade-shadow.hpp"
 #include "render/pipeline/composite.hpp"
+#include "render/pipeline/contact-shadow.hpp"
+#include "render/pipeline/deferred-meshlet.hpp"
 #include "render/pipeline/deferred.hpp"
+#include "render/pipeline/deform.hpp"
+#include "render/pipeline/denoise.hpp"
 #include "render/pipeline/direct.hpp"
+#include "render/pipeline/gi-probe.hpp"
+#include "render/pipeline/hiz.hpp"
+#include "render/pipeline/impostor.hpp"
 #include "render/pipeline/indirect.hpp"
+#include "render/pipeline/light-cluster.hpp"
+#include "render/pipeline/object-pick.hpp"
+#include "render/pipeline/overlay.hpp"
+#include "render/pipeline/path-trace.hpp"
+#include "render/pipeline/reflection.hpp"
+#include "render/pipeline/restir.hpp"
+#include "render/pipeline/shading-rate.hpp"
+#include "render/pipeline/shadow.hpp"
+#include "render/pipeline/taa.hpp"
+#include "render/pipeline/transform.hpp"
+#include "render/pipeline/transparent.hpp"
+#include "render/pipeline/visibility.hpp"
+#include "render/resource/cascade-shadow.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "render/resource/path-trace.hpp"
 #include "resource/aux-resource.hpp"
 #include "resource/render-resource.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
 #include <cstdint>
 #include <expected>
 #include <libassert/assert.hpp>
+#include <optional>
 #include <ranges>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
 namespace resource
 {
+	namespace
+	{
+		// Run a pipeline creation on the thread pool
+		template <typename F>
+		coro::task<std::invoke_result_t<F>> create_on(coro::thread_pool& thread_pool, F create) noexcept
+		{
+			co_await thread_pool.schedule();
+			co_return create();
+		}
+	}
+
 	std::expected<Pipeline, Error> Pipeline::create(
+		coro::thread_pool& thread_pool,
 		const vulkan::Context& context,
 		const render::MaterialLayout& material_layout,
-		vk::Format composite_format
+		render::VertexFormat vertex_format,
+		vk::Format composite_format,
+		vk::Format hdr_format,
+		GBufferPath gbuffer_path
 	) noexcept
 	{
-		auto indirect_pipeline_result = render::IndirectPipeline::create(context);
+		constexpr auto deferred_vertex_fetch = config::DEFERRED_VERTEX_PULLING
+			? render::DeferredPipeline::VertexFetch::Pull
+			: render::DeferredPipeline::VertexFetch::Attribute;
+
+		// Pipelines are independent of each other, and the pipeline cache is internally synchronized
+		auto [transform_task,
+			  deform_task,
+			  shading_rate_task,
+			  indirect_task,
+			  deferred_task,
+			  impostor_task,
+			  object_pick_task,
+			  hiz_task,
+			  light_cluster_task,
+			  shadow_task,
+			  cascade_shadow_task,
+			  contact_shadow_task,
+			  ambient_occlusion_task,
+			  gi_probe_task,
+			  atmosphere_task,
+			  direct_lighting_task,
+			  restir_task,
+			  reflection_task,
+			  denoise_task,
+			  transparent_task,
+			  path_trace_task,
+			  auto_exposure_task,
+			  taa_task,
+			  spatial_upscale_task,
+			  bloom_task,
+			  composite_task,
+			  overlay_task] =
+			coro::sync_wait(
+				coro::when_all(
+					create_on(thread_pool, [&] { return render::TransformPipeline::create(context); }),
+					create_on(thread_pool, [&] { return render::DeformPipeline::create(context); }),
+					create_on(
+						thread_pool,
+						[&] { return render::ShadingRatePipeline::create(context, hdr_format); }
+					),
+					create_on(thread_pool, [&] { return render::IndirectPipeline::create(context); }),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::DeferredPipeline::create(
+								context,
+								material_layout,
+								vertex_format,
+								deferred_vertex_fetch,
+								1,
+								hdr_format
+							);
+						}
+					),
+					create_on(
+						thread_pool,
+						[&] { return render::ImpostorPipeline::create(context, hdr_format); }
+					),
+					create_on(thread_pool, [&] { return render::ObjectPickPipeline::create(context); }),
+					create_on(thread_pool, [&] { return render::HizPipeline::create(context); }),
+					create_on(thread_pool, [&] { return render::LightClusterPipeline::create(context); }),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::ShadowPipeline::create(context, material_layout, vertex_format);
+						}
+					),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::CascadeShadowPipeline::create(
+								context,
+								material_layout,
+								vertex_format
+							);
+						}
+					),
+					create_on(thread_pool, [&] { return render::ContactShadowPipeline::create(context); }),
+					create_on(thread_pool, [&] { return render::AmbientOcclusionPipeline::create(context); }),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::GiProbePipeline::create(context, material_layout, vertex_format);
+						}
+					),
+					create_on(thread_pool, [&] { return render::AtmospherePipeline::create(context); }),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::DirectLightingPipeline::create(
+								context,
+								render::DirectLightingPipeline::Precision::Half,
+								hdr_format
+							);
+						}
+					),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::RestirPipeline::create(context, material_layout, vertex_format);
+						}
+					),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::ReflectionPipeline::create(
+								context,
+								material_layout,
+								vertex_format
+							);
+						}
+					),
+					create_on(thread_pool, [&] { return render::DenoisePipeline::create(context); }),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::TransparentPipeline::create(
+								context,
+								material_layout,
+								vertex_format
+							);
+						}
+					),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::PathTracePipeline::create(
+								context,
+								material_layout,
+								vertex_format,
+								hdr_format
+							);
+						}
+					),
+					create_on(
+						thread_pool,
+						[&] {
+							return render::AutoExposurePipeline::create(
+								context,
+								config::AUTO_EXPOSURE_HISTOGRAM_DOWNSCALE
+							);
+						}
+					),
+					create_on(thread_pool, [&] { return render::TaaPipeline::create(context); }),
+					create_on(thread_pool, [&] { return render::SpatialUpscalePipeline::create(context); }),
+					create_on(thread_pool, [&] { return render::BloomPipeline::create(context); }),
+					create_on(
+						thread_pool,
+						[&] { return render::CompositePipeline::create(context, composite_format); }
+					),
+					create_on(
+						thread_pool,
+						[&] { return render::OverlayPipeline::create(context, composite_format); }
+					)
+				)
+			);
+
+		auto transform_pipeline_result = std::move(transform_task.return_value());
+		if (!transform_pipeline_result)
+			return transform_pipeline_result.error().forward("Create transform pipeline failed");
+		auto transform_pipeline = std::move(*transform_pipeline_result);
+
+		auto deform_pipeline_result = std::move(deform_task.return_value());
+		if (!deform_pipeline_result)
+			return deform_pipeline_result.error().forward("Create deform pipeline failed");
+		auto deform_pipeline = std::move(*deform_pipeline_result);
+
+		auto shading_rate_pipeline_result = std::move(shading_rate_task.return_value());
+		if (!shading_rate_pipeline_result)
+			return shading_rate_pipeline_result.error().forward("Create shading rate pipeline failed");
+		auto shading_rate_pipeline = std::move(*shading_rate_pipeline_result);
+
+		auto indirect_pipeline_result = std::move(indirect_task.return_value());
 		if (!indirect_pipeline_result)
 			return indirect_pipeline_result.error().forward("Create indirect pipeline failed");
 		auto indirect_pipeline = std::move(*indirect_pipeline_result);
 
-		auto deferred_pipeline_result = render::DeferredPipeline::create(context, material_layout);
+		auto deferred_pipeline_result = std::move(deferred_task.return_value());
 		if (!deferred_pipeline_result)
 			return deferred_pipeline_result.error().forward("Create deferred pipeline failed");
 		auto deferred_pipeline = std::move(*deferred_pipeline_result);
 
-		auto direct_lighting_pipeline_result = render::DirectLightingPipeline::create(context);
+		auto impostor_pipeline_result = std::move(impostor_task.return_value());
+		if (!impostor_pipeline_result)
+			return impostor_pipeline_result.error().forward("Create impostor pipeline failed");
+		auto impostor_pipeline = std::move(*impostor_pipeline_result);
+
+		auto object_pick_pipeline_result = std::move(object_pick_task.return_value());
+		if (!object_pick_pipeline_result)
+			return object_pick_pipeline_result.error().forward("Create object pick pipeline failed");
+		auto object_pick_pipeline = std::move(*object_pick_pipeline_result);
+
+		auto hiz_pipeline_result = std::move(hiz_task.return_value());
+		if (!hiz_pipeline_result) return hiz_pipeline_result.error().forward("Create HiZ pipeline failed");
+		auto hiz_pipeline = std::move(*hiz_pipeline_result);
+
+		auto light_cluster_pipeline_result = std::move(light_cluster_task.return_value());
+		if (!light_cluster_pipeline_result)
+			return light_cluster_pipeline_result.error().forward("Create light cluster pipeline failed");
+		auto light_cluster_pipeline = std::move(*light_cluster_pipeline_result);
+
+		auto shadow_pipeline_result = std::move(shadow_task.return_value());
+		if (!shadow_pipeline_result)
+			return shadow_pipeline_result.error().forward("Create shadow pipeline failed");
+		auto shadow_pipeline = std::move(*shadow_pipeline_result);
+
+		auto cascade_shadow_pipeline_result = std::move(cascade_shadow_task.return_value());
+		if (!cascade_shadow_pipeline_result)
+			return cascade_shadow_pipeline_result.error().forward("Create cascade shadow pipeline failed");
+		auto cascade_shadow_pipeline = std::move(*cascade_shadow_pipeline_result);
+
+		auto contact_shadow_pipeline_result = std::move(contact_shadow_task.return_value());
+		if (!contact_shadow_pipeline_result)
+			return contact_shadow_pipeline_result.error().forward("Create contact shadow pipeline failed");
+		auto contact_shadow_pipeline = std::move(*contact_shadow_pipeline_result);
+
+		auto ambient_occlusion_pipeline_result = std::move(ambient_occlusion_task.return_value());
+		if (!ambient_occlusion_pipeline_result)
+			return ambient_occlusion_pipeline_result.error().forward(
+				"Create ambient occlusion pipeline failed"
+			);
+		auto ambient_occlusion_pipeline = std::move(*ambient_occlusion_pipeline_result);
+
+		auto gi_probe_pipeline_result = std::move(gi_probe_task.return_value());
+		if (!gi_probe_pipeline_result)
+			return gi_probe_pipeline_result.error().forward("Create probe update pipeline failed");
+		auto gi_probe_pipeline = std::move(*gi_probe_pipeline_result);
+
+		auto atmosphere_pipeline_result = std::move(atmosphere_task.return_value());
+		if (!atmosphere_pipeline_result)
+			return atmosphere_pipeline_result.error().forward("Create atmosphere pipeline failed");
+		auto atmosphere_pipeline = std::move(*atmosphere_pipeline_result);
+
+		auto direct_lighting_pipeline_result = std::move(direct_lighting_task.return_value());
 		if (!direct_lighting_pipeline_result)
 			return direct_lighting_pipeline_result.error().forward("Create direct lighting pipeline failed");
 		auto direct_lighting_pipeline = std::move(*direct_lighting_pipeline_result);
 
-		auto auto_exposure_pipeline_result = render::AutoExposurePipeline::create(context);
+		auto restir_pipeline_result = std::move(restir_task.return_value());
+		if (!restir_pipeline_result)
+			return restir_pipeline_result.error().forward("Create ReSTIR pipeline failed");
+		auto restir_pipeline = std::move(*restir_pipeline_result);
+
+		auto reflection_pipeline_result = std::move(reflection_task.return_value());
+		if (!reflection_pipeline_result)
+			return reflection_pipeline_result.error().forward("Create reflection pipeline failed");
+		auto reflection_pipeline = std::move(*reflection_pipeline_result);
+
+		auto denoise_pipeline_result = std::move(denoise_task.return_value());
+		if (!denoise_pipeline_result)
+			return denoise_pipeline_result.error().forward("Create denoise pipeline failed");
+		auto denoise_pipeline = std::move(*denoise_pipeline_result);
+
+		auto transparent_pipeline_result = std::move(transparent_task.return_value());
+		if (!transparent_pipeline_result)
+			return transparent_pipeline_result.error().forward("Create transparent pipeline failed");
+		auto transparent_pipeline = std::move(*transparent_pipeline_result);
+
+		auto path_trace_pipeline_result = std::move(path_trace_task.return_value());
+		if (!path_trace_pipeline_result)
+			return path_trace_pipeline_result.error().forward("Create path tracing pipeline failed");
+		auto path_trace_pipeline = std::move(*path_trace_pipeline_result);
+
+		auto auto_exposure_pipeline_result = std::move(auto_exposure_task.return_value());
 		if (!auto_exposure_pipeline_result)
 			return auto_exposure_pipeline_result.error().forward("Create auto-exposure pipeline failed");
 		auto auto_exposure_pipeline = std::move(*auto_exposure_pipeline_result);
 
-		auto composite_pipeline_result = render::CompositePipeline::create(context, composite_format);
+		auto taa_pipeline_result = std::move(taa_task.return_value());
+		if (!taa_pipeline_result) return taa_pipeline_result.error().forward("Create TAA pipeline failed");
+		auto taa_pipeline = std::move(*taa_pipeline_result);
+
+		auto spatial_upscale_pipeline_result = std::move(spatial_upscale_task.return_value());
+		if (!spatial_upscale_pipeline_result)
+			return spatial_upscale_pipeline_result.error().forward("Create spatial upscale pipeline failed");
+		auto spatial_upscale_pipeline = std::move(*spatial_upscale_pipeline_result);
+
+		auto bloom_pipeline_result = std::move(bloom_task.return_value());
+		if (!bloom_pipeline_result)
+			return bloom_pipeline_result.error().forward("Create bloom pipeline failed");
+		auto bloom_pipeline = std::move(*bloom_pipeline_result);
+
+		auto composite_pipeline_result = std::move(composite_task.return_value());
 		if (!composite_pipeline_result)
 			return composite_pipeline_result.error().forward("Create composite pipeline failed");
 		auto composite_pipeline = std::move(*composite_pipeline_result);
 
+		auto overlay_pipeline_result = std::move(overlay_task.return_value());
+		if (!overlay_pipeline_result)
+			return overlay_pipeline_result.error().forward("Create overlay pipeline failed");
+		auto overlay_pipeline = std::move(*overlay_pipeline_result);
+
+		// Alternative G-buffer paths are only compiled when selected, rarely enough to not be parallelized
+		std::optional<render::MeshletDeferredPipeline> meshlet_deferred_pipeline;
+		if (gbuffer_path == GBufferPath::Meshlet)
+		{
+			auto meshlet_deferred_pipeline_result =
+				render::MeshletDeferredPipeline::create(context, material_layout, vertex_format, hdr_format);
+			if (!meshlet_deferred_pipeline_result)
+				return meshlet_deferred_pipeline_result.error().forward(
+					"Create meshlet deferred pipeline failed"
+				);
+			meshlet_deferred_pipeline = std::move(*meshlet_deferred_pipeline_result);
+		}
+
+		std::optional<render::VisibilityPipeline> visibility_pipeline;
+		if (gbuffer_path == GBufferPath::Visibility)
+		{
+			auto visibility_pipeline_result =
+				render::VisibilityPipeline::create(context, material_layout, vertex_format, hdr_format);
+			if (!visibility_pipeline_result)
+				return visibility_pipeline_result.error().forward("Create visibility pipeline failed");
+			visibility_pipeline = std::move(*visibility_pipeline_result);
+		}
+
 		return Pipeline{
+			.transform = std::move(transform_pipeline),
+			.deform = std::move(deform_pipeline),
+			.shading_rate = std::move(shading_rate_pipeline),
 			.indirect = std::move(indirect_pipeline),
 			.deferred = std::move(deferred_pipeline),
+			.impostor = std::move(impostor_pipeline),
+			.object_pick = std::move(object_pick_pipeline),
+			.hiz = std::move(hiz_pipeline),
+			.light_cluster = std::move(light_cluster_pipeline),
+			.shadow = std::move(shadow_pipeline),
+			.cascade_shadow = std::move(cascade_shadow_pipeline),
+			.contact_shadow = std::move(contact_shadow_pipeline),
+			.ambient_occlusion = std::move(ambient_occlusion_pipeline),
+			.gi_probe = std::move(gi_probe_pipeline),
+			.atmosphere = std::move(atmosphere_pipeline),
 			.direct_lighting = std::move(direct_lighting_pipeline),
+			.restir = std::move(restir_pipeline),
+			.reflection = std::move(reflection_pipeline),
+			.denoise = std::move(denoise_pipeline),
+			.transparent = std::move(transparent_pipeline),
+			.path_trace = std::move(path_trace_pipeline),
 			.auto_exposure = std::move(auto_exposure_pipeline),
-			.composite = std::move(composite_pipeline)
+			.taa = std::move(taa_pipeline),
+			.spatial_upscale = std::move(spatial_upscale_pipeline),
+			.bloom = std::move(bloom_pipeline),
+			.composite = std::move(composite_pipeline),
+			.overlay = std::move(overlay_pipeline),
+			.meshlet_deferred = std::move(meshlet_deferred_pipeline),
+			.visibility = std::move(visibility_pipeline)
 		};
 	}
 
@@ -67,6 +433,27 @@ namespace resource
 		uint32_t count
 	) const noexcept
 	{
+		auto transform_resource_set_result = transform.create_resource_sets(context, count);
+		if (!transform_resource_set_result)
+			return transform_resource_set_result.error().forward(
+				"Create resource sets for transform pipeline failed"
+			);
+		auto transform_resource_sets = std::move(*transform_resource_set_result);
+
+		auto deform_resource_set_result = deform.create_resource_sets(context, count);
+		if (!deform_resource_set_result)
+			return deform_resource_set_result.error().forward(
+				"Create resource sets for deform pipeline failed"
+			);
+		auto deform_resource_sets = std::move(*deform_resource_set_result);
+
+		auto shading_rate_resource_set_result = shading_rate.create_resource_sets(context, count);
+		if (!shading_rate_resource_set_result)
+			return shading_rate_resource_set_result.error().forward(
+				"Create resource sets for shading rate pipeline failed"
+			);
+		auto shading_rate_resource_sets = std::move(*shading_rate_resource_set_result);
+
 		auto indirect_resource_set_result = indirect.create_resource_sets(context, count);
 		if (!indirect_resource_set_result)
 			return indirect_resource_set_result.error().forward(
@@ -74,6 +461,13 @@ namespace resource
 			);
 		auto indirect_resource_sets = std::move(*indirect_resource_set_result);
 
+		auto blended_indirect_resource_set_result = indirect.create_resource_sets(context, count);
+		if (!blended_indirect_resource_set_result)
+			return blended_indirect_resource_set_result.error().forward(
+				"Create blended resource sets for indirect pipeline failed"
+			);
+		auto blended_indirect_resource_sets = std::move(*blended_indirect_resource_set_result);
+
 		auto deferred_resource_set_result = deferred.create_resource_sets(context, count);
 		if (!deferred_resource_set_result)
 			return deferred_resource_set_result.error().forward(
@@ -81,6 +475,67 @@ namespace resource
 			);
 		auto deferred_resource_sets = std::move(*deferred_resource_set_result);
 
+		auto impostor_resource_set_result = impostor.create_resource_sets(context, count);
+		if (!impostor_resource_set_result)
+			return impostor_resource_set_result.error().forward(
+				"Create resource sets for impostor pipeline failed"
+			);
+		auto impostor_resource_sets = std::move(*impostor_resource_set_result);
+
+		auto object_pick_resource_set_result = object_pick.create_resource_sets(context, count);
+		if (!object_pick_resource_set_result)
+			return object_pick_resource_set_result.error().forward(
+				"Create resource sets for object pick pipeline failed"
+			);
+		auto object_pick_resource_sets = std::move(*object_pick_resource_set_result);
+
+		auto hiz_resource_set_result = hiz.create_resource_sets(context, count);
+		if (!hiz_resource_set_result)
+			return hiz_resource_set_result.error().forward("Create resource sets for HiZ pipeline failed");
+		auto hiz_resource_sets = std::move(*hiz_resource_set_result);
+
+		auto light_cluster_resource_set_result = light_cluster.create_resource_sets(context, count);
+		if (!light_cluster_resource_set_result)
+			return light_cluster_resource_set_result.error().forward(
+				"Create resource sets for light cluster pipeline failed"
+			);
+		auto light_cluster_resource_sets = std::move(*light_cluster_resource_set_result);
+
+		auto shadow_resource_set_result = shadow.create_resource_sets(context, count);
+		if (!shadow_resource_set_result)
+			return shadow_resource_set_result.error().forward(
+				"Create resource sets for shadow pipeline failed"
+			);
+		auto shadow_resource_sets = std::move(*shadow_resource_set_result);
+
+		auto cascade_shadow_resource_set_result = cascade_shadow.create_resource_sets(context, count);
+		if (!cascade_shadow_resource_set_result)
+			return cascade_shadow_resource_set_result.error().forward(
+				"Create resource sets for cascade shadow pipeline failed"
+			);
+		auto cascade_shadow_resource_sets = std::move(*cascade_shadow_resource_set_result);
+
+		auto contact_shadow_resource_set_result = contact_shadow.create_resource_sets(context, count);
+		if (!contact_shadow_resource_set_result)
+			return contact_shadow_resource_set_result.error().forward(
+				"Create resource sets for contact shadow pipeline failed"
+			);
+		auto contact_shadow_resource_sets = std::move(*contact_shadow_resource_set_result);
+
+		auto ambient_occlusion_resource_set_result = ambient_occlusion.create_resource_sets(context, count);
+		if (!ambient_occlusion_resource_set_result)
+			return ambient_occlusion_resource_set_result.error().forward(
+				"Create resource sets for ambient occlusion pipeline failed"
+			);
+		auto ambient_occlusion_resource_sets = std::move(*ambient_occlusion_resource_set_result);
+
+		auto gi_probe_resource_set_result = gi_probe.create_resource_sets(context, count);
+		if (!gi_probe_resource_set_result)
+			return gi_probe_resource_set_result.error().forward(
+				"Create resource sets for probe update pipeline failed"
+			);
+		auto gi_probe_resource_sets = std::move(*gi_probe_resource_set_result);
+
 		auto direct_lighting_resource_set_result = direct_lighting.create_resource_sets(context, count);
 		if (!direct_lighting_resource_set_result)
 			return direct_lighting_resource_set_result.error().forward(
@@ -88,6 +543,41 @@ namespace resource
 			);
 		auto direct_lighting_resource_sets = std::move(*direct_lighting_resource_set_result);
 
+		auto restir_resource_set_result = restir.create_resource_sets(context, count);
+		if (!restir_resource_set_result)
+			return restir_resource_set_result.error().forward(
+				"Create resource sets for ReSTIR pipeline failed"
+			);
+		auto restir_resource_sets = std::move(*restir_resource_set_result);
+
+		auto reflection_resource_set_result = reflection.create_resource_sets(context, count);
+		if (!reflection_resource_set_result)
+			return reflection_resource_set_result.error().forward(
+				"Create resource sets for reflection pipeline failed"
+			);
+		auto reflection_resource_sets = std::move(*reflection_resource_set_result);
+
+		auto reflection_denoise_resource_set_result = denoise.create_resource_sets(context, count);
+		if (!reflection_denoise_resource_set_result)
+			return reflection_denoise_resource_set_result.error().forward(
+				"Create reflection resource sets for denoise pipeline failed"
+			);
+		auto reflection_denoise_resource_sets = std::move(*reflection_denoise_resource_set_result);
+
+		auto transparent_resource_set_result = transparent.create_resource_sets(context, count);
+		if (!transparent_resource_set_result)
+			return transparent_resource_set_result.error().forward(
+				"Create resource sets for transparent pipeline failed"
+			);
+		auto transparent_resource_sets = std::move(*transparent_resource_set_result);
+
+		auto path_trace_resource_set_result = path_trace.create_resource_sets(context, count);
+		if (!path_trace_resource_set_result)
+			return path_trace_resource_set_result.error().forward(
+				"Create resource sets for path tracing pipeline failed"
+			);
+		auto path_trace_resource_sets = std::move(*path_trace_resource_set_result);
+
 		auto auto_exposure_resource_set_result = auto_exposure.create_resource_sets(context, count);
 		if (!auto_exposure_resource_set_result)
 			return auto_exposure_resource_set_result.error().forward(
@@ -95,6 +585,25 @@ namespace resource
 			);
 		auto auto_exposure_resource_sets = std::move(*auto_exposure_resource_set_result);
 
+		auto taa_resource_set_result = taa.create_resource_sets(context, count);
+		if (!taa_resource_set_result)
+			return taa_resource_set_result.error().forward("Create resource sets for TAA pipeline failed");
+		auto taa_resource_sets = std::move(*taa_resource_set_result);
+
+		auto spatial_upscale_resource_set_result = spatial_upscale.create_resource_sets(context, count);
+		if (!spatial_upscale_resource_set_result)
+			return spatial_upscale_resource_set_result.error().forward(
+				"Create resource sets for spatial upscale pipeline failed"
+			);
+		auto spatial_upscale_resource_sets = std::move(*spatial_upscale_resource_set_result);
+
+		auto bloom_resource_set_result = bloom.create_resource_sets(context, count);
+		if (!bloom_resource_set_result)
+			return bloom_resource_set_result.error().forward(
+				"Create resource sets for bloom pipeline failed"
+			);
+		auto bloom_resource_sets = std::move(*bloom_resource_set_result);
+
 		auto composite_resource_set_result = composite.create_resource_sets(context, count);
 		if (!composite_resource_set_result)
 			return composite_resource_set_result.error().forward(
@@ -102,68 +611,370 @@ namespace resource
 			);
 		auto composite_resource_sets = std::move(*composite_resource_set_result);
 
-		return std::views::zip_transform(
-				   CTOR_LAMBDA(ResourceSet),
-				   indirect_resource_sets | std::views::as_rvalue,
-				   deferred_resource_sets | std::views::as_rvalue,
-				   direct_lighting_resource_sets | std::views::as_rvalue,
-				   auto_exposure_resource_sets | std::views::as_rvalue,
-				   composite_resource_sets | std::views::as_rvalue
-			   )
+		auto overlay_resource_set_result = overlay.create_resource_sets(context, count);
+		if (!overlay_resource_set_result)
+			return overlay_resource_set_result.error().forward(
+				"Create resource sets for overlay pipeline failed"
+			);
+		auto overlay_resource_sets = std::move(*overlay_resource_set_result);
+
+		auto resource_sets =
+			std::views::zip_transform(
+				CTOR_LAMBDA(ResourceSet),
+				transform_resource_sets | std::views::as_rvalue,
+				deform_resource_sets | std::views::as_rvalue,
+				shading_rate_resource_sets | std::views::as_rvalue,
+				indirect_resource_sets | std::views::as_rvalue,
+				blended_indirect_resource_sets | std::views::as_rvalue,
+				deferred_resource_sets | std::views::as_rvalue,
+				impostor_resource_sets | std::views::as_rvalue,
+				object_pick_resource_sets | std::views::as_rvalue,
+				hiz_resource_sets | std::views::as_rvalue,
+				light_cluster_resource_sets | std::views::as_rvalue,
+				shadow_resource_sets | std::views::as_rvalue,
+				cascade_shadow_resource_sets | std::views::as_rvalue,
+				contact_shadow_resource_sets | std::views::as_rvalue,
+				ambient_occlusion_resource_sets | std::views::as_rvalue,
+				gi_probe_resource_sets | std::views::as_rvalue,
+				direct_lighting_resource_sets | std::views::as_rvalue,
+				restir_resource_sets | std::views::as_rvalue,
+				reflection_resource_sets | std::views::as_rvalue,
+				reflection_denoise_resource_sets | std::views::as_rvalue,
+				transparent_resource_sets | std::views::as_rvalue,
+				path_trace_resource_sets | std::views::as_rvalue,
+				auto_exposure_resource_sets | std::views::as_rvalue,
+				taa_resource_sets | std::views::as_rvalue,
+				spatial_upscale_resource_sets | std::views::as_rvalue,
+				bloom_resource_sets | std::views::as_rvalue,
+				composite_resource_sets | std::views::as_rvalue,
+				overlay_resource_sets | std::views::as_rvalue
+			)
 			| std::ranges::to<std::vector>();
+
+		if (meshlet_deferred.has_value())
+		{
+			auto meshlet_deferred_resource_set_result =
+				meshlet_deferred->create_resource_sets(context, count);
+			if (!meshlet_deferred_resource_set_result)
+				return meshlet_deferred_resource_set_result.error().forward(
+					"Create resource sets for meshlet deferred pipeline failed"
+				);
+			for (
+				auto&& [resource_set, meshlet_deferred_resource_set] :
+				std::views::zip(resource_sets, *meshlet_deferred_resource_set_result)
+			)
+				resource_set.meshlet_deferred.emplace(std::move(meshlet_deferred_resource_set));
+		}
+
+		if (visibility.has_value())
+		{
+			auto visibility_resource_set_result = visibility->create_resource_sets(context, count);
+			if (!visibility_resource_set_result)
+				return visibility_resource_set_result.error().forward(
+					"Create resource sets for visibility pipeline failed"
+				);
+			for (
+				auto&& [resource_set, visibility_resource_set] :
+				std::views::zip(resource_sets, *visibility_resource_set_result)
+			)
+				resource_set.visibility.emplace(std::move(visibility_resource_set));
+		}
+
+		return resource_sets;
 	}
 
 	void ResourceSet::update(
 		const vulkan::Context& context,
 		const render::Model& model,
+		const render::Tlas& tlas,
 		const resource::RenderResource& curr_resource,
 		const resource::RenderResource& prev_resource,
-		const resource::AuxResource& aux_resource
+		const resource::AuxResource& aux_resource,
+		const render::GiProbeVolume& gi_probe_volume,
+		const render::EnvironmentLighting& environment_lighting,
+		render::AtmospherePipeline::LutView atmosphere,
+		std::optional<render::PathTraceAttachment::View> path_trace_accumulation,
+		std::optional<render::CascadeShadowAttachment::View> shadow_map
 	) noexcept
 	{
 		DEBUG_ASSERT(curr_resource.attachments.has_value());
 		DEBUG_ASSERT(prev_resource.attachments.has_value());
 
+		transform.update(context, model.scene_graph, curr_resource.transform);
+
+		// Descriptors can't reference the deform resource before its buffers are allocated
+		if (model.deform_list.has_value() && curr_resource.deform->joint_matrices.count() > 0)
+			deform.update(context, model.mesh_list, *model.deform_list, curr_resource.deform);
+
+		shading_rate.update(
+			context,
+			prev_resource.attachments->hdr,
+			prev_resource.attachments->deferred,
+			curr_resource.attachments->hdr,
+			curr_resource.attachments->shading_rate
+		);
+
 		indirect.update(
 			context,
 			model,
 			curr_resource.param->camera,
-			curr_resource.drawcall,
-			curr_resource.indirect
+			curr_resource.transform,
+			curr_resource.indirect,
+			curr_resource.geometry_feedback,
+			prev_resource.attachments->hiz,
+			curr_resource.attachments->hiz
 		);
 
+		blended_indirect.update(
+			context,
+			model,
+			curr_resource.param->camera,
+			curr_resource.transform,
+			curr_resource.blended_indirect,
+			curr_resource.geometry_feedback,
+			prev_resource.attachments->hiz,
+			curr_resource.attachments->hiz,
+			render::SceneGraph::Bucket::Blended
+		);
+
+		// Previous world transforms are missing until the previous frame resource has rendered once
+		const auto prev_transform_valid = prev_resource.transform->world_transform.count()
+			== curr_resource.transform->world_transform.count();
+
 		deferred.update(
 			context,
 			model,
-			curr_resource.drawcall,
+			curr_resource.transform,
+			prev_transform_valid ? prev_resource.transform : curr_resource.transform,
 			curr_resource.indirect,
 			curr_resource.attachments->deferred,
 			curr_resource.attachments->hdr,
 			curr_resource.param->camera,
+			curr_resource.param->primary_light,
+			curr_resource.feedback,
+			curr_resource.attachments->shading_rate
+		);
+
+		if (meshlet_deferred.has_value())
+			meshlet_deferred->update(
+				context,
+				model,
+				curr_resource.transform,
+				prev_transform_valid ? prev_resource.transform : curr_resource.transform,
+				curr_resource.indirect,
+				curr_resource.attachments->deferred,
+				curr_resource.attachments->hdr,
+				curr_resource.attachments->hiz,
+				curr_resource.param->camera,
+				curr_resource.feedback
+			);
+
+		if (visibility.has_value())
+		{
+			DEBUG_ASSERT(curr_resource.attachments->visibility.has_value());
+			visibility->update(
+				context,
+				model,
+				curr_resource.transform,
+				prev_transform_valid ? prev_resource.transform : curr_resource.transform,
+				curr_resource.indirect,
+				curr_resource.attachments->deferred,
+				curr_resource.attachments->hdr,
+				*curr_resource.attachments->visibility,
+				curr_resource.param->camera,
+				curr_resource.feedback
+			);
+		}
+
+		impostor.update(
+			context,
+			model,
+			curr_resource.transform,
+			prev_transform_valid ? prev_resource.transform : curr_resource.transform,
+			curr_resource.indirect,
+			curr_resource.attachments->deferred,
+			curr_resource.attachments->hdr,
+			curr_resource.param->camera
+		);
+
+		object_pick.update(
+			context,
+			curr_resource.attachments->deferred,
+			curr_resource.indirect,
+			curr_resource.object_pick
+		);
+
+		hiz.update(context, curr_resource.attachments->deferred->depth, curr_resource.attachments->hiz);
+
+		light_cluster.update(
+			context,
+			model.light_list,
+			curr_resource.transform->world_transform,
+			curr_resource.attachments->deferred,
+			curr_resource.attachments->light_cluster,
+			curr_resource.param->camera
+		);
+
+		shadow.update(
+			context,
+			model,
+			tlas,
+			curr_resource.attachments->deferred,
+			curr_resource.attachments->shadow_mask,
+			curr_resource.param->camera,
 			curr_resource.param->primary_light
 		);
 
+		// Cascades only exist with shadow maps enabled, the set keeps its previous bindings otherwise
+		if (shadow_map.has_value())
+			cascade_shadow.update(
+				context,
+				model,
+				curr_resource.transform,
+				curr_resource.indirect,
+				*shadow_map,
+				curr_resource.attachments->deferred,
+				curr_resource.attachments->shadow_mask,
+				curr_resource.param->camera,
+				curr_resource.param->primary_light
+			);
+
+		contact_shadow.update(
+			context,
+			curr_resource.attachments->deferred,
+			curr_resource.attachments->shadow_mask,
+			curr_resource.param->camera,
+			curr_resource.param->primary_light
+		);
+
+		ambient_occlusion.update(
+			context,
+			tlas,
+			curr_resource.attachments->deferred,
+			prev_resource.attachments->ambient_occlusion,
+			curr_resource.attachments->ambient_occlusion,
+			curr_resource.param->camera,
+			aux_resource.blue_noise_view
+		);
+
+		gi_probe.update(context, model, tlas, gi_probe_volume, curr_resource.param->primary_light);
+
 		direct_lighting.update(
 			context,
 			curr_resource.attachments->deferred,
 			curr_resource.attachments->hdr,
+			curr_resource.attachments->shadow_mask,
+			curr_resource.attachments->ambient_occlusion,
 			curr_resource.param->camera,
-			curr_resource.param->primary_light
+			curr_resource.param->primary_light,
+			model.light_list,
+			curr_resource.transform->world_transform,
+			curr_resource.attachments->light_cluster,
+			gi_probe_volume,
+			curr_resource.attachments->shading_rate,
+			environment_lighting,
+			atmosphere
+		);
+
+		// ReSTIR attachments only exist while enabled, the set keeps its previous bindings otherwise
+		if (curr_resource.attachments->restir.has_value() && prev_resource.attachments->restir.has_value())
+			restir.update(
+				context,
+				model,
+				tlas,
+				curr_resource.attachments->deferred,
+				*curr_resource.attachments->restir,
+				*prev_resource.attachments->restir,
+				curr_resource.attachments->hdr,
+				curr_resource.param->camera,
+				curr_resource.transform->world_transform
+			);
+
+		reflection.update(
+			context,
+			model,
+			tlas,
+			curr_resource.attachments->deferred,
+			curr_resource.attachments->hiz,
+			prev_resource.attachments->taa,
+			curr_resource.attachments->reflection,
+			curr_resource.attachments->reflection_denoise,
+			curr_resource.attachments->hdr,
+			curr_resource.param->camera,
+			curr_resource.param->primary_light,
+			environment_lighting
+		);
+
+		reflection_denoise.update(
+			context,
+			curr_resource.attachments->deferred,
+			curr_resource.attachments->reflection->signal,
+			prev_resource.attachments->reflection_denoise,
+			curr_resource.attachments->reflection_denoise,
+			curr_resource.param->camera
+		);
+
+		transparent.update(
+			context,
+			model,
+			curr_resource.transform,
+			curr_resource.blended_indirect,
+			curr_resource.attachments->deferred,
+			curr_resource.attachments->transparent,
+			curr_resource.param->camera,
+			curr_resource.param->primary_light,
+			curr_resource.feedback
 		);
 
+		// Accumulation only exists while path tracing, the set keeps its previous bindings otherwise
+		if (path_trace_accumulation.has_value())
+			path_trace.update(
+				context,
+				model,
+				tlas,
+				*path_trace_accumulation,
+				curr_resource.attachments->hdr,
+				curr_resource.param->camera,
+				curr_resource.param->primary_light,
+				curr_resource.transform->world_transform
+			);
+
 		auto_exposure.update(
 			context,
 			curr_resource.auto_exposure,
 			prev_resource.auto_exposure,
 			curr_resource.param->exposure_param,
 			curr_resource.attachments->hdr,
+			curr_resource.attachments->luminance_pyramid,
 			aux_resource.exposure_mask_view
 		);
 
+		taa.update(
+			context,
+			curr_resource.attachments->hdr,
+			curr_resource.attachments->deferred,
+			prev_resource.attachments->taa,
+			curr_resource.attachments->taa,
+			curr_resource.param->camera
+		);
+
+		// Writes the TAA attachment in place of the TAA pass, with the exposure applied by the composite
+		spatial_upscale.update(
+			context,
+			prev_resource.auto_exposure->exposure_result_buffer,
+			curr_resource.attachments->hdr,
+			curr_resource.attachments->taa
+		);
+
+		bloom.update(context, curr_resource.attachments->taa, curr_resource.attachments->bloom);
+
+		// Auto-exposure runs asynchronously after each frame, the composite uses the result of previous frame
 		composite.update(
 			context,
-			curr_resource.auto_exposure->exposure_result_buffer,
-			curr_resource.attachments->hdr
+			prev_resource.auto_exposure->exposure_result_buffer,
+			curr_resource.attachments->taa,
+			curr_resource.attachments->transparent,
+			curr_resource.attachments->bloom
 		);
 	}
 }
@@ -1,17 +1,36 @@
 #include "resource/render-resource.hpp"
-#include "common/util/array.hpp"
 #include "common/util/error.hpp"
-#include "render/interface/primitive-drawcall.hpp"
+#include "render/resource/ambient-occlusion.hpp"
 #include "render/resource/auto-exposure.hpp"
+#include "render/resource/bloom.hpp"
 #include "render/resource/deferred.hpp"
+#include "render/resource/deform.hpp"
+#include "render/resource/denoise.hpp"
+#include "render/resource/feedback.hpp"
 #include "render/resource/hdr.hpp"
+#include "render/resource/hiz.hpp"
+#include "render/resource/luminance-pyramid.hpp"
 #include "render/resource/host.hpp"
+#include "render/resource/light-cluster.hpp"
+#include "render/resource/object-pick.hpp"
+#include "render/resource/reflection.hpp"
+#include "render/resource/restir.hpp"
+#include "render/resource/shadow.hpp"
+#include "render/resource/taa.hpp"
+#include "render/resource/transform.hpp"
+#include "render/resource/transparent.hpp"
+#include "render/resource/visibility.hpp"
 #include "render/util/per-render-state.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
 #include "vulkan/interface/context.hpp"
 
 #include <expected>
+#include <glm/common.hpp>
+#include <glm/ext/vector_float2.hpp>
 #include <glm/ext/vector_uint2_sized.hpp>
-#include <span>
+#include <libassert/assert.hpp>
+#include <optional>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -20,6 +39,9 @@ namespace resource
 {
 	std::expected<RenderResource, Error> RenderResource::create(const vulkan::Context& context) noexcept
 	{
+		auto upload_ring_result = vulkan::UploadRing::create(context, UPLOAD_RING_CAPACITY);
+		if (!upload_ring_result) return upload_ring_result.error().forward("Create upload ring failed");
+
 		auto param_result = render::HostParamResource::create(context);
 		if (!param_result) return param_result.error().forward("Create host param resource failed");
 
@@ -27,59 +49,453 @@ namespace resource
 		if (!auto_exposure_result)
 			return auto_exposure_result.error().forward("Create auto exposure resource failed");
 
+		auto object_pick_result = render::ObjectPickResource::create(context);
+		if (!object_pick_result)
+			return object_pick_result.error().forward("Create object pick resource failed");
+
 		return RenderResource{
+			.upload_ring = std::move(*upload_ring_result),
 			.param = std::move(*param_result),
-			.drawcall = {},
+			.transform = render::TransformResource(context),
+			.deform = render::DeformResource(context),
 			.indirect = {},
-			.auto_exposure = std::move(*auto_exposure_result)
+			.blended_indirect = {},
+			.auto_exposure = std::move(*auto_exposure_result),
+			.feedback = {},
+			.geometry_feedback = {},
+			.object_pick = std::move(*object_pick_result)
 		};
 	}
 
 	std::expected<void, Error> RenderResource::update(
 		const vulkan::Context& context,
+		vulkan::DeletionQueue& deletion_queue,
 		const RenderData& data
 	) noexcept
 	{
-		if (const auto result = param.update(data.camera, data.exposure_param, data.primary_light); !result)
+		upload_ring.reset();
+
+		if (const auto result =
+				param.update(context, upload_ring, data.camera, data.exposure_param, data.primary_light);
+			!result)
 			return result.error().forward("Update host param resource failed");
 
-		if (const auto result = drawcall.update(context, data.drawcalls, data.transforms); !result)
-			return result.error().forward("Update host drawcall resource failed");
+		const auto transform_result = transform.update(
+			context,
+			upload_ring,
+			deletion_queue,
+			data.node_count,
+			data.transform_updates,
+			data.root_transform
+		);
+		if (!transform_result) return transform_result.error().forward("Update transform resource failed");
 
-		if (const auto result =
-				indirect
-					.resize(context, data.drawcalls.map(&std::span<const render::PrimitiveDrawcall>::size));
+		if (data.deform_parameters.has_value())
+		{
+			const auto deform_result = deform.update(context, upload_ring, *data.deform_parameters);
+			if (!deform_result) return deform_result.error().forward("Update deform resource failed");
+		}
+
+		if (const auto result = indirect.resize(
+				context,
+				data.drawcall_counts,
+				data.primitive_count,
+				static_cast<uint32_t>(data.cull_views.size())
+			);
 			!result)
 			return result.error().forward("Update indirect resource failed");
 
+		if (const auto result = indirect.upload_views(context, upload_ring, data.cull_views); !result)
+			return result.error().forward("Upload culling views failed");
+
+		if (const auto result =
+				blended_indirect.resize(context, data.blended_drawcall_counts, data.primitive_count);
+			!result)
+			return result.error().forward("Update blended indirect resource failed");
+
+		if (const auto result = feedback.resize(context, data.material_count); !result)
+			return result.error().forward("Update feedback resource failed");
+
+		if (const auto result = geometry_feedback.resize(context, data.primitive_count); !result)
+			return result.error().forward("Update geometry feedback resource failed");
+
 		return {};
 	}
 
+	namespace
+	{
+		// Attachments rendered at the render extent, allocated together with the same capacity
+		struct RenderAttachments
+		{
+			render::DeferredAttachment deferred;
+			render::HdrAttachment hdr;
+			render::HizAttachment hiz;
+			render::LuminancePyramidAttachment luminance_pyramid;
+			render::ShadowMaskAttachment shadow_mask;
+			render::AmbientOcclusionAttachment ambient_occlusion;
+			render::LightClusterAttachment light_cluster;
+			render::ShadingRateAttachment shading_rate;
+			render::TransparentAttachment transparent;
+			render::ReflectionAttachment reflection;
+			render::DenoiseAttachment reflection_denoise;
+			std::optional<render::VisibilityAttachment> visibility;
+			std::optional<render::RestirAttachment> restir;
+		};
+
+		glm::u32vec2 grown_capacity(const vulkan::Context& context, glm::u32vec2 render_extent) noexcept
+		{
+			const auto max_dimension = context.phy_device.getProperties().limits.maxImageDimension2D;
+			const auto grown = glm::u32vec2(
+				glm::ceil(glm::vec2(render_extent) * RenderResource::ATTACHMENT_GROWTH_FACTOR)
+			);
+
+			return glm::max(glm::min(grown, glm::u32vec2(max_dimension)), render_extent);
+		}
+
+		std::expected<RenderAttachments, Error> create_render_attachments(
+			const vulkan::Context& context,
+			glm::u32vec2 render_extent,
+			bool half_resolution_shadow,
+			render::AmbientOcclusionAttachment::Resolution ambient_occlusion_resolution,
+			vk::Format hdr_format,
+			bool visibility_buffer,
+			bool restir
+		) noexcept
+		{
+			const auto capacity = grown_capacity(context, render_extent);
+
+			auto deferred_result = render::DeferredAttachment::create(context, capacity);
+			if (!deferred_result)
+				return deferred_result.error().forward("Create deferred attachments failed");
+
+			auto hdr_result = render::HdrAttachment::create(context, capacity, 1, hdr_format);
+			if (!hdr_result) return hdr_result.error().forward("Create HDR attachments failed");
+
+			auto hiz_result = render::HizAttachment::create(context, capacity);
+			if (!hiz_result) return hiz_result.error().forward("Create HiZ attachment failed");
+
+			auto luminance_pyramid_result = render::LuminancePyramidAttachment::create(context, capacity);
+			if (!luminance_pyramid_result)
+				return luminance_pyramid_result.error().forward("Create luminance pyramid failed");
+
+			auto shadow_mask_result =
+				render::ShadowMaskAttachment::create(context, capacity, half_resolution_shadow);
+			if (!shadow_mask_result) return shadow_mask_result.error().forward("Create shadow mask failed");
+
+			auto ambient_occlusion_result =
+				render::AmbientOcclusionAttachment::create(context, capacity, ambient_occlusion_resolution);
+			if (!ambient_occlusion_result)
+				return ambient_occlusion_result.error().forward("Create ambient occlusion failed");
+
+			auto light_cluster_result = render::LightClusterAttachment::create(context, capacity);
+			if (!light_cluster_result)
+				return light_cluster_result.error().forward("Create light cluster failed");
+
+			auto shading_rate_result = render::ShadingRateAttachment::create(context, capacity);
+			if (!shading_rate_result)
+				return shading_rate_result.error().forward("Create shading rate image failed");
+
+			auto transparent_result = render::TransparentAttachment::create(context, capacity);
+			if (!transparent_result)
+				return transparent_result.error().forward("Create transparent attachment failed");
+
+			auto reflection_result = render::ReflectionAttachment::create(context, capacity);
+			if (!reflection_result)
+				return reflection_result.error().forward("Create reflection attachment failed");
+
+			auto reflection_denoise_result = render::DenoiseAttachment::create(
+				context,
+				capacity,
+				render::ReflectionAttachment::DOWNSCALE
+			);
+			if (!reflection_denoise_result)
+				return reflection_denoise_result.error().forward(
+					"Create reflection denoise attachment failed"
+				);
+
+			std::optional<render::VisibilityAttachment> visibility;
+			if (visibility_buffer)
+			{
+				auto visibility_result = render::VisibilityAttachment::create(context, capacity);
+				if (!visibility_result)
+					return visibility_result.error().forward("Create visibility attachment failed");
+				visibility = std::move(*visibility_result);
+			}
+
+			std::optional<render::RestirAttachment> restir_attachment;
+			if (restir)
+			{
+				auto restir_result = render::RestirAttachment::create(context, capacity);
+				if (!restir_result) return restir_result.error().forward("Create ReSTIR attachment failed");
+				restir_attachment = std::move(*restir_result);
+			}
+
+			return RenderAttachments{
+				.deferred = std::move(*deferred_result),
+				.hdr = std::move(*hdr_result),
+				.hiz = std::move(*hiz_result),
+				.luminance_pyramid = std::move(*luminance_pyramid_result),
+				.shadow_mask = std::move(*shadow_mask_result),
+				.ambient_occlusion = std::move(*ambient_occlusion_result),
+				.light_cluster = std::move(*light_cluster_result),
+				.shading_rate = std::move(*shading_rate_result),
+				.transparent = std::move(*transparent_result),
+				.reflection = std::move(*reflection_result),
+				.reflection_denoise = std::move(*reflection_denoise_result),
+				.visibility = std::move(visibility),
+				.restir = std::move(restir_attachment),
+			};
+		}
+
+		// Replace the render attachments with newly created ones, retiring the old ones
+		std::expected<void, Error> recreate_render_attachments(
+			const vulkan::Context& context,
+			vulkan::DeletionQueue& deletion_queue,
+			RenderResource::Attachments& attachments,
+			glm::u32vec2 render_extent,
+			bool half_resolution_shadow,
+			render::AmbientOcclusionAttachment::Resolution ambient_occlusion_resolution,
+			vk::Format hdr_format,
+			bool visibility_buffer,
+			bool restir
+		) noexcept
+		{
+			auto render_result = create_render_attachments(
+				context,
+				render_extent,
+				half_resolution_shadow,
+				ambient_occlusion_resolution,
+				hdr_format,
+				visibility_buffer,
+				restir
+			);
+			if (!render_result) return render_result.error().forward("Create render attachments failed");
+
+			deletion_queue.retire(std::exchange(attachments.deferred, std::move(render_result->deferred)));
+			deletion_queue.retire(std::exchange(attachments.hdr, std::move(render_result->hdr)));
+			deletion_queue.retire(std::exchange(attachments.hiz, std::move(render_result->hiz)));
+			deletion_queue.retire(
+				std::exchange(attachments.luminance_pyramid, std::move(render_result->luminance_pyramid))
+			);
+			deletion_queue.retire(
+				std::exchange(attachments.shadow_mask, std::move(render_result->shadow_mask))
+			);
+			deletion_queue.retire(
+				std::exchange(attachments.ambient_occlusion, std::move(render_result->ambient_occlusion))
+			);
+			deletion_queue.retire(
+				std::exchange(attachments.light_cluster, std::move(render_result->light_cluster))
+			);
+			deletion_queue.retire(
+				std::exchange(attachments.shading_rate, std::move(render_result->shading_rate))
+			);
+			deletion_queue.retire(
+				std::exchange(attachments.transparent, std::move(render_result->transparent))
+			);
+			deletion_queue.retire(
+				std::exchange(attachments.reflection, std::move(render_result->reflection))
+			);
+			deletion_queue.retire(
+				std::exchange(attachments.reflection_denoise, std::move(render_result->reflection_denoise))
+			);
+			deletion_queue.retire(
+				std::exchange(attachments.visibility, std::move(render_result->visibility))
+			);
+			deletion_queue.retire(std::exchange(attachments.restir, std::move(render_result->restir)));
+			attachments.undersized_frames = 0;
+
+			return {};
+		}
+
+		void set_render_extent(RenderResource::Attachments& attachments, glm::u32vec2 render_extent) noexcept
+		{
+			attachments.deferred.set_extent(render_extent);
+			attachments.hdr.set_extent(render_extent);
+			attachments.hiz.set_extent(render_extent);
+			attachments.luminance_pyramid.set_extent(render_extent);
+			attachments.shadow_mask.set_extent(render_extent);
+			attachments.ambient_occlusion.set_extent(render_extent);
+			attachments.light_cluster.set_extent(render_extent);
+			attachments.shading_rate.set_extent(render_extent);
+			attachments.transparent.set_extent(render_extent);
+			attachments.reflection.set_extent(render_extent);
+			attachments.reflection_denoise.set_extent(render_extent);
+			if (attachments.visibility.has_value()) attachments.visibility->set_extent(render_extent);
+			if (attachments.restir.has_value()) attachments.restir->set_extent(render_extent);
+		}
+	}
+
 	std::expected<void, Error> RenderResource::resize_attachments(
 		const vulkan::Context& context,
-		glm::u32vec2 extent
+		vulkan::DeletionQueue& deletion_queue,
+		glm::u32vec2 extent,
+		glm::u32vec2 render_extent,
+		bool half_resolution_shadow,
+		render::AmbientOcclusionAttachment::Resolution ambient_occlusion_resolution,
+		vk::Format hdr_format,
+		bool visibility_buffer,
+		bool restir
 	) noexcept
 	{
-		auto deferred_result = render::DeferredAttachment::create(context, extent);
-		if (!deferred_result) return deferred_result.error().forward("Create deferred attachments failed");
+		auto taa_result = render::TaaAttachment::create(context, extent);
+		if (!taa_result) return taa_result.error().forward("Create TAA attachment failed");
+
+		auto bloom_result = render::BloomAttachment::create(context, extent);
+		if (!bloom_result) return bloom_result.error().forward("Create bloom attachment failed");
 
-		auto hdr_result = render::HdrAttachment::create(context, extent);
-		if (!hdr_result) return hdr_result.error().forward("Create HDR attachments failed");
+		if (attachments.has_value())
+		{
+			deletion_queue.retire(std::exchange(attachments->taa, std::move(*taa_result)));
+			deletion_queue.retire(std::exchange(attachments->bloom, std::move(*bloom_result)));
+			return resize_render_attachments(
+				context,
+				deletion_queue,
+				render_extent,
+				half_resolution_shadow,
+				ambient_occlusion_resolution,
+				hdr_format,
+				visibility_buffer,
+				restir
+			);
+		}
+
+		auto render_result = create_render_attachments(
+			context,
+			render_extent,
+			half_resolution_shadow,
+			ambient_occlusion_resolution,
+			hdr_format,
+			visibility_buffer,
+			restir
+		);
+		if (!render_result) return render_result.error().forward("Create render attachments failed");
 
 		attachments = Attachments{
-			.deferred = std::move(*deferred_result),
-			.hdr = std::move(*hdr_result),
+			.deferred = std::move(render_result->deferred),
+			.hdr = std::move(render_result->hdr),
+			.hiz = std::move(render_result->hiz),
+			.luminance_pyramid = std::move(render_result->luminance_pyramid),
+			.shadow_mask = std::move(render_result->shadow_mask),
+			.ambient_occlusion = std::move(render_result->ambient_occlusion),
+			.light_cluster = std::move(render_result->light_cluster),
+			.shading_rate = std::move(render_result->shading_rate),
+			.transparent = std::move(render_result->transparent),
+			.reflection = std::move(render_result->reflection),
+			.reflection_denoise = std::move(render_result->reflection_denoise),
+			.taa = std::move(*taa_result),
+			.bloom = std::move(*bloom_result),
+			.visibility = std::move(render_result->visibility),
+			.restir = std::move(render_result->restir),
 		};
+		set_render_extent(*attachments, render_extent);
+
 		return {};
 	}
 
-	void RenderResource::upload(const vk::raii::CommandBuffer& command_buffer) const noexcept
+	std::expected<void, Error> RenderResource::resize_render_attachments(
+		const vulkan::Context& context,
+		vulkan::DeletionQueue& deletion_queue,
+		glm::u32vec2 render_extent,
+		bool half_resolution_shadow,
+		render::AmbientOcclusionAttachment::Resolution ambient_occlusion_resolution,
+		vk::Format hdr_format,
+		bool visibility_buffer,
+		bool restir
+	) noexcept
+	{
+		DEBUG_ASSERT(attachments.has_value());
+
+		const bool fits = attachments->deferred.fits(render_extent)
+			&& attachments->hdr.fits(render_extent)
+			&& attachments->hiz.fits(render_extent)
+			&& attachments->luminance_pyramid.fits(render_extent)
+			&& attachments->shadow_mask.fits(render_extent)
+			&& attachments->ambient_occlusion.fits(render_extent)
+			&& attachments->light_cluster.fits(render_extent)
+			&& attachments->shading_rate.fits(render_extent)
+			&& attachments->transparent.fits(render_extent)
+			&& attachments->reflection.fits(render_extent)
+			&& attachments->reflection_denoise.fits(render_extent)
+			&& attachments->shadow_mask.half_resolution() == half_resolution_shadow
+			&& attachments->ambient_occlusion.resolution() == ambient_occlusion_resolution
+			&& attachments->hdr.format() == hdr_format
+			&& attachments->visibility.has_value() == visibility_buffer
+			&& (!attachments->visibility.has_value() || attachments->visibility->fits(render_extent))
+			&& attachments->restir.has_value() == restir
+			&& (!attachments->restir.has_value() || attachments->restir->fits(render_extent));
+
+		if (!fits)
+		{
+			const auto result = recreate_render_attachments(
+				context,
+				deletion_queue,
+				*attachments,
+				render_extent,
+				half_resolution_shadow,
+				ambient_occlusion_resolution,
+				hdr_format,
+				visibility_buffer,
+				restir
+			);
+			if (!result) return result.error().forward("Grow render attachments failed");
+		}
+
+		set_render_extent(*attachments, render_extent);
+
+		return {};
+	}
+
+	std::expected<bool, Error> RenderResource::trim_attachments(
+		const vulkan::Context& context,
+		vulkan::DeletionQueue& deletion_queue
+	) noexcept
+	{
+		if (!attachments.has_value()) return false;
+
+		const auto render_extent = attachments->hdr->extent;
+		const auto capacity = attachments->hdr.capacity_extent();
+		const auto coverage =
+			(double(render_extent.x) * render_extent.y) / (double(capacity.x) * capacity.y);
+
+		if (coverage >= ATTACHMENT_SHRINK_THRESHOLD)
+		{
+			attachments->undersized_frames = 0;
+			return false;
+		}
+
+		if (++attachments->undersized_frames < ATTACHMENT_SHRINK_FRAMES) return false;
+
+		const auto result = recreate_render_attachments(
+			context,
+			deletion_queue,
+			*attachments,
+			render_extent,
+			attachments->shadow_mask.half_resolution(),
+			attachments->ambient_occlusion.resolution(),
+			attachments->hdr.format(),
+			attachments->visibility.has_value(),
+			attachments->restir.has_value()
+		);
+		if (!result) return result.error().forward("Shrink render attachments failed");
+
+		set_render_extent(*attachments, render_extent);
+
+		return true;
+	}
+
+	void RenderResource::upload(const vk::raii::CommandBuffer& command_buffer) noexcept
 	{
-		const auto host_param_barriers = param.upload(command_buffer);
-		const auto host_drawcall_barriers = drawcall.upload(command_buffer);
+		// Camera is copied from its own staging buffer, which stays writable until submit
+		param.record(command_buffer);
 
-		const auto barriers = util::array_concat(host_param_barriers, host_drawcall_barriers);
+		// TODO: Raytrace pipeline stage flag bits
+		const auto barrier = upload_ring.record(
+			command_buffer,
+			vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eUniformRead
+		);
 
-		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(barriers));
+		if (barrier.has_value())
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(*barrier));
 	}
 }
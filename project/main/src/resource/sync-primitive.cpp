@@ -15,12 +15,21 @@ namespace resource
 		auto fence_result = context.device.createFence({.flags = vk::FenceCreateFlagBits::eSignaled});
 		auto image_available_semaphore = context.device.createSemaphore({});
 
+		const auto semaphore_type_info = vk::SemaphoreTypeCreateInfo{
+			.semaphoreType = vk::SemaphoreType::eTimeline,
+			.initialValue = 0,
+		};
+		auto timeline_semaphore =
+			context.device.createSemaphore(vk::SemaphoreCreateInfo().setPNext(&semaphore_type_info));
+
 		if (!fence_result) return Error::from(fence_result);
 		if (!image_available_semaphore) return Error::from(image_available_semaphore);
+		if (!timeline_semaphore) return Error::from(timeline_semaphore);
 
 		return FrameSyncPrimitive{
 			.draw_fence = std::move(*fence_result),
-			.image_available_semaphore = std::move(*image_available_semaphore)
+			.image_available_semaphore = std::move(*image_available_semaphore),
+			.timeline_semaphore = std::move(*timeline_semaphore)
 		};
 	}
 }
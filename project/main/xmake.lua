@@ -1,5 +1,33 @@
 add_requires("tinyobjloader v2.0.0rc13")
 
+-- Frame resources, parameters, presets and input records, shared with the offline renderers
+target("main.common")
+	set_kind("static")
+
+	add_deps(
+		"lib.common",
+		"lib.image",
+		"lib.scene",
+		"vulkan.util",
+		"vulkan.alloc",
+		"vulkan.context",
+		"model.gltf",
+		"render",
+		{public = true}
+	)
+
+	add_files(
+		"src/resource/*.cpp",
+		"src/logic/param/*.cpp",
+		"src/logic/param.cpp",
+		"src/logic/preset.cpp",
+		"src/logic/model-cache.cpp",
+		"src/logic/input-record.cpp"
+	)
+	add_files("asset/**", {rule = "utils.bin2obj"})
+	add_includedirs("include", {public = true})
+	add_headerfiles("include/**.hpp")
+
 target("main")
 	set_kind("binary")
 
@@ -12,12 +40,18 @@ target("main")
 		"vulkan.context",
 		"model.wavefront",
 		"model.gltf",
-		"render"
+		"render",
+		"main.common"
 	)
 	
-	add_files("src/**.cpp")
-	add_files("asset/**", {rule = "utils.bin2obj"})
-	add_includedirs("include")
-	add_headerfiles("include/**.hpp")
+	add_files(
+		"src/**.cpp"
+			.. "|resource/*.cpp"
+			.. "|logic/param/*.cpp"
+			.. "|logic/param.cpp"
+			.. "|logic/preset.cpp"
+			.. "|logic/model-cache.cpp"
+			.. "|logic/input-record.cpp"
+	)
 
 	add_packages("tinyobjloader", "argparse")
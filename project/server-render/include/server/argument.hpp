@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace server
+{
+	///
+	/// @brief Command line arguments of the render server
+	///
+	struct Argument
+	{
+		std::string model_path;               // Path to the glTF model, shared by all sessions
+		std::vector<std::string> path_files;  // Camera path JSON files, assigned to the sessions in turn
+		std::string output_directory = ".";   // Directory receiving the frame stream of each session
+
+		uint32_t session_count = 4;
+		uint32_t frame_count = 600;  // Frames rendered by each session
+		glm::u32vec2 extent = {1280, 720};
+		float frame_rate = 30.0f;    // Frame budget of each session, `0` renders as fast as scheduled
+		bool packed_vertex = false;  // Upload vertices as `render::VertexFormat::Packed`
+		float lod_error = 0.0f;      // Maximum projected LOD error in pixels, LOD generation disabled if `0`
+
+		///
+		/// @brief Parse the argument
+		///
+		/// @param arguments Input argument
+		/// @return Parsed argument or error
+		///
+		[[nodiscard]]
+		static std::expected<Argument, Error> parse(std::span<const char*> arguments) noexcept;
+	};
+}
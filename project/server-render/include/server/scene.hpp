@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "resource/aux-resource.hpp"
+#include "resource/pipeline.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <filesystem>
+#include <vulkan/vulkan.hpp>
+
+namespace server
+{
+	///
+	/// @brief Resources shared by all sessions of the server, loaded once and never modified while serving
+	/// @details Sessions only bind these resources, so any number of them can record frames against the
+	/// same scene. Per-session state (camera, attachments, history) lives in `Session`.
+	///
+	struct Scene
+	{
+		static constexpr auto TARGET_FORMAT = vk::Format::eR8G8B8A8Unorm;
+
+		render::MaterialLayout material_layout;
+		render::Model model;
+		render::Tlas tlas;
+
+		resource::Pipeline pipeline;
+		resource::AuxResource aux_resource;
+		render::GiProbeVolume gi_probe_volume;  // Never updated, global illumination is not served
+
+		// Black placeholder, environment lighting is not served either
+		render::EnvironmentLighting environment_lighting;
+
+		///
+		/// @brief Load a glTF model and create the shared resources to render it
+		///
+		/// @param context Vulkan context
+		/// @param model_path Path to the glTF model
+		/// @param vertex_format Vertex format of the uploaded geometry
+		/// @param generate_lod Whether to generate LODs of the geometry
+		/// @return Created scene or error
+		///
+		[[nodiscard]]
+		static std::expected<Scene, Error> create(
+			const vulkan::Context& context,
+			const std::filesystem::path& model_path,
+			render::VertexFormat vertex_format,
+			bool generate_lod
+		) noexcept;
+	};
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "bench/camera-path.hpp"
+#include "common/util/error.hpp"
+#include "logic/param/auto-exposure.hpp"
+#include "logic/param/primary-light.hpp"
+#include "render/resource/indirect.hpp"
+#include "resource/pipeline.hpp"
+#include "resource/render-resource.hpp"
+#include "resource/sync-primitive.hpp"
+#include "server/scene.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/container/device/readback-ring.hpp"
+#include "vulkan/container/host/cycle.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace server
+{
+	///
+	/// @brief Offscreen render session of the server, running the same passes as the main render page
+	/// @details Each session owns its camera, frame resources and attachments, and only binds the shared
+	/// `Scene`. Frames are never waited for: `ready()` polls whether the GPU has released the frame
+	/// resources of the next frame, so a scheduler can interleave many sessions on one queue.
+	///
+	/// The composited frame is read back through a `vulkan::ReadbackRing` and appended to the output stream
+	/// as tightly packed RGBA8 rows, `FRAME_RESOURCE_COUNT` frames after it was submitted. The stream is raw
+	/// video ready for an encoder, e.g. a FIFO read by `ffmpeg -f rawvideo -pix_fmt rgba`.
+	///
+	class Session
+	{
+	  public:
+
+		static constexpr uint32_t FRAME_RESOURCE_COUNT = 2;
+		static constexpr size_t TEXEL_SIZE = 4;  // Size of a texel of `Scene::TARGET_FORMAT`
+
+		///
+		/// @brief Options of a session
+		///
+		struct Option
+		{
+			glm::u32vec2 extent;
+			uint32_t frame_count;             // Frames to render before the session finishes
+			double phase;                     // Offset along the camera path, in `[0, 1)`
+			std::chrono::nanoseconds budget;  // Minimal interval between two frames, `0` for unlimited
+			float lod_pixel_error;            // See `render::IndirectPipeline::lod_threshold_from_pixels`
+		};
+
+		///
+		/// @brief Statistics of a session
+		///
+		struct Statistics
+		{
+			uint32_t submitted_frames = 0;
+			uint32_t written_frames = 0;  // Frames read back and appended to the output stream
+			uint32_t late_frames = 0;     // Frames submitted more than one budget after they were due
+		};
+
+		///
+		/// @brief Create a session
+		///
+		/// @param context Vulkan context
+		/// @param scene Shared scene, must outlive the session
+		/// @param camera_path Camera path of the session
+		/// @param option Options of the session
+		/// @param output_path Path of the output stream, truncated if it exists
+		/// @return Created session or error
+		///
+		[[nodiscard]]
+		static std::expected<Session, Error> create(
+			const vulkan::Context& context,
+			const Scene& scene,
+			bench::CameraPath camera_path,
+			const Option& option,
+			const std::filesystem::path& output_path
+		) noexcept;
+
+		///
+		/// @brief Check whether the session can render its next frame without blocking
+		///
+		/// @param context Vulkan context
+		/// @param now Current time
+		/// @return `true` if the next frame is due and its frame resources are released by the GPU, or error
+		///
+		[[nodiscard]]
+		std::expected<bool, Error> ready(
+			const vulkan::Context& context,
+			std::chrono::steady_clock::time_point now
+		) const noexcept;
+
+		///
+		/// @brief Record and submit the next frame, without waiting for its completion
+		/// @note Only call when `ready()` returns `true`
+		///
+		/// @param context Vulkan context
+		/// @param now Current time
+		/// @return Void or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> render_frame(
+			const vulkan::Context& context,
+			std::chrono::steady_clock::time_point now
+		) noexcept;
+
+		///
+		/// @brief Wait for the submitted frames and write them to the output stream
+		/// @warning Waits for the whole device, call after the last frame of all sessions is submitted
+		///
+		/// @param context Vulkan context
+		/// @return Void or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> finish(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Check whether all frames of the session are submitted
+		///
+		[[nodiscard]]
+		bool done() const noexcept { return submitted_frames >= option.frame_count; }
+
+		///
+		/// @brief Time at which the next frame is due
+		///
+		[[nodiscard]]
+		std::chrono::steady_clock::time_point next_due() const noexcept { return due_time; }
+
+		///
+		/// @brief Get the statistics of the session
+		///
+		[[nodiscard]]
+		Statistics get_statistics() const noexcept;
+
+	  private:
+
+		struct FrameResource
+		{
+			vk::raii::CommandBuffer command_buffer;
+			resource::RenderResource render_resource;
+			resource::ResourceSet resource_set;
+			resource::FrameSyncPrimitive sync_primitive;
+			bool submitted = false;  // Whether `sync_primitive.draw_fence` guards a submitted frame
+
+			explicit FrameResource(
+				vk::raii::CommandBuffer command_buffer,
+				resource::RenderResource render_resource,
+				resource::ResourceSet resource_set,
+				resource::FrameSyncPrimitive sync_primitive
+			) :
+				command_buffer(std::move(command_buffer)),
+				render_resource(std::move(render_resource)),
+				resource_set(std::move(resource_set)),
+				sync_primitive(std::move(sync_primitive))
+			{}
+
+			FrameResource(const FrameResource&) = delete;
+			FrameResource(FrameResource&&) = default;
+			FrameResource& operator=(const FrameResource&) = delete;
+			FrameResource& operator=(FrameResource&&) = default;
+		};
+
+		const Scene* scene;
+		Option option;
+		float lod_threshold;  // See `render::IndirectPipeline::compute`
+
+		vk::raii::CommandPool command_pool;
+		vulkan::Cycle<FrameResource> frame_resources;
+		vulkan::DeletionQueue deletion_queue = vulkan::DeletionQueue(FRAME_RESOURCE_COUNT);
+		vulkan::ReadbackRing readback_ring;
+		vulkan::Attachment target;
+
+		bench::CameraPath camera_path;
+		logic::PrimaryLight primary_light;
+		logic::Exposure exposure;
+
+		struct Output
+		{
+			std::ofstream stream;
+			uint32_t written_frames = 0;
+		};
+
+		// Heap allocated, referenced by the pending readback callbacks while the session is moved
+		std::unique_ptr<Output> output;
+
+		std::chrono::steady_clock::time_point due_time = std::chrono::steady_clock::time_point::min();
+		std::optional<std::chrono::steady_clock::time_point> last_frame_time = std::nullopt;
+		bool history_valid = false;  // Whether HiZ and TAA output of previous frame hold valid content
+		uint32_t submitted_frames = 0;
+		uint32_t late_frames = 0;
+
+		explicit Session(
+			const Scene& scene,
+			const Option& option,
+			float lod_threshold,
+			vk::raii::CommandPool command_pool,
+			vulkan::Cycle<FrameResource> frame_resources,
+			vulkan::ReadbackRing readback_ring,
+			vulkan::Attachment target,
+			bench::CameraPath camera_path,
+			std::unique_ptr<Output> output
+		) :
+			scene(&scene),
+			option(option),
+			lod_threshold(lod_threshold),
+			command_pool(std::move(command_pool)),
+			frame_resources(std::move(frame_resources)),
+			readback_ring(std::move(readback_ring)),
+			target(std::move(target)),
+			camera_path(std::move(camera_path)),
+			output(std::move(output))
+		{}
+
+		void record(FrameResource& frame, const FrameResource& prev_frame, bool history_valid) const noexcept;
+
+		void record_phase(FrameResource& frame, render::DrawPhase phase, bool history_valid) const noexcept;
+
+		void record_composite(FrameResource& frame) const noexcept;
+
+	  public:
+
+		Session(const Session&) = delete;
+		Session(Session&&) = default;
+		Session& operator=(const Session&) = delete;
+		Session& operator=(Session&&) = default;
+	};
+}
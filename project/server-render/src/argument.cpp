@@ -0,0 +1,77 @@
+#include "server/argument.hpp"
+#include "common/util/error.hpp"
+
+#include <argparse/argparse.hpp>
+#include <cstdint>
+#include <exception>
+#include <expected>
+#include <format>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace server
+{
+	std::expected<Argument, Error> Argument::parse(std::span<const char*> arguments) noexcept
+	{
+		Argument argument;
+
+		auto session_count = static_cast<int>(argument.session_count);
+		auto frame_count = static_cast<int>(argument.frame_count);
+		auto width = static_cast<int>(argument.extent.x);
+		auto height = static_cast<int>(argument.extent.y);
+
+		argparse::ArgumentParser parser("server.render");
+		parser.add_argument("model")
+			.help("Path to the glTF model to render")
+			.required()
+			.store_into(argument.model_path);
+		parser.add_argument("--sessions").help("Number of concurrent sessions").store_into(session_count);
+		parser.add_argument("--frames")
+			.help("Number of frames rendered by each session")
+			.store_into(frame_count);
+		parser.add_argument("--width").help("Width of each session").store_into(width);
+		parser.add_argument("--height").help("Height of each session").store_into(height);
+		parser.add_argument("--fps")
+			.help("Frame rate budget of each session, 0 for unlimited")
+			.store_into(argument.frame_rate);
+		parser.add_argument("--path")
+			.help("Camera path JSON file, repeat to give sessions different paths, orbits if omitted")
+			.append();
+		parser.add_argument("--output-dir")
+			.help("Directory receiving the raw RGBA frame stream of each session")
+			.store_into(argument.output_directory);
+		parser.add_argument("--packed-vertex")
+			.help("Use quantized vertex format")
+			.store_into(argument.packed_vertex);
+		parser.add_argument("--lod-error")
+			.help("Generate LODs and select them with the maximum projected error in pixels")
+			.store_into(argument.lod_error);
+
+		try
+		{
+			parser.parse_args(arguments.size(), arguments.data());
+		}
+		catch (const std::exception& e)
+		{
+			return Error(e.what(), parser.usage());
+		}
+
+		if (session_count <= 0) return Error("Invalid session count", std::format("Got {}", session_count));
+		if (frame_count <= 0) return Error("Invalid frame count", std::format("Got {}", frame_count));
+		if (width <= 0 || height <= 0)
+			return Error("Invalid resolution", std::format("Got {}x{}", width, height));
+		if (argument.frame_rate < 0.0f)
+			return Error("Invalid frame rate", std::format("Got {}", argument.frame_rate));
+		if (argument.lod_error < 0.0f)
+			return Error("Invalid LOD error", std::format("Got {}", argument.lod_error));
+
+		if (parser.is_used("--path")) argument.path_files = parser.get<std::vector<std::string>>("--path");
+		argument.session_count = static_cast<uint32_t>(session_count);
+		argument.frame_count = static_cast<uint32_t>(frame_count);
+		argument.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+
+		return argument;
+	}
+}
@@ -0,0 +1,217 @@
+#include "bench/camera-path.hpp"
+#include "common/file.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "render/model/mesh.hpp"
+#include "server/argument.hpp"
+#include "server/scene.hpp"
+#include "server/session.hpp"
+#include "vulkan/context/device.hpp"
+#include "vulkan/context/instance.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <print>
+#include <ranges>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Upper bound of a scheduler sleep while a due session waits for the GPU
+static constexpr auto GPU_POLL_INTERVAL = std::chrono::microseconds(500);
+
+static std::expected<bench::CameraPath, Error> load_camera_path(
+	const server::Argument& argument,
+	uint32_t session_index
+) noexcept
+{
+	if (argument.path_files.empty()) return bench::CameraPath::orbit();
+
+	const auto& path_file = argument.path_files[session_index % argument.path_files.size()];
+
+	const auto content_result = file::read(path_file);
+	if (!content_result) return content_result.error().forward("Read camera path file failed");
+
+	const auto json = Json::parse(*content_result, nullptr, false);
+	if (json.is_discarded()) return Error("Parse camera path file failed", "Invalid JSON");
+
+	return bench::CameraPath::from_json(json);
+}
+
+static std::expected<std::vector<server::Session>, Error> create_sessions(
+	const vulkan::Context& context,
+	const server::Scene& scene,
+	const server::Argument& argument
+) noexcept
+{
+	const auto budget = argument.frame_rate > 0.0f
+		? std::chrono::duration_cast<std::chrono::nanoseconds>(
+			  std::chrono::duration<double>(1.0 / static_cast<double>(argument.frame_rate))
+		  )
+		: std::chrono::nanoseconds(0);
+
+	std::vector<server::Session> sessions;
+	sessions.reserve(argument.session_count);
+
+	for (const auto session_index : std::views::iota(0u, argument.session_count))
+	{
+		auto camera_path_result = load_camera_path(argument, session_index);
+		if (!camera_path_result) return camera_path_result.error().forward("Load camera path failed");
+
+		// Spread the sessions along their paths, so that sessions sharing a path show different views
+		const auto option = server::Session::Option{
+			.extent = argument.extent,
+			.frame_count = argument.frame_count,
+			.phase = static_cast<double>(session_index) / static_cast<double>(argument.session_count),
+			.budget = budget,
+			.lod_pixel_error = argument.lod_error,
+		};
+
+		const auto output_path =
+			std::filesystem::path(argument.output_directory) / std::format("session-{}.rgba", session_index);
+
+		auto session_result =
+			server::Session::create(context, scene, std::move(*camera_path_result), option, output_path);
+		if (!session_result)
+			return session_result.error().forward(std::format("Create session {} failed", session_index));
+
+		sessions.emplace_back(std::move(*session_result));
+	}
+
+	return sessions;
+}
+
+// Round-robin over the sessions, each pass submits at most one frame per session that is due and whose
+// frame resources are released by the GPU. A session waiting for the GPU never blocks the others.
+static std::expected<void, Error> serve(
+	const vulkan::Context& context,
+	std::span<server::Session> sessions
+) noexcept
+{
+	while (!std::ranges::all_of(sessions, &server::Session::done))
+	{
+		bool submitted = false;
+
+		for (auto& session : sessions)
+		{
+			const auto now = std::chrono::steady_clock::now();
+
+			const auto ready_result = session.ready(context, now);
+			if (!ready_result) return ready_result.error().forward("Poll session failed");
+			if (!*ready_result) continue;
+
+			if (const auto result = session.render_frame(context, now); !result)
+				return result.error().forward("Render session frame failed");
+			submitted = true;
+		}
+
+		if (submitted) continue;
+
+		// Nothing to submit until the earliest session is due, sessions already due wait for the GPU
+		const auto poll_time = std::chrono::steady_clock::now() + GPU_POLL_INTERVAL;
+		auto wake_time = std::chrono::steady_clock::time_point::max();
+		for (const auto& session : sessions)
+			if (!session.done()) wake_time = std::min(wake_time, std::max(session.next_due(), poll_time));
+
+		std::this_thread::sleep_until(wake_time);
+	}
+
+	for (auto& session : sessions)
+		if (const auto result = session.finish(context); !result)
+			return result.error().forward("Finish session failed");
+
+	return {};
+}
+
+static std::expected<Json, Error> run(const server::Argument& argument) noexcept
+{
+	/* Context */
+
+	auto instance_result =
+		vulkan::HeadlessInstanceContext::create({.application_name = "Vulkan-RT Render Server"});
+	if (!instance_result) return instance_result.error().forward("Create instance context failed");
+	auto instance = std::move(*instance_result);
+
+	auto device_result = vulkan::HeadlessDeviceContext::create(instance, {.raytracing = true}, ".cache");
+	if (!device_result) return device_result.error().forward("Create device context failed");
+	auto device = std::move(*device_result);
+
+	const auto context = device.get();
+
+	/* Load */
+
+	auto scene_result = server::Scene::create(
+		context,
+		argument.model_path,
+		argument.packed_vertex ? render::VertexFormat::Packed : render::VertexFormat::Full,
+		argument.lod_error > 0.0f
+	);
+	if (!scene_result) return scene_result.error().forward("Load scene failed");
+	const auto scene = std::move(*scene_result);
+
+	auto sessions_result = create_sessions(context, scene, argument);
+	if (!sessions_result) return sessions_result.error().forward("Create sessions failed");
+	auto sessions = std::move(*sessions_result);
+
+	/* Serve */
+
+	const auto start_time = std::chrono::steady_clock::now();
+
+	if (const auto result = serve(context, sessions); !result) return result.error();
+
+	const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	/* Summarize */
+
+	auto json = Json::object();
+	json["device"] = std::string(context.phy_device.getProperties().deviceName);
+	json["model"] = argument.model_path;
+	json["resolution"] = {argument.extent.x, argument.extent.y};
+	json["seconds"] = seconds;
+
+	auto& session_reports = json["sessions"] = Json::array();
+	for (const auto& session : sessions)
+	{
+		const auto statistics = session.get_statistics();
+		session_reports.push_back(
+			Json{
+				{"submitted_frames", statistics.submitted_frames},
+				{"written_frames", statistics.written_frames},
+				{"late_frames", statistics.late_frames},
+				{"fps", statistics.written_frames / seconds},
+			}
+		);
+	}
+
+	return json;
+}
+
+int main(int argc, const char* argv[]) noexcept
+{
+	const auto argument_result = server::Argument::parse(std::span<const char*>(argv, argc));
+	if (!argument_result)
+	{
+		std::println(std::cerr, "{}", argument_result.error()->message);
+		if (argument_result.error()->detail) std::println(std::cerr, "{}", *argument_result.error()->detail);
+		return EXIT_FAILURE;
+	}
+
+	const auto report_result = run(*argument_result);
+	if (!report_result)
+	{
+		std::println(std::cerr, "Error: {}", report_result.error().root());
+		return EXIT_FAILURE;
+	}
+
+	std::println("{}", report_result->dump(4));
+	return EXIT_SUCCESS;
+}
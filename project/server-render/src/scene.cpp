@@ -0,0 +1,115 @@
+#include "server/scene.hpp"
+#include "common/util/error.hpp"
+#include "model/gltf.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/texture-list.hpp"
+#include "render/model/texture.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "resource/aux-resource.hpp"
+#include "resource/pipeline.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <coro/sync_wait.hpp>
+#include <coro/thread_pool.hpp>
+#include <expected>
+#include <filesystem>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint3_sized.hpp>
+#include <utility>
+
+namespace server
+{
+	std::expected<Scene, Error> Scene::create(
+		const vulkan::Context& context,
+		const std::filesystem::path& model_path,
+		render::VertexFormat vertex_format,
+		bool generate_lod
+	) noexcept
+	{
+		auto thread_pool = coro::thread_pool::make_unique();
+
+		/* Model */
+
+		auto [gltf_parsing_task, gltf_parsing_progress] =
+			model::gltf::load_from_file(*thread_pool, model_path);
+		auto gltf_parsing_result = coro::sync_wait(std::move(gltf_parsing_task));
+		if (!gltf_parsing_result) return gltf_parsing_result.error().forward("Parse gltf model failed");
+		auto gltf_model = std::move(*gltf_parsing_result);
+
+		auto material_layout_result = render::MaterialLayout::create(context);
+		if (!material_layout_result)
+			return material_layout_result.error().forward("Create material layout failed");
+		auto material_layout = std::move(*material_layout_result);
+
+		const auto texture_load_opt = render::TextureList::LoadOption{
+			.color_load_strategy = render::Texture::ColorLoadStrategy::BalancedBC,
+			.exit_on_failed_load = true
+		};
+
+		auto [model_task, model_progress] = render::Model::create(
+			*thread_pool,
+			context,
+			material_layout,
+			gltf_model,
+			{
+				.texture_load_option = texture_load_opt,
+				.compact_blas = true,
+				.vertex_format = vertex_format,
+				.optimize_mesh = true,
+				.generate_lod = generate_lod,
+			}
+		);
+		auto model_result = coro::sync_wait(std::move(model_task));
+		if (!model_result) return model_result.error().forward("Load model failed");
+		auto model = std::move(*model_result);
+
+		const auto transforms = model.hierarchy.compute_transforms(glm::mat4(1.0));
+		auto tlas_result = render::Tlas::build(context, model, transforms);
+		if (!tlas_result) return tlas_result.error().forward("Build TLAS failed");
+		auto tlas = std::move(*tlas_result);
+
+		/* Pipelines & Auxiliary Resources */
+
+		auto pipeline_result = resource::Pipeline::create(
+			context,
+			material_layout,
+			model.mesh_list->vertex_format,
+			TARGET_FORMAT
+		);
+		if (!pipeline_result) return pipeline_result.error().forward("Create pipelines failed");
+
+		auto aux_resource_result = resource::AuxResource::create(context);
+		if (!aux_resource_result)
+			return aux_resource_result.error().forward("Create auxiliary resources failed");
+
+		// Smallest volume to bind to the direct lighting, only sampled with global illumination enabled
+		auto gi_probe_volume_result = render::GiProbeVolume::create(
+			context,
+			{.origin = glm::vec3(-0.5f), .spacing = glm::vec3(1.0f), .count = glm::u32vec3(2)},
+			1
+		);
+		if (!gi_probe_volume_result)
+			return gi_probe_volume_result.error().forward("Create probe volume failed");
+
+		// Bound to the direct lighting as well, only sampled with environment lighting enabled
+		auto environment_lighting_result =
+			render::EnvironmentLighting::create_uniform(context, glm::vec3(0.0f));
+		if (!environment_lighting_result)
+			return environment_lighting_result.error().forward("Create environment lighting failed");
+
+		return Scene{
+			.material_layout = std::move(material_layout),
+			.model = std::move(model),
+			.tlas = std::move(tlas),
+			.pipeline = std::move(*pipeline_result),
+			.aux_resource = std::move(*aux_resource_result),
+			.gi_probe_volume = std::move(*gi_probe_volume_result),
+			.environment_lighting = std::move(*environment_lighting_result),
+		};
+	}
+}
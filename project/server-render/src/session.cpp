@@ -0,0 +1,445 @@
+#include "server/session.hpp"
+#include "bench/camera-path.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/pipeline/bloom.hpp"
+#include "render/pipeline/hiz.hpp"
+#include "render/pipeline/indirect.hpp"
+#include "render/resource/ambient-occlusion.hpp"
+#include "render/resource/indirect.hpp"
+#include "resource/render-resource.hpp"
+#include "resource/sync-primitive.hpp"
+#include "server/scene.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/container/device/readback-ring.hpp"
+#include "vulkan/container/host/cycle.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/glm.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace server
+{
+	namespace
+	{
+		// Exposure adaptation step of the first frame, and upper bound after a scheduling hiccup
+		constexpr float MAX_DELTA_TIME = 1.0f / 30.0f;
+	}
+
+	std::expected<Session, Error> Session::create(
+		const vulkan::Context& context,
+		const Scene& scene,
+		bench::CameraPath camera_path,
+		const Option& option,
+		const std::filesystem::path& output_path
+	) noexcept
+	{
+		auto command_pool_result = context.device.createCommandPool({
+			.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+			.queueFamilyIndex = context.family,
+		});
+		if (!command_pool_result) return Error::from(command_pool_result);
+		auto command_pool = std::move(*command_pool_result);
+
+		auto command_buffers_result = context.device.allocateCommandBuffers({
+			.commandPool = command_pool,
+			.commandBufferCount = FRAME_RESOURCE_COUNT,
+		});
+		if (!command_buffers_result) return Error::from(command_buffers_result);
+		auto command_buffers = std::move(*command_buffers_result);
+
+		auto render_resources_result =
+			std::views::repeat(resource::RenderResource::create, FRAME_RESOURCE_COUNT)
+			| std::views::transform([&context](auto f) { return f(context); })
+			| Error::collect();
+		if (!render_resources_result)
+			return render_resources_result.error().forward("Create render resources failed");
+		auto render_resources = std::move(*render_resources_result);
+
+		// No attachments exist yet, nothing is retired
+		auto deletion_queue = vulkan::DeletionQueue(FRAME_RESOURCE_COUNT);
+		for (auto& render_resource : render_resources)
+		{
+			const auto result = render_resource.resize_attachments(
+				context,
+				deletion_queue,
+				option.extent,
+				option.extent,
+				true,
+				render::AmbientOcclusionAttachment::Resolution::Quarter
+			);
+			if (!result) return result.error().forward("Create render attachments failed");
+		}
+
+		auto sync_primitives_result =
+			std::views::repeat(resource::FrameSyncPrimitive::create, FRAME_RESOURCE_COUNT)
+			| std::views::transform([&context](auto f) { return f(context); })
+			| Error::collect();
+		if (!sync_primitives_result)
+			return sync_primitives_result.error().forward("Create sync primitives failed");
+		auto sync_primitives = std::move(*sync_primitives_result);
+
+		auto resource_sets_result = scene.pipeline.create_resource_sets(context, FRAME_RESOURCE_COUNT);
+		if (!resource_sets_result) return resource_sets_result.error().forward("Create resource sets failed");
+		auto resource_sets = std::move(*resource_sets_result);
+
+		auto frame_resources =
+			std::views::zip_transform(
+				CTOR_LAMBDA(FrameResource),
+				command_buffers | std::views::as_rvalue,
+				render_resources | std::views::as_rvalue,
+				resource_sets | std::views::as_rvalue,
+				sync_primitives | std::views::as_rvalue
+			)
+			| vulkan::Cycle<FrameResource>::into;
+
+		auto readback_ring_result = vulkan::ReadbackRing::create(
+			context,
+			FRAME_RESOURCE_COUNT,
+			size_t(option.extent.x) * option.extent.y * TEXEL_SIZE
+		);
+		if (!readback_ring_result) return readback_ring_result.error().forward("Create readback ring failed");
+
+		auto target_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			option.extent,
+			Scene::TARGET_FORMAT,
+			vk::ImageUsageFlagBits::eTransferSrc
+		);
+		if (!target_result) return target_result.error().forward("Create offscreen target failed");
+
+		auto output = std::make_unique<Output>();
+		output->stream.open(output_path, std::ios::binary | std::ios::trunc);
+		if (!output->stream)
+			return Error("Open output stream failed", output_path.string());
+
+		return Session(
+			scene,
+			option,
+			render::IndirectPipeline::lod_threshold_from_pixels(option.lod_pixel_error, option.extent.y),
+			std::move(command_pool),
+			std::move(frame_resources),
+			std::move(*readback_ring_result),
+			std::move(*target_result),
+			std::move(camera_path),
+			std::move(output)
+		);
+	}
+
+	std::expected<bool, Error> Session::ready(
+		const vulkan::Context& context,
+		std::chrono::steady_clock::time_point now
+	) const noexcept
+	{
+		if (done() || now < due_time) return false;
+
+		// Frame resources of the next frame, see `vulkan::Cycle::history`
+		const auto& next_frame = frame_resources.history(FRAME_RESOURCE_COUNT - 1);
+		if (!next_frame.submitted) return true;
+
+		const auto wait_result =
+			context.device.waitForFences(*next_frame.sync_primitive.draw_fence, vk::True, 0);
+		if (wait_result == vk::Result::eTimeout) return false;
+		if (wait_result != vk::Result::eSuccess) return Error::from(wait_result);
+
+		return true;
+	}
+
+	std::expected<void, Error> Session::render_frame(
+		const vulkan::Context& context,
+		std::chrono::steady_clock::time_point now
+	) noexcept
+	{
+		frame_resources.cycle();
+		auto& frame = frame_resources.current();
+		const auto& prev_frame = frame_resources.prev();
+
+		// `ready()` has checked that the frame last using these resources has completed
+		deletion_queue.advance();
+		if (const auto result = readback_ring.begin_frame(); !result)
+			return result.error().forward("Read back session frame failed");
+
+		/* Schedule */
+
+		// Catch up on the budget after a short delay, but never burst frames after a long one
+		if (option.budget.count() > 0)
+		{
+			const bool late = submitted_frames > 0 && now - due_time > option.budget;
+			if (late) late_frames++;
+			if (submitted_frames == 0 || late) due_time = now;
+			due_time += option.budget;
+		}
+
+		const auto delta_time = last_frame_time.has_value()
+			? std::min(std::chrono::duration<float>(now - *last_frame_time).count(), MAX_DELTA_TIME)
+			: MAX_DELTA_TIME;
+		last_frame_time = now;
+
+		/* Update & Bind */
+
+		const auto& model = scene->model;
+
+		const auto t = std::fmod(
+			option.phase + static_cast<double>(submitted_frames) / static_cast<double>(option.frame_count),
+			1.0
+		);
+
+		const auto render_data = resource::RenderData{
+			.drawcall_counts = model.scene_graph.drawcall_counts(),
+			.blended_drawcall_counts = model.scene_graph.drawcall_counts(render::SceneGraph::Bucket::Blended),
+			.node_count = model.scene_graph->node_count,
+			.primitive_count = model.mesh_list->primitive_attr_array.size(),
+			.material_count = model.material_list.material_count(),
+			.transform_updates = {},
+			.root_transform = glm::mat4(1.0f),
+			.camera = camera_path.sample(t, option.extent),
+			.primary_light = primary_light.get(),
+			.exposure_param = exposure.get(delta_time, option.extent),
+		};
+
+		if (const auto result = frame.render_resource.update(context, deletion_queue, render_data); !result)
+			return result.error().forward("Update render resource failed");
+
+		frame.resource_set.update(
+			context,
+			model,
+			scene->tlas,
+			frame.render_resource,
+			prev_frame.render_resource,
+			scene->aux_resource,
+			scene->gi_probe_volume,
+			scene->environment_lighting,
+			scene->pipeline.atmosphere.get_lut_view(),
+			std::nullopt,
+			std::nullopt
+		);
+
+		/* Record */
+
+		if (const auto result = frame.command_buffer.begin({}); !result) return Error::from(result);
+
+		record(frame, prev_frame, std::exchange(history_valid, true));
+
+		const auto read_result = readback_ring.read_image(
+			context,
+			frame.command_buffer,
+			vulkan::AttachmentView(target).image,
+			vk::ImageLayout::eTransferSrcOptimal,
+			vk::ImageAspectFlagBits::eColor,
+			option.extent,
+			TEXEL_SIZE,
+			[output = output.get()](std::span<const std::byte> data) {
+				const auto size = static_cast<std::streamsize>(data.size());
+				output->stream.write(reinterpret_cast<const char*>(data.data()), size);
+				output->written_frames++;
+			}
+		);
+		if (!read_result) return read_result.error().forward("Record session frame readback failed");
+
+		if (const auto barrier = readback_ring.host_barrier())
+			frame.command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(*barrier));
+
+		if (const auto result = frame.command_buffer.end(); !result) return Error::from(result);
+
+		/* Submit */
+
+		const auto command_buffer_submit_info = vk::CommandBufferSubmitInfo{
+			.commandBuffer = frame.command_buffer,
+		};
+		const auto submit_info = vk::SubmitInfo2().setCommandBufferInfos(command_buffer_submit_info);
+
+		if (const auto result = context.device.resetFences(*frame.sync_primitive.draw_fence); !result)
+			return Error::from(result);
+
+		{
+			const std::scoped_lock lock(context.submit_mutex);
+			if (const auto result = context.queue.submit2(submit_info, frame.sync_primitive.draw_fence);
+				!result)
+				return Error::from(result);
+		}
+
+		frame.submitted = true;
+		submitted_frames++;
+
+		return {};
+	}
+
+	std::expected<void, Error> Session::finish(const vulkan::Context& context) noexcept
+	{
+		if (const auto result = context.device.waitIdle(); !result) return Error::from(result);
+
+		// Visit every slot once, oldest first, delivering the frames still pending in the ring
+		for ([[maybe_unused]] const auto _ : std::views::iota(0u, FRAME_RESOURCE_COUNT))
+			if (const auto result = readback_ring.begin_frame(); !result)
+				return result.error().forward("Read back session frame failed");
+
+		output->stream.flush();
+		if (!output->stream) return Error("Write output stream failed");
+
+		return {};
+	}
+
+	Session::Statistics Session::get_statistics() const noexcept
+	{
+		return {
+			.submitted_frames = submitted_frames,
+			.written_frames = output->written_frames,
+			.late_frames = late_frames,
+		};
+	}
+
+	void Session::record(FrameResource& frame, const FrameResource& prev_frame, bool history_valid)
+		const noexcept
+	{
+		const auto& pipeline = scene->pipeline;
+		const auto& command_buffer = frame.command_buffer;
+
+		frame.render_resource.upload(command_buffer);
+
+		// Previous HiZ is never built, transition it so that it can still be bound
+		if (!history_valid)
+			render::HizPipeline::discard(command_buffer, prev_frame.render_resource.attachments->hiz);
+
+		pipeline.transform.compute(command_buffer, frame.resource_set.transform);
+
+		// Variable rate shading is not served, the cleared rates shade every pixel at full rate
+		pipeline.shading_rate.clear(command_buffer, frame.resource_set.shading_rate);
+
+		record_phase(frame, render::DrawPhase::Early, history_valid);
+		record_phase(frame, render::DrawPhase::Late, history_valid);
+
+		pipeline.light_cluster.compute(command_buffer, frame.resource_set.light_cluster);
+		pipeline.shadow.compute(command_buffer, frame.resource_set.shadow);
+
+		// Ambient occlusion is not served, the cleared output keeps the lighting bindings valid
+		pipeline.ambient_occlusion.clear(command_buffer, frame.resource_set.ambient_occlusion);
+
+		pipeline.direct_lighting.compute(command_buffer, frame.resource_set.direct_lighting);
+
+		for (const auto phase : {render::DrawPhase::Early, render::DrawPhase::Late})
+			pipeline.indirect.compute(
+				command_buffer,
+				frame.resource_set.blended_indirect,
+				phase,
+				history_valid,
+				lod_threshold
+			);
+		pipeline.transparent.render(command_buffer, frame.resource_set.transparent);
+
+		pipeline.auto_exposure.compute(command_buffer, frame.resource_set.auto_exposure);
+		pipeline.taa.compute(command_buffer, frame.resource_set.taa, history_valid);
+
+		// Composited without bloom, the chain is only transitioned so that it can still be bound
+		render::BloomPipeline::discard(command_buffer, frame.render_resource.attachments->bloom);
+
+		record_composite(frame);
+	}
+
+	void Session::record_phase(FrameResource& frame, render::DrawPhase phase, bool history_valid)
+		const noexcept
+	{
+		const auto& pipeline = scene->pipeline;
+		const auto& command_buffer = frame.command_buffer;
+
+		pipeline.indirect.compute(
+			command_buffer,
+			frame.resource_set.indirect,
+			phase,
+			history_valid,
+			lod_threshold
+		);
+		pipeline.deferred.render(command_buffer, frame.resource_set.deferred, phase);
+		pipeline.hiz.compute(command_buffer, frame.resource_set.hiz);
+	}
+
+	void Session::record_composite(FrameResource& frame) const noexcept
+	{
+		const auto& command_buffer = frame.command_buffer;
+		const auto target_view = vulkan::AttachmentView(target);
+
+		const auto target_barrier = [&target_view](
+										vk::PipelineStageFlags2 src_stage,
+										vk::AccessFlags2 src_access,
+										vk::PipelineStageFlags2 dst_stage,
+										vk::AccessFlags2 dst_access,
+										vk::ImageLayout old_layout,
+										vk::ImageLayout new_layout
+									) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = src_stage,
+				.srcAccessMask = src_access,
+				.dstStageMask = dst_stage,
+				.dstAccessMask = dst_access,
+				.oldLayout = old_layout,
+				.newLayout = new_layout,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = target_view.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		};
+
+		// Previous content of the target is never read, but its last readback must complete first
+		const auto pre_composite_barrier = target_barrier(
+			vk::PipelineStageFlagBits2::eCopy,
+			vk::AccessFlagBits2::eNone,
+			vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			vk::AccessFlagBits2::eColorAttachmentWrite,
+			vk::ImageLayout::eUndefined,
+			vk::ImageLayout::eColorAttachmentOptimal
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_composite_barrier));
+
+		const auto rendering_area = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(option.extent)
+		};
+
+		const auto target_attachment = vk::RenderingAttachmentInfo{
+			.imageView = target_view.view,
+			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.loadOp = vk::AttachmentLoadOp::eClear,
+			.storeOp = vk::AttachmentStoreOp::eStore,
+			.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f)
+		};
+
+		const auto rendering_info =
+			vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
+				.setColorAttachments(target_attachment);
+
+		command_buffer.beginRendering(rendering_info);
+		scene->pipeline.composite.render(command_buffer, frame.resource_set.composite);
+		command_buffer.endRendering();
+
+		// Read back by the readback ring right after
+		const auto post_composite_barrier = target_barrier(
+			vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			vk::AccessFlagBits2::eColorAttachmentWrite,
+			vk::PipelineStageFlagBits2::eCopy,
+			vk::AccessFlagBits2::eTransferRead,
+			vk::ImageLayout::eColorAttachmentOptimal,
+			vk::ImageLayout::eTransferSrcOptimal
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_composite_barrier));
+	}
+}
@@ -0,0 +1,35 @@
+-- Headless render server, renders many offscreen sessions sharing one device, model and pipeline set
+
+-- Scene shared across sessions, also loaded by the other offline renderers
+target("server.render.common")
+	set_kind("static")
+	set_default(false)
+
+	add_deps("lib.common", "model.gltf", "render", "main.common", {public = true})
+
+	add_files("src/scene.cpp")
+	add_includedirs("include", {public = true})
+	add_headerfiles("include/server/scene.hpp")
+
+target("server.render")
+	set_kind("binary")
+	set_default(false)
+
+	add_deps(
+		"lib.common",
+		"lib.scene",
+		"vulkan.util",
+		"vulkan.alloc",
+		"vulkan.context",
+		"model.gltf",
+		"render",
+		"main.common",
+		"bench.render.common",
+		"server.render.common"
+	)
+
+	add_files("src/**.cpp|scene.cpp")
+	add_includedirs("include")
+	add_headerfiles("include/**.hpp")
+
+	add_packages("argparse")
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace still
+{
+	///
+	/// @brief Command line arguments of the still renderer
+	///
+	struct Argument
+	{
+		std::string model_path;
+		std::optional<std::string> path_file = std::nullopt;  // Camera path JSON file, orbits if omitted
+		double time = 0.0;                                    // Position along the camera path, in `[0, 1]`
+		std::string output_path = "still.ppm";                // Binary PPM image receiving the render
+
+		glm::u32vec2 extent = {15360, 8640};  // Extent of the whole image
+		uint32_t tile_size = 1024;            // Extent of the visible part of each tile
+		uint32_t guard_size = 64;             // Extra pixels rendered around each tile, then cropped
+		uint32_t frame_count = 16;            // Frames accumulated by TAA in each tile
+		bool packed_vertex = false;           // Upload vertices as `render::VertexFormat::Packed`
+
+		///
+		/// @brief Parse the argument
+		///
+		/// @param arguments Input argument
+		/// @return Parsed argument or error
+		///
+		[[nodiscard]]
+		static std::expected<Argument, Error> parse(std::span<const char*> arguments) noexcept;
+	};
+}
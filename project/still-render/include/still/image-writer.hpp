@@ -0,0 +1,90 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace still
+{
+	///
+	/// @brief Writes an image to disk region by region, without ever holding the whole image in memory
+	/// @details The output is a binary PPM (`P6`) image. The file is sized up front, so that regions can be
+	/// written at their final offsets in any order. Only one row of the region is converted in memory at a
+	/// time.
+	///
+	class ImageWriter
+	{
+	  public:
+
+		static constexpr size_t SOURCE_TEXEL_SIZE = 4;  // RGBA8 source texels, alpha is dropped
+		static constexpr size_t TEXEL_SIZE = 3;         // RGB8 texels of the PPM image
+
+		///
+		/// @brief Create the image file, truncating it if it exists
+		///
+		/// @param path Path of the image
+		/// @param extent Extent of the whole image
+		/// @return Created writer or error
+		///
+		[[nodiscard]]
+		static std::expected<ImageWriter, Error> create(
+			const std::filesystem::path& path,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief Write a region of the image
+		/// @note Failures are deferred to `finish()`, so that it can be called from a readback callback
+		///
+		/// @param offset Offset of the region in the image
+		/// @param extent Extent of the region, must lie inside the image
+		/// @param data RGBA8 texels, the region starts at the first texel
+		/// @param row_pitch Distance between two rows of @p data in texels
+		///
+		void write(
+			glm::u32vec2 offset,
+			glm::u32vec2 extent,
+			std::span<const std::byte> data,
+			size_t row_pitch
+		) noexcept;
+
+		///
+		/// @brief Flush the image to disk
+		///
+		/// @return Void, or error if any write has failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> finish() noexcept;
+
+	  private:
+
+		std::fstream stream;
+		std::streamoff header_size;
+		glm::u32vec2 extent;
+
+		std::vector<std::byte> row_buffer;
+		bool failed = false;
+
+		explicit ImageWriter(std::fstream stream, std::streamoff header_size, glm::u32vec2 extent) :
+			stream(std::move(stream)),
+			header_size(header_size),
+			extent(extent),
+			row_buffer(size_t(extent.x) * TEXEL_SIZE)
+		{}
+
+	  public:
+
+		ImageWriter(const ImageWriter&) = delete;
+		ImageWriter(ImageWriter&&) = default;
+		ImageWriter& operator=(const ImageWriter&) = delete;
+		ImageWriter& operator=(ImageWriter&&) = default;
+	};
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "logic/param/auto-exposure.hpp"
+#include "logic/param/primary-light.hpp"
+#include "render/interface/camera.hpp"
+#include "render/resource/indirect.hpp"
+#include "resource/render-resource.hpp"
+#include "resource/sync-primitive.hpp"
+#include "server/scene.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/container/device/readback-ring.hpp"
+#include "vulkan/container/host/cycle.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace still
+{
+	///
+	/// @brief Renders frames of a fixed extent offscreen, running the same passes as the main render page
+	/// @details The caller supplies the camera of each frame, so the same renderer meters the exposure over
+	/// the whole view and then renders every tile of the image through its sub-projection. Requested frames
+	/// are read back through a `vulkan::ReadbackRing` as tightly packed RGBA8 rows, and delivered
+	/// `FRAME_RESOURCE_COUNT` frames after they were submitted, or by `finish()`.
+	///
+	class TileRenderer
+	{
+	  public:
+
+		static constexpr uint32_t FRAME_RESOURCE_COUNT = 2;
+		static constexpr size_t TEXEL_SIZE = 4;  // Size of a texel of `server::Scene::TARGET_FORMAT`
+
+		///
+		/// @brief Create a tile renderer
+		///
+		/// @param context Vulkan context
+		/// @param scene Scene to render, must outlive the renderer
+		/// @param extent Extent of every rendered frame
+		/// @return Created renderer or error
+		///
+		[[nodiscard]]
+		static std::expected<TileRenderer, Error> create(
+			const vulkan::Context& context,
+			const server::Scene& scene,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief Record and submit a frame, waiting for the frame resources it reuses
+		///
+		/// @param context Vulkan context
+		/// @param camera Camera of the frame, previous-frame matrices must match the last frame if
+		/// @p history_valid is `true`
+		/// @param delta_time Exposure adaptation step in seconds, `0` keeps the exposure of the last frame
+		/// @param history_valid Whether the last frame was rendered from the same view, `false` restarts the
+		/// TAA accumulation and disables occlusion culling against the previous HiZ
+		/// @param readback Callback receiving the composited frame, `std::nullopt` skips the readback
+		/// @return Void or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> render_frame(
+			const vulkan::Context& context,
+			const render::Camera& camera,
+			float delta_time,
+			bool history_valid,
+			std::optional<vulkan::ReadbackRing::Callback> readback
+		) noexcept;
+
+		///
+		/// @brief Wait for the submitted frames and deliver the pending readbacks
+		///
+		/// @param context Vulkan context
+		/// @return Void or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> finish(const vulkan::Context& context) noexcept;
+
+	  private:
+
+		struct FrameResource
+		{
+			vk::raii::CommandBuffer command_buffer;
+			resource::RenderResource render_resource;
+			resource::ResourceSet resource_set;
+			resource::FrameSyncPrimitive sync_primitive;
+			bool submitted = false;  // Whether `sync_primitive.draw_fence` guards a submitted frame
+
+			explicit FrameResource(
+				vk::raii::CommandBuffer command_buffer,
+				resource::RenderResource render_resource,
+				resource::ResourceSet resource_set,
+				resource::FrameSyncPrimitive sync_primitive
+			) :
+				command_buffer(std::move(command_buffer)),
+				render_resource(std::move(render_resource)),
+				resource_set(std::move(resource_set)),
+				sync_primitive(std::move(sync_primitive))
+			{}
+
+			FrameResource(const FrameResource&) = delete;
+			FrameResource(FrameResource&&) = default;
+			FrameResource& operator=(const FrameResource&) = delete;
+			FrameResource& operator=(FrameResource&&) = default;
+		};
+
+		const server::Scene* scene;
+		glm::u32vec2 extent;
+
+		vk::raii::CommandPool command_pool;
+		vulkan::Cycle<FrameResource> frame_resources;
+		vulkan::DeletionQueue deletion_queue = vulkan::DeletionQueue(FRAME_RESOURCE_COUNT);
+		vulkan::ReadbackRing readback_ring;
+		vulkan::Attachment target;
+
+		logic::PrimaryLight primary_light;
+		logic::Exposure exposure;
+
+		explicit TileRenderer(
+			const server::Scene& scene,
+			glm::u32vec2 extent,
+			vk::raii::CommandPool command_pool,
+			vulkan::Cycle<FrameResource> frame_resources,
+			vulkan::ReadbackRing readback_ring,
+			vulkan::Attachment target
+		) :
+			scene(&scene),
+			extent(extent),
+			command_pool(std::move(command_pool)),
+			frame_resources(std::move(frame_resources)),
+			readback_ring(std::move(readback_ring)),
+			target(std::move(target))
+		{}
+
+		void record(FrameResource& frame, const FrameResource& prev_frame, bool history_valid) const noexcept;
+
+		void record_phase(FrameResource& frame, render::DrawPhase phase, bool history_valid) const noexcept;
+
+		void record_composite(FrameResource& frame) const noexcept;
+
+	  public:
+
+		TileRenderer(const TileRenderer&) = delete;
+		TileRenderer(TileRenderer&&) = default;
+		TileRenderer& operator=(const TileRenderer&) = delete;
+		TileRenderer& operator=(TileRenderer&&) = default;
+	};
+}
@@ -0,0 +1,72 @@
+#include "still/argument.hpp"
+#include "common/util/error.hpp"
+
+#include <argparse/argparse.hpp>
+#include <cstdint>
+#include <exception>
+#include <expected>
+#include <format>
+#include <span>
+#include <string>
+
+namespace still
+{
+	std::expected<Argument, Error> Argument::parse(std::span<const char*> arguments) noexcept
+	{
+		Argument argument;
+
+		auto width = static_cast<int>(argument.extent.x);
+		auto height = static_cast<int>(argument.extent.y);
+		auto tile_size = static_cast<int>(argument.tile_size);
+		auto guard_size = static_cast<int>(argument.guard_size);
+		auto frame_count = static_cast<int>(argument.frame_count);
+
+		argparse::ArgumentParser parser("still.render");
+		parser.add_argument("model")
+			.help("Path to the glTF model to render")
+			.required()
+			.store_into(argument.model_path);
+		parser.add_argument("--path").help("Camera path JSON file, orbits if omitted");
+		parser.add_argument("--time")
+			.help("Position along the camera path, from 0 to 1")
+			.store_into(argument.time);
+		parser.add_argument("--width").help("Width of the image").store_into(width);
+		parser.add_argument("--height").help("Height of the image").store_into(height);
+		parser.add_argument("--tile").help("Size of each tile").store_into(tile_size);
+		parser.add_argument("--guard")
+			.help("Guard band rendered around each tile for screen-space effects")
+			.store_into(guard_size);
+		parser.add_argument("--frames")
+			.help("Number of frames accumulated in each tile")
+			.store_into(frame_count);
+		parser.add_argument("--output").help("Output PPM image").store_into(argument.output_path);
+		parser.add_argument("--packed-vertex")
+			.help("Use quantized vertex format")
+			.store_into(argument.packed_vertex);
+
+		try
+		{
+			parser.parse_args(arguments.size(), arguments.data());
+		}
+		catch (const std::exception& e)
+		{
+			return Error(e.what(), parser.usage());
+		}
+
+		if (width <= 0 || height <= 0)
+			return Error("Invalid resolution", std::format("Got {}x{}", width, height));
+		if (tile_size <= 0) return Error("Invalid tile size", std::format("Got {}", tile_size));
+		if (guard_size < 0) return Error("Invalid guard size", std::format("Got {}", guard_size));
+		if (frame_count <= 0) return Error("Invalid frame count", std::format("Got {}", frame_count));
+		if (argument.time < 0.0 || argument.time > 1.0)
+			return Error("Invalid time", std::format("Got {}, expects [0, 1]", argument.time));
+
+		if (parser.is_used("--path")) argument.path_file = parser.get<std::string>("--path");
+		argument.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+		argument.tile_size = static_cast<uint32_t>(tile_size);
+		argument.guard_size = static_cast<uint32_t>(guard_size);
+		argument.frame_count = static_cast<uint32_t>(frame_count);
+
+		return argument;
+	}
+}
@@ -0,0 +1,83 @@
+#include "still/image-writer.hpp"
+#include "common/util/error.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <ios>
+#include <ranges>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace still
+{
+	std::expected<ImageWriter, Error> ImageWriter::create(
+		const std::filesystem::path& path,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		const auto header = std::format("P6\n{} {}\n255\n", extent.x, extent.y);
+		const auto header_size = static_cast<std::streamoff>(header.size());
+
+		{
+			auto header_stream = std::ofstream(path, std::ios::binary | std::ios::trunc);
+			header_stream.write(header.data(), header_size);
+			if (!header_stream) return Error("Write image header failed", path.string());
+		}
+
+		// Size the file up front, so that every region can be written at its final offset
+		std::error_code error_code;
+		const auto file_size = header.size() + size_t(extent.x) * extent.y * TEXEL_SIZE;
+		std::filesystem::resize_file(path, file_size, error_code);
+		if (error_code) return Error("Resize image file failed", error_code.message());
+
+		auto stream = std::fstream(path, std::ios::binary | std::ios::in | std::ios::out);
+		if (!stream) return Error("Open image file failed", path.string());
+
+		return ImageWriter(std::move(stream), header_size, extent);
+	}
+
+	void ImageWriter::write(
+		glm::u32vec2 offset,
+		glm::u32vec2 extent,
+		std::span<const std::byte> data,
+		size_t row_pitch
+	) noexcept
+	{
+		if (failed) return;
+
+		for (const auto y : std::views::iota(0u, extent.y))
+		{
+			const auto source_row =
+				data.subspan(y * row_pitch * SOURCE_TEXEL_SIZE, extent.x * SOURCE_TEXEL_SIZE);
+			for (const auto x : std::views::iota(0u, extent.x))
+				for (const auto channel : std::views::iota(0uz, TEXEL_SIZE))
+					row_buffer[x * TEXEL_SIZE + channel] = source_row[x * SOURCE_TEXEL_SIZE + channel];
+
+			const auto position = header_size
+				+ static_cast<std::streamoff>(
+					  ((size_t(offset.y) + y) * this->extent.x + offset.x) * TEXEL_SIZE
+				);
+			stream.seekp(position);
+			stream.write(
+				reinterpret_cast<const char*>(row_buffer.data()),
+				static_cast<std::streamsize>(extent.x * TEXEL_SIZE)
+			);
+		}
+
+		if (!stream) failed = true;
+	}
+
+	std::expected<void, Error> ImageWriter::finish() noexcept
+	{
+		stream.flush();
+		if (failed || !stream) return Error("Write image file failed");
+		return {};
+	}
+}
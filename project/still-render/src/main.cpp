@@ -0,0 +1,215 @@
+#include "bench/camera-path.hpp"
+#include "common/file.hpp"
+#include "common/json.hpp"
+#include "common/util/error.hpp"
+#include "render/model/mesh.hpp"
+#include "server/scene.hpp"
+#include "still/argument.hpp"
+#include "still/image-writer.hpp"
+#include "still/tile-renderer.hpp"
+#include "vulkan/context/device.hpp"
+#include "vulkan/context/instance.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <format>
+#include <glm/common.hpp>
+#include <glm/ext/vector_double2.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <iostream>
+#include <optional>
+#include <print>
+#include <ranges>
+#include <span>
+#include <utility>
+
+// Frames rendered over the whole view before the tiles, converging the auto exposure
+static constexpr uint32_t METERING_FRAME_COUNT = 60;
+
+// Exposure adaptation step of the metering frames, tiles then freeze the exposure with a zero step
+static constexpr float METERING_DELTA_TIME = 0.1f;
+
+static std::expected<bench::CameraPath, Error> load_camera_path(const still::Argument& argument) noexcept
+{
+	if (!argument.path_file.has_value()) return bench::CameraPath::orbit();
+
+	const auto content_result = file::read(*argument.path_file);
+	if (!content_result) return content_result.error().forward("Read camera path file failed");
+
+	const auto json = Json::parse(*content_result, nullptr, false);
+	if (json.is_discarded()) return Error("Parse camera path file failed", "Invalid JSON");
+
+	return bench::CameraPath::from_json(json);
+}
+
+// Meter the exposure over the whole view, scaled into a single tile. The exposure only depends on the
+// luminance histogram, so the distorted aspect ratio does not matter.
+static std::expected<void, Error> meter_exposure(
+	const vulkan::Context& context,
+	still::TileRenderer& renderer,
+	bench::CameraPath& camera_path,
+	const still::Argument& argument,
+	glm::u32vec2 tile_extent
+) noexcept
+{
+	for (const auto frame_index : std::views::iota(0u, METERING_FRAME_COUNT))
+	{
+		const auto camera = camera_path.sample_tile(
+			argument.time,
+			argument.extent,
+			glm::dvec2(-1.0),
+			glm::dvec2(1.0),
+			tile_extent
+		);
+
+		const auto result =
+			renderer.render_frame(context, camera, METERING_DELTA_TIME, frame_index > 0, std::nullopt);
+		if (!result) return result.error().forward("Render metering frame failed");
+	}
+
+	return {};
+}
+
+// Render every tile with its guard band, accumulating `frame_count` jittered frames and writing the
+// visible part of the last one. At most `TileRenderer::FRAME_RESOURCE_COUNT` tiles are in flight.
+static std::expected<void, Error> render_tiles(
+	const vulkan::Context& context,
+	still::TileRenderer& renderer,
+	still::ImageWriter& writer,
+	bench::CameraPath& camera_path,
+	const still::Argument& argument,
+	glm::u32vec2 tile_extent
+) noexcept
+{
+	const auto image_extent = glm::dvec2(argument.extent);
+	const auto guard = argument.guard_size;
+	const auto tile_count = (argument.extent + argument.tile_size - 1u) / argument.tile_size;
+
+	for (const auto tile_y : std::views::iota(0u, tile_count.y))
+		for (const auto tile_x : std::views::iota(0u, tile_count.x))
+		{
+			const auto offset = glm::u32vec2(tile_x, tile_y) * argument.tile_size;
+			const auto visible_extent = glm::min(glm::u32vec2(argument.tile_size), argument.extent - offset);
+
+			// Pixel edges map linearly onto NDC, the rendered rectangle includes the guard band
+			const auto pixel_min = glm::dvec2(offset) - static_cast<double>(guard);
+			const auto pixel_max = pixel_min + glm::dvec2(tile_extent);
+			const auto ndc_min = pixel_min / image_extent * 2.0 - 1.0;
+			const auto ndc_max = pixel_max / image_extent * 2.0 - 1.0;
+
+			for (const auto frame_index : std::views::iota(0u, argument.frame_count))
+			{
+				const auto camera =
+					camera_path.sample_tile(argument.time, argument.extent, ndc_min, ndc_max, tile_extent);
+
+				auto readback = std::optional<vulkan::ReadbackRing::Callback>();
+				if (frame_index + 1 == argument.frame_count)
+					readback = [&writer, offset, visible_extent, guard, tile_extent](
+								   std::span<const std::byte> data
+							   ) {
+						const auto guard_offset =
+							(size_t(guard) * tile_extent.x + guard) * still::TileRenderer::TEXEL_SIZE;
+						writer.write(offset, visible_extent, data.subspan(guard_offset), tile_extent.x);
+					};
+
+				const auto result =
+					renderer.render_frame(context, camera, 0.0f, frame_index > 0, std::move(readback));
+				if (!result)
+					return result.error().forward(std::format("Render tile ({}, {}) failed", tile_x, tile_y));
+			}
+		}
+
+	return {};
+}
+
+static std::expected<void, Error> run(const still::Argument& argument) noexcept
+{
+	/* Context */
+
+	auto instance_result =
+		vulkan::HeadlessInstanceContext::create({.application_name = "Vulkan-RT Still Render"});
+	if (!instance_result) return instance_result.error().forward("Create instance context failed");
+	auto instance = std::move(*instance_result);
+
+	auto device_result = vulkan::HeadlessDeviceContext::create(instance, {.raytracing = true}, ".cache");
+	if (!device_result) return device_result.error().forward("Create device context failed");
+	auto device = std::move(*device_result);
+
+	const auto context = device.get();
+
+	/* Load */
+
+	auto scene_result = server::Scene::create(
+		context,
+		argument.model_path,
+		argument.packed_vertex ? render::VertexFormat::Packed : render::VertexFormat::Full,
+		false
+	);
+	if (!scene_result) return scene_result.error().forward("Load scene failed");
+	const auto scene = std::move(*scene_result);
+
+	auto camera_path_result = load_camera_path(argument);
+	if (!camera_path_result) return camera_path_result.error().forward("Load camera path failed");
+	auto camera_path = std::move(*camera_path_result);
+
+	const auto tile_extent = glm::u32vec2(argument.tile_size + 2 * argument.guard_size);
+
+	auto renderer_result = still::TileRenderer::create(context, scene, tile_extent);
+	if (!renderer_result) return renderer_result.error().forward("Create tile renderer failed");
+	auto renderer = std::move(*renderer_result);
+
+	auto writer_result = still::ImageWriter::create(argument.output_path, argument.extent);
+	if (!writer_result) return writer_result.error().forward("Create image writer failed");
+	auto writer = std::move(*writer_result);
+
+	/* Render */
+
+	const auto start_time = std::chrono::steady_clock::now();
+
+	if (const auto result = meter_exposure(context, renderer, camera_path, argument, tile_extent); !result)
+		return result.error().forward("Meter exposure failed");
+
+	if (const auto result = render_tiles(context, renderer, writer, camera_path, argument, tile_extent);
+		!result)
+		return result.error().forward("Render tiles failed");
+
+	if (const auto result = renderer.finish(context); !result)
+		return result.error().forward("Finish tile renderer failed");
+
+	if (const auto result = writer.finish(); !result) return result.error().forward("Write image failed");
+
+	const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	std::println(
+		"Rendered {}x{} to {} in {:.2f}s",
+		argument.extent.x,
+		argument.extent.y,
+		argument.output_path,
+		seconds
+	);
+
+	return {};
+}
+
+int main(int argc, const char* argv[]) noexcept
+{
+	const auto argument_result = still::Argument::parse(std::span<const char*>(argv, argc));
+	if (!argument_result)
+	{
+		std::println(std::cerr, "{}", argument_result.error()->message);
+		if (argument_result.error()->detail) std::println(std::cerr, "{}", *argument_result.error()->detail);
+		return EXIT_FAILURE;
+	}
+
+	if (const auto result = run(*argument_result); !result)
+	{
+		std::println(std::cerr, "Error: {}", result.error().root());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
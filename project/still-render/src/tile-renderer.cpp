@@ -0,0 +1,387 @@
+#include "still/tile-renderer.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/pipeline/bloom.hpp"
+#include "render/pipeline/hiz.hpp"
+#include "render/resource/ambient-occlusion.hpp"
+#include "render/resource/indirect.hpp"
+#include "resource/render-resource.hpp"
+#include "resource/sync-primitive.hpp"
+#include "server/scene.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/container/device/readback-ring.hpp"
+#include "vulkan/container/host/cycle.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace still
+{
+	namespace
+	{
+		// LODs are never generated for stills, a non-positive threshold always selects the full geometry
+		constexpr float LOD_THRESHOLD = 0.0f;
+	}
+
+	std::expected<TileRenderer, Error> TileRenderer::create(
+		const vulkan::Context& context,
+		const server::Scene& scene,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		auto command_pool_result = context.device.createCommandPool({
+			.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+			.queueFamilyIndex = context.family,
+		});
+		if (!command_pool_result) return Error::from(command_pool_result);
+		auto command_pool = std::move(*command_pool_result);
+
+		auto command_buffers_result = context.device.allocateCommandBuffers({
+			.commandPool = command_pool,
+			.commandBufferCount = FRAME_RESOURCE_COUNT,
+		});
+		if (!command_buffers_result) return Error::from(command_buffers_result);
+		auto command_buffers = std::move(*command_buffers_result);
+
+		auto render_resources_result =
+			std::views::repeat(resource::RenderResource::create, FRAME_RESOURCE_COUNT)
+			| std::views::transform([&context](auto f) { return f(context); })
+			| Error::collect();
+		if (!render_resources_result)
+			return render_resources_result.error().forward("Create render resources failed");
+		auto render_resources = std::move(*render_resources_result);
+
+		// No attachments exist yet, nothing is retired
+		auto deletion_queue = vulkan::DeletionQueue(FRAME_RESOURCE_COUNT);
+		for (auto& render_resource : render_resources)
+		{
+			const auto result = render_resource.resize_attachments(
+				context,
+				deletion_queue,
+				extent,
+				extent,
+				true,
+				render::AmbientOcclusionAttachment::Resolution::Quarter
+			);
+			if (!result) return result.error().forward("Create render attachments failed");
+		}
+
+		auto sync_primitives_result =
+			std::views::repeat(resource::FrameSyncPrimitive::create, FRAME_RESOURCE_COUNT)
+			| std::views::transform([&context](auto f) { return f(context); })
+			| Error::collect();
+		if (!sync_primitives_result)
+			return sync_primitives_result.error().forward("Create sync primitives failed");
+		auto sync_primitives = std::move(*sync_primitives_result);
+
+		auto resource_sets_result = scene.pipeline.create_resource_sets(context, FRAME_RESOURCE_COUNT);
+		if (!resource_sets_result) return resource_sets_result.error().forward("Create resource sets failed");
+		auto resource_sets = std::move(*resource_sets_result);
+
+		auto frame_resources =
+			std::views::zip_transform(
+				CTOR_LAMBDA(FrameResource),
+				command_buffers | std::views::as_rvalue,
+				render_resources | std::views::as_rvalue,
+				resource_sets | std::views::as_rvalue,
+				sync_primitives | std::views::as_rvalue
+			)
+			| vulkan::Cycle<FrameResource>::into;
+
+		auto readback_ring_result = vulkan::ReadbackRing::create(
+			context,
+			FRAME_RESOURCE_COUNT,
+			size_t(extent.x) * extent.y * TEXEL_SIZE
+		);
+		if (!readback_ring_result) return readback_ring_result.error().forward("Create readback ring failed");
+
+		auto target_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			server::Scene::TARGET_FORMAT,
+			vk::ImageUsageFlagBits::eTransferSrc
+		);
+		if (!target_result) return target_result.error().forward("Create offscreen target failed");
+
+		return TileRenderer(
+			scene,
+			extent,
+			std::move(command_pool),
+			std::move(frame_resources),
+			std::move(*readback_ring_result),
+			std::move(*target_result)
+		);
+	}
+
+	std::expected<void, Error> TileRenderer::render_frame(
+		const vulkan::Context& context,
+		const render::Camera& camera,
+		float delta_time,
+		bool history_valid,
+		std::optional<vulkan::ReadbackRing::Callback> readback
+	) noexcept
+	{
+		frame_resources.cycle();
+		auto& frame = frame_resources.current();
+		const auto& prev_frame = frame_resources.prev();
+
+		if (frame.submitted)
+		{
+			const auto wait_result = context.device.waitForFences(
+				*frame.sync_primitive.draw_fence,
+				vk::True,
+				std::numeric_limits<uint64_t>::max()
+			);
+			if (wait_result != vk::Result::eSuccess) return Error::from(wait_result);
+		}
+
+		deletion_queue.advance();
+		if (const auto result = readback_ring.begin_frame(); !result)
+			return result.error().forward("Read back tile failed");
+
+		/* Update & Bind */
+
+		const auto& model = scene->model;
+
+		const auto render_data = resource::RenderData{
+			.drawcall_counts = model.scene_graph.drawcall_counts(),
+			.blended_drawcall_counts = model.scene_graph.drawcall_counts(render::SceneGraph::Bucket::Blended),
+			.node_count = model.scene_graph->node_count,
+			.primitive_count = model.mesh_list->primitive_attr_array.size(),
+			.material_count = model.material_list.material_count(),
+			.transform_updates = {},
+			.root_transform = glm::mat4(1.0f),
+			.camera = camera,
+			.primary_light = primary_light.get(),
+			.exposure_param = exposure.get(delta_time, extent),
+		};
+
+		if (const auto result = frame.render_resource.update(context, deletion_queue, render_data); !result)
+			return result.error().forward("Update render resource failed");
+
+		frame.resource_set.update(
+			context,
+			model,
+			scene->tlas,
+			frame.render_resource,
+			prev_frame.render_resource,
+			scene->aux_resource,
+			scene->gi_probe_volume,
+			scene->environment_lighting,
+			scene->pipeline.atmosphere.get_lut_view(),
+			std::nullopt,
+			std::nullopt
+		);
+
+		/* Record */
+
+		if (const auto result = frame.command_buffer.begin({}); !result) return Error::from(result);
+
+		record(frame, prev_frame, history_valid);
+
+		if (readback.has_value())
+		{
+			const auto read_result = readback_ring.read_image(
+				context,
+				frame.command_buffer,
+				vulkan::AttachmentView(target).image,
+				vk::ImageLayout::eTransferSrcOptimal,
+				vk::ImageAspectFlagBits::eColor,
+				extent,
+				TEXEL_SIZE,
+				std::move(*readback)
+			);
+			if (!read_result) return read_result.error().forward("Record tile readback failed");
+		}
+
+		if (const auto barrier = readback_ring.host_barrier())
+			frame.command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(*barrier));
+
+		if (const auto result = frame.command_buffer.end(); !result) return Error::from(result);
+
+		/* Submit */
+
+		const auto command_buffer_submit_info = vk::CommandBufferSubmitInfo{
+			.commandBuffer = frame.command_buffer,
+		};
+		const auto submit_info = vk::SubmitInfo2().setCommandBufferInfos(command_buffer_submit_info);
+
+		if (const auto result = context.device.resetFences(*frame.sync_primitive.draw_fence); !result)
+			return Error::from(result);
+
+		{
+			const std::scoped_lock lock(context.submit_mutex);
+			if (const auto result = context.queue.submit2(submit_info, frame.sync_primitive.draw_fence);
+				!result)
+				return Error::from(result);
+		}
+
+		frame.submitted = true;
+
+		return {};
+	}
+
+	std::expected<void, Error> TileRenderer::finish(const vulkan::Context& context) noexcept
+	{
+		if (const auto result = context.device.waitIdle(); !result) return Error::from(result);
+
+		// Visit every slot once, oldest first, delivering the frames still pending in the ring
+		for ([[maybe_unused]] const auto _ : std::views::iota(0u, FRAME_RESOURCE_COUNT))
+			if (const auto result = readback_ring.begin_frame(); !result)
+				return result.error().forward("Read back tile failed");
+
+		return {};
+	}
+
+	void TileRenderer::record(FrameResource& frame, const FrameResource& prev_frame, bool history_valid)
+		const noexcept
+	{
+		const auto& pipeline = scene->pipeline;
+		const auto& command_buffer = frame.command_buffer;
+
+		frame.render_resource.upload(command_buffer);
+
+		// Previous HiZ is never built, transition it so that it can still be bound
+		if (!history_valid)
+			render::HizPipeline::discard(command_buffer, prev_frame.render_resource.attachments->hiz);
+
+		pipeline.transform.compute(command_buffer, frame.resource_set.transform);
+
+		// Variable rate shading is not used, the cleared rates shade every pixel at full rate
+		pipeline.shading_rate.clear(command_buffer, frame.resource_set.shading_rate);
+
+		record_phase(frame, render::DrawPhase::Early, history_valid);
+		record_phase(frame, render::DrawPhase::Late, history_valid);
+
+		pipeline.light_cluster.compute(command_buffer, frame.resource_set.light_cluster);
+		pipeline.shadow.compute(command_buffer, frame.resource_set.shadow);
+
+		// Ambient occlusion is not used, the cleared output keeps the lighting bindings valid
+		pipeline.ambient_occlusion.clear(command_buffer, frame.resource_set.ambient_occlusion);
+
+		pipeline.direct_lighting.compute(command_buffer, frame.resource_set.direct_lighting);
+
+		for (const auto phase : {render::DrawPhase::Early, render::DrawPhase::Late})
+			pipeline.indirect.compute(
+				command_buffer,
+				frame.resource_set.blended_indirect,
+				phase,
+				history_valid,
+				LOD_THRESHOLD
+			);
+		pipeline.transparent.render(command_buffer, frame.resource_set.transparent);
+
+		pipeline.auto_exposure.compute(command_buffer, frame.resource_set.auto_exposure);
+		pipeline.taa.compute(command_buffer, frame.resource_set.taa, history_valid);
+
+		// Composited without bloom, the chain is only transitioned so that it can still be bound
+		render::BloomPipeline::discard(command_buffer, frame.render_resource.attachments->bloom);
+
+		record_composite(frame);
+	}
+
+	void TileRenderer::record_phase(FrameResource& frame, render::DrawPhase phase, bool history_valid)
+		const noexcept
+	{
+		const auto& pipeline = scene->pipeline;
+		const auto& command_buffer = frame.command_buffer;
+
+		pipeline.indirect.compute(
+			command_buffer,
+			frame.resource_set.indirect,
+			phase,
+			history_valid,
+			LOD_THRESHOLD
+		);
+		pipeline.deferred.render(command_buffer, frame.resource_set.deferred, phase);
+		pipeline.hiz.compute(command_buffer, frame.resource_set.hiz);
+	}
+
+	void TileRenderer::record_composite(FrameResource& frame) const noexcept
+	{
+		const auto& command_buffer = frame.command_buffer;
+		const auto target_view = vulkan::AttachmentView(target);
+
+		const auto target_barrier = [&target_view](
+										vk::PipelineStageFlags2 src_stage,
+										vk::AccessFlags2 src_access,
+										vk::PipelineStageFlags2 dst_stage,
+										vk::AccessFlags2 dst_access,
+										vk::ImageLayout old_layout,
+										vk::ImageLayout new_layout
+									) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = src_stage,
+				.srcAccessMask = src_access,
+				.dstStageMask = dst_stage,
+				.dstAccessMask = dst_access,
+				.oldLayout = old_layout,
+				.newLayout = new_layout,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = target_view.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		};
+
+		// Previous content of the target is never read, but its last readback must complete first
+		const auto pre_composite_barrier = target_barrier(
+			vk::PipelineStageFlagBits2::eCopy,
+			vk::AccessFlagBits2::eNone,
+			vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			vk::AccessFlagBits2::eColorAttachmentWrite,
+			vk::ImageLayout::eUndefined,
+			vk::ImageLayout::eColorAttachmentOptimal
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_composite_barrier));
+
+		const auto rendering_area = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(extent)
+		};
+
+		const auto target_attachment = vk::RenderingAttachmentInfo{
+			.imageView = target_view.view,
+			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.loadOp = vk::AttachmentLoadOp::eClear,
+			.storeOp = vk::AttachmentStoreOp::eStore,
+			.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f)
+		};
+
+		const auto rendering_info =
+			vk::RenderingInfo{.renderArea = rendering_area, .layerCount = 1}
+				.setColorAttachments(target_attachment);
+
+		command_buffer.beginRendering(rendering_info);
+		scene->pipeline.composite.render(command_buffer, frame.resource_set.composite);
+		command_buffer.endRendering();
+
+		// Read back by the readback ring right after
+		const auto post_composite_barrier = target_barrier(
+			vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			vk::AccessFlagBits2::eColorAttachmentWrite,
+			vk::PipelineStageFlagBits2::eCopy,
+			vk::AccessFlagBits2::eTransferRead,
+			vk::ImageLayout::eColorAttachmentOptimal,
+			vk::ImageLayout::eTransferSrcOptimal
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_composite_barrier));
+	}
+}
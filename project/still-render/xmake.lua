@@ -0,0 +1,36 @@
+-- Tiled offline still renderer, renders one view of the camera path at a resolution above the device limit
+
+-- Offscreen tile renderer and image writer, shared with the batch renderer
+target("still.render.common")
+	set_kind("static")
+	set_default(false)
+
+	add_deps("lib.common", "render", "main.common", "server.render.common", {public = true})
+
+	add_files("src/tile-renderer.cpp", "src/image-writer.cpp")
+	add_includedirs("include", {public = true})
+	add_headerfiles("include/still/tile-renderer.hpp", "include/still/image-writer.hpp")
+
+target("still.render")
+	set_kind("binary")
+	set_default(false)
+
+	add_deps(
+		"lib.common",
+		"lib.scene",
+		"vulkan.util",
+		"vulkan.alloc",
+		"vulkan.context",
+		"model.gltf",
+		"render",
+		"main.common",
+		"bench.render.common",
+		"server.render.common",
+		"still.render.common"
+	)
+
+	add_files("src/**.cpp|tile-renderer.cpp|image-writer.cpp")
+	add_includedirs("include")
+	add_headerfiles("include/**.hpp")
+
+	add_packages("argparse")
@@ -7,8 +7,13 @@
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <span>
+#include <stop_token>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -16,14 +21,15 @@
 namespace render::impl
 {
 	///
-	/// @brief BLAS prototype for a mesh
+	/// @brief BLAS prototype for a mesh, holding everything needed to allocate and build the BLAS
 	///
 	///
 	struct MeshBlasPrototype
 	{
-		vulkan::Buffer buffer;
-		vk::raii::AccelerationStructureKHR blas;
+		vk::DeviceSize blas_size;
 		vk::DeviceSize scratch_size;
+		vk::DeviceSize update_scratch_size;  // Only meaningful with `eAllowUpdate`
+		vk::BuildAccelerationStructureFlagsKHR build_flags;
 
 		/* Per-geometry info */
 
@@ -32,39 +38,82 @@ namespace render::impl
 
 		///
 		/// @brief Create BLAS prototype for a mesh
+		/// @note Only queries the build sizes, storage of the BLAS is allocated by `build_blas`. Safe to call
+		/// from multiple threads
 		///
 		/// @param context Vulkan context
 		/// @param material_list Material list
 		/// @param primitive_attrs Primitive attributes in the entire mesh-list
-		/// @param vertex_buffer_addr Base address of the vertex buffer
-		/// @param index_buffer_addr Base address of the index buffer
+		/// @param position_buffer_addr Base address of the fp32 position stream, see `MeshList::Ref`
+		/// @param position_stride Stride of the position stream
+		/// @param index_buffer_addr Base address of the index buffer, indices are read at the size recorded
+		/// in each primitive attribute
 		/// @param mesh Mesh primitive index range
+		/// @param build_flags Build preference flags, e.g. `ePreferFastTrace`
+		/// @param allow_compaction Whether to build with `eAllowCompaction`
 		/// @return Mesh BLAS prototype
 		///
 		[[nodiscard]]
-		static std::expected<MeshBlasPrototype, Error> create(
+		static MeshBlasPrototype create(
 			const vulkan::Context& context,
 			const MaterialList& material_list,
 			std::span<const PrimitiveAttribute> primitive_attrs,
-			vk::DeviceAddress vertex_buffer_addr,
+			vk::DeviceAddress position_buffer_addr,
+			vk::DeviceSize position_stride,
 			vk::DeviceAddress index_buffer_addr,
-			PrimitiveIndexRange mesh
+			PrimitiveIndexRange mesh,
+			vk::BuildAccelerationStructureFlagsKHR build_flags,
+			bool allow_compaction
 		) noexcept;
 	};
 
 	///
-	/// @brief Create BLAS prototypes for all primitives in the mesh list
+	/// @brief Meshes grouped by identical geometry, see `BlasList`
 	///
+	struct BlasSharing
+	{
+		std::vector<uint32_t> mesh_blas_index;  // Index of the BLAS of each mesh
+		std::vector<uint32_t> blas_mesh_index;  // Index of the mesh each BLAS is created from
+	};
+
+	///
+	/// @brief Group meshes with identical geometry, so that they share a BLAS
+	/// @details Meshes are grouped by geometry hash, then primitive sizes and opaqueness are compared
+	/// exactly to rule out hash collisions and geometry flag mismatches
+	///
+	/// @param mesh_list Mesh list
+	/// @param material_list Material list
+	/// @param exclusive_meshes Meshes never sharing their BLAS, e.g. deformed meshes whose BLAS is refit
+	/// @return Grouped meshes
+	///
+	[[nodiscard]]
+	BlasSharing share_blas(
+		const MeshList& mesh_list,
+		const MaterialList& material_list,
+		std::span<const uint32_t> exclusive_meshes = {}
+	) noexcept;
+
+	///
+	/// @brief Create BLAS prototypes for meshes in the mesh list, in parallel batches on @p thread_pool
+	///
+	/// @param thread_pool Thread pool
 	/// @param context Vulkan context
 	/// @param mesh_list Mesh list
 	/// @param material_list Material list
-	/// @return Array of prototypes, where indices correspond to the attribute array in mesh list
+	/// @param meshes Indices of the meshes to create prototypes for, see `BlasSharing::blas_mesh_index`
+	/// @param build_flags Build preference flags, e.g. `ePreferFastTrace`
+	/// @param allow_compaction Whether to build with `eAllowCompaction`
+	/// @return Array of prototypes, where indices correspond to @p meshes
 	///
 	[[nodiscard]]
-	std::expected<std::vector<MeshBlasPrototype>, Error> create_blas(
+	coro::task<std::vector<MeshBlasPrototype>> create_blas(
+		coro::thread_pool& thread_pool,
 		const vulkan::Context& context,
 		const MeshList& mesh_list,
-		const MaterialList& material_list
+		const MaterialList& material_list,
+		std::span<const uint32_t> meshes,
+		vk::BuildAccelerationStructureFlagsKHR build_flags,
+		bool allow_compaction
 	) noexcept;
 
 	///
@@ -73,19 +122,93 @@ namespace render::impl
 	///
 	struct BuildBlasResult
 	{
-		std::vector<BlasList::AccelStruct> blas_list;
+		std::vector<vulkan::Buffer> buffers;  // Storage shared by the BLASes
+		std::vector<vk::raii::AccelerationStructureKHR> blas_list;
+		BlasList::MemoryStat memory_stat;
 	};
 
 	///
-	/// @brief Build BLASes
+	/// @brief Allocate and build BLASes
+	/// @details Storage of the BLASes is suballocated from a few large buffers, instead of one allocation
+	/// per BLAS. When compacting, each buffer is released once all BLASes in it are compacted.
 	///
 	/// @param context Vulkan context
 	/// @param prototypes Prototypes to be built
+	/// @param compact Whether to compact the BLASes after building, prototypes must be created with
+	/// `allow_compaction` set
+	/// @param stop_token Stop token, checked between batches. Fails after the batch in flight completes
 	/// @return Array of built BLASes
 	///
 	[[nodiscard]]
 	std::expected<BuildBlasResult, Error> build_blas(
 		const vulkan::Context& context,
-		std::vector<MeshBlasPrototype> prototypes
+		std::span<const MeshBlasPrototype> prototypes,
+		bool compact,
+		std::stop_token stop_token
+	) noexcept;
+
+	///
+	/// @brief BLASes serialized into host memory, see `BlasList::Serialized`
+	///
+	struct SerializedBlas
+	{
+		std::vector<std::byte> data;
+		std::vector<uint64_t> offsets;  // Offset of each BLAS in `data`, followed by the size of `data`
+	};
+
+	///
+	/// @brief Serialize built BLASes into host memory
+	/// @details Serialized sizes are queried first, then the BLASes are copied with `eSerialize` into a
+	/// host-readable buffer on the async compute queue, each starting at a 256-byte aligned offset
+	///
+	/// @param context Vulkan context
+	/// @param blas_list Built BLASes, not written by the GPU while serializing
+	/// @return Serialized BLASes, or error
+	///
+	[[nodiscard]]
+	std::expected<SerializedBlas, Error> serialize_blas(
+		const vulkan::Context& context,
+		std::span<const vk::raii::AccelerationStructureKHR> blas_list
+	) noexcept;
+
+	///
+	/// @brief Deserialize BLASes written by `serialize_blas`
+	/// @details Every BLAS is checked against the device with `getAccelerationStructureCompatibilityKHR`
+	/// before anything is allocated. Storage is suballocated like `build_blas`, sized from the
+	/// deserialized size recorded in each serialized header.
+	///
+	/// @param context Vulkan context
+	/// @param data Serialized BLASes
+	/// @param offsets Offset of each BLAS in @p data, followed by the size of @p data. Offsets must be
+	/// 256-byte aligned
+	/// @return Deserialized BLASes, or error if any BLAS is malformed or incompatible with the device
+	///
+	[[nodiscard]]
+	std::expected<BuildBlasResult, Error> deserialize_blas(
+		const vulkan::Context& context,
+		std::span<const std::byte> data,
+		std::span<const uint64_t> offsets
+	) noexcept;
+
+	///
+	/// @brief Scratch memory for refitting BLASes, see `BlasList::refit`
+	///
+	struct RefitScratch
+	{
+		vulkan::Buffer buffer;
+		std::vector<vk::DeviceAddress> addresses;  // Aligned scratch address of each refit
+	};
+
+	///
+	/// @brief Allocate scratch memory for refitting several BLASes in a single build command
+	///
+	/// @param context Vulkan context
+	/// @param update_scratch_sizes Update scratch size of each BLAS, see `MeshBlasPrototype`
+	/// @return Scratch memory, or error
+	///
+	[[nodiscard]]
+	std::expected<RefitScratch, Error> create_refit_scratch(
+		const vulkan::Context& context,
+		std::span<const vk::DeviceSize> update_scratch_sizes
 	) noexcept;
 }
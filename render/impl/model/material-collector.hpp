@@ -4,12 +4,16 @@
 #include "model/material.hpp"
 #include "model/texture.hpp"
 #include "render/model/material.hpp"
+#include "render/model/sampler-cache.hpp"
 #include "render/model/texture-list.hpp"
 #include "render/model/texture.hpp"
+#include "vulkan/interface/context.hpp"
 
 #include <cstdint>
 #include <expected>
 #include <map>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -20,12 +24,27 @@ namespace render::impl
 {
 	///
 	/// @brief Material collector
-	/// @details Collect materials, arrange its image views and samplers as linear array
+	/// @details Collect materials, arrange its image views and samplers as linear array. Samplers are taken
+	/// from a `SamplerCache` shared with other material lists
 	///
 	class MaterialCollector
 	{
 	  public:
 
+		///
+		/// @brief Create a material collector
+		///
+		/// @param sampler_cache Sampler cache, must outlive the collector
+		/// @param sampler_policy Sampling policy of all samplers
+		///
+		explicit MaterialCollector(
+			SamplerCache& sampler_cache,
+			SamplerCache::Policy sampler_policy
+		) noexcept :
+			sampler_cache(sampler_cache),
+			sampler_policy(sampler_policy)
+		{}
+
 		///
 		/// @brief Result of material collection
 		/// @details Call `std::move(collector).collect()` to obtain the result
@@ -33,8 +52,11 @@ namespace render::impl
 		struct Result
 		{
 			std::vector<vk::raii::ImageView> textures;
-			std::vector<vk::raii::Sampler> samplers;
+			std::vector<std::shared_ptr<const vk::raii::Sampler>> samplers;
 			std::vector<std::pair<vk::ImageView, vk::Sampler>> combined;
+
+			// Source of each combined descriptor, `std::nullopt` for fallback and error hint textures
+			std::vector<std::optional<TextureSource>> sources;
 		};
 
 		///
@@ -49,28 +71,31 @@ namespace render::impl
 		///
 		/// @brief Add a material's textures to the collector and get the corresponding texture index
 		///
-		/// @param device Vulkan device
+		/// @param context Vulkan context
 		/// @param texture_list Texture list to get texture references from
 		/// @param texture_set CPU-side texture set to collect
 		/// @return Texture index for the collected material, or error
 		///
 		[[nodiscard]]
 		std::expected<TextureIndex, Error> add_material(
-			const vk::raii::Device& device,
+			const vulkan::Context& context,
 			const TextureList& texture_list,
 			const model::TextureSet& texture_set
 		) noexcept;
 
 	  private:
 
+		SamplerCache& sampler_cache;
+		SamplerCache::Policy sampler_policy;
+
 		// Array of textures
 		std::vector<vk::raii::ImageView> textures;
 
 		// Maps texture reference and usage to texture index in `textures`, for caching
 		std::map<std::pair<Texture::Ref, Texture::Usage>, uint32_t> texture_indices;
 
-		// Array of samplers
-		std::vector<vk::raii::Sampler> samplers;
+		// Array of samplers, shared through `sampler_cache`
+		std::vector<std::shared_ptr<const vk::raii::Sampler>> samplers;
 
 		// Maps sample mode to sampler index in `samplers`, for caching
 		std::map<model::SampleMode, uint32_t> sampler_indices;
@@ -81,11 +106,13 @@ namespace render::impl
 		// Maps texture index and sampler index to combined index in `combined`, for caching
 		std::map<std::pair<uint32_t, uint32_t>, uint32_t> combined_indices;
 
+		// Sources of combined descriptors, one-to-one corresponding to `combined`
+		std::vector<std::optional<TextureSource>> sources;
+
 		std::expected<uint32_t, Error> add_texture(
-			const vk::raii::Device& device,
-			Texture::Ref texture_ref,
-			Texture::Usage usage,
-			model::SampleMode sample_mode
+			const vulkan::Context& context,
+			const TextureList::TextureResult& texture,
+			Texture::Usage usage
 		) noexcept;
 	};
 }
@@ -14,12 +14,16 @@ namespace render::impl
 	///
 	/// @param device Vulkan device
 	/// @param sample_mode Sample mode
+	/// @param max_anisotropy Maximum anisotropy within the device limit, `1` disables anisotropic filtering
+	/// @param lod_bias Bias added to the computed mip level
 	/// @return Created sampler, or error
 	///
 	[[nodiscard]]
 	std::expected<vk::raii::Sampler, Error> to_sampler(
 		const vk::raii::Device& device,
-		model::SampleMode sample_mode
+		model::SampleMode sample_mode,
+		float max_anisotropy,
+		float lod_bias
 	) noexcept;
 
 	///
@@ -3,6 +3,7 @@
 #include "scene/camera.hpp"
 
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float2.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <glm/glm.hpp>
 
@@ -18,5 +19,6 @@ namespace render
 		glm::mat4 view_projection;
 		glm::vec3 camera_pos;
 		glm::vec3 prev_camera_pos;
+		glm::vec2 jitter;  // Sub-pixel offset of the rasterized geometry in NDC, see `TaaPipeline`
 	};
 }
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/glm.hpp>
+
+namespace render
+{
+	///
+	/// @brief Additional view culled by the indirect pipeline alongside the main camera, e.g. a shadow
+	/// cascade or a reflection probe face
+	/// @note Additional views are frustum culled only, without occlusion culling
+	///
+	struct CullView
+	{
+		glm::mat4 view_projection;  // Drawcalls outside the clip volume of this matrix are culled
+	};
+}
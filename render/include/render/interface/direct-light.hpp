@@ -13,5 +13,7 @@ namespace render
 		glm::vec3 direction;   // Direction of the light
 		glm::vec3 light;       // RGB intensity of the light
 		float sin_half_angle;  // Sine of half the angle of the light cone
+
+		bool operator==(const DirectLight&) const noexcept = default;
 	};
 }
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace render
+{
+	///
+	/// @brief An emissive triangle of a primitive instanced at a node, picked by an alias table
+	/// @details Entry `i` is picked with `probability`. To sample, draw `u` in `[0, 1)`, take entry
+	/// `floor(u * count)`, and keep it if the fraction of `u * count` is below `alias_threshold`, otherwise
+	/// take entry `alias`.
+	///
+	struct EmissiveTriangle
+	{
+		uint32_t node_index;       // Index of the node, vertices are transformed by its world transform
+		uint32_t primitive_index;  // Index into the primitive attributes the TLAS is built from
+		uint32_t triangle;         // Index of the triangle within the primitive
+		float probability;         // Probability of picking this entry
+		float alias_threshold;     // Chance of keeping this entry over `alias` once its slot is drawn
+		uint32_t alias;            // Entry taken in place of this one
+	};
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/ext/vector_float3.hpp>
+
+namespace render
+{
+	///
+	/// @brief GPU representation of `model::HlodCluster`
+	/// @details Bounds are in the space of the proxy node, so they follow its transform
+	///
+	struct HlodCluster
+	{
+		glm::vec3 aabb_min;
+		uint32_t proxy_node_index;
+		glm::vec3 aabb_max;
+		uint32_t padding = 0;
+	};
+
+	// Per-node HLOD entry of a node outside any cluster
+	inline constexpr uint32_t NO_HLOD = 0xFFFFFFFF;
+
+	// Set in the per-node HLOD entry of a proxy node, cleared for a source node of the cluster
+	inline constexpr uint32_t HLOD_PROXY_BIT = 0x80000000;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/ext/vector_float3.hpp>
+
+namespace render
+{
+	///
+	/// @brief GPU representation of `model::Impostor`
+	/// @details Atlases of all impostors are stacked vertically in one image, see `ImpostorList`
+	///
+	struct Impostor
+	{
+		glm::vec3 center;        // Center of the bounding sphere, in mesh space
+		float radius;            // Radius of the bounding sphere, in mesh space
+		uint32_t atlas_index;    // Place of the atlas in the stack
+		uint32_t atlas_count;    // Atlases in the stack
+		uint32_t frame_count;    // Frames along each axis of the atlas
+		uint32_t padding = 0;
+	};
+
+	///
+	/// @brief A node drawn as an impostor, appended by `IndirectPipeline`
+	///
+	struct ImpostorInstance
+	{
+		uint32_t node_index;
+		uint32_t impostor_index;
+	};
+
+	// Per-primitive impostor entry of a primitive without impostor
+	inline constexpr uint32_t NO_IMPOSTOR = 0xFFFFFFFF;
+
+	// Set in the per-primitive impostor entry of the first primitive of a mesh, which appends the instance
+	inline constexpr uint32_t IMPOSTOR_FIRST_BIT = 0x80000000;
+}
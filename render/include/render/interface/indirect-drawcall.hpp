@@ -2,17 +2,47 @@
 
 #include "primitive-drawcall.hpp"
 
+#include <cstdint>
+#include <glm/ext/vector_float3.hpp>
 #include <vulkan/vulkan.hpp>
 
 namespace render
 {
 	///
 	/// @brief A drawcall for an indirect draw, containing both the draw command and the primitive information
-	/// @note `draw_command.firstInstance` is used for vertex shader to identify the drawcall
+	/// @note `draw_command.firstInstance` is used for vertex shader to identify the drawcall. Instanced
+	/// commands draw consecutive drawcalls, so the vertex shader reads the drawcall at
+	/// `firstInstance + instance index`
 	///
 	struct IndirectDrawcall
 	{
 		vk::DrawIndexedIndirectCommand draw_command;
 		PrimitiveDrawcall primitive_drawcall;
 	};
+
+	///
+	/// @brief Counters written by the indirect pass, one instance per render state
+	///
+	struct IndirectCount
+	{
+		uint32_t early_draw_count;      // Drawcalls visible in early phase
+		uint32_t late_draw_count;       // Drawcalls visible in late phase
+		uint32_t late_candidate_count;  // Drawcalls occluded in early phase, to be retested in late phase
+		uint32_t early_command_count;   // Instanced commands of early phase
+		uint32_t late_command_count;    // Instanced commands of late phase
+		uint32_t early_triangle_count;  // Triangles drawn in early phase, at the selected levels of detail
+		uint32_t late_triangle_count;   // Triangles drawn in late phase, at the selected levels of detail
+	};
+
+	///
+	/// @brief World-space bounds of a drawcall, written by the early phase of the indirect pass and reused by
+	/// the additional views and the late phase
+	///
+	struct DrawcallBounds
+	{
+		glm::vec3 center;  // Center of the world-space AABB and the bounding sphere
+		float radius;      // Radius of the bounding sphere
+		glm::vec3 extent;  // Half extent of the world-space AABB
+		float padding;
+	};
 }
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+
+namespace render
+{
+	///
+	/// @brief Update of the local transform of a single node
+	///
+	struct NodeTransformUpdate
+	{
+		glm::mat4 local_transform;  // New local transform of the node
+		uint32_t node_index;        // Index of the node to update
+	};
+}
@@ -9,6 +9,10 @@ namespace render
 	///
 	struct PrimitiveDrawcall
 	{
+		// Primitive index of a drawcall slot culled without being tested, e.g. a free or hidden instance slot
+		// of `InstanceList`
+		static constexpr uint32_t HIDDEN = 0xFFFFFFFF;
+
 		uint32_t node_index;       // Index of the node, used for selecting the correct transform
 		uint32_t primitive_index;  // Index of the primitive into global primitives
 	};
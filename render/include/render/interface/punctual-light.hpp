@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/ext/vector_float3.hpp>
+
+namespace render
+{
+	///
+	/// @brief A point or spot light placed at a node
+	/// @details The spot factor is `saturate(dot(-L, direction) * spot_scale + spot_offset)^2`. Point lights
+	/// use a scale of 0 and an offset of 1, so that the factor is always 1.
+	///
+	struct PunctualLight
+	{
+		glm::vec3 color;      // Linear RGB color premultiplied by intensity, in candela
+		float range;          // Distance where the light falls off to 0, always finite
+		uint32_t node_index;  // Index of the node, light is at the origin of the node and points to -Z
+		float spot_scale;     // Scale of the cosine to the spot direction
+		float spot_offset;    // Offset of the scaled cosine to the spot direction
+	};
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace render
+{
+	///
+	/// @brief Width and height of a light cluster tile in pixels
+	///
+	constexpr uint32_t LIGHT_CLUSTER_TILE_SIZE = 32;
+
+	///
+	/// @brief Number of depth slices of each light cluster tile
+	///
+	constexpr uint32_t LIGHT_CLUSTER_SLICE_COUNT = 32;
+
+	///
+	/// @brief Maximum number of lights in a light cluster, extra lights are dropped
+	///
+	constexpr uint32_t LIGHT_CLUSTER_MAX_LIGHTS = 32;
+}
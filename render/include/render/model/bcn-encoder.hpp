@@ -0,0 +1,124 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "image/bc-image.hpp"
+#include "render/model/texture.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-allocator.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief GPU BCn encoder, compresses uploaded RGBA8 mipmap chains into BCn textures with compute shaders
+	/// @details Trades quality for loading speed compared to the CPU encoder (see `image::BCnImage`): BC3
+	/// and BC5 use bounding-box endpoints, and BC7 is limited to mode 6. Used by `TextureList` when
+	/// `TextureList::LoadOption::gpu_encode` is set.
+	///
+	class BcnEncoder
+	{
+	  public:
+
+		///
+		/// @brief Uploaded texture to encode, see `Texture::Unencoded`
+		///
+		struct Source
+		{
+			vulkan::Image image;  // `eR8G8B8A8Unorm` image with `eSampled` usage, in `eShaderReadOnlyOptimal`
+			std::vector<glm::u32vec2> level_extents;  // Extent of each mipmap level, multiples of 4
+			image::BCnFormat format;
+			std::optional<float> min_alpha = std::nullopt;
+		};
+
+		///
+		/// @brief Create a GPU BCn encoder
+		///
+		/// @param context Vulkan context
+		/// @return Created encoder, or error
+		///
+		[[nodiscard]]
+		static std::expected<BcnEncoder, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Encode the sources into BCn textures, and wait for the encoding to complete
+		/// @note Output textures are left in `eShaderReadOnlyOptimal` layout, same as `Texture::upload`
+		/// @note Not thread-safe, descriptor sets of each call are allocated from the same allocator
+		///
+		/// @param context Vulkan context
+		/// @param sources Uploaded textures to encode, can be destroyed once this function returns
+		/// @param usage Vulkan image usage of the output textures
+		/// @return Encoded textures, one-to-one corresponding to @p sources, or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<Texture>, Error> encode(
+			const vulkan::Context& context,
+			std::span<const Source> sources,
+			vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled
+		) noexcept;
+
+		///
+		/// @brief Check if a format can be encoded on the GPU, only BC3, BC5 and BC7 have shaders
+		///
+		/// @param format Target format
+		/// @return `true` if supported, otherwise the texture must be encoded on the CPU
+		///
+		[[nodiscard]]
+		static constexpr bool supports(image::BCnFormat format) noexcept
+		{
+			return format == image::BCnFormat::BC3
+				|| format == image::BCnFormat::BC5
+				|| format == image::BCnFormat::BC7;
+		}
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 block_count;
+			uint32_t level;
+			uint32_t block_offset;
+			uint32_t format;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		// Must match `FORMAT_*` in `bcn-encode.slang`
+		static constexpr uint32_t FORMAT_BC3 = 0;
+		static constexpr uint32_t FORMAT_BC5 = 1;
+		static constexpr uint32_t FORMAT_BC7 = 2;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+		vulkan::DescriptorAllocator descriptor_allocator;  // Sets of the last batch, reset by the next one
+
+		explicit BcnEncoder(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline,
+			vulkan::DescriptorAllocator descriptor_allocator
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline)),
+			descriptor_allocator(std::move(descriptor_allocator))
+		{}
+
+	  public:
+
+		BcnEncoder(const BcnEncoder&) = delete;
+		BcnEncoder(BcnEncoder&&) = default;
+		BcnEncoder& operator=(const BcnEncoder&) = delete;
+		BcnEncoder& operator=(BcnEncoder&&) = default;
+	};
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/model/blas.hpp"
+#include "render/model/model-cache.hpp"
+#include "render/model/model.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <utility>
+
+namespace render
+{
+	///
+	/// @brief Versioned, memory-mapped file of serialized BLASes, see `BlasList::Serialized`
+	/// @details Sits next to a `ModelCache`, so that reloading a cached model deserializes its BLASes
+	/// instead of building them. The serialized data is device-specific: `open` only validates the file
+	/// and the key, compatibility with the device is checked by `BlasList::deserialize`. The caller is
+	/// expected to rebuild the BLASes and `write` the cache again if either fails.
+	///
+	class BlasCache
+	{
+	  public:
+
+		///
+		/// @brief Version of the file format, bump on any format change
+		///
+		static constexpr uint32_t VERSION = 1;
+
+		///
+		/// @brief Key identifying the content of a cache
+		///
+		struct Key
+		{
+			ModelCache::Key model;  // Key of the model cache the BLASes are built from
+			uint64_t option_hash;   // Hash of the options affecting the built BLASes
+
+			[[nodiscard]]
+			bool operator==(const Key&) const noexcept = default;
+		};
+
+		///
+		/// @brief Get the cache key for a model cache and loading options
+		///
+		/// @param model_key Key of the model cache
+		/// @param option Options used for loading, only those affecting the BLASes are hashed
+		/// @return Cache key
+		///
+		[[nodiscard]]
+		static Key get_key(ModelCache::Key model_key, const Model::Option& option) noexcept;
+
+		///
+		/// @brief Get the path of the BLAS cache next to a model cache
+		///
+		/// @param model_cache_path Path to the model cache file
+		/// @return Path to the BLAS cache file
+		///
+		[[nodiscard]]
+		static std::filesystem::path get_path(const std::filesystem::path& model_cache_path) noexcept;
+
+		///
+		/// @brief Open and validate a cache file
+		///
+		/// @param path Path to the cache file
+		/// @param key Expected key of the cache
+		/// @return Opened cache, or error if the file doesn't exist, is outdated or is corrupted
+		///
+		[[nodiscard]]
+		static std::expected<BlasCache, Error> open(const std::filesystem::path& path, Key key) noexcept;
+
+		///
+		/// @brief Write serialized BLASes into a cache file
+		/// @note The file is written to a temporary path first and then renamed, see `ModelCache::write`
+		///
+		/// @param path Path to the cache file, parent directories are created if needed
+		/// @param key Key of the cache
+		/// @param serialized Serialized BLASes
+		/// @return `void` on success, or error
+		///
+		[[nodiscard]]
+		static std::expected<void, Error> write(
+			const std::filesystem::path& path,
+			Key key,
+			const BlasList::SerializedView& serialized
+		) noexcept;
+
+		///
+		/// @brief Get the serialized BLASes stored in the cache
+		/// @warning The view references the mapped file, keep the cache alive while using it
+		///
+		/// @return View of the serialized BLASes
+		///
+		[[nodiscard]]
+		const BlasList::SerializedView& view() const noexcept
+		{
+			return serialized;
+		}
+
+	  private:
+
+		std::shared_ptr<const void> mapping;  // Keeps the file mapped
+		BlasList::SerializedView serialized;
+
+		explicit BlasCache(std::shared_ptr<const void> mapping, BlasList::SerializedView serialized) :
+			mapping(std::move(mapping)),
+			serialized(serialized)
+		{}
+
+	  public:
+
+		BlasCache(const BlasCache&) = delete;
+		BlasCache(BlasCache&&) = default;
+		BlasCache& operator=(const BlasCache&) = delete;
+		BlasCache& operator=(BlasCache&&) = default;
+	};
+}
@@ -6,8 +6,14 @@
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <expected>
-#include <ranges>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -19,63 +25,249 @@ namespace render
 	/// @brief List of BLASes
 	/// @details
 	/// #### Indexing Scheme
-	/// - Each BLAS in `blas_list` corresponds to the mesh at the same index as `MeshList->mesh_ranges_array`,
-	/// where different primitives in that mesh are grouped as different sub-geometries in the BLAS
-	/// - Each geometry in `blas_list` corresponds to the primitive at the same index inside the mesh's
-	/// primitive range
+	/// - Meshes with identical geometry share a BLAS, `mesh_blas_index` maps each mesh at the same index as
+	/// `MeshList->mesh_ranges_array` to its BLAS in `blas`. Meshes are identical if their geometry hashes
+	/// (see `MeshList::Ref::mesh_geometry_hash_array`), primitive sizes and opaqueness all match
+	/// - Different primitives in a mesh are grouped as different sub-geometries in the BLAS, each geometry
+	/// corresponds to the primitive at the same index inside the mesh's primitive range
+	/// - Deformable meshes never share their BLAS, which is built with `eAllowUpdate` and refit to the
+	/// deformed vertices with `refit`
 	///
 	/// #### Implementation Hint
 	/// Set `instanceCustomIndex` to `mesh.offset` when creating TLAS, where `mesh` is the corresponding
-	/// mesh acquired from `MeshList`.
+	/// mesh acquired from `MeshList`. Shared BLASes are then shaded with the primitives of each instance's
+	/// own mesh.
 	///
 	class BlasList
 	{
 	  public:
 
-		using AccelStruct = std::pair<vulkan::Buffer, vk::raii::AccelerationStructureKHR>;
-		using AccelStructView = std::ranges::transform_view<
-			std::ranges::ref_view<const std::vector<AccelStruct>>,
-			vk::raii::AccelerationStructureKHR AccelStruct::*
-		>;
+		using AccelStructView = std::span<const vk::raii::AccelerationStructureKHR>;
+
+		///
+		/// @brief Memory usage of the BLAS buffers, in bytes
+		/// @note `compacted_size` equals `original_size` if compaction is disabled
+		///
+		struct MemoryStat
+		{
+			vk::DeviceSize original_size;   // Total size before compaction
+			vk::DeviceSize compacted_size;  // Total size after compaction
+		};
+
+		///
+		/// @brief Trade-off between build time and trace performance of the BLASes
+		///
+		enum class BuildPreference
+		{
+			FastTrace,  // Build with `ePreferFastTrace`, for BLASes kept throughout rendering
+			FastBuild   // Build with `ePreferFastBuild`, for BLASes to be rebuilt with `FastTrace` later
+		};
 
 		///
 		/// @brief Create and build BLASes
+		/// @details Prototypes are sized in parallel on @p thread_pool, and storage of the BLASes is
+		/// suballocated from a few large buffers
+		/// @note BLASes are built on the async compute queue, so this can run on a background thread while
+		/// the main queue keeps rendering
 		///
+		/// @param thread_pool Thread pool
 		/// @param context Vulkan context
 		/// @param mesh_list Mesh list
 		/// @param material_list Material list
+		/// @param compact Compact the BLASes after building, reduces memory usage at the cost of load time
+		/// @param preference Build preference of the BLASes
+		/// @param stop_token Stop token, building fails between batches once a stop is requested
+		/// @param deformable_meshes Meshes whose vertices are deformed on GPU, see `DeformList`
 		/// @return Created and built BLASes or error
 		///
 		[[nodiscard]]
-		static std::expected<BlasList, Error> create(
+		static coro::task<std::expected<BlasList, Error>> create(
+			coro::thread_pool& thread_pool,
+			const vulkan::Context& context,
+			const MeshList& mesh_list,
+			const MaterialList& material_list,
+			bool compact = false,
+			BuildPreference preference = BuildPreference::FastTrace,
+			std::stop_token stop_token = {},
+			std::span<const uint32_t> deformable_meshes = {}
+		) noexcept;
+
+		///
+		/// @brief Non-owning view of serialized BLASes, see `Serialized`
+		///
+		struct SerializedView
+		{
+			std::span<const std::byte> data;
+			std::span<const uint64_t> offsets;          // Offset of each BLAS in `data`, then the end
+			std::span<const uint32_t> mesh_blas_index;  // See `ReadonlyWrapper::mesh_blas_index`
+		};
+
+		///
+		/// @brief BLASes serialized into an opaque, device-specific format, see `serialize`
+		/// @details Each BLAS is stored as written by `vkCmdCopyAccelerationStructureToMemoryKHR`, starting
+		/// with the driver and compatibility UUIDs. A serialized list only deserializes on a device reporting
+		/// it compatible, usually the same device with the same driver version.
+		///
+		struct Serialized
+		{
+			std::vector<std::byte> data;
+			std::vector<uint64_t> offsets;
+			std::vector<uint32_t> mesh_blas_index;
+
+			[[nodiscard]]
+			SerializedView view() const noexcept
+			{
+				return {.data = data, .offsets = offsets, .mesh_blas_index = mesh_blas_index};
+			}
+		};
+
+		///
+		/// @brief Deserialize BLASes written by `serialize`, skipping the build entirely
+		/// @details Compatibility with the device is checked first, nothing is allocated if any BLAS is
+		/// incompatible. The caller is expected to fall back to `create` on failure.
+		/// @note Deserialized BLASes report `BuildPreference::FastTrace` and have nothing to refit
+		///
+		/// @param context Vulkan context
+		/// @param mesh_list Mesh list the BLASes were built from
+		/// @param serialized Serialized BLASes
+		/// @return Deserialized BLASes, or error if malformed or incompatible with the device
+		///
+		[[nodiscard]]
+		static std::expected<BlasList, Error> deserialize(
 			const vulkan::Context& context,
 			const MeshList& mesh_list,
-			const MaterialList& material_list
+			const SerializedView& serialized
 		) noexcept;
 
+		///
+		/// @brief Serialize the BLASes, so that they reload with `deserialize` instead of being rebuilt
+		/// @details Runs on the async compute queue and blocks until the BLASes are read back
+		///
+		/// @param context Vulkan context
+		/// @return Serialized BLASes, or error if any BLAS is refit, see `refit`
+		///
+		[[nodiscard]]
+		std::expected<Serialized, Error> serialize(const vulkan::Context& context) const noexcept;
+
+		///
+		/// @brief Refit the BLASes of the deformable meshes to their current vertices
+		/// @details Records a single `eUpdate` build into @p command_buffer, between barriers against the
+		/// previous traces and builds and the following TLAS builds and traces. No-op without deformable
+		/// meshes
+		/// @note Writes of the deformed vertices must be made visible to acceleration structure builds by
+		/// the caller, see `DeformPipeline`
+		/// @warning The scratch buffer is reused, all refits are expected on the same queue
+		///
+		/// @param command_buffer Command buffer to record into
+		///
+		void refit(const vk::raii::CommandBuffer& command_buffer) const noexcept;
+
+		///
+		/// @brief Get memory usage of the BLAS buffers
+		///
+		/// @return Memory usage before and after compaction
+		///
+		[[nodiscard]]
+		MemoryStat get_memory_stat() const noexcept
+		{
+			return memory_stat;
+		}
+
+		///
+		/// @brief Get build preference the BLASes were built with
+		///
+		/// @return Build preference
+		///
+		[[nodiscard]]
+		BuildPreference get_build_preference() const noexcept
+		{
+			return build_preference;
+		}
+
+		///
+		/// @brief Whether the BLASes were loaded with `deserialize` instead of being built
+		///
+		[[nodiscard]]
+		bool is_deserialized() const noexcept
+		{
+			return deserialized;
+		}
+
 		struct ReadonlyWrapper
 		{
 			///
-			/// @brief BLASes for each mesh
+			/// @brief Unique BLASes, shared by meshes with identical geometry
 			///
 			AccelStructView blas;
 
+			///
+			/// @brief Index into `blas` of each mesh
+			///
+			std::span<const uint32_t> mesh_blas_index;
+
+			///
+			/// @brief Get the BLAS of a mesh
+			///
+			/// @param mesh_index Index of the mesh in the mesh list
+			/// @return BLAS of the mesh
+			///
+			[[nodiscard]]
+			const vk::raii::AccelerationStructureKHR& get_mesh_blas(uint32_t mesh_index) const noexcept
+			{
+				return blas[mesh_blas_index[mesh_index]];
+			}
+
 			const ReadonlyWrapper* operator->() const noexcept { return this; }
 		};
 
 		ReadonlyWrapper operator->() const noexcept
 		{
 			return ReadonlyWrapper{
-				.blas = blas_list | std::views::transform(&AccelStruct::second),
+				.blas = blas_list,
+				.mesh_blas_index = mesh_blas_index,
 			};
 		}
 
 	  private:
 
-		std::vector<AccelStruct> blas_list;
+		// Geometry of a BLAS refit by `refit`, referencing the vertices in the mesh list
+		struct RefitTarget
+		{
+			uint32_t blas_index;
+			vk::BuildAccelerationStructureFlagsKHR build_flags;
+			vk::DeviceAddress scratch_addr;
+			std::vector<vk::AccelerationStructureGeometryKHR> geometries;
+			std::vector<vk::AccelerationStructureBuildRangeInfoKHR> build_range;
+		};
+
+		std::vector<vulkan::Buffer> buffers;  // Storage shared by the BLASes, declared first to destroy last
+		std::vector<vk::raii::AccelerationStructureKHR> blas_list;
+		std::vector<uint32_t> mesh_blas_index;
+		MemoryStat memory_stat;
+		BuildPreference build_preference;
+		bool deserialized;
+
+		std::vector<RefitTarget> refit_targets;
+		std::optional<vulkan::Buffer> refit_scratch_buffer;
 
-		explicit BlasList(std::vector<AccelStruct> blas_list) :
-			blas_list(std::move(blas_list))
+		explicit BlasList(
+			std::vector<vulkan::Buffer> buffers,
+			std::vector<vk::raii::AccelerationStructureKHR> blas_list,
+			std::vector<uint32_t> mesh_blas_index,
+			MemoryStat memory_stat,
+			BuildPreference build_preference,
+			bool deserialized,
+			std::vector<RefitTarget> refit_targets,
+			std::optional<vulkan::Buffer> refit_scratch_buffer
+		) :
+			buffers(std::move(buffers)),
+			blas_list(std::move(blas_list)),
+			mesh_blas_index(std::move(mesh_blas_index)),
+			memory_stat(memory_stat),
+			build_preference(build_preference),
+			deserialized(deserialized),
+			refit_targets(std::move(refit_targets)),
+			refit_scratch_buffer(std::move(refit_scratch_buffer))
 		{}
 
 	  public:
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model/animation.hpp"
+#include "model/mesh.hpp"
+#include "model/model.hpp"
+#include "render/model/mesh.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace render
+{
+	///
+	/// @brief GPU-side deformation data of the deformable meshes of a model, see `model::Deformation`
+	/// @details
+	/// - Holds the bind-pose vertices, skin bindings and morph target deltas of every deformed primitive,
+	/// from which `DeformPipeline` rewrites the vertices of the mesh list in place each frame
+	/// - A mesh is deformed once and posed by the first node drawing it, instances of the same mesh share
+	/// the deformed vertices
+	/// - Only supports mesh lists of `VertexFormat::Full` without a geometry pool
+	///
+	class DeformList
+	{
+	  public:
+
+		static constexpr uint32_t NO_SKIN = 0xFFFFFFFF;
+
+		///
+		/// @brief Deformation of a single primitive, laid out as the push constant of the deform shader
+		///
+		struct Job
+		{
+			uint32_t vertex_offset;  // Offset of the first vertex into the vertex buffer of the mesh list
+			uint32_t vertex_count;   // Number of vertices in the primitive
+			uint32_t bind_offset;    // Offset of the first vertex into the bind-pose vertex buffer
+			uint32_t skin_offset;    // Offset of the first vertex into the skin buffer, or `NO_SKIN`
+			uint32_t morph_offset;   // Offset of the first delta into the morph buffer
+			uint32_t target_count;   // Number of morph targets
+			uint32_t joint_offset;   // Offset of the first joint matrix of the mesh
+			uint32_t weight_offset;  // Offset of the first morph weight of the mesh
+		};
+
+		///
+		/// @brief Host-side deformation parameters of a frame, see `compute_parameters`
+		///
+		struct Parameters
+		{
+			std::vector<glm::mat4> joint_matrices;
+			std::vector<float> morph_weights;
+		};
+
+		///
+		/// @brief Get the meshes to be deformed
+		///
+		/// @param model CPU-side model data
+		/// @return Indices of the deformable meshes, see `model::Mesh::deformable`
+		///
+		[[nodiscard]]
+		static std::vector<uint32_t> get_deformable_meshes(const model::Model& model) noexcept;
+
+		///
+		/// @brief Create a deform list
+		/// @note The vertices of deformed primitives must be uploaded in their original order, see
+		/// `model::Primitive::deformation`
+		///
+		/// @param context Vulkan context
+		/// @param model CPU-side model data
+		/// @param mesh_list Mesh list created from the meshes of @p model
+		/// @return Created deform list or error
+		///
+		[[nodiscard]]
+		static std::expected<DeformList, Error> create(
+			const vulkan::Context& context,
+			const model::Model& model,
+			const MeshList& mesh_list
+		) noexcept;
+
+		///
+		/// @brief Compute joint matrices and morph weights of all deformed meshes
+		///
+		/// @param world_transforms World transforms of all nodes, see `model::Hierarchy::compute_transforms`
+		/// @param node_morph_weights Morph weights of all nodes, see `model::Animation::sample`. Nodes
+		/// without weights use the default weights of their mesh
+		/// @return Parameters to be uploaded through `DeformResource`
+		///
+		[[nodiscard]]
+		Parameters compute_parameters(
+			std::span<const glm::mat4> world_transforms,
+			std::span<const std::vector<float>> node_morph_weights = {}
+		) const noexcept;
+
+		struct Ref
+		{
+			vulkan::ArrayBufferRef<model::FullVertex> bind_vertex_buffer;
+			vulkan::ArrayBufferRef<model::VertexSkin> skin_buffer;
+
+			// Per morph target, the position deltas of all vertices followed by their normal deltas
+			vulkan::ArrayBufferRef<glm::vec3> morph_buffer;
+
+			std::span<const Job> jobs;
+
+			const Ref* operator->() const noexcept { return this; }
+		};
+
+		///
+		/// @brief Get references to the buffers and jobs
+		/// @note Buffers always hold at least one element
+		///
+		/// @return References
+		///
+		[[nodiscard]]
+		Ref get() const noexcept
+		{
+			return Ref{
+				.bind_vertex_buffer = bind_vertex_buffer,
+				.skin_buffer = skin_buffer,
+				.morph_buffer = morph_buffer,
+				.jobs = jobs,
+			};
+		}
+
+	  private:
+
+		// Deformed mesh, posed by a single node
+		struct Binding
+		{
+			uint32_t node_index;
+			std::optional<uint32_t> skin_index;
+			uint32_t joint_offset;
+			uint32_t weight_offset;
+			std::vector<float> default_weights;  // Sized to the morph target count of the mesh
+		};
+
+		vulkan::ArrayBuffer<model::FullVertex> bind_vertex_buffer;
+		vulkan::ArrayBuffer<model::VertexSkin> skin_buffer;
+		vulkan::ArrayBuffer<glm::vec3> morph_buffer;
+
+		std::vector<Job> jobs;
+		std::vector<Binding> bindings;
+		std::vector<model::Skin> skins;
+
+		uint32_t joint_count;
+		uint32_t weight_count;
+
+		explicit DeformList(
+			vulkan::ArrayBuffer<model::FullVertex> bind_vertex_buffer,
+			vulkan::ArrayBuffer<model::VertexSkin> skin_buffer,
+			vulkan::ArrayBuffer<glm::vec3> morph_buffer,
+			std::vector<Job> jobs,
+			std::vector<Binding> bindings,
+			std::vector<model::Skin> skins,
+			uint32_t joint_count,
+			uint32_t weight_count
+		) :
+			bind_vertex_buffer(std::move(bind_vertex_buffer)),
+			skin_buffer(std::move(skin_buffer)),
+			morph_buffer(std::move(morph_buffer)),
+			jobs(std::move(jobs)),
+			bindings(std::move(bindings)),
+			skins(std::move(skins)),
+			joint_count(joint_count),
+			weight_count(weight_count)
+		{}
+
+	  public:
+
+		DeformList(const DeformList&) = delete;
+		DeformList(DeformList&&) = default;
+		DeformList& operator=(const DeformList&) = delete;
+		DeformList& operator=(DeformList&&) = default;
+	};
+}
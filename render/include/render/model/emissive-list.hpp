@@ -0,0 +1,91 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model/hierarchy.hpp"
+#include "model/material.hpp"
+#include "render/interface/emissive-triangle.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/scene-graph.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <utility>
+
+namespace render
+{
+	///
+	/// @brief GPU-side emissive triangles of a model, one entry for each triangle of each node instancing a
+	/// primitive with a non-zero emissive factor
+	/// @details
+	/// - Entries form an alias table, picking a triangle in proportion to the luminance of its emissive
+	/// factor. Emissive textures and triangle areas are left to the sampling shader, as the host keeps no
+	/// vertices after upload.
+	/// - Triangles index the geometry the TLAS is built from, see `MeshList::Ref::primitive_attr_array`.
+	/// Deformed vertices are not followed.
+	///
+	class EmissiveList
+	{
+	  public:
+
+		///
+		/// @brief Create an emissive list
+		///
+		/// @param context Vulkan context
+		/// @param hierarchy Hierarchy of the model
+		/// @param mesh_list Mesh list of the model
+		/// @param materials Materials of the model, indexed by `PrimitiveAttribute::material_index`
+		/// @param scene_graph Scene graph of the model, HLOD proxy nodes are skipped as rays never hit them
+		/// @return Created emissive list or error
+		///
+		[[nodiscard]]
+		static std::expected<EmissiveList, Error> create(
+			const vulkan::Context& context,
+			const model::Hierarchy& hierarchy,
+			const MeshList& mesh_list,
+			std::span<const model::Material> materials,
+			const SceneGraph& scene_graph
+		) noexcept;
+
+		///
+		/// @brief Get the triangle buffer
+		/// @note Always holds at least one element, use `count` for the actual number of triangles
+		///
+		/// @return Reference to the triangle buffer
+		///
+		[[nodiscard]]
+		vulkan::ArrayBufferRef<EmissiveTriangle> get() const noexcept
+		{
+			return triangle_buffer;
+		}
+
+		///
+		/// @brief Get the number of triangles
+		///
+		/// @return Number of triangles
+		///
+		[[nodiscard]]
+		uint32_t count() const noexcept
+		{
+			return triangle_buffer.count();
+		}
+
+	  private:
+
+		vulkan::ArrayBuffer<EmissiveTriangle> triangle_buffer;
+
+		explicit EmissiveList(vulkan::ArrayBuffer<EmissiveTriangle> triangle_buffer) :
+			triangle_buffer(std::move(triangle_buffer))
+		{}
+
+	  public:
+
+		EmissiveList(const EmissiveList&) = delete;
+		EmissiveList(EmissiveList&&) = default;
+		EmissiveList& operator=(const EmissiveList&) = delete;
+		EmissiveList& operator=(EmissiveList&&) = default;
+	};
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include "common/util/async.hpp"
+#include "common/util/error.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model-cache.hpp"
+#include "vulkan/container/host/range-allocator.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <set>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Streams the full geometry of primitives into the geometry pool of a mesh list in the background
+	/// @details The mesh list is expected to be uploaded from a baked model with a geometry pool (see
+	/// `MeshList::upload`), so that only the coarsest level of detail of each primitive is resident up front.
+	/// The streamer picks the primitives whose coarse level exceeds the level of detail threshold at the
+	/// projected size reported by the indirect pipeline (see `GeometryFeedbackResource`), prioritized by that
+	/// size. Their full geometry, including all levels of detail, is read from the mapped cache on
+	/// background threads, uploaded into the pool, and swapped in by rewriting their primitive attributes.
+	/// When the pool is full, primitives not seen for a while are evicted back to their coarse level.
+	///
+	/// Call these every frame:
+	/// 1. `update` after waiting for the frame, with the feedback read back from it
+	/// 2. `record` in the command buffer of the frame, before the indirect pipeline
+	///
+	/// @note Acceleration structures and ray traced passes keep using the coarse geometry, see
+	/// `MeshList::Ref::trace_primitive_attr_buffer`. Primitives without coarser levels are never streamed,
+	/// they are uploaded in full up front.
+	/// @warning The mesh list must outlive the streamer
+	///
+	class GeometryStreamer
+	{
+	  public:
+
+		///
+		/// @brief Options of geometry streaming
+		///
+		struct Option
+		{
+			// Max count of primitives loading concurrently
+			uint32_t max_pending_loads = 16;
+
+			// Max size of geometry uploaded in a single `update`, at least one primitive is uploaded
+			size_t max_upload_size = 32 * 1048576;
+
+			// Frames in flight, pool ranges of evicted primitives are reused after this many `update` calls
+			uint32_t frames_in_flight = 3;
+
+			// Frames a primitive must stay unseen before it can be evicted
+			uint32_t evict_delay = 120;
+		};
+
+		///
+		/// @brief Statistics of geometry streaming
+		///
+		struct Stat
+		{
+			size_t primitive_count;  // Count of streamable primitives
+			size_t resident_count;   // Count of streamed primitives in use
+			size_t pending_count;    // Count of primitives loading or waiting for upload
+			size_t resident_size;    // Size of streamed geometry in use, in bytes
+			size_t pool_size;        // Size of the geometry pool, in bytes
+		};
+
+		///
+		/// @brief Get the capacity of a geometry pool fitting a memory budget
+		/// @details The budget is split between vertices and indices by their share in @p baked, and the
+		/// capacity never exceeds the full geometry
+		///
+		/// @param baked Baked mesh data to stream from
+		/// @param memory_budget Size of the pool, in bytes
+		/// @return Pool capacity, see `MeshList::upload`
+		///
+		[[nodiscard]]
+		static MeshList::PoolCapacity get_pool_capacity(
+			const MeshList::BakedView& baked,
+			size_t memory_budget
+		) noexcept;
+
+		///
+		/// @brief Create a geometry streamer
+		///
+		/// @param context Vulkan context
+		/// @param source Model cache that @p mesh_list was uploaded from
+		/// @param mesh_list Mesh list with a geometry pool to stream into
+		/// @param option Streaming options
+		/// @return Created streamer, or error
+		///
+		[[nodiscard]]
+		static std::expected<GeometryStreamer, Error> create(
+			const vulkan::Context& context,
+			std::shared_ptr<const ModelCache> source,
+			const MeshList& mesh_list,
+			Option option = {}
+		) noexcept;
+
+		///
+		/// @brief Update priorities, collect finished loads, upload and swap in primitives, start new loads
+		///
+		/// @param context Vulkan context
+		/// @param primitive_size Projected size of each primitive, see `GeometryFeedbackResource::Feedback`.
+		/// Ignored if mismatching the primitive count
+		/// @param lod_threshold Level of detail threshold the frame was culled with, see
+		/// `IndirectPipeline::compute`. Non-positive to stream every visible primitive
+		/// @return `void` on success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> update(
+			const vulkan::Context& context,
+			std::span<const float> primitive_size,
+			float lod_threshold
+		) noexcept;
+
+		///
+		/// @brief Record updates of the primitive attributes
+		/// @note Must be recorded outside of rendering
+		///
+		/// @param command_buffer Command buffer of the frame
+		///
+		void record(const vk::raii::CommandBuffer& command_buffer) noexcept;
+
+		///
+		/// @brief Get statistics of geometry streaming
+		///
+		/// @return Statistics
+		///
+		[[nodiscard]]
+		Stat get_stat() const noexcept;
+
+	  private:
+
+		// Full geometry of a primitive read from the source
+		struct Loaded
+		{
+			std::vector<std::byte> vertices;
+			std::vector<std::byte> indices;
+		};
+
+		// Pool ranges of a streamed primitive, in elements
+		struct Resident
+		{
+			vulkan::RangeAllocator::Range vertex_range;
+			vulkan::RangeAllocator::Range index_range;
+		};
+
+		// Pool ranges of an evicted primitive, freed once no frame in flight uses them
+		struct Retired
+		{
+			uint64_t frame;
+			Resident resident;
+		};
+
+		// Unit of streaming, a primitive with coarser levels of detail
+		struct Entry
+		{
+			uint32_t primitive_index;
+			float coarse_error;    // Error of the coarse level uploaded up front
+			uint32_t index_count;  // Count of indices of all levels
+
+			float priority = 0;        // Decayed projected size while the coarse level is too coarse
+			uint64_t last_used = 0;    // Last frame the full geometry was needed
+			uint64_t retry_frame = 0;  // Earliest frame to load or swap in again
+
+			std::optional<util::Future<Loaded>> load = std::nullopt;
+			std::optional<Loaded> loaded = std::nullopt;
+			std::optional<Resident> resident = std::nullopt;
+		};
+
+		std::shared_ptr<const ModelCache> source;
+		Option option;
+		vulkan::StaticResourceCreator resource_creator;
+
+		// Handles of the mesh list
+		vk::Buffer vertex_buffer;
+		vk::Buffer index_buffer;
+		vk::Buffer primitive_attr_buffer;
+		vk::DeviceSize vertex_size;
+		vk::DeviceSize index_size;
+		MeshList::GeometryPool pool;
+		std::vector<PrimitiveAttribute> coarse_attrs;
+
+		vulkan::RangeAllocator vertex_allocator;
+		vulkan::RangeAllocator index_allocator;
+
+		std::vector<Entry> entries;
+		std::vector<Retired> retired;
+		std::set<uint32_t> dirty_entries;
+
+		uint64_t frame = 0;
+		size_t resident_size = 0;
+
+		explicit GeometryStreamer(
+			std::shared_ptr<const ModelCache> source,
+			Option option,
+			vulkan::StaticResourceCreator resource_creator,
+			const MeshList& mesh_list,
+			std::vector<Entry> entries
+		) :
+			source(std::move(source)),
+			option(option),
+			resource_creator(std::move(resource_creator)),
+			vertex_buffer(mesh_list->vertex_buffer),
+			index_buffer(mesh_list->index_buffer),
+			primitive_attr_buffer(mesh_list->primitive_attr_buffer),
+			vertex_size(vertex_stride(mesh_list->vertex_format)),
+			index_size(index_stride(mesh_list->index_format)),
+			pool(*mesh_list->geometry_pool),
+			coarse_attrs(mesh_list->primitive_attr_array | std::ranges::to<std::vector>()),
+			vertex_allocator(pool.vertex_count),
+			index_allocator(pool.index_count),
+			entries(std::move(entries))
+		{}
+
+		// Get current attribute of a primitive, the streamed geometry if resident
+		[[nodiscard]]
+		PrimitiveAttribute get_attribute(const Entry& entry) const noexcept;
+
+		// Get vertex and index data of a primitive in the source
+		[[nodiscard]]
+		std::pair<std::span<const std::byte>, std::span<const std::byte>> get_source_data(
+			const Entry& entry
+		) const noexcept;
+
+		void apply_feedback(std::span<const float> primitive_size, float lod_threshold) noexcept;
+
+		void collect_loads() noexcept;
+
+		void start_loads() noexcept;
+
+		[[nodiscard]]
+		std::expected<void, Error> upload_loaded(const vulkan::Context& context) noexcept;
+
+		// Allocate pool ranges, evicting unseen primitives of lower priority until they fit
+		[[nodiscard]]
+		std::optional<Resident> allocate(const Entry& entry) noexcept;
+
+		void evict(uint32_t index) noexcept;
+
+		// Free pool ranges no longer used by any frame in flight
+		void free_retired() noexcept;
+
+	  public:
+
+		GeometryStreamer(const GeometryStreamer&) = delete;
+		GeometryStreamer(GeometryStreamer&&) = default;
+		GeometryStreamer& operator=(const GeometryStreamer&) = delete;
+		GeometryStreamer& operator=(GeometryStreamer&&) = default;
+	};
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model/model.hpp"
+#include "render/interface/impostor.hpp"
+#include "render/model/mesh.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief GPU-side octahedral impostors of a model, see `model::bake_impostors`
+	/// @details
+	/// - The atlases of all impostors are stacked vertically into one albedo image (sRGB) and one
+	/// normal-depth image (UNORM), with impostor `i` taking rows `[i * atlas_size, (i + 1) * atlas_size)`.
+	/// Mipmaps stop at 4 texels per frame, so frames don't blend into their neighbors.
+	/// - Each primitive has an impostor entry, see `NO_IMPOSTOR` and `IMPOSTOR_FIRST_BIT`. Culling appends
+	/// one `ImpostorInstance` per node at the first primitive of its mesh, see `IndirectPipeline`
+	/// - Always created, with dummy buffers and images if the model has no impostors, see `empty`
+	///
+	class ImpostorList
+	{
+	  public:
+
+		///
+		/// @brief Baked impostor, `model::Impostor` without its atlases
+		///
+		struct BakedImpostor
+		{
+			uint32_t mesh_index;
+			glm::vec3 center;
+			float radius;
+			uint32_t frame_count;
+			uint32_t frame_size;
+		};
+
+		///
+		/// @brief Non-owning view of baked impostors, see `Baked`
+		///
+		struct BakedView
+		{
+			std::span<const BakedImpostor> impostors;
+			std::span<const glm::u8vec4> texels;
+		};
+
+		///
+		/// @brief Baked impostors, with the albedo atlas of each impostor followed by its normal-depth atlas
+		/// in `texels`
+		///
+		struct Baked
+		{
+			std::vector<BakedImpostor> impostors;
+			std::vector<glm::u8vec4> texels;
+
+			[[nodiscard]]
+			BakedView view() const noexcept
+			{
+				return {.impostors = impostors, .texels = texels};
+			}
+		};
+
+		///
+		/// @brief Bake the impostors of a CPU-side model
+		///
+		/// @param impostors Impostors of the model
+		/// @return Baked impostors
+		///
+		[[nodiscard]]
+		static Baked bake(const model::ImpostorList& impostors) noexcept;
+
+		///
+		/// @brief Create an impostor list
+		///
+		/// @param context Vulkan context
+		/// @param baked Baked impostors, all with the same frame layout
+		/// @param mesh_list Mesh list of the model
+		/// @return Created impostor list or error
+		///
+		[[nodiscard]]
+		static std::expected<ImpostorList, Error> create(
+			const vulkan::Context& context,
+			const BakedView& baked,
+			const MeshList& mesh_list
+		) noexcept;
+
+		///
+		/// @brief References to the GPU resources
+		///
+		struct Ref
+		{
+			vulkan::ArrayBufferRef<Impostor> impostor_buffer;            // Padded with a dummy if empty
+			vulkan::ArrayBufferRef<uint32_t> primitive_impostor_buffer;  // Impostor entry of each primitive
+			vk::ImageView albedo_view;
+			vk::ImageView normal_depth_view;
+			vk::Sampler sampler;
+		};
+
+		///
+		/// @return References to the GPU resources
+		///
+		[[nodiscard]]
+		Ref get() const noexcept
+		{
+			return Ref{
+				.impostor_buffer = impostor_buffer,
+				.primitive_impostor_buffer = primitive_impostor_buffer,
+				.albedo_view = albedo_view,
+				.normal_depth_view = normal_depth_view,
+				.sampler = sampler
+			};
+		}
+
+		///
+		/// @brief Check if the model has no impostors
+		///
+		/// @return `true` if there are no impostors
+		///
+		[[nodiscard]]
+		bool empty() const noexcept
+		{
+			return impostor_count == 0;
+		}
+
+	  private:
+
+		vulkan::ArrayBuffer<Impostor> impostor_buffer;
+		vulkan::ArrayBuffer<uint32_t> primitive_impostor_buffer;
+		vulkan::Image albedo_image;
+		vulkan::Image normal_depth_image;
+		vk::raii::ImageView albedo_view;
+		vk::raii::ImageView normal_depth_view;
+		vk::raii::Sampler sampler;
+		uint32_t impostor_count;
+
+		explicit ImpostorList(
+			vulkan::ArrayBuffer<Impostor> impostor_buffer,
+			vulkan::ArrayBuffer<uint32_t> primitive_impostor_buffer,
+			vulkan::Image albedo_image,
+			vulkan::Image normal_depth_image,
+			vk::raii::ImageView albedo_view,
+			vk::raii::ImageView normal_depth_view,
+			vk::raii::Sampler sampler,
+			uint32_t impostor_count
+		) :
+			impostor_buffer(std::move(impostor_buffer)),
+			primitive_impostor_buffer(std::move(primitive_impostor_buffer)),
+			albedo_image(std::move(albedo_image)),
+			normal_depth_image(std::move(normal_depth_image)),
+			albedo_view(std::move(albedo_view)),
+			normal_depth_view(std::move(normal_depth_view)),
+			sampler(std::move(sampler)),
+			impostor_count(impostor_count)
+		{}
+
+	  public:
+
+		ImpostorList(const ImpostorList&) = delete;
+		ImpostorList(ImpostorList&&) = default;
+		ImpostorList& operator=(const ImpostorList&) = delete;
+		ImpostorList& operator=(ImpostorList&&) = default;
+	};
+}
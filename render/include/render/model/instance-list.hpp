@@ -0,0 +1,260 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+#include "render/interface/node-transform.hpp"
+#include "render/interface/primitive-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/util/per-render-state.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace render
+{
+	///
+	/// @brief Host-side registry of mesh instances added to a scene graph at runtime
+	/// @details
+	/// - An instance draws every primitive of a mesh with its own transform, taking one reserved node and
+	/// one reserved drawcall slot for each primitive, see `SceneGraph::InstanceCapacity`
+	/// - Nodes and drawcall slots are taken from free lists, adding and removing never moves other instances
+	/// - Handles stay valid until their instance is removed. Slots carry a generation, so a stale handle is
+	/// rejected even after its slot is reused
+	/// - Edits only mark nodes and drawcall slots dirty. `flush` uploads the dirty drawcall slots, a copy
+	/// region for each run of consecutive slots, and collects the dirty local transforms, which are then
+	/// scattered on GPU by `TransformPipeline`. An edit thus costs a constant upload, regardless of the
+	/// instance count.
+	///
+	/// @note Instances are rasterized only, they are not part of the TLAS
+	/// @warning The drawcall buffers of the scene graph are shared by frames in flight, a frame still culling
+	/// may see the drawcalls flushed for the next frame. This only affects whether the edited instances are
+	/// drawn in that frame.
+	///
+	class InstanceList
+	{
+	  public:
+
+		///
+		/// @brief Stable handle of an instance
+		///
+		struct Handle
+		{
+			uint32_t index;       // Index of the instance slot
+			uint32_t generation;  // Generation of the slot when the instance was added
+
+			[[nodiscard]]
+			std::strong_ordering operator<=>(const Handle&) const noexcept = default;
+		};
+
+		///
+		/// @brief Create an empty instance list over the reserved capacity of a scene graph
+		///
+		/// @param scene_graph Scene graph, created with a non-empty `SceneGraph::InstanceCapacity`
+		/// @param mesh_list Mesh list of the model
+		/// @param material_list Material list of the model
+		/// @return Created instance list, or error
+		///
+		/// @warning The instance list references the drawcall buffers of @p scene_graph, beware of the
+		/// lifetime
+		///
+		[[nodiscard]]
+		static std::expected<InstanceList, Error> create(
+			const SceneGraph& scene_graph,
+			const MeshList& mesh_list,
+			const MaterialList& material_list
+		) noexcept;
+
+		///
+		/// @brief Add an instance of a mesh
+		///
+		/// @param mesh_index Index of the mesh
+		/// @param transform Transform of the instance, applied after the root transform
+		/// @param visible Whether the instance is drawn
+		/// @return Handle of the instance, or error if the mesh is invalid or the capacity is exhausted
+		///
+		[[nodiscard]]
+		std::expected<Handle, Error> add_instance(
+			uint32_t mesh_index,
+			const glm::mat4& transform,
+			bool visible = true
+		) noexcept;
+
+		///
+		/// @brief Remove an instance, releasing its node and drawcall slots
+		///
+		/// @param handle Handle of the instance
+		/// @return `void` if success, or error if the handle is stale
+		///
+		[[nodiscard]]
+		std::expected<void, Error> remove_instance(Handle handle) noexcept;
+
+		///
+		/// @brief Set the transform of an instance
+		///
+		/// @param handle Handle of the instance
+		/// @param transform New transform, applied after the root transform
+		/// @return `void` if success, or error if the handle is stale
+		///
+		[[nodiscard]]
+		std::expected<void, Error> set_transform(Handle handle, const glm::mat4& transform) noexcept;
+
+		///
+		/// @brief Show or hide an instance, keeping its slots
+		///
+		/// @param handle Handle of the instance
+		/// @param visible Whether the instance is drawn
+		/// @return `void` if success, or error if the handle is stale
+		///
+		[[nodiscard]]
+		std::expected<void, Error> set_visibility(Handle handle, bool visible) noexcept;
+
+		///
+		/// @brief Check whether a handle refers to a live instance
+		///
+		/// @param handle Handle of the instance
+		/// @return `true` if the instance has not been removed
+		///
+		[[nodiscard]]
+		bool contains(Handle handle) const noexcept;
+
+		///
+		/// @brief Get the count of live instances
+		///
+		/// @return Count of live instances
+		///
+		[[nodiscard]]
+		size_t instance_count() const noexcept
+		{
+			return live_count;
+		}
+
+		///
+		/// @brief Schedule the upload of the dirty drawcall slots into @p upload_ring, and collect the dirty
+		/// transforms into `transform_updates()`
+		///
+		/// @param context Vulkan context
+		/// @param upload_ring Upload ring of the current frame
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> flush(
+			const vulkan::Context& context,
+			vulkan::UploadRing& upload_ring
+		) noexcept;
+
+		///
+		/// @brief Get the dirty transforms collected by the last `flush`
+		/// @details Pass them to `TransformResource::update` of the same frame, together with the updates of
+		/// the hierarchy nodes if any
+		///
+		/// @return Local transform updates, at most one per node
+		///
+		[[nodiscard]]
+		std::span<const NodeTransformUpdate> transform_updates() const noexcept
+		{
+			return flushed_transforms;
+		}
+
+	  private:
+
+		// Render state of a primitive
+		struct Placement
+		{
+			bool blended;
+			model::Material::Mode mode;
+		};
+
+		// Reserved drawcall slots of a single render state
+		struct SlotList
+		{
+			vulkan::ArrayBufferRef<PrimitiveDrawcall> buffer;
+			uint32_t offset;                       // First reserved slot in the buffer
+			std::vector<PrimitiveDrawcall> slots;  // Host copy of the reserved slots
+			std::vector<uint32_t> free_slots;      // Free slots, lowest on top
+			std::vector<uint32_t> dirty_slots;
+			std::vector<bool> dirty;
+		};
+
+		struct DrawcallSlot
+		{
+			Placement placement;
+			uint32_t slot;
+			uint32_t primitive_index;
+		};
+
+		struct Instance
+		{
+			uint32_t generation = 0;
+			bool live = false;
+			bool visible = false;
+			uint32_t node_slot = 0;
+			std::vector<DrawcallSlot> drawcalls;
+		};
+
+		std::vector<PrimitiveIndexRange> mesh_ranges;
+		std::vector<Placement> placements;  // Placement of each primitive
+
+		PerRenderState<SlotList> main_slots;
+		PerRenderState<SlotList> blended_slots;
+
+		uint32_t node_offset;                    // First reserved node in the scene graph
+		std::vector<glm::mat4> node_transforms;  // Local transform of each reserved node
+		std::vector<uint32_t> free_nodes;        // Free nodes, lowest on top
+		std::vector<uint32_t> dirty_nodes;
+		std::vector<bool> node_dirty;
+
+		std::vector<Instance> instances;
+		std::vector<uint32_t> free_instances;
+		size_t live_count = 0;
+
+		std::vector<NodeTransformUpdate> flushed_transforms;
+
+		explicit InstanceList(
+			std::vector<PrimitiveIndexRange> mesh_ranges,
+			std::vector<Placement> placements,
+			PerRenderState<SlotList> main_slots,
+			PerRenderState<SlotList> blended_slots,
+			uint32_t node_offset,
+			uint32_t node_capacity
+		) noexcept :
+			mesh_ranges(std::move(mesh_ranges)),
+			placements(std::move(placements)),
+			main_slots(std::move(main_slots)),
+			blended_slots(std::move(blended_slots)),
+			node_offset(node_offset),
+			node_transforms(node_capacity, glm::mat4(1.0f)),
+			free_nodes(std::from_range, std::views::iota(0u, node_capacity) | std::views::reverse),
+			node_dirty(node_capacity, false)
+		{}
+
+		[[nodiscard]]
+		SlotList& slot_list(Placement placement) noexcept
+		{
+			return (placement.blended ? blended_slots : main_slots)[placement.mode];
+		}
+
+		[[nodiscard]]
+		Instance* find(Handle handle) noexcept;
+
+		void write_drawcall(const DrawcallSlot& drawcall, PrimitiveDrawcall value) noexcept;
+
+	  public:
+
+		InstanceList(const InstanceList&) = delete;
+		InstanceList(InstanceList&&) = default;
+		InstanceList& operator=(const InstanceList&) = delete;
+		InstanceList& operator=(InstanceList&&) = default;
+	};
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model/hierarchy.hpp"
+#include "model/light.hpp"
+#include "render/interface/punctual-light.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <utility>
+
+namespace render
+{
+	///
+	/// @brief GPU-side punctual lights of a model, one entry for each node referencing a light
+	/// @details
+	/// - Directional lights are skipped, the scene is lit by the primary directional light instead
+	/// - Lights without a range get a finite one at which the illuminance drops below `MIN_ILLUMINANCE`,
+	/// so that every light can be culled by its bounding sphere
+	///
+	class LightList
+	{
+	  public:
+
+		// Illuminance at which a light without range is cut off, in lux
+		static constexpr float MIN_ILLUMINANCE = 0.01f;
+
+		///
+		/// @brief Create a light list
+		///
+		/// @param context Vulkan context
+		/// @param hierarchy Hierarchy of the model
+		/// @param lights Lights of the model, indexed by `model::NodeData::light_index`
+		/// @return Created light list or error
+		///
+		[[nodiscard]]
+		static std::expected<LightList, Error> create(
+			const vulkan::Context& context,
+			const model::Hierarchy& hierarchy,
+			std::span<const model::Light> lights
+		) noexcept;
+
+		///
+		/// @brief Get the light buffer
+		/// @note Always holds at least one element, use `count` for the actual number of lights
+		///
+		/// @return Reference to the light buffer
+		///
+		[[nodiscard]]
+		vulkan::ArrayBufferRef<PunctualLight> get() const noexcept
+		{
+			return light_buffer;
+		}
+
+		///
+		/// @brief Get the number of lights
+		///
+		/// @return Number of lights
+		///
+		[[nodiscard]]
+		uint32_t count() const noexcept
+		{
+			return light_buffer.count();
+		}
+
+	  private:
+
+		vulkan::ArrayBuffer<PunctualLight> light_buffer;
+
+		explicit LightList(vulkan::ArrayBuffer<PunctualLight> light_buffer) :
+			light_buffer(std::move(light_buffer))
+		{}
+
+	  public:
+
+		LightList(const LightList&) = delete;
+		LightList(LightList&&) = default;
+		LightList& operator=(const LightList&) = delete;
+		LightList& operator=(LightList&&) = default;
+	};
+}
@@ -4,16 +4,22 @@
 #include "common/util/error.hpp"
 #include "common/util/tagged-type.hpp"
 #include "model/material.hpp"
+#include "render/model/sampler-cache.hpp"
 #include "render/model/texture-list.hpp"
+#include "render/model/texture.hpp"
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 
 #include <coro/coro.hpp>
 #include <coro/task.hpp>
 #include <coro/thread_pool.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -67,10 +73,22 @@ namespace render
 		model::Material::Param param;
 	};
 
+	///
+	/// @brief Source of a texture descriptor, used to replace the texture when streaming
+	///
+	struct TextureSource
+	{
+		uint32_t texture_index;  // Index of the texture in `TextureList`
+		Texture::Usage usage;    // Usage of the image view
+		vk::Sampler sampler;     // Sampler of the descriptor
+	};
+
 	///
 	/// @brief Material list, manages all material-related GPU resources, including textures, samplers, info
 	/// buffer, and descriptor sets
-	///
+	/// @details All textures live in a single bindless array, indexed by the `TextureIndex` of each material
+	/// info. The descriptor set can thus be bound once by any pipeline using `MaterialLayout`, and texture
+	/// descriptors can be replaced after binding without rebuilding it (see `TextureStreamer`).
 	///
 	class MaterialList
 	{
@@ -91,12 +109,24 @@ namespace render
 		/// @brief Progress of creating material list
 		///
 		///
-		using Progress = util::SyncedEnumVariant<
+		using Progress = util::AtomicEnumVariant<
 			util::Tag<ProgressState::Preparing>,
 			util::Tag<ProgressState::TextureList, util::ProgressRef>,
 			util::Tag<ProgressState::Processing>
 		>;
 
+		///
+		/// @brief Option of creating samplers
+		///
+		struct SamplerOption
+		{
+			// Cache to share samplers with other material lists, `nullptr` to only share within this list
+			std::shared_ptr<SamplerCache> cache = nullptr;
+
+			// Sampling policy, e.g. lower anisotropy for low-end devices
+			SamplerCache::Policy policy = {};
+		};
+
 		///
 		/// @brief Create a material list from CPU-side material list
 		///
@@ -106,6 +136,8 @@ namespace render
 		/// @param layout Descriptor set layout for materials
 		/// @param material_list CPU-side material list
 		/// @param texture_load_option Options for loading textures
+		/// @param sampler_option Options for creating samplers
+		/// @param stop_token Stop token, see `TextureList::create`
 		/// @return Created `MaterialList` if successful, or an `Error` if fails
 		///
 		[[nodiscard]]
@@ -115,7 +147,28 @@ namespace render
 			const vulkan::Context& context,
 			const MaterialLayout& layout,
 			const model::MaterialList& material_list,
-			TextureList::LoadOption texture_load_option
+			TextureList::LoadOption texture_load_option,
+			SamplerOption sampler_option = {},
+			std::stop_token stop_token = {}
+		) noexcept;
+
+		///
+		/// @brief Create a material list from an already created texture list
+		///
+		/// @param context Vulkan context
+		/// @param layout Descriptor set layout for materials
+		/// @param texture_list Texture list, indexed by the texture sets of @p materials
+		/// @param materials CPU-side materials, see `model::MaterialList::materials`
+		/// @param sampler_option Options for creating samplers
+		/// @return Created `MaterialList` if successful, or an `Error` if fails
+		///
+		[[nodiscard]]
+		static std::expected<MaterialList, Error> create(
+			const vulkan::Context& context,
+			const MaterialLayout& layout,
+			TextureList texture_list,
+			std::span<const model::Material> materials,
+			const SamplerOption& sampler_option = {}
 		) noexcept;
 
 		///
@@ -141,24 +194,55 @@ namespace render
 			return material_modes[material_index == 0xFFFFFFFF ? 0 : material_index + 1];
 		}
 
+		///
+		/// @brief Get the modes of all materials, the default material at index 0
+		///
+		/// @return Material modes
+		///
+		[[nodiscard]]
+		std::span<const model::Material::Mode> get_material_modes() const noexcept
+		{
+			return material_modes;
+		}
+
+		///
+		/// @brief Get count of materials, excluding the default material
+		///
+		/// @return Material count
+		///
+		[[nodiscard]]
+		size_t material_count() const noexcept
+		{
+			return material_modes.size() - 1;
+		}
+
 	  private:
 
 		TextureList texture_list;
 
 		std::vector<vk::raii::ImageView> textures;
-		std::vector<vk::raii::Sampler> samplers;
+		std::vector<std::shared_ptr<const vk::raii::Sampler>> samplers;  // Shared through `SamplerCache`
 		vulkan::ArrayBuffer<MaterialInfo> info_buffer;
 		std::vector<model::Material::Mode> material_modes;
 
+		// Texture indices of each material info, default material at index 0
+		std::vector<TextureIndex> texture_indices;
+
+		// Sources of the texture descriptors. The texture array holds twice as many descriptors, the second
+		// half is reserved for streamed replacements, see `TextureStreamer`
+		std::vector<std::optional<TextureSource>> texture_sources;
+
 		vk::raii::DescriptorPool pool;
 		vk::raii::DescriptorSet descriptor_set;
 
 		explicit MaterialList(
 			TextureList texture_list,
 			std::vector<vk::raii::ImageView> textures,
-			std::vector<vk::raii::Sampler> samplers,
+			std::vector<std::shared_ptr<const vk::raii::Sampler>> samplers,
 			vulkan::ArrayBuffer<MaterialInfo> info_buffer,
 			std::vector<model::Material::Mode> material_modes,
+			std::vector<TextureIndex> texture_indices,
+			std::vector<std::optional<TextureSource>> texture_sources,
 			vk::raii::DescriptorPool pool,
 			vk::raii::DescriptorSet descriptor_set
 		) :
@@ -167,6 +251,8 @@ namespace render
 			samplers(std::move(samplers)),
 			info_buffer(std::move(info_buffer)),
 			material_modes(std::move(material_modes)),
+			texture_indices(std::move(texture_indices)),
+			texture_sources(std::move(texture_sources)),
 			pool(std::move(pool)),
 			descriptor_set(std::move(descriptor_set))
 		{}
@@ -178,9 +264,13 @@ namespace render
 			const vulkan::Context& context,
 			const MaterialLayout& layout,
 			const model::MaterialList& material_list,
-			TextureList::LoadOption texture_load_option
+			TextureList::LoadOption texture_load_option,
+			SamplerOption sampler_option,
+			std::stop_token stop_token
 		) noexcept;
 
+		friend class TextureStreamer;
+
 	  public:
 
 		MaterialList(const MaterialList&) = delete;
@@ -6,31 +6,113 @@
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <array>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <glm/ext/vector_float3.hpp>
 #include <glm/glm.hpp>
+#include <optional>
 #include <span>
 #include <utility>
 #include <vector>
+#include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace render
 {
 	constexpr uint32_t DEFAULT_MATERIAL = 0xFFFFFFFF;
 
+	///
+	/// @brief GPU-side vertex format of a mesh list
+	///
+	enum class VertexFormat
+	{
+		Full,    // `model::FullVertex`, 48 bytes of fp32 attributes
+		Packed,  // `model::PackedVertex`, 20 bytes, dequantized with the AABB of the primitive
+	};
+
+	///
+	/// @brief Get the stride of a vertex in the vertex buffer
+	///
+	/// @param format Vertex format
+	/// @return Stride in bytes
+	///
+	[[nodiscard]]
+	constexpr vk::DeviceSize vertex_stride(VertexFormat format) noexcept
+	{
+		return format == VertexFormat::Packed ? sizeof(model::PackedVertex) : sizeof(model::FullVertex);
+	}
+
+	///
+	/// @brief GPU-side index format of a mesh list
+	/// @details Indices are relative to the first vertex of their primitive, so 16-bit indices apply when
+	/// no primitive has more than 65536 vertices. Chosen by `MeshList::bake` and `MeshList::create`
+	///
+	enum class IndexFormat
+	{
+		Uint32,  // 32-bit indices
+		Uint16,  // 16-bit indices, packed two per 32-bit word when read from shaders
+	};
+
+	///
+	/// @brief Get the size of an index in the index buffer
+	///
+	/// @param format Index format
+	/// @return Size in bytes
+	///
+	[[nodiscard]]
+	constexpr uint32_t index_stride(IndexFormat format) noexcept
+	{
+		return format == IndexFormat::Uint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	}
+
+	///
+	/// @brief Get the Vulkan index type of an index format
+	///
+	/// @param format Index format
+	/// @return Index type, for index buffer bindings and acceleration structure builds
+	///
+	[[nodiscard]]
+	constexpr vk::IndexType index_type(IndexFormat format) noexcept
+	{
+		return format == IndexFormat::Uint16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+	}
+
+	///
+	/// @brief Index range of a level of detail of a primitive
+	///
+	struct PrimitiveLod
+	{
+		uint32_t index_offset;  // Offset of the first index into the index buffer
+		uint32_t index_count;   // Number of indices in the level
+		float error;            // Error relative to the primitive extent, see `model::GeometryLod::error`
+	};
+
 	///
 	/// @brief Attributes for a primitive
 	///
 	struct PrimitiveAttribute
 	{
+		// Maximum number of levels of detail, including the full geometry
+		static constexpr uint32_t MAX_LOD_COUNT = 4;
+
 		uint32_t index_offset;    // Offset of the first index into the index buffer
 		uint32_t vertex_offset;   // Offset of the first vertex into the vertex buffer
 		uint32_t index_count;     // Number of indices in the primitive
 		uint32_t vertex_count;    // Number of vertices in the primitive
+		uint32_t meshlet_offset;  // Offset of the first meshlet into the meshlet buffer
+		uint32_t meshlet_count;   // Number of meshlets in the primitive
 		uint32_t material_index;  // `0xFFFFFFFF` if no material
+		uint32_t index_size;      // Size of an index in bytes, see `index_stride`
 		glm::vec3 aabb_min;       // Minimum corner of AlignedBound
 		glm::vec3 aabb_max;       // Maximum corner of AlignedBound
+		uint32_t lod_count;       // Number of valid levels in `lods`, at least 1
+
+		// Levels of detail, `lods[0]` is the full geometry and aliases `index_offset`/`index_count`
+		std::array<PrimitiveLod, MAX_LOD_COUNT> lods;
 	};
 
 	///
@@ -52,19 +134,82 @@ namespace render
 	{
 	  public:
 
+		///
+		/// @brief Capacity of the geometry pool reserved for streamed primitives, see `upload`
+		///
+		struct PoolCapacity
+		{
+			uint32_t vertex_count;
+			uint32_t index_count;
+		};
+
+		///
+		/// @brief Region of the vertex and index buffers reserved for streamed primitives, in elements
+		/// @details Placed after the geometry uploaded up front, see `GeometryStreamer`
+		///
+		struct GeometryPool
+		{
+			uint32_t vertex_offset, vertex_count;
+			uint32_t index_offset, index_count;
+		};
+
 		///
 		/// @brief References to buffers
 		/// @note Beware of the lifetime
 		///
 		struct Ref
 		{
-			vulkan::ArrayBufferRef<model::FullVertex> vertex_buffer;
-			vulkan::ArrayBufferRef<uint32_t> index_buffer;
+			// Vertex buffer, element type is determined by `vertex_format`
+			vk::Buffer vertex_buffer;
+			VertexFormat vertex_format;
+
+			///
+			/// @brief FP32 position stream for acceleration structure builds and position-only passes
+			/// @details A separate tightly packed `glm::vec3` buffer for @p VertexFormat::Full with
+			/// `split_positions` (see `bake`), and for @p VertexFormat::Packed when ray tracing is enabled.
+			/// Otherwise aliases `vertex_buffer`, with `position_stride` being the vertex stride
+			///
+			vk::Buffer position_buffer;
+			vk::DeviceSize position_stride;
+
+			// Index buffer, element type is determined by `index_format`
+			vk::Buffer index_buffer;
+			IndexFormat index_format;
+
 			vulkan::ArrayBufferRef<PrimitiveAttribute> primitive_attr_buffer;
 
+			///
+			/// @brief Primitive attributes matching the acceleration structure geometry
+			/// @details Aliases `primitive_attr_buffer`, unless a geometry pool is reserved. The attributes
+			/// of streamed primitives are then rewritten in `primitive_attr_buffer`, but ray traced passes
+			/// keep indexing the geometry uploaded up front, which `primitive_attr_array` describes
+			///
+			vulkan::ArrayBufferRef<PrimitiveAttribute> trace_primitive_attr_buffer;
+
+			// Meshlets, offsets rebased to the meshlet vertex/triangle buffers
+			vulkan::ArrayBufferRef<model::Meshlet> meshlet_buffer;
+
+			// Meshlet-local vertices, indexing into the vertices of the owning primitive
+			vulkan::ArrayBufferRef<uint32_t> meshlet_vertex_buffer;
+
+			// Meshlet triangles, packed as `i0 | i1 << 8 | i2 << 16`
+			vulkan::ArrayBufferRef<uint32_t> meshlet_triangle_buffer;
+
 			std::span<const PrimitiveIndexRange> mesh_ranges_array;
 			std::span<const PrimitiveAttribute> primitive_attr_array;
 
+			///
+			/// @brief Hash of the geometry of each mesh, covering the vertices and indices of the full
+			/// geometry of its primitives
+			/// @details Meshes with equal hashes can share an acceleration structure, see `BlasList`. Only
+			/// comparable within the same mesh list
+			///
+			std::span<const uint64_t> mesh_geometry_hash_array;
+
+			uint32_t max_meshlet_count;  // Maximum meshlet count among all primitives
+
+			std::optional<GeometryPool> geometry_pool;  // `std::nullopt` if no pool is reserved
+
 			[[nodiscard]]
 			const Ref* operator->() const noexcept
 			{
@@ -72,17 +217,149 @@ namespace render
 			}
 		};
 
+		///
+		/// @brief Non-owning view of baked mesh data, see `Baked`
+		///
+		struct BakedView
+		{
+			VertexFormat vertex_format;
+			IndexFormat index_format;
+
+			std::span<const model::FullVertex> vertices;           // Empty for `VertexFormat::Packed`
+			std::span<const model::PackedVertex> packed_vertices;  // Empty for `VertexFormat::Full`
+			std::span<const glm::vec3> positions;                  // Separate position stream, if any
+			std::span<const uint32_t> indices;                     // Empty for `IndexFormat::Uint16`
+			std::span<const uint16_t> short_indices;               // Empty for `IndexFormat::Uint32`
+			std::span<const PrimitiveAttribute> primitive_attrs;
+			std::span<const PrimitiveIndexRange> mesh_primitive_index_ranges;
+
+			std::span<const model::Meshlet> meshlets;
+			std::span<const uint32_t> meshlet_vertices;
+			std::span<const uint32_t> meshlet_triangles;
+			uint32_t max_meshlet_count;
+
+			///
+			/// @brief Get the count of indices, in either format
+			///
+			[[nodiscard]]
+			size_t index_count() const noexcept
+			{
+				return indices.size() + short_indices.size();
+			}
+
+			///
+			/// @brief Get an index widened to 32 bits
+			///
+			/// @param index Position in the index buffer
+			/// @return Index, relative to the first vertex of its primitive
+			///
+			[[nodiscard]]
+			uint32_t get_index(size_t index) const noexcept
+			{
+				return index_format == IndexFormat::Uint16 ? short_indices[index] : indices[index];
+			}
+
+			///
+			/// @brief Get the raw bytes of a range of indices, as laid out in the index buffer
+			///
+			/// @param offset First index of the range
+			/// @param count Count of indices in the range
+			/// @return Bytes of the range
+			///
+			[[nodiscard]]
+			std::span<const std::byte> index_bytes(size_t offset, size_t count) const noexcept;
+		};
+
+		///
+		/// @brief CPU-side mesh data, laid out exactly as the GPU buffers of a mesh list
+		/// @details Can be uploaded or serialized as-is, without processing the source meshes again
+		///
+		struct Baked
+		{
+			VertexFormat vertex_format;
+			IndexFormat index_format;
+
+			std::vector<model::FullVertex> vertices;
+			std::vector<model::PackedVertex> packed_vertices;
+			std::vector<glm::vec3> positions;
+			std::vector<uint32_t> indices;
+			std::vector<uint16_t> short_indices;
+			std::vector<PrimitiveAttribute> primitive_attrs;
+			std::vector<PrimitiveIndexRange> mesh_primitive_index_ranges;
+
+			std::vector<model::Meshlet> meshlets;
+			std::vector<uint32_t> meshlet_vertices;
+			std::vector<uint32_t> meshlet_triangles;
+			uint32_t max_meshlet_count;
+
+			[[nodiscard]]
+			BakedView view() const noexcept;
+		};
+
+		///
+		/// @brief Bake meshes into GPU buffer layout on the CPU, without creating any GPU resources
+		/// @note For @p VertexFormat::Packed, the position stream is always baked regardless of device
+		/// features, so that the result can be uploaded on any device. Indices are baked as
+		/// @p IndexFormat::Uint16 if every primitive fits, see `IndexFormat`
+		///
+		/// @param mesh Host-side meshes
+		/// @param vertex_format GPU-side vertex format
+		/// @param split_positions Also bake a tightly packed position stream for @p VertexFormat::Full, so
+		/// that position-only passes and acceleration structure builds read 12 bytes per vertex instead of
+		/// the whole interleaved vertex. Always enabled for @p VertexFormat::Packed
+		/// @return Baked mesh data
+		///
+		[[nodiscard]]
+		static Baked bake(
+			std::span<const model::Mesh> mesh,
+			VertexFormat vertex_format,
+			bool split_positions = false
+		) noexcept;
+
+		///
+		/// @brief Create a mesh list from baked mesh data
+		/// @details With @p pool, only the coarsest level of detail of each primitive is uploaded, with its
+		/// vertices compacted, and the pool is reserved after it. The full geometry is expected to be
+		/// streamed into the pool from @p baked later, see `GeometryStreamer`. Meshlets are dropped in this
+		/// case.
+		/// @note The position stream of @p VertexFormat::Packed is skipped if ray tracing isn't enabled. The
+		/// position stream of @p VertexFormat::Full is dropped with @p pool, as streamed primitives only
+		/// write interleaved vertices
+		///
+		/// @param context Vulkan context
+		/// @param baked Baked mesh data, see `bake`
+		/// @param pool Capacity of the geometry pool, `std::nullopt` to upload the full geometry
+		/// @return Created mesh list or error
+		///
+		[[nodiscard]]
+		static std::expected<MeshList, Error> upload(
+			const vulkan::Context& context,
+			const BakedView& baked,
+			std::optional<PoolCapacity> pool = std::nullopt
+		) noexcept;
+
 		///
 		/// @brief Create a mesh list
+		/// @details Unlike `bake` followed by `upload`, the concatenated arrays are never built in host
+		/// memory. Offsets are computed from the primitive sizes first, then batches of primitives are
+		/// written in parallel straight into staging memory, which is submitted as it fills. The index format
+		/// is chosen as in `bake`
 		///
+		/// @param thread_pool Thread pool writing the batches
 		/// @param context Vulkan context
 		/// @param mesh Host-side meshes
+		/// @param vertex_format GPU-side vertex format
+		/// @param split_positions Also create a tightly packed position stream for @p VertexFormat::Full,
+		/// see `bake`
 		/// @return Created mesh list or error
 		///
 		[[nodiscard]]
-		static std::expected<MeshList, Error> create(
+		static coro::task<std::expected<MeshList, Error>> create(
+			coro::thread_pool& thread_pool,
 			const vulkan::Context& context,
-			std::span<const model::Mesh> mesh
+			std::span<const model::Mesh> mesh,
+			VertexFormat vertex_format = VertexFormat::Full,
+			bool split_positions = false
 		) noexcept;
 
 		Ref operator->() const noexcept { return get(); }
@@ -95,36 +372,83 @@ namespace render
 		[[nodiscard]]
 		Ref get() const noexcept
 		{
+			vk::Buffer position_stream = vertex_buffer;
+			vk::DeviceSize position_stride = vertex_stride(vertex_format);
+			if (position_buffer.has_value())
+			{
+				position_stream = *position_buffer;
+				position_stride = sizeof(glm::vec3);
+			}
+
 			return Ref{
 				.vertex_buffer = vertex_buffer,
+				.vertex_format = vertex_format,
+				.position_buffer = position_stream,
+				.position_stride = position_stride,
 				.index_buffer = index_buffer,
+				.index_format = index_format,
 				.primitive_attr_buffer = primitive_attr_buffer,
+				.trace_primitive_attr_buffer = trace_primitive_attr_buffer.has_value()
+					? vulkan::ArrayBufferRef<PrimitiveAttribute>(*trace_primitive_attr_buffer)
+					: vulkan::ArrayBufferRef<PrimitiveAttribute>(primitive_attr_buffer),
+				.meshlet_buffer = meshlet_buffer,
+				.meshlet_vertex_buffer = meshlet_vertex_buffer,
+				.meshlet_triangle_buffer = meshlet_triangle_buffer,
 				.mesh_ranges_array = mesh_primitive_index_ranges,
-				.primitive_attr_array = primitive_attributes
+				.primitive_attr_array = primitive_attributes,
+				.mesh_geometry_hash_array = mesh_geometry_hashes,
+				.max_meshlet_count = max_meshlet_count,
+				.geometry_pool = geometry_pool
 			};
 		}
 
 	  private:
 
-		vulkan::ArrayBuffer<model::FullVertex> vertex_buffer;
-		vulkan::ArrayBuffer<uint32_t> index_buffer;
+		vulkan::Buffer vertex_buffer;
+		VertexFormat vertex_format;
+		std::optional<vulkan::ArrayBuffer<glm::vec3>> position_buffer;
+		vulkan::Buffer index_buffer;
+		IndexFormat index_format;
 		vulkan::ArrayBuffer<PrimitiveAttribute> primitive_attr_buffer;
+		std::optional<vulkan::ArrayBuffer<PrimitiveAttribute>> trace_primitive_attr_buffer = std::nullopt;
+		vulkan::ArrayBuffer<model::Meshlet> meshlet_buffer;
+		vulkan::ArrayBuffer<uint32_t> meshlet_vertex_buffer;
+		vulkan::ArrayBuffer<uint32_t> meshlet_triangle_buffer;
 
 		std::vector<PrimitiveIndexRange> mesh_primitive_index_ranges;
 		std::vector<PrimitiveAttribute> primitive_attributes;
+		std::vector<uint64_t> mesh_geometry_hashes;
+		uint32_t max_meshlet_count;
+		std::optional<GeometryPool> geometry_pool = std::nullopt;
 
 		explicit MeshList(
-			vulkan::ArrayBuffer<model::FullVertex> vertex_buffer,
-			vulkan::ArrayBuffer<uint32_t> index_buffer,
+			vulkan::Buffer vertex_buffer,
+			VertexFormat vertex_format,
+			std::optional<vulkan::ArrayBuffer<glm::vec3>> position_buffer,
+			vulkan::Buffer index_buffer,
+			IndexFormat index_format,
 			vulkan::ArrayBuffer<PrimitiveAttribute> primitive_attr_buffer,
+			vulkan::ArrayBuffer<model::Meshlet> meshlet_buffer,
+			vulkan::ArrayBuffer<uint32_t> meshlet_vertex_buffer,
+			vulkan::ArrayBuffer<uint32_t> meshlet_triangle_buffer,
 			std::vector<PrimitiveIndexRange> mesh_primitive_index_ranges,
-			std::vector<PrimitiveAttribute> primitive_attributes
+			std::vector<PrimitiveAttribute> primitive_attributes,
+			std::vector<uint64_t> mesh_geometry_hashes,
+			uint32_t max_meshlet_count
 		) :
 			vertex_buffer(std::move(vertex_buffer)),
+			vertex_format(vertex_format),
+			position_buffer(std::move(position_buffer)),
 			index_buffer(std::move(index_buffer)),
+			index_format(index_format),
 			primitive_attr_buffer(std::move(primitive_attr_buffer)),
+			meshlet_buffer(std::move(meshlet_buffer)),
+			meshlet_vertex_buffer(std::move(meshlet_vertex_buffer)),
+			meshlet_triangle_buffer(std::move(meshlet_triangle_buffer)),
 			mesh_primitive_index_ranges(std::move(mesh_primitive_index_ranges)),
-			primitive_attributes(std::move(primitive_attributes))
+			primitive_attributes(std::move(primitive_attributes)),
+			mesh_geometry_hashes(std::move(mesh_geometry_hashes)),
+			max_meshlet_count(max_meshlet_count)
 		{}
 
 	  public:
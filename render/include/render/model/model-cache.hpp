@@ -0,0 +1,139 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/model/model.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace render
+{
+	///
+	/// @brief Versioned, memory-mapped binary cache of a baked model, see `Model::Baked`
+	/// @details A cache file stores everything `Model::create` needs after CPU-side processing: hierarchy,
+	/// materials, pre-encoded texture mipmap chains, mesh buffers in their final GPU layout and lights.
+	/// Loading from a cache skips source parsing, mesh processing and texture encoding entirely, the mapped
+	/// data is copied directly into staging buffers.
+	///
+	/// Bulk arrays (vertices, indices, texels and texture levels) can be stored as compressed payloads,
+	/// see `model::encode_payload`. Compressed blobs are decoded on the CPU in parallel by `open`, the
+	/// others stay mapped.
+	///
+	/// A cache is only valid for the same @p Key, which covers the content of the source file, the options
+	/// affecting baked data and the memory layout of the serialized types. Mismatching caches are rejected
+	/// by `open`, the caller is expected to re-bake and `write` the cache in that case.
+	///
+	class ModelCache
+	{
+	  public:
+
+		///
+		/// @brief Version of the file format, bump on any format change
+		///
+		static constexpr uint32_t VERSION = 6;
+
+		///
+		/// @brief Key identifying the content of a cache
+		///
+		struct Key
+		{
+			uint64_t source_hash;  // Hash of the source file, see `hash_file`
+			uint64_t option_hash;  // Hash of the baking options and serialized type layouts
+
+			[[nodiscard]]
+			bool operator==(const Key&) const noexcept = default;
+		};
+
+		///
+		/// @brief Hash the content of a source file
+		/// @note Only the given file is hashed. Resources referenced by it (e.g. external buffers and images
+		/// of a glTF file) are not covered, remove the cache manually after modifying them.
+		///
+		/// @param path Path to the source file
+		/// @return Hash of the file content, or error if the file can't be read
+		///
+		[[nodiscard]]
+		static std::expected<uint64_t, Error> hash_file(const std::filesystem::path& path) noexcept;
+
+		///
+		/// @brief Get the cache key for a source file and loading options
+		///
+		/// @param source_hash Hash of the source file, see `hash_file`
+		/// @param option Options used for baking, GPU-only fields are ignored
+		/// @return Cache key
+		///
+		[[nodiscard]]
+		static Key get_key(uint64_t source_hash, const Model::Option& option) noexcept;
+
+		///
+		/// @brief Open and validate a cache file
+		///
+		/// @param path Path to the cache file
+		/// @param key Expected key of the cache
+		/// @return Opened cache, or error if the file doesn't exist, is outdated or is corrupted
+		///
+		[[nodiscard]]
+		static std::expected<ModelCache, Error> open(const std::filesystem::path& path, Key key) noexcept;
+
+		///
+		/// @brief Write a baked model into a cache file
+		/// @note The file is written to a temporary path first and then renamed, an existing cache is never
+		/// left half-written
+		///
+		/// @param path Path to the cache file, parent directories are created if needed
+		/// @param key Key of the cache
+		/// @param baked Baked model
+		/// @param compress Compress the bulk arrays, each is kept as-is if it doesn't shrink. Smaller files
+		/// load faster from disk, at the cost of decoding them on open
+		/// @return `void` on success, or error
+		///
+		[[nodiscard]]
+		static std::expected<void, Error> write(
+			const std::filesystem::path& path,
+			Key key,
+			const Model::BakedView& baked,
+			bool compress = false
+		) noexcept;
+
+		///
+		/// @brief Get the baked model stored in the cache
+		/// @warning The view references the mapped file and the decoded blobs, keep the cache alive while
+		/// using it
+		///
+		/// @return View of the baked model
+		///
+		[[nodiscard]]
+		const Model::BakedView& view() const noexcept
+		{
+			return baked;
+		}
+
+	  private:
+
+		std::shared_ptr<const void> mapping;  // Keeps the file mapped
+		std::vector<std::byte> decoded;       // Decoded compressed blobs
+		Model::BakedView baked;
+
+		explicit ModelCache(
+			std::shared_ptr<const void> mapping,
+			std::vector<std::byte> decoded,
+			Model::BakedView baked
+		) :
+			mapping(std::move(mapping)),
+			decoded(std::move(decoded)),
+			baked(std::move(baked))
+		{}
+
+	  public:
+
+		ModelCache(const ModelCache&) = delete;
+		ModelCache(ModelCache&&) = default;
+		ModelCache& operator=(const ModelCache&) = delete;
+		ModelCache& operator=(ModelCache&&) = default;
+	};
+}
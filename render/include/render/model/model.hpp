@@ -2,19 +2,31 @@
 
 #include "common/util/error.hpp"
 #include "common/util/tagged-type.hpp"
+#include "model/animation.hpp"
 #include "model/hierarchy.hpp"
+#include "model/light.hpp"
 #include "model/model.hpp"
 #include "render/model/blas.hpp"
+#include "render/model/deform-list.hpp"
+#include "render/model/emissive-list.hpp"
+#include "render/model/impostor-list.hpp"
+#include "render/model/light-list.hpp"
 #include "render/model/material.hpp"
 #include "render/model/mesh.hpp"
+#include "render/model/scene-graph.hpp"
 #include "render/model/texture-list.hpp"
 #include "vulkan/interface/context.hpp"
 
 #include <coro/task.hpp>
 #include <coro/thread_pool.hpp>
+#include <cstdint>
 #include <expected>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <utility>
+#include <vector>
 
 namespace render
 {
@@ -42,7 +54,7 @@ namespace render
 		/// @brief Progress of loading model
 		///
 		///
-		using Progress = util::SyncedEnumVariant<
+		using Progress = util::AtomicEnumVariant<
 			util::Tag<ProgressState::Preparing>,
 			util::Tag<ProgressState::Material, std::shared_ptr<const MaterialList::Progress>>,
 			util::Tag<ProgressState::Mesh>,
@@ -56,18 +68,86 @@ namespace render
 		struct Option
 		{
 			TextureList::LoadOption texture_load_option;
+
+			// Shared sampler cache and sampling policy, see `MaterialList::SamplerOption`
+			MaterialList::SamplerOption sampler_option = {};
+
+			// Compact BLASes after building, see `BlasList::create`
+			bool compact_blas = false;
+
+			// Build BLASes with `BlasList::BuildPreference::FastBuild` and without compaction to finish
+			// loading sooner, `compact_blas` is ignored. Rebuild them for fast trace while rendering
+			bool fast_build_blas = false;
+
+			// GPU-side vertex format, pipelines must be created with the same format
+			VertexFormat vertex_format = VertexFormat::Full;
+
+			// Also store a tightly packed position stream for `VertexFormat::Full`, read by position-only
+			// passes and BLAS builds, see `MeshList::bake`
+			bool split_positions = false;
+
+			// Reorder primitives for vertex cache, overdraw and vertex fetch, see `model::Geometry::optimize`
+			bool optimize_mesh = false;
+
+			// Generate a LOD chain for each primitive, see `model::Geometry::simplify`
+			bool generate_lod = false;
+
+			// Upload coarse geometry and reserve a pool for streaming the rest, see `MeshList::upload`. Only
+			// used when loading from a baked model
+			std::optional<MeshList::PoolCapacity> geometry_pool = std::nullopt;
+
+			// Nodes and drawcall slots reserved for instances added at runtime, see `InstanceList`
+			SceneGraph::InstanceCapacity instance_capacity = {};
+		};
+
+		///
+		/// @brief Non-owning view of a baked model, see `Baked`
+		///
+		struct BakedView
+		{
+			std::span<const model::ParentOnlyNode> nodes;
+			std::span<const model::Material> materials;
+			std::vector<TextureList::BakedTupleView> textures;
+			MeshList::BakedView mesh;
+			std::span<const model::Light> lights;
+			std::span<const model::HlodCluster> hlod_clusters;
+			std::span<const uint32_t> hlod_source_nodes;
+			ImpostorList::BakedView impostor;
+
+			// Serialized BLASes, see `BlasCache`. Built as usual if absent or incompatible with the device
+			std::optional<BlasList::SerializedView> blas = std::nullopt;
+		};
+
+		///
+		/// @brief CPU-side model with all expensive processing done (mesh optimization, LOD generation,
+		/// texture encoding, etc.), ready to be uploaded or serialized into a `ModelCache`
+		///
+		struct Baked
+		{
+			std::vector<model::ParentOnlyNode> nodes;
+			std::vector<model::Material> materials;
+			std::vector<TextureList::BakedTuple> textures;
+			MeshList::Baked mesh;
+			std::vector<model::Light> lights;
+			std::vector<model::HlodCluster> hlod_clusters;
+			std::vector<uint32_t> hlod_source_nodes;
+			ImpostorList::Baked impostor;
+
+			[[nodiscard]]
+			BakedView view() const noexcept;
 		};
 
 		///
 		/// @brief Load a model from a CPU-side `model::Model`
 		///
-		/// @warning The caller must eep the references alive and stable in address while loading
+		/// @warning The caller must keep the references alive and stable in address while loading
 		///
 		/// @param thread_pool Coroutine thread pool
 		/// @param context Vulkan context
 		/// @param material_layout Material layout of the model. Create one before loading a model
 		/// @param model CPU-side model data
 		/// @param option Option of loading model
+		/// @param stop_token Stop token, loading fails at the next checkpoint once a stop is requested
 		/// @return The coroutine task and a shared pointer to the progress
 		///
 		[[nodiscard]]
@@ -76,7 +156,52 @@ namespace render
 			const vulkan::Context& context,
 			const MaterialLayout& material_layout,
 			const model::Model& model,
-			Option option = {}
+			Option option = {},
+			std::stop_token stop_token = {}
+		) noexcept;
+
+		///
+		/// @brief Bake a CPU-side `model::Model` without creating any GPU resources
+		/// @note GPU-related fields of @p option (e.g. `compact_blas`) are ignored
+		///
+		/// @warning The caller must keep the references alive and stable in address while baking
+		///
+		/// @param thread_pool Coroutine thread pool
+		/// @param model CPU-side model data
+		/// @param option Option of loading model
+		/// @param stop_token Stop token, baking fails at the next checkpoint once a stop is requested
+		/// @return The coroutine task and a shared pointer to the progress
+		///
+		[[nodiscard]]
+		static std::pair<coro::task<std::expected<Baked, Error>>, std::shared_ptr<const Progress>> bake(
+			coro::thread_pool& thread_pool,
+			const model::Model& model,
+			Option option = {},
+			std::stop_token stop_token = {}
+		) noexcept;
+
+		///
+		/// @brief Load a model from a baked model, skipping all CPU-side processing
+		/// @note `option.vertex_format` must match the vertex format of @p baked
+		///
+		/// @warning The caller must keep the references alive and stable in address while loading
+		///
+		/// @param thread_pool Coroutine thread pool
+		/// @param context Vulkan context
+		/// @param material_layout Material layout of the model
+		/// @param baked Baked model, see `bake` and `ModelCache`
+		/// @param option Option of loading model, CPU-side processing fields are ignored
+		/// @param stop_token Stop token, loading fails at the next checkpoint once a stop is requested
+		/// @return The coroutine task and a shared pointer to the progress
+		///
+		[[nodiscard]]
+		static std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Progress>> create(
+			coro::thread_pool& thread_pool,
+			const vulkan::Context& context,
+			const MaterialLayout& material_layout,
+			const BakedView& baked,
+			Option option = {},
+			std::stop_token stop_token = {}
 		) noexcept;
 
 		///
@@ -100,18 +225,63 @@ namespace render
 		///
 		BlasList blas_list;
 
+		///
+		/// @brief GPU-side flattened hierarchy and drawcalls of the model
+		///
+		SceneGraph scene_graph;
+
+		///
+		/// @brief GPU-side punctual lights of the model
+		///
+		LightList light_list;
+
+		///
+		/// @brief GPU-side emissive triangles of the model
+		///
+		EmissiveList emissive_list;
+
+		///
+		/// @brief GPU-side deformation data of the model
+		/// @note `std::nullopt` if no mesh is deformable, or the model is loaded from a baked model
+		///
+		std::optional<DeformList> deform_list;
+
+		///
+		/// @brief Animations of the model, sampled by host to pose the hierarchy and the deform list
+		/// @note Empty if the model is loaded from a baked model, which has no deformation data
+		///
+		std::vector<model::Animation> animations;
+
+		///
+		/// @brief GPU-side impostors of the model, see `model::bake_impostors`
+		/// @note Always created, check `ImpostorList::empty` for whether the model has impostors
+		///
+		ImpostorList impostor_list;
+
 	  private:
 
 		explicit Model(
 			model::Hierarchy hierarchy,
 			MeshList mesh_list,
 			MaterialList material_list,
-			BlasList blas_list
+			BlasList blas_list,
+			SceneGraph scene_graph,
+			LightList light_list,
+			EmissiveList emissive_list,
+			std::optional<DeformList> deform_list,
+			std::vector<model::Animation> animations,
+			ImpostorList impostor_list
 		) :
 			hierarchy(std::move(hierarchy)),
 			mesh_list(std::move(mesh_list)),
 			material_list(std::move(material_list)),
-			blas_list(std::move(blas_list))
+			blas_list(std::move(blas_list)),
+			scene_graph(std::move(scene_graph)),
+			light_list(std::move(light_list)),
+			emissive_list(std::move(emissive_list)),
+			deform_list(std::move(deform_list)),
+			animations(std::move(animations)),
+			impostor_list(std::move(impostor_list))
 		{}
 
 		[[nodiscard]]
@@ -121,14 +291,56 @@ namespace render
 			const vulkan::Context& context,
 			const MaterialLayout& material_layout,
 			const model::Model& model,
-			Option option
+			Option option,
+			std::stop_token stop_token
+		) noexcept;
+
+		[[nodiscard]]
+		static coro::task<std::expected<Baked, Error>> bake_impl(
+			coro::thread_pool& thread_pool,
+			std::shared_ptr<Progress> progress,
+			const model::Model& model,
+			Option option,
+			std::stop_token stop_token
+		) noexcept;
+
+		[[nodiscard]]
+		static coro::task<std::expected<Model, Error>> create_baked_impl(
+			coro::thread_pool& thread_pool,
+			std::shared_ptr<Progress> progress,
+			const vulkan::Context& context,
+			const MaterialLayout& material_layout,
+			const BakedView& baked,
+			Option option,
+			std::stop_token stop_token
 		) noexcept;
 
 		[[nodiscard]]
 		static coro::task<std::expected<MeshList, Error>> create_mesh(
 			coro::thread_pool& thread_pool,
 			const vulkan::Context& context,
-			const model::Model& model
+			const model::Model& model,
+			Option option,
+			std::stop_token stop_token
+		) noexcept;
+
+		// Optimize and generate LODs for all primitives in parallel, `std::nullopt` if nothing to process.
+		// Primitives not yet started are left unprocessed once a stop is requested, check after awaiting
+		[[nodiscard]]
+		static coro::task<std::optional<std::vector<model::Mesh>>> process_meshes(
+			coro::thread_pool& thread_pool,
+			const model::Model& model,
+			Option option,
+			std::stop_token stop_token
+		) noexcept;
+
+		[[nodiscard]]
+		static coro::task<model::Primitive> process_primitive(
+			coro::thread_pool& thread_pool,
+			const model::Primitive& primitive,
+			bool optimize,
+			bool generate_lod,
+			std::stop_token stop_token
 		) noexcept;
 
 		[[nodiscard]]
@@ -136,7 +348,10 @@ namespace render
 			coro::thread_pool& thread_pool,
 			const vulkan::Context& context,
 			const MaterialList& material_list,
-			const MeshList& mesh_list
+			const MeshList& mesh_list,
+			Option option,
+			std::stop_token stop_token,
+			std::span<const uint32_t> deformable_meshes = {}
 		) noexcept;
 
 	  public:
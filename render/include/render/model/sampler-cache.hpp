@@ -0,0 +1,79 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model/texture.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <compare>
+#include <expected>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Cache of texture samplers, shared across material lists and models
+	/// @details Samplers are owned by the material lists using them, the cache only keeps weak references.
+	/// Identical samplers of every loaded model are thus created once, keeping large scenes far below
+	/// `maxSamplerAllocationCount`, and a sampler is destroyed with the last material list using it.
+	///
+	/// @note Thread-safe, models may load concurrently
+	///
+	class SamplerCache
+	{
+	  public:
+
+		///
+		/// @brief Sampling policy applied on top of the sample mode of each texture
+		///
+		struct Policy
+		{
+			// Maximum anisotropy, clamped to the device limit. `1` or lower disables anisotropic filtering,
+			// which saves texture bandwidth on low-end devices
+			float max_anisotropy = 4.0f;
+
+			// Bias added to the computed mip level, positive values sample smaller mips
+			float lod_bias = 0.0f;
+
+			[[nodiscard]]
+			auto operator<=>(const Policy&) const noexcept = default;
+
+			[[nodiscard]]
+			bool operator==(const Policy&) const noexcept = default;
+		};
+
+		///
+		/// @brief Get a sampler, creating it if no live sampler matches
+		///
+		/// @param context Vulkan context
+		/// @param sample_mode Sample mode of the texture
+		/// @param policy Sampling policy
+		/// @return Shared sampler, or error
+		///
+		[[nodiscard]]
+		std::expected<std::shared_ptr<const vk::raii::Sampler>, Error> get(
+			const vulkan::Context& context,
+			const model::SampleMode& sample_mode,
+			Policy policy
+		) noexcept;
+
+	  private:
+
+		struct Key
+		{
+			model::SampleMode sample_mode;
+			Policy policy;  // Clamped to the device limit
+
+			[[nodiscard]]
+			auto operator<=>(const Key&) const noexcept = default;
+
+			[[nodiscard]]
+			bool operator==(const Key&) const noexcept = default;
+		};
+
+		std::mutex mutex;
+		std::map<Key, std::weak_ptr<const vk::raii::Sampler>> samplers;
+	};
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "model/hierarchy.hpp"
+#include "model/model.hpp"
+#include "render/interface/hlod-cluster.hpp"
+#include "render/interface/primitive-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/util/per-render-state.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace render
+{
+	///
+	/// @brief Range of nodes of the same depth, indexing into the BFS order of the hierarchy
+	///
+	struct NodeLevelRange
+	{
+		uint32_t offset, count;
+	};
+
+	///
+	/// @brief GPU-side flattened hierarchy and drawcalls of a model
+	/// @details
+	/// - Nodes are flattened in BFS order and grouped by depth, world transforms are then computed on GPU
+	/// level by level. See `TransformPipeline`.
+	/// - Drawcalls only depend on the hierarchy, meshes and materials, thus are generated and uploaded once
+	/// when creating
+	/// - Drawcalls are split into buckets, each culled into its own `IndirectResource`, see `Bucket`
+	/// - Optionally reserves root nodes and drawcall slots for instances added at runtime, see
+	/// `InstanceCapacity` and `InstanceList`. Reserved nodes follow the hierarchy nodes as an extra level,
+	/// reserved drawcalls follow the drawcalls of the hierarchy in every render state of both buckets, and
+	/// stay hidden (see `PrimitiveDrawcall::HIDDEN`) until used
+	/// - Optionally holds HLOD clusters (see `model::HlodList`), with an HLOD entry per node telling the
+	/// culling pass whether the node is a source or the proxy of a cluster, see `IndirectPipeline::compute`
+	///
+	class SceneGraph
+	{
+	  public:
+
+		// Parent index of the root node
+		static constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+
+		///
+		/// @brief Drawcall bucket, selecting the pass the drawcalls are drawn in
+		///
+		enum class Bucket
+		{
+			Main,    // Opaque and alpha-masked drawcalls, drawn into the G-buffer
+			Blended  // `AlphaMode::Blend` drawcalls in the masked render states, see `TransparentPipeline`
+		};
+
+		///
+		/// @brief Capacity reserved for instances added at runtime
+		///
+		struct InstanceCapacity
+		{
+			uint32_t node_count = 0;      // Reserved root nodes, one for each instance
+			uint32_t drawcall_count = 0;  // Reserved drawcall slots in each render state of each bucket
+		};
+
+		///
+		/// @brief References to buffers
+		/// @note Beware of the lifetime
+		///
+		struct Ref
+		{
+			vulkan::ArrayBufferRef<uint32_t> bfs_order_buffer;        // Node indices in BFS order
+			vulkan::ArrayBufferRef<uint32_t> parent_buffer;           // Parent index of each node
+			vulkan::ArrayBufferRef<glm::mat4> local_transform_buffer;  // Local transform of each node
+			PerRenderState<vulkan::ArrayBufferRef<PrimitiveDrawcall>> drawcall_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<PrimitiveDrawcall>> blended_drawcall_buffers;
+			vulkan::ArrayBufferRef<HlodCluster> hlod_cluster_buffer;  // Padded with a dummy if empty
+			vulkan::ArrayBufferRef<uint32_t> node_hlod_buffer;       // HLOD entry of each node, see `NO_HLOD`
+
+			std::span<const NodeLevelRange> level_ranges;
+			uint32_t node_count;
+
+			[[nodiscard]]
+			const Ref* operator->() const noexcept
+			{
+				return this;
+			}
+
+			[[nodiscard]]
+			PerRenderState<vulkan::ArrayBufferRef<PrimitiveDrawcall>> bucket(Bucket bucket) const noexcept
+			{
+				return bucket == Bucket::Blended ? blended_drawcall_buffers : drawcall_buffers;
+			}
+		};
+
+		///
+		/// @brief Create a scene graph
+		///
+		/// @param context Vulkan context
+		/// @param hierarchy Hierarchy of the model
+		/// @param mesh_list Mesh list of the model
+		/// @param material_list Material list of the model
+		/// @param instance_capacity Capacity reserved for instances added at runtime
+		/// @param hlod_clusters HLOD clusters of the model, see `model::HlodList`
+		/// @param hlod_source_nodes Source nodes of the HLOD clusters, see `model::HlodList`
+		/// @return Created scene graph or error
+		///
+		[[nodiscard]]
+		static std::expected<SceneGraph, Error> create(
+			const vulkan::Context& context,
+			const model::Hierarchy& hierarchy,
+			const MeshList& mesh_list,
+			const MaterialList& material_list,
+			InstanceCapacity instance_capacity = {},
+			std::span<const model::HlodCluster> hlod_clusters = {},
+			std::span<const uint32_t> hlod_source_nodes = {}
+		) noexcept;
+
+		Ref operator->() const noexcept { return get(); }
+
+		///
+		/// @brief Get the references to the GPU buffers and level ranges
+		///
+		/// @return References to the GPU buffers and level ranges
+		///
+		[[nodiscard]]
+		Ref get() const noexcept;
+
+		///
+		/// @brief Get the capacity reserved for instances
+		///
+		/// @return Capacity passed to `create()`
+		///
+		[[nodiscard]]
+		InstanceCapacity instance_capacity() const noexcept
+		{
+			return reserved_capacity;
+		}
+
+		///
+		/// @brief Check if a node is the proxy of an HLOD cluster
+		/// @note Proxies only stand in for their cluster in rasterization, ray traced passes should skip them
+		///
+		/// @param node_index Index of the node
+		/// @return `true` if the node is an HLOD proxy
+		///
+		[[nodiscard]]
+		bool is_hlod_proxy(uint32_t node_index) const noexcept;
+
+		///
+		/// @brief Get drawcall counts of each render state, including the reserved instance slots
+		///
+		/// @param bucket Drawcall bucket
+		/// @return Drawcall counts
+		///
+		[[nodiscard]]
+		PerRenderState<size_t> drawcall_counts(Bucket bucket = Bucket::Main) const noexcept
+		{
+			const auto& buffers = bucket == Bucket::Blended ? blended_drawcall_buffers : drawcall_buffers;
+			return buffers.map([](const auto& buffer) { return static_cast<size_t>(buffer.count()); });
+		}
+
+	  private:
+
+		vulkan::ArrayBuffer<uint32_t> bfs_order_buffer;
+		vulkan::ArrayBuffer<uint32_t> parent_buffer;
+		vulkan::ArrayBuffer<glm::mat4> local_transform_buffer;
+		PerRenderState<vulkan::ArrayBuffer<PrimitiveDrawcall>> drawcall_buffers;
+		PerRenderState<vulkan::ArrayBuffer<PrimitiveDrawcall>> blended_drawcall_buffers;
+		vulkan::ArrayBuffer<HlodCluster> hlod_cluster_buffer;
+		vulkan::ArrayBuffer<uint32_t> node_hlod_buffer;
+
+		std::vector<NodeLevelRange> level_ranges;
+		std::vector<uint32_t> hlod_proxy_nodes;  // Sorted
+		InstanceCapacity reserved_capacity;
+
+		explicit SceneGraph(
+			vulkan::ArrayBuffer<uint32_t> bfs_order_buffer,
+			vulkan::ArrayBuffer<uint32_t> parent_buffer,
+			vulkan::ArrayBuffer<glm::mat4> local_transform_buffer,
+			PerRenderState<vulkan::ArrayBuffer<PrimitiveDrawcall>> drawcall_buffers,
+			PerRenderState<vulkan::ArrayBuffer<PrimitiveDrawcall>> blended_drawcall_buffers,
+			vulkan::ArrayBuffer<HlodCluster> hlod_cluster_buffer,
+			vulkan::ArrayBuffer<uint32_t> node_hlod_buffer,
+			std::vector<NodeLevelRange> level_ranges,
+			std::vector<uint32_t> hlod_proxy_nodes,
+			InstanceCapacity reserved_capacity
+		) :
+			bfs_order_buffer(std::move(bfs_order_buffer)),
+			parent_buffer(std::move(parent_buffer)),
+			local_transform_buffer(std::move(local_transform_buffer)),
+			drawcall_buffers(std::move(drawcall_buffers)),
+			blended_drawcall_buffers(std::move(blended_drawcall_buffers)),
+			hlod_cluster_buffer(std::move(hlod_cluster_buffer)),
+			node_hlod_buffer(std::move(node_hlod_buffer)),
+			level_ranges(std::move(level_ranges)),
+			hlod_proxy_nodes(std::move(hlod_proxy_nodes)),
+			reserved_capacity(reserved_capacity)
+		{}
+
+	  public:
+
+		SceneGraph(const SceneGraph&) = delete;
+		SceneGraph(SceneGraph&&) = default;
+		SceneGraph& operator=(const SceneGraph&) = delete;
+		SceneGraph& operator=(SceneGraph&&) = default;
+	};
+}
@@ -2,9 +2,12 @@
 
 #include "common/util/async.hpp"
 #include "common/util/error.hpp"
+#include "image/bc-image.hpp"
 #include "model/material.hpp"
 #include "model/texture.hpp"
+#include "render/model/bcn-encoder.hpp"
 #include "render/model/texture.hpp"
+#include "vulkan/alloc/image.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/util/static-resource-creator.hpp"
 
@@ -16,7 +19,10 @@
 #include <expected>
 #include <memory>
 #include <optional>
+#include <span>
+#include <stop_token>
 #include <utility>
+#include <variant>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -25,6 +31,13 @@ namespace render
 {
 	///
 	/// @brief GPU texture list class, managing all textures used in `model::MaterialList`
+	/// @details Textures are deduplicated by the content of their source (see `model::Texture::hash_source`)
+	/// before decoding, so byte-identical images referenced through different files, buffers or materials
+	/// are decoded, encoded and uploaded once, and share the same `Texture`
+	/// - When uploading baked textures, small textures of the same format and mipmap extents are packed
+	/// into the layers of shared 2D array images (see `LoadOption::pack_max_size`), which cuts the image
+	/// objects and allocations of models with many small textures. Each texture is still sampled through
+	/// its own single-layer view, so packing is transparent to materials and shaders.
 	///
 	class TextureList
 	{
@@ -36,7 +49,13 @@ namespace render
 		///
 		struct LoadOption
 		{
+			// Load strategies are fitted to the formats supported by the device when loading, see
+			// `Texture::CompressionSupport::fit`. Callers of `bake` fit them for the target device
 			Texture::ColorLoadStrategy color_load_strategy = Texture::ColorLoadStrategy::BalancedBC;
+
+			// Speed/quality of color textures encoded in BC7 by `color_load_strategy`
+			image::BC7Quality bc7_quality = {};
+
 			Texture::NormalLoadStrategy normal_load_strategy = Texture::NormalLoadStrategy::AllBC5;
 			vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled;
 
@@ -46,6 +65,20 @@ namespace render
 
 			// Max size of pending upload data allowed during loading
 			size_t max_pending_data_size = 16 * 1048576;
+
+			// Limit of the larger dimension of loaded textures, `0` for unlimited. Used to load
+			// low-resolution textures up front when streaming, see `TextureStreamer`
+			uint32_t max_size = 0;
+
+			// Set to `true` to encode BCn textures on the GPU (see `BcnEncoder`), which loads faster at lower
+			// quality and ignores `bc7_quality`. Uncompressed mipmap chains stay in GPU memory until all
+			// textures are loaded
+			bool gpu_encode = false;
+
+			// Baked textures at most this size in both dimensions are packed into shared array images by
+			// `upload`, if they have the same format and mipmap extents. `0` to upload every texture into
+			// its own image
+			uint32_t pack_max_size = 256;
 		};
 
 		///
@@ -56,7 +89,8 @@ namespace render
 		/// @param material_list Material list to load textures
 		/// @param load_option Options for texture loading
 		/// @param progress Progress reporter for texture loading progress, will be incremented by 1 for each
-		/// loaded texture
+		/// loaded unique texture
+		/// @param stop_token Stop token, textures not yet started fail once a stop is requested
 		/// @return Created `TextureList` on success, or an `Error` on failure
 		///
 		[[nodiscard]]
@@ -65,6 +99,64 @@ namespace render
 			util::Progress progress,
 			const vulkan::Context& context,
 			const model::MaterialList& material_list,
+			LoadOption load_option,
+			std::stop_token stop_token = {}
+		) noexcept;
+
+		///
+		/// @brief Baked textures of a single `model::MaterialList` texture, see `Texture::Baked`
+		/// @note Textures that failed to load are `std::nullopt`, same as in `TextureList`
+		///
+		struct BakedTuple
+		{
+			std::optional<Texture::Baked> color;
+			std::optional<Texture::Baked> normal;
+			model::SampleMode sample_mode;
+		};
+
+		///
+		/// @brief Non-owning view of `BakedTuple`
+		///
+		struct BakedTupleView
+		{
+			std::optional<Texture::BakedView> color;
+			std::optional<Texture::BakedView> normal;
+			model::SampleMode sample_mode;
+		};
+
+		///
+		/// @brief Bake all textures of a material list on the CPU, without creating any GPU resources
+		/// @note Unlike `create`, all baked textures are kept in memory until returned
+		///
+		/// @param thread_pool Thread pool for asynchronous baking
+		/// @param progress Progress reporter, incremented by 1 for each baked unique texture
+		/// @param material_list Material list to bake textures
+		/// @param load_option Options for texture loading, GPU-related fields are ignored
+		/// @param stop_token Stop token, textures not yet started fail once a stop is requested
+		/// @return Baked textures, one-to-one corresponding to `model::MaterialList::textures`, or an `Error`
+		///
+		[[nodiscard]]
+		static coro::task<std::expected<std::vector<BakedTuple>, Error>> bake(
+			coro::thread_pool& thread_pool,
+			util::Progress progress,
+			const model::MaterialList& material_list,
+			LoadOption load_option,
+			std::stop_token stop_token = {}
+		) noexcept;
+
+		///
+		/// @brief Create a texture list from baked textures
+		/// @details Small textures are packed into shared array images, see `LoadOption::pack_max_size`
+		///
+		/// @param context Vulkan device context
+		/// @param textures Baked textures, see `bake`
+		/// @param load_option Options for texture loading, only GPU-related fields are used
+		/// @return Created `TextureList` on success, or an `Error` on failure
+		///
+		[[nodiscard]]
+		static std::expected<TextureList, Error> upload(
+			const vulkan::Context& context,
+			std::span<const BakedTupleView> textures,
 			LoadOption load_option
 		) noexcept;
 
@@ -76,6 +168,9 @@ namespace render
 		{
 			Texture::Ref texture;
 			model::SampleMode sample_mode;
+
+			// Index of the texture in the list, `std::nullopt` for fallback and error hint textures
+			std::optional<uint32_t> index = std::nullopt;
 		};
 
 		///
@@ -110,12 +205,52 @@ namespace render
 		{
 			std::optional<Texture> color;
 			std::optional<Texture> normal;
+		};
+
+		// Texture tuple referencing images owned by `images`
+		struct TextureRefTuple
+		{
+			std::optional<Texture::Ref> color;
+			std::optional<Texture::Ref> normal;
+		};
+
+		// Texture of a `model::MaterialList` texture, references a tuple shared by all textures of the same
+		// content
+		struct TextureEntry
+		{
+			uint32_t tuple_index;
 			model::SampleMode sample_mode;
 		};
 
-		std::unique_ptr<std::vector<TextureTuple>> textures;
+		// Uploaded texture, either ready or waiting for GPU encoding
+		using LoadedTexture = std::variant<Texture, BcnEncoder::Source>;
+
+		struct LoadedTuple
+		{
+			std::optional<LoadedTexture> color;
+			std::optional<LoadedTexture> normal;
+		};
+
+		// Textures of unique content in a `model::MaterialList`
+		struct TextureGroups
+		{
+			// First texture of each unique content, with the usages of all textures of that content merged
+			std::vector<std::pair<const model::Texture*, model::TextureUsage>> unique_textures;
+
+			// Index into `unique_textures` of each `model::MaterialList` texture
+			std::vector<uint32_t> unique_indices;
+		};
+
+		// Images of all textures in `textures`, an array image holds all textures packed into its layers
+		std::vector<vulkan::Image> images;
+
+		std::vector<TextureRefTuple> textures;
+		std::vector<TextureEntry> entries;
 		std::unique_ptr<Texture> color_fallback, normal_fallback, error_hint_texture;
 
+		// Vulkan guarantees at least this many array layers per image
+		static constexpr uint32_t PACK_MAX_LAYERS = 256;
+
 		static constexpr model::SampleMode FALLBACK_SAMPLE_MODE = {};
 		static constexpr model::SampleMode ERROR_HINT_SAMPLE_MODE = {
 			.min_filter = model::Filter::Nearest,
@@ -125,22 +260,35 @@ namespace render
 		};
 
 		TextureList(
-			std::vector<TextureTuple> textures,
+			std::vector<vulkan::Image> images,
+			std::vector<TextureRefTuple> textures,
+			std::vector<TextureEntry> entries,
 			Texture color_fallback,
 			Texture normal_fallback,
 			Texture error_hint_texture
 		) :
-			textures(std::make_unique<std::vector<TextureTuple>>(std::move(textures))),
+			images(std::move(images)),
+			textures(std::move(textures)),
+			entries(std::move(entries)),
 			color_fallback(std::make_unique<Texture>(std::move(color_fallback))),
 			normal_fallback(std::make_unique<Texture>(std::move(normal_fallback))),
 			error_hint_texture(std::make_unique<Texture>(std::move(error_hint_texture)))
 		{}
 
+		// Hash the sources of all textures and group them by content, textures whose source can't be read
+		// are left in their own groups
+		[[nodiscard]]
+		static coro::task<TextureGroups> group_textures(
+			coro::thread_pool& thread_pool,
+			const model::MaterialList& material_list
+		) noexcept;
+
 		// Create texture tuple for a single texture, with no progress reporting
 		[[nodiscard]]
-		static coro::task<std::expected<TextureTuple, Error>> create_texture_tuple(
+		static coro::task<std::expected<LoadedTuple, Error>> create_texture_tuple(
 			coro::thread_pool& thread_pool,
 			const util::Progress& progress,
+			std::stop_token stop_token,
 			const vulkan::Context& context,
 			vulkan::StaticResourceCreator& resource_creator,
 			const model::Texture& texture,
@@ -148,6 +296,25 @@ namespace render
 			LoadOption load_option
 		) noexcept;
 
+		// Encode all pending textures on the GPU, in batches of `LoadOption::max_pending_data_size`
+		[[nodiscard]]
+		static std::expected<std::vector<TextureTuple>, Error> finish_texture_tuples(
+			const vulkan::Context& context,
+			std::vector<LoadedTuple> loaded_tuples,
+			LoadOption load_option
+		) noexcept;
+
+		// Bake texture tuple for a single texture, with no progress reporting
+		[[nodiscard]]
+		static coro::task<std::expected<BakedTuple, Error>> bake_texture_tuple(
+			coro::thread_pool& thread_pool,
+			const util::Progress& progress,
+			std::stop_token stop_token,
+			const model::Texture& texture,
+			model::TextureUsage texture_usage,
+			LoadOption load_option
+		) noexcept;
+
 	  public:
 
 		TextureList(const TextureList&) = delete;
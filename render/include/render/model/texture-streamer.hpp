@@ -0,0 +1,293 @@
+#pragma once
+
+#include "common/util/async.hpp"
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+#include "render/model/material.hpp"
+#include "render/model/texture-list.hpp"
+#include "render/model/texture.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <set>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Streams higher-resolution textures of a material list in the background
+	/// @details The material list is expected to be loaded with low-resolution textures up front (see
+	/// `TextureList::LoadOption::max_size`), so that rendering can start right away. The streamer then bakes
+	/// textures on background threads at the resolution their materials are sampled at on screen, both
+	/// reported by the deferred pass (see `TextureFeedbackResource`), prioritized by the screen-space usage
+	/// of their materials. Baked textures are swapped into the reserved half of the material texture array
+	/// once uploaded, and re-baked at a higher resolution when sampled finer later. Distant materials thus
+	/// only take the memory of the mipmap levels they sample. When the memory budget is exceeded, textures
+	/// not seen for a while are evicted back to their low-resolution version.
+	///
+	/// The budget follows the device-local memory telemetry of the allocator (see
+	/// `vulkan::Allocator::get_device_memory_usage`). When other allocations (BLASes, attachments, geometry)
+	/// leave less than `Option::memory_reserve` free, the top mipmap levels of the lowest-priority textures
+	/// are dropped, even if on screen, and only streamed back once memory is available again.
+	///
+	/// Call these every frame:
+	/// 1. `update` after waiting for the frame, with the feedback read back from it
+	/// 2. `record` in the command buffer of the frame, before any pass sampling the materials
+	///
+	/// @warning The material list must outlive the streamer
+	///
+	class TextureStreamer
+	{
+	  public:
+
+		///
+		/// @brief Options of texture streaming
+		///
+		struct Option
+		{
+			// Memory budget of streamed textures, in bytes. Lowered at runtime to keep `memory_reserve` free
+			size_t memory_budget = 1024 * 1048576;
+
+			// Device-local memory left free for other allocations, in bytes
+			size_t memory_reserve = 256 * 1048576;
+
+			// Max count of textures baking concurrently
+			uint32_t max_pending_bakes = 4;
+
+			// Max size of texture data uploaded in a single `update`, at least one texture is uploaded
+			size_t max_upload_size = 32 * 1048576;
+
+			// Frames in flight, evicted textures are destroyed after this many `update` calls
+			uint32_t frames_in_flight = 3;
+
+			// Frames a texture must stay unseen before it can be evicted
+			uint32_t evict_delay = 120;
+		};
+
+		///
+		/// @brief Statistics of texture streaming
+		///
+		struct Stat
+		{
+			size_t texture_count;   // Count of streamable textures
+			size_t resident_count;  // Count of streamed textures in use
+			size_t pending_count;   // Count of textures baking or waiting for upload
+			size_t resident_size;   // Size of streamed textures in use, in bytes
+			size_t budget;          // Current memory budget of streamed textures, in bytes
+		};
+
+		///
+		/// @brief Create a texture streamer
+		///
+		/// @param context Vulkan context
+		/// @param source CPU-side material list that @p material_list was created from
+		/// @param material_list Material list to stream textures into
+		/// @param load_option Options used to load @p material_list. Only textures sampled finer than
+		/// `max_size` are streamed, nothing is streamed if it is `0`
+		/// @param option Streaming options
+		/// @return Created streamer, or error
+		///
+		[[nodiscard]]
+		static std::expected<TextureStreamer, Error> create(
+			const vulkan::Context& context,
+			std::shared_ptr<const model::MaterialList> source,
+			const MaterialList& material_list,
+			TextureList::LoadOption load_option,
+			Option option = {}
+		) noexcept;
+
+		///
+		/// @brief Update priorities, collect finished bakes, upload and swap in textures, and start new bakes
+		/// @note Textures failing to bake stay in low resolution
+		///
+		/// @param context Vulkan context
+		/// @param material_usage Covered pixels of each material, see
+		/// `TextureFeedbackResource::Feedback`. Ignored if empty or mismatching the material count
+		/// @param material_resolution Sampled texture resolution of each material, see
+		/// `TextureFeedbackResource::Feedback`. Ignored if mismatching @p material_usage
+		/// @return `void` on success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> update(
+			const vulkan::Context& context,
+			std::span<const uint32_t> material_usage,
+			std::span<const uint32_t> material_resolution
+		) noexcept;
+
+		///
+		/// @brief Record updates of the material texture indices
+		/// @note Must be recorded outside of rendering
+		///
+		/// @param command_buffer Command buffer of the frame
+		///
+		void record(const vk::raii::CommandBuffer& command_buffer) noexcept;
+
+		///
+		/// @brief Recreate the views and descriptors of the streamed textures moved by defragmentation
+		/// @details Streamed textures may be moved by `vulkan::Defragmentation`, call this after each
+		/// `vulkan::Defragmentation::end_pass`, before the material list is used again
+		/// @note Must not be called concurrently with `update`
+		///
+		/// @param context Vulkan context
+		/// @return `void` on success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> rebind_relocated(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Get statistics of texture streaming
+		///
+		/// @return Statistics
+		///
+		[[nodiscard]]
+		Stat get_stat() const noexcept;
+
+	  private:
+
+		// Streamed texture in use, with an image view for each slot of the entry
+		struct Resident
+		{
+			Texture texture;
+			std::vector<vk::raii::ImageView> views;
+			uint32_t generation;  // Generation of `texture.image` the views were created for
+			size_t size;
+			uint32_t resolution_log;  // `log2` of the resolution limit it was baked with
+			bool full_resolution;     // Whether it is smaller than the limit, thus not limited by it
+		};
+
+		// Evicted texture, destroyed once no frame in flight uses it
+		struct Retired
+		{
+			uint64_t frame;
+			Resident resident;
+		};
+
+		// Unit of streaming, the color or normal texture of a single source texture
+		struct Entry
+		{
+			uint32_t texture_index;
+			bool normal;
+			std::vector<uint32_t> slots;      // Texture descriptors sampling this texture
+			std::vector<uint32_t> materials;  // Material infos referencing `slots`
+
+			uint64_t priority = 0;        // Decayed covered pixels of `materials`
+			uint64_t last_used = 0;       // Last frame seen on screen
+			uint64_t retry_frame = 0;     // Earliest frame to bake or swap in again
+			uint32_t resolution_log = 0;  // `log2` of the finest resolution `materials` were last sampled at
+			uint32_t bake_log = 0;        // `log2` of the resolution limit of `bake` and `baked`
+			bool failed = false;
+
+			std::optional<util::Future<std::expected<Texture::Baked, Error>>> bake = std::nullopt;
+			std::optional<Texture::Baked> baked = std::nullopt;
+			std::optional<Resident> resident = std::nullopt;
+
+			// Whether a higher resolution than the current one is sampled
+			[[nodiscard]]
+			bool needs_upgrade(uint32_t loaded_log) const noexcept
+			{
+				if (!resident.has_value()) return resolution_log > loaded_log;
+				return !resident->full_resolution && resolution_log > resident->resolution_log;
+			}
+		};
+
+		std::shared_ptr<const model::MaterialList> source;
+		TextureList::LoadOption load_option;
+		Option option;
+		vulkan::StaticResourceCreator resource_creator;
+
+		// Handles of the material list
+		vk::DescriptorSet descriptor_set;
+		vk::Buffer info_buffer;
+		std::vector<TextureIndex> texture_indices;
+		std::vector<std::optional<TextureSource>> texture_sources;
+
+		std::vector<std::optional<uint32_t>> slot_entries;  // Entry of each texture descriptor
+		std::vector<Entry> entries;
+		std::vector<Retired> retired;
+		std::set<uint32_t> dirty_materials;
+
+		uint64_t frame = 0;
+		size_t resident_size = 0;
+		size_t budget = 0;  // Effective budget, `Option::memory_budget` lowered by memory pressure
+
+		explicit TextureStreamer(
+			std::shared_ptr<const model::MaterialList> source,
+			TextureList::LoadOption load_option,
+			Option option,
+			vulkan::StaticResourceCreator resource_creator,
+			const MaterialList& material_list,
+			std::vector<std::optional<uint32_t>> slot_entries,
+			std::vector<Entry> entries
+		) :
+			source(std::move(source)),
+			load_option(load_option),
+			option(option),
+			resource_creator(std::move(resource_creator)),
+			descriptor_set(*material_list.descriptor_set),
+			info_buffer(material_list.info_buffer),
+			texture_indices(material_list.texture_indices),
+			texture_sources(material_list.texture_sources),
+			slot_entries(std::move(slot_entries)),
+			entries(std::move(entries)),
+			budget(option.memory_budget)
+		{}
+
+		// Get current texture index of a material info, streamed slots are in the second half
+		[[nodiscard]]
+		TextureIndex get_texture_index(uint32_t material) const noexcept;
+
+		// `log2` of the resolution limit textures of the material list were loaded with
+		[[nodiscard]]
+		uint32_t get_loaded_log() const noexcept;
+
+		void apply_feedback(
+			std::span<const uint32_t> material_usage,
+			std::span<const uint32_t> material_resolution
+		) noexcept;
+
+		void collect_bakes() noexcept;
+
+		void start_bakes() noexcept;
+
+		[[nodiscard]]
+		std::expected<void, Error> upload_baked(const vulkan::Context& context) noexcept;
+
+		// Derive the effective budget from the device-local memory usage
+		void update_budget(const vulkan::Context& context) noexcept;
+
+		// Evict the lowest-priority textures, seen or not, until the resident ones fit the budget
+		void trim_to_budget() noexcept;
+
+		// Evict unseen textures of lower priority until @p size fits the budget
+		[[nodiscard]]
+		bool reserve_memory(size_t size, uint64_t priority) noexcept;
+
+		void evict(Entry& entry) noexcept;
+
+		void mark_dirty(const Entry& entry) noexcept;
+
+		// Create the views of a resident texture, and write them into the streamed slots of the entry
+		[[nodiscard]]
+		std::expected<void, Error> bind_views(
+			const vulkan::Context& context,
+			const Entry& entry,
+			Resident& resident
+		) noexcept;
+
+	  public:
+
+		TextureStreamer(const TextureStreamer&) = delete;
+		TextureStreamer(TextureStreamer&&) = default;
+		TextureStreamer& operator=(const TextureStreamer&) = delete;
+		TextureStreamer& operator=(TextureStreamer&&) = default;
+	};
+}
@@ -9,10 +9,15 @@
 #include "vulkan/interface/context.hpp"
 #include "vulkan/util/static-resource-creator.hpp"
 
+#include <compare>
 #include <cstddef>
 #include <cstdint>
 #include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
 #include <optional>
+#include <span>
+#include <variant>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
@@ -39,6 +44,11 @@ namespace render
 			Rg8Unorm,
 			Rg16Unorm,
 			BC5,
+
+			// Formats of devices without BC support, appended to keep the values of serialized formats
+			ETC2,
+			EAC_RG11,
+			ASTC4x4,
 		};
 
 		///
@@ -61,11 +71,22 @@ namespace render
 			Raw,        // Load raw Unorm8 only
 			AllBC3,     // Load all files in BC3
 			AllBC7,     // Load all files in BC7
-			BalancedBC  // Load smaller images in BC7 (Max dim <= 1024px after resize)
+			BalancedBC,  // Load smaller images in BC7 (Max dim <= 1024px after resize)
+			Adaptive,    // Pick per image by trial encoding sampled blocks, see `ADAPTIVE_PSNR_TARGET`
+			AllETC2,     // Load all files in ETC2, for devices without BC
+			AstcETC2     // Transcode KTX2 into ASTC 4x4, and load other files in ETC2
 		};
 
 		static constexpr size_t BC7_THRESHOLD = 1024;
 
+		// `ColorLoadStrategy::Adaptive` collapses single-color images into a 1x1 Unorm8 texture, and picks
+		// BC3 over BC7 if the sampled blocks encoded in BC3 reach this PSNR in dB
+		static constexpr double ADAPTIVE_PSNR_TARGET = 40.0;
+
+		// `ColorLoadStrategy::Adaptive` trial encodes up to this many blocks in each dimension, evenly spread
+		// over the image
+		static constexpr uint32_t ADAPTIVE_SAMPLE_GRID = 16;
+
 		///
 		/// @brief Strategy for loading normal map texture
 		///
@@ -76,6 +97,47 @@ namespace render
 			AdaptiveUnorm,     // Load 16-bit images as Unorm16, 8-bit images as Unorm8
 			AdaptiveUnormBC5,  // Load 16-bit images as Unorm16, 8-bit images as BC5
 			AllBC5,            // Load all images as BC5
+			AllEAC,            // Load all images as EAC RG11, for devices without BC
+		};
+
+		///
+		/// @brief Block compression formats supported by a device for sampled images
+		///
+		struct CompressionSupport
+		{
+			bool bc = true;
+			bool etc2 = false;
+			bool astc = false;
+
+			///
+			/// @brief Query the block compression features of a physical device
+			///
+			/// @param phy_device Physical device
+			/// @return Supported formats
+			///
+			[[nodiscard]]
+			static CompressionSupport query(const vk::raii::PhysicalDevice& phy_device) noexcept;
+
+			///
+			/// @brief Fit a color load strategy to the supported formats
+			/// @details BC strategies fall back to ETC2 (with ASTC for KTX2 if supported) and then to raw,
+			/// ETC2 strategies fall back to `ColorLoadStrategy::BalancedBC`
+			///
+			/// @param strategy Preferred strategy
+			/// @return @p strategy if supported, otherwise the closest supported strategy
+			///
+			[[nodiscard]]
+			ColorLoadStrategy fit(ColorLoadStrategy strategy) const noexcept;
+
+			///
+			/// @brief Fit a normal map load strategy to the supported formats
+			/// @details BC5 strategies fall back to EAC RG11 and then to Unorm8, EAC to BC5
+			///
+			/// @param strategy Preferred strategy
+			/// @return @p strategy if supported, otherwise the closest supported strategy
+			///
+			[[nodiscard]]
+			NormalLoadStrategy fit(NormalLoadStrategy strategy) const noexcept;
 		};
 
 		///
@@ -89,8 +151,18 @@ namespace render
 			uint32_t mipmap_levels;
 			std::optional<float> min_alpha;
 
-			auto operator<=>(const Ref& other) const { return image <=> other.image; }
-			bool operator==(const Ref& other) const { return image == other.image; };
+			// Layer of `image` holding the texture, non-zero for textures packed into a shared array image
+			uint32_t array_layer = 0;
+
+			std::strong_ordering operator<=>(const Ref& other) const
+			{
+				if (const auto order = image <=> other.image; order != 0) return order;
+				return array_layer <=> other.array_layer;
+			}
+			bool operator==(const Ref& other) const
+			{
+				return image == other.image && array_layer == other.array_layer;
+			};
 
 			///
 			/// @brief Get vulkan format for this texture
@@ -109,8 +181,241 @@ namespace render
 		uint32_t mipmap_levels;
 		std::optional<float> min_alpha = std::nullopt;
 
+		///
+		/// @brief A mipmap level of a baked texture
+		///
+		struct BakedLevel
+		{
+			glm::u32vec2 extent;  // Extent of the level in texels
+			uint64_t offset;      // Byte offset of the level data in the baked data
+			uint64_t size;        // Byte size of the level data
+		};
+
+		///
+		/// @brief Non-owning view of a baked texture, see `Baked`
+		///
+		struct BakedView
+		{
+			Format format;
+			std::optional<float> min_alpha;
+			std::span<const BakedLevel> levels;
+			std::span<const std::byte> data;
+		};
+
+		///
+		/// @brief CPU-side texture, fully decoded, resized, mipmapped and encoded into its final format
+		/// @details The data of all levels is stored contiguously, so it can be uploaded or serialized as-is
+		/// without processing it again
+		///
+		struct Baked
+		{
+			Format format;
+			std::optional<float> min_alpha = std::nullopt;
+			std::vector<BakedLevel> levels;
+			std::vector<std::byte> data;
+
+			[[nodiscard]]
+			BakedView view() const noexcept
+			{
+				return {.format = format, .min_alpha = min_alpha, .levels = levels, .data = data};
+			}
+		};
+
+		///
+		/// @brief CPU-side texture pending block compression
+		/// @details Produced when a load strategy selects a BCn format, so that the texture can be encoded
+		/// either on the CPU (`encode`) or on the GPU (`BcnEncoder`). Only the base level is kept, the mipmap
+		/// chain is generated by whichever side encodes it.
+		///
+		struct Unencoded
+		{
+			image::BCnFormat format;
+			std::optional<float> min_alpha = std::nullopt;
+			image::Image<image::Format::Unorm8, image::Layout::RGBA> image;  // Base level, POT and >= 4x4
+
+			// Mipmap chains stop at the BCn block size
+			static constexpr uint32_t MIN_SIZE_LOG = 2;
+		};
+
+		///
+		/// @brief Texture prepared by a load strategy, either already baked or pending block compression
+		///
+		using Prepared = std::variant<Baked, Unencoded>;
+
+		///
+		/// @brief Prepare a color texture from a `lib.model` texture, see `bake_color_texture`
+		///
+		/// @param texture Input texture
+		/// @param load_strategy Color image loading strategy
+		/// @param max_size Limit of the larger dimension, see `bake_color_texture`
+		/// @return Prepared texture, or error
+		///
+		[[nodiscard]]
+		static std::expected<Prepared, Error> prepare_color_texture(
+			const model::Texture& texture,
+			ColorLoadStrategy load_strategy,
+			uint32_t max_size = 0
+		) noexcept;
+
+		///
+		/// @brief Prepare a normal map texture from a `lib.model` texture, see `bake_normal_texture`
+		///
+		/// @param texture Input texture
+		/// @param load_strategy Normal map loading strategy
+		/// @param max_size Limit of the larger dimension, see `bake_color_texture`
+		/// @return Prepared texture, or error
+		///
+		[[nodiscard]]
+		static std::expected<Prepared, Error> prepare_normal_texture(
+			const model::Texture& texture,
+			NormalLoadStrategy load_strategy,
+			uint32_t max_size = 0
+		) noexcept;
+
+		///
+		/// @brief Encode a texture pending block compression on the CPU
+		///
+		/// @param unencoded Texture pending block compression
+		/// @param bc7_quality Quality options, used when encoding in BC7
+		/// @return Baked texture, or error
+		///
+		[[nodiscard]]
+		static std::expected<Baked, Error> encode(
+			const Unencoded& unencoded,
+			image::BC7Quality bc7_quality = {}
+		) noexcept;
+
+		///
+		/// @brief Get texture format of a BCn format
+		///
+		/// @param format BCn format
+		/// @return Texture format
+		///
+		[[nodiscard]]
+		static Format get_bcn_format(image::BCnFormat format) noexcept;
+
+		///
+		/// @brief Bake a color texture from a `lib.model` texture
+		/// @note Equivalent to `prepare_color_texture`, followed by `encode` if pending block compression
+		///
+		/// @param texture Input texture
+		/// @param load_strategy Color image loading strategy
+		/// @param max_size Limit of the larger dimension, the image is downscaled by powers of two to fit.
+		/// Encoded sources are decoded at a reduced resolution when possible. `0` for unlimited
+		/// @param bc7_quality Quality options for textures encoded in BC7
+		/// @return Baked texture, or error
+		///
+		[[nodiscard]]
+		static std::expected<Baked, Error> bake_color_texture(
+			const model::Texture& texture,
+			ColorLoadStrategy load_strategy,
+			uint32_t max_size = 0,
+			image::BC7Quality bc7_quality = {}
+		) noexcept;
+
+		///
+		/// @brief Bake a normal map texture from a `lib.model` texture
+		/// @note Equivalent to `prepare_normal_texture`, followed by `encode` if pending block compression
+		///
+		/// @param texture Input texture
+		/// @param load_strategy Normal map loading strategy
+		/// @param max_size Limit of the larger dimension, see `bake_color_texture`
+		/// @return Baked texture, or error
+		///
+		[[nodiscard]]
+		static std::expected<Baked, Error> bake_normal_texture(
+			const model::Texture& texture,
+			NormalLoadStrategy load_strategy,
+			uint32_t max_size = 0
+		) noexcept;
+
+		///
+		/// @brief Upload a baked texture
+		/// @warning Calling this function will add image upload tasks to the creator, but will not execute
+		/// them. Call `vulkan::StaticResourceCreator::execute_uploads` to actually execute the upload tasks.
+		///
+		/// @param context Vulkan context
+		/// @param resource_creator Resource creator instance
+		/// @param baked Baked texture, must stay alive until the upload tasks are created
+		/// @param usage Vulkan image usage, defaulted to `eSampled`
+		/// @return Uploaded texture, or error
+		///
+		[[nodiscard]]
+		static std::expected<Texture, Error> upload(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			const BakedView& baked,
+			vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled
+		) noexcept;
+
+		///
+		/// @brief Upload baked textures of the same layout into the layers of a single 2D array image
+		/// @details Layer `i` of the image holds `layers[i]`, reference it with `Ref::array_layer`
+		/// @warning Same as `upload`, the upload tasks are added to the creator but not executed
+		///
+		/// @param context Vulkan context
+		/// @param resource_creator Resource creator instance
+		/// @param layers Baked textures, must share the format and the extents of all levels, and stay alive
+		/// until the upload tasks are created
+		/// @param usage Vulkan image usage, defaulted to `eSampled`
+		/// @return Uploaded array image, or error
+		///
+		[[nodiscard]]
+		static std::expected<vulkan::Image, Error> upload_array(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			std::span<const BakedView> layers,
+			vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled
+		) noexcept;
+
+		///
+		/// @brief Encode a texture pending block compression on the CPU, and upload it
+		/// @details Equivalent to `encode` followed by `upload`, except that the blocks are encoded directly
+		/// into staging memory, without being packed into a `Baked` first or copied into the staging memory
+		/// @warning Calling this function will add image upload tasks to the creator, but will not execute
+		/// them. Call `vulkan::StaticResourceCreator::execute_uploads` to actually execute the upload tasks.
+		///
+		/// @param context Vulkan context
+		/// @param resource_creator Resource creator instance
+		/// @param unencoded Texture pending block compression
+		/// @param usage Vulkan image usage, defaulted to `eSampled`
+		/// @param bc7_quality Quality options, used when encoding in BC7
+		/// @return Uploaded texture, or error
+		///
+		[[nodiscard]]
+		static std::expected<Texture, Error> encode_and_upload(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			const Unencoded& unencoded,
+			vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled,
+			image::BC7Quality bc7_quality = {}
+		) noexcept;
+
+		///
+		/// @brief Upload a prepared texture, encoding it on the CPU if pending block compression
+		/// @note Equivalent to `upload` for baked textures, and `encode_and_upload` otherwise
+		/// @warning Calling this function will add image upload tasks to the creator, but will not execute
+		/// them. Call `vulkan::StaticResourceCreator::execute_uploads` to actually execute the upload tasks.
+		///
+		/// @param context Vulkan context
+		/// @param resource_creator Resource creator instance
+		/// @param prepared Prepared texture, must stay alive until the upload tasks are created
+		/// @param usage Vulkan image usage, defaulted to `eSampled`
+		/// @param bc7_quality Quality options, used when encoding in BC7
+		/// @return Uploaded texture, or error
+		///
+		[[nodiscard]]
+		static std::expected<Texture, Error> upload_prepared(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			const Prepared& prepared,
+			vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled,
+			image::BC7Quality bc7_quality = {}
+		) noexcept;
+
 		///
 		/// @brief Load a color texture from a `lib.model` texture
+		/// @note Equivalent to `prepare_color_texture` followed by `upload_prepared`
 		/// @warning Calling this function will add image upload tasks to the creator, but will not execute
 		/// them. Call `vulkan::StaticResourceCreator::execute_uploads` to actually execute the upload tasks.
 		///
@@ -132,6 +437,7 @@ namespace render
 
 		///
 		/// @brief Load a normal map texture from a `lib.model` texture
+		/// @note Equivalent to `prepare_normal_texture` followed by `upload_prepared`
 		/// @warning Calling this function will add image upload tasks to the creator, but will
 		/// not execute them. Call `vulkan::StaticResourceCreator::execute_uploads` to actually execute the
 		/// upload tasks.
@@ -170,38 +476,30 @@ namespace render
 
 	  private:
 
-		/* Load Functions */
+		/* Bake Functions */
 
-		// Load RGBA8_UNORM image, if `allow_resize` is set to true, NPOT image is resized as POT image and
-		// mipmap is generated
-		static std::expected<Texture, Error> load_rgba8_unorm(
-			const vulkan::Context& context,
-			vulkan::StaticResourceCreator& resource_creator,
-			const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image,
-			vk::ImageUsageFlags usage
+		// Bake RGBA8_UNORM image, NPOT image is resized as POT image and mipmap is generated
+		static Baked bake_rgba8_unorm(
+			const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image
 		) noexcept;
 
-		// Load BCn image, resize and generate mipmap
-		static std::expected<Texture, Error> load_bcn(
-			const vulkan::Context& context,
-			vulkan::StaticResourceCreator& resource_creator,
+		// Prepare BCn image, resize and generate mipmap
+		static Unencoded prepare_bcn(
 			const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image,
-			image::BCnFormat format,
-			vk::ImageUsageFlags usage
+			image::BCnFormat format
 		) noexcept;
 
-		static std::expected<Texture, Error> load_rg8_unorm(
-			const vulkan::Context& context,
-			vulkan::StaticResourceCreator& resource_creator,
-			const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image,
-			vk::ImageUsageFlags usage
+		// Prepare color image for `ColorLoadStrategy::Adaptive`
+		static Prepared prepare_adaptive(
+			const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image
 		) noexcept;
 
-		static std::expected<Texture, Error> load_rg16_unorm(
-			const vulkan::Context& context,
-			vulkan::StaticResourceCreator& resource_creator,
-			const image::Image<image::Format::Unorm16, image::Layout::RGBA>& image,
-			vk::ImageUsageFlags usage
+		static Baked bake_rg8_unorm(
+			const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image
+		) noexcept;
+
+		static Baked bake_rg16_unorm(
+			const image::Image<image::Format::Unorm16, image::Layout::RGBA>& image
 		) noexcept;
 	};
 }
@@ -1,14 +1,20 @@
 #pragma once
 
 #include "common/util/error.hpp"
+#include "model/hierarchy.hpp"
+#include "render/model/mesh.hpp"
 #include "render/model/model.hpp"
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
 #include <span>
 #include <utility>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
@@ -21,36 +27,225 @@ namespace render
 	{
 	  public:
 
+		// Instance mask bit of instances with only opaque primitives
+		static constexpr uint8_t OPAQUE_INSTANCE_MASK = 0x01;
+
+		// Instance mask bit of instances with alpha tested or blended primitives, e.g. foliage
+		static constexpr uint8_t ALPHA_INSTANCE_MASK = 0x02;
+
+		// Mask bits of the instances beyond the radius of `cull()`, replacing `OPAQUE_INSTANCE_MASK` and
+		// `ALPHA_INSTANCE_MASK`. Rays of local effects test only the near bits, rays with `0xFF` hit all
+		static constexpr uint8_t FAR_OPAQUE_INSTANCE_MASK = OPAQUE_INSTANCE_MASK << 2;
+		static constexpr uint8_t FAR_ALPHA_INSTANCE_MASK = ALPHA_INSTANCE_MASK << 2;
+
+		///
+		/// @brief Per-instance parameters of a TLAS
+		///
+		struct InstanceParam
+		{
+			uint8_t mask = 0xFF;      // Instance mask, tested against the cull mask of rays
+			uint32_t sbt_offset = 0;  // Instance shader binding table record offset
+		};
+
+		///
+		/// @brief Sphere splitting the instances into near and far ones, see `cull()`
+		///
+		struct InstanceCull
+		{
+			glm::vec3 origin;  // Center of the sphere, usually the camera position
+			float radius;      // Instances fully outside the sphere are far
+		};
+
+		///
+		/// @brief Get the default parameters of an instance, classified by the alpha modes of its primitives
+		///
+		/// @param model Model instance
+		/// @param mesh_index Mesh index of the instance
+		/// @return `OPAQUE_INSTANCE_MASK` or `ALPHA_INSTANCE_MASK` as mask, zero SBT offset
+		///
+		[[nodiscard]]
+		static InstanceParam get_default_param(const Model& model, uint32_t mesh_index) noexcept;
+
+		///
+		/// @brief Get instance parameters for hit records laid out per primitive
+		/// @details Each primitive owns @p records_per_primitive consecutive hit records, one per ray type.
+		/// The SBT offset of an instance points at the records of its first primitive, so the record of a
+		/// geometry is selected by the geometry index. See `vulkan::ShaderBindingTable`.
+		///
+		/// @param model Model instance
+		/// @param records_per_primitive Count of hit records of each primitive
+		/// @return Parameters of each instance, same layout as `Hierarchy::get_renderables()`
+		///
+		[[nodiscard]]
+		static std::vector<InstanceParam> get_hit_record_params(
+			const Model& model,
+			uint32_t records_per_primitive
+		) noexcept;
+
+		///
+		/// @brief Get the SBT offsets of `get_hit_record_params()`, from the mesh layout only
+		///
+		/// @param renderables Renderable drawcalls, see `Hierarchy::get_renderables()`
+		/// @param mesh_ranges Primitive range of each mesh, see `MeshList::mesh_ranges_array`
+		/// @param records_per_primitive Count of hit records of each primitive
+		/// @return SBT offset of each instance, same layout as @p renderables
+		///
+		[[nodiscard]]
+		static std::vector<uint32_t> get_hit_record_offsets(
+			std::span<const model::Hierarchy::Drawcall> renderables,
+			std::span<const PrimitiveIndexRange> mesh_ranges,
+			uint32_t records_per_primitive
+		) noexcept;
+
 		///
 		/// @brief Build a TLAS from model and node transforms
+		/// @note The TLAS is built with `eAllowUpdate`, so it can be refit later with `update()`
 		///
 		/// @param context Vulkan context
 		/// @param model Model instance
 		/// @param transforms Node transform matrix array
+		/// @param instance_params Parameters of each instance, same layout as
+		/// `Hierarchy::get_renderables()`. Empty to use `get_default_param()` for all instances
 		/// @return Built TLAS or error
 		///
 		static std::expected<Tlas, Error> build(
 			const vulkan::Context& context,
 			const Model& model,
+			std::span<const glm::mat4> transforms,
+			std::span<const InstanceParam> instance_params = {}
+		) noexcept;
+
+		///
+		/// @brief Refit the TLAS with new node transforms
+		/// @details
+		/// - Only instances whose transform changed are written into the instance buffer
+		/// - Records the copy and the `eUpdate` build into @p command_buffer, nothing is submitted
+		/// - Does nothing if no instance changed
+		///
+		/// @warning The previous update must have finished executing on GPU before calling this, as the
+		/// staging and scratch buffers are reused
+		///
+		/// @param context Vulkan context
+		/// @param command_buffer Command buffer to record into
+		/// @param transforms Node transform matrix array, same layout as the one passed to `build()`
+		/// @return `true` if the TLAS is updated, `false` if nothing changed, or error
+		///
+		[[nodiscard]]
+		std::expected<bool, Error> update(
+			const vulkan::Context& context,
+			const vk::raii::CommandBuffer& command_buffer,
 			std::span<const glm::mat4> transforms
 		) noexcept;
 
-		// TODO: update TLAS
+		///
+		/// @brief Refit the TLAS to BLASes refit since the last build, e.g. by `BlasList::refit`
+		/// @details Records an `eUpdate` build into @p command_buffer without changing any instance
+		/// @note Unlike `update()`, the staging buffer is not used, so previous frames may still be executing
+		///
+		/// @param context Vulkan context
+		/// @param command_buffer Command buffer to record into
+		///
+		void refit(
+			const vulkan::Context& context,
+			const vk::raii::CommandBuffer& command_buffer
+		) const noexcept;
+
+		///
+		/// @brief Reclassify the instances into near and far ones by the distance of their bounds
+		/// @details
+		/// - Instances whose bounding sphere lies fully outside @p cull get their near mask bits moved to the
+		/// far bits, e.g. `OPAQUE_INSTANCE_MASK` to `FAR_OPAQUE_INSTANCE_MASK`, and back once inside again.
+		/// Effects limited to a radius trace with the near bits only, and skip the far instances.
+		/// - Changed instances are written inline with `vkCmdUpdateBuffer`, followed by an `eUpdate` build
+		/// - Does nothing if no instance changed, cheap enough to call every frame
+		///
+		/// @note Unlike `update()`, the staging buffer is not used, so previous frames may still be executing
+		///
+		/// @param context Vulkan context
+		/// @param command_buffer Command buffer to record into
+		/// @param cull Sphere of the near instances
+		/// @return `true` if the TLAS is updated, `false` if nothing changed
+		///
+		[[nodiscard]]
+		bool cull(
+			const vulkan::Context& context,
+			const vk::raii::CommandBuffer& command_buffer,
+			const InstanceCull& cull
+		) noexcept;
+
+		///
+		/// @brief Rebuild the TLAS in place to reference the current BLASes of the model
+		/// @details
+		/// - Used after `Model::blas_list` is replaced, e.g. fast-build BLASes rebuilt for fast trace. The
+		/// TLAS handle is unchanged, so descriptors need no update
+		/// - Records the copy and the `eBuild` build into @p command_buffer, nothing is submitted
+		/// - Instance masks and SBT offsets are kept
+		///
+		/// @warning Same as `update()`, the previous update must have finished executing on GPU. The
+		/// replaced BLASes must be kept alive until the frames in flight referencing them have completed
+		///
+		/// @param context Vulkan context
+		/// @param command_buffer Command buffer to record into
+		/// @param model Model the TLAS was built from, with its BLAS list replaced
+		/// @return `void` on success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> replace_blas(
+			const vulkan::Context& context,
+			const vk::raii::CommandBuffer& command_buffer,
+			const Model& model
+		) noexcept;
+
+		operator vk::AccelerationStructureKHR() const noexcept { return tlas; }
 
 	  private:
 
+		static constexpr auto BUILD_FLAGS = vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate
+			| vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastBuild;
+
+		std::vector<vk::AccelerationStructureInstanceKHR> instances;  // Host copy of the instances
+		std::vector<uint32_t> instance_nodes;                         // Node index of each instance
+		std::vector<glm::vec4> instance_bounds;  // Object space bounding sphere, center and radius
+		std::vector<uint8_t> instance_masks;     // Mask of each instance while near, see `cull()`
+
 		vulkan::ArrayBuffer<vk::AccelerationStructureInstanceKHR> instance_buffer;
+		vulkan::ArrayBuffer<vk::AccelerationStructureInstanceKHR> staging_buffer;
+		vulkan::Buffer scratch_buffer;  // Scratch buffer for updating
 		vulkan::Buffer tlas_buffer;
 		vk::raii::AccelerationStructureKHR tlas;
 
+		vk::DeviceSize scratch_alignment;
+
+		// Record copies of changed instances from the staging buffer if any, then build the TLAS in @p mode
+		void record_build(
+			const vulkan::Context& context,
+			const vk::raii::CommandBuffer& command_buffer,
+			std::span<const vk::BufferCopy> copy_regions,
+			vk::BuildAccelerationStructureModeKHR mode
+		) const noexcept;
+
 		explicit Tlas(
+			std::vector<vk::AccelerationStructureInstanceKHR> instances,
+			std::vector<uint32_t> instance_nodes,
+			std::vector<glm::vec4> instance_bounds,
+			std::vector<uint8_t> instance_masks,
 			vulkan::ArrayBuffer<vk::AccelerationStructureInstanceKHR> instance_buffer,
+			vulkan::ArrayBuffer<vk::AccelerationStructureInstanceKHR> staging_buffer,
+			vulkan::Buffer scratch_buffer,
 			vulkan::Buffer tlas_buffer,
-			vk::raii::AccelerationStructureKHR tlas
+			vk::raii::AccelerationStructureKHR tlas,
+			vk::DeviceSize scratch_alignment
 		) :
+			instances(std::move(instances)),
+			instance_nodes(std::move(instance_nodes)),
+			instance_bounds(std::move(instance_bounds)),
+			instance_masks(std::move(instance_masks)),
 			instance_buffer(std::move(instance_buffer)),
+			staging_buffer(std::move(staging_buffer)),
+			scratch_buffer(std::move(scratch_buffer)),
 			tlas_buffer(std::move(tlas_buffer)),
-			tlas(std::move(tlas))
+			tlas(std::move(tlas)),
+			scratch_alignment(scratch_alignment)
 		{}
 
 	  public:
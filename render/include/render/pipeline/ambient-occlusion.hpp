@@ -0,0 +1,234 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/ambient-occlusion.hpp"
+#include "render/resource/deferred.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Ambient occlusion pipeline, traces short cosine-distributed rays per ambient occlusion texel
+	/// against the TLAS and accumulates them over frames
+	/// @details
+	/// - Expects the deferred attachments to be in `eShaderReadOnlyOptimal` layout, which is the layout the
+	/// deferred pipeline leaves them in
+	/// - Ray directions are drawn from the blue noise texture (see `image::get_blue_noise`), offset per ray
+	/// and per frame
+	/// - The result is blended with the history of the previous frame, reprojected with the velocity of the
+	/// deferred attachment. History texels seen at another view distance are rejected as disoccluded.
+	/// - Leaves the output in `eGeneral` layout, ready to be sampled by fragment and compute shaders, and to
+	/// serve as the history of the next frame
+	/// - All geometries are traced as opaque, alpha-tested triangles occlude as a whole
+	/// @note Requires the `raytracing` device feature. See `vulkan::DeviceFeature`.
+	///
+	class AmbientOcclusionPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Options of ambient occlusion
+		///
+		struct Option
+		{
+			// Rays traced per frame in total, rays per texel are derived from it, see `get_rays_per_pixel`
+			uint32_t ray_budget = 2 * 1048576;
+
+			// Upper limit of rays per ambient occlusion texel
+			uint32_t max_rays_per_pixel = 4;
+
+			// Max distance of an occluder, in world units
+			float radius = 1.0f;
+
+			// Cull mask of the rays, see `Tlas::OPAQUE_INSTANCE_MASK` and `Tlas::ALPHA_INSTANCE_MASK`. Near
+			// instances only by default, see `Tlas::cull()`
+			uint8_t instance_mask = Tlas::OPAQUE_INSTANCE_MASK | Tlas::ALPHA_INSTANCE_MASK;
+
+			bool operator==(const Option&) const noexcept = default;
+		};
+
+		///
+		/// @brief Get the rays traced per ambient occlusion texel to fit a ray budget
+		///
+		/// @param option Options of ambient occlusion
+		/// @param extent Extent of the ambient occlusion attachment
+		/// @return Budget divided by texel count, clamped to `[1, max_rays_per_pixel]`
+		///
+		[[nodiscard]]
+		static uint32_t get_rays_per_pixel(const Option& option, glm::u32vec2 extent) noexcept;
+
+		///
+		/// @brief Create an ambient occlusion pipeline
+		///
+		/// @param context Vulkan context, must have the `raytracing` feature enabled
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<AmbientOcclusionPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Trace the ambient occlusion rays and write the accumulated result
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of ambient occlusion
+		/// @param frame_index Index of the frame, rotates the noise
+		/// @param history_valid Whether the history holds the output of the previous frame, `false` after
+		/// creation, resizing, or frames without ambient occlusion
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			uint64_t frame_index,
+			bool history_valid
+		) const noexcept;
+
+		///
+		/// @brief Clear the output to unoccluded without tracing, for frames with ambient occlusion disabled
+		/// @details Leaves the output in the same layout as `compute`, so that it can stay bound to the
+		/// lighting pass. The cleared output is rejected as history.
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void clear(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 ao_size;
+			glm::u32vec2 full_size;
+			uint32_t downscale;
+			uint32_t rays_per_pixel;
+			float radius;
+			uint32_t instance_mask;
+			uint32_t frame_index;
+			uint32_t history_valid;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		void dispatch(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const PushConstant& push_constant
+		) const noexcept;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+
+		explicit AmbientOcclusionPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline))
+		{}
+
+	  public:
+
+		AmbientOcclusionPipeline(const AmbientOcclusionPipeline&) = delete;
+		AmbientOcclusionPipeline(AmbientOcclusionPipeline&&) = default;
+		AmbientOcclusionPipeline& operator=(const AmbientOcclusionPipeline&) = delete;
+		AmbientOcclusionPipeline& operator=(AmbientOcclusionPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for ambient occlusion pipeline
+	///
+	class AmbientOcclusionPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param tlas TLAS of the scene
+		/// @param deferred Deferred attachment to read depth, normal and velocity from
+		/// @param history Ambient occlusion attachment written by the previous frame
+		/// @param output Ambient occlusion attachment to write into, must have the same resolution as
+		/// @p history
+		/// @param camera Camera buffer
+		/// @param blue_noise View of the blue noise texture in `eShaderReadOnlyOptimal` layout, see
+		/// `image::get_blue_noise`
+		///
+		void update(
+			const vulkan::Context& context,
+			const Tlas& tlas,
+			DeferredAttachment::View deferred,
+			AmbientOcclusionAttachment::View history,
+			AmbientOcclusionAttachment::View output,
+			vulkan::ElementBufferRef<Camera> camera,
+			vk::ImageView blue_noise
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			glm::u32vec2 full_size;
+			AmbientOcclusionAttachment::View output;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class AmbientOcclusionPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/direct-light.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Atmosphere pipeline, precomputes the scattering LUTs of a physically based sky
+	/// @details
+	/// - Follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique",
+	/// see `atmosphere.slang`. Radiance is for a unit sun illuminance, scaled by `DirectLight::light`.
+	/// - The transmittance and multiple scattering LUTs don't depend on the sun, they are baked on the main
+	/// queue before `create` returns and left in `eShaderReadOnlyOptimal` layout
+	/// - The sky-view LUT holds the sky radiance around the viewer, it only depends on the elevation of
+	/// the sun and is recomputed by `compute` when it changes. It is baked once for a zenith sun on
+	/// creation, and left in `eGeneral` layout.
+	/// - The LUTs are owned by the pipeline and shared by all frames, which execute in submission order on
+	/// the same queue
+	///
+	class AtmospherePipeline
+	{
+	  public:
+
+		static constexpr auto LUT_FORMAT = vk::Format::eR16G16B16A16Sfloat;  // RGBA16, Float, 8 BPP
+
+		// Must match `atmosphere.slang`
+		static constexpr auto TRANSMITTANCE_LUT_SIZE = glm::u32vec2(256, 64);
+		static constexpr auto MULTI_SCATTERING_LUT_SIZE = glm::u32vec2(32, 32);
+		static constexpr auto SKY_VIEW_LUT_SIZE = glm::u32vec2(192, 108);
+
+		///
+		/// @brief Views of the LUTs read while lighting
+		///
+		struct LutView
+		{
+			vk::ImageView transmittance;  // In `eShaderReadOnlyOptimal` layout
+			vk::ImageView sky_view;       // In `eGeneral` layout
+		};
+
+		///
+		/// @brief Create an atmosphere pipeline and bake its LUTs
+		///
+		/// @param context Vulkan context
+		/// @return Created pipeline or error
+		///
+		[[nodiscard]]
+		static std::expected<AtmospherePipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Recompute the sky-view LUT for a sun
+		/// @details Synchronizes with the reads of the previous frames and with the reads of the lighting in
+		/// fragment and compute shaders after it
+		///
+		/// @param command_buffer Command buffer
+		/// @param sun Sun, only the elevation of its direction is used
+		///
+		void compute(const vk::raii::CommandBuffer& command_buffer, const DirectLight& sun) const noexcept;
+
+		///
+		/// @brief Get the views of the LUTs
+		///
+		/// @return Views of the LUTs
+		///
+		[[nodiscard]]
+		LutView get_lut_view() const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			float sun_cos_zenith;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;  // Must match all `atmosphere/*.slang` shaders
+
+		vulkan::Image transmittance_lut;
+		vk::raii::ImageView transmittance_view;
+		vulkan::Image multi_scattering_lut;
+		vk::raii::ImageView multi_scattering_view;
+		vulkan::Image sky_view_lut;
+		vk::raii::ImageView sky_view_view;
+
+		vk::raii::Sampler sampler;
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+		vk::raii::DescriptorPool descriptor_pool;
+		vk::raii::DescriptorSet descriptor_set;  // Binds the LUTs to the sky-view program
+
+		explicit AtmospherePipeline(
+			vulkan::Image transmittance_lut,
+			vk::raii::ImageView transmittance_view,
+			vulkan::Image multi_scattering_lut,
+			vk::raii::ImageView multi_scattering_view,
+			vulkan::Image sky_view_lut,
+			vk::raii::ImageView sky_view_view,
+			vk::raii::Sampler sampler,
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline,
+			vk::raii::DescriptorPool descriptor_pool,
+			vk::raii::DescriptorSet descriptor_set
+		) :
+			transmittance_lut(std::move(transmittance_lut)),
+			transmittance_view(std::move(transmittance_view)),
+			multi_scattering_lut(std::move(multi_scattering_lut)),
+			multi_scattering_view(std::move(multi_scattering_view)),
+			sky_view_lut(std::move(sky_view_lut)),
+			sky_view_view(std::move(sky_view_view)),
+			sampler(std::move(sampler)),
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline)),
+			descriptor_pool(std::move(descriptor_pool)),
+			descriptor_set(std::move(descriptor_set))
+		{}
+
+		// Bake the transmittance and multiple scattering LUTs and the initial sky view
+		[[nodiscard]]
+		std::expected<void, Error> bake(const vulkan::Context& context) const noexcept;
+
+	  public:
+
+		AtmospherePipeline(const AtmospherePipeline&) = delete;
+		AtmospherePipeline(AtmospherePipeline&&) = default;
+		AtmospherePipeline& operator=(const AtmospherePipeline&) = delete;
+		AtmospherePipeline& operator=(AtmospherePipeline&&) = default;
+	};
+}
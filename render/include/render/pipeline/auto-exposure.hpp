@@ -4,8 +4,10 @@
 #include "render/interface/auto-exposure.hpp"
 #include "render/resource/auto-exposure.hpp"
 #include "render/resource/hdr.hpp"
+#include "render/resource/luminance-pyramid.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
 
 #include <cstdint>
 #include <expected>
@@ -22,8 +24,10 @@ namespace render
 	///
 	/// @brief Auto exposure pipeline
 	/// @details
-	/// - Takes the HDR image as input, calculates the histogram and compute the exposure value
+	/// - Takes the HDR image as input, builds its luminance pyramid in a single dispatch, calculates the
+	/// histogram of a small pyramid level and compute the exposure value
 	/// - Configure by setting the exposure parameters (`ExposureParam`)
+	/// - Leaves the luminance pyramid in `eGeneral` layout, readable by later compute shaders
 	///
 	class AutoExposurePipeline
 	{
@@ -31,14 +35,25 @@ namespace render
 
 		class ResourceSet;
 
+		// Pyramid level the histogram is computed from, 1/8 of the HDR extent along each axis
+		static constexpr uint32_t HISTOGRAM_LEVEL = 2;
+
 		///
 		/// @brief Create a auto-exposure pipeline
+		/// @details If the device supports basic, ballot and arithmetic subgroup operations in compute
+		/// shaders, the histogram aggregates the lanes sharing a bin before the shared memory atomics, and
+		/// each thread accumulates @p histogram_downscale x @p histogram_downscale pixels. Otherwise falls
+		/// back to one pixel per thread and one shared memory atomic per pixel.
 		///
 		/// @param context Vulkan context
+		/// @param histogram_downscale Pixels per thread along each axis, only used by the subgroup histogram
 		/// @return Created pipeline or error
 		///
 		[[nodiscard]]
-		static std::expected<AutoExposurePipeline, Error> create(const vulkan::Context& context) noexcept;
+		static std::expected<AutoExposurePipeline, Error> create(
+			const vulkan::Context& context,
+			uint32_t histogram_downscale = 1
+		) noexcept;
 
 		///
 		/// @brief Create a given number of resource sets
@@ -55,49 +70,78 @@ namespace render
 
 		///
 		/// @brief Execute computes for auto-exposure
+		/// @note The commands only use compute stages, so that they can be recorded for a compute-only queue
 		///
 		/// @param command_buffer Command buffer to record commands
 		/// @param resource_set Resource set to bind for the compute
+		/// @param dst_stage_mask Stages reading the exposure result later in the same queue. Pass @p eNone if
+		/// the result is consumed by another queue, which synchronizes through a semaphore instead
 		///
 		void compute(
 			const vk::raii::CommandBuffer& command_buffer,
-			const ResourceSet& resource_set
+			const ResourceSet& resource_set,
+			vk::PipelineStageFlags2 dst_stage_mask = vk::PipelineStageFlagBits2::eFragmentShader
 		) const noexcept;
 
 	  private:
 
-		vk::raii::DescriptorSetLayout clear_resource_layout, histogram_resource_layout,
-			reduce_resource_layout;
-		vk::raii::PipelineLayout clear_pipeline_layout, histogram_pipeline_layout, reduce_pipeline_layout;
-		vk::raii::Pipeline clear_pipeline, histogram_pipeline, reduce_pipeline;
+		struct PyramidPushConstant
+		{
+			glm::u32vec2 extent;
+			uint32_t level_count;
+			uint32_t group_count;
+		};
+
+		struct HistogramPushConstant
+		{
+			glm::u32vec2 input_size;
+		};
+
+		static constexpr uint32_t PYRAMID_TILE_EXTENT = 64;  // HDR pixels covered by a pyramid workgroup
+
+		vk::raii::DescriptorSetLayout clear_resource_layout, pyramid_resource_layout,
+			histogram_resource_layout, reduce_resource_layout;
+		vk::raii::PipelineLayout clear_pipeline_layout, pyramid_pipeline_layout, histogram_pipeline_layout,
+			reduce_pipeline_layout;
+		vk::raii::Pipeline clear_pipeline, pyramid_pipeline, histogram_pipeline, reduce_pipeline;
 
 		vk::raii::Sampler input_sampler;
 		vk::raii::Sampler mask_sampler;
 
+		uint32_t histogram_group_extent;  // Pixels covered by a histogram workgroup along each axis
+
 		explicit AutoExposurePipeline(
 			vk::raii::DescriptorSetLayout clear_resource_layout,
+			vk::raii::DescriptorSetLayout pyramid_resource_layout,
 			vk::raii::DescriptorSetLayout histogram_resource_layout,
 			vk::raii::DescriptorSetLayout reduce_resource_layout,
 			vk::raii::PipelineLayout clear_pipeline_layout,
+			vk::raii::PipelineLayout pyramid_pipeline_layout,
 			vk::raii::PipelineLayout histogram_pipeline_layout,
 			vk::raii::PipelineLayout reduce_pipeline_layout,
 			vk::raii::Pipeline clear_pipeline,
+			vk::raii::Pipeline pyramid_pipeline,
 			vk::raii::Pipeline histogram_pipeline,
 			vk::raii::Pipeline reduce_pipeline,
 			vk::raii::Sampler input_sampler,
-			vk::raii::Sampler mask_sampler
+			vk::raii::Sampler mask_sampler,
+			uint32_t histogram_group_extent
 		) :
 			clear_resource_layout(std::move(clear_resource_layout)),
+			pyramid_resource_layout(std::move(pyramid_resource_layout)),
 			histogram_resource_layout(std::move(histogram_resource_layout)),
 			reduce_resource_layout(std::move(reduce_resource_layout)),
 			clear_pipeline_layout(std::move(clear_pipeline_layout)),
+			pyramid_pipeline_layout(std::move(pyramid_pipeline_layout)),
 			histogram_pipeline_layout(std::move(histogram_pipeline_layout)),
 			reduce_pipeline_layout(std::move(reduce_pipeline_layout)),
 			clear_pipeline(std::move(clear_pipeline)),
+			pyramid_pipeline(std::move(pyramid_pipeline)),
 			histogram_pipeline(std::move(histogram_pipeline)),
 			reduce_pipeline(std::move(reduce_pipeline)),
 			input_sampler(std::move(input_sampler)),
-			mask_sampler(std::move(mask_sampler))
+			mask_sampler(std::move(mask_sampler)),
+			histogram_group_extent(histogram_group_extent)
 		{}
 
 	  public:
@@ -123,6 +167,7 @@ namespace render
 		/// @param resource Auto-exposure resources of current frame
 		/// @param prev_resource Auto-exposure resources of previous frame
 		/// @param hdr HDR image input
+		/// @param pyramid Luminance pyramid to build, must have identical extent with the HDR image
 		/// @param mask_image_view Image view of the mask image
 		///
 		void update(
@@ -131,22 +176,27 @@ namespace render
 			const AutoExposureResource& prev_resource,
 			vulkan::ElementBufferRef<ExposureParam> exposure_param,
 			HdrAttachment::View hdr,
+			LuminancePyramidAttachment::View pyramid,
 			vk::ImageView mask_image_view
 		) noexcept;
 
 	  private:
 
 		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
-		vk::raii::DescriptorSet clear_descriptor_set, histogram_descriptor_set, reduce_descriptor_set;
+		vk::raii::DescriptorSet clear_descriptor_set, pyramid_descriptor_set, histogram_descriptor_set,
+			reduce_descriptor_set;
 
 		vk::Sampler input_sampler;
 		vk::Sampler mask_sampler;
 
-		std::optional<glm::u32vec2> image_size;
+		std::optional<LuminancePyramidAttachment::View> pyramid;
+
+		vulkan::DescriptorWriteCache descriptor_cache;
 
 		explicit ResourceSet(
 			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
 			vk::raii::DescriptorSet clear_descriptor_set,
+			vk::raii::DescriptorSet pyramid_descriptor_set,
 			vk::raii::DescriptorSet histogram_descriptor_set,
 			vk::raii::DescriptorSet reduce_descriptor_set,
 			vk::Sampler input_sampler,
@@ -154,6 +204,7 @@ namespace render
 		) :
 			descriptor_pool(std::move(descriptor_pool)),
 			clear_descriptor_set(std::move(clear_descriptor_set)),
+			pyramid_descriptor_set(std::move(pyramid_descriptor_set)),
 			histogram_descriptor_set(std::move(histogram_descriptor_set)),
 			reduce_descriptor_set(std::move(reduce_descriptor_set)),
 			input_sampler(input_sampler),
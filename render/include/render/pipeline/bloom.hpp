@@ -0,0 +1,192 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/resource/bloom.hpp"
+#include "render/resource/taa.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Bloom pipeline, dual filtered over the bloom chain of the TAA output
+	/// @details
+	/// - Downsamples the TAA output through every level of the bloom chain, then upsamples back to level 0,
+	/// adding each level onto the next finer one. Every pass runs at the resolution of its level, so the
+	/// whole chain costs a fixed fraction of a single full resolution pass, however wide the bloom is.
+	/// - Level 0 holds the normalized sum of all levels, composited over the image with a single bilinear
+	/// fetch, see `CompositePipeline::render`
+	/// - The first downsample weights its taps by inverse luminance, so that single bright pixels do not
+	/// flicker through the chain
+	/// - Expects the TAA attachment to be in `eGeneral` layout as left by `TaaPipeline`, and leaves the
+	/// bloom chain in `eGeneral` layout, ready to be sampled by fragment shaders
+	///
+	class BloomPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a bloom pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<BloomPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Build the bloom chain
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+		///
+		/// @brief Discard the content of a bloom chain and transition it to `eGeneral` layout. Used when
+		/// bloom is disabled, so that the composite can still bind the chain.
+		///
+		/// @param command_buffer Command buffer
+		/// @param bloom Bloom chain
+		///
+		static void discard(
+			const vk::raii::CommandBuffer& command_buffer,
+			BloomAttachment::View bloom
+		) noexcept;
+
+	  private:
+
+		struct DownsamplePushConstant
+		{
+			glm::u32vec2 src_size;
+			glm::u32vec2 dst_size;
+			vk::Bool32 karis_average;
+		};
+
+		struct UpsamplePushConstant
+		{
+			glm::u32vec2 src_size;
+			glm::u32vec2 dst_size;
+			float scale;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline downsample_pipeline;
+		vk::raii::Pipeline upsample_pipeline;
+		vk::raii::Sampler sampler;
+
+		explicit BloomPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline downsample_pipeline,
+			vk::raii::Pipeline upsample_pipeline,
+			vk::raii::Sampler sampler
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			downsample_pipeline(std::move(downsample_pipeline)),
+			upsample_pipeline(std::move(upsample_pipeline)),
+			sampler(std::move(sampler))
+		{}
+
+	  public:
+
+		BloomPipeline(const BloomPipeline&) = delete;
+		BloomPipeline(BloomPipeline&&) = default;
+		BloomPipeline& operator=(const BloomPipeline&) = delete;
+		BloomPipeline& operator=(BloomPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for bloom pipeline. Holds one descriptor set per pass
+	///
+	class BloomPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param taa TAA attachment to build from
+		/// @param bloom Bloom chain to build into, created for the extent of @p taa
+		///
+		void update(
+			const vulkan::Context& context,
+			TaaAttachment::View taa,
+			BloomAttachment::View bloom
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		std::vector<vk::raii::DescriptorSet> downsample_sets;  // One for each level
+		std::vector<vk::raii::DescriptorSet> upsample_sets;    // One for each level except the last
+
+		vk::Sampler sampler;
+
+		struct Resource
+		{
+			TaaAttachment::View taa;
+			BloomAttachment::View bloom;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			std::vector<vk::raii::DescriptorSet> downsample_sets,
+			std::vector<vk::raii::DescriptorSet> upsample_sets,
+			vk::Sampler sampler
+		) noexcept :
+			descriptor_pool(std::move(descriptor_pool)),
+			downsample_sets(std::move(downsample_sets)),
+			upsample_sets(std::move(upsample_sets)),
+			sampler(sampler)
+		{}
+
+		friend class BloomPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/cull-view.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/resource/cascade-shadow.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/shadow.hpp"
+#include "render/resource/transform.hpp"
+#include "render/util/per-render-state.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Cascaded shadow map pipeline, rasterizes the shadow casters of the primary light into the
+	/// cascades, and resolves them into the shadow mask
+	/// @details
+	/// - Cascade `i` is the additional view `i` of the indirect resource (see
+	/// `IndirectResource::upload_views`), so the casters of every cascade are culled by the same indirect
+	/// dispatch as the main camera. Upload the cascades from `fit_cascades()` as views before running the
+	/// indirect pipeline
+	/// - Shares the vertex paths and rasterization states of the deferred pipeline, with depth only output.
+	/// Fragment shaders are bound for alpha-masked render states alone. Opaque render states of
+	/// @p VertexFormat::Full fetch positions only, from the tightly packed position stream if the model
+	/// has one (see `MeshList::Ref::position_buffer`)
+	/// - Only the cascades in the dirty mask are rendered, the others keep their content from previous
+	/// frames, see `CascadeShadowAttachment::acquire_dirty_cascades()`
+	/// - The resolve pass writes the shadow mask like `ShadowPipeline`, so the lighting pass consumes either
+	/// of them alike. It expects the deferred attachments to be in `eShaderReadOnlyOptimal` layout, and
+	/// leaves the shadow mask in `eGeneral` layout, ready to be sampled by fragment shaders
+	/// @note Unlike `ShadowPipeline`, this requires no raytracing feature
+	///
+	class CascadeShadowPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a cascaded shadow map pipeline
+		///
+		/// @param context Vulkan context
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to render, see `MeshList::create`
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<CascadeShadowPipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full
+		) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Render the shadow casters into the dirty cascades
+		/// @note Must be recorded after the indirect pipeline and outside of rendering
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param dirty_mask Cascades to render, bit `i` for cascade `i`
+		///
+		void render(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			uint32_t dirty_mask
+		) const noexcept;
+
+		///
+		/// @brief Sample the cascades and write the shadow mask
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void resolve(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 alpha_mask_enabled;
+		};
+
+		struct RenderPushConstant
+		{
+			uint32_t cascade_index;
+		};
+
+		struct ResolvePushConstant
+		{
+			glm::u32vec2 mask_size;
+			glm::u32vec2 full_size;
+			uint32_t downscale;
+			uint32_t cascade_count;
+			uint32_t cascade_resolution;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		static std::expected<vk::raii::Pipeline, Error> create_render_pipeline(
+			const vulkan::Context& context,
+			const vk::raii::PipelineLayout& pipeline_layout,
+			const vk::raii::ShaderModule& shader_module,
+			VertexFormat vertex_format,
+			bool alpha_mask_enabled,
+			bool double_sided
+		) noexcept;
+
+		vk::raii::DescriptorSetLayout render_descriptor_set_layout;
+		vk::raii::PipelineLayout render_pipeline_layout;
+		PerRenderState<vk::raii::Pipeline> render_pipelines;
+
+		vk::raii::DescriptorSetLayout resolve_descriptor_set_layout;
+		vk::raii::PipelineLayout resolve_pipeline_layout;
+		vk::raii::Pipeline resolve_pipeline;
+
+		VertexFormat vertex_format;
+
+		explicit CascadeShadowPipeline(
+			vk::raii::DescriptorSetLayout render_descriptor_set_layout,
+			vk::raii::PipelineLayout render_pipeline_layout,
+			PerRenderState<vk::raii::Pipeline> render_pipelines,
+			vk::raii::DescriptorSetLayout resolve_descriptor_set_layout,
+			vk::raii::PipelineLayout resolve_pipeline_layout,
+			vk::raii::Pipeline resolve_pipeline,
+			VertexFormat vertex_format
+		) :
+			render_descriptor_set_layout(std::move(render_descriptor_set_layout)),
+			render_pipeline_layout(std::move(render_pipeline_layout)),
+			render_pipelines(std::move(render_pipelines)),
+			resolve_descriptor_set_layout(std::move(resolve_descriptor_set_layout)),
+			resolve_pipeline_layout(std::move(resolve_pipeline_layout)),
+			resolve_pipeline(std::move(resolve_pipeline)),
+			vertex_format(vertex_format)
+		{}
+
+	  public:
+
+		CascadeShadowPipeline(const CascadeShadowPipeline&) = delete;
+		CascadeShadowPipeline(CascadeShadowPipeline&&) = default;
+		CascadeShadowPipeline& operator=(const CascadeShadowPipeline&) = delete;
+		CascadeShadowPipeline& operator=(CascadeShadowPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for cascaded shadow map pipeline
+	///
+	class CascadeShadowPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance
+		/// @param transform Transform resource, providing world transforms of the nodes
+		/// @param indirect_resource Indirect drawcall resource, with at least `cascade_count` additional
+		/// views holding the cascades
+		/// @param cascade_shadow Cascaded shadow map attachment
+		/// @param deferred Deferred attachment to read depth and normal from
+		/// @param shadow_mask Shadow mask attachment to write into
+		/// @param camera Camera buffer
+		/// @param direct_light Primary light buffer
+		///
+		/// @warning The vertex format of the model must match the pipeline, or a fatal/unrecoverable error
+		/// will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const TransformResource& transform,
+			const IndirectResource& indirect_resource,
+			CascadeShadowAttachment::View cascade_shadow,
+			DeferredAttachment::View deferred,
+			ShadowMaskAttachment::View shadow_mask,
+			vulkan::ElementBufferRef<Camera> camera,
+			vulkan::ElementBufferRef<DirectLight> direct_light
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		PerRenderState<vk::raii::DescriptorSet> render_descriptor_set;
+		vk::raii::DescriptorSet resolve_descriptor_set;
+
+		// External resources
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+
+			vk::Buffer vertex_buffer;
+			VertexFormat vertex_format;
+			vk::Buffer position_buffer;
+			vk::DeviceSize position_stride;
+			vk::Buffer index_buffer;
+			IndexFormat index_format;
+			PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>> indirect_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>> command_buffers;
+			PerRenderState<vulkan::ElementBufferRef<IndirectCount>> count_buffers;
+
+			CascadeShadowAttachment::View cascade_shadow;
+			glm::u32vec2 full_size;
+			ShadowMaskAttachment::View shadow_mask;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			PerRenderState<vk::raii::DescriptorSet> render_descriptor_set,
+			vk::raii::DescriptorSet resolve_descriptor_set
+		) :
+			descriptor_pool(std::move(descriptor_pool)),
+			render_descriptor_set(std::move(render_descriptor_set)),
+			resolve_descriptor_set(std::move(resolve_descriptor_set))
+		{}
+
+		friend class CascadeShadowPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -2,9 +2,13 @@
 
 #include "common/util/error.hpp"
 #include "render/interface/auto-exposure.hpp"
-#include "render/resource/hdr.hpp"
+#include "render/resource/bloom.hpp"
+#include "render/resource/taa.hpp"
+#include "render/resource/transparent.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/image.hpp"
 #include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
 
 #include <cstdint>
 #include <expected>
@@ -21,7 +25,10 @@ namespace render
 {
 	///
 	/// @brief Composite pipeline
-	/// @details Takes the HDR image and exposure result, composites and tonemaps the image
+	/// @details Takes the upscaled HDR image and exposure result (see `TaaPipeline` and
+	/// `SpatialUpscalePipeline`), optionally sharpens it, blends the bloom chain over it (see
+	/// `BloomPipeline`), resolves the transparent layers over it (see `TransparentPipeline`), then tonemaps
+	/// the image
 	///
 	class CompositePipeline
 	{
@@ -29,17 +36,30 @@ namespace render
 
 		class ResourceSet;
 
+		///
+		/// @brief How the exposed HDR color is tonemapped
+		///
+		enum class TonemapMode
+		{
+			Analytic,  // Evaluate the tonemapping curve per pixel
+			Lut,       // Single trilinear fetch from a 3D LUT baked on creation
+		};
+
 		///
 		/// @brief Create a composite pipeline
+		/// @details The tonemapping LUT is baked on the main queue before returning, whichever @p mode is
+		/// used, so that its descriptor is always valid
 		///
 		/// @param context Vulkan context
 		/// @param target_format Format of the target image
+		/// @param mode Tonemapping mode
 		/// @return Created pipeline or error
 		///
 		[[nodiscard]]
 		static std::expected<CompositePipeline, Error> create(
 			const vulkan::Context& context,
-			vk::Format target_format
+			vk::Format target_format,
+			TonemapMode mode = TonemapMode::Lut
 		) noexcept;
 
 		///
@@ -60,29 +80,55 @@ namespace render
 		///
 		/// @param command_buffer Command buffer
 		/// @param resource_set Resource set
+		/// @param bloom_intensity Blend factor of the bloom chain in `[0, 1]`, `0` skips the bloom fetch and
+		/// leaves the chain unread
+		/// @param sharpness Strength of the contrast-adaptive sharpening in `[0, 1]`, `0` skips it
 		///
 		void render(
 			const vk::raii::CommandBuffer& command_buffer,
-			const ResourceSet& resource_set
+			const ResourceSet& resource_set,
+			float bloom_intensity = 0.0f,
+			float sharpness = 0.0f
 		) const noexcept;
 
 	  private:
 
+		struct PushConstant
+		{
+			glm::u32vec2 transparent_extent;
+			float bloom_intensity;
+			float sharpness;
+		};
+
 		vk::raii::DescriptorSetLayout resource_layout;
 		vk::raii::PipelineLayout pipeline_layout;
 		vk::raii::Pipeline pipeline;
 		vk::raii::Sampler input_sampler;
+		vk::raii::Sampler transparent_sampler;  // Bilinear, for the transparent layers and the bloom chain
+
+		// Tonemapping LUT in `eShaderReadOnlyOptimal` layout, sampled trilinearly
+		vulkan::Image tonemap_lut;
+		vk::raii::ImageView tonemap_lut_view;
+		vk::raii::Sampler tonemap_lut_sampler;
 
 		explicit CompositePipeline(
 			vk::raii::DescriptorSetLayout resource_layout,
 			vk::raii::PipelineLayout pipeline_layout,
 			vk::raii::Pipeline pipeline,
-			vk::raii::Sampler input_sampler
+			vk::raii::Sampler input_sampler,
+			vk::raii::Sampler transparent_sampler,
+			vulkan::Image tonemap_lut,
+			vk::raii::ImageView tonemap_lut_view,
+			vk::raii::Sampler tonemap_lut_sampler
 		) :
 			resource_layout(std::move(resource_layout)),
 			pipeline_layout(std::move(pipeline_layout)),
 			pipeline(std::move(pipeline)),
-			input_sampler(std::move(input_sampler))
+			input_sampler(std::move(input_sampler)),
+			transparent_sampler(std::move(transparent_sampler)),
+			tonemap_lut(std::move(tonemap_lut)),
+			tonemap_lut_view(std::move(tonemap_lut_view)),
+			tonemap_lut_sampler(std::move(tonemap_lut_sampler))
 		{}
 
 	  public:
@@ -104,14 +150,17 @@ namespace render
 		/// @brief Update the resource set
 		///
 		/// @param context Vulkan context
-		/// @param exposure_resource Exposure resource of current frame
-		/// @param forward_resource Forward rendering resource of current frame
-		/// @param image_size Size of the input and output image
+		/// @param exposure_result Exposure result of current frame
+		/// @param taa TAA attachment of current frame, see `TaaPipeline`
+		/// @param transparent Transparent attachment of current frame, see `TransparentPipeline`
+		/// @param bloom Bloom chain of current frame, see `BloomPipeline`
 		///
 		void update(
 			const vulkan::Context& context,
 			vulkan::ElementBufferRef<ExposureResult> exposure_result,
-			HdrAttachment::View hdr
+			TaaAttachment::View taa,
+			TransparentAttachment::View transparent,
+			BloomAttachment::View bloom
 		) noexcept;
 
 	  private:
@@ -120,17 +169,29 @@ namespace render
 		vk::raii::DescriptorSet descriptor_set;
 
 		vk::Sampler sampler;
+		vk::Sampler transparent_sampler;
+		vk::ImageView tonemap_lut_view;
+		vk::Sampler tonemap_lut_sampler;
 
 		std::optional<glm::u32vec2> image_size = std::nullopt;
+		glm::u32vec2 transparent_extent = {0, 0};
+
+		vulkan::DescriptorWriteCache descriptor_cache;
 
 		explicit ResourceSet(
 			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
 			vk::raii::DescriptorSet descriptor_set,
-			vk::Sampler sampler
+			vk::Sampler sampler,
+			vk::Sampler transparent_sampler,
+			vk::ImageView tonemap_lut_view,
+			vk::Sampler tonemap_lut_sampler
 		) :
 			descriptor_pool(std::move(descriptor_pool)),
 			descriptor_set(std::move(descriptor_set)),
-			sampler(sampler)
+			sampler(sampler),
+			transparent_sampler(transparent_sampler),
+			tonemap_lut_view(tonemap_lut_view),
+			tonemap_lut_sampler(tonemap_lut_sampler)
 		{}
 
 		friend class CompositePipeline;
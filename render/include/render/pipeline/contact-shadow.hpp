@@ -0,0 +1,181 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/shadow.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Screen-space contact shadow pipeline, marches a short segment toward the primary light in the
+	/// depth buffer and merges the occlusion into the shadow mask
+	/// @details
+	/// - Recovers the small-scale shadows lost to shadow ray biasing and to the limited resolution of shadow
+	/// maps, at a cost bounded by `Option::step_count` per mask texel
+	/// - Runs after the shadow pass (`ShadowPipeline` or `CascadeShadowPipeline::resolve`) of the same frame,
+	/// texels already shadowed are skipped. Runs at the resolution of the shadow mask, which may be halved.
+	/// - Expects the deferred attachments to be in `eShaderReadOnlyOptimal` layout, and the shadow mask in
+	/// `eGeneral` layout as left by the shadow pass. Leaves the shadow mask in `eGeneral` layout.
+	/// - Only surfaces visible on screen cast contact shadows
+	///
+	class ContactShadowPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Options of contact shadows
+		///
+		struct Option
+		{
+			uint32_t step_count = 12;    // Steps of the march toward the light
+			float max_distance = 0.25f;  // Length of the march, in world units
+			float thickness = 0.02f;     // Assumed thickness of the depth buffer, relative to the view depth
+		};
+
+		///
+		/// @brief Create a contact shadow pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<ContactShadowPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief March toward the light and clear the occluded texels of the shadow mask
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of contact shadows
+		/// @param frame_index Index of the frame, rotates the step offsets
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			uint64_t frame_index
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 mask_size;
+			glm::u32vec2 full_size;
+			uint32_t downscale;
+			uint32_t step_count;
+			float max_distance;
+			float thickness;
+			uint32_t frame_index;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+
+		explicit ContactShadowPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline))
+		{}
+
+	  public:
+
+		ContactShadowPipeline(const ContactShadowPipeline&) = delete;
+		ContactShadowPipeline(ContactShadowPipeline&&) = default;
+		ContactShadowPipeline& operator=(const ContactShadowPipeline&) = delete;
+		ContactShadowPipeline& operator=(ContactShadowPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for contact shadow pipeline
+	///
+	class ContactShadowPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param deferred Deferred attachment to read depth from
+		/// @param shadow_mask Shadow mask attachment to merge into, written by the shadow pass
+		/// @param camera Camera buffer
+		/// @param direct_light Primary light buffer
+		///
+		void update(
+			const vulkan::Context& context,
+			DeferredAttachment::View deferred,
+			ShadowMaskAttachment::View shadow_mask,
+			vulkan::ElementBufferRef<Camera> camera,
+			vulkan::ElementBufferRef<DirectLight> direct_light
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			glm::u32vec2 full_size;
+			ShadowMaskAttachment::View shadow_mask;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class ContactShadowPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/hiz.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "render/util/per-render-state.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+namespace render
+{
+	///
+	/// @brief Meshlet-based deferred rendering pipeline, using task and mesh shaders
+	/// @details Drop-in replacement of `DeferredPipeline` with identical attachments and synchronization
+	/// scheme. Instead of drawing whole primitives, each visible indirect drawcall is expanded into its
+	/// meshlets (see `model::Meshlet`), which are culled individually by the task shader:
+	/// - Frustum culling against the bounding sphere
+	/// - Back-face culling against the normal cone, skipped for double-sided materials
+	/// - Occlusion culling against the current frame's HiZ, only in @p DrawPhase::Late
+	///
+	/// Task groups are dispatched as `(meshlet_chunks, indirect_entries, 1)`, where each chunk covers
+	/// `TASK_GROUP_SIZE` meshlets of a primitive. Chunks are sized for the largest primitive of the model,
+	/// groups beyond the meshlet count or the draw count of the phase exit without emitting mesh groups.
+	///
+	/// @note Requires the `mesh_shader` device feature. See `vulkan::DeviceFeature`.
+	/// @note The late phase must directly follow the early phase of the same frame, with only shader reads of
+	/// the attachments in between (e.g. HiZ build)
+	///
+	class MeshletDeferredPipeline
+	{
+	  public:
+
+		// Meshlets tested by a single task group, must match the task shader
+		static constexpr uint32_t TASK_GROUP_SIZE = 32;
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a meshlet deferred rendering pipeline
+		///
+		/// @param context Vulkan context, must have the `mesh_shader` feature enabled
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to render, see `MeshList::create`
+		/// @param hdr_format Format of the HDR attachments rendered to, see `HdrAttachment::format`
+		/// @return Created pipeline, or error if creation failed
+		///
+		[[nodiscard]]
+		static std::expected<MeshletDeferredPipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full,
+			vk::Format hdr_format = HdrAttachment::HDR_FORMAT
+		) noexcept;
+
+		///
+		/// @brief Create a given number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Render the scene using the meshlet deferred rendering pipeline
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param phase Draw phase, @p DrawPhase::Early clears the attachments and @p DrawPhase::Late draws
+		/// on top of the early phase results
+		///
+		void render(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			DrawPhase phase
+		) const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 alpha_mask_enabled;
+			vk::Bool32 double_sided;
+			vk::Bool32 packed_vertex;
+		};
+
+		struct PushConstant
+		{
+			glm::u32vec2 curr_hiz_size;  // Extent in use of the current HiZ
+			uint32_t phase;              // 0 for early phase, 1 for late phase
+			uint32_t entry_offset;       // Offset of the first indirect entry of the phase
+			uint32_t entry_base;         // Base entry index of the current batch, relative to `entry_offset`
+		};
+
+		// Task group count limits of the device
+		struct TaskLimit
+		{
+			uint32_t max_group_count_x;
+			uint32_t max_group_count_y;
+			uint32_t max_group_total_count;
+		};
+
+		static std::expected<vk::raii::Pipeline, Error> create_pipeline(
+			const vulkan::Context& context,
+			const vk::raii::PipelineLayout& pipeline_layout,
+			const vk::raii::ShaderModule& shader_module,
+			VertexFormat vertex_format,
+			vk::Format hdr_format,
+			bool alpha_mask_enabled,
+			bool double_sided
+		) noexcept;
+
+		vk::raii::DescriptorSetLayout data_descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		PerRenderState<vk::raii::Pipeline> pipelines;
+		TaskLimit task_limit;
+		VertexFormat vertex_format;
+
+		explicit MeshletDeferredPipeline(
+			vk::raii::DescriptorSetLayout data_descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			PerRenderState<vk::raii::Pipeline> pipelines,
+			TaskLimit task_limit,
+			VertexFormat vertex_format
+		) :
+			data_descriptor_set_layout(std::move(data_descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipelines(std::move(pipelines)),
+			task_limit(task_limit),
+			vertex_format(vertex_format)
+		{}
+
+	  public:
+
+		MeshletDeferredPipeline(const MeshletDeferredPipeline&) = delete;
+		MeshletDeferredPipeline(MeshletDeferredPipeline&&) = default;
+		MeshletDeferredPipeline& operator=(const MeshletDeferredPipeline&) = delete;
+		MeshletDeferredPipeline& operator=(MeshletDeferredPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for meshlet deferred pipeline
+	///
+	class MeshletDeferredPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance
+		/// @param transform Transform resource, providing world transforms of the nodes
+		/// @param prev_transform Transform resource of previous frame, for motion vectors. Pass @p transform
+		/// if previous frame has no world transforms
+		/// @param indirect_resource Indirect drawcall resource
+		/// @param deferred_attachment Deferred attachments
+		/// @param hdr_attachment HDR attachments
+		/// @param curr_hiz Current frame's HiZ, built from the early phase depth
+		/// @param camera_param Camera parameter buffer
+		/// @param material_feedback Feedback buffer accumulating covered pixels of each material, see
+		/// `TextureFeedbackResource`
+		///
+		/// @warning Deferred and HDR attachments must have identical extents, and the vertex format of the
+		/// model must match the pipeline, or a fatal/unrecoverable error will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const TransformResource& transform,
+			const TransformResource& prev_transform,
+			const IndirectResource& indirect_resource,
+			DeferredAttachment::View deferred_attachment,
+			HdrAttachment::View hdr_attachment,
+			HizAttachment::View curr_hiz,
+			vulkan::ElementBufferRef<Camera> camera_param,
+			vulkan::ArrayBufferRef<uint32_t> material_feedback
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		PerRenderState<vk::raii::DescriptorSet> data_descriptor_set;
+
+		// External resources
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+
+			PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>> indirect_buffers;
+			PerRenderState<vulkan::ElementBufferRef<IndirectCount>> count_buffers;
+			uint32_t max_meshlet_count;
+			VertexFormat vertex_format;
+
+			vk::Image curr_hiz;
+			glm::u32vec2 curr_hiz_size;
+			gbuffer::Attachment attachment;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			PerRenderState<vk::raii::DescriptorSet> data_descriptor_set
+		) :
+			descriptor_pool(std::move(descriptor_pool)),
+			data_descriptor_set(std::move(data_descriptor_set))
+		{}
+
+		friend class MeshletDeferredPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
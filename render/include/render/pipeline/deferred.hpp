@@ -2,7 +2,6 @@
 
 #include <cstdint>
 #include <expected>
-#include <glm/ext/vector_uint2_sized.hpp>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -11,20 +10,23 @@
 #include <vulkan/vulkan_raii.hpp>
 
 #include "common/util/error.hpp"
-#include "model/mesh.hpp"
 #include "render/interface/camera.hpp"
 #include "render/interface/direct-light.hpp"
 #include "render/interface/indirect-drawcall.hpp"
 #include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
 #include "render/model/model.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/pipeline/util/variant-cache.hpp"
 #include "render/resource/deferred.hpp"
 #include "render/resource/hdr.hpp"
-#include "render/resource/host.hpp"
 #include "render/resource/indirect.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "render/resource/transform.hpp"
 #include "render/util/per-render-state.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
-#include "vulkan/interface/attachment.hpp"
 #include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
 
 namespace render
 {
@@ -32,7 +34,20 @@ namespace render
 	/// @brief Deferred rendering pipeline
 	/// @details
 	/// - Takes the indirect drawcalls and render to deferred attachment
-	/// - Supports 4 material variants, where BLEND is currently rendered as MASK
+	/// - Material variants are keyed by `MaterialFeatures`. BLEND drawcalls are in their own bucket of the
+	/// scene graph, drawn by `TransparentPipeline`. Only the generic variant is compiled on creation, the
+	/// variants of a model are compiled in the background once requested with @p request_variants, see
+	/// `PipelineVariantCache`
+	/// - Geometry is rasterized with `Camera::jitter`, velocity is the texcoord offset from a pixel to its
+	/// position in the previous frame, excluding the jitter
+	/// - Vertices are either fed by fixed-function vertex input, or pulled from the vertex buffer of the
+	/// mesh list by `PrimitiveAttribute::vertex_offset`, see `VertexFetch`
+	/// - With the `fragment_shading_rate` device feature, fragments are shaded at the rates of the shading
+	/// rate image given to the resource set, see `ShadingRatePipeline`. Depth is still tested per pixel.
+	/// - With more than one view (see `create`), every drawcall is broadcast to all layers of the
+	/// attachments in a single multiview pass. View 0 is transformed by the camera and view 1 by the second
+	/// camera of the resource set. The drawcalls must be culled against a view enclosing both (see
+	/// `scene::StereoRig::cull_view`), without occlusion culling, as the HiZ only covers one view.
 	///
 	/// ### Color attachments
 	///
@@ -41,10 +56,25 @@ namespace render
 	/// | 0        | Albedo      | Albedo R     | Albedo G  | Albedo B | Sky Flag |
 	/// | 1        | Normal      | Packed Norm. | -         | -        | -        |
 	/// | 2        | PBR         | Roughness    | Metalness | -        | -        |
-	/// | 3        | HDR Output  | HDR R        | HDR G     | HDR B    | Alpha    |
+	/// | 3        | Velocity    | Offset U     | Offset V  | -        | -        |
+	/// | 4        | HDR Output  | HDR R        | HDR G     | HDR B    | Alpha    |
+	/// | 5        | Object ID   | Packed ID    | -         | -        | -        |
+	///
+	/// The object ID packs the render state and the indirect drawcall index like the first word of a
+	/// visibility buffer texel, see `ObjectPickPipeline`
+	///
+	/// ### Depth prepass
+	///
+	/// Alpha-tested fragment shaders disable early depth tests, so overlapping masked geometry (e.g. foliage)
+	/// runs the full G-buffer shader for every layer. With a depth prepass (see `DepthPrepass`), the selected
+	/// render states are first drawn depth only, with alpha tests where masked, then drawn again with an
+	/// `eEqual` depth test and forced early fragment tests, so each pixel is shaded once. Selected per
+	/// `render()` call, the pipelines of every pass are compiled together for each variant.
 	///
 	/// @note Synchronization scheme used by this pipeline expects next usage of the HDR attachment is color
 	/// attachment (which is very likely to be lighting pass)
+	/// @note The late phase must directly follow the early phase of the same frame, with only shader reads of
+	/// the attachments in between (e.g. HiZ build)
 	///
 	class DeferredPipeline
 	{
@@ -52,17 +82,45 @@ namespace render
 
 		class ResourceSet;
 
+		///
+		/// @brief How the vertex shader fetches vertices
+		///
+		enum class VertexFetch
+		{
+			Attribute,  // Fixed-function vertex input from the bound vertex buffer
+			Pull        // Loaded from the vertex buffer as a storage buffer, no vertex input state
+		};
+
+		///
+		/// @brief Render states drawn with a depth prepass
+		///
+		enum class DepthPrepass
+		{
+			None,    // No prepass, every render state is shaded with regular depth tests
+			Masked,  // Alpha-masked render states only
+			All      // Every render state
+		};
+
 		///
 		/// @brief Create a deferred rendering pipeline
 		///
-		/// @param context Vulkan context
+		/// @param context Vulkan context, must outlive the pipeline as variants are compiled with it
 		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to render, see `MeshList::create`
+		/// @param vertex_fetch How vertices are fetched, see `VertexFetch`
+		/// @param view_count Views rendered at once, `1` or `2`. Must match the attachments of the resource
+		/// sets, and can't be combined with the `fragment_shading_rate` device feature.
+		/// @param hdr_format Format of the HDR attachments rendered to, see `HdrAttachment::format`
 		/// @return Created deferred rendering pipeline, or error if creation failed
 		///
 		[[nodiscard]]
 		static std::expected<DeferredPipeline, Error> create(
 			const vulkan::Context& context,
-			const render::MaterialLayout& material_layout
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full,
+			VertexFetch vertex_fetch = VertexFetch::Attribute,
+			uint32_t view_count = 1,
+			vk::Format hdr_format = HdrAttachment::HDR_FORMAT
 		) noexcept;
 
 		///
@@ -78,15 +136,47 @@ namespace render
 			uint32_t count
 		) const noexcept;
 
+		///
+		/// @brief Start compiling the variants of the material modes used by a material list
+		///
+		/// @param material_list Material list of the model to render
+		///
+		void request_variants(const MaterialList& material_list) noexcept;
+
+		///
+		/// @brief Adopt the variants compiled since the last call, see `PipelineVariantCache::update`
+		/// @note Call between frames, not concurrently with @p render
+		///
+		/// @return `void` if success, or error of a failed variant, which keeps drawing with the generic one
+		///
+		[[nodiscard]]
+		std::expected<void, Error> update_variants() noexcept;
+
+		///
+		/// @brief Check if any requested variant is still compiling
+		///
+		/// @return `true` if compiling
+		///
+		[[nodiscard]]
+		bool compiling_variants() const noexcept
+		{
+			return variants.compiling();
+		}
+
 		///
 		/// @brief Render the scene using the deferred rendering pipeline
 		///
 		/// @param command_buffer Command buffer
 		/// @param resource_set Resource set
+		/// @param phase Draw phase, @p DrawPhase::Early clears the attachments and @p DrawPhase::Late draws
+		/// on top of the early phase results
+		/// @param depth_prepass Render states drawn with a depth prepass, see `DepthPrepass`
 		///
 		void render(
 			const vk::raii::CommandBuffer& command_buffer,
-			const ResourceSet& resource_set
+			const ResourceSet& resource_set,
+			DrawPhase phase,
+			DepthPrepass depth_prepass = DepthPrepass::None
 		) const noexcept;
 
 	  private:
@@ -95,28 +185,80 @@ namespace render
 		{
 			vk::Bool32 alpha_mask_enabled;
 			vk::Bool32 double_sided;
+			vk::Bool32 packed_vertex;
+		};
+
+		// Pass a pipeline variant is drawn in
+		enum class Pass
+		{
+			GBuffer,       // Shaded with regular depth tests
+			DepthPrepass,  // Depth only, alpha-tested if masked
+			DepthEqual     // Shaded on top of the prepass with `eEqual` depth tests
+		};
+
+		// Pipelines of a material variant, one for each pass
+		struct Variant
+		{
+			vk::raii::Pipeline gbuffer;
+			vk::raii::Pipeline prepass;
+			vk::raii::Pipeline depth_equal;
 		};
 
 		static std::expected<vk::raii::Pipeline, Error> create_pipeline(
 			const vulkan::Context& context,
-			const vk::raii::PipelineLayout& pipeline_layout,
-			const vk::raii::ShaderModule& shader_module,
+			vk::PipelineLayout pipeline_layout,
+			vk::ShaderModule shader_module,
+			VertexFormat vertex_format,
+			VertexFetch vertex_fetch,
+			uint32_t view_count,
+			vk::Format hdr_format,
+			Pass pass,
 			bool alpha_mask_enabled,
 			bool double_sided
 		) noexcept;
 
+		// Compile all passes of a variant
+		static std::expected<Variant, Error> create_variant(
+			const vulkan::Context& context,
+			vk::PipelineLayout pipeline_layout,
+			vk::ShaderModule shader_module,
+			VertexFormat vertex_format,
+			VertexFetch vertex_fetch,
+			uint32_t view_count,
+			vk::Format hdr_format,
+			MaterialFeatures features
+		) noexcept;
+
+		// Draw all render states selected by a mask with a set of pipelines
+		void draw(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			DrawPhase phase,
+			const PerRenderState<vk::Pipeline>& pipelines,
+			const PerRenderState<bool>& mask
+		) const noexcept;
+
 		vk::raii::DescriptorSetLayout data_descriptor_set_layout;
 		vk::raii::PipelineLayout pipeline_layout;
-		PerRenderState<vk::raii::Pipeline> pipelines;
+		PipelineVariantCache<Variant> variants;  // Declared after `pipeline_layout` to join first
+		VertexFormat vertex_format;
+		VertexFetch vertex_fetch;
+		bool variable_rate;  // Pipelines accept a fragment shading rate attachment
 
 		explicit DeferredPipeline(
 			vk::raii::DescriptorSetLayout data_descriptor_set_layout,
 			vk::raii::PipelineLayout pipeline_layout,
-			PerRenderState<vk::raii::Pipeline> pipelines
+			PipelineVariantCache<Variant> variants,
+			VertexFormat vertex_format,
+			VertexFetch vertex_fetch,
+			bool variable_rate
 		) :
 			data_descriptor_set_layout(std::move(data_descriptor_set_layout)),
 			pipeline_layout(std::move(pipeline_layout)),
-			pipelines(std::move(pipelines))
+			variants(std::move(variants)),
+			vertex_format(vertex_format),
+			vertex_fetch(vertex_fetch),
+			variable_rate(variable_rate)
 		{}
 
 	  public:
@@ -141,24 +283,35 @@ namespace render
 		/// @param model Model instance
 		/// @param camera_param Camera parameter buffer
 		/// @param primary_light_param  Primary light parameter buffer
-		/// @param host_drawcall Host drawcall resource
+		/// @param material_feedback Feedback buffer accumulating covered pixels of each material, see
+		/// `TextureFeedbackResource`
+		/// @param transform Transform resource, providing world transforms of the nodes
+		/// @param prev_transform Transform resource of previous frame, for motion vectors. Pass @p transform
+		/// if previous frame has no world transforms
 		/// @param indirect_resource Indirect drawcall resource
 		/// @param deferred_attachment Deferred attachments
 		/// @param hdr_attachment HDR attachments
-		/// @param extent Rendering extent
+		/// @param shading_rate Shading rate image of the frame, ignored without the `fragment_shading_rate`
+		/// device feature
+		/// @param second_camera_param Camera parameter buffer of view 1 with a multiview pipeline, defaults
+		/// to @p camera_param
 		///
-		/// @warning Deferred and HDR attachments must have identical extents, or a fatal/unrecoverable error
-		/// will occur
+		/// @warning Deferred and HDR attachments must have identical extents, and the vertex format of the
+		/// model must match the pipeline, or a fatal/unrecoverable error will occur
 		///
 		void update(
 			const vulkan::Context& context,
 			const Model& model,
-			const HostDrawcallResource& host_drawcall,
+			const TransformResource& transform,
+			const TransformResource& prev_transform,
 			const IndirectResource& indirect_resource,
 			DeferredAttachment::View deferred_attachment,
 			HdrAttachment::View hdr_attachment,
 			vulkan::ElementBufferRef<Camera> camera_param,
-			vulkan::ElementBufferRef<DirectLight> primary_light_param
+			vulkan::ElementBufferRef<DirectLight> primary_light_param,
+			vulkan::ArrayBufferRef<uint32_t> material_feedback,
+			std::optional<ShadingRateAttachment::View> shading_rate = std::nullopt,
+			std::optional<vulkan::ElementBufferRef<Camera>> second_camera_param = std::nullopt
 		) noexcept;
 
 	  private:
@@ -166,28 +319,29 @@ namespace render
 		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
 		PerRenderState<vk::raii::DescriptorSet> data_descriptor_set;
 
-		struct Attachment
-		{
-			glm::u32vec2 extent;
-			vulkan::AttachmentView albedo, normal, pbr, depth, hdr;
-		};
-
 		// External resources
 		struct Resource
 		{
 			vk::DescriptorSet material_descriptor_set;
 
-			vulkan::ArrayBufferRef<model::FullVertex> vertex_buffer;
-			vulkan::ArrayBufferRef<uint32_t> index_buffer;
+			vk::Buffer vertex_buffer;
+			VertexFormat vertex_format;
+			vk::Buffer index_buffer;
+			IndexFormat index_format;
 			PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>> indirect_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>> command_buffers;
+			PerRenderState<vulkan::ElementBufferRef<IndirectCount>> count_buffers;
 
-			Attachment attachment;
+			gbuffer::Attachment attachment;
+			std::optional<ShadingRateAttachment::View> shading_rate;
 		};
 
 		std::optional<Resource> resource = std::nullopt;
 
 		const Resource* operator->() const noexcept { return resource.operator->(); }
 
+		vulkan::DescriptorWriteCache descriptor_cache;
+
 		explicit ResourceSet(
 			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
 			PerRenderState<vk::raii::DescriptorSet> data_descriptor_set
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/model/deform-list.hpp"
+#include "render/model/mesh.hpp"
+#include "render/resource/deform.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Deform pipeline, skins and morphs the vertices of deformable meshes on GPU
+	/// @details
+	/// - Rewrites the vertices of each primitive in `DeformList` in place in the vertex buffer of the mesh
+	/// list, from the bind-pose vertices, one dispatch per primitive
+	/// - Leaves the vertex buffer ready to be read by rasterization, shaders and acceleration structure
+	/// builds. Refit the affected BLASes with `BlasList::refit` afterwards, then update the TLAS
+	///
+	class DeformPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a deform pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created deform pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<DeformPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Deform the vertices
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			uint32_t vertex_offset;
+			uint32_t vertex_count;
+			uint32_t bind_offset;
+			uint32_t skin_offset;
+			uint32_t morph_offset;
+			uint32_t target_count;
+			uint32_t joint_offset;
+			uint32_t weight_offset;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+
+		// Stages reading the vertex buffer, depending on the enabled features
+		vk::PipelineStageFlags2 vertex_reader_stages;
+
+		explicit DeformPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline,
+			vk::PipelineStageFlags2 vertex_reader_stages
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline)),
+			vertex_reader_stages(vertex_reader_stages)
+		{}
+
+	  public:
+
+		DeformPipeline(const DeformPipeline&) = delete;
+		DeformPipeline(DeformPipeline&&) = default;
+		DeformPipeline& operator=(const DeformPipeline&) = delete;
+		DeformPipeline& operator=(DeformPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for deform pipeline
+	///
+	class DeformPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param mesh_list Mesh list of the model, whose vertices are deformed
+		/// @param deform_list Deform list of the model
+		/// @param deform Deform resource of the frame
+		///
+		void update(
+			const vulkan::Context& context,
+			const MeshList& mesh_list,
+			const DeformList& deform_list,
+			const DeformResource& deform
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		vk::raii::DescriptorSet descriptor_set;
+
+		// External resources
+		struct Resource
+		{
+			vk::Buffer vertex_buffer;
+			DeformList::Ref deform_list;
+			DeformResource::Ref deform;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			vk::raii::DescriptorSet descriptor_set
+		) noexcept :
+			descriptor_pool(std::move(descriptor_pool)),
+			descriptor_set(std::move(descriptor_set))
+		{}
+
+		friend class DeformPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/resource/denoise.hpp"
+#include "render/resource/deferred.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Spatiotemporal denoise pipeline for low sample count ray traced signals, shared by the ray
+	/// traced passes
+	/// @details Follows SVGF (Schied et al., "Spatiotemporal Variance-Guided Filtering"):
+	/// 1. The noisy signal is accumulated with the history of the previous frame, reprojected with the
+	/// velocity of the deferred attachment. Luminance moments are accumulated alongside to estimate the
+	/// variance per texel.
+	/// 2. `DenoiseAttachment::WAVELET_ITERATIONS` iterations of an à-trous wavelet filter with growing step
+	/// sizes, edge-stopped by normal, view distance, and luminance relative to the filtered variance. The
+	/// output of the first iteration becomes the color history of the next frame.
+	///
+	/// - Expects the deferred attachments to be in `eShaderReadOnlyOptimal` layout, and the noisy signal
+	/// in `eGeneral` layout, holding RGB in the same extent as the denoise attachment
+	/// - History texels seen at another view distance are rejected as disoccluded. Instead of a spatial
+	/// variance estimate, the variance of short histories is inflated.
+	/// - Leaves all images of the denoise attachment in `eGeneral` layout, the denoised signal (see
+	/// `DenoiseAttachment::View::output`) ready to be sampled by fragment and compute shaders
+	///
+	class DenoisePipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Options of denoising, defaults follow the paper
+		///
+		struct Option
+		{
+			float color_alpha = 0.2f;    // Min weight of the current frame in the color accumulation
+			float moments_alpha = 0.2f;  // Min weight of the current frame in the moments accumulation
+			float phi_color = 4.0f;      // Luminance edge-stopping, in standard deviations
+			float phi_normal = 128.0f;   // Normal edge-stopping, exponent of the cosine
+			float phi_distance = 0.05f;  // View distance edge-stopping, relative difference per texel step
+		};
+
+		///
+		/// @brief Create a denoise pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<DenoisePipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Denoise the signal
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of denoising
+		/// @param history_valid Whether the history holds the output of the previous frame, `false` after
+		/// creation or resizing
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			bool history_valid
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 size;
+			glm::u32vec2 full_size;
+			uint32_t downscale;
+			uint32_t history_valid;
+			float color_alpha;
+			float moments_alpha;
+			float phi_color;
+			float phi_normal;
+			float phi_distance;
+			uint32_t step;
+			uint32_t write_history;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline temporal_pipeline;
+		vk::raii::Pipeline wavelet_pipeline;
+
+		explicit DenoisePipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline temporal_pipeline,
+			vk::raii::Pipeline wavelet_pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			temporal_pipeline(std::move(temporal_pipeline)),
+			wavelet_pipeline(std::move(wavelet_pipeline))
+		{}
+
+	  public:
+
+		DenoisePipeline(const DenoisePipeline&) = delete;
+		DenoisePipeline(DenoisePipeline&&) = default;
+		DenoisePipeline& operator=(const DenoisePipeline&) = delete;
+		DenoisePipeline& operator=(DenoisePipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for denoise pipeline
+	///
+	class DenoisePipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param deferred Deferred attachment to read depth, normal and velocity from
+		/// @param signal Noisy signal to denoise, in the extent of @p output
+		/// @param history Denoise attachment of the previous frame
+		/// @param output Denoise attachment to write into, must have the same downscale as @p history
+		/// @param camera Camera buffer
+		///
+		void update(
+			const vulkan::Context& context,
+			DeferredAttachment::View deferred,
+			vulkan::AttachmentView signal,
+			DenoiseAttachment::View history,
+			DenoiseAttachment::View output,
+			vulkan::ElementBufferRef<Camera> camera
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+
+		// Indexed by the filtered image written, the temporal pass writes `filtered[0]`, and wavelet
+		// iteration `i` reads `filtered[i % 2]` and writes the other
+		std::vector<vk::raii::DescriptorSet> sets;
+
+		struct Resource
+		{
+			glm::u32vec2 full_size;
+			DenoiseAttachment::View output;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> pool,
+			std::vector<vk::raii::DescriptorSet> sets
+		) :
+			pool(std::move(pool)),
+			sets(std::move(sets))
+		{}
+
+		friend class DenoisePipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
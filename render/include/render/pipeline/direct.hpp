@@ -3,13 +3,24 @@
 #include "common/util/error.hpp"
 #include "render/interface/camera.hpp"
 #include "render/interface/direct-light.hpp"
+#include "render/model/light-list.hpp"
+#include "render/pipeline/atmosphere.hpp"
+#include "render/resource/ambient-occlusion.hpp"
 #include "render/resource/deferred.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
 #include "render/resource/hdr.hpp"
+#include "render/resource/light-cluster.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "render/resource/shadow.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
 
 #include <cstdint>
 #include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -23,7 +34,29 @@ namespace render
 	/// @brief Direct-light pipeline
 	/// @details
 	/// - Takes the deferred attachments and calculate lighting
-	/// - Lighting result is added to the HDR attachment
+	/// - Direct light is attenuated by the shadow mask, which is expected to be in `eGeneral` layout (see
+	/// `ShadowPipeline`)
+	/// - Punctual lights are gathered from the light cluster grid, which is expected to be filled by
+	/// `LightClusterPipeline`. They are not shadowed.
+	/// - Ambient term is optionally attenuated by the ambient occlusion, upsampled bilaterally with the view
+	/// distance. It is expected to be in `eGeneral` layout (see `AmbientOcclusionPipeline`)
+	/// - Diffuse ambient term is optionally replaced by the irradiance of the probe volume, expected to be in
+	/// `eGeneral` layout (see `GiProbePipeline`)
+	/// - Without the probe volume, the ambient term is optionally taken from the precomputed environment
+	/// lighting instead, diffuse from its SH irradiance and specular by the split sum (see
+	/// `EnvironmentLighting`)
+	/// - Sky pixels and the sun are optionally lit by the precomputed atmosphere, the sky radiance is
+	/// sampled from the sky-view LUT and the sun is attenuated by the transmittance LUT (see
+	/// `AtmospherePipeline`). Without it, sky pixels are left as the G-buffer pass wrote them.
+	/// - Lighting result is added to the HDR attachment, either by a fullscreen draw (`render`) or by a
+	/// compute dispatch (`compute`). Both paths share the same resource sets and produce the same result.
+	/// - Both paths optionally shade at the coarse rates of the shading rate image (see
+	/// `ShadingRatePipeline`), the fragment path by the fragment shading rate attachment, the compute path
+	/// by sharing the result of the top-left pixel of each coarse block with similar neighbors
+	/// - The BRDF is optionally evaluated in half precision, which runs at double rate on GPUs with packed
+	/// fp16 math (see `Precision`)
+	/// - Both paths optionally light only the pixels of one checkerboard parity, leaving the others as the
+	/// G-buffer pass wrote them for `TaaPipeline` to reconstruct. Coarse shading is disabled meanwhile.
 	///
 	class DirectLightingPipeline
 	{
@@ -31,14 +64,30 @@ namespace render
 
 		class ResourceSet;
 
+		///
+		/// @brief Arithmetic precision of the BRDF
+		///
+		enum class Precision
+		{
+			Full,  // Everything in fp32
+			Half,  // Fresnel and diffuse terms in fp16, vectors and specular distribution in fp32
+		};
+
 		///
 		/// @brief Create a direct lighting pipeline
+		/// @note `Precision::Half` relies on `shaderFloat16`, which is a required device feature
 		///
 		/// @param context Vulkan context
+		/// @param precision Arithmetic precision of the BRDF, for both the fragment and compute path
+		/// @param hdr_format Format of the HDR attachments lit, see `HdrAttachment::format`
 		/// @return Created pipeline or error
 		///
 		[[nodiscard]]
-		static std::expected<DirectLightingPipeline, Error> create(const vulkan::Context& context) noexcept;
+		static std::expected<DirectLightingPipeline, Error> create(
+			const vulkan::Context& context,
+			Precision precision = Precision::Half,
+			vk::Format hdr_format = HdrAttachment::HDR_FORMAT
+		) noexcept;
 
 		///
 		/// @brief Create a given number of resource sets
@@ -60,29 +109,130 @@ namespace render
 		///
 		/// @param command_buffer Command buffer
 		/// @param resource_set Resource set
+		/// @param ambient_occlusion Whether to attenuate the ambient term by the ambient occlusion, which
+		/// must have been computed in the frame
+		/// @param global_illumination Whether to take the diffuse ambient term from the probe volume instead
+		/// of the constant ambient
+		/// @param environment Whether to light the ambient term by the environment lighting, where the probe
+		/// volume doesn't replace it
+		/// @param atmosphere Whether to shade the sky and attenuate the sun by the atmosphere
+		/// @param checkerboard Parity of `x + y` of the pixels to light, lights all pixels if empty. The
+		/// fragment shading rate attachment must hold full rates when set.
 		///
 		void render(
 			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			bool ambient_occlusion = false,
+			bool global_illumination = false,
+			bool environment = false,
+			bool atmosphere = false,
+			std::optional<uint32_t> checkerboard = std::nullopt
+		) const noexcept;
+
+		///
+		/// @brief Get the fragment shading rate attachment to chain into the rendering session of `render`
+		///
+		/// @param resource_set Resource set
+		/// @return Attachment info of the shading rate image of @p resource_set, or `std::nullopt` if the
+		/// pipeline was created without the `fragment_shading_rate` device feature
+		///
+		[[nodiscard]]
+		std::optional<vk::RenderingFragmentShadingRateAttachmentInfoKHR> get_shading_rate_attachment_info(
 			const ResourceSet& resource_set
 		) const noexcept;
 
+		///
+		/// @brief Perform lighting with a compute dispatch, outside of any dynamic rendering session
+		/// @details Pixels are shaded in 16x16 tiles, tiles with only sky pixels exit right after reading the
+		/// albedo
+		/// @note The HDR attachment is expected to be in `eColorAttachmentOptimal` layout, as left by the
+		/// G-buffer pass, and is transitioned to `eShaderReadOnlyOptimal`
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param ambient_occlusion Whether to attenuate the ambient term by the ambient occlusion, see
+		/// `render`
+		/// @param global_illumination Whether to take the diffuse ambient term from the probe volume, see
+		/// `render`
+		/// @param variable_rate Whether to shade at the rates of the shading rate image, which must have been
+		/// written in the frame. Works without the `fragment_shading_rate` device feature.
+		/// @param environment Whether to light the ambient term by the environment lighting, see `render`
+		/// @param atmosphere Whether to shade the sky and attenuate the sun by the atmosphere, see `render`
+		/// @param checkerboard Parity of `x + y` of the pixels to light, see `render`. Overrides
+		/// @p variable_rate when set.
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			bool ambient_occlusion = false,
+			bool global_illumination = false,
+			bool variable_rate = false,
+			bool environment = false,
+			bool atmosphere = false,
+			std::optional<uint32_t> checkerboard = std::nullopt
+		) const noexcept;
+
 	  private:
 
 		vk::raii::DescriptorSetLayout descriptor_set_layout;
 		vk::raii::PipelineLayout pipeline_layout;
 		vk::raii::Pipeline pipeline;
+		vk::raii::Pipeline compute_pipeline;
 		vk::raii::Sampler sampler;
+		vk::raii::Sampler linear_sampler;
+		vk::raii::Sampler environment_sampler;
+		bool hardware_variable_rate;  // Fragment path accepts a fragment shading rate attachment
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 half_precision;
+		};
+
+		struct PushConstant
+		{
+			glm::u32vec2 full_size;                // Extent in use of the deferred and HDR attachments
+			glm::u32vec2 mask_size;                // Extent in use of the shadow mask
+			glm::u32vec2 ao_size;                  // Extent in use of the ambient occlusion
+			uint32_t ao_downscale;                 // Downscale of the ambient occlusion, 0 if disabled
+			uint32_t gi_enabled;                   // 1 to sample the probe volume, 0 for constant ambient
+			GiProbeVolume::GridConstant gi_grid;  // Placement of the probes
+			glm::u32vec2 shading_rate_tile;        // Tile size of the shading rate image, 0 for full rate
+			uint32_t environment_enabled;          // 1 to sample the environment lighting, 0 for constant
+			uint32_t atmosphere_enabled;           // 1 to shade the sky and the sun by the atmosphere
+			uint32_t checkerboard;                 // 1 + parity of the lit pixels, 0 to light all pixels
+		};
+
+		[[nodiscard]]
+		static PushConstant get_push_constant(
+			const ResourceSet& resource_set,
+			bool ambient_occlusion,
+			bool global_illumination,
+			bool variable_rate,
+			bool environment,
+			bool atmosphere,
+			std::optional<uint32_t> checkerboard
+		) noexcept;
+
+		static constexpr uint32_t COMPUTE_TILE_SIZE = 16;  // Must match `GROUP_TILE_SIZE` in `direct.slang`
 
 		explicit DirectLightingPipeline(
 			vk::raii::DescriptorSetLayout descriptor_set_layout,
 			vk::raii::PipelineLayout pipeline_layout,
 			vk::raii::Pipeline pipeline,
-			vk::raii::Sampler sampler
+			vk::raii::Pipeline compute_pipeline,
+			vk::raii::Sampler sampler,
+			vk::raii::Sampler linear_sampler,
+			vk::raii::Sampler environment_sampler,
+			bool hardware_variable_rate
 		) :
 			descriptor_set_layout(std::move(descriptor_set_layout)),
 			pipeline_layout(std::move(pipeline_layout)),
 			pipeline(std::move(pipeline)),
-			sampler(std::move(sampler))
+			compute_pipeline(std::move(compute_pipeline)),
+			sampler(std::move(sampler)),
+			linear_sampler(std::move(linear_sampler)),
+			environment_sampler(std::move(environment_sampler)),
+			hardware_variable_rate(hardware_variable_rate)
 		{}
 
 	  public:
@@ -101,8 +251,17 @@ namespace render
 			const vulkan::Context& context,
 			DeferredAttachment::View deferred,
 			HdrAttachment::View hdr,
+			ShadowMaskAttachment::View shadow_mask,
+			AmbientOcclusionAttachment::View ambient_occlusion,
 			vulkan::ElementBufferRef<Camera> camera,
-			vulkan::ElementBufferRef<DirectLight> direct_light
+			vulkan::ElementBufferRef<DirectLight> direct_light,
+			const LightList& light_list,
+			vulkan::ArrayBufferRef<glm::mat4> world_transforms,
+			LightClusterAttachment::View light_cluster,
+			GiProbeVolume::View gi_probe,
+			ShadingRateAttachment::View shading_rate,
+			EnvironmentLighting::View environment,
+			AtmospherePipeline::LutView atmosphere
 		) noexcept;
 
 	  private:
@@ -111,24 +270,36 @@ namespace render
 		vk::raii::DescriptorSet set;
 
 		vk::Sampler sampler;
+		vk::Sampler linear_sampler;
+		vk::Sampler environment_sampler;
 
 		struct Resource
 		{
 			HdrAttachment::View hdr;
+			glm::u32vec2 mask_size;
+			AmbientOcclusionAttachment::View ambient_occlusion;
+			GiProbeVolume::Grid gi_grid;
+			ShadingRateAttachment::View shading_rate;
 		};
 
 		std::optional<Resource> resource = std::nullopt;
 
 		const Resource* operator->() const noexcept { return resource.operator->(); }
 
+		vulkan::DescriptorWriteCache descriptor_cache;
+
 		explicit ResourceSet(
 			std::shared_ptr<vk::raii::DescriptorPool> pool,
 			vk::raii::DescriptorSet set,
-			vk::Sampler sampler
+			vk::Sampler sampler,
+			vk::Sampler linear_sampler,
+			vk::Sampler environment_sampler
 		) :
 			pool(std::move(pool)),
 			set(std::move(set)),
-			sampler(sampler)
+			sampler(sampler),
+			linear_sampler(linear_sampler),
+			environment_sampler(environment_sampler)
 		{}
 
 		friend class DirectLightingPipeline;
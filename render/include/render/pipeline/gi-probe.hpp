@@ -0,0 +1,277 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Probe update pipeline of the dynamic diffuse global illumination
+	/// @details Traces rays from a subset of the probes of a `GiProbeVolume` each frame against the TLAS,
+	/// and blends them into the irradiance and distance atlases. The direct lighting samples the atlases in
+	/// place of the constant ambient term, see `DirectLightingPipeline::render`.
+	///
+	/// - The work per frame is a fixed ray budget, independent of the resolution. The probes updated in a
+	/// frame are a contiguous range of the grid, advancing every frame and wrapping around, so that each
+	/// probe is updated once every `probe_count / get_update_count` frames.
+	/// - Hits are shaded with the emission, the shadowed primary light and the previous state of the probes,
+	/// which accumulates further bounces over frames. Punctual lights and normal maps are ignored.
+	/// - Rays escaping the scene gather the same uniform radiance as the ambient term they replace
+	/// - Expects the atlases in `eGeneral` layout, and leaves them in the same layout ready to be sampled by
+	/// fragment and compute shaders
+	/// @note Requires the `raytracing` device feature. See `vulkan::DeviceFeature`.
+	///
+	class GiProbePipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		// Upper limit of `Option::rays_per_probe`
+		static constexpr uint32_t MAX_RAYS_PER_PROBE = 256;
+
+		///
+		/// @brief Options of the probe update
+		///
+		struct Option
+		{
+			// Rays traced per frame in total, probes updated per frame are derived from it, see
+			// `get_update_count`
+			uint32_t ray_budget = 131072;
+
+			// Rays traced from each updated probe, at most `MAX_RAYS_PER_PROBE`
+			uint32_t rays_per_probe = 128;
+
+			// Weight of the history when blending a probe update, higher is more stable but lags behind
+			// lighting changes
+			float hysteresis = 0.9f;
+
+			bool operator==(const Option&) const noexcept = default;
+		};
+
+		///
+		/// @brief Get the count of probes updated in a frame to fit the ray budget
+		///
+		/// @param option Options of the probe update
+		/// @param volume Probe volume
+		/// @return Budget divided by rays per probe, clamped to at least one probe, at most all probes and
+		/// the ray capacity of the volume
+		///
+		[[nodiscard]]
+		static uint32_t get_update_count(const Option& option, const GiProbeVolume::View& volume) noexcept;
+
+		///
+		/// @brief Get the options of a frame of a static bake
+		/// @details A bake converges the probes of a static scene once, then stops updating them, leaving
+		/// the sampling of the atlases by the lighting as the only cost. Each frame of the bake spends the
+		/// whole ray capacity of the volume, and the hysteresis follows a running mean so that the atlases
+		/// converge to the average of all passes instead of an exponential history. Later passes shade their
+		/// hits with the earlier ones, adding a bounce per pass.
+		///
+		/// @param option Options of the probe update, `ray_budget` and `hysteresis` are overridden
+		/// @param volume Probe volume
+		/// @param pass_count Updates of each probe in the bake
+		/// @param bake_frame Frames of the bake recorded before this one, also the frame index to pass to
+		/// `compute`
+		/// @return Options of the frame, or `std::nullopt` once the bake is complete
+		///
+		[[nodiscard]]
+		static std::optional<Option> get_bake_option(
+			const Option& option,
+			const GiProbeVolume::View& volume,
+			uint32_t pass_count,
+			uint32_t bake_frame
+		) noexcept;
+
+		///
+		/// @brief Get the frames of regular updates after which each probe has been updated a number of times
+		///
+		/// @param option Options of the probe update
+		/// @param volume Probe volume
+		/// @param pass_count Updates of each probe
+		/// @return Count of frames, rounded up
+		///
+		[[nodiscard]]
+		static uint32_t get_frame_count(
+			const Option& option,
+			const GiProbeVolume::View& volume,
+			uint32_t pass_count
+		) noexcept;
+
+		///
+		/// @brief Create a probe update pipeline
+		///
+		/// @param context Vulkan context, must have the `raytracing` feature enabled
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to trace, see `MeshList::create`
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<GiProbePipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full
+		) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Trace and update the probes of a frame
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of the probe update
+		/// @param frame_index Index of the frame, selects the updated probes and rotates the ray directions
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			uint32_t frame_index
+		) const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 packed_vertex;
+		};
+
+		struct PushConstant
+		{
+			GiProbeVolume::GridConstant grid;
+			uint32_t first_probe;
+			uint32_t update_count;
+			uint32_t rays_per_probe;
+			uint32_t frame_index;
+			float hysteresis;
+		};
+
+		static constexpr uint32_t TRACE_WORKGROUP_SIZE = 64;  // Must match `main_trace` in `gi-probe.slang`
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline trace_pipeline;
+		vk::raii::Pipeline update_pipeline;
+		vk::raii::Sampler sampler;
+		VertexFormat vertex_format;
+
+		explicit GiProbePipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline trace_pipeline,
+			vk::raii::Pipeline update_pipeline,
+			vk::raii::Sampler sampler,
+			VertexFormat vertex_format
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			trace_pipeline(std::move(trace_pipeline)),
+			update_pipeline(std::move(update_pipeline)),
+			sampler(std::move(sampler)),
+			vertex_format(vertex_format)
+		{}
+
+	  public:
+
+		GiProbePipeline(const GiProbePipeline&) = delete;
+		GiProbePipeline(GiProbePipeline&&) = default;
+		GiProbePipeline& operator=(const GiProbePipeline&) = delete;
+		GiProbePipeline& operator=(GiProbePipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for probe update pipeline
+	///
+	class GiProbePipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance, providing geometries and materials
+		/// @param tlas TLAS of the scene
+		/// @param volume Probe volume to update
+		/// @param direct_light Primary light buffer
+		///
+		/// @warning The vertex format of the model must match the pipeline, and @p tlas must be built from
+		/// the same model, or a fatal/unrecoverable error will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const Tlas& tlas,
+			GiProbeVolume::View volume,
+			vulkan::ElementBufferRef<DirectLight> direct_light
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		vk::Sampler sampler;
+
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+			VertexFormat vertex_format;
+			GiProbeVolume::View volume;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> pool,
+			vk::raii::DescriptorSet set,
+			vk::Sampler sampler
+		) :
+			pool(std::move(pool)),
+			set(std::move(set)),
+			sampler(sampler)
+		{}
+
+		friend class GiProbePipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
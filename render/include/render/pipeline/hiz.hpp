@@ -0,0 +1,155 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/resource/hiz.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief HiZ pipeline, builds the depth pyramid from the deferred depth attachment
+	/// @details
+	/// - Expects the depth attachment to be in `eShaderReadOnlyOptimal` layout, which is the layout the
+	/// deferred pipeline leaves it in
+	/// - Leaves the HiZ attachment in `eGeneral` layout, ready to be read by compute shaders
+	///
+	class HizPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a HiZ pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created HiZ pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<HizPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Build the depth pyramid
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+		///
+		/// @brief Discard the content of a HiZ attachment and transition it to `eGeneral` layout. Used when
+		/// the attachment is freshly created and has never been built.
+		///
+		/// @param command_buffer Command buffer
+		/// @param hiz HiZ attachment
+		///
+		static void discard(const vk::raii::CommandBuffer& command_buffer, HizAttachment::View hiz) noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 src_size;
+			glm::u32vec2 dst_size;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+
+		explicit HizPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline))
+		{}
+
+	  public:
+
+		HizPipeline(const HizPipeline&) = delete;
+		HizPipeline(HizPipeline&&) = default;
+		HizPipeline& operator=(const HizPipeline&) = delete;
+		HizPipeline& operator=(HizPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for HiZ pipeline. Holds one descriptor set per pyramid level
+	///
+	class HizPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param depth Depth attachment to build from
+		/// @param hiz HiZ attachment to build into, must have identical extent with the depth attachment
+		///
+		void update(
+			const vulkan::Context& context,
+			vulkan::AttachmentView depth,
+			HizAttachment::View hiz
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		std::vector<vk::raii::DescriptorSet> descriptor_sets;  // One for each level
+
+		std::optional<HizAttachment::View> hiz = std::nullopt;
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			std::vector<vk::raii::DescriptorSet> descriptor_sets
+		) noexcept :
+			descriptor_pool(std::move(descriptor_pool)),
+			descriptor_sets(std::move(descriptor_sets))
+		{}
+
+		friend class HizPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
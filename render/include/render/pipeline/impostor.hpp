@@ -0,0 +1,171 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/model.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Impostor pipeline, draws the nodes replaced by their octahedral impostors into the G-buffer
+	/// @details
+	/// - Draws one quad per `ImpostorInstance` appended by the early phase of `IndirectPipeline` (see
+	/// `impostor_threshold`), with a single non-indexed indirect command
+	/// - Each quad faces the atlas frame nearest to the camera, and writes the albedo and the normal of the
+	/// frame into the G-buffer. Coverage is alpha-tested, depth is the depth of the quad
+	/// - Renders on top of the early phase results, before the HiZ is built, so impostors also occlude in
+	/// the late phase
+	///
+	/// @note Single view only, additional views draw the meshes themselves, see `IndirectPipeline`
+	///
+	class ImpostorPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create an impostor pipeline
+		///
+		/// @param context Vulkan context
+		/// @param hdr_format Format of the HDR attachments rendered to, see `HdrAttachment::format`
+		/// @return Created pipeline or error
+		///
+		[[nodiscard]]
+		static std::expected<ImpostorPipeline, Error> create(
+			const vulkan::Context& context,
+			vk::Format hdr_format = HdrAttachment::HDR_FORMAT
+		) noexcept;
+
+		///
+		/// @brief Create a given number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Draw the impostor instances on top of the early phase results
+		///
+		/// @param command_buffer Command buffer, outside of any rendering scope
+		/// @param resource_set Resource set
+		///
+		void render(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+
+		explicit ImpostorPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline))
+		{}
+
+	  public:
+
+		ImpostorPipeline(const ImpostorPipeline&) = delete;
+		ImpostorPipeline(ImpostorPipeline&&) = default;
+		ImpostorPipeline& operator=(const ImpostorPipeline&) = delete;
+		ImpostorPipeline& operator=(ImpostorPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for impostor pipeline
+	///
+	class ImpostorPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance, providing the impostor atlases
+		/// @param transform Transform resource, providing world transforms of the nodes
+		/// @param prev_transform Transform resource of previous frame, for motion vectors. Pass @p transform
+		/// if previous frame has no world transforms
+		/// @param indirect_resource Indirect drawcall resource of the main bucket, holding the instances
+		/// @param deferred_attachment Deferred attachments
+		/// @param hdr_attachment HDR attachments
+		/// @param camera_param Camera parameter buffer
+		///
+		/// @warning Deferred and HDR attachments must have identical extents
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const TransformResource& transform,
+			const TransformResource& prev_transform,
+			const IndirectResource& indirect_resource,
+			DeferredAttachment::View deferred_attachment,
+			HdrAttachment::View hdr_attachment,
+			vulkan::ElementBufferRef<Camera> camera_param
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		vk::raii::DescriptorSet descriptor_set;
+
+		// External resources
+		struct Resource
+		{
+			vulkan::ArrayBufferRef<vk::DrawIndirectCommand> command_buffer;
+			gbuffer::Attachment attachment;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			vk::raii::DescriptorSet descriptor_set
+		) :
+			descriptor_pool(std::move(descriptor_pool)),
+			descriptor_set(std::move(descriptor_set))
+		{}
+
+		friend class ImpostorPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
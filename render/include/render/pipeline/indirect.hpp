@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -10,13 +11,16 @@
 
 #include "common/util/error.hpp"
 #include "render/interface/camera.hpp"
+#include "render/interface/impostor.hpp"
 #include "render/interface/indirect-drawcall.hpp"
 #include "render/model/model.hpp"
-#include "render/resource/host.hpp"
+#include "render/resource/hiz.hpp"
 #include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
 #include "render/util/per-render-state.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
 
 namespace render
 {
@@ -24,7 +28,24 @@ namespace render
 	/// @brief Indirect pipeline, computes the indirect drawcalls
 	/// @details
 	/// - Takes the drawcall data and outputs the indirect drawcall buffers
-	/// - Supports 4 material variants, where BLEND is currently rendered as MASK
+	/// - Culled drawcalls are dropped, visible drawcalls are compacted into the indirect buffers and counted
+	/// in the draw count buffers
+	/// - Runs in two phases for HiZ occlusion culling:
+	///   1. @p DrawPhase::Early tests against the previous frame's HiZ, occluded drawcalls are deferred as
+	///   late candidates
+	///   2. @p DrawPhase::Late re-tests the candidates against the current frame's HiZ, which is built from
+	///   the early phase depth
+	/// - Supports 4 material variants. BLEND drawcalls are in their own bucket of the scene graph, culled
+	/// with a separate resource set and `IndirectResource`, see `SceneGraph::Bucket`
+	/// - Transforms each drawcall's bounds into world space once in the early phase, then tests the bounding
+	/// sphere before the AABB with the world-to-clip matrix of every view, see `DrawcallBounds`
+	/// - Selects a level of detail per drawcall from the projected size of the world-space AABB
+	/// - Groups the visible drawcalls by primitive and level of detail, each group is placed consecutively
+	/// and drawn with one instanced command, so the command count scales with the unique meshes in view
+	/// - Culls the additional views of `IndirectResource` (e.g. shadow cascades) in the early phase dispatch,
+	/// loading each drawcall once for all views, see `IndirectResource::upload_views()`
+	/// - Optionally orders the commands of the main camera front to back by coarse depth buckets, so opaque
+	/// draws reject more fragments with early depth testing
 	///
 	class IndirectPipeline
 	{
@@ -56,32 +77,94 @@ namespace render
 
 		///
 		/// @brief Execute the compute pass to generate indirect drawcalls
+		/// @details The early phase also generates the drawcalls of the additional views
 		///
 		/// @param command_buffer Command buffer
 		/// @param resource_set Resource set to bind for the compute
+		/// @param phase Draw phase to generate
+		/// @param occlusion_enabled Whether to test against the previous HiZ in early phase, set to `false`
+		/// when the previous HiZ holds no valid content
+		/// @param lod_threshold Maximum projected error of the selected level of detail in NDC units, see
+		/// `lod_threshold_from_pixels()`. Non-positive value always selects the full geometry
+		/// @param sort_enabled Whether to order the commands of the main camera front to back. Commands of
+		/// the additional views keep their order
+		/// @param hlod_threshold Projected size of an HLOD cluster in NDC units below which its proxy is
+		/// drawn in place of its nodes, chosen on the main camera for every view. Non-positive value never
+		/// draws proxies, see `SceneGraph`
+		/// @param impostor_threshold Projected size of a mesh in NDC units below which the main camera draws
+		/// its impostor in place of its primitives, see `ImpostorPipeline`. Non-positive value never draws
+		/// impostors
 		///
 		void compute(
 			const vk::raii::CommandBuffer& command_buffer,
-			const ResourceSet& resource_set
+			const ResourceSet& resource_set,
+			DrawPhase phase,
+			bool occlusion_enabled,
+			float lod_threshold,
+			bool sort_enabled = false,
+			float hlod_threshold = 0.0f,
+			float impostor_threshold = 0.0f
 		) const noexcept;
 
+		///
+		/// @brief Convert a level of detail error threshold from pixels into NDC units
+		///
+		/// @param pixel_error Maximum projected error in pixels
+		/// @param viewport_height Height of the viewport in pixels
+		/// @return Threshold for `compute`
+		///
+		[[nodiscard]]
+		static constexpr float lod_threshold_from_pixels(float pixel_error, uint32_t viewport_height) noexcept
+		{
+			return 2.0f * pixel_error / static_cast<float>(viewport_height);
+		}
+
 	  private:
 
-		using PushConstant = uint32_t;
+		struct PushConstant
+		{
+			uint32_t drawcall_count;
+			uint32_t phase;
+			uint32_t occlusion_enabled;
+			float lod_threshold;
+			glm::u32vec2 prev_hiz_size;
+			glm::u32vec2 curr_hiz_size;
+			uint32_t group_count;
+			uint32_t view_count;
+			uint32_t sort_enabled;
+			float hlod_threshold;
+			float impostor_threshold;
+		};
+
 		static constexpr uint32_t WORKGROUP_SIZE = 64;
 
 		vk::raii::DescriptorSetLayout descriptor_set_layout;
 		vk::raii::PipelineLayout pipeline_layout;
-		vk::raii::Pipeline pipeline;
+
+		// Culls and counts instances, sorts groups by depth, allocates instance ranges and commands, scatters
+		// the drawcalls
+		vk::raii::Pipeline cull_pipeline;
+		vk::raii::Pipeline sort_count_pipeline;
+		vk::raii::Pipeline sort_prefix_pipeline;
+		vk::raii::Pipeline allocate_pipeline;
+		vk::raii::Pipeline scatter_pipeline;
 
 		explicit IndirectPipeline(
 			vk::raii::DescriptorSetLayout descriptor_set_layout,
 			vk::raii::PipelineLayout pipeline_layout,
-			vk::raii::Pipeline pipeline
+			vk::raii::Pipeline cull_pipeline,
+			vk::raii::Pipeline sort_count_pipeline,
+			vk::raii::Pipeline sort_prefix_pipeline,
+			vk::raii::Pipeline allocate_pipeline,
+			vk::raii::Pipeline scatter_pipeline
 		) :
 			descriptor_set_layout(std::move(descriptor_set_layout)),
 			pipeline_layout(std::move(pipeline_layout)),
-			pipeline(std::move(pipeline))
+			cull_pipeline(std::move(cull_pipeline)),
+			sort_count_pipeline(std::move(sort_count_pipeline)),
+			sort_prefix_pipeline(std::move(sort_prefix_pipeline)),
+			allocate_pipeline(std::move(allocate_pipeline)),
+			scatter_pipeline(std::move(scatter_pipeline))
 		{}
 
 	  public:
@@ -105,15 +188,23 @@ namespace render
 		/// @param context Vulkan context
 		/// @param model Model instance
 		/// @param camera Camera buffer
-		/// @param drawcall_resource Host drawcall resource
+		/// @param transform_resource Transform resource, providing world transforms of the nodes
 		/// @param indirect_resource Indirect drawcall resource
+		/// @param geometry_feedback Projected size of each primitive, see `GeometryFeedbackResource`
+		/// @param prev_hiz HiZ of the previous frame, used in early phase
+		/// @param curr_hiz HiZ of the current frame, used in late phase
+		/// @param bucket Drawcall bucket of the scene graph to cull
 		///
 		void update(
 			const vulkan::Context& context,
 			const Model& model,
 			vulkan::ElementBufferRef<Camera> camera,
-			const HostDrawcallResource& drawcall_resource,
-			const IndirectResource& indirect_resource
+			const TransformResource& transform_resource,
+			const IndirectResource& indirect_resource,
+			vulkan::ArrayBufferRef<uint32_t> geometry_feedback,
+			HizAttachment::View prev_hiz,
+			HizAttachment::View curr_hiz,
+			SceneGraph::Bucket bucket = SceneGraph::Bucket::Main
 		) noexcept;
 
 	  private:
@@ -121,11 +212,32 @@ namespace render
 		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
 		PerRenderState<vk::raii::DescriptorSet> descriptor_sets;
 
-		std::optional<PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>>> indirect_buffers =
-			std::nullopt;
+		// External resources
+		struct Resource
+		{
+			PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>> indirect_buffers;
+			PerRenderState<vulkan::ElementBufferRef<IndirectCount>> count_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<uint32_t>> candidate_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>> command_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<uint32_t>> group_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>> view_indirect_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>> view_command_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<uint32_t>> view_group_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<uint32_t>> group_depth_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<uint32_t>> sort_bucket_buffers;
+			vulkan::ArrayBufferRef<ImpostorInstance> impostor_instance_buffer;
+			vulkan::ArrayBufferRef<vk::DrawIndirectCommand> impostor_command_buffer;
+			uint32_t view_count;
+			glm::u32vec2 prev_hiz_size;
+			glm::u32vec2 curr_hiz_size;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
 
 		friend class IndirectPipeline;
 
+		vulkan::DescriptorWriteCache descriptor_cache;
+
 		explicit ResourceSet(
 			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
 			PerRenderState<vk::raii::DescriptorSet> descriptor_sets
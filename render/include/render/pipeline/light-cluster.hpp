@@ -0,0 +1,166 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/light-list.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/light-cluster.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Light culling pipeline, assigns the punctual lights of a model to the clusters of the screen
+	/// @details
+	/// - One workgroup per tile, the depth slices are tightened to the depth range of the tile, so that
+	/// clusters covering no geometry receive no lights
+	/// - Lights are culled by their bounding spheres (see `LightList`), spot lights are not culled by cone
+	/// - Expects the depth attachment to be in `eShaderReadOnlyOptimal` layout, which is the layout the
+	/// deferred pipeline leaves it in
+	/// - Makes the cluster grid visible to fragment shaders when done
+	///
+	class LightClusterPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a light culling pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created pipeline or error
+		///
+		[[nodiscard]]
+		static std::expected<LightClusterPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Fill the light cluster grid
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param lights Whether to cull the punctual lights, `false` leaves every cluster empty, e.g. while
+		/// `RestirPipeline` shades them
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			bool lights = true
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 extent;
+			glm::u32vec2 tile_count;
+			uint32_t light_count;
+		};
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+
+		explicit LightClusterPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline))
+		{}
+
+	  public:
+
+		LightClusterPipeline(const LightClusterPipeline&) = delete;
+		LightClusterPipeline(LightClusterPipeline&&) = default;
+		LightClusterPipeline& operator=(const LightClusterPipeline&) = delete;
+		LightClusterPipeline& operator=(LightClusterPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for light culling pipeline
+	///
+	class LightClusterPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param light_list Punctual lights of the model
+		/// @param world_transforms World transform of each node, see `TransformResource`
+		/// @param deferred Deferred attachment to read depth from
+		/// @param light_cluster Light cluster grid to write into, created with the extent of @p deferred
+		/// @param camera Camera buffer
+		///
+		void update(
+			const vulkan::Context& context,
+			const LightList& light_list,
+			vulkan::ArrayBufferRef<glm::mat4> world_transforms,
+			DeferredAttachment::View deferred,
+			LightClusterAttachment::View light_cluster,
+			vulkan::ElementBufferRef<Camera> camera
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			glm::u32vec2 extent;
+			uint32_t light_count;
+			LightClusterAttachment::View light_cluster;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class LightClusterPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/primitive-drawcall.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/indirect.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Object pick pipeline, resolves the drawcall covering a pixel
+	/// @details
+	/// - Reads the object ID attachment of `DeferredAttachment` at a single pixel, and looks up the drawcall
+	/// it refers to in the indirect drawcalls of the frame
+	/// - Must run in the frame writing the object IDs, as culling rebuilds the indirect drawcalls every
+	/// frame. Only the resolved `PrimitiveDrawcall` is then read back, which takes a few bytes.
+	/// - Expects the object ID attachment to be in `eShaderReadOnlyOptimal` layout after the G-buffer pass
+	/// - Leaves the result synchronized for transfer reads, ready for `vulkan::ReadbackRing::read_buffer`
+	/// @note Pixels drawn by `ImpostorPipeline` are not pickable
+	///
+	class ObjectPickPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create an object pick pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<ObjectPickPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Resolve the drawcall covering a pixel
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param pixel Picked pixel, clamped to the extent of the deferred attachment
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			glm::u32vec2 pixel
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 pixel;
+		};
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+
+		explicit ObjectPickPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline))
+		{}
+
+	  public:
+
+		ObjectPickPipeline(const ObjectPickPipeline&) = delete;
+		ObjectPickPipeline(ObjectPickPipeline&&) = default;
+		ObjectPickPipeline& operator=(const ObjectPickPipeline&) = delete;
+		ObjectPickPipeline& operator=(ObjectPickPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for object pick pipeline
+	///
+	class ObjectPickPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param deferred Deferred attachment of current frame, holding the object IDs
+		/// @param indirect Indirect drawcalls the object IDs of current frame refer to
+		/// @param result Result buffer, see `ObjectPickResource`
+		///
+		void update(
+			const vulkan::Context& context,
+			DeferredAttachment::View deferred,
+			const IndirectResource& indirect,
+			vulkan::ElementBufferRef<PrimitiveDrawcall> result
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			glm::u32vec2 extent;
+			vulkan::ElementBufferRef<PrimitiveDrawcall> result;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class ObjectPickPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/resource/overlay.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Overlay pipeline, blends a cached overlay layer over the target image
+	/// @details Renders into the current rendering scope, e.g. right after `CompositePipeline::render`. The
+	/// layer holds premultiplied color (see `OverlayAttachment`), the blend gives the same result as drawing
+	/// its contents over the target directly.
+	///
+	/// - Expects the layer in `eShaderReadOnlyOptimal` layout
+	///
+	class OverlayPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create an overlay pipeline
+		///
+		/// @param context Vulkan context
+		/// @param target_format Format of the target image
+		/// @return Created pipeline or error
+		///
+		[[nodiscard]]
+		static std::expected<OverlayPipeline, Error> create(
+			const vulkan::Context& context,
+			vk::Format target_format
+		) noexcept;
+
+		///
+		/// @brief Create a given number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Blend the overlay layer over the target image
+		///
+		/// @param command_buffer Command buffer, inside a rendering scope of the target image
+		/// @param resource_set Resource set
+		///
+		void render(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		vk::raii::DescriptorSetLayout resource_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+		vk::raii::Sampler sampler;
+
+		explicit OverlayPipeline(
+			vk::raii::DescriptorSetLayout resource_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline,
+			vk::raii::Sampler sampler
+		) :
+			resource_layout(std::move(resource_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline)),
+			sampler(std::move(sampler))
+		{}
+
+	  public:
+
+		OverlayPipeline(const OverlayPipeline&) = delete;
+		OverlayPipeline(OverlayPipeline&&) = default;
+		OverlayPipeline& operator=(const OverlayPipeline&) = delete;
+		OverlayPipeline& operator=(OverlayPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for overlay pipeline
+	///
+	class OverlayPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param overlay Overlay layer to blend
+		///
+		void update(const vulkan::Context& context, OverlayAttachment::View overlay) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		vk::raii::DescriptorSet descriptor_set;
+
+		vk::Sampler sampler;
+
+		std::optional<glm::u32vec2> image_size = std::nullopt;
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			vk::raii::DescriptorSet descriptor_set,
+			vk::Sampler sampler
+		) :
+			descriptor_pool(std::move(descriptor_pool)),
+			descriptor_set(std::move(descriptor_set)),
+			sampler(sampler)
+		{}
+
+		friend class OverlayPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
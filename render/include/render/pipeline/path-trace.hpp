@@ -0,0 +1,253 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/path-trace.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Progressive path tracing pipeline, a ground truth reference for the raster lighting
+	/// @details Traces camera paths against the TLAS with ray queries, shading hits with the bindless
+	/// materials of the model and the same BRDF as the raster lighting (see `pbr::gltf`). Each bounce
+	/// samples the primary light and one random punctual light with shadow rays, and continues along
+	/// a sampled diffuse or specular direction. Escaping rays gather a uniform ambient radiance, matching
+	/// the ambient term of the raster lighting.
+	///
+	/// - Samples are summed into the accumulation attachment across frames, and the mean overwrites the HDR
+	/// attachment. The accumulation restarts whenever `compute` is called with a zero frame index.
+	/// - Spends a budget of paths per frame, see `get_dispatch`. Below one path per pixel, pixels are
+	/// traced in an interleaved pattern, untraced pixels show their mean so far.
+	/// - Pixels stop tracing once they have accumulated `Option::max_samples`
+	/// - Expects the HDR attachment to be in `eShaderReadOnlyOptimal` layout after the lighting pass, and
+	/// leaves it in the same layout. Its previous content is discarded.
+	/// - Textures are sampled at their finest resident level, and hits use the geometry of the BLASes (see
+	/// `MeshList::Ref::trace_primitive_attr_buffer`)
+	/// @note Requires the `raytracing` device feature. See `vulkan::DeviceFeature`.
+	///
+	class PathTracePipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Options of path tracing, any change should restart the accumulation
+		///
+		struct Option
+		{
+			// Paths traced per frame in total, see `get_dispatch`
+			uint32_t sample_budget = 1048576;
+
+			// Upper limit of paths traced per pixel in a frame
+			uint32_t max_samples_per_pixel = 4;
+
+			// Indirect bounces of a path after the primary hit
+			uint32_t max_bounces = 4;
+
+			// Samples accumulated per pixel before it stops tracing
+			uint32_t max_samples = 4096;
+
+			bool operator==(const Option&) const noexcept = default;
+		};
+
+		///
+		/// @brief Work of a frame derived from the sample budget
+		///
+		struct Dispatch
+		{
+			uint32_t samples_per_pixel;  // Paths traced per traced pixel
+			uint32_t pixel_stride;       // Each pixel is traced once every `pixel_stride` frames
+		};
+
+		///
+		/// @brief Get the work of a frame fitting the sample budget
+		///
+		/// @param option Options of path tracing
+		/// @param extent Extent of the HDR attachment
+		/// @return Budget divided by pixel count, clamped to `[1, max_samples_per_pixel]` paths per pixel.
+		/// Budgets below one path per pixel spread the pixels over up to `MAX_PIXEL_STRIDE` frames instead.
+		///
+		[[nodiscard]]
+		static Dispatch get_dispatch(const Option& option, glm::u32vec2 extent) noexcept;
+
+		///
+		/// @brief Create a path tracing pipeline
+		///
+		/// @param context Vulkan context, must have the `raytracing` feature enabled
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to trace, see `MeshList::create`
+		/// @param hdr_format Format of the HDR attachments written, see `HdrAttachment::format`
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<PathTracePipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full,
+			vk::Format hdr_format = HdrAttachment::HDR_FORMAT
+		) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Trace the paths of a frame, accumulate them and write the mean into the HDR attachment
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of path tracing
+		/// @param frame_index Frames accumulated since the last restart, `0` discards the accumulation
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			uint32_t frame_index
+		) const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 packed_vertex;
+		};
+
+		struct PushConstant
+		{
+			glm::u32vec2 size;
+			uint32_t frame_index;
+			uint32_t samples_per_pixel;
+			uint32_t pixel_stride;
+			uint32_t max_bounces;
+			uint32_t max_samples;
+			uint32_t light_count;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+		static constexpr uint32_t MAX_PIXEL_STRIDE = 16;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+		VertexFormat vertex_format;
+
+		explicit PathTracePipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline,
+			VertexFormat vertex_format
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline)),
+			vertex_format(vertex_format)
+		{}
+
+	  public:
+
+		PathTracePipeline(const PathTracePipeline&) = delete;
+		PathTracePipeline(PathTracePipeline&&) = default;
+		PathTracePipeline& operator=(const PathTracePipeline&) = delete;
+		PathTracePipeline& operator=(PathTracePipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for path tracing pipeline
+	///
+	class PathTracePipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance, providing geometries, materials and punctual lights
+		/// @param tlas TLAS of the scene
+		/// @param accumulation Accumulation attachment, same extent as @p hdr
+		/// @param hdr HDR attachment to write the mean into
+		/// @param camera Camera buffer
+		/// @param direct_light Primary light buffer
+		/// @param world_transforms World transforms of the nodes, for the punctual lights
+		///
+		/// @warning The vertex format of the model must match the pipeline, and @p tlas must be built from
+		/// the same model, or a fatal/unrecoverable error will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const Tlas& tlas,
+			PathTraceAttachment::View accumulation,
+			HdrAttachment::View hdr,
+			vulkan::ElementBufferRef<Camera> camera,
+			vulkan::ElementBufferRef<DirectLight> direct_light,
+			vulkan::ArrayBufferRef<glm::mat4> world_transforms
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+			VertexFormat vertex_format;
+			uint32_t light_count;
+
+			PathTraceAttachment::View accumulation;
+			HdrAttachment::View hdr;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class PathTracePipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
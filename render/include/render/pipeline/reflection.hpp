@@ -0,0 +1,287 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/denoise.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/hiz.hpp"
+#include "render/resource/reflection.hpp"
+#include "render/resource/taa.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Hybrid glossy reflection pipeline, screen-space marching with a ray traced fallback
+	/// @details Reflections are only traced for glossy pixels, below `Option::max_roughness`, at the
+	/// resolution of the reflection attachment:
+	/// 1. `trace` classifies tiles of `ReflectionAttachment::TILE_SIZE` texels, clearing tiles without glossy
+	/// pixels and appending the others to the tile list. The trace pass then runs over the listed tiles
+	/// only with an indirect dispatch, so its cost scales with the glossy area of the frame.
+	/// 2. A GGX sampled direction is marched against the HiZ attachment, a hit is shaded with the previous
+	/// frame's TAA output at its reprojected position. Rays leaving the screen, passing behind geometry or
+	/// hitting nothing fall back to a ray query against the TLAS, shading the hit with the primary light, a
+	/// shadow ray and the ambient.
+	/// 3. The signal is denoised by `DenoisePipeline` (see `DenoiseAttachment`), called between `trace` and
+	/// `composite`
+	/// 4. `composite` weights the denoised reflections by the split-sum BRDF and adds them to the HDR
+	/// attachment, fading them out towards `Option::max_roughness`. With environment lighting enabled, the
+	/// prefiltered environment specular of the lighting pass is replaced.
+	///
+	/// - Expects the deferred attachments and the HDR attachment to be in `eShaderReadOnlyOptimal` layout
+	/// after the lighting pass, and leaves the HDR attachment in the same layout
+	/// - Expects the HiZ attachment and the previous TAA output in `eGeneral` layout
+	/// - Leaves the signal in `eGeneral` layout, ready for `DenoisePipeline::compute`
+	/// - The HiZ holds the farthest depth of each footprint, coarse steps only detect crossings behind the
+	/// whole footprint. Thin geometry missed by the march is found by the fallback ray.
+	/// @note Requires the `raytracing` device feature. See `vulkan::DeviceFeature`.
+	///
+	class ReflectionPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Options of reflections
+		///
+		struct Option
+		{
+			float max_roughness = 0.4f;  // Pixels above this roughness keep the lighting pass result
+			float max_distance = 50.0f;  // Length of the screen-space march, in world units
+			uint32_t max_steps = 32;     // Coarse steps of the screen-space march
+			float thickness = 0.05f;     // Assumed thickness of the depth buffer, relative to the view depth
+		};
+
+		///
+		/// @brief Create a reflection pipeline
+		///
+		/// @param context Vulkan context, must have the `raytracing` feature enabled
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to trace, see `MeshList::create`
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<ReflectionPipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full
+		) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Classify the glossy tiles and trace their reflections into the signal
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of reflections
+		/// @param frame_index Index of the frame, rotates the sampled directions
+		/// @param history_valid Whether the previous TAA output holds the previous frame, `false` traces all
+		/// rays against the TLAS
+		/// @param environment Whether environment lighting is enabled, escaping rays then sample the
+		/// environment instead of the constant ambient
+		///
+		void trace(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			uint32_t frame_index,
+			bool history_valid,
+			bool environment
+		) const noexcept;
+
+		///
+		/// @brief Add the denoised reflections to the HDR attachment
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of reflections, same as the last `trace`
+		/// @param environment Whether environment lighting is enabled, same as the lighting pass
+		///
+		void composite(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			bool environment
+		) const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 packed_vertex;
+		};
+
+		struct PushConstant
+		{
+			glm::u32vec2 size;
+			glm::u32vec2 full_size;
+			glm::u32vec2 history_size;
+			float max_roughness;
+			float max_distance;
+			uint32_t max_steps;
+			float thickness;
+			uint32_t frame_index;
+			uint32_t history_valid;
+			uint32_t environment_enabled;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline classify_pipeline;
+		vk::raii::Pipeline trace_pipeline;
+		vk::raii::Pipeline composite_pipeline;
+		vk::raii::Sampler environment_sampler;
+		VertexFormat vertex_format;
+
+		explicit ReflectionPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline classify_pipeline,
+			vk::raii::Pipeline trace_pipeline,
+			vk::raii::Pipeline composite_pipeline,
+			vk::raii::Sampler environment_sampler,
+			VertexFormat vertex_format
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			classify_pipeline(std::move(classify_pipeline)),
+			trace_pipeline(std::move(trace_pipeline)),
+			composite_pipeline(std::move(composite_pipeline)),
+			environment_sampler(std::move(environment_sampler)),
+			vertex_format(vertex_format)
+		{}
+
+		void bind(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const PushConstant& push_constant
+		) const noexcept;
+
+	  public:
+
+		ReflectionPipeline(const ReflectionPipeline&) = delete;
+		ReflectionPipeline(ReflectionPipeline&&) = default;
+		ReflectionPipeline& operator=(const ReflectionPipeline&) = delete;
+		ReflectionPipeline& operator=(ReflectionPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for reflection pipeline
+	///
+	class ReflectionPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance, providing geometries and materials
+		/// @param tlas TLAS of the scene
+		/// @param deferred Deferred attachment of the current frame
+		/// @param hiz HiZ attachment built from the depth of the current frame
+		/// @param prev_color TAA output of the previous frame, sampled by screen-space hits
+		/// @param reflection Reflection attachment to trace into
+		/// @param denoised Denoise attachment the signal is denoised into, read by `composite`
+		/// @param hdr HDR attachment to add the reflections to, same extent as @p deferred
+		/// @param camera Camera buffer
+		/// @param direct_light Primary light buffer
+		/// @param environment Environment lighting, bound even if disabled
+		///
+		/// @warning The vertex format of the model must match the pipeline, @p tlas must be built from the
+		/// same model, and @p denoised must have the downscale of @p reflection, or a fatal/unrecoverable
+		/// error will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const Tlas& tlas,
+			DeferredAttachment::View deferred,
+			HizAttachment::View hiz,
+			TaaAttachment::View prev_color,
+			ReflectionAttachment::View reflection,
+			DenoiseAttachment::View denoised,
+			HdrAttachment::View hdr,
+			vulkan::ElementBufferRef<Camera> camera,
+			vulkan::ElementBufferRef<DirectLight> direct_light,
+			EnvironmentLighting::View environment
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		vk::Sampler environment_sampler;
+
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+			VertexFormat vertex_format;
+			glm::u32vec2 full_size;
+			glm::u32vec2 history_size;
+
+			ReflectionAttachment::View reflection;
+			HdrAttachment::View hdr;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> pool,
+			vk::raii::DescriptorSet set,
+			vk::Sampler environment_sampler
+		) :
+			pool(std::move(pool)),
+			set(std::move(set)),
+			environment_sampler(environment_sampler)
+		{}
+
+		friend class ReflectionPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
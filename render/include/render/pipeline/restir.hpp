@@ -0,0 +1,236 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/restir.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief ReSTIR direct illumination from the emissive triangles and the punctual lights of a model
+	/// @details Resamples one light sample per pixel from many lights at a constant cost per pixel, see
+	/// "Spatiotemporal reservoir resampling for real-time ray tracing with dynamic direct lighting" (Bitterli
+	/// et al.):
+	/// 1. Each pixel draws `Option::candidate_count` candidates, uniformly among the punctual lights and by
+	/// the alias table of `EmissiveList`, and keeps one in proportion to the luminance of its unshadowed
+	/// contribution. The reservoir of the previous frame at the reprojected pixel is then merged.
+	/// 2. Reservoirs of `Option::spatial_samples` random neighbors are merged, and the kept sample is shaded
+	/// with a single shadow ray against the TLAS. The result is added to the HDR attachment.
+	///
+	/// - Reuse is rejected across pixels of dissimilar view distance or normal, neighbors are merged without
+	/// visibility, which biases towards the unshadowed lighting at shadow boundaries. Occluded samples are
+	/// kept with no weight so that the next frame discards them.
+	/// - Punctual lights are shadowed here, the light cluster grid must be left empty meanwhile so that they
+	/// are not counted twice. See `LightClusterPipeline::compute`.
+	/// - Expects the deferred attachments and the HDR attachment to be in `eShaderReadOnlyOptimal` layout
+	/// after the lighting pass, and leaves the HDR attachment in the same layout
+	/// @note Requires the `raytracing` device feature. See `vulkan::DeviceFeature`.
+	///
+	class RestirPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Options of the resampling
+		///
+		struct Option
+		{
+			uint32_t candidate_count = 8;  // Light candidates drawn per pixel
+			uint32_t spatial_samples = 4;  // Neighbors merged by the spatial reuse
+			float spatial_radius = 16.0f;  // Radius of the spatial reuse, in pixels
+			uint32_t max_history = 20;     // Temporal history cap, relative to `candidate_count`
+		};
+
+		///
+		/// @brief Create a ReSTIR pipeline
+		///
+		/// @param context Vulkan context, must have the `raytracing` feature enabled
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to trace, see `MeshList::create`
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<RestirPipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full
+		) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Resample the light samples of each pixel and add their shading to the HDR attachment
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of the resampling
+		/// @param frame_index Index of the frame, rotates the random numbers
+		/// @param history_valid Whether the previous reservoirs are from the previous frame at the same
+		/// extent, `false` skips the temporal reuse
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			uint32_t frame_index,
+			bool history_valid
+		) const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 packed_vertex;
+		};
+
+		struct PushConstant
+		{
+			glm::u32vec2 size;
+			uint32_t frame_index;
+			uint32_t history_valid;
+			uint32_t candidate_count;
+			uint32_t spatial_samples;
+			float spatial_radius;
+			float max_history;
+			uint32_t punctual_count;
+			uint32_t emissive_count;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline initial_pipeline;
+		vk::raii::Pipeline spatial_pipeline;
+		VertexFormat vertex_format;
+
+		explicit RestirPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline initial_pipeline,
+			vk::raii::Pipeline spatial_pipeline,
+			VertexFormat vertex_format
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			initial_pipeline(std::move(initial_pipeline)),
+			spatial_pipeline(std::move(spatial_pipeline)),
+			vertex_format(vertex_format)
+		{}
+
+	  public:
+
+		RestirPipeline(const RestirPipeline&) = delete;
+		RestirPipeline(RestirPipeline&&) = default;
+		RestirPipeline& operator=(const RestirPipeline&) = delete;
+		RestirPipeline& operator=(RestirPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for ReSTIR pipeline
+	///
+	class RestirPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance, providing geometries, materials, punctual lights and emissive
+		/// triangles
+		/// @param tlas TLAS of the scene
+		/// @param deferred Deferred attachment of the current frame
+		/// @param restir ReSTIR attachment of the current frame
+		/// @param prev_restir ReSTIR attachment of the previous frame, reused temporally
+		/// @param hdr HDR attachment to add the lighting to, same extent as @p deferred
+		/// @param camera Camera buffer
+		/// @param world_transforms World transforms of the nodes, for the lights
+		///
+		/// @warning The vertex format of the model must match the pipeline, @p tlas must be built from the
+		/// same model, and @p restir must be at the extent of @p deferred, or a fatal/unrecoverable error
+		/// will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const Tlas& tlas,
+			DeferredAttachment::View deferred,
+			RestirAttachment::View restir,
+			RestirAttachment::View prev_restir,
+			HdrAttachment::View hdr,
+			vulkan::ElementBufferRef<Camera> camera,
+			vulkan::ArrayBufferRef<glm::mat4> world_transforms
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+			VertexFormat vertex_format;
+			uint32_t punctual_count;
+			uint32_t emissive_count;
+
+			RestirAttachment::View restir;
+			RestirAttachment::View prev_restir;
+			HdrAttachment::View hdr;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class RestirPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Shading rate pipeline, chooses the coarse shading rate of each screen tile for variable rate
+	/// shading
+	/// @details
+	/// - Each tile of the `ShadingRateAttachment` is shaded at half rate along an axis if the mean luminance
+	/// contrast of the previous frame along that axis is below a threshold. The threshold grows with the
+	/// motion of the tile, fast moving regions are shaded coarser.
+	/// - The previous frame is read at the same screen position without reprojection, at most one tile away
+	/// for most motions, which coarse shading at 2x2 tolerates
+	/// - Expects the HDR and deferred attachments of the previous frame in `eShaderReadOnlyOptimal` layout,
+	/// which is the layout the lighting and deferred pipelines leave them in
+	/// - Leaves the shading rate image in `eGeneral` layout, visible to the fragment shading rate stage and
+	/// to compute shaders. See `DeferredPipeline::render` and `DirectLightingPipeline::compute`.
+	///
+	class ShadingRatePipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Options of the shading rate generation
+		///
+		struct Option
+		{
+			// Mean Weber contrast between neighboring pixels below which an axis of a tile is coarsened
+			float contrast_threshold = 0.03f;
+
+			// Relative increase of the threshold per pixel of motion
+			float motion_scale = 0.25f;
+		};
+
+		///
+		/// @brief Create a shading rate pipeline
+		///
+		/// @param context Vulkan context
+		/// @param hdr_format Format of the HDR attachments tinted by the visualization, see
+		/// `HdrAttachment::format`
+		/// @return Created pipeline or error
+		///
+		[[nodiscard]]
+		static std::expected<ShadingRatePipeline, Error> create(
+			const vulkan::Context& context,
+			vk::Format hdr_format = HdrAttachment::HDR_FORMAT
+		) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Generate the shading rate image from the previous frame
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param option Options of the shading rate generation
+		/// @param history_valid Whether the attachments of the previous frame hold rendered content, full
+		/// rate is written otherwise
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const Option& option,
+			bool history_valid
+		) const noexcept;
+
+		///
+		/// @brief Fill the shading rate image with full rate, for frames with variable rate shading disabled
+		/// @details Leaves the image in the same layout as `compute`, so that it can stay bound to the
+		/// consuming passes
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void clear(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+		///
+		/// @brief Tint the lit HDR attachment by the shading rate, for debugging
+		/// @note The HDR attachment is expected to be in `eShaderReadOnlyOptimal` layout, as left by the
+		/// lighting pass, and is left in the same layout
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void visualize(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 extent;
+			glm::u32vec2 prev_extent;
+			glm::u32vec2 tile_size;
+			glm::u32vec2 tile_count;
+			float contrast_threshold;
+			float motion_scale;
+			uint32_t enabled;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;  // Must match `WORKGROUP_SIZE` in `shading-rate.slang`
+
+		void dispatch(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			const PushConstant& push_constant
+		) const noexcept;
+
+		[[nodiscard]]
+		static PushConstant get_push_constant(const ResourceSet& resource_set) noexcept;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline generate_pipeline;
+		vk::raii::Pipeline visualize_pipeline;
+		bool fragment_shading_rate;
+
+		explicit ShadingRatePipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline generate_pipeline,
+			vk::raii::Pipeline visualize_pipeline,
+			bool fragment_shading_rate
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			generate_pipeline(std::move(generate_pipeline)),
+			visualize_pipeline(std::move(visualize_pipeline)),
+			fragment_shading_rate(fragment_shading_rate)
+		{}
+
+	  public:
+
+		ShadingRatePipeline(const ShadingRatePipeline&) = delete;
+		ShadingRatePipeline(ShadingRatePipeline&&) = default;
+		ShadingRatePipeline& operator=(const ShadingRatePipeline&) = delete;
+		ShadingRatePipeline& operator=(ShadingRatePipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for shading rate pipeline
+	///
+	class ShadingRatePipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param prev_hdr HDR attachment of the previous frame
+		/// @param prev_deferred Deferred attachment of the previous frame, provides the velocity
+		/// @param hdr HDR attachment of the current frame, tinted by `visualize`
+		/// @param shading_rate Shading rate image to write into
+		///
+		void update(
+			const vulkan::Context& context,
+			HdrAttachment::View prev_hdr,
+			DeferredAttachment::View prev_deferred,
+			HdrAttachment::View hdr,
+			ShadingRateAttachment::View shading_rate
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			glm::u32vec2 prev_extent;
+			HdrAttachment::View hdr;
+			ShadingRateAttachment::View shading_rate;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class ShadingRatePipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
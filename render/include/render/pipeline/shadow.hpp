@@ -0,0 +1,191 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/shadow.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Shadow pipeline, traces one shadow ray per shadow mask texel against the TLAS toward the
+	/// primary light
+	/// @details
+	/// - Expects the deferred attachments to be in `eShaderReadOnlyOptimal` layout, which is the layout the
+	/// deferred pipeline leaves them in
+	/// - Leaves the shadow mask in `eGeneral` layout, ready to be sampled by fragment shaders
+	/// - Candidate hits on non-opaque geometries (alpha-masked or blended materials, see
+	/// `MeshBlasPrototype::create`) are alpha tested against the albedo texture, opaque geometries skip
+	/// the test entirely
+	/// @note Requires the `raytracing` device feature. See `vulkan::DeviceFeature`.
+	///
+	class ShadowPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a shadow pipeline
+		///
+		/// @param context Vulkan context, must have the `raytracing` feature enabled
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to trace, see `MeshList::create`
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<ShadowPipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full
+		) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Trace the shadow rays and write the shadow mask
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 packed_vertex;
+		};
+
+		struct PushConstant
+		{
+			glm::u32vec2 mask_size;
+			glm::u32vec2 full_size;
+			uint32_t downscale;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+		VertexFormat vertex_format;
+
+		explicit ShadowPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline,
+			VertexFormat vertex_format
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline)),
+			vertex_format(vertex_format)
+		{}
+
+	  public:
+
+		ShadowPipeline(const ShadowPipeline&) = delete;
+		ShadowPipeline(ShadowPipeline&&) = default;
+		ShadowPipeline& operator=(const ShadowPipeline&) = delete;
+		ShadowPipeline& operator=(ShadowPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for shadow pipeline
+	///
+	class ShadowPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance, providing geometries and materials for alpha testing
+		/// @param tlas TLAS of the scene
+		/// @param deferred Deferred attachment to read depth and normal from
+		/// @param shadow_mask Shadow mask attachment to write into
+		/// @param camera Camera buffer
+		/// @param direct_light Primary light buffer
+		///
+		/// @warning The vertex format of the model must match the pipeline, and @p tlas must be built from
+		/// the same model, or a fatal/unrecoverable error will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const Tlas& tlas,
+			DeferredAttachment::View deferred,
+			ShadowMaskAttachment::View shadow_mask,
+			vulkan::ElementBufferRef<Camera> camera,
+			vulkan::ElementBufferRef<DirectLight> direct_light
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+			VertexFormat vertex_format;
+
+			glm::u32vec2 full_size;
+			ShadowMaskAttachment::View shadow_mask;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class ShadowPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
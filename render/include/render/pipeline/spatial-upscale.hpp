@@ -0,0 +1,160 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/auto-exposure.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/taa.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Spatial upscale pipeline, an alternative to `TaaPipeline` that upscales a single frame
+	/// @details
+	/// - Upscales the HDR image to the output extent with an edge-adaptive kernel, which keeps edges sharp
+	/// without any history, so that frames need no jitter and have no ghosting
+	/// - Filters the colors after applying the exposure and compressing them into `[0, 1)`, the output is
+	/// divided back by the exposure so that bloom and composite read it like the TAA output
+	/// - Expects the HDR attachment to be in `eShaderReadOnlyOptimal` layout after the lighting pass
+	/// - Writes into a `TaaAttachment`, and leaves it in `eGeneral` layout ready to be sampled by fragment
+	/// shaders. The output can serve as the history of a following TAA frame.
+	/// @note Pair with the sharpening of `CompositePipeline` to restore the detail lost by upscaling
+	///
+	class SpatialUpscalePipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a spatial upscale pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<SpatialUpscalePipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Upscale the current frame
+		/// @note The exposure result must be visible to the compute shader stage
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void compute(const vk::raii::CommandBuffer& command_buffer, const ResourceSet& resource_set)
+			const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 extent;
+			glm::u32vec2 render_extent;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+
+		explicit SpatialUpscalePipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline))
+		{}
+
+	  public:
+
+		SpatialUpscalePipeline(const SpatialUpscalePipeline&) = delete;
+		SpatialUpscalePipeline(SpatialUpscalePipeline&&) = default;
+		SpatialUpscalePipeline& operator=(const SpatialUpscalePipeline&) = delete;
+		SpatialUpscalePipeline& operator=(SpatialUpscalePipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for spatial upscale pipeline
+	///
+	class SpatialUpscalePipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param exposure_result Exposure result applied by the composite of current frame
+		/// @param hdr HDR attachment of current frame, lit
+		/// @param output TAA attachment of current frame
+		///
+		/// @warning @p hdr must be no larger than @p output, or a fatal/unrecoverable error will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			vulkan::ElementBufferRef<ExposureResult> exposure_result,
+			HdrAttachment::View hdr,
+			TaaAttachment::View output
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		struct Resource
+		{
+			HdrAttachment::View hdr;
+			TaaAttachment::View output;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(std::shared_ptr<vk::raii::DescriptorPool> pool, vk::raii::DescriptorSet set) :
+			pool(std::move(pool)),
+			set(std::move(set))
+		{}
+
+		friend class SpatialUpscalePipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
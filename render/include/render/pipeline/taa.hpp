@@ -0,0 +1,206 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/taa.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief TAA pipeline, resolves the jittered HDR image of a frame against the history of the previous
+	/// frame
+	/// @details
+	/// - History is reprojected with the velocity of the closest pixel in the 3x3 neighborhood, pixels
+	/// without geometry are reprojected with the camera alone
+	/// - Reprojected history is clipped to the color distribution of the neighborhood to reject stale
+	/// samples, then blended with the current frame
+	/// - Upscales when the HDR and deferred attachments are smaller than the output, the history is kept at
+	/// the output extent so it survives changes of the render extent
+	/// - Expects the HDR attachment to be in `eShaderReadOnlyOptimal` layout after the lighting pass, and the
+	/// deferred attachments in `eShaderReadOnlyOptimal` layout
+	/// - Reconstructs checkerboard frames, where only pixels of one parity were lit (see
+	/// `DirectLightingPipeline`). Unlit pixels are interpolated from their lit neighbors along the smoother
+	/// axis and lean more on the reprojected history, and only lit pixels bound the history clipping.
+	/// - Leaves the output in `eGeneral` layout, ready to be sampled by fragment shaders
+	/// @note Geometry must be rasterized with `Camera::jitter` set from @p get_jitter for the resolve to
+	/// converge to an anti-aliased image
+	///
+	class TaaPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Get the sub-pixel jitter of a frame
+		/// @details Follows the Halton (2, 3) sequence, repeating every `JITTER_PHASE_COUNT` frames
+		///
+		/// @param frame_index Index of the frame, only the relative order matters
+		/// @param extent Render extent, i.e. extent of the HDR and deferred attachments
+		/// @return Jitter in NDC, within half a pixel in each axis
+		///
+		[[nodiscard]]
+		static glm::vec2 get_jitter(uint32_t frame_index, glm::u32vec2 extent) noexcept;
+
+		///
+		/// @brief Create a TAA pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<TaaPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Resolve the current frame against the history
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param history_valid Whether the history holds the output of the previous frame, the history is
+		/// discarded and the current frame is output as-is if `false`
+		/// @param checkerboard Parity of `x + y` of the lit pixels of the HDR attachment, all pixels are lit
+		/// if empty. Requires the HDR attachment to have the output extent.
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			bool history_valid,
+			std::optional<uint32_t> checkerboard = std::nullopt
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::u32vec2 extent;
+			glm::u32vec2 render_extent;
+			uint32_t history_valid;
+			uint32_t checkerboard;  // 1 + parity of the lit pixels, 0 if all pixels are lit
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 8;
+		static constexpr uint32_t JITTER_PHASE_COUNT = 8;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline pipeline;
+		vk::raii::Sampler history_sampler;
+
+		explicit TaaPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline pipeline,
+			vk::raii::Sampler history_sampler
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			pipeline(std::move(pipeline)),
+			history_sampler(std::move(history_sampler))
+		{}
+
+	  public:
+
+		TaaPipeline(const TaaPipeline&) = delete;
+		TaaPipeline(TaaPipeline&&) = default;
+		TaaPipeline& operator=(const TaaPipeline&) = delete;
+		TaaPipeline& operator=(TaaPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for TAA pipeline
+	///
+	class TaaPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param hdr HDR attachment of current frame, lit and jittered
+		/// @param deferred Deferred attachment of current frame, to read depth and velocity from
+		/// @param history TAA attachment of previous frame
+		/// @param output TAA attachment of current frame
+		/// @param camera Camera buffer of current frame
+		///
+		/// @warning @p hdr and @p deferred must have identical extents no larger than @p output, and
+		/// @p history must have the same extent as @p output, or a fatal/unrecoverable error will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			HdrAttachment::View hdr,
+			DeferredAttachment::View deferred,
+			TaaAttachment::View history,
+			TaaAttachment::View output,
+			vulkan::ElementBufferRef<Camera> camera
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> pool;
+		vk::raii::DescriptorSet set;
+
+		vk::Sampler history_sampler;
+
+		struct Resource
+		{
+			HdrAttachment::View hdr;
+			TaaAttachment::View history;
+			TaaAttachment::View output;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> pool,
+			vk::raii::DescriptorSet set,
+			vk::Sampler history_sampler
+		) :
+			pool(std::move(pool)),
+			set(std::move(set)),
+			history_sampler(history_sampler)
+		{}
+
+		friend class TaaPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
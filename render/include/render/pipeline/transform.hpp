@@ -0,0 +1,156 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/resource/transform.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Transform pipeline, computes world transforms of all nodes on GPU
+	/// @details
+	/// - Scatters dirty local transforms uploaded by host into the local transform buffer of the scene graph
+	/// - Propagates transforms level by level along the BFS order, one dispatch per depth level
+	/// - Leaves the world transform buffer ready to be read by compute and vertex shaders
+	///
+	class TransformPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a transform pipeline
+		///
+		/// @param context Vulkan context
+		/// @return Created transform pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<TransformPipeline, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Create a number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Compute world transforms
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void compute(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		struct PushConstant
+		{
+			glm::mat4 root_transform;
+			uint32_t offset;
+			uint32_t count;
+		};
+
+		static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+		vk::raii::DescriptorSetLayout descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline scatter_pipeline;
+		vk::raii::Pipeline propagate_pipeline;
+
+		explicit TransformPipeline(
+			vk::raii::DescriptorSetLayout descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline scatter_pipeline,
+			vk::raii::Pipeline propagate_pipeline
+		) :
+			descriptor_set_layout(std::move(descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			scatter_pipeline(std::move(scatter_pipeline)),
+			propagate_pipeline(std::move(propagate_pipeline))
+		{}
+
+	  public:
+
+		TransformPipeline(const TransformPipeline&) = delete;
+		TransformPipeline(TransformPipeline&&) = default;
+		TransformPipeline& operator=(const TransformPipeline&) = delete;
+		TransformPipeline& operator=(TransformPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for transform pipeline
+	///
+	class TransformPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param scene_graph Scene graph of the model
+		/// @param transform Transform resource of the frame
+		///
+		void update(
+			const vulkan::Context& context,
+			const SceneGraph& scene_graph,
+			const TransformResource& transform
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		vk::raii::DescriptorSet descriptor_set;
+
+		// External resources
+		struct Resource
+		{
+			SceneGraph::Ref scene_graph;
+			TransformResource::Ref transform;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			vk::raii::DescriptorSet descriptor_set
+		) noexcept :
+			descriptor_pool(std::move(descriptor_pool)),
+			descriptor_set(std::move(descriptor_set))
+		{}
+
+		friend class TransformPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "render/resource/transparent.hpp"
+#include "render/util/per-render-state.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Weighted blended order-independent transparency pipeline (McGuire & Bavoil 2013)
+	/// @details
+	/// - Draws the `SceneGraph::Bucket::Blended` drawcalls, culled into their own `IndirectResource`, on top
+	/// of the depth of the deferred attachment with depth tests but without depth writes
+	/// - Each fragment is lit by the primary light and the constant ambient, then accumulated in any order
+	/// into the transparent attachment:
+	///   - Accumulation: `sum(w * (alpha * color, alpha))`, additive blending
+	///   - Revealage: `prod(1 - alpha)`, multiplicative blending
+	///   - `w` is a depth weight favouring nearer layers
+	/// - `CompositePipeline` resolves the layers over the opaque image as
+	/// `lerp(accum.rgb / accum.a, opaque, revealage)`
+	///
+	/// @note Composited after TAA, blended geometry is drawn without jitter and is not temporally filtered
+	/// @note The deferred depth is expected in shader read-only layout (as left by the G-buffer passes), and
+	/// is left in the same layout. The transparent attachment is left in shader read-only layout for
+	/// `CompositePipeline`
+	///
+	class TransparentPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a transparent pipeline
+		///
+		/// @param context Vulkan context
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to render, see `MeshList::create`
+		/// @return Created pipeline, or error if creation failed
+		///
+		[[nodiscard]]
+		static std::expected<TransparentPipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full
+		) noexcept;
+
+		///
+		/// @brief Create a given number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Draw the blended drawcalls of both phases into the transparent attachment
+		/// @note The indirect pipeline must have culled both phases of the blended indirect resource
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void render(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+		///
+		/// @brief Clear the transparent attachment without drawing, e.g. when the frame is path traced
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void clear(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set
+		) const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 double_sided;
+			vk::Bool32 packed_vertex;
+		};
+
+		static std::expected<vk::raii::Pipeline, Error> create_pipeline(
+			const vulkan::Context& context,
+			vk::PipelineLayout pipeline_layout,
+			vk::ShaderModule shader_module,
+			VertexFormat vertex_format,
+			bool double_sided
+		) noexcept;
+
+		// Transition and clear the attachments, then draw the blended drawcalls if `draw` is set
+		void record(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			bool draw
+		) const noexcept;
+
+		vk::raii::DescriptorSetLayout data_descriptor_set_layout;
+		vk::raii::PipelineLayout pipeline_layout;
+		vk::raii::Pipeline single_sided_pipeline;
+		vk::raii::Pipeline double_sided_pipeline;
+		VertexFormat vertex_format;
+
+		explicit TransparentPipeline(
+			vk::raii::DescriptorSetLayout data_descriptor_set_layout,
+			vk::raii::PipelineLayout pipeline_layout,
+			vk::raii::Pipeline single_sided_pipeline,
+			vk::raii::Pipeline double_sided_pipeline,
+			VertexFormat vertex_format
+		) :
+			data_descriptor_set_layout(std::move(data_descriptor_set_layout)),
+			pipeline_layout(std::move(pipeline_layout)),
+			single_sided_pipeline(std::move(single_sided_pipeline)),
+			double_sided_pipeline(std::move(double_sided_pipeline)),
+			vertex_format(vertex_format)
+		{}
+
+	  public:
+
+		TransparentPipeline(const TransparentPipeline&) = delete;
+		TransparentPipeline(TransparentPipeline&&) = default;
+		TransparentPipeline& operator=(const TransparentPipeline&) = delete;
+		TransparentPipeline& operator=(TransparentPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for transparent pipeline
+	///
+	class TransparentPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance
+		/// @param transform Transform resource, providing world transforms of the nodes
+		/// @param indirect_resource Indirect drawcall resource of the blended bucket, see
+		/// `SceneGraph::Bucket::Blended`
+		/// @param deferred_attachment Deferred attachments, only the depth is used
+		/// @param transparent_attachment Transparent attachment
+		/// @param camera_param Camera parameter buffer
+		/// @param primary_light_param Primary light parameter buffer
+		/// @param material_feedback Feedback buffer accumulating covered pixels of each material, see
+		/// `TextureFeedbackResource`
+		///
+		/// @warning Deferred and transparent attachments must have identical extents
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const TransformResource& transform,
+			const IndirectResource& indirect_resource,
+			DeferredAttachment::View deferred_attachment,
+			TransparentAttachment::View transparent_attachment,
+			vulkan::ElementBufferRef<Camera> camera_param,
+			vulkan::ElementBufferRef<DirectLight> primary_light_param,
+			vulkan::ArrayBufferRef<uint32_t> material_feedback
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		PerRenderState<vk::raii::DescriptorSet> data_descriptor_set;
+
+		// External resources
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+
+			vk::Buffer vertex_buffer;
+			VertexFormat vertex_format;
+			vk::Buffer index_buffer;
+			IndexFormat index_format;
+			PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>> indirect_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>> command_buffers;
+			PerRenderState<vulkan::ElementBufferRef<IndirectCount>> count_buffers;
+
+			glm::u32vec2 extent;
+			vulkan::AttachmentView depth, accumulation, revealage;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			PerRenderState<vk::raii::DescriptorSet> data_descriptor_set
+		) :
+			descriptor_pool(std::move(descriptor_pool)),
+			data_descriptor_set(std::move(data_descriptor_set))
+		{}
+
+		friend class TransparentPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
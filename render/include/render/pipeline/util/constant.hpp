@@ -65,6 +65,18 @@ namespace render::constant
 			| vk::ColorComponentFlagBits::eA
 	};
 
+	///
+	/// @brief Fragment shading rate state taking the rate from the shading rate attachment
+	/// @note Requires the `fragment_shading_rate` device feature, see `ShadingRateAttachment`
+	///
+	constexpr auto ATTACHMENT_SHADING_RATE_STATE = vk::PipelineFragmentShadingRateStateCreateInfoKHR{
+		.fragmentSize = vk::Extent2D{.width = 1, .height = 1},
+		.combinerOps = std::to_array({
+			vk::FragmentShadingRateCombinerOpKHR::eKeep,
+			vk::FragmentShadingRateCombinerOpKHR::eReplace,
+		}),
+	};
+
 	///
 	/// @brief Viewport state for fully-dynamic viewport & scissor
 	///
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "model/mesh.hpp"
+#include "render/model/mesh.hpp"
+#include "render/pipeline/util/constant.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "vulkan/interface/attachment.hpp"
+
+#include <array>
+#include <cstddef>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+// Shared states and synchronization of the G-buffer passes, see `DeferredPipeline`,
+// `MeshletDeferredPipeline` and `VisibilityPipeline`
+namespace render::gbuffer
+{
+	///
+	/// @brief Attachments written by a G-buffer pass
+	///
+	struct Attachment
+	{
+		glm::u32vec2 extent;
+		vulkan::AttachmentView albedo, normal, pbr, velocity, depth, hdr, object_id;
+		uint32_t view_count = 1;  // Layers rendered by a multiview pass, see `get_view_mask`
+
+		///
+		/// @brief Collect attachments from deferred and HDR attachments
+		/// @warning Deferred and HDR attachments must have identical extents and view counts
+		///
+		/// @param deferred_attachment Deferred attachments
+		/// @param hdr_attachment HDR attachment
+		/// @return Attachments of the G-buffer pass
+		///
+		[[nodiscard]]
+		static Attachment from(
+			DeferredAttachment::View deferred_attachment,
+			HdrAttachment::View hdr_attachment
+		) noexcept;
+	};
+
+	///
+	/// @brief Get the view mask of a multiview G-buffer pass
+	/// @note Pipelines drawn in the pass must be created with the same view mask
+	///
+	/// @param view_count Views rendered at once, at most 32
+	/// @return `0` for a single view, which disables multiview, or one bit for each view otherwise
+	///
+	[[nodiscard]]
+	constexpr uint32_t get_view_mask(uint32_t view_count) noexcept
+	{
+		return view_count > 1 ? (1u << view_count) - 1u : 0u;
+	}
+
+	///
+	/// @brief Get the color attachment formats, in location order
+	///
+	/// @param hdr_format Format of the HDR attachment, see `HdrAttachment::format`
+	/// @return Formats of the color attachments
+	///
+	constexpr auto get_color_formats(vk::Format hdr_format) noexcept
+	{
+		return std::to_array({
+			DeferredAttachment::ALBEDO_FORMAT,     // Location 0
+			DeferredAttachment::NORMAL_FORMAT,     // Location 1
+			DeferredAttachment::PBR_FORMAT,        // Location 2
+			DeferredAttachment::VELOCITY_FORMAT,   // Location 3
+			hdr_format,                            // Location 4
+			DeferredAttachment::OBJECT_ID_FORMAT,  // Location 5
+		});
+	}
+
+	///
+	/// @brief Color attachment formats with `HdrAttachment::HDR_FORMAT`, in location order
+	///
+	constexpr auto COLOR_FORMATS = get_color_formats(HdrAttachment::HDR_FORMAT);
+
+	///
+	/// @brief Color blend states, overwriting all color attachments
+	///
+	constexpr auto COLOR_BLEND_ATTACHMENT_STATES = std::to_array({
+		constant::DEFAULT_BLEND_STATE,
+		constant::DEFAULT_BLEND_STATE,
+		constant::DEFAULT_BLEND_STATE,
+		constant::DEFAULT_BLEND_STATE,
+		constant::DEFAULT_BLEND_STATE,
+		constant::DEFAULT_BLEND_STATE,
+	});
+
+	///
+	/// @brief Depth stencil state, reverse-Z depth test and write
+	///
+	constexpr auto DEPTH_STENCIL_STATE = vk::PipelineDepthStencilStateCreateInfo{
+		.depthTestEnable = vk::True,
+		.depthWriteEnable = vk::True,
+		.depthCompareOp = vk::CompareOp::eGreater,
+		.depthBoundsTestEnable = vk::False,
+		.stencilTestEnable = vk::False
+	};
+
+	///
+	/// @brief Vertex input attributes of @p VertexFormat::Full, matching `model::Vertex` in shaders
+	///
+	constexpr auto get_full_vertex_input_attribute_descs() noexcept
+	{
+		constexpr auto vertex_position_attr_desc = vk::VertexInputAttributeDescription{
+			.location = 0,
+			.binding = 0,
+			.format = vk::Format::eR32G32B32Sfloat,
+			.offset = offsetof(model::FullVertex, position)
+		};
+
+		constexpr auto vertex_texcoord_attr_desc = vk::VertexInputAttributeDescription{
+			.location = 1,
+			.binding = 0,
+			.format = vk::Format::eR32G32Sfloat,
+			.offset = offsetof(model::FullVertex, texcoord)
+		};
+
+		constexpr auto vertex_normal_attr_desc = vk::VertexInputAttributeDescription{
+			.location = 2,
+			.binding = 0,
+			.format = vk::Format::eR32G32B32Sfloat,
+			.offset = offsetof(model::FullVertex, normal)
+		};
+
+		constexpr auto vertex_tangent_attr_desc = vk::VertexInputAttributeDescription{
+			.location = 3,
+			.binding = 0,
+			.format = vk::Format::eR32G32B32A32Sfloat,
+			.offset = offsetof(model::FullVertex, tangent)
+		};
+
+		return std::to_array({
+			vertex_position_attr_desc,
+			vertex_texcoord_attr_desc,
+			vertex_normal_attr_desc,
+			vertex_tangent_attr_desc,
+		});
+	}
+
+	///
+	/// @brief Vertex input attributes of @p VertexFormat::Packed, matching `model::PackedVertex` in shaders
+	///
+	constexpr auto get_packed_vertex_input_attribute_descs() noexcept
+	{
+		constexpr auto vertex_position_attr_desc = vk::VertexInputAttributeDescription{
+			.location = 0,
+			.binding = 0,
+			.format = vk::Format::eR16G16B16A16Unorm,
+			.offset = offsetof(model::PackedVertex, position)
+		};
+
+		constexpr auto vertex_texcoord_attr_desc = vk::VertexInputAttributeDescription{
+			.location = 1,
+			.binding = 0,
+			.format = vk::Format::eR16G16Sfloat,
+			.offset = offsetof(model::PackedVertex, texcoord)
+		};
+
+		constexpr auto vertex_normal_attr_desc = vk::VertexInputAttributeDescription{
+			.location = 2,
+			.binding = 0,
+			.format = vk::Format::eR16G16Snorm,
+			.offset = offsetof(model::PackedVertex, normal)
+		};
+
+		constexpr auto vertex_tangent_attr_desc = vk::VertexInputAttributeDescription{
+			.location = 3,
+			.binding = 0,
+			.format = vk::Format::eR16G16Snorm,
+			.offset = offsetof(model::PackedVertex, tangent)
+		};
+
+		return std::to_array({
+			vertex_position_attr_desc,
+			vertex_texcoord_attr_desc,
+			vertex_normal_attr_desc,
+			vertex_tangent_attr_desc,
+		});
+	}
+
+	///
+	/// @brief Get the vertex input attributes of a vertex format, bound to binding 0
+	///
+	/// @param vertex_format Vertex format
+	/// @return Vertex input attribute descriptions
+	///
+	[[nodiscard]]
+	constexpr auto get_vertex_input_attribute_descs(VertexFormat vertex_format) noexcept
+	{
+		return vertex_format == VertexFormat::Packed
+			? get_packed_vertex_input_attribute_descs()
+			: get_full_vertex_input_attribute_descs();
+	}
+
+	///
+	/// @brief Get the rasterization state of a render state
+	///
+	/// @param double_sided Whether the material is double-sided, disables back-face culling if `true`
+	/// @return Rasterization state
+	///
+	[[nodiscard]]
+	constexpr vk::PipelineRasterizationStateCreateInfo get_rasterization_state(bool double_sided) noexcept
+	{
+		return {
+			.cullMode = double_sided ? vk::CullModeFlagBits::eNone : vk::CullModeFlagBits::eBack,
+			.lineWidth = 1.0
+		};
+	}
+
+	///
+	/// @brief Transition the attachments, begin rendering and set viewport and scissor
+	///
+	/// @param command_buffer Command buffer
+	/// @param attachment Attachments
+	/// @param phase Draw phase, @p DrawPhase::Early clears the attachments and @p DrawPhase::Late loads the
+	/// early phase results
+	/// @param shading_rate Shading rate image used as fragment shading rate attachment, in `eGeneral`
+	/// layout. The bound pipelines must be created with `eRenderingFragmentShadingRateAttachmentKHR`.
+	/// Only supported with a single view.
+	///
+	void begin_rendering(
+		const vk::raii::CommandBuffer& command_buffer,
+		const Attachment& attachment,
+		DrawPhase phase,
+		std::optional<ShadingRateAttachment::View> shading_rate = std::nullopt
+	) noexcept;
+
+	///
+	/// @brief End rendering and transition the attachments for reading
+	/// @note The HDR attachment is kept in color attachment layout, expecting next usage to be color
+	/// attachment. The object ID attachment is left readable by compute shaders, like the others.
+	///
+	/// @param command_buffer Command buffer
+	/// @param attachment Attachments
+	///
+	void end_rendering(const vk::raii::CommandBuffer& command_buffer, const Attachment& attachment) noexcept;
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "common/util/async.hpp"
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <utility>
+
+namespace render
+{
+	///
+	/// @brief Material features selecting a pipeline variant, a bitmask with a fixed number of bits
+	/// @details Each feature maps to a specialization constant of the material shaders. A new material
+	/// feature (e.g. emissive, clearcoat or unlit) adds a bit, doubling the variants of
+	/// `PipelineVariantCache` without compiling any of them until a material uses it.
+	///
+	struct MaterialFeatures
+	{
+		enum Bit : uint32_t
+		{
+			AlphaMask = 1u << 0,    // Fragments are alpha-tested against the cutoff
+			DoubleSided = 1u << 1,  // Back faces are drawn with flipped normals instead of culled
+		};
+
+		static constexpr uint32_t BIT_COUNT = 2;
+		static constexpr size_t VARIANT_COUNT = 1zu << BIT_COUNT;
+
+		// Features of the generic variant, drawing materials of any features until their variant is ready.
+		// Opaque materials are alpha-tested and single-sided ones are not culled, which only costs speed for
+		// the usual materials with opaque textures
+		static constexpr uint32_t GENERIC = AlphaMask | DoubleSided;
+
+		uint32_t bits = 0;
+
+		[[nodiscard]]
+		constexpr bool has(Bit bit) const noexcept
+		{
+			return (bits & bit) != 0;
+		}
+
+		[[nodiscard]]
+		static constexpr MaterialFeatures from(model::AlphaMode alpha_mode, bool double_sided) noexcept
+		{
+			return {
+				.bits = (alpha_mode != model::AlphaMode::Opaque ? static_cast<uint32_t>(AlphaMask) : 0u)
+					| (double_sided ? static_cast<uint32_t>(DoubleSided) : 0u)
+			};
+		}
+
+		[[nodiscard]]
+		static constexpr MaterialFeatures from(model::Material::Mode mode) noexcept
+		{
+			return from(mode.alpha_mode, mode.double_sided);
+		}
+
+		[[nodiscard]]
+		bool operator==(const MaterialFeatures&) const noexcept = default;
+	};
+
+	///
+	/// @brief Cache of the pipeline variants of a material shader, compiled lazily on background threads
+	/// @details The generic variant is compiled on creation. Other variants are compiled once requested,
+	/// e.g. for the material modes a model uses, and drawn with the generic variant until adopted by
+	/// @p update.
+	///
+	/// @tparam T Pipelines of a variant, e.g. one per pass
+	///
+	template <typename T>
+	class PipelineVariantCache
+	{
+	  public:
+
+		// Compiles the pipelines of a variant, called concurrently from background threads
+		using Compile = std::function<std::expected<T, Error>(MaterialFeatures)>;
+
+		///
+		/// @brief Create a variant cache, compiling the generic variant
+		///
+		/// @param compile Compile function, must stay valid until the cache is destroyed
+		/// @return Created cache, or error if the generic variant fails to compile
+		///
+		[[nodiscard]]
+		static std::expected<PipelineVariantCache, Error> create(Compile compile) noexcept
+		{
+			auto generic_result = compile(MaterialFeatures{.bits = MaterialFeatures::GENERIC});
+			if (!generic_result) return generic_result.error().forward("Compile generic variant failed");
+
+			auto cache = PipelineVariantCache(std::make_shared<const Compile>(std::move(compile)));
+			cache.variants[MaterialFeatures::GENERIC].emplace(std::move(*generic_result));
+
+			return cache;
+		}
+
+		///
+		/// @brief Start compiling a variant in the background, unless it is compiled, compiling, or failed
+		///
+		/// @param features Features of the variant
+		///
+		void request(MaterialFeatures features) noexcept
+		{
+			const auto index = features.bits;
+			if (variants[index].has_value() || pending[index].has_value() || failed[index]) return;
+
+			auto future = std::async(std::launch::async, [compile = compile, features] {
+				return (*compile)(features);
+			});
+			pending[index] = util::Future(std::move(future));
+		}
+
+		///
+		/// @brief Adopt the variants compiled since the last call
+		/// @note Not thread-safe, must not run concurrently with @p get
+		///
+		/// @return `void` if success, or the error of a failed variant. Failed variants keep drawing with the
+		/// generic variant and are not requested again
+		///
+		[[nodiscard]]
+		std::expected<void, Error> update() noexcept
+		{
+			for (const auto index : std::views::iota(0zu, MaterialFeatures::VARIANT_COUNT))
+			{
+				auto& task = pending[index];
+				if (!task.has_value() || !task->ready()) continue;
+
+				auto result = std::move(*task).get();
+				task.reset();
+
+				if (!result)
+				{
+					failed[index] = true;
+					return result.error().forward(
+						"Compile pipeline variant failed",
+						std::format("features={:#x}", index)
+					);
+				}
+				variants[index].emplace(std::move(*result));
+			}
+
+			return {};
+		}
+
+		///
+		/// @brief Get the pipelines of a variant, falling back to the generic variant until it is compiled
+		///
+		/// @param features Features of the variant
+		/// @return Pipelines of the variant
+		///
+		[[nodiscard]]
+		const T& get(MaterialFeatures features) const noexcept
+		{
+			const auto& variant = variants[features.bits];
+			return variant.has_value() ? *variant : *variants[MaterialFeatures::GENERIC];
+		}
+
+		///
+		/// @brief Check if any requested variant is still compiling
+		///
+		/// @return `true` if compiling
+		///
+		[[nodiscard]]
+		bool compiling() const noexcept
+		{
+			return std::ranges::any_of(pending, [](const auto& task) { return task.has_value(); });
+		}
+
+	  private:
+
+		std::shared_ptr<const Compile> compile;  // Shared with the compiling tasks
+		std::array<std::optional<T>, MaterialFeatures::VARIANT_COUNT> variants = {};
+		std::array<bool, MaterialFeatures::VARIANT_COUNT> failed = {};
+
+		// Declared last to join first
+		std::array<std::optional<util::Future<std::expected<T, Error>>>, MaterialFeatures::VARIANT_COUNT>
+			pending = {};
+
+		explicit PipelineVariantCache(std::shared_ptr<const Compile> compile) noexcept :
+			compile(std::move(compile))
+		{}
+
+	  public:
+
+		PipelineVariantCache(const PipelineVariantCache&) = delete;
+		PipelineVariantCache(PipelineVariantCache&&) = default;
+		PipelineVariantCache& operator=(const PipelineVariantCache&) = delete;
+		PipelineVariantCache& operator=(PipelineVariantCache&&) = default;
+	};
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "render/resource/visibility.hpp"
+#include "render/util/per-render-state.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/descriptor-cache.hpp"
+
+namespace render
+{
+	///
+	/// @brief Visibility buffer rendering pipeline
+	/// @details Drop-in replacement of `DeferredPipeline` producing identical attachments, split into two
+	/// passes to reduce the bandwidth of overdraw:
+	/// - `render`: rasterizes the indirect drawcalls into depth and a visibility buffer, which only stores
+	/// the render state, the drawcall index and the triangle index of each pixel (see
+	/// `VisibilityAttachment`). Textures are only sampled by masked materials, for the alpha test.
+	/// - `resolve`: a fullscreen pass fetching the triangle of each pixel from the mesh buffers,
+	/// interpolating its attributes with ray-reconstructed barycentrics and derivatives, and shading the
+	/// G-buffer exactly once per pixel
+	///
+	/// The resolve pass writes the G-buffer as color attachments rather than from compute, as the sRGB albedo
+	/// format can't be used as a storage image.
+	///
+	/// @note The late phase must directly follow the early phase of the same frame, with only shader reads of
+	/// the attachments in between (e.g. HiZ build). `resolve` must be called after the late phase, and leaves
+	/// the attachments in the same layouts as `DeferredPipeline` does after the late phase.
+	///
+	class VisibilityPipeline
+	{
+	  public:
+
+		class ResourceSet;
+
+		///
+		/// @brief Create a visibility buffer rendering pipeline
+		///
+		/// @param context Vulkan context
+		/// @param material_layout Model material layout
+		/// @param vertex_format Vertex format of the models to render, see `MeshList::create`
+		/// @param hdr_format Format of the HDR attachments resolved to, see `HdrAttachment::format`
+		/// @return Created pipeline, or error if creation failed
+		///
+		[[nodiscard]]
+		static std::expected<VisibilityPipeline, Error> create(
+			const vulkan::Context& context,
+			const render::MaterialLayout& material_layout,
+			VertexFormat vertex_format = VertexFormat::Full,
+			vk::Format hdr_format = HdrAttachment::HDR_FORMAT
+		) noexcept;
+
+		///
+		/// @brief Create a given number of resource sets
+		///
+		/// @param context Vulkan context
+		/// @param count Number of resource sets to create
+		/// @return Created resource sets or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<ResourceSet>, Error> create_resource_sets(
+			const vulkan::Context& context,
+			uint32_t count
+		) const noexcept;
+
+		///
+		/// @brief Rasterize the scene into the depth and visibility attachments
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		/// @param phase Draw phase, @p DrawPhase::Early clears the attachments and @p DrawPhase::Late draws
+		/// on top of the early phase results
+		///
+		void render(
+			const vk::raii::CommandBuffer& command_buffer,
+			const ResourceSet& resource_set,
+			DrawPhase phase
+		) const noexcept;
+
+		///
+		/// @brief Shade the G-buffer and the HDR emission from the visibility attachment
+		///
+		/// @param command_buffer Command buffer
+		/// @param resource_set Resource set
+		///
+		void resolve(const vk::raii::CommandBuffer& command_buffer, const ResourceSet& resource_set)
+			const noexcept;
+
+	  private:
+
+		struct SpecializationConstant
+		{
+			vk::Bool32 alpha_mask_enabled;
+			vk::Bool32 double_sided;
+		};
+
+		static std::expected<vk::raii::Pipeline, Error> create_draw_pipeline(
+			const vulkan::Context& context,
+			const vk::raii::PipelineLayout& pipeline_layout,
+			const vk::raii::ShaderModule& shader_module,
+			VertexFormat vertex_format,
+			bool alpha_mask_enabled,
+			bool double_sided
+		) noexcept;
+
+		static std::expected<vk::raii::Pipeline, Error> create_resolve_pipeline(
+			const vulkan::Context& context,
+			const vk::raii::PipelineLayout& pipeline_layout,
+			VertexFormat vertex_format,
+			vk::Format hdr_format
+		) noexcept;
+
+		vk::raii::DescriptorSetLayout draw_descriptor_set_layout;
+		vk::raii::DescriptorSetLayout resolve_descriptor_set_layout;
+		vk::raii::PipelineLayout draw_pipeline_layout;
+		vk::raii::PipelineLayout resolve_pipeline_layout;
+		PerRenderState<vk::raii::Pipeline> draw_pipelines;
+		vk::raii::Pipeline resolve_pipeline;
+		VertexFormat vertex_format;
+
+		explicit VisibilityPipeline(
+			vk::raii::DescriptorSetLayout draw_descriptor_set_layout,
+			vk::raii::DescriptorSetLayout resolve_descriptor_set_layout,
+			vk::raii::PipelineLayout draw_pipeline_layout,
+			vk::raii::PipelineLayout resolve_pipeline_layout,
+			PerRenderState<vk::raii::Pipeline> draw_pipelines,
+			vk::raii::Pipeline resolve_pipeline,
+			VertexFormat vertex_format
+		) :
+			draw_descriptor_set_layout(std::move(draw_descriptor_set_layout)),
+			resolve_descriptor_set_layout(std::move(resolve_descriptor_set_layout)),
+			draw_pipeline_layout(std::move(draw_pipeline_layout)),
+			resolve_pipeline_layout(std::move(resolve_pipeline_layout)),
+			draw_pipelines(std::move(draw_pipelines)),
+			resolve_pipeline(std::move(resolve_pipeline)),
+			vertex_format(vertex_format)
+		{}
+
+	  public:
+
+		VisibilityPipeline(const VisibilityPipeline&) = delete;
+		VisibilityPipeline(VisibilityPipeline&&) = default;
+		VisibilityPipeline& operator=(const VisibilityPipeline&) = delete;
+		VisibilityPipeline& operator=(VisibilityPipeline&&) = default;
+	};
+
+	///
+	/// @brief Resource set for visibility buffer pipeline
+	///
+	class VisibilityPipeline::ResourceSet
+	{
+	  public:
+
+		///
+		/// @brief Update the resource set
+		///
+		/// @param context Vulkan context
+		/// @param model Model instance
+		/// @param transform Transform resource, providing world transforms of the nodes
+		/// @param prev_transform Transform resource of previous frame, for motion vectors. Pass @p transform
+		/// if previous frame has no world transforms
+		/// @param indirect_resource Indirect drawcall resource
+		/// @param deferred_attachment Deferred attachments
+		/// @param hdr_attachment HDR attachments
+		/// @param visibility_attachment Visibility attachment
+		/// @param camera_param Camera parameter buffer
+		/// @param material_feedback Feedback buffer accumulating covered pixels of each material, see
+		/// `TextureFeedbackResource`
+		///
+		/// @warning Deferred, HDR and visibility attachments must have identical extents, and the vertex
+		/// format of the model must match the pipeline, or a fatal/unrecoverable error will occur
+		///
+		void update(
+			const vulkan::Context& context,
+			const Model& model,
+			const TransformResource& transform,
+			const TransformResource& prev_transform,
+			const IndirectResource& indirect_resource,
+			DeferredAttachment::View deferred_attachment,
+			HdrAttachment::View hdr_attachment,
+			VisibilityAttachment::View visibility_attachment,
+			vulkan::ElementBufferRef<Camera> camera_param,
+			vulkan::ArrayBufferRef<uint32_t> material_feedback
+		) noexcept;
+
+	  private:
+
+		std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool;
+		PerRenderState<vk::raii::DescriptorSet> draw_descriptor_set;
+		vk::raii::DescriptorSet resolve_descriptor_set;
+
+		// External resources
+		struct Resource
+		{
+			vk::DescriptorSet material_descriptor_set;
+
+			vk::Buffer vertex_buffer;
+			VertexFormat vertex_format;
+			vk::Buffer index_buffer;
+			IndexFormat index_format;
+			PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>> indirect_buffers;
+			PerRenderState<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>> command_buffers;
+			PerRenderState<vulkan::ElementBufferRef<IndirectCount>> count_buffers;
+
+			vulkan::AttachmentView visibility;
+			gbuffer::Attachment attachment;
+		};
+
+		std::optional<Resource> resource = std::nullopt;
+
+		const Resource* operator->() const noexcept { return resource.operator->(); }
+
+		vulkan::DescriptorWriteCache descriptor_cache;
+
+		explicit ResourceSet(
+			std::shared_ptr<vk::raii::DescriptorPool> descriptor_pool,
+			PerRenderState<vk::raii::DescriptorSet> draw_descriptor_set,
+			vk::raii::DescriptorSet resolve_descriptor_set
+		) :
+			descriptor_pool(std::move(descriptor_pool)),
+			draw_descriptor_set(std::move(draw_descriptor_set)),
+			resolve_descriptor_set(std::move(resolve_descriptor_set))
+		{}
+
+		friend class VisibilityPipeline;
+
+	  public:
+
+		ResourceSet(const ResourceSet&) = delete;
+		ResourceSet(ResourceSet&&) = default;
+		ResourceSet& operator=(const ResourceSet&) = delete;
+		ResourceSet& operator=(ResourceSet&&) = default;
+	};
+}
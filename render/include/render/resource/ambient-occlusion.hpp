@@ -0,0 +1,143 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Ambient occlusion attachment, temporally accumulated occlusion at reduced resolution
+	/// @details
+	/// - Each texel takes 4 bytes of storage, the ambient visibility (`1` for unoccluded) and the distance
+	/// from the camera to the surface it was traced from, `0` for background
+	/// - Texel `p` holds the occlusion of pixel `p * downscale` of the deferred attachment
+	/// - Output of the ambient occlusion pipeline of a frame, and history of the next frame
+	/// - Written by the ambient occlusion pipeline in `eGeneral` layout, and sampled in the same layout
+	/// - The image may be larger than the extent in use (see @p set_extent), only the top-left `extent`
+	/// sub-rectangle is written
+	///
+	class AmbientOcclusionAttachment
+	{
+	  public:
+
+		static constexpr auto AMBIENT_OCCLUSION_FORMAT = vk::Format::eR16G16Sfloat;  // RG16, Float, 4 BPP
+
+		///
+		/// @brief Resolution of the ambient occlusion relative to the deferred attachment
+		///
+		enum class Resolution : uint32_t
+		{
+			Half = 2,    // Each texel covers 2x2 pixels
+			Quarter = 4  // Each texel covers 4x4 pixels
+		};
+
+		///
+		/// @brief Create an ambient occlusion attachment
+		///
+		/// @param context Vulkan context
+		/// @param extent Extent of the deferred attachment, determines the capacity
+		/// @param resolution Resolution relative to @p extent (rounded up)
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<AmbientOcclusionAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent,
+			Resolution resolution
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;  // Extent of the attachment itself
+			uint32_t downscale;   // Ratio from the deferred attachment extent to the extent, 2 or 4
+			vulkan::AttachmentView attachment;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.downscale = downscale,
+				.attachment = attachment,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the attachment can serve a given deferred attachment extent without
+		/// reallocation
+		///
+		/// @param extent Requested extent of the deferred attachment
+		/// @return `true` if the reduced extent of @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual((extent + downscale - 1u) / downscale, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle needed by @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent of the deferred attachment
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = (extent + downscale - 1u) / downscale;
+		}
+
+		///
+		/// @brief Get the resolution relative to the deferred attachment
+		///
+		/// @return Resolution the attachment was created with
+		///
+		[[nodiscard]]
+		Resolution resolution() const noexcept
+		{
+			return static_cast<Resolution>(downscale);
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		uint32_t downscale;
+		vulkan::Attachment attachment;
+
+		explicit AmbientOcclusionAttachment(
+			glm::u32vec2 extent,
+			uint32_t downscale,
+			vulkan::Attachment attachment
+		) :
+			extent(extent),
+			capacity(extent),
+			downscale(downscale),
+			attachment(std::move(attachment))
+		{}
+
+	  public:
+
+		AmbientOcclusionAttachment(const AmbientOcclusionAttachment&) = delete;
+		AmbientOcclusionAttachment(AmbientOcclusionAttachment&&) = default;
+		AmbientOcclusionAttachment& operator=(const AmbientOcclusionAttachment&) = delete;
+		AmbientOcclusionAttachment& operator=(AmbientOcclusionAttachment&&) = default;
+	};
+}
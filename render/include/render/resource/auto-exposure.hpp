@@ -7,6 +7,7 @@
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <utility>
 
@@ -39,6 +40,9 @@ namespace render
 			// Exposure frame buffer, contains the internal exposure frame data of the current frame
 			vulkan::ElementBufferRef<ExposureFrame> exposure_frame_buffer;
 
+			// Groups finished building the luminance pyramid, cleared at the start of each computation
+			vulkan::ElementBufferRef<uint32_t> pyramid_counter_buffer;
+
 			const Ref* operator->() const noexcept { return this; }
 		};
 
@@ -53,7 +57,8 @@ namespace render
 			return {
 				.histogram_buffer = histogram_buffer,
 				.exposure_result_buffer = exposure_result_buffer,
-				.exposure_frame_buffer = exposure_frame_buffer
+				.exposure_frame_buffer = exposure_frame_buffer,
+				.pyramid_counter_buffer = pyramid_counter_buffer
 			};
 		}
 
@@ -64,15 +69,18 @@ namespace render
 		vulkan::ElementBuffer<ExposureHistogramType[EXPOSURE_HISTOGRAM_BIN_COUNT]> histogram_buffer;
 		vulkan::ElementBuffer<ExposureResult> exposure_result_buffer;
 		vulkan::ElementBuffer<ExposureFrame> exposure_frame_buffer;
+		vulkan::ElementBuffer<uint32_t> pyramid_counter_buffer;
 
 		explicit AutoExposureResource(
 			vulkan::ElementBuffer<ExposureHistogramType[EXPOSURE_HISTOGRAM_BIN_COUNT]> histogram_buffer,
 			vulkan::ElementBuffer<ExposureResult> exposure_result_buffer,
-			vulkan::ElementBuffer<ExposureFrame> exposure_frame_buffer
+			vulkan::ElementBuffer<ExposureFrame> exposure_frame_buffer,
+			vulkan::ElementBuffer<uint32_t> pyramid_counter_buffer
 		) :
 			histogram_buffer(std::move(histogram_buffer)),
 			exposure_result_buffer(std::move(exposure_result_buffer)),
-			exposure_frame_buffer(std::move(exposure_frame_buffer))
+			exposure_frame_buffer(std::move(exposure_frame_buffer)),
+			pyramid_counter_buffer(std::move(pyramid_counter_buffer))
 		{}
 
 	  public:
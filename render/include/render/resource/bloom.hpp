@@ -0,0 +1,102 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/common.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Bloom chain of the temporally resolved HDR attachment, built by the bloom pipeline
+	/// @details
+	/// - Level 0 is half of the TAA extent (rounded up), each following level is half of the previous level,
+	/// down to `MAX_LEVELS` levels
+	/// - Each pixel takes 8 bytes of storage, but the whole chain is only a third of the TAA attachment
+	/// - Written by the bloom pipeline in `eGeneral` layout, and sampled in the same layout. Level 0 holds
+	/// the bloom composited over the image, see `CompositePipeline`
+	///
+	class BloomAttachment
+	{
+	  public:
+
+		static constexpr auto BLOOM_FORMAT = vk::Format::eR16G16B16A16Sfloat;  // RGBA16, Float, 8 BPP
+		static constexpr uint32_t MAX_LEVELS = 6;  // Level 5 is 1/64 of the TAA extent along each axis
+
+		///
+		/// @brief Create a bloom chain for a TAA attachment of given extent
+		///
+		/// @param context Vulkan context
+		/// @param extent Extent of the TAA attachment
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<BloomAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;  // Extent of the TAA attachment
+			uint32_t level_count;
+			vk::Image image;
+			std::array<vk::ImageView, MAX_LEVELS> level_views;  // Views of each single level
+
+			const View* operator->() const noexcept { return this; }
+
+			///
+			/// @brief Get extent of a given level
+			///
+			/// @param level Level index
+			/// @return Extent of the level
+			///
+			[[nodiscard]]
+			glm::u32vec2 level_extent(uint32_t level) const noexcept
+			{
+				auto size = extent;
+				for (uint32_t i = 0; i <= level; i++) size = glm::max((size + 1u) / 2u, glm::u32vec2(1));
+				return size;
+			}
+		};
+
+		operator View() const noexcept;
+
+		View operator->() const noexcept { return *this; }
+
+	  private:
+
+		glm::u32vec2 extent;
+		vulkan::Image image;
+		std::vector<vk::raii::ImageView> level_views;
+
+		explicit BloomAttachment(
+			glm::u32vec2 extent,
+			vulkan::Image image,
+			std::vector<vk::raii::ImageView> level_views
+		) :
+			extent(extent),
+			image(std::move(image)),
+			level_views(std::move(level_views))
+		{}
+
+	  public:
+
+		BloomAttachment(const BloomAttachment&) = delete;
+		BloomAttachment(BloomAttachment&&) = default;
+		BloomAttachment& operator=(const BloomAttachment&) = delete;
+		BloomAttachment& operator=(BloomAttachment&&) = default;
+	};
+}
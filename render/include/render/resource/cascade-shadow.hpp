@@ -0,0 +1,136 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/util/cascade.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Cascaded shadow map attachment, depth of the primary light per cascade
+	/// @details
+	/// - A square depth image array, one layer per cascade, rendered with the reverse-Z orthographic
+	/// projections given by `fit_cascades()`
+	/// - Each layer is left in `eShaderReadOnlyOptimal` layout after being rendered
+	/// - Remembers the cascades each layer was last rendered with, so that static cascades can be kept
+	/// across frames, see `acquire_dirty_cascades()`
+	///
+	class CascadeShadowAttachment
+	{
+	  public:
+
+		static constexpr auto DEPTH_FORMAT = vk::Format::eD32Sfloat;  // D32, Float, 4 BPP
+		static constexpr uint32_t MAX_CASCADES = 8;
+
+		///
+		/// @brief Create a cascaded shadow map attachment
+		///
+		/// @param context Vulkan context
+		/// @param resolution Width and height of each cascade
+		/// @param cascade_count Count of cascades, at most @p MAX_CASCADES
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<CascadeShadowAttachment, Error> create(
+			const vulkan::Context& context,
+			uint32_t resolution,
+			uint32_t cascade_count
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			uint32_t resolution;
+			uint32_t cascade_count;
+			vk::Image image;
+			vk::ImageView array_view;                              // View of all layers, for sampling
+			std::array<vk::ImageView, MAX_CASCADES> layer_views;  // Views of each single layer, for rendering
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept;
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Get the cascades to render this frame, and remember them as rendered
+		/// @details A cascade is dirty if it hasn't been rendered yet, or when @p cached is `false`. In
+		/// cached mode, a cascade is only dirty when its matrix or @p geometry_version changes since it was
+		/// last rendered. Snapped cascades keep their matrices while the camera moves within a texel and the
+		/// light stays still, see `fit_cascades()`
+		///
+		/// @param cascades Cascades of this frame, must have `cascade_count` elements
+		/// @param geometry_version Version of the shadow casting geometry, changed whenever any caster moves
+		/// or the model is replaced
+		/// @param cached Whether to keep cascades that didn't change
+		/// @return Bitmask of the dirty cascades, bit `i` for cascade `i`
+		///
+		[[nodiscard]]
+		uint32_t acquire_dirty_cascades(
+			std::span<const ShadowCascade> cascades,
+			uint64_t geometry_version,
+			bool cached
+		) noexcept;
+
+		///
+		/// @brief Get count of cascades
+		///
+		/// @return Count of cascades
+		///
+		[[nodiscard]]
+		uint32_t cascade_count() const noexcept
+		{
+			return static_cast<uint32_t>(layer_views.size());
+		}
+
+	  private:
+
+		// Cascade a layer was last rendered with
+		struct CachedCascade
+		{
+			glm::mat4 view_projection;
+			uint64_t geometry_version;
+		};
+
+		uint32_t resolution;
+		vulkan::Image image;
+		vk::raii::ImageView array_view;
+		std::vector<vk::raii::ImageView> layer_views;
+		std::vector<std::optional<CachedCascade>> cached_cascades;
+
+		explicit CascadeShadowAttachment(
+			uint32_t resolution,
+			vulkan::Image image,
+			vk::raii::ImageView array_view,
+			std::vector<vk::raii::ImageView> layer_views
+		) :
+			resolution(resolution),
+			image(std::move(image)),
+			array_view(std::move(array_view)),
+			layer_views(std::move(layer_views)),
+			cached_cascades(this->layer_views.size(), std::nullopt)
+		{}
+
+	  public:
+
+		CascadeShadowAttachment(const CascadeShadowAttachment&) = delete;
+		CascadeShadowAttachment(CascadeShadowAttachment&&) = default;
+		CascadeShadowAttachment& operator=(const CascadeShadowAttachment&) = delete;
+		CascadeShadowAttachment& operator=(CascadeShadowAttachment&&) = default;
+	};
+}
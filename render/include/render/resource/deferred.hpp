@@ -5,8 +5,10 @@
 #include "vulkan/interface/attachment.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
 #include <libassert/assert.hpp>
 #include <utility>
 #include <vulkan/vulkan.hpp>
@@ -16,29 +18,42 @@ namespace render
 	///
 	/// @brief Attachment for deferred rendering
 	/// @details
-	/// - Each pixel takes 14 bytes of storage
+	/// - Each pixel takes 22 bytes of storage
 	/// - See deferred pipeline for detailed layout
+	/// - The images may be larger than the extent in use (see @p set_extent), only the top-left `extent`
+	/// sub-rectangle is rendered
+	/// - With more than one view, each image is a layered image with one layer per view, viewed as a 2D
+	/// array and rendered in a single multiview pass (see `DeferredPipeline`)
 	///
 	class DeferredAttachment
 	{
 	  public:
 
-		static constexpr auto ALBEDO_FORMAT = vk::Format::eR8G8B8A8Srgb;  // RGBA8, Srgb, 4 BPP
-		static constexpr auto NORMAL_FORMAT = vk::Format::eR16G16Snorm;   // RG16, Snorm, 4 BPP
-		static constexpr auto PBR_FORMAT = vk::Format::eR8G8Unorm;        // RG8, Unorm, 2 BPP
-		static constexpr auto DEPTH_FORMAT = vk::Format::eD32Sfloat;      // D32, Float, 4 BPP
+		static constexpr auto ALBEDO_FORMAT = vk::Format::eR8G8B8A8Srgb;    // RGBA8, Srgb, 4 BPP
+		static constexpr auto NORMAL_FORMAT = vk::Format::eR16G16Snorm;     // RG16, Snorm, 4 BPP
+		static constexpr auto PBR_FORMAT = vk::Format::eR8G8Unorm;          // RG8, Unorm, 2 BPP
+		static constexpr auto DEPTH_FORMAT = vk::Format::eD32Sfloat;        // D32, Float, 4 BPP
+		static constexpr auto VELOCITY_FORMAT = vk::Format::eR16G16Sfloat;  // RG16, Float, 4 BPP
+		static constexpr auto OBJECT_ID_FORMAT = vk::Format::eR32Uint;      // R32, Uint, 4 BPP
+
+		///
+		/// @brief Object ID of pixels not covered by any drawcall, see `VisibilityId` in shaders
+		///
+		static constexpr uint32_t INVALID_OBJECT_ID = 0xFFFFFFFF;
 
 		///
 		/// @brief Create a deferred attachment with given extent
 		///
 		/// @param context Vulkan context
-		/// @param extent Attachment extent
+		/// @param extent Attachment extent, also the capacity
+		/// @param view_count Views rendered at once, one layer each
 		/// @return Created attachment or error
 		///
 		[[nodiscard]]
 		static std::expected<DeferredAttachment, Error> create(
 			const vulkan::Context& context,
-			glm::u32vec2 extent
+			glm::u32vec2 extent,
+			uint32_t view_count = 1
 		) noexcept;
 
 		///
@@ -47,7 +62,9 @@ namespace render
 		struct View
 		{
 			glm::u32vec2 extent;
-			vulkan::AttachmentView albedo, normal, pbr, depth;
+			vulkan::AttachmentView albedo, normal, pbr, depth, velocity;
+			vulkan::AttachmentView object_id;  // Packed drawcall of each pixel, see `ObjectPickPipeline`
+			uint32_t view_count = 1;
 
 			const View* operator->() const noexcept { return this; }
 		};
@@ -60,28 +77,64 @@ namespace render
 				.normal = normal,
 				.pbr = pbr,
 				.depth = depth,
+				.velocity = velocity,
+				.object_id = object_id,
+				.view_count = view_count,
 			};
 		}
 
 		View operator->() const noexcept { return *this; }
 
+		///
+		/// @brief Check whether the attachment can hold a given extent without reallocation
+		///
+		/// @param extent Requested extent
+		/// @return `true` if @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual(extent, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle of @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = extent;
+		}
+
 	  private:
 
 		glm::u32vec2 extent;
-		vulkan::Attachment albedo, normal, pbr, depth;
+		glm::u32vec2 capacity;
+		uint32_t view_count;
+		vulkan::Attachment albedo, normal, pbr, depth, velocity, object_id;
 
 		explicit DeferredAttachment(
 			glm::u32vec2 extent,
+			uint32_t view_count,
 			vulkan::Attachment albedo,
 			vulkan::Attachment normal,
 			vulkan::Attachment pbr,
-			vulkan::Attachment depth
+			vulkan::Attachment depth,
+			vulkan::Attachment velocity,
+			vulkan::Attachment object_id
 		) :
 			extent(extent),
+			capacity(extent),
+			view_count(view_count),
 			albedo(std::move(albedo)),
 			normal(std::move(normal)),
 			pbr(std::move(pbr)),
-			depth(std::move(depth))
+			depth(std::move(depth)),
+			velocity(std::move(velocity)),
+			object_id(std::move(object_id))
 		{}
 
 	  public:
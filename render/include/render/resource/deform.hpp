@@ -0,0 +1,87 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/model/deform-list.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/container/device/dyn-buffer.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Per-frame deformation resource
+	/// @details Holds the joint matrices and morph weights of the frame, see `DeformList::Parameters`,
+	/// uploaded by host through a `vulkan::UploadRing`, or written in place if
+	/// `vulkan::Allocator::supports_direct_upload`
+	///
+	class DeformResource
+	{
+	  public:
+
+		///
+		/// @brief Create a deform resource, buffers are allocated on first `update`
+		///
+		/// @param context Vulkan context
+		///
+		explicit DeformResource(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Write new parameters in place, or schedule their upload into @p upload_ring
+		///
+		/// @param context Vulkan context
+		/// @param upload_ring Upload ring of the current frame
+		/// @param parameters Parameters of the frame, see `DeformList::compute_parameters`
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> update(
+			const vulkan::Context& context,
+			vulkan::UploadRing& upload_ring,
+			const DeformList::Parameters& parameters
+		) noexcept;
+
+		struct Ref
+		{
+			vulkan::ArrayBufferRef<glm::mat4> joint_matrices;
+			vulkan::ArrayBufferRef<float> morph_weights;
+
+			const Ref* operator->() const noexcept { return this; }
+		};
+
+		///
+		/// @brief Get references to the buffers
+		///
+		/// @return References
+		///
+		[[nodiscard]]
+		Ref ref() const noexcept
+		{
+			return Ref{
+				.joint_matrices = joint_matrix_buffer,
+				.morph_weights = morph_weight_buffer,
+			};
+		}
+
+		Ref operator->() const noexcept { return ref(); }
+
+	  private:
+
+		bool direct_upload;  // Whether the buffers are written in place by host
+		vulkan::DynArrayBuffer<glm::mat4> joint_matrix_buffer;
+		vulkan::DynArrayBuffer<float> morph_weight_buffer;
+
+	  public:
+
+		DeformResource(const DeformResource&) = delete;
+		DeformResource(DeformResource&&) = default;
+		DeformResource& operator=(const DeformResource&) = delete;
+		DeformResource& operator=(DeformResource&&) = default;
+	};
+}
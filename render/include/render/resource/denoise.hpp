@@ -0,0 +1,152 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Denoise attachment, intermediates and history of the spatiotemporal denoiser for one signal
+	/// @details
+	/// - All images are RGBA16F. Color images hold the signal in RGB and its luminance variance in A.
+	/// - `history` holds the output of the first wavelet iteration, fed back as the color history of the next
+	/// frame
+	/// - `moments` holds the first and second moments of the luminance, the history length and the view
+	/// distance of the surface the texel was denoised for, `0` for background
+	/// - `filtered` is the ping-pong pair of the wavelet iterations, see `output`
+	/// - Texel `p` covers pixel `p * downscale` of the deferred attachment, matching signals traced at
+	/// reduced resolution
+	/// - Written by `DenoisePipeline` in `eGeneral` layout, and sampled in the same layout
+	/// - The images may be larger than the extent in use (see @p set_extent), only the top-left `extent`
+	/// sub-rectangle is written
+	///
+	class DenoiseAttachment
+	{
+	  public:
+
+		static constexpr auto DENOISE_FORMAT = vk::Format::eR16G16B16A16Sfloat;  // RGBA16, Float, 8 BPP
+
+		// Count of wavelet iterations, with step sizes of 1, 2, 4, ... texels
+		static constexpr uint32_t WAVELET_ITERATIONS = 5;
+
+		///
+		/// @brief Create a denoise attachment
+		///
+		/// @param context Vulkan context
+		/// @param extent Extent of the deferred attachment, determines the capacity
+		/// @param downscale Ratio from @p extent to the extent of the signal (rounded up), at least 1
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<DenoiseAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent,
+			uint32_t downscale = 1
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;  // Extent of the signal
+			uint32_t downscale;   // Ratio from the deferred attachment extent to the extent
+			vulkan::AttachmentView history;
+			vulkan::AttachmentView moments;
+			std::array<vulkan::AttachmentView, 2> filtered;
+
+			const View* operator->() const noexcept { return this; }
+
+			///
+			/// @brief Get the denoised signal, the last of `filtered` written by the wavelet iterations
+			///
+			/// @return View of the denoised signal, in `eGeneral` layout after `DenoisePipeline::compute`
+			///
+			[[nodiscard]]
+			vulkan::AttachmentView output() const noexcept
+			{
+				return filtered[WAVELET_ITERATIONS % 2];
+			}
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.downscale = downscale,
+				.history = history,
+				.moments = moments,
+				.filtered = {filtered[0], filtered[1]},
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the attachment can serve a given deferred attachment extent without
+		/// reallocation
+		///
+		/// @param extent Requested extent of the deferred attachment
+		/// @return `true` if the signal extent of @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual((extent + downscale - 1u) / downscale, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle needed by @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent of the deferred attachment
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = (extent + downscale - 1u) / downscale;
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		uint32_t downscale;
+		vulkan::Attachment history;
+		vulkan::Attachment moments;
+		std::array<vulkan::Attachment, 2> filtered;
+
+		explicit DenoiseAttachment(
+			glm::u32vec2 extent,
+			uint32_t downscale,
+			vulkan::Attachment history,
+			vulkan::Attachment moments,
+			std::array<vulkan::Attachment, 2> filtered
+		) :
+			extent(extent),
+			capacity(extent),
+			downscale(downscale),
+			history(std::move(history)),
+			moments(std::move(moments)),
+			filtered(std::move(filtered))
+		{}
+
+	  public:
+
+		DenoiseAttachment(const DenoiseAttachment&) = delete;
+		DenoiseAttachment(DenoiseAttachment&&) = default;
+		DenoiseAttachment& operator=(const DenoiseAttachment&) = delete;
+		DenoiseAttachment& operator=(DenoiseAttachment&&) = default;
+	};
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Image-based lighting of an environment map, precomputed on the GPU
+	/// @details
+	/// - The equirectangular map is resampled into a source cubemap with mipmaps, which the other terms
+	/// are computed from. None of them is touched per frame, ambient lighting takes a few fetches per pixel.
+	/// - Diffuse irradiance is stored as 9 SH coefficients (RGB, W unused), convolved with the clamped
+	/// cosine and divided by pi, see `eval_irradiance` in `environment.slang`
+	/// - Specular radiance is prefiltered into a cubemap mip chain, level `i` at roughness
+	/// `i / (SPECULAR_LEVELS - 1)`
+	/// - The split-sum BRDF LUT holds the scale and bias to `F0`, indexed by `n_dot_v` and roughness
+	/// - Everything is computed on the main queue before `create` returns. Create a new instance when the
+	/// environment changes, and retire the old one once the frames in flight are done with it.
+	/// - Images are left in `eShaderReadOnlyOptimal` layout
+	///
+	class EnvironmentLighting
+	{
+	  public:
+
+		using EquirectImage = image::Image<image::Format::Float32, image::Layout::RGBA>;
+
+		static constexpr auto SPECULAR_FORMAT = vk::Format::eR16G16B16A16Sfloat;  // RGBA16, Float, 8 BPP
+		static constexpr auto BRDF_LUT_FORMAT = vk::Format::eR16G16Sfloat;         // RG16, Float, 4 BPP
+
+		static constexpr uint32_t SOURCE_SIZE = 256;         // Face side of the source cubemap
+		static constexpr uint32_t SPECULAR_SIZE = 128;       // Face side of the specular cubemap at level 0
+		static constexpr uint32_t SPECULAR_LEVELS = 6;       // Must match `environment.slang`
+		static constexpr uint32_t BRDF_LUT_SIZE = 128;       // Must match `environment.slang`
+		static constexpr uint32_t SH_COEFFICIENT_COUNT = 9;  // Must match `environment.slang`
+		static constexpr uint32_t SH_SOURCE_LEVEL = 3;       // Level of the source cubemap projected to SH
+
+		// Width the equirectangular map is worth decoding at, as hint of `image::Image::decode`
+		static constexpr uint32_t EQUIRECT_DECODE_SIZE = SOURCE_SIZE * 4;
+
+		///
+		/// @brief Create the environment lighting of an equirectangular map
+		///
+		/// @param context Vulkan context
+		/// @param equirect Linear HDR radiance in equirectangular projection, Y up and `-Z` at the center
+		/// @return Created environment lighting or error
+		///
+		[[nodiscard]]
+		static std::expected<EnvironmentLighting, Error> create(
+			const vulkan::Context& context,
+			const EquirectImage& equirect
+		) noexcept;
+
+		///
+		/// @brief Create the environment lighting of a uniform radiance, e.g. as placeholder when no
+		/// environment map is given
+		///
+		/// @param context Vulkan context
+		/// @param radiance Radiance from all directions
+		/// @return Created environment lighting or error
+		///
+		[[nodiscard]]
+		static std::expected<EnvironmentLighting, Error> create_uniform(
+			const vulkan::Context& context,
+			glm::vec3 radiance
+		) noexcept;
+
+		///
+		/// @brief View of the environment lighting
+		///
+		struct View
+		{
+			vulkan::ArrayBufferRef<glm::vec4> irradiance_sh;
+			vk::ImageView specular;  // Cube view of all levels
+			vk::ImageView brdf_lut;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.irradiance_sh = irradiance_sh,
+				.specular = specular_view,
+				.brdf_lut = brdf_lut_view,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+	  private:
+
+		vulkan::ArrayBuffer<glm::vec4> irradiance_sh;
+		vulkan::Image specular;
+		vk::raii::ImageView specular_view;
+		vulkan::Image brdf_lut;
+		vk::raii::ImageView brdf_lut_view;
+
+		explicit EnvironmentLighting(
+			vulkan::ArrayBuffer<glm::vec4> irradiance_sh,
+			vulkan::Image specular,
+			vk::raii::ImageView specular_view,
+			vulkan::Image brdf_lut,
+			vk::raii::ImageView brdf_lut_view
+		) :
+			irradiance_sh(std::move(irradiance_sh)),
+			specular(std::move(specular)),
+			specular_view(std::move(specular_view)),
+			brdf_lut(std::move(brdf_lut)),
+			brdf_lut_view(std::move(brdf_lut_view))
+		{}
+
+	  public:
+
+		EnvironmentLighting(const EnvironmentLighting&) = delete;
+		EnvironmentLighting(EnvironmentLighting&&) = default;
+		EnvironmentLighting& operator=(const EnvironmentLighting&) = delete;
+		EnvironmentLighting& operator=(EnvironmentLighting&&) = default;
+	};
+}
+
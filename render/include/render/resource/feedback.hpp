@@ -0,0 +1,156 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Host-readable feedback of texture usage, written by the deferred pass
+	/// @details Holds two counters per material, indexed the same as the material info buffer (default
+	/// material at index 0). The deferred pass accumulates covered pixels of each material into the first
+	/// half, and the finest texture resolution each material is sampled at into the second half. The host
+	/// reads them back after the frame completes to prioritize texture streaming and pick the streamed
+	/// resolutions, see `TextureStreamer`.
+	///
+	class TextureFeedbackResource
+	{
+	  public:
+
+		TextureFeedbackResource() = default;
+
+		///
+		/// @brief Feedback read back from a frame
+		///
+		struct Feedback
+		{
+			// Covered pixels of each material
+			std::vector<uint32_t> material_usage;
+
+			// `log2` of the finest texture resolution each material is sampled at, plus one. `0` if the
+			// material is not on screen
+			std::vector<uint32_t> material_resolution;
+		};
+
+		///
+		/// @brief Resize the feedback buffer, counters are cleared if the buffer is recreated
+		///
+		/// @param context Vulkan context
+		/// @param material_count Count of materials, excluding the default material
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> resize(const vulkan::Context& context, size_t material_count) noexcept;
+
+		///
+		/// @brief Read the counters and clear them for the next use
+		/// @warning The frame writing this resource must have completed
+		///
+		/// @return Feedback of each material, or error
+		///
+		[[nodiscard]]
+		std::expected<Feedback, Error> read_and_clear() const noexcept;
+
+		///
+		/// @brief Get reference to the feedback buffer
+		///
+		/// @return Reference to the feedback buffer
+		///
+		[[nodiscard]]
+		vulkan::ArrayBufferRef<uint32_t> ref() const noexcept
+		{
+			ASSUME(buffer.has_value());
+			return *buffer;
+		}
+
+		operator vulkan::ArrayBufferRef<uint32_t>() const noexcept { return ref(); }
+
+	  private:
+
+		std::optional<vulkan::ArrayBuffer<uint32_t>> buffer = std::nullopt;
+
+	  public:
+
+		TextureFeedbackResource(const TextureFeedbackResource&) = delete;
+		TextureFeedbackResource(TextureFeedbackResource&&) = default;
+		TextureFeedbackResource& operator=(const TextureFeedbackResource&) = delete;
+		TextureFeedbackResource& operator=(TextureFeedbackResource&&) = default;
+	};
+
+	///
+	/// @brief Host-readable feedback of geometry usage, written by the indirect pipeline
+	/// @details Holds the largest projected size of each primitive among its visible instances, indexed the
+	/// same as the primitive attribute buffer. The host reads them back after the frame completes to pick
+	/// the primitives streamed in at full detail, see `GeometryStreamer`.
+	///
+	class GeometryFeedbackResource
+	{
+	  public:
+
+		GeometryFeedbackResource() = default;
+
+		///
+		/// @brief Feedback read back from a frame
+		///
+		struct Feedback
+		{
+			// Largest projected size of each primitive in NDC units, see `IndirectPipeline::compute`. `0` if
+			// the primitive is not visible
+			std::vector<float> primitive_size;
+		};
+
+		///
+		/// @brief Resize the feedback buffer, sizes are cleared if the buffer is recreated
+		///
+		/// @param context Vulkan context
+		/// @param primitive_count Count of primitives
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> resize(const vulkan::Context& context, size_t primitive_count) noexcept;
+
+		///
+		/// @brief Read the sizes and clear them for the next use
+		/// @warning The frame writing this resource must have completed
+		///
+		/// @return Feedback of each primitive, or error
+		///
+		[[nodiscard]]
+		std::expected<Feedback, Error> read_and_clear() const noexcept;
+
+		///
+		/// @brief Get reference to the feedback buffer
+		///
+		/// @return Reference to the feedback buffer, one bit-casted `float` per primitive
+		///
+		[[nodiscard]]
+		vulkan::ArrayBufferRef<uint32_t> ref() const noexcept
+		{
+			ASSUME(buffer.has_value());
+			return *buffer;
+		}
+
+		operator vulkan::ArrayBufferRef<uint32_t>() const noexcept { return ref(); }
+
+	  private:
+
+		std::optional<vulkan::ArrayBuffer<uint32_t>> buffer = std::nullopt;
+
+	  public:
+
+		GeometryFeedbackResource(const GeometryFeedbackResource&) = delete;
+		GeometryFeedbackResource(GeometryFeedbackResource&&) = default;
+		GeometryFeedbackResource& operator=(const GeometryFeedbackResource&) = delete;
+		GeometryFeedbackResource& operator=(GeometryFeedbackResource&&) = default;
+	};
+}
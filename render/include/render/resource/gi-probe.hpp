@@ -0,0 +1,190 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/model/model.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint3_sized.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <span>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Probe volume of the dynamic diffuse global illumination, a regular grid of irradiance probes
+	/// covering the scene
+	/// @details
+	/// - Each probe stores the irradiance and the mean and mean squared distance to the surrounding
+	/// geometry, both over the sphere of directions in octahedral tiles of an atlas. Tiles have a border of
+	/// one texel, mirrored from the opposite edge, so that bilinear filtering wraps across the octahedron.
+	/// - Tile of probe `(x, y, z)` is at `(x + y * count.x, z)` in both atlases
+	/// - Irradiance tiles take 8x8 texels of 8 bytes. RGB is the cosine-weighted mean radiance around the
+	/// direction, A is `1` once the probe has been traced, `0` before.
+	/// - Distance tiles take 16x16 texels of 4 bytes, distances are relative to `1.5 * length(spacing)`
+	/// - The ray buffer holds the radiance and hit distance of the probe rays traced in a frame
+	/// - Shared by the frames in flight, as they execute in submission order on the same queue. Cleared to
+	/// untraced and left in `eGeneral` layout on creation, read and written in the same layout afterwards.
+	///
+	class GiProbeVolume
+	{
+	  public:
+
+		static constexpr auto IRRADIANCE_FORMAT = vk::Format::eR16G16B16A16Sfloat;  // RGBA16, Float, 8 BPP
+		static constexpr auto DISTANCE_FORMAT = vk::Format::eR16G16Sfloat;          // RG16, Float, 4 BPP
+
+		// Sides of the tiles including the border, must match `gi-probe.slang`
+		static constexpr uint32_t IRRADIANCE_TILE_SIZE = 8;
+		static constexpr uint32_t DISTANCE_TILE_SIZE = 16;
+
+		///
+		/// @brief Placement of the probes in the layout of `GiProbeGrid` in `gi-probe.slang`, W unused
+		///
+		struct GridConstant
+		{
+			glm::vec4 origin;
+			glm::vec4 spacing;
+			glm::u32vec4 count;
+		};
+
+		///
+		/// @brief Placement of the probes
+		///
+		struct Grid
+		{
+			glm::vec3 origin;    // Position of probe `(0, 0, 0)`
+			glm::vec3 spacing;   // Distance between neighboring probes along each axis
+			glm::u32vec3 count;  // Count of probes along each axis, at least 2
+
+			[[nodiscard]]
+			uint32_t probe_count() const noexcept
+			{
+				return count.x * count.y * count.z;
+			}
+
+			[[nodiscard]]
+			GridConstant get_constant() const noexcept
+			{
+				return {
+					.origin = glm::vec4(origin, 0.0),
+					.spacing = glm::vec4(spacing, 0.0),
+					.count = glm::u32vec4(count, 0),
+				};
+			}
+
+			bool operator==(const Grid&) const noexcept = default;
+		};
+
+		///
+		/// @brief Fit a grid of uniformly spaced probes to the bounds of a model
+		/// @details The longest axis of the bounds gets @p max_count probes, the other axes as many as
+		/// needed to cover the bounds at the same spacing. Probes on the outer faces lie on the bounds.
+		///
+		/// @param model Model instance
+		/// @param transforms World transforms of the nodes, see `Hierarchy::compute_transforms`
+		/// @param max_count Max count of probes along an axis, at least 2
+		/// @return Fitted grid, a unit cube at the origin if the model has no geometry
+		///
+		[[nodiscard]]
+		static Grid fit_grid(
+			const Model& model,
+			std::span<const glm::mat4> transforms,
+			uint32_t max_count
+		) noexcept;
+
+		///
+		/// @brief Create a probe volume
+		///
+		/// @param context Vulkan context
+		/// @param grid Placement of the probes
+		/// @param ray_capacity Max count of probe rays traced in a frame
+		/// @return Created probe volume, or error if the atlases exceed the device limit
+		///
+		[[nodiscard]]
+		static std::expected<GiProbeVolume, Error> create(
+			const vulkan::Context& context,
+			const Grid& grid,
+			uint32_t ray_capacity
+		) noexcept;
+
+		///
+		/// @brief View of the probe volume
+		///
+		struct View
+		{
+			Grid grid;
+			uint32_t ray_capacity;
+			vulkan::AttachmentView irradiance;
+			vulkan::AttachmentView distance;
+			vulkan::ArrayBufferRef<glm::vec4> rays;  // RGB: radiance, A: hit distance, negative for backfaces
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.grid = grid,
+				.ray_capacity = ray_capacity,
+				.irradiance = irradiance,
+				.distance = distance,
+				.rays = rays,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Get the extent of an atlas
+		///
+		/// @param grid Placement of the probes
+		/// @param tile_size Side of a tile, `IRRADIANCE_TILE_SIZE` or `DISTANCE_TILE_SIZE`
+		/// @return Extent of the atlas in texels
+		///
+		[[nodiscard]]
+		static glm::u32vec2 atlas_extent(const Grid& grid, uint32_t tile_size) noexcept
+		{
+			return glm::u32vec2(grid.count.x * grid.count.y, grid.count.z) * tile_size;
+		}
+
+	  private:
+
+		Grid grid;
+		uint32_t ray_capacity;
+		vulkan::Attachment irradiance;
+		vulkan::Attachment distance;
+		vulkan::ArrayBuffer<glm::vec4> rays;
+
+		explicit GiProbeVolume(
+			const Grid& grid,
+			uint32_t ray_capacity,
+			vulkan::Attachment irradiance,
+			vulkan::Attachment distance,
+			vulkan::ArrayBuffer<glm::vec4> rays
+		) :
+			grid(grid),
+			ray_capacity(ray_capacity),
+			irradiance(std::move(irradiance)),
+			distance(std::move(distance)),
+			rays(std::move(rays))
+		{}
+
+	  public:
+
+		GiProbeVolume(const GiProbeVolume&) = delete;
+		GiProbeVolume(GiProbeVolume&&) = default;
+		GiProbeVolume& operator=(const GiProbeVolume&) = delete;
+		GiProbeVolume& operator=(GiProbeVolume&&) = default;
+	};
+}
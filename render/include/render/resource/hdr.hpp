@@ -5,17 +5,24 @@
 #include "vulkan/interface/attachment.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
 #include <libassert/assert.hpp>
 #include <utility>
 #include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
 
 namespace render
 {
 	///
 	/// @brief Generic HDR attachment
-	/// @details Each pixel takes 8 bytes of storage
+	/// @details
+	/// - Each pixel takes 8 bytes of storage, or 4 bytes in `PACKED_HDR_FORMAT`
+	/// - The image may be larger than the extent in use (see @p set_extent), only the top-left `extent`
+	/// sub-rectangle is rendered
+	/// - With more than one view, the image has one layer per view, see `DeferredAttachment`
 	///
 	class HdrAttachment
 	{
@@ -23,17 +30,38 @@ namespace render
 
 		static constexpr auto HDR_FORMAT = vk::Format::eR16G16B16A16Sfloat;
 
+		// Packed alternative halving the bandwidth, without alpha and negative values. Alpha is unused past
+		// the G-buffer pass. Pipelines writing the attachment must be created with the same format.
+		static constexpr auto PACKED_HDR_FORMAT = vk::Format::eB10G11R11UfloatPack32;
+
+		///
+		/// @brief Check whether a device can render to and store into the HDR attachment in a format
 		///
-		/// @brief Create a deferred attachment with given extent
+		/// @param phy_device Physical device
+		/// @param format `HDR_FORMAT` or `PACKED_HDR_FORMAT`
+		/// @return `true` if the format supports blended color attachments, storage and linear filtering
+		///
+		[[nodiscard]]
+		static bool is_format_supported(
+			const vk::raii::PhysicalDevice& phy_device,
+			vk::Format format
+		) noexcept;
+
+		///
+		/// @brief Create a HDR attachment with given extent
 		///
 		/// @param context Vulkan context
-		/// @param extent Attachment extent
+		/// @param extent Attachment extent, also the capacity
+		/// @param view_count Views rendered at once, one layer each
+		/// @param format `HDR_FORMAT` or `PACKED_HDR_FORMAT`
 		/// @return Created attachment or error
 		///
 		[[nodiscard]]
 		static std::expected<HdrAttachment, Error> create(
 			const vulkan::Context& context,
-			glm::u32vec2 extent
+			glm::u32vec2 extent,
+			uint32_t view_count = 1,
+			vk::Format format = HDR_FORMAT
 		) noexcept;
 
 		///
@@ -43,6 +71,7 @@ namespace render
 		{
 			glm::u32vec2 extent;
 			vulkan::AttachmentView attachment;
+			uint32_t view_count = 1;
 
 			const View* operator->() const noexcept { return this; }
 		};
@@ -52,18 +81,76 @@ namespace render
 			return {
 				.extent = extent,
 				.attachment = attachment,
+				.view_count = view_count,
 			};
 		}
 
 		View operator->() const noexcept { return *this; }
 
+		///
+		/// @brief Check whether the attachment can hold a given extent without reallocation
+		///
+		/// @param extent Requested extent
+		/// @return `true` if @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual(extent, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle of @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = extent;
+		}
+
+		///
+		/// @brief Get the allocated extent of the attachment
+		///
+		/// @return Allocated extent, never smaller than the extent in use
+		///
+		[[nodiscard]]
+		glm::u32vec2 capacity_extent() const noexcept
+		{
+			return capacity;
+		}
+
+		///
+		/// @brief Get the format of the attachment
+		///
+		/// @return `HDR_FORMAT` or `PACKED_HDR_FORMAT`
+		///
+		[[nodiscard]]
+		vk::Format format() const noexcept
+		{
+			return image_format;
+		}
+
 	  private:
 
 		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		uint32_t view_count;
+		vk::Format image_format;
 		vulkan::Attachment attachment;
 
-		explicit HdrAttachment(glm::u32vec2 extent, vulkan::Attachment attachment) :
+		explicit HdrAttachment(
+			glm::u32vec2 extent,
+			uint32_t view_count,
+			vk::Format image_format,
+			vulkan::Attachment attachment
+		) :
 			extent(extent),
+			capacity(extent),
+			view_count(view_count),
+			image_format(image_format),
 			attachment(std::move(attachment))
 		{}
 
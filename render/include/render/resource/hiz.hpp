@@ -0,0 +1,134 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Hierarchical-Z (depth pyramid) attachment, used for occlusion culling
+	/// @details
+	/// - Level 0 has the same extent as the depth attachment, each following level is half of the previous
+	/// level (rounded up), so that every texel conservatively covers its footprint in the upper level
+	/// - Each texel stores the farthest depth (minimum, as reverse-Z is used) of its footprint
+	/// - The image is always kept in `eGeneral` layout after being built
+	/// - The image may be larger than the extent in use (see @p set_extent), levels are then built from the
+	/// top-left sub-rectangle only and `level_extent` reports the extents in use
+	///
+	class HizAttachment
+	{
+	  public:
+
+		static constexpr auto HIZ_FORMAT = vk::Format::eR32Sfloat;  // R32, Float, 4 BPP
+		static constexpr uint32_t MAX_LEVELS = 16;
+
+		///
+		/// @brief Create a HiZ attachment with given extent
+		///
+		/// @param context Vulkan context
+		/// @param extent Extent of the depth attachment, also the capacity
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<HizAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;
+			uint32_t level_count;
+			vk::Image image;
+			vk::ImageView full_view;                             // View of all levels
+			std::array<vk::ImageView, MAX_LEVELS> level_views;  // Views of each single level
+
+			const View* operator->() const noexcept { return this; }
+
+			///
+			/// @brief Get extent of a given level
+			///
+			/// @param level Level index
+			/// @return Extent of the level
+			///
+			[[nodiscard]]
+			glm::u32vec2 level_extent(uint32_t level) const noexcept
+			{
+				auto size = extent;
+				for (uint32_t i = 0; i < level; i++) size = glm::max((size + 1u) / 2u, glm::u32vec2(1));
+				return size;
+			}
+		};
+
+		operator View() const noexcept;
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the attachment can hold a given extent without reallocation
+		///
+		/// @param extent Requested extent of the depth attachment
+		/// @return `true` if @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual(extent, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle of @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent of the depth attachment
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = extent;
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		vulkan::Image image;
+		vk::raii::ImageView full_view;
+		std::vector<vk::raii::ImageView> level_views;
+
+		explicit HizAttachment(
+			glm::u32vec2 extent,
+			vulkan::Image image,
+			vk::raii::ImageView full_view,
+			std::vector<vk::raii::ImageView> level_views
+		) :
+			extent(extent),
+			capacity(extent),
+			image(std::move(image)),
+			full_view(std::move(full_view)),
+			level_views(std::move(level_views))
+		{}
+
+	  public:
+
+		HizAttachment(const HizAttachment&) = delete;
+		HizAttachment(HizAttachment&&) = default;
+		HizAttachment& operator=(const HizAttachment&) = delete;
+		HizAttachment& operator=(HizAttachment&&) = default;
+	};
+}
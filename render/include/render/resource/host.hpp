@@ -4,16 +4,13 @@
 #include "render/interface/auto-exposure.hpp"
 #include "render/interface/camera.hpp"
 #include "render/interface/direct-light.hpp"
-#include "render/interface/primitive-drawcall.hpp"
-#include "render/util/per-render-state.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
-#include "vulkan/container/device/staged-buffer.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
 #include "vulkan/interface/context.hpp"
 
-#include <array>
 #include <expected>
-#include <glm/ext/matrix_float4x4.hpp>
-#include <span>
+#include <optional>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -22,6 +19,12 @@ namespace render
 {
 	///
 	/// @brief Resources for parameters uploaded from host
+	/// @details The buffers are device-local, their contents are uploaded every frame through a
+	/// `vulkan::UploadRing`, or written in place if `vulkan::Allocator::supports_direct_upload`
+	///
+	/// The camera can be late-latched: it is written into a host-visible buffer, either the camera buffer
+	/// itself or a staging buffer copied on the GPU by `record`, so that `latch_camera` may overwrite it
+	/// right before the command buffer is submitted
 	///
 	class HostParamResource
 	{
@@ -37,8 +40,10 @@ namespace render
 		static std::expected<HostParamResource, Error> create(const vulkan::Context& context) noexcept;
 
 		///
-		/// @brief Update the resource with new data without actually uploading to GPU
+		/// @brief Write new data in place, or schedule its upload into @p upload_ring
 		///
+		/// @param context Vulkan context
+		/// @param upload_ring Upload ring of the current frame
 		/// @param camera Camera data
 		/// @param exposure_param Exposure parameters
 		/// @param primary_light Primary light parameters
@@ -46,21 +51,29 @@ namespace render
 		///
 		[[nodiscard]]
 		std::expected<void, Error> update(
+			const vulkan::Context& context,
+			vulkan::UploadRing& upload_ring,
 			const Camera& camera,
 			const ExposureParam& exposure_param,
 			const DirectLight& primary_light
 		) noexcept;
 
 		///
-		/// @brief Upload the data to GPU
+		/// @brief Overwrite the camera written by the last `update`
+		/// @note Call before the command buffer recorded with this resource is submitted
 		///
-		/// @param command_buffer Command buffer
-		/// @return Buffer memory barriers for the uploaded buffers
+		/// @param camera Camera data
+		/// @return `void` if success, or error
 		///
 		[[nodiscard]]
-		std::array<vk::BufferMemoryBarrier2, 3> upload(
-			const vk::raii::CommandBuffer& command_buffer
-		) const noexcept;
+		std::expected<void, Error> latch_camera(const Camera& camera) const noexcept;
+
+		///
+		/// @brief Record the copy of the latched camera and its barrier, if the camera is staged
+		///
+		/// @param command_buffer Command buffer, before any pass reading the camera
+		///
+		void record(const vk::raii::CommandBuffer& command_buffer) const noexcept;
 
 		struct Ref
 		{
@@ -95,18 +108,26 @@ namespace render
 
 	  private:
 
-		vulkan::StagedBuffer<Camera> camera;
-		vulkan::StagedBuffer<ExposureParam> exposure_param;
-		vulkan::StagedBuffer<DirectLight> primary_light;
+		vulkan::ElementBuffer<Camera> camera;
+		vulkan::ElementBuffer<ExposureParam> exposure_param;
+		vulkan::ElementBuffer<DirectLight> primary_light;
+		bool direct_upload;  // Whether the buffers are written in place by host
+
+		// Host-visible copy source of the camera, copied by `record`. Empty with direct upload
+		std::optional<vulkan::ElementBuffer<Camera>> camera_staging;
 
 		explicit HostParamResource(
-			vulkan::StagedBuffer<Camera> camera,
-			vulkan::StagedBuffer<ExposureParam> exposure_param,
-			vulkan::StagedBuffer<DirectLight> primary_light
+			vulkan::ElementBuffer<Camera> camera,
+			vulkan::ElementBuffer<ExposureParam> exposure_param,
+			vulkan::ElementBuffer<DirectLight> primary_light,
+			bool direct_upload,
+			std::optional<vulkan::ElementBuffer<Camera>> camera_staging
 		) :
 			camera(std::move(camera)),
 			exposure_param(std::move(exposure_param)),
-			primary_light(std::move(primary_light))
+			primary_light(std::move(primary_light)),
+			direct_upload(direct_upload),
+			camera_staging(std::move(camera_staging))
 		{}
 
 	  public:
@@ -116,78 +137,4 @@ namespace render
 		HostParamResource& operator=(const HostParamResource&) = delete;
 		HostParamResource& operator=(HostParamResource&&) = default;
 	};
-
-	///
-	/// @brief Resources for storing drawcalls uploaded by host
-	///
-	class HostDrawcallResource
-	{
-	  public:
-
-		HostDrawcallResource() = default;
-
-		///
-		/// @brief Update the resource with new data without actually uploading to GPU
-		///
-		/// @param context Vulkan context
-		/// @param primitive_drawcalls Primitive drawcalls
-		/// @param transforms Transforms
-		/// @return `void` if success, or error
-		///
-		[[nodiscard]]
-		std::expected<void, Error> update(
-			const vulkan::Context& context,
-			PerRenderState<std::span<const PrimitiveDrawcall>> primitive_drawcalls,
-			std::span<const glm::mat4> transforms
-		) noexcept;
-
-		///
-		/// @brief Upload to GPU
-		///
-		/// @param command_buffer Command buffer
-		/// @return Array of memory barriers for the buffers
-		///
-		[[nodiscard]]
-		std::array<vk::BufferMemoryBarrier2, 5> upload(
-			const vk::raii::CommandBuffer& command_buffer
-		) const noexcept;
-
-		struct Ref
-		{
-			// Transform matrices buffer
-			vulkan::ArrayBufferRef<glm::mat4> transform;
-
-			// Primitive drawcall buffers
-			PerRenderState<vulkan::ArrayBufferRef<PrimitiveDrawcall>> primitive_drawcalls;
-
-			const Ref* operator->() const noexcept { return this; }
-		};
-
-		Ref operator->() const noexcept
-		{
-			return Ref{
-				.transform = transform_buffer,
-				.primitive_drawcalls =
-					primitive_drawcall_buffers.to<vulkan::ArrayBufferRef<PrimitiveDrawcall>>(),
-			};
-		}
-
-	  private:
-
-		vulkan::DynArrayStagedBuffer<glm::mat4> transform_buffer = vulkan::DynArrayStagedBuffer<glm::mat4>(
-			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst
-		);
-
-		PerRenderState<vulkan::DynArrayStagedBuffer<PrimitiveDrawcall>> primitive_drawcall_buffers =
-			PerRenderState<vulkan::DynArrayStagedBuffer<PrimitiveDrawcall>>::from_args(
-				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst
-			);
-
-	  public:
-
-		HostDrawcallResource(const HostDrawcallResource&) = delete;
-		HostDrawcallResource(HostDrawcallResource&&) = default;
-		HostDrawcallResource& operator=(const HostDrawcallResource&) = delete;
-		HostDrawcallResource& operator=(HostDrawcallResource&&) = default;
-	};
 }
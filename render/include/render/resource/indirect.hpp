@@ -1,26 +1,73 @@
 #pragma once
 
 #include "common/util/error.hpp"
+#include "render/interface/cull-view.hpp"
+#include "render/interface/impostor.hpp"
 #include "render/interface/indirect-drawcall.hpp"
 #include "render/util/per-render-state.hpp"
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
 #include "vulkan/container/device/dyn-buffer.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
 #include "vulkan/interface/context.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <expected>
+#include <optional>
+#include <span>
 #include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
 
 namespace render
 {
+	///
+	/// @brief Phase of the two-phase occlusion culling
+	///
+	enum class DrawPhase
+	{
+		Early,  // Drawcalls visible against previous frame's HiZ
+		Late    // Drawcalls occluded in early phase but visible against current frame's HiZ
+	};
+
 	///
 	/// @brief Indirect drawcall resource
+	/// @details Holds the compacted indirect drawcall stream and the draw counts for each render state. Only
+	/// visible drawcalls are appended to the stream, the draw counts are consumed by
+	/// `drawIndexedIndirectCount`.
+	///
+	/// Each indirect buffer holds `2 * drawcall_count` entries: The first half is for @p DrawPhase::Early and
+	/// the second half is for @p DrawPhase::Late. Use `phase_capacity()` and `phase_offset()` to locate them.
+	///
+	/// Visible drawcalls of the same primitive and level of detail are placed consecutively, and drawn by a
+	/// single instanced command from the command buffers, laid out in phases like the indirect buffers. The
+	/// command counts are also in the draw count buffers.
+	///
+	/// Additional views (see `CullView`) are culled in the same early phase dispatch as the main camera, each
+	/// drawcall is loaded once and tested against every view. Their streams are in the view buffers, view
+	/// `i` takes `drawcall_count` entries and commands starting at `view_offset()`, and its counts are the
+	/// early phase fields of the `IndirectCount` at index `i + 1` of the draw count buffers.
+	///
+	/// The bounds buffers hold the world-space bounds of each drawcall (see `DrawcallBounds`), written by
+	/// the early phase and reused by the additional views and the late phase.
+	///
+	/// The sort buffers hold the nearest view depth of each instance group and a histogram of
+	/// `SORT_BUCKET_COUNT` depth buckets per phase, used to order the commands front to back.
+	///
+	/// The impostor buffers hold the nodes drawn as impostors by the main camera, appended in the early phase
+	/// across all render states, and the single non-indexed command drawing them, see `ImpostorPipeline`.
+	///
+	/// The counts of the main camera can be copied into a host-readable stat buffer after the late phase,
+	/// see `record_stat_copy()`, and read back once the frame completes with `read_stat()`.
 	///
 	class IndirectResource
 	{
 	  public:
 
+		// Count of depth buckets of the front-to-back command sort, for a single phase
+		static constexpr uint32_t SORT_BUCKET_COUNT = 256;
+
 		IndirectResource() = default;
 
 		///
@@ -28,14 +75,63 @@ namespace render
 		///
 		/// @param context Vulkan context
 		/// @param drawcall_counts Element count of drawcalls
+		/// @param primitive_count Primitive count of the model, drawcalls are grouped into instances by their
+		/// primitives
+		/// @param view_count Count of additional views, see `upload_views()`
 		/// @return `void` if success, or error
 		///
 		[[nodiscard]]
 		std::expected<void, Error> resize(
 			const vulkan::Context& context,
-			render::PerRenderState<size_t> drawcall_counts
+			render::PerRenderState<size_t> drawcall_counts,
+			size_t primitive_count,
+			uint32_t view_count = 0
 		) noexcept;
 
+		///
+		/// @brief Schedule the upload of the additional views into @p upload_ring
+		///
+		/// @param context Vulkan context
+		/// @param upload_ring Upload ring of the current frame
+		/// @param views Additional views, must hold the view count passed to `resize()`
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> upload_views(
+			const vulkan::Context& context,
+			vulkan::UploadRing& upload_ring,
+			std::span<const CullView> views
+		) noexcept;
+
+		///
+		/// @brief Copy the counts of the main camera into the stat buffer
+		/// @details Records a barrier from the late phase compute, the copy, and a barrier to host read.
+		/// Record it after the late phase `IndirectPipeline::compute`.
+		///
+		/// @param command_buffer Command buffer
+		///
+		void record_stat_copy(const vk::raii::CommandBuffer& command_buffer) const noexcept;
+
+		///
+		/// @brief Read the counts of the main camera copied by `record_stat_copy()`
+		/// @warning The frame writing this resource must have completed
+		///
+		/// @return Counts of each render state, zeroed if nothing has been copied yet, or error
+		///
+		[[nodiscard]]
+		std::expected<PerRenderState<IndirectCount>, Error> read_stat() const noexcept;
+
+		///
+		/// @brief Get the count of additional views
+		///
+		/// @return Count of additional views
+		///
+		[[nodiscard]]
+		uint32_t view_count() const noexcept
+		{
+			return static_cast<uint32_t>(view_buffer.count());
+		}
+
 		///
 		/// @brief Get references to the buffer
 		///
@@ -49,6 +145,234 @@ namespace render
 
 		operator PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>>() const noexcept { return ref(); }
 
+		///
+		/// @brief Get references to the draw count buffers, each holding one `IndirectCount` for the main
+		/// camera followed by one for each additional view
+		///
+		/// @return References to the draw count buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ElementBufferRef<IndirectCount>> count_ref() const noexcept
+		{
+			return draw_count_buffers.map([](const auto& buffer) {
+				return vulkan::ElementBufferRef<IndirectCount>(static_cast<vk::Buffer>(buffer));
+			});
+		}
+
+		///
+		/// @brief Get references to the late-phase candidate buffers, holding indices into the primitive
+		/// drawcalls
+		///
+		/// @return References to the candidate buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<uint32_t>> candidate_ref() const noexcept
+		{
+			return late_candidate_buffers.to<vulkan::ArrayBufferRef<uint32_t>>();
+		}
+
+		///
+		/// @brief Get references to the instanced command buffers, laid out in phases like the indirect
+		/// buffers
+		///
+		/// @return References to the command buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>> command_ref() const noexcept
+		{
+			return command_buffers.to<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>>();
+		}
+
+		///
+		/// @brief Get references to the instance group buffers, holding the instance counts and then the
+		/// first indirect entries of each primitive and level of detail, for both phases
+		///
+		/// @return References to the instance group buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<uint32_t>> group_ref() const noexcept
+		{
+			return instance_group_buffers.to<vulkan::ArrayBufferRef<uint32_t>>();
+		}
+
+		///
+		/// @brief Get references to the instance state buffers, holding the group of each culled drawcall
+		/// for the main camera and then for each additional view
+		///
+		/// @return References to the instance state buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<uint32_t>> state_ref() const noexcept
+		{
+			return instance_state_buffers.to<vulkan::ArrayBufferRef<uint32_t>>();
+		}
+
+		///
+		/// @brief Get references to the group depth buffers, holding the nearest view depth of each instance
+		/// group, laid out in phases like the instance group buffers
+		///
+		/// @return References to the group depth buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<uint32_t>> group_depth_ref() const noexcept
+		{
+			return group_depth_buffers.to<vulkan::ArrayBufferRef<uint32_t>>();
+		}
+
+		///
+		/// @brief Get references to the sort bucket buffers, holding `SORT_BUCKET_COUNT` depth buckets for
+		/// each phase
+		///
+		/// @return References to the sort bucket buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<uint32_t>> sort_bucket_ref() const noexcept
+		{
+			return sort_bucket_buffers.to<vulkan::ArrayBufferRef<uint32_t>>();
+		}
+
+		///
+		/// @brief Get references to the bounds buffers, holding the world-space bounds of each drawcall
+		///
+		/// @return References to the bounds buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<DrawcallBounds>> bounds_ref() const noexcept
+		{
+			return bounds_buffers.to<vulkan::ArrayBufferRef<DrawcallBounds>>();
+		}
+
+		///
+		/// @brief Get a reference to the additional view buffer
+		///
+		/// @return Reference to the view buffer
+		///
+		[[nodiscard]]
+		vulkan::ArrayBufferRef<CullView> view_ref() const noexcept
+		{
+			return view_buffer;
+		}
+
+		///
+		/// @brief Get references to the indirect buffers of the additional views, laid out in views
+		///
+		/// @return References to the view indirect buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<IndirectDrawcall>> view_indirect_ref() const noexcept
+		{
+			return view_indirect_drawcall_buffers.to<vulkan::ArrayBufferRef<IndirectDrawcall>>();
+		}
+
+		///
+		/// @brief Get references to the instanced command buffers of the additional views, laid out in views
+		///
+		/// @return References to the view command buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>>
+		view_command_ref() const noexcept
+		{
+			return view_command_buffers.to<vulkan::ArrayBufferRef<vk::DrawIndexedIndirectCommand>>();
+		}
+
+		///
+		/// @brief Get references to the instance group buffers of the additional views, laid out in views
+		///
+		/// @return References to the view instance group buffers
+		///
+		[[nodiscard]]
+		PerRenderState<vulkan::ArrayBufferRef<uint32_t>> view_group_ref() const noexcept
+		{
+			return view_instance_group_buffers.to<vulkan::ArrayBufferRef<uint32_t>>();
+		}
+
+		///
+		/// @brief Get a reference to the impostor instance buffer, holding the nodes drawn as impostors
+		///
+		/// @return Reference to the impostor instance buffer
+		///
+		[[nodiscard]]
+		vulkan::ArrayBufferRef<ImpostorInstance> impostor_instance_ref() const noexcept
+		{
+			return impostor_instance_buffer;
+		}
+
+		///
+		/// @brief Get a reference to the impostor command buffer, holding one command drawing a quad for
+		/// each impostor instance
+		///
+		/// @return Reference to the impostor command buffer
+		///
+		[[nodiscard]]
+		vulkan::ArrayBufferRef<vk::DrawIndirectCommand> impostor_command_ref() const noexcept
+		{
+			return impostor_command_buffer;
+		}
+
+		///
+		/// @brief Get the offset of the first entry of an additional view in a view indirect or command
+		/// buffer, in entries
+		///
+		/// @param buffer Indirect buffer of the same render state, acquired from `ref()`
+		/// @param view Index of the additional view
+		/// @return Offset in entries
+		///
+		[[nodiscard]]
+		static size_t view_offset(vulkan::ArrayBufferRef<IndirectDrawcall> buffer, uint32_t view) noexcept
+		{
+			return view * phase_capacity(buffer);
+		}
+
+		///
+		/// @brief Get the byte offset of the counts of an additional view in a draw count buffer
+		///
+		/// @param view Index of the additional view
+		/// @return Offset in bytes
+		///
+		[[nodiscard]]
+		static size_t view_count_offset(uint32_t view) noexcept
+		{
+			return (view + 1) * sizeof(IndirectCount);
+		}
+
+		///
+		/// @brief Get the instance group count of a single phase in an instance group buffer
+		///
+		/// @param buffer Instance group buffer acquired from `group_ref()`
+		/// @return Instance group count of a single phase
+		///
+		[[nodiscard]]
+		static size_t group_count(vulkan::ArrayBufferRef<uint32_t> buffer) noexcept
+		{
+			return buffer.count() / 2;
+		}
+
+		///
+		/// @brief Get the drawcall capacity of a single phase in an indirect buffer
+		///
+		/// @param buffer Indirect buffer acquired from `ref()`
+		/// @return Maximum drawcall count of a single phase
+		///
+		[[nodiscard]]
+		static size_t phase_capacity(vulkan::ArrayBufferRef<IndirectDrawcall> buffer) noexcept
+		{
+			return buffer.count() / 2;
+		}
+
+		///
+		/// @brief Get the offset of the first entry of a phase in an indirect buffer, in entries
+		///
+		/// @param buffer Indirect buffer acquired from `ref()`
+		/// @param phase Draw phase
+		/// @return Offset in entries
+		///
+		[[nodiscard]]
+		static size_t phase_offset(vulkan::ArrayBufferRef<IndirectDrawcall> buffer, DrawPhase phase) noexcept
+		{
+			return phase == DrawPhase::Early ? 0 : phase_capacity(buffer);
+		}
+
 	  private:
 
 		PerRenderState<vulkan::DynArrayBuffer<IndirectDrawcall>> indirect_drawcall_buffers =
@@ -57,6 +381,97 @@ namespace render
 				vulkan::MemoryUsage::GpuOnly
 			);
 
+		PerRenderState<vulkan::DynArrayBuffer<IndirectCount>> draw_count_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<IndirectCount>>::from_args(
+				vk::BufferUsageFlagBits::eIndirectBuffer
+					| vk::BufferUsageFlagBits::eStorageBuffer
+					| vk::BufferUsageFlagBits::eTransferSrc
+					| vk::BufferUsageFlagBits::eTransferDst,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		// Host-readable copy of the main camera counts, one for each render state
+		std::optional<vulkan::ArrayBuffer<IndirectCount>> stat_buffer = std::nullopt;
+
+		PerRenderState<vulkan::DynArrayBuffer<uint32_t>> late_candidate_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<uint32_t>>::from_args(
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		PerRenderState<vulkan::DynArrayBuffer<vk::DrawIndexedIndirectCommand>> command_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<vk::DrawIndexedIndirectCommand>>::from_args(
+				vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		PerRenderState<vulkan::DynArrayBuffer<uint32_t>> instance_group_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<uint32_t>>::from_args(
+				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		PerRenderState<vulkan::DynArrayBuffer<uint32_t>> instance_state_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<uint32_t>>::from_args(
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		PerRenderState<vulkan::DynArrayBuffer<uint32_t>> group_depth_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<uint32_t>>::from_args(
+				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		PerRenderState<vulkan::DynArrayBuffer<uint32_t>> sort_bucket_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<uint32_t>>::from_args(
+				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		PerRenderState<vulkan::DynArrayBuffer<DrawcallBounds>> bounds_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<DrawcallBounds>>::from_args(
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		vulkan::DynArrayBuffer<CullView> view_buffer = vulkan::DynArrayBuffer<CullView>(
+			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+			vulkan::MemoryUsage::GpuOnly
+		);
+
+		PerRenderState<vulkan::DynArrayBuffer<IndirectDrawcall>> view_indirect_drawcall_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<IndirectDrawcall>>::from_args(
+				vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		PerRenderState<vulkan::DynArrayBuffer<vk::DrawIndexedIndirectCommand>> view_command_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<vk::DrawIndexedIndirectCommand>>::from_args(
+				vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		PerRenderState<vulkan::DynArrayBuffer<uint32_t>> view_instance_group_buffers =
+			PerRenderState<vulkan::DynArrayBuffer<uint32_t>>::from_args(
+				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		vulkan::DynArrayBuffer<ImpostorInstance> impostor_instance_buffer =
+			vulkan::DynArrayBuffer<ImpostorInstance>(
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
+		vulkan::DynArrayBuffer<vk::DrawIndirectCommand> impostor_command_buffer =
+			vulkan::DynArrayBuffer<vk::DrawIndirectCommand>(
+				vk::BufferUsageFlagBits::eIndirectBuffer
+					| vk::BufferUsageFlagBits::eStorageBuffer
+					| vk::BufferUsageFlagBits::eTransferDst,
+				vulkan::MemoryUsage::GpuOnly
+			);
+
 	  public:
 
 		IndirectResource(const IndirectResource&) = delete;
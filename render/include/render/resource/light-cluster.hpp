@@ -0,0 +1,123 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/internal/light-cluster.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+
+namespace render
+{
+	///
+	/// @brief Light cluster grid, lists the punctual lights affecting each froxel of the screen
+	/// @details
+	/// - The screen is divided into tiles of `LIGHT_CLUSTER_TILE_SIZE` pixels, each tile is further divided
+	/// into `LIGHT_CLUSTER_SLICE_COUNT` exponential depth slices. See `light-cluster.slang` for the slicing.
+	/// - Each cluster owns a fixed slot of `LIGHT_CLUSTER_MAX_LIGHTS` light indices, so that the grid can be
+	/// filled without a global counter
+	/// - Written by `LightClusterPipeline` and read by `DirectLightingPipeline`
+	/// - The buffers may hold more tiles than in use (see @p set_extent), clusters are then indexed with the
+	/// tile count in use
+	///
+	class LightClusterAttachment
+	{
+	  public:
+
+		///
+		/// @brief Create a light cluster grid
+		///
+		/// @param context Vulkan context
+		/// @param extent Extent of the deferred attachment, determines the capacity
+		/// @return Created grid or error
+		///
+		[[nodiscard]]
+		static std::expected<LightClusterAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the grid
+		///
+		struct View
+		{
+			glm::u32vec2 tile_count;                        // Number of tiles in each direction
+			vulkan::ArrayBufferRef<uint32_t> light_counts;   // Light count of each cluster
+			vulkan::ArrayBufferRef<uint32_t> light_indices;  // `LIGHT_CLUSTER_MAX_LIGHTS` slots per cluster
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.tile_count = tile_count,
+				.light_counts = light_counts,
+				.light_indices = light_indices,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the grid can serve a given deferred attachment extent without reallocation
+		///
+		/// @param extent Requested extent of the deferred attachment
+		/// @return `true` if the tile count of @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual(calc_tile_count(extent), tile_capacity));
+		}
+
+		///
+		/// @brief Use only the tiles needed by @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent of the deferred attachment
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			tile_count = calc_tile_count(extent);
+		}
+
+	  private:
+
+		glm::u32vec2 tile_count;
+		glm::u32vec2 tile_capacity;
+		vulkan::ArrayBuffer<uint32_t> light_counts;
+		vulkan::ArrayBuffer<uint32_t> light_indices;
+
+		static glm::u32vec2 calc_tile_count(glm::u32vec2 extent) noexcept
+		{
+			return (extent + LIGHT_CLUSTER_TILE_SIZE - 1u) / LIGHT_CLUSTER_TILE_SIZE;
+		}
+
+		explicit LightClusterAttachment(
+			glm::u32vec2 tile_count,
+			vulkan::ArrayBuffer<uint32_t> light_counts,
+			vulkan::ArrayBuffer<uint32_t> light_indices
+		) :
+			tile_count(tile_count),
+			tile_capacity(tile_count),
+			light_counts(std::move(light_counts)),
+			light_indices(std::move(light_indices))
+		{}
+
+	  public:
+
+		LightClusterAttachment(const LightClusterAttachment&) = delete;
+		LightClusterAttachment(LightClusterAttachment&&) = default;
+		LightClusterAttachment& operator=(const LightClusterAttachment&) = delete;
+		LightClusterAttachment& operator=(LightClusterAttachment&&) = default;
+	};
+}
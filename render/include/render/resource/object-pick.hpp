@@ -0,0 +1,61 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/primitive-drawcall.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <utility>
+
+namespace render
+{
+	///
+	/// @brief Result of an object pick, written by `ObjectPickPipeline`
+	/// @details Holds the drawcall covering the picked pixel, or `PrimitiveDrawcall::HIDDEN` in both indices
+	/// if no pickable drawcall covers it. The host reads the result back asynchronously, e.g. through
+	/// `vulkan::ReadbackRing`.
+	///
+	class ObjectPickResource
+	{
+	  public:
+
+		///
+		/// @brief Create the object pick resource
+		///
+		/// @param context Vulkan context
+		/// @return Created object pick resource or error
+		///
+		[[nodiscard]]
+		static std::expected<ObjectPickResource, Error> create(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Get reference to the result buffer, with storage and transfer source usages
+		///
+		/// @return Reference to the result buffer
+		///
+		[[nodiscard]]
+		vulkan::ElementBufferRef<PrimitiveDrawcall> ref() const noexcept
+		{
+			return result_buffer;
+		}
+
+		operator vulkan::ElementBufferRef<PrimitiveDrawcall>() const noexcept { return ref(); }
+
+	  private:
+
+		vulkan::ElementBuffer<PrimitiveDrawcall> result_buffer;
+
+		explicit ObjectPickResource(vulkan::ElementBuffer<PrimitiveDrawcall> result_buffer) :
+			result_buffer(std::move(result_buffer))
+		{}
+
+	  public:
+
+		ObjectPickResource(const ObjectPickResource&) = delete;
+		ObjectPickResource(ObjectPickResource&&) = default;
+		ObjectPickResource& operator=(const ObjectPickResource&) = delete;
+		ObjectPickResource& operator=(ObjectPickResource&&) = default;
+	};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Overlay layer attachment, holding UI drawn once and blended over several frames
+	/// @details
+	/// - Holds premultiplied color, as produced by drawing with straight alpha blending over a transparent
+	/// clear, see `OverlayPipeline`
+	/// - Created with the format of the target image, so that the drawing pipelines of the target (e.g.
+	/// ImGui) also draw into the layer
+	///
+	class OverlayAttachment
+	{
+	  public:
+
+		///
+		/// @brief Create an overlay attachment
+		///
+		/// @param context Vulkan context
+		/// @param extent Attachment extent, same as the target image
+		/// @param format Format of the target image
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<OverlayAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent,
+			vk::Format format
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;
+			vulkan::AttachmentView attachment;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.attachment = attachment,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+	  private:
+
+		glm::u32vec2 extent;
+		vulkan::Attachment attachment;
+
+		explicit OverlayAttachment(glm::u32vec2 extent, vulkan::Attachment attachment) :
+			extent(extent),
+			attachment(std::move(attachment))
+		{}
+
+	  public:
+
+		OverlayAttachment(const OverlayAttachment&) = delete;
+		OverlayAttachment(OverlayAttachment&&) = default;
+		OverlayAttachment& operator=(const OverlayAttachment&) = delete;
+		OverlayAttachment& operator=(OverlayAttachment&&) = default;
+	};
+}
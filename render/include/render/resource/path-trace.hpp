@@ -0,0 +1,81 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Accumulation attachment of the path tracer
+	/// @details
+	/// - Each pixel takes 16 bytes of storage, the sum of the traced radiance in RGB and the count of
+	/// accumulated samples in A, all in full precision
+	/// - Read and written in place by the path tracing pipeline in `eGeneral` layout, frames accumulate into
+	/// the same attachment in submission order
+	/// - Allocated at exactly the render extent, as any change of the extent restarts the accumulation
+	///
+	class PathTraceAttachment
+	{
+	  public:
+
+		static constexpr auto ACCUMULATION_FORMAT = vk::Format::eR32G32B32A32Sfloat;  // RGBA32, Float, 16 BPP
+
+		///
+		/// @brief Create a path trace accumulation attachment
+		///
+		/// @param context Vulkan context
+		/// @param extent Attachment extent, same as the HDR attachment in use
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<PathTraceAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;
+			vulkan::AttachmentView accumulation;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.accumulation = accumulation,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+	  private:
+
+		glm::u32vec2 extent;
+		vulkan::Attachment accumulation;
+
+		explicit PathTraceAttachment(glm::u32vec2 extent, vulkan::Attachment accumulation) :
+			extent(extent),
+			accumulation(std::move(accumulation))
+		{}
+
+	  public:
+
+		PathTraceAttachment(const PathTraceAttachment&) = delete;
+		PathTraceAttachment(PathTraceAttachment&&) = default;
+		PathTraceAttachment& operator=(const PathTraceAttachment&) = delete;
+		PathTraceAttachment& operator=(PathTraceAttachment&&) = default;
+	};
+}
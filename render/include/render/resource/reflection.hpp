@@ -0,0 +1,132 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Reflection attachment, noisy glossy reflections at half resolution and their tile list
+	/// @details
+	/// - The signal takes 8 bytes per texel, the reflected radiance in RGB, and in A `1` for texels traced
+	/// on a glossy surface, `0` otherwise. Untraced texels hold zero radiance.
+	/// - Texel `p` holds the reflection of pixel `p * DOWNSCALE` of the deferred attachment
+	/// - The tile list holds the indirect dispatch arguments of the trace pass in its first 3 elements,
+	/// followed by the tiles of `TILE_SIZE` texels holding glossy pixels, packed as `x | y << 16`
+	/// - Written by the reflection pipeline in `eGeneral` layout, then denoised by `DenoisePipeline`
+	/// - The signal may be larger than the extent in use (see @p set_extent), only the top-left `extent`
+	/// sub-rectangle is written
+	///
+	class ReflectionAttachment
+	{
+	  public:
+
+		static constexpr auto SIGNAL_FORMAT = vk::Format::eR16G16B16A16Sfloat;  // RGBA16, Float, 8 BPP
+
+		static constexpr uint32_t DOWNSCALE = 2;  // Each texel covers 2x2 pixels
+		static constexpr uint32_t TILE_SIZE = 8;  // Side of a tile in texels, also the workgroup size
+
+		// Elements before the tiles in the tile list, the `vk::DispatchIndirectCommand` of the trace pass
+		static constexpr uint32_t TILE_LIST_HEADER = 3;
+
+		///
+		/// @brief Create a reflection attachment
+		///
+		/// @param context Vulkan context
+		/// @param extent Extent of the deferred attachment, determines the capacity
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<ReflectionAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;  // Extent of the signal
+			uint32_t downscale;   // Ratio from the deferred attachment extent to the extent
+			vulkan::AttachmentView signal;
+			vulkan::ArrayBufferRef<uint32_t> tile_list;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.downscale = DOWNSCALE,
+				.signal = signal,
+				.tile_list = tile_list,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the attachment can serve a given deferred attachment extent without
+		/// reallocation
+		///
+		/// @param extent Requested extent of the deferred attachment
+		/// @return `true` if the signal extent of @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual((extent + DOWNSCALE - 1u) / DOWNSCALE, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle needed by @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent of the deferred attachment
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = (extent + DOWNSCALE - 1u) / DOWNSCALE;
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		vulkan::Attachment signal;
+		vulkan::ArrayBuffer<uint32_t> tile_list;
+
+		explicit ReflectionAttachment(
+			glm::u32vec2 extent,
+			vulkan::Attachment signal,
+			vulkan::ArrayBuffer<uint32_t> tile_list
+		) :
+			extent(extent),
+			capacity(extent),
+			signal(std::move(signal)),
+			tile_list(std::move(tile_list))
+		{}
+
+	  public:
+
+		ReflectionAttachment(const ReflectionAttachment&) = delete;
+		ReflectionAttachment(ReflectionAttachment&&) = default;
+		ReflectionAttachment& operator=(const ReflectionAttachment&) = delete;
+		ReflectionAttachment& operator=(ReflectionAttachment&&) = default;
+	};
+}
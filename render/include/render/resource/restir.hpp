@@ -0,0 +1,134 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+
+namespace render
+{
+	///
+	/// @brief ReSTIR attachment, light sample reservoirs of each pixel
+	/// @details
+	/// - Holds one `Reservoir` per pixel of the deferred attachment, in row-major order with a stride of
+	/// the extent in use
+	/// - `reservoirs` holds the reservoirs after spatial reuse and shading, reused temporally by the next
+	/// frame. `intermediate` holds the reservoirs after temporal reuse, read by the spatial reuse of the
+	/// same frame.
+	/// - Written and read by `RestirPipeline` in compute shaders only
+	/// - The buffers may hold more pixels than in use (see @p set_extent), reservoirs are then indexed with
+	/// the extent in use, which invalidates the previous content
+	///
+	class RestirAttachment
+	{
+	  public:
+
+		///
+		/// @brief Reservoir of a pixel, same layout as `Reservoir` in `restir.slang`
+		///
+		struct Reservoir
+		{
+			glm::vec2 barycentrics;     // Weights of the 2nd and 3rd vertex of a sampled triangle
+			uint32_t light;             // Sampled light, `0xFFFFFFFF` if empty, see `restir.slang`
+			float contribution_weight;  // Unbiased contribution weight of the sample
+			float sample_count;         // Candidates the reservoir has seen, `M` in the literature
+			float view_distance;        // Distance from the camera to the pixel, to validate reuse
+			uint32_t normal;            // Octahedral normal of the pixel packed as 2 FP16
+			uint32_t padding;
+		};
+
+		///
+		/// @brief Create a ReSTIR attachment
+		///
+		/// @param context Vulkan context
+		/// @param extent Extent of the deferred attachment, also the capacity
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<RestirAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;
+			vulkan::ArrayBufferRef<Reservoir> reservoirs;
+			vulkan::ArrayBufferRef<Reservoir> intermediate;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.reservoirs = reservoirs,
+				.intermediate = intermediate,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the attachment can serve a given deferred attachment extent without
+		/// reallocation
+		///
+		/// @param extent Requested extent of the deferred attachment
+		/// @return `true` if @p extent holds at most as many pixels as the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual(extent, capacity));
+		}
+
+		///
+		/// @brief Use only the pixels needed by @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent of the deferred attachment
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = extent;
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		vulkan::ArrayBuffer<Reservoir> reservoirs;
+		vulkan::ArrayBuffer<Reservoir> intermediate;
+
+		explicit RestirAttachment(
+			glm::u32vec2 extent,
+			vulkan::ArrayBuffer<Reservoir> reservoirs,
+			vulkan::ArrayBuffer<Reservoir> intermediate
+		) :
+			extent(extent),
+			capacity(extent),
+			reservoirs(std::move(reservoirs)),
+			intermediate(std::move(intermediate))
+		{}
+
+	  public:
+
+		RestirAttachment(const RestirAttachment&) = delete;
+		RestirAttachment(RestirAttachment&&) = default;
+		RestirAttachment& operator=(const RestirAttachment&) = delete;
+		RestirAttachment& operator=(RestirAttachment&&) = default;
+	};
+}
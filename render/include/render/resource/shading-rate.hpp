@@ -0,0 +1,132 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Shading rate image, the coarse shading rate of each tile of the screen
+	/// @details
+	/// - Each texel covers `tile_size` pixels of the deferred attachment and holds the rate in the encoding
+	/// of `VK_KHR_fragment_shading_rate`, `(log2(width) << 2) | log2(height)`, at most 2x2
+	/// - Written by `ShadingRatePipeline`, consumed by the G-buffer and fragment lighting passes as a
+	/// fragment shading rate attachment, and read by the compute lighting pass as a storage image
+	/// - Kept in `eGeneral` layout
+	/// - The image may be larger than the extent in use (see @p set_extent), only the top-left tiles are
+	/// written
+	///
+	class ShadingRateAttachment
+	{
+	  public:
+
+		static constexpr auto SHADING_RATE_FORMAT = vk::Format::eR8Uint;  // R8, Uint, 1 BPP
+
+		// Preferred tile size, clamped into the texel size range supported by the device
+		static constexpr uint32_t PREFERRED_TILE_SIZE = 16;
+
+		///
+		/// @brief Create a shading rate image
+		///
+		/// @param context Vulkan context, the image is usable as a fragment shading rate attachment only if
+		/// the `fragment_shading_rate` feature is enabled
+		/// @param extent Extent of the deferred attachment, determines the capacity
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<ShadingRateAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;      // Extent of the deferred attachment covered
+			glm::u32vec2 tile_size;   // Pixels covered by each texel
+			glm::u32vec2 tile_count;  // Number of tiles in use in each direction
+			vulkan::AttachmentView attachment;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.tile_size = tile_size,
+				.tile_count = calc_tile_count(extent),
+				.attachment = attachment,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the image can serve a given deferred attachment extent without reallocation
+		///
+		/// @param extent Requested extent of the deferred attachment
+		/// @return `true` if the tile count of @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual(calc_tile_count(extent), tile_capacity));
+		}
+
+		///
+		/// @brief Use only the tiles needed by @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent of the deferred attachment
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = extent;
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 tile_size;
+		glm::u32vec2 tile_capacity;
+		vulkan::Attachment attachment;
+
+		glm::u32vec2 calc_tile_count(glm::u32vec2 extent) const noexcept
+		{
+			return (extent + tile_size - 1u) / tile_size;
+		}
+
+		explicit ShadingRateAttachment(
+			glm::u32vec2 extent,
+			glm::u32vec2 tile_size,
+			glm::u32vec2 tile_capacity,
+			vulkan::Attachment attachment
+		) :
+			extent(extent),
+			tile_size(tile_size),
+			tile_capacity(tile_capacity),
+			attachment(std::move(attachment))
+		{}
+
+	  public:
+
+		ShadingRateAttachment(const ShadingRateAttachment&) = delete;
+		ShadingRateAttachment(ShadingRateAttachment&&) = default;
+		ShadingRateAttachment& operator=(const ShadingRateAttachment&) = delete;
+		ShadingRateAttachment& operator=(ShadingRateAttachment&&) = default;
+	};
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Shadow mask attachment, visibility of the primary light per pixel
+	/// @details
+	/// - Each texel takes 1 byte of storage, `1` for lit and `0` for shadowed
+	/// - At half resolution, texel `p` holds the visibility of pixel `p * 2` of the deferred attachment
+	/// - Written by the shadow pipeline in `eGeneral` layout, and sampled in the same layout
+	/// - The image may be larger than the extent in use (see @p set_extent), only the top-left `extent`
+	/// sub-rectangle is written
+	///
+	class ShadowMaskAttachment
+	{
+	  public:
+
+		static constexpr auto SHADOW_MASK_FORMAT = vk::Format::eR8Unorm;  // R8, Unorm, 1 BPP
+
+		///
+		/// @brief Create a shadow mask attachment
+		///
+		/// @param context Vulkan context
+		/// @param extent Extent of the deferred attachment, determines the capacity
+		/// @param half_resolution Whether to create the mask at half of @p extent (rounded up)
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<ShadowMaskAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent,
+			bool half_resolution
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;  // Extent of the mask itself
+			uint32_t downscale;   // Ratio from the deferred attachment extent to the mask extent, 1 or 2
+			vulkan::AttachmentView attachment;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.downscale = downscale,
+				.attachment = attachment,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the mask can serve a given deferred attachment extent without reallocation
+		///
+		/// @param extent Requested extent of the deferred attachment
+		/// @return `true` if the mask extent of @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual((extent + downscale - 1u) / downscale, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle needed by @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent of the deferred attachment
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = (extent + downscale - 1u) / downscale;
+		}
+
+		///
+		/// @brief Check whether the mask is traced at half resolution
+		///
+		/// @return `true` if each mask texel covers 2x2 pixels
+		///
+		[[nodiscard]]
+		bool half_resolution() const noexcept
+		{
+			return downscale == 2;
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		uint32_t downscale;
+		vulkan::Attachment attachment;
+
+		explicit ShadowMaskAttachment(
+			glm::u32vec2 extent,
+			uint32_t downscale,
+			vulkan::Attachment attachment
+		) :
+			extent(extent),
+			capacity(extent),
+			downscale(downscale),
+			attachment(std::move(attachment))
+		{}
+
+	  public:
+
+		ShadowMaskAttachment(const ShadowMaskAttachment&) = delete;
+		ShadowMaskAttachment(ShadowMaskAttachment&&) = default;
+		ShadowMaskAttachment& operator=(const ShadowMaskAttachment&) = delete;
+		ShadowMaskAttachment& operator=(ShadowMaskAttachment&&) = default;
+	};
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Temporally resolved HDR attachment
+	/// @details
+	/// - Each pixel takes 8 bytes of storage
+	/// - Output of the TAA pipeline of a frame, and history of the next frame
+	/// - Written by the TAA pipeline in `eGeneral` layout, and sampled in the same layout
+	///
+	class TaaAttachment
+	{
+	  public:
+
+		static constexpr auto TAA_FORMAT = vk::Format::eR16G16B16A16Sfloat;  // RGBA16, Float, 8 BPP
+
+		///
+		/// @brief Create a TAA attachment with given extent
+		///
+		/// @param context Vulkan context
+		/// @param extent Attachment extent
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<TaaAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;
+			vulkan::AttachmentView attachment;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.attachment = attachment,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+	  private:
+
+		glm::u32vec2 extent;
+		vulkan::Attachment attachment;
+
+		explicit TaaAttachment(glm::u32vec2 extent, vulkan::Attachment attachment) :
+			extent(extent),
+			attachment(std::move(attachment))
+		{}
+
+	  public:
+
+		TaaAttachment(const TaaAttachment&) = delete;
+		TaaAttachment(TaaAttachment&&) = default;
+		TaaAttachment& operator=(const TaaAttachment&) = delete;
+		TaaAttachment& operator=(TaaAttachment&&) = default;
+	};
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "render/interface/node-transform.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/container/device/dyn-buffer.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <span>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Per-frame node transform resource
+	/// @details
+	/// - Holds the dirty local transform updates uploaded by host through a `vulkan::UploadRing`, or written
+	/// in place if `vulkan::Allocator::supports_direct_upload`. The host only uploads changed nodes instead
+	/// of the whole hierarchy
+	/// - Holds the world transforms computed by `TransformPipeline`
+	///
+	class TransformResource
+	{
+	  public:
+
+		///
+		/// @brief Create a transform resource, buffers are allocated on first `update`
+		///
+		/// @param context Vulkan context
+		///
+		explicit TransformResource(const vulkan::Context& context) noexcept;
+
+		///
+		/// @brief Write new data in place, or schedule its upload into @p upload_ring
+		///
+		/// @param context Vulkan context
+		/// @param upload_ring Upload ring of the current frame
+		/// @param deletion_queue Deletion queue retiring a replaced world transform buffer, which the next
+		/// frame still reads as its previous transforms
+		/// @param node_count Total node count of the hierarchy
+		/// @param updates Dirty local transform updates, at most one update per node
+		/// @param root_transform Transform applied to the root node in addition to its own transform
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> update(
+			const vulkan::Context& context,
+			vulkan::UploadRing& upload_ring,
+			vulkan::DeletionQueue& deletion_queue,
+			size_t node_count,
+			std::span<const NodeTransformUpdate> updates,
+			const glm::mat4& root_transform
+		) noexcept;
+
+		struct Ref
+		{
+			// Dirty local transform updates
+			vulkan::ArrayBufferRef<NodeTransformUpdate> updates;
+
+			// World transform of each node, computed on GPU
+			vulkan::ArrayBufferRef<glm::mat4> world_transform;
+
+			// Transform applied to the root node
+			glm::mat4 root_transform;
+
+			const Ref* operator->() const noexcept { return this; }
+		};
+
+		///
+		/// @brief Get references to the buffers
+		///
+		/// @return References
+		///
+		[[nodiscard]]
+		Ref ref() const noexcept
+		{
+			return Ref{
+				.updates = update_buffer,
+				.world_transform = world_transform_buffer,
+				.root_transform = root_transform,
+			};
+		}
+
+		Ref operator->() const noexcept { return ref(); }
+
+	  private:
+
+		bool direct_upload;  // Whether the update buffer is written in place by host
+		vulkan::DynArrayBuffer<NodeTransformUpdate> update_buffer;
+
+		vulkan::DynArrayBuffer<glm::mat4> world_transform_buffer = vulkan::DynArrayBuffer<glm::mat4>(
+			vk::BufferUsageFlagBits::eStorageBuffer,
+			vulkan::MemoryUsage::GpuOnly
+		);
+
+		glm::mat4 root_transform = glm::mat4(1.0f);
+
+	  public:
+
+		TransformResource(const TransformResource&) = delete;
+		TransformResource(TransformResource&&) = default;
+		TransformResource& operator=(const TransformResource&) = delete;
+		TransformResource& operator=(TransformResource&&) = default;
+	};
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Weighted blended order-independent transparency attachment
+	/// @details
+	/// - Each pixel takes 10 bytes of storage
+	/// - See transparent pipeline for detailed layout
+	/// - The images may be larger than the extent in use (see @p set_extent), only the top-left `extent`
+	/// sub-rectangle is rendered
+	///
+	class TransparentAttachment
+	{
+	  public:
+
+		static constexpr auto ACCUMULATION_FORMAT = vk::Format::eR16G16B16A16Sfloat;  // RGBA16, Float, 8 BPP
+		static constexpr auto REVEALAGE_FORMAT = vk::Format::eR16Sfloat;              // R16, Float, 2 BPP
+
+		///
+		/// @brief Create a transparent attachment with given extent
+		///
+		/// @param context Vulkan context
+		/// @param extent Attachment extent, also the capacity
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<TransparentAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;
+			vulkan::AttachmentView accumulation, revealage;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.accumulation = accumulation,
+				.revealage = revealage,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the attachment can hold a given extent without reallocation
+		///
+		/// @param extent Requested extent
+		/// @return `true` if @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual(extent, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle of @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = extent;
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		vulkan::Attachment accumulation, revealage;
+
+		explicit TransparentAttachment(
+			glm::u32vec2 extent,
+			vulkan::Attachment accumulation,
+			vulkan::Attachment revealage
+		) :
+			extent(extent),
+			capacity(extent),
+			accumulation(std::move(accumulation)),
+			revealage(std::move(revealage))
+		{}
+
+	  public:
+
+		TransparentAttachment(const TransparentAttachment&) = delete;
+		TransparentAttachment(TransparentAttachment&&) = default;
+		TransparentAttachment& operator=(const TransparentAttachment&) = delete;
+		TransparentAttachment& operator=(TransparentAttachment&&) = default;
+	};
+}
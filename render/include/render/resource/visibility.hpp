@@ -0,0 +1,111 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <libassert/assert.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	///
+	/// @brief Visibility buffer attachment, see `VisibilityPipeline`
+	/// @details
+	/// - Each pixel takes 8 bytes of storage
+	/// - The image may be larger than the extent in use (see @p set_extent), only the top-left `extent`
+	/// sub-rectangle is rendered
+	///
+	class VisibilityAttachment
+	{
+	  public:
+
+		static constexpr auto VISIBILITY_FORMAT = vk::Format::eR32G32Uint;  // RG32, Uint, 8 BPP
+
+		// First word of pixels not covered by geometry, must match `VisibilityId::INVALID` in shaders
+		static constexpr uint32_t INVALID_ID = 0xFFFFFFFF;
+
+		///
+		/// @brief Create a visibility attachment with given extent
+		///
+		/// @param context Vulkan context
+		/// @param extent Attachment extent, also the capacity
+		/// @return Created attachment or error
+		///
+		[[nodiscard]]
+		static std::expected<VisibilityAttachment, Error> create(
+			const vulkan::Context& context,
+			glm::u32vec2 extent
+		) noexcept;
+
+		///
+		/// @brief View of the attachment
+		///
+		struct View
+		{
+			glm::u32vec2 extent;
+			vulkan::AttachmentView attachment;
+
+			const View* operator->() const noexcept { return this; }
+		};
+
+		operator View() const noexcept
+		{
+			return {
+				.extent = extent,
+				.attachment = attachment,
+			};
+		}
+
+		View operator->() const noexcept { return *this; }
+
+		///
+		/// @brief Check whether the attachment can hold a given extent without reallocation
+		///
+		/// @param extent Requested extent
+		/// @return `true` if @p extent fits in the allocated capacity
+		///
+		[[nodiscard]]
+		bool fits(glm::u32vec2 extent) const noexcept
+		{
+			return glm::all(glm::lessThanEqual(extent, capacity));
+		}
+
+		///
+		/// @brief Use only the top-left sub-rectangle of @p extent, keeping the allocation
+		/// @note @p extent must fit in the capacity, see @p fits
+		///
+		/// @param extent New extent
+		///
+		void set_extent(glm::u32vec2 extent) noexcept
+		{
+			DEBUG_ASSERT(fits(extent));
+			this->extent = extent;
+		}
+
+	  private:
+
+		glm::u32vec2 extent;
+		glm::u32vec2 capacity;
+		vulkan::Attachment attachment;
+
+		explicit VisibilityAttachment(glm::u32vec2 extent, vulkan::Attachment attachment) :
+			extent(extent),
+			capacity(extent),
+			attachment(std::move(attachment))
+		{}
+
+	  public:
+
+		VisibilityAttachment(const VisibilityAttachment&) = delete;
+		VisibilityAttachment(VisibilityAttachment&&) = default;
+		VisibilityAttachment& operator=(const VisibilityAttachment&) = delete;
+		VisibilityAttachment& operator=(VisibilityAttachment&&) = default;
+	};
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "render/interface/camera.hpp"
+
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <vector>
+
+namespace render
+{
+	///
+	/// @brief Options of cascade fitting, see `fit_cascades()`
+	///
+	struct CascadeOption
+	{
+		uint32_t cascade_count = 4;   // Count of cascades, from near to far
+		uint32_t resolution = 2048;   // Shadow map resolution of each cascade, used for texel snapping
+		float near_distance = 0.1f;   // View depth where the first cascade starts
+		float shadow_distance = 100;  // View depth where the last cascade ends
+		float split_lambda = 0.75f;   // Blend from uniform (0) to logarithmic (1) split distances
+
+		// Distance toward the light beyond the bounds of a cascade, where shadow casters are still captured
+		float caster_distance = 200;
+	};
+
+	///
+	/// @brief A fitted shadow cascade
+	///
+	struct ShadowCascade
+	{
+		glm::mat4 view_projection;  // Reverse-Z orthographic projection from world space, toward the light
+		float far_distance;         // View depth where the cascade ends
+	};
+
+	///
+	/// @brief Fit shadow cascades of a directional light to slices of the camera frustum
+	/// @details
+	/// - The frustum from `CascadeOption::near_distance` to `CascadeOption::shadow_distance` is split into
+	/// slices by the practical split scheme, each covered by one cascade
+	/// - Each cascade bounds the sphere of its slice, so its extent is unchanged when the camera rotates
+	/// - The cascade origin is snapped to whole texels in light space, so shadow edges don't shimmer when
+	/// the camera moves, and the matrix is unchanged unless the camera moves by at least a texel. Cached
+	/// shadow maps rely on this, see `CascadeShadowAttachment::acquire_dirty_cascades()`
+	///
+	/// @param camera Camera of the frame, with a reverse-Z perspective projection
+	/// @param light_direction Direction toward the light, see `DirectLight::direction`
+	/// @param option Fitting options
+	/// @return Fitted cascades, from near to far
+	///
+	[[nodiscard]]
+	std::vector<ShadowCascade> fit_cascades(
+		const Camera& camera,
+		glm::vec3 light_direction,
+		const CascadeOption& option
+	) noexcept;
+}
@@ -0,0 +1,404 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/memory.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	///
+	/// @brief Single-queue render graph, deriving the barriers between passes from their declared accesses
+	/// @details
+	/// #### Declaration
+	/// 1. Import external images and buffers with `import_image` and `import_buffer`, or declare transient
+	/// images with `create_image`
+	/// 2. Add passes with `add_pass`. The setup function declares, through `PassBuilder`, every resource the
+	/// pass reads or writes along with the pipeline stages, accesses and layouts it uses
+	/// 3. Record the graph with `execute`
+	///
+	/// #### Execution
+	/// - Passes are recorded in declaration order, all barriers a pass requires are batched into a single
+	/// `pipelineBarrier2` call right before it
+	/// - Passes whose writes are never read by a later live pass are culled, unless they write an imported
+	/// resource or are marked with `PassBuilder::set_side_effect`
+	/// - Transient images whose lifetimes don't overlap share memory, see `TransientCache`
+	///
+	/// The graph is cheap to declare and meant to be rebuilt every frame. Declarations and the scratch data
+	/// of `execute` are allocated from the memory resource given on construction, e.g. a per-frame arena.
+	///
+	/// @note Barriers are only derived for accesses declared through the graph, accesses made by passes
+	/// outside of the graph must be reflected in the initial and final accesses of the imported resources
+	///
+	class RenderGraph
+	{
+	  public:
+
+		class PassBuilder;
+		class Resources;
+		class TransientCache;
+
+		///
+		/// @brief Handle of an image in the graph
+		///
+		struct ImageHandle
+		{
+			uint32_t index;
+		};
+
+		///
+		/// @brief Handle of a buffer in the graph
+		///
+		struct BufferHandle
+		{
+			uint32_t index;
+		};
+
+		///
+		/// @brief Access of an image, by a pass or outside of the graph
+		///
+		struct ImageAccess
+		{
+			vk::PipelineStageFlags2 stage;
+			vk::AccessFlags2 access;
+			vk::ImageLayout layout;
+		};
+
+		///
+		/// @brief Access of a buffer, by a pass or outside of the graph
+		///
+		struct BufferAccess
+		{
+			vk::PipelineStageFlags2 stage;
+			vk::AccessFlags2 access;
+		};
+
+		///
+		/// @brief Description of a transient image, a 2D image with a single mip level and array layer
+		///
+		struct TransientImageInfo
+		{
+			vk::Format format;
+			vk::Extent2D extent;
+			vk::ImageUsageFlags usage;
+
+			bool operator==(const TransientImageInfo&) const noexcept = default;
+		};
+
+		///
+		/// @brief Function declaring the accesses of a pass
+		///
+		using SetupFunc = std::function<void(PassBuilder& builder)>;
+
+		///
+		/// @brief Function recording a pass
+		///
+		using ExecuteFunc =
+			std::function<std::expected<void, Error>(const vk::raii::CommandBuffer&, const Resources&)>;
+
+		///
+		/// @brief Create an empty render graph
+		///
+		/// @param memory_resource Memory resource of the declarations and the scratch data of `execute`, must
+		/// outlive the graph
+		///
+		explicit RenderGraph(
+			std::pmr::memory_resource& memory_resource = *std::pmr::new_delete_resource()
+		) noexcept :
+			memory_resource(&memory_resource),
+			images(&memory_resource),
+			buffers(&memory_resource),
+			passes(&memory_resource)
+		{}
+
+		///
+		/// @brief Import an external image
+		///
+		/// @param attachment External image and its view
+		/// @param range Subresource range accessed by the graph
+		/// @param initial_access Last access of the image before the graph is executed
+		/// @param final_access Access the image is made available to after the graph is executed, the image
+		/// is left in the state of its last access in the graph if `std::nullopt`
+		/// @return Handle of the image
+		///
+		[[nodiscard]]
+		ImageHandle import_image(
+			vulkan::AttachmentView attachment,
+			vk::ImageSubresourceRange range,
+			ImageAccess initial_access,
+			std::optional<ImageAccess> final_access = std::nullopt
+		) noexcept;
+
+		///
+		/// @brief Declare a transient image, which only lives during the execution of the graph
+		/// @note Contents of transient images are undefined before their first access in the graph
+		///
+		/// @param info Description of the image
+		/// @return Handle of the image
+		///
+		[[nodiscard]]
+		ImageHandle create_image(const TransientImageInfo& info) noexcept;
+
+		///
+		/// @brief Import an external buffer, accessed as a whole
+		///
+		/// @param buffer External buffer
+		/// @param initial_access Last access of the buffer before the graph is executed
+		/// @param final_access Access the buffer is made available to after the graph is executed
+		/// @return Handle of the buffer
+		///
+		[[nodiscard]]
+		BufferHandle import_buffer(
+			vk::Buffer buffer,
+			BufferAccess initial_access,
+			std::optional<BufferAccess> final_access = std::nullopt
+		) noexcept;
+
+		///
+		/// @brief Add a pass to the graph
+		///
+		/// @param name Name of the pass, used in error messages
+		/// @param setup Function declaring the accesses of the pass, called immediately
+		/// @param execute Function recording the pass, called in `execute` unless the pass is culled
+		///
+		void add_pass(std::string_view name, const SetupFunc& setup, ExecuteFunc execute) noexcept;
+
+		///
+		/// @brief Record the live passes of the graph and the barriers between them
+		///
+		/// @param context Vulkan context
+		/// @param command_buffer Command buffer
+		/// @param transient_cache Cache providing the memory of the transient images
+		/// @return Void, or error if creating the transient images or recording any pass failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> execute(
+			const vulkan::Context& context,
+			const vk::raii::CommandBuffer& command_buffer,
+			TransientCache& transient_cache
+		) const noexcept;
+
+	  private:
+
+		struct ImageNode
+		{
+			std::optional<TransientImageInfo> transient;
+			vulkan::AttachmentView attachment;
+			vk::ImageSubresourceRange range;
+			ImageAccess initial_access;
+			std::optional<ImageAccess> final_access;
+		};
+
+		struct BufferNode
+		{
+			vk::Buffer buffer;
+			BufferAccess initial_access;
+			std::optional<BufferAccess> final_access;
+		};
+
+		struct ImageUse
+		{
+			uint32_t index;
+			ImageAccess access;
+			bool write;
+		};
+
+		struct BufferUse
+		{
+			uint32_t index;
+			BufferAccess access;
+			bool write;
+		};
+
+		struct Pass
+		{
+			std::pmr::string name;
+			std::pmr::vector<ImageUse> image_uses;
+			std::pmr::vector<BufferUse> buffer_uses;
+			bool side_effect;
+			ExecuteFunc execute;
+		};
+
+		// Lifetime of a transient image in pass indices, and the memory block it is placed in
+		struct TransientPlacement
+		{
+			TransientImageInfo info;
+			uint32_t first_pass;
+			uint32_t last_pass;
+			uint32_t block;
+
+			bool operator==(const TransientPlacement&) const noexcept = default;
+		};
+
+		std::pmr::memory_resource* memory_resource;
+
+		std::pmr::vector<ImageNode> images;
+		std::pmr::vector<BufferNode> buffers;
+		std::pmr::vector<Pass> passes;
+
+		// Mark the passes contributing to any output of the graph
+		std::pmr::vector<bool> find_live_passes() const noexcept;
+
+		// Assign the transient images to memory blocks, and recreate the images of the cache if the
+		// assignment changed
+		static std::expected<void, Error> prepare_transients(
+			const vulkan::Context& context,
+			TransientCache& cache,
+			std::span<TransientPlacement> placements,
+			std::pmr::memory_resource& memory_resource
+		) noexcept;
+
+	  public:
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph(RenderGraph&&) = default;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+		RenderGraph& operator=(RenderGraph&&) = default;
+	};
+
+	///
+	/// @brief Declares the accesses of a pass
+	/// @details Multiple accesses of the same resource in a pass are merged, and must share the same layout
+	///
+	class RenderGraph::PassBuilder
+	{
+	  public:
+
+		///
+		/// @brief Declare a read-only access to an image
+		///
+		void read(ImageHandle image, ImageAccess access) noexcept;
+
+		///
+		/// @brief Declare a write access to an image, the access may also read the image
+		///
+		void write(ImageHandle image, ImageAccess access) noexcept;
+
+		///
+		/// @brief Declare a read-only access to a buffer
+		///
+		void read(BufferHandle buffer, BufferAccess access) noexcept;
+
+		///
+		/// @brief Declare a write access to a buffer, the access may also read the buffer
+		///
+		void write(BufferHandle buffer, BufferAccess access) noexcept;
+
+		///
+		/// @brief Keep the pass even if none of its writes are used, e.g. for passes writing to resources
+		/// outside of the graph
+		///
+		void set_side_effect() noexcept;
+
+	  private:
+
+		Pass& pass;
+
+		void add_use(ImageHandle image, ImageAccess access, bool write) noexcept;
+		void add_use(BufferHandle buffer, BufferAccess access, bool write) noexcept;
+
+		explicit PassBuilder(Pass& pass) :
+			pass(pass)
+		{}
+
+		friend class RenderGraph;
+
+	  public:
+
+		PassBuilder(const PassBuilder&) = delete;
+		PassBuilder(PassBuilder&&) = delete;
+		PassBuilder& operator=(const PassBuilder&) = delete;
+		PassBuilder& operator=(PassBuilder&&) = delete;
+	};
+
+	///
+	/// @brief Resolves the handles of a graph while recording a pass
+	///
+	class RenderGraph::Resources
+	{
+	  public:
+
+		///
+		/// @brief Get the image and view of an image handle
+		///
+		[[nodiscard]]
+		vulkan::AttachmentView image(ImageHandle image) const noexcept;
+
+		///
+		/// @brief Get the buffer of a buffer handle
+		///
+		[[nodiscard]]
+		vk::Buffer buffer(BufferHandle buffer) const noexcept;
+
+	  private:
+
+		std::span<const vulkan::AttachmentView> images;
+		std::span<const BufferNode> buffers;
+
+		explicit Resources(
+			std::span<const vulkan::AttachmentView> images,
+			std::span<const BufferNode> buffers
+		) :
+			images(images),
+			buffers(buffers)
+		{}
+
+		friend class RenderGraph;
+
+	  public:
+
+		Resources(const Resources&) = delete;
+		Resources(Resources&&) = delete;
+		Resources& operator=(const Resources&) = delete;
+		Resources& operator=(Resources&&) = delete;
+	};
+
+	///
+	/// @brief Memory and images backing the transient images of a render graph
+	/// @details
+	/// - Transient images are assigned to memory blocks greedily, largest first, sharing a block with other
+	/// images whose lifetimes (from their first to their last live pass) don't overlap
+	/// - The memory and images are kept as long as the transient images and their lifetimes stay the same
+	/// across executions, otherwise they are recreated
+	///
+	/// @warning The memory may be freed on `RenderGraph::execute`, so a cache must not be shared by command
+	/// buffers in flight, e.g. keep one cache per frame in flight
+	///
+	class RenderGraph::TransientCache
+	{
+	  public:
+
+		TransientCache() = default;
+
+	  private:
+
+		std::vector<TransientPlacement> placements;
+
+		// Images must be destroyed before the memory they are placed in
+		std::vector<vulkan::Memory> memory_blocks;
+		std::vector<vk::raii::Image> images;
+		std::vector<vk::raii::ImageView> views;
+
+		friend class RenderGraph;
+
+	  public:
+
+		TransientCache(const TransientCache&) = delete;
+		TransientCache(TransientCache&&) = default;
+		TransientCache& operator=(const TransientCache&) = delete;
+		TransientCache& operator=(TransientCache&&) = default;
+	};
+}
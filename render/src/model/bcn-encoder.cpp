@@ -0,0 +1,407 @@
+#include "render/model/bcn-encoder.hpp"
+#include "common/util/error.hpp"
+#include "image/bc-image.hpp"
+#include "render/model/texture.hpp"
+#include "shader/bcn-encode.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/command-runner.hpp"
+#include "vulkan/util/descriptor-allocator.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <libassert/assert.hpp>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto src_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto dst_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({src_binding, dst_binding});
+	}
+
+	// Sets the first pool holds, one for each texture of a batch
+	static constexpr uint32_t INITIAL_SET_COUNT = 64;
+
+	// Descriptors of each set, see `get_descriptor_set_bindings`
+	static constexpr auto DESCRIPTOR_RATIOS = std::to_array<vulkan::DescriptorAllocator::Ratio>({
+		{.type = vk::DescriptorType::eSampledImage,  .count = 1.0f},
+		{.type = vk::DescriptorType::eStorageBuffer, .count = 1.0f},
+	});
+
+	static glm::u32vec2 get_block_count(glm::u32vec2 extent) noexcept
+	{
+		return (extent + 3u) / 4u;
+	}
+
+	std::expected<BcnEncoder, Error> BcnEncoder::create(const vulkan::Context& context) noexcept
+	{
+		auto shader_module_result = vulkan::create_shader(context.device, shader::bcn_encode);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*descriptor_set_layout)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main");
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+		auto pipeline = std::move(*pipeline_result);
+
+		auto descriptor_allocator_result =
+			vulkan::DescriptorAllocator::create(context, INITIAL_SET_COUNT, DESCRIPTOR_RATIOS);
+		if (!descriptor_allocator_result)
+			return descriptor_allocator_result.error().forward("Create descriptor allocator failed");
+
+		return BcnEncoder(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(pipeline),
+			std::move(*descriptor_allocator_result)
+		);
+	}
+
+	std::expected<std::vector<Texture>, Error> BcnEncoder::encode(
+		const vulkan::Context& context,
+		std::span<const Source> sources,
+		vk::ImageUsageFlags usage
+	) noexcept
+	{
+		if (sources.empty()) return std::vector<Texture>();
+
+		/* Descriptor sets */
+
+		// The previous batch has been waited for, its sets are reused and the pools only grow for larger ones
+		descriptor_allocator.reset();
+
+		const auto layouts = std::vector(sources.size(), *descriptor_set_layout);
+		auto descriptor_sets_result = descriptor_allocator.allocate(context.device, layouts);
+		if (!descriptor_sets_result)
+			return descriptor_sets_result.error().forward("Allocate descriptor sets failed");
+		const auto descriptor_sets = std::move(*descriptor_sets_result);
+
+		/* Per-source resources */
+
+		std::vector<vk::raii::ImageView> src_views;
+		std::vector<vulkan::ArrayBuffer<glm::u32vec4>> block_buffers;
+		std::vector<std::vector<uint32_t>> block_offsets;  // Offset of each level in the block buffer
+		std::vector<Texture> textures;
+
+		src_views.reserve(sources.size());
+		block_buffers.reserve(sources.size());
+		block_offsets.reserve(sources.size());
+		textures.reserve(sources.size());
+
+		for (const auto& [source, descriptor_set] : std::views::zip(sources, descriptor_sets))
+		{
+			if (source.level_extents.empty()) return Error("Mipmap chain of source is empty");
+
+			const auto vk_format = [format = source.format] {
+				switch (format)
+				{
+				case image::BCnFormat::BC3:
+					return vk::Format::eBc3UnormBlock;
+				case image::BCnFormat::BC5:
+					return vk::Format::eBc5UnormBlock;
+				case image::BCnFormat::BC7:
+					return vk::Format::eBc7UnormBlock;
+				default:
+					UNREACHABLE("Invalid format", format);
+				}
+			}();
+
+			const auto level_count = static_cast<uint32_t>(source.level_extents.size());
+
+			std::vector<uint32_t> offsets;
+			uint32_t block_total = 0;
+			for (const auto extent : source.level_extents)
+			{
+				const auto block_count = get_block_count(extent);
+				offsets.push_back(block_total);
+				block_total += block_count.x * block_count.y;
+			}
+
+			auto src_view_result = context.device.createImageView({
+				.image = source.image,
+				.viewType = vk::ImageViewType::e2D,
+				.format = vk::Format::eR8G8B8A8Unorm,
+				.subresourceRange = {
+					.aspectMask = vk::ImageAspectFlagBits::eColor,
+					.baseMipLevel = 0,
+					.levelCount = level_count,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+			});
+			if (!src_view_result) return Error::from(src_view_result);
+
+			auto block_buffer_result = context.allocator.create_array_buffer<glm::u32vec4>(
+				block_total,
+				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc,
+				vulkan::MemoryUsage::GpuOnly,
+				vk::SharingMode::eExclusive,
+				{},
+				vulkan::MemoryCategory::Staging
+			);
+			if (!block_buffer_result)
+				return block_buffer_result.error().forward("Create block buffer failed");
+
+			// Storage formats, views of other formats are created through `eMutableFormat`
+			const auto extent = source.level_extents[0];
+			const auto image_create_info = vk::ImageCreateInfo{
+				.flags = vk::ImageCreateFlagBits::eMutableFormat,
+				.imageType = vk::ImageType::e2D,
+				.format = vk_format,
+				.extent = {.width = extent.x, .height = extent.y, .depth = 1},
+				.mipLevels = level_count,
+				.arrayLayers = 1,
+				.usage = usage | vk::ImageUsageFlagBits::eTransferDst
+			};
+			auto image_result = context.allocator.create_image(
+				image_create_info,
+				vulkan::MemoryUsage::GpuOnly,
+				vulkan::MemoryCategory::Texture
+			);
+			if (!image_result) return image_result.error().forward("Create gpu image failed");
+
+			const auto src_image_info = vk::DescriptorImageInfo{
+				.imageView = *src_view_result,
+				.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+			};
+			const auto dst_buffer_info = vk::DescriptorBufferInfo{
+				.buffer = *block_buffer_result,
+				.offset = 0,
+				.range = vk::WholeSize
+			};
+
+			const auto write_descriptor_sets = std::to_array({
+				vk::WriteDescriptorSet{
+					.dstSet = descriptor_set,
+					.dstBinding = 0,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eSampledImage,
+					.pImageInfo = &src_image_info
+				},
+				vk::WriteDescriptorSet{
+					.dstSet = descriptor_set,
+					.dstBinding = 1,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eStorageBuffer,
+					.pBufferInfo = &dst_buffer_info
+				},
+			});
+			context.device.updateDescriptorSets(write_descriptor_sets, {});
+
+			src_views.push_back(std::move(*src_view_result));
+			block_buffers.push_back(std::move(*block_buffer_result));
+			block_offsets.push_back(std::move(offsets));
+			textures.push_back(
+				Texture{
+					.image = std::move(*image_result),
+					.format = Texture::get_bcn_format(source.format),
+					.mipmap_levels = level_count,
+					.min_alpha = source.min_alpha
+				}
+			);
+		}
+
+		/* Encode and copy */
+
+		auto command_runner_result = vulkan::CommandRunner::create(context);
+		if (!command_runner_result)
+			return command_runner_result.error().forward("Create command runner failed");
+		const auto command_runner = std::move(*command_runner_result);
+
+		const auto record = [&](const vk::raii::CommandBuffer& command_buffer) {
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+
+			for (const auto& [source, descriptor_set, offsets] :
+				 std::views::zip(sources, descriptor_sets, block_offsets))
+			{
+				const auto format = [format = source.format] {
+					switch (format)
+					{
+					case image::BCnFormat::BC3:
+						return FORMAT_BC3;
+					case image::BCnFormat::BC5:
+						return FORMAT_BC5;
+					default:
+						return FORMAT_BC7;
+					}
+				}();
+
+				command_buffer.bindDescriptorSets(
+					vk::PipelineBindPoint::eCompute,
+					pipeline_layout,
+					0,
+					descriptor_set,
+					{}
+				);
+
+				for (const auto [level, extent] : source.level_extents | std::views::enumerate)
+				{
+					const auto push_constant = PushConstant{
+						.block_count = get_block_count(extent),
+						.level = static_cast<uint32_t>(level),
+						.block_offset = offsets[level],
+						.format = format
+					};
+					const auto group_count =
+						(push_constant.block_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+					command_buffer.pushConstants<PushConstant>(
+						*pipeline_layout,
+						vk::ShaderStageFlagBits::eCompute,
+						0,
+						push_constant
+					);
+					command_buffer.dispatch(group_count.x, group_count.y, 1);
+				}
+			}
+
+			/* Blocks written -> copy, discarding previous content of the outputs */
+
+			const auto full_range = vk::ImageSubresourceRange{
+				.aspectMask = vk::ImageAspectFlagBits::eColor,
+				.baseMipLevel = 0,
+				.levelCount = vk::RemainingMipLevels,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			};
+
+			const auto block_barrier = vk::MemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+				.dstAccessMask = vk::AccessFlagBits2::eTransferRead
+			};
+			const auto pre_copy_barriers =
+				textures
+				| std::views::transform([&full_range](const Texture& texture) {
+					  return vk::ImageMemoryBarrier2{
+						  .srcStageMask = vk::PipelineStageFlagBits2::eTopOfPipe,
+						  .srcAccessMask = vk::AccessFlagBits2::eNone,
+						  .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+						  .dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+						  .oldLayout = vk::ImageLayout::eUndefined,
+						  .newLayout = vk::ImageLayout::eTransferDstOptimal,
+						  .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+						  .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+						  .image = texture.image,
+						  .subresourceRange = full_range
+					  };
+				  })
+				| std::ranges::to<std::vector>();
+			command_buffer.pipelineBarrier2(
+				vk::DependencyInfo()
+					.setMemoryBarriers(block_barrier)
+					.setImageMemoryBarriers(pre_copy_barriers)
+			);
+
+			for (const auto& [source, block_buffer, offsets, texture] :
+				 std::views::zip(sources, block_buffers, block_offsets, textures))
+			{
+				const auto copy_regions =
+					std::views::iota(0zu, source.level_extents.size())
+					| std::views::transform([&source, &offsets](size_t level) {
+						  const auto extent = source.level_extents[level];
+						  return vk::BufferImageCopy{
+							  .bufferOffset = offsets[level] * sizeof(glm::u32vec4),
+							  .bufferRowLength = 0,
+							  .bufferImageHeight = 0,
+							  .imageSubresource = {
+								  .aspectMask = vk::ImageAspectFlagBits::eColor,
+								  .mipLevel = static_cast<uint32_t>(level),
+								  .baseArrayLayer = 0,
+								  .layerCount = 1,
+							  },
+							  .imageOffset = {.x = 0, .y = 0, .z = 0},
+							  .imageExtent = {.width = extent.x, .height = extent.y, .depth = 1}
+						  };
+					  })
+					| std::ranges::to<std::vector>();
+
+				command_buffer.copyBufferToImage(
+					block_buffer,
+					texture.image,
+					vk::ImageLayout::eTransferDstOptimal,
+					copy_regions
+				);
+			}
+
+			/* Copy -> any later use */
+
+			const auto post_copy_barriers =
+				textures
+				| std::views::transform([&full_range](const Texture& texture) {
+					  return vk::ImageMemoryBarrier2{
+						  .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+						  .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+						  .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+						  .dstAccessMask = vk::AccessFlagBits2::eNone,
+						  .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+						  .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+						  .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+						  .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+						  .image = texture.image,
+						  .subresourceRange = full_range
+					  };
+				  })
+				| std::ranges::to<std::vector>();
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_copy_barriers));
+		};
+
+		if (const auto result = command_runner.run(context, record); !result)
+			return result.error().forward("Run encode commands failed");
+
+		return textures;
+	}
+}
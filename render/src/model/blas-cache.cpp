@@ -0,0 +1,224 @@
+#include "render/model/blas-cache.hpp"
+#include "common/util/align.hpp"
+#include "common/util/error.hpp"
+#include "common/util/hash.hpp"
+#include "common/util/span.hpp"
+#include "render/model/blas.hpp"
+#include "render/model/model-cache.hpp"
+#include "render/model/model.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <mio/mmap.hpp>
+#include <span>
+#include <system_error>
+
+/*
+ * File layout, all integers in native endianness:
+ *
+ * - `Header` at offset 0
+ * - `uint64_t[blas_count + 1]` offsets of the serialized BLASes in the data, followed by its size
+ * - `uint32_t[mesh_count]` BLAS index of each mesh
+ * - Serialized BLASes at `Header::data_offset`, aligned to `DATA_ALIGNMENT`
+ */
+
+namespace render
+{
+	namespace
+	{
+		constexpr auto MAGIC = std::to_array<char>({'V', 'R', 'T', 'B', 'L', 'A', 'S', 'C'});
+
+		// Serialized BLASes are copied from 256-byte aligned addresses, see `BlasList::serialize`
+		constexpr uint64_t DATA_ALIGNMENT = 256;
+
+		struct Header
+		{
+			std::array<char, 8> magic;
+			uint32_t version;
+			uint32_t mesh_count;
+			uint64_t source_hash;
+			uint64_t model_option_hash;
+			uint64_t option_hash;
+			uint64_t blas_count;
+			uint64_t data_offset;
+		};
+	}
+
+	BlasCache::Key BlasCache::get_key(ModelCache::Key model_key, const Model::Option& option) noexcept
+	{
+		// Coarse geometry uploaded for streaming yields different BLASes than the full geometry
+		const auto option_fields = std::to_array<uint32_t>({
+			static_cast<uint32_t>(option.compact_blas),
+			static_cast<uint32_t>(option.geometry_pool.has_value()),
+		});
+
+		return Key{.model = model_key, .option_hash = util::hash_bytes(util::as_bytes(option_fields))};
+	}
+
+	std::filesystem::path BlasCache::get_path(const std::filesystem::path& model_cache_path) noexcept
+	{
+		auto path = model_cache_path;
+		path += ".blas";
+		return path;
+	}
+
+	std::expected<void, Error> BlasCache::write(
+		const std::filesystem::path& path,
+		Key key,
+		const BlasList::SerializedView& serialized
+	) noexcept
+	{
+		if (serialized.offsets.empty() || serialized.offsets.back() != serialized.data.size())
+			return Error("Invalid serialized BLAS", "Offsets out of range");
+
+		/* Layout */
+
+		const auto offsets_offset = uint64_t(sizeof(Header));
+		const auto mesh_blas_index_offset = offsets_offset + serialized.offsets.size_bytes();
+		const auto data_offset = util::align_address(
+			mesh_blas_index_offset + serialized.mesh_blas_index.size_bytes(),
+			DATA_ALIGNMENT
+		);
+
+		const auto header = Header{
+			.magic = MAGIC,
+			.version = VERSION,
+			.mesh_count = static_cast<uint32_t>(serialized.mesh_blas_index.size()),
+			.source_hash = key.model.source_hash,
+			.model_option_hash = key.model.option_hash,
+			.option_hash = key.option_hash,
+			.blas_count = serialized.offsets.size() - 1,
+			.data_offset = data_offset
+		};
+
+		/* Write to temporary file */
+
+		auto temp_path = path;
+		temp_path += ".tmp";
+
+		std::error_code error_code;
+		if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error_code);
+		if (error_code)
+			return Error(
+				std::format("Create directory '{}' failed", path.parent_path().string()),
+				error_code.message()
+			);
+
+		std::ofstream file;
+		file.exceptions(std::ios::failbit | std::ios::badbit);
+
+		try
+		{
+			file.open(temp_path, std::ios::binary | std::ios::trunc);
+
+			uint64_t position = 0;
+			const auto write_at = [&file, &position](uint64_t offset, std::span<const std::byte> data) {
+				static constexpr auto ZEROS = std::array<char, DATA_ALIGNMENT>{};
+				file.write(ZEROS.data(), static_cast<std::streamsize>(offset - position));
+				file.write(
+					reinterpret_cast<const char*>(data.data()),
+					static_cast<std::streamsize>(data.size())
+				);
+				position = offset + data.size();
+			};
+
+			write_at(0, util::object_as_bytes(header));
+			write_at(offsets_offset, util::as_bytes(serialized.offsets));
+			write_at(mesh_blas_index_offset, util::as_bytes(serialized.mesh_blas_index));
+			write_at(data_offset, serialized.data);
+
+			file.close();
+		}
+		catch (const std::ios::failure& e)
+		{
+			std::filesystem::remove(temp_path, error_code);
+			return Error(std::format("Write file '{}' failed", temp_path.string()), e.what());
+		}
+
+		/* Replace */
+
+		std::filesystem::rename(temp_path, path, error_code);
+		if (error_code)
+		{
+			std::filesystem::remove(temp_path, error_code);
+			return Error(std::format("Rename '{}' failed", temp_path.string()), error_code.message());
+		}
+
+		return {};
+	}
+
+	std::expected<BlasCache, Error> BlasCache::open(const std::filesystem::path& path, Key key) noexcept
+	{
+		if (!std::filesystem::is_regular_file(path))
+			return Error("Cache file doesn't exist", std::format("Path: {}", path.string()));
+
+		std::shared_ptr<const mio::basic_mmap_source<std::byte>> mmap;
+		try
+		{
+			mmap = std::make_shared<const mio::basic_mmap_source<std::byte>>(path.string(), 0);
+		}
+		catch (const std::system_error& e)
+		{
+			return Error(
+				"Memory map file failed",
+				std::format("Path: {}, what(): {:?}", path.string(), e.what())
+			);
+		}
+
+		const auto file = std::span(mmap->data(), mmap->size());
+
+		/* Header */
+
+		if (file.size() < sizeof(Header)) return Error("Invalid cache file", "File too small");
+
+		Header header;
+		std::memcpy(&header, file.data(), sizeof(Header));
+
+		if (header.magic != MAGIC) return Error("Invalid cache file", "Magic mismatch");
+		if (header.version != VERSION)
+			return Error(
+				"Outdated cache file",
+				std::format("Version {}, expected {}", header.version, VERSION)
+			);
+		if (header.source_hash != key.model.source_hash
+			|| header.model_option_hash != key.model.option_hash
+			|| header.option_hash != key.option_hash)
+			return Error("Outdated cache file", "Key mismatch");
+
+		/* Tables */
+
+		const auto offsets_offset = uint64_t(sizeof(Header));
+		const auto offsets_size = (header.blas_count + 1) * sizeof(uint64_t);
+		const auto mesh_blas_index_offset = offsets_offset + offsets_size;
+		const auto mesh_blas_index_size = uint64_t(header.mesh_count) * sizeof(uint32_t);
+
+		if (header.blas_count >= file.size() / sizeof(uint64_t)
+			|| mesh_blas_index_offset + mesh_blas_index_size > header.data_offset
+			|| header.data_offset % DATA_ALIGNMENT != 0
+			|| header.data_offset > file.size())
+			return Error("Invalid cache file", "Tables out of range");
+
+		const auto offsets = util::from_bytes<const uint64_t>(file.subspan(offsets_offset, offsets_size));
+		const auto mesh_blas_index =
+			util::from_bytes<const uint32_t>(file.subspan(mesh_blas_index_offset, mesh_blas_index_size));
+
+		const auto data = file.subspan(header.data_offset);
+		if (offsets.back() != data.size()) return Error("Invalid cache file", "Data size mismatch");
+
+		const auto serialized = BlasList::SerializedView{
+			.data = data,
+			.offsets = offsets,
+			.mesh_blas_index = mesh_blas_index
+		};
+
+		return BlasCache(std::move(mmap), serialized);
+	}
+}
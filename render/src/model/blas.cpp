@@ -5,25 +5,240 @@
 #include "render/model/mesh.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <algorithm>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <cstdint>
 #include <expected>
-#include <functional>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stop_token>
 #include <utility>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace render
 {
-	std::expected<BlasList, Error> BlasList::create(
+	coro::task<std::expected<BlasList, Error>> BlasList::create(
+		coro::thread_pool& thread_pool,
 		const vulkan::Context& context,
 		const MeshList& mesh_list,
-		const MaterialList& material_list
+		const MaterialList& material_list,
+		bool compact,
+		BuildPreference preference,
+		std::stop_token stop_token,
+		std::span<const uint32_t> deformable_meshes
+	) noexcept
+	{
+		if (!context.feature.raytracing)
+			co_return Error("Missing raytracing feature", "BLAS requires raytracing feature to be enabled");
+
+		const auto build_flags = preference == BuildPreference::FastBuild
+			? vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastBuild
+			: vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace;
+
+		auto sharing = impl::share_blas(mesh_list, material_list, deformable_meshes);
+
+		/* Split static and deformable BLASes, the latter are built for update */
+
+		std::vector<bool> deformable(mesh_list->mesh_ranges_array.size(), false);
+		for (const auto mesh_idx : deformable_meshes)
+			if (mesh_idx < deformable.size()) deformable[mesh_idx] = true;
+
+		std::vector<uint32_t> static_blas, deformable_blas;
+		for (const auto [blas_idx, mesh_idx] : sharing.blas_mesh_index | std::views::enumerate)
+		{
+			auto& target = deformable[mesh_idx] ? deformable_blas : static_blas;
+			target.push_back(static_cast<uint32_t>(blas_idx));
+		}
+
+		const auto get_meshes = [&sharing](std::span<const uint32_t> blas_indices) {
+			return blas_indices
+				| std::views::transform([&sharing](uint32_t blas_idx) {
+					   return sharing.blas_mesh_index[blas_idx];
+				   })
+				| std::ranges::to<std::vector>();
+		};
+		const auto static_meshes = get_meshes(static_blas);
+		const auto deformed_meshes = get_meshes(deformable_blas);
+
+		auto static_prototypes = co_await impl::create_blas(
+			thread_pool,
+			context,
+			mesh_list,
+			material_list,
+			static_meshes,
+			build_flags,
+			compact
+		);
+		auto deformable_prototypes = co_await impl::create_blas(
+			thread_pool,
+			context,
+			mesh_list,
+			material_list,
+			deformed_meshes,
+			build_flags | vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate,
+			compact
+		);
+
+		auto prototypes = std::vector<impl::MeshBlasPrototype>(sharing.blas_mesh_index.size());
+		for (auto&& [blas_idx, prototype] : std::views::zip(static_blas, static_prototypes))
+			prototypes[blas_idx] = std::move(prototype);
+		for (auto&& [blas_idx, prototype] : std::views::zip(deformable_blas, deformable_prototypes))
+			prototypes[blas_idx] = std::move(prototype);
+
+		if (stop_token.stop_requested()) co_return Error("Cancelled");
+
+		auto build_result = impl::build_blas(context, prototypes, compact, std::move(stop_token));
+		if (!build_result) co_return build_result.error().forward("Build BLAS failed");
+
+		/* Keep the geometries of deformable BLASes for refitting */
+
+		std::vector<RefitTarget> refit_targets;
+		std::optional<vulkan::Buffer> refit_scratch_buffer;
+
+		if (!deformable_blas.empty())
+		{
+			const auto update_scratch_sizes =
+				deformable_blas
+				| std::views::transform([&prototypes](uint32_t blas_idx) {
+					  return prototypes[blas_idx].update_scratch_size;
+				  })
+				| std::ranges::to<std::vector>();
+
+			auto scratch_result = impl::create_refit_scratch(context, update_scratch_sizes);
+			if (!scratch_result) co_return scratch_result.error().forward("Create BLAS refit scratch failed");
+
+			for (const auto [blas_idx, scratch_addr] :
+				 std::views::zip(deformable_blas, scratch_result->addresses))
+			{
+				auto& prototype = prototypes[blas_idx];
+				refit_targets.push_back({
+					.blas_index = blas_idx,
+					.build_flags = prototype.build_flags,
+					.scratch_addr = scratch_addr,
+					.geometries = std::move(prototype.geometries),
+					.build_range = std::move(prototype.build_range),
+				});
+			}
+
+			refit_scratch_buffer = std::move(scratch_result->buffer);
+		}
+
+		co_return BlasList(
+			std::move(build_result->buffers),
+			std::move(build_result->blas_list),
+			std::move(sharing.mesh_blas_index),
+			build_result->memory_stat,
+			preference,
+			false,
+			std::move(refit_targets),
+			std::move(refit_scratch_buffer)
+		);
+	}
+
+	std::expected<BlasList, Error> BlasList::deserialize(
+		const vulkan::Context& context,
+		const MeshList& mesh_list,
+		const SerializedView& serialized
 	) noexcept
 	{
 		if (!context.feature.raytracing)
 			return Error("Missing raytracing feature", "BLAS requires raytracing feature to be enabled");
 
-		return impl::create_blas(context, mesh_list, material_list)
-			.and_then(std::bind(impl::build_blas, std::cref(context), std::placeholders::_1))
-			.transform([](impl::BuildBlasResult result) { return BlasList(std::move(result.blas_list)); });
+		if (serialized.offsets.empty() || serialized.offsets.back() != serialized.data.size())
+			return Error("Invalid serialized BLAS", "Offsets out of range");
+		if (serialized.mesh_blas_index.size() != mesh_list->mesh_ranges_array.size())
+			return Error("Invalid serialized BLAS", "Mesh count mismatch");
+
+		const auto blas_count = serialized.offsets.size() - 1;
+		if (std::ranges::any_of(serialized.mesh_blas_index, [blas_count](uint32_t idx) {
+				return idx >= blas_count;
+			}))
+			return Error("Invalid serialized BLAS", "BLAS index out of range");
+
+		auto result = impl::deserialize_blas(context, serialized.data, serialized.offsets);
+		if (!result) return result.error().forward("Deserialize BLAS failed");
+
+		return BlasList(
+			std::move(result->buffers),
+			std::move(result->blas_list),
+			std::vector(std::from_range, serialized.mesh_blas_index),
+			result->memory_stat,
+			BuildPreference::FastTrace,
+			true,
+			{},
+			std::nullopt
+		);
+	}
+
+	std::expected<BlasList::Serialized, Error> BlasList::serialize(
+		const vulkan::Context& context
+	) const noexcept
+	{
+		// Refit BLASes follow the deformed vertices, a snapshot would be stale and can't be refit
+		if (!refit_targets.empty())
+			return Error("Serialize BLAS failed", "Refit BLASes of deformable meshes can't be serialized");
+
+		auto result = impl::serialize_blas(context, blas_list);
+		if (!result) return result.error().forward("Serialize BLAS failed");
+
+		return Serialized{
+			.data = std::move(result->data),
+			.offsets = std::move(result->offsets),
+			.mesh_blas_index = mesh_blas_index,
+		};
+	}
+
+	void BlasList::refit(const vk::raii::CommandBuffer& command_buffer) const noexcept
+	{
+		if (refit_targets.empty()) return;
+
+		// Previous traces read, and previous refits write, the BLASes and the scratch buffer
+		const auto pre_refit_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR
+				| vk::PipelineStageFlagBits2::eComputeShader
+				| vk::PipelineStageFlagBits2::eFragmentShader,
+			.srcAccessMask = vk::AccessFlagBits2::eAccelerationStructureReadKHR
+				| vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+			.dstStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+			.dstAccessMask = vk::AccessFlagBits2::eAccelerationStructureReadKHR
+				| vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(pre_refit_barrier));
+
+		const auto build_geometry_infos =
+			refit_targets
+			| std::views::transform([this](const RefitTarget& target) {
+				  const auto& blas = blas_list[target.blas_index];
+				  return vk::AccelerationStructureBuildGeometryInfoKHR()
+					  .setType(vk::AccelerationStructureTypeKHR::eBottomLevel)
+					  .setMode(vk::BuildAccelerationStructureModeKHR::eUpdate)
+					  .setSrcAccelerationStructure(blas)
+					  .setDstAccelerationStructure(blas)
+					  .setScratchData(target.scratch_addr)
+					  .setFlags(target.build_flags)
+					  .setGeometries(target.geometries);
+			  })
+			| std::ranges::to<std::vector>();
+		const auto build_range_info_ptrs =
+			refit_targets
+			| std::views::transform([](const RefitTarget& target) { return target.build_range.data(); })
+			| std::ranges::to<std::vector>();
+
+		command_buffer.buildAccelerationStructuresKHR(build_geometry_infos, build_range_info_ptrs);
+
+		// TLAS builds and traces read the refit BLASes
+		const auto post_refit_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+			.srcAccessMask = vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+			.dstStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR
+				| vk::PipelineStageFlagBits2::eComputeShader
+				| vk::PipelineStageFlagBits2::eFragmentShader,
+			.dstAccessMask = vk::AccessFlagBits2::eAccelerationStructureReadKHR,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(post_refit_barrier));
 	}
 }
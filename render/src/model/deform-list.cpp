@@ -0,0 +1,226 @@
+#include "render/model/deform-list.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "model/animation.hpp"
+#include "model/mesh.hpp"
+#include "model/model.hpp"
+#include "render/model/mesh.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	namespace
+	{
+		template <typename T>
+		std::expected<vulkan::ArrayBuffer<T>, Error> create_storage_buffer(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			std::span<const T> data
+		) noexcept
+		{
+			if (!data.empty())
+				return resource_creator.create_array_buffer(
+					context,
+					data,
+					vk::BufferUsageFlagBits::eStorageBuffer
+				);
+
+			// Zero-sized buffers are not allowed, pad with a dummy element while keeping the count 0
+			constexpr auto dummy = T{};
+			return resource_creator
+				.create_buffer(context, util::object_as_bytes(dummy), vk::BufferUsageFlagBits::eStorageBuffer)
+				.transform([](vulkan::Buffer buffer) {
+					return vulkan::ArrayBuffer<T>(std::move(buffer), 0);
+				});
+		}
+	}
+
+	std::vector<uint32_t> DeformList::get_deformable_meshes(const model::Model& model) noexcept
+	{
+		return std::views::iota(0zu, model.meshes.size())
+			| std::views::filter([&model](size_t mesh_index) {
+				  return model.meshes[mesh_index].deformable();
+			  })
+			| std::views::transform([](size_t mesh_index) { return static_cast<uint32_t>(mesh_index); })
+			| std::ranges::to<std::vector>();
+	}
+
+	std::expected<DeformList, Error> DeformList::create(
+		const vulkan::Context& context,
+		const model::Model& model,
+		const MeshList& mesh_list
+	) noexcept
+	{
+		const auto mesh_list_ref = mesh_list.get();
+
+		if (mesh_list_ref.vertex_format != VertexFormat::Full)
+			return Error("Deformable meshes require the full vertex format");
+		if (mesh_list_ref.geometry_pool.has_value())
+			return Error("Deformable meshes are not supported with a geometry pool");
+
+		std::vector<model::FullVertex> bind_vertices;
+		std::vector<model::VertexSkin> skin;
+		std::vector<glm::vec3> morph_deltas;
+		std::vector<Job> jobs;
+		std::vector<Binding> bindings;
+		uint32_t joint_count = 0;
+		uint32_t weight_count = 0;
+
+		const auto renderables = model.hierarchy.get_renderables();
+		const auto nodes = model.hierarchy.get_nodes();
+
+		for (const auto mesh_index : get_deformable_meshes(model))
+		{
+			const auto& mesh = model.meshes[mesh_index];
+
+			// Meshes not drawn by any node are left in their bind pose
+			const auto renderable =
+				std::ranges::find(renderables, mesh_index, &model::Hierarchy::Drawcall::mesh_index);
+			if (renderable == renderables.end()) continue;
+
+			const auto skin_index = nodes[renderable->node_index].data.skin_index;
+			auto binding = Binding{
+				.node_index = renderable->node_index,
+				.skin_index = skin_index,
+				.joint_offset = joint_count,
+				.weight_offset = weight_count,
+				.default_weights = mesh.morph_weights,
+			};
+			if (skin_index.has_value())
+				joint_count += static_cast<uint32_t>(model.skins[*skin_index].joints.size());
+			weight_count += static_cast<uint32_t>(mesh.morph_weights.size());
+
+			const auto primitive_range = mesh_list_ref.mesh_ranges_array[mesh_index];
+			for (const auto [primitive_idx, primitive] : mesh.primitives | std::views::enumerate)
+			{
+				const auto& deformation = primitive.deformation;
+				const auto& attribute =
+					mesh_list_ref.primitive_attr_array[primitive_range.offset + primitive_idx];
+				const auto vertex_count = primitive.geometry.vertices.size();
+
+				if (attribute.vertex_count != vertex_count)
+					return Error(
+						"Vertices of a deformed primitive were reordered",
+						std::format("Mesh #{}, primitive #{}", mesh_index, primitive_idx)
+					);
+				if (deformation.morph_targets.size() > mesh.morph_weights.size())
+					return Error(
+						"Morph targets of a primitive outnumber the weights of its mesh",
+						std::format(
+							"Mesh #{}, primitive #{} has {} targets but {} weights",
+							mesh_index,
+							primitive_idx,
+							deformation.morph_targets.size(),
+							mesh.morph_weights.size()
+						)
+					);
+
+				const bool skinned = !deformation.skin.empty() && skin_index.has_value();
+				jobs.push_back(
+					Job{
+						.vertex_offset = attribute.vertex_offset,
+						.vertex_count = attribute.vertex_count,
+						.bind_offset = static_cast<uint32_t>(bind_vertices.size()),
+						.skin_offset = skinned ? static_cast<uint32_t>(skin.size()) : NO_SKIN,
+						.morph_offset = static_cast<uint32_t>(morph_deltas.size()),
+						.target_count = static_cast<uint32_t>(deformation.morph_targets.size()),
+						.joint_offset = binding.joint_offset,
+						.weight_offset = binding.weight_offset,
+					}
+				);
+
+				bind_vertices.append_range(primitive.geometry.vertices);
+				if (skinned) skin.append_range(deformation.skin);
+
+				// Missing normal deltas are stored as zeros, keeping a fixed stride per target
+				for (const auto& target : deformation.morph_targets)
+				{
+					morph_deltas.append_range(target.position_deltas);
+					if (target.normal_deltas.empty())
+						morph_deltas.resize(morph_deltas.size() + vertex_count, glm::vec3(0.0f));
+					else
+						morph_deltas.append_range(target.normal_deltas);
+				}
+			}
+
+			bindings.push_back(std::move(binding));
+		}
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+		auto resource_creator = std::move(*resource_creator_result);
+
+		auto bind_vertex_buffer_result =
+			create_storage_buffer<model::FullVertex>(context, resource_creator, bind_vertices);
+		if (!bind_vertex_buffer_result)
+			return bind_vertex_buffer_result.error().forward("Create bind-pose vertex buffer failed");
+
+		auto skin_buffer_result = create_storage_buffer<model::VertexSkin>(context, resource_creator, skin);
+		if (!skin_buffer_result) return skin_buffer_result.error().forward("Create skin buffer failed");
+
+		auto morph_buffer_result = create_storage_buffer<glm::vec3>(context, resource_creator, morph_deltas);
+		if (!morph_buffer_result) return morph_buffer_result.error().forward("Create morph buffer failed");
+
+		if (const auto result = resource_creator.execute_uploads(context); !result)
+			return result.error().forward("Execute upload tasks failed");
+
+		return DeformList(
+			std::move(*bind_vertex_buffer_result),
+			std::move(*skin_buffer_result),
+			std::move(*morph_buffer_result),
+			std::move(jobs),
+			std::move(bindings),
+			model.skins,
+			joint_count,
+			weight_count
+		);
+	}
+
+	DeformList::Parameters DeformList::compute_parameters(
+		std::span<const glm::mat4> world_transforms,
+		std::span<const std::vector<float>> node_morph_weights
+	) const noexcept
+	{
+		auto parameters = Parameters{
+			.joint_matrices = std::vector(joint_count, glm::mat4(1.0f)),
+			.morph_weights = std::vector(weight_count, 0.0f),
+		};
+
+		for (const auto& binding : bindings)
+		{
+			if (binding.skin_index.has_value())
+			{
+				const auto joint_matrices =
+					skins[*binding.skin_index].compute_joint_matrices(world_transforms, binding.node_index);
+				std::ranges::copy(joint_matrices, parameters.joint_matrices.begin() + binding.joint_offset);
+			}
+
+			const bool animated = binding.node_index < node_morph_weights.size()
+				&& !node_morph_weights[binding.node_index].empty();
+			const auto& weights = animated ? node_morph_weights[binding.node_index] : binding.default_weights;
+
+			std::ranges::copy(
+				weights | std::views::take(binding.default_weights.size()),
+				parameters.morph_weights.begin() + binding.weight_offset
+			);
+		}
+
+		return parameters;
+	}
+}
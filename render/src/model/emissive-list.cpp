@@ -0,0 +1,168 @@
+#include "render/model/emissive-list.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "model/hierarchy.hpp"
+#include "model/material.hpp"
+#include "render/interface/emissive-triangle.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/scene-graph.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <glm/geometric.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	namespace
+	{
+		// Fill the probabilities and aliases of entries weighted by their current `probability`, see "A
+		// Linear Algorithm for Generating Random Numbers with a Given Distribution" (Vose)
+		void build_alias_table(std::span<EmissiveTriangle> entries) noexcept
+		{
+			const auto weight_sum = std::ranges::fold_left(
+				entries | std::views::transform(&EmissiveTriangle::probability),
+				0.0,
+				std::plus()
+			);
+
+			std::vector<double> scaled(entries.size());
+			std::vector<uint32_t> small, large;
+
+			for (const auto [index, entry] : entries | std::views::enumerate)
+			{
+				entry.probability = static_cast<float>(entry.probability / weight_sum);
+				scaled[index] = double(entry.probability) * entries.size();
+				(scaled[index] < 1.0 ? small : large).push_back(static_cast<uint32_t>(index));
+			}
+
+			while (!small.empty() && !large.empty())
+			{
+				const auto small_index = small.back();
+				const auto large_index = large.back();
+				small.pop_back();
+
+				entries[small_index].alias_threshold = static_cast<float>(scaled[small_index]);
+				entries[small_index].alias = large_index;
+
+				scaled[large_index] -= 1.0 - scaled[small_index];
+				if (scaled[large_index] < 1.0)
+				{
+					large.pop_back();
+					small.push_back(large_index);
+				}
+			}
+
+			// Leftovers are 1 up to rounding errors
+			for (const auto* remaining : {&small, &large})
+				for (const auto index : *remaining)
+				{
+					entries[index].alias_threshold = 1.0f;
+					entries[index].alias = index;
+				}
+		}
+
+		std::expected<vulkan::ArrayBuffer<EmissiveTriangle>, Error> create_triangle_buffer(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			std::span<const EmissiveTriangle> triangles
+		) noexcept
+		{
+			if (!triangles.empty())
+				return resource_creator.create_array_buffer(
+					context,
+					triangles,
+					vk::BufferUsageFlagBits::eStorageBuffer
+				);
+
+			// Zero-sized buffers are not allowed, pad with a dummy triangle while keeping the count 0
+			constexpr auto dummy_triangle = EmissiveTriangle{
+				.node_index = 0,
+				.primitive_index = 0,
+				.triangle = 0,
+				.probability = 0.0f,
+				.alias_threshold = 1.0f,
+				.alias = 0,
+			};
+			return resource_creator
+				.create_buffer(
+					context,
+					util::object_as_bytes(dummy_triangle),
+					vk::BufferUsageFlagBits::eStorageBuffer
+				)
+				.transform([](vulkan::Buffer buffer) {
+					return vulkan::ArrayBuffer<EmissiveTriangle>(std::move(buffer), 0);
+				});
+		}
+	}
+
+	std::expected<EmissiveList, Error> EmissiveList::create(
+		const vulkan::Context& context,
+		const model::Hierarchy& hierarchy,
+		const MeshList& mesh_list,
+		std::span<const model::Material> materials,
+		const SceneGraph& scene_graph
+	) noexcept
+	{
+		std::vector<EmissiveTriangle> triangles;
+
+		for (const auto [node, mesh] : hierarchy.get_renderables())
+		{
+			if (scene_graph.is_hlod_proxy(node)) continue;
+
+			const auto primitive_range = mesh_list->mesh_ranges_array[mesh];
+
+			for (
+				const auto primitive_idx :
+				std::views::iota(primitive_range.offset, primitive_range.offset + primitive_range.count)
+			)
+			{
+				const auto& primitive_attr = mesh_list->primitive_attr_array[primitive_idx];
+				if (primitive_attr.material_index == DEFAULT_MATERIAL
+					|| primitive_attr.material_index >= materials.size())
+					continue;
+
+				const auto emissive_factor = materials[primitive_attr.material_index].param.emissive_factor;
+				const auto luminance = glm::dot(emissive_factor, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+				if (luminance <= 0.0f) continue;
+
+				// Weights are normalized into probabilities by the alias table
+				for (const auto triangle : std::views::iota(0u, primitive_attr.index_count / 3))
+					triangles.push_back(
+						EmissiveTriangle{
+							.node_index = node,
+							.primitive_index = primitive_idx,
+							.triangle = triangle,
+							.probability = luminance,
+							.alias_threshold = 1.0f,
+							.alias = 0,
+						}
+					);
+			}
+		}
+
+		if (!triangles.empty()) build_alias_table(triangles);
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+		auto resource_creator = std::move(*resource_creator_result);
+
+		auto triangle_buffer_result = create_triangle_buffer(context, resource_creator, triangles);
+		if (!triangle_buffer_result)
+			return triangle_buffer_result.error().forward("Create emissive triangle buffer failed");
+
+		if (const auto result = resource_creator.execute_uploads(context); !result)
+			return result.error().forward("Execute upload tasks failed");
+
+		return EmissiveList(std::move(*triangle_buffer_result));
+	}
+}
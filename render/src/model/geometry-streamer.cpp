@@ -0,0 +1,419 @@
+#include "render/model/geometry-streamer.hpp"
+#include "common/util/async.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model-cache.hpp"
+#include "vulkan/container/host/range-allocator.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	// (Helper) Get the count of indices of all levels of a primitive, the levels follow the full geometry
+	[[nodiscard]]
+	static uint32_t get_index_count(const PrimitiveAttribute& attr) noexcept
+	{
+		const auto lods = std::span(attr.lods).first(attr.lod_count);
+		const auto lod_end = [&attr](const PrimitiveLod& lod) {
+			return lod.index_offset + lod.index_count - attr.index_offset;
+		};
+		return std::ranges::max(lods | std::views::transform(lod_end));
+	}
+
+	MeshList::PoolCapacity GeometryStreamer::get_pool_capacity(
+		const MeshList::BakedView& baked,
+		size_t memory_budget
+	) noexcept
+	{
+		const auto vertex_count = baked.vertices.size() + baked.packed_vertices.size();
+		const auto vertex_data_size = vertex_count * vertex_stride(baked.vertex_format);
+		const auto index_data_size = baked.index_count() * index_stride(baked.index_format);
+		const auto total_size = vertex_data_size + index_data_size;
+		if (total_size == 0) return {.vertex_count = 0, .index_count = 0};
+
+		const auto budget = static_cast<double>(std::min(memory_budget, total_size));
+		const auto vertex_budget = budget * static_cast<double>(vertex_data_size) / total_size;
+		const auto index_budget = budget - vertex_budget;
+
+		return {
+			.vertex_count = static_cast<uint32_t>(vertex_budget / vertex_stride(baked.vertex_format)),
+			.index_count = static_cast<uint32_t>(index_budget / index_stride(baked.index_format)),
+		};
+	}
+
+	std::expected<GeometryStreamer, Error> GeometryStreamer::create(
+		const vulkan::Context& context,
+		std::shared_ptr<const ModelCache> source,
+		const MeshList& mesh_list,
+		Option option
+	) noexcept
+	{
+		if (source == nullptr) return Error("Source model cache is null");
+		if (!mesh_list->geometry_pool.has_value()) return Error("Mesh list has no geometry pool");
+
+		const auto& baked = source->view().mesh;
+		if (baked.vertex_format != mesh_list->vertex_format)
+			return Error("Source vertex format mismatches the mesh list");
+		if (baked.index_format != mesh_list->index_format)
+			return Error("Source index format mismatches the mesh list");
+		if (baked.primitive_attrs.size() != mesh_list->primitive_attr_array.size())
+			return Error("Source primitive count mismatches the mesh list");
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+
+		/* Primitives with coarser levels */
+
+		std::vector<Entry> entries;
+		for (const auto [primitive_index, attr] : baked.primitive_attrs | std::views::enumerate)
+		{
+			if (attr.lod_count <= 1) continue;
+
+			entries.push_back(
+				Entry{
+					.primitive_index = static_cast<uint32_t>(primitive_index),
+					.coarse_error = attr.lods[attr.lod_count - 1].error,
+					.index_count = get_index_count(attr)
+				}
+			);
+		}
+
+		return GeometryStreamer(
+			std::move(source),
+			option,
+			std::move(*resource_creator_result),
+			mesh_list,
+			std::move(entries)
+		);
+	}
+
+	std::expected<void, Error> GeometryStreamer::update(
+		const vulkan::Context& context,
+		std::span<const float> primitive_size,
+		float lod_threshold
+	) noexcept
+	{
+		frame++;
+		free_retired();
+
+		apply_feedback(primitive_size, lod_threshold);
+		collect_loads();
+
+		if (const auto result = upload_loaded(context); !result)
+			return result.error().forward("Upload streamed geometry failed");
+
+		start_loads();
+
+		return {};
+	}
+
+	void GeometryStreamer::record(const vk::raii::CommandBuffer& command_buffer) noexcept
+	{
+		if (dirty_entries.empty()) return;
+
+		// Previous frames may still read the primitive attributes
+		const auto pre_update_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(pre_update_barrier));
+
+		for (const auto index : dirty_entries)
+		{
+			const auto& entry = entries[index];
+			command_buffer.updateBuffer<PrimitiveAttribute>(
+				primitive_attr_buffer,
+				entry.primitive_index * sizeof(PrimitiveAttribute),
+				get_attribute(entry)
+			);
+		}
+
+		const auto post_update_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(post_update_barrier));
+
+		dirty_entries.clear();
+	}
+
+	GeometryStreamer::Stat GeometryStreamer::get_stat() const noexcept
+	{
+		const auto resident_count = std::ranges::count_if(entries, [](const Entry& entry) {
+			return entry.resident.has_value();
+		});
+		const auto pending_count = std::ranges::count_if(entries, [](const Entry& entry) {
+			return entry.load.has_value() || entry.loaded.has_value();
+		});
+
+		return {
+			.primitive_count = entries.size(),
+			.resident_count = static_cast<size_t>(resident_count),
+			.pending_count = static_cast<size_t>(pending_count),
+			.resident_size = resident_size,
+			.pool_size = pool.vertex_count * vertex_size + pool.index_count * index_size
+		};
+	}
+
+	PrimitiveAttribute GeometryStreamer::get_attribute(const Entry& entry) const noexcept
+	{
+		if (!entry.resident.has_value()) return coarse_attrs[entry.primitive_index];
+
+		auto attr = source->view().mesh.primitive_attrs[entry.primitive_index];
+		const auto source_index_offset = attr.index_offset;
+
+		// Rebase the levels into the pool ranges, meshlets index the full geometry of the source
+		attr.index_offset = pool.index_offset + static_cast<uint32_t>(entry.resident->index_range.offset);
+		attr.vertex_offset = pool.vertex_offset + static_cast<uint32_t>(entry.resident->vertex_range.offset);
+		attr.meshlet_offset = 0;
+		attr.meshlet_count = 0;
+		for (auto& lod : std::span(attr.lods).first(attr.lod_count))
+			lod.index_offset = lod.index_offset - source_index_offset + attr.index_offset;
+
+		return attr;
+	}
+
+	std::pair<std::span<const std::byte>, std::span<const std::byte>> GeometryStreamer::get_source_data(
+		const Entry& entry
+	) const noexcept
+	{
+		const auto& baked = source->view().mesh;
+		const auto& attr = baked.primitive_attrs[entry.primitive_index];
+
+		const auto vertex_data = baked.vertex_format == VertexFormat::Packed
+			? util::as_bytes(baked.packed_vertices)
+			: util::as_bytes(baked.vertices);
+
+		return {
+			vertex_data.subspan(attr.vertex_offset * vertex_size, attr.vertex_count * vertex_size),
+			baked.index_bytes(attr.index_offset, entry.index_count)
+		};
+	}
+
+	void GeometryStreamer::apply_feedback(std::span<const float> primitive_size, float lod_threshold) noexcept
+	{
+		if (primitive_size.size() != coarse_attrs.size()) return;
+
+		for (auto& entry : entries)
+		{
+			// Same test as the level selection of the indirect pipeline, `0` if not visible
+			const auto size = primitive_size[entry.primitive_index];
+			const bool too_coarse =
+				size > 0 && (lod_threshold <= 0 || entry.coarse_error * size > lod_threshold);
+
+			// Decay, so that primitives no longer needed lose priority over time
+			entry.priority = entry.priority / 2 + (too_coarse ? size : 0.0f);
+			if (too_coarse) entry.last_used = frame;
+		}
+	}
+
+	void GeometryStreamer::collect_loads() noexcept
+	{
+		for (auto& entry : entries)
+		{
+			if (!entry.load.has_value() || !entry.load->ready()) continue;
+
+			entry.loaded = std::move(*entry.load).get();
+			entry.load.reset();
+		}
+	}
+
+	void GeometryStreamer::start_loads() noexcept
+	{
+		auto pending_count = std::ranges::count_if(entries, [](const Entry& entry) {
+			return entry.load.has_value();
+		});
+		if (std::cmp_greater_equal(pending_count, option.max_pending_loads)) return;
+
+		auto candidates =
+			std::views::iota(0zu, entries.size())
+			| std::views::filter([this](size_t index) {
+				  const auto& entry = entries[index];
+				  return entry.priority > 0
+					  && entry.last_used == frame
+					  && frame >= entry.retry_frame
+					  && !entry.load.has_value()
+					  && !entry.loaded.has_value()
+					  && !entry.resident.has_value();
+			  })
+			| std::ranges::to<std::vector>();
+		const auto get_priority = [this](size_t index) { return entries[index].priority; };
+		std::ranges::sort(candidates, std::greater(), get_priority);
+
+		for (const auto index : candidates)
+		{
+			if (std::cmp_greater_equal(pending_count, option.max_pending_loads)) break;
+
+			auto& entry = entries[index];
+			const auto [vertex_data, index_data] = get_source_data(entry);
+
+			// Reading the mapped cache may fault pages in from disk, kept off the render thread
+			const auto load_func = [source = source, vertex_data, index_data]() noexcept -> Loaded {
+				return Loaded{
+					.vertices = vertex_data | std::ranges::to<std::vector>(),
+					.indices = index_data | std::ranges::to<std::vector>()
+				};
+			};
+			auto future = std::async(std::launch::async, load_func);
+
+			entry.load = util::Future(std::move(future));
+			pending_count++;
+		}
+	}
+
+	std::expected<void, Error> GeometryStreamer::upload_loaded(const vulkan::Context& context) noexcept
+	{
+		auto candidates =
+			std::views::iota(0zu, entries.size())
+			| std::views::filter([this](size_t index) {
+				  const auto& entry = entries[index];
+				  return entry.loaded.has_value() && frame >= entry.retry_frame;
+			  })
+			| std::ranges::to<std::vector>();
+		if (candidates.empty()) return {};
+		const auto get_priority = [this](size_t index) { return entries[index].priority; };
+		std::ranges::sort(candidates, std::greater(), get_priority);
+
+		/* Upload within budget */
+
+		std::vector<std::pair<size_t, Resident>> uploaded;
+		size_t upload_size = 0;
+
+		for (const auto index : candidates)
+		{
+			auto& entry = entries[index];
+			const auto& loaded = *entry.loaded;
+			const auto size = loaded.vertices.size() + loaded.indices.size();
+			if (!uploaded.empty() && upload_size + size > option.max_upload_size) break;
+
+			const auto resident = allocate(entry);
+			if (!resident.has_value())
+			{
+				// Doesn't fit for now, retry later if still needed
+				entry.loaded.reset();
+				entry.retry_frame = frame + option.evict_delay;
+				continue;
+			}
+
+			using Region = vulkan::StaticResourceCreator::BufferRegion;
+			const auto regions = std::to_array<Region>({
+				{.buffer = vertex_buffer,
+				 .offset = (pool.vertex_offset + resident->vertex_range.offset) * vertex_size,
+				 .size = loaded.vertices.size()},
+				{.buffer = index_buffer,
+				 .offset = (pool.index_offset + resident->index_range.offset) * index_size,
+				 .size = loaded.indices.size()},
+			});
+
+			const auto write = [&loaded](std::span<const std::span<std::byte>> destinations) {
+				std::ranges::copy(loaded.vertices, destinations[0].begin());
+				std::ranges::copy(loaded.indices, destinations[1].begin());
+				return std::expected<void, Error>();
+			};
+
+			if (const auto result = resource_creator.write_buffers_in_place(context, regions, write); !result)
+			{
+				vertex_allocator.free(resident->vertex_range);
+				index_allocator.free(resident->index_range);
+				return result.error().forward("Write primitive geometry failed");
+			}
+
+			entry.loaded.reset();
+			uploaded.emplace_back(index, *resident);
+			resident_size += size;
+			upload_size += size;
+		}
+
+		if (uploaded.empty()) return {};
+
+		if (const auto result = resource_creator.execute_uploads(context); !result)
+			return result.error().forward("Execute upload tasks failed");
+
+		/* Swap in */
+
+		for (const auto& [index, resident] : uploaded)
+		{
+			entries[index].resident = resident;
+			dirty_entries.insert(static_cast<uint32_t>(index));
+		}
+
+		return {};
+	}
+
+	std::optional<GeometryStreamer::Resident> GeometryStreamer::allocate(const Entry& entry) noexcept
+	{
+		const auto& attr = source->view().mesh.primitive_attrs[entry.primitive_index];
+
+		while (true)
+		{
+			const auto vertex_range = vertex_allocator.allocate(attr.vertex_count);
+			const auto index_range =
+				vertex_range.has_value() ? index_allocator.allocate(entry.index_count) : std::nullopt;
+			if (index_range.has_value())
+				return Resident{.vertex_range = *vertex_range, .index_range = *index_range};
+			if (vertex_range.has_value()) vertex_allocator.free(*vertex_range);
+
+			auto evictable =
+				std::views::iota(0zu, entries.size())
+				| std::views::filter([this, &entry](size_t index) {
+					  const auto& candidate = entries[index];
+					  return candidate.resident.has_value()
+						  && candidate.last_used + option.evict_delay < frame
+						  && candidate.priority < entry.priority;
+				  });
+
+			const auto get_priority = [this](size_t index) { return entries[index].priority; };
+			const auto victim = std::ranges::min_element(evictable, {}, get_priority);
+			if (victim == evictable.end()) return std::nullopt;
+
+			evict(static_cast<uint32_t>(*victim));
+		}
+	}
+
+	void GeometryStreamer::evict(uint32_t index) noexcept
+	{
+		auto& entry = entries[index];
+		const auto& resident = *entry.resident;
+		resident_size -= resident.vertex_range.size * vertex_size + resident.index_range.size * index_size;
+
+		// Frames in flight may still draw from the pool ranges
+		retired.push_back(Retired{.frame = frame + option.frames_in_flight, .resident = resident});
+		entry.resident.reset();
+		entry.retry_frame = frame + option.frames_in_flight;
+
+		dirty_entries.insert(index);
+	}
+
+	void GeometryStreamer::free_retired() noexcept
+	{
+		for (const auto& item : retired)
+		{
+			if (item.frame > frame) continue;
+			vertex_allocator.free(item.resident.vertex_range);
+			index_allocator.free(item.resident.index_range);
+		}
+
+		std::erase_if(retired, [this](const Retired& item) { return item.frame <= frame; });
+	}
+}
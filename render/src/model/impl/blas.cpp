@@ -1,6 +1,7 @@
 #include "model/blas.hpp"
 #include "common/util/align.hpp"
 #include "common/util/error.hpp"
+#include "common/util/trace.hpp"
 #include "model/material.hpp"
 #include "model/mesh.hpp"
 #include "render/model/material.hpp"
@@ -9,13 +10,25 @@
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/util/command-runner.hpp"
+
 #include <algorithm>
+#include <array>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <expected>
+#include <format>
+#include <functional>
+#include <iterator>
 #include <libassert/assert.hpp>
+#include <optional>
 #include <ranges>
 #include <span>
+#include <stop_token>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -23,44 +36,51 @@
 
 namespace render::impl
 {
-	// Future TODO: Compact
-	static constexpr vk::BuildAccelerationStructureFlagsKHR BLAS_BUILD_FLAGS =
-		vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace;
+	// (Helper) Whether a primitive is traced as opaque geometry
+	[[nodiscard]]
+	static bool is_opaque(const MaterialList& material_list, const PrimitiveAttribute& attribute) noexcept
+	{
+		const auto mode = material_list.query_material_mode(attribute.material_index);
+		return mode.alpha_mode == model::AlphaMode::Opaque;
+	}
 
-	std::expected<MeshBlasPrototype, Error> MeshBlasPrototype::create(
+	MeshBlasPrototype MeshBlasPrototype::create(
 		const vulkan::Context& context,
 		const MaterialList& material_list,
 		std::span<const PrimitiveAttribute> primitive_attrs,
-		vk::DeviceAddress vertex_buffer_addr,
+		vk::DeviceAddress position_buffer_addr,
+		vk::DeviceSize position_stride,
 		vk::DeviceAddress index_buffer_addr,
-		PrimitiveIndexRange mesh
+		PrimitiveIndexRange mesh,
+		vk::BuildAccelerationStructureFlagsKHR build_flags,
+		bool allow_compaction
 	) noexcept
 	{
 		ASSERT(mesh.count > 0);
 
+		if (allow_compaction) build_flags |= vk::BuildAccelerationStructureFlagBitsKHR::eAllowCompaction;
+
 		const auto primitives = primitive_attrs.subspan(mesh.offset, mesh.count);
 
 		const auto get_geometry =
-			[&material_list, vertex_buffer_addr, index_buffer_addr](const PrimitiveAttribute& attribute) {
-				const auto vertex_addr =
-					vertex_buffer_addr + sizeof(model::FullVertex) * attribute.vertex_offset;
-				const auto index_addr = index_buffer_addr + sizeof(uint32_t) * attribute.index_offset;
+			[=, &material_list](const PrimitiveAttribute& attribute) {
+				const auto vertex_addr = position_buffer_addr + position_stride * attribute.vertex_offset;
+				const auto index_addr = index_buffer_addr + attribute.index_size * attribute.index_offset;
+				const auto index_type = attribute.index_size == sizeof(uint16_t)
+					? vk::IndexType::eUint16
+					: vk::IndexType::eUint32;
 
 				const auto triangle_geometry = vk::AccelerationStructureGeometryTrianglesDataKHR{
 					.vertexFormat = vk::Format::eR32G32B32Sfloat,
 					.vertexData = vertex_addr,
-					.vertexStride = sizeof(model::FullVertex),
+					.vertexStride = position_stride,
 					.maxVertex = attribute.vertex_count - 1,
-					.indexType = vk::IndexType::eUint32,
+					.indexType = index_type,
 					.indexData = index_addr
 				};
 
 				vk::GeometryFlagsKHR geometry_flags = {};
-				if (material_list.query_material_mode(attribute.material_index).alpha_mode
-					== model::AlphaMode::Opaque)
-				{
-					geometry_flags |= vk::GeometryFlagBitsKHR::eOpaque;
-				}
+				if (is_opaque(material_list, attribute)) geometry_flags |= vk::GeometryFlagBitsKHR::eOpaque;
 
 				const auto geometry_info = vk::AccelerationStructureGeometryKHR{
 					.geometryType = vk::GeometryTypeKHR::eTriangles,
@@ -95,7 +115,7 @@ namespace render::impl
 			vk::AccelerationStructureBuildGeometryInfoKHR()
 				.setType(vk::AccelerationStructureTypeKHR::eBottomLevel)
 				.setMode(vk::BuildAccelerationStructureModeKHR::eBuild)
-				.setFlags(BLAS_BUILD_FLAGS)
+				.setFlags(build_flags)
 				.setGeometries(geometries);
 
 		const auto build_sizes = context.device.getAccelerationStructureBuildSizesKHR(
@@ -104,82 +124,348 @@ namespace render::impl
 			primitive_counts
 		);
 
-		/* Create BLAS */
-
-		const auto blas_buffer_create_info = vk::BufferCreateInfo{
-			.size = build_sizes.accelerationStructureSize,
-			.usage = vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR
-				| vk::BufferUsageFlagBits::eShaderDeviceAddress
-		};
-		auto blas_buffer_result =
-			context.allocator.create_buffer(blas_buffer_create_info, vulkan::MemoryUsage::GpuOnly);
-		if (!blas_buffer_result) return blas_buffer_result.error().forward("Create BLAS buffer failed");
-		auto blas_buffer = std::move(*blas_buffer_result);
-
-		const auto blas_create_info = vk::AccelerationStructureCreateInfoKHR{
-			.buffer = blas_buffer,
-			.offset = 0,
-			.size = build_sizes.accelerationStructureSize,
-			.type = vk::AccelerationStructureTypeKHR::eBottomLevel,
-		};
-		auto blas_result = context.device.createAccelerationStructureKHR(blas_create_info);
-		if (!blas_result) return Error::from(blas_result).forward("Create BLAS failed");
-
 		return MeshBlasPrototype{
-			.buffer = std::move(blas_buffer),
-			.blas = std::move(*blas_result),
+			.blas_size = build_sizes.accelerationStructureSize,
 			.scratch_size = build_sizes.buildScratchSize,
+			.update_scratch_size = build_sizes.updateScratchSize,
+			.build_flags = build_flags,
 			.geometries = std::move(geometries),
 			.build_range = std::move(build_ranges),
 		};
 	}
 
-	std::expected<std::vector<MeshBlasPrototype>, Error> create_blas(
+	BlasSharing share_blas(
+		const MeshList& mesh_list,
+		const MaterialList& material_list,
+		std::span<const uint32_t> exclusive_meshes
+	) noexcept
+	{
+		const auto meshes = mesh_list->mesh_ranges_array;
+		const auto hashes = mesh_list->mesh_geometry_hash_array;
+		const auto attributes = mesh_list->primitive_attr_array;
+
+		const auto same_primitive = [&material_list](const auto& a, const auto& b) {
+			return a.vertex_count == b.vertex_count
+				&& a.index_count == b.index_count
+				&& is_opaque(material_list, a) == is_opaque(material_list, b);
+		};
+		const auto same_mesh = [&](uint32_t a, uint32_t b) {
+			return std::ranges::equal(
+				attributes.subspan(meshes[a].offset, meshes[a].count),
+				attributes.subspan(meshes[b].offset, meshes[b].count),
+				same_primitive
+			);
+		};
+
+		auto sharing = BlasSharing();
+		sharing.mesh_blas_index.reserve(meshes.size());
+
+		// BLASes created so far, by the geometry hash of their meshes
+		std::unordered_map<uint64_t, std::vector<uint32_t>> blas_by_hash;
+
+		std::vector<bool> exclusive(meshes.size(), false);
+		for (const auto mesh_idx : exclusive_meshes)
+			if (mesh_idx < meshes.size()) exclusive[mesh_idx] = true;
+
+		for (const auto mesh_idx : std::views::iota(0u, static_cast<uint32_t>(meshes.size())))
+		{
+			// Without geometry hashes, every mesh gets its own BLAS
+			if (hashes.size() != meshes.size() || exclusive[mesh_idx])
+			{
+				sharing.mesh_blas_index.push_back(static_cast<uint32_t>(sharing.blas_mesh_index.size()));
+				sharing.blas_mesh_index.push_back(mesh_idx);
+				continue;
+			}
+
+			auto& candidates = blas_by_hash[hashes[mesh_idx]];
+			const auto shared = std::ranges::find_if(candidates, [&](uint32_t blas_idx) {
+				return same_mesh(sharing.blas_mesh_index[blas_idx], mesh_idx);
+			});
+
+			if (shared != candidates.end())
+			{
+				sharing.mesh_blas_index.push_back(*shared);
+				continue;
+			}
+
+			const auto blas_idx = static_cast<uint32_t>(sharing.blas_mesh_index.size());
+			sharing.blas_mesh_index.push_back(mesh_idx);
+			sharing.mesh_blas_index.push_back(blas_idx);
+			candidates.push_back(blas_idx);
+		}
+
+		return sharing;
+	}
+
+	// Meshes sized per task, sizing is cheap so that meshes are batched to amortize scheduling
+	static constexpr size_t PROTOTYPE_BATCH_SIZE = 256;
+
+	// (Helper) Inputs shared by the prototypes of all meshes
+	struct PrototypeSource
+	{
+		std::span<const PrimitiveIndexRange> mesh_ranges;
+		std::span<const PrimitiveAttribute> primitive_attrs;
+		vk::DeviceAddress position_buffer_addr;
+		vk::DeviceSize position_stride;
+		vk::DeviceAddress index_buffer_addr;
+		vk::BuildAccelerationStructureFlagsKHR build_flags;
+		bool allow_compaction;
+	};
+
+	// (Helper) Create prototypes of a batch of meshes on the thread pool
+	static coro::task<std::vector<MeshBlasPrototype>> create_prototype_batch(
+		coro::thread_pool& thread_pool,
+		const vulkan::Context& context,
+		const MaterialList& material_list,
+		PrototypeSource source,
+		std::span<const uint32_t> meshes
+	) noexcept
+	{
+		co_await thread_pool.schedule();
+
+		const auto trace = util::trace::Scope("Create BLAS prototypes", meshes.size());
+
+		const auto create_prototype = [&context, &material_list, &source](uint32_t mesh_idx) {
+			return MeshBlasPrototype::create(
+				context,
+				material_list,
+				source.primitive_attrs,
+				source.position_buffer_addr,
+				source.position_stride,
+				source.index_buffer_addr,
+				source.mesh_ranges[mesh_idx],
+				source.build_flags,
+				source.allow_compaction
+			);
+		};
+
+		co_return meshes | std::views::transform(create_prototype) | std::ranges::to<std::vector>();
+	}
+
+	coro::task<std::vector<MeshBlasPrototype>> create_blas(
+		coro::thread_pool& thread_pool,
 		const vulkan::Context& context,
 		const MeshList& mesh_list,
-		const MaterialList& material_list
+		const MaterialList& material_list,
+		std::span<const uint32_t> meshes,
+		vk::BuildAccelerationStructureFlagsKHR build_flags,
+		bool allow_compaction
 	) noexcept
 	{
-		const vk::DeviceAddress vertex_buffer_addr =
-			context.device.getBufferAddress({.buffer = mesh_list->vertex_buffer});
-		const vk::DeviceAddress index_buffer_addr =
-			context.device.getBufferAddress({.buffer = mesh_list->index_buffer});
-
-		auto blas_prototypes_result =
-			mesh_list->mesh_ranges_array
-			| std::views::transform(
-				[vertex_buffer_addr, index_buffer_addr, &context, &material_list, &mesh_list](
-					const PrimitiveIndexRange& range
-				) {
-					return impl::MeshBlasPrototype::create(
-						context,
-						material_list,
-						mesh_list->primitive_attr_array,
-						vertex_buffer_addr,
-						index_buffer_addr,
-						range
-					);
-				}
-			)
-			| Error::collect();
+		const auto source = PrototypeSource{
+			.mesh_ranges = mesh_list->mesh_ranges_array,
+			.primitive_attrs = mesh_list->primitive_attr_array,
+			.position_buffer_addr = context.device.getBufferAddress({.buffer = mesh_list->position_buffer}),
+			.position_stride = mesh_list->position_stride,
+			.index_buffer_addr = context.device.getBufferAddress({.buffer = mesh_list->index_buffer}),
+			.build_flags = build_flags,
+			.allow_compaction = allow_compaction,
+		};
+
+		std::vector<coro::task<std::vector<MeshBlasPrototype>>> tasks;
+		for (size_t offset = 0; offset < meshes.size(); offset += PROTOTYPE_BATCH_SIZE)
+		{
+			const auto batch = meshes.subspan(offset, std::min(PROTOTYPE_BATCH_SIZE, meshes.size() - offset));
+			tasks.push_back(create_prototype_batch(thread_pool, context, material_list, source, batch));
+		}
 
-		if (!blas_prototypes_result)
-			return blas_prototypes_result.error().forward("Create BLAS prototypes failed");
+		auto batch_results = co_await coro::when_all(std::move(tasks));
 
-		return blas_prototypes_result;
+		std::vector<MeshBlasPrototype> prototypes;
+		prototypes.reserve(meshes.size());
+		for (auto& batch_result : batch_results)
+			std::ranges::move(batch_result.return_value(), std::back_inserter(prototypes));
+
+		co_return prototypes;
 	}
 
-	// Minimum scratch buffer size of 64MiB
-	static constexpr auto MIN_SCRATCH_BUFFER_SIZE = 64 * 1048576zu;
+	// BLASes are suballocated from arenas of this size, larger BLASes get a buffer of their own
+	static constexpr vk::DeviceSize BLAS_ARENA_SIZE = 256 * 1048576zu;
 
-	std::expected<BuildBlasResult, Error> build_blas(
+	// Acceleration structures must be placed at offsets aligned to 256 bytes
+	static constexpr vk::DeviceSize BLAS_OFFSET_ALIGNMENT = 256;
+
+	// (Helper) BLASes suballocated from a few large buffers
+	struct BlasStorage
+	{
+		std::vector<vulkan::Buffer> arenas;
+		std::vector<vk::raii::AccelerationStructureKHR> blas;  // Same indexing as the requested sizes
+		std::vector<size_t> arena_index;                        // Index of the arena holding each BLAS
+	};
+
+	///
+	/// @brief Create BLASes, suballocated from arenas
+	///
+	/// @param context Vulkan context
+	/// @param sizes Size of each BLAS
+	/// @param order Order to pack the BLASes into arenas, BLASes close in order share an arena
+	/// @return Created BLASes and their storage, or error
+	///
+	static std::expected<BlasStorage, Error> create_blas_storage(
 		const vulkan::Context& context,
-		std::vector<MeshBlasPrototype> prototypes
+		std::span<const vk::DeviceSize> sizes,
+		std::span<const size_t> order
 	) noexcept
 	{
-		/* Create Environment */
+		/* Pack into arenas */
+
+		std::vector<size_t> arena_index(sizes.size());
+		std::vector<vk::DeviceSize> offsets(sizes.size());
+		std::vector<vk::DeviceSize> arena_sizes;
 
-		// Get scratch alignment
+		for (const auto idx : order)
+		{
+			const auto offset =
+				arena_sizes.empty() ? 0 : util::align_address(arena_sizes.back(), BLAS_OFFSET_ALIGNMENT);
+
+			if (arena_sizes.empty() || offset + sizes[idx] > BLAS_ARENA_SIZE)
+			{
+				arena_index[idx] = arena_sizes.size();
+				offsets[idx] = 0;
+				arena_sizes.push_back(sizes[idx]);
+			}
+			else
+			{
+				arena_index[idx] = arena_sizes.size() - 1;
+				offsets[idx] = offset;
+				arena_sizes.back() = offset + sizes[idx];
+			}
+		}
+
+		/* Create arenas */
+
+		// Built on the compute queue, traced on the main queue
+		const auto queue_families = context.unique_families();
+
+		std::vector<vulkan::Buffer> arenas;
+		arenas.reserve(arena_sizes.size());
+
+		for (const auto arena_size : arena_sizes)
+		{
+			const auto buffer_create_info = vk::BufferCreateInfo{
+				.size = arena_size,
+				.usage = vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR
+					| vk::BufferUsageFlagBits::eShaderDeviceAddress,
+				.sharingMode = context.multi_queue_sharing_mode(),
+				.queueFamilyIndexCount = static_cast<uint32_t>(queue_families.size()),
+				.pQueueFamilyIndices = queue_families.data(),
+			};
+			auto buffer_result = context.allocator.create_buffer(
+				buffer_create_info,
+				vulkan::MemoryUsage::GpuOnly,
+				vulkan::MemoryCategory::AccelerationStructure,
+				"BLAS Arena"
+			);
+			if (!buffer_result) return buffer_result.error().forward("Create BLAS arena failed");
+
+			arenas.push_back(std::move(*buffer_result));
+		}
+
+		/* Create BLASes */
+
+		std::vector<vk::raii::AccelerationStructureKHR> blas_list;
+		blas_list.reserve(sizes.size());
+
+		for (const auto [size, arena, offset] : std::views::zip(sizes, arena_index, offsets))
+		{
+			const auto blas_create_info = vk::AccelerationStructureCreateInfoKHR{
+				.buffer = arenas[arena],
+				.offset = offset,
+				.size = size,
+				.type = vk::AccelerationStructureTypeKHR::eBottomLevel,
+			};
+			auto blas_result = context.device.createAccelerationStructureKHR(blas_create_info);
+			if (!blas_result) return Error::from(blas_result).forward("Create BLAS failed");
+
+			blas_list.push_back(std::move(*blas_result));
+		}
+
+		return BlasStorage{
+			.arenas = std::move(arenas),
+			.blas = std::move(blas_list),
+			.arena_index = std::move(arena_index),
+		};
+	}
+
+	///
+	/// @brief Compact a built batch of BLASes, replacing the original BLASes in @p blas_list
+	///
+	/// @param context Vulkan context
+	/// @param command_runner Command runner
+	/// @param blas_list All BLASes
+	/// @param blas_sizes Sizes of all BLASes, updated to the compacted sizes
+	/// @param batch Indices of the BLASes in the batch
+	/// @param query_pool Query pool holding the compacted sizes of the batch, in the same order as @p batch
+	/// @return Arenas holding the compacted BLASes, or error
+	///
+	static std::expected<std::vector<vulkan::Buffer>, Error> compact_blas_batch(
+		const vulkan::Context& context,
+		const vulkan::CommandRunner& command_runner,
+		std::span<vk::raii::AccelerationStructureKHR> blas_list,
+		std::span<vk::DeviceSize> blas_sizes,
+		std::span<const size_t> batch,
+		const vk::raii::QueryPool& query_pool
+	) noexcept
+	{
+		/* Query compacted sizes */
+
+		const auto [query_result, compacted_sizes] = query_pool.getResults<vk::DeviceSize>(
+			0,
+			static_cast<uint32_t>(batch.size()),
+			batch.size() * sizeof(vk::DeviceSize),
+			sizeof(vk::DeviceSize),
+			vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait
+		);
+		if (query_result != vk::Result::eSuccess)
+			return Error::from(query_result).forward("Query compacted sizes failed");
+
+		/* Create compacted BLASes */
+
+		const auto order = std::views::iota(0zu, batch.size()) | std::ranges::to<std::vector>();
+		auto storage_result = create_blas_storage(context, compacted_sizes, order);
+		if (!storage_result) return storage_result.error().forward("Create compacted BLAS storage failed");
+		auto storage = std::move(*storage_result);
+
+		/* Copy */
+
+		const auto run_result = command_runner.run(
+			context,
+			[&blas_list, &batch, &storage](const vk::raii::CommandBuffer& command_buffer) {
+				for (const auto& [blas_idx, compacted] : std::views::zip(batch, storage.blas))
+				{
+					command_buffer.copyAccelerationStructureKHR({
+						.src = blas_list[blas_idx],
+						.dst = compacted,
+						.mode = vk::CopyAccelerationStructureModeKHR::eCompact,
+					});
+				}
+			}
+		);
+		if (!run_result) return run_result.error().forward("Copy compacted BLAS failed");
+
+		/* Replace, originals are destroyed here */
+
+		for (auto&& [blas_idx, compacted, compacted_size] :
+			 std::views::zip(batch, storage.blas, compacted_sizes))
+		{
+			blas_list[blas_idx] = std::move(compacted);
+			blas_sizes[blas_idx] = compacted_size;
+		}
+
+		return std::move(storage.arenas);
+	}
+
+	static vk::DeviceSize get_total_size(std::span<const vk::DeviceSize> sizes) noexcept
+	{
+		return std::ranges::fold_left(sizes, vk::DeviceSize(0), std::plus());
+	}
+
+	// Minimum scratch buffer size of 64MiB
+	static constexpr auto MIN_SCRATCH_BUFFER_SIZE = 64 * 1048576zu;
+
+	// (Helper) Get the alignment of scratch buffer addresses
+	static vk::DeviceSize get_scratch_alignment(const vulkan::Context& context) noexcept
+	{
 		const auto as_properties =
 			context.phy_device
 				.getProperties2<
@@ -187,7 +473,19 @@ namespace render::impl
 					vk::PhysicalDeviceAccelerationStructurePropertiesKHR
 				>()
 				.get<vk::PhysicalDeviceAccelerationStructurePropertiesKHR>();
-		const auto scratch_alignment = as_properties.minAccelerationStructureScratchOffsetAlignment;
+		return as_properties.minAccelerationStructureScratchOffsetAlignment;
+	}
+
+	std::expected<BuildBlasResult, Error> build_blas(
+		const vulkan::Context& context,
+		std::span<const MeshBlasPrototype> prototypes,
+		bool compact,
+		std::stop_token stop_token
+	) noexcept
+	{
+		/* Create Environment */
+
+		const auto scratch_alignment = get_scratch_alignment(context);
 
 		// Find maximum needed scratch buffer size
 		const auto max_scratch_size =
@@ -202,7 +500,9 @@ namespace render::impl
 				.usage =
 					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
 			},
-			vulkan::MemoryUsage::GpuOnly
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::AccelerationStructure,
+			"BLAS Scratch"
 		);
 		if (!scratch_buffer_result)
 			return scratch_buffer_result.error().forward("Create scratch buffer failed");
@@ -212,11 +512,18 @@ namespace render::impl
 			scratch_alignment
 		);
 
-		auto command_runner_result = vulkan::CommandRunner::create(context);
+		// Build on the async compute queue, leaving the main queue free for rendering during load
+		auto command_runner_result =
+			vulkan::CommandRunner::create(context, vulkan::CommandRunner::QueueType::Compute);
 		if (!command_runner_result)
 			return command_runner_result.error().forward("Create command runner failed");
 		auto command_runner = std::move(*command_runner_result);
 
+		auto blas_sizes = prototypes
+			| std::views::transform(&MeshBlasPrototype::blas_size)
+			| std::ranges::to<std::vector>();
+		const auto original_size = get_total_size(blas_sizes);
+
 		/* Sort by scratch size */
 
 		std::vector<size_t> prototype_index(std::from_range, std::views::iota(0zu, prototypes.size()));
@@ -224,10 +531,85 @@ namespace render::impl
 			return prototypes[left].scratch_size < prototypes[right].scratch_size;
 		});
 
+		/* Create storage */
+
+		// Packed in build order (popped from the back), so that arenas are released early when compacting
+		const auto build_order = prototype_index | std::views::reverse | std::ranges::to<std::vector>();
+		auto storage_result = create_blas_storage(context, blas_sizes, build_order);
+		if (!storage_result) return storage_result.error().forward("Create BLAS storage failed");
+		auto storage = std::move(*storage_result);
+		auto& blas_list = storage.blas;
+
+		auto arenas = std::vector<std::optional<vulkan::Buffer>>(
+			std::from_range,
+			storage.arenas | std::views::as_rvalue
+		);
+		std::vector<vulkan::Buffer> compacted_arenas;
+
+		// Count of BLASes not yet compacted in each arena
+		std::vector<size_t> arena_remaining(arenas.size(), 0);
+		for (const auto arena : storage.arena_index) arena_remaining[arena]++;
+
+		/* Build in batches, recording a batch while the previous one executes */
+
+		struct PendingBatch
+		{
+			std::vector<size_t> batch;
+			vk::raii::QueryPool query_pool;
+			vulkan::CommandRunner::Ticket ticket;
+		};
+
+		// Compaction of a batch is deferred until the next batch has been submitted
+		std::optional<PendingBatch> pending_batch;
+
+		const auto finish_batch = [&](const PendingBatch& pending) -> std::expected<void, Error> {
+			const auto trace = util::trace::Scope("Finish BLAS batch", pending.batch.size());
+
+			if (const auto result = command_runner.wait(context, pending.ticket); !result)
+				return result.error().forward("Build acceleration structure failed");
+
+			if (!compact) return {};
+
+			auto compact_result = compact_blas_batch(
+				context,
+				command_runner,
+				blas_list,
+				blas_sizes,
+				pending.batch,
+				pending.query_pool
+			);
+			if (!compact_result)
+				return compact_result.error().forward("Compact acceleration structure failed");
+			std::ranges::move(*compact_result, std::back_inserter(compacted_arenas));
+
+			// Release arenas whose BLASes are all replaced by compacted ones
+			for (const auto idx : pending.batch)
+			{
+				const auto arena = storage.arena_index[idx];
+				if (--arena_remaining[arena] == 0) arenas[arena].reset();
+			}
+
+			return {};
+		};
+
 		while (!prototype_index.empty())
 		{
+			if (stop_token.stop_requested())
+			{
+				// The batch in flight still uses the scratch buffer and the command runner
+				if (pending_batch)
+					if (const auto result = command_runner.wait(context, pending_batch->ticket); !result)
+						return result.error().forward("Wait for acceleration structure build failed");
+
+				return Error("Cancelled");
+			}
+
+			// Records and submits the batch, then finishes the previous batch
+			const auto trace = util::trace::Scope("Build BLAS batch");
+
 			auto current_base = scratch_addr;
 
+			std::vector<size_t> batch;
 			std::vector<vk::AccelerationStructureBuildGeometryInfoKHR> build_geometry_infos;
 			std::vector<std::vector<vk::AccelerationStructureBuildRangeInfoKHR>> build_range_infos;
 
@@ -246,44 +628,379 @@ namespace render::impl
 					vk::AccelerationStructureBuildGeometryInfoKHR()
 						.setType(vk::AccelerationStructureTypeKHR::eBottomLevel)
 						.setMode(vk::BuildAccelerationStructureModeKHR::eBuild)
-						.setDstAccelerationStructure(prototype.blas)
+						.setDstAccelerationStructure(blas_list[prototype_index.back()])
 						.setScratchData(current_base)
-						.setFlags(BLAS_BUILD_FLAGS)
+						.setFlags(prototype.build_flags)
 						.setGeometries(prototype.geometries)
 				);
 				build_range_infos.emplace_back(prototype.build_range);
+				batch.push_back(prototype_index.back());
 
 				prototype_index.pop_back();
 				current_base += aligned_scratch_size;
 			}
-
 			/* Build */
 
 			const auto build_range_info_ptrs = build_range_infos
 				| std::views::transform([](const auto& obj) { return obj.data(); })
 				| std::ranges::to<std::vector>();
 
-			const auto run_result = command_runner.run(
+			vk::raii::QueryPool query_pool = nullptr;
+			if (compact)
+			{
+				auto query_pool_result = context.device.createQueryPool({
+					.queryType = vk::QueryType::eAccelerationStructureCompactedSizeKHR,
+					.queryCount = static_cast<uint32_t>(batch.size()),
+				});
+				if (!query_pool_result)
+					return Error::from(query_pool_result).forward("Create query pool failed");
+				query_pool = std::move(*query_pool_result);
+			}
+
+			const auto blas_handles =
+				batch
+				| std::views::transform([&blas_list](size_t idx) { return *blas_list[idx]; })
+				| std::ranges::to<std::vector>();
+
+			const auto submit_result = command_runner.submit_async(
 				context,
-				[&build_range_info_ptrs,
-				 &build_geometry_infos](const vk::raii::CommandBuffer& command_buffer) {
+				[&build_range_info_ptrs, &build_geometry_infos, &query_pool, &blas_handles, compact](
+					const vk::raii::CommandBuffer& command_buffer
+				) {
+					// The scratch buffer is reused by consecutive batches in flight
+					const auto scratch_barrier = vk::MemoryBarrier2{
+						.srcStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+						.srcAccessMask = vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+						.dstStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+						.dstAccessMask = vk::AccessFlagBits2::eAccelerationStructureReadKHR
+							| vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+					};
+					command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(scratch_barrier));
+
+					const auto query_count = static_cast<uint32_t>(blas_handles.size());
+					if (compact) command_buffer.resetQueryPool(query_pool, 0, query_count);
+
 					command_buffer
 						.buildAccelerationStructuresKHR(build_geometry_infos, build_range_info_ptrs);
+
+					if (!compact) return;
+
+					// Compacted size is only available after the build finishes
+					const auto query_barrier = vk::MemoryBarrier2{
+						.srcStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+						.srcAccessMask = vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+						.dstStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+						.dstAccessMask = vk::AccessFlagBits2::eAccelerationStructureReadKHR,
+					};
+					command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(query_barrier));
+					command_buffer.writeAccelerationStructuresPropertiesKHR(
+						blas_handles,
+						vk::QueryType::eAccelerationStructureCompactedSizeKHR,
+						query_pool,
+						0
+					);
 				}
 			);
-			if (!run_result) return run_result.error().forward("Build acceleration structure failed");
+			if (!submit_result)
+				return submit_result.error().forward("Submit acceleration structure build failed");
+
+			if (pending_batch)
+				if (const auto result = finish_batch(*pending_batch); !result) return result.error();
+
+			pending_batch = PendingBatch{
+				.batch = std::move(batch),
+				.query_pool = std::move(query_pool),
+				.ticket = *submit_result,
+			};
 		}
 
-		auto blas_list =
-			prototypes
-			| std::views::as_rvalue
-			| std::views::transform([](MeshBlasPrototype prototype) {
-				  return std::make_pair(std::move(prototype.buffer), std::move(prototype.blas));
-			  })
-			| std::ranges::to<std::vector>();
+		if (pending_batch)
+			if (const auto result = finish_batch(*pending_batch); !result) return result.error();
+
+		const auto compacted_size = get_total_size(blas_sizes);
+
+		// All original arenas have been released if compacted
+		auto buffers = std::move(compacted_arenas);
+		for (auto& arena : arenas)
+			if (arena.has_value()) buffers.push_back(std::move(*arena));
 
 		return BuildBlasResult{
+			.buffers = std::move(buffers),
 			.blas_list = std::move(blas_list),
+			.memory_stat = {.original_size = original_size, .compacted_size = compacted_size},
+		};
+	}
+
+	// Serialized BLASes are copied from and to 256-byte aligned addresses
+	static constexpr vk::DeviceSize SERIALIZED_BLAS_ALIGNMENT = 256;
+
+	// Serialized header: driver UUID, compatibility UUID, serialized size, deserialized size and handle count
+	static constexpr size_t SERIALIZED_SIZE_OFFSET = 2 * VK_UUID_SIZE;
+	static constexpr size_t SERIALIZED_HEADER_SIZE = SERIALIZED_SIZE_OFFSET + 3 * sizeof(uint64_t);
+
+	// (Helper) Get the address of a buffer, aligned up to `SERIALIZED_BLAS_ALIGNMENT`
+	static vk::DeviceAddress get_serialized_address(
+		const vulkan::Context& context,
+		const vulkan::Buffer& buffer
+	) noexcept
+	{
+		const auto address = context.device.getBufferAddress({.buffer = buffer});
+		return util::align_address(address, SERIALIZED_BLAS_ALIGNMENT);
+	}
+
+	std::expected<SerializedBlas, Error> serialize_blas(
+		const vulkan::Context& context,
+		std::span<const vk::raii::AccelerationStructureKHR> blas_list
+	) noexcept
+	{
+		if (blas_list.empty()) return SerializedBlas{.data = {}, .offsets = {0}};
+
+		auto command_runner_result =
+			vulkan::CommandRunner::create(context, vulkan::CommandRunner::QueueType::Compute);
+		if (!command_runner_result)
+			return command_runner_result.error().forward("Create command runner failed");
+		const auto command_runner = std::move(*command_runner_result);
+
+		const auto blas_count = static_cast<uint32_t>(blas_list.size());
+		const auto blas_handles = blas_list
+			| std::views::transform([](const auto& blas) { return *blas; })
+			| std::ranges::to<std::vector>();
+
+		/* Query serialized sizes */
+
+		auto query_pool_result = context.device.createQueryPool({
+			.queryType = vk::QueryType::eAccelerationStructureSerializationSizeKHR,
+			.queryCount = blas_count,
+		});
+		if (!query_pool_result) return Error::from(query_pool_result).forward("Create query pool failed");
+		const auto query_pool = std::move(*query_pool_result);
+
+		const auto query_run_result = command_runner.run(
+			context,
+			[&query_pool, &blas_handles, blas_count](const vk::raii::CommandBuffer& command_buffer) {
+				command_buffer.resetQueryPool(query_pool, 0, blas_count);
+				command_buffer.writeAccelerationStructuresPropertiesKHR(
+					blas_handles,
+					vk::QueryType::eAccelerationStructureSerializationSizeKHR,
+					query_pool,
+					0
+				);
+			}
+		);
+		if (!query_run_result) return query_run_result.error().forward("Query serialized sizes failed");
+
+		const auto [query_result, serialized_sizes] = query_pool.getResults<vk::DeviceSize>(
+			0,
+			blas_count,
+			blas_count * sizeof(vk::DeviceSize),
+			sizeof(vk::DeviceSize),
+			vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait
+		);
+		if (query_result != vk::Result::eSuccess)
+			return Error::from(query_result).forward("Query serialized sizes failed");
+
+		std::vector<uint64_t> offsets;
+		offsets.reserve(blas_count + 1);
+		vk::DeviceSize total_size = 0;
+		for (const auto size : serialized_sizes)
+		{
+			offsets.push_back(total_size);
+			total_size = util::align_address(total_size + size, SERIALIZED_BLAS_ALIGNMENT);
+		}
+		offsets.push_back(total_size);
+
+		/* Serialize */
+
+		auto buffer_result = context.allocator.create_buffer(
+			{
+				.size = total_size + SERIALIZED_BLAS_ALIGNMENT,
+				.usage =
+					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+			},
+			vulkan::MemoryUsage::GpuToCpu,
+			vulkan::MemoryCategory::AccelerationStructure,
+			"BLAS Serialization"
+		);
+		if (!buffer_result) return buffer_result.error().forward("Create serialization buffer failed");
+		const auto buffer = std::move(*buffer_result);
+
+		const auto base_addr = get_serialized_address(context, buffer);
+		const auto buffer_offset = base_addr - context.device.getBufferAddress({.buffer = buffer});
+
+		const auto copy_result = command_runner.run(
+			context,
+			[&blas_list, &offsets, base_addr](const vk::raii::CommandBuffer& command_buffer) {
+				for (const auto [blas, offset] : std::views::zip(blas_list, offsets))
+				{
+					command_buffer.copyAccelerationStructureToMemoryKHR({
+						.src = blas,
+						.dst = base_addr + offset,
+						.mode = vk::CopyAccelerationStructureModeKHR::eSerialize,
+					});
+				}
+
+				const auto host_barrier = vk::MemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+					.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+					.dstStageMask = vk::PipelineStageFlagBits2::eHost,
+					.dstAccessMask = vk::AccessFlagBits2::eHostRead,
+				};
+				command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(host_barrier));
+			}
+		);
+		if (!copy_result) return copy_result.error().forward("Serialize acceleration structure failed");
+
+		auto data = std::vector<std::byte>(total_size);
+		if (const auto result = buffer.download(data, buffer_offset); !result)
+			return result.error().forward("Download serialized BLAS failed");
+
+		return SerializedBlas{.data = std::move(data), .offsets = std::move(offsets)};
+	}
+
+	std::expected<BuildBlasResult, Error> deserialize_blas(
+		const vulkan::Context& context,
+		std::span<const std::byte> data,
+		std::span<const uint64_t> offsets
+	) noexcept
+	{
+		ASSERT(!offsets.empty());
+		const auto blas_count = offsets.size() - 1;
+
+		/* Validate and read deserialized sizes */
+
+		std::vector<vk::DeviceSize> sizes;
+		sizes.reserve(blas_count);
+
+		for (const auto idx : std::views::iota(0zu, blas_count))
+		{
+			const auto begin = offsets[idx];
+			const auto end = offsets[idx + 1];
+			if (begin % SERIALIZED_BLAS_ALIGNMENT != 0
+				|| end < begin
+				|| end > data.size()
+				|| end - begin < SERIALIZED_HEADER_SIZE)
+				return Error("Serialized BLAS out of range", std::format("Index: {}", idx));
+
+			const auto serialized = data.subspan(begin, end - begin);
+
+			// The version data is the leading driver and compatibility UUIDs
+			const auto version_info = vk::AccelerationStructureVersionInfoKHR{
+				.pVersionData = reinterpret_cast<const uint8_t*>(serialized.data()),
+			};
+			if (context.device.getAccelerationStructureCompatibilityKHR(version_info)
+				!= vk::AccelerationStructureCompatibilityKHR::eCompatible)
+				return Error(
+					"Serialized BLAS incompatible with the device",
+					"Serialized by a different device or driver version"
+				);
+
+			std::array<uint64_t, 3> header;
+			std::memcpy(header.data(), serialized.data() + SERIALIZED_SIZE_OFFSET, sizeof(header));
+			const auto [serialized_size, deserialized_size, handle_count] = header;
+			if (serialized_size > serialized.size() || handle_count != 0 || deserialized_size == 0)
+				return Error("Invalid serialized BLAS header", std::format("Index: {}", idx));
+
+			sizes.push_back(deserialized_size);
+		}
+
+		if (blas_count == 0)
+			return BuildBlasResult{.buffers = {}, .blas_list = {}, .memory_stat = {0, 0}};
+
+		/* Create storage */
+
+		const auto order = std::views::iota(0zu, blas_count) | std::ranges::to<std::vector>();
+		auto storage_result = create_blas_storage(context, sizes, order);
+		if (!storage_result) return storage_result.error().forward("Create BLAS storage failed");
+		auto storage = std::move(*storage_result);
+
+		/* Deserialize */
+
+		auto command_runner_result =
+			vulkan::CommandRunner::create(context, vulkan::CommandRunner::QueueType::Compute);
+		if (!command_runner_result)
+			return command_runner_result.error().forward("Create command runner failed");
+		const auto command_runner = std::move(*command_runner_result);
+
+		// Read directly by the device, written once from the host
+		auto buffer_result = context.allocator.create_buffer(
+			{
+				.size = data.size() + SERIALIZED_BLAS_ALIGNMENT,
+				.usage =
+					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+			},
+			vulkan::MemoryUsage::CpuToGpu,
+			vulkan::MemoryCategory::AccelerationStructure,
+			"BLAS Deserialization"
+		);
+		if (!buffer_result) return buffer_result.error().forward("Create deserialization buffer failed");
+		const auto buffer = std::move(*buffer_result);
+
+		const auto base_addr = get_serialized_address(context, buffer);
+		const auto buffer_offset = base_addr - context.device.getBufferAddress({.buffer = buffer});
+		if (const auto result = buffer.upload(data, buffer_offset); !result)
+			return result.error().forward("Upload serialized BLAS failed");
+
+		const auto copy_result = command_runner.run(
+			context,
+			[&storage, &offsets, base_addr](const vk::raii::CommandBuffer& command_buffer) {
+				for (const auto [blas, offset] : std::views::zip(storage.blas, offsets))
+				{
+					command_buffer.copyMemoryToAccelerationStructureKHR({
+						.src = base_addr + offset,
+						.dst = blas,
+						.mode = vk::CopyAccelerationStructureModeKHR::eDeserialize,
+					});
+				}
+			}
+		);
+		if (!copy_result) return copy_result.error().forward("Deserialize acceleration structure failed");
+
+		// Deserialized BLASes keep the size they were serialized with, compacted or not
+		const auto total_size = get_total_size(sizes);
+
+		return BuildBlasResult{
+			.buffers = std::move(storage.arenas),
+			.blas_list = std::move(storage.blas),
+			.memory_stat = {.original_size = total_size, .compacted_size = total_size},
 		};
 	}
+
+	std::expected<RefitScratch, Error> create_refit_scratch(
+		const vulkan::Context& context,
+		std::span<const vk::DeviceSize> update_scratch_sizes
+	) noexcept
+	{
+		const auto scratch_alignment = get_scratch_alignment(context);
+
+		std::vector<vk::DeviceSize> offsets;
+		offsets.reserve(update_scratch_sizes.size());
+
+		vk::DeviceSize total_size = 0;
+		for (const auto size : update_scratch_sizes)
+		{
+			offsets.push_back(total_size);
+			total_size += util::align_address(size, scratch_alignment);
+		}
+
+		auto buffer_result = context.allocator.create_buffer(
+			{
+				.size = std::max(total_size, scratch_alignment) + scratch_alignment,
+				.usage =
+					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+			},
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::AccelerationStructure,
+			"BLAS Refit Scratch"
+		);
+		if (!buffer_result) return buffer_result.error().forward("Create refit scratch buffer failed");
+		auto buffer = std::move(*buffer_result);
+
+		const auto base_addr =
+			util::align_address(context.device.getBufferAddress({.buffer = buffer}), scratch_alignment);
+		auto addresses = offsets
+			| std::views::transform([base_addr](vk::DeviceSize offset) { return base_addr + offset; })
+			| std::ranges::to<std::vector>();
+
+		return RefitScratch{.buffer = std::move(buffer), .addresses = std::move(addresses)};
+	}
 }
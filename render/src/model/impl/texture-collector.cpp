@@ -4,11 +4,14 @@
 #include "model/texture.hpp"
 #include "model/vk-object.hpp"
 #include "render/model/material.hpp"
+#include "render/model/sampler-cache.hpp"
 #include "render/model/texture-list.hpp"
 #include "render/model/texture.hpp"
+#include "vulkan/interface/context.hpp"
 
 #include <cstdint>
 #include <expected>
+#include <optional>
 #include <utility>
 #include <vulkan/vulkan_raii.hpp>
 
@@ -19,12 +22,13 @@ namespace render::impl
 		return {
 			.textures = std::move(textures),
 			.samplers = std::move(samplers),
-			.combined = std::move(combined)
+			.combined = std::move(combined),
+			.sources = std::move(sources)
 		};
 	}
 
 	std::expected<TextureIndex, Error> MaterialCollector::add_material(
-		const vk::raii::Device& device,
+		const vulkan::Context& context,
 		const TextureList& texture_list,
 		const model::TextureSet& texture_set
 	) noexcept
@@ -34,14 +38,10 @@ namespace render::impl
 		const auto orm_ref = texture_list.get_color_texture(texture_set.roughness_metallic);
 		const auto normal_ref = texture_list.get_normal_texture(texture_set.normal);
 
-		const auto albedo_idx_result =
-			add_texture(device, albedo_ref.texture, Texture::Usage::Color, albedo_ref.sample_mode);
-		const auto emissive_idx_result =
-			add_texture(device, emissive_ref.texture, Texture::Usage::Color, emissive_ref.sample_mode);
-		const auto orm_idx_result =
-			add_texture(device, orm_ref.texture, Texture::Usage::Linear, orm_ref.sample_mode);
-		const auto normal_idx_result =
-			add_texture(device, normal_ref.texture, Texture::Usage::Normal, normal_ref.sample_mode);
+		const auto albedo_idx_result = add_texture(context, albedo_ref, Texture::Usage::Color);
+		const auto emissive_idx_result = add_texture(context, emissive_ref, Texture::Usage::Color);
+		const auto orm_idx_result = add_texture(context, orm_ref, Texture::Usage::Linear);
+		const auto normal_idx_result = add_texture(context, normal_ref, Texture::Usage::Normal);
 
 		if (!albedo_idx_result) return albedo_idx_result.error().forward("Collect albedo texture failed");
 		if (!emissive_idx_result)
@@ -58,19 +58,19 @@ namespace render::impl
 	}
 
 	std::expected<uint32_t, Error> MaterialCollector::add_texture(
-		const vk::raii::Device& device,
-		Texture::Ref texture_ref,
-		Texture::Usage usage,
-		model::SampleMode sample_mode
+		const vulkan::Context& context,
+		const TextureList::TextureResult& texture,
+		Texture::Usage usage
 	) noexcept
 	{
+		const auto [texture_ref, sample_mode, source_index] = texture;
 		uint32_t texture_index, sampler_index;
 
 		// Get or create sampler
 		if (!sampler_indices.contains(sample_mode))
 		{
-			auto sampler_result = impl::to_sampler(device, sample_mode);
-			if (!sampler_result) return sampler_result.error().forward("Create sampler failed");
+			auto sampler_result = sampler_cache.get(context, sample_mode, sampler_policy);
+			if (!sampler_result) return sampler_result.error().forward("Get sampler failed");
 			auto sampler = std::move(*sampler_result);
 
 			sampler_index = samplers.size();
@@ -85,7 +85,7 @@ namespace render::impl
 		// Get or create texture
 		if (!texture_indices.contains({texture_ref, usage}))
 		{
-			auto image_view_result = impl::to_image_view(device, texture_ref, usage);
+			auto image_view_result = impl::to_image_view(context.device, texture_ref, usage);
 			if (!image_view_result) return image_view_result.error().forward("Create image view failed");
 			auto image_view = std::move(*image_view_result);
 
@@ -102,8 +102,19 @@ namespace render::impl
 		if (!combined_indices.contains({texture_index, sampler_index}))
 		{
 			const auto combined_index = combined.size();
-			combined.emplace_back(textures[texture_index], samplers[sampler_index]);
+			combined.emplace_back(textures[texture_index], *samplers[sampler_index]);
 			combined_indices.emplace(std::make_pair(texture_index, sampler_index), combined_index);
+
+			sources.push_back(
+				source_index.transform([this, usage, sampler_index](uint32_t index) {
+					return TextureSource{
+						.texture_index = index,
+						.usage = usage,
+						.sampler = *samplers[sampler_index]
+					};
+				})
+			);
+
 			return combined_index;
 		}
 		else
@@ -13,7 +13,9 @@ namespace render::impl
 {
 	std::expected<vk::raii::Sampler, Error> to_sampler(
 		const vk::raii::Device& device,
-		model::SampleMode sample_mode
+		model::SampleMode sample_mode,
+		float max_anisotropy,
+		float lod_bias
 	) noexcept
 	{
 		const auto mag_filter = as_filter(sample_mode.mag_filter);
@@ -29,8 +31,9 @@ namespace render::impl
 			.addressModeU = address_mode_u,
 			.addressModeV = address_mode_v,
 			.addressModeW = address_mode_v,  // Use V wrap mode for W as well
-			.anisotropyEnable = vk::True,
-			.maxAnisotropy = 4.0f,
+			.mipLodBias = lod_bias,
+			.anisotropyEnable = max_anisotropy > 1.0f ? vk::True : vk::False,
+			.maxAnisotropy = max_anisotropy,
 			.maxLod = sample_mode.max_mipmap_level,
 		};
 		auto sampler_result = device.createSampler(sampler_create_info);
@@ -51,7 +54,7 @@ namespace render::impl
 			.aspectMask = vk::ImageAspectFlagBits::eColor,
 			.baseMipLevel = 0,
 			.levelCount = vk::RemainingMipLevels,
-			.baseArrayLayer = 0,
+			.baseArrayLayer = texture_ref.array_layer,
 			.layerCount = 1
 		};
 
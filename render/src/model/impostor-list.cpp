@@ -0,0 +1,276 @@
+#include "render/model/impostor-list.hpp"
+#include "common/util/error.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "model/model.hpp"
+#include "render/interface/impostor.hpp"
+#include "render/model/mesh.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	namespace
+	{
+		using AtlasImage = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
+
+		// Smallest frame size kept in the mipmap chain, smaller frames would blend into their neighbors
+		constexpr uint32_t MIN_FRAME_SIZE = 4;
+
+		std::expected<vk::raii::ImageView, Error> create_view(
+			const vulkan::Context& context,
+			vk::Image image,
+			vk::Format format
+		) noexcept
+		{
+			auto view_result = context.device.createImageView({
+				.image = image,
+				.viewType = vk::ImageViewType::e2D,
+				.format = format,
+				.subresourceRange = {
+					.aspectMask = vk::ImageAspectFlagBits::eColor,
+					.baseMipLevel = 0,
+					.levelCount = vk::RemainingMipLevels,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+			});
+			if (!view_result) return Error::from(view_result);
+			return std::move(*view_result);
+		}
+
+		std::expected<std::vector<uint32_t>, Error> get_primitive_impostors(
+			std::span<const ImpostorList::BakedImpostor> impostors,
+			const MeshList& mesh_list
+		) noexcept
+		{
+			const auto mesh_ranges = mesh_list.get().mesh_ranges_array;
+			const auto primitive_count = mesh_list.get().primitive_attr_array.size();
+
+			// Zero-sized buffers are not allowed, the extra entry is never read
+			auto entries = std::vector<uint32_t>(primitive_count + 1, NO_IMPOSTOR);
+
+			for (const auto [impostor_index, impostor] : impostors | std::views::enumerate)
+			{
+				if (impostor.mesh_index >= mesh_ranges.size())
+					return Error(
+						"Impostor mesh index out of bound",
+						std::format("Impostor #{} references mesh #{}", impostor_index, impostor.mesh_index)
+					);
+
+				const auto [offset, count] = mesh_ranges[impostor.mesh_index];
+				for (const auto primitive : std::views::iota(offset, offset + count))
+				{
+					const auto entry = static_cast<uint32_t>(impostor_index);
+					entries[primitive] = primitive == offset ? entry | IMPOSTOR_FIRST_BIT : entry;
+				}
+			}
+
+			return entries;
+		}
+	}
+
+	ImpostorList::Baked ImpostorList::bake(const model::ImpostorList& impostors) noexcept
+	{
+		Baked baked;
+
+		for (const auto& impostor : impostors.impostors)
+		{
+			baked.impostors.push_back({
+				.mesh_index = impostor.mesh_index,
+				.center = impostor.center,
+				.radius = impostor.radius,
+				.frame_count = impostors.frame_count,
+				.frame_size = impostors.frame_size,
+			});
+			baked.texels.append_range(impostor.albedo.data);
+			baked.texels.append_range(impostor.normal_depth.data);
+		}
+
+		return baked;
+	}
+
+	std::expected<ImpostorList, Error> ImpostorList::create(
+		const vulkan::Context& context,
+		const BakedView& baked,
+		const MeshList& mesh_list
+	) noexcept
+	{
+		/* Validate */
+
+		const auto frame_count = baked.impostors.empty() ? 1u : baked.impostors.front().frame_count;
+		const auto frame_size = baked.impostors.empty() ? 1u : baked.impostors.front().frame_size;
+		const auto atlas_size = frame_count * frame_size;
+		const auto impostor_count = static_cast<uint32_t>(baked.impostors.size());
+
+		for (const auto& impostor : baked.impostors)
+			if (impostor.frame_count != frame_count || impostor.frame_size != frame_size)
+				return Error("Impostors have different frame layouts");
+
+		if (atlas_size == 0) return Error("Impostor atlas is empty");
+
+		const auto atlas_texel_count = size_t(atlas_size) * atlas_size;
+		if (baked.texels.size() != atlas_texel_count * 2 * impostor_count)
+			return Error(
+				"Impostor texel count mismatch",
+				std::format(
+					"Expected {} texels, got {}",
+					atlas_texel_count * 2 * impostor_count,
+					baked.texels.size()
+				)
+			);
+
+		auto primitive_impostors_result = get_primitive_impostors(baked.impostors, mesh_list);
+		if (!primitive_impostors_result)
+			return primitive_impostors_result.error().forward("Invalid impostors");
+
+		/* Stack atlases */
+
+		const auto stack_size = glm::u32vec2(atlas_size, atlas_size * std::max(impostor_count, 1u));
+
+		auto albedo_texels = std::vector<glm::u8vec4>();
+		auto normal_depth_texels = std::vector<glm::u8vec4>();
+		albedo_texels.reserve(size_t(stack_size.x) * stack_size.y);
+		normal_depth_texels.reserve(size_t(stack_size.x) * stack_size.y);
+
+		for (const auto atlases : baked.texels | std::views::chunk(atlas_texel_count * 2))
+		{
+			albedo_texels.append_range(atlases | std::views::take(atlas_texel_count));
+			normal_depth_texels.append_range(atlases | std::views::drop(atlas_texel_count));
+		}
+
+		// Dummy texels without impostors
+		if (impostor_count == 0)
+		{
+			albedo_texels.push_back({0, 0, 0, 0});
+			normal_depth_texels.push_back({128, 128, 255, 255});
+		}
+
+		const auto albedo_atlas = AtlasImage(stack_size, std::move(albedo_texels));
+		const auto normal_depth_atlas = AtlasImage(stack_size, std::move(normal_depth_texels));
+
+		auto impostors = baked.impostors
+			| std::views::enumerate
+			| std::views::transform([impostor_count](const auto& pair) {
+				  const auto& [index, impostor] = pair;
+				  return Impostor{
+					  .center = impostor.center,
+					  .radius = impostor.radius,
+					  .atlas_index = static_cast<uint32_t>(index),
+					  .atlas_count = impostor_count,
+					  .frame_count = impostor.frame_count,
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+
+		// Zero-sized buffers are not allowed, pad with a dummy impostor while keeping the count 0
+		if (impostors.empty())
+			impostors.push_back(
+				{.center = {}, .radius = 0.0f, .atlas_index = 0, .atlas_count = 1, .frame_count = 1}
+			);
+
+		/* Upload */
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+		auto resource_creator = std::move(*resource_creator_result);
+
+		auto impostor_buffer_result =
+			resource_creator.create_array_buffer(context, impostors, vk::BufferUsageFlagBits::eStorageBuffer);
+		if (!impostor_buffer_result)
+			return impostor_buffer_result.error().forward("Create impostor buffer failed");
+
+		auto primitive_impostor_buffer_result = resource_creator.create_array_buffer(
+			context,
+			*primitive_impostors_result,
+			vk::BufferUsageFlagBits::eStorageBuffer
+		);
+		if (!primitive_impostor_buffer_result)
+			return primitive_impostor_buffer_result.error().forward("Create primitive entry buffer failed");
+
+		const auto min_size_log = static_cast<uint32_t>(std::bit_width(frame_count * MIN_FRAME_SIZE)) - 1;
+		const auto mipmap_levels = impostor_count == 0
+			? 1u
+			: vulkan::StaticResourceCreator::get_mipmap_levels(stack_size, min_size_log);
+
+		auto albedo_image_result = resource_creator.create_image(
+			context,
+			albedo_atlas,
+			vk::Format::eR8G8B8A8Srgb,
+			vk::ImageUsageFlagBits::eSampled,
+			vk::ImageLayout::eShaderReadOnlyOptimal,
+			{},
+			mipmap_levels
+		);
+		if (!albedo_image_result) return albedo_image_result.error().forward("Create albedo atlas failed");
+
+		auto normal_depth_image_result = resource_creator.create_image(
+			context,
+			normal_depth_atlas,
+			vk::Format::eR8G8B8A8Unorm,
+			vk::ImageUsageFlagBits::eSampled,
+			vk::ImageLayout::eShaderReadOnlyOptimal,
+			{},
+			mipmap_levels
+		);
+		if (!normal_depth_image_result)
+			return normal_depth_image_result.error().forward("Create normal-depth atlas failed");
+
+		if (const auto result = resource_creator.execute_uploads(context); !result)
+			return result.error().forward("Execute upload tasks failed");
+
+		/* Views & Sampler */
+
+		auto albedo_view_result = create_view(context, *albedo_image_result, vk::Format::eR8G8B8A8Srgb);
+		if (!albedo_view_result) return albedo_view_result.error().forward("Create albedo view failed");
+
+		auto normal_depth_view_result =
+			create_view(context, *normal_depth_image_result, vk::Format::eR8G8B8A8Unorm);
+		if (!normal_depth_view_result)
+			return normal_depth_view_result.error().forward("Create normal-depth view failed");
+
+		// Atlases are stacked vertically, frames at the edges of the stack are clamped
+		constexpr auto sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eLinear,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = vk::LodClampNone,
+		};
+
+		auto sampler_result = context.device.createSampler(sampler_create_info);
+		if (!sampler_result) return Error::from(sampler_result);
+
+		return ImpostorList(
+			std::move(*impostor_buffer_result),
+			std::move(*primitive_impostor_buffer_result),
+			std::move(*albedo_image_result),
+			std::move(*normal_depth_image_result),
+			std::move(*albedo_view_result),
+			std::move(*normal_depth_view_result),
+			std::move(*sampler_result),
+			impostor_count
+		);
+	}
+}
@@ -0,0 +1,293 @@
+#include "render/model/instance-list.hpp"
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+#include "render/interface/node-transform.hpp"
+#include "render/interface/primitive-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/util/per-render-state.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace render
+{
+	namespace
+	{
+		constexpr auto HIDDEN_DRAWCALL =
+			PrimitiveDrawcall{.node_index = 0, .primitive_index = PrimitiveDrawcall::HIDDEN};
+	}
+
+	std::expected<InstanceList, Error> InstanceList::create(
+		const SceneGraph& scene_graph,
+		const MeshList& mesh_list,
+		const MaterialList& material_list
+	) noexcept
+	{
+		const auto capacity = scene_graph.instance_capacity();
+		const auto scene_graph_ref = scene_graph.get();
+
+		if (capacity.node_count == 0 || capacity.drawcall_count == 0)
+			return Error("Scene graph reserves no capacity for instances");
+
+		const auto placements =
+			mesh_list->primitive_attr_array
+			| std::views::transform([&material_list](const PrimitiveAttribute& attr) {
+				  const auto mode = material_list.query_material_mode(attr.material_index);
+				  return Placement{.blended = mode.alpha_mode == model::AlphaMode::Blend, .mode = mode};
+			  })
+			| std::ranges::to<std::vector>();
+
+		// Reserved slots follow the drawcalls of the hierarchy, see `SceneGraph::create`
+		const auto make_slot_list = [&capacity](vulkan::ArrayBufferRef<PrimitiveDrawcall> buffer) {
+			return SlotList{
+				.buffer = buffer,
+				.offset = static_cast<uint32_t>(buffer.count()) - capacity.drawcall_count,
+				.slots = std::vector(capacity.drawcall_count, HIDDEN_DRAWCALL),
+				.free_slots = std::vector(
+					std::from_range,
+					std::views::iota(0u, capacity.drawcall_count) | std::views::reverse
+				),
+				.dirty_slots = {},
+				.dirty = std::vector(capacity.drawcall_count, false),
+			};
+		};
+
+		return InstanceList(
+			std::vector(std::from_range, mesh_list->mesh_ranges_array),
+			placements,
+			scene_graph_ref.drawcall_buffers.map(make_slot_list),
+			scene_graph_ref.blended_drawcall_buffers.map(make_slot_list),
+			scene_graph_ref.node_count - capacity.node_count,
+			capacity.node_count
+		);
+	}
+
+	InstanceList::Instance* InstanceList::find(Handle handle) noexcept
+	{
+		if (handle.index >= instances.size()) return nullptr;
+
+		auto& instance = instances[handle.index];
+		if (!instance.live || instance.generation != handle.generation) return nullptr;
+
+		return &instance;
+	}
+
+	bool InstanceList::contains(Handle handle) const noexcept
+	{
+		return handle.index < instances.size()
+			&& instances[handle.index].live
+			&& instances[handle.index].generation == handle.generation;
+	}
+
+	void InstanceList::write_drawcall(const DrawcallSlot& drawcall, PrimitiveDrawcall value) noexcept
+	{
+		auto& list = slot_list(drawcall.placement);
+		list.slots[drawcall.slot] = value;
+
+		if (!list.dirty[drawcall.slot])
+		{
+			list.dirty[drawcall.slot] = true;
+			list.dirty_slots.push_back(drawcall.slot);
+		}
+	}
+
+	std::expected<InstanceList::Handle, Error> InstanceList::add_instance(
+		uint32_t mesh_index,
+		const glm::mat4& transform,
+		bool visible
+	) noexcept
+	{
+		if (mesh_index >= mesh_ranges.size())
+			return Error("Mesh index out of range", std::format("{}", mesh_index));
+		if (free_nodes.empty()) return Error("Instance node capacity exhausted");
+
+		const auto [primitive_offset, primitive_count] = mesh_ranges[mesh_index];
+		const auto primitives = std::views::iota(primitive_offset, primitive_offset + primitive_count);
+
+		// Check every render state before taking any slot, so a failed add leaves the list untouched
+		auto required_main = PerRenderState<size_t>::from_args(0uz);
+		auto required_blended = PerRenderState<size_t>::from_args(0uz);
+		for (const auto primitive_idx : primitives)
+		{
+			const auto placement = placements[primitive_idx];
+			(placement.blended ? required_blended : required_main)[placement.mode]++;
+		}
+
+		for (const auto& [list, required] : std::views::zip(main_slots.all(), required_main.all()))
+			if (list.free_slots.size() < required) return Error("Instance drawcall capacity exhausted");
+		for (const auto& [list, required] : std::views::zip(blended_slots.all(), required_blended.all()))
+			if (list.free_slots.size() < required) return Error("Instance drawcall capacity exhausted");
+
+		/* Take the slots */
+
+		uint32_t instance_index;
+		if (free_instances.empty())
+		{
+			instance_index = static_cast<uint32_t>(instances.size());
+			instances.emplace_back();
+		}
+		else
+		{
+			instance_index = free_instances.back();
+			free_instances.pop_back();
+		}
+
+		auto& instance = instances[instance_index];
+		instance.live = true;
+		instance.visible = visible;
+		instance.node_slot = free_nodes.back();
+		free_nodes.pop_back();
+
+		instance.drawcalls.clear();
+		for (const auto primitive_idx : primitives)
+		{
+			const auto placement = placements[primitive_idx];
+			auto& list = slot_list(placement);
+
+			const auto drawcall = DrawcallSlot{
+				.placement = placement,
+				.slot = list.free_slots.back(),
+				.primitive_index = primitive_idx,
+			};
+			list.free_slots.pop_back();
+
+			instance.drawcalls.push_back(drawcall);
+			write_drawcall(
+				drawcall,
+				PrimitiveDrawcall{
+					.node_index = node_offset + instance.node_slot,
+					.primitive_index = visible ? primitive_idx : PrimitiveDrawcall::HIDDEN,
+				}
+			);
+		}
+
+		live_count++;
+
+		const auto handle = Handle{.index = instance_index, .generation = instance.generation};
+		if (const auto result = set_transform(handle, transform); !result)
+			return result.error().forward("Set initial transform failed");
+
+		return handle;
+	}
+
+	std::expected<void, Error> InstanceList::remove_instance(Handle handle) noexcept
+	{
+		auto* const instance = find(handle);
+		if (instance == nullptr) return Error("Stale instance handle");
+
+		for (const auto& drawcall : instance->drawcalls)
+		{
+			write_drawcall(drawcall, HIDDEN_DRAWCALL);
+			slot_list(drawcall.placement).free_slots.push_back(drawcall.slot);
+		}
+
+		free_nodes.push_back(instance->node_slot);
+		instance->drawcalls.clear();
+		instance->live = false;
+		instance->generation++;
+
+		free_instances.push_back(handle.index);
+		live_count--;
+
+		return {};
+	}
+
+	std::expected<void, Error> InstanceList::set_transform(Handle handle, const glm::mat4& transform) noexcept
+	{
+		const auto* const instance = find(handle);
+		if (instance == nullptr) return Error("Stale instance handle");
+
+		const auto node = instance->node_slot;
+		node_transforms[node] = transform;
+
+		if (!node_dirty[node])
+		{
+			node_dirty[node] = true;
+			dirty_nodes.push_back(node);
+		}
+
+		return {};
+	}
+
+	std::expected<void, Error> InstanceList::set_visibility(Handle handle, bool visible) noexcept
+	{
+		auto* const instance = find(handle);
+		if (instance == nullptr) return Error("Stale instance handle");
+		if (instance->visible == visible) return {};
+
+		instance->visible = visible;
+		for (const auto& drawcall : instance->drawcalls)
+			write_drawcall(
+				drawcall,
+				PrimitiveDrawcall{
+					.node_index = node_offset + instance->node_slot,
+					.primitive_index = visible ? drawcall.primitive_index : PrimitiveDrawcall::HIDDEN,
+				}
+			);
+
+		return {};
+	}
+
+	std::expected<void, Error> InstanceList::flush(
+		const vulkan::Context& context,
+		vulkan::UploadRing& upload_ring
+	) noexcept
+	{
+		/* Drawcalls */
+
+		const auto flush_slots = [&context, &upload_ring](SlotList& list) -> std::expected<void, Error> {
+			std::ranges::sort(list.dirty_slots);
+
+			// Upload each run of consecutive dirty slots with a single copy region
+			const auto consecutive = [](uint32_t a, uint32_t b) { return b == a + 1; };
+			for (const auto run : list.dirty_slots | std::views::chunk_by(consecutive))
+			{
+				const auto first = run.front();
+				const auto elements =
+					std::span<const PrimitiveDrawcall>(list.slots).subspan(first, std::ranges::size(run));
+
+				if (const auto result = upload_ring.push(context, elements, list.buffer, list.offset + first);
+					!result)
+					return result.error().forward("Upload instance drawcalls failed");
+			}
+
+			for (const auto slot : list.dirty_slots) list.dirty[slot] = false;
+			list.dirty_slots.clear();
+
+			return {};
+		};
+
+		for (auto& list : main_slots.all())
+			if (const auto result = flush_slots(list); !result) return result;
+		for (auto& list : blended_slots.all())
+			if (const auto result = flush_slots(list); !result) return result;
+
+		/* Transforms */
+
+		flushed_transforms.clear();
+		for (const auto node : dirty_nodes)
+		{
+			flushed_transforms.push_back(
+				NodeTransformUpdate{
+					.local_transform = node_transforms[node],
+					.node_index = node_offset + node,
+				}
+			);
+			node_dirty[node] = false;
+		}
+		dirty_nodes.clear();
+
+		return {};
+	}
+}
@@ -0,0 +1,135 @@
+#include "render/model/light-list.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "model/hierarchy.hpp"
+#include "model/light.hpp"
+#include "render/interface/punctual-light.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <glm/common.hpp>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	namespace
+	{
+		std::optional<PunctualLight> to_punctual_light(
+			const model::Light& light,
+			uint32_t node_index
+		) noexcept
+		{
+			if (light.type == model::LightType::Directional) return std::nullopt;
+
+			const auto color = light.color * light.intensity;
+
+			// Distance where the illuminance of the brightest channel drops to `MIN_ILLUMINANCE`
+			const auto peak = std::max({color.r, color.g, color.b, 0.0f});
+			const auto range = light.range.value_or(std::sqrt(peak / LightList::MIN_ILLUMINANCE));
+
+			auto spot_scale = 0.0f;
+			auto spot_offset = 1.0f;
+
+			if (light.type == model::LightType::Spot)
+			{
+				// See the implementation notes of `KHR_lights_punctual`
+				const auto cos_inner = std::cos(light.inner_cone_angle);
+				const auto cos_outer = std::cos(light.outer_cone_angle);
+				spot_scale = 1.0f / std::max(0.001f, cos_inner - cos_outer);
+				spot_offset = -cos_outer * spot_scale;
+			}
+
+			return PunctualLight{
+				.color = color,
+				.range = std::max(range, 0.001f),
+				.node_index = node_index,
+				.spot_scale = spot_scale,
+				.spot_offset = spot_offset,
+			};
+		}
+
+		std::expected<vulkan::ArrayBuffer<PunctualLight>, Error> create_light_buffer(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			std::span<const PunctualLight> lights
+		) noexcept
+		{
+			if (!lights.empty())
+				return resource_creator.create_array_buffer(
+					context,
+					lights,
+					vk::BufferUsageFlagBits::eStorageBuffer
+				);
+
+			// Zero-sized buffers are not allowed, pad with a dummy light while keeping the count 0
+			constexpr auto dummy_light = PunctualLight{
+				.color = {},
+				.range = 0.0f,
+				.node_index = 0,
+				.spot_scale = 0.0f,
+				.spot_offset = 0.0f,
+			};
+			return resource_creator
+				.create_buffer(
+					context,
+					util::object_as_bytes(dummy_light),
+					vk::BufferUsageFlagBits::eStorageBuffer
+				)
+				.transform([](vulkan::Buffer buffer) {
+					return vulkan::ArrayBuffer<PunctualLight>(std::move(buffer), 0);
+				});
+		}
+	}
+
+	std::expected<LightList, Error> LightList::create(
+		const vulkan::Context& context,
+		const model::Hierarchy& hierarchy,
+		std::span<const model::Light> lights
+	) noexcept
+	{
+		std::vector<PunctualLight> punctual_lights;
+
+		for (const auto [node_index, node] : hierarchy.get_nodes() | std::views::enumerate)
+		{
+			if (!node.data.light_index.has_value()) continue;
+			if (*node.data.light_index >= lights.size())
+				return Error(
+					"Light index of a node is out of bound",
+					std::format(
+						"Node #{} has a light index of #{} which goes out of bound (total {})",
+						node_index,
+						*node.data.light_index,
+						lights.size()
+					)
+				);
+
+			const auto punctual_light =
+				to_punctual_light(lights[*node.data.light_index], static_cast<uint32_t>(node_index));
+			if (punctual_light.has_value()) punctual_lights.push_back(*punctual_light);
+		}
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+		auto resource_creator = std::move(*resource_creator_result);
+
+		auto light_buffer_result = create_light_buffer(context, resource_creator, punctual_lights);
+		if (!light_buffer_result) return light_buffer_result.error().forward("Create light buffer failed");
+
+		if (const auto result = resource_creator.execute_uploads(context); !result)
+			return result.error().forward("Execute upload tasks failed");
+
+		return LightList(std::move(*light_buffer_result));
+	}
+}
@@ -4,6 +4,7 @@
 #include "common/util/unpack.hpp"
 #include "model/material-collector.hpp"
 #include "model/material.hpp"
+#include "render/model/sampler-cache.hpp"
 #include "render/model/texture-list.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/alloc/buffer.hpp"
@@ -19,8 +20,10 @@
 #include <format>
 #include <libassert/assert.hpp>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <span>
+#include <stop_token>
 #include <tuple>
 #include <utility>
 #include <variant>
@@ -61,16 +64,22 @@ namespace render
 			binding1_texture_dynamic_array,
 		});
 
+		// Textures are updated after binding when streaming, see `TextureStreamer`
 		const auto binding_flags = std::to_array<vk::DescriptorBindingFlags>({
 			{},
 			vk::DescriptorBindingFlagBits::ePartiallyBound
-				| vk::DescriptorBindingFlagBits::eVariableDescriptorCount,
+				| vk::DescriptorBindingFlagBits::eVariableDescriptorCount
+				| vk::DescriptorBindingFlagBits::eUpdateAfterBind
+				| vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending,
 		});
 		const auto binding_flags_create_info =
 			vk::DescriptorSetLayoutBindingFlagsCreateInfo().setBindingFlags(binding_flags);
 
 		const auto layout_create_info =
-			vk::DescriptorSetLayoutCreateInfo().setPNext(&binding_flags_create_info).setBindings(bindings);
+			vk::DescriptorSetLayoutCreateInfo()
+				.setPNext(&binding_flags_create_info)
+				.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool)
+				.setBindings(bindings);
 		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(layout_create_info);
 		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
 
@@ -90,9 +99,12 @@ namespace render
 				return resource_creator_result.error().forward("Create resource creator failed");
 			auto resource_creator = std::move(*resource_creator_result);
 
-			auto buffer_result =
-				resource_creator
-					.create_array_buffer(context, material_infos, vk::BufferUsageFlagBits::eStorageBuffer);
+			// Texture indices are updated by transfer when streaming
+			auto buffer_result = resource_creator.create_array_buffer(
+				context,
+				material_infos,
+				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst
+			);
 			if (!buffer_result) return buffer_result.error().forward("Create info buffer failed");
 
 			if (const auto upload_result = resource_creator.execute_uploads(context); !upload_result)
@@ -104,26 +116,32 @@ namespace render
 		std::expected<
 			std::tuple<
 				std::vector<vk::raii::ImageView>,
-				std::vector<vk::raii::Sampler>,
+				std::vector<std::shared_ptr<const vk::raii::Sampler>>,
 				std::vector<std::pair<vk::ImageView, vk::Sampler>>,
 				std::vector<MaterialInfo>,
-				std::vector<model::Material::Mode>
+				std::vector<model::Material::Mode>,
+				std::vector<std::optional<TextureSource>>
 			>,
 			Error
 		>
 		collect_textures(
 			const vulkan::Context& context,
 			const TextureList& texture_list,
-			const model::MaterialList& material_list
+			std::span<const model::Material> materials,
+			const MaterialList::SamplerOption& sampler_option
 		) noexcept
 		{
-			impl::MaterialCollector texture_collector;
+			// Without a shared cache, samplers are still deduplicated within the list
+			const auto sampler_cache =
+				sampler_option.cache != nullptr ? sampler_option.cache : std::make_shared<SamplerCache>();
+
+			impl::MaterialCollector texture_collector(*sampler_cache, sampler_option.policy);
 			std::vector<MaterialInfo> material_infos;
 			std::vector<model::Material::Mode> material_modes;
 
 			// Collect fallback texture
 			const auto fallback_texture_index_result =
-				texture_collector.add_material(context.device, texture_list, model::TextureSet{});
+				texture_collector.add_material(context, texture_list, model::TextureSet{});
 			if (!fallback_texture_index_result)
 				return fallback_texture_index_result.error().forward("Collect fallback texture failed");
 			material_infos.emplace_back(
@@ -134,10 +152,10 @@ namespace render
 			);
 
 			// Collect material textures
-			for (const auto& [idx, material] : material_list.materials | std::views::enumerate)
+			for (const auto& [idx, material] : materials | std::views::enumerate)
 			{
 				const auto texture_index_result =
-					texture_collector.add_material(context.device, texture_list, material.texture_set);
+					texture_collector.add_material(context, texture_list, material.texture_set);
 				if (!texture_index_result)
 					return texture_index_result.error()
 						.forward("Collect material texture failed", std::format("Material index: {}", idx));
@@ -148,12 +166,17 @@ namespace render
 				material_modes.push_back(material.mode);
 			}
 
-			auto [textures, samplers, combined] = std::move(texture_collector).collect();
+			auto [textures, samplers, combined, sources] = std::move(texture_collector).collect();
 
-			if (combined.size() > MAX_TEXTURE_COUNT)
+			// Half of the texture array is reserved for streaming
+			if (combined.size() > MAX_TEXTURE_COUNT / 2)
 				return Error(
 					"Too many textures",
-					std::format("Texture count {} exceeds the maximum {}", combined.size(), MAX_TEXTURE_COUNT)
+					std::format(
+						"Texture count {} exceeds the maximum {}",
+						combined.size(),
+						MAX_TEXTURE_COUNT / 2
+					)
 				);
 
 			return std::make_tuple(
@@ -161,7 +184,8 @@ namespace render
 				std::move(samplers),
 				std::move(combined),
 				std::move(material_infos),
-				std::move(material_modes)
+				std::move(material_modes),
+				std::move(sources)
 			);
 		}
 
@@ -184,7 +208,10 @@ namespace render
 				vk::DescriptorPoolCreateInfo()
 					.setMaxSets(1)
 					.setPoolSizes(pool_sizes)
-					.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet);
+					.setFlags(
+						vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet
+						| vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind
+					);
 
 			auto descriptor_pool_result = device.createDescriptorPool(descriptor_pool_create_info);
 			if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
@@ -263,11 +290,22 @@ namespace render
 		const vulkan::Context& context,
 		const MaterialLayout& layout,
 		const model::MaterialList& material_list,
-		TextureList::LoadOption texture_load_option
+		TextureList::LoadOption texture_load_option,
+		SamplerOption sampler_option,
+		std::stop_token stop_token
 	) noexcept
 	{
 		auto progress = std::make_shared<Progress>(Progress::from<ProgressState::Preparing>());
-		auto task = create_impl(thread_pool, progress, context, layout, material_list, texture_load_option);
+		auto task = create_impl(
+			thread_pool,
+			progress,
+			context,
+			layout,
+			material_list,
+			texture_load_option,
+			std::move(sampler_option),
+			std::move(stop_token)
+		);
 		return {std::move(task), progress};
 	}
 
@@ -277,7 +315,9 @@ namespace render
 		const vulkan::Context& context,
 		const MaterialLayout& layout,
 		const model::MaterialList& material_list,
-		TextureList::LoadOption texture_load_option
+		TextureList::LoadOption texture_load_option,
+		SamplerOption sampler_option,
+		std::stop_token stop_token
 	) noexcept
 	{
 		/*===== Create texture list =====*/
@@ -290,25 +330,44 @@ namespace render
 			std::move(texture_list_progress),
 			context,
 			material_list,
-			texture_load_option
+			texture_load_option,
+			std::move(stop_token)
 		);
 		if (!texture_list_result) co_return texture_list_result.error().forward("Create texture list failed");
 		auto texture_list = std::move(*texture_list_result);
 
 		progress->set<ProgressState::Processing>(std::monostate());
 
+		co_return create(
+			context,
+			layout,
+			std::move(texture_list),
+			material_list.materials,
+			sampler_option
+		);
+	}
+
+	std::expected<MaterialList, Error> MaterialList::create(
+		const vulkan::Context& context,
+		const MaterialLayout& layout,
+		TextureList texture_list,
+		std::span<const model::Material> materials,
+		const SamplerOption& sampler_option
+	) noexcept
+	{
 		/*===== Collect texture info =====*/
 
-		auto collect_result = collect_textures(context, texture_list, material_list);
-		if (!collect_result) co_return collect_result.error().forward("Collect textures failed");
-		auto [textures, samplers, combined, material_infos, material_modes] = std::move(*collect_result);
+		auto collect_result = collect_textures(context, texture_list, materials, sampler_option);
+		if (!collect_result) return collect_result.error().forward("Collect textures failed");
+		auto [textures, samplers, combined, material_infos, material_modes, texture_sources] =
+			std::move(*collect_result);
 
 		/*===== Detect material modes =====*/
 		// Avoid unnecessary alpha-testing
 
 		for (
 			const auto [material, mode] : std::views::zip(
-				material_list.materials | std::views::as_const,
+				materials,
 				material_modes | std::views::drop(1)  // NOTE: skip fallback texture at index 0
 			)
 		)
@@ -322,32 +381,39 @@ namespace render
 			case model::AlphaMode::Opaque:
 				continue;
 			case model::AlphaMode::Mask:
-			case model::AlphaMode::Blend:
 				if (min_alpha.value_or(0) * material.param.base_color_factor.a > material.param.alpha_cutoff)
 					mode.alpha_mode = model::AlphaMode::Opaque;
 				continue;
+			case model::AlphaMode::Blend:
+				// Blended materials are only opaque if no texel is transparent at all
+				if (min_alpha.value_or(0) * material.param.base_color_factor.a >= 1.0f)
+					mode.alpha_mode = model::AlphaMode::Opaque;
+				continue;
 			}
 		}
 
 		/*===== Create info buffer =====*/
 
 		auto info_buffer_result = create_info_buffer(context, material_infos);
-		if (!info_buffer_result) co_return info_buffer_result.error().forward("Create info buffer failed");
+		if (!info_buffer_result) return info_buffer_result.error().forward("Create info buffer failed");
 		auto info_buffer = std::move(*info_buffer_result);
 
 		/*===== Create descriptor pool =====*/
 
-		auto descriptor_pool_result = create_descriptor_pool(context.device, combined.size());
+		// Second half of the texture array is left unwritten for streamed textures
+		const auto descriptor_count = combined.size() * 2;
+
+		auto descriptor_pool_result = create_descriptor_pool(context.device, descriptor_count);
 		if (!descriptor_pool_result)
-			co_return descriptor_pool_result.error().forward("Create descriptor pool failed");
+			return descriptor_pool_result.error().forward("Create descriptor pool failed");
 		auto descriptor_pool = std::move(*descriptor_pool_result);
 
 		/*===== Allocate descriptor set =====*/
 
 		auto descriptor_set_result =
-			allocate_descriptor_set(context.device, descriptor_pool, layout, combined.size());
+			allocate_descriptor_set(context.device, descriptor_pool, layout, descriptor_count);
 		if (!descriptor_set_result)
-			co_return descriptor_set_result.error().forward("Allocate descriptor set failed");
+			return descriptor_set_result.error().forward("Allocate descriptor set failed");
 		auto descriptor_set = std::move(*descriptor_set_result);
 
 		/*===== Write descriptor set =====*/
@@ -355,16 +421,22 @@ namespace render
 		if (const auto update_result =
 				update_descriptor_set(context.device, descriptor_set, info_buffer, combined);
 			!update_result)
-			co_return update_result.error().forward("Update descriptor set failed");
+			return update_result.error().forward("Update descriptor set failed");
 
 		/*===== Done =====*/
 
-		co_return MaterialList(
+		auto texture_indices = material_infos
+			| std::views::transform(&MaterialInfo::texture_index)
+			| std::ranges::to<std::vector>();
+
+		return MaterialList(
 			std::move(texture_list),
 			std::move(textures),
 			std::move(samplers),
 			std::move(info_buffer),
 			std::move(material_modes),
+			std::move(texture_indices),
+			std::move(texture_sources),
 			std::move(descriptor_pool),
 			std::move(descriptor_set)
 		);
@@ -1,15 +1,27 @@
 #include "render/model/mesh.hpp"
+#include "common/util/align.hpp"
 #include "common/util/error.hpp"
+#include "common/util/hash.hpp"
+#include "common/util/span.hpp"
 #include "model/mesh.hpp"
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/util/static-resource-creator.hpp"
 
 #include <algorithm>
+#include <array>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <functional>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint3_sized.hpp>
 #include <iterator>
+#include <limits>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <utility>
@@ -21,93 +33,487 @@ namespace render
 {
 	namespace
 	{
-		struct MeshCollectResult
+		uint32_t pack_meshlet_triangle(glm::u8vec3 triangle) noexcept
 		{
-			std::vector<model::FullVertex> vertices;
-			std::vector<uint32_t> indices;
-			std::vector<PrimitiveAttribute> primitive_attrs;
-			std::vector<PrimitiveIndexRange> mesh_primitive_index_ranges;
+			return static_cast<uint32_t>(triangle.x)
+				| static_cast<uint32_t>(triangle.y) << 8
+				| static_cast<uint32_t>(triangle.z) << 16;
+		}
+
+		// Largest vertex count of a primitive addressable by 16-bit indices
+		constexpr size_t MAX_SHORT_INDEX_VERTEX_COUNT = 65536;
+
+		// Shaders read index buffers as 32-bit words, 16-bit index data is padded to a whole word
+		size_t get_index_padding(size_t index_data_size) noexcept
+		{
+			return util::align_address(index_data_size, sizeof(uint32_t)) - index_data_size;
+		}
+
+		// Coarser levels of detail of a primitive that fit into `PrimitiveAttribute::lods`
+		auto uploaded_lods(const model::Primitive& primitive) noexcept
+		{
+			return primitive.lods | std::views::take(PrimitiveAttribute::MAX_LOD_COUNT - 1);
+		}
+
+		// Placement of a primitive in the concatenated arrays, offsets in elements
+		struct PrimitivePlacement
+		{
+			const model::Primitive* primitive;
+			size_t vertex_offset;
+			size_t index_offset;  // Offset of the full geometry, the coarser levels follow
+			size_t index_count;   // Count of indices of all levels
+			size_t meshlet_offset;
+			size_t meshlet_vertex_offset;
+			size_t meshlet_triangle_offset;
 		};
 
-		MeshCollectResult collect_mesh_data(std::span<const model::Mesh> mesh) noexcept
+		// Placement of all primitives, computed from their sizes only
+		struct MeshLayout
 		{
-			std::vector<model::FullVertex> vertices;
-			std::vector<uint32_t> indices;
+			std::vector<PrimitivePlacement> placements;
 			std::vector<PrimitiveAttribute> primitive_attrs;
 			std::vector<PrimitiveIndexRange> mesh_primitive_index_ranges;
+			IndexFormat index_format = IndexFormat::Uint32;
 
-			const auto all_primitives =
-				mesh | std::views::transform(&model::Mesh::primitives) | std::views::join;
-			const auto vertex_count = std::ranges::fold_left(
-				all_primitives | std::views::transform([](const model::Primitive& primitive) {
-					return primitive.geometry.vertices.size();
-				}),
-				0zu,
-				std::plus()
-			);
-			const auto index_count = std::ranges::fold_left(
-				all_primitives | std::views::transform([](const model::Primitive& primitive) {
-					return primitive.geometry.indices.size();
-				}),
-				0zu,
-				std::plus()
-			);
-			const auto primitive_attr_count = std::ranges::distance(all_primitives);
+			size_t vertex_count = 0;
+			size_t index_count = 0;
+			size_t meshlet_count = 0;
+			size_t meshlet_vertex_count = 0;
+			size_t meshlet_triangle_count = 0;
+			uint32_t max_meshlet_count = 0;
+		};
 
-			vertices.reserve(vertex_count);
-			indices.reserve(index_count);
-			primitive_attrs.reserve(primitive_attr_count);
-			mesh_primitive_index_ranges.reserve(mesh.size());
+		// Destination of the data of a single primitive
+		struct PrimitiveDestination
+		{
+			std::span<model::FullVertex> vertices;           // Empty for `VertexFormat::Packed`
+			std::span<model::PackedVertex> packed_vertices;  // Empty for `VertexFormat::Full`
+			std::span<glm::vec3> positions;                  // Empty if there's no separate position stream
+			std::span<uint32_t> indices;        // Empty for `IndexFormat::Uint16`
+			std::span<uint16_t> short_indices;  // Empty for `IndexFormat::Uint32`
+			std::span<model::Meshlet> meshlets;
+			std::span<uint32_t> meshlet_vertices;
+			std::span<uint32_t> meshlet_triangles;
+		};
 
-			const auto push_primitive = [&vertices, &indices](const model::Primitive& primitive) {
-				const auto index_offset = static_cast<uint32_t>(indices.size());
-				const auto vertex_offset = static_cast<uint32_t>(vertices.size());
+		// 16-bit indices if every primitive fits, see `IndexFormat`
+		IndexFormat select_index_format(std::span<const model::Mesh> mesh) noexcept
+		{
+			const auto primitives = mesh | std::views::transform(&model::Mesh::primitives) | std::views::join;
+			if (std::ranges::empty(primitives)) return IndexFormat::Uint32;
 
-				vertices.append_range(primitive.geometry.vertices);
-				indices.append_range(primitive.geometry.indices);
+			const bool short_indices = std::ranges::all_of(primitives, [](const model::Primitive& primitive) {
+				return primitive.geometry.vertices.size() <= MAX_SHORT_INDEX_VERTEX_COUNT;
+			});
+			return short_indices ? IndexFormat::Uint16 : IndexFormat::Uint32;
+		}
+
+		MeshLayout layout_mesh_data(std::span<const model::Mesh> mesh) noexcept
+		{
+			auto layout = MeshLayout();
+			layout.index_format = select_index_format(mesh);
+
+			const auto place_primitive = [&layout](const model::Primitive& primitive) {
+				const auto& geometry = primitive.geometry;
 
-				return PrimitiveAttribute{
-					.index_offset = index_offset,
-					.vertex_offset = vertex_offset,
-					.index_count = static_cast<uint32_t>(primitive.geometry.indices.size()),
-					.vertex_count = static_cast<uint32_t>(primitive.geometry.vertices.size()),
-					.material_index = primitive.material_index.value_or(DEFAULT_MATERIAL),
-					.aabb_min = primitive.geometry.aabb_min,
-					.aabb_max = primitive.geometry.aabb_max
+				auto placement = PrimitivePlacement{
+					.primitive = &primitive,
+					.vertex_offset = layout.vertex_count,
+					.index_offset = layout.index_count,
+					.index_count = geometry.indices.size(),
+					.meshlet_offset = layout.meshlet_count,
+					.meshlet_vertex_offset = layout.meshlet_vertex_count,
+					.meshlet_triangle_offset = layout.meshlet_triangle_count
 				};
+
+				// Coarser levels follow the full geometry, sharing its vertices
+				auto lods = std::array<PrimitiveLod, PrimitiveAttribute::MAX_LOD_COUNT>{};
+				lods[0] = PrimitiveLod{
+					.index_offset = static_cast<uint32_t>(placement.index_offset),
+					.index_count = static_cast<uint32_t>(geometry.indices.size()),
+					.error = 0.0f
+				};
+				uint32_t lod_count = 1;
+				for (const auto& lod : uploaded_lods(primitive))
+				{
+					lods[lod_count++] = PrimitiveLod{
+						.index_offset = static_cast<uint32_t>(placement.index_offset + placement.index_count),
+						.index_count = static_cast<uint32_t>(lod.indices.size()),
+						.error = lod.error
+					};
+					placement.index_count += lod.indices.size();
+				}
+
+				layout.vertex_count += geometry.vertices.size();
+				layout.index_count += placement.index_count;
+				layout.meshlet_count += geometry.meshlets.size();
+				layout.meshlet_vertex_count += geometry.meshlet_vertices.size();
+				layout.meshlet_triangle_count += geometry.meshlet_triangles.size();
+				layout.max_meshlet_count =
+					std::max(layout.max_meshlet_count, static_cast<uint32_t>(geometry.meshlets.size()));
+
+				layout.placements.push_back(placement);
+				layout.primitive_attrs.push_back(
+					PrimitiveAttribute{
+						.index_offset = static_cast<uint32_t>(placement.index_offset),
+						.vertex_offset = static_cast<uint32_t>(placement.vertex_offset),
+						.index_count = static_cast<uint32_t>(geometry.indices.size()),
+						.vertex_count = static_cast<uint32_t>(geometry.vertices.size()),
+						.meshlet_offset = static_cast<uint32_t>(placement.meshlet_offset),
+						.meshlet_count = static_cast<uint32_t>(geometry.meshlets.size()),
+						.material_index = primitive.material_index.value_or(DEFAULT_MATERIAL),
+						.index_size = index_stride(layout.index_format),
+						.aabb_min = geometry.aabb_min,
+						.aabb_max = geometry.aabb_max,
+						.lod_count = lod_count,
+						.lods = lods
+					}
+				);
 			};
 
+			const auto primitive_count = std::ranges::fold_left(
+				mesh | std::views::transform([](const model::Mesh& mesh) { return mesh.primitives.size(); }),
+				0zu,
+				std::plus()
+			);
+			layout.placements.reserve(primitive_count);
+			layout.primitive_attrs.reserve(primitive_count);
+			layout.mesh_primitive_index_ranges.reserve(mesh.size());
+
 			for (const auto& mesh : mesh)
 			{
-				const auto primitive_offset = static_cast<uint32_t>(primitive_attrs.size());
-				primitive_attrs.append_range(mesh.primitives | std::views::transform(push_primitive));
-
-				mesh_primitive_index_ranges.push_back(
+				layout.mesh_primitive_index_ranges.push_back(
 					PrimitiveIndexRange{
-						.offset = primitive_offset,
+						.offset = static_cast<uint32_t>(layout.primitive_attrs.size()),
 						.count = static_cast<uint32_t>(mesh.primitives.size())
 					}
 				);
+				std::ranges::for_each(mesh.primitives, place_primitive);
+			}
+
+			return layout;
+		}
+
+		// Write the data of a primitive, each destination is written sequentially as it may be write-combined
+		void write_primitive(
+			const PrimitivePlacement& placement,
+			const PrimitiveDestination& destination
+		) noexcept
+		{
+			const auto& primitive = *placement.primitive;
+			const auto& geometry = primitive.geometry;
+
+			if (!destination.packed_vertices.empty())
+			{
+				const auto pack_vertex = [&geometry](const model::FullVertex& vertex) {
+					return model::PackedVertex::pack(vertex, geometry.aabb_min, geometry.aabb_max);
+				};
+				std::ranges::transform(geometry.vertices, destination.packed_vertices.begin(), pack_vertex);
+			}
+			else
+			{
+				std::ranges::copy(geometry.vertices, destination.vertices.begin());
+			}
+
+			if (!destination.positions.empty())
+			{
+				std::ranges::copy(
+					geometry.vertices | std::views::transform(&model::FullVertex::position),
+					destination.positions.begin()
+				);
+			}
+
+			const auto write_indices = [&primitive]<typename T>(std::span<T> indices) {
+				const auto narrow = [](uint32_t index) { return static_cast<T>(index); };
+				auto index_iter =
+					std::ranges::transform(primitive.geometry.indices, indices.begin(), narrow).out;
+				for (const auto& lod : uploaded_lods(primitive))
+					index_iter = std::ranges::transform(lod.indices, index_iter, narrow).out;
+			};
+			if (!destination.short_indices.empty())
+				write_indices(destination.short_indices);
+			else
+				write_indices(destination.indices);
+
+			const auto rebase_meshlet = [&placement](model::Meshlet meshlet) {
+				meshlet.vertex_offset += static_cast<uint32_t>(placement.meshlet_vertex_offset);
+				meshlet.triangle_offset += static_cast<uint32_t>(placement.meshlet_triangle_offset);
+				return meshlet;
+			};
+			std::ranges::transform(geometry.meshlets, destination.meshlets.begin(), rebase_meshlet);
+			std::ranges::copy(geometry.meshlet_vertices, destination.meshlet_vertices.begin());
+			std::ranges::transform(
+				geometry.meshlet_triangles,
+				destination.meshlet_triangles.begin(),
+				pack_meshlet_triangle
+			);
+		}
+
+		// Destination of a primitive within arrays starting at the placement of `base`
+		PrimitiveDestination get_primitive_destination(
+			const PrimitivePlacement& base,
+			const PrimitivePlacement& placement,
+			const PrimitiveDestination& arrays
+		) noexcept
+		{
+			const auto& geometry = placement.primitive->geometry;
+			const auto vertex_offset = placement.vertex_offset - base.vertex_offset;
+			const auto vertex_count = geometry.vertices.size();
+
+			const auto vertex_range = [vertex_offset, vertex_count](auto span) {
+				return span.empty() ? span : span.subspan(vertex_offset, vertex_count);
+			};
+			const auto index_offset = placement.index_offset - base.index_offset;
+			const auto index_count = placement.index_count;
+
+			const auto index_range = [index_offset, index_count](auto span) {
+				return span.empty() ? span : span.subspan(index_offset, index_count);
+			};
+
+			return {
+				.vertices = vertex_range(arrays.vertices),
+				.packed_vertices = vertex_range(arrays.packed_vertices),
+				.positions = vertex_range(arrays.positions),
+				.indices = index_range(arrays.indices),
+				.short_indices = index_range(arrays.short_indices),
+				.meshlets = arrays.meshlets.subspan(
+					placement.meshlet_offset - base.meshlet_offset,
+					geometry.meshlets.size()
+				),
+				.meshlet_vertices = arrays.meshlet_vertices.subspan(
+					placement.meshlet_vertex_offset - base.meshlet_vertex_offset,
+					geometry.meshlet_vertices.size()
+				),
+				.meshlet_triangles = arrays.meshlet_triangles.subspan(
+					placement.meshlet_triangle_offset - base.meshlet_triangle_offset,
+					geometry.meshlet_triangles.size()
+				)
+			};
+		}
+
+		MeshList::Baked collect_mesh_data(
+			std::span<const model::Mesh> mesh,
+			VertexFormat vertex_format,
+			bool position_stream
+		) noexcept
+		{
+			auto layout = layout_mesh_data(mesh);
+
+			std::vector<model::FullVertex> vertices;
+			std::vector<model::PackedVertex> packed_vertices;
+			std::vector<glm::vec3> positions;
+
+			if (vertex_format == VertexFormat::Packed)
+				packed_vertices.resize(layout.vertex_count);
+			else
+				vertices.resize(layout.vertex_count);
+			if (position_stream) positions.resize(layout.vertex_count);
+			std::vector<uint32_t> indices;
+			std::vector<uint16_t> short_indices;
+			if (layout.index_format == IndexFormat::Uint16)
+				short_indices.resize(layout.index_count);
+			else
+				indices.resize(layout.index_count);
+			auto meshlets = std::vector<model::Meshlet>(layout.meshlet_count);
+			auto meshlet_vertices = std::vector<uint32_t>(layout.meshlet_vertex_count);
+			auto meshlet_triangles = std::vector<uint32_t>(layout.meshlet_triangle_count);
+
+			if (!layout.placements.empty())
+			{
+				const auto arrays = PrimitiveDestination{
+					.vertices = vertices,
+					.packed_vertices = packed_vertices,
+					.positions = positions,
+					.indices = indices,
+					.short_indices = short_indices,
+					.meshlets = meshlets,
+					.meshlet_vertices = meshlet_vertices,
+					.meshlet_triangles = meshlet_triangles
+				};
+
+				for (const auto& placement : layout.placements)
+				{
+					write_primitive(
+						placement,
+						get_primitive_destination(layout.placements.front(), placement, arrays)
+					);
+				}
 			}
 
 			return {
+				.vertex_format = vertex_format,
+				.index_format = layout.index_format,
 				.vertices = std::move(vertices),
+				.packed_vertices = std::move(packed_vertices),
+				.positions = std::move(positions),
 				.indices = std::move(indices),
-				.primitive_attrs = std::move(primitive_attrs),
-				.mesh_primitive_index_ranges = std::move(mesh_primitive_index_ranges),
+				.short_indices = std::move(short_indices),
+				.primitive_attrs = std::move(layout.primitive_attrs),
+				.mesh_primitive_index_ranges = std::move(layout.mesh_primitive_index_ranges),
+				.meshlets = std::move(meshlets),
+				.meshlet_vertices = std::move(meshlet_vertices),
+				.meshlet_triangles = std::move(meshlet_triangles),
+				.max_meshlet_count = layout.max_meshlet_count,
+			};
+		}
+
+		// Coarsest level of detail of each primitive with its vertices compacted, uploaded in place of the
+		// full geometry when streaming. Meshlets are dropped, as they index the full geometry. So is the
+		// position stream of full vertices, as streamed primitives wouldn't fill it
+		MeshList::Baked bake_coarse(const MeshList::BakedView& baked) noexcept
+		{
+			auto coarse = MeshList::Baked{
+				.vertex_format = baked.vertex_format,
+				.index_format = baked.index_format,
+				.vertices = {},
+				.packed_vertices = {},
+				.positions = {},
+				.indices = {},
+				.short_indices = {},
+				.primitive_attrs = {},
+				.mesh_primitive_index_ranges =
+					baked.mesh_primitive_index_ranges | std::ranges::to<std::vector>(),
+				// Single placeholders, as storage buffers can't be empty
+				.meshlets = {model::Meshlet()},
+				.meshlet_vertices = {0},
+				.meshlet_triangles = {0},
+				.max_meshlet_count = 0,
+			};
+			coarse.primitive_attrs.reserve(baked.primitive_attrs.size());
+
+			std::vector<uint32_t> remap;
+			for (const auto& attr : baked.primitive_attrs)
+			{
+				const auto& lod = attr.lods[attr.lod_count - 1];
+				const auto vertex_offset =
+					static_cast<uint32_t>(coarse.vertices.size() + coarse.packed_vertices.size());
+				const auto index_offset =
+					static_cast<uint32_t>(coarse.indices.size() + coarse.short_indices.size());
+
+				// Vertices referenced by the level, in order of first use
+				remap.assign(attr.vertex_count, std::numeric_limits<uint32_t>::max());
+				uint32_t vertex_count = 0;
+				const auto lod_end = lod.index_offset + lod.index_count;
+				for (const auto position : std::views::iota(lod.index_offset, lod_end))
+				{
+					const auto index = baked.get_index(position);
+					auto& local_index = remap[index];
+					if (local_index == std::numeric_limits<uint32_t>::max())
+					{
+						local_index = vertex_count++;
+
+						const auto source_index = attr.vertex_offset + index;
+						if (!baked.vertices.empty()) coarse.vertices.push_back(baked.vertices[source_index]);
+						if (!baked.packed_vertices.empty())
+							coarse.packed_vertices.push_back(baked.packed_vertices[source_index]);
+						if (!baked.positions.empty() && baked.vertex_format == VertexFormat::Packed)
+							coarse.positions.push_back(baked.positions[source_index]);
+					}
+					if (coarse.index_format == IndexFormat::Uint16)
+						coarse.short_indices.push_back(static_cast<uint16_t>(local_index));
+					else
+						coarse.indices.push_back(local_index);
+				}
+
+				auto coarse_attr = attr;
+				coarse_attr.index_offset = index_offset;
+				coarse_attr.vertex_offset = vertex_offset;
+				coarse_attr.index_count = lod.index_count;
+				coarse_attr.vertex_count = vertex_count;
+				coarse_attr.meshlet_offset = 0;
+				coarse_attr.meshlet_count = 0;
+				coarse_attr.lod_count = 1;
+				coarse_attr.lods = {};
+				coarse_attr.lods[0] =
+					PrimitiveLod{.index_offset = index_offset, .index_count = lod.index_count, .error = 0.0f};
+				coarse.primitive_attrs.push_back(coarse_attr);
+			}
+
+			return coarse;
+		}
+
+		// Usage flags of the geometry buffers
+		struct BufferUsages
+		{
+			vk::BufferUsageFlags vertex;
+			vk::BufferUsageFlags position;
+			vk::BufferUsageFlags index;
+		};
+
+		BufferUsages get_buffer_usages(const vulkan::Context& context, bool position_stream) noexcept
+		{
+			vk::BufferUsageFlags geometry_buffer_extra_flgs = vk::BufferUsageFlagBits::eShaderDeviceAddress;
+			if (context.feature.raytracing)
+				geometry_buffer_extra_flgs |=
+					vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR;
+
+			// Acceleration structures are built from the separate position stream if present
+			const auto vertex_buffer_extra_flags =
+				position_stream ? vk::BufferUsageFlags() : geometry_buffer_extra_flgs;
+
+			return {
+				// Storage usage for vertex pulling in mesh shaders
+				.vertex = vk::BufferUsageFlagBits::eVertexBuffer
+					| vk::BufferUsageFlagBits::eStorageBuffer
+					| vertex_buffer_extra_flags,
+				// Vertex usage for position-only passes
+				.position = vk::BufferUsageFlagBits::eVertexBuffer | geometry_buffer_extra_flgs,
+				// Storage usage for alpha testing candidate hits of shadow rays
+				.index = vk::BufferUsageFlagBits::eIndexBuffer
+					| vk::BufferUsageFlagBits::eStorageBuffer
+					| geometry_buffer_extra_flgs,
 			};
 		}
 
 		struct BufferResult
 		{
-			vulkan::ArrayBuffer<model::FullVertex> vertex_buffer;
-			vulkan::ArrayBuffer<uint32_t> index_buffer;
+			vulkan::Buffer vertex_buffer;
+			std::optional<vulkan::ArrayBuffer<glm::vec3>> position_buffer;
+			vulkan::Buffer index_buffer;
 			vulkan::ArrayBuffer<PrimitiveAttribute> primitive_attr_buffer;
+			vulkan::ArrayBuffer<model::Meshlet> meshlet_buffer;
+			vulkan::ArrayBuffer<uint32_t> meshlet_vertex_buffer;
+			vulkan::ArrayBuffer<uint32_t> meshlet_triangle_buffer;
+			std::optional<vulkan::ArrayBuffer<PrimitiveAttribute>> trace_primitive_attr_buffer;
 		};
 
+		// Create a buffer starting with @p data, followed by @p reserved_size bytes left uninitialized
+		std::expected<vulkan::Buffer, Error> create_reserved_buffer(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			std::span<const std::byte> data,
+			size_t reserved_size,
+			vk::BufferUsageFlags usage
+		) noexcept
+		{
+			if (reserved_size == 0)
+				return resource_creator.create_buffer(context, data, usage, vulkan::MemoryCategory::Geometry);
+
+			auto buffer_result = vulkan::StaticResourceCreator::create_empty_buffer(
+				context,
+				data.size_bytes() + reserved_size,
+				usage,
+				vulkan::MemoryCategory::Geometry
+			);
+			if (!buffer_result) return buffer_result.error().forward("Create gpu buffer failed");
+
+			const auto regions = std::to_array<vulkan::StaticResourceCreator::BufferRegion>({
+				{.buffer = *buffer_result, .offset = 0, .size = data.size_bytes()},
+			});
+			const auto write = [data](std::span<const std::span<std::byte>> destinations) {
+				std::ranges::copy(data, destinations[0].begin());
+				return std::expected<void, Error>();
+			};
+			if (const auto result = resource_creator.write_buffers_in_place(context, regions, write); !result)
+				return result.error().forward("Write buffer data failed");
+
+			return std::move(*buffer_result);
+		}
+
 		std::expected<BufferResult, Error> create_buffers(
 			const vulkan::Context& context,
-			const MeshCollectResult& collect_result
+			const MeshList::BakedView& baked,
+			std::optional<MeshList::PoolCapacity> pool
 		) noexcept
 		{
 			auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
@@ -115,67 +521,602 @@ namespace render
 				return resource_creator_result.error().forward("Create resource creator failed");
 			auto resource_creator = std::move(*resource_creator_result);
 
-			vk::BufferUsageFlags geometry_buffer_extra_flgs = vk::BufferUsageFlagBits::eShaderDeviceAddress;
-			if (context.feature.raytracing)
-				geometry_buffer_extra_flgs |=
-					vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR;
+			// The separate position stream of packed vertices is only needed when ray tracing is enabled
+			const bool position_stream = !baked.positions.empty()
+				&& (baked.vertex_format == VertexFormat::Full || context.feature.raytracing);
+			const auto usages = get_buffer_usages(context, position_stream);
+			const auto vertex_data = baked.vertex_format == VertexFormat::Packed
+				? util::as_bytes(baked.packed_vertices)
+				: util::as_bytes(baked.vertices);
 
-			auto vertex_buffer_result = resource_creator.create_array_buffer(
+			// Streamed primitives aren't ray traced, the position stream isn't reserved
+			const auto pool_capacity =
+				pool.value_or(MeshList::PoolCapacity{.vertex_count = 0, .index_count = 0});
+			const auto index_data = baked.index_bytes(0, baked.index_count());
+			const auto index_reserved_size = pool_capacity.index_count * index_stride(baked.index_format);
+
+			auto vertex_buffer_result = create_reserved_buffer(
 				context,
-				collect_result.vertices,
-				vk::BufferUsageFlagBits::eVertexBuffer | geometry_buffer_extra_flgs
+				resource_creator,
+				vertex_data,
+				pool_capacity.vertex_count * vertex_stride(baked.vertex_format),
+				usages.vertex
 			);
-			auto index_buffer_result = resource_creator.create_array_buffer(
+			auto position_buffer_result =
+				std::expected<std::optional<vulkan::ArrayBuffer<glm::vec3>>, Error>(std::nullopt);
+			if (position_stream)
+			{
+				position_buffer_result =
+					resource_creator
+						.create_array_buffer(
+							context,
+							baked.positions,
+							usages.position,
+							vulkan::MemoryCategory::Geometry
+						)
+						.transform([](vulkan::ArrayBuffer<glm::vec3> buffer) {
+							return std::optional(std::move(buffer));
+						});
+			}
+			auto index_buffer_result = create_reserved_buffer(
 				context,
-				collect_result.indices,
-				vk::BufferUsageFlagBits::eIndexBuffer | geometry_buffer_extra_flgs
+				resource_creator,
+				index_data,
+				index_reserved_size + get_index_padding(index_data.size() + index_reserved_size),
+				usages.index
 			);
 			auto primitive_attr_buffer_result = resource_creator.create_array_buffer(
 				context,
-				collect_result.primitive_attrs,
-				vk::BufferUsageFlagBits::eStorageBuffer
+				baked.primitive_attrs,
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryCategory::Geometry
+			);
+			auto trace_primitive_attr_buffer_result =
+				std::expected<std::optional<vulkan::ArrayBuffer<PrimitiveAttribute>>, Error>(std::nullopt);
+			if (pool.has_value())
+			{
+				trace_primitive_attr_buffer_result =
+					resource_creator
+						.create_array_buffer(
+							context,
+							baked.primitive_attrs,
+							vk::BufferUsageFlagBits::eStorageBuffer,
+							vulkan::MemoryCategory::Geometry
+						)
+						.transform([](vulkan::ArrayBuffer<PrimitiveAttribute> buffer) {
+							return std::optional(std::move(buffer));
+						});
+			}
+			auto meshlet_buffer_result = resource_creator.create_array_buffer(
+				context,
+				baked.meshlets,
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryCategory::Geometry
+			);
+			auto meshlet_vertex_buffer_result = resource_creator.create_array_buffer(
+				context,
+				baked.meshlet_vertices,
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryCategory::Geometry
+			);
+			auto meshlet_triangle_buffer_result = resource_creator.create_array_buffer(
+				context,
+				baked.meshlet_triangles,
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryCategory::Geometry
 			);
 
 			if (!vertex_buffer_result)
 				return vertex_buffer_result.error().forward("Create vertex buffer failed");
+			if (!position_buffer_result)
+				return position_buffer_result.error().forward("Create position buffer failed");
 			if (!index_buffer_result)
 				return index_buffer_result.error().forward("Create index buffer failed");
 			if (!primitive_attr_buffer_result)
 				return primitive_attr_buffer_result.error().forward("Create primitive buffer failed");
+			if (!trace_primitive_attr_buffer_result)
+				return trace_primitive_attr_buffer_result.error().forward(
+					"Create trace primitive buffer failed"
+				);
+			if (!meshlet_buffer_result)
+				return meshlet_buffer_result.error().forward("Create meshlet buffer failed");
+			if (!meshlet_vertex_buffer_result)
+				return meshlet_vertex_buffer_result.error().forward("Create meshlet vertex buffer failed");
+			if (!meshlet_triangle_buffer_result)
+				return meshlet_triangle_buffer_result.error().forward(
+					"Create meshlet triangle buffer failed"
+				);
 
 			auto vertex_buffer = std::move(*vertex_buffer_result);
+			auto position_buffer = std::move(*position_buffer_result);
 			auto index_buffer = std::move(*index_buffer_result);
 			auto primitive_attr_buffer = std::move(*primitive_attr_buffer_result);
+			auto meshlet_buffer = std::move(*meshlet_buffer_result);
+			auto meshlet_vertex_buffer = std::move(*meshlet_vertex_buffer_result);
+			auto meshlet_triangle_buffer = std::move(*meshlet_triangle_buffer_result);
+			auto trace_primitive_attr_buffer = std::move(*trace_primitive_attr_buffer_result);
 
 			if (const auto upload_result = resource_creator.execute_uploads(context); !upload_result)
 				return upload_result.error().forward("Execute upload tasks failed");
 
 			return BufferResult{
 				.vertex_buffer = std::move(vertex_buffer),
+				.position_buffer = std::move(position_buffer),
 				.index_buffer = std::move(index_buffer),
 				.primitive_attr_buffer = std::move(primitive_attr_buffer),
+				.meshlet_buffer = std::move(meshlet_buffer),
+				.meshlet_vertex_buffer = std::move(meshlet_vertex_buffer),
+				.meshlet_triangle_buffer = std::move(meshlet_triangle_buffer),
+				.trace_primitive_attr_buffer = std::move(trace_primitive_attr_buffer),
+			};
+		}
+
+		// Upper bound of the staging size of a batch, a fraction of a staging chunk so that batches written
+		// in parallel share the chunks
+		constexpr size_t UPLOAD_BATCH_SIZE = vulkan::StaticResourceCreator::STAGING_CHUNK_SIZE / 4;
+
+		// Pending data size above which the uploads are executed, bounding the staging memory in use
+		constexpr size_t MAX_PENDING_UPLOAD_SIZE = vulkan::StaticResourceCreator::STAGING_CHUNK_SIZE
+			* vulkan::StaticResourceCreator::STAGING_CHUNK_COUNT;
+
+		template <typename T>
+		std::expected<vulkan::ArrayBuffer<T>, Error> create_empty_array_buffer(
+			const vulkan::Context& context,
+			size_t count,
+			vk::BufferUsageFlags usage
+		) noexcept
+		{
+			return vulkan::StaticResourceCreator::create_empty_buffer(
+					   context,
+					   count * sizeof(T),
+					   usage,
+					   vulkan::MemoryCategory::Geometry
+			)
+				.transform([count](vulkan::Buffer buffer) {
+					return vulkan::ArrayBuffer<T>(std::move(buffer), count);
+				});
+		}
+
+		// Create the geometry buffers at their final size, only the primitive attributes are uploaded
+		std::expected<BufferResult, Error> create_empty_buffers(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			const MeshLayout& layout,
+			VertexFormat vertex_format,
+			bool position_stream
+		) noexcept
+		{
+			const auto usages = get_buffer_usages(context, position_stream);
+			const auto index_data_size = layout.index_count * index_stride(layout.index_format);
+
+			auto vertex_buffer_result = vulkan::StaticResourceCreator::create_empty_buffer(
+				context,
+				layout.vertex_count * vertex_stride(vertex_format),
+				usages.vertex,
+				vulkan::MemoryCategory::Geometry
+			);
+			auto position_buffer_result =
+				std::expected<std::optional<vulkan::ArrayBuffer<glm::vec3>>, Error>(std::nullopt);
+			if (position_stream)
+			{
+				position_buffer_result =
+					create_empty_array_buffer<glm::vec3>(context, layout.vertex_count, usages.position)
+						.transform([](vulkan::ArrayBuffer<glm::vec3> buffer) {
+							return std::optional(std::move(buffer));
+						});
+			}
+			auto index_buffer_result = vulkan::StaticResourceCreator::create_empty_buffer(
+				context,
+				index_data_size + get_index_padding(index_data_size),
+				usages.index,
+				vulkan::MemoryCategory::Geometry
+			);
+			auto primitive_attr_buffer_result = resource_creator.create_array_buffer(
+				context,
+				layout.primitive_attrs,
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryCategory::Geometry
+			);
+			auto meshlet_buffer_result = create_empty_array_buffer<model::Meshlet>(
+				context,
+				layout.meshlet_count,
+				vk::BufferUsageFlagBits::eStorageBuffer
+			);
+			auto meshlet_vertex_buffer_result = create_empty_array_buffer<uint32_t>(
+				context,
+				layout.meshlet_vertex_count,
+				vk::BufferUsageFlagBits::eStorageBuffer
+			);
+			auto meshlet_triangle_buffer_result = create_empty_array_buffer<uint32_t>(
+				context,
+				layout.meshlet_triangle_count,
+				vk::BufferUsageFlagBits::eStorageBuffer
+			);
+
+			if (!vertex_buffer_result)
+				return vertex_buffer_result.error().forward("Create vertex buffer failed");
+			if (!position_buffer_result)
+				return position_buffer_result.error().forward("Create position buffer failed");
+			if (!index_buffer_result)
+				return index_buffer_result.error().forward("Create index buffer failed");
+			if (!primitive_attr_buffer_result)
+				return primitive_attr_buffer_result.error().forward("Create primitive buffer failed");
+			if (!meshlet_buffer_result)
+				return meshlet_buffer_result.error().forward("Create meshlet buffer failed");
+			if (!meshlet_vertex_buffer_result)
+				return meshlet_vertex_buffer_result.error().forward("Create meshlet vertex buffer failed");
+			if (!meshlet_triangle_buffer_result)
+				return meshlet_triangle_buffer_result.error().forward(
+					"Create meshlet triangle buffer failed"
+				);
+
+			return BufferResult{
+				.vertex_buffer = std::move(*vertex_buffer_result),
+				.position_buffer = std::move(*position_buffer_result),
+				.index_buffer = std::move(*index_buffer_result),
+				.primitive_attr_buffer = std::move(*primitive_attr_buffer_result),
+				.meshlet_buffer = std::move(*meshlet_buffer_result),
+				.meshlet_vertex_buffer = std::move(*meshlet_vertex_buffer_result),
+				.meshlet_triangle_buffer = std::move(*meshlet_triangle_buffer_result),
+				.trace_primitive_attr_buffer = std::nullopt,
+			};
+		}
+
+		// Size of the data of a primitive in bytes
+		size_t get_primitive_data_size(
+			const PrimitivePlacement& placement,
+			VertexFormat vertex_format,
+			IndexFormat index_format,
+			bool position_stream
+		) noexcept
+		{
+			const auto& geometry = placement.primitive->geometry;
+			const auto vertex_size = vertex_stride(vertex_format) + (position_stream ? sizeof(glm::vec3) : 0);
+
+			return geometry.vertices.size() * vertex_size
+				+ placement.index_count * index_stride(index_format)
+				+ geometry.meshlets.size() * sizeof(model::Meshlet)
+				+ (geometry.meshlet_vertices.size() + geometry.meshlet_triangles.size()) * sizeof(uint32_t);
+		}
+
+		// Split the placements into runs of consecutive primitives of at most `UPLOAD_BATCH_SIZE` bytes,
+		// a larger primitive forms a batch by itself
+		std::vector<std::span<const PrimitivePlacement>> split_batches(
+			std::span<const PrimitivePlacement> placements,
+			VertexFormat vertex_format,
+			IndexFormat index_format,
+			bool position_stream
+		) noexcept
+		{
+			std::vector<std::span<const PrimitivePlacement>> batches;
+
+			size_t batch_begin = 0;
+			size_t batch_size = 0;
+			for (const auto index : std::views::iota(0zu, placements.size()))
+			{
+				const auto size =
+					get_primitive_data_size(placements[index], vertex_format, index_format, position_stream);
+				if (batch_size > 0 && batch_size + size > UPLOAD_BATCH_SIZE)
+				{
+					batches.push_back(placements.subspan(batch_begin, index - batch_begin));
+					batch_begin = index;
+					batch_size = 0;
+				}
+				batch_size += size;
+			}
+			if (batch_begin < placements.size()) batches.push_back(placements.subspan(batch_begin));
+
+			return batches;
+		}
+
+		// Write a batch of consecutive primitives straight into staging memory, as one contiguous region of
+		// each buffer
+		coro::task<std::expected<void, Error>> upload_batch(
+			coro::thread_pool& thread_pool,
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			const BufferResult& buffers,
+			VertexFormat vertex_format,
+			IndexFormat index_format,
+			std::span<const PrimitivePlacement> batch
+		) noexcept
+		{
+			co_await thread_pool.schedule();
+
+			const auto& first = batch.front();
+			const auto& last = batch.back();
+			const auto& last_geometry = last.primitive->geometry;
+
+			const auto vertex_count =
+				last.vertex_offset + last_geometry.vertices.size() - first.vertex_offset;
+			const auto index_count = last.index_offset + last.index_count - first.index_offset;
+			const auto meshlet_count =
+				last.meshlet_offset + last_geometry.meshlets.size() - first.meshlet_offset;
+			const auto meshlet_vertex_count = last.meshlet_vertex_offset
+				+ last_geometry.meshlet_vertices.size()
+				- first.meshlet_vertex_offset;
+			const auto meshlet_triangle_count = last.meshlet_triangle_offset
+				+ last_geometry.meshlet_triangles.size()
+				- first.meshlet_triangle_offset;
+
+			const auto stride = vertex_stride(vertex_format);
+			const auto index_size = index_stride(index_format);
+			const auto position_buffer =
+				buffers.position_buffer.has_value() ? vk::Buffer(*buffers.position_buffer) : vk::Buffer();
+			const auto position_count = buffers.position_buffer.has_value() ? vertex_count : 0;
+
+			using Region = vulkan::StaticResourceCreator::BufferRegion;
+			const auto regions = std::to_array<Region>({
+				{.buffer = buffers.vertex_buffer,
+				 .offset = first.vertex_offset * stride,
+				 .size = vertex_count * stride},
+				{.buffer = position_buffer,
+				 .offset = first.vertex_offset * sizeof(glm::vec3),
+				 .size = position_count * sizeof(glm::vec3)},
+				{.buffer = buffers.index_buffer,
+				 .offset = first.index_offset * index_size,
+				 .size = index_count * index_size},
+				{.buffer = buffers.meshlet_buffer,
+				 .offset = first.meshlet_offset * sizeof(model::Meshlet),
+				 .size = meshlet_count * sizeof(model::Meshlet)},
+				{.buffer = buffers.meshlet_vertex_buffer,
+				 .offset = first.meshlet_vertex_offset * sizeof(uint32_t),
+				 .size = meshlet_vertex_count * sizeof(uint32_t)},
+				{.buffer = buffers.meshlet_triangle_buffer,
+				 .offset = first.meshlet_triangle_offset * sizeof(uint32_t),
+				 .size = meshlet_triangle_count * sizeof(uint32_t)},
+			});
+
+			const auto write = [&](std::span<const std::span<std::byte>> destinations) {
+				const bool packed = vertex_format == VertexFormat::Packed;
+				const bool short_indices = index_format == IndexFormat::Uint16;
+				const auto arrays = PrimitiveDestination{
+					.vertices = packed
+						? std::span<model::FullVertex>()
+						: util::from_writable_bytes<model::FullVertex>(destinations[0]),
+					.packed_vertices = packed
+						? util::from_writable_bytes<model::PackedVertex>(destinations[0])
+						: std::span<model::PackedVertex>(),
+					.positions = util::from_writable_bytes<glm::vec3>(destinations[1]),
+					.indices = short_indices
+						? std::span<uint32_t>()
+						: util::from_writable_bytes<uint32_t>(destinations[2]),
+					.short_indices = short_indices
+						? util::from_writable_bytes<uint16_t>(destinations[2])
+						: std::span<uint16_t>(),
+					.meshlets = util::from_writable_bytes<model::Meshlet>(destinations[3]),
+					.meshlet_vertices = util::from_writable_bytes<uint32_t>(destinations[4]),
+					.meshlet_triangles = util::from_writable_bytes<uint32_t>(destinations[5])
+				};
+
+				for (const auto& placement : batch)
+					write_primitive(placement, get_primitive_destination(first, placement, arrays));
+
+				return std::expected<void, Error>();
+			};
+
+			if (const auto result = resource_creator.write_buffers_in_place(context, regions, write); !result)
+				co_return result.error().forward("Write primitive data failed");
+
+			co_return resource_creator.execute_uploads_with_size_thres(context, MAX_PENDING_UPLOAD_SIZE);
+		}
+
+		// Hash the sizes, vertices and indices of a primitive into @p seed
+		uint64_t hash_primitive_geometry(
+			std::span<const std::byte> vertices,
+			std::span<const std::byte> indices,
+			uint64_t seed
+		) noexcept
+		{
+			const auto hash = util::hash_object(std::array{vertices.size(), indices.size()}, seed);
+			return util::hash_bytes(indices, util::hash_bytes(vertices, hash));
+		}
+
+		// Hash the full geometry of the primitives of a host-side mesh on the thread pool
+		coro::task<uint64_t> hash_mesh_geometry(
+			coro::thread_pool& thread_pool,
+			const model::Mesh& mesh
+		) noexcept
+		{
+			co_await thread_pool.schedule();
+
+			uint64_t hash = 0;
+			for (const auto& primitive : mesh.primitives)
+			{
+				const auto& geometry = primitive.geometry;
+				hash = hash_primitive_geometry(
+					util::as_bytes(geometry.vertices),
+					util::as_bytes(geometry.indices),
+					hash
+				);
+			}
+
+			co_return hash;
+		}
+
+		// Hash the full geometry of the primitives of each baked mesh, vertices are hashed in the position
+		// stream if present, as it's the one traced
+		std::vector<uint64_t> hash_mesh_geometry(const MeshList::BakedView& baked) noexcept
+		{
+			const auto get_vertices = [&baked](const PrimitiveAttribute& attr) -> std::span<const std::byte> {
+				if (!baked.positions.empty())
+					return util::as_bytes(baked.positions.subspan(attr.vertex_offset, attr.vertex_count));
+				if (!baked.vertices.empty())
+					return util::as_bytes(baked.vertices.subspan(attr.vertex_offset, attr.vertex_count));
+				return util::as_bytes(baked.packed_vertices.subspan(attr.vertex_offset, attr.vertex_count));
+			};
+
+			const auto hash_mesh = [&baked, &get_vertices](PrimitiveIndexRange mesh) {
+				uint64_t hash = 0;
+				for (const auto& attr : baked.primitive_attrs.subspan(mesh.offset, mesh.count))
+				{
+					const auto indices = baked.index_bytes(attr.index_offset, attr.index_count);
+					hash = hash_primitive_geometry(get_vertices(attr), indices, hash);
+				}
+				return hash;
 			};
+
+			return baked.mesh_primitive_index_ranges
+				| std::views::transform(hash_mesh)
+				| std::ranges::to<std::vector>();
 		}
+	}
 
+	std::span<const std::byte> MeshList::BakedView::index_bytes(size_t offset, size_t count) const noexcept
+	{
+		if (index_format == IndexFormat::Uint16) return util::as_bytes(short_indices.subspan(offset, count));
+		return util::as_bytes(indices.subspan(offset, count));
 	}
 
-	std::expected<MeshList, Error> MeshList::create(
+	MeshList::BakedView MeshList::Baked::view() const noexcept
+	{
+		return {
+			.vertex_format = vertex_format,
+			.index_format = index_format,
+			.vertices = vertices,
+			.packed_vertices = packed_vertices,
+			.positions = positions,
+			.indices = indices,
+			.short_indices = short_indices,
+			.primitive_attrs = primitive_attrs,
+			.mesh_primitive_index_ranges = mesh_primitive_index_ranges,
+			.meshlets = meshlets,
+			.meshlet_vertices = meshlet_vertices,
+			.meshlet_triangles = meshlet_triangles,
+			.max_meshlet_count = max_meshlet_count,
+		};
+	}
+
+	MeshList::Baked MeshList::bake(
+		std::span<const model::Mesh> mesh,
+		VertexFormat vertex_format,
+		bool split_positions
+	) noexcept
+	{
+		const bool position_stream = vertex_format == VertexFormat::Packed || split_positions;
+		return collect_mesh_data(mesh, vertex_format, position_stream);
+	}
+
+	std::expected<MeshList, Error> MeshList::upload(
 		const vulkan::Context& context,
-		std::span<const model::Mesh> mesh
+		const BakedView& baked,
+		std::optional<PoolCapacity> pool
 	) noexcept
 	{
-		auto mesh_collect_result = collect_mesh_data(mesh);
+		// Only the coarse geometry is uploaded up front when streaming
+		const auto coarse = pool.transform([&baked](PoolCapacity) { return bake_coarse(baked); });
+		const auto uploaded = coarse.has_value() ? coarse->view() : baked;
 
-		auto buffers_result = create_buffers(context, mesh_collect_result);
+		auto buffers_result = create_buffers(context, uploaded, pool);
 		if (!buffers_result) return buffers_result.error();
 		auto buffers = std::move(*buffers_result);
 
-		return MeshList(
+		auto mesh_list = MeshList(
+			std::move(buffers.vertex_buffer),
+			uploaded.vertex_format,
+			std::move(buffers.position_buffer),
+			std::move(buffers.index_buffer),
+			uploaded.index_format,
+			std::move(buffers.primitive_attr_buffer),
+			std::move(buffers.meshlet_buffer),
+			std::move(buffers.meshlet_vertex_buffer),
+			std::move(buffers.meshlet_triangle_buffer),
+			uploaded.mesh_primitive_index_ranges | std::ranges::to<std::vector>(),
+			uploaded.primitive_attrs | std::ranges::to<std::vector>(),
+			hash_mesh_geometry(uploaded),
+			uploaded.max_meshlet_count
+		);
+
+		if (pool.has_value())
+		{
+			mesh_list.trace_primitive_attr_buffer = std::move(buffers.trace_primitive_attr_buffer);
+			mesh_list.geometry_pool = GeometryPool{
+				.vertex_offset =
+					static_cast<uint32_t>(uploaded.vertices.size() + uploaded.packed_vertices.size()),
+				.vertex_count = pool->vertex_count,
+				.index_offset = static_cast<uint32_t>(uploaded.index_count()),
+				.index_count = pool->index_count,
+			};
+		}
+
+		return mesh_list;
+	}
+
+	coro::task<std::expected<MeshList, Error>> MeshList::create(
+		coro::thread_pool& thread_pool,
+		const vulkan::Context& context,
+		std::span<const model::Mesh> mesh,
+		VertexFormat vertex_format,
+		bool split_positions
+	) noexcept
+	{
+		// Packed vertices can't be used as acceleration structure input, a separate fp32 stream is needed
+		const bool position_stream = vertex_format == VertexFormat::Packed
+			? context.feature.raytracing
+			: split_positions;
+		auto layout = layout_mesh_data(mesh);
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			co_return resource_creator_result.error().forward("Create resource creator failed");
+		auto resource_creator = std::move(*resource_creator_result);
+
+		auto buffers_result =
+			create_empty_buffers(context, resource_creator, layout, vertex_format, position_stream);
+		if (!buffers_result) co_return buffers_result.error();
+		auto buffers = std::move(*buffers_result);
+
+		/* Write batches of primitives in parallel */
+
+		const auto upload_fn = [&](std::span<const PrimitivePlacement> batch) {
+			return upload_batch(
+				thread_pool,
+				context,
+				resource_creator,
+				buffers,
+				vertex_format,
+				layout.index_format,
+				batch
+			);
+		};
+		auto tasks = split_batches(layout.placements, vertex_format, layout.index_format, position_stream)
+			| std::views::transform(upload_fn)
+			| std::ranges::to<std::vector>();
+		auto batch_results = co_await coro::when_all(std::move(tasks));
+
+		// Submitted uploads must complete regardless, as the buffers are destroyed on failure
+		const auto upload_result = resource_creator.execute_uploads(context);
+
+		for (auto& batch_result : batch_results)
+			if (const auto& result = batch_result.return_value(); !result)
+				co_return result.error().forward("Upload primitive batch failed");
+		if (!upload_result) co_return upload_result.error().forward("Execute upload tasks failed");
+
+		/* Hash geometry of meshes in parallel */
+
+		auto hash_tasks = mesh
+			| std::views::transform([&thread_pool](const model::Mesh& source_mesh) {
+				  return hash_mesh_geometry(thread_pool, source_mesh);
+			  })
+			| std::ranges::to<std::vector>();
+		auto mesh_geometry_hashes = co_await coro::when_all(std::move(hash_tasks))
+			| std::views::transform([](auto& result) { return result.return_value(); })
+			| std::ranges::to<std::vector>();
+
+		co_return MeshList(
 			std::move(buffers.vertex_buffer),
+			vertex_format,
+			std::move(buffers.position_buffer),
 			std::move(buffers.index_buffer),
+			layout.index_format,
 			std::move(buffers.primitive_attr_buffer),
-			std::move(mesh_collect_result.mesh_primitive_index_ranges),
-			std::move(mesh_collect_result.primitive_attrs)
+			std::move(buffers.meshlet_buffer),
+			std::move(buffers.meshlet_vertex_buffer),
+			std::move(buffers.meshlet_triangle_buffer),
+			std::move(layout.mesh_primitive_index_ranges),
+			std::move(layout.primitive_attrs),
+			std::move(mesh_geometry_hashes),
+			layout.max_meshlet_count
 		);
 	}
 }
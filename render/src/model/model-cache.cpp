@@ -0,0 +1,753 @@
+#include "render/model/model-cache.hpp"
+#include "common/util/align.hpp"
+#include "common/util/error.hpp"
+#include "common/util/hash.hpp"
+#include "common/util/span.hpp"
+#include "model/hierarchy.hpp"
+#include "model/light.hpp"
+#include "model/material.hpp"
+#include "model/mesh.hpp"
+#include "model/model.hpp"
+#include "model/payload.hpp"
+#include "model/texture.hpp"
+#include "render/model/impostor-list.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/texture-list.hpp"
+#include "render/model/texture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <ios>
+#include <memory>
+#include <mio/mmap.hpp>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * File layout, all integers in native endianness:
+ *
+ * - `Header` at offset 0
+ * - `BlobEntry[blob_count]` at `Header::directory_offset`
+ * - Blobs, each aligned to `BLOB_ALIGNMENT`. A blob is either stored as-is, or as a compressed payload of
+ *   `BlobEntry::codec` (see `model::encode_payload`), decoded into `BlobEntry::raw_size` bytes on open
+ *
+ * The first `BlobId::FixedCount` blobs hold the hierarchy, materials, texture records, mesh buffers,
+ * lights, HLOD clusters and impostors.
+ * Each texture record references two additional blobs per baked texture: its level table
+ * (`Texture::BakedLevel[]`) and its level data.
+ */
+
+namespace render
+{
+	namespace
+	{
+		constexpr auto MAGIC = std::to_array<char>({'V', 'R', 'T', 'C', 'A', 'C', 'H', 'E'});
+		constexpr uint64_t BLOB_ALIGNMENT = 16;
+		constexpr uint32_t NO_BLOB = 0xFFFFFFFF;
+
+		struct Header
+		{
+			std::array<char, 8> magic;
+			uint32_t version;
+			uint32_t blob_count;
+			uint64_t source_hash;
+			uint64_t option_hash;
+			uint64_t directory_offset;
+			uint32_t vertex_format;
+			uint32_t max_meshlet_count;
+			uint32_t index_format;
+		};
+
+		struct BlobEntry
+		{
+			uint64_t offset;
+			uint64_t size;       // Stored size
+			uint64_t raw_size;   // Decoded size, equal to `size` if stored as-is
+			uint32_t codec;      // `model::PayloadCodec`
+			uint32_t stride;     // Element size for the codec
+		};
+
+		enum BlobId : uint32_t
+		{
+			Nodes,
+			Materials,
+			TextureTuples,
+			Vertices,
+			PackedVertices,
+			Positions,
+			Indices,
+			ShortIndices,
+			PrimitiveAttrs,
+			MeshRanges,
+			Meshlets,
+			MeshletVertices,
+			MeshletTriangles,
+			Lights,
+			HlodClusters,
+			HlodSourceNodes,
+			Impostors,
+			ImpostorTexels,
+			FixedCount
+		};
+
+		struct TextureRecord
+		{
+			uint32_t levels_blob;  // `NO_BLOB` if the texture is absent
+			uint32_t data_blob;
+			Texture::Format format;
+			uint32_t has_min_alpha;
+			float min_alpha;
+		};
+
+		struct TextureTupleRecord
+		{
+			TextureRecord color;
+			TextureRecord normal;
+			model::SampleMode sample_mode;
+		};
+
+		// Types stored as raw bytes, their layouts are covered by `get_layout_hash`
+		static_assert(std::is_trivially_copyable_v<model::ParentOnlyNode>);
+		static_assert(std::is_trivially_copyable_v<model::Material>);
+		static_assert(std::is_trivially_copyable_v<model::Light>);
+		static_assert(std::is_trivially_copyable_v<model::HlodCluster>);
+		static_assert(std::is_trivially_copyable_v<ImpostorList::BakedImpostor>);
+		static_assert(std::is_trivially_copyable_v<model::FullVertex>);
+		static_assert(std::is_trivially_copyable_v<model::PackedVertex>);
+		static_assert(std::is_trivially_copyable_v<model::Meshlet>);
+		static_assert(std::is_trivially_copyable_v<PrimitiveAttribute>);
+		static_assert(std::is_trivially_copyable_v<PrimitiveIndexRange>);
+		static_assert(std::is_trivially_copyable_v<Texture::BakedLevel>);
+		static_assert(std::is_trivially_copyable_v<TextureTupleRecord>);
+
+		uint64_t get_layout_hash() noexcept
+		{
+			const auto sizes = std::to_array<uint64_t>({
+				sizeof(Header),
+				sizeof(BlobEntry),
+				sizeof(TextureTupleRecord),
+				sizeof(model::ParentOnlyNode),
+				sizeof(model::Material),
+				sizeof(model::Light),
+				sizeof(model::HlodCluster),
+				sizeof(ImpostorList::BakedImpostor),
+				sizeof(model::FullVertex),
+				sizeof(model::PackedVertex),
+				sizeof(model::Meshlet),
+				sizeof(PrimitiveAttribute),
+				sizeof(PrimitiveIndexRange),
+				sizeof(Texture::BakedLevel),
+			});
+			return util::hash_bytes(util::as_bytes(sizes));
+		}
+
+		// Raw blob with the codec compressing it, if compression is enabled
+		struct Blob
+		{
+			std::span<const std::byte> data;
+			model::PayloadCodec codec = model::PayloadCodec::None;
+			uint32_t stride = 0;
+		};
+
+		// Serialized blobs of a baked model, in directory order
+		struct BlobList
+		{
+			std::vector<TextureTupleRecord> texture_records;
+			std::vector<Blob> blobs;
+		};
+
+		template <typename T>
+		Blob vertex_blob(std::span<const T> data) noexcept
+		{
+			return {.data = util::as_bytes(data), .codec = model::PayloadCodec::Vertex, .stride = sizeof(T)};
+		}
+
+		template <typename T>
+		Blob index_blob(std::span<const T> data) noexcept
+		{
+			return {
+				.data = util::as_bytes(data),
+				.codec = model::PayloadCodec::IndexSequence,
+				.stride = sizeof(T)
+			};
+		}
+
+		BlobList collect_blobs(const Model::BakedView& baked) noexcept
+		{
+			BlobList result;
+			auto& blobs = result.blobs;
+
+			// Bulk arrays are compressible, small records are always stored as-is
+			blobs.resize(BlobId::FixedCount);
+			blobs[BlobId::Nodes] = {.data = util::as_bytes(baked.nodes)};
+			blobs[BlobId::Materials] = {.data = util::as_bytes(baked.materials)};
+			blobs[BlobId::Vertices] = vertex_blob(baked.mesh.vertices);
+			blobs[BlobId::PackedVertices] = vertex_blob(baked.mesh.packed_vertices);
+			blobs[BlobId::Positions] = vertex_blob(baked.mesh.positions);
+			blobs[BlobId::Indices] = index_blob(baked.mesh.indices);
+			blobs[BlobId::ShortIndices] = index_blob(baked.mesh.short_indices);
+			blobs[BlobId::PrimitiveAttrs] = {.data = util::as_bytes(baked.mesh.primitive_attrs)};
+			blobs[BlobId::MeshRanges] = {.data = util::as_bytes(baked.mesh.mesh_primitive_index_ranges)};
+			blobs[BlobId::Meshlets] = {.data = util::as_bytes(baked.mesh.meshlets)};
+			blobs[BlobId::MeshletVertices] = index_blob(baked.mesh.meshlet_vertices);
+			blobs[BlobId::MeshletTriangles] = vertex_blob(baked.mesh.meshlet_triangles);
+			blobs[BlobId::Lights] = {.data = util::as_bytes(baked.lights)};
+			blobs[BlobId::HlodClusters] = {.data = util::as_bytes(baked.hlod_clusters)};
+			blobs[BlobId::HlodSourceNodes] = {.data = util::as_bytes(baked.hlod_source_nodes)};
+			blobs[BlobId::Impostors] = {.data = util::as_bytes(baked.impostor.impostors)};
+			blobs[BlobId::ImpostorTexels] = vertex_blob(baked.impostor.texels);
+
+			const auto push_texture = [&blobs](const std::optional<Texture::BakedView>& texture) {
+				if (!texture.has_value())
+				{
+					return TextureRecord{
+						.levels_blob = NO_BLOB,
+						.data_blob = NO_BLOB,
+						.format = {},
+						.has_min_alpha = 0,
+						.min_alpha = 0.0f
+					};
+				}
+
+				// Level data is compressed as 16-byte elements, the block size of most formats
+				const auto levels_blob = static_cast<uint32_t>(blobs.size());
+				blobs.push_back({.data = util::as_bytes(texture->levels)});
+				blobs.push_back({.data = texture->data, .codec = model::PayloadCodec::Vertex, .stride = 16});
+
+				return TextureRecord{
+					.levels_blob = levels_blob,
+					.data_blob = levels_blob + 1,
+					.format = texture->format,
+					.has_min_alpha = texture->min_alpha.has_value() ? 1u : 0u,
+					.min_alpha = texture->min_alpha.value_or(0.0f)
+				};
+			};
+
+			result.texture_records =
+				baked.textures
+				| std::views::transform([&push_texture](const TextureList::BakedTupleView& tuple) {
+					  return TextureTupleRecord{
+						  .color = push_texture(tuple.color),
+						  .normal = push_texture(tuple.normal),
+						  .sample_mode = tuple.sample_mode
+					  };
+				  })
+				| std::ranges::to<std::vector>();
+			blobs[BlobId::TextureTuples] = {.data = util::as_bytes(result.texture_records)};
+
+			return result;
+		}
+
+		// Raw blobs of a cache file, either mapped or decoded into `decoded`
+		struct ResolvedBlobs
+		{
+			std::vector<std::span<const std::byte>> blobs;
+			std::vector<std::byte> decoded;
+		};
+
+		std::expected<ResolvedBlobs, Error> resolve_blobs(
+			std::span<const BlobEntry> directory,
+			std::span<const std::byte> file
+		) noexcept
+		{
+			ResolvedBlobs result;
+			result.blobs.reserve(directory.size());
+
+			uint64_t decoded_size = 0;
+			for (const auto [blob_id, entry] : directory | std::views::enumerate)
+			{
+				const auto [offset, size, raw_size, codec, stride] = entry;
+				if (offset % BLOB_ALIGNMENT != 0 || offset > file.size() || size > file.size() - offset)
+					return Error("Invalid cache file", std::format("Blob {} out of range", blob_id));
+
+				if (codec == static_cast<uint32_t>(model::PayloadCodec::None))
+				{
+					if (raw_size != size)
+						return Error("Invalid cache file", std::format("Blob {} has invalid size", blob_id));
+					continue;
+				}
+
+				decoded_size = util::align_address(decoded_size, BLOB_ALIGNMENT) + raw_size;
+			}
+
+			// Compressed blobs are decoded into one allocation, aligned as if they were mapped
+			result.decoded.resize(decoded_size);
+
+			std::vector<model::Payload> payloads;
+			uint64_t decoded_offset = 0;
+			for (const auto& [offset, size, raw_size, codec, stride] : directory)
+			{
+				const auto stored = file.subspan(offset, size);
+				if (codec == static_cast<uint32_t>(model::PayloadCodec::None))
+				{
+					result.blobs.push_back(stored);
+					continue;
+				}
+
+				decoded_offset = util::align_address(decoded_offset, BLOB_ALIGNMENT);
+				const auto decoded = std::span(result.decoded).subspan(decoded_offset, raw_size);
+				decoded_offset += raw_size;
+
+				payloads.push_back({
+					.codec = static_cast<model::PayloadCodec>(codec),
+					.stride = stride,
+					.encoded = stored,
+					.decoded = decoded,
+				});
+				result.blobs.push_back(decoded);
+			}
+
+			if (const auto decode_result = model::decode_payloads(payloads); !decode_result)
+				return decode_result.error().forward("Invalid cache file");
+
+			return result;
+		}
+
+		template <typename T>
+		std::expected<std::span<const T>, Error> get_blob(
+			std::span<const std::span<const std::byte>> blobs,
+			uint32_t blob_id
+		) noexcept
+		{
+			if (blob_id >= blobs.size())
+				return Error("Invalid cache file", std::format("Blob {} doesn't exist", blob_id));
+
+			const auto blob = blobs[blob_id];
+			if (blob.size() % sizeof(T) != 0)
+				return Error("Invalid cache file", std::format("Blob {} has invalid size", blob_id));
+
+			return util::from_bytes<const T>(blob);
+		}
+
+		std::expected<std::optional<Texture::BakedView>, Error> get_texture(
+			std::span<const std::span<const std::byte>> blobs,
+			const TextureRecord& record
+		) noexcept
+		{
+			if (record.levels_blob == NO_BLOB) return std::nullopt;
+
+			if (static_cast<uint32_t>(record.format) > static_cast<uint32_t>(Texture::Format::ASTC4x4))
+				return Error("Invalid cache file", "Invalid texture format");
+
+			auto levels_result = get_blob<Texture::BakedLevel>(blobs, record.levels_blob);
+			if (!levels_result) return levels_result.error();
+			auto data_result = get_blob<std::byte>(blobs, record.data_blob);
+			if (!data_result) return data_result.error();
+
+			return Texture::BakedView{
+				.format = record.format,
+				.min_alpha = record.has_min_alpha != 0 ? std::optional(record.min_alpha) : std::nullopt,
+				.levels = *levels_result,
+				.data = *data_result
+			};
+		}
+
+		// Validate indices used on the CPU side, GPU-side offsets are trusted once the key matches
+		std::expected<void, Error> validate_indices(const Model::BakedView& baked) noexcept
+		{
+			const auto mesh_count = baked.mesh.mesh_primitive_index_ranges.size();
+			const auto primitive_count = baked.mesh.primitive_attrs.size();
+
+			for (const auto& node : baked.nodes)
+				if (node.data.mesh_index.has_value() && *node.data.mesh_index >= mesh_count)
+					return Error("Mesh index out of range");
+
+			for (const auto& node : baked.nodes)
+				if (node.data.light_index.has_value() && *node.data.light_index >= baked.lights.size())
+					return Error("Light index out of range");
+
+			for (const auto& range : baked.mesh.mesh_primitive_index_ranges)
+				if (uint64_t(range.offset) + range.count > primitive_count)
+					return Error("Primitive range out of range");
+
+			for (const auto& attr : baked.mesh.primitive_attrs)
+			{
+				if (attr.material_index != DEFAULT_MATERIAL && attr.material_index >= baked.materials.size())
+					return Error("Material index out of range");
+				if (attr.lod_count == 0 || attr.lod_count > PrimitiveAttribute::MAX_LOD_COUNT)
+					return Error("Invalid LOD count");
+			}
+
+			for (const auto& cluster : baked.hlod_clusters)
+			{
+				if (cluster.proxy_node_index >= baked.nodes.size())
+					return Error("HLOD proxy node out of range");
+				if (uint64_t(cluster.source_offset) + cluster.source_count > baked.hlod_source_nodes.size())
+					return Error("HLOD source range out of range");
+			}
+
+			for (const auto node : baked.hlod_source_nodes)
+				if (node >= baked.nodes.size()) return Error("HLOD source node out of range");
+
+			uint64_t impostor_texel_count = 0;
+			for (const auto& impostor : baked.impostor.impostors)
+			{
+				if (impostor.mesh_index >= mesh_count) return Error("Impostor mesh index out of range");
+
+				const auto atlas_size = uint64_t(impostor.frame_count) * impostor.frame_size;
+				impostor_texel_count += atlas_size * atlas_size * 2;
+			}
+
+			if (impostor_texel_count != baked.impostor.texels.size())
+				return Error("Impostor texel count mismatch");
+
+			const auto vertex_format_valid = baked.mesh.vertex_format == VertexFormat::Packed
+				|| baked.mesh.vertex_format == VertexFormat::Full;
+			if (!vertex_format_valid) return Error("Invalid vertex format");
+
+			const auto index_format_valid = baked.mesh.index_format == IndexFormat::Uint16
+				? baked.mesh.indices.empty()
+				: baked.mesh.index_format == IndexFormat::Uint32 && baked.mesh.short_indices.empty();
+			if (!index_format_valid) return Error("Invalid index format");
+
+			return {};
+		}
+	}
+
+	std::expected<uint64_t, Error> ModelCache::hash_file(const std::filesystem::path& path) noexcept
+	{
+		std::error_code error_code;
+		const auto file_size = std::filesystem::file_size(path, error_code);
+		if (error_code)
+			return Error(
+				std::format("Get size of file '{}' failed", path.string()),
+				error_code.message()
+			);
+
+		// Empty files can't be mapped
+		if (file_size == 0) return util::hash_bytes({});
+
+		try
+		{
+			const auto mmap = mio::basic_mmap_source<std::byte>(path.string(), 0);
+			return util::hash_bytes(std::span(mmap.data(), mmap.size()));
+		}
+		catch (const std::system_error& e)
+		{
+			return Error(
+				"Memory map file failed",
+				std::format("Path: {}, what(): {:?}", path.string(), e.what())
+			);
+		}
+	}
+
+	ModelCache::Key ModelCache::get_key(uint64_t source_hash, const Model::Option& option) noexcept
+	{
+		const auto& texture_option = option.texture_load_option;
+		const auto option_fields = std::to_array<uint32_t>({
+			static_cast<uint32_t>(texture_option.color_load_strategy),
+			static_cast<uint32_t>(texture_option.normal_load_strategy),
+			static_cast<uint32_t>(texture_option.exit_on_failed_load),
+			texture_option.max_size,
+			texture_option.bc7_quality.uber_level,
+			texture_option.bc7_quality.max_partitions,
+			static_cast<uint32_t>(option.vertex_format),
+			static_cast<uint32_t>(option.split_positions),
+			static_cast<uint32_t>(option.optimize_mesh),
+			static_cast<uint32_t>(option.generate_lod),
+		});
+
+		return Key{
+			.source_hash = source_hash,
+			.option_hash = util::hash_bytes(util::as_bytes(option_fields), get_layout_hash())
+		};
+	}
+
+	std::expected<void, Error> ModelCache::write(
+		const std::filesystem::path& path,
+		Key key,
+		const Model::BakedView& baked,
+		bool compress
+	) noexcept
+	{
+		const auto blob_list = collect_blobs(baked);
+
+		/* Compress */
+
+		// Blobs that don't shrink are stored as-is
+		std::vector<std::vector<std::byte>> payloads(blob_list.blobs.size());
+		std::vector<std::span<const std::byte>> blobs;
+		std::vector<std::pair<model::PayloadCodec, uint32_t>> codecs;
+		for (const auto& [blob, payload] : std::views::zip(blob_list.blobs, payloads))
+		{
+			auto encoded = compress && blob.codec != model::PayloadCodec::None
+				? model::encode_payload(blob.data, blob.codec, blob.stride)
+				: std::nullopt;
+
+			if (encoded.has_value())
+			{
+				payload = std::move(*encoded);
+				blobs.push_back(payload);
+				codecs.emplace_back(blob.codec, blob.stride);
+			}
+			else
+			{
+				blobs.push_back(blob.data);
+				codecs.emplace_back(model::PayloadCodec::None, 0);
+			}
+		}
+
+		/* Layout */
+
+		const auto directory_offset = util::align_address(sizeof(Header), BLOB_ALIGNMENT);
+		const auto directory_end = directory_offset + blobs.size() * sizeof(BlobEntry);
+		auto data_offset = util::align_address(directory_end, BLOB_ALIGNMENT);
+
+		std::vector<BlobEntry> directory;
+		directory.reserve(blobs.size());
+		for (const auto& [blob, source, codec] : std::views::zip(blobs, blob_list.blobs, codecs))
+		{
+			directory.push_back(
+				BlobEntry{
+					.offset = data_offset,
+					.size = blob.size(),
+					.raw_size = source.data.size(),
+					.codec = static_cast<uint32_t>(codec.first),
+					.stride = codec.second
+				}
+			);
+			data_offset = util::align_address(data_offset + blob.size(), BLOB_ALIGNMENT);
+		}
+
+		const auto header = Header{
+			.magic = MAGIC,
+			.version = VERSION,
+			.blob_count = static_cast<uint32_t>(blobs.size()),
+			.source_hash = key.source_hash,
+			.option_hash = key.option_hash,
+			.directory_offset = directory_offset,
+			.vertex_format = static_cast<uint32_t>(baked.mesh.vertex_format),
+			.max_meshlet_count = baked.mesh.max_meshlet_count,
+			.index_format = static_cast<uint32_t>(baked.mesh.index_format)
+		};
+
+		/* Write to temporary file */
+
+		auto temp_path = path;
+		temp_path += ".tmp";
+
+		std::error_code error_code;
+		if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error_code);
+		if (error_code)
+			return Error(
+				std::format("Create directory '{}' failed", path.parent_path().string()),
+				error_code.message()
+			);
+
+		std::ofstream file;
+		file.exceptions(std::ios::failbit | std::ios::badbit);
+
+		try
+		{
+			file.open(temp_path, std::ios::binary | std::ios::trunc);
+
+			uint64_t position = 0;
+			const auto write_at = [&file, &position](uint64_t offset, std::span<const std::byte> data) {
+				static constexpr auto ZEROS = std::array<char, BLOB_ALIGNMENT>{};
+				file.write(ZEROS.data(), static_cast<std::streamsize>(offset - position));
+				file.write(
+					reinterpret_cast<const char*>(data.data()),
+					static_cast<std::streamsize>(data.size())
+				);
+				position = offset + data.size();
+			};
+
+			write_at(0, util::object_as_bytes(header));
+			write_at(directory_offset, util::as_bytes(directory));
+			for (const auto& [entry, blob] : std::views::zip(directory, blobs)) write_at(entry.offset, blob);
+
+			file.close();
+		}
+		catch (const std::ios::failure& e)
+		{
+			std::filesystem::remove(temp_path, error_code);
+			return Error(std::format("Write file '{}' failed", temp_path.string()), e.what());
+		}
+
+		/* Replace */
+
+		std::filesystem::rename(temp_path, path, error_code);
+		if (error_code)
+		{
+			std::filesystem::remove(temp_path, error_code);
+			return Error(std::format("Rename '{}' failed", temp_path.string()), error_code.message());
+		}
+
+		return {};
+	}
+
+	std::expected<ModelCache, Error> ModelCache::open(const std::filesystem::path& path, Key key) noexcept
+	{
+		if (!std::filesystem::is_regular_file(path))
+			return Error("Cache file doesn't exist", std::format("Path: {}", path.string()));
+
+		std::shared_ptr<const mio::basic_mmap_source<std::byte>> mmap;
+		try
+		{
+			mmap = std::make_shared<const mio::basic_mmap_source<std::byte>>(path.string(), 0);
+		}
+		catch (const std::system_error& e)
+		{
+			return Error(
+				"Memory map file failed",
+				std::format("Path: {}, what(): {:?}", path.string(), e.what())
+			);
+		}
+
+		const auto file = std::span(mmap->data(), mmap->size());
+
+		/* Header */
+
+		if (file.size() < sizeof(Header)) return Error("Invalid cache file", "File too small");
+
+		Header header;
+		std::memcpy(&header, file.data(), sizeof(Header));
+
+		if (header.magic != MAGIC) return Error("Invalid cache file", "Magic mismatch");
+		if (header.version != VERSION)
+			return Error(
+				"Outdated cache file",
+				std::format("Version {}, expected {}", header.version, VERSION)
+			);
+		if (header.source_hash != key.source_hash || header.option_hash != key.option_hash)
+			return Error("Outdated cache file", "Key mismatch");
+
+		/* Directory */
+
+		if (header.blob_count < BlobId::FixedCount) return Error("Invalid cache file", "Too few blobs");
+
+		const auto directory_size = uint64_t(header.blob_count) * sizeof(BlobEntry);
+		if (header.directory_offset % alignof(BlobEntry) != 0
+			|| header.directory_offset > file.size()
+			|| directory_size > file.size() - header.directory_offset)
+			return Error("Invalid cache file", "Directory out of range");
+
+		const auto directory =
+			util::from_bytes<const BlobEntry>(file.subspan(header.directory_offset, directory_size));
+
+		auto resolved_result = resolve_blobs(directory, file);
+		if (!resolved_result) return resolved_result.error().forward("Read blobs failed");
+		auto [blobs, decoded] = std::move(*resolved_result);
+
+		/* Fixed blobs */
+
+		auto nodes_result = get_blob<model::ParentOnlyNode>(blobs, BlobId::Nodes);
+		auto materials_result = get_blob<model::Material>(blobs, BlobId::Materials);
+		auto texture_tuples_result = get_blob<TextureTupleRecord>(blobs, BlobId::TextureTuples);
+		auto vertices_result = get_blob<model::FullVertex>(blobs, BlobId::Vertices);
+		auto packed_vertices_result = get_blob<model::PackedVertex>(blobs, BlobId::PackedVertices);
+		auto positions_result = get_blob<glm::vec3>(blobs, BlobId::Positions);
+		auto indices_result = get_blob<uint32_t>(blobs, BlobId::Indices);
+		auto short_indices_result = get_blob<uint16_t>(blobs, BlobId::ShortIndices);
+		auto primitive_attrs_result = get_blob<PrimitiveAttribute>(blobs, BlobId::PrimitiveAttrs);
+		auto mesh_ranges_result = get_blob<PrimitiveIndexRange>(blobs, BlobId::MeshRanges);
+		auto meshlets_result = get_blob<model::Meshlet>(blobs, BlobId::Meshlets);
+		auto meshlet_vertices_result = get_blob<uint32_t>(blobs, BlobId::MeshletVertices);
+		auto meshlet_triangles_result = get_blob<uint32_t>(blobs, BlobId::MeshletTriangles);
+		auto lights_result = get_blob<model::Light>(blobs, BlobId::Lights);
+		auto hlod_clusters_result = get_blob<model::HlodCluster>(blobs, BlobId::HlodClusters);
+		auto hlod_source_nodes_result = get_blob<uint32_t>(blobs, BlobId::HlodSourceNodes);
+		auto impostors_result = get_blob<ImpostorList::BakedImpostor>(blobs, BlobId::Impostors);
+		auto impostor_texels_result = get_blob<glm::u8vec4>(blobs, BlobId::ImpostorTexels);
+
+		if (!nodes_result) return nodes_result.error().forward("Read nodes failed");
+		if (!materials_result) return materials_result.error().forward("Read materials failed");
+		if (!texture_tuples_result) return texture_tuples_result.error().forward("Read textures failed");
+		if (!vertices_result) return vertices_result.error().forward("Read vertices failed");
+		if (!packed_vertices_result)
+			return packed_vertices_result.error().forward("Read packed vertices failed");
+		if (!positions_result) return positions_result.error().forward("Read positions failed");
+		if (!indices_result) return indices_result.error().forward("Read indices failed");
+		if (!short_indices_result) return short_indices_result.error().forward("Read short indices failed");
+		if (!primitive_attrs_result)
+			return primitive_attrs_result.error().forward("Read primitive attributes failed");
+		if (!mesh_ranges_result) return mesh_ranges_result.error().forward("Read mesh ranges failed");
+		if (!meshlets_result) return meshlets_result.error().forward("Read meshlets failed");
+		if (!meshlet_vertices_result)
+			return meshlet_vertices_result.error().forward("Read meshlet vertices failed");
+		if (!meshlet_triangles_result)
+			return meshlet_triangles_result.error().forward("Read meshlet triangles failed");
+		if (!lights_result) return lights_result.error().forward("Read lights failed");
+		if (!hlod_clusters_result) return hlod_clusters_result.error().forward("Read HLOD clusters failed");
+		if (!hlod_source_nodes_result)
+			return hlod_source_nodes_result.error().forward("Read HLOD source nodes failed");
+		if (!impostors_result) return impostors_result.error().forward("Read impostors failed");
+		if (!impostor_texels_result)
+			return impostor_texels_result.error().forward("Read impostor texels failed");
+
+		/* Textures */
+
+		std::vector<TextureList::BakedTupleView> textures;
+		textures.reserve(texture_tuples_result->size());
+		for (const auto& [idx, record] : *texture_tuples_result | std::views::enumerate)
+		{
+			auto color_result = get_texture(blobs, record.color);
+			if (!color_result)
+				return color_result.error()
+					.forward("Read color texture failed", std::format("Index: {}", idx));
+
+			auto normal_result = get_texture(blobs, record.normal);
+			if (!normal_result)
+				return normal_result.error()
+					.forward("Read normal texture failed", std::format("Index: {}", idx));
+
+			textures.push_back(
+				TextureList::BakedTupleView{
+					.color = *color_result,
+					.normal = *normal_result,
+					.sample_mode = record.sample_mode
+				}
+			);
+		}
+
+		/* Assemble */
+
+		auto baked = Model::BakedView{
+			.nodes = *nodes_result,
+			.materials = *materials_result,
+			.textures = std::move(textures),
+			.mesh = MeshList::BakedView{
+				.vertex_format = static_cast<VertexFormat>(header.vertex_format),
+				.index_format = static_cast<IndexFormat>(header.index_format),
+				.vertices = *vertices_result,
+				.packed_vertices = *packed_vertices_result,
+				.positions = *positions_result,
+				.indices = *indices_result,
+				.short_indices = *short_indices_result,
+				.primitive_attrs = *primitive_attrs_result,
+				.mesh_primitive_index_ranges = *mesh_ranges_result,
+				.meshlets = *meshlets_result,
+				.meshlet_vertices = *meshlet_vertices_result,
+				.meshlet_triangles = *meshlet_triangles_result,
+				.max_meshlet_count = header.max_meshlet_count
+			},
+			.lights = *lights_result,
+			.hlod_clusters = *hlod_clusters_result,
+			.hlod_source_nodes = *hlod_source_nodes_result,
+			.impostor = ImpostorList::BakedView{
+				.impostors = *impostors_result,
+				.texels = *impostor_texels_result
+			}
+		};
+
+		if (const auto validate_result = validate_indices(baked); !validate_result)
+			return validate_result.error().forward("Invalid cache file");
+
+		return ModelCache(std::move(mmap), std::move(decoded), std::move(baked));
+	}
+}
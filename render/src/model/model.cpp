@@ -1,40 +1,162 @@
 #include "render/model/model.hpp"
+#include "common/util/async.hpp"
 #include "common/util/error.hpp"
+#include "model/hierarchy.hpp"
+#include "model/mesh.hpp"
 #include "model/model.hpp"
 #include "render/model/blas.hpp"
+#include "render/model/deform-list.hpp"
+#include "render/model/emissive-list.hpp"
+#include "render/model/impostor-list.hpp"
+#include "render/model/light-list.hpp"
 #include "render/model/material.hpp"
 #include "render/model/mesh.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/model/texture-list.hpp"
+#include "render/model/texture.hpp"
 #include "vulkan/interface/context.hpp"
 
 #include <coro/task.hpp>
 #include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+#include <cstdint>
 #include <expected>
 #include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stop_token>
 #include <utility>
+#include <vector>
 
 namespace render
 {
+	coro::task<model::Primitive> Model::process_primitive(
+		coro::thread_pool& thread_pool,
+		const model::Primitive& primitive,
+		bool optimize,
+		bool generate_lod,
+		std::stop_token stop_token
+	) noexcept
+	{
+		co_await thread_pool.schedule();
+
+		if (stop_token.stop_requested()) co_return primitive;
+
+		// LODs index into the vertices, so they are generated after vertex reordering. Deformations index
+		// into the vertices too, deformed primitives are left in their order
+		const bool reorder = optimize && primitive.deformation.empty();
+		auto geometry = reorder ? primitive.geometry.optimize() : primitive.geometry;
+		auto lods = generate_lod ? geometry.simplify({}) : primitive.lods;
+
+		co_return model::Primitive{
+			.geometry = std::move(geometry),
+			.lods = std::move(lods),
+			.material_index = primitive.material_index,
+			.deformation = primitive.deformation
+		};
+	}
+
+	coro::task<std::optional<std::vector<model::Mesh>>> Model::process_meshes(
+		coro::thread_pool& thread_pool,
+		const model::Model& model,
+		Option option,
+		std::stop_token stop_token
+	) noexcept
+	{
+		co_await thread_pool.schedule();
+
+		if (!option.optimize_mesh && !option.generate_lod) co_return std::nullopt;
+
+		/* Process all primitives in parallel, then regroup into meshes */
+
+		const auto process_fn = [&thread_pool, &option, &stop_token](const model::Primitive& primitive) {
+			return process_primitive(
+				thread_pool,
+				primitive,
+				option.optimize_mesh,
+				option.generate_lod,
+				stop_token
+			);
+		};
+		auto tasks = model.meshes
+			| std::views::transform(&model::Mesh::primitives)
+			| std::views::join
+			| std::views::transform(process_fn)
+			| std::ranges::to<std::vector>();
+		auto processed_primitives = co_await coro::when_all(std::move(tasks));
+
+		auto primitive_iter = processed_primitives.begin();
+		const auto regroup_mesh = [&primitive_iter](const model::Mesh& mesh) {
+			auto primitives =
+				std::ranges::subrange(primitive_iter, primitive_iter + mesh.primitives.size())
+				| std::views::transform([](auto& result) { return std::move(result.return_value()); })
+				| std::ranges::to<std::vector>();
+			primitive_iter += mesh.primitives.size();
+			return model::Mesh{.primitives = std::move(primitives), .morph_weights = mesh.morph_weights};
+		};
+
+		co_return model.meshes | std::views::transform(regroup_mesh) | std::ranges::to<std::vector>();
+	}
+
 	coro::task<std::expected<MeshList, Error>> Model::create_mesh(
 		coro::thread_pool& thread_pool,
 		const vulkan::Context& context,
-		const model::Model& model
+		const model::Model& model,
+		Option option,
+		std::stop_token stop_token
 	) noexcept
 	{
-		co_await thread_pool.schedule();
-		auto mesh_list = MeshList::create(context, model.meshes);
-		co_return mesh_list;
+		const auto processed_meshes = co_await process_meshes(thread_pool, model, option, stop_token);
+		if (stop_token.stop_requested()) co_return Error("Cancelled");
+
+		const auto meshes =
+			processed_meshes.has_value() ? std::span<const model::Mesh>(*processed_meshes) : model.meshes;
+
+		co_return co_await MeshList::create(
+			thread_pool,
+			context,
+			meshes,
+			option.vertex_format,
+			option.split_positions
+		);
 	}
 
 	coro::task<std::expected<BlasList, Error>> Model::create_blas(
 		coro::thread_pool& thread_pool,
 		const vulkan::Context& context,
 		const MaterialList& material_list,
-		const MeshList& mesh_list
+		const MeshList& mesh_list,
+		Option option,
+		std::stop_token stop_token,
+		std::span<const uint32_t> deformable_meshes
 	) noexcept
 	{
 		co_await thread_pool.schedule();
-		auto blas_list = BlasList::create(context, mesh_list, material_list);
-		co_return blas_list;
+
+		// Fast-built BLASes are meant to be replaced soon, compaction would only delay the first frame
+		if (option.fast_build_blas)
+			co_return co_await BlasList::create(
+				thread_pool,
+				context,
+				mesh_list,
+				material_list,
+				false,
+				BlasList::BuildPreference::FastBuild,
+				std::move(stop_token),
+				deformable_meshes
+			);
+
+		co_return co_await BlasList::create(
+			thread_pool,
+			context,
+			mesh_list,
+			material_list,
+			option.compact_blas,
+			BlasList::BuildPreference::FastTrace,
+			std::move(stop_token),
+			deformable_meshes
+		);
 	}
 
 	std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Model::Progress>> Model::create(
@@ -42,11 +164,20 @@ namespace render
 		const vulkan::Context& context,
 		const MaterialLayout& material_layout,
 		const model::Model& model,
-		Option option
+		Option option,
+		std::stop_token stop_token
 	) noexcept
 	{
 		auto progress = std::make_shared<Progress>(Progress::from<ProgressState::Preparing>());
-		auto task = create_impl(thread_pool, progress, context, material_layout, model, option);
+		auto task = create_impl(
+			thread_pool,
+			progress,
+			context,
+			material_layout,
+			model,
+			option,
+			std::move(stop_token)
+		);
 		return {std::move(task), progress};
 	}
 
@@ -56,7 +187,8 @@ namespace render
 		const vulkan::Context& context,
 		const MaterialLayout& material_layout,
 		const model::Model& model,
-		Option option
+		Option option,
+		std::stop_token stop_token
 	) noexcept
 	{
 		auto [material_task, material_progress] = MaterialList::create(
@@ -64,13 +196,15 @@ namespace render
 			context,
 			material_layout,
 			model.material_list,
-			option.texture_load_option
+			option.texture_load_option,
+			option.sampler_option,
+			stop_token
 		);
 		progress->set<ProgressState::Material>(material_progress);
 		auto material_result = co_await std::move(material_task);
 
 		progress->set<ProgressState::Mesh>();
-		auto mesh_result = co_await create_mesh(thread_pool, context, model);
+		auto mesh_result = co_await create_mesh(thread_pool, context, model, option, stop_token);
 
 		if (!material_result) co_return material_result.error().forward("Create material list failed");
 		if (!mesh_result) co_return mesh_result.error().forward("Create mesh list failed");
@@ -79,10 +213,277 @@ namespace render
 		auto mesh = std::move(*mesh_result);
 
 		progress->set<ProgressState::Blas>();
-		auto blas_result = co_await create_blas(thread_pool, context, material, mesh);
+		const auto deformable_meshes = DeformList::get_deformable_meshes(model);
+		auto blas_result =
+			co_await create_blas(thread_pool, context, material, mesh, option, stop_token, deformable_meshes);
 		if (!blas_result) co_return blas_result.error().forward("Create BLAS failed");
 		auto blas = std::move(*blas_result);
 
-		co_return Model(model.hierarchy, std::move(mesh), std::move(material), std::move(blas));
+		auto scene_graph_result = SceneGraph::create(
+			context,
+			model.hierarchy,
+			mesh,
+			material,
+			option.instance_capacity,
+			model.hlod.clusters,
+			model.hlod.source_nodes
+		);
+		if (!scene_graph_result) co_return scene_graph_result.error().forward("Create scene graph failed");
+		auto scene_graph = std::move(*scene_graph_result);
+
+		auto light_list_result = LightList::create(context, model.hierarchy, model.lights);
+		if (!light_list_result) co_return light_list_result.error().forward("Create light list failed");
+		auto light_list = std::move(*light_list_result);
+
+		auto emissive_list_result =
+			EmissiveList::create(context, model.hierarchy, mesh, model.material_list.materials, scene_graph);
+		if (!emissive_list_result)
+			co_return emissive_list_result.error().forward("Create emissive list failed");
+		auto emissive_list = std::move(*emissive_list_result);
+
+		std::optional<DeformList> deform_list;
+		if (!deformable_meshes.empty())
+		{
+			auto deform_list_result = DeformList::create(context, model, mesh);
+			if (!deform_list_result)
+				co_return deform_list_result.error().forward("Create deform list failed");
+			deform_list.emplace(std::move(*deform_list_result));
+		}
+
+		const auto baked_impostors = ImpostorList::bake(model.impostors);
+		auto impostor_list_result = ImpostorList::create(context, baked_impostors.view(), mesh);
+		if (!impostor_list_result)
+			co_return impostor_list_result.error().forward("Create impostor list failed");
+
+		co_return Model(
+			model.hierarchy,
+			std::move(mesh),
+			std::move(material),
+			std::move(blas),
+			std::move(scene_graph),
+			std::move(light_list),
+			std::move(emissive_list),
+			std::move(deform_list),
+			model.animations,
+			std::move(*impostor_list_result)
+		);
+	}
+
+	Model::BakedView Model::Baked::view() const noexcept
+	{
+		const auto as_view = [](const Texture::Baked& texture) {
+			return texture.view();
+		};
+		const auto as_tuple_view = [&as_view](const TextureList::BakedTuple& tuple) {
+			return TextureList::BakedTupleView{
+				.color = tuple.color.transform(as_view),
+				.normal = tuple.normal.transform(as_view),
+				.sample_mode = tuple.sample_mode
+			};
+		};
+
+		return {
+			.nodes = nodes,
+			.materials = materials,
+			.textures = textures | std::views::transform(as_tuple_view) | std::ranges::to<std::vector>(),
+			.mesh = mesh.view(),
+			.lights = lights,
+			.hlod_clusters = hlod_clusters,
+			.hlod_source_nodes = hlod_source_nodes,
+			.impostor = impostor.view()
+		};
+	}
+
+	std::pair<coro::task<std::expected<Model::Baked, Error>>, std::shared_ptr<const Model::Progress>>
+	Model::bake(
+		coro::thread_pool& thread_pool,
+		const model::Model& model,
+		Option option,
+		std::stop_token stop_token
+	) noexcept
+	{
+		auto progress = std::make_shared<Progress>(Progress::from<ProgressState::Preparing>());
+		auto task = bake_impl(thread_pool, progress, model, option, std::move(stop_token));
+		return {std::move(task), progress};
+	}
+
+	coro::task<std::expected<Model::Baked, Error>> Model::bake_impl(
+		coro::thread_pool& thread_pool,
+		std::shared_ptr<Progress> progress,
+		const model::Model& model,
+		Option option,
+		std::stop_token stop_token
+	) noexcept
+	{
+		/* Textures */
+
+		using MaterialProgressState = MaterialList::ProgressState;
+
+		const auto material_progress = std::make_shared<MaterialList::Progress>(
+			MaterialList::Progress::from<MaterialProgressState::Preparing>()
+		);
+		progress->set<ProgressState::Material>(material_progress);
+
+		util::Progress texture_progress;
+		material_progress->set<MaterialProgressState::TextureList>(texture_progress.get_ref());
+
+		auto textures_result = co_await TextureList::bake(
+			thread_pool,
+			std::move(texture_progress),
+			model.material_list,
+			option.texture_load_option,
+			stop_token
+		);
+		if (!textures_result) co_return textures_result.error().forward("Bake textures failed");
+
+		/* Meshes */
+
+		progress->set<ProgressState::Mesh>();
+
+		const auto processed_meshes = co_await process_meshes(thread_pool, model, option, stop_token);
+		if (stop_token.stop_requested()) co_return Error("Cancelled");
+
+		const auto meshes =
+			processed_meshes.has_value() ? std::span<const model::Mesh>(*processed_meshes) : model.meshes;
+		auto mesh = MeshList::bake(meshes, option.vertex_format, option.split_positions);
+
+		/* Hierarchy */
+
+		const auto as_parent_only = [](const model::FullNode& node) {
+			return model::ParentOnlyNode{.parent_index = node.parent_index, .data = node.data};
+		};
+		auto nodes = model.hierarchy.get_nodes()
+			| std::views::transform(as_parent_only)
+			| std::ranges::to<std::vector>();
+
+		co_return Baked{
+			.nodes = std::move(nodes),
+			.materials = model.material_list.materials,
+			.textures = std::move(*textures_result),
+			.mesh = std::move(mesh),
+			.lights = model.lights,
+			.hlod_clusters = model.hlod.clusters,
+			.hlod_source_nodes = model.hlod.source_nodes,
+			.impostor = ImpostorList::bake(model.impostors)
+		};
+	}
+
+	std::pair<coro::task<std::expected<Model, Error>>, std::shared_ptr<const Model::Progress>> Model::create(
+		coro::thread_pool& thread_pool,
+		const vulkan::Context& context,
+		const MaterialLayout& material_layout,
+		const BakedView& baked,
+		Option option,
+		std::stop_token stop_token
+	) noexcept
+	{
+		auto progress = std::make_shared<Progress>(Progress::from<ProgressState::Preparing>());
+		auto task = create_baked_impl(
+			thread_pool,
+			progress,
+			context,
+			material_layout,
+			baked,
+			option,
+			std::move(stop_token)
+		);
+		return {std::move(task), progress};
+	}
+
+	coro::task<std::expected<Model, Error>> Model::create_baked_impl(
+		coro::thread_pool& thread_pool,
+		std::shared_ptr<Progress> progress,
+		const vulkan::Context& context,
+		const MaterialLayout& material_layout,
+		const BakedView& baked,
+		Option option,
+		std::stop_token stop_token
+	) noexcept
+	{
+		co_await thread_pool.schedule();
+
+		if (baked.mesh.vertex_format != option.vertex_format)
+			co_return Error("Vertex format mismatch", "Baked vertex format differs from the requested one");
+
+		auto hierarchy_result = model::Hierarchy::create(baked.nodes);
+		if (!hierarchy_result) co_return hierarchy_result.error().forward("Create hierarchy failed");
+		auto hierarchy = std::move(*hierarchy_result);
+
+		/* Materials, textures are already baked */
+
+		progress->set<ProgressState::Material>(
+			std::make_shared<MaterialList::Progress>(
+				MaterialList::Progress::from<MaterialList::ProgressState::Processing>()
+			)
+		);
+
+		auto texture_list_result = TextureList::upload(context, baked.textures, option.texture_load_option);
+		if (!texture_list_result) co_return texture_list_result.error().forward("Upload texture list failed");
+
+		auto material_result = MaterialList::create(
+			context,
+			material_layout,
+			std::move(*texture_list_result),
+			baked.materials,
+			option.sampler_option
+		);
+		if (!material_result) co_return material_result.error().forward("Create material list failed");
+		auto material = std::move(*material_result);
+
+		/* Meshes */
+
+		progress->set<ProgressState::Mesh>();
+		auto mesh_result = MeshList::upload(context, baked.mesh, option.geometry_pool);
+		if (!mesh_result) co_return mesh_result.error().forward("Upload mesh list failed");
+		auto mesh = std::move(*mesh_result);
+
+		progress->set<ProgressState::Blas>();
+
+		// Baked models have no deformable meshes, serialized BLASes cover all meshes
+		std::expected<BlasList, Error> blas_result = Error("No serialized BLAS");
+		if (baked.blas.has_value()) blas_result = BlasList::deserialize(context, mesh, *baked.blas);
+		if (!blas_result)
+			blas_result = co_await create_blas(thread_pool, context, material, mesh, option, stop_token);
+		if (!blas_result) co_return blas_result.error().forward("Create BLAS failed");
+		auto blas = std::move(*blas_result);
+
+		auto scene_graph_result = SceneGraph::create(
+			context,
+			hierarchy,
+			mesh,
+			material,
+			option.instance_capacity,
+			baked.hlod_clusters,
+			baked.hlod_source_nodes
+		);
+		if (!scene_graph_result) co_return scene_graph_result.error().forward("Create scene graph failed");
+		auto scene_graph = std::move(*scene_graph_result);
+
+		auto light_list_result = LightList::create(context, hierarchy, baked.lights);
+		if (!light_list_result) co_return light_list_result.error().forward("Create light list failed");
+		auto light_list = std::move(*light_list_result);
+
+		auto emissive_list_result =
+			EmissiveList::create(context, hierarchy, mesh, baked.materials, scene_graph);
+		if (!emissive_list_result)
+			co_return emissive_list_result.error().forward("Create emissive list failed");
+		auto emissive_list = std::move(*emissive_list_result);
+
+		auto impostor_list_result = ImpostorList::create(context, baked.impostor, mesh);
+		if (!impostor_list_result)
+			co_return impostor_list_result.error().forward("Create impostor list failed");
+
+		co_return Model(
+			std::move(hierarchy),
+			std::move(mesh),
+			std::move(material),
+			std::move(blas),
+			std::move(scene_graph),
+			std::move(light_list),
+			std::move(emissive_list),
+			std::nullopt,
+			{},
+			std::move(*impostor_list_result)
+		);
 	}
 }
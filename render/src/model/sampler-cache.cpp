@@ -0,0 +1,44 @@
+#include "render/model/sampler-cache.hpp"
+#include "common/util/error.hpp"
+#include "model/texture.hpp"
+#include "model/vk-object.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <expected>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	std::expected<std::shared_ptr<const vk::raii::Sampler>, Error> SamplerCache::get(
+		const vulkan::Context& context,
+		const model::SampleMode& sample_mode,
+		Policy policy
+	) noexcept
+	{
+		const auto device_max_anisotropy = context.phy_device.getProperties().limits.maxSamplerAnisotropy;
+		policy.max_anisotropy = std::clamp(policy.max_anisotropy, 1.0f, device_max_anisotropy);
+
+		const auto key = Key{.sample_mode = sample_mode, .policy = policy};
+
+		const std::scoped_lock lock(mutex);
+
+		if (const auto it = samplers.find(key); it != samplers.end())
+			if (auto sampler = it->second.lock(); sampler != nullptr) return sampler;
+
+		auto sampler_result =
+			impl::to_sampler(context.device, sample_mode, policy.max_anisotropy, policy.lod_bias);
+		if (!sampler_result) return sampler_result.error().forward("Create sampler failed");
+		auto sampler = std::make_shared<const vk::raii::Sampler>(std::move(*sampler_result));
+
+		// Drop samplers released by unloaded models
+		std::erase_if(samplers, [](const auto& entry) { return entry.second.expired(); });
+		samplers.insert_or_assign(key, sampler);
+
+		return sampler;
+	}
+}
@@ -0,0 +1,338 @@
+#include "render/model/scene-graph.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "model/hierarchy.hpp"
+#include "model/material.hpp"
+#include "model/model.hpp"
+#include "render/interface/hlod-cluster.hpp"
+#include "render/interface/primitive-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/util/per-render-state.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	namespace
+	{
+		std::vector<NodeLevelRange> get_level_ranges(const model::Hierarchy& hierarchy) noexcept
+		{
+			const auto nodes = hierarchy.get_nodes();
+			const auto bfs_order = hierarchy.get_bfs_order();
+
+			std::vector<uint32_t> depths(nodes.size(), 0);
+			std::vector<NodeLevelRange> level_ranges;
+
+			for (const auto [bfs_idx, node_idx] : bfs_order | std::views::enumerate)
+			{
+				const auto& parent_index = nodes[node_idx].parent_index;
+				const auto depth = parent_index.has_value() ? depths[*parent_index] + 1 : 0;
+				depths[node_idx] = depth;
+
+				// BFS order guarantees depths are non-decreasing
+				if (depth == level_ranges.size())
+					level_ranges.push_back({.offset = static_cast<uint32_t>(bfs_idx), .count = 0});
+				level_ranges.back().count++;
+			}
+
+			return level_ranges;
+		}
+
+		struct Drawcalls
+		{
+			PerRenderState<std::vector<PrimitiveDrawcall>> main, blended;
+		};
+
+		Drawcalls get_drawcalls(
+			const model::Hierarchy& hierarchy,
+			const MeshList& mesh_list,
+			const MaterialList& material_list,
+			uint32_t reserved_count
+		) noexcept
+		{
+			Drawcalls drawcalls;
+
+			for (const auto [node, mesh] : hierarchy.get_renderables())
+			{
+				const auto primitive_range = mesh_list->mesh_ranges_array[mesh];
+
+				for (
+					const auto primitive_idx :
+					std::views::iota(primitive_range.offset, primitive_range.offset + primitive_range.count)
+				)
+				{
+					const auto primitive_attr = mesh_list->primitive_attr_array[primitive_idx];
+					const auto material_mode =
+						material_list.query_material_mode(primitive_attr.material_index);
+
+					// `PerRenderState` maps blend to the masked render states of the blended bucket
+					const bool blended = material_mode.alpha_mode == model::AlphaMode::Blend;
+					auto& bucket = blended ? drawcalls.blended : drawcalls.main;
+					bucket[material_mode].emplace_back(
+						PrimitiveDrawcall{.node_index = node, .primitive_index = primitive_idx}
+					);
+				}
+			}
+
+			// Reserved instance slots are hidden until `InstanceList` fills them
+			constexpr auto hidden_drawcall =
+				PrimitiveDrawcall{.node_index = 0, .primitive_index = PrimitiveDrawcall::HIDDEN};
+			for (auto& bucket_drawcalls : drawcalls.main.all())
+				bucket_drawcalls.insert(bucket_drawcalls.end(), reserved_count, hidden_drawcall);
+			for (auto& bucket_drawcalls : drawcalls.blended.all())
+				bucket_drawcalls.insert(bucket_drawcalls.end(), reserved_count, hidden_drawcall);
+
+			return drawcalls;
+		}
+
+		std::expected<vulkan::ArrayBuffer<PrimitiveDrawcall>, Error> create_drawcall_buffer(
+			const vulkan::Context& context,
+			vulkan::StaticResourceCreator& resource_creator,
+			std::span<const PrimitiveDrawcall> drawcalls
+		) noexcept
+		{
+			if (!drawcalls.empty())
+				return resource_creator.create_array_buffer(
+					context,
+					drawcalls,
+					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst
+				);
+
+			// Zero-sized buffers are not allowed, pad with a dummy drawcall while keeping the count 0
+			constexpr auto dummy_drawcall = PrimitiveDrawcall{.node_index = 0, .primitive_index = 0};
+			return resource_creator
+				.create_buffer(
+					context,
+					util::object_as_bytes(dummy_drawcall),
+					vk::BufferUsageFlagBits::eStorageBuffer
+				)
+				.transform([](vulkan::Buffer buffer) {
+					return vulkan::ArrayBuffer<PrimitiveDrawcall>(std::move(buffer), 0);
+				});
+		}
+
+		struct Hlod
+		{
+			std::vector<HlodCluster> clusters;
+			std::vector<uint32_t> node_entries;  // HLOD entry of each node, see `NO_HLOD`
+			std::vector<uint32_t> proxy_nodes;   // Sorted
+		};
+
+		std::expected<Hlod, Error> get_hlod(
+			std::span<const model::HlodCluster> clusters,
+			std::span<const uint32_t> source_nodes,
+			uint32_t node_count
+		) noexcept
+		{
+			Hlod hlod{.clusters = {}, .node_entries = std::vector(node_count, NO_HLOD), .proxy_nodes = {}};
+
+			for (const auto [cluster_index, cluster] : clusters | std::views::enumerate)
+			{
+				if (cluster.proxy_node_index >= node_count
+					|| uint64_t(cluster.source_offset) + cluster.source_count > source_nodes.size())
+					return Error("HLOD cluster out of bounds", std::format("Cluster #{}", cluster_index));
+
+				const auto entry = static_cast<uint32_t>(cluster_index);
+				hlod.node_entries[cluster.proxy_node_index] = entry | HLOD_PROXY_BIT;
+				for (const auto node : source_nodes.subspan(cluster.source_offset, cluster.source_count))
+				{
+					if (node >= node_count)
+						return Error("HLOD source out of bounds", std::format("Cluster #{}", cluster_index));
+					hlod.node_entries[node] = entry;
+				}
+
+				hlod.clusters.push_back(
+					HlodCluster{
+						.aabb_min = cluster.aabb_min,
+						.proxy_node_index = cluster.proxy_node_index,
+						.aabb_max = cluster.aabb_max,
+					}
+				);
+				hlod.proxy_nodes.push_back(cluster.proxy_node_index);
+			}
+
+			std::ranges::sort(hlod.proxy_nodes);
+
+			return hlod;
+		}
+	}
+
+	std::expected<SceneGraph, Error> SceneGraph::create(
+		const vulkan::Context& context,
+		const model::Hierarchy& hierarchy,
+		const MeshList& mesh_list,
+		const MaterialList& material_list,
+		InstanceCapacity instance_capacity,
+		std::span<const model::HlodCluster> hlod_clusters,
+		std::span<const uint32_t> hlod_source_nodes
+	) noexcept
+	{
+		/* Flatten hierarchy */
+
+		const auto nodes = hierarchy.get_nodes();
+		auto bfs_order = std::vector(std::from_range, hierarchy.get_bfs_order());
+
+		auto parents =
+			nodes
+			| std::views::transform([](const model::FullNode& node) {
+				  return node.parent_index.value_or(NO_PARENT);
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto local_transforms =
+			nodes
+			| std::views::transform([](const model::FullNode& node) {
+				  return node.data.transform.to_matrix();
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto level_ranges = get_level_ranges(hierarchy);
+		const auto drawcalls =
+			get_drawcalls(hierarchy, mesh_list, material_list, instance_capacity.drawcall_count);
+
+		// Reserved instance nodes are roots, propagated after the hierarchy as a level of their own
+		if (instance_capacity.node_count > 0)
+		{
+			level_ranges.push_back(
+				{.offset = static_cast<uint32_t>(bfs_order.size()), .count = instance_capacity.node_count}
+			);
+			bfs_order.append_range(
+				std::views::iota(0u, instance_capacity.node_count)
+				| std::views::transform([offset = static_cast<uint32_t>(nodes.size())](uint32_t idx) {
+					  return offset + idx;
+				  })
+			);
+			parents.insert(parents.end(), instance_capacity.node_count, NO_PARENT);
+			local_transforms.insert(local_transforms.end(), instance_capacity.node_count, glm::mat4(1.0f));
+		}
+
+		auto hlod_result =
+			get_hlod(hlod_clusters, hlod_source_nodes, static_cast<uint32_t>(hierarchy.get_nodes().size()));
+		if (!hlod_result) return hlod_result.error().forward("Invalid HLOD clusters");
+		auto& hlod = *hlod_result;
+
+		// Reserved instance nodes are never in a cluster
+		hlod.node_entries.insert(hlod.node_entries.end(), instance_capacity.node_count, NO_HLOD);
+
+		// Zero-sized buffers are not allowed, pad with a dummy cluster never referenced by a node
+		if (hlod.clusters.empty()) hlod.clusters.push_back({});
+
+		/* Upload */
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+		auto resource_creator = std::move(*resource_creator_result);
+
+		auto bfs_order_buffer_result =
+			resource_creator.create_array_buffer(context, bfs_order, vk::BufferUsageFlagBits::eStorageBuffer);
+		if (!bfs_order_buffer_result)
+			return bfs_order_buffer_result.error().forward("Create BFS order buffer failed");
+
+		auto parent_buffer_result =
+			resource_creator.create_array_buffer(context, parents, vk::BufferUsageFlagBits::eStorageBuffer);
+		if (!parent_buffer_result) return parent_buffer_result.error().forward("Create parent buffer failed");
+
+		auto local_transform_buffer_result = resource_creator.create_array_buffer(
+			context,
+			local_transforms,
+			vk::BufferUsageFlagBits::eStorageBuffer
+		);
+		if (!local_transform_buffer_result)
+			return local_transform_buffer_result.error().forward("Create local transform buffer failed");
+
+		auto drawcall_buffers_result = PerRenderState<vulkan::ArrayBuffer<PrimitiveDrawcall>>::from_ctor(
+			[&](model::AlphaMode alpha_mode, bool double_sided) {
+				return create_drawcall_buffer(
+					context,
+					resource_creator,
+					drawcalls.main[alpha_mode, double_sided]
+				);
+			}
+		);
+		if (!drawcall_buffers_result)
+			return drawcall_buffers_result.error().forward("Create drawcall buffers failed");
+
+		auto blended_drawcall_buffers_result =
+			PerRenderState<vulkan::ArrayBuffer<PrimitiveDrawcall>>::from_ctor(
+				[&](model::AlphaMode alpha_mode, bool double_sided) {
+					return create_drawcall_buffer(
+						context,
+						resource_creator,
+						drawcalls.blended[alpha_mode, double_sided]
+					);
+				}
+			);
+		if (!blended_drawcall_buffers_result)
+			return blended_drawcall_buffers_result.error().forward("Create blended drawcall buffers failed");
+
+		auto hlod_cluster_buffer_result = resource_creator.create_array_buffer(
+			context,
+			hlod.clusters,
+			vk::BufferUsageFlagBits::eStorageBuffer
+		);
+		if (!hlod_cluster_buffer_result)
+			return hlod_cluster_buffer_result.error().forward("Create HLOD cluster buffer failed");
+
+		auto node_hlod_buffer_result = resource_creator.create_array_buffer(
+			context,
+			hlod.node_entries,
+			vk::BufferUsageFlagBits::eStorageBuffer
+		);
+		if (!node_hlod_buffer_result)
+			return node_hlod_buffer_result.error().forward("Create node HLOD buffer failed");
+
+		if (const auto result = resource_creator.execute_uploads(context); !result)
+			return result.error().forward("Execute upload tasks failed");
+
+		return SceneGraph(
+			std::move(*bfs_order_buffer_result),
+			std::move(*parent_buffer_result),
+			std::move(*local_transform_buffer_result),
+			std::move(*drawcall_buffers_result),
+			std::move(*blended_drawcall_buffers_result),
+			std::move(*hlod_cluster_buffer_result),
+			std::move(*node_hlod_buffer_result),
+			std::move(level_ranges),
+			std::move(hlod.proxy_nodes),
+			instance_capacity
+		);
+	}
+
+	SceneGraph::Ref SceneGraph::get() const noexcept
+	{
+		return Ref{
+			.bfs_order_buffer = bfs_order_buffer,
+			.parent_buffer = parent_buffer,
+			.local_transform_buffer = local_transform_buffer,
+			.drawcall_buffers = drawcall_buffers.map([](const auto& buffer) {
+				return vulkan::ArrayBufferRef<PrimitiveDrawcall>(buffer);
+			}),
+			.blended_drawcall_buffers = blended_drawcall_buffers.map([](const auto& buffer) {
+				return vulkan::ArrayBufferRef<PrimitiveDrawcall>(buffer);
+			}),
+			.hlod_cluster_buffer = hlod_cluster_buffer,
+			.node_hlod_buffer = node_hlod_buffer,
+			.level_ranges = level_ranges,
+			.node_count = parent_buffer.count(),
+		};
+	}
+
+	bool SceneGraph::is_hlod_proxy(uint32_t node_index) const noexcept
+	{
+		return std::ranges::binary_search(hlod_proxy_nodes, node_index);
+	}
+}
@@ -2,24 +2,36 @@
 #include "common/number-literals.hpp"
 #include "common/util/async.hpp"
 #include "common/util/error.hpp"
+#include "common/util/trace.hpp"
 #include "image/common.hpp"
 #include "image/image.hpp"
 #include "model/material.hpp"
 #include "model/texture.hpp"
+#include "render/model/bcn-encoder.hpp"
 #include "render/model/texture.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/util/static-resource-creator.hpp"
 
+#include <algorithm>
+#include <array>
 #include <coro/task.hpp>
 #include <coro/thread_pool.hpp>
 #include <coro/when_all.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
+#include <format>
+#include <functional>
+#include <glm/ext/vector_uint2_sized.hpp>
 #include <glm/ext/vector_uint4_sized.hpp>
+#include <map>
 #include <optional>
 #include <ranges>
+#include <span>
+#include <stop_token>
 #include <tuple>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace render
@@ -47,11 +59,13 @@ namespace render
 		TextureList::LoadOption load_option
 	) noexcept
 	{
+		const auto support = Texture::CompressionSupport::query(context.phy_device);
+
 		auto color_fallback_result = Texture::load_color_texture(
 			context,
 			resource_creator,
 			model::Texture{.source = model::TextureSet::get_general_fallback_texture()},
-			Texture::ColorLoadStrategy::AllBC7,
+			support.fit(Texture::ColorLoadStrategy::AllBC7),
 			load_option.usage
 		);
 		if (!color_fallback_result)
@@ -62,7 +76,7 @@ namespace render
 			context,
 			resource_creator,
 			model::Texture{.source = model::TextureSet::get_normal_map_fallback_texture()},
-			Texture::NormalLoadStrategy::AllBC5,
+			support.fit(Texture::NormalLoadStrategy::AllBC5),
 			load_option.usage
 		);
 		if (!normal_fallback_result)
@@ -87,9 +101,100 @@ namespace render
 		);
 	}
 
-	coro::task<std::expected<TextureList::TextureTuple, Error>> TextureList::create_texture_tuple(
+	namespace
+	{
+		// Identity of a texture's decoded content
+		struct ContentKey
+		{
+			uint64_t source_hash;
+			bool flip_x;
+			bool flip_y;
+
+			[[nodiscard]]
+			auto operator<=>(const ContentKey&) const noexcept = default;
+		};
+
+		// Layout of a baked texture, textures of the same layout can be packed into one array image
+		struct PackKey
+		{
+			Texture::Format format;
+			std::vector<std::pair<uint32_t, uint32_t>> level_extents;
+
+			[[nodiscard]]
+			auto operator<=>(const PackKey&) const noexcept = default;
+		};
+
+		// Location of a baked texture in the input of `TextureList::upload`
+		struct BakedSlot
+		{
+			size_t index;
+			bool normal;
+		};
+	}
+
+	static coro::task<std::optional<ContentKey>> hash_texture(
+		coro::thread_pool& thread_pool,
+		const model::Texture& texture
+	) noexcept
+	{
+		co_await thread_pool.schedule();
+
+		const auto hash_result = texture.hash_source();
+		if (!hash_result) co_return std::nullopt;
+
+		co_return ContentKey{.source_hash = *hash_result, .flip_x = texture.flip_x, .flip_y = texture.flip_y};
+	}
+
+	coro::task<TextureList::TextureGroups> TextureList::group_textures(
+		coro::thread_pool& thread_pool,
+		const model::MaterialList& material_list
+	) noexcept
+	{
+		auto tasks = material_list.textures
+			| std::views::transform([&thread_pool](const auto& texture_info) {
+				  return hash_texture(thread_pool, texture_info.first);
+			  })
+			| std::ranges::to<std::vector>();
+
+		const auto keys = co_await coro::when_all(std::move(tasks))
+			| std::views::transform([](auto&& result) { return std::move(result.return_value()); })
+			| std::ranges::to<std::vector>();
+
+		TextureGroups groups;
+		groups.unique_indices.reserve(keys.size());
+		std::map<ContentKey, uint32_t> key_indices;
+
+		for (const auto& [key, texture_info] : std::views::zip(keys, material_list.textures))
+		{
+			const auto& [texture, usage] = texture_info;
+			const auto new_index = static_cast<uint32_t>(groups.unique_textures.size());
+
+			const auto [iter, inserted] = key.has_value()
+				? key_indices.try_emplace(*key, new_index)
+				: std::make_pair(key_indices.end(), true);
+
+			if (inserted)
+			{
+				groups.unique_indices.push_back(new_index);
+				groups.unique_textures.emplace_back(&texture, usage);
+				continue;
+			}
+
+			groups.unique_indices.push_back(iter->second);
+
+			auto& merged_usage = groups.unique_textures[iter->second].second;
+			merged_usage.srgb |= usage.srgb;
+			merged_usage.linear |= usage.linear;
+			merged_usage.normal |= usage.normal;
+		}
+
+		co_return groups;
+	}
+
+	coro::task<std::expected<TextureList::LoadedTuple, Error>> TextureList::create_texture_tuple(
 		coro::thread_pool& thread_pool,
 		const util::Progress& progress,
+		std::stop_token stop_token,
 		const vulkan::Context& context,
 		vulkan::StaticResourceCreator& resource_creator,
 		const model::Texture& texture,
@@ -99,18 +204,64 @@ namespace render
 	{
 		co_await thread_pool.schedule();
 
-		std::optional<Texture> color_texture;
-		std::optional<Texture> normal_texture;
+		if (stop_token.stop_requested()) co_return Error("Cancelled");
 
-		if (texture_usage.linear || texture_usage.srgb)
-		{
-			auto color_texture_result = Texture::load_color_texture(
+		const auto trace = util::trace::Scope("Load texture");
+
+		// With GPU encoding, BC textures left unencoded are uploaded uncompressed, and encoded later by
+		// `BcnEncoder`. Otherwise, and always for ETC2/EAC, they are encoded on the CPU directly into staging
+		// memory
+		const auto upload_prepared = [&context, &resource_creator, &load_option](
+										 const Texture::Prepared& prepared
+									 ) -> std::expected<LoadedTexture, Error> {
+			if (std::holds_alternative<Texture::Baked>(prepared)
+				|| !load_option.gpu_encode
+				|| !BcnEncoder::supports(std::get<Texture::Unencoded>(prepared).format))
+				return Texture::upload_prepared(
+					context,
+					resource_creator,
+					prepared,
+					load_option.usage,
+					load_option.bc7_quality
+				);
+
+			// Only the base level is uploaded, the mipmap chain is generated on device
+			const auto& unencoded = std::get<Texture::Unencoded>(prepared);
+			const auto base_size = unencoded.image.size;
+			const auto mipmap_levels = vulkan::StaticResourceCreator::get_mipmap_levels(
+				base_size,
+				Texture::Unencoded::MIN_SIZE_LOG
+			);
+
+			auto image_result = resource_creator.create_image(
 				context,
-				resource_creator,
-				texture,
-				load_option.color_load_strategy,
-				load_option.usage
+				unencoded.image,
+				vk::Format::eR8G8B8A8Unorm,
+				vk::ImageUsageFlagBits::eSampled,
+				vk::ImageLayout::eShaderReadOnlyOptimal,
+				{},
+				mipmap_levels
 			);
+			if (!image_result) return image_result.error().forward("Create uncompressed image failed");
+
+			return BcnEncoder::Source{
+				.image = std::move(*image_result),
+				.level_extents = std::views::iota(0_u32, mipmap_levels)
+					| std::views::transform([base_size](uint32_t level) { return base_size >> level; })
+					| std::ranges::to<std::vector>(),
+				.format = unencoded.format,
+				.min_alpha = unencoded.min_alpha
+			};
+		};
+
+		std::optional<LoadedTexture> color_texture;
+		std::optional<LoadedTexture> normal_texture;
+
+		if (texture_usage.linear || texture_usage.srgb)
+		{
+			auto color_texture_result =
+				Texture::prepare_color_texture(texture, load_option.color_load_strategy, load_option.max_size)
+					.and_then(upload_prepared);
 
 			if (!color_texture_result)
 			{
@@ -125,13 +276,10 @@ namespace render
 
 		if (texture_usage.normal)
 		{
-			auto normal_texture_result = Texture::load_normal_texture(
-				context,
-				resource_creator,
-				texture,
-				load_option.normal_load_strategy,
-				load_option.usage
-			);
+			const auto normal_strategy = load_option.normal_load_strategy;
+			auto normal_texture_result =
+				Texture::prepare_normal_texture(texture, normal_strategy, load_option.max_size)
+					.and_then(upload_prepared);
 
 			if (!normal_texture_result)
 			{
@@ -151,11 +299,92 @@ namespace render
 
 		progress.increment();
 
-		co_return TextureTuple{
-			.color = std::move(color_texture),
-			.normal = std::move(normal_texture),
-			.sample_mode = texture.sample_mode
+		co_return LoadedTuple{.color = std::move(color_texture), .normal = std::move(normal_texture)};
+	}
+
+	std::expected<std::vector<TextureList::TextureTuple>, Error> TextureList::finish_texture_tuples(
+		const vulkan::Context& context,
+		std::vector<LoadedTuple> loaded_tuples,
+		LoadOption load_option
+	) noexcept
+	{
+		// Location of a pending texture in the output tuples
+		struct Target
+		{
+			size_t index;
+			bool normal;
 		};
+
+		std::vector<BcnEncoder::Source> sources;
+		std::vector<Target> targets;
+
+		const auto take_ready = [&sources, &targets](
+									std::optional<LoadedTexture>& loaded,
+									Target target
+								) -> std::optional<Texture> {
+			if (!loaded.has_value()) return std::nullopt;
+			if (auto* texture = std::get_if<Texture>(&*loaded)) return std::move(*texture);
+
+			sources.push_back(std::move(std::get<BcnEncoder::Source>(*loaded)));
+			targets.push_back(target);
+			return std::nullopt;
+		};
+
+		std::vector<TextureTuple> texture_tuples;
+		texture_tuples.reserve(loaded_tuples.size());
+
+		for (auto&& [idx, loaded] : loaded_tuples | std::views::enumerate)
+		{
+			auto color = take_ready(loaded.color, {.index = static_cast<size_t>(idx), .normal = false});
+			auto normal = take_ready(loaded.normal, {.index = static_cast<size_t>(idx), .normal = true});
+
+			texture_tuples.push_back(TextureTuple{.color = std::move(color), .normal = std::move(normal)});
+		}
+
+		if (sources.empty()) return texture_tuples;
+
+		auto encoder_result = BcnEncoder::create(context);
+		if (!encoder_result) return encoder_result.error().forward("Create GPU BCn encoder failed");
+		auto encoder = std::move(*encoder_result);
+
+		const auto get_source_size = [](const BcnEncoder::Source& source) {
+			const auto get_level_size = [](glm::u32vec2 extent) {
+				return size_t(extent.x) * extent.y * 4;
+			};
+			return std::ranges::fold_left(
+				source.level_extents | std::views::transform(get_level_size),
+				0zu,
+				std::plus()
+			);
+		};
+
+		// Uncompressed images of each batch are released once encoded
+		for (size_t begin = 0; begin < sources.size();)
+		{
+			size_t end = begin;
+			for (size_t batch_size = 0;
+				 end < sources.size() && (end == begin || batch_size < load_option.max_pending_data_size);
+				 end++)
+				batch_size += get_source_size(sources[end]);
+
+			const auto batch = std::ranges::subrange(sources.begin() + begin, sources.begin() + end)
+				| std::views::as_rvalue
+				| std::ranges::to<std::vector>();
+
+			auto encode_result = encoder.encode(context, batch, load_option.usage);
+			if (!encode_result) return encode_result.error().forward("Encode textures on GPU failed");
+
+			for (auto&& [target, texture] :
+				 std::views::zip(std::span(targets).subspan(begin, end - begin), *encode_result))
+			{
+				auto& tuple = texture_tuples[target.index];
+				(target.normal ? tuple.normal : tuple.color) = std::move(texture);
+			}
+
+			begin = end;
+		}
+
+		return texture_tuples;
 	}
 
 	coro::task<std::expected<TextureList, Error>> TextureList::create(
@@ -163,10 +392,17 @@ namespace render
 		util::Progress progress,
 		const vulkan::Context& context,
 		const model::MaterialList& material_list,
-		LoadOption load_option
+		LoadOption load_option,
+		std::stop_token stop_token
 	) noexcept
 	{
-		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		const auto support = Texture::CompressionSupport::query(context.phy_device);
+		load_option.color_load_strategy = support.fit(load_option.color_load_strategy);
+		load_option.normal_load_strategy = support.fit(load_option.normal_load_strategy);
+
+		// Textures are created by all workers of the pool at once, let each allocate from its own pool
+		auto resource_creator_result =
+			vulkan::StaticResourceCreator::create(context, vulkan::AllocationPool::PerThread);
 		if (!resource_creator_result)
 			co_return resource_creator_result.error().forward("Create resource creator failed");
 		auto resource_creator = std::move(*resource_creator_result);
@@ -177,38 +413,329 @@ namespace render
 		if (!fallback_result) co_return fallback_result.error().forward("Load fallback textures failed");
 		auto [color_fallback, normal_fallback, error_hint_texture] = std::move(*fallback_result);
 
-		/* Load material textures */
+		/* Load material textures, once per unique content */
+
+		const auto groups = co_await group_textures(thread_pool, material_list);
 
 		const auto task_func =
-			[&progress, &thread_pool, &resource_creator, &load_option, &context](const auto& texture_info) {
+			[&progress, &thread_pool, &stop_token, &resource_creator, &load_option, &context](
+				const auto& texture_info
+			) {
 				return create_texture_tuple(
 					thread_pool,
 					progress,
+					stop_token,
 					context,
 					resource_creator,
-					texture_info.first,
+					*texture_info.first,
 					texture_info.second,
 					load_option
 				);
 			};
 
-		progress.set_total(material_list.textures.size());
+		progress.set_total(groups.unique_textures.size());
 		auto tasks =
-			material_list.textures | std::views::transform(task_func) | std::ranges::to<std::vector>();
+			groups.unique_textures | std::views::transform(task_func) | std::ranges::to<std::vector>();
 
 		auto texture_results = co_await coro::when_all(std::move(tasks))
 			| std::views::transform([](auto&& result) { return std::move(result.return_value()); })
 			| Error::collect();
 		if (!texture_results) co_return texture_results.error().forward("Load textures failed");
-		auto textures = std::move(*texture_results);
+
+		// GPU encoding is the last expensive step, skip it if stopped in the meantime
+		if (stop_token.stop_requested()) co_return Error("Cancelled");
 
 		/* Last upload */
 
 		if (const auto upload_result = resource_creator.execute_uploads(context); !upload_result)
 			co_return upload_result.error().forward("Execute upload tasks failed");
 
+		/* Encode pending textures */
+
+		auto finish_result = finish_texture_tuples(context, std::move(*texture_results), load_option);
+		if (!finish_result) co_return finish_result.error().forward("Finish textures failed");
+
+		std::vector<vulkan::Image> images;
+		const auto take_image = [&images](std::optional<Texture>& texture) -> std::optional<Texture::Ref> {
+			if (!texture.has_value()) return std::nullopt;
+			const auto ref = texture->ref();
+			images.push_back(std::move(texture->image));
+			return ref;
+		};
+
+		auto textures = *finish_result
+			| std::views::transform([&take_image](TextureTuple& tuple) {
+				  return TextureRefTuple{
+					  .color = take_image(tuple.color),
+					  .normal = take_image(tuple.normal)
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto entries = std::views::zip(material_list.textures, groups.unique_indices)
+			| std::views::transform([](const auto& pair) {
+				  const auto& [texture_info, unique_index] = pair;
+				  return TextureEntry{
+					  .tuple_index = unique_index,
+					  .sample_mode = texture_info.first.sample_mode
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+
 		co_return TextureList(
+			std::move(images),
 			std::move(textures),
+			std::move(entries),
+			std::move(color_fallback),
+			std::move(normal_fallback),
+			std::move(error_hint_texture)
+		);
+	}
+
+	coro::task<std::expected<TextureList::BakedTuple, Error>> TextureList::bake_texture_tuple(
+		coro::thread_pool& thread_pool,
+		const util::Progress& progress,
+		std::stop_token stop_token,
+		const model::Texture& texture,
+		model::TextureUsage texture_usage,
+		LoadOption load_option
+	) noexcept
+	{
+		co_await thread_pool.schedule();
+
+		if (stop_token.stop_requested()) co_return Error("Cancelled");
+
+		const auto trace = util::trace::Scope("Bake texture");
+
+		std::optional<Texture::Baked> color_texture;
+		std::optional<Texture::Baked> normal_texture;
+
+		if (texture_usage.linear || texture_usage.srgb)
+		{
+			auto color_texture_result = Texture::bake_color_texture(
+				texture,
+				load_option.color_load_strategy,
+				load_option.max_size,
+				load_option.bc7_quality
+			);
+
+			if (!color_texture_result)
+			{
+				if (load_option.exit_on_failed_load)
+					co_return color_texture_result.error().forward("Bake color texture failed");
+			}
+			else
+			{
+				color_texture = std::move(*color_texture_result);
+			}
+		}
+
+		if (texture_usage.normal)
+		{
+			auto normal_texture_result =
+				Texture::bake_normal_texture(texture, load_option.normal_load_strategy, load_option.max_size);
+
+			if (!normal_texture_result)
+			{
+				if (load_option.exit_on_failed_load)
+					co_return normal_texture_result.error().forward("Bake normal texture failed");
+			}
+			else
+			{
+				normal_texture = std::move(*normal_texture_result);
+			}
+		}
+
+		progress.increment();
+
+		co_return BakedTuple{
+			.color = std::move(color_texture),
+			.normal = std::move(normal_texture),
+			.sample_mode = texture.sample_mode
+		};
+	}
+
+	coro::task<std::expected<std::vector<TextureList::BakedTuple>, Error>> TextureList::bake(
+		coro::thread_pool& thread_pool,
+		util::Progress progress,
+		const model::MaterialList& material_list,
+		LoadOption load_option,
+		std::stop_token stop_token
+	) noexcept
+	{
+		const auto groups = co_await group_textures(thread_pool, material_list);
+
+		const auto task_func =
+			[&progress, &thread_pool, &stop_token, &load_option](const auto& texture_info) {
+				return bake_texture_tuple(
+					thread_pool,
+					progress,
+					stop_token,
+					*texture_info.first,
+					texture_info.second,
+					load_option
+				);
+			};
+
+		progress.set_total(groups.unique_textures.size());
+		auto tasks =
+			groups.unique_textures | std::views::transform(task_func) | std::ranges::to<std::vector>();
+
+		auto texture_results = co_await coro::when_all(std::move(tasks))
+			| std::views::transform([](auto&& result) { return std::move(result.return_value()); })
+			| Error::collect();
+		if (!texture_results) co_return texture_results.error().forward("Bake textures failed");
+
+		// Baked textures are copied to duplicates, as the output is one-to-one to the material list
+		co_return std::views::zip(material_list.textures, groups.unique_indices)
+			| std::views::transform([&texture_results](const auto& pair) {
+				  const auto& [texture_info, unique_index] = pair;
+				  auto tuple = (*texture_results)[unique_index];
+				  tuple.sample_mode = texture_info.first.sample_mode;
+				  return tuple;
+			  })
+			| std::ranges::to<std::vector>();
+	}
+
+	std::expected<TextureList, Error> TextureList::upload(
+		const vulkan::Context& context,
+		std::span<const BakedTupleView> textures,
+		LoadOption load_option
+	) noexcept
+	{
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+		auto resource_creator = std::move(*resource_creator_result);
+
+		auto fallback_result = load_fallback_textures(context, resource_creator, load_option);
+		if (!fallback_result) return fallback_result.error().forward("Load fallback textures failed");
+		auto [color_fallback, normal_fallback, error_hint_texture] = std::move(*fallback_result);
+
+		std::vector<vulkan::Image> images;
+		auto texture_tuples = std::vector<TextureRefTuple>(textures.size());
+
+		const auto get_baked = [&textures](BakedSlot slot) -> const std::optional<Texture::BakedView>& {
+			return slot.normal ? textures[slot.index].normal : textures[slot.index].color;
+		};
+		const auto get_stored = [&texture_tuples](BakedSlot slot) -> std::optional<Texture::Ref>& {
+			return slot.normal ? texture_tuples[slot.index].normal : texture_tuples[slot.index].color;
+		};
+
+		/* Pack small textures of the same layout into array images */
+
+		std::map<PackKey, std::vector<BakedSlot>> pack_groups;
+
+		for (const auto [idx, normal] :
+			 std::views::cartesian_product(std::views::iota(0zu, textures.size()), std::array{false, true}))
+		{
+			const auto& baked = get_baked({.index = idx, .normal = normal});
+			if (load_option.pack_max_size == 0 || !baked.has_value() || baked->levels.empty()) continue;
+
+			const auto base_extent = baked->levels.front().extent;
+			if (base_extent.x > load_option.pack_max_size || base_extent.y > load_option.pack_max_size)
+				continue;
+
+			auto key = PackKey{
+				.format = baked->format,
+				.level_extents = baked->levels
+					| std::views::transform([](const Texture::BakedLevel& level) {
+						  return std::make_pair(level.extent.x, level.extent.y);
+					  })
+					| std::ranges::to<std::vector>()
+			};
+			pack_groups[std::move(key)].push_back({.index = idx, .normal = normal});
+		}
+
+		for (const auto& [key, slots] : pack_groups)
+		{
+			// A single texture gains nothing from packing, leave it to the regular upload
+			if (slots.size() < 2) continue;
+
+			for (const auto chunk : slots | std::views::chunk(PACK_MAX_LAYERS))
+			{
+				const auto layers =
+					chunk
+					| std::views::transform([&get_baked](BakedSlot slot) { return *get_baked(slot); })
+					| std::ranges::to<std::vector>();
+
+				auto image_result =
+					Texture::upload_array(context, resource_creator, layers, load_option.usage);
+				if (!image_result)
+					return image_result.error().forward(
+						"Upload packed textures failed",
+						std::format("Texture count: {}", layers.size())
+					);
+				auto image = std::move(*image_result);
+
+				for (const auto [layer, slot] : chunk | std::views::enumerate)
+				{
+					const auto& baked = *get_baked(slot);
+					get_stored(slot) = Texture::Ref{
+						.image = image,
+						.format = baked.format,
+						.mipmap_levels = static_cast<uint32_t>(baked.levels.size()),
+						.min_alpha = baked.min_alpha,
+						.array_layer = static_cast<uint32_t>(layer)
+					};
+				}
+				images.push_back(std::move(image));
+
+				const auto upload_result = resource_creator.execute_uploads_with_size_thres(
+					context,
+					load_option.max_pending_data_size
+				);
+				if (!upload_result) return upload_result.error().forward("Execute upload tasks failed");
+			}
+		}
+
+		/* Upload remaining textures into their own images */
+
+		const auto upload_single = [&context, &resource_creator, &load_option, &images, &get_baked,
+									&get_stored](BakedSlot slot) -> std::expected<void, Error> {
+			const auto& baked = get_baked(slot);
+			auto& stored = get_stored(slot);
+			if (!baked.has_value() || stored.has_value()) return {};
+
+			auto texture_result = Texture::upload(context, resource_creator, *baked, load_option.usage);
+			if (!texture_result) return texture_result.error();
+
+			stored = texture_result->ref();
+			images.push_back(std::move(texture_result->image));
+			return {};
+		};
+
+		std::vector<TextureEntry> entries;
+		entries.reserve(textures.size());
+
+		for (const auto& [idx, baked] : textures | std::views::enumerate)
+		{
+			const auto index = static_cast<size_t>(idx);
+
+			if (const auto color_result = upload_single({.index = index, .normal = false}); !color_result)
+				return color_result.error()
+					.forward("Upload color texture failed", std::format("Index: {}", idx));
+
+			if (const auto normal_result = upload_single({.index = index, .normal = true}); !normal_result)
+				return normal_result.error()
+					.forward("Upload normal texture failed", std::format("Index: {}", idx));
+
+			entries.push_back(
+				TextureEntry{.tuple_index = static_cast<uint32_t>(idx), .sample_mode = baked.sample_mode}
+			);
+
+			const auto upload_result =
+				resource_creator.execute_uploads_with_size_thres(context, load_option.max_pending_data_size);
+			if (!upload_result) return upload_result.error().forward("Execute upload tasks failed");
+		}
+
+		if (const auto upload_result = resource_creator.execute_uploads(context); !upload_result)
+			return upload_result.error().forward("Execute upload tasks failed");
+
+		return TextureList(
+			std::move(images),
+			std::move(texture_tuples),
+			std::move(entries),
 			std::move(color_fallback),
 			std::move(normal_fallback),
 			std::move(error_hint_texture)
@@ -220,13 +747,14 @@ namespace render
 		if (!index.has_value())
 			return {.texture = color_fallback->ref(), .sample_mode = FALLBACK_SAMPLE_MODE};
 
-		if (*index >= textures->size())
+		if (*index >= entries.size())
 			return {.texture = error_hint_texture->ref(), .sample_mode = ERROR_HINT_SAMPLE_MODE};
 
-		if (const auto& texture_tuple = textures->at(*index); !texture_tuple.color.has_value())
+		const auto& entry = entries[*index];
+		if (const auto& texture_tuple = textures.at(entry.tuple_index); !texture_tuple.color.has_value())
 			return {.texture = error_hint_texture->ref(), .sample_mode = ERROR_HINT_SAMPLE_MODE};
 		else
-			return {.texture = texture_tuple.color->ref(), .sample_mode = texture_tuple.sample_mode};
+			return {.texture = *texture_tuple.color, .sample_mode = entry.sample_mode, .index = index};
 	}
 
 	TextureList::TextureResult TextureList::get_normal_texture(std::optional<uint32_t> index) const noexcept
@@ -234,12 +762,13 @@ namespace render
 		if (!index.has_value())
 			return {.texture = normal_fallback->ref(), .sample_mode = FALLBACK_SAMPLE_MODE};
 
-		if (*index >= textures->size())
+		if (*index >= entries.size())
 			return {.texture = error_hint_texture->ref(), .sample_mode = ERROR_HINT_SAMPLE_MODE};
 
-		if (const auto& texture_tuple = textures->at(*index); !texture_tuple.normal.has_value())
+		const auto& entry = entries[*index];
+		if (const auto& texture_tuple = textures.at(entry.tuple_index); !texture_tuple.normal.has_value())
 			return {.texture = error_hint_texture->ref(), .sample_mode = ERROR_HINT_SAMPLE_MODE};
 		else
-			return {.texture = texture_tuple.normal->ref(), .sample_mode = texture_tuple.sample_mode};
+			return {.texture = *texture_tuple.normal, .sample_mode = entry.sample_mode, .index = index};
 	}
 }
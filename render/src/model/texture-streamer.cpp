@@ -0,0 +1,523 @@
+#include "render/model/texture-streamer.hpp"
+#include "common/number-literals.hpp"
+#include "common/util/async.hpp"
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+#include "model/vk-object.hpp"
+#include "render/model/material.hpp"
+#include "render/model/texture.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <future>
+#include <glm/common.hpp>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	std::expected<TextureStreamer, Error> TextureStreamer::create(
+		const vulkan::Context& context,
+		std::shared_ptr<const model::MaterialList> source,
+		const MaterialList& material_list,
+		TextureList::LoadOption load_option,
+		Option option
+	) noexcept
+	{
+		if (source == nullptr) return Error("Source material list is null");
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+
+		/* Group texture descriptors by source texture */
+
+		std::map<std::pair<uint32_t, bool>, uint32_t> entry_indices;
+		std::vector<std::optional<uint32_t>> slot_entries(material_list.texture_sources.size());
+		std::vector<Entry> entries;
+
+		for (const auto [slot, texture_source] : material_list.texture_sources | std::views::enumerate)
+		{
+			if (!texture_source.has_value()) continue;
+			if (texture_source->texture_index >= source->textures.size())
+				return Error("Source material list mismatches the material list");
+
+			const auto normal = texture_source->usage == Texture::Usage::Normal;
+			const auto [it, inserted] =
+				entry_indices.try_emplace({texture_source->texture_index, normal}, entries.size());
+			if (inserted)
+				entries.push_back(Entry{.texture_index = texture_source->texture_index, .normal = normal});
+
+			entries[it->second].slots.push_back(static_cast<uint32_t>(slot));
+			slot_entries[slot] = it->second;
+		}
+
+		for (const auto [material, texture_index] : material_list.texture_indices | std::views::enumerate)
+		{
+			for (const auto slot :
+				 {texture_index.albedo, texture_index.emissive, texture_index.orm, texture_index.normal})
+			{
+				const auto entry_index = slot_entries[slot];
+				if (!entry_index.has_value()) continue;
+
+				auto& materials = entries[*entry_index].materials;
+				if (!std::ranges::contains(materials, static_cast<uint32_t>(material)))
+					materials.push_back(static_cast<uint32_t>(material));
+			}
+		}
+
+		return TextureStreamer(
+			std::move(source),
+			load_option,
+			option,
+			std::move(*resource_creator_result),
+			material_list,
+			std::move(slot_entries),
+			std::move(entries)
+		);
+	}
+
+	std::expected<void, Error> TextureStreamer::update(
+		const vulkan::Context& context,
+		std::span<const uint32_t> material_usage,
+		std::span<const uint32_t> material_resolution
+	) noexcept
+	{
+		frame++;
+		std::erase_if(retired, [this](const Retired& item) { return item.frame <= frame; });
+
+		apply_feedback(material_usage, material_resolution);
+		collect_bakes();
+
+		update_budget(context);
+		trim_to_budget();
+
+		if (const auto result = upload_baked(context); !result)
+			return result.error().forward("Upload streamed textures failed");
+
+		start_bakes();
+
+		return {};
+	}
+
+	void TextureStreamer::record(const vk::raii::CommandBuffer& command_buffer) noexcept
+	{
+		if (dirty_materials.empty()) return;
+
+		// Previous frames may still read the material infos
+		const auto pre_update_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(pre_update_barrier));
+
+		for (const auto material : dirty_materials)
+		{
+			const auto texture_index = get_texture_index(material);
+			command_buffer.updateBuffer<TextureIndex>(
+				info_buffer,
+				material * sizeof(MaterialInfo) + offsetof(MaterialInfo, texture_index),
+				texture_index
+			);
+		}
+
+		const auto post_update_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(post_update_barrier));
+
+		dirty_materials.clear();
+	}
+
+	TextureStreamer::Stat TextureStreamer::get_stat() const noexcept
+	{
+		const auto resident_count = std::ranges::count_if(entries, [](const Entry& entry) {
+			return entry.resident.has_value();
+		});
+		const auto pending_count = std::ranges::count_if(entries, [](const Entry& entry) {
+			return entry.bake.has_value() || entry.baked.has_value();
+		});
+
+		return {
+			.texture_count = entries.size(),
+			.resident_count = static_cast<size_t>(resident_count),
+			.pending_count = static_cast<size_t>(pending_count),
+			.resident_size = resident_size,
+			.budget = budget
+		};
+	}
+
+	TextureIndex TextureStreamer::get_texture_index(uint32_t material) const noexcept
+	{
+		const auto slot_count = static_cast<uint32_t>(slot_entries.size());
+		const auto get_slot = [this, slot_count](uint32_t slot) {
+			const auto entry_index = slot_entries[slot];
+			if (!entry_index.has_value() || !entries[*entry_index].resident.has_value()) return slot;
+			return slot_count + slot;
+		};
+
+		const auto& base = texture_indices[material];
+		return {
+			.albedo = get_slot(base.albedo),
+			.emissive = get_slot(base.emissive),
+			.orm = get_slot(base.orm),
+			.normal = get_slot(base.normal),
+		};
+	}
+
+	uint32_t TextureStreamer::get_loaded_log() const noexcept
+	{
+		// Unlimited textures are already loaded at full resolution
+		if (load_option.max_size == 0) return std::numeric_limits<uint32_t>::max();
+		return static_cast<uint32_t>(std::bit_width(load_option.max_size)) - 1;
+	}
+
+	void TextureStreamer::apply_feedback(
+		std::span<const uint32_t> material_usage,
+		std::span<const uint32_t> material_resolution
+	) noexcept
+	{
+		if (material_usage.size() != texture_indices.size()) return;
+		const bool has_resolution = material_resolution.size() == material_usage.size();
+
+		for (auto& entry : entries)
+		{
+			uint64_t usage = 0;
+			uint32_t resolution = 0;
+			for (const auto material : entry.materials)
+			{
+				usage += material_usage[material];
+				if (has_resolution) resolution = std::max(resolution, material_resolution[material]);
+			}
+
+			// Decay, so that textures no longer on screen lose priority over time
+			entry.priority = entry.priority / 2 + usage;
+			if (usage > 0) entry.last_used = frame;
+
+			// Resolution of the last frame seen on screen, `0` in the feedback if not sampled
+			if (resolution > 0) entry.resolution_log = resolution - 1;
+		}
+	}
+
+	void TextureStreamer::collect_bakes() noexcept
+	{
+		for (auto& entry : entries)
+		{
+			if (!entry.bake.has_value() || !entry.bake->ready()) continue;
+
+			auto bake_result = std::move(*entry.bake).get();
+			entry.bake.reset();
+
+			if (!bake_result)
+				entry.failed = true;
+			else
+				entry.baked = std::move(*bake_result);
+		}
+	}
+
+	void TextureStreamer::start_bakes() noexcept
+	{
+		auto pending_count = std::ranges::count_if(entries, [](const Entry& entry) {
+			return entry.bake.has_value();
+		});
+		if (std::cmp_greater_equal(pending_count, option.max_pending_bakes)) return;
+
+		const auto loaded_log = get_loaded_log();
+
+		auto candidates =
+			std::views::iota(0zu, entries.size())
+			| std::views::filter([this, loaded_log](size_t index) {
+				  const auto& entry = entries[index];
+				  return entry.priority > 0
+					  && !entry.failed
+					  && frame >= entry.retry_frame
+					  && !entry.bake.has_value()
+					  && !entry.baked.has_value()
+					  && entry.needs_upgrade(loaded_log);
+			  })
+			| std::ranges::to<std::vector>();
+		const auto get_priority = [this](size_t index) { return entries[index].priority; };
+		std::ranges::sort(candidates, std::greater(), get_priority);
+
+		using BakeResult = std::expected<Texture::Baked, Error>;
+
+		for (const auto index : candidates)
+		{
+			if (std::cmp_greater_equal(pending_count, option.max_pending_bakes)) break;
+
+			auto& entry = entries[index];
+			const auto max_size = 1_u32 << entry.resolution_log;
+
+			const auto bake_func = [source = source,
+									load_option = load_option,
+									texture_index = entry.texture_index,
+									normal = entry.normal,
+									max_size]() noexcept -> BakeResult {
+				const auto& texture = source->textures[texture_index].first;
+				if (normal)
+					return Texture::bake_normal_texture(texture, load_option.normal_load_strategy, max_size);
+				return Texture::bake_color_texture(
+					texture,
+					load_option.color_load_strategy,
+					max_size,
+					load_option.bc7_quality
+				);
+			};
+			auto future = std::async(std::launch::async, bake_func);
+
+			entry.bake = util::Future(std::move(future));
+			entry.bake_log = entry.resolution_log;
+			pending_count++;
+		}
+	}
+
+	std::expected<void, Error> TextureStreamer::upload_baked(const vulkan::Context& context) noexcept
+	{
+		auto candidates =
+			std::views::iota(0zu, entries.size())
+			| std::views::filter([this](size_t index) {
+				  const auto& entry = entries[index];
+				  return entry.baked.has_value() && frame >= entry.retry_frame;
+			  })
+			| std::ranges::to<std::vector>();
+		if (candidates.empty()) return {};
+		const auto get_priority = [this](size_t index) { return entries[index].priority; };
+		std::ranges::sort(candidates, std::greater(), get_priority);
+
+		/* Upload within budget */
+
+		std::vector<std::pair<size_t, Resident>> uploaded;
+		size_t upload_size = 0;
+
+		for (const auto index : candidates)
+		{
+			auto& entry = entries[index];
+			const auto size = entry.baked->data.size();
+			if (!uploaded.empty() && upload_size + size > option.max_upload_size) break;
+
+			// Upgraded textures replace their current version
+			const auto replaced_size = entry.resident.transform(&Resident::size).value_or(0);
+			if (!reserve_memory(size - std::min(size, replaced_size), entry.priority))
+			{
+				// Doesn't fit for now, retry later if still needed
+				entry.baked.reset();
+				entry.retry_frame = frame + option.evict_delay;
+				continue;
+			}
+
+			// Streamed textures come and go the most, defragmentation may move them, see `rebind_relocated`
+			const auto usage = load_option.usage | vk::ImageUsageFlagBits::eTransferSrc;
+			auto texture_result = Texture::upload(context, resource_creator, entry.baked->view(), usage);
+			if (!texture_result) return texture_result.error().forward("Upload texture failed");
+			texture_result->image.enable_relocation(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+			const auto base_extent = entry.baked->levels.front().extent;
+			const bool full_resolution = glm::max(base_extent.x, base_extent.y) < 1_u32 << entry.bake_log;
+
+			entry.baked.reset();
+			uploaded.emplace_back(
+				index,
+				Resident{
+					.texture = std::move(*texture_result),
+					.views = {},
+					.generation = 0,
+					.size = size,
+					.resolution_log = entry.bake_log,
+					.full_resolution = full_resolution
+				}
+			);
+			resident_size += size;
+			upload_size += size;
+		}
+
+		if (uploaded.empty()) return {};
+
+		if (const auto result = resource_creator.execute_uploads(context); !result)
+			return result.error().forward("Execute upload tasks failed");
+
+		/* Swap into streamed slots */
+
+		for (auto& [index, resident] : uploaded)
+		{
+			auto& entry = entries[index];
+
+			if (const auto result = bind_views(context, entry, resident); !result)
+				return result.error().forward("Bind streamed texture failed");
+
+			// Frames in flight may still sample the replaced version
+			if (entry.resident.has_value())
+			{
+				resident_size -= entry.resident->size;
+				retired.push_back(
+					Retired{.frame = frame + option.frames_in_flight, .resident = std::move(*entry.resident)}
+				);
+			}
+
+			entry.resident = std::move(resident);
+			mark_dirty(entry);
+		}
+
+		return {};
+	}
+
+	std::expected<void, Error> TextureStreamer::bind_views(
+		const vulkan::Context& context,
+		const Entry& entry,
+		Resident& resident
+	) noexcept
+	{
+		const auto slot_count = static_cast<uint32_t>(slot_entries.size());
+
+		std::vector<vk::raii::ImageView> views;
+		std::vector<vk::DescriptorImageInfo> image_infos;
+		for (const auto slot : entry.slots)
+		{
+			const auto& texture_source = *texture_sources[slot];
+
+			auto view_result =
+				impl::to_image_view(context.device, resident.texture.ref(), texture_source.usage);
+			if (!view_result) return view_result.error().forward("Create image view failed");
+
+			image_infos.push_back(
+				vk::DescriptorImageInfo{
+					.sampler = texture_source.sampler,
+					.imageView = *view_result,
+					.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+				}
+			);
+			views.push_back(std::move(*view_result));
+		}
+
+		const auto writes =
+			std::views::zip(entry.slots, image_infos)
+			| std::views::transform([this, slot_count](const auto& pair) {
+				  const auto& [slot, image_info] = pair;
+				  return vk::WriteDescriptorSet{
+					  .dstSet = descriptor_set,
+					  .dstBinding = 1,
+					  .dstArrayElement = slot_count + slot,
+					  .descriptorCount = 1,
+					  .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+					  .pImageInfo = &image_info
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+		context.device.updateDescriptorSets(writes, {});
+
+		resident.views = std::move(views);
+		resident.generation = resident.texture.image.get_generation();
+
+		return {};
+	}
+
+	std::expected<void, Error> TextureStreamer::rebind_relocated(const vulkan::Context& context) noexcept
+	{
+		for (auto& entry : entries)
+		{
+			if (!entry.resident.has_value()) continue;
+
+			auto& resident = *entry.resident;
+			if (resident.generation == resident.texture.image.get_generation()) continue;
+
+			if (const auto result = bind_views(context, entry, resident); !result)
+				return result.error().forward("Rebind relocated texture failed");
+		}
+
+		return {};
+	}
+
+	void TextureStreamer::update_budget(const vulkan::Context& context) noexcept
+	{
+		const auto usage = context.allocator.get_device_memory_usage();
+
+		// Retired textures are still counted in the usage, but are about to be released
+		const auto retired_size = std::ranges::fold_left(
+			retired | std::views::transform([](const Retired& item) { return item.resident.size; }),
+			0zu,
+			std::plus()
+		);
+
+		// Memory streamed textures may occupy, if everything else stays as is
+		const auto streamed_size = resident_size + retired_size;
+		const auto others_size = usage.usage_bytes - std::min(usage.usage_bytes, streamed_size);
+		const auto reserved_size = others_size + option.memory_reserve;
+		const auto available = usage.budget_bytes - std::min(usage.budget_bytes, reserved_size);
+
+		budget = std::min(option.memory_budget, available);
+	}
+
+	void TextureStreamer::trim_to_budget() noexcept
+	{
+		while (resident_size > budget)
+		{
+			auto resident = entries | std::views::filter([](const Entry& entry) {
+								return entry.resident.has_value();
+							});
+
+			const auto victim = std::ranges::min_element(resident, {}, &Entry::priority);
+			if (victim == resident.end()) return;
+
+			evict(*victim);
+
+			// Stay at low resolution for a while, instead of streaming back right away under pressure
+			victim->retry_frame = frame + option.evict_delay;
+		}
+	}
+
+	bool TextureStreamer::reserve_memory(size_t size, uint64_t priority) noexcept
+	{
+		while (resident_size + size > budget)
+		{
+			auto evictable = entries | std::views::filter([this, priority](const Entry& entry) {
+								 return entry.resident.has_value()
+									 && entry.last_used + option.evict_delay < frame
+									 && entry.priority < priority;
+							 });
+
+			const auto victim = std::ranges::min_element(evictable, {}, &Entry::priority);
+			if (victim == evictable.end()) return false;
+
+			evict(*victim);
+		}
+
+		return true;
+	}
+
+	void TextureStreamer::evict(Entry& entry) noexcept
+	{
+		resident_size -= entry.resident->size;
+
+		// Frames in flight may still sample the texture through the streamed slots
+		retired.push_back(
+			Retired{.frame = frame + option.frames_in_flight, .resident = std::move(*entry.resident)}
+		);
+		entry.resident.reset();
+		entry.retry_frame = frame + option.frames_in_flight;
+
+		mark_dirty(entry);
+	}
+
+	void TextureStreamer::mark_dirty(const Entry& entry) noexcept
+	{
+		dirty_materials.insert_range(entry.materials);
+	}
+}
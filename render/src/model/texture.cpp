@@ -2,286 +2,862 @@
 #include "common/number-literals.hpp"
 #include "common/util/error.hpp"
 #include "common/util/overload.hpp"
+#include "common/util/span.hpp"
+#include "common/util/trace.hpp"
 #include "image/bc-image.hpp"
 #include "image/common.hpp"
+#include "image/dds.hpp"
 #include "image/image.hpp"
+#include "image/ktx2.hpp"
 #include "model/texture.hpp"
+#include "vulkan/alloc/image.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/util/static-resource-creator.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
+#include <filesystem>
+#include <format>
+#include <functional>
 #include <glm/common.hpp>
+#include <glm/ext/vector_int4.hpp>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <glm/ext/vector_uint4_sized.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vector_relational.hpp>
 #include <libassert/assert.hpp>
+#include <limits>
 #include <map>
+#include <mio/mmap.hpp>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <string_view>
+#include <system_error>
 #include <utility>
 #include <variant>
+#include <vector>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_structs.hpp>
 
 namespace render
 {
-	std::expected<Texture, Error> Texture::load_rgba8_unorm(
-		const vulkan::Context& context,
-		vulkan::StaticResourceCreator& resource_creator,
-		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image,
-		vk::ImageUsageFlags usage
+	// Pack a mipmap chain into a baked texture, `texel_scale` converts element dimensions to texels
+	template <typename T>
+	static Texture::Baked pack_mipmap_chain(
+		Texture::Format format,
+		std::span<const T> mipmap_chain,
+		uint32_t texel_scale = 1
+	) noexcept
+	{
+		auto baked = Texture::Baked{.format = format, .min_alpha = std::nullopt, .levels = {}, .data = {}};
+		baked.levels.reserve(mipmap_chain.size());
+		baked.data.reserve(
+			std::ranges::fold_left(
+				mipmap_chain | std::views::transform([](const T& level) {
+					return util::as_bytes(level.data).size();
+				}),
+				0zu,
+				std::plus()
+			)
+		);
+
+		for (const auto& level : mipmap_chain)
+		{
+			const auto level_data = util::as_bytes(level.data);
+			baked.levels.push_back(
+				Texture::BakedLevel{
+					.extent = level.size * texel_scale,
+					.offset = baked.data.size(),
+					.size = level_data.size()
+				}
+			);
+			baked.data.append_range(level_data);
+		}
+
+		return baked;
+	}
+
+	// Downscale an image by powers of two until its larger dimension fits `max_size`, `0` for unlimited
+	template <image::Format F>
+	static image::Image<F, image::Layout::RGBA> limit_size(
+		image::Image<F, image::Layout::RGBA> image,
+		uint32_t max_size
 	) noexcept
 	{
-		/* Generate mipmap chain */
+		if (max_size == 0) return image;
 
+		auto size = image.size;
+		while (glm::max(size.x, size.y) > max_size) size = glm::max(size / 2_u32, glm::u32vec2(1));
+
+		if (size == image.size) return image;
+
+		const auto trace = util::trace::Scope("Resize texture");
+		return image.resize(size);
+	}
+
+	Texture::Baked Texture::bake_rgba8_unorm(
+		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image
+	) noexcept
+	{
 		const auto mipmap_chain = image.resize_and_generate_mipmap(0);
+		return pack_mipmap_chain(Format::Rgba8Unorm, std::span(mipmap_chain));
+	}
 
-		/* Create vulkan image */
+	Texture::Unencoded Texture::prepare_bcn(
+		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image,
+		image::BCnFormat format
+	) noexcept
+	{
+		const auto trace = util::trace::Scope("Prepare texture");
 
-		auto image_result = resource_creator.create_image_mipmap(
-			context,
-			mipmap_chain,
-			vk::Format::eR8G8B8A8Unorm,
-			usage,
-			vk::ImageLayout::eShaderReadOnlyOptimal,
-			vk::ImageCreateFlagBits::eMutableFormat
-		);
-		if (!image_result) return image_result.error().forward("Create image failed");
-		auto vk_image = std::move(*image_result);
+		auto base = image.is_pot() ? image : image.resize_to_pot(true);
 
-		/* Construct */
+		const auto min_size = glm::u32vec2(1_u32 << Unencoded::MIN_SIZE_LOG);
+		if (glm::any(glm::lessThan(base.size, min_size))) base = base.resize(glm::max(base.size, min_size));
 
-		return Texture{
-			.image = std::move(vk_image),
-			.format = Format::Rgba8Unorm,
-			.mipmap_levels = static_cast<uint32_t>(mipmap_chain.size())
+		return Unencoded{.format = format, .min_alpha = std::nullopt, .image = std::move(base)};
+	}
+
+	// Gather blocks evenly spread over an image in a grid of up to `Texture::ADAPTIVE_SAMPLE_GRID` blocks
+	// in each dimension. The image must be a multiple of 4 in both dimensions
+	static image::Image<image::Format::Unorm8, image::Layout::RGBA> sample_blocks(
+		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image
+	) noexcept
+	{
+		const auto block_dim = image.size / 4_u32;
+		const auto sample_dim = glm::min(block_dim, glm::u32vec2(Texture::ADAPTIVE_SAMPLE_GRID));
+		if (sample_dim == block_dim) return image;
+
+		auto samples = image::Image<image::Format::Unorm8, image::Layout::RGBA>(sample_dim * 4_u32);
+
+		const auto rows = std::views::iota(0_u32, sample_dim.y * 4);
+		const auto columns = std::views::iota(0_u32, sample_dim.x);
+
+		for (const auto [y, block_x] : std::views::cartesian_product(rows, columns))
+		{
+			// Source block at the center of each cell of the sample grid
+			const auto source_block = (glm::u32vec2(block_x, y / 4) * 2_u32 + 1_u32) * block_dim
+				/ (sample_dim * 2_u32);
+			const auto source_row = source_block.y * 4 + y % 4;
+
+			std::ranges::copy(
+				std::span(image.data).subspan(source_row * image.size.x + source_block.x * 4, 4),
+				samples.data.begin() + y * samples.size.x + block_x * 4
+			);
+		}
+
+		return samples;
+	}
+
+	// PSNR in dB between two images of the same size, over all 4 channels
+	static double get_psnr(
+		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& a,
+		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& b
+	) noexcept
+	{
+		const auto get_squared_error = [](glm::u8vec4 pixel_a, glm::u8vec4 pixel_b) {
+			const auto diff = glm::ivec4(pixel_a) - glm::ivec4(pixel_b);
+			return uint64_t(glm::dot(diff, diff));
 		};
+
+		const auto squared_error = std::ranges::fold_left(
+			std::views::zip_transform(get_squared_error, a.data, b.data),
+			0_u64,
+			std::plus()
+		);
+		if (squared_error == 0) return std::numeric_limits<double>::infinity();
+
+		const auto mse = double(squared_error) / double(a.data.size() * 4);
+		return 10.0 * std::log10(255.0 * 255.0 / mse);
 	}
 
-	std::expected<Texture, Error> Texture::load_bcn(
-		const vulkan::Context& context,
-		vulkan::StaticResourceCreator& resource_creator,
-		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image,
-		image::BCnFormat format,
-		vk::ImageUsageFlags usage
+	Texture::Prepared Texture::prepare_adaptive(
+		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image
 	) noexcept
 	{
-		/* Select Formats */
+		using Unorm8Image = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
 
-		const auto [texture_format, vk_format] = [format] -> std::pair<Format, vk::Format> {
-			switch (format)
-			{
-			case image::BCnFormat::BC3:
-				return {Format::BC3, vk::Format::eBc3UnormBlock};
-			case image::BCnFormat::BC5:
-				return {Format::BC5, vk::Format::eBc5SnormBlock};
-			case image::BCnFormat::BC7:
-				return {Format::BC7, vk::Format::eBc7UnormBlock};
-			default:
-				UNREACHABLE("Invalid format");
-			}
-		}();
+		// Single-color images are sampled identically at any resolution
+		const auto first_pixel = image.data[0];
+		const auto is_first_pixel = [first_pixel](glm::u8vec4 pixel) { return pixel == first_pixel; };
+		if (std::ranges::all_of(image.data, is_first_pixel))
+			return bake_rgba8_unorm(Unorm8Image({1, 1}, first_pixel));
+
+		auto unencoded = prepare_bcn(image, image::BCnFormat::BC3);
+
+		// BC3 and BC7 take the same memory, BC3 is preferred as it encodes much faster
+		const auto samples = sample_blocks(unencoded.image);
+		const auto bc3_psnr =
+			image::BCnImage::encode(samples, image::BCnFormat::BC3)
+				.and_then([](const image::BCnImage& encoded) { return encoded.decode(); })
+				.transform([&samples](const Unorm8Image& decoded) { return get_psnr(samples, decoded); });
+
+		if (!bc3_psnr || *bc3_psnr < ADAPTIVE_PSNR_TARGET) unencoded.format = image::BCnFormat::BC7;
+		return unencoded;
+	}
+
+	Texture::Format Texture::get_bcn_format(image::BCnFormat format) noexcept
+	{
+		switch (format)
+		{
+		case image::BCnFormat::BC3:
+			return Format::BC3;
+		case image::BCnFormat::BC5:
+			return Format::BC5;
+		case image::BCnFormat::BC7:
+			return Format::BC7;
+		case image::BCnFormat::ETC2:
+			return Format::ETC2;
+		case image::BCnFormat::EAC_RG11:
+			return Format::EAC_RG11;
+		case image::BCnFormat::ASTC4x4:
+			return Format::ASTC4x4;
+		default:
+			UNREACHABLE("Invalid format");
+		}
+	}
+
+	Texture::CompressionSupport Texture::CompressionSupport::query(
+		const vk::raii::PhysicalDevice& phy_device
+	) noexcept
+	{
+		const auto features = phy_device.getFeatures();
+		return {
+			.bc = features.textureCompressionBC == vk::True,
+			.etc2 = features.textureCompressionETC2 == vk::True,
+			.astc = features.textureCompressionASTC_LDR == vk::True,
+		};
+	}
+
+	Texture::ColorLoadStrategy Texture::CompressionSupport::fit(ColorLoadStrategy strategy) const noexcept
+	{
+		switch (strategy)
+		{
+		case ColorLoadStrategy::Raw:
+			return strategy;
+
+		case ColorLoadStrategy::AllETC2:
+		case ColorLoadStrategy::AstcETC2:
+			if (etc2) return astc ? strategy : ColorLoadStrategy::AllETC2;
+			return bc ? ColorLoadStrategy::BalancedBC : ColorLoadStrategy::Raw;
+
+		default:
+			if (bc) return strategy;
+			if (etc2) return astc ? ColorLoadStrategy::AstcETC2 : ColorLoadStrategy::AllETC2;
+			return ColorLoadStrategy::Raw;
+		}
+	}
+
+	Texture::NormalLoadStrategy Texture::CompressionSupport::fit(NormalLoadStrategy strategy) const noexcept
+	{
+		switch (strategy)
+		{
+		case NormalLoadStrategy::AllBC5:
+		case NormalLoadStrategy::AdaptiveUnormBC5:
+			if (bc) return strategy;
+			if (etc2) return NormalLoadStrategy::AllEAC;
+			return strategy == NormalLoadStrategy::AllBC5
+				? NormalLoadStrategy::AllUnorm8
+				: NormalLoadStrategy::AdaptiveUnorm;
+
+		case NormalLoadStrategy::AllEAC:
+			if (etc2) return strategy;
+			return bc ? NormalLoadStrategy::AllBC5 : NormalLoadStrategy::AllUnorm8;
+
+		default:
+			return strategy;
+		}
+	}
 
-		/* Generate mipmap */
+	std::expected<Texture::Baked, Error> Texture::encode(
+		const Unencoded& unencoded,
+		image::BC7Quality bc7_quality
+	) noexcept
+	{
+		const auto trace = util::trace::Scope("Encode texture");
 
 		auto mipmap_chain_result =
-			image.resize_and_generate_mipmap(2)
-			| std::views::transform([format](const auto& image) {
-				  return image::BCnImage::encode(image, format);
+			unencoded.image.generate_mipmap(Unencoded::MIN_SIZE_LOG)
+			| std::views::transform([&unencoded, bc7_quality](const auto& image) {
+				  return image::BCnImage::encode(image, unencoded.format, bc7_quality);
 			  })
 			| Error::collect();
 		if (!mipmap_chain_result) return mipmap_chain_result.error().forward("Encode BCn image failed");
 		const auto mipmap_chain = std::move(*mipmap_chain_result);
 
-		/* Create vulkan image */
+		// Sizes of BCn images are in 4x4 blocks
+		auto baked = pack_mipmap_chain(get_bcn_format(unencoded.format), std::span(mipmap_chain), 4);
+		baked.min_alpha = unencoded.min_alpha;
+		return baked;
+	}
 
-		auto image_result = resource_creator.create_image_mipmap_bcn(
-			context,
-			mipmap_chain,
-			false,
-			usage,
-			vk::ImageLayout::eShaderReadOnlyOptimal,
-			vk::ImageCreateFlagBits::eMutableFormat
-		);
-		if (!image_result) return image_result.error().forward("Create image failed");
-		auto vk_image = std::move(*image_result);
+	Texture::Baked Texture::bake_rg8_unorm(
+		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image
+	) noexcept
+	{
+		const auto mipmap_chain =
+			image.convert<image::Format::Unorm8, image::Layout::RG>().resize_and_generate_mipmap(0);
+		return pack_mipmap_chain(Format::Rg8Unorm, std::span(mipmap_chain));
+	}
+
+	Texture::Baked Texture::bake_rg16_unorm(
+		const image::Image<image::Format::Unorm16, image::Layout::RGBA>& image
+	) noexcept
+	{
+		const auto mipmap_chain =
+			image.convert<image::Format::Unorm16, image::Layout::RG>().resize_and_generate_mipmap(0);
+		return pack_mipmap_chain(Format::Rg16Unorm, std::span(mipmap_chain));
+	}
 
-		/* Construct */
+	// Finish baking a prepared texture on the CPU
+	static std::expected<Texture::Baked, Error> encode_prepared(
+		Texture::Prepared prepared,
+		image::BC7Quality bc7_quality
+	) noexcept
+	{
+		if (auto* baked = std::get_if<Texture::Baked>(&prepared)) return std::move(*baked);
+		return Texture::encode(std::get<Texture::Unencoded>(prepared), bc7_quality);
+	}
 
-		return Texture{
-			.image = std::move(vk_image),
-			.format = texture_format,
-			.mipmap_levels = static_cast<uint32_t>(mipmap_chain.size())
+	// Pack the levels of a pre-encoded BCn texture into a baked texture
+	static Texture::Baked pack_bcn_levels(
+		image::BCnFormat format,
+		std::span<const image::BCnLevel> levels,
+		std::optional<float> min_alpha
+	) noexcept
+	{
+		auto baked = Texture::Baked{
+			.format = Texture::get_bcn_format(format),
+			.min_alpha = min_alpha,
+			.levels = {},
+			.data = {}
 		};
+
+		for (const auto& level : levels)
+		{
+			const auto level_data = util::as_bytes(level.blocks);
+			baked.levels.push_back(
+				Texture::BakedLevel{
+					.extent = level.extent,
+					.offset = baked.data.size(),
+					.size = level_data.size()
+				}
+			);
+			baked.data.append_range(level_data);
+		}
+
+		return baked;
 	}
 
-	std::expected<Texture, Error> Texture::load_rg8_unorm(
-		const vulkan::Context& context,
-		vulkan::StaticResourceCreator& resource_creator,
-		const image::Image<image::Format::Unorm8, image::Layout::RGBA>& image,
-		vk::ImageUsageFlags usage
+	// A single level larger than a block is better decoded, so that a mipmap chain gets generated
+	static bool lacks_mipmap_chain(std::span<const image::BCnLevel> levels) noexcept
+	{
+		const auto& base_extent = levels.front().extent;
+		return levels.size() == 1 && glm::max(base_extent.x, base_extent.y) > 4;
+	}
+
+	// Bake a KTX2 (transcoded into `formats[0]`) or DDS (with one of `formats`) file, `std::nullopt` if the
+	// file is neither, has a DDS format not in `formats`, or lacks a mipmap chain
+	static std::expected<std::optional<Texture::Baked>, Error> bake_pre_encoded(
+		std::span<const std::byte> data,
+		std::span<const image::BCnFormat> formats,
+		uint32_t max_size
 	) noexcept
 	{
-		const auto mipmap_chain =
-			image.map([](const glm::u8vec4& pixel) { return glm::u8vec2(pixel); })
-				.resize_and_generate_mipmap(0);
-
-		return resource_creator
-			.create_image_mipmap(
-				context,
-				mipmap_chain,
-				vk::Format::eR8G8Unorm,
-				usage,
-				vk::ImageLayout::eShaderReadOnlyOptimal,
-				vk::ImageCreateFlagBits::eMutableFormat
-			)
-			.transform_error([](Error&& error) { return std::move(error).forward("Create image failed"); })
-			.transform([&mipmap_chain](auto vk_image) {
-				return Texture{
-					.image = std::move(vk_image),
-					.format = Format::Rg8Unorm,
-					.mipmap_levels = static_cast<uint32_t>(mipmap_chain.size())
-				};
-			});
+		if (image::Ktx2Image::is_ktx2(data))
+		{
+			auto ktx2_result = image::Ktx2Image::transcode(data, formats.front(), max_size);
+			if (!ktx2_result) return ktx2_result.error().forward("Transcode KTX2 texture failed");
+			if (lacks_mipmap_chain(ktx2_result->levels)) return std::nullopt;
+
+			// Fully opaque unless the container has alpha, whose minimum is unknown without decoding
+			const auto min_alpha = ktx2_result->has_alpha ? std::nullopt : std::optional(1.0f);
+			return pack_bcn_levels(ktx2_result->format, ktx2_result->levels, min_alpha);
+		}
+
+		if (image::DdsImage::is_dds(data))
+		{
+			auto dds_result = image::DdsImage::read(data, max_size);
+			if (!dds_result) return dds_result.error().forward("Read DDS texture failed");
+			if (!std::ranges::contains(formats, dds_result->format)) return std::nullopt;
+			if (lacks_mipmap_chain(dds_result->levels)) return std::nullopt;
+
+			return pack_bcn_levels(dds_result->format, dds_result->levels, std::nullopt);
+		}
+
+		return std::nullopt;
 	}
 
-	std::expected<Texture, Error> Texture::load_rg16_unorm(
-		const vulkan::Context& context,
-		vulkan::StaticResourceCreator& resource_creator,
-		const image::Image<image::Format::Unorm16, image::Layout::RGBA>& image,
-		vk::ImageUsageFlags usage
+	// Bake a pre-encoded file by memory-mapping it, see `bake_pre_encoded`
+	static std::expected<std::optional<Texture::Baked>, Error> bake_pre_encoded_file(
+		const std::filesystem::path& path,
+		std::span<const image::BCnFormat> formats,
+		uint32_t max_size
 	) noexcept
 	{
-		const auto mipmap_chain =
-			image.map([](const glm::u16vec4& pixel) { return glm::u16vec2(pixel); })
-				.resize_and_generate_mipmap(0);
-
-		return resource_creator
-			.create_image_mipmap(
-				context,
-				mipmap_chain,
-				vk::Format::eR16G16Unorm,
-				usage,
-				vk::ImageLayout::eShaderReadOnlyOptimal,
-				vk::ImageCreateFlagBits::eMutableFormat
-			)
-			.transform_error([](Error&& error) { return std::move(error).forward("Create image failed"); })
-			.transform([&mipmap_chain](auto vk_image) {
-				return Texture{
-					.image = std::move(vk_image),
-					.format = Format::Rg16Unorm,
-					.mipmap_levels = static_cast<uint32_t>(mipmap_chain.size())
-				};
-			});
+		try
+		{
+			const auto mmap = mio::basic_mmap_source<std::byte>(path.string(), 0);
+			return bake_pre_encoded(std::span(mmap.data(), mmap.size()), formats, max_size);
+		}
+		catch (const std::system_error& e)
+		{
+			return Error(
+				"Memory map texture file failed",
+				std::format("Path: {}, what(): {:?}", path.string(), e.what())
+			);
+		}
 	}
 
-	std::expected<Texture, Error> Texture::load_color_texture(
-		const vulkan::Context& context,
-		vulkan::StaticResourceCreator& resource_creator,
+	// Sidecar extensions, in order of preference. DDS blocks are copied as-is, KTX2 is transcoded
+	static constexpr auto SIDECAR_EXTENSIONS = std::to_array<std::string_view>({".dds", ".ktx2"});
+
+	// Bake a texture from its pre-encoded data without decoding or encoding any pixel, `std::nullopt` if none
+	// is usable. Either the source itself is a KTX2 container, or an up-to-date sidecar sits next to the
+	// source file (e.g. `albedo.dds` for `albedo.png`, at least as new as it)
+	static std::expected<std::optional<Texture::Baked>, Error> bake_pre_encoded(
+		const model::Texture& texture,
+		std::span<const image::BCnFormat> formats,
+		uint32_t max_size
+	) noexcept
+	{
+		// Blocks can't be flipped without re-encoding
+		if (texture.flip_x || texture.flip_y) return std::nullopt;
+
+		if (const auto* data = std::get_if<std::vector<std::byte>>(&texture.source))
+			return bake_pre_encoded(*data, formats, max_size);
+
+		if (const auto* shared_data = std::get_if<model::Texture::SharedData>(&texture.source))
+			return bake_pre_encoded(shared_data->data, formats, max_size);
+
+		const auto* path = std::get_if<std::filesystem::path>(&texture.source);
+		if (path == nullptr) return std::nullopt;
+
+		auto source_result = bake_pre_encoded_file(*path, formats, max_size);
+		if (!source_result || source_result->has_value()) return source_result;
+
+		std::error_code error_code;
+		const auto source_time = std::filesystem::last_write_time(*path, error_code);
+		if (error_code) return std::nullopt;
+
+		for (const auto extension : SIDECAR_EXTENSIONS)
+		{
+			const auto sidecar_path = std::filesystem::path(*path).replace_extension(extension);
+			if (sidecar_path == *path) continue;
+
+			const auto sidecar_time = std::filesystem::last_write_time(sidecar_path, error_code);
+			if (error_code || sidecar_time < source_time) continue;
+
+			auto sidecar_result = bake_pre_encoded_file(sidecar_path, formats, max_size);
+			if (!sidecar_result)
+				return sidecar_result.error().forward(
+					std::format("Load sidecar texture '{}' failed", sidecar_path.string())
+				);
+			if (sidecar_result->has_value()) return sidecar_result;
+		}
+
+		return std::nullopt;
+	}
+
+	std::expected<Texture::Prepared, Error> Texture::prepare_color_texture(
 		const model::Texture& texture,
 		ColorLoadStrategy load_strategy,
-		vk::ImageUsageFlags usage
+		uint32_t max_size
 	) noexcept
 	{
-		auto image_result = texture.load_8bit();
+		// Pre-encoded data is used with its own mipmap chain. KTX2 is transcoded into the first format, BC7
+		// regardless of size as it costs no encoding
+		const auto pre_encoded_formats = [load_strategy] -> std::vector<image::BCnFormat> {
+			switch (load_strategy)
+			{
+			case ColorLoadStrategy::AllBC3:
+				return {image::BCnFormat::BC3};
+			case ColorLoadStrategy::AllBC7:
+				return {image::BCnFormat::BC7};
+			case ColorLoadStrategy::BalancedBC:
+			case ColorLoadStrategy::Adaptive:
+				return {image::BCnFormat::BC7, image::BCnFormat::BC3};
+			case ColorLoadStrategy::AllETC2:
+				return {image::BCnFormat::ETC2};
+			case ColorLoadStrategy::AstcETC2:
+				return {image::BCnFormat::ASTC4x4, image::BCnFormat::ETC2};
+			default:
+				return {};
+			}
+		}();
+
+		if (!pre_encoded_formats.empty())
+		{
+			auto pre_encoded_result = bake_pre_encoded(texture, pre_encoded_formats, max_size);
+			if (!pre_encoded_result)
+				return pre_encoded_result.error().forward("Load pre-encoded texture failed");
+			if (pre_encoded_result->has_value()) return std::move(**pre_encoded_result);
+		}
+
+		// Decoded at reduced resolution when limited, `limit_size` only finishes the last step
+		auto image_result = texture.load_8bit(max_size);
 		if (!image_result) return image_result.error().forward("Load texture failed");
-		auto image = std::move(*image_result);
 
-		const auto min_alpha = std::ranges::min(image.data | std::views::transform(&glm::u8vec4::a));
+		// Taken before the final downscaling. Images reduced while decoding are box-filtered, so isolated
+		// transparent texels may average out, while alpha-tested areas larger than the reduction are kept
+		const auto min_alpha = image_result->min_alpha() / 255.0f;
+
+		const auto image = limit_size(std::move(*image_result), max_size);
 
-		auto load_result = [&] {
+		auto prepared = [&] -> Prepared {
 			switch (load_strategy)
 			{
 			case ColorLoadStrategy::Raw:
-				return load_rgba8_unorm(context, resource_creator, image, usage);
+				return bake_rgba8_unorm(image);
 
 			case ColorLoadStrategy::AllBC3:
-				return load_bcn(context, resource_creator, image, image::BCnFormat::BC3, usage);
+				return prepare_bcn(image, image::BCnFormat::BC3);
 
 			case ColorLoadStrategy::AllBC7:
-				return load_bcn(context, resource_creator, image, image::BCnFormat::BC7, usage);
+				return prepare_bcn(image, image::BCnFormat::BC7);
 
 			case ColorLoadStrategy::BalancedBC:
-				return load_bcn(
-					context,
-					resource_creator,
+				return prepare_bcn(
 					image,
 					glm::max(image.size.x, image.size.y) <= BC7_THRESHOLD
 						? image::BCnFormat::BC7
-						: image::BCnFormat::BC3,
-					usage
+						: image::BCnFormat::BC3
 				);
 
+			case ColorLoadStrategy::Adaptive:
+				return prepare_adaptive(image);
+
+			case ColorLoadStrategy::AllETC2:
+			case ColorLoadStrategy::AstcETC2:
+				return prepare_bcn(image, image::BCnFormat::ETC2);
+
 			default:
 				UNREACHABLE("Invalid enum input");
 			}
 		}();
 
-		return std::move(load_result).transform([min_alpha](Texture texture) {
-			texture.min_alpha = min_alpha / 255.0f;
-			return texture;
-		});
+		std::visit([min_alpha](auto& value) { value.min_alpha = min_alpha; }, prepared);
+		return prepared;
 	}
 
-	std::expected<Texture, Error> Texture::load_normal_texture(
-		const vulkan::Context& context,
-		vulkan::StaticResourceCreator& resource_creator,
+	std::expected<Texture::Baked, Error> Texture::bake_color_texture(
+		const model::Texture& texture,
+		ColorLoadStrategy load_strategy,
+		uint32_t max_size,
+		image::BC7Quality bc7_quality
+	) noexcept
+	{
+		return prepare_color_texture(texture, load_strategy, max_size)
+			.and_then([bc7_quality](Prepared prepared) {
+				return encode_prepared(std::move(prepared), bc7_quality);
+			});
+	}
+
+	std::expected<Texture::Prepared, Error> Texture::prepare_normal_texture(
 		const model::Texture& texture,
 		NormalLoadStrategy load_strategy,
-		vk::ImageUsageFlags usage
+		uint32_t max_size
 	) noexcept
 	{
 		using Unorm8Image = image::Image<image::Format::Unorm8, image::Layout::RGBA>;
 		using Unorm16Image = image::Image<image::Format::Unorm16, image::Layout::RGBA>;
 
-		auto image_result = texture.load();
+		// Pre-encoded data is used with its own mipmap chain, it has no 16-bit precision to keep
+		if (load_strategy == NormalLoadStrategy::AllBC5
+			|| load_strategy == NormalLoadStrategy::AdaptiveUnormBC5
+			|| load_strategy == NormalLoadStrategy::AllEAC)
+		{
+			const auto pre_encoded_formats = std::to_array({
+				load_strategy == NormalLoadStrategy::AllEAC
+					? image::BCnFormat::EAC_RG11
+					: image::BCnFormat::BC5
+			});
+
+			auto pre_encoded_result = bake_pre_encoded(texture, pre_encoded_formats, max_size);
+			if (!pre_encoded_result)
+				return pre_encoded_result.error().forward("Load pre-encoded texture failed");
+			if (pre_encoded_result->has_value()) return std::move(**pre_encoded_result);
+		}
+
+		auto image_result = texture.load(max_size);
 		if (!image_result) return image_result.error().forward("Load texture failed");
-		auto image = std::move(*image_result);
 
-		const auto unorm16_to_unorm8 = [](const glm::u16vec4& pixel) {
-			return glm::u8vec4(pixel >> 8_u16);
-		};
+		const auto image = std::visit(
+			[max_size](auto image) -> model::Texture::ImageVariant {
+				return limit_size(std::move(image), max_size);
+			},
+			std::move(*image_result)
+		);
 
 		const auto convert_to_unorm8 = util::Overload(
 			[](const Unorm8Image& image) { return image; },
-			[&unorm16_to_unorm8](const Unorm16Image& image) { return image.map(unorm16_to_unorm8); }
+			[](const Unorm16Image& image) {
+				return image.convert<image::Format::Unorm8, image::Layout::RGBA>();
+			}
 		);
 
 		switch (load_strategy)
 		{
 		case NormalLoadStrategy::AllUnorm8:
-			return load_rg8_unorm(context, resource_creator, std::visit(convert_to_unorm8, image), usage);
+			return bake_rg8_unorm(std::visit(convert_to_unorm8, image));
 
 		case NormalLoadStrategy::AdaptiveUnorm:
 			return std::holds_alternative<Unorm16Image>(image)
-				? load_rg16_unorm(context, resource_creator, std::get<Unorm16Image>(image), usage)
-				: load_rg8_unorm(context, resource_creator, std::get<Unorm8Image>(image), usage);
+				? bake_rg16_unorm(std::get<Unorm16Image>(image))
+				: bake_rg8_unorm(std::get<Unorm8Image>(image));
 
 		case NormalLoadStrategy::AdaptiveUnormBC5:
-			return std::holds_alternative<Unorm16Image>(image)
-				? load_rg16_unorm(context, resource_creator, std::get<Unorm16Image>(image), usage)
-				: load_bcn(
-					  context,
-					  resource_creator,
-					  std::get<Unorm8Image>(image),
-					  image::BCnFormat::BC5,
-					  usage
-				  );
+			if (std::holds_alternative<Unorm16Image>(image))
+				return bake_rg16_unorm(std::get<Unorm16Image>(image));
+			return prepare_bcn(std::get<Unorm8Image>(image), image::BCnFormat::BC5);
 
 		case NormalLoadStrategy::AllBC5:
-			return load_bcn(
-				context,
-				resource_creator,
-				std::visit(convert_to_unorm8, image),
-				image::BCnFormat::BC5,
-				usage
-			);
+			return prepare_bcn(std::visit(convert_to_unorm8, image), image::BCnFormat::BC5);
+
+		case NormalLoadStrategy::AllEAC:
+			return prepare_bcn(std::visit(convert_to_unorm8, image), image::BCnFormat::EAC_RG11);
 
 		default:
 			UNREACHABLE("Invalid strategy", load_strategy);
 		}
 	}
 
+	std::expected<Texture::Baked, Error> Texture::bake_normal_texture(
+		const model::Texture& texture,
+		NormalLoadStrategy load_strategy,
+		uint32_t max_size
+	) noexcept
+	{
+		return prepare_normal_texture(texture, load_strategy, max_size).and_then([](Prepared prepared) {
+			return encode_prepared(std::move(prepared), {});
+		});
+	}
+
+	// Storage formats, views of other formats are created through `eMutableFormat`
+	static vk::Format get_storage_format(Texture::Format format) noexcept
+	{
+		switch (format)
+		{
+		case Texture::Format::Rgba8Unorm:
+			return vk::Format::eR8G8B8A8Unorm;
+		case Texture::Format::BC3:
+			return vk::Format::eBc3UnormBlock;
+		case Texture::Format::BC7:
+			return vk::Format::eBc7UnormBlock;
+		case Texture::Format::Rg8Unorm:
+			return vk::Format::eR8G8Unorm;
+		case Texture::Format::Rg16Unorm:
+			return vk::Format::eR16G16Unorm;
+		case Texture::Format::BC5:
+			return vk::Format::eBc5UnormBlock;
+		case Texture::Format::ETC2:
+			return vk::Format::eEtc2R8G8B8A8UnormBlock;
+		case Texture::Format::EAC_RG11:
+			return vk::Format::eEacR11G11UnormBlock;
+		case Texture::Format::ASTC4x4:
+			return vk::Format::eAstc4x4UnormBlock;
+		default:
+			UNREACHABLE("Invalid format", format);
+		}
+	}
+
+	// Slice the data of each level of a baked texture
+	static std::expected<std::vector<vulkan::StaticResourceCreator::RawLevel>, Error> get_raw_levels(
+		const Texture::BakedView& baked
+	) noexcept
+	{
+		// Baked data may come from an external source (e.g. a cache file), verify before slicing
+		const bool levels_in_range =
+			std::ranges::all_of(baked.levels, [&baked](const Texture::BakedLevel& level) {
+				return level.offset <= baked.data.size() && level.size <= baked.data.size() - level.offset;
+			});
+		if (!levels_in_range) return Error("Invalid baked texture", "Level data out of range");
+
+		return baked.levels
+			| std::views::transform([&baked](const Texture::BakedLevel& level) {
+				   return vulkan::StaticResourceCreator::RawLevel{
+					   .extent = level.extent,
+					   .data = baked.data.subspan(level.offset, level.size)
+				   };
+			   })
+			| std::ranges::to<std::vector>();
+	}
+
+	std::expected<Texture, Error> Texture::upload(
+		const vulkan::Context& context,
+		vulkan::StaticResourceCreator& resource_creator,
+		const BakedView& baked,
+		vk::ImageUsageFlags usage
+	) noexcept
+	{
+		const auto trace = util::trace::Scope("Upload texture");
+
+		const auto raw_levels_result = get_raw_levels(baked);
+		if (!raw_levels_result) return raw_levels_result.error();
+
+		auto image_result = resource_creator.create_image_mipmap_raw(
+			context,
+			*raw_levels_result,
+			get_storage_format(baked.format),
+			usage,
+			vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageCreateFlagBits::eMutableFormat
+		);
+		if (!image_result) return image_result.error().forward("Create image failed");
+
+		return Texture{
+			.image = std::move(*image_result),
+			.format = baked.format,
+			.mipmap_levels = static_cast<uint32_t>(baked.levels.size()),
+			.min_alpha = baked.min_alpha
+		};
+	}
+
+	std::expected<vulkan::Image, Error> Texture::upload_array(
+		const vulkan::Context& context,
+		vulkan::StaticResourceCreator& resource_creator,
+		std::span<const BakedView> layers,
+		vk::ImageUsageFlags usage
+	) noexcept
+	{
+		const auto trace = util::trace::Scope("Upload texture array");
+
+		if (layers.empty()) return Error("No texture to upload");
+
+		const auto has_other_format = [format = layers.front().format](const BakedView& baked) {
+			return baked.format != format;
+		};
+		if (std::ranges::any_of(layers, has_other_format)) return Error("Texture formats of layers mismatch");
+
+		auto layer_levels_result = layers | std::views::transform(get_raw_levels) | Error::collect();
+		if (!layer_levels_result) return layer_levels_result.error();
+		const auto layer_levels = *layer_levels_result
+			| std::views::transform([](const auto& levels) {
+				  return std::span<const vulkan::StaticResourceCreator::RawLevel>(levels);
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto image_result = resource_creator.create_image_array_raw(
+			context,
+			layer_levels,
+			get_storage_format(layers.front().format),
+			usage,
+			vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageCreateFlagBits::eMutableFormat
+		);
+		if (!image_result) return image_result.error().forward("Create image failed");
+
+		return std::move(*image_result);
+	}
+
+	std::expected<Texture, Error> Texture::encode_and_upload(
+		const vulkan::Context& context,
+		vulkan::StaticResourceCreator& resource_creator,
+		const Unencoded& unencoded,
+		vk::ImageUsageFlags usage,
+		image::BC7Quality bc7_quality
+	) noexcept
+	{
+		// Blocks are encoded straight into staging memory, encoding and upload are a single step
+		const auto trace = util::trace::Scope("Encode and upload texture");
+
+		const auto mipmap_chain = unencoded.image.generate_mipmap(Unencoded::MIN_SIZE_LOG);
+		const auto format = get_bcn_format(unencoded.format);
+
+		const auto levels =
+			mipmap_chain
+			| std::views::transform([](const auto& level) {
+				  const auto block_dim = level.size / 4_u32;
+				  return vulkan::StaticResourceCreator::InPlaceLevel{
+					  .extent = level.size,
+					  .size = size_t(block_dim.x) * block_dim.y * sizeof(image::BCnBlock)
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+
+		// Blocks are encoded straight into the mapped staging memory, staging ranges are block-aligned
+		const auto encode_levels = [&](std::span<const std::span<std::byte>> destinations) {
+			for (const auto [level, destination] : std::views::zip(mipmap_chain, destinations))
+			{
+				const auto blocks = std::span(
+					reinterpret_cast<image::BCnBlock*>(destination.data()),
+					destination.size() / sizeof(image::BCnBlock)
+				);
+
+				const auto result =
+					image::BCnImage::encode_into(level, unencoded.format, blocks, bc7_quality);
+				if (!result) return result;
+			}
+			return std::expected<void, Error>();
+		};
+
+		auto image_result = resource_creator.create_image_mipmap_in_place(
+			context,
+			levels,
+			get_storage_format(format),
+			encode_levels,
+			usage,
+			vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageCreateFlagBits::eMutableFormat
+		);
+		if (!image_result) return image_result.error().forward("Create image failed");
+
+		return Texture{
+			.image = std::move(*image_result),
+			.format = format,
+			.mipmap_levels = static_cast<uint32_t>(levels.size()),
+			.min_alpha = unencoded.min_alpha
+		};
+	}
+
+	std::expected<Texture, Error> Texture::upload_prepared(
+		const vulkan::Context& context,
+		vulkan::StaticResourceCreator& resource_creator,
+		const Prepared& prepared,
+		vk::ImageUsageFlags usage,
+		image::BC7Quality bc7_quality
+	) noexcept
+	{
+		if (const auto* baked = std::get_if<Baked>(&prepared))
+			return upload(context, resource_creator, baked->view(), usage);
+
+		const auto& unencoded = std::get<Unencoded>(prepared);
+		return encode_and_upload(context, resource_creator, unencoded, usage, bc7_quality);
+	}
+
+	std::expected<Texture, Error> Texture::load_color_texture(
+		const vulkan::Context& context,
+		vulkan::StaticResourceCreator& resource_creator,
+		const model::Texture& texture,
+		ColorLoadStrategy load_strategy,
+		vk::ImageUsageFlags usage
+	) noexcept
+	{
+		auto prepared_result = prepare_color_texture(texture, load_strategy);
+		if (!prepared_result) return prepared_result.error();
+
+		return upload_prepared(context, resource_creator, *prepared_result, usage);
+	}
+
+	std::expected<Texture, Error> Texture::load_normal_texture(
+		const vulkan::Context& context,
+		vulkan::StaticResourceCreator& resource_creator,
+		const model::Texture& texture,
+		NormalLoadStrategy load_strategy,
+		vk::ImageUsageFlags usage
+	) noexcept
+	{
+		auto prepared_result = prepare_normal_texture(texture, load_strategy);
+		if (!prepared_result) return prepared_result.error();
+
+		return upload_prepared(context, resource_creator, *prepared_result, usage);
+	}
+
 	vk::Format Texture::Ref::get_format(Usage usage) noexcept
 	{
 		static const std::map<std::pair<Texture::Format, Usage>, vk::Format> format_map = {
@@ -295,6 +871,11 @@ namespace render
 			{{Texture::Format::Rg16Unorm, Usage::Normal},  vk::Format::eR16G16Unorm  },
 			{{Texture::Format::Rg8Unorm, Usage::Normal},   vk::Format::eR8G8Unorm    },
 			{{Texture::Format::BC5, Usage::Normal},        vk::Format::eBc5UnormBlock},
+			{{Texture::Format::ETC2, Usage::Color},        vk::Format::eEtc2R8G8B8A8SrgbBlock },
+			{{Texture::Format::ETC2, Usage::Linear},       vk::Format::eEtc2R8G8B8A8UnormBlock},
+			{{Texture::Format::EAC_RG11, Usage::Normal},   vk::Format::eEacR11G11UnormBlock   },
+			{{Texture::Format::ASTC4x4, Usage::Color},     vk::Format::eAstc4x4SrgbBlock      },
+			{{Texture::Format::ASTC4x4, Usage::Linear},    vk::Format::eAstc4x4UnormBlock     },
 		};
 
 		ASSERT(format_map.contains({format, usage}) && "Unsupported texture format and usage");
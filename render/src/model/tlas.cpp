@@ -1,7 +1,9 @@
 #include "render/model/tlas.hpp"
 #include "common/util/align.hpp"
 #include "common/util/error.hpp"
+#include "common/util/profile.hpp"
 #include "model/hierarchy.hpp"
+#include "model/material.hpp"
 #include "render/model/model.hpp"
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/alloc/buffer.hpp"
@@ -10,9 +12,16 @@
 #include "vulkan/util/command-runner.hpp"
 #include "vulkan/util/static-resource-creator.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
+#include <glm/common.hpp>
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/geometric.hpp>
 #include <ranges>
 #include <span>
 #include <utility>
@@ -24,44 +33,111 @@ namespace render
 {
 	namespace
 	{
-		std::expected<vulkan::ArrayBuffer<vk::AccelerationStructureInstanceKHR>, Error>
-		create_instance_buffer(
+		std::vector<vk::AccelerationStructureInstanceKHR> get_instances(
 			const vulkan::Context& context,
 			const Model& model,
-			std::span<const glm::mat4> transforms
+			std::span<const glm::mat4> transforms,
+			std::span<const Tlas::InstanceParam> instance_params
 		) noexcept
 		{
-			const auto get_tlas_instance =
-				[&model, &context, &transforms](const model::Hierarchy::Drawcall& drawcall) {
-					const auto blas_address = context.device.getAccelerationStructureAddressKHR(
-						{.accelerationStructure = model.blas_list->blas[drawcall.mesh_index]}
-					);
-
-					return vk::AccelerationStructureInstanceKHR{
-						.transform = vulkan::to<vk::TransformMatrixKHR>(transforms[drawcall.node_index]),
-						.instanceCustomIndex = model.mesh_list->mesh_ranges_array[drawcall.mesh_index].offset,
-						.mask = 0,
-						.instanceShaderBindingTableRecordOffset = 0,
-						.flags = {},
-						.accelerationStructureReference = blas_address
-					};
+			const auto get_tlas_instance = [&](const auto& indexed_drawcall) {
+				const auto& [instance_idx, drawcall] = indexed_drawcall;
+
+				const auto blas_address = context.device.getAccelerationStructureAddressKHR(
+					{.accelerationStructure = model.blas_list->get_mesh_blas(drawcall.mesh_index)}
+				);
+				const auto param = instance_params.empty()
+					? Tlas::get_default_param(model, drawcall.mesh_index)
+					: instance_params[instance_idx];
+
+				// HLOD proxies only stand in for rasterization, rays always hit the source nodes
+				const auto mask = model.scene_graph.is_hlod_proxy(drawcall.node_index) ? 0u : param.mask;
+
+				return vk::AccelerationStructureInstanceKHR{
+					.transform = vulkan::to<vk::TransformMatrixKHR>(transforms[drawcall.node_index]),
+					.instanceCustomIndex = model.mesh_list->mesh_ranges_array[drawcall.mesh_index].offset,
+					.mask = mask,
+					.instanceShaderBindingTableRecordOffset = param.sbt_offset,
+					.flags = {},
+					.accelerationStructureReference = blas_address
 				};
+			};
 
-			auto instances = std::vector(
+			return std::vector(
 				std::from_range,
-				model.hierarchy.get_renderables() | std::views::transform(get_tlas_instance)
+				model.hierarchy.get_renderables()
+					| std::views::enumerate
+					| std::views::transform(get_tlas_instance)
 			);
+		}
+
+		// Object space bounding sphere of a mesh, enclosing the bounds of its primitives
+		glm::vec4 get_mesh_bound(const Model& model, uint32_t mesh_index) noexcept
+		{
+			const auto range = model.mesh_list->mesh_ranges_array[mesh_index];
+			const auto attributes = model.mesh_list->primitive_attr_array.subspan(range.offset, range.count);
+			if (attributes.empty()) return glm::vec4(0.0f);
+
+			auto aabb_min = attributes.front().aabb_min;
+			auto aabb_max = attributes.front().aabb_max;
+			for (const auto& attribute : attributes)
+			{
+				aabb_min = glm::min(aabb_min, attribute.aabb_min);
+				aabb_max = glm::max(aabb_max, attribute.aabb_max);
+			}
+
+			return {(aabb_min + aabb_max) * 0.5f, glm::distance(aabb_min, aabb_max) * 0.5f};
+		}
+
+		// Distance from @p origin to the sphere @p bound transformed by @p transform, negative inside
+		float get_bound_distance(
+			const vk::TransformMatrixKHR& transform,
+			const glm::vec4& bound,
+			const glm::vec3& origin
+		) noexcept
+		{
+			const auto& m = transform.matrix;
+
+			glm::vec3 center;
+			float max_scale_squared = 0.0f;
+			for (const auto row : std::views::iota(0, 3))
+				center[row] = m[row][0] * bound.x + m[row][1] * bound.y + m[row][2] * bound.z + m[row][3];
+			for (const auto column : std::views::iota(0, 3))
+			{
+				const auto axis = glm::vec3(m[0][column], m[1][column], m[2][column]);
+				max_scale_squared = std::max(max_scale_squared, glm::dot(axis, axis));
+			}
 
+			return glm::distance(center, origin) - bound.w * std::sqrt(max_scale_squared);
+		}
+
+		// Mask of an instance beyond the radius of `Tlas::cull`, near bits moved to the far bits
+		uint8_t get_far_mask(uint8_t mask) noexcept
+		{
+			constexpr uint8_t near_bits = Tlas::OPAQUE_INSTANCE_MASK | Tlas::ALPHA_INSTANCE_MASK;
+			constexpr uint8_t far_bits = Tlas::FAR_OPAQUE_INSTANCE_MASK | Tlas::FAR_ALPHA_INSTANCE_MASK;
+			return (mask & ~(near_bits | far_bits)) | ((mask & near_bits) << 2);
+		}
+
+		std::expected<vulkan::ArrayBuffer<vk::AccelerationStructureInstanceKHR>, Error>
+		create_instance_buffer(
+			const vulkan::Context& context,
+			std::span<const vk::AccelerationStructureInstanceKHR> instances
+		) noexcept
+		{
 			auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
 			if (!resource_creator_result)
 				return resource_creator_result.error().forward("Create resource creator failed");
 			auto resource_creator = std::move(*resource_creator_result);
 
+			// Transfer destination for partial updates, see `Tlas::update`
 			auto instance_buffer_result = resource_creator.create_array_buffer(
 				context,
 				instances,
 				vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR
 					| vk::BufferUsageFlagBits::eShaderDeviceAddress
+					| vk::BufferUsageFlagBits::eTransferDst,
+				vulkan::MemoryCategory::AccelerationStructure
 			);
 			if (!instance_buffer_result)
 				return instance_buffer_result.error().forward("Create instance buffer failed");
@@ -72,20 +148,120 @@ namespace render
 
 			return instance_buffer;
 		}
+
+		vk::AccelerationStructureGeometryKHR get_instance_geometry(
+			const vulkan::Context& context,
+			vk::Buffer instance_buffer
+		) noexcept
+		{
+			return vk::AccelerationStructureGeometryKHR()
+				.setGeometryType(vk::GeometryTypeKHR::eInstances)
+				.setGeometry(
+					vk::AccelerationStructureGeometryInstancesDataKHR{
+						.data = context.device.getBufferAddress({.buffer = instance_buffer})
+					}
+				);
+		}
+	}
+
+	Tlas::InstanceParam Tlas::get_default_param(const Model& model, uint32_t mesh_index) noexcept
+	{
+		const auto range = model.mesh_list->mesh_ranges_array[mesh_index];
+		const auto is_opaque = [&model](const PrimitiveAttribute& attribute) {
+			return model.material_list.query_material_mode(attribute.material_index).alpha_mode
+				== model::AlphaMode::Opaque;
+		};
+		const auto attributes = model.mesh_list->primitive_attr_array.subspan(range.offset, range.count);
+		const bool opaque = std::ranges::all_of(attributes, is_opaque);
+
+		return {.mask = opaque ? OPAQUE_INSTANCE_MASK : ALPHA_INSTANCE_MASK, .sbt_offset = 0};
+	}
+
+	std::vector<Tlas::InstanceParam> Tlas::get_hit_record_params(
+		const Model& model,
+		uint32_t records_per_primitive
+	) noexcept
+	{
+		const auto renderables = model.hierarchy.get_renderables();
+		const auto offsets =
+			get_hit_record_offsets(renderables, model.mesh_list->mesh_ranges_array, records_per_primitive);
+
+		const auto get_param = [&model](const auto& drawcall_offset) {
+			const auto& [drawcall, offset] = drawcall_offset;
+			auto param = get_default_param(model, drawcall.mesh_index);
+			param.sbt_offset = offset;
+			return param;
+		};
+
+		return std::vector(
+			std::from_range,
+			std::views::zip(renderables, offsets) | std::views::transform(get_param)
+		);
+	}
+
+	std::vector<uint32_t> Tlas::get_hit_record_offsets(
+		std::span<const model::Hierarchy::Drawcall> renderables,
+		std::span<const PrimitiveIndexRange> mesh_ranges,
+		uint32_t records_per_primitive
+	) noexcept
+	{
+		const auto get_offset = [mesh_ranges, records_per_primitive](const auto& drawcall) {
+			return mesh_ranges[drawcall.mesh_index].offset * records_per_primitive;
+		};
+
+		return std::vector(std::from_range, renderables | std::views::transform(get_offset));
 	}
 
 	std::expected<Tlas, Error> Tlas::build(
 		const vulkan::Context& context,
 		const Model& model,
-		std::span<const glm::mat4> transforms
+		std::span<const glm::mat4> transforms,
+		std::span<const InstanceParam> instance_params
 	) noexcept
 	{
+		PROFILE_ZONE("Build TLAS");
+
 		/* Get TLAS instances */
 
-		auto instance_buffer_result = create_instance_buffer(context, model, transforms);
+		if (!instance_params.empty() && instance_params.size() != model.hierarchy.get_renderables().size())
+			return Error("Instance parameter count mismatches instance count");
+
+		auto instances = get_instances(context, model, transforms, instance_params);
+		auto instance_nodes =
+			model.hierarchy.get_renderables()
+			| std::views::transform(&model::Hierarchy::Drawcall::node_index)
+			| std::ranges::to<std::vector>();
+		auto instance_bounds =
+			model.hierarchy.get_renderables()
+			| std::views::transform([&model](const auto& drawcall) {
+				  return get_mesh_bound(model, drawcall.mesh_index);
+			  })
+			| std::ranges::to<std::vector>();
+		auto instance_masks =
+			instances
+			| std::views::transform([](const vk::AccelerationStructureInstanceKHR& instance) {
+				  return static_cast<uint8_t>(instance.mask);
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto instance_buffer_result = create_instance_buffer(context, instances);
 		if (!instance_buffer_result) return instance_buffer_result.error();
 		auto instance_buffer = std::move(*instance_buffer_result);
 
+		using Instance = vk::AccelerationStructureInstanceKHR;
+		auto staging_buffer_result = context.allocator.create_array_buffer<Instance>(
+			instances.size(),
+			vk::BufferUsageFlagBits::eTransferSrc,
+			vulkan::MemoryUsage::CpuToGpu,
+			vk::SharingMode::eExclusive,
+			{},
+			vulkan::MemoryCategory::Staging,
+			"TLAS Instance Staging"
+		);
+		if (!staging_buffer_result)
+			return staging_buffer_result.error().forward("Create instance staging buffer failed");
+		auto staging_buffer = std::move(*staging_buffer_result);
+
 		/* Create TLAS */
 
 		const auto as_properties =
@@ -97,24 +273,17 @@ namespace render
 				.get<vk::PhysicalDeviceAccelerationStructurePropertiesKHR>();
 		const auto scratch_alignment = as_properties.minAccelerationStructureScratchOffsetAlignment;
 
-		const auto geometry =
-			vk::AccelerationStructureGeometryKHR()
-				.setGeometryType(vk::GeometryTypeKHR::eInstances)
-				.setGeometry(
-					vk::AccelerationStructureGeometryInstancesDataKHR{
-						.data = context.device.getBufferAddress({.buffer = instance_buffer})
-					}
-				);
+		const auto geometry = get_instance_geometry(context, instance_buffer);
 
 		auto build_info =
 			vk::AccelerationStructureBuildGeometryInfoKHR()
 				.setType(vk::AccelerationStructureTypeKHR::eTopLevel)
-				.setFlags(vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace)
+				.setFlags(BUILD_FLAGS)
 				.setMode(vk::BuildAccelerationStructureModeKHR::eBuild)
 				.setGeometries(geometry);  // NOTE: incomplete at this moment
 
 		const auto build_range_info = vk::AccelerationStructureBuildRangeInfoKHR{
-			.primitiveCount = static_cast<uint32_t>(model.hierarchy.get_renderables().size()),
+			.primitiveCount = static_cast<uint32_t>(instances.size()),
 			.primitiveOffset = 0,
 			.firstVertex = 0,
 			.transformOffset = 0
@@ -123,17 +292,20 @@ namespace render
 		const auto build_sizes = context.device.getAccelerationStructureBuildSizesKHR(
 			vk::AccelerationStructureBuildTypeKHR::eDevice,
 			build_info,
-			{static_cast<uint32_t>(model.hierarchy.get_renderables().size())}
+			{static_cast<uint32_t>(instances.size())}
 		);
 
-		// Create scratch & as-storage buffer
+		// Create scratch & as-storage buffer. Scratch buffer is kept for later updates
+		const auto scratch_size = std::max(build_sizes.buildScratchSize, build_sizes.updateScratchSize);
 		auto scratch_buffer_result = context.allocator.create_buffer(
 			{
-				.size = build_sizes.buildScratchSize + scratch_alignment,
+				.size = scratch_size + scratch_alignment,
 				.usage =
 					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
 			},
-			vulkan::MemoryUsage::GpuOnly
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::AccelerationStructure,
+			"TLAS Scratch"
 		);
 		auto tlas_buffer_result = context.allocator.create_buffer(
 			{
@@ -141,7 +313,9 @@ namespace render
 				.usage = vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR
 					| vk::BufferUsageFlagBits::eShaderDeviceAddress,
 			},
-			vulkan::MemoryUsage::GpuOnly
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::AccelerationStructure,
+			"TLAS"
 		);
 
 		if (!scratch_buffer_result)
@@ -185,6 +359,224 @@ namespace render
 		);
 		if (!run_result) return run_result.error().forward("Build TLAS failed");
 
-		return Tlas(std::move(instance_buffer), std::move(tlas_buffer), std::move(tlas));
+		return Tlas(
+			std::move(instances),
+			std::move(instance_nodes),
+			std::move(instance_bounds),
+			std::move(instance_masks),
+			std::move(instance_buffer),
+			std::move(staging_buffer),
+			std::move(scratch_buffer),
+			std::move(tlas_buffer),
+			std::move(tlas),
+			scratch_alignment
+		);
+	}
+
+	std::expected<bool, Error> Tlas::update(
+		const vulkan::Context& context,
+		const vk::raii::CommandBuffer& command_buffer,
+		std::span<const glm::mat4> transforms
+	) noexcept
+	{
+		/* Write changed instances to staging buffer */
+
+		std::vector<vk::BufferCopy> copy_regions;
+
+		for (const auto [instance_idx, node_idx] : instance_nodes | std::views::enumerate)
+		{
+			auto& instance = instances[instance_idx];
+			const auto transform = vulkan::to<vk::TransformMatrixKHR>(transforms[node_idx]);
+			if (instance.transform == transform) continue;
+
+			instance.transform = transform;
+
+			if (const auto result = staging_buffer.upload({&instance, 1}, instance_idx); !result)
+				return result.error().forward("Upload instance to staging buffer failed");
+
+			const auto offset = instance_idx * sizeof(vk::AccelerationStructureInstanceKHR);
+			copy_regions.push_back({
+				.srcOffset = offset,
+				.dstOffset = offset,
+				.size = sizeof(vk::AccelerationStructureInstanceKHR),
+			});
+		}
+
+		if (copy_regions.empty()) return false;
+
+		record_build(context, command_buffer, copy_regions, vk::BuildAccelerationStructureModeKHR::eUpdate);
+
+		return true;
+	}
+
+	void Tlas::refit(
+		const vulkan::Context& context,
+		const vk::raii::CommandBuffer& command_buffer
+	) const noexcept
+	{
+		record_build(context, command_buffer, {}, vk::BuildAccelerationStructureModeKHR::eUpdate);
+	}
+
+	bool Tlas::cull(
+		const vulkan::Context& context,
+		const vk::raii::CommandBuffer& command_buffer,
+		const InstanceCull& cull
+	) noexcept
+	{
+		/* Reclassify instances */
+
+		std::vector<uint32_t> changed_instances;
+
+		for (const auto [instance_idx, instance] : instances | std::views::enumerate)
+		{
+			const auto distance =
+				get_bound_distance(instance.transform, instance_bounds[instance_idx], cull.origin);
+			const auto near_mask = instance_masks[instance_idx];
+			const auto mask = distance > cull.radius ? get_far_mask(near_mask) : near_mask;
+			if (instance.mask == mask) continue;
+
+			instance.mask = mask;
+			changed_instances.push_back(static_cast<uint32_t>(instance_idx));
+		}
+
+		if (changed_instances.empty()) return false;
+
+		/* Write changed instances inline */
+
+		// Previous builds read the instance buffer before it is overwritten
+		const auto pre_write_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+			.srcAccessMask = {},
+			.dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.dstAccessMask = {},
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(pre_write_barrier));
+
+		// `vkCmdUpdateBuffer` writes at most 65536 bytes at once
+		constexpr size_t max_run_length = 65536 / sizeof(vk::AccelerationStructureInstanceKHR);
+
+		for (size_t run_begin = 0; run_begin < changed_instances.size();)
+		{
+			const auto first = changed_instances[run_begin];
+
+			auto run_end = run_begin + 1;
+			while (run_end < changed_instances.size()
+				   && run_end - run_begin < max_run_length
+				   && changed_instances[run_end] == first + (run_end - run_begin))
+				run_end++;
+
+			command_buffer.updateBuffer<vk::AccelerationStructureInstanceKHR>(
+				instance_buffer,
+				first * sizeof(vk::AccelerationStructureInstanceKHR),
+				std::span(instances).subspan(first, run_end - run_begin)
+			);
+
+			run_begin = run_end;
+		}
+
+		record_build(context, command_buffer, {}, vk::BuildAccelerationStructureModeKHR::eUpdate);
+
+		return true;
+	}
+
+	std::expected<void, Error> Tlas::replace_blas(
+		const vulkan::Context& context,
+		const vk::raii::CommandBuffer& command_buffer,
+		const Model& model
+	) noexcept
+	{
+		/* Rewrite BLAS references of all instances */
+
+		for (auto&& [instance, drawcall] : std::views::zip(instances, model.hierarchy.get_renderables()))
+		{
+			instance.accelerationStructureReference = context.device.getAccelerationStructureAddressKHR(
+				{.accelerationStructure = model.blas_list->get_mesh_blas(drawcall.mesh_index)}
+			);
+		}
+
+		if (const auto result = staging_buffer.upload(instances, 0); !result)
+			return result.error().forward("Upload instances to staging buffer failed");
+
+		/* Rebuild, BLASes differ too much from the original ones for a refit */
+
+		const auto copy_region = vk::BufferCopy{
+			.srcOffset = 0,
+			.dstOffset = 0,
+			.size = instances.size() * sizeof(vk::AccelerationStructureInstanceKHR),
+		};
+		record_build(
+			context,
+			command_buffer,
+			{&copy_region, 1},
+			vk::BuildAccelerationStructureModeKHR::eBuild
+		);
+
+		return {};
+	}
+
+	void Tlas::record_build(
+		const vulkan::Context& context,
+		const vk::raii::CommandBuffer& command_buffer,
+		std::span<const vk::BufferCopy> copy_regions,
+		vk::BuildAccelerationStructureModeKHR mode
+	) const noexcept
+	{
+		/* Copy changed instances */
+
+		if (!copy_regions.empty())
+			command_buffer.copyBuffer(staging_buffer, instance_buffer, copy_regions);
+
+		// Instances are read by the build, TLAS and scratch are overwritten after previous users are done
+		const auto pre_build_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer
+				| vk::PipelineStageFlagBits2::eFragmentShader
+				| vk::PipelineStageFlagBits2::eComputeShader
+				| vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite
+				| vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+			.dstStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderRead
+				| vk::AccessFlagBits2::eAccelerationStructureReadKHR
+				| vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(pre_build_barrier));
+
+		/* Build TLAS */
+
+		const auto geometry = get_instance_geometry(context, instance_buffer);
+
+		// Source is ignored in `eBuild` mode
+		const auto build_info =
+			vk::AccelerationStructureBuildGeometryInfoKHR()
+				.setType(vk::AccelerationStructureTypeKHR::eTopLevel)
+				.setFlags(BUILD_FLAGS)
+				.setMode(mode)
+				.setSrcAccelerationStructure(tlas)
+				.setDstAccelerationStructure(tlas)
+				.setGeometries(geometry)
+				.setScratchData(
+					util::align_address(
+						context.device.getBufferAddress({.buffer = scratch_buffer}),
+						scratch_alignment
+					)
+				);
+
+		const auto build_range_info = vk::AccelerationStructureBuildRangeInfoKHR{
+			.primitiveCount = static_cast<uint32_t>(instances.size()),
+			.primitiveOffset = 0,
+			.firstVertex = 0,
+			.transformOffset = 0
+		};
+
+		command_buffer.buildAccelerationStructuresKHR({build_info}, {&build_range_info});
+
+		const auto post_build_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR,
+			.srcAccessMask = vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+			.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader
+				| vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eAccelerationStructureReadKHR,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(post_build_barrier));
 	}
 }
@@ -0,0 +1,402 @@
+#include "render/pipeline/ambient-occlusion.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/ambient-occlusion.hpp"
+#include "render/resource/deferred.hpp"
+#include "shader/ambient-occlusion.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto depth_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto normal_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto velocity_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 2,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto tlas_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 3,
+			.descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto camera_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 4,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto blue_noise_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 5,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto history_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 6,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto dst_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 7,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({
+			depth_binding,
+			normal_binding,
+			velocity_binding,
+			tlas_binding,
+			camera_binding,
+			blue_noise_binding,
+			history_binding,
+			dst_binding,
+		});
+	}
+
+	uint32_t AmbientOcclusionPipeline::get_rays_per_pixel(const Option& option, glm::u32vec2 extent) noexcept
+	{
+		const auto texel_count = std::max<uint64_t>(uint64_t(extent.x) * extent.y, 1);
+		const auto max_rays_per_pixel = std::max(option.max_rays_per_pixel, 1u);
+		const auto rays_per_pixel = std::min<uint64_t>(option.ray_budget / texel_count, max_rays_per_pixel);
+
+		return std::max(static_cast<uint32_t>(rays_per_pixel), 1u);
+	}
+
+	std::expected<AmbientOcclusionPipeline, Error> AmbientOcclusionPipeline::create(
+		const vulkan::Context& context
+	) noexcept
+	{
+		if (!context.feature.raytracing)
+			return Error("Missing raytracing feature", "Ambient occlusion requires raytracing feature");
+
+		auto shader_module_result = vulkan::create_shader(context.device, shader::ambient_occlusion);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto set_layouts = std::to_array<vk::DescriptorSetLayout>({descriptor_set_layout});
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(set_layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main");
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+		auto pipeline = std::move(*pipeline_result);
+
+		return AmbientOcclusionPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(pipeline)
+		);
+	}
+
+	std::expected<std::vector<AmbientOcclusionPipeline::ResourceSet>, Error> AmbientOcclusionPipeline::
+		create_resource_sets(const vulkan::Context& context, uint32_t count) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void AmbientOcclusionPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		uint64_t frame_index,
+		bool history_valid
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Ambient Occlusion");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& output = resource_set->output;
+
+		dispatch(
+			command_buffer,
+			resource_set,
+			PushConstant{
+				.ao_size = output.extent,
+				.full_size = resource_set->full_size,
+				.downscale = output.downscale,
+				.rays_per_pixel = get_rays_per_pixel(option, output.extent),
+				.radius = option.radius,
+				.instance_mask = option.instance_mask,
+				.frame_index = static_cast<uint32_t>(frame_index),
+				.history_valid = history_valid ? 1u : 0u,
+			}
+		);
+	}
+
+	void AmbientOcclusionPipeline::clear(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Ambient Occlusion Clear");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& output = resource_set->output;
+
+		dispatch(
+			command_buffer,
+			resource_set,
+			PushConstant{
+				.ao_size = output.extent,
+				.full_size = resource_set->full_size,
+				.downscale = output.downscale,
+				.rays_per_pixel = 0,
+				.radius = 0.0f,
+				.instance_mask = 0,
+				.frame_index = 0,
+				.history_valid = 0,
+			}
+		);
+	}
+
+	void AmbientOcclusionPipeline::dispatch(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const PushConstant& push_constant
+	) const noexcept
+	{
+		const auto& output = resource_set->output;
+
+		/* Pre-trace layout transition, previous content is discarded */
+
+		const auto pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask =
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = output.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		/* Trace */
+
+		const auto group_count = (push_constant.ao_size + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{*resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		/* Make the result visible to the lighting pass and to the next frame */
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask =
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = output.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	void AmbientOcclusionPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Tlas& tlas,
+		DeferredAttachment::View deferred,
+		AmbientOcclusionAttachment::View history,
+		AmbientOcclusionAttachment::View output,
+		vulkan::ElementBufferRef<Camera> camera,
+		vk::ImageView blue_noise
+	) noexcept
+	{
+		DEBUG_ASSERT(history.downscale == output.downscale, "History resolution mismatches output");
+
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto sampled_image_info = [](vk::ImageView view, vk::ImageLayout layout) {
+			return vk::DescriptorImageInfo{.imageView = view, .imageLayout = layout};
+		};
+
+		const auto depth_image_info =
+			sampled_image_info(deferred.depth.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto normal_image_info =
+			sampled_image_info(deferred.normal.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto velocity_image_info =
+			sampled_image_info(deferred.velocity.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto blue_noise_image_info =
+			sampled_image_info(blue_noise, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto history_image_info =
+			sampled_image_info(history.attachment.view, vk::ImageLayout::eGeneral);
+
+		const auto tlas_handle = static_cast<vk::AccelerationStructureKHR>(tlas);
+		const auto tlas_info =
+			vk::WriteDescriptorSetAccelerationStructureKHR().setAccelerationStructures(tlas_handle);
+
+		const auto camera_buf_info = vk::DescriptorBufferInfo{
+			.buffer = camera,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto dst_image_info = vk::DescriptorImageInfo{
+			.imageView = output.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		/*===== Write Descriptor Set =====*/
+
+		const auto sampled_image_write = [this](uint32_t binding, const auto& image_info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &image_info,
+			};
+		};
+
+		const auto write_descriptors = std::to_array({
+			sampled_image_write(0, depth_image_info),
+			sampled_image_write(1, normal_image_info),
+			sampled_image_write(2, velocity_image_info),
+			vk::WriteDescriptorSet{
+				.pNext = &tlas_info,
+				.dstSet = set,
+				.dstBinding = 3,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 4,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &camera_buf_info,
+			},
+			sampled_image_write(5, blue_noise_image_info),
+			sampled_image_write(6, history_image_info),
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 7,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &dst_image_info,
+			},
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{.full_size = deferred.extent, .output = output};
+	}
+}
@@ -0,0 +1,555 @@
+#include "render/pipeline/atmosphere.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/direct-light.hpp"
+#include "shader/atmosphere/multi-scattering.hpp"
+#include "shader/atmosphere/sky-view.hpp"
+#include "shader/atmosphere/transmittance.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/command-runner.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/geometric.hpp>
+#include <span>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	namespace
+	{
+		// Stages of the direct lighting, fragment or compute path, reading the LUTs
+		constexpr auto LIGHTING_STAGES =
+			vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+
+		// Sun of the sky view baked on creation, at the zenith
+		constexpr auto INITIAL_SUN = DirectLight{
+			.direction = glm::vec3(0.0f, 1.0f, 0.0f),
+			.light = glm::vec3(1.0f),
+			.sin_half_angle = 0.0f,
+		};
+
+		consteval vk::DescriptorSetLayoutBinding compute_binding(
+			uint32_t binding,
+			vk::DescriptorType type
+		) noexcept
+		{
+			return {
+				.binding = binding,
+				.descriptorType = type,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		}
+
+		constexpr auto TRANSMITTANCE_BINDINGS = std::to_array({
+			compute_binding(0, vk::DescriptorType::eStorageImage),
+		});
+
+		constexpr auto MULTI_SCATTERING_BINDINGS = std::to_array({
+			compute_binding(0, vk::DescriptorType::eCombinedImageSampler),
+			compute_binding(1, vk::DescriptorType::eStorageImage),
+		});
+
+		constexpr auto SKY_VIEW_BINDINGS = std::to_array({
+			compute_binding(0, vk::DescriptorType::eCombinedImageSampler),
+			compute_binding(1, vk::DescriptorType::eCombinedImageSampler),
+			compute_binding(2, vk::DescriptorType::eStorageImage),
+		});
+
+		struct Program
+		{
+			vk::raii::DescriptorSetLayout set_layout;
+			vk::raii::PipelineLayout pipeline_layout;
+			vk::raii::Pipeline pipeline;
+		};
+
+		[[nodiscard]]
+		std::expected<Program, Error> create_program(
+			const vulkan::Context& context,
+			std::span<const std::byte> code,
+			std::span<const vk::DescriptorSetLayoutBinding> bindings,
+			uint32_t push_constant_size
+		) noexcept
+		{
+			auto shader_result = vulkan::create_shader(context.device, code);
+			if (!shader_result) return shader_result.error().forward("Create shader module failed");
+			const auto shader_module = std::move(*shader_result);
+
+			auto set_layout_result = context.device.createDescriptorSetLayout(
+				vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+			);
+			if (!set_layout_result) return Error::from(set_layout_result);
+			auto set_layout = std::move(*set_layout_result);
+
+			const auto push_constant_range = vk::PushConstantRange{
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+				.offset = 0,
+				.size = push_constant_size
+			};
+			auto pipeline_layout_result = context.device.createPipelineLayout(
+				push_constant_size > 0
+					? vk::PipelineLayoutCreateInfo().setSetLayouts(*set_layout).setPushConstantRanges(
+						  push_constant_range
+					  )
+					: vk::PipelineLayoutCreateInfo().setSetLayouts(*set_layout)
+			);
+			if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+			auto pipeline_layout = std::move(*pipeline_layout_result);
+
+			const auto stage_info = vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eCompute,
+				.module = shader_module,
+				.pName = "main"
+			};
+			auto pipeline_result = context.device.createComputePipeline(
+				context.pipeline_cache,
+				vk::ComputePipelineCreateInfo{.stage = stage_info, .layout = pipeline_layout}
+			);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			auto pipeline = std::move(*pipeline_result);
+
+			return Program{
+				.set_layout = std::move(set_layout),
+				.pipeline_layout = std::move(pipeline_layout),
+				.pipeline = std::move(pipeline),
+			};
+		}
+
+		[[nodiscard]]
+		std::expected<vulkan::Image, Error> create_lut(
+			const vulkan::Context& context,
+			glm::u32vec2 size,
+			const char* debug_name
+		) noexcept
+		{
+			return context.allocator.create_image(
+				vk::ImageCreateInfo{
+					.imageType = vk::ImageType::e2D,
+					.format = AtmospherePipeline::LUT_FORMAT,
+					.extent = {.width = size.x, .height = size.y, .depth = 1},
+					.mipLevels = 1,
+					.arrayLayers = 1,
+					.samples = vk::SampleCountFlagBits::e1,
+					.tiling = vk::ImageTiling::eOptimal,
+					.usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+					.sharingMode = vk::SharingMode::eExclusive,
+				},
+				vulkan::MemoryUsage::GpuOnly,
+				vulkan::MemoryCategory::Texture,
+				debug_name
+			);
+		}
+
+		[[nodiscard]]
+		std::expected<vk::raii::ImageView, Error> create_lut_view(
+			const vulkan::Context& context,
+			vk::Image image
+		) noexcept
+		{
+			auto view_result = context.device.createImageView({
+				.image = image,
+				.viewType = vk::ImageViewType::e2D,
+				.format = AtmospherePipeline::LUT_FORMAT,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor),
+			});
+			if (!view_result) return Error::from(view_result);
+			return std::move(*view_result);
+		}
+
+		constexpr uint32_t group_count(uint32_t size, uint32_t workgroup_size) noexcept
+		{
+			return (size + workgroup_size - 1) / workgroup_size;
+		}
+	}
+
+	std::expected<AtmospherePipeline, Error> AtmospherePipeline::create(
+		const vulkan::Context& context
+	) noexcept
+	{
+		/*===== LUTs =====*/
+
+		auto transmittance_lut_result =
+			create_lut(context, TRANSMITTANCE_LUT_SIZE, "Atmosphere Transmittance");
+		auto multi_scattering_lut_result =
+			create_lut(context, MULTI_SCATTERING_LUT_SIZE, "Atmosphere Multi-scattering");
+		auto sky_view_lut_result = create_lut(context, SKY_VIEW_LUT_SIZE, "Atmosphere Sky View");
+
+		if (!transmittance_lut_result)
+			return transmittance_lut_result.error().forward("Create transmittance LUT failed");
+		if (!multi_scattering_lut_result)
+			return multi_scattering_lut_result.error().forward("Create multi-scattering LUT failed");
+		if (!sky_view_lut_result) return sky_view_lut_result.error().forward("Create sky-view LUT failed");
+
+		auto transmittance_lut = std::move(*transmittance_lut_result);
+		auto multi_scattering_lut = std::move(*multi_scattering_lut_result);
+		auto sky_view_lut = std::move(*sky_view_lut_result);
+
+		auto transmittance_view_result = create_lut_view(context, transmittance_lut);
+		auto multi_scattering_view_result = create_lut_view(context, multi_scattering_lut);
+		auto sky_view_view_result = create_lut_view(context, sky_view_lut);
+
+		if (!transmittance_view_result)
+			return transmittance_view_result.error().forward("Create view failed");
+		if (!multi_scattering_view_result)
+			return multi_scattering_view_result.error().forward("Create view failed");
+		if (!sky_view_view_result) return sky_view_view_result.error().forward("Create view failed");
+
+		auto transmittance_view = std::move(*transmittance_view_result);
+		auto multi_scattering_view = std::move(*multi_scattering_view_result);
+		auto sky_view_view = std::move(*sky_view_view_result);
+
+		constexpr auto sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eNearest,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = 0.0f,
+		};
+		auto sampler_result = context.device.createSampler(sampler_create_info);
+		if (!sampler_result) return Error::from(sampler_result);
+		auto sampler = std::move(*sampler_result);
+
+		/*===== Sky-view Program =====*/
+
+		auto program_result =
+			create_program(context, shader::atmosphere::sky_view, SKY_VIEW_BINDINGS, sizeof(PushConstant));
+		if (!program_result) return program_result.error().forward("Create sky-view program failed");
+		auto [descriptor_set_layout, pipeline_layout, pipeline] = std::move(*program_result);
+
+		const auto pool_sizes = vulkan::calc_pool_sizes(SKY_VIEW_BINDINGS, 1);
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(1)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::move(*descriptor_pool_result);
+
+		auto sets_result = context.device.allocateDescriptorSets(
+			vk::DescriptorSetAllocateInfo()
+				.setDescriptorPool(descriptor_pool)
+				.setSetLayouts(*descriptor_set_layout)
+		);
+		if (!sets_result) return Error::from(sets_result);
+		auto descriptor_set = std::move(sets_result->front());
+
+		const auto transmittance_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = transmittance_view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+		const auto multi_scattering_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = multi_scattering_view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+		const auto sky_view_info =
+			vk::DescriptorImageInfo{.imageView = sky_view_view, .imageLayout = vk::ImageLayout::eGeneral};
+
+		const auto writes = std::to_array<vk::WriteDescriptorSet>({
+			{
+				.dstSet = descriptor_set,
+				.dstBinding = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &transmittance_info,
+			},
+			{
+				.dstSet = descriptor_set,
+				.dstBinding = 1,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &multi_scattering_info,
+			},
+			{
+				.dstSet = descriptor_set,
+				.dstBinding = 2,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &sky_view_info,
+			},
+		});
+		context.device.updateDescriptorSets(writes, {});
+
+		auto atmosphere = AtmospherePipeline(
+			std::move(transmittance_lut),
+			std::move(transmittance_view),
+			std::move(multi_scattering_lut),
+			std::move(multi_scattering_view),
+			std::move(sky_view_lut),
+			std::move(sky_view_view),
+			std::move(sampler),
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(pipeline),
+			std::move(descriptor_pool),
+			std::move(descriptor_set)
+		);
+
+		if (const auto result = atmosphere.bake(context); !result)
+			return result.error().forward("Bake atmosphere LUTs failed");
+
+		return atmosphere;
+	}
+
+	std::expected<void, Error> AtmospherePipeline::bake(const vulkan::Context& context) const noexcept
+	{
+		/*===== Programs =====*/
+
+		auto transmittance_program_result =
+			create_program(context, shader::atmosphere::transmittance, TRANSMITTANCE_BINDINGS, 0);
+		auto multi_scattering_program_result =
+			create_program(context, shader::atmosphere::multi_scattering, MULTI_SCATTERING_BINDINGS, 0);
+
+		if (!transmittance_program_result)
+			return transmittance_program_result.error().forward("Create transmittance program failed");
+		if (!multi_scattering_program_result)
+			return multi_scattering_program_result.error().forward("Create multi-scattering program failed");
+
+		const auto transmittance_program = std::move(*transmittance_program_result);
+		const auto multi_scattering_program = std::move(*multi_scattering_program_result);
+
+		/*===== Descriptor Sets =====*/
+
+		const auto pool_sizes = std::to_array<vk::DescriptorPoolSize>({
+			{.type = vk::DescriptorType::eCombinedImageSampler, .descriptorCount = 1},
+			{.type = vk::DescriptorType::eStorageImage, .descriptorCount = 2},
+		});
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(2)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		const auto descriptor_pool = std::move(*descriptor_pool_result);
+
+		const auto set_layouts = std::to_array<vk::DescriptorSetLayout>({
+			transmittance_program.set_layout,
+			multi_scattering_program.set_layout,
+		});
+		auto sets_result = context.device.allocateDescriptorSets(
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(descriptor_pool).setSetLayouts(set_layouts)
+		);
+		if (!sets_result) return Error::from(sets_result);
+		const auto sets = std::move(*sets_result);
+
+		const auto& transmittance_set = sets[0];
+		const auto& multi_scattering_set = sets[1];
+
+		const auto transmittance_storage_info = vk::DescriptorImageInfo{
+			.imageView = transmittance_view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+		const auto transmittance_sampled_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = transmittance_view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+		const auto multi_scattering_storage_info = vk::DescriptorImageInfo{
+			.imageView = multi_scattering_view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto writes = std::to_array<vk::WriteDescriptorSet>({
+			{
+				.dstSet = transmittance_set,
+				.dstBinding = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &transmittance_storage_info,
+			},
+			{
+				.dstSet = multi_scattering_set,
+				.dstBinding = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &transmittance_sampled_info,
+			},
+			{
+				.dstSet = multi_scattering_set,
+				.dstBinding = 1,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &multi_scattering_storage_info,
+			},
+		});
+		context.device.updateDescriptorSets(writes, {});
+
+		/*===== Bake =====*/
+
+		auto runner_result = vulkan::CommandRunner::create(context);
+		if (!runner_result) return runner_result.error().forward("Create command runner failed");
+		const auto runner = std::move(*runner_result);
+
+		const auto record_bake = [&](const vk::raii::CommandBuffer& command_buffer) {
+			const auto range = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor);
+
+			const auto to_general = [&range](vk::Image image) {
+				return vk::ImageMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eNone,
+					.srcAccessMask = vk::AccessFlagBits2::eNone,
+					.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+					.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+					.oldLayout = vk::ImageLayout::eUndefined,
+					.newLayout = vk::ImageLayout::eGeneral,
+					.image = image,
+					.subresourceRange = range,
+				};
+			};
+			const auto to_read_only = [&range](vk::Image image, vk::PipelineStageFlags2 dst_stage) {
+				return vk::ImageMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+					.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+					.dstStageMask = dst_stage,
+					.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+					.oldLayout = vk::ImageLayout::eGeneral,
+					.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+					.image = image,
+					.subresourceRange = range,
+				};
+			};
+			const auto bind = [&command_buffer](const Program& program, const vk::raii::DescriptorSet& set) {
+				command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, program.pipeline);
+				command_buffer.bindDescriptorSets(
+					vk::PipelineBindPoint::eCompute,
+					program.pipeline_layout,
+					0,
+					{set},
+					{}
+				);
+			};
+
+			const auto general_barriers = std::to_array({
+				to_general(transmittance_lut),
+				to_general(multi_scattering_lut),
+				to_general(sky_view_lut),
+			});
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(general_barriers));
+
+			/* Transmittance */
+
+			bind(transmittance_program, transmittance_set);
+			command_buffer.dispatch(
+				group_count(TRANSMITTANCE_LUT_SIZE.x, WORKGROUP_SIZE),
+				group_count(TRANSMITTANCE_LUT_SIZE.y, WORKGROUP_SIZE),
+				1
+			);
+
+			// Read by all the other LUTs and by the lighting
+			const auto transmittance_barrier = to_read_only(
+				transmittance_lut,
+				vk::PipelineStageFlagBits2::eComputeShader | LIGHTING_STAGES
+			);
+			command_buffer.pipelineBarrier2(
+				vk::DependencyInfo().setImageMemoryBarriers(transmittance_barrier)
+			);
+
+			/* Multiple Scattering */
+
+			bind(multi_scattering_program, multi_scattering_set);
+			command_buffer.dispatch(
+				group_count(MULTI_SCATTERING_LUT_SIZE.x, WORKGROUP_SIZE),
+				group_count(MULTI_SCATTERING_LUT_SIZE.y, WORKGROUP_SIZE),
+				1
+			);
+
+			const auto multi_scattering_barrier =
+				to_read_only(multi_scattering_lut, vk::PipelineStageFlagBits2::eComputeShader);
+			command_buffer.pipelineBarrier2(
+				vk::DependencyInfo().setImageMemoryBarriers(multi_scattering_barrier)
+			);
+
+			/* Sky View */
+
+			compute(command_buffer, INITIAL_SUN);
+		};
+		if (const auto result = runner.run(context, record_bake); !result)
+			return result.error().forward("Run bake commands failed");
+
+		return {};
+	}
+
+	void AtmospherePipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const DirectLight& sun
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Atmosphere");
+
+		const auto range = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor);
+
+		// Overwrites the sky view read by the lighting of the previous frame
+		const auto pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = LIGHTING_STAGES,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.image = sky_view_lut,
+			.subresourceRange = range,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			pipeline_layout,
+			0,
+			{descriptor_set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			PushConstant{.sun_cos_zenith = glm::normalize(sun.direction).y}
+		);
+		command_buffer.dispatch(
+			group_count(SKY_VIEW_LUT_SIZE.x, WORKGROUP_SIZE),
+			group_count(SKY_VIEW_LUT_SIZE.y, WORKGROUP_SIZE),
+			1
+		);
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = LIGHTING_STAGES,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.image = sky_view_lut,
+			.subresourceRange = range,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	AtmospherePipeline::LutView AtmospherePipeline::get_lut_view() const noexcept
+	{
+		return {.transmittance = transmittance_view, .sky_view = sky_view_view};
+	}
+}
@@ -6,20 +6,23 @@
 #include "render/interface/auto-exposure.hpp"
 #include "render/resource/auto-exposure.hpp"
 #include "render/resource/hdr.hpp"
+#include "render/resource/luminance-pyramid.hpp"
 #include "shader/auto-exposure/clear.hpp"
+#include "shader/auto-exposure/histogram-wave.hpp"
 #include "shader/auto-exposure/histogram.hpp"
+#include "shader/auto-exposure/pyramid.hpp"
 #include "shader/auto-exposure/reduce.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
 #include "vulkan/util/shader.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
-#include <glm/ext/vector_uint3.hpp>
-#include <glm/ext/vector_uint3_sized.hpp>
 #include <glm/glm.hpp>
 #include <libassert/assert.hpp>
 #include <memory>
@@ -42,7 +45,52 @@ namespace render
 				.stageFlags = vk::ShaderStageFlagBits::eCompute
 			};
 
-			return std::to_array({histogram_binding});
+			constexpr auto pyramid_counter_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute
+			};
+
+			return std::to_array({histogram_binding, pyramid_counter_binding});
+		}
+
+		consteval auto get_pyramid_program_resource_bindings() noexcept
+		{
+			constexpr auto hdr_image_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 0,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute
+			};
+
+			constexpr auto levels_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.descriptorCount = LuminancePyramidAttachment::MAX_LEVELS,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute
+			};
+
+			constexpr auto group_top_level_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 2,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute
+			};
+
+			constexpr auto counter_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 3,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute
+			};
+
+			return std::to_array({
+				hdr_image_binding,
+				levels_binding,
+				group_top_level_binding,
+				counter_binding,
+			});
 		}
 
 		consteval auto get_histogram_program_resource_bindings() noexcept
@@ -129,19 +177,59 @@ namespace render
 			});
 		}
 
-		constexpr glm::uvec3 HISTOGRAM_WORKGROUP_SIZE = {16, 16, 1};
+		constexpr uint32_t HISTOGRAM_WORKGROUP_SIZE = 16;
+		constexpr uint32_t PYRAMID_GROUP_LEVELS = 6;  // Levels built by each pyramid workgroup
 
 		constexpr auto CLEAR_RESOURCE_BINDINGS = get_clear_program_resource_bindings();
+		constexpr auto PYRAMID_RESOURCE_BINDINGS = get_pyramid_program_resource_bindings();
 		constexpr auto HISTOGRAM_RESOURCE_BINDINGS = get_histogram_program_resource_bindings();
 		constexpr auto REDUCE_RESOURCE_BINDINGS = get_reduce_program_resource_bindings();
+
+		// Subgroup operations used by `histogram-wave.slang`
+		bool supports_wave_histogram(const vk::raii::PhysicalDevice& phy_device) noexcept
+		{
+			constexpr auto required_operations = vk::SubgroupFeatureFlagBits::eBasic
+				| vk::SubgroupFeatureFlagBits::eBallot
+				| vk::SubgroupFeatureFlagBits::eArithmetic;
+
+			const auto properties = phy_device.getProperties2<
+				vk::PhysicalDeviceProperties2,
+				vk::PhysicalDeviceSubgroupProperties
+			>();
+			const auto& subgroup_properties = properties.get<vk::PhysicalDeviceSubgroupProperties>();
+
+			return (subgroup_properties.supportedStages & vk::ShaderStageFlagBits::eCompute)
+				&& (subgroup_properties.supportedOperations & required_operations) == required_operations;
+		}
+
+		// Falls back to the top level for tiny HDR extents
+		uint32_t get_histogram_level(const LuminancePyramidAttachment::View& pyramid) noexcept
+		{
+			return std::min(AutoExposurePipeline::HISTOGRAM_LEVEL, pyramid.level_count - 1);
+		}
+
+		vk::ImageSubresourceRange get_pyramid_range(const LuminancePyramidAttachment::View& pyramid) noexcept
+		{
+			return vk::ImageSubresourceRange{
+				.aspectMask = vk::ImageAspectFlagBits::eColor,
+				.baseMipLevel = 0,
+				.levelCount = pyramid.level_count,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			};
+		}
 	}
 
 	void AutoExposurePipeline::compute(
 		const vk::raii::CommandBuffer& command_buffer,
-		const ResourceSet& resource_set
+		const ResourceSet& resource_set,
+		vk::PipelineStageFlags2 dst_stage_mask
 	) const noexcept
 	{
-		DEBUG_ASSERT(resource_set.image_size.has_value());
+		const auto label = vulkan::DebugLabel(command_buffer, "Auto Exposure");
+
+		DEBUG_ASSERT(resource_set.pyramid.has_value());
+		const auto& pyramid = *resource_set.pyramid;
 
 		/*===== Clear Histogram =====*/
 
@@ -163,13 +251,76 @@ namespace render
 			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
 			.dstAccessMask = vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite
 		};
-		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(clear_barrier));
+
+		// Previous content of the pyramid is discarded
+		const auto pyramid_pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask =
+				vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = pyramid.image,
+			.subresourceRange = get_pyramid_range(pyramid)
+		};
+
+		command_buffer.pipelineBarrier2(
+			vk::DependencyInfo()
+				.setMemoryBarriers(clear_barrier)
+				.setImageMemoryBarriers(pyramid_pre_barrier)
+		);
+
+		/*===== Luminance Pyramid =====*/
+
+		const auto pyramid_group_count = (pyramid.extent + PYRAMID_TILE_EXTENT - 1_u32) / PYRAMID_TILE_EXTENT;
+		const auto pyramid_push_constant = PyramidPushConstant{
+			.extent = pyramid.extent,
+			.level_count = pyramid.level_count,
+			.group_count = pyramid_group_count.x * pyramid_group_count.y,
+		};
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pyramid_pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			pyramid_pipeline_layout,
+			0,
+			{resource_set.pyramid_descriptor_set},
+			{}
+		);
+		command_buffer.pushConstants<PyramidPushConstant>(
+			*pyramid_pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			pyramid_push_constant
+		);
+		command_buffer.dispatch(pyramid_group_count.x, pyramid_group_count.y, 1);
+
+		/*===== Post-Pyramid Sync =====*/
+
+		const auto pyramid_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = pyramid.image,
+			.subresourceRange = get_pyramid_range(pyramid)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pyramid_barrier));
 
 		/*===== Histogram =====*/
 
+		const auto histogram_push_constant = HistogramPushConstant{
+			.input_size = pyramid.level_extent(get_histogram_level(pyramid)),
+		};
 		const auto histogram_group_count =
-			(glm::u32vec3(*resource_set.image_size, 1) + HISTOGRAM_WORKGROUP_SIZE - 1_u32)
-			/ HISTOGRAM_WORKGROUP_SIZE;
+			(histogram_push_constant.input_size + histogram_group_extent - 1_u32) / histogram_group_extent;
 
 		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, histogram_pipeline);
 		command_buffer.bindDescriptorSets(
@@ -179,7 +330,13 @@ namespace render
 			{resource_set.histogram_descriptor_set},
 			{}
 		);
-		command_buffer.dispatch(histogram_group_count.x, histogram_group_count.y, histogram_group_count.z);
+		command_buffer.pushConstants<HistogramPushConstant>(
+			*histogram_pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			histogram_push_constant
+		);
+		command_buffer.dispatch(histogram_group_count.x, histogram_group_count.y, 1);
 
 		/*===== Post-Histogram Sync =====*/
 
@@ -205,24 +362,36 @@ namespace render
 
 		/*===== Post-reduce Sync =====*/
 
+		if (dst_stage_mask == vk::PipelineStageFlagBits2::eNone) return;
+
 		const auto reduce_barrier = vk::MemoryBarrier2{
 			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
 			.srcAccessMask = vk::AccessFlagBits2::eShaderWrite,
-			.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
-			.dstAccessMask = vk::AccessFlagBits2::eShaderRead
+			.dstStageMask = dst_stage_mask,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eUniformRead
 		};
 		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(reduce_barrier));
 	}
 
 	std::expected<AutoExposurePipeline, Error> AutoExposurePipeline::create(
-		const vulkan::Context& context
+		const vulkan::Context& context,
+		uint32_t histogram_downscale
 	) noexcept
 	{
+		DEBUG_ASSERT(histogram_downscale >= 1);
+
+		const auto wave_histogram = supports_wave_histogram(context.phy_device);
+		const auto histogram_group_extent =
+			HISTOGRAM_WORKGROUP_SIZE * (wave_histogram ? histogram_downscale : 1);
+
 		/*===== Descriptor set layout =====*/
 
 		auto clear_resource_layout_result = context.device.createDescriptorSetLayout(
 			vk::DescriptorSetLayoutCreateInfo().setBindings(CLEAR_RESOURCE_BINDINGS)
 		);
+		auto pyramid_resource_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(PYRAMID_RESOURCE_BINDINGS)
+		);
 		auto histogram_resource_layout_result = context.device.createDescriptorSetLayout(
 			vk::DescriptorSetLayoutCreateInfo().setBindings(HISTOGRAM_RESOURCE_BINDINGS)
 		);
@@ -231,10 +400,12 @@ namespace render
 		);
 
 		if (!clear_resource_layout_result) return Error::from(clear_resource_layout_result);
+		if (!pyramid_resource_layout_result) return Error::from(pyramid_resource_layout_result);
 		if (!histogram_resource_layout_result) return Error::from(histogram_resource_layout_result);
 		if (!reduce_resource_layout_result) return Error::from(reduce_resource_layout_result);
 
 		auto clear_resource_layout = std::move(*clear_resource_layout_result);
+		auto pyramid_resource_layout = std::move(*pyramid_resource_layout_result);
 		auto histogram_resource_layout = std::move(*histogram_resource_layout_result);
 		auto reduce_resource_layout = std::move(*reduce_resource_layout_result);
 
@@ -242,6 +413,8 @@ namespace render
 
 		const auto clear_resource_layout_list =
 			std::to_array<vk::DescriptorSetLayout>({clear_resource_layout});
+		const auto pyramid_resource_layout_list =
+			std::to_array<vk::DescriptorSetLayout>({pyramid_resource_layout});
 		const auto histogram_resource_layout_list =
 			std::to_array<vk::DescriptorSetLayout>({histogram_resource_layout});
 		const auto reduce_resource_layout_list =
@@ -250,35 +423,61 @@ namespace render
 		auto clear_pipeline_layout_result = context.device.createPipelineLayout(
 			vk::PipelineLayoutCreateInfo().setSetLayouts(clear_resource_layout_list)
 		);
+		const auto pyramid_push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PyramidPushConstant)
+		};
+		const auto histogram_push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(HistogramPushConstant)
+		};
+
+		auto pyramid_pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(pyramid_resource_layout_list)
+				.setPushConstantRanges(pyramid_push_constant_range)
+		);
 		auto histogram_pipeline_layout_result = context.device.createPipelineLayout(
-			vk::PipelineLayoutCreateInfo().setSetLayouts(histogram_resource_layout_list)
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(histogram_resource_layout_list)
+				.setPushConstantRanges(histogram_push_constant_range)
 		);
 		auto reduce_pipeline_layout_result = context.device.createPipelineLayout(
 			vk::PipelineLayoutCreateInfo().setSetLayouts(reduce_resource_layout_list)
 		);
 		if (!clear_pipeline_layout_result) return Error::from(clear_pipeline_layout_result);
+		if (!pyramid_pipeline_layout_result) return Error::from(pyramid_pipeline_layout_result);
 		if (!histogram_pipeline_layout_result) return Error::from(histogram_pipeline_layout_result);
 		if (!reduce_pipeline_layout_result) return Error::from(reduce_pipeline_layout_result);
 
 		auto clear_pipeline_layout = std::move(*clear_pipeline_layout_result);
+		auto pyramid_pipeline_layout = std::move(*pyramid_pipeline_layout_result);
 		auto histogram_pipeline_layout = std::move(*histogram_pipeline_layout_result);
 		auto reduce_pipeline_layout = std::move(*reduce_pipeline_layout_result);
 
 		/*===== Shader modules =====*/
 
 		auto clear_shader_result = vulkan::create_shader(context.device, shader::auto_exposure::clear);
-		auto histogram_shader_result =
-			vulkan::create_shader(context.device, shader::auto_exposure::histogram);
+		auto pyramid_shader_result = vulkan::create_shader(context.device, shader::auto_exposure::pyramid);
+		auto histogram_shader_result = vulkan::create_shader(
+			context.device,
+			wave_histogram ? shader::auto_exposure::histogram_wave : shader::auto_exposure::histogram
+		);
 		auto reduce_shader_result = vulkan::create_shader(context.device, shader::auto_exposure::reduce);
 
 		if (!clear_shader_result)
 			return clear_shader_result.error().forward("Create shader for 'clear' program failed");
+		if (!pyramid_shader_result)
+			return pyramid_shader_result.error().forward("Create shader for 'pyramid' program failed");
 		if (!histogram_shader_result)
 			return histogram_shader_result.error().forward("Create shader for 'histogram' program failed");
 		if (!reduce_shader_result)
 			return reduce_shader_result.error().forward("Create shader for 'reduce' program failed");
 
 		auto clear_shader = std::move(*clear_shader_result);
+		auto pyramid_shader = std::move(*pyramid_shader_result);
 		auto histogram_shader = std::move(*histogram_shader_result);
 		auto reduce_shader = std::move(*reduce_shader_result);
 
@@ -289,10 +488,27 @@ namespace render
 			.module = clear_shader,
 			.pName = "main"
 		};
+		const auto pyramid_shader_stage_info = vk::PipelineShaderStageCreateInfo{
+			.stage = vk::ShaderStageFlagBits::eCompute,
+			.module = pyramid_shader,
+			.pName = "main"
+		};
+		// Ignored by the fallback histogram, which has no specialization constant
+		const auto histogram_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = 0,
+			.size = sizeof(uint32_t),
+		};
+		const auto histogram_specialization_info =
+			vk::SpecializationInfo()
+				.setMapEntries(histogram_spec_entry)
+				.setData<uint32_t>(histogram_downscale);
+
 		const auto histogram_shader_stage_info = vk::PipelineShaderStageCreateInfo{
 			.stage = vk::ShaderStageFlagBits::eCompute,
 			.module = histogram_shader,
-			.pName = "main"
+			.pName = "main",
+			.pSpecializationInfo = wave_histogram ? &histogram_specialization_info : nullptr
 		};
 		const auto reduce_shader_stage_info = vk::PipelineShaderStageCreateInfo{
 			.stage = vk::ShaderStageFlagBits::eCompute,
@@ -306,6 +522,10 @@ namespace render
 			.stage = clear_shader_stage_info,
 			.layout = clear_pipeline_layout,
 		};
+		const auto pyramid_pipeline_create_info = vk::ComputePipelineCreateInfo{
+			.stage = pyramid_shader_stage_info,
+			.layout = pyramid_pipeline_layout,
+		};
 		const auto histogram_pipeline_create_info = vk::ComputePipelineCreateInfo{
 			.stage = histogram_shader_stage_info,
 			.layout = histogram_pipeline_layout,
@@ -316,17 +536,21 @@ namespace render
 		};
 
 		auto clear_pipeline_result =
-			context.device.createComputePipeline(nullptr, clear_pipeline_create_info);
+			context.device.createComputePipeline(context.pipeline_cache, clear_pipeline_create_info);
+		auto pyramid_pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pyramid_pipeline_create_info);
 		auto histogram_pipeline_result =
-			context.device.createComputePipeline(nullptr, histogram_pipeline_create_info);
+			context.device.createComputePipeline(context.pipeline_cache, histogram_pipeline_create_info);
 		auto reduce_pipeline_result =
-			context.device.createComputePipeline(nullptr, reduce_pipeline_create_info);
+			context.device.createComputePipeline(context.pipeline_cache, reduce_pipeline_create_info);
 
 		if (!clear_pipeline_result) return Error::from(clear_pipeline_result);
+		if (!pyramid_pipeline_result) return Error::from(pyramid_pipeline_result);
 		if (!histogram_pipeline_result) return Error::from(histogram_pipeline_result);
 		if (!reduce_pipeline_result) return Error::from(reduce_pipeline_result);
 
 		auto clear_pipeline = std::move(*clear_pipeline_result);
+		auto pyramid_pipeline = std::move(*pyramid_pipeline_result);
 		auto histogram_pipeline = std::move(*histogram_pipeline_result);
 		auto reduce_pipeline = std::move(*reduce_pipeline_result);
 
@@ -366,16 +590,20 @@ namespace render
 
 		return AutoExposurePipeline(
 			std::move(clear_resource_layout),
+			std::move(pyramid_resource_layout),
 			std::move(histogram_resource_layout),
 			std::move(reduce_resource_layout),
 			std::move(clear_pipeline_layout),
+			std::move(pyramid_pipeline_layout),
 			std::move(histogram_pipeline_layout),
 			std::move(reduce_pipeline_layout),
 			std::move(clear_pipeline),
+			std::move(pyramid_pipeline),
 			std::move(histogram_pipeline),
 			std::move(reduce_pipeline),
 			std::move(input_sampler),
-			std::move(mask_sampler)
+			std::move(mask_sampler),
+			histogram_group_extent
 		);
 	}
 
@@ -384,6 +612,7 @@ namespace render
 	{
 		const auto bindings = util::array_concat(
 			CLEAR_RESOURCE_BINDINGS,
+			PYRAMID_RESOURCE_BINDINGS,
 			HISTOGRAM_RESOURCE_BINDINGS,
 			REDUCE_RESOURCE_BINDINGS
 		);
@@ -392,18 +621,23 @@ namespace render
 		auto descriptor_pool_result = context.device.createDescriptorPool(
 			vk::DescriptorPoolCreateInfo()
 				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
-				.setMaxSets(count * 3)
+				.setMaxSets(count * 4)
 				.setPoolSizes(pool_sizes)
 		);
 		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
 		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
 
 		const auto clear_layouts = std::vector(count, *clear_resource_layout);
+		const auto pyramid_layouts = std::vector(count, *pyramid_resource_layout);
 		const auto histogram_layouts = std::vector(count, *histogram_resource_layout);
 		const auto reduce_layouts = std::vector(count, *reduce_resource_layout);
 
 		const auto clear_set_alloc_info =
 			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(clear_layouts);
+		const auto pyramid_set_alloc_info =
+			vk::DescriptorSetAllocateInfo()
+				.setDescriptorPool(*descriptor_pool)
+				.setSetLayouts(pyramid_layouts);
 		const auto histogram_set_alloc_info =
 			vk::DescriptorSetAllocateInfo()
 				.setDescriptorPool(*descriptor_pool)
@@ -412,14 +646,17 @@ namespace render
 			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(reduce_layouts);
 
 		auto clear_sets_result = context.device.allocateDescriptorSets(clear_set_alloc_info);
+		auto pyramid_sets_result = context.device.allocateDescriptorSets(pyramid_set_alloc_info);
 		auto histogram_sets_result = context.device.allocateDescriptorSets(histogram_set_alloc_info);
 		auto reduce_sets_result = context.device.allocateDescriptorSets(reduce_set_alloc_info);
 
 		if (!clear_sets_result) return Error::from(clear_sets_result);
+		if (!pyramid_sets_result) return Error::from(pyramid_sets_result);
 		if (!histogram_sets_result) return Error::from(histogram_sets_result);
 		if (!reduce_sets_result) return Error::from(reduce_sets_result);
 
 		auto clear_sets = std::move(*clear_sets_result);
+		auto pyramid_sets = std::move(*pyramid_sets_result);
 		auto histogram_sets = std::move(*histogram_sets_result);
 		auto reduce_sets = std::move(*reduce_sets_result);
 
@@ -427,6 +664,7 @@ namespace render
 				   CTOR_LAMBDA(ResourceSet),
 				   std::views::repeat(descriptor_pool),
 				   clear_sets | std::views::as_rvalue,
+				   pyramid_sets | std::views::as_rvalue,
 				   histogram_sets | std::views::as_rvalue,
 				   reduce_sets | std::views::as_rvalue,
 				   std::views::repeat(*input_sampler),
@@ -441,10 +679,12 @@ namespace render
 		const AutoExposureResource& prev_resource,
 		vulkan::ElementBufferRef<ExposureParam> exposure_param,
 		HdrAttachment::View hdr,
+		LuminancePyramidAttachment::View pyramid,
 		vk::ImageView mask_image_view
 	) noexcept
 	{
-		this->image_size = hdr.extent;
+		DEBUG_ASSERT(hdr.extent == pyramid.extent);
+		this->pyramid = pyramid;
 
 		/*===== Resource Infos =====*/
 
@@ -473,11 +713,33 @@ namespace render
 			.offset = 0,
 			.range = vk::WholeSize
 		};
-		const auto input_image_info = vk::DescriptorImageInfo{
-			.sampler = input_sampler,
+		const auto pyramid_counter_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = resource->pyramid_counter_buffer,
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+		const auto hdr_image_info = vk::DescriptorImageInfo{
 			.imageView = hdr.attachment.view,
 			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
 		};
+		const auto input_image_info = vk::DescriptorImageInfo{
+			.sampler = input_sampler,
+			.imageView = pyramid.level_views[get_histogram_level(pyramid)],
+			.imageLayout = vk::ImageLayout::eGeneral
+		};
+
+		// Levels beyond the level count are never written, but must still be valid
+		std::array<vk::DescriptorImageInfo, LuminancePyramidAttachment::MAX_LEVELS> level_image_infos;
+		for (const auto level : std::views::iota(0_u32, LuminancePyramidAttachment::MAX_LEVELS))
+			level_image_infos[level] = vk::DescriptorImageInfo{
+				.imageView = pyramid.level_views[std::min(level, pyramid.level_count - 1)],
+				.imageLayout = vk::ImageLayout::eGeneral
+			};
+
+		const auto group_top_level_image_info = vk::DescriptorImageInfo{
+			.imageView = pyramid.level_views[std::min(PYRAMID_GROUP_LEVELS - 1, pyramid.level_count - 1)],
+			.imageLayout = vk::ImageLayout::eGeneral
+		};
 		const auto mask_image_info = vk::DescriptorImageInfo{
 			.sampler = mask_sampler,
 			.imageView = mask_image_view,
@@ -494,6 +756,47 @@ namespace render
 			.descriptorType = vk::DescriptorType::eStorageBuffer,
 			.pBufferInfo = &histogram_buffer_info
 		};
+		const auto clear_binding_1 = vk::WriteDescriptorSet{
+			.dstSet = clear_descriptor_set,
+			.dstBinding = 1,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.pBufferInfo = &pyramid_counter_buffer_info
+		};
+
+		const auto pyramid_binding_0 = vk::WriteDescriptorSet{
+			.dstSet = pyramid_descriptor_set,
+			.dstBinding = 0,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.pImageInfo = &hdr_image_info
+		};
+		const auto pyramid_binding_1 = vk::WriteDescriptorSet{
+			.dstSet = pyramid_descriptor_set,
+			.dstBinding = 1,
+			.dstArrayElement = 0,
+			.descriptorCount = LuminancePyramidAttachment::MAX_LEVELS,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.pImageInfo = level_image_infos.data()
+		};
+		const auto pyramid_binding_2 = vk::WriteDescriptorSet{
+			.dstSet = pyramid_descriptor_set,
+			.dstBinding = 2,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.pImageInfo = &group_top_level_image_info
+		};
+		const auto pyramid_binding_3 = vk::WriteDescriptorSet{
+			.dstSet = pyramid_descriptor_set,
+			.dstBinding = 3,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.pBufferInfo = &pyramid_counter_buffer_info
+		};
 
 		const auto histogram_binding_0 = vk::WriteDescriptorSet{
 			.dstSet = histogram_descriptor_set,
@@ -571,6 +874,12 @@ namespace render
 
 		const auto descriptor_writes = std::to_array({
 			clear_binding_0,
+			clear_binding_1,
+
+			pyramid_binding_0,
+			pyramid_binding_1,
+			pyramid_binding_2,
+			pyramid_binding_3,
 
 			histogram_binding_0,
 			histogram_binding_1,
@@ -584,6 +893,6 @@ namespace render
 			reduce_binding_4,
 		});
 
-		context.device.updateDescriptorSets(descriptor_writes, {});
+		descriptor_cache.update(context.device, descriptor_writes);
 	}
 }
@@ -0,0 +1,394 @@
+#include "render/pipeline/bloom.hpp"
+#include "common/number-literals.hpp"
+#include "common/util/error.hpp"
+#include "render/resource/bloom.hpp"
+#include "render/resource/taa.hpp"
+#include "shader/bloom/downsample.hpp"
+#include "shader/bloom/upsample.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto src_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto dst_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({src_binding, dst_binding});
+	}
+
+	// Downsample passes for each level, upsample passes for each level except the last
+	static constexpr uint32_t SETS_PER_RESOURCE_SET = BloomAttachment::MAX_LEVELS * 2 - 1;
+
+	static vk::ImageSubresourceRange get_bloom_range(uint32_t base_level, uint32_t level_count) noexcept
+	{
+		return vk::ImageSubresourceRange{
+			.aspectMask = vk::ImageAspectFlagBits::eColor,
+			.baseMipLevel = base_level,
+			.levelCount = level_count,
+			.baseArrayLayer = 0,
+			.layerCount = 1,
+		};
+	}
+
+	std::expected<BloomPipeline, Error> BloomPipeline::create(const vulkan::Context& context) noexcept
+	{
+		auto downsample_shader_result = vulkan::create_shader(context.device, shader::bloom::downsample);
+		auto upsample_shader_result = vulkan::create_shader(context.device, shader::bloom::upsample);
+		if (!downsample_shader_result)
+			return downsample_shader_result.error().forward("Create downsample shader module failed");
+		if (!upsample_shader_result)
+			return upsample_shader_result.error().forward("Create upsample shader module failed");
+		auto downsample_shader = std::move(*downsample_shader_result);
+		auto upsample_shader = std::move(*upsample_shader_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = std::max<uint32_t>(sizeof(DownsamplePushConstant), sizeof(UpsamplePushConstant))
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*descriptor_set_layout)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto create_pipeline = [&context, &pipeline_layout](const vk::raii::ShaderModule& module) {
+			const auto stage_create_info =
+				vk::PipelineShaderStageCreateInfo()
+					.setStage(vk::ShaderStageFlagBits::eCompute)
+					.setModule(module)
+					.setPName("main");
+			const auto pipeline_create_info =
+				vk::ComputePipelineCreateInfo().setStage(stage_create_info).setLayout(pipeline_layout);
+
+			return context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		};
+
+		auto downsample_pipeline_result = create_pipeline(downsample_shader);
+		if (!downsample_pipeline_result) return Error::from(downsample_pipeline_result);
+		auto downsample_pipeline = std::move(*downsample_pipeline_result);
+
+		auto upsample_pipeline_result = create_pipeline(upsample_shader);
+		if (!upsample_pipeline_result) return Error::from(upsample_pipeline_result);
+		auto upsample_pipeline = std::move(*upsample_pipeline_result);
+
+		constexpr auto sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eNearest,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = 0.0f,
+		};
+
+		auto sampler_result = context.device.createSampler(sampler_create_info);
+		if (!sampler_result) return Error::from(sampler_result);
+		auto sampler = std::move(*sampler_result);
+
+		return BloomPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(downsample_pipeline),
+			std::move(upsample_pipeline),
+			std::move(sampler)
+		);
+	}
+
+	std::expected<std::vector<BloomPipeline::ResourceSet>, Error> BloomPipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto set_count = count * SETS_PER_RESOURCE_SET;
+		const auto descriptor_pool_sizes = vulkan::calc_pool_sizes(bindings, set_count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(set_count)
+				.setPoolSizes(descriptor_pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(SETS_PER_RESOURCE_SET, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+
+		const auto create_resource_set_fn =
+			[this, &set_alloc_info, &context, &descriptor_pool] -> std::expected<ResourceSet, Error> {
+			auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+			if (!sets_result) return Error::from(sets_result);
+
+			auto& sets = *sets_result;
+
+			auto upsample_sets = sets
+				| std::views::drop(BloomAttachment::MAX_LEVELS)
+				| std::views::as_rvalue
+				| std::ranges::to<std::vector>();
+			sets.erase(sets.begin() + BloomAttachment::MAX_LEVELS, sets.end());
+
+			return ResourceSet(descriptor_pool, std::move(sets), std::move(upsample_sets), sampler);
+		};
+
+		return std::views::repeat(create_resource_set_fn, count)
+			| std::views::transform([](auto&& f) { return f(); })
+			| Error::collect();
+	}
+
+	void BloomPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Bloom");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& taa = resource_set->taa;
+		const auto& bloom = resource_set->bloom;
+
+		/* Wait for the TAA output, previous content of the chain is discarded */
+
+		const auto pre_barriers = std::to_array({
+			vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+				.oldLayout = vk::ImageLayout::eGeneral,
+				.newLayout = vk::ImageLayout::eGeneral,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = taa.attachment.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			},
+			vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+				.srcAccessMask = vk::AccessFlagBits2::eNone,
+				.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.oldLayout = vk::ImageLayout::eUndefined,
+				.newLayout = vk::ImageLayout::eGeneral,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = bloom.image,
+				.subresourceRange = get_bloom_range(0, bloom.level_count)
+			},
+		});
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+
+		// Make a level written by the last pass readable by the next ones
+		const auto level_barrier = [&command_buffer, &bloom](uint32_t level) {
+			const auto barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask =
+					vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageRead,
+				.oldLayout = vk::ImageLayout::eGeneral,
+				.newLayout = vk::ImageLayout::eGeneral,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = bloom.image,
+				.subresourceRange = get_bloom_range(level, 1)
+			};
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(barrier));
+		};
+
+		/* Downsample into each level */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, downsample_pipeline);
+
+		for (const auto level : std::views::iota(0_u32, bloom.level_count))
+		{
+			const auto push_constant = DownsamplePushConstant{
+				.src_size = level == 0 ? taa.extent : bloom.level_extent(level - 1),
+				.dst_size = bloom.level_extent(level),
+				.karis_average = level == 0 ? vk::True : vk::False,
+			};
+			const auto group_count = (push_constant.dst_size + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eCompute,
+				pipeline_layout,
+				0,
+				*resource_set.downsample_sets[level],
+				{}
+			);
+			command_buffer.pushConstants<DownsamplePushConstant>(
+				*pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				push_constant
+			);
+			command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+			level_barrier(level);
+		}
+
+		/* Upsample back to level 0 */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, upsample_pipeline);
+
+		for (const auto level : std::views::iota(0_u32, bloom.level_count - 1) | std::views::reverse)
+		{
+			const auto push_constant = UpsamplePushConstant{
+				.src_size = bloom.level_extent(level + 1),
+				.dst_size = bloom.level_extent(level),
+				.scale = level == 0 ? 1.0f / static_cast<float>(bloom.level_count) : 1.0f,
+			};
+			const auto group_count = (push_constant.dst_size + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eCompute,
+				pipeline_layout,
+				0,
+				*resource_set.upsample_sets[level],
+				{}
+			);
+			command_buffer.pushConstants<UpsamplePushConstant>(
+				*pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				push_constant
+			);
+			command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+			if (level > 0) level_barrier(level);
+		}
+
+		/* Make level 0 visible to the composite */
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = bloom.image,
+			.subresourceRange = get_bloom_range(0, 1)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	void BloomPipeline::discard(
+		const vk::raii::CommandBuffer& command_buffer,
+		BloomAttachment::View bloom
+	) noexcept
+	{
+		const auto barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = bloom.image,
+			.subresourceRange = get_bloom_range(0, bloom.level_count)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(barrier));
+	}
+
+	void BloomPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		TaaAttachment::View taa,
+		BloomAttachment::View bloom
+	) noexcept
+	{
+		DEBUG_ASSERT(bloom.extent == taa.extent);
+
+		const auto write_pass = [this, &context](
+									const vk::raii::DescriptorSet& set,
+									vk::ImageView src_view,
+									vk::ImageView dst_view
+								) {
+			const auto src_image_info = vk::DescriptorImageInfo{
+				.sampler = sampler,
+				.imageView = src_view,
+				.imageLayout = vk::ImageLayout::eGeneral
+			};
+
+			const auto dst_image_info =
+				vk::DescriptorImageInfo{.imageView = dst_view, .imageLayout = vk::ImageLayout::eGeneral};
+
+			const auto write_descriptor_sets = std::to_array({
+				vk::WriteDescriptorSet{
+					.dstSet = set,
+					.dstBinding = 0,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+					.pImageInfo = &src_image_info
+				},
+				vk::WriteDescriptorSet{
+					.dstSet = set,
+					.dstBinding = 1,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eStorageImage,
+					.pImageInfo = &dst_image_info
+				},
+			});
+
+			descriptor_cache.update(context.device, write_descriptor_sets);
+		};
+
+		for (const auto level : std::views::iota(0_u32, bloom.level_count))
+		{
+			// Level 0 is downsampled from the TAA attachment, others from the previous level
+			const auto src_view = level == 0 ? taa.attachment.view : bloom.level_views[level - 1];
+			write_pass(downsample_sets[level], src_view, bloom.level_views[level]);
+		}
+
+		for (const auto level : std::views::iota(0_u32, bloom.level_count - 1))
+			write_pass(upsample_sets[level], bloom.level_views[level + 1], bloom.level_views[level]);
+
+		resource = Resource{.taa = taa, .bloom = bloom};
+	}
+}
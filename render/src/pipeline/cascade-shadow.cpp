@@ -0,0 +1,863 @@
+#include "render/pipeline/cascade-shadow.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/model.hpp"
+#include "render/pipeline/util/constant.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/resource/cascade-shadow.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/shadow.hpp"
+#include "render/resource/transform.hpp"
+#include "render/util/per-render-state.hpp"
+#include "shader/cascade-shadow-resolve.hpp"
+#include "shader/cascade-shadow.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/container/host/linked-struct.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	// Position-only render states bind either the separate position stream or the interleaved vertices, see
+	// `MeshList::Ref::position_buffer`
+	static constexpr auto POSITION_ONLY_DYNSTATE = std::to_array({
+		vk::DynamicState::eViewport,
+		vk::DynamicState::eScissor,
+		vk::DynamicState::eVertexInputBindingStride,
+	});
+
+	static consteval auto get_render_descriptor_set_bindings() noexcept
+	{
+		constexpr auto primitive_attr_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
+		};
+
+		constexpr auto indirect_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eVertex
+		};
+
+		constexpr auto transform_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 2,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eVertex
+		};
+
+		constexpr auto view_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 3,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eVertex
+		};
+
+		return std::to_array({
+			primitive_attr_buffer_binding,
+			indirect_buffer_binding,
+			transform_buffer_binding,
+			view_buffer_binding,
+		});
+	}
+
+	static consteval auto get_resolve_descriptor_set_bindings() noexcept
+	{
+		constexpr auto depth_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto normal_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto cascade_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 2,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto camera_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 3,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto light_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 4,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto dst_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 5,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto view_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 6,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({
+			depth_binding,
+			normal_binding,
+			cascade_binding,
+			camera_binding,
+			light_binding,
+			dst_binding,
+			view_buffer_binding,
+		});
+	}
+
+	std::expected<vk::raii::Pipeline, Error> CascadeShadowPipeline::create_render_pipeline(
+		const vulkan::Context& context,
+		const vk::raii::PipelineLayout& pipeline_layout,
+		const vk::raii::ShaderModule& shader_module,
+		VertexFormat vertex_format,
+		bool alpha_mask_enabled,
+		bool double_sided
+	) noexcept
+	{
+		/*===== Shaders =====*/
+
+		// Opaque render states of full vertices only read positions
+		const bool position_only = vertex_format == VertexFormat::Full && !alpha_mask_enabled;
+		const char* vertex_entry = "main_vertex";
+		if (position_only)
+			vertex_entry = "main_vertex_position";
+		else if (vertex_format == VertexFormat::Packed)
+			vertex_entry = "main_vertex_packed";
+
+		const auto spec_data = SpecializationConstant{
+			.alpha_mask_enabled = alpha_mask_enabled ? vk::True : vk::False,
+		};
+		const auto alpha_mask_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = offsetof(SpecializationConstant, alpha_mask_enabled),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto specialization_info =
+			vk::SpecializationInfo()
+				.setMapEntries(alpha_mask_spec_entry)
+				.setData<SpecializationConstant>(spec_data);
+
+		const auto vertex_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
+			.stage = vk::ShaderStageFlagBits::eVertex,
+			.module = shader_module,
+			.pName = vertex_entry,
+			.pSpecializationInfo = &specialization_info
+		};
+		const auto fragment_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
+			.stage = vk::ShaderStageFlagBits::eFragment,
+			.module = shader_module,
+			.pName = "main_fragment",
+			.pSpecializationInfo = &specialization_info
+		};
+
+		// Opaque render states write depth only, without a fragment shader
+		const auto shader_stage_create_infos = std::to_array({
+			vertex_shader_stage_create_info,
+			fragment_shader_stage_create_info,
+		});
+		const auto shader_stages =
+			std::span(shader_stage_create_infos).first(alpha_mask_enabled ? 2 : 1);
+
+		/*===== Input =====*/
+
+		const auto vertex_input_binding_desc = vk::VertexInputBindingDescription{
+			.binding = 0,
+			.stride = static_cast<uint32_t>(vertex_stride(vertex_format)),
+			.inputRate = vk::VertexInputRate::eVertex
+		};
+
+		const auto vertex_input_attribute_descs = gbuffer::get_vertex_input_attribute_descs(vertex_format);
+
+		// Stride is dynamic, so that the position stream and the interleaved vertices share the pipeline
+		const auto position_attribute_desc = vk::VertexInputAttributeDescription{
+			.location = 0,
+			.binding = 0,
+			.format = vk::Format::eR32G32B32Sfloat,
+			.offset = 0
+		};
+		static_assert(offsetof(model::FullVertex, position) == 0);
+
+		const auto attribute_descs = position_only
+			? std::span<const vk::VertexInputAttributeDescription>(&position_attribute_desc, 1)
+			: std::span<const vk::VertexInputAttributeDescription>(vertex_input_attribute_descs);
+
+		const auto vertex_input_state_create_info =
+			vk::PipelineVertexInputStateCreateInfo()
+				.setVertexBindingDescriptions(vertex_input_binding_desc)
+				.setVertexAttributeDescriptions(attribute_descs);
+
+		/*===== Fixed Function =====*/
+
+		const auto rasterization_info = gbuffer::get_rasterization_state(double_sided);
+		const auto color_blend_info = vk::PipelineColorBlendStateCreateInfo();
+
+		/*===== Output =====*/
+
+		const auto pipeline_rendering_create_info =
+			vk::PipelineRenderingCreateInfo().setDepthAttachmentFormat(CascadeShadowAttachment::DEPTH_FORMAT);
+
+		/*===== Dynamic States =====*/
+
+		const auto dynamic_states = position_only
+			? std::span<const vk::DynamicState>(POSITION_ONLY_DYNSTATE)
+			: std::span<const vk::DynamicState>(constant::DYNAMIC_VIEWPORT_DYNSTATE);
+		const auto dynamic_state_info = vk::PipelineDynamicStateCreateInfo().setDynamicStates(dynamic_states);
+
+		/*===== Pipeline Creation =====*/
+
+		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
+			vk::GraphicsPipelineCreateInfo()
+				.setStages(shader_stages)
+				.setPVertexInputState(&vertex_input_state_create_info)
+				.setPInputAssemblyState(&constant::TRIANGLE_LIST_INPUT_ASSEMBLY_STATE)
+				.setPRasterizationState(&rasterization_info)
+				.setPMultisampleState(&constant::BASIC_MULTISAMPLE_STATE)
+				.setPDepthStencilState(&gbuffer::DEPTH_STENCIL_STATE)
+				.setPColorBlendState(&color_blend_info)
+				.setPViewportState(&constant::DYNAMIC_VIEWPORT_STATE)
+				.setPDynamicState(&dynamic_state_info)
+				.setLayout(pipeline_layout);
+		pipeline_create_info.push(pipeline_rendering_create_info);
+
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
+		if (!pipeline_result)
+		{
+			return Error::from(pipeline_result)
+				.forward(
+					"Create graphics pipeline failed",
+					std::format("alpha_mask_enabled={}, double_sided={}", alpha_mask_enabled, double_sided)
+				);
+		}
+
+		return std::move(*pipeline_result);
+	}
+
+	std::expected<CascadeShadowPipeline, Error> CascadeShadowPipeline::create(
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format
+	) noexcept
+	{
+		/*===== Render =====*/
+
+		auto render_shader_result = vulkan::create_shader(context.device, shader::cascade_shadow);
+		if (!render_shader_result) return render_shader_result.error().forward("Create shader module failed");
+		auto render_shader = std::move(*render_shader_result);
+
+		constexpr auto render_bindings = get_render_descriptor_set_bindings();
+		auto render_descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(render_bindings)
+		);
+		if (!render_descriptor_set_layout_result) return Error::from(render_descriptor_set_layout_result);
+		auto render_descriptor_set_layout = std::move(*render_descriptor_set_layout_result);
+
+		const auto render_set_layouts = std::to_array<const vk::DescriptorSetLayout>({
+			material_layout.layout,
+			render_descriptor_set_layout,
+		});
+		const auto render_push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eVertex,
+			.offset = 0,
+			.size = sizeof(RenderPushConstant)
+		};
+
+		auto render_pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(render_set_layouts)
+				.setPushConstantRanges(render_push_constant_range)
+		);
+		if (!render_pipeline_layout_result) return Error::from(render_pipeline_layout_result);
+		auto render_pipeline_layout = std::move(*render_pipeline_layout_result);
+
+		auto render_pipelines_result = PerRenderState<vk::raii::Pipeline>::from_ctor(
+			[&](model::AlphaMode alpha_mode, bool double_sided) {
+				return create_render_pipeline(
+					context,
+					render_pipeline_layout,
+					render_shader,
+					vertex_format,
+					alpha_mode == model::AlphaMode::Mask,
+					double_sided
+				);
+			}
+		);
+		if (!render_pipelines_result)
+			return render_pipelines_result.error().forward("Create pipelines failed");
+		auto render_pipelines = std::move(*render_pipelines_result);
+
+		/*===== Resolve =====*/
+
+		auto resolve_shader_result = vulkan::create_shader(context.device, shader::cascade_shadow_resolve);
+		if (!resolve_shader_result)
+			return resolve_shader_result.error().forward("Create resolve shader module failed");
+		auto resolve_shader = std::move(*resolve_shader_result);
+
+		constexpr auto resolve_bindings = get_resolve_descriptor_set_bindings();
+		auto resolve_descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(resolve_bindings)
+		);
+		if (!resolve_descriptor_set_layout_result) return Error::from(resolve_descriptor_set_layout_result);
+		auto resolve_descriptor_set_layout = std::move(*resolve_descriptor_set_layout_result);
+
+		const auto resolve_push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(ResolvePushConstant)
+		};
+
+		auto resolve_pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*resolve_descriptor_set_layout)
+				.setPushConstantRanges(resolve_push_constant_range)
+		);
+		if (!resolve_pipeline_layout_result) return Error::from(resolve_pipeline_layout_result);
+		auto resolve_pipeline_layout = std::move(*resolve_pipeline_layout_result);
+
+		const auto resolve_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(resolve_shader)
+				.setPName("main");
+		const auto resolve_pipeline_create_info =
+			vk::ComputePipelineCreateInfo()
+				.setStage(resolve_stage_create_info)
+				.setLayout(resolve_pipeline_layout);
+
+		auto resolve_pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, resolve_pipeline_create_info);
+		if (!resolve_pipeline_result) return Error::from(resolve_pipeline_result);
+		auto resolve_pipeline = std::move(*resolve_pipeline_result);
+
+		return CascadeShadowPipeline(
+			std::move(render_descriptor_set_layout),
+			std::move(render_pipeline_layout),
+			std::move(render_pipelines),
+			std::move(resolve_descriptor_set_layout),
+			std::move(resolve_pipeline_layout),
+			std::move(resolve_pipeline),
+			vertex_format
+		);
+	}
+
+	std::expected<std::vector<CascadeShadowPipeline::ResourceSet>, Error>
+	CascadeShadowPipeline::create_resource_sets(const vulkan::Context& context, uint32_t count) const noexcept
+	{
+		/*
+		 * NOTE: Each resource set contains 4 render descriptor sets for each material variant, and 1 resolve
+		 * descriptor set
+		 */
+
+		static constexpr auto RENDER_SETS_PER_RESOURCE_SET = 4;
+
+		constexpr auto render_bindings = get_render_descriptor_set_bindings();
+		constexpr auto resolve_bindings = get_resolve_descriptor_set_bindings();
+		auto pool_sizes = vulkan::calc_pool_sizes(render_bindings, count * RENDER_SETS_PER_RESOURCE_SET);
+		pool_sizes.append_range(vulkan::calc_pool_sizes(resolve_bindings, count));
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count * (RENDER_SETS_PER_RESOURCE_SET + 1))
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::to_array<vk::DescriptorSetLayout>({
+			*render_descriptor_set_layout,
+			*render_descriptor_set_layout,
+			*render_descriptor_set_layout,
+			*render_descriptor_set_layout,
+			*resolve_descriptor_set_layout,
+		});
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+
+		const auto create_resource_set_fn =
+			[&set_alloc_info, &context, &descriptor_pool] -> std::expected<ResourceSet, Error> {
+			auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+			if (!sets_result) return Error::from(sets_result);
+			auto sets = std::move(*sets_result);
+
+			return ResourceSet(
+				descriptor_pool,
+				{
+					.opaque_single_sided = std::move(sets[0]),
+					.opaque_double_sided = std::move(sets[1]),
+					.masked_single_sided = std::move(sets[2]),
+					.masked_double_sided = std::move(sets[3]),
+				},
+				std::move(sets[4])
+			);
+		};
+
+		return std::views::repeat(create_resource_set_fn, count)
+			| std::views::transform([](auto&& f) { return f(); })
+			| Error::collect();
+	}
+
+	void CascadeShadowPipeline::render(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		uint32_t dirty_mask
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Cascade Shadow");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
+
+		const auto& cascade_shadow = resource_set->cascade_shadow;
+		const auto resolution = cascade_shadow.resolution;
+
+		// Opaque render states of full vertices read positions only, see `create_render_pipeline`
+		const auto position_only_states =
+			PerRenderState<bool>::from_ctor([this](model::AlphaMode alpha_mode, bool) {
+				return vertex_format == VertexFormat::Full && alpha_mode != model::AlphaMode::Mask;
+			});
+
+		const auto layer_range = [](uint32_t layer) {
+			return vk::ImageSubresourceRange{
+				.aspectMask = vk::ImageAspectFlagBits::eDepth,
+				.baseMipLevel = 0,
+				.levelCount = 1,
+				.baseArrayLayer = layer,
+				.layerCount = 1,
+			};
+		};
+
+		for (const auto cascade : std::views::iota(0u, cascade_shadow.cascade_count))
+		{
+			if ((dirty_mask & (1u << cascade)) == 0) continue;
+
+			/* Pre-rendering layout transition, previous content is discarded */
+
+			const auto pre_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eNone,
+				.dstStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+					| vk::PipelineStageFlagBits2::eLateFragmentTests,
+				.dstAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+					| vk::AccessFlagBits2::eDepthStencilAttachmentRead,
+				.oldLayout = vk::ImageLayout::eUndefined,
+				.newLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = cascade_shadow.image,
+				.subresourceRange = layer_range(cascade)
+			};
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+			/* Begin rendering */
+
+			const auto depth_attachment_info = vk::RenderingAttachmentInfo{
+				.imageView = cascade_shadow.layer_views[cascade],
+				.imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+				.loadOp = vk::AttachmentLoadOp::eClear,
+				.storeOp = vk::AttachmentStoreOp::eStore,
+				.clearValue = vk::ClearDepthStencilValue{.depth = 0.0f, .stencil = 0}
+			};
+
+			const auto rendering_rect = vk::Rect2D{
+				.offset = vk::Offset2D{.x = 0, .y = 0},
+				.extent = vk::Extent2D{.width = resolution, .height = resolution}
+			};
+
+			command_buffer.beginRendering(
+				vk::RenderingInfo()
+					.setRenderArea(rendering_rect)
+					.setLayerCount(1)
+					.setPDepthAttachment(&depth_attachment_info)
+			);
+
+			command_buffer.setViewport(
+				0,
+				vk::Viewport{
+					.x = 0.0f,
+					.y = 0.0f,
+					.width = static_cast<float>(resolution),
+					.height = static_cast<float>(resolution),
+					.minDepth = 0.0f,
+					.maxDepth = 1.0f
+				}
+			);
+			command_buffer.setScissor(0, rendering_rect);
+
+			/* Draw */
+
+			command_buffer.bindIndexBuffer(
+				resource_set->index_buffer,
+				0,
+				index_type(resource_set->index_format)
+			);
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				*render_pipeline_layout,
+				0,
+				resource_set->material_descriptor_set,
+				{}
+			);
+			command_buffer.pushConstants<RenderPushConstant>(
+				*render_pipeline_layout,
+				vk::ShaderStageFlagBits::eVertex,
+				0,
+				RenderPushConstant{.cascade_index = cascade}
+			);
+
+			for (
+				const auto& [pipeline, position_only, descriptor_set, indirect_buffer, commands, counts] :
+				std::views::zip(
+					render_pipelines.all(),
+					position_only_states.as_array(),
+					resource_set.render_descriptor_set.all(),
+					resource_set->indirect_buffers.all(),
+					resource_set->command_buffers.all(),
+					resource_set->count_buffers.all()
+				)
+			)
+			{
+				const auto phase_capacity = IndirectResource::phase_capacity(indirect_buffer);
+				if (phase_capacity == 0) continue;
+
+				command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
+				if (position_only)
+					command_buffer.bindVertexBuffers2(
+						0,
+						resource_set->position_buffer,
+						{0},
+						{},
+						resource_set->position_stride
+					);
+				else
+					command_buffer.bindVertexBuffers(0, resource_set->vertex_buffer, {0});
+				command_buffer.bindDescriptorSets(
+					vk::PipelineBindPoint::eGraphics,
+					*render_pipeline_layout,
+					1,
+					*descriptor_set,
+					{}
+				);
+
+				// Instanced commands of the view are in the front of its range, see `IndirectResource`
+				const auto command_offset = IndirectResource::view_offset(indirect_buffer, cascade)
+					* sizeof(vk::DrawIndexedIndirectCommand);
+				const auto count_offset = IndirectResource::view_count_offset(cascade)
+					+ offsetof(IndirectCount, early_command_count);
+
+				command_buffer.drawIndexedIndirectCount(
+					commands,
+					command_offset,
+					counts,
+					count_offset,
+					phase_capacity,
+					sizeof(vk::DrawIndexedIndirectCommand)
+				);
+			}
+
+			command_buffer.endRendering();
+
+			/* Post-rendering layout transition */
+
+			const auto post_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+					| vk::PipelineStageFlagBits2::eLateFragmentTests,
+				.srcAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+				.oldLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+				.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = cascade_shadow.image,
+				.subresourceRange = layer_range(cascade)
+			};
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+		}
+	}
+
+	void CascadeShadowPipeline::resolve(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Cascade Shadow Resolve");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& shadow_mask = resource_set->shadow_mask;
+
+		/* Pre-resolve layout transition, previous content is discarded */
+
+		const auto pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = shadow_mask.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		/* Resolve */
+
+		const auto push_constant = ResolvePushConstant{
+			.mask_size = shadow_mask.extent,
+			.full_size = resource_set->full_size,
+			.downscale = shadow_mask.downscale,
+			.cascade_count = resource_set->cascade_shadow.cascade_count,
+			.cascade_resolution = resource_set->cascade_shadow.resolution,
+		};
+		const auto group_count = (push_constant.mask_size + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, resolve_pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*resolve_pipeline_layout,
+			0,
+			*resource_set.resolve_descriptor_set,
+			{}
+		);
+		command_buffer.pushConstants<ResolvePushConstant>(
+			*resolve_pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		/* Make the mask visible to the lighting pass */
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = shadow_mask.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	void CascadeShadowPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const TransformResource& transform,
+		const IndirectResource& indirect_resource,
+		CascadeShadowAttachment::View cascade_shadow,
+		DeferredAttachment::View deferred,
+		ShadowMaskAttachment::View shadow_mask,
+		vulkan::ElementBufferRef<Camera> camera,
+		vulkan::ElementBufferRef<DirectLight> direct_light
+	) noexcept
+	{
+		DEBUG_ASSERT(
+			indirect_resource.view_count() >= cascade_shadow.cascade_count,
+			"Indirect resource holds fewer views than cascades"
+		);
+
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto primitive_attr_buf_info = whole_buffer_info(model.mesh_list->primitive_attr_buffer);
+		const auto transform_buf_info = whole_buffer_info(transform->world_transform);
+		const auto view_buf_info = whole_buffer_info(indirect_resource.view_ref());
+		const auto camera_buf_info = whole_buffer_info(camera);
+		const auto direct_light_buf_info = whole_buffer_info(direct_light);
+
+		const auto view_indirect_buf_infos = indirect_resource.view_indirect_ref().map(
+			[&whole_buffer_info](const auto& buffer) { return whole_buffer_info(buffer); }
+		);
+
+		const auto depth_image_info = vk::DescriptorImageInfo{
+			.imageView = deferred.depth.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto normal_image_info = vk::DescriptorImageInfo{
+			.imageView = deferred.normal.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto cascade_image_info = vk::DescriptorImageInfo{
+			.imageView = cascade_shadow.array_view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto dst_image_info = vk::DescriptorImageInfo{
+			.imageView = shadow_mask.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		/*===== Write Render Descriptor Sets =====*/
+
+		for (
+			const auto& [descriptor_set, view_indirect_buf_info] :
+			std::views::zip(render_descriptor_set.all(), view_indirect_buf_infos.all())
+		)
+		{
+			const auto write_sets = std::to_array({
+				vk::WriteDescriptorSet{
+					.dstSet = descriptor_set,
+					.dstBinding = 0,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eStorageBuffer,
+					.pBufferInfo = &primitive_attr_buf_info,
+				},
+				vk::WriteDescriptorSet{
+					.dstSet = descriptor_set,
+					.dstBinding = 1,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eStorageBuffer,
+					.pBufferInfo = &view_indirect_buf_info,
+				},
+				vk::WriteDescriptorSet{
+					.dstSet = descriptor_set,
+					.dstBinding = 2,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eStorageBuffer,
+					.pBufferInfo = &transform_buf_info,
+				},
+				vk::WriteDescriptorSet{
+					.dstSet = descriptor_set,
+					.dstBinding = 3,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eStorageBuffer,
+					.pBufferInfo = &view_buf_info,
+				},
+			});
+
+			descriptor_cache.update(context.device, write_sets);
+		}
+
+		/*===== Write Resolve Descriptor Set =====*/
+
+		const auto resolve_write_sets = std::to_array({
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_descriptor_set,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &depth_image_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_descriptor_set,
+				.dstBinding = 1,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &normal_image_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_descriptor_set,
+				.dstBinding = 2,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &cascade_image_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_descriptor_set,
+				.dstBinding = 3,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &camera_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_descriptor_set,
+				.dstBinding = 4,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &direct_light_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_descriptor_set,
+				.dstBinding = 5,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &dst_image_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_descriptor_set,
+				.dstBinding = 6,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &view_buf_info,
+			},
+		});
+
+		descriptor_cache.update(context.device, resolve_write_sets);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{
+			.material_descriptor_set = model.material_list.get_descriptor_set(),
+
+			.vertex_buffer = model.mesh_list->vertex_buffer,
+			.vertex_format = model.mesh_list->vertex_format,
+			.position_buffer = model.mesh_list->position_buffer,
+			.position_stride = model.mesh_list->position_stride,
+			.index_buffer = model.mesh_list->index_buffer,
+			.index_format = model.mesh_list->index_format,
+			.indirect_buffers = indirect_resource.ref(),
+			.command_buffers = indirect_resource.view_command_ref(),
+			.count_buffers = indirect_resource.count_ref(),
+
+			.cascade_shadow = cascade_shadow,
+			.full_size = deferred.extent,
+			.shadow_mask = shadow_mask,
+		};
+	}
+}
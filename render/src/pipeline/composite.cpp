@@ -4,13 +4,21 @@
 #include "render/interface/auto-exposure.hpp"
 #include "render/pipeline/util/constant.hpp"
 #include "render/pipeline/util/fullscreen-pipeline.hpp"
-#include "render/resource/hdr.hpp"
+#include "render/resource/bloom.hpp"
+#include "render/resource/taa.hpp"
+#include "render/resource/transparent.hpp"
+#include "shader/composite-lut.hpp"
 #include "shader/composite.hpp"
+#include "vulkan/alloc/allocator.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/image.hpp"
 #include "vulkan/container/host/linked-struct.hpp"
 #include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
 #include "vulkan/numeric/glm.hpp"
 #include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/command-runner.hpp"
+#include "vulkan/util/debug-utils.hpp"
 #include "vulkan/util/shader.hpp"
 
 #include <array>
@@ -20,6 +28,7 @@
 #include <libassert/assert.hpp>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -45,15 +54,176 @@ namespace render
 				.stageFlags = vk::ShaderStageFlagBits::eFragment
 			};
 
-			return std::to_array({exposure_result_binding, hdr_image_binding});
+			constexpr auto transparent_accumulation_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 2,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment
+			};
+
+			constexpr auto transparent_revealage_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 3,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment
+			};
+
+			constexpr auto tonemap_lut_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 4,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment
+			};
+
+			constexpr auto bloom_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 5,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment
+			};
+
+			return std::to_array({
+				exposure_result_binding,
+				hdr_image_binding,
+				transparent_accumulation_binding,
+				transparent_revealage_binding,
+				tonemap_lut_binding,
+				bloom_binding,
+			});
 		}
 
 		constexpr auto RESOURCE_BINDINGS = get_resource_layout_bindings();
+
+		constexpr auto TONEMAP_LUT_FORMAT = vk::Format::eR16G16B16A16Sfloat;
+		constexpr uint32_t TONEMAP_LUT_SIZE = 32;  // Texels along each axis, see `internal/composite.slang`
+		constexpr uint32_t TONEMAP_LUT_WORKGROUP_SIZE = 4;
+
+		constexpr auto TONEMAP_LUT_BAKE_BINDING = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute
+		};
+
+		// Bake the tonemapping into the LUT and wait for it, leaving the LUT in `eShaderReadOnlyOptimal`
+		std::expected<void, Error> bake_tonemap_lut(
+			const vulkan::Context& context,
+			vk::Image lut,
+			vk::ImageView lut_view
+		) noexcept
+		{
+			auto shader_result = vulkan::create_shader(context.device, shader::composite_lut);
+			if (!shader_result) return shader_result.error().forward("Create LUT bake shader failed");
+			const auto shader_module = std::move(*shader_result);
+
+			auto set_layout_result = context.device.createDescriptorSetLayout(
+				vk::DescriptorSetLayoutCreateInfo().setBindings(TONEMAP_LUT_BAKE_BINDING)
+			);
+			if (!set_layout_result) return Error::from(set_layout_result);
+			const auto set_layout = std::move(*set_layout_result);
+
+			auto pipeline_layout_result = context.device.createPipelineLayout(
+				vk::PipelineLayoutCreateInfo().setSetLayouts(*set_layout)
+			);
+			if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+			const auto pipeline_layout = std::move(*pipeline_layout_result);
+
+			const auto stage_info = vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eCompute,
+				.module = shader_module,
+				.pName = "main"
+			};
+			auto pipeline_result = context.device.createComputePipeline(
+				context.pipeline_cache,
+				vk::ComputePipelineCreateInfo{.stage = stage_info, .layout = pipeline_layout}
+			);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			const auto pipeline = std::move(*pipeline_result);
+
+			const auto pool_sizes = vulkan::calc_pool_sizes(std::span(&TONEMAP_LUT_BAKE_BINDING, 1), 1);
+			auto descriptor_pool_result = context.device.createDescriptorPool(
+				vk::DescriptorPoolCreateInfo()
+					.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+					.setMaxSets(1)
+					.setPoolSizes(pool_sizes)
+			);
+			if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+			const auto descriptor_pool = std::move(*descriptor_pool_result);
+
+			auto sets_result = context.device.allocateDescriptorSets(
+				vk::DescriptorSetAllocateInfo().setDescriptorPool(descriptor_pool).setSetLayouts(*set_layout)
+			);
+			if (!sets_result) return Error::from(sets_result);
+			const auto descriptor_set = std::move(sets_result->front());
+
+			const auto lut_image_info =
+				vk::DescriptorImageInfo{.imageView = lut_view, .imageLayout = vk::ImageLayout::eGeneral};
+			const auto lut_write = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &lut_image_info
+			};
+			context.device.updateDescriptorSets(lut_write, {});
+
+			auto runner_result = vulkan::CommandRunner::create(context);
+			if (!runner_result) return runner_result.error().forward("Create command runner failed");
+			const auto runner = std::move(*runner_result);
+
+			const auto range = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor);
+
+			const auto record_bake = [&pipeline, &pipeline_layout, &descriptor_set, lut, &range](
+										 const vk::raii::CommandBuffer& command_buffer
+									 ) {
+				const auto pre_barrier = vk::ImageMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eNone,
+					.srcAccessMask = vk::AccessFlagBits2::eNone,
+					.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+					.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+					.oldLayout = vk::ImageLayout::eUndefined,
+					.newLayout = vk::ImageLayout::eGeneral,
+					.image = lut,
+					.subresourceRange = range,
+				};
+				command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+				constexpr auto group_count = TONEMAP_LUT_SIZE / TONEMAP_LUT_WORKGROUP_SIZE;
+
+				command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+				command_buffer.bindDescriptorSets(
+					vk::PipelineBindPoint::eCompute,
+					pipeline_layout,
+					0,
+					{descriptor_set},
+					{}
+				);
+				command_buffer.dispatch(group_count, group_count, group_count);
+
+				const auto post_barrier = vk::ImageMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+					.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+					.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+					.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+					.oldLayout = vk::ImageLayout::eGeneral,
+					.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+					.image = lut,
+					.subresourceRange = range,
+				};
+				command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+			};
+			if (const auto result = runner.run(context, record_bake); !result)
+				return result.error().forward("Bake tonemapping LUT failed");
+
+			return {};
+		}
 	}
 
 	std::expected<CompositePipeline, Error> CompositePipeline::create(
 		const vulkan::Context& context,
-		vk::Format target_format
+		vk::Format target_format,
+		TonemapMode mode
 	) noexcept
 	{
 		/*===== Descriptor Set Layout =====*/
@@ -67,8 +237,14 @@ namespace render
 		/*===== Pipeline Layout =====*/
 
 		const auto layouts = std::to_array<vk::DescriptorSetLayout>({descriptor_set_layout});
-		auto pipeline_layout_result =
-			context.device.createPipelineLayout(vk::PipelineLayoutCreateInfo().setSetLayouts(layouts));
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eFragment,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo().setSetLayouts(layouts).setPushConstantRanges(push_constant_range)
+		);
 		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
 		auto pipeline_layout = std::move(*pipeline_layout_result);
 
@@ -89,10 +265,22 @@ namespace render
 			.module = vertex_shader,
 			.pName = "main"
 		};
+		const auto use_tonemap_lut = vk::Bool32(mode == TonemapMode::Lut);
+		const auto use_tonemap_lut_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = 0,
+			.size = sizeof(vk::Bool32),
+		};
+		const auto fragment_specialization_info =
+			vk::SpecializationInfo()
+				.setMapEntries(use_tonemap_lut_entry)
+				.setData<vk::Bool32>(use_tonemap_lut);
+
 		const auto fragment_shader_info = vk::PipelineShaderStageCreateInfo{
 			.stage = vk::ShaderStageFlagBits::eFragment,
 			.module = fragment_shader,
-			.pName = "main"
+			.pName = "main",
+			.pSpecializationInfo = &fragment_specialization_info
 		};
 
 		const auto shader_stages = std::to_array({
@@ -122,7 +310,8 @@ namespace render
 				.setLayout(pipeline_layout);
 		pipeline_create_info.push(pipeline_rendering_create_info);
 
-		auto pipeline_result = context.device.createGraphicsPipeline(nullptr, pipeline_create_info.get());
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
 		if (!pipeline_result) return Error::from(pipeline_result);
 		auto pipeline = std::move(*pipeline_result);
 
@@ -146,11 +335,80 @@ namespace render
 		if (!sampler_result) return Error::from(sampler_result);
 		auto sampler = std::move(*sampler_result);
 
+		constexpr auto transparent_sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eNearest,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = 0.0f,
+		};
+
+		auto transparent_sampler_result = context.device.createSampler(transparent_sampler_create_info);
+		if (!transparent_sampler_result) return Error::from(transparent_sampler_result);
+		auto transparent_sampler = std::move(*transparent_sampler_result);
+
+		/*===== Tonemapping LUT =====*/
+
+		const auto tonemap_lut_create_info = vk::ImageCreateInfo{
+			.imageType = vk::ImageType::e3D,
+			.format = TONEMAP_LUT_FORMAT,
+			.extent = {.width = TONEMAP_LUT_SIZE, .height = TONEMAP_LUT_SIZE, .depth = TONEMAP_LUT_SIZE},
+			.mipLevels = 1,
+			.arrayLayers = 1,
+			.samples = vk::SampleCountFlagBits::e1,
+			.tiling = vk::ImageTiling::eOptimal,
+			.usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled
+		};
+		auto tonemap_lut_result = context.allocator.create_image(
+			tonemap_lut_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Other,
+			"Tonemap LUT"
+		);
+		if (!tonemap_lut_result) return tonemap_lut_result.error().forward("Create tonemapping LUT failed");
+		auto tonemap_lut = std::move(*tonemap_lut_result);
+
+		auto tonemap_lut_view_result = context.device.createImageView({
+			.image = tonemap_lut,
+			.viewType = vk::ImageViewType::e3D,
+			.format = TONEMAP_LUT_FORMAT,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor),
+		});
+		if (!tonemap_lut_view_result) return Error::from(tonemap_lut_view_result);
+		auto tonemap_lut_view = std::move(*tonemap_lut_view_result);
+
+		if (const auto result = bake_tonemap_lut(context, tonemap_lut, tonemap_lut_view); !result)
+			return result.error().forward("Bake tonemapping LUT failed");
+
+		constexpr auto tonemap_lut_sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eNearest,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = 0.0f,
+		};
+
+		auto tonemap_lut_sampler_result = context.device.createSampler(tonemap_lut_sampler_create_info);
+		if (!tonemap_lut_sampler_result) return Error::from(tonemap_lut_sampler_result);
+		auto tonemap_lut_sampler = std::move(*tonemap_lut_sampler_result);
+
 		return CompositePipeline(
 			std::move(descriptor_set_layout),
 			std::move(pipeline_layout),
 			std::move(pipeline),
-			std::move(sampler)
+			std::move(sampler),
+			std::move(transparent_sampler),
+			std::move(tonemap_lut),
+			std::move(tonemap_lut_view),
+			std::move(tonemap_lut_sampler)
 		);
 	}
 
@@ -181,16 +439,23 @@ namespace render
 				   CTOR_LAMBDA(ResourceSet),
 				   std::views::repeat(descriptor_pool),
 				   sets | std::views::as_rvalue,
-				   std::views::repeat(*input_sampler)
+				   std::views::repeat(*input_sampler),
+				   std::views::repeat(*transparent_sampler),
+				   std::views::repeat(*tonemap_lut_view),
+				   std::views::repeat(*tonemap_lut_sampler)
 			   )
 			| std::ranges::to<std::vector>();
 	}
 
 	void CompositePipeline::render(
 		const vk::raii::CommandBuffer& command_buffer,
-		const ResourceSet& resource_set
+		const ResourceSet& resource_set,
+		float bloom_intensity,
+		float sharpness
 	) const noexcept
 	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Composite");
+
 		DEBUG_ASSERT(resource_set.image_size.has_value());
 
 		command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
@@ -201,6 +466,16 @@ namespace render
 			{resource_set.descriptor_set},
 			{}
 		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eFragment,
+			0,
+			PushConstant{
+				.transparent_extent = resource_set.transparent_extent,
+				.bloom_intensity = bloom_intensity,
+				.sharpness = sharpness,
+			}
+		);
 
 		command_buffer.setViewport(
 			0,
@@ -226,10 +501,13 @@ namespace render
 	void CompositePipeline::ResourceSet::update(
 		const vulkan::Context& context,
 		vulkan::ElementBufferRef<ExposureResult> exposure_result,
-		HdrAttachment::View hdr
+		TaaAttachment::View taa,
+		TransparentAttachment::View transparent,
+		BloomAttachment::View bloom
 	) noexcept
 	{
-		this->image_size = hdr.extent;
+		this->image_size = taa.extent;
+		this->transparent_extent = transparent.extent;
 
 		const auto exposure_result_buffer_info = vk::DescriptorBufferInfo{
 			.buffer = exposure_result,
@@ -238,10 +516,31 @@ namespace render
 		};
 		const auto hdr_image_info = vk::DescriptorImageInfo{
 			.sampler = sampler,
-			.imageView = hdr.attachment.view,
+			.imageView = taa.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral
+		};
+		const auto transparent_accumulation_info = vk::DescriptorImageInfo{
+			.sampler = transparent_sampler,
+			.imageView = transparent.accumulation.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+		};
+		const auto transparent_revealage_info = vk::DescriptorImageInfo{
+			.sampler = transparent_sampler,
+			.imageView = transparent.revealage.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+		};
+		const auto tonemap_lut_info = vk::DescriptorImageInfo{
+			.sampler = tonemap_lut_sampler,
+			.imageView = tonemap_lut_view,
 			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
 		};
 
+		const auto bloom_info = vk::DescriptorImageInfo{
+			.sampler = transparent_sampler,
+			.imageView = bloom.level_views[0],
+			.imageLayout = vk::ImageLayout::eGeneral
+		};
+
 		const auto binding_0 = vk::WriteDescriptorSet{
 			.dstSet = descriptor_set,
 			.dstBinding = 0,
@@ -259,7 +558,42 @@ namespace render
 			.pImageInfo = &hdr_image_info
 		};
 
-		const auto writes = std::to_array({binding_0, binding_1});
-		context.device.updateDescriptorSets(writes, {});
+		const auto binding_2 = vk::WriteDescriptorSet{
+			.dstSet = descriptor_set,
+			.dstBinding = 2,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+			.pImageInfo = &transparent_accumulation_info
+		};
+		const auto binding_3 = vk::WriteDescriptorSet{
+			.dstSet = descriptor_set,
+			.dstBinding = 3,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+			.pImageInfo = &transparent_revealage_info
+		};
+
+		const auto binding_4 = vk::WriteDescriptorSet{
+			.dstSet = descriptor_set,
+			.dstBinding = 4,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+			.pImageInfo = &tonemap_lut_info
+		};
+
+		const auto binding_5 = vk::WriteDescriptorSet{
+			.dstSet = descriptor_set,
+			.dstBinding = 5,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+			.pImageInfo = &bloom_info
+		};
+
+		const auto writes = std::to_array({binding_0, binding_1, binding_2, binding_3, binding_4, binding_5});
+		descriptor_cache.update(context.device, writes);
 	}
 }
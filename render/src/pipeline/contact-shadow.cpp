@@ -0,0 +1,295 @@
+#include "render/pipeline/contact-shadow.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/shadow.hpp"
+#include "shader/contact-shadow.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto depth_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto camera_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto light_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 2,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto mask_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 3,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({
+			depth_binding,
+			camera_binding,
+			light_binding,
+			mask_binding,
+		});
+	}
+
+	std::expected<ContactShadowPipeline, Error> ContactShadowPipeline::create(
+		const vulkan::Context& context
+	) noexcept
+	{
+		auto shader_module_result = vulkan::create_shader(context.device, shader::contact_shadow);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*descriptor_set_layout)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main");
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+		auto pipeline = std::move(*pipeline_result);
+
+		return ContactShadowPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(pipeline)
+		);
+	}
+
+	std::expected<std::vector<ContactShadowPipeline::ResourceSet>, Error>
+	ContactShadowPipeline::create_resource_sets(const vulkan::Context& context, uint32_t count) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void ContactShadowPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		uint64_t frame_index
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Contact Shadow");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& shadow_mask = resource_set->shadow_mask;
+
+		/* Wait for the shadow pass, the mask is read and merged into */
+
+		const auto pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask =
+				vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = shadow_mask.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		/* March */
+
+		const auto push_constant = PushConstant{
+			.mask_size = shadow_mask.extent,
+			.full_size = resource_set->full_size,
+			.downscale = shadow_mask.downscale,
+			.step_count = option.step_count,
+			.max_distance = option.max_distance,
+			.thickness = option.thickness,
+			.frame_index = static_cast<uint32_t>(frame_index),
+		};
+		const auto group_count = (push_constant.mask_size + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{*resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		/* Make the mask visible to the lighting pass */
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = shadow_mask.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	void ContactShadowPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		DeferredAttachment::View deferred,
+		ShadowMaskAttachment::View shadow_mask,
+		vulkan::ElementBufferRef<Camera> camera,
+		vulkan::ElementBufferRef<DirectLight> direct_light
+	) noexcept
+	{
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto depth_image_info = vk::DescriptorImageInfo{
+			.imageView = deferred.depth.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto camera_buf_info = vk::DescriptorBufferInfo{
+			.buffer = camera,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto direct_light_buf_info = vk::DescriptorBufferInfo{
+			.buffer = direct_light,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto mask_image_info = vk::DescriptorImageInfo{
+			.imageView = shadow_mask.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		/*===== Write Descriptor Set =====*/
+
+		const auto write_descriptors = std::to_array({
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &depth_image_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 1,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &camera_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 2,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &direct_light_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 3,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &mask_image_info,
+			},
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{
+			.full_size = deferred.extent,
+			.shadow_mask = shadow_mask,
+		};
+	}
+}
@@ -0,0 +1,581 @@
+#include "render/pipeline/deferred-meshlet.hpp"
+#include "common/util/array.hpp"
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/model.hpp"
+#include "render/pipeline/util/constant.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/hiz.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "render/util/per-render-state.hpp"
+#include "shader/deferred-meshlet.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/container/host/linked-struct.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto storage_buffer_binding = [](uint32_t binding, vk::ShaderStageFlags stages) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = stages
+			};
+		};
+
+		constexpr auto task = vk::ShaderStageFlagBits::eTaskEXT;
+		constexpr auto mesh = vk::ShaderStageFlagBits::eMeshEXT;
+		constexpr auto fragment = vk::ShaderStageFlagBits::eFragment;
+
+		constexpr auto camera_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 3,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = task | mesh
+		};
+
+		constexpr auto curr_hiz_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 9,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = task
+		};
+
+		return std::to_array({
+			storage_buffer_binding(0, task | mesh | fragment),  // Primitive attributes
+			storage_buffer_binding(1, task),                    // Indirect drawcalls
+			storage_buffer_binding(2, task | mesh),             // Node transforms
+			camera_buffer_binding,
+			storage_buffer_binding(4, task),         // Draw counts
+			storage_buffer_binding(5, task | mesh),  // Meshlets
+			storage_buffer_binding(6, mesh),         // Meshlet vertices
+			storage_buffer_binding(7, mesh),         // Meshlet triangles
+			storage_buffer_binding(8, mesh),         // Vertices
+			curr_hiz_binding,
+			storage_buffer_binding(10, mesh),      // Previous node transforms
+			storage_buffer_binding(11, fragment),  // Material feedback
+		});
+	}
+
+	std::expected<vk::raii::Pipeline, Error> MeshletDeferredPipeline::create_pipeline(
+		const vulkan::Context& context,
+		const vk::raii::PipelineLayout& pipeline_layout,
+		const vk::raii::ShaderModule& shader_module,
+		VertexFormat vertex_format,
+		vk::Format hdr_format,
+		bool alpha_mask_enabled,
+		bool double_sided
+	) noexcept
+	{
+		/*===== Shaders =====*/
+
+		const auto spec_data = SpecializationConstant{
+			.alpha_mask_enabled = alpha_mask_enabled ? vk::True : vk::False,
+			.double_sided = double_sided ? vk::True : vk::False,
+			.packed_vertex = vertex_format == VertexFormat::Packed ? vk::True : vk::False
+		};
+
+		const auto alpha_mask_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = offsetof(SpecializationConstant, alpha_mask_enabled),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto double_sided_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 1,
+			.offset = offsetof(SpecializationConstant, double_sided),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto packed_vertex_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 2,
+			.offset = offsetof(SpecializationConstant, packed_vertex),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto spec_entries = std::to_array({
+			alpha_mask_spec_entry,
+			double_sided_spec_entry,
+			packed_vertex_spec_entry,
+		});
+
+		const auto specialization_info =
+			vk::SpecializationInfo().setMapEntries(spec_entries).setData<SpecializationConstant>(spec_data);
+
+		// Task shader skips cone culling for double-sided materials
+		const auto task_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
+			.stage = vk::ShaderStageFlagBits::eTaskEXT,
+			.module = shader_module,
+			.pName = "main_task",
+			.pSpecializationInfo = &specialization_info
+		};
+		const auto mesh_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
+			.stage = vk::ShaderStageFlagBits::eMeshEXT,
+			.module = shader_module,
+			.pName = "main_mesh",
+			.pSpecializationInfo = &specialization_info
+		};
+		const auto fragment_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
+			.stage = vk::ShaderStageFlagBits::eFragment,
+			.module = shader_module,
+			.pName = "main_fragment",
+			.pSpecializationInfo = &specialization_info
+		};
+
+		const auto shader_stage_create_infos = std::to_array({
+			task_shader_stage_create_info,
+			mesh_shader_stage_create_info,
+			fragment_shader_stage_create_info,
+		});
+
+		/*===== Fixed Function =====*/
+
+		const auto rasterization_info = gbuffer::get_rasterization_state(double_sided);
+		const auto color_blend_info =
+			vk::PipelineColorBlendStateCreateInfo().setAttachments(gbuffer::COLOR_BLEND_ATTACHMENT_STATES);
+
+		/*===== Output =====*/
+
+		const auto color_formats = gbuffer::get_color_formats(hdr_format);
+		const auto pipeline_rendering_create_info =
+			vk::PipelineRenderingCreateInfo()
+				.setColorAttachmentFormats(color_formats)
+				.setDepthAttachmentFormat(DeferredAttachment::DEPTH_FORMAT);
+
+		/*===== Dynamic States =====*/
+
+		const auto dynamic_state_info =
+			vk::PipelineDynamicStateCreateInfo().setDynamicStates(constant::DYNAMIC_VIEWPORT_DYNSTATE);
+
+		/*===== Pipeline Creation =====*/
+
+		// Vertex input and input assembly states are ignored by mesh pipelines
+		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
+			vk::GraphicsPipelineCreateInfo()
+				.setStages(shader_stage_create_infos)
+				.setPRasterizationState(&rasterization_info)
+				.setPMultisampleState(&constant::BASIC_MULTISAMPLE_STATE)
+				.setPDepthStencilState(&gbuffer::DEPTH_STENCIL_STATE)
+				.setPColorBlendState(&color_blend_info)
+				.setPViewportState(&constant::DYNAMIC_VIEWPORT_STATE)
+				.setPDynamicState(&dynamic_state_info)
+				.setLayout(pipeline_layout);
+		pipeline_create_info.push(pipeline_rendering_create_info);
+
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
+		if (!pipeline_result)
+		{
+			return Error::from(pipeline_result)
+				.forward(
+					"Create graphics pipeline failed",
+					std::format("alpha_mask_enabled={}, double_sided={}", alpha_mask_enabled, double_sided)
+				);
+		}
+
+		return std::move(*pipeline_result);
+	}
+
+	std::expected<MeshletDeferredPipeline, Error> MeshletDeferredPipeline::create(
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format,
+		vk::Format hdr_format
+	) noexcept
+	{
+		if (!context.feature.mesh_shader)
+			return Error(
+				"Missing mesh shader feature",
+				"Meshlet deferred pipeline requires mesh shader feature to be enabled"
+			);
+
+		const auto mesh_shader_properties =
+			context.phy_device
+				.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceMeshShaderPropertiesEXT>()
+				.get<vk::PhysicalDeviceMeshShaderPropertiesEXT>();
+		const auto task_limit = TaskLimit{
+			.max_group_count_x = mesh_shader_properties.maxTaskWorkGroupCount[0],
+			.max_group_count_y = mesh_shader_properties.maxTaskWorkGroupCount[1],
+			.max_group_total_count = mesh_shader_properties.maxTaskWorkGroupTotalCount,
+		};
+
+		auto shader_module_result = vulkan::create_shader(context.device, shader::deferred_meshlet);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result)
+			return Error::from(descriptor_set_layout_result).forward("Create descriptor set layout failed");
+		auto data_descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({
+			material_layout.layout,
+			data_descriptor_set_layout,
+		});
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eTaskEXT,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(set_layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result)
+			return Error::from(pipeline_layout_result).forward("Create pipeline layout failed");
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		auto pipelines_result = PerRenderState<vk::raii::Pipeline>::from_ctor(
+			[&](model::AlphaMode alpha_mode, bool double_sided) {
+				return create_pipeline(
+					context,
+					pipeline_layout,
+					shader_module,
+					vertex_format,
+					hdr_format,
+					alpha_mode == model::AlphaMode::Mask,
+					double_sided
+				);
+			}
+		);
+		if (!pipelines_result) return pipelines_result.error().forward("Create pipelines failed");
+		auto pipelines = std::move(*pipelines_result);
+
+		return MeshletDeferredPipeline(
+			std::move(data_descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(pipelines),
+			task_limit,
+			vertex_format
+		);
+	}
+
+	std::expected<std::vector<MeshletDeferredPipeline::ResourceSet>, Error>
+	MeshletDeferredPipeline::create_resource_sets(const vulkan::Context& context, uint32_t count)
+		const noexcept
+	{
+		/*
+		 * NOTE: Each resource set contains 4 descriptor sets for each material variant
+		 */
+
+		static constexpr auto SETS_PER_RESOURCE_SET = 4;
+
+		constexpr auto descriptor_bindings = get_descriptor_set_bindings();
+		const auto descriptor_pool_sizes =
+			vulkan::calc_pool_sizes(descriptor_bindings, count * SETS_PER_RESOURCE_SET);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count * SETS_PER_RESOURCE_SET)
+				.setPoolSizes(descriptor_pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(SETS_PER_RESOURCE_SET, *data_descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+
+		const auto create_resource_set_fn =
+			[&set_alloc_info, &context, &descriptor_pool] -> std::expected<ResourceSet, Error> {
+			auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+			if (!sets_result) return Error::from(sets_result);
+			auto sets = std::move(*sets_result);
+
+			return ResourceSet(
+				descriptor_pool,
+				{
+					.opaque_single_sided = std::move(sets[0]),
+					.opaque_double_sided = std::move(sets[1]),
+					.masked_single_sided = std::move(sets[2]),
+					.masked_double_sided = std::move(sets[3]),
+				}
+			);
+		};
+
+		return std::views::repeat(create_resource_set_fn, count)
+			| std::views::transform([](auto&& f) { return f(); })
+			| Error::collect();
+	}
+
+	void MeshletDeferredPipeline::render(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		DrawPhase phase
+	) const noexcept
+	{
+		const auto* label_name = phase == DrawPhase::Early ? "G-Buffer (Early)" : "G-Buffer (Late)";
+		const auto label = vulkan::DebugLabel(command_buffer, label_name);
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
+
+		/*===== Task Shader Inputs =====*/
+		// NOTE: Indirect pass only synchronizes with indirect reads and vertex/compute shaders
+
+		static constexpr auto get_buffer_barrier = [](vk::Buffer buffer) {
+			return vk::BufferMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eShaderWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eTaskShaderEXT,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.buffer = buffer,
+				.offset = 0,
+				.size = vk::WholeSize
+			};
+		};
+
+		const auto indirect_barriers = resource_set->indirect_buffers.as_ref_array()
+			| util::map_array([](auto&& buffer) { return get_buffer_barrier(buffer.get()); });
+		const auto count_barriers = resource_set->count_buffers.as_ref_array()
+			| util::map_array([](auto&& buffer) { return get_buffer_barrier(buffer.get()); });
+		const auto buffer_barriers = util::array_concat(indirect_barriers, count_barriers);
+
+		// Current HiZ is built by compute right before the late phase
+		const auto hiz_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eTaskShaderEXT,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = resource_set->curr_hiz,
+			.subresourceRange = vk::ImageSubresourceRange{
+				.aspectMask = vk::ImageAspectFlagBits::eColor,
+				.baseMipLevel = 0,
+				.levelCount = vk::RemainingMipLevels,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			}
+		};
+
+		auto dependency_info = vk::DependencyInfo().setBufferMemoryBarriers(buffer_barriers);
+		if (phase == DrawPhase::Late) dependency_info.setImageMemoryBarriers(hiz_barrier);
+		command_buffer.pipelineBarrier2(dependency_info);
+
+		/*===== Draw =====*/
+
+		gbuffer::begin_rendering(command_buffer, resource_set->attachment, phase);
+
+		const auto chunk_count =
+			(resource_set->max_meshlet_count + TASK_GROUP_SIZE - 1) / TASK_GROUP_SIZE;
+		DEBUG_ASSERT(chunk_count <= task_limit.max_group_count_x);
+
+		// Split the indirect entries into batches, so that each dispatch fits the task group count limits
+		const auto batch_size =
+			chunk_count == 0
+				? 0
+				: std::min(task_limit.max_group_count_y, task_limit.max_group_total_count / chunk_count);
+
+		// Materials are indexed from a single bindless set, bound once for all variants sharing the layout
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eGraphics,
+			*pipeline_layout,
+			0,
+			resource_set->material_descriptor_set,
+			{}
+		);
+
+		for (
+			const auto& [pipeline, data_descriptor_set, indirect_buffer] : std::views::zip(
+				pipelines.all(),
+				resource_set.data_descriptor_set.all(),
+				resource_set->indirect_buffers.all()
+			)
+		)
+		{
+			const auto phase_capacity =
+				static_cast<uint32_t>(IndirectResource::phase_capacity(indirect_buffer));
+			const auto phase_offset =
+				static_cast<uint32_t>(IndirectResource::phase_offset(indirect_buffer, phase));
+			if (phase_capacity == 0 || batch_size == 0) continue;
+
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
+
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				*pipeline_layout,
+				1,
+				*data_descriptor_set,
+				{}
+			);
+
+			// Actual draw count is read by the task shader, surplus groups exit early
+			for (uint32_t entry_base = 0; entry_base < phase_capacity; entry_base += batch_size)
+			{
+				const auto push_constant = PushConstant{
+					.curr_hiz_size = resource_set->curr_hiz_size,
+					.phase = phase == DrawPhase::Early ? 0u : 1u,
+					.entry_offset = phase_offset,
+					.entry_base = entry_base,
+				};
+
+				command_buffer.pushConstants<PushConstant>(
+					*pipeline_layout,
+					vk::ShaderStageFlagBits::eTaskEXT,
+					0,
+					push_constant
+				);
+
+				const auto entry_count = std::min(batch_size, phase_capacity - entry_base);
+				command_buffer.drawMeshTasksEXT(chunk_count, entry_count, 1);
+			}
+		}
+
+		gbuffer::end_rendering(command_buffer, resource_set->attachment);
+	}
+
+	void MeshletDeferredPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const TransformResource& transform,
+		const TransformResource& prev_transform,
+		const IndirectResource& indirect_resource,
+		DeferredAttachment::View deferred_attachment,
+		HdrAttachment::View hdr_attachment,
+		HizAttachment::View curr_hiz,
+		vulkan::ElementBufferRef<Camera> camera_param,
+		vulkan::ArrayBufferRef<uint32_t> material_feedback
+	) noexcept
+	{
+		/* Write descriptor sets */
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto primitive_attr_buffer_write = whole_buffer_info(model.mesh_list->primitive_attr_buffer);
+		const auto transform_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = transform->world_transform,
+			.offset = 0,
+			.range = transform->world_transform.size_vk(),
+		};
+		const auto prev_transform_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = prev_transform->world_transform,
+			.offset = 0,
+			.range = prev_transform->world_transform.size_vk(),
+		};
+		const auto camera_buffer_write = whole_buffer_info(camera_param);
+		const auto meshlet_buffer_write = whole_buffer_info(model.mesh_list->meshlet_buffer);
+		const auto meshlet_vertex_buffer_write = whole_buffer_info(model.mesh_list->meshlet_vertex_buffer);
+		const auto meshlet_triangle_buffer_write =
+			whole_buffer_info(model.mesh_list->meshlet_triangle_buffer);
+		const auto vertex_buffer_write = whole_buffer_info(model.mesh_list->vertex_buffer);
+		const auto material_feedback_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = material_feedback,
+			.offset = 0,
+			.range = material_feedback.size_vk(),
+		};
+
+		const auto curr_hiz_image_info = vk::DescriptorImageInfo{
+			.imageView = curr_hiz.full_view,
+			.imageLayout = vk::ImageLayout::eGeneral
+		};
+
+		for (
+			const auto& [descriptor_set, indirect_buffer, count_buffer] : std::views::zip(
+				data_descriptor_set.all(),
+				indirect_resource.ref().all(),
+				indirect_resource.count_ref().all()
+			)
+		)
+		{
+			const auto indirect_buffer_write = vk::DescriptorBufferInfo{
+				.buffer = indirect_buffer,
+				.offset = 0,
+				.range = indirect_buffer.size_vk(),
+			};
+			const auto count_buffer_write = whole_buffer_info(count_buffer);
+
+			// Binding 3 (camera) is the only uniform buffer
+			const auto buffer_write_set =
+				[&descriptor_set](uint32_t binding, const vk::DescriptorBufferInfo& info) {
+				return vk::WriteDescriptorSet{
+					.dstSet = descriptor_set,
+					.dstBinding = binding,
+					.dstArrayElement = 0,
+					.descriptorCount = 1,
+					.descriptorType = binding == 3 ? vk::DescriptorType::eUniformBuffer
+												   : vk::DescriptorType::eStorageBuffer,
+					.pBufferInfo = &info
+				};
+			};
+
+			const auto curr_hiz_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 9,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &curr_hiz_image_info
+			};
+
+			const auto write_sets = std::to_array({
+				buffer_write_set(0, primitive_attr_buffer_write),
+				buffer_write_set(1, indirect_buffer_write),
+				buffer_write_set(2, transform_buffer_write),
+				buffer_write_set(3, camera_buffer_write),
+				buffer_write_set(4, count_buffer_write),
+				buffer_write_set(5, meshlet_buffer_write),
+				buffer_write_set(6, meshlet_vertex_buffer_write),
+				buffer_write_set(7, meshlet_triangle_buffer_write),
+				buffer_write_set(8, vertex_buffer_write),
+				curr_hiz_write_set,
+				buffer_write_set(10, prev_transform_buffer_write),
+				buffer_write_set(11, material_feedback_buffer_write),
+			});
+
+			descriptor_cache.update(context.device, write_sets);
+		}
+
+		/* Store infos */
+
+		DEBUG_ASSERT(deferred_attachment.view_count == 1, "Multiview is only supported by `DeferredPipeline`");
+
+		resource = Resource{
+			.material_descriptor_set = model.material_list.get_descriptor_set(),
+
+			.indirect_buffers = indirect_resource.ref(),
+			.count_buffers = indirect_resource.count_ref(),
+			.max_meshlet_count = model.mesh_list->max_meshlet_count,
+			.vertex_format = model.mesh_list->vertex_format,
+
+			.curr_hiz = curr_hiz.image,
+			.curr_hiz_size = curr_hiz.extent,
+			.attachment = gbuffer::Attachment::from(deferred_attachment, hdr_attachment)
+		};
+	}
+}
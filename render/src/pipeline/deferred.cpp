@@ -1,27 +1,27 @@
 #include "render/pipeline/deferred.hpp"
-#include "common/util/array.hpp"
 #include "common/util/error.hpp"
 #include "model/material.hpp"
-#include "model/mesh.hpp"
 #include "render/interface/camera.hpp"
 #include "render/interface/direct-light.hpp"
 #include "render/interface/indirect-drawcall.hpp"
 #include "render/model/material.hpp"
 #include "render/model/model.hpp"
 #include "render/pipeline/util/constant.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/pipeline/util/variant-cache.hpp"
 #include "render/resource/deferred.hpp"
 #include "render/resource/hdr.hpp"
-#include "render/resource/host.hpp"
 #include "render/resource/indirect.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "render/resource/transform.hpp"
 #include "render/util/per-render-state.hpp"
 #include "shader/deferred.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/container/host/linked-struct.hpp"
 #include "vulkan/interface/attachment.hpp"
 #include "vulkan/interface/context.hpp"
-#include "vulkan/numeric/base-level.hpp"
-#include "vulkan/numeric/glm.hpp"
 #include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
 #include "vulkan/util/shader.hpp"
 
 #include <array>
@@ -29,10 +29,11 @@
 #include <cstdint>
 #include <expected>
 #include <format>
-#include <glm/ext/vector_uint2_sized.hpp>
 #include <libassert/assert.hpp>
 #include <memory>
+#include <optional>
 #include <ranges>
+#include <span>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -46,7 +47,7 @@ namespace render
 			.binding = 0,
 			.descriptorType = vk::DescriptorType::eStorageBuffer,
 			.descriptorCount = 1,
-			.stageFlags = vk::ShaderStageFlagBits::eFragment
+			.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
 		};
 
 		constexpr auto indirect_buffer_binding = vk::DescriptorSetLayoutBinding{
@@ -77,15 +78,74 @@ namespace render
 			.stageFlags = vk::ShaderStageFlagBits::eFragment
 		};
 
+		constexpr auto material_feedback_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 5,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eFragment
+		};
+
+		constexpr auto prev_transform_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 6,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eVertex
+		};
+
+		// Only read with `VertexFetch::Pull`, always written so that both variants share the layout
+		constexpr auto vertex_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 7,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eVertex
+		};
+
+		// Camera of view 1 in a multiview pass, always written so that both view counts share the layout
+		constexpr auto second_camera_buffer_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 8,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eVertex
+		};
+
 		return std::to_array({
 			primitive_attr_buffer_binding,
 			indirect_buffer_binding,
 			transform_buffer_binding,
 			camera_buffer_binding,
 			direct_light_param_binding,
+			material_feedback_binding,
+			prev_transform_buffer_binding,
+			vertex_buffer_binding,
+			second_camera_buffer_binding,
 		});
 	}
 
+	// Depth prepass writes depth only, color attachments are kept untouched
+	static constexpr auto NO_COLOR_WRITE_BLEND_STATE = vk::PipelineColorBlendAttachmentState{
+		.blendEnable = vk::False,
+		.colorWriteMask = vk::ColorComponentFlags(),
+	};
+
+	static constexpr auto NO_COLOR_WRITE_BLEND_STATES = std::to_array({
+		NO_COLOR_WRITE_BLEND_STATE,
+		NO_COLOR_WRITE_BLEND_STATE,
+		NO_COLOR_WRITE_BLEND_STATE,
+		NO_COLOR_WRITE_BLEND_STATE,
+		NO_COLOR_WRITE_BLEND_STATE,
+		NO_COLOR_WRITE_BLEND_STATE,
+	});
+	static_assert(NO_COLOR_WRITE_BLEND_STATES.size() == gbuffer::COLOR_FORMATS.size());
+
+	// Shading on top of the depth prepass, only the visible surface of each pixel passes
+	static constexpr auto DEPTH_EQUAL_STATE = vk::PipelineDepthStencilStateCreateInfo{
+		.depthTestEnable = vk::True,
+		.depthWriteEnable = vk::False,
+		.depthCompareOp = vk::CompareOp::eEqual,
+		.depthBoundsTestEnable = vk::False,
+		.stencilTestEnable = vk::False
+	};
+
 	static std::expected<vk::raii::DescriptorSetLayout, Error> create_descriptor_set_layout(
 		const vulkan::Context& context
 	) noexcept
@@ -116,57 +176,28 @@ namespace render
 		return std::move(*layout_result);
 	}
 
-	static constexpr auto get_vertex_input_attribute_descs() noexcept
-	{
-		constexpr auto vertex_position_attr_desc = vk::VertexInputAttributeDescription{
-			.location = 0,
-			.binding = 0,
-			.format = vk::Format::eR32G32B32Sfloat,
-			.offset = offsetof(model::FullVertex, position)
-		};
-
-		constexpr auto vertex_texcoord_attr_desc = vk::VertexInputAttributeDescription{
-			.location = 1,
-			.binding = 0,
-			.format = vk::Format::eR32G32Sfloat,
-			.offset = offsetof(model::FullVertex, texcoord)
-		};
-
-		constexpr auto vertex_normal_attr_desc = vk::VertexInputAttributeDescription{
-			.location = 2,
-			.binding = 0,
-			.format = vk::Format::eR32G32B32Sfloat,
-			.offset = offsetof(model::FullVertex, normal)
-		};
-
-		constexpr auto vertex_tangent_attr_desc = vk::VertexInputAttributeDescription{
-			.location = 3,
-			.binding = 0,
-			.format = vk::Format::eR32G32B32A32Sfloat,
-			.offset = offsetof(model::FullVertex, tangent)
-		};
-
-		return std::to_array({
-			vertex_position_attr_desc,
-			vertex_texcoord_attr_desc,
-			vertex_normal_attr_desc,
-			vertex_tangent_attr_desc,
-		});
-	}
-
 	std::expected<vk::raii::Pipeline, Error> DeferredPipeline::create_pipeline(
 		const vulkan::Context& context,
-		const vk::raii::PipelineLayout& pipeline_layout,
-		const vk::raii::ShaderModule& shader_module,
+		vk::PipelineLayout pipeline_layout,
+		vk::ShaderModule shader_module,
+		VertexFormat vertex_format,
+		VertexFetch vertex_fetch,
+		uint32_t view_count,
+		vk::Format hdr_format,
+		Pass pass,
 		bool alpha_mask_enabled,
 		bool double_sided
 	) noexcept
 	{
 		/*===== Shaders =====*/
 
+		// Alpha is already tested by the prepass, fragments discarded there fail the equal depth test
+		const bool alpha_test = alpha_mask_enabled && pass != Pass::DepthEqual;
+
 		const auto spec_data = SpecializationConstant{
-			.alpha_mask_enabled = alpha_mask_enabled ? vk::True : vk::False,
-			.double_sided = double_sided ? vk::True : vk::False
+			.alpha_mask_enabled = alpha_test ? vk::True : vk::False,
+			.double_sided = double_sided ? vk::True : vk::False,
+			.packed_vertex = vertex_format == VertexFormat::Packed ? vk::True : vk::False
 		};
 
 		const auto alpha_mask_spec_entry = vk::SpecializationMapEntry{
@@ -179,23 +210,47 @@ namespace render
 			.offset = offsetof(SpecializationConstant, double_sided),
 			.size = sizeof(vk::Bool32),
 		};
+		const auto packed_vertex_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 2,
+			.offset = offsetof(SpecializationConstant, packed_vertex),
+			.size = sizeof(vk::Bool32),
+		};
 		const auto spec_entries = std::to_array({
 			alpha_mask_spec_entry,
 			double_sided_spec_entry,
+			packed_vertex_spec_entry,
 		});
 
 		const auto specialization_info =
 			vk::SpecializationInfo().setMapEntries(spec_entries).setData<SpecializationConstant>(spec_data);
 
+		const auto* const vertex_entry = [vertex_format, vertex_fetch] {
+			if (vertex_fetch == VertexFetch::Pull) return "main_vertex_pull";
+			return vertex_format == VertexFormat::Packed ? "main_vertex_packed" : "main_vertex";
+		}();
+
 		const auto vertex_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
 			.stage = vk::ShaderStageFlagBits::eVertex,
 			.module = shader_module,
-			.pName = "main_vertex",
+			.pName = vertex_entry,
+			.pSpecializationInfo = &specialization_info
 		};
+		const auto* const fragment_entry = [pass] {
+			switch (pass)
+			{
+			case Pass::DepthPrepass:
+				return "main_fragment_depth";
+			case Pass::DepthEqual:
+				return "main_fragment_early";
+			default:
+				return "main_fragment";
+			}
+		}();
+
 		const auto fragment_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
 			.stage = vk::ShaderStageFlagBits::eFragment,
 			.module = shader_module,
-			.pName = "main_fragment",
+			.pName = fragment_entry,
 			.pSpecializationInfo = &specialization_info
 		};
 
@@ -204,63 +259,45 @@ namespace render
 			fragment_shader_stage_create_info,
 		});
 
+		// Opaque prepass writes depth only, without a fragment shader
+		const bool has_fragment_stage = pass != Pass::DepthPrepass || alpha_test;
+		const auto shader_stages = std::span(shader_stage_create_infos).first(has_fragment_stage ? 2 : 1);
+
 		/*===== Input =====*/
 
-		constexpr auto vertex_input_binding_desc = vk::VertexInputBindingDescription{
+		const auto vertex_input_binding_desc = vk::VertexInputBindingDescription{
 			.binding = 0,
-			.stride = sizeof(model::FullVertex),
+			.stride = static_cast<uint32_t>(vertex_stride(vertex_format)),
 			.inputRate = vk::VertexInputRate::eVertex
 		};
 
-		constexpr auto vertex_input_attribute_descs = get_vertex_input_attribute_descs();
+		const auto vertex_input_attribute_descs = gbuffer::get_vertex_input_attribute_descs(vertex_format);
 
+		// Pulled vertices are loaded in the vertex shader, leaving the vertex input state empty
 		const auto vertex_input_state_create_info =
-			vk::PipelineVertexInputStateCreateInfo()
-				.setVertexBindingDescriptions(vertex_input_binding_desc)
-				.setVertexAttributeDescriptions(vertex_input_attribute_descs);
+			vertex_fetch == VertexFetch::Pull
+			? vk::PipelineVertexInputStateCreateInfo()
+			: vk::PipelineVertexInputStateCreateInfo()
+				  .setVertexBindingDescriptions(vertex_input_binding_desc)
+				  .setVertexAttributeDescriptions(vertex_input_attribute_descs);
 
 		/*===== Fixed Function =====*/
 
-		const auto rasterization_info = vk::PipelineRasterizationStateCreateInfo{
-			.cullMode = double_sided ? vk::CullModeFlagBits::eNone : vk::CullModeFlagBits::eBack,
-			.lineWidth = 1.0
-		};
-
-		constexpr auto depth_stencil_info = vk::PipelineDepthStencilStateCreateInfo{
-			.depthTestEnable = vk::True,
-			.depthWriteEnable = vk::True,
-			.depthCompareOp = vk::CompareOp::eGreater,
-			.depthBoundsTestEnable = vk::False,
-			.stencilTestEnable = vk::False
-		};
-
-		const auto attachment_blend_state = vk::PipelineColorBlendAttachmentState{
-			.blendEnable = vk::False,
-			.colorWriteMask = vk::ColorComponentFlagBits::eR
-				| vk::ColorComponentFlagBits::eG
-				| vk::ColorComponentFlagBits::eB
-				| vk::ColorComponentFlagBits::eA
-		};
-		const auto color_attachment_blend_states = std::to_array({
-			attachment_blend_state,
-			attachment_blend_state,
-			attachment_blend_state,
-			attachment_blend_state,
-		});
+		const auto rasterization_info = gbuffer::get_rasterization_state(double_sided);
+		const auto color_blend_states = pass == Pass::DepthPrepass
+			? std::span<const vk::PipelineColorBlendAttachmentState>(NO_COLOR_WRITE_BLEND_STATES)
+			: std::span<const vk::PipelineColorBlendAttachmentState>(gbuffer::COLOR_BLEND_ATTACHMENT_STATES);
 		const auto color_blend_info =
-			vk::PipelineColorBlendStateCreateInfo().setAttachments(color_attachment_blend_states);
+			vk::PipelineColorBlendStateCreateInfo().setAttachments(color_blend_states);
+		const auto* const depth_stencil_info =
+			pass == Pass::DepthEqual ? &DEPTH_EQUAL_STATE : &gbuffer::DEPTH_STENCIL_STATE;
 
 		/*===== Output =====*/
 
-		constexpr auto color_formats = std::to_array({
-			DeferredAttachment::ALBEDO_FORMAT,  // Location 0
-			DeferredAttachment::NORMAL_FORMAT,  // Location 1
-			DeferredAttachment::PBR_FORMAT,     // Location 2
-			HdrAttachment::HDR_FORMAT,          // Location 3
-		});
-
+		const auto color_formats = gbuffer::get_color_formats(hdr_format);
 		const auto pipeline_rendering_create_info =
 			vk::PipelineRenderingCreateInfo()
+				.setViewMask(gbuffer::get_view_mask(view_count))
 				.setColorAttachmentFormats(color_formats)
 				.setDepthAttachmentFormat(DeferredAttachment::DEPTH_FORMAT);
 
@@ -271,38 +308,103 @@ namespace render
 
 		/*===== Pipeline Creation =====*/
 
+		const auto variable_rate = context.feature.fragment_shading_rate;
+		const auto pipeline_create_flags = variable_rate
+			? vk::PipelineCreateFlags(vk::PipelineCreateFlagBits::eRenderingFragmentShadingRateAttachmentKHR)
+			: vk::PipelineCreateFlags();
+
 		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
 			vk::GraphicsPipelineCreateInfo()
-				.setStages(shader_stage_create_infos)
+				.setFlags(pipeline_create_flags)
+				.setStages(shader_stages)
 				.setPVertexInputState(&vertex_input_state_create_info)
 				.setPInputAssemblyState(&constant::TRIANGLE_LIST_INPUT_ASSEMBLY_STATE)
 				.setPRasterizationState(&rasterization_info)
 				.setPMultisampleState(&constant::BASIC_MULTISAMPLE_STATE)
-				.setPDepthStencilState(&depth_stencil_info)
+				.setPDepthStencilState(depth_stencil_info)
 				.setPColorBlendState(&color_blend_info)
 				.setPViewportState(&constant::DYNAMIC_VIEWPORT_STATE)
 				.setPDynamicState(&dynamic_state_info)
 				.setLayout(pipeline_layout);
 		pipeline_create_info.push(pipeline_rendering_create_info);
+		if (variable_rate) pipeline_create_info.push(constant::ATTACHMENT_SHADING_RATE_STATE);
 
-		auto pipeline_result = context.device.createGraphicsPipeline(nullptr, pipeline_create_info.get());
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
 		if (!pipeline_result)
 		{
 			return Error::from(pipeline_result)
 				.forward(
 					"Create graphics pipeline failed",
-					std::format("alpha_mask_enabled={}, double_sided={}", alpha_mask_enabled, double_sided)
+					std::format(
+						"pass={}, alpha_mask_enabled={}, double_sided={}",
+						static_cast<int>(pass),
+						alpha_mask_enabled,
+						double_sided
+					)
 				);
 		}
 
 		return std::move(*pipeline_result);
 	}
 
+	std::expected<DeferredPipeline::Variant, Error> DeferredPipeline::create_variant(
+		const vulkan::Context& context,
+		vk::PipelineLayout pipeline_layout,
+		vk::ShaderModule shader_module,
+		VertexFormat vertex_format,
+		VertexFetch vertex_fetch,
+		uint32_t view_count,
+		vk::Format hdr_format,
+		MaterialFeatures features
+	) noexcept
+	{
+		const auto create_pass_pipeline = [&](Pass pass) {
+			return create_pipeline(
+				context,
+				pipeline_layout,
+				shader_module,
+				vertex_format,
+				vertex_fetch,
+				view_count,
+				hdr_format,
+				pass,
+				features.has(MaterialFeatures::AlphaMask),
+				features.has(MaterialFeatures::DoubleSided)
+			);
+		};
+
+		auto gbuffer_result = create_pass_pipeline(Pass::GBuffer);
+		if (!gbuffer_result) return gbuffer_result.error().forward("Create G-buffer pipeline failed");
+
+		auto prepass_result = create_pass_pipeline(Pass::DepthPrepass);
+		if (!prepass_result) return prepass_result.error().forward("Create depth prepass pipeline failed");
+
+		auto depth_equal_result = create_pass_pipeline(Pass::DepthEqual);
+		if (!depth_equal_result)
+			return depth_equal_result.error().forward("Create depth equal pipeline failed");
+
+		return Variant{
+			.gbuffer = std::move(*gbuffer_result),
+			.prepass = std::move(*prepass_result),
+			.depth_equal = std::move(*depth_equal_result),
+		};
+	}
+
 	std::expected<DeferredPipeline, Error> DeferredPipeline::create(
 		const vulkan::Context& context,
-		const render::MaterialLayout& material_layout
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format,
+		VertexFetch vertex_fetch,
+		uint32_t view_count,
+		vk::Format hdr_format
 	) noexcept
 	{
+		if (view_count < 1 || view_count > 2)
+			return Error("Unsupported view count", std::format("view_count={}", view_count));
+		if (view_count > 1 && context.feature.fragment_shading_rate)
+			return Error("Multiview rendering is not supported with fragment shading rate");
+
 		auto shader_module_result = vulkan::create_shader(context.device, shader::deferred);
 		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
 		auto shader_module = std::move(*shader_module_result);
@@ -322,27 +424,40 @@ namespace render
 		}
 		auto pipeline_layout = std::move(*pipeline_layout_result);
 
-		auto pipelines_result = PerRenderState<vk::raii::Pipeline>::from_ctor(
-			[&](model::AlphaMode alpha_mode, bool double_sided) {
-				return create_pipeline(
-					context,
-					pipeline_layout,
-					shader_module,
-					alpha_mode == model::AlphaMode::Mask,
-					double_sided
-				);
-			}
-		);
-		if (!pipelines_result)
-		{
-			return pipelines_result.error().forward("Create pipelines failed");
-		}
-		auto pipelines = std::move(*pipelines_result);
+		// Kept alive by the compile function, variants are compiled after this returns
+		const auto shared_shader_module =
+			std::make_shared<const vk::raii::ShaderModule>(std::move(shader_module));
+
+		const auto compile_variant = [&context,
+									  layout = *pipeline_layout,
+									  module = shared_shader_module,
+									  vertex_format,
+									  vertex_fetch,
+									  view_count,
+									  hdr_format](MaterialFeatures features) {
+			return create_variant(
+				context,
+				layout,
+				*module,
+				vertex_format,
+				vertex_fetch,
+				view_count,
+				hdr_format,
+				features
+			);
+		};
+
+		auto variants_result = PipelineVariantCache<Variant>::create(compile_variant);
+		if (!variants_result) return variants_result.error().forward("Create pipeline variants failed");
+		auto variants = std::move(*variants_result);
 
 		return DeferredPipeline{
 			std::move(data_descriptor_set_layout),
 			std::move(pipeline_layout),
-			std::move(pipelines)
+			std::move(variants),
+			vertex_format,
+			vertex_fetch,
+			context.feature.fragment_shading_rate
 		};
 	}
 
@@ -396,214 +511,146 @@ namespace render
 			| Error::collect();
 	}
 
+	void DeferredPipeline::request_variants(const MaterialList& material_list) noexcept
+	{
+		for (const auto mode : material_list.get_material_modes())
+			variants.request(MaterialFeatures::from(mode));
+	}
+
+	std::expected<void, Error> DeferredPipeline::update_variants() noexcept
+	{
+		return variants.update();
+	}
+
 	void DeferredPipeline::render(
 		const vk::raii::CommandBuffer& command_buffer,
-		const ResourceSet& resource_set
+		const ResourceSet& resource_set,
+		DrawPhase phase,
+		DepthPrepass depth_prepass
 	) const noexcept
 	{
-		DEBUG_ASSERT(resource_set.resource.has_value());
-
-		const auto color_attachments = std::to_array({
-			resource_set.resource->attachment.albedo,
-			resource_set.resource->attachment.normal,
-			resource_set.resource->attachment.pbr,
-			resource_set.resource->attachment.hdr,
-		});
+		const auto* label_name = phase == DrawPhase::Early ? "G-Buffer (Early)" : "G-Buffer (Late)";
+		const auto label = vulkan::DebugLabel(command_buffer, label_name);
 
-		/*===== Pre-rendering Layout Transitions =====*/
-
-		const auto pre_depth_barrier = vk::ImageMemoryBarrier2{
-			.srcStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
-				| vk::PipelineStageFlagBits2::eLateFragmentTests,
-			.srcAccessMask = vk::AccessFlagBits2::eNone,
-			.dstStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
-				| vk::PipelineStageFlagBits2::eLateFragmentTests,
-			.dstAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite
-				| vk::AccessFlagBits2::eDepthStencilAttachmentRead,
-			.oldLayout = vk::ImageLayout::eUndefined,
-			.newLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
-			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.image = resource_set.resource->attachment.depth.image,
-			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eDepth)
-		};
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
 
-		const auto pre_color_barriers =
-			color_attachments | util::map_array([](const vulkan::AttachmentView& attachment) {
-				return vk::ImageMemoryBarrier2{
-					.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-					.srcAccessMask = vk::AccessFlagBits2::eNone,
-					.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-					.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
-					.oldLayout = vk::ImageLayout::eUndefined,
-					.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
-					.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-					.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-					.image = attachment.image,
-					.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
-				};
-			});
+		gbuffer::begin_rendering(
+			command_buffer,
+			resource_set->attachment,
+			phase,
+			variable_rate ? resource_set->shading_rate : std::nullopt
+		);
 
-		const auto pre_barriers = util::array_concat(pre_depth_barrier, pre_color_barriers);
-		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+		if (vertex_fetch == VertexFetch::Attribute)
+			command_buffer.bindVertexBuffers(0, resource_set.resource->vertex_buffer, {0});
+		command_buffer.bindIndexBuffer(
+			resource_set.resource->index_buffer,
+			0,
+			index_type(resource_set.resource->index_format)
+		);
 
-		/*===== Draw =====*/
+		// Materials are indexed from a single bindless set, bound once for all variants sharing the layout
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eGraphics,
+			*pipeline_layout,
+			0,
+			resource_set.resource->material_descriptor_set,
+			{}
+		);
 
-		const auto color_attachment_infos =
-			color_attachments | util::map_array([](const vulkan::AttachmentView& attachment) {
-				return vk::RenderingAttachmentInfo{
-					.imageView = attachment.view,
-					.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
-					.loadOp = vk::AttachmentLoadOp::eClear,
-					.storeOp = vk::AttachmentStoreOp::eStore,
-					.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f)
-				};
+		const auto prepassed =
+			PerRenderState<bool>::from_ctor([depth_prepass](model::AlphaMode alpha_mode, bool) {
+				return depth_prepass == DepthPrepass::All
+					|| (depth_prepass == DepthPrepass::Masked && alpha_mode == model::AlphaMode::Mask);
 			});
+		const auto shaded = prepassed.map([](bool prepass) { return !prepass; });
 
-		const auto depth_attachment_info = vk::RenderingAttachmentInfo{
-			.imageView = resource_set.resource->attachment.depth.view,
-			.imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
-			.loadOp = vk::AttachmentLoadOp::eClear,
-			.storeOp = vk::AttachmentStoreOp::eStore,
-			.clearValue = vk::ClearDepthStencilValue{.depth = 0.0f, .stencil = 0}
-		};
-
-		const auto rendering_rect = vk::Rect2D{
-			.offset = vk::Offset2D{.x = 0, .y = 0},
-			.extent = vulkan::to<vk::Extent2D>(resource_set.resource->attachment.extent)
+		// Render states whose variant is still compiling draw with the generic variant
+		const auto render_variants =
+			PerRenderState<const Variant*>::from_ctor([this](model::AlphaMode alpha_mode, bool double_sided) {
+				return &variants.get(MaterialFeatures::from(alpha_mode, double_sided));
+			});
+		const auto get_pipelines = [&render_variants](vk::raii::Pipeline Variant::* pass) {
+			return render_variants.map([pass](const Variant* variant) -> vk::Pipeline {
+				return *(variant->*pass);
+			});
 		};
 
-		const auto rendering_info =
-			vk::RenderingInfo()
-				.setRenderArea(rendering_rect)
-				.setLayerCount(1)
-				.setColorAttachments(color_attachment_infos)
-				.setPDepthAttachment(&depth_attachment_info);
+		// Render states without prepass go first, so that they occlude the prepass as well
+		draw(command_buffer, resource_set, phase, get_pipelines(&Variant::gbuffer), shaded);
+		draw(command_buffer, resource_set, phase, get_pipelines(&Variant::prepass), prepassed);
+		draw(command_buffer, resource_set, phase, get_pipelines(&Variant::depth_equal), prepassed);
 
-		command_buffer.beginRendering(rendering_info);
-
-		command_buffer
-			.bindVertexBuffers(0, static_cast<vk::Buffer>(resource_set.resource->vertex_buffer), {0});
-		command_buffer.bindIndexBuffer(resource_set.resource->index_buffer, 0, vk::IndexType::eUint32);
-
-		command_buffer.setViewport(
-			0,
-			vk::Viewport{
-				.x = 0.0f,
-				.y = 0.0f,
-				.width = static_cast<float>(resource_set.resource->attachment.extent.x),
-				.height = static_cast<float>(resource_set.resource->attachment.extent.y),
-				.minDepth = 0.0f,
-				.maxDepth = 1.0f
-			}
-		);
-		command_buffer.setScissor(0, rendering_rect);
+		gbuffer::end_rendering(command_buffer, resource_set->attachment);
+	}
 
+	void DeferredPipeline::draw(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		DrawPhase phase,
+		const PerRenderState<vk::Pipeline>& pipelines,
+		const PerRenderState<bool>& mask
+	) const noexcept
+	{
 		for (
-			const auto& [pipeline, data_descriptor_set, indirect_buffer] : std::views::zip(
+			const auto& [pipeline, enabled, descriptor_set, indirect_buffer, commands, count_buffer] :
+			std::views::zip(
 				pipelines.all(),
+				mask.all(),
 				resource_set.data_descriptor_set.all(),
-				resource_set.resource->indirect_buffers.all()
+				resource_set.resource->indirect_buffers.all(),
+				resource_set.resource->command_buffers.all(),
+				resource_set.resource->count_buffers.all()
 			)
 		)
 		{
-			if (indirect_buffer.count() == 0) continue;
+			const auto phase_capacity = IndirectResource::phase_capacity(indirect_buffer);
+			if (!enabled || phase_capacity == 0) continue;
 
-			command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
 
 			command_buffer.bindDescriptorSets(
 				vk::PipelineBindPoint::eGraphics,
 				*pipeline_layout,
-				0,
-				{resource_set.resource->material_descriptor_set, data_descriptor_set},
+				1,
+				*descriptor_set,
 				{}
 			);
 
-			command_buffer.drawIndexedIndirect(
-				indirect_buffer,
-				0,
-				indirect_buffer.count(),
-				sizeof(render::IndirectDrawcall)
+			// Instanced commands are in the front of each phase, actual count is written by indirect pass
+			const auto command_offset = IndirectResource::phase_offset(indirect_buffer, phase)
+				* sizeof(vk::DrawIndexedIndirectCommand);
+			const auto count_offset = phase == DrawPhase::Early
+				? offsetof(IndirectCount, early_command_count)
+				: offsetof(IndirectCount, late_command_count);
+
+			command_buffer.drawIndexedIndirectCount(
+				commands,
+				command_offset,
+				count_buffer,
+				count_offset,
+				phase_capacity,
+				sizeof(vk::DrawIndexedIndirectCommand)
 			);
 		}
-
-		command_buffer.endRendering();
-
-		/*===== Post-rendering Layout Transitions =====*/
-		// NOTE: HDR attachment is handled differently than others -- no layout transitions, expect next usage
-		// to be color attachment
-
-		const auto post_layout_transition_color_attachments = std::to_array({
-			resource_set.resource->attachment.albedo,
-			resource_set.resource->attachment.normal,
-			resource_set.resource->attachment.pbr,
-		});
-
-		const auto post_color_barriers =
-			post_layout_transition_color_attachments
-			| util::map_array([](const vulkan::AttachmentView& attachment) {
-				  return vk::ImageMemoryBarrier2{
-					  .srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-					  .srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
-					  .dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader
-						  | vk::PipelineStageFlagBits2::eComputeShader,
-					  .dstAccessMask = vk::AccessFlagBits2::eShaderRead,
-					  .oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
-					  .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-					  .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-					  .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-					  .image = attachment.image,
-					  .subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
-				  };
-			  });
-
-		const auto post_hdr_barrier = vk::ImageMemoryBarrier2{
-			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-			.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
-			.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-			.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
-			.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
-			.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
-			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.image = resource_set->attachment.hdr.image,
-			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
-		};
-
-		const auto post_depth_barrier = vk::ImageMemoryBarrier2{
-			.srcStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
-				| vk::PipelineStageFlagBits2::eLateFragmentTests,
-			.srcAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite
-				| vk::AccessFlagBits2::eDepthStencilAttachmentRead,
-			.dstStageMask =
-				vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader,
-			.dstAccessMask = vk::AccessFlagBits2::eShaderRead,
-			.oldLayout = vk::ImageLayout::eDepthAttachmentOptimal,
-			.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-			.image = resource_set.resource->attachment.depth.image,
-			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eDepth)
-		};
-
-		const auto post_barriers =
-			util::array_concat(post_color_barriers, post_hdr_barrier, post_depth_barrier);
-		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barriers));
 	}
 
 	void DeferredPipeline::ResourceSet::update(
 		const vulkan::Context& context,
 		const Model& model,
-		const HostDrawcallResource& host_drawcall,
+		const TransformResource& transform,
+		const TransformResource& prev_transform,
 		const IndirectResource& indirect_resource,
 		DeferredAttachment::View deferred_attachment,
 		HdrAttachment::View hdr_attachment,
 		vulkan::ElementBufferRef<Camera> camera_param,
-		vulkan::ElementBufferRef<DirectLight> primary_light_param
+		vulkan::ElementBufferRef<DirectLight> primary_light_param,
+		vulkan::ArrayBufferRef<uint32_t> material_feedback,
+		std::optional<ShadingRateAttachment::View> shading_rate,
+		std::optional<vulkan::ElementBufferRef<Camera>> second_camera_param
 	) noexcept
 	{
-		DEBUG_ASSERT(deferred_attachment.extent == hdr_attachment.extent);
-
 		/* Write descriptor sets */
 
 		const auto primitive_attr_buffer_write = vk::DescriptorBufferInfo{
@@ -621,9 +668,15 @@ namespace render
 		});
 
 		const auto transform_buffer_write = vk::DescriptorBufferInfo{
-			.buffer = host_drawcall->transform,
+			.buffer = transform->world_transform,
 			.offset = 0,
-			.range = host_drawcall->transform.size_vk(),
+			.range = transform->world_transform.size_vk(),
+		};
+
+		const auto prev_transform_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = prev_transform->world_transform,
+			.offset = 0,
+			.range = prev_transform->world_transform.size_vk(),
 		};
 
 		const auto camera_buffer_write = vk::DescriptorBufferInfo{
@@ -632,12 +685,30 @@ namespace render
 			.range = vk::WholeSize,
 		};
 
+		const auto second_camera_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = second_camera_param.value_or(camera_param),
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
 		const auto direct_light_param_buffer_write = vk::DescriptorBufferInfo{
 			.buffer = primary_light_param,
 			.offset = 0,
 			.range = vk::WholeSize,
 		};
 
+		const auto material_feedback_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = material_feedback,
+			.offset = 0,
+			.range = material_feedback.size_vk(),
+		};
+
+		const auto vertex_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = model.mesh_list->vertex_buffer,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
 		for (
 			const auto& [descriptor_set, indirect_buffer_write] :
 			std::views::zip(data_descriptor_set.all(), indirect_buffer_writes.all())
@@ -688,36 +759,72 @@ namespace render
 				.pBufferInfo = &direct_light_param_buffer_write
 			};
 
+			const auto material_feedback_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 5,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &material_feedback_buffer_write
+			};
+
+			const auto prev_transform_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 6,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &prev_transform_buffer_write
+			};
+
+			const auto vertex_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 7,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &vertex_buffer_write
+			};
+
+			const auto second_camera_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 8,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &second_camera_buffer_write
+			};
+
 			const auto write_sets = std::to_array({
 				primitive_attr_buffer_write_set,
 				indirect_buffer_write_set,
 				transform_buffer_write_set,
 				camera_buffer_write_set,
 				direct_light_param_buffer_write_set,
+				material_feedback_buffer_write_set,
+				prev_transform_buffer_write_set,
+				vertex_buffer_write_set,
+				second_camera_buffer_write_set,
 			});
 
-			context.device.updateDescriptorSets(write_sets, {});
+			descriptor_cache.update(context.device, write_sets);
 		}
 
 		/* Store infos */
 
-		const auto attachment = Attachment{
-			.extent = deferred_attachment.extent,
-			.albedo = deferred_attachment.albedo,
-			.normal = deferred_attachment.normal,
-			.pbr = deferred_attachment.pbr,
-			.depth = deferred_attachment.depth,
-			.hdr = hdr_attachment.attachment,
-		};
-
 		resource = Resource{
 			.material_descriptor_set = model.material_list.get_descriptor_set(),
 
 			.vertex_buffer = model.mesh_list->vertex_buffer,
+			.vertex_format = model.mesh_list->vertex_format,
 			.index_buffer = model.mesh_list->index_buffer,
+			.index_format = model.mesh_list->index_format,
 			.indirect_buffers = indirect_resource.ref(),
+			.command_buffers = indirect_resource.command_ref(),
+			.count_buffers = indirect_resource.count_ref(),
 
-			.attachment = attachment
+			.attachment = gbuffer::Attachment::from(deferred_attachment, hdr_attachment),
+			.shading_rate = shading_rate
 		};
 	}
 }
@@ -0,0 +1,299 @@
+#include "render/pipeline/deform.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/model/deform-list.hpp"
+#include "render/model/mesh.hpp"
+#include "render/resource/deform.hpp"
+#include "shader/deform.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto get_storage_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		return std::to_array({
+			get_storage_binding(0),  // Bind-pose vertices
+			get_storage_binding(1),  // Vertex skins
+			get_storage_binding(2),  // Morph target deltas
+			get_storage_binding(3),  // Joint matrices
+			get_storage_binding(4),  // Morph weights
+			get_storage_binding(5),  // Deformed vertices, the vertex buffer of the mesh list
+		});
+	}
+
+	static vk::BufferMemoryBarrier2 get_buffer_barrier(
+		vk::Buffer buffer,
+		vk::PipelineStageFlags2 src_stage,
+		vk::AccessFlags2 src_access,
+		vk::PipelineStageFlags2 dst_stage,
+		vk::AccessFlags2 dst_access
+	) noexcept
+	{
+		return vk::BufferMemoryBarrier2{
+			.srcStageMask = src_stage,
+			.srcAccessMask = src_access,
+			.dstStageMask = dst_stage,
+			.dstAccessMask = dst_access,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.buffer = buffer,
+			.offset = 0,
+			.size = vk::WholeSize
+		};
+	}
+
+	std::expected<DeformPipeline, Error> DeformPipeline::create(const vulkan::Context& context) noexcept
+	{
+		auto shader_result = vulkan::create_shader(context.device, shader::deform);
+		if (!shader_result) return shader_result.error().forward("Create deform shader module failed");
+		auto shader_module = std::move(*shader_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*descriptor_set_layout)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main");
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+
+		auto vertex_reader_stages = vk::PipelineStageFlagBits2::eVertexAttributeInput
+			| vk::PipelineStageFlagBits2::eVertexShader
+			| vk::PipelineStageFlagBits2::eFragmentShader
+			| vk::PipelineStageFlagBits2::eComputeShader;
+		if (context.feature.mesh_shader) vertex_reader_stages |= vk::PipelineStageFlagBits2::eMeshShaderEXT;
+		if (context.feature.raytracing)
+			vertex_reader_stages |= vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR;
+
+		return DeformPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(*pipeline_result),
+			vertex_reader_stages
+		);
+	}
+
+	std::expected<std::vector<DeformPipeline::ResourceSet>, Error> DeformPipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void DeformPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Deform");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& resource = *resource_set.resource;
+
+		constexpr auto vertex_reader_access = vk::AccessFlagBits2::eVertexAttributeRead
+			| vk::AccessFlagBits2::eShaderStorageRead
+			| vk::AccessFlagBits2::eShaderRead;
+
+		// The vertex buffer is shared across frames, wait for readers of previous frames
+		const auto pre_barrier = get_buffer_barrier(
+			resource.vertex_buffer,
+			vertex_reader_stages,
+			vertex_reader_access,
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageWrite
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(pre_barrier));
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			pipeline_layout,
+			0,
+			*resource_set.descriptor_set,
+			{}
+		);
+
+		for (const auto& job : resource.deform_list.jobs)
+		{
+			const auto push_constant = PushConstant{
+				.vertex_offset = job.vertex_offset,
+				.vertex_count = job.vertex_count,
+				.bind_offset = job.bind_offset,
+				.skin_offset = job.skin_offset,
+				.morph_offset = job.morph_offset,
+				.target_count = job.target_count,
+				.joint_offset = job.joint_offset,
+				.weight_offset = job.weight_offset,
+			};
+
+			command_buffer.pushConstants<PushConstant>(
+				*pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				push_constant
+			);
+			command_buffer.dispatch((job.vertex_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+		}
+
+		// Primitives write disjoint vertex ranges, a single barrier covers all dispatches
+		const auto post_barrier = get_buffer_barrier(
+			resource.vertex_buffer,
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageWrite,
+			vertex_reader_stages,
+			vertex_reader_access
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(post_barrier));
+	}
+
+	void DeformPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const MeshList& mesh_list,
+		const DeformList& deform_list,
+		const DeformResource& deform
+	) noexcept
+	{
+		const auto mesh_list_ref = mesh_list.get();
+		const auto deform_list_ref = deform_list.get();
+
+		const auto bind_vertex_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = deform_list_ref.bind_vertex_buffer,
+			.offset = 0,
+			.range = deform_list_ref.bind_vertex_buffer.size_vk()
+		};
+
+		const auto skin_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = deform_list_ref.skin_buffer,
+			.offset = 0,
+			.range = deform_list_ref.skin_buffer.size_vk()
+		};
+
+		const auto morph_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = deform_list_ref.morph_buffer,
+			.offset = 0,
+			.range = deform_list_ref.morph_buffer.size_vk()
+		};
+
+		const auto joint_matrix_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = deform->joint_matrices,
+			.offset = 0,
+			.range = deform->joint_matrices.size_vk()
+		};
+
+		const auto morph_weight_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = deform->morph_weights,
+			.offset = 0,
+			.range = deform->morph_weights.size_vk()
+		};
+
+		const auto vertex_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = mesh_list_ref.vertex_buffer,
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+
+		const auto buffer_infos = std::to_array({
+			bind_vertex_buffer_info,
+			skin_buffer_info,
+			morph_buffer_info,
+			joint_matrix_buffer_info,
+			morph_weight_buffer_info,
+			vertex_buffer_info,
+		});
+
+		const auto write_descriptor_sets =
+			buffer_infos
+			| std::views::enumerate
+			| std::views::transform([this](const auto& pair) {
+				  const auto& [binding, buffer_info] = pair;
+				  return vk::WriteDescriptorSet{
+					  .dstSet = descriptor_set,
+					  .dstBinding = static_cast<uint32_t>(binding),
+					  .descriptorCount = 1,
+					  .descriptorType = vk::DescriptorType::eStorageBuffer,
+					  .pBufferInfo = &buffer_info
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+
+		descriptor_cache.update(context.device, write_descriptor_sets);
+
+		resource = Resource{
+			.vertex_buffer = mesh_list_ref.vertex_buffer,
+			.deform_list = deform_list_ref,
+			.deform = deform.ref(),
+		};
+	}
+}
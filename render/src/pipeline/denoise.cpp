@@ -0,0 +1,395 @@
+#include "render/pipeline/denoise.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/denoise.hpp"
+#include "shader/denoise.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	// Descriptor sets per resource set, one for each filtered image written
+	static constexpr uint32_t SETS_PER_RESOURCE_SET = 2;
+
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto sampled_image_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		constexpr auto storage_image_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		constexpr auto camera_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 3,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({
+			sampled_image_binding(0),  // Depth
+			sampled_image_binding(1),  // Normal
+			sampled_image_binding(2),  // Velocity
+			camera_binding,
+			sampled_image_binding(4),   // Signal
+			sampled_image_binding(5),   // Previous history
+			sampled_image_binding(6),   // Previous moments
+			sampled_image_binding(7),   // Wavelet source
+			storage_image_binding(8),   // Destination
+			storage_image_binding(9),   // Moments
+			storage_image_binding(10),  // History
+		});
+	}
+
+	std::expected<DenoisePipeline, Error> DenoisePipeline::create(const vulkan::Context& context) noexcept
+	{
+		auto shader_module_result = vulkan::create_shader(context.device, shader::denoise);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto set_layouts = std::to_array<vk::DescriptorSetLayout>({descriptor_set_layout});
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(set_layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto create_pipeline = [&](const char* entry) -> std::expected<vk::raii::Pipeline, Error> {
+			const auto pipeline_stage_create_info =
+				vk::PipelineShaderStageCreateInfo()
+					.setStage(vk::ShaderStageFlagBits::eCompute)
+					.setModule(shader_module)
+					.setPName(entry);
+			const auto pipeline_create_info =
+				vk::ComputePipelineCreateInfo()
+					.setStage(pipeline_stage_create_info)
+					.setLayout(pipeline_layout);
+
+			auto pipeline_result =
+				context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			return std::move(*pipeline_result);
+		};
+
+		auto temporal_pipeline_result = create_pipeline("main_temporal");
+		if (!temporal_pipeline_result)
+			return temporal_pipeline_result.error().forward("Create temporal pipeline failed");
+
+		auto wavelet_pipeline_result = create_pipeline("main_wavelet");
+		if (!wavelet_pipeline_result)
+			return wavelet_pipeline_result.error().forward("Create wavelet pipeline failed");
+
+		return DenoisePipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(*temporal_pipeline_result),
+			std::move(*wavelet_pipeline_result)
+		);
+	}
+
+	std::expected<std::vector<DenoisePipeline::ResourceSet>, Error> DenoisePipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto set_count = count * SETS_PER_RESOURCE_SET;
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, set_count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(set_count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(SETS_PER_RESOURCE_SET, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+
+		const auto create_resource_set_fn =
+			[&set_alloc_info, &context, &descriptor_pool] -> std::expected<ResourceSet, Error> {
+			auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+			if (!sets_result) return Error::from(sets_result);
+			return ResourceSet(descriptor_pool, std::move(*sets_result));
+		};
+
+		return std::views::repeat(create_resource_set_fn, count)
+			| std::views::transform([](auto&& f) { return f(); })
+			| Error::collect();
+	}
+
+	void DenoisePipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		bool history_valid
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Denoise");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& output = resource_set->output;
+
+		const auto image_barrier = [](vk::Image image,
+									  vk::PipelineStageFlags2 src_stage,
+									  vk::AccessFlags2 src_access,
+									  vk::PipelineStageFlags2 dst_stage,
+									  vk::AccessFlags2 dst_access,
+									  vk::ImageLayout old_layout) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = src_stage,
+				.srcAccessMask = src_access,
+				.dstStageMask = dst_stage,
+				.dstAccessMask = dst_access,
+				.oldLayout = old_layout,
+				.newLayout = vk::ImageLayout::eGeneral,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		};
+
+		// Written by a pass, then read by the next one
+		const auto pass_barrier = [&image_barrier](vk::Image image) {
+			return image_barrier(
+				image,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageRead,
+				vk::ImageLayout::eGeneral
+			);
+		};
+
+		/* Pre-denoise layout transition, previous content is discarded */
+
+		const auto pre_barrier = [&image_barrier](vk::Image image) {
+			return image_barrier(
+				image,
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eNone,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite | vk::AccessFlagBits2::eShaderStorageRead,
+				vk::ImageLayout::eUndefined
+			);
+		};
+
+		const auto pre_barriers = std::to_array({
+			pre_barrier(output.history.image),
+			pre_barrier(output.moments.image),
+			pre_barrier(output.filtered[0].image),
+			pre_barrier(output.filtered[1].image),
+		});
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+
+		auto push_constant = PushConstant{
+			.size = output.extent,
+			.full_size = resource_set->full_size,
+			.downscale = output.downscale,
+			.history_valid = history_valid ? 1u : 0u,
+			.color_alpha = option.color_alpha,
+			.moments_alpha = option.moments_alpha,
+			.phi_color = option.phi_color,
+			.phi_normal = option.phi_normal,
+			.phi_distance = option.phi_distance,
+			.step = 1,
+			.write_history = 0,
+		};
+		const auto group_count = (output.extent + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+		const auto dispatch = [&](uint32_t set_index) {
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eCompute,
+				*pipeline_layout,
+				0,
+				*resource_set.sets[set_index],
+				{}
+			);
+			command_buffer.pushConstants<PushConstant>(
+				*pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				push_constant
+			);
+			command_buffer.dispatch(group_count.x, group_count.y, 1);
+		};
+
+		/* Temporal accumulation, writes `filtered[0]` and the moments */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, temporal_pipeline);
+		dispatch(0);
+
+		const auto temporal_barriers = std::to_array({
+			pass_barrier(output.filtered[0].image),
+			pass_barrier(output.moments.image),
+		});
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(temporal_barriers));
+
+		/* Wavelet iterations, ping-pong between the filtered images */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, wavelet_pipeline);
+
+		for (const auto iteration : std::views::iota(0u, DenoiseAttachment::WAVELET_ITERATIONS))
+		{
+			const auto dst_index = (iteration + 1) % 2;
+
+			push_constant.step = 1u << iteration;
+			push_constant.write_history = iteration == 0 ? 1u : 0u;
+			dispatch(dst_index);
+
+			const auto iteration_barrier = pass_barrier(output.filtered[dst_index].image);
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(iteration_barrier));
+		}
+
+		/* Make the output and the history visible to the consumers and to the next frame */
+
+		const auto post_barriers = std::to_array({
+			image_barrier(
+				output.output().image,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite,
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderSampledRead,
+				vk::ImageLayout::eGeneral
+			),
+			image_barrier(
+				output.history.image,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderSampledRead,
+				vk::ImageLayout::eGeneral
+			),
+		});
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barriers));
+	}
+
+	void DenoisePipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		DeferredAttachment::View deferred,
+		vulkan::AttachmentView signal,
+		DenoiseAttachment::View history,
+		DenoiseAttachment::View output,
+		vulkan::ElementBufferRef<Camera> camera
+	) noexcept
+	{
+		DEBUG_ASSERT(history.downscale == output.downscale, "History resolution mismatches output");
+
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto image_info = [](vulkan::AttachmentView view, vk::ImageLayout layout) {
+			return vk::DescriptorImageInfo{.imageView = view.view, .imageLayout = layout};
+		};
+
+		const auto depth_image_info = image_info(deferred.depth, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto normal_image_info = image_info(deferred.normal, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto velocity_image_info =
+			image_info(deferred.velocity, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto signal_image_info = image_info(signal, vk::ImageLayout::eGeneral);
+		const auto prev_history_image_info = image_info(history.history, vk::ImageLayout::eGeneral);
+		const auto prev_moments_image_info = image_info(history.moments, vk::ImageLayout::eGeneral);
+		const auto moments_image_info = image_info(output.moments, vk::ImageLayout::eGeneral);
+		const auto history_image_info = image_info(output.history, vk::ImageLayout::eGeneral);
+		const auto filtered_image_infos = std::to_array({
+			image_info(output.filtered[0], vk::ImageLayout::eGeneral),
+			image_info(output.filtered[1], vk::ImageLayout::eGeneral),
+		});
+
+		const auto camera_buf_info = vk::DescriptorBufferInfo{
+			.buffer = camera,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		/*===== Write Descriptor Sets =====*/
+
+		for (const auto dst_index : std::views::iota(0u, SETS_PER_RESOURCE_SET))
+		{
+			const auto& set = sets[dst_index];
+
+			const auto image_write = [&set](uint32_t binding, vk::DescriptorType type, const auto& info) {
+				return vk::WriteDescriptorSet{
+					.dstSet = set,
+					.dstBinding = binding,
+					.descriptorCount = 1,
+					.descriptorType = type,
+					.pImageInfo = &info,
+				};
+			};
+
+			const auto write_descriptors = std::to_array({
+				image_write(0, vk::DescriptorType::eSampledImage, depth_image_info),
+				image_write(1, vk::DescriptorType::eSampledImage, normal_image_info),
+				image_write(2, vk::DescriptorType::eSampledImage, velocity_image_info),
+				vk::WriteDescriptorSet{
+					.dstSet = set,
+					.dstBinding = 3,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eUniformBuffer,
+					.pBufferInfo = &camera_buf_info,
+				},
+				image_write(4, vk::DescriptorType::eSampledImage, signal_image_info),
+				image_write(5, vk::DescriptorType::eSampledImage, prev_history_image_info),
+				image_write(6, vk::DescriptorType::eSampledImage, prev_moments_image_info),
+				image_write(7, vk::DescriptorType::eSampledImage, filtered_image_infos[1 - dst_index]),
+				image_write(8, vk::DescriptorType::eStorageImage, filtered_image_infos[dst_index]),
+				image_write(9, vk::DescriptorType::eStorageImage, moments_image_info),
+				image_write(10, vk::DescriptorType::eStorageImage, history_image_info),
+			});
+
+			descriptor_cache.update(context.device, write_descriptors);
+		}
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{.full_size = deferred.extent, .output = output};
+	}
+}
@@ -3,23 +3,37 @@
 #include "common/util/error.hpp"
 #include "render/interface/camera.hpp"
 #include "render/interface/direct-light.hpp"
+#include "render/model/light-list.hpp"
+#include "render/pipeline/atmosphere.hpp"
 #include "render/pipeline/util/constant.hpp"
 #include "render/pipeline/util/fullscreen-pipeline.hpp"
+#include "render/resource/ambient-occlusion.hpp"
 #include "render/resource/deferred.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/gi-probe.hpp"
 #include "render/resource/hdr.hpp"
+#include "render/resource/light-cluster.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "render/resource/shadow.hpp"
+#include "shader/direct-packed.hpp"
 #include "shader/direct.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/container/host/linked-struct.hpp"
 #include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
 #include "vulkan/numeric/glm.hpp"
 #include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
 #include "vulkan/util/shader.hpp"
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
 #include <libassert/assert.hpp>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <utility>
 #include <vector>
@@ -36,44 +50,147 @@ namespace render
 				.binding = 0,
 				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
 				.descriptorCount = 1,
-				.stageFlags = vk::ShaderStageFlagBits::eFragment,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
 			};
 
 			constexpr auto normal_tex_binding = vk::DescriptorSetLayoutBinding{
 				.binding = 1,
 				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
 				.descriptorCount = 1,
-				.stageFlags = vk::ShaderStageFlagBits::eFragment,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
 			};
 
 			constexpr auto pbr_tex_binding = vk::DescriptorSetLayoutBinding{
 				.binding = 2,
 				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
 				.descriptorCount = 1,
-				.stageFlags = vk::ShaderStageFlagBits::eFragment,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
 			};
 
 			constexpr auto depth_tex_binding = vk::DescriptorSetLayoutBinding{
 				.binding = 3,
 				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
 				.descriptorCount = 1,
-				.stageFlags = vk::ShaderStageFlagBits::eFragment,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
 			};
 
-			// TODO: Shadow mask texture
+			constexpr auto shadow_mask_tex_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 4,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
 
 			constexpr auto camera_binding = vk::DescriptorSetLayoutBinding{
-				.binding = 4,
+				.binding = 5,
 				.descriptorType = vk::DescriptorType::eUniformBuffer,
 				.descriptorCount = 1,
-				.stageFlags = vk::ShaderStageFlagBits::eFragment,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
 			};
 
 			constexpr auto light_binding = vk::DescriptorSetLayoutBinding{
-				.binding = 5,
+				.binding = 6,
 				.descriptorType = vk::DescriptorType::eUniformBuffer,
 				.descriptorCount = 1,
-				.stageFlags = vk::ShaderStageFlagBits::eFragment,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto punctual_light_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 7,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto transform_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 8,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto cluster_light_count_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 9,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto cluster_light_index_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 10,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto hdr_image_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 11,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto ambient_occlusion_tex_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 12,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto gi_irradiance_tex_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 13,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto gi_distance_tex_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 14,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto shading_rate_image_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 15,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto environment_sh_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 16,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto environment_specular_tex_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 17,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto environment_brdf_lut_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 18,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto atmosphere_transmittance_tex_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 19,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			};
+
+			constexpr auto atmosphere_sky_view_tex_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 20,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
 			};
 
 			return std::to_array({
@@ -81,8 +198,23 @@ namespace render
 				normal_tex_binding,
 				pbr_tex_binding,
 				depth_tex_binding,
+				shadow_mask_tex_binding,
 				camera_binding,
 				light_binding,
+				punctual_light_binding,
+				transform_binding,
+				cluster_light_count_binding,
+				cluster_light_index_binding,
+				hdr_image_binding,
+				ambient_occlusion_tex_binding,
+				gi_irradiance_tex_binding,
+				gi_distance_tex_binding,
+				shading_rate_image_binding,
+				environment_sh_binding,
+				environment_specular_tex_binding,
+				environment_brdf_lut_binding,
+				atmosphere_transmittance_tex_binding,
+				atmosphere_sky_view_tex_binding,
 			});
 		}
 
@@ -91,7 +223,9 @@ namespace render
 
 	[[nodiscard]]
 	std::expected<DirectLightingPipeline, Error> DirectLightingPipeline::create(
-		const vulkan::Context& context
+		const vulkan::Context& context,
+		Precision precision,
+		vk::Format hdr_format
 	) noexcept
 	{
 		/*===== Descriptor Set Layout =====*/
@@ -105,22 +239,44 @@ namespace render
 		/*===== Pipeline Layout =====*/
 
 		const auto layouts = std::to_array<vk::DescriptorSetLayout>({descriptor_set_layout});
-		auto pipeline_layout_result =
-			context.device.createPipelineLayout(vk::PipelineLayoutCreateInfo().setSetLayouts(layouts));
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
 		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
 		auto pipeline_layout = std::move(*pipeline_layout_result);
 
 		/*===== Shader Modules =====*/
 
 		auto vertex_shader_result = fullscreen::get_vertex_shader(context.device);
-		auto fragment_shader_result = vulkan::create_shader(context.device, shader::direct);
+		// Storage format of the compute path is fixed in the shader
+		const auto direct_shader_code =
+			hdr_format == HdrAttachment::PACKED_HDR_FORMAT ? shader::direct_packed : shader::direct;
+		auto direct_shader_result = vulkan::create_shader(context.device, direct_shader_code);
 
 		if (!vertex_shader_result) return vertex_shader_result.error().forward("Create vertex shader failed");
-		if (!fragment_shader_result)
-			return fragment_shader_result.error().forward("Create fragment shader failed");
+		if (!direct_shader_result) return direct_shader_result.error().forward("Create direct shader failed");
 
 		auto vertex_shader = std::move(*vertex_shader_result);
-		auto fragment_shader = std::move(*fragment_shader_result);
+		auto direct_shader = std::move(*direct_shader_result);
+
+		const auto spec_data = SpecializationConstant{
+			.half_precision = precision == Precision::Half ? vk::True : vk::False,
+		};
+		const auto spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = offsetof(SpecializationConstant, half_precision),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto specialization_info =
+			vk::SpecializationInfo().setMapEntries(spec_entry).setData<SpecializationConstant>(spec_data);
 
 		const auto vertex_shader_info = vk::PipelineShaderStageCreateInfo{
 			.stage = vk::ShaderStageFlagBits::eVertex,
@@ -129,8 +285,9 @@ namespace render
 		};
 		const auto fragment_shader_info = vk::PipelineShaderStageCreateInfo{
 			.stage = vk::ShaderStageFlagBits::eFragment,
-			.module = fragment_shader,
-			.pName = "main"
+			.module = direct_shader,
+			.pName = "main_fragment",
+			.pSpecializationInfo = &specialization_info
 		};
 
 		const auto shader_stages = std::to_array({
@@ -144,10 +301,17 @@ namespace render
 			vk::PipelineColorBlendStateCreateInfo().setAttachments(constant::ADDITIVE_BLEND_STATE);
 
 		const auto pipeline_rendering_create_info =
-			vk::PipelineRenderingCreateInfo().setColorAttachmentFormats(HdrAttachment::HDR_FORMAT);
+			vk::PipelineRenderingCreateInfo().setColorAttachmentFormats(hdr_format);
+
+		// Coarse rates are taken from the shading rate image, see `ShadingRatePipeline`
+		const auto hardware_variable_rate = context.feature.fragment_shading_rate;
+		const auto pipeline_create_flags = hardware_variable_rate
+			? vk::PipelineCreateFlags(vk::PipelineCreateFlagBits::eRenderingFragmentShadingRateAttachmentKHR)
+			: vk::PipelineCreateFlags();
 
 		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
 			vk::GraphicsPipelineCreateInfo()
+				.setFlags(pipeline_create_flags)
 				.setStages(shader_stages)
 				.setPVertexInputState(&fullscreen::VERTEX_INPUT_STATE)
 				.setPInputAssemblyState(&constant::TRIANGLE_LIST_INPUT_ASSEMBLY_STATE)
@@ -159,11 +323,29 @@ namespace render
 				.setPDynamicState(&fullscreen::DYNAMIC_STATE_INFO)
 				.setLayout(pipeline_layout);
 		pipeline_create_info.push(pipeline_rendering_create_info);
+		if (hardware_variable_rate) pipeline_create_info.push(constant::ATTACHMENT_SHADING_RATE_STATE);
 
-		auto pipeline_result = context.device.createGraphicsPipeline(nullptr, pipeline_create_info.get());
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
 		if (!pipeline_result) return Error::from(pipeline_result);
 		auto pipeline = std::move(*pipeline_result);
 
+		/*===== Compute Pipeline =====*/
+
+		const auto compute_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(direct_shader)
+				.setPName("main_compute")
+				.setPSpecializationInfo(&specialization_info);
+		const auto compute_pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(compute_stage_create_info).setLayout(pipeline_layout);
+
+		auto compute_pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, compute_pipeline_create_info);
+		if (!compute_pipeline_result) return Error::from(compute_pipeline_result);
+		auto compute_pipeline = std::move(*compute_pipeline_result);
+
 		/*===== Sampler =====*/
 
 		constexpr auto sampler_create_info = vk::SamplerCreateInfo{
@@ -184,11 +366,49 @@ namespace render
 		if (!sampler_result) return Error::from(sampler_result);
 		auto sampler = std::move(*sampler_result);
 
+		// Probe atlases are filtered within their tiles, see `GiProbeVolume`
+		constexpr auto linear_sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eNearest,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = 0.0f,
+		};
+
+		auto linear_sampler_result = context.device.createSampler(linear_sampler_create_info);
+		if (!linear_sampler_result) return Error::from(linear_sampler_result);
+		auto linear_sampler = std::move(*linear_sampler_result);
+
+		// Specular levels are blended by roughness, see `EnvironmentLighting`
+		constexpr auto environment_sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eLinear,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = vk::LodClampNone,
+		};
+
+		auto environment_sampler_result = context.device.createSampler(environment_sampler_create_info);
+		if (!environment_sampler_result) return Error::from(environment_sampler_result);
+		auto environment_sampler = std::move(*environment_sampler_result);
+
 		return DirectLightingPipeline(
 			std::move(descriptor_set_layout),
 			std::move(pipeline_layout),
 			std::move(pipeline),
-			std::move(sampler)
+			std::move(compute_pipeline),
+			std::move(sampler),
+			std::move(linear_sampler),
+			std::move(environment_sampler),
+			hardware_variable_rate
 		);
 	}
 
@@ -217,16 +437,70 @@ namespace render
 				   CTOR_LAMBDA(ResourceSet),
 				   std::views::repeat(descriptor_pool),
 				   sets | std::views::as_rvalue,
-				   std::views::repeat(*sampler)
+				   std::views::repeat(*sampler),
+				   std::views::repeat(*linear_sampler),
+				   std::views::repeat(*environment_sampler)
 			   )
 			| std::ranges::to<std::vector>();
 	}
 
+	DirectLightingPipeline::PushConstant DirectLightingPipeline::get_push_constant(
+		const ResourceSet& resource_set,
+		bool ambient_occlusion,
+		bool global_illumination,
+		bool variable_rate,
+		bool environment,
+		bool atmosphere,
+		std::optional<uint32_t> checkerboard
+	) noexcept
+	{
+		const auto& ao = resource_set->ambient_occlusion;
+
+		// Coarse blocks would share lighting with pixels left unlit
+		const bool coarse = variable_rate && !checkerboard.has_value();
+		const auto checkerboard_code = checkerboard.has_value() ? 1 + *checkerboard % 2 : 0;
+
+		return {
+			.full_size = resource_set->hdr.extent,
+			.mask_size = resource_set->mask_size,
+			.ao_size = ao.extent,
+			.ao_downscale = ambient_occlusion ? ao.downscale : 0,
+			.gi_enabled = global_illumination ? 1u : 0u,
+			.gi_grid = resource_set->gi_grid.get_constant(),
+			.shading_rate_tile = coarse ? resource_set->shading_rate.tile_size : glm::u32vec2(0),
+			.environment_enabled = environment ? 1u : 0u,
+			.atmosphere_enabled = atmosphere ? 1u : 0u,
+			.checkerboard = checkerboard_code,
+		};
+	}
+
+	std::optional<vk::RenderingFragmentShadingRateAttachmentInfoKHR> DirectLightingPipeline::
+		get_shading_rate_attachment_info(const ResourceSet& resource_set) const noexcept
+	{
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		if (!hardware_variable_rate) return std::nullopt;
+
+		const auto& shading_rate = resource_set->shading_rate;
+
+		return vk::RenderingFragmentShadingRateAttachmentInfoKHR{
+			.imageView = shading_rate.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+			.shadingRateAttachmentTexelSize = vulkan::to<vk::Extent2D>(shading_rate.tile_size),
+		};
+	}
+
 	void DirectLightingPipeline::render(
 		const vk::raii::CommandBuffer& command_buffer,
-		const ResourceSet& resource_set
+		const ResourceSet& resource_set,
+		bool ambient_occlusion,
+		bool global_illumination,
+		bool environment,
+		bool atmosphere,
+		std::optional<uint32_t> checkerboard
 	) const noexcept
 	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Direct Lighting");
+
 		DEBUG_ASSERT(resource_set.resource.has_value());
 
 		const auto extent = resource_set->hdr.extent;
@@ -250,17 +524,118 @@ namespace render
 		command_buffer.setScissor(0, {scissor});
 		command_buffer
 			.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline_layout, 0, {resource_set.set}, {});
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			0,
+			get_push_constant(
+				resource_set,
+				ambient_occlusion,
+				global_illumination,
+				false,
+				environment,
+				atmosphere,
+				checkerboard
+			)
+		);
 		command_buffer.draw(6, 1, 0, 0);
 	}
 
+	void DirectLightingPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		bool ambient_occlusion,
+		bool global_illumination,
+		bool variable_rate,
+		bool environment,
+		bool atmosphere,
+		std::optional<uint32_t> checkerboard
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Direct Lighting");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+
+		const auto& hdr = resource_set->hdr;
+
+		/* Pre-lighting barrier */
+
+		// G-buffer pass has written the emission into the HDR attachment
+		const auto pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask =
+				vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = hdr.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		/* Lighting */
+
+		const auto group_count = (hdr.extent + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, compute_pipeline);
+		command_buffer
+			.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeline_layout, 0, {resource_set.set}, {});
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute,
+			0,
+			get_push_constant(
+				resource_set,
+				ambient_occlusion,
+				global_illumination,
+				variable_rate,
+				environment,
+				atmosphere,
+				checkerboard
+			)
+		);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		/* Post-lighting barrier, leaves the same layout as the fragment path */
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask =
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = hdr.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
 	void DirectLightingPipeline::ResourceSet::update(
 		const vulkan::Context& context,
 		DeferredAttachment::View deferred,
 		HdrAttachment::View hdr,
+		ShadowMaskAttachment::View shadow_mask,
+		AmbientOcclusionAttachment::View ambient_occlusion,
 		vulkan::ElementBufferRef<Camera> camera,
-		vulkan::ElementBufferRef<DirectLight> direct_light
+		vulkan::ElementBufferRef<DirectLight> direct_light,
+		const LightList& light_list,
+		vulkan::ArrayBufferRef<glm::mat4> world_transforms,
+		LightClusterAttachment::View light_cluster,
+		GiProbeVolume::View gi_probe,
+		ShadingRateAttachment::View shading_rate,
+		EnvironmentLighting::View environment,
+		AtmospherePipeline::LutView atmosphere
 	) noexcept
 	{
+		DEBUG_ASSERT(shading_rate.extent == hdr.extent, "Shading rate image mismatches HDR attachment");
+
 		/*===== Texture / Buffer Infos =====*/
 
 		const auto albedo_tex_info = vk::DescriptorImageInfo{
@@ -287,6 +662,54 @@ namespace render
 			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
 		};
 
+		const auto shadow_mask_tex_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = shadow_mask.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto ambient_occlusion_tex_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = ambient_occlusion.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto gi_irradiance_tex_info = vk::DescriptorImageInfo{
+			.sampler = linear_sampler,
+			.imageView = gi_probe.irradiance.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto gi_distance_tex_info = vk::DescriptorImageInfo{
+			.sampler = linear_sampler,
+			.imageView = gi_probe.distance.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto environment_specular_tex_info = vk::DescriptorImageInfo{
+			.sampler = environment_sampler,
+			.imageView = environment.specular,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto environment_brdf_lut_info = vk::DescriptorImageInfo{
+			.sampler = linear_sampler,
+			.imageView = environment.brdf_lut,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto atmosphere_transmittance_tex_info = vk::DescriptorImageInfo{
+			.sampler = linear_sampler,
+			.imageView = atmosphere.transmittance,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto atmosphere_sky_view_tex_info = vk::DescriptorImageInfo{
+			.sampler = linear_sampler,
+			.imageView = atmosphere.sky_view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
 		const auto camera_buf_info = vk::DescriptorBufferInfo{
 			.buffer = camera,
 			.offset = 0,
@@ -299,6 +722,26 @@ namespace render
 			.range = vk::WholeSize,
 		};
 
+		const auto hdr_image_info = vk::DescriptorImageInfo{
+			.imageView = hdr.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto shading_rate_image_info = vk::DescriptorImageInfo{
+			.imageView = shading_rate.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto punctual_light_buf_info = whole_buffer_info(light_list.get());
+		const auto transform_buf_info = whole_buffer_info(world_transforms);
+		const auto cluster_light_count_buf_info = whole_buffer_info(light_cluster.light_counts);
+		const auto cluster_light_index_buf_info = whole_buffer_info(light_cluster.light_indices);
+		const auto environment_sh_buf_info = whole_buffer_info(environment.irradiance_sh);
+
 		/*===== Write Descriptor Set =====*/
 
 		const auto albedo_tex_write_descriptor = vk::WriteDescriptorSet{
@@ -337,37 +780,141 @@ namespace render
 			.pImageInfo = &depth_tex_info,
 		};
 
-		const auto camera_buf_write_descriptor = vk::WriteDescriptorSet{
+		const auto shadow_mask_tex_write_descriptor = vk::WriteDescriptorSet{
 			.dstSet = set,
 			.dstBinding = 4,
 			.dstArrayElement = 0,
 			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+			.pImageInfo = &shadow_mask_tex_info,
+		};
+
+		const auto camera_buf_write_descriptor = vk::WriteDescriptorSet{
+			.dstSet = set,
+			.dstBinding = 5,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
 			.descriptorType = vk::DescriptorType::eUniformBuffer,
 			.pBufferInfo = &camera_buf_info,
 		};
 
 		const auto direct_light_buf_write_descriptor = vk::WriteDescriptorSet{
 			.dstSet = set,
-			.dstBinding = 5,
+			.dstBinding = 6,
 			.dstArrayElement = 0,
 			.descriptorCount = 1,
 			.descriptorType = vk::DescriptorType::eUniformBuffer,
 			.pBufferInfo = &direct_light_buf_info,
 		};
 
+		const auto storage_buffer_write_descriptor = [this](uint32_t binding, const auto& buffer_info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &buffer_info,
+			};
+		};
+
 		const auto write_descriptors = std::to_array({
 			albedo_tex_write_descriptor,
 			normal_tex_write_descriptor,
 			pbr_tex_write_descriptor,
 			depth_tex_write_descriptor,
+			shadow_mask_tex_write_descriptor,
 			camera_buf_write_descriptor,
 			direct_light_buf_write_descriptor,
+			storage_buffer_write_descriptor(7, punctual_light_buf_info),
+			storage_buffer_write_descriptor(8, transform_buf_info),
+			storage_buffer_write_descriptor(9, cluster_light_count_buf_info),
+			storage_buffer_write_descriptor(10, cluster_light_index_buf_info),
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 11,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &hdr_image_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 12,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &ambient_occlusion_tex_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 13,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &gi_irradiance_tex_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 14,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &gi_distance_tex_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 15,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &shading_rate_image_info,
+			},
+			storage_buffer_write_descriptor(16, environment_sh_buf_info),
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 17,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &environment_specular_tex_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 18,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &environment_brdf_lut_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 19,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &atmosphere_transmittance_tex_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 20,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &atmosphere_sky_view_tex_info,
+			},
 		});
 
-		context.device.updateDescriptorSets(write_descriptors, {});
+		descriptor_cache.update(context.device, write_descriptors);
 
 		/*===== Store Persistent =====*/
 
-		resource = Resource{.hdr = hdr};
+		resource = Resource{
+			.hdr = hdr,
+			.mask_size = shadow_mask.extent,
+			.ambient_occlusion = ambient_occlusion,
+			.gi_grid = gi_probe.grid,
+			.shading_rate = shading_rate,
+		};
 	}
 }
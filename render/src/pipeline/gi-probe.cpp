@@ -0,0 +1,517 @@
+#include "render/pipeline/gi-probe.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/gi-probe.hpp"
+#include "shader/gi-probe.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto tlas_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto light_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto storage_buffer_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		constexpr auto sampled_image_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		constexpr auto storage_image_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		return std::to_array({
+			tlas_binding,
+			light_binding,
+			storage_buffer_binding(2),  // Primitive attributes
+			storage_buffer_binding(3),  // Indices
+			storage_buffer_binding(4),  // Vertices
+			sampled_image_binding(5),   // Irradiance atlas
+			sampled_image_binding(6),   // Distance atlas
+			storage_buffer_binding(7),  // Probe rays
+			storage_image_binding(8),   // Irradiance atlas
+			storage_image_binding(9),   // Distance atlas
+		});
+	}
+
+	uint32_t GiProbePipeline::get_update_count(
+		const Option& option,
+		const GiProbeVolume::View& volume
+	) noexcept
+	{
+		const auto rays_per_probe = std::clamp(option.rays_per_probe, 1u, MAX_RAYS_PER_PROBE);
+		const auto max_count = std::max(
+			std::min(volume.grid.probe_count(), volume.ray_capacity / rays_per_probe),
+			1u
+		);
+
+		return std::clamp(option.ray_budget / rays_per_probe, 1u, max_count);
+	}
+
+	std::optional<GiProbePipeline::Option> GiProbePipeline::get_bake_option(
+		const Option& option,
+		const GiProbeVolume::View& volume,
+		uint32_t pass_count,
+		uint32_t bake_frame
+	) noexcept
+	{
+		auto bake_option = option;
+		bake_option.ray_budget = volume.ray_capacity;
+
+		const auto probe_count = uint64_t(volume.grid.probe_count());
+		const auto updated = uint64_t(bake_frame) * get_update_count(bake_option, volume);
+		if (updated >= probe_count * pass_count) return std::nullopt;
+
+		// Probes of a frame wrapping around the grid start the next pass one update early
+		const auto pass = static_cast<float>(updated / probe_count);
+		bake_option.hysteresis = pass / (pass + 1.0f);
+
+		return bake_option;
+	}
+
+	uint32_t GiProbePipeline::get_frame_count(
+		const Option& option,
+		const GiProbeVolume::View& volume,
+		uint32_t pass_count
+	) noexcept
+	{
+		const auto updates = uint64_t(volume.grid.probe_count()) * pass_count;
+		const auto update_count = get_update_count(option, volume);
+		return static_cast<uint32_t>((updates + update_count - 1) / update_count);
+	}
+
+	std::expected<GiProbePipeline, Error> GiProbePipeline::create(
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format
+	) noexcept
+	{
+		if (!context.feature.raytracing)
+			return Error("Missing raytracing feature", "Probe update requires raytracing feature");
+
+		auto shader_module_result = vulkan::create_shader(context.device, shader::gi_probe);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({
+			material_layout.layout,
+			descriptor_set_layout,
+		});
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(set_layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto spec_data = SpecializationConstant{
+			.packed_vertex = vertex_format == VertexFormat::Packed ? vk::True : vk::False
+		};
+		const auto packed_vertex_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = offsetof(SpecializationConstant, packed_vertex),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto specialization_info =
+			vk::SpecializationInfo()
+				.setMapEntries(packed_vertex_spec_entry)
+				.setData<SpecializationConstant>(spec_data);
+
+		const auto create_pipeline =
+			[&](const char* entry_point) -> std::expected<vk::raii::Pipeline, Error> {
+			const auto stage_create_info =
+				vk::PipelineShaderStageCreateInfo()
+					.setStage(vk::ShaderStageFlagBits::eCompute)
+					.setModule(shader_module)
+					.setPName(entry_point)
+					.setPSpecializationInfo(&specialization_info);
+			const auto pipeline_create_info =
+				vk::ComputePipelineCreateInfo().setStage(stage_create_info).setLayout(pipeline_layout);
+
+			auto pipeline_result =
+				context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			return std::move(*pipeline_result);
+		};
+
+		auto trace_pipeline_result = create_pipeline("main_trace");
+		if (!trace_pipeline_result)
+			return trace_pipeline_result.error().forward("Create probe trace pipeline failed");
+		auto trace_pipeline = std::move(*trace_pipeline_result);
+
+		auto update_pipeline_result = create_pipeline("main_update");
+		if (!update_pipeline_result)
+			return update_pipeline_result.error().forward("Create probe update pipeline failed");
+		auto update_pipeline = std::move(*update_pipeline_result);
+
+		/*===== Sampler =====*/
+
+		// Bilinear within a tile, the borders of the tiles keep the filter from reaching the neighbors
+		constexpr auto sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eNearest,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = 0.0f,
+		};
+
+		auto sampler_result = context.device.createSampler(sampler_create_info);
+		if (!sampler_result) return Error::from(sampler_result);
+		auto sampler = std::move(*sampler_result);
+
+		return GiProbePipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(trace_pipeline),
+			std::move(update_pipeline),
+			std::move(sampler),
+			vertex_format
+		);
+	}
+
+	std::expected<std::vector<GiProbePipeline::ResourceSet>, Error> GiProbePipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue,
+				   std::views::repeat(*sampler)
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void GiProbePipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		uint32_t frame_index
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "GI Probe");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
+
+		const auto& volume = resource_set->volume;
+		const auto probe_count = volume.grid.probe_count();
+		const auto update_count = get_update_count(option, volume);
+		const auto rays_per_probe = std::clamp(option.rays_per_probe, 1u, MAX_RAYS_PER_PROBE);
+
+		const auto push_constant = PushConstant{
+			.grid = volume.grid.get_constant(),
+			.first_probe = static_cast<uint32_t>((uint64_t(frame_index) * update_count) % probe_count),
+			.update_count = update_count,
+			.rays_per_probe = rays_per_probe,
+			.frame_index = frame_index,
+			.hysteresis = std::clamp(option.hysteresis, 0.0f, 1.0f),
+		};
+
+		const auto atlas_barrier = [](vk::Image image,
+									  vk::PipelineStageFlags2 src_stage,
+									  vk::AccessFlags2 src_access,
+									  vk::PipelineStageFlags2 dst_stage,
+									  vk::AccessFlags2 dst_access) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = src_stage,
+				.srcAccessMask = src_access,
+				.dstStageMask = dst_stage,
+				.dstAccessMask = dst_access,
+				.oldLayout = vk::ImageLayout::eGeneral,
+				.newLayout = vk::ImageLayout::eGeneral,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		};
+
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{resource_set->material_descriptor_set, *resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+
+		/* Trace */
+
+		// Rays of the previous frame are overwritten, after its update has read them
+		const auto pre_trace_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(pre_trace_barrier));
+
+		const auto ray_count = update_count * rays_per_probe;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, trace_pipeline);
+		command_buffer.dispatch((ray_count + TRACE_WORKGROUP_SIZE - 1) / TRACE_WORKGROUP_SIZE, 1, 1);
+
+		/* Update */
+
+		// Rays are read by the update, and the atlases sampled by the trace and by the lighting of the
+		// previous frame are overwritten
+		const auto pre_update_memory_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+		};
+		const auto pre_update_image_barriers = std::to_array({
+			atlas_barrier(
+				volume.irradiance.image,
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderSampledRead,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite
+			),
+			atlas_barrier(
+				volume.distance.image,
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderSampledRead,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite
+			),
+		});
+		command_buffer.pipelineBarrier2(
+			vk::DependencyInfo()
+				.setMemoryBarriers(pre_update_memory_barrier)
+				.setImageMemoryBarriers(pre_update_image_barriers)
+		);
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, update_pipeline);
+		command_buffer.dispatch(update_count, 1, 1);
+
+		/* Make the atlases visible to the lighting and to the trace of the next frame */
+
+		const auto post_barriers = std::to_array({
+			atlas_barrier(
+				volume.irradiance.image,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite,
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageRead
+			),
+			atlas_barrier(
+				volume.distance.image,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite,
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageRead
+			),
+		});
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barriers));
+	}
+
+	void GiProbePipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const Tlas& tlas,
+		GiProbeVolume::View volume,
+		vulkan::ElementBufferRef<DirectLight> direct_light
+	) noexcept
+	{
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto tlas_handle = static_cast<vk::AccelerationStructureKHR>(tlas);
+		const auto tlas_info =
+			vk::WriteDescriptorSetAccelerationStructureKHR().setAccelerationStructures(tlas_handle);
+
+		const auto direct_light_buf_info = vk::DescriptorBufferInfo{
+			.buffer = direct_light,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto primitive_attr_buf_info = whole_buffer_info(model.mesh_list->trace_primitive_attr_buffer);
+		const auto index_buf_info = whole_buffer_info(model.mesh_list->index_buffer);
+		const auto vertex_buf_info = whole_buffer_info(model.mesh_list->vertex_buffer);
+		const auto ray_buf_info = whole_buffer_info(volume.rays);
+
+		const auto irradiance_sampled_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = volume.irradiance.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto distance_sampled_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = volume.distance.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto irradiance_storage_info = vk::DescriptorImageInfo{
+			.imageView = volume.irradiance.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto distance_storage_info = vk::DescriptorImageInfo{
+			.imageView = volume.distance.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		/*===== Write Descriptor Set =====*/
+
+		const auto buffer_write = [this](uint32_t binding, const vk::DescriptorBufferInfo& info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &info,
+			};
+		};
+
+		const auto image_write =
+			[this](uint32_t binding, vk::DescriptorType type, const vk::DescriptorImageInfo& info) {
+				return vk::WriteDescriptorSet{
+					.dstSet = set,
+					.dstBinding = binding,
+					.descriptorCount = 1,
+					.descriptorType = type,
+					.pImageInfo = &info,
+				};
+			};
+
+		const auto write_descriptors = std::to_array({
+			vk::WriteDescriptorSet{
+				.pNext = &tlas_info,
+				.dstSet = set,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 1,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &direct_light_buf_info,
+			},
+			buffer_write(2, primitive_attr_buf_info),
+			buffer_write(3, index_buf_info),
+			buffer_write(4, vertex_buf_info),
+			image_write(5, vk::DescriptorType::eCombinedImageSampler, irradiance_sampled_info),
+			image_write(6, vk::DescriptorType::eCombinedImageSampler, distance_sampled_info),
+			buffer_write(7, ray_buf_info),
+			image_write(8, vk::DescriptorType::eStorageImage, irradiance_storage_info),
+			image_write(9, vk::DescriptorType::eStorageImage, distance_storage_info),
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{
+			.material_descriptor_set = model.material_list.get_descriptor_set(),
+			.vertex_format = model.mesh_list->vertex_format,
+			.volume = volume,
+		};
+	}
+}
@@ -0,0 +1,262 @@
+#include "render/pipeline/hiz.hpp"
+#include "common/number-literals.hpp"
+#include "common/util/error.hpp"
+#include "render/resource/hiz.hpp"
+#include "shader/hiz.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto src_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto dst_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({src_binding, dst_binding});
+	}
+
+	static vk::ImageSubresourceRange get_hiz_range(uint32_t base_level, uint32_t level_count) noexcept
+	{
+		return vk::ImageSubresourceRange{
+			.aspectMask = vk::ImageAspectFlagBits::eColor,
+			.baseMipLevel = base_level,
+			.levelCount = level_count,
+			.baseArrayLayer = 0,
+			.layerCount = 1,
+		};
+	}
+
+	std::expected<HizPipeline, Error> HizPipeline::create(const vulkan::Context& context) noexcept
+	{
+		auto shader_module_result = vulkan::create_shader(context.device, shader::hiz);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*descriptor_set_layout)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main");
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+		auto pipeline = std::move(*pipeline_result);
+
+		return HizPipeline(std::move(descriptor_set_layout), std::move(pipeline_layout), std::move(pipeline));
+	}
+
+	std::expected<std::vector<HizPipeline::ResourceSet>, Error> HizPipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto set_count = count * HizAttachment::MAX_LEVELS;
+		const auto descriptor_pool_sizes = vulkan::calc_pool_sizes(bindings, set_count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(set_count)
+				.setPoolSizes(descriptor_pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(HizAttachment::MAX_LEVELS, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+
+		const auto create_resource_set_fn =
+			[&set_alloc_info, &context, &descriptor_pool] -> std::expected<ResourceSet, Error> {
+			auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+			if (!sets_result) return Error::from(sets_result);
+			return ResourceSet(descriptor_pool, std::move(*sets_result));
+		};
+
+		return std::views::repeat(create_resource_set_fn, count)
+			| std::views::transform([](auto&& f) { return f(); })
+			| Error::collect();
+	}
+
+	void HizPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "HiZ");
+
+		DEBUG_ASSERT(resource_set.hiz.has_value());
+		const auto& hiz = *resource_set.hiz;
+
+		/* Pre-build layout transition, previous content is discarded */
+
+		const auto pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = hiz.image,
+			.subresourceRange = get_hiz_range(0, hiz.level_count)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		/* Build each level */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+
+		for (const auto level : std::views::iota(0_u32, hiz.level_count))
+		{
+			const auto push_constant = PushConstant{
+				.src_size = level == 0 ? hiz.extent : hiz.level_extent(level - 1),
+				.dst_size = hiz.level_extent(level),
+			};
+			const auto group_count = (push_constant.dst_size + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eCompute,
+				pipeline_layout,
+				0,
+				*resource_set.descriptor_sets[level],
+				{}
+			);
+			command_buffer.pushConstants<PushConstant>(
+				*pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				push_constant
+			);
+			command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+			const auto level_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+				.oldLayout = vk::ImageLayout::eGeneral,
+				.newLayout = vk::ImageLayout::eGeneral,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = hiz.image,
+				.subresourceRange = get_hiz_range(level, 1)
+			};
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(level_barrier));
+		}
+	}
+
+	void HizPipeline::discard(const vk::raii::CommandBuffer& command_buffer, HizAttachment::View hiz) noexcept
+	{
+		const auto barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = hiz.image,
+			.subresourceRange = get_hiz_range(0, hiz.level_count)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(barrier));
+	}
+
+	void HizPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		vulkan::AttachmentView depth,
+		HizAttachment::View hiz
+	) noexcept
+	{
+		for (const auto level : std::views::iota(0_u32, hiz.level_count))
+		{
+			// Level 0 is built from the depth attachment, others from the previous level
+			const auto src_layout =
+				level == 0 ? vk::ImageLayout::eShaderReadOnlyOptimal : vk::ImageLayout::eGeneral;
+			const auto src_image_info = vk::DescriptorImageInfo{
+				.imageView = level == 0 ? depth.view : hiz.level_views[level - 1],
+				.imageLayout = src_layout
+			};
+
+			const auto dst_image_info = vk::DescriptorImageInfo{
+				.imageView = hiz.level_views[level],
+				.imageLayout = vk::ImageLayout::eGeneral
+			};
+
+			const auto write_descriptor_sets = std::to_array({
+				vk::WriteDescriptorSet{
+					.dstSet = descriptor_sets[level],
+					.dstBinding = 0,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eSampledImage,
+					.pImageInfo = &src_image_info
+				},
+				vk::WriteDescriptorSet{
+					.dstSet = descriptor_sets[level],
+					.dstBinding = 1,
+					.descriptorCount = 1,
+					.descriptorType = vk::DescriptorType::eStorageImage,
+					.pImageInfo = &dst_image_info
+				},
+			});
+
+			descriptor_cache.update(context.device, write_descriptor_sets);
+		}
+
+		this->hiz = hiz;
+	}
+}
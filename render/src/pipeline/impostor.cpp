@@ -0,0 +1,313 @@
+#include "render/pipeline/impostor.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/model.hpp"
+#include "render/pipeline/util/constant.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "shader/impostor.hpp"
+#include "vulkan/container/host/linked-struct.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	namespace
+	{
+		// Node transforms are also read by the fragment shader, for the normals
+		constexpr auto get_storage_buffer_binding(uint32_t binding) noexcept
+		{
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
+			};
+		}
+
+		constexpr auto get_atlas_binding(uint32_t binding) noexcept
+		{
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment
+			};
+		}
+
+		constexpr auto RESOURCE_BINDINGS = std::to_array({
+			get_storage_buffer_binding(0),  // Impostor instances
+			get_storage_buffer_binding(1),  // Impostors
+			get_storage_buffer_binding(2),  // Node transforms
+			get_storage_buffer_binding(3),  // Previous node transforms
+			vk::DescriptorSetLayoutBinding{
+				.binding = 4,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex
+			},                     // Camera
+			get_atlas_binding(5),  // Albedo atlas
+			get_atlas_binding(6),  // Normal-depth atlas
+		});
+	}
+
+	std::expected<ImpostorPipeline, Error> ImpostorPipeline::create(
+		const vulkan::Context& context,
+		vk::Format hdr_format
+	) noexcept
+	{
+		/*===== Descriptor Set Layout =====*/
+
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(RESOURCE_BINDINGS)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		/*===== Pipeline Layout =====*/
+
+		const auto layouts = std::to_array<vk::DescriptorSetLayout>({descriptor_set_layout});
+		auto pipeline_layout_result =
+			context.device.createPipelineLayout(vk::PipelineLayoutCreateInfo().setSetLayouts(layouts));
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		/*===== Shader Modules =====*/
+
+		auto shader_module_result = vulkan::create_shader(context.device, shader::impostor);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		const auto shader_stages = std::to_array({
+			vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eVertex,
+				.module = shader_module,
+				.pName = "main_vertex"
+			},
+			vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eFragment,
+				.module = shader_module,
+				.pName = "main_fragment"
+			},
+		});
+
+		/*===== Pipeline =====*/
+
+		// Quads are generated from the vertex index
+		constexpr auto vertex_input_state = vk::PipelineVertexInputStateCreateInfo{};
+
+		// Quads face the frame nearest to the camera, which may lean away from it
+		const auto rasterization_state = gbuffer::get_rasterization_state(true);
+
+		const auto color_blend_state =
+			vk::PipelineColorBlendStateCreateInfo().setAttachments(gbuffer::COLOR_BLEND_ATTACHMENT_STATES);
+
+		const auto color_formats = gbuffer::get_color_formats(hdr_format);
+		const auto pipeline_rendering_create_info =
+			vk::PipelineRenderingCreateInfo()
+				.setColorAttachmentFormats(color_formats)
+				.setDepthAttachmentFormat(DeferredAttachment::DEPTH_FORMAT);
+
+		const auto dynamic_state_info =
+			vk::PipelineDynamicStateCreateInfo().setDynamicStates(constant::DYNAMIC_VIEWPORT_DYNSTATE);
+
+		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
+			vk::GraphicsPipelineCreateInfo()
+				.setStages(shader_stages)
+				.setPVertexInputState(&vertex_input_state)
+				.setPInputAssemblyState(&constant::TRIANGLE_LIST_INPUT_ASSEMBLY_STATE)
+				.setPRasterizationState(&rasterization_state)
+				.setPMultisampleState(&constant::BASIC_MULTISAMPLE_STATE)
+				.setPDepthStencilState(&gbuffer::DEPTH_STENCIL_STATE)
+				.setPColorBlendState(&color_blend_state)
+				.setPViewportState(&constant::DYNAMIC_VIEWPORT_STATE)
+				.setPDynamicState(&dynamic_state_info)
+				.setLayout(pipeline_layout);
+		pipeline_create_info.push(pipeline_rendering_create_info);
+
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
+		if (!pipeline_result) return Error::from(pipeline_result);
+
+		return ImpostorPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(*pipeline_result)
+		);
+	}
+
+	std::expected<std::vector<ImpostorPipeline::ResourceSet>, Error> ImpostorPipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		const auto pool_sizes = vulkan::calc_pool_sizes(RESOURCE_BINDINGS, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void ImpostorPipeline::render(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Impostors");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+
+		gbuffer::begin_rendering(command_buffer, resource_set.resource->attachment, DrawPhase::Late);
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eGraphics,
+			*pipeline_layout,
+			0,
+			{resource_set.descriptor_set},
+			{}
+		);
+		command_buffer.drawIndirect(
+			resource_set.resource->command_buffer,
+			0,
+			1,
+			sizeof(vk::DrawIndirectCommand)
+		);
+
+		gbuffer::end_rendering(command_buffer, resource_set.resource->attachment);
+	}
+
+	void ImpostorPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const TransformResource& transform,
+		const TransformResource& prev_transform,
+		const IndirectResource& indirect_resource,
+		DeferredAttachment::View deferred_attachment,
+		HdrAttachment::View hdr_attachment,
+		vulkan::ElementBufferRef<Camera> camera_param
+	) noexcept
+	{
+		// Impostor buffers are never empty even without impostors, see `ImpostorList::create`
+		const auto impostor_list = model.impostor_list.get();
+
+		const auto buffer_infos = std::to_array({
+			vk::DescriptorBufferInfo{
+				.buffer = indirect_resource.impostor_instance_ref(),
+				.offset = 0,
+				.range = vk::WholeSize
+			},
+			vk::DescriptorBufferInfo{
+				.buffer = impostor_list.impostor_buffer,
+				.offset = 0,
+				.range = vk::WholeSize
+			},
+			vk::DescriptorBufferInfo{
+				.buffer = transform->world_transform,
+				.offset = 0,
+				.range = transform->world_transform.size_vk()
+			},
+			vk::DescriptorBufferInfo{
+				.buffer = prev_transform->world_transform,
+				.offset = 0,
+				.range = prev_transform->world_transform.size_vk()
+			},
+		});
+
+		const auto camera_buffer_info =
+			vk::DescriptorBufferInfo{.buffer = camera_param, .offset = 0, .range = vk::WholeSize};
+
+		const auto albedo_image_info = vk::DescriptorImageInfo{
+			.sampler = impostor_list.sampler,
+			.imageView = impostor_list.albedo_view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+		};
+
+		const auto normal_depth_image_info = vk::DescriptorImageInfo{
+			.sampler = impostor_list.sampler,
+			.imageView = impostor_list.normal_depth_view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+		};
+
+		const auto get_buffer_write = [this, &buffer_infos](uint32_t binding) {
+			return vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = binding,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &buffer_infos[binding]
+			};
+		};
+
+		const auto write_descriptor_sets = std::to_array({
+			get_buffer_write(0),
+			get_buffer_write(1),
+			get_buffer_write(2),
+			get_buffer_write(3),
+			vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 4,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &camera_buffer_info
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 5,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &albedo_image_info
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 6,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo = &normal_depth_image_info
+			},
+		});
+
+		descriptor_cache.update(context.device, write_descriptor_sets);
+
+		resource = Resource{
+			.command_buffer = indirect_resource.impostor_command_ref(),
+			.attachment = gbuffer::Attachment::from(deferred_attachment, hdr_attachment),
+		};
+	}
+}
@@ -3,15 +3,19 @@
 #include "common/util/error.hpp"
 #include "render/interface/camera.hpp"
 #include "render/model/model.hpp"
-#include "render/resource/host.hpp"
+#include "render/resource/hiz.hpp"
 #include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "shader/indirect-wave.hpp"
 #include "shader/indirect.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
 #include "vulkan/util/shader.hpp"
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <libassert/assert.hpp>
@@ -63,12 +67,180 @@ namespace render
 			.stageFlags = vk::ShaderStageFlagBits::eCompute,
 		};
 
+		constexpr auto draw_count_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 5,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto late_candidates_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 6,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto prev_hiz_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 7,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto curr_hiz_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 8,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto commands_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 9,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto instance_groups_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 10,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto instance_states_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 11,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto primitive_feedback_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 12,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto views_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 13,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto view_entries_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 14,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto view_commands_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 15,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto view_groups_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 16,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto group_depths_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 17,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto sort_buckets_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 18,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto drawcall_bounds_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 19,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto hlod_clusters_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 20,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto node_hlods_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 21,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto primitive_impostors_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 22,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto impostors_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 23,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto impostor_instances_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 24,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto impostor_command_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 25,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
 		return std::to_array({
 			indirect_entries_binding,
 			drawcalls_binding,
 			node_transforms_binding,
 			primitive_attrs_binding,
 			camera_binding,
+			draw_count_binding,
+			late_candidates_binding,
+			prev_hiz_binding,
+			curr_hiz_binding,
+			commands_binding,
+			instance_groups_binding,
+			instance_states_binding,
+			primitive_feedback_binding,
+			views_binding,
+			view_entries_binding,
+			view_commands_binding,
+			view_groups_binding,
+			group_depths_binding,
+			sort_buckets_binding,
+			drawcall_bounds_binding,
+			hlod_clusters_binding,
+			node_hlods_binding,
+			primitive_impostors_binding,
+			impostors_binding,
+			impostor_instances_binding,
+			impostor_command_binding,
 		});
 	}
 
@@ -87,7 +259,8 @@ namespace render
 
 	static std::expected<vk::raii::PipelineLayout, Error> create_pipeline_layout(
 		const vulkan::Context& context,
-		const vk::raii::DescriptorSetLayout& data_descriptor_set_layout
+		const vk::raii::DescriptorSetLayout& data_descriptor_set_layout,
+		uint32_t push_constant_size
 	) noexcept
 	{
 		const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({data_descriptor_set_layout});
@@ -95,7 +268,7 @@ namespace render
 		const auto push_constant_range = vk::PushConstantRange{
 			.stageFlags = vk::ShaderStageFlagBits::eCompute,
 			.offset = 0,
-			.size = sizeof(uint32_t)
+			.size = push_constant_size
 		};
 
 		const auto create_info =
@@ -108,38 +281,93 @@ namespace render
 		return std::move(*layout_result);
 	}
 
+	// Subgroup operations used by `indirect-wave.slang`
+	static bool supports_wave_culling(const vk::raii::PhysicalDevice& phy_device) noexcept
+	{
+		constexpr auto required_operations =
+			vk::SubgroupFeatureFlagBits::eBasic | vk::SubgroupFeatureFlagBits::eBallot;
+
+		const auto properties = phy_device.getProperties2<
+			vk::PhysicalDeviceProperties2,
+			vk::PhysicalDeviceSubgroupProperties
+		>();
+		const auto& subgroup_properties = properties.get<vk::PhysicalDeviceSubgroupProperties>();
+
+		return (subgroup_properties.supportedStages & vk::ShaderStageFlagBits::eCompute)
+			&& (subgroup_properties.supportedOperations & required_operations) == required_operations;
+	}
+
 	std::expected<IndirectPipeline, Error> IndirectPipeline::create(const vulkan::Context& context) noexcept
 	{
 		auto shader_module_result = vulkan::create_shader(context.device, shader::indirect);
 		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
 		auto shader_module = std::move(*shader_module_result);
 
+		// Only the cull step shares per-node loads across the subgroup, the other steps have nothing to share
+		const auto wave_culling = supports_wave_culling(context.phy_device);
+		auto cull_shader_module_result = wave_culling
+			? vulkan::create_shader(context.device, shader::indirect_wave)
+			: vulkan::create_shader(context.device, shader::indirect);
+		if (!cull_shader_module_result)
+			return cull_shader_module_result.error().forward("Create cull shader module failed");
+		auto cull_shader_module = std::move(*cull_shader_module_result);
+
 		auto descriptor_set_layout_result = create_descriptor_set_layout(context);
 		if (!descriptor_set_layout_result)
 			return descriptor_set_layout_result.error().forward("Create descriptor set layout failed");
 		auto data_descriptor_set_layout = std::move(*descriptor_set_layout_result);
 
-		auto pipeline_layout_result = create_pipeline_layout(context, data_descriptor_set_layout);
+		auto pipeline_layout_result =
+			create_pipeline_layout(context, data_descriptor_set_layout, sizeof(PushConstant));
 		if (!pipeline_layout_result)
 			return pipeline_layout_result.error().forward("Create pipeline layout failed");
 		auto pipeline_layout = std::move(*pipeline_layout_result);
 
-		const auto pipeline_stage_create_info =
-			vk::PipelineShaderStageCreateInfo()
-				.setStage(vk::ShaderStageFlagBits::eCompute)
-				.setModule(shader_module)
-				.setPName("main");
-		const auto pipeline_create_info =
-			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+		const auto create_pipeline = [&](const char* entry, const vk::raii::ShaderModule& module)
+			-> std::expected<vk::raii::Pipeline, Error> {
+			const auto pipeline_stage_create_info =
+				vk::PipelineShaderStageCreateInfo()
+					.setStage(vk::ShaderStageFlagBits::eCompute)
+					.setModule(module)
+					.setPName(entry);
+			const auto pipeline_create_info =
+				vk::ComputePipelineCreateInfo()
+					.setStage(pipeline_stage_create_info)
+					.setLayout(pipeline_layout);
+
+			auto pipeline_result =
+				context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			return std::move(*pipeline_result);
+		};
+
+		auto cull_pipeline_result = create_pipeline("main", cull_shader_module);
+		if (!cull_pipeline_result) return cull_pipeline_result.error().forward("Create cull pipeline failed");
+
+		auto sort_count_pipeline_result = create_pipeline("main_sort_count", shader_module);
+		if (!sort_count_pipeline_result)
+			return sort_count_pipeline_result.error().forward("Create sort count pipeline failed");
 
-		auto pipeline_result = context.device.createComputePipeline(nullptr, pipeline_create_info);
-		if (!pipeline_result) return Error::from(pipeline_result);
-		auto pipeline = std::move(*pipeline_result);
+		auto sort_prefix_pipeline_result = create_pipeline("main_sort_prefix", shader_module);
+		if (!sort_prefix_pipeline_result)
+			return sort_prefix_pipeline_result.error().forward("Create sort prefix pipeline failed");
+
+		auto allocate_pipeline_result = create_pipeline("main_allocate", shader_module);
+		if (!allocate_pipeline_result)
+			return allocate_pipeline_result.error().forward("Create allocate pipeline failed");
+
+		auto scatter_pipeline_result = create_pipeline("main_scatter", shader_module);
+		if (!scatter_pipeline_result)
+			return scatter_pipeline_result.error().forward("Create scatter pipeline failed");
 
 		return IndirectPipeline(
 			std::move(data_descriptor_set_layout),
 			std::move(pipeline_layout),
-			std::move(pipeline)
+			std::move(*cull_pipeline_result),
+			std::move(*sort_count_pipeline_result),
+			std::move(*sort_prefix_pipeline_result),
+			std::move(*allocate_pipeline_result),
+			std::move(*scatter_pipeline_result)
 		);
 	}
 
@@ -195,43 +423,192 @@ namespace render
 
 	void IndirectPipeline::compute(
 		const vk::raii::CommandBuffer& command_buffer,
-		const ResourceSet& resource_set
+		const ResourceSet& resource_set,
+		DrawPhase phase,
+		bool occlusion_enabled,
+		float lod_threshold,
+		bool sort_enabled,
+		float hlod_threshold,
+		float impostor_threshold
 	) const noexcept
 	{
-		DEBUG_ASSERT(resource_set.indirect_buffers.has_value());
+		const auto* label_name = phase == DrawPhase::Early ? "Culling (Early)" : "Culling (Late)";
+		const auto label = vulkan::DebugLabel(command_buffer, label_name);
 
-		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+		DEBUG_ASSERT(resource_set.resource.has_value());
 
-		for (
-			const auto [descriptor_set, buffer] :
-			std::views::zip(resource_set.descriptor_sets.all(), resource_set.indirect_buffers->all())
-		)
+		if (phase == DrawPhase::Early)
 		{
-			if (buffer.count() == 0) continue;
-
-			const auto group_count = (buffer.count() + WORKGROUP_SIZE) / WORKGROUP_SIZE;
-			const auto push_constant = static_cast<uint32_t>(buffer.count());
+			/*
+			 * Clear draw counts, instance groups and sort buffers of both phases and all views, late phase
+			 * reuses the counts and candidates from early phase
+			 */
 
-			command_buffer
-				.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeline_layout, 0, *descriptor_set, {});
+			for (const auto& count_buffer : resource_set.resource->count_buffers.all())
+				command_buffer.fillBuffer(count_buffer, 0, vk::WholeSize, 0);
+			for (const auto& group_buffer : resource_set.resource->group_buffers.all())
+				command_buffer.fillBuffer(group_buffer, 0, vk::WholeSize, 0);
+			for (const auto& group_buffer : resource_set.resource->view_group_buffers.all())
+				command_buffer.fillBuffer(group_buffer, 0, vk::WholeSize, 0);
+			for (const auto& depth_buffer : resource_set.resource->group_depth_buffers.all())
+				command_buffer.fillBuffer(depth_buffer, 0, vk::WholeSize, 0xFFFFFFFF);
+			for (const auto& bucket_buffer : resource_set.resource->sort_bucket_buffers.all())
+				command_buffer.fillBuffer(bucket_buffer, 0, vk::WholeSize, 0);
 
-			command_buffer.pushConstants<uint32_t>(
-				*pipeline_layout,
-				vk::ShaderStageFlagBits::eCompute,
+			// One quad per impostor instance, instances are counted by the early phase
+			const auto impostor_command = vk::DrawIndirectCommand{
+				.vertexCount = 6,
+				.instanceCount = 0,
+				.firstVertex = 0,
+				.firstInstance = 0
+			};
+			command_buffer.updateBuffer<vk::DrawIndirectCommand>(
+				resource_set.resource->impostor_command_buffer,
 				0,
-				push_constant
+				impostor_command
 			);
 
-			command_buffer.dispatch(group_count, 1, 1);
+			static constexpr auto get_clear_barrier = [](vk::Buffer buffer) {
+				return vk::BufferMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+					.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+					.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+					.dstAccessMask = vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite,
+					.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+					.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+					.buffer = buffer,
+					.offset = 0,
+					.size = vk::WholeSize
+				};
+			};
+
+			const auto count_clear_barriers = resource_set.resource->count_buffers.as_ref_array()
+				| util::map_array([](auto&& buffer) { return get_clear_barrier(buffer.get()); });
+			const auto group_clear_barriers = resource_set.resource->group_buffers.as_ref_array()
+				| util::map_array([](auto&& buffer) { return get_clear_barrier(buffer.get()); });
+			const auto view_group_clear_barriers = resource_set.resource->view_group_buffers.as_ref_array()
+				| util::map_array([](auto&& buffer) { return get_clear_barrier(buffer.get()); });
+			const auto depth_clear_barriers = resource_set.resource->group_depth_buffers.as_ref_array()
+				| util::map_array([](auto&& buffer) { return get_clear_barrier(buffer.get()); });
+			const auto bucket_clear_barriers = resource_set.resource->sort_bucket_buffers.as_ref_array()
+				| util::map_array([](auto&& buffer) { return get_clear_barrier(buffer.get()); });
+			const auto impostor_clear_barriers =
+				std::to_array({get_clear_barrier(resource_set.resource->impostor_command_buffer)});
+			const auto clear_barriers = util::array_concat(
+				count_clear_barriers,
+				group_clear_barriers,
+				view_group_clear_barriers,
+				depth_clear_barriers,
+				bucket_clear_barriers,
+				impostor_clear_barriers
+			);
+
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(clear_barriers));
+		}
+
+		/* Compute */
+
+		// Additional views are culled along with the early phase, their groups are allocated after the main
+		// camera groups
+		const auto view_count = phase == DrawPhase::Early ? resource_set.resource->view_count : 0u;
+
+		// Thread count of a step, one thread per drawcall, per group of every view, or a single thread
+		enum class StepSize
+		{
+			Drawcall,
+			Group,
+			Single
+		};
+
+		// Each step reads the counts, groups and states written by the previous step in all render states
+		const auto dispatch_step = [&](const vk::raii::Pipeline& step_pipeline, StepSize step_size) {
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, step_pipeline);
+
+			for (
+				const auto [descriptor_set, buffer, group_buffer] : std::views::zip(
+					resource_set.descriptor_sets.all(),
+					resource_set.resource->indirect_buffers.all(),
+					resource_set.resource->group_buffers.all()
+				)
+			)
+			{
+				const auto drawcall_count = IndirectResource::phase_capacity(buffer);
+				if (drawcall_count == 0) continue;
+
+				const auto instance_group_count = IndirectResource::group_count(group_buffer);
+				const auto group_thread_count = instance_group_count * (view_count + 1);
+				size_t thread_count = 1;
+				if (step_size == StepSize::Drawcall) thread_count = drawcall_count;
+				if (step_size == StepSize::Group) thread_count = group_thread_count;
+				const auto workgroup_count = (thread_count + WORKGROUP_SIZE) / WORKGROUP_SIZE;
+				const auto push_constant = PushConstant{
+					.drawcall_count = static_cast<uint32_t>(drawcall_count),
+					.phase = phase == DrawPhase::Early ? 0u : 1u,
+					.occlusion_enabled = occlusion_enabled ? 1u : 0u,
+					.lod_threshold = lod_threshold,
+					.prev_hiz_size = resource_set.resource->prev_hiz_size,
+					.curr_hiz_size = resource_set.resource->curr_hiz_size,
+					.group_count = static_cast<uint32_t>(instance_group_count),
+					.view_count = view_count,
+					.sort_enabled = sort_enabled ? 1u : 0u,
+					.hlod_threshold = hlod_threshold,
+					.impostor_threshold = impostor_threshold,
+				};
+
+				command_buffer.bindDescriptorSets(
+					vk::PipelineBindPoint::eCompute,
+					pipeline_layout,
+					0,
+					*descriptor_set,
+					{}
+				);
+
+				command_buffer.pushConstants<PushConstant>(
+					*pipeline_layout,
+					vk::ShaderStageFlagBits::eCompute,
+					0,
+					push_constant
+				);
+
+				command_buffer.dispatch(workgroup_count, 1, 1);
+			}
+		};
+
+		const auto step_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite,
+		};
+
+		dispatch_step(cull_pipeline, StepSize::Drawcall);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(step_barrier));
+
+		if (sort_enabled)
+		{
+			dispatch_step(sort_count_pipeline, StepSize::Group);
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(step_barrier));
+			dispatch_step(sort_prefix_pipeline, StepSize::Single);
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(step_barrier));
 		}
 
+		dispatch_step(allocate_pipeline, StepSize::Group);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(step_barrier));
+		dispatch_step(scatter_pipeline, StepSize::Drawcall);
+
+		/* Sync */
+
+		// Counts and candidates are also read by the late phase compute
 		static constexpr auto get_sync_barrier = [](vk::Buffer buffer) {
 			return vk::BufferMemoryBarrier2{
 				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
 				.srcAccessMask = vk::AccessFlagBits2::eShaderWrite,
-				.dstStageMask =
-					vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eVertexShader,
-				.dstAccessMask = vk::AccessFlagBits2::eIndirectCommandRead | vk::AccessFlagBits2::eShaderRead,
+				.dstStageMask = vk::PipelineStageFlagBits2::eDrawIndirect
+					| vk::PipelineStageFlagBits2::eVertexShader
+					| vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask = vk::AccessFlagBits2::eIndirectCommandRead
+					| vk::AccessFlagBits2::eShaderRead
+					| vk::AccessFlagBits2::eShaderWrite,
 				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
 				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
 				.buffer = buffer,
@@ -240,8 +617,31 @@ namespace render
 			};
 		};
 
-		const auto barriers = resource_set.indirect_buffers->as_ref_array()
+		const auto indirect_barriers = resource_set.resource->indirect_buffers.as_ref_array()
+			| util::map_array([](auto&& buffer) { return get_sync_barrier(buffer.get()); });
+		const auto count_barriers = resource_set.resource->count_buffers.as_ref_array()
+			| util::map_array([](auto&& buffer) { return get_sync_barrier(buffer.get()); });
+		const auto candidate_barriers = resource_set.resource->candidate_buffers.as_ref_array()
+			| util::map_array([](auto&& buffer) { return get_sync_barrier(buffer.get()); });
+		const auto command_barriers = resource_set.resource->command_buffers.as_ref_array()
 			| util::map_array([](auto&& buffer) { return get_sync_barrier(buffer.get()); });
+		const auto view_indirect_barriers = resource_set.resource->view_indirect_buffers.as_ref_array()
+			| util::map_array([](auto&& buffer) { return get_sync_barrier(buffer.get()); });
+		const auto view_command_barriers = resource_set.resource->view_command_buffers.as_ref_array()
+			| util::map_array([](auto&& buffer) { return get_sync_barrier(buffer.get()); });
+		const auto impostor_barriers = std::to_array({
+			get_sync_barrier(resource_set.resource->impostor_instance_buffer),
+			get_sync_barrier(resource_set.resource->impostor_command_buffer),
+		});
+		const auto barriers = util::array_concat(
+			indirect_barriers,
+			count_barriers,
+			candidate_barriers,
+			command_barriers,
+			view_indirect_barriers,
+			view_command_barriers,
+			impostor_barriers
+		);
 
 		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(barriers));
 	}
@@ -250,15 +650,34 @@ namespace render
 		const vulkan::Context& context,
 		const Model& model,
 		vulkan::ElementBufferRef<Camera> camera,
-		const HostDrawcallResource& drawcall_resource,
-		const IndirectResource& indirect_resource
+		const TransformResource& transform_resource,
+		const IndirectResource& indirect_resource,
+		vulkan::ArrayBufferRef<uint32_t> geometry_feedback,
+		HizAttachment::View prev_hiz,
+		HizAttachment::View curr_hiz,
+		SceneGraph::Bucket bucket
 	) noexcept
 	{
+		const auto prev_hiz_image_info = vk::DescriptorImageInfo{
+			.imageView = prev_hiz.full_view,
+			.imageLayout = vk::ImageLayout::eGeneral
+		};
+
+		const auto curr_hiz_image_info = vk::DescriptorImageInfo{
+			.imageView = curr_hiz.full_view,
+			.imageLayout = vk::ImageLayout::eGeneral
+		};
+
+		const auto drawcall_buffers = model.scene_graph->bucket(bucket);
+
 		for (
-			const auto& [descriptor_set, indirect_buffer, drawcall_buffer] : std::views::zip(
+			const auto& [descriptor_set, indirect_buffer, count_buffer, candidate_buffer, drawcall_buffer] :
+			std::views::zip(
 				descriptor_sets.all(),
 				indirect_resource.ref().all(),
-				drawcall_resource->primitive_drawcalls.all()
+				indirect_resource.count_ref().all(),
+				indirect_resource.candidate_ref().all(),
+				drawcall_buffers.all()
 			)
 		)
 		{
@@ -275,9 +694,9 @@ namespace render
 			};
 
 			const auto transform_buffer_info = vk::DescriptorBufferInfo{
-				.buffer = drawcall_resource->transform,
+				.buffer = transform_resource->world_transform,
 				.offset = 0,
-				.range = drawcall_resource->transform.size_vk()
+				.range = transform_resource->world_transform.size_vk()
 			};
 
 			const auto primitive_attr_buffer_info = vk::DescriptorBufferInfo{
@@ -289,6 +708,16 @@ namespace render
 			const auto camera_buffer_info =
 				vk::DescriptorBufferInfo{.buffer = camera, .offset = 0, .range = vk::WholeSize};
 
+			// Counts of the main camera, followed by the counts of the additional views
+			const auto draw_count_buffer_info =
+				vk::DescriptorBufferInfo{.buffer = count_buffer, .offset = 0, .range = vk::WholeSize};
+
+			const auto candidate_buffer_info = vk::DescriptorBufferInfo{
+				.buffer = candidate_buffer,
+				.offset = 0,
+				.range = candidate_buffer.size_vk()
+			};
+
 			const auto indirect_write_descriptor_set = vk::WriteDescriptorSet{
 				.dstSet = descriptor_set,
 				.dstBinding = 0,
@@ -329,17 +758,395 @@ namespace render
 				.pBufferInfo = &camera_buffer_info
 			};
 
+			const auto draw_count_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 5,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &draw_count_buffer_info
+			};
+
+			const auto candidate_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 6,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &candidate_buffer_info
+			};
+
+			const auto prev_hiz_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 7,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &prev_hiz_image_info
+			};
+
+			const auto curr_hiz_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 8,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &curr_hiz_image_info
+			};
+
 			const auto write_descriptor_sets = std::to_array({
 				indirect_write_descriptor_set,
 				primitive_drawcall_descriptor_set,
 				transform_descriptor_set,
 				primitive_attr_descriptor_set,
 				camera_descriptor_set,
+				draw_count_descriptor_set,
+				candidate_descriptor_set,
+				prev_hiz_descriptor_set,
+				curr_hiz_descriptor_set,
 			});
 
-			context.device.updateDescriptorSets(write_descriptor_sets, {});
+			descriptor_cache.update(context.device, write_descriptor_sets);
 		}
 
-		indirect_buffers = indirect_resource.ref();
+		/* Instancing & feedback buffers */
+
+		const auto feedback_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = geometry_feedback,
+			.offset = 0,
+			.range = geometry_feedback.size_vk()
+		};
+
+		for (
+			const auto& [descriptor_set, command_buffer, group_buffer, state_buffer] : std::views::zip(
+				descriptor_sets.all(),
+				indirect_resource.command_ref().all(),
+				indirect_resource.group_ref().all(),
+				indirect_resource.state_ref().all()
+			)
+		)
+		{
+			const auto command_buffer_info = vk::DescriptorBufferInfo{
+				.buffer = command_buffer,
+				.offset = 0,
+				.range = command_buffer.size_vk()
+			};
+
+			const auto group_buffer_info = vk::DescriptorBufferInfo{
+				.buffer = group_buffer,
+				.offset = 0,
+				.range = group_buffer.size_vk()
+			};
+
+			const auto state_buffer_info = vk::DescriptorBufferInfo{
+				.buffer = state_buffer,
+				.offset = 0,
+				.range = state_buffer.size_vk()
+			};
+
+			const auto command_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 9,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &command_buffer_info
+			};
+
+			const auto group_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 10,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &group_buffer_info
+			};
+
+			const auto state_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 11,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &state_buffer_info
+			};
+
+			const auto feedback_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 12,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &feedback_buffer_info
+			};
+
+			const auto write_descriptor_sets = std::to_array({
+				command_descriptor_set,
+				group_descriptor_set,
+				state_descriptor_set,
+				feedback_descriptor_set,
+			});
+
+			descriptor_cache.update(context.device, write_descriptor_sets);
+		}
+
+		/* Additional view buffers */
+
+		// View buffers are never empty even without additional views, see `vulkan::DynBuffer::MIN_SIZE`
+		const auto views_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = indirect_resource.view_ref(),
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+
+		for (
+			const auto& [descriptor_set, view_indirect_buffer, view_command_buffer, view_group_buffer] :
+			std::views::zip(
+				descriptor_sets.all(),
+				indirect_resource.view_indirect_ref().all(),
+				indirect_resource.view_command_ref().all(),
+				indirect_resource.view_group_ref().all()
+			)
+		)
+		{
+			const auto view_indirect_buffer_info =
+				vk::DescriptorBufferInfo{.buffer = view_indirect_buffer, .offset = 0, .range = vk::WholeSize};
+
+			const auto view_command_buffer_info =
+				vk::DescriptorBufferInfo{.buffer = view_command_buffer, .offset = 0, .range = vk::WholeSize};
+
+			const auto view_group_buffer_info =
+				vk::DescriptorBufferInfo{.buffer = view_group_buffer, .offset = 0, .range = vk::WholeSize};
+
+			const auto views_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 13,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &views_buffer_info
+			};
+
+			const auto view_indirect_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 14,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &view_indirect_buffer_info
+			};
+
+			const auto view_command_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 15,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &view_command_buffer_info
+			};
+
+			const auto view_group_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 16,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &view_group_buffer_info
+			};
+
+			const auto write_descriptor_sets = std::to_array({
+				views_descriptor_set,
+				view_indirect_descriptor_set,
+				view_command_descriptor_set,
+				view_group_descriptor_set,
+			});
+
+			descriptor_cache.update(context.device, write_descriptor_sets);
+		}
+
+		/* Sort buffers */
+
+		for (
+			const auto& [descriptor_set, depth_buffer, bucket_buffer] : std::views::zip(
+				descriptor_sets.all(),
+				indirect_resource.group_depth_ref().all(),
+				indirect_resource.sort_bucket_ref().all()
+			)
+		)
+		{
+			const auto depth_buffer_info = vk::DescriptorBufferInfo{
+				.buffer = depth_buffer,
+				.offset = 0,
+				.range = depth_buffer.size_vk()
+			};
+
+			const auto bucket_buffer_info = vk::DescriptorBufferInfo{
+				.buffer = bucket_buffer,
+				.offset = 0,
+				.range = bucket_buffer.size_vk()
+			};
+
+			const auto depth_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 17,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &depth_buffer_info
+			};
+
+			const auto bucket_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 18,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &bucket_buffer_info
+			};
+
+			const auto write_descriptor_sets = std::to_array({depth_descriptor_set, bucket_descriptor_set});
+
+			descriptor_cache.update(context.device, write_descriptor_sets);
+		}
+
+		/* Bounds buffers */
+
+		for (
+			const auto& [descriptor_set, bounds_buffer] :
+			std::views::zip(descriptor_sets.all(), indirect_resource.bounds_ref().all())
+		)
+		{
+			const auto bounds_buffer_info = vk::DescriptorBufferInfo{
+				.buffer = bounds_buffer,
+				.offset = 0,
+				.range = bounds_buffer.size_vk()
+			};
+
+			const auto bounds_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 19,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &bounds_buffer_info
+			};
+
+			descriptor_cache.update(context.device, std::to_array({bounds_descriptor_set}));
+		}
+
+		/* HLOD buffers */
+
+		// HLOD buffers are never empty even without clusters, see `SceneGraph::create`
+		const auto hlod_cluster_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = model.scene_graph->hlod_cluster_buffer,
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+
+		const auto node_hlod_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = model.scene_graph->node_hlod_buffer,
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+
+		for (const auto& descriptor_set : descriptor_sets.all())
+		{
+			const auto hlod_cluster_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 20,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &hlod_cluster_buffer_info
+			};
+
+			const auto node_hlod_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 21,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &node_hlod_buffer_info
+			};
+
+			const auto write_descriptor_sets =
+				std::to_array({hlod_cluster_descriptor_set, node_hlod_descriptor_set});
+
+			descriptor_cache.update(context.device, write_descriptor_sets);
+		}
+
+		/* Impostor buffers */
+
+		// Impostor buffers are never empty even without impostors, see `ImpostorList::create`
+		const auto impostor_list = model.impostor_list.get();
+
+		const auto primitive_impostor_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = impostor_list.primitive_impostor_buffer,
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+
+		const auto impostor_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = impostor_list.impostor_buffer,
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+
+		const auto impostor_instance_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = indirect_resource.impostor_instance_ref(),
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+
+		const auto impostor_command_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = indirect_resource.impostor_command_ref(),
+			.offset = 0,
+			.range = vk::WholeSize
+		};
+
+		for (const auto& descriptor_set : descriptor_sets.all())
+		{
+			const auto primitive_impostor_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 22,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &primitive_impostor_buffer_info
+			};
+
+			const auto impostor_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 23,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &impostor_buffer_info
+			};
+
+			const auto impostor_instance_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 24,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &impostor_instance_buffer_info
+			};
+
+			const auto impostor_command_descriptor_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 25,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &impostor_command_buffer_info
+			};
+
+			const auto write_descriptor_sets = std::to_array({
+				primitive_impostor_descriptor_set,
+				impostor_descriptor_set,
+				impostor_instance_descriptor_set,
+				impostor_command_descriptor_set,
+			});
+
+			descriptor_cache.update(context.device, write_descriptor_sets);
+		}
+
+		resource = Resource{
+			.indirect_buffers = indirect_resource.ref(),
+			.count_buffers = indirect_resource.count_ref(),
+			.candidate_buffers = indirect_resource.candidate_ref(),
+			.command_buffers = indirect_resource.command_ref(),
+			.group_buffers = indirect_resource.group_ref(),
+			.view_indirect_buffers = indirect_resource.view_indirect_ref(),
+			.view_command_buffers = indirect_resource.view_command_ref(),
+			.view_group_buffers = indirect_resource.view_group_ref(),
+			.group_depth_buffers = indirect_resource.group_depth_ref(),
+			.sort_bucket_buffers = indirect_resource.sort_bucket_ref(),
+			.impostor_instance_buffer = indirect_resource.impostor_instance_ref(),
+			.impostor_command_buffer = indirect_resource.impostor_command_ref(),
+			.view_count = indirect_resource.view_count(),
+			.prev_hiz_size = prev_hiz.extent,
+			.curr_hiz_size = curr_hiz.extent,
+		};
 	}
 }
@@ -0,0 +1,304 @@
+#include "render/pipeline/light-cluster.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/light-list.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/light-cluster.hpp"
+#include "shader/light-cluster.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto depth_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto camera_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto light_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 2,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto transform_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 3,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto light_count_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 4,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto light_index_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 5,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({
+			depth_binding,
+			camera_binding,
+			light_binding,
+			transform_binding,
+			light_count_binding,
+			light_index_binding,
+		});
+	}
+
+	std::expected<LightClusterPipeline, Error> LightClusterPipeline::create(
+		const vulkan::Context& context
+	) noexcept
+	{
+		auto shader_module_result = vulkan::create_shader(context.device, shader::light_cluster);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({descriptor_set_layout});
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(set_layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main");
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+		auto pipeline = std::move(*pipeline_result);
+
+		return LightClusterPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(pipeline)
+		);
+	}
+
+	std::expected<std::vector<LightClusterPipeline::ResourceSet>, Error> LightClusterPipeline::
+		create_resource_sets(const vulkan::Context& context, uint32_t count) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void LightClusterPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		bool lights
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Light Cluster");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& light_cluster = resource_set->light_cluster;
+
+		/* Cull */
+
+		const auto push_constant = PushConstant{
+			.extent = resource_set->extent,
+			.tile_count = light_cluster.tile_count,
+			.light_count = lights ? resource_set->light_count : 0,
+		};
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{*resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+		command_buffer.dispatch(light_cluster.tile_count.x, light_cluster.tile_count.y, 1);
+
+		/* Make the grid visible to the lighting pass */
+
+		const auto make_barrier = [](vk::Buffer buffer) {
+			return vk::BufferMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.buffer = buffer,
+				.offset = 0,
+				.size = vk::WholeSize,
+			};
+		};
+
+		const auto barriers = std::to_array({
+			make_barrier(light_cluster.light_counts),
+			make_barrier(light_cluster.light_indices),
+		});
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(barriers));
+	}
+
+	void LightClusterPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const LightList& light_list,
+		vulkan::ArrayBufferRef<glm::mat4> world_transforms,
+		DeferredAttachment::View deferred,
+		LightClusterAttachment::View light_cluster,
+		vulkan::ElementBufferRef<Camera> camera
+	) noexcept
+	{
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto depth_image_info = vk::DescriptorImageInfo{
+			.imageView = deferred.depth.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto camera_buf_info = whole_buffer_info(camera);
+		const auto light_buf_info = whole_buffer_info(light_list.get());
+		const auto transform_buf_info = whole_buffer_info(world_transforms);
+		const auto light_count_buf_info = whole_buffer_info(light_cluster.light_counts);
+		const auto light_index_buf_info = whole_buffer_info(light_cluster.light_indices);
+
+		/*===== Write Descriptor Set =====*/
+
+		const auto write_descriptors = std::to_array({
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &depth_image_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 1,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &camera_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 2,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &light_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 3,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &transform_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 4,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &light_count_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 5,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &light_index_buf_info,
+			},
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{
+			.extent = deferred.extent,
+			.light_count = light_list.count(),
+			.light_cluster = light_cluster
+		};
+	}
+}
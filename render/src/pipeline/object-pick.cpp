@@ -0,0 +1,241 @@
+#include "render/pipeline/object-pick.hpp"
+#include "common/util/array.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/interface/primitive-drawcall.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/indirect.hpp"
+#include "shader/object-pick.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/common.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static constexpr uint32_t RENDER_STATE_COUNT = 4;  // Must match `RENDER_STATE_COUNT` in the shader
+
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto object_id_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto indirect_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = RENDER_STATE_COUNT,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto result_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 2,
+			.descriptorType = vk::DescriptorType::eStorageBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({object_id_binding, indirect_binding, result_binding});
+	}
+
+	std::expected<ObjectPickPipeline, Error> ObjectPickPipeline::create(
+		const vulkan::Context& context
+	) noexcept
+	{
+		auto shader_module_result = vulkan::create_shader(context.device, shader::object_pick);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*descriptor_set_layout)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main");
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+
+		return ObjectPickPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(*pipeline_result)
+		);
+	}
+
+	std::expected<std::vector<ObjectPickPipeline::ResourceSet>, Error> ObjectPickPipeline::
+		create_resource_sets(const vulkan::Context& context, uint32_t count) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void ObjectPickPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		glm::u32vec2 pixel
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Object Pick");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->extent.x > 0 && resource_set->extent.y > 0);
+
+		// G-buffer passes have transitioned the object IDs for compute reads. The result was last copied
+		// to host by an earlier frame using this resource set, wait for the copy before overwriting.
+		const auto pre_barrier = vk::BufferMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.buffer = resource_set->result,
+			.offset = 0,
+			.size = resource_set->result.size_vk()
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(pre_barrier));
+
+		const auto push_constant = PushConstant{.pixel = glm::min(pixel, resource_set->extent - 1u)};
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+		command_buffer
+			.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeline_layout, 0, {resource_set.set}, {});
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+		command_buffer.dispatch(1, 1, 1);
+
+		const auto post_barrier = vk::BufferMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eCopy,
+			.dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.buffer = resource_set->result,
+			.offset = 0,
+			.size = resource_set->result.size_vk()
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(post_barrier));
+	}
+
+	void ObjectPickPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		DeferredAttachment::View deferred,
+		const IndirectResource& indirect,
+		vulkan::ElementBufferRef<PrimitiveDrawcall> result
+	) noexcept
+	{
+		const auto object_id_image_info = vk::DescriptorImageInfo{
+			.imageView = deferred.object_id.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		// In the order of `PerRenderState::all()`, which the shader indexes by render state
+		const auto indirect_buffer_infos =
+			indirect.ref().as_array() | util::map_array([](vulkan::ArrayBufferRef<IndirectDrawcall> buffer) {
+				return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+			});
+
+		const auto result_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = result,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto write_descriptors = std::to_array({
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &object_id_image_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 1,
+				.descriptorCount = RENDER_STATE_COUNT,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = indirect_buffer_infos.data(),
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 2,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &result_buffer_info,
+			},
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		resource = Resource{.extent = deferred.extent, .result = result};
+	}
+}
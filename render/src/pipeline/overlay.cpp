@@ -0,0 +1,250 @@
+#include "render/pipeline/overlay.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/pipeline/util/constant.hpp"
+#include "render/pipeline/util/fullscreen-pipeline.hpp"
+#include "render/resource/overlay.hpp"
+#include "shader/overlay.hpp"
+#include "vulkan/container/host/linked-struct.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/glm.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	namespace
+	{
+		constexpr auto OVERLAY_BINDING = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eFragment
+		};
+
+		constexpr auto RESOURCE_BINDINGS = std::to_array({OVERLAY_BINDING});
+
+		// Premultiplied over, the same result as drawing with straight alpha blending over the target
+		constexpr auto PREMULTIPLIED_BLEND_STATE = vk::PipelineColorBlendAttachmentState{
+			.blendEnable = vk::True,
+			.srcColorBlendFactor = vk::BlendFactor::eOne,
+			.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha,
+			.colorBlendOp = vk::BlendOp::eAdd,
+			.srcAlphaBlendFactor = vk::BlendFactor::eOne,
+			.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha,
+			.alphaBlendOp = vk::BlendOp::eAdd,
+			.colorWriteMask = vk::ColorComponentFlagBits::eR
+				| vk::ColorComponentFlagBits::eG
+				| vk::ColorComponentFlagBits::eB
+				| vk::ColorComponentFlagBits::eA
+		};
+	}
+
+	std::expected<OverlayPipeline, Error> OverlayPipeline::create(
+		const vulkan::Context& context,
+		vk::Format target_format
+	) noexcept
+	{
+		/*===== Descriptor Set Layout =====*/
+
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(RESOURCE_BINDINGS)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		/*===== Pipeline Layout =====*/
+
+		const auto layouts = std::to_array<vk::DescriptorSetLayout>({descriptor_set_layout});
+		auto pipeline_layout_result =
+			context.device.createPipelineLayout(vk::PipelineLayoutCreateInfo().setSetLayouts(layouts));
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		/*===== Shader Modules =====*/
+
+		auto vertex_shader_result = fullscreen::get_vertex_shader(context.device);
+		auto fragment_shader_result = vulkan::create_shader(context.device, shader::overlay);
+
+		if (!vertex_shader_result) return vertex_shader_result.error().forward("Create vertex shader failed");
+		if (!fragment_shader_result)
+			return fragment_shader_result.error().forward("Create fragment shader failed");
+
+		auto vertex_shader = std::move(*vertex_shader_result);
+		auto fragment_shader = std::move(*fragment_shader_result);
+
+		const auto shader_stages = std::to_array({
+			vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eVertex,
+				.module = vertex_shader,
+				.pName = "main"
+			},
+			vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eFragment,
+				.module = fragment_shader,
+				.pName = "main"
+			},
+		});
+
+		/*===== Pipeline =====*/
+
+		const auto color_blend_state =
+			vk::PipelineColorBlendStateCreateInfo().setAttachments(PREMULTIPLIED_BLEND_STATE);
+
+		const auto pipeline_rendering_create_info =
+			vk::PipelineRenderingCreateInfo().setColorAttachmentFormats(target_format);
+
+		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
+			vk::GraphicsPipelineCreateInfo()
+				.setStages(shader_stages)
+				.setPVertexInputState(&fullscreen::VERTEX_INPUT_STATE)
+				.setPInputAssemblyState(&constant::TRIANGLE_LIST_INPUT_ASSEMBLY_STATE)
+				.setPRasterizationState(&constant::NO_CULL_RASTERIZATION_STATE)
+				.setPMultisampleState(&constant::BASIC_MULTISAMPLE_STATE)
+				.setPDepthStencilState(&constant::NO_DEPTH_TEST_STATE)
+				.setPColorBlendState(&color_blend_state)
+				.setPViewportState(&constant::DYNAMIC_VIEWPORT_STATE)
+				.setPDynamicState(&fullscreen::DYNAMIC_STATE_INFO)
+				.setLayout(pipeline_layout);
+		pipeline_create_info.push(pipeline_rendering_create_info);
+
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
+		if (!pipeline_result) return Error::from(pipeline_result);
+		auto pipeline = std::move(*pipeline_result);
+
+		/*===== Sampler =====*/
+
+		// Same extent as the target, each fragment takes exactly its texel
+		constexpr auto sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eNearest,
+			.minFilter = vk::Filter::eNearest,
+			.mipmapMode = vk::SamplerMipmapMode::eNearest,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = 0.0f,
+		};
+
+		auto sampler_result = context.device.createSampler(sampler_create_info);
+		if (!sampler_result) return Error::from(sampler_result);
+		auto sampler = std::move(*sampler_result);
+
+		return OverlayPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(pipeline),
+			std::move(sampler)
+		);
+	}
+
+	std::expected<std::vector<OverlayPipeline::ResourceSet>, Error> OverlayPipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		const auto pool_sizes = vulkan::calc_pool_sizes(RESOURCE_BINDINGS, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *resource_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue,
+				   std::views::repeat(*sampler)
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void OverlayPipeline::render(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Overlay");
+
+		DEBUG_ASSERT(resource_set.image_size.has_value());
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eGraphics,
+			*pipeline_layout,
+			0,
+			{resource_set.descriptor_set},
+			{}
+		);
+
+		command_buffer.setViewport(
+			0,
+			vk::Viewport{
+				.x = 0.0f,
+				.y = 0.0f,
+				.width = static_cast<float>(resource_set.image_size->x),
+				.height = static_cast<float>(resource_set.image_size->y),
+				.minDepth = 0.0f,
+				.maxDepth = 1.0f
+			}
+		);
+
+		const auto scissor = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(*resource_set.image_size),
+		};
+		command_buffer.setScissor(0, scissor);
+
+		command_buffer.draw(6, 1, 0, 0);
+	}
+
+	void OverlayPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		OverlayAttachment::View overlay
+	) noexcept
+	{
+		this->image_size = overlay.extent;
+
+		const auto overlay_image_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = overlay.attachment.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+		};
+
+		const auto write = vk::WriteDescriptorSet{
+			.dstSet = descriptor_set,
+			.dstBinding = 0,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = vk::DescriptorType::eCombinedImageSampler,
+			.pImageInfo = &overlay_image_info
+		};
+
+		descriptor_cache.update(context.device, std::to_array({write}));
+	}
+}
@@ -0,0 +1,438 @@
+#include "render/pipeline/path-trace.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/model/light-list.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/path-trace.hpp"
+#include "shader/path-trace-packed.hpp"
+#include "shader/path-trace.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto tlas_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto camera_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto light_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 2,
+			.descriptorType = vk::DescriptorType::eUniformBuffer,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto storage_buffer_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		constexpr auto storage_image_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		return std::to_array({
+			tlas_binding,
+			camera_binding,
+			light_binding,
+			storage_buffer_binding(3),  // Primitive attributes
+			storage_buffer_binding(4),  // Indices
+			storage_buffer_binding(5),  // Vertices
+			storage_buffer_binding(6),  // Punctual lights
+			storage_buffer_binding(7),  // Node transforms
+			storage_image_binding(8),   // Accumulation
+			storage_image_binding(9),   // HDR
+		});
+	}
+
+	PathTracePipeline::Dispatch PathTracePipeline::get_dispatch(
+		const Option& option,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		const auto pixel_count = std::max<uint64_t>(uint64_t(extent.x) * extent.y, 1);
+		const auto sample_budget = std::max<uint64_t>(option.sample_budget, 1);
+
+		if (sample_budget < pixel_count)
+		{
+			const auto pixel_stride = (pixel_count + sample_budget - 1) / sample_budget;
+			return {
+				.samples_per_pixel = 1,
+				.pixel_stride = static_cast<uint32_t>(std::min<uint64_t>(pixel_stride, MAX_PIXEL_STRIDE)),
+			};
+		}
+
+		const auto max_samples_per_pixel = std::max(option.max_samples_per_pixel, 1u);
+		const auto samples_per_pixel = std::min<uint64_t>(sample_budget / pixel_count, max_samples_per_pixel);
+
+		return {.samples_per_pixel = static_cast<uint32_t>(samples_per_pixel), .pixel_stride = 1};
+	}
+
+	std::expected<PathTracePipeline, Error> PathTracePipeline::create(
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format,
+		vk::Format hdr_format
+	) noexcept
+	{
+		if (!context.feature.raytracing)
+			return Error("Missing raytracing feature", "Path tracing requires raytracing feature");
+
+		const auto shader_code =
+			hdr_format == HdrAttachment::PACKED_HDR_FORMAT ? shader::path_trace_packed : shader::path_trace;
+		auto shader_module_result = vulkan::create_shader(context.device, shader_code);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({
+			material_layout.layout,
+			descriptor_set_layout,
+		});
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(set_layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto spec_data = SpecializationConstant{
+			.packed_vertex = vertex_format == VertexFormat::Packed ? vk::True : vk::False
+		};
+		const auto packed_vertex_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = offsetof(SpecializationConstant, packed_vertex),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto specialization_info =
+			vk::SpecializationInfo()
+				.setMapEntries(packed_vertex_spec_entry)
+				.setData<SpecializationConstant>(spec_data);
+
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main")
+				.setPSpecializationInfo(&specialization_info);
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+		auto pipeline = std::move(*pipeline_result);
+
+		return PathTracePipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(pipeline),
+			vertex_format
+		);
+	}
+
+	std::expected<std::vector<PathTracePipeline::ResourceSet>, Error> PathTracePipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void PathTracePipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		uint32_t frame_index
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Path Trace");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
+		DEBUG_ASSERT(resource_set->accumulation.extent == resource_set->hdr.extent);
+
+		const auto& accumulation = resource_set->accumulation;
+		const auto& hdr = resource_set->hdr;
+
+		/* Pre-trace layout transition */
+
+		// Accumulation is written by the same pass of earlier frames, discarded on restart. The lighting
+		// result in the HDR attachment is overwritten as a whole
+		const auto pre_barriers = std::to_array({
+			vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask =
+					vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+				.oldLayout = frame_index == 0 ? vk::ImageLayout::eUndefined : vk::ImageLayout::eGeneral,
+				.newLayout = vk::ImageLayout::eGeneral,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = accumulation.accumulation.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			},
+			vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput
+					| vk::PipelineStageFlagBits2::eFragmentShader
+					| vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eNone,
+				.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.oldLayout = vk::ImageLayout::eUndefined,
+				.newLayout = vk::ImageLayout::eGeneral,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = hdr.attachment.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			},
+		});
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+
+		/* Trace */
+
+		const auto dispatch = get_dispatch(option, hdr.extent);
+		const auto push_constant = PushConstant{
+			.size = hdr.extent,
+			.frame_index = frame_index,
+			.samples_per_pixel = dispatch.samples_per_pixel,
+			.pixel_stride = dispatch.pixel_stride,
+			.max_bounces = option.max_bounces,
+			.max_samples = option.max_samples,
+			.light_count = resource_set->light_count,
+		};
+		const auto group_count = (push_constant.size + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{resource_set->material_descriptor_set, *resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		/* Leave the HDR attachment in the layout of the lighting pass */
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask =
+				vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = hdr.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	void PathTracePipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const Tlas& tlas,
+		PathTraceAttachment::View accumulation,
+		HdrAttachment::View hdr,
+		vulkan::ElementBufferRef<Camera> camera,
+		vulkan::ElementBufferRef<DirectLight> direct_light,
+		vulkan::ArrayBufferRef<glm::mat4> world_transforms
+	) noexcept
+	{
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto tlas_handle = static_cast<vk::AccelerationStructureKHR>(tlas);
+		const auto tlas_info =
+			vk::WriteDescriptorSetAccelerationStructureKHR().setAccelerationStructures(tlas_handle);
+
+		const auto camera_buf_info = vk::DescriptorBufferInfo{
+			.buffer = camera,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto direct_light_buf_info = vk::DescriptorBufferInfo{
+			.buffer = direct_light,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto primitive_attr_buf_info = whole_buffer_info(model.mesh_list->trace_primitive_attr_buffer);
+		const auto index_buf_info = whole_buffer_info(model.mesh_list->index_buffer);
+		const auto vertex_buf_info = whole_buffer_info(model.mesh_list->vertex_buffer);
+		const auto punctual_light_buf_info = whole_buffer_info(model.light_list.get());
+		const auto transform_buf_info = whole_buffer_info(world_transforms);
+
+		const auto accumulation_image_info = vk::DescriptorImageInfo{
+			.imageView = accumulation.accumulation.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto hdr_image_info = vk::DescriptorImageInfo{
+			.imageView = hdr.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		/*===== Write Descriptor Set =====*/
+
+		const auto buffer_write = [this](uint32_t binding, const vk::DescriptorBufferInfo& info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &info,
+			};
+		};
+
+		const auto image_write = [this](uint32_t binding, const vk::DescriptorImageInfo& info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageImage,
+				.pImageInfo = &info,
+			};
+		};
+
+		const auto write_descriptors = std::to_array({
+			vk::WriteDescriptorSet{
+				.pNext = &tlas_info,
+				.dstSet = set,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 1,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &camera_buf_info,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 2,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &direct_light_buf_info,
+			},
+			buffer_write(3, primitive_attr_buf_info),
+			buffer_write(4, index_buf_info),
+			buffer_write(5, vertex_buf_info),
+			buffer_write(6, punctual_light_buf_info),
+			buffer_write(7, transform_buf_info),
+			image_write(8, accumulation_image_info),
+			image_write(9, hdr_image_info),
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{
+			.material_descriptor_set = model.material_list.get_descriptor_set(),
+			.vertex_format = model.mesh_list->vertex_format,
+			.light_count = model.light_list.count(),
+			.accumulation = accumulation,
+			.hdr = hdr
+		};
+	}
+}
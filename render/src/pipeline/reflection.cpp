@@ -0,0 +1,575 @@
+#include "render/pipeline/reflection.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/denoise.hpp"
+#include "render/resource/environment.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/hiz.hpp"
+#include "render/resource/reflection.hpp"
+#include "render/resource/taa.hpp"
+#include "shader/reflection.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto binding_of = [](uint32_t binding, vk::DescriptorType type) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = type,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		constexpr auto uniform_buffer_binding = [binding_of](uint32_t binding) {
+			return binding_of(binding, vk::DescriptorType::eUniformBuffer);
+		};
+
+		constexpr auto storage_buffer_binding = [binding_of](uint32_t binding) {
+			return binding_of(binding, vk::DescriptorType::eStorageBuffer);
+		};
+
+		constexpr auto sampled_image_binding = [binding_of](uint32_t binding) {
+			return binding_of(binding, vk::DescriptorType::eSampledImage);
+		};
+
+		constexpr auto storage_image_binding = [binding_of](uint32_t binding) {
+			return binding_of(binding, vk::DescriptorType::eStorageImage);
+		};
+
+		constexpr auto combined_image_binding = [binding_of](uint32_t binding) {
+			return binding_of(binding, vk::DescriptorType::eCombinedImageSampler);
+		};
+
+		return std::to_array({
+			binding_of(0, vk::DescriptorType::eAccelerationStructureKHR),
+			uniform_buffer_binding(1),   // Camera
+			uniform_buffer_binding(2),   // Primary light
+			storage_buffer_binding(3),   // Primitive attributes
+			storage_buffer_binding(4),   // Indices
+			storage_buffer_binding(5),   // Vertices
+			sampled_image_binding(6),    // Depth
+			sampled_image_binding(7),    // Normal
+			sampled_image_binding(8),    // PBR
+			sampled_image_binding(9),    // Albedo
+			sampled_image_binding(10),   // HiZ
+			sampled_image_binding(11),   // Previous color
+			storage_image_binding(12),   // Signal
+			storage_buffer_binding(13),  // Tile list
+			sampled_image_binding(14),   // Denoised signal
+			combined_image_binding(15),  // Environment specular
+			combined_image_binding(16),  // Environment BRDF LUT
+			storage_image_binding(17),   // HDR
+		});
+	}
+
+	std::expected<ReflectionPipeline, Error> ReflectionPipeline::create(
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format
+	) noexcept
+	{
+		if (!context.feature.raytracing)
+			return Error("Missing raytracing feature", "Reflections require raytracing feature");
+
+		auto shader_module_result = vulkan::create_shader(context.device, shader::reflection);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({
+			material_layout.layout,
+			descriptor_set_layout,
+		});
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(set_layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto spec_data = SpecializationConstant{
+			.packed_vertex = vertex_format == VertexFormat::Packed ? vk::True : vk::False
+		};
+		const auto packed_vertex_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = offsetof(SpecializationConstant, packed_vertex),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto specialization_info =
+			vk::SpecializationInfo()
+				.setMapEntries(packed_vertex_spec_entry)
+				.setData<SpecializationConstant>(spec_data);
+
+		const auto create_pipeline = [&](const char* entry) -> std::expected<vk::raii::Pipeline, Error> {
+			const auto pipeline_stage_create_info =
+				vk::PipelineShaderStageCreateInfo()
+					.setStage(vk::ShaderStageFlagBits::eCompute)
+					.setModule(shader_module)
+					.setPName(entry)
+					.setPSpecializationInfo(&specialization_info);
+			const auto pipeline_create_info =
+				vk::ComputePipelineCreateInfo()
+					.setStage(pipeline_stage_create_info)
+					.setLayout(pipeline_layout);
+
+			auto pipeline_result =
+				context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			return std::move(*pipeline_result);
+		};
+
+		auto classify_pipeline_result = create_pipeline("main_classify");
+		if (!classify_pipeline_result)
+			return classify_pipeline_result.error().forward("Create classify pipeline failed");
+
+		auto trace_pipeline_result = create_pipeline("main_trace");
+		if (!trace_pipeline_result)
+			return trace_pipeline_result.error().forward("Create trace pipeline failed");
+
+		auto composite_pipeline_result = create_pipeline("main_composite");
+		if (!composite_pipeline_result)
+			return composite_pipeline_result.error().forward("Create composite pipeline failed");
+
+		/*===== Sampler =====*/
+
+		// Specular levels are blended by roughness, same as the lighting pass
+		constexpr auto environment_sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eLinear,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = vk::LodClampNone,
+		};
+
+		auto environment_sampler_result = context.device.createSampler(environment_sampler_create_info);
+		if (!environment_sampler_result) return Error::from(environment_sampler_result);
+
+		return ReflectionPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(*classify_pipeline_result),
+			std::move(*trace_pipeline_result),
+			std::move(*composite_pipeline_result),
+			std::move(*environment_sampler_result),
+			vertex_format
+		);
+	}
+
+	std::expected<std::vector<ReflectionPipeline::ResourceSet>, Error> ReflectionPipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue,
+				   std::views::repeat(*environment_sampler)
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void ReflectionPipeline::bind(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const PushConstant& push_constant
+	) const noexcept
+	{
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{resource_set->material_descriptor_set, *resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+	}
+
+	void ReflectionPipeline::trace(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		uint32_t frame_index,
+		bool history_valid,
+		bool environment
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Reflection Trace");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
+
+		const auto& reflection = resource_set->reflection;
+
+		/* Reset the tile count, keeping the other dispatch dimensions at 1 */
+
+		const auto tile_list_reset = std::to_array<uint32_t>({0, 1, 1});
+		command_buffer.updateBuffer<uint32_t>(reflection.tile_list, 0, tile_list_reset);
+
+		// Previous content of the signal is discarded, the denoiser of the previous frame has read it
+		const auto signal_pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = reflection.signal.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+
+		const auto tile_list_reset_barrier = vk::BufferMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask =
+				vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.buffer = reflection.tile_list,
+			.offset = 0,
+			.size = vk::WholeSize
+		};
+
+		command_buffer.pipelineBarrier2(
+			vk::DependencyInfo()
+				.setImageMemoryBarriers(signal_pre_barrier)
+				.setBufferMemoryBarriers(tile_list_reset_barrier)
+		);
+
+		const auto push_constant = PushConstant{
+			.size = reflection.extent,
+			.full_size = resource_set->full_size,
+			.history_size = resource_set->history_size,
+			.max_roughness = option.max_roughness,
+			.max_distance = option.max_distance,
+			.max_steps = option.max_steps,
+			.thickness = option.thickness,
+			.frame_index = frame_index,
+			.history_valid = history_valid ? 1u : 0u,
+			.environment_enabled = environment ? 1u : 0u,
+		};
+
+		/* Classify tiles, clearing the tiles without glossy pixels */
+
+		const auto tile_group_count = (reflection.extent + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, classify_pipeline);
+		bind(command_buffer, resource_set, push_constant);
+		command_buffer.dispatch(tile_group_count.x, tile_group_count.y, 1);
+
+		const auto tile_list_barrier = vk::BufferMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask =
+				vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask =
+				vk::AccessFlagBits2::eIndirectCommandRead | vk::AccessFlagBits2::eShaderStorageRead,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.buffer = reflection.tile_list,
+			.offset = 0,
+			.size = vk::WholeSize
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(tile_list_barrier));
+
+		/* Trace the glossy tiles, one workgroup per tile */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, trace_pipeline);
+		bind(command_buffer, resource_set, push_constant);
+		command_buffer.dispatchIndirect(reflection.tile_list, 0);
+
+		/* Make the signal visible to the denoiser and the composite pass */
+
+		const auto signal_post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask =
+				vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageRead,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = reflection.signal.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(signal_post_barrier));
+	}
+
+	void ReflectionPipeline::composite(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		bool environment
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Reflection Composite");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+
+		const auto& hdr = resource_set->hdr;
+
+		const auto hdr_barrier = [&hdr](vk::PipelineStageFlags2 src_stage,
+										vk::AccessFlags2 src_access,
+										vk::PipelineStageFlags2 dst_stage,
+										vk::AccessFlags2 dst_access,
+										vk::ImageLayout old_layout,
+										vk::ImageLayout new_layout) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = src_stage,
+				.srcAccessMask = src_access,
+				.dstStageMask = dst_stage,
+				.dstAccessMask = dst_access,
+				.oldLayout = old_layout,
+				.newLayout = new_layout,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = hdr.attachment.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		};
+
+		/* Add the reflections to the lighting result in place */
+
+		const auto pre_barrier = hdr_barrier(
+			vk::PipelineStageFlagBits2::eColorAttachmentOutput | vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageLayout::eGeneral
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		const auto push_constant = PushConstant{
+			.size = resource_set->reflection.extent,
+			.full_size = resource_set->full_size,
+			.history_size = resource_set->history_size,
+			.max_roughness = option.max_roughness,
+			.max_distance = option.max_distance,
+			.max_steps = option.max_steps,
+			.thickness = option.thickness,
+			.frame_index = 0,
+			.history_valid = 0,
+			.environment_enabled = environment ? 1u : 0u,
+		};
+		const auto group_count = (hdr.extent + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, composite_pipeline);
+		bind(command_buffer, resource_set, push_constant);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		/* Leave the HDR attachment in the layout of the lighting pass */
+
+		const auto post_barrier = hdr_barrier(
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderSampledRead,
+			vk::ImageLayout::eGeneral,
+			vk::ImageLayout::eShaderReadOnlyOptimal
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	void ReflectionPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const Tlas& tlas,
+		DeferredAttachment::View deferred,
+		HizAttachment::View hiz,
+		TaaAttachment::View prev_color,
+		ReflectionAttachment::View reflection,
+		DenoiseAttachment::View denoised,
+		HdrAttachment::View hdr,
+		vulkan::ElementBufferRef<Camera> camera,
+		vulkan::ElementBufferRef<DirectLight> direct_light,
+		EnvironmentLighting::View environment
+	) noexcept
+	{
+		DEBUG_ASSERT(deferred.extent == hdr.extent);
+		DEBUG_ASSERT(denoised.downscale == reflection.downscale, "Denoise resolution mismatches reflection");
+
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto tlas_handle = static_cast<vk::AccelerationStructureKHR>(tlas);
+		const auto tlas_info =
+			vk::WriteDescriptorSetAccelerationStructureKHR().setAccelerationStructures(tlas_handle);
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto camera_buf_info = whole_buffer_info(camera);
+		const auto direct_light_buf_info = whole_buffer_info(direct_light);
+		const auto primitive_attr_buf_info = whole_buffer_info(model.mesh_list->trace_primitive_attr_buffer);
+		const auto index_buf_info = whole_buffer_info(model.mesh_list->index_buffer);
+		const auto vertex_buf_info = whole_buffer_info(model.mesh_list->vertex_buffer);
+		const auto tile_list_buf_info = whole_buffer_info(reflection.tile_list);
+
+		const auto image_info = [](vk::ImageView view, vk::ImageLayout layout) {
+			return vk::DescriptorImageInfo{.imageView = view, .imageLayout = layout};
+		};
+
+		const auto depth_image_info =
+			image_info(deferred.depth.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto normal_image_info =
+			image_info(deferred.normal.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto pbr_image_info = image_info(deferred.pbr.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto albedo_image_info =
+			image_info(deferred.albedo.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto hiz_image_info = image_info(hiz.full_view, vk::ImageLayout::eGeneral);
+		const auto prev_color_image_info = image_info(prev_color.attachment.view, vk::ImageLayout::eGeneral);
+		const auto signal_image_info = image_info(reflection.signal.view, vk::ImageLayout::eGeneral);
+		const auto denoised_image_info = image_info(denoised.output().view, vk::ImageLayout::eGeneral);
+		const auto hdr_image_info = image_info(hdr.attachment.view, vk::ImageLayout::eGeneral);
+
+		const auto environment_specular_info = vk::DescriptorImageInfo{
+			.sampler = environment_sampler,
+			.imageView = environment.specular,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto environment_brdf_lut_info = vk::DescriptorImageInfo{
+			.sampler = environment_sampler,
+			.imageView = environment.brdf_lut,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		/*===== Write Descriptor Set =====*/
+
+		const auto buffer_write =
+			[this](uint32_t binding, vk::DescriptorType type, const vk::DescriptorBufferInfo& info) {
+				return vk::WriteDescriptorSet{
+					.dstSet = set,
+					.dstBinding = binding,
+					.descriptorCount = 1,
+					.descriptorType = type,
+					.pBufferInfo = &info,
+				};
+			};
+
+		const auto image_write =
+			[this](uint32_t binding, vk::DescriptorType type, const vk::DescriptorImageInfo& info) {
+				return vk::WriteDescriptorSet{
+					.dstSet = set,
+					.dstBinding = binding,
+					.descriptorCount = 1,
+					.descriptorType = type,
+					.pImageInfo = &info,
+				};
+			};
+
+		const auto write_descriptors = std::to_array({
+			vk::WriteDescriptorSet{
+				.pNext = &tlas_info,
+				.dstSet = set,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
+			},
+			buffer_write(1, vk::DescriptorType::eUniformBuffer, camera_buf_info),
+			buffer_write(2, vk::DescriptorType::eUniformBuffer, direct_light_buf_info),
+			buffer_write(3, vk::DescriptorType::eStorageBuffer, primitive_attr_buf_info),
+			buffer_write(4, vk::DescriptorType::eStorageBuffer, index_buf_info),
+			buffer_write(5, vk::DescriptorType::eStorageBuffer, vertex_buf_info),
+			image_write(6, vk::DescriptorType::eSampledImage, depth_image_info),
+			image_write(7, vk::DescriptorType::eSampledImage, normal_image_info),
+			image_write(8, vk::DescriptorType::eSampledImage, pbr_image_info),
+			image_write(9, vk::DescriptorType::eSampledImage, albedo_image_info),
+			image_write(10, vk::DescriptorType::eSampledImage, hiz_image_info),
+			image_write(11, vk::DescriptorType::eSampledImage, prev_color_image_info),
+			image_write(12, vk::DescriptorType::eStorageImage, signal_image_info),
+			buffer_write(13, vk::DescriptorType::eStorageBuffer, tile_list_buf_info),
+			image_write(14, vk::DescriptorType::eSampledImage, denoised_image_info),
+			image_write(15, vk::DescriptorType::eCombinedImageSampler, environment_specular_info),
+			image_write(16, vk::DescriptorType::eCombinedImageSampler, environment_brdf_lut_info),
+			image_write(17, vk::DescriptorType::eStorageImage, hdr_image_info),
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{
+			.material_descriptor_set = model.material_list.get_descriptor_set(),
+			.vertex_format = model.mesh_list->vertex_format,
+			.full_size = deferred.extent,
+			.history_size = prev_color.extent,
+			.reflection = reflection,
+			.hdr = hdr
+		};
+	}
+}
@@ -0,0 +1,432 @@
+#include "render/pipeline/restir.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/camera.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/model/tlas.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/restir.hpp"
+#include "shader/restir.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto binding_of = [](uint32_t binding, vk::DescriptorType type) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = type,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		constexpr auto storage_buffer_binding = [binding_of](uint32_t binding) {
+			return binding_of(binding, vk::DescriptorType::eStorageBuffer);
+		};
+
+		constexpr auto sampled_image_binding = [binding_of](uint32_t binding) {
+			return binding_of(binding, vk::DescriptorType::eSampledImage);
+		};
+
+		return std::to_array({
+			binding_of(0, vk::DescriptorType::eAccelerationStructureKHR),
+			binding_of(1, vk::DescriptorType::eUniformBuffer),  // Camera
+			storage_buffer_binding(2),                          // Primitive attributes
+			storage_buffer_binding(3),                          // Indices
+			storage_buffer_binding(4),                          // Vertices
+			storage_buffer_binding(5),                          // Punctual lights
+			storage_buffer_binding(6),                          // Node transforms
+			storage_buffer_binding(7),                          // Emissive triangles
+			sampled_image_binding(8),                           // Depth
+			sampled_image_binding(9),                           // Normal
+			sampled_image_binding(10),                          // PBR
+			sampled_image_binding(11),                          // Albedo
+			storage_buffer_binding(12),                         // Previous reservoirs
+			storage_buffer_binding(13),                         // Intermediate reservoirs
+			storage_buffer_binding(14),                         // Reservoirs
+			binding_of(15, vk::DescriptorType::eStorageImage),  // HDR
+		});
+	}
+
+	std::expected<RestirPipeline, Error> RestirPipeline::create(
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format
+	) noexcept
+	{
+		if (!context.feature.raytracing)
+			return Error("Missing raytracing feature", "ReSTIR requires raytracing feature");
+
+		auto shader_module_result = vulkan::create_shader(context.device, shader::restir);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({
+			material_layout.layout,
+			descriptor_set_layout,
+		});
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(set_layouts)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto spec_data = SpecializationConstant{
+			.packed_vertex = vertex_format == VertexFormat::Packed ? vk::True : vk::False
+		};
+		const auto packed_vertex_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = offsetof(SpecializationConstant, packed_vertex),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto specialization_info =
+			vk::SpecializationInfo()
+				.setMapEntries(packed_vertex_spec_entry)
+				.setData<SpecializationConstant>(spec_data);
+
+		const auto create_pipeline = [&](const char* entry) -> std::expected<vk::raii::Pipeline, Error> {
+			const auto pipeline_stage_create_info =
+				vk::PipelineShaderStageCreateInfo()
+					.setStage(vk::ShaderStageFlagBits::eCompute)
+					.setModule(shader_module)
+					.setPName(entry)
+					.setPSpecializationInfo(&specialization_info);
+			const auto pipeline_create_info =
+				vk::ComputePipelineCreateInfo()
+					.setStage(pipeline_stage_create_info)
+					.setLayout(pipeline_layout);
+
+			auto pipeline_result =
+				context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			return std::move(*pipeline_result);
+		};
+
+		auto initial_pipeline_result = create_pipeline("main_initial");
+		if (!initial_pipeline_result)
+			return initial_pipeline_result.error().forward("Create initial pipeline failed");
+
+		auto spatial_pipeline_result = create_pipeline("main_spatial");
+		if (!spatial_pipeline_result)
+			return spatial_pipeline_result.error().forward("Create spatial pipeline failed");
+
+		return RestirPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(*initial_pipeline_result),
+			std::move(*spatial_pipeline_result),
+			vertex_format
+		);
+	}
+
+	std::expected<std::vector<RestirPipeline::ResourceSet>, Error> RestirPipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void RestirPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		uint32_t frame_index,
+		bool history_valid
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "ReSTIR");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
+
+		const auto& hdr = resource_set->hdr;
+		const auto& restir = resource_set->restir;
+
+		const auto hdr_barrier = [&hdr](vk::PipelineStageFlags2 src_stage,
+										vk::AccessFlags2 src_access,
+										vk::PipelineStageFlags2 dst_stage,
+										vk::AccessFlags2 dst_access,
+										vk::ImageLayout old_layout,
+										vk::ImageLayout new_layout) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = src_stage,
+				.srcAccessMask = src_access,
+				.dstStageMask = dst_stage,
+				.dstAccessMask = dst_access,
+				.oldLayout = old_layout,
+				.newLayout = new_layout,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = hdr.attachment.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		};
+
+		// Reservoirs of the previous frame are read, and the reservoirs read by the next frame are written
+		constexpr auto storage_access =
+			vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite;
+		const auto reservoir_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = storage_access,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = storage_access,
+		};
+		const auto hdr_pre_barrier = hdr_barrier(
+			vk::PipelineStageFlagBits2::eColorAttachmentOutput | vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::PipelineStageFlagBits2::eComputeShader,
+			storage_access,
+			vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageLayout::eGeneral
+		);
+		command_buffer.pipelineBarrier2(
+			vk::DependencyInfo()
+				.setMemoryBarriers(reservoir_barrier)
+				.setImageMemoryBarriers(hdr_pre_barrier)
+		);
+
+		const auto push_constant = PushConstant{
+			.size = restir.extent,
+			.frame_index = frame_index,
+			.history_valid = history_valid ? 1u : 0u,
+			.candidate_count = std::max(option.candidate_count, 1u),
+			.spatial_samples = option.spatial_samples,
+			.spatial_radius = option.spatial_radius,
+			.max_history = static_cast<float>(option.max_history),
+			.punctual_count = resource_set->punctual_count,
+			.emissive_count = resource_set->emissive_count,
+		};
+		const auto group_count = (restir.extent + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{resource_set->material_descriptor_set, *resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+
+		/* Initial candidates and temporal reuse */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, initial_pipeline);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		const auto intermediate_barrier = vk::BufferMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.buffer = restir.intermediate,
+			.offset = 0,
+			.size = vk::WholeSize
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(intermediate_barrier));
+
+		/* Spatial reuse and shading */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, spatial_pipeline);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		/* Leave the HDR attachment in the layout of the lighting pass */
+
+		const auto hdr_post_barrier = hdr_barrier(
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderSampledRead,
+			vk::ImageLayout::eGeneral,
+			vk::ImageLayout::eShaderReadOnlyOptimal
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(hdr_post_barrier));
+	}
+
+	void RestirPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const Tlas& tlas,
+		DeferredAttachment::View deferred,
+		RestirAttachment::View restir,
+		RestirAttachment::View prev_restir,
+		HdrAttachment::View hdr,
+		vulkan::ElementBufferRef<Camera> camera,
+		vulkan::ArrayBufferRef<glm::mat4> world_transforms
+	) noexcept
+	{
+		DEBUG_ASSERT(deferred.extent == hdr.extent);
+		DEBUG_ASSERT(restir.extent == deferred.extent, "ReSTIR extent mismatches deferred attachment");
+
+		/*===== Texture / Buffer Infos =====*/
+
+		const auto tlas_handle = static_cast<vk::AccelerationStructureKHR>(tlas);
+		const auto tlas_info =
+			vk::WriteDescriptorSetAccelerationStructureKHR().setAccelerationStructures(tlas_handle);
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto camera_buf_info = whole_buffer_info(camera);
+		const auto primitive_attr_buf_info = whole_buffer_info(model.mesh_list->trace_primitive_attr_buffer);
+		const auto index_buf_info = whole_buffer_info(model.mesh_list->index_buffer);
+		const auto vertex_buf_info = whole_buffer_info(model.mesh_list->vertex_buffer);
+		const auto punctual_light_buf_info = whole_buffer_info(model.light_list.get());
+		const auto transform_buf_info = whole_buffer_info(world_transforms);
+		const auto emissive_buf_info = whole_buffer_info(model.emissive_list.get());
+		const auto prev_reservoir_buf_info = whole_buffer_info(prev_restir.reservoirs);
+		const auto intermediate_buf_info = whole_buffer_info(restir.intermediate);
+		const auto reservoir_buf_info = whole_buffer_info(restir.reservoirs);
+
+		const auto image_info = [](vk::ImageView view, vk::ImageLayout layout) {
+			return vk::DescriptorImageInfo{.imageView = view, .imageLayout = layout};
+		};
+
+		const auto depth_image_info =
+			image_info(deferred.depth.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto normal_image_info =
+			image_info(deferred.normal.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto pbr_image_info = image_info(deferred.pbr.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto albedo_image_info =
+			image_info(deferred.albedo.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto hdr_image_info = image_info(hdr.attachment.view, vk::ImageLayout::eGeneral);
+
+		/*===== Write Descriptor Set =====*/
+
+		const auto buffer_write = [this](uint32_t binding, const vk::DescriptorBufferInfo& info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &info,
+			};
+		};
+
+		const auto image_write =
+			[this](uint32_t binding, vk::DescriptorType type, const vk::DescriptorImageInfo& info) {
+				return vk::WriteDescriptorSet{
+					.dstSet = set,
+					.dstBinding = binding,
+					.descriptorCount = 1,
+					.descriptorType = type,
+					.pImageInfo = &info,
+				};
+			};
+
+		const auto write_descriptors = std::to_array({
+			vk::WriteDescriptorSet{
+				.pNext = &tlas_info,
+				.dstSet = set,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
+			},
+			vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = 1,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &camera_buf_info,
+			},
+			buffer_write(2, primitive_attr_buf_info),
+			buffer_write(3, index_buf_info),
+			buffer_write(4, vertex_buf_info),
+			buffer_write(5, punctual_light_buf_info),
+			buffer_write(6, transform_buf_info),
+			buffer_write(7, emissive_buf_info),
+			image_write(8, vk::DescriptorType::eSampledImage, depth_image_info),
+			image_write(9, vk::DescriptorType::eSampledImage, normal_image_info),
+			image_write(10, vk::DescriptorType::eSampledImage, pbr_image_info),
+			image_write(11, vk::DescriptorType::eSampledImage, albedo_image_info),
+			buffer_write(12, prev_reservoir_buf_info),
+			buffer_write(13, intermediate_buf_info),
+			buffer_write(14, reservoir_buf_info),
+			image_write(15, vk::DescriptorType::eStorageImage, hdr_image_info),
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{
+			.material_descriptor_set = model.material_list.get_descriptor_set(),
+			.vertex_format = model.mesh_list->vertex_format,
+			.punctual_count = model.light_list.count(),
+			.emissive_count = model.emissive_list.count(),
+			.restir = restir,
+			.prev_restir = prev_restir,
+			.hdr = hdr
+		};
+	}
+}
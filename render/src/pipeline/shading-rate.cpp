@@ -0,0 +1,413 @@
+#include "render/pipeline/shading-rate.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "shader/shading-rate-packed.hpp"
+#include "shader/shading-rate.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto prev_hdr_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 0,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto prev_velocity_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 1,
+			.descriptorType = vk::DescriptorType::eSampledImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto shading_rate_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 2,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		constexpr auto hdr_binding = vk::DescriptorSetLayoutBinding{
+			.binding = 3,
+			.descriptorType = vk::DescriptorType::eStorageImage,
+			.descriptorCount = 1,
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+		};
+
+		return std::to_array({
+			prev_hdr_binding,
+			prev_velocity_binding,
+			shading_rate_binding,
+			hdr_binding,
+		});
+	}
+
+	std::expected<ShadingRatePipeline, Error> ShadingRatePipeline::create(
+		const vulkan::Context& context,
+		vk::Format hdr_format
+	) noexcept
+	{
+		const bool packed_hdr = hdr_format == HdrAttachment::PACKED_HDR_FORMAT;
+		const auto shader_code = packed_hdr ? shader::shading_rate_packed : shader::shading_rate;
+		auto shader_module_result = vulkan::create_shader(context.device, shader_code);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*descriptor_set_layout)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		const auto create_pipeline =
+			[&](const char* entry_point) -> std::expected<vk::raii::Pipeline, Error> {
+			const auto stage_create_info =
+				vk::PipelineShaderStageCreateInfo()
+					.setStage(vk::ShaderStageFlagBits::eCompute)
+					.setModule(shader_module)
+					.setPName(entry_point);
+			const auto pipeline_create_info =
+				vk::ComputePipelineCreateInfo().setStage(stage_create_info).setLayout(pipeline_layout);
+
+			auto pipeline_result =
+				context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			return std::move(*pipeline_result);
+		};
+
+		auto generate_pipeline_result = create_pipeline("main_generate");
+		if (!generate_pipeline_result)
+			return generate_pipeline_result.error().forward("Create shading rate generate pipeline failed");
+		auto generate_pipeline = std::move(*generate_pipeline_result);
+
+		auto visualize_pipeline_result = create_pipeline("main_visualize");
+		if (!visualize_pipeline_result)
+			return visualize_pipeline_result.error().forward("Create shading rate visualize pipeline failed");
+		auto visualize_pipeline = std::move(*visualize_pipeline_result);
+
+		return ShadingRatePipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(generate_pipeline),
+			std::move(visualize_pipeline),
+			context.feature.fragment_shading_rate
+		);
+	}
+
+	std::expected<std::vector<ShadingRatePipeline::ResourceSet>, Error> ShadingRatePipeline::
+		create_resource_sets(const vulkan::Context& context, uint32_t count) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	ShadingRatePipeline::PushConstant ShadingRatePipeline::get_push_constant(
+		const ResourceSet& resource_set
+	) noexcept
+	{
+		const auto& shading_rate = resource_set->shading_rate;
+
+		return {
+			.extent = shading_rate.extent,
+			.prev_extent = resource_set->prev_extent,
+			.tile_size = shading_rate.tile_size,
+			.tile_count = shading_rate.tile_count,
+			.contrast_threshold = 0.0f,
+			.motion_scale = 0.0f,
+			.enabled = 0,
+		};
+	}
+
+	void ShadingRatePipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const Option& option,
+		bool history_valid
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Shading Rate");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+
+		auto push_constant = get_push_constant(resource_set);
+		push_constant.contrast_threshold = std::max(option.contrast_threshold, 0.0f);
+		push_constant.motion_scale = std::max(option.motion_scale, 0.0f);
+		push_constant.enabled = history_valid ? 1u : 0u;
+
+		dispatch(command_buffer, resource_set, push_constant);
+	}
+
+	void ShadingRatePipeline::clear(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Shading Rate Clear");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+
+		dispatch(command_buffer, resource_set, get_push_constant(resource_set));
+	}
+
+	void ShadingRatePipeline::dispatch(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		const PushConstant& push_constant
+	) const noexcept
+	{
+		const auto& shading_rate = resource_set->shading_rate;
+
+		// Consumers of the shading rate image of the previous use
+		auto consumer_stage =
+			vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+		auto consumer_access = vk::AccessFlags2(vk::AccessFlagBits2::eShaderStorageRead);
+		if (fragment_shading_rate)
+		{
+			consumer_stage |= vk::PipelineStageFlagBits2::eFragmentShadingRateAttachmentKHR;
+			consumer_access |= vk::AccessFlagBits2::eFragmentShadingRateAttachmentReadKHR;
+		}
+
+		/* Pre-generate layout transition, every tile in use is rewritten */
+
+		const auto pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = consumer_stage,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = shading_rate.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		/* Generate, one group per tile */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, generate_pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{*resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			push_constant
+		);
+		command_buffer.dispatch(shading_rate.tile_count.x, shading_rate.tile_count.y, 1);
+
+		/* Make the rates visible to the consumers */
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+			.dstStageMask = consumer_stage,
+			.dstAccessMask = consumer_access,
+			.oldLayout = vk::ImageLayout::eGeneral,
+			.newLayout = vk::ImageLayout::eGeneral,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = shading_rate.attachment.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	void ShadingRatePipeline::visualize(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Shading Rate Visualize");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& hdr = resource_set->hdr;
+
+		const auto hdr_barrier = [&hdr](vk::PipelineStageFlags2 src_stage,
+										vk::AccessFlags2 src_access,
+										vk::ImageLayout old_layout,
+										vk::PipelineStageFlags2 dst_stage,
+										vk::AccessFlags2 dst_access,
+										vk::ImageLayout new_layout) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = src_stage,
+				.srcAccessMask = src_access,
+				.dstStageMask = dst_stage,
+				.dstAccessMask = dst_access,
+				.oldLayout = old_layout,
+				.newLayout = new_layout,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = hdr.attachment.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		};
+
+		// Lighting writes either as color attachment or as storage image
+		const auto pre_barrier = hdr_barrier(
+			vk::PipelineStageFlagBits2::eColorAttachmentOutput | vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::ImageLayout::eGeneral
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		const auto group_count = (hdr.extent + WORKGROUP_SIZE - 1u) / WORKGROUP_SIZE;
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, visualize_pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			*pipeline_layout,
+			0,
+			{*resource_set.set},
+			{}
+		);
+		command_buffer.pushConstants<PushConstant>(
+			*pipeline_layout,
+			vk::ShaderStageFlagBits::eCompute,
+			0,
+			get_push_constant(resource_set)
+		);
+		command_buffer.dispatch(group_count.x, group_count.y, 1);
+
+		const auto post_barrier = hdr_barrier(
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::ImageLayout::eGeneral,
+			vk::PipelineStageFlagBits2::eAllCommands,
+			vk::AccessFlagBits2::eShaderSampledRead,
+			vk::ImageLayout::eShaderReadOnlyOptimal
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	void ShadingRatePipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		HdrAttachment::View prev_hdr,
+		DeferredAttachment::View prev_deferred,
+		HdrAttachment::View hdr,
+		ShadingRateAttachment::View shading_rate
+	) noexcept
+	{
+		DEBUG_ASSERT(hdr.extent == shading_rate.extent, "Shading rate image mismatches HDR attachment");
+
+		/*===== Texture Infos =====*/
+
+		const auto prev_hdr_image_info = vk::DescriptorImageInfo{
+			.imageView = prev_hdr.attachment.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto prev_velocity_image_info = vk::DescriptorImageInfo{
+			.imageView = prev_deferred.velocity.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto shading_rate_image_info = vk::DescriptorImageInfo{
+			.imageView = shading_rate.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		const auto hdr_image_info = vk::DescriptorImageInfo{
+			.imageView = hdr.attachment.view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+
+		/*===== Write Descriptor Set =====*/
+
+		const auto image_write = [this](uint32_t binding, vk::DescriptorType type, const auto& image_info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.descriptorCount = 1,
+				.descriptorType = type,
+				.pImageInfo = &image_info,
+			};
+		};
+
+		const auto write_descriptors = std::to_array({
+			image_write(0, vk::DescriptorType::eSampledImage, prev_hdr_image_info),
+			image_write(1, vk::DescriptorType::eSampledImage, prev_velocity_image_info),
+			image_write(2, vk::DescriptorType::eStorageImage, shading_rate_image_info),
+			image_write(3, vk::DescriptorType::eStorageImage, hdr_image_info),
+		});
+
+		descriptor_cache.update(context.device, write_descriptors);
+
+		/*===== Store Persistent =====*/
+
+		resource = Resource{
+			.prev_extent = prev_hdr.extent,
+			.hdr = hdr,
+			.shading_rate = shading_rate,
+		};
+	}
+}
@@ -0,0 +1,337 @@
+#include "render/pipeline/transform.hpp"
+#include "common/util/construct.hpp"
+#include "common/util/error.hpp"
+#include "render/model/scene-graph.hpp"
+#include "render/resource/transform.hpp"
+#include "shader/transform/propagate.hpp"
+#include "shader/transform/scatter.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static consteval auto get_descriptor_set_bindings() noexcept
+	{
+		constexpr auto get_storage_binding = [](uint32_t binding) {
+			return vk::DescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		};
+
+		return std::to_array({
+			get_storage_binding(0),  // Dirty local transform updates
+			get_storage_binding(1),  // Local transforms
+			get_storage_binding(2),  // Parent indices
+			get_storage_binding(3),  // BFS order
+			get_storage_binding(4),  // World transforms
+		});
+	}
+
+	static std::expected<vk::raii::Pipeline, Error> create_compute_pipeline(
+		const vulkan::Context& context,
+		const vk::raii::PipelineLayout& pipeline_layout,
+		const vk::raii::ShaderModule& shader_module
+	) noexcept
+	{
+		const auto pipeline_stage_create_info =
+			vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(shader_module)
+				.setPName("main");
+		const auto pipeline_create_info =
+			vk::ComputePipelineCreateInfo().setStage(pipeline_stage_create_info).setLayout(pipeline_layout);
+
+		auto pipeline_result =
+			context.device.createComputePipeline(context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+		return std::move(*pipeline_result);
+	}
+
+	static vk::BufferMemoryBarrier2 get_buffer_barrier(
+		vk::Buffer buffer,
+		vk::PipelineStageFlags2 src_stage,
+		vk::AccessFlags2 src_access,
+		vk::PipelineStageFlags2 dst_stage,
+		vk::AccessFlags2 dst_access
+	) noexcept
+	{
+		return vk::BufferMemoryBarrier2{
+			.srcStageMask = src_stage,
+			.srcAccessMask = src_access,
+			.dstStageMask = dst_stage,
+			.dstAccessMask = dst_access,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.buffer = buffer,
+			.offset = 0,
+			.size = vk::WholeSize
+		};
+	}
+
+	std::expected<TransformPipeline, Error> TransformPipeline::create(const vulkan::Context& context) noexcept
+	{
+		auto scatter_shader_result = vulkan::create_shader(context.device, shader::transform::scatter);
+		if (!scatter_shader_result)
+			return scatter_shader_result.error().forward("Create scatter shader module failed");
+		auto scatter_shader = std::move(*scatter_shader_result);
+
+		auto propagate_shader_result = vulkan::create_shader(context.device, shader::transform::propagate);
+		if (!propagate_shader_result)
+			return propagate_shader_result.error().forward("Create propagate shader module failed");
+		auto propagate_shader = std::move(*propagate_shader_result);
+
+		constexpr auto bindings = get_descriptor_set_bindings();
+		auto descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+		);
+		if (!descriptor_set_layout_result) return Error::from(descriptor_set_layout_result);
+		auto descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		const auto push_constant_range = vk::PushConstantRange{
+			.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			.offset = 0,
+			.size = sizeof(PushConstant)
+		};
+
+		auto pipeline_layout_result = context.device.createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+				.setSetLayouts(*descriptor_set_layout)
+				.setPushConstantRanges(push_constant_range)
+		);
+		if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		auto scatter_pipeline_result = create_compute_pipeline(context, pipeline_layout, scatter_shader);
+		if (!scatter_pipeline_result)
+			return scatter_pipeline_result.error().forward("Create scatter pipeline failed");
+
+		auto propagate_pipeline_result = create_compute_pipeline(context, pipeline_layout, propagate_shader);
+		if (!propagate_pipeline_result)
+			return propagate_pipeline_result.error().forward("Create propagate pipeline failed");
+
+		return TransformPipeline(
+			std::move(descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(*scatter_pipeline_result),
+			std::move(*propagate_pipeline_result)
+		);
+	}
+
+	std::expected<std::vector<TransformPipeline::ResourceSet>, Error> TransformPipeline::create_resource_sets(
+		const vulkan::Context& context,
+		uint32_t count
+	) const noexcept
+	{
+		constexpr auto bindings = get_descriptor_set_bindings();
+		const auto pool_sizes = vulkan::calc_pool_sizes(bindings, count);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(count, *descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+		auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+		if (!sets_result) return Error::from(sets_result);
+		auto sets = std::move(*sets_result);
+
+		return std::views::zip_transform(
+				   CTOR_LAMBDA(ResourceSet),
+				   std::views::repeat(descriptor_pool),
+				   sets | std::views::as_rvalue
+			   )
+			| std::ranges::to<std::vector>();
+	}
+
+	void TransformPipeline::compute(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Transform");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		const auto& scene_graph = resource_set.resource->scene_graph;
+		const auto& transform = resource_set.resource->transform;
+
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eCompute,
+			pipeline_layout,
+			0,
+			*resource_set.descriptor_set,
+			{}
+		);
+
+		/* Scatter dirty local transforms */
+
+		// The local transform buffer is shared across frames, wait for readers of previous frames
+		const auto pre_scatter_barrier = get_buffer_barrier(
+			scene_graph.local_transform_buffer,
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageRead,
+			vk::PipelineStageFlagBits2::eComputeShader,
+			vk::AccessFlagBits2::eShaderStorageWrite
+		);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(pre_scatter_barrier));
+
+		const auto update_count = static_cast<uint32_t>(transform.updates.count());
+		if (update_count > 0)
+		{
+			const auto push_constant = PushConstant{
+				.root_transform = transform.root_transform,
+				.offset = 0,
+				.count = update_count,
+			};
+
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, scatter_pipeline);
+			command_buffer.pushConstants<PushConstant>(
+				*pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				push_constant
+			);
+			command_buffer.dispatch((update_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+		}
+
+		// World transforms of the previous use of this frame are read by vertex and compute shaders
+		const auto pre_propagate_barriers = std::to_array({
+			get_buffer_barrier(
+				scene_graph.local_transform_buffer,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageRead
+			),
+			get_buffer_barrier(
+				transform.world_transform,
+				vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageRead,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite
+			),
+		});
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(pre_propagate_barriers));
+
+		/* Propagate level by level */
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, propagate_pipeline);
+
+		for (const auto& level : scene_graph.level_ranges)
+		{
+			const auto push_constant = PushConstant{
+				.root_transform = transform.root_transform,
+				.offset = level.offset,
+				.count = level.count,
+			};
+
+			command_buffer.pushConstants<PushConstant>(
+				*pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				push_constant
+			);
+			command_buffer.dispatch((level.count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+			// Next level and later passes read world transforms of this level
+			const auto level_barrier = get_buffer_barrier(
+				transform.world_transform,
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite,
+				vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eVertexShader,
+				vk::AccessFlagBits2::eShaderStorageRead
+			);
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(level_barrier));
+		}
+	}
+
+	void TransformPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const SceneGraph& scene_graph,
+		const TransformResource& transform
+	) noexcept
+	{
+		const auto scene_graph_ref = scene_graph.get();
+
+		const auto update_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = transform->updates,
+			.offset = 0,
+			.range = transform->updates.size_vk()
+		};
+
+		const auto local_transform_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = scene_graph_ref.local_transform_buffer,
+			.offset = 0,
+			.range = scene_graph_ref.local_transform_buffer.size_vk()
+		};
+
+		const auto parent_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = scene_graph_ref.parent_buffer,
+			.offset = 0,
+			.range = scene_graph_ref.parent_buffer.size_vk()
+		};
+
+		const auto bfs_order_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = scene_graph_ref.bfs_order_buffer,
+			.offset = 0,
+			.range = scene_graph_ref.bfs_order_buffer.size_vk()
+		};
+
+		const auto world_transform_buffer_info = vk::DescriptorBufferInfo{
+			.buffer = transform->world_transform,
+			.offset = 0,
+			.range = transform->world_transform.size_vk()
+		};
+
+		const auto buffer_infos = std::to_array({
+			update_buffer_info,
+			local_transform_buffer_info,
+			parent_buffer_info,
+			bfs_order_buffer_info,
+			world_transform_buffer_info,
+		});
+
+		const auto write_descriptor_sets =
+			buffer_infos
+			| std::views::enumerate
+			| std::views::transform([this](const auto& pair) {
+				  const auto& [binding, buffer_info] = pair;
+				  return vk::WriteDescriptorSet{
+					  .dstSet = descriptor_set,
+					  .dstBinding = static_cast<uint32_t>(binding),
+					  .descriptorCount = 1,
+					  .descriptorType = vk::DescriptorType::eStorageBuffer,
+					  .pBufferInfo = &buffer_info
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+
+		descriptor_cache.update(context.device, write_descriptor_sets);
+
+		resource = Resource{
+			.scene_graph = scene_graph_ref,
+			.transform = transform.ref(),
+		};
+	}
+}
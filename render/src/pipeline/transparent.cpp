@@ -0,0 +1,749 @@
+#include "render/pipeline/transparent.hpp"
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/direct-light.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model.hpp"
+#include "render/pipeline/util/constant.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "render/resource/transparent.hpp"
+#include "render/util/per-render-state.hpp"
+#include "shader/transparent.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/container/host/linked-struct.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/glm.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	namespace
+	{
+		consteval auto get_descriptor_set_bindings() noexcept
+		{
+			constexpr auto primitive_attr_buffer_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 0,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
+			};
+
+			constexpr auto indirect_buffer_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex
+			};
+
+			constexpr auto transform_buffer_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 2,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex
+			};
+
+			constexpr auto camera_buffer_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 3,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
+			};
+
+			constexpr auto direct_light_param_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 4,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment
+			};
+
+			constexpr auto material_feedback_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 5,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eFragment
+			};
+
+			return std::to_array({
+				primitive_attr_buffer_binding,
+				indirect_buffer_binding,
+				transform_buffer_binding,
+				camera_buffer_binding,
+				direct_light_param_binding,
+				material_feedback_binding,
+			});
+		}
+
+		constexpr auto DESCRIPTOR_SET_BINDINGS = get_descriptor_set_bindings();
+
+		constexpr auto COLOR_FORMATS = std::to_array({
+			TransparentAttachment::ACCUMULATION_FORMAT,  // Location 0
+			TransparentAttachment::REVEALAGE_FORMAT,     // Location 1
+		});
+
+		// Accumulation sums the weighted colors and alphas of all layers
+		constexpr auto ACCUMULATION_BLEND_STATE = vk::PipelineColorBlendAttachmentState{
+			.blendEnable = vk::True,
+			.srcColorBlendFactor = vk::BlendFactor::eOne,
+			.dstColorBlendFactor = vk::BlendFactor::eOne,
+			.colorBlendOp = vk::BlendOp::eAdd,
+			.srcAlphaBlendFactor = vk::BlendFactor::eOne,
+			.dstAlphaBlendFactor = vk::BlendFactor::eOne,
+			.alphaBlendOp = vk::BlendOp::eAdd,
+			.colorWriteMask = vk::ColorComponentFlagBits::eR
+				| vk::ColorComponentFlagBits::eG
+				| vk::ColorComponentFlagBits::eB
+				| vk::ColorComponentFlagBits::eA
+		};
+
+		// Revealage multiplies `1 - alpha` of all layers, the fragment outputs its alpha
+		constexpr auto REVEALAGE_BLEND_STATE = vk::PipelineColorBlendAttachmentState{
+			.blendEnable = vk::True,
+			.srcColorBlendFactor = vk::BlendFactor::eZero,
+			.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcColor,
+			.colorBlendOp = vk::BlendOp::eAdd,
+			.srcAlphaBlendFactor = vk::BlendFactor::eZero,
+			.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha,
+			.alphaBlendOp = vk::BlendOp::eAdd,
+			.colorWriteMask = vk::ColorComponentFlagBits::eR
+		};
+
+		constexpr auto COLOR_BLEND_STATES = std::to_array({
+			ACCUMULATION_BLEND_STATE,
+			REVEALAGE_BLEND_STATE,
+		});
+		static_assert(COLOR_BLEND_STATES.size() == COLOR_FORMATS.size());
+
+		// Layers are tested against the opaque geometry, but do not occlude each other
+		constexpr auto DEPTH_TEST_NO_WRITE_STATE = vk::PipelineDepthStencilStateCreateInfo{
+			.depthTestEnable = vk::True,
+			.depthWriteEnable = vk::False,
+			.depthCompareOp = vk::CompareOp::eGreaterOrEqual,
+			.depthBoundsTestEnable = vk::False,
+			.stencilTestEnable = vk::False
+		};
+
+		std::expected<vk::raii::DescriptorSetLayout, Error> create_descriptor_set_layout(
+			const vulkan::Context& context
+		) noexcept
+		{
+			auto layout_result = context.device.createDescriptorSetLayout(
+				vk::DescriptorSetLayoutCreateInfo().setBindings(DESCRIPTOR_SET_BINDINGS)
+			);
+			if (!layout_result) return Error::from(layout_result);
+			return std::move(*layout_result);
+		}
+
+		std::expected<vk::raii::PipelineLayout, Error> create_pipeline_layout(
+			const vulkan::Context& context,
+			vk::DescriptorSetLayout material_descriptor_set_layout,
+			vk::DescriptorSetLayout data_descriptor_set_layout
+		) noexcept
+		{
+			const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({
+				material_descriptor_set_layout,
+				data_descriptor_set_layout,
+			});
+			const auto create_info = vk::PipelineLayoutCreateInfo().setSetLayouts(set_layouts);
+
+			auto layout_result = context.device.createPipelineLayout(create_info);
+			if (!layout_result) return Error::from(layout_result);
+			return std::move(*layout_result);
+		}
+	}
+
+	std::expected<vk::raii::Pipeline, Error> TransparentPipeline::create_pipeline(
+		const vulkan::Context& context,
+		vk::PipelineLayout pipeline_layout,
+		vk::ShaderModule shader_module,
+		VertexFormat vertex_format,
+		bool double_sided
+	) noexcept
+	{
+		/*===== Shaders =====*/
+
+		const auto spec_data = SpecializationConstant{
+			.double_sided = double_sided ? vk::True : vk::False,
+			.packed_vertex = vertex_format == VertexFormat::Packed ? vk::True : vk::False
+		};
+
+		const auto double_sided_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = offsetof(SpecializationConstant, double_sided),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto packed_vertex_spec_entry = vk::SpecializationMapEntry{
+			.constantID = 1,
+			.offset = offsetof(SpecializationConstant, packed_vertex),
+			.size = sizeof(vk::Bool32),
+		};
+		const auto spec_entries = std::to_array({
+			double_sided_spec_entry,
+			packed_vertex_spec_entry,
+		});
+
+		const auto specialization_info =
+			vk::SpecializationInfo().setMapEntries(spec_entries).setData<SpecializationConstant>(spec_data);
+
+		const auto vertex_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
+			.stage = vk::ShaderStageFlagBits::eVertex,
+			.module = shader_module,
+			.pName = vertex_format == VertexFormat::Packed ? "main_vertex_packed" : "main_vertex",
+			.pSpecializationInfo = &specialization_info
+		};
+		const auto fragment_shader_stage_create_info = vk::PipelineShaderStageCreateInfo{
+			.stage = vk::ShaderStageFlagBits::eFragment,
+			.module = shader_module,
+			.pName = "main_fragment",
+			.pSpecializationInfo = &specialization_info
+		};
+
+		const auto shader_stages = std::to_array({
+			vertex_shader_stage_create_info,
+			fragment_shader_stage_create_info,
+		});
+
+		/*===== Input =====*/
+
+		const auto vertex_input_binding_desc = vk::VertexInputBindingDescription{
+			.binding = 0,
+			.stride = static_cast<uint32_t>(vertex_stride(vertex_format)),
+			.inputRate = vk::VertexInputRate::eVertex
+		};
+
+		const auto vertex_input_attribute_descs = gbuffer::get_vertex_input_attribute_descs(vertex_format);
+
+		const auto vertex_input_state_create_info =
+			vk::PipelineVertexInputStateCreateInfo()
+				.setVertexBindingDescriptions(vertex_input_binding_desc)
+				.setVertexAttributeDescriptions(vertex_input_attribute_descs);
+
+		/*===== Fixed Function =====*/
+
+		const auto rasterization_info = gbuffer::get_rasterization_state(double_sided);
+		const auto color_blend_info =
+			vk::PipelineColorBlendStateCreateInfo().setAttachments(COLOR_BLEND_STATES);
+
+		/*===== Output =====*/
+
+		const auto pipeline_rendering_create_info =
+			vk::PipelineRenderingCreateInfo()
+				.setColorAttachmentFormats(COLOR_FORMATS)
+				.setDepthAttachmentFormat(DeferredAttachment::DEPTH_FORMAT);
+
+		/*===== Dynamic States =====*/
+
+		const auto dynamic_state_info =
+			vk::PipelineDynamicStateCreateInfo().setDynamicStates(constant::DYNAMIC_VIEWPORT_DYNSTATE);
+
+		/*===== Pipeline Creation =====*/
+
+		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
+			vk::GraphicsPipelineCreateInfo()
+				.setStages(shader_stages)
+				.setPVertexInputState(&vertex_input_state_create_info)
+				.setPInputAssemblyState(&constant::TRIANGLE_LIST_INPUT_ASSEMBLY_STATE)
+				.setPRasterizationState(&rasterization_info)
+				.setPMultisampleState(&constant::BASIC_MULTISAMPLE_STATE)
+				.setPDepthStencilState(&DEPTH_TEST_NO_WRITE_STATE)
+				.setPColorBlendState(&color_blend_info)
+				.setPViewportState(&constant::DYNAMIC_VIEWPORT_STATE)
+				.setPDynamicState(&dynamic_state_info)
+				.setLayout(pipeline_layout);
+		pipeline_create_info.push(pipeline_rendering_create_info);
+
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
+		if (!pipeline_result)
+		{
+			return Error::from(pipeline_result)
+				.forward("Create graphics pipeline failed", std::format("double_sided={}", double_sided));
+		}
+
+		return std::move(*pipeline_result);
+	}
+
+	std::expected<TransparentPipeline, Error> TransparentPipeline::create(
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format
+	) noexcept
+	{
+		auto shader_module_result = vulkan::create_shader(context.device, shader::transparent);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		auto descriptor_set_layout_result = create_descriptor_set_layout(context);
+		if (!descriptor_set_layout_result)
+			return descriptor_set_layout_result.error().forward("Create descriptor set layout failed");
+		auto data_descriptor_set_layout = std::move(*descriptor_set_layout_result);
+
+		auto pipeline_layout_result =
+			create_pipeline_layout(context, material_layout.layout, data_descriptor_set_layout);
+		if (!pipeline_layout_result)
+			return pipeline_layout_result.error().forward("Create pipeline layout failed");
+		auto pipeline_layout = std::move(*pipeline_layout_result);
+
+		auto single_sided_result =
+			create_pipeline(context, pipeline_layout, shader_module, vertex_format, false);
+		if (!single_sided_result)
+			return single_sided_result.error().forward("Create single-sided pipeline failed");
+
+		auto double_sided_result =
+			create_pipeline(context, pipeline_layout, shader_module, vertex_format, true);
+		if (!double_sided_result)
+			return double_sided_result.error().forward("Create double-sided pipeline failed");
+
+		return TransparentPipeline(
+			std::move(data_descriptor_set_layout),
+			std::move(pipeline_layout),
+			std::move(*single_sided_result),
+			std::move(*double_sided_result),
+			vertex_format
+		);
+	}
+
+	std::expected<std::vector<TransparentPipeline::ResourceSet>, Error>
+	TransparentPipeline::create_resource_sets(const vulkan::Context& context, uint32_t count) const noexcept
+	{
+		/*
+		 * NOTE: Each resource set contains 4 descriptor sets for each render state, like the deferred
+		 * pipeline. Only the masked ones hold blended drawcalls, see `SceneGraph::Bucket::Blended`
+		 */
+
+		static constexpr auto SETS_PER_RESOURCE_SET = 4;
+
+		const auto descriptor_pool_sizes =
+			vulkan::calc_pool_sizes(DESCRIPTOR_SET_BINDINGS, count * SETS_PER_RESOURCE_SET);
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count * SETS_PER_RESOURCE_SET)
+				.setPoolSizes(descriptor_pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::vector(SETS_PER_RESOURCE_SET, *data_descriptor_set_layout);
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+
+		const auto create_resource_set_fn =
+			[&set_alloc_info, &context, &descriptor_pool] -> std::expected<ResourceSet, Error> {
+			auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+			if (!sets_result) return Error::from(sets_result);
+			auto sets = std::move(*sets_result);
+
+			return ResourceSet(
+				descriptor_pool,
+				{
+					.opaque_single_sided = std::move(sets[0]),
+					.opaque_double_sided = std::move(sets[1]),
+					.masked_single_sided = std::move(sets[2]),
+					.masked_double_sided = std::move(sets[3]),
+				}
+			);
+		};
+
+		return std::views::repeat(create_resource_set_fn, count)
+			| std::views::transform([](auto&& f) { return f(); })
+			| Error::collect();
+	}
+
+	void TransparentPipeline::render(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Transparent");
+		record(command_buffer, resource_set, true);
+	}
+
+	void TransparentPipeline::clear(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Transparent (Clear)");
+		record(command_buffer, resource_set, false);
+	}
+
+	void TransparentPipeline::record(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		bool draw
+	) const noexcept
+	{
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
+
+		const auto target_images = std::to_array({
+			resource_set->accumulation.image,
+			resource_set->revealage.image,
+		});
+
+		/*===== Pre-rendering Layout Transitions =====*/
+
+		// Previous content is discarded, last read by the composite pass
+		const auto pre_target_barriers = target_images | std::views::transform([](vk::Image image) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+				.srcAccessMask = vk::AccessFlagBits2::eNone,
+				.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+				.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+				.oldLayout = vk::ImageLayout::eUndefined,
+				.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		});
+
+		// Depth is sampled by the lighting and HiZ passes before
+		const auto pre_depth_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask =
+				vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+				| vk::PipelineStageFlagBits2::eLateFragmentTests,
+			.dstAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentRead,
+			.oldLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			.newLayout = vk::ImageLayout::eDepthReadOnlyOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = resource_set->depth.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eDepth)
+		};
+
+		auto pre_barriers = pre_target_barriers | std::ranges::to<std::vector>();
+		pre_barriers.push_back(pre_depth_barrier);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+
+		/*===== Begin Rendering =====*/
+
+		// Empty accumulation and full revealage, resolving to the opaque image only
+		const auto color_attachment_infos = std::to_array({
+			vk::RenderingAttachmentInfo{
+				.imageView = resource_set->accumulation.view,
+				.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.loadOp = vk::AttachmentLoadOp::eClear,
+				.storeOp = vk::AttachmentStoreOp::eStore,
+				.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 0.0f)
+			},
+			vk::RenderingAttachmentInfo{
+				.imageView = resource_set->revealage.view,
+				.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.loadOp = vk::AttachmentLoadOp::eClear,
+				.storeOp = vk::AttachmentStoreOp::eStore,
+				.clearValue = vk::ClearColorValue(1.0f, 1.0f, 1.0f, 1.0f)
+			},
+		});
+
+		const auto depth_attachment_info = vk::RenderingAttachmentInfo{
+			.imageView = resource_set->depth.view,
+			.imageLayout = vk::ImageLayout::eDepthReadOnlyOptimal,
+			.loadOp = vk::AttachmentLoadOp::eLoad,
+			.storeOp = vk::AttachmentStoreOp::eNone,
+		};
+
+		const auto rendering_rect = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(resource_set->extent)
+		};
+
+		command_buffer.beginRendering(
+			vk::RenderingInfo()
+				.setRenderArea(rendering_rect)
+				.setLayerCount(1)
+				.setColorAttachments(color_attachment_infos)
+				.setPDepthAttachment(&depth_attachment_info)
+		);
+
+		command_buffer.setViewport(
+			0,
+			vk::Viewport{
+				.x = 0.0f,
+				.y = 0.0f,
+				.width = static_cast<float>(resource_set->extent.x),
+				.height = static_cast<float>(resource_set->extent.y),
+				.minDepth = 0.0f,
+				.maxDepth = 1.0f
+			}
+		);
+		command_buffer.setScissor(0, rendering_rect);
+
+		/*===== Draw =====*/
+
+		if (draw)
+		{
+			command_buffer.bindVertexBuffers(0, resource_set->vertex_buffer, {0});
+			command_buffer.bindIndexBuffer(
+				resource_set->index_buffer,
+				0,
+				index_type(resource_set->index_format)
+			);
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				*pipeline_layout,
+				0,
+				resource_set->material_descriptor_set,
+				{}
+			);
+
+			const auto pipelines =
+				PerRenderState<vk::Pipeline>::from_ctor([this](model::AlphaMode, bool double_sided) {
+					return double_sided ? *double_sided_pipeline : *single_sided_pipeline;
+				});
+
+			for (
+				const auto& [pipeline, descriptor_set, indirect_buffer, commands, count_buffer] :
+				std::views::zip(
+					pipelines.all(),
+					resource_set.data_descriptor_set.all(),
+					resource_set->indirect_buffers.all(),
+					resource_set->command_buffers.all(),
+					resource_set->count_buffers.all()
+				)
+			)
+			{
+				const auto phase_capacity = IndirectResource::phase_capacity(indirect_buffer);
+				if (phase_capacity == 0) continue;
+
+				command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+				command_buffer.bindDescriptorSets(
+					vk::PipelineBindPoint::eGraphics,
+					*pipeline_layout,
+					1,
+					*descriptor_set,
+					{}
+				);
+
+				// Layers are order-independent, both phases are drawn in one pass
+				for (const auto phase : {DrawPhase::Early, DrawPhase::Late})
+				{
+					const auto command_offset = IndirectResource::phase_offset(indirect_buffer, phase)
+						* sizeof(vk::DrawIndexedIndirectCommand);
+					const auto count_offset = phase == DrawPhase::Early
+						? offsetof(IndirectCount, early_command_count)
+						: offsetof(IndirectCount, late_command_count);
+
+					command_buffer.drawIndexedIndirectCount(
+						commands,
+						command_offset,
+						count_buffer,
+						count_offset,
+						phase_capacity,
+						sizeof(vk::DrawIndexedIndirectCommand)
+					);
+				}
+			}
+		}
+
+		command_buffer.endRendering();
+
+		/*===== Post-rendering Layout Transitions =====*/
+
+		const auto post_target_barriers = target_images | std::views::transform([](vk::Image image) {
+			return vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+				.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+				.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+		});
+
+		const auto post_depth_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+				| vk::PipelineStageFlagBits2::eLateFragmentTests,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask =
+				vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderRead,
+			.oldLayout = vk::ImageLayout::eDepthReadOnlyOptimal,
+			.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = resource_set->depth.image,
+			.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eDepth)
+		};
+
+		auto post_barriers = post_target_barriers | std::ranges::to<std::vector>();
+		post_barriers.push_back(post_depth_barrier);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barriers));
+	}
+
+	void TransparentPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const TransformResource& transform,
+		const IndirectResource& indirect_resource,
+		DeferredAttachment::View deferred_attachment,
+		TransparentAttachment::View transparent_attachment,
+		vulkan::ElementBufferRef<Camera> camera_param,
+		vulkan::ElementBufferRef<DirectLight> primary_light_param,
+		vulkan::ArrayBufferRef<uint32_t> material_feedback
+	) noexcept
+	{
+		DEBUG_ASSERT(deferred_attachment.extent == transparent_attachment.extent);
+
+		/* Write descriptor sets */
+
+		const auto primitive_attr_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = model.mesh_list->primitive_attr_buffer,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto indirect_buffer_writes = indirect_resource.ref().map([](const auto& drawcall_buffer) {
+			return vk::DescriptorBufferInfo{
+				.buffer = drawcall_buffer,
+				.offset = 0,
+				.range = drawcall_buffer.size_vk(),
+			};
+		});
+
+		const auto transform_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = transform->world_transform,
+			.offset = 0,
+			.range = transform->world_transform.size_vk(),
+		};
+
+		const auto camera_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = camera_param,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto direct_light_param_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = primary_light_param,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+
+		const auto material_feedback_buffer_write = vk::DescriptorBufferInfo{
+			.buffer = material_feedback,
+			.offset = 0,
+			.range = material_feedback.size_vk(),
+		};
+
+		for (
+			const auto& [descriptor_set, indirect_buffer_write] :
+			std::views::zip(data_descriptor_set.all(), indirect_buffer_writes.all())
+		)
+		{
+			const auto primitive_attr_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &primitive_attr_buffer_write
+			};
+
+			const auto indirect_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 1,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &indirect_buffer_write
+			};
+
+			const auto transform_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 2,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &transform_buffer_write
+			};
+
+			const auto camera_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 3,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &camera_buffer_write
+			};
+
+			const auto direct_light_param_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 4,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.pBufferInfo = &direct_light_param_buffer_write
+			};
+
+			const auto material_feedback_buffer_write_set = vk::WriteDescriptorSet{
+				.dstSet = descriptor_set,
+				.dstBinding = 5,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &material_feedback_buffer_write
+			};
+
+			const auto write_sets = std::to_array({
+				primitive_attr_buffer_write_set,
+				indirect_buffer_write_set,
+				transform_buffer_write_set,
+				camera_buffer_write_set,
+				direct_light_param_buffer_write_set,
+				material_feedback_buffer_write_set,
+			});
+
+			descriptor_cache.update(context.device, write_sets);
+		}
+
+		/* Store infos */
+
+		resource = Resource{
+			.material_descriptor_set = model.material_list.get_descriptor_set(),
+
+			.vertex_buffer = model.mesh_list->vertex_buffer,
+			.vertex_format = model.mesh_list->vertex_format,
+			.index_buffer = model.mesh_list->index_buffer,
+			.index_format = model.mesh_list->index_format,
+			.indirect_buffers = indirect_resource.ref(),
+			.command_buffers = indirect_resource.command_ref(),
+			.count_buffers = indirect_resource.count_ref(),
+
+			.extent = transparent_attachment.extent,
+			.depth = deferred_attachment.depth,
+			.accumulation = transparent_attachment.accumulation,
+			.revealage = transparent_attachment.revealage,
+		};
+	}
+}
@@ -0,0 +1,283 @@
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "common/util/array.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/shading-rate.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/glm.hpp"
+
+#include <array>
+#include <cstdint>
+#include <libassert/assert.hpp>
+#include <optional>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render::gbuffer
+{
+	Attachment Attachment::from(
+		DeferredAttachment::View deferred_attachment,
+		HdrAttachment::View hdr_attachment
+	) noexcept
+	{
+		DEBUG_ASSERT(deferred_attachment.extent == hdr_attachment.extent);
+		DEBUG_ASSERT(deferred_attachment.view_count == hdr_attachment.view_count);
+
+		return Attachment{
+			.extent = deferred_attachment.extent,
+			.albedo = deferred_attachment.albedo,
+			.normal = deferred_attachment.normal,
+			.pbr = deferred_attachment.pbr,
+			.velocity = deferred_attachment.velocity,
+			.depth = deferred_attachment.depth,
+			.hdr = hdr_attachment.attachment,
+			.object_id = deferred_attachment.object_id,
+			.view_count = deferred_attachment.view_count,
+		};
+	}
+
+	void begin_rendering(
+		const vk::raii::CommandBuffer& command_buffer,
+		const Attachment& attachments,
+		DrawPhase phase,
+		std::optional<ShadingRateAttachment::View> shading_rate
+	) noexcept
+	{
+		const auto color_attachments = std::to_array({
+			attachments.albedo,
+			attachments.normal,
+			attachments.pbr,
+			attachments.velocity,
+		});
+
+		/*===== Pre-rendering Layout Transitions =====*/
+		// NOTE: Early phase discards previous content, late phase continues rendering on top of early phase
+		// results, which are left in post-rendering layouts
+
+		// Multiview passes render every layer at once
+		const auto color_range =
+			vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor, attachments.view_count);
+		const auto depth_range =
+			vulkan::base_level_image_range(vk::ImageAspectFlagBits::eDepth, attachments.view_count);
+
+		const auto is_early = phase == DrawPhase::Early;
+		const auto prev_layout =
+			is_early ? vk::ImageLayout::eUndefined : vk::ImageLayout::eShaderReadOnlyOptimal;
+
+		const auto pre_depth_src_stage = is_early
+			? vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests
+			: vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader;
+		const auto pre_color_src_stage = is_early
+			? vk::PipelineStageFlagBits2::eColorAttachmentOutput
+			: vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+
+		const auto pre_depth_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = pre_depth_src_stage,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+				| vk::PipelineStageFlagBits2::eLateFragmentTests,
+			.dstAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+				| vk::AccessFlagBits2::eDepthStencilAttachmentRead,
+			.oldLayout = prev_layout,
+			.newLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = attachments.depth.image,
+			.subresourceRange = depth_range
+		};
+
+		const auto pre_color_barriers =
+			util::array_concat(color_attachments, attachments.object_id)
+			| util::map_array([pre_color_src_stage, prev_layout, color_range](
+								  const vulkan::AttachmentView& attachment
+							  ) {
+				return vk::ImageMemoryBarrier2{
+					.srcStageMask = pre_color_src_stage,
+					.srcAccessMask = vk::AccessFlagBits2::eNone,
+					.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+					.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+					.oldLayout = prev_layout,
+					.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+					.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+					.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+					.image = attachment.image,
+					.subresourceRange = color_range
+				};
+			});
+
+		// HDR attachment is left in color attachment layout in both phases
+		const auto pre_hdr_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.srcAccessMask =
+				is_early ? vk::AccessFlagBits2::eNone : vk::AccessFlagBits2::eColorAttachmentWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+			.oldLayout = is_early ? vk::ImageLayout::eUndefined : vk::ImageLayout::eColorAttachmentOptimal,
+			.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = attachments.hdr.image,
+			.subresourceRange = color_range
+		};
+
+		const auto pre_barriers = util::array_concat(pre_depth_barrier, pre_color_barriers, pre_hdr_barrier);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+
+		/*===== Begin Rendering =====*/
+
+		const auto load_op = is_early ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad;
+
+		// Zero albedo alpha marks the pixels not covered by geometry, see the sky flag of `DeferredPipeline`
+
+		const auto float_attachment_infos =
+			util::array_concat(color_attachments, attachments.hdr)
+			| util::map_array([load_op](const vulkan::AttachmentView& attachment) {
+				return vk::RenderingAttachmentInfo{
+					.imageView = attachment.view,
+					.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+					.loadOp = load_op,
+					.storeOp = vk::AttachmentStoreOp::eStore,
+					.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 0.0f)
+				};
+			});
+
+		const auto object_id_attachment_info = vk::RenderingAttachmentInfo{
+			.imageView = attachments.object_id.view,
+			.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.loadOp = load_op,
+			.storeOp = vk::AttachmentStoreOp::eStore,
+			.clearValue = vk::ClearColorValue(
+				std::to_array<uint32_t>({DeferredAttachment::INVALID_OBJECT_ID, 0, 0, 0})
+			)
+		};
+
+		const auto color_attachment_infos =
+			util::array_concat(float_attachment_infos, object_id_attachment_info);
+
+		const auto depth_attachment_info = vk::RenderingAttachmentInfo{
+			.imageView = attachments.depth.view,
+			.imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+			.loadOp = load_op,
+			.storeOp = vk::AttachmentStoreOp::eStore,
+			.clearValue = vk::ClearDepthStencilValue{.depth = 0.0f, .stencil = 0}
+		};
+
+		const auto rendering_rect = vk::Rect2D{
+			.offset = vk::Offset2D{.x = 0, .y = 0},
+			.extent = vulkan::to<vk::Extent2D>(attachments.extent)
+		};
+
+		auto rendering_info =
+			vk::RenderingInfo()
+				.setRenderArea(rendering_rect)
+				.setLayerCount(1)
+				.setViewMask(get_view_mask(attachments.view_count))
+				.setColorAttachments(color_attachment_infos)
+				.setPDepthAttachment(&depth_attachment_info);
+
+		// Coarse shading of low contrast tiles, see `ShadingRatePipeline`
+		auto shading_rate_attachment_info = vk::RenderingFragmentShadingRateAttachmentInfoKHR();
+		if (shading_rate.has_value())
+		{
+			DEBUG_ASSERT(shading_rate->extent == attachments.extent);
+			DEBUG_ASSERT(attachments.view_count == 1, "Shading rate attachment is single-layered");
+
+			shading_rate_attachment_info = vk::RenderingFragmentShadingRateAttachmentInfoKHR{
+				.imageView = shading_rate->attachment.view,
+				.imageLayout = vk::ImageLayout::eGeneral,
+				.shadingRateAttachmentTexelSize = vulkan::to<vk::Extent2D>(shading_rate->tile_size),
+			};
+			rendering_info.setPNext(&shading_rate_attachment_info);
+		}
+
+		command_buffer.beginRendering(rendering_info);
+
+		command_buffer.setViewport(
+			0,
+			vk::Viewport{
+				.x = 0.0f,
+				.y = 0.0f,
+				.width = static_cast<float>(attachments.extent.x),
+				.height = static_cast<float>(attachments.extent.y),
+				.minDepth = 0.0f,
+				.maxDepth = 1.0f
+			}
+		);
+		command_buffer.setScissor(0, rendering_rect);
+	}
+
+	void end_rendering(const vk::raii::CommandBuffer& command_buffer, const Attachment& attachments) noexcept
+	{
+		command_buffer.endRendering();
+
+		/*===== Post-rendering Layout Transitions =====*/
+		// NOTE: HDR attachment is handled differently than others -- no layout transitions, expect next usage
+		// to be color attachment
+
+		const auto color_range =
+			vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor, attachments.view_count);
+		const auto depth_range =
+			vulkan::base_level_image_range(vk::ImageAspectFlagBits::eDepth, attachments.view_count);
+
+		const auto post_layout_transition_color_attachments = std::to_array({
+			attachments.albedo,
+			attachments.normal,
+			attachments.pbr,
+			attachments.velocity,
+			attachments.object_id,
+		});
+
+		const auto post_color_barriers =
+			post_layout_transition_color_attachments
+			| util::map_array([color_range](const vulkan::AttachmentView& attachment) {
+				  return vk::ImageMemoryBarrier2{
+					  .srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+					  .srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+					  .dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader
+						  | vk::PipelineStageFlagBits2::eComputeShader,
+					  .dstAccessMask = vk::AccessFlagBits2::eShaderRead,
+					  .oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+					  .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+					  .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+					  .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+					  .image = attachment.image,
+					  .subresourceRange = color_range
+				  };
+			  });
+
+		const auto post_hdr_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+			.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = attachments.hdr.image,
+			.subresourceRange = color_range
+		};
+
+		const auto post_depth_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+				| vk::PipelineStageFlagBits2::eLateFragmentTests,
+			.srcAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+				| vk::AccessFlagBits2::eDepthStencilAttachmentRead,
+			.dstStageMask =
+				vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eShaderRead,
+			.oldLayout = vk::ImageLayout::eDepthAttachmentOptimal,
+			.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = attachments.depth.image,
+			.subresourceRange = depth_range
+		};
+
+		const auto post_barriers =
+			util::array_concat(post_color_barriers, post_hdr_barrier, post_depth_barrier);
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barriers));
+	}
+}
@@ -0,0 +1,961 @@
+#include "render/pipeline/visibility.hpp"
+#include "common/util/array.hpp"
+#include "common/util/error.hpp"
+#include "model/material.hpp"
+#include "render/interface/camera.hpp"
+#include "render/interface/indirect-drawcall.hpp"
+#include "render/model/material.hpp"
+#include "render/model/model.hpp"
+#include "render/pipeline/util/constant.hpp"
+#include "render/pipeline/util/fullscreen-pipeline.hpp"
+#include "render/pipeline/util/gbuffer-pass.hpp"
+#include "render/resource/deferred.hpp"
+#include "render/resource/hdr.hpp"
+#include "render/resource/indirect.hpp"
+#include "render/resource/transform.hpp"
+#include "render/resource/visibility.hpp"
+#include "render/util/per-render-state.hpp"
+#include "shader/visibility-resolve.hpp"
+#include "shader/visibility.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/container/host/linked-struct.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/numeric/glm.hpp"
+#include "vulkan/numeric/pool-size.hpp"
+#include "vulkan/util/debug-utils.hpp"
+#include "vulkan/util/shader.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <libassert/assert.hpp>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	namespace
+	{
+		constexpr uint32_t RENDER_STATE_COUNT = 4;  // Must match `RENDER_STATE_COUNT` in the resolve shader
+
+		consteval auto get_draw_descriptor_set_bindings() noexcept
+		{
+			constexpr auto primitive_attr_buffer_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 0,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
+			};
+
+			constexpr auto indirect_buffer_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
+			};
+
+			constexpr auto transform_buffer_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 2,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex
+			};
+
+			constexpr auto camera_buffer_binding = vk::DescriptorSetLayoutBinding{
+				.binding = 3,
+				.descriptorType = vk::DescriptorType::eUniformBuffer,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eVertex
+			};
+
+			return std::to_array({
+				primitive_attr_buffer_binding,
+				indirect_buffer_binding,
+				transform_buffer_binding,
+				camera_buffer_binding,
+			});
+		}
+
+		consteval auto get_resolve_descriptor_set_bindings() noexcept
+		{
+			constexpr auto make_binding = [](uint32_t binding, vk::DescriptorType type, uint32_t count = 1) {
+				return vk::DescriptorSetLayoutBinding{
+					.binding = binding,
+					.descriptorType = type,
+					.descriptorCount = count,
+					.stageFlags = vk::ShaderStageFlagBits::eFragment
+				};
+			};
+
+			constexpr auto storage_buffer = vk::DescriptorType::eStorageBuffer;
+
+			return std::to_array({
+				make_binding(0, storage_buffer),                      // Primitive attributes
+				make_binding(1, storage_buffer, RENDER_STATE_COUNT),  // Indirect drawcalls
+				make_binding(2, storage_buffer),                      // Transforms
+				make_binding(3, storage_buffer),                      // Previous transforms
+				make_binding(4, vk::DescriptorType::eUniformBuffer),  // Camera
+				make_binding(5, storage_buffer),                      // Index buffer
+				make_binding(6, storage_buffer),                      // Vertex buffer
+				make_binding(7, vk::DescriptorType::eSampledImage),   // Visibility buffer
+				make_binding(8, storage_buffer),                      // Material feedback
+			});
+		}
+
+		std::expected<vk::raii::PipelineLayout, Error> create_pipeline_layout(
+			const vulkan::Context& context,
+			vk::DescriptorSetLayout material_descriptor_set_layout,
+			vk::DescriptorSetLayout data_descriptor_set_layout
+		) noexcept
+		{
+			const auto set_layouts = std::to_array<const vk::DescriptorSetLayout>({
+				material_descriptor_set_layout,
+				data_descriptor_set_layout,
+			});
+			const auto create_info = vk::PipelineLayoutCreateInfo().setSetLayouts(set_layouts);
+
+			auto layout_result = context.device.createPipelineLayout(create_info);
+			if (!layout_result) return Error::from(layout_result);
+			return std::move(*layout_result);
+		}
+
+		// Visibility buffer stays in color attachment layout between the phases, as nothing reads it
+		void begin_visibility_rendering(
+			const vk::raii::CommandBuffer& command_buffer,
+			vulkan::AttachmentView visibility,
+			const gbuffer::Attachment& attachment,
+			DrawPhase phase
+		) noexcept
+		{
+			const auto is_early = phase == DrawPhase::Early;
+
+			/*===== Pre-rendering Layout Transitions =====*/
+
+			const auto pre_visibility_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+				.srcAccessMask =
+					is_early ? vk::AccessFlagBits2::eNone : vk::AccessFlagBits2::eColorAttachmentWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+				.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+				.oldLayout =
+					is_early ? vk::ImageLayout::eUndefined : vk::ImageLayout::eColorAttachmentOptimal,
+				.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = visibility.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+
+			// Depth is read by HiZ build between the phases, same as `gbuffer::begin_rendering`
+			const auto pre_depth_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = is_early
+					? vk::PipelineStageFlagBits2::eEarlyFragmentTests
+						| vk::PipelineStageFlagBits2::eLateFragmentTests
+					: vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eNone,
+				.dstStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+					| vk::PipelineStageFlagBits2::eLateFragmentTests,
+				.dstAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+					| vk::AccessFlagBits2::eDepthStencilAttachmentRead,
+				.oldLayout = is_early ? vk::ImageLayout::eUndefined : vk::ImageLayout::eShaderReadOnlyOptimal,
+				.newLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = attachment.depth.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eDepth)
+			};
+
+			const auto pre_barriers = std::to_array({pre_visibility_barrier, pre_depth_barrier});
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+
+			/*===== Begin Rendering =====*/
+
+			const auto load_op = is_early ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad;
+
+			const auto visibility_attachment_info = vk::RenderingAttachmentInfo{
+				.imageView = visibility.view,
+				.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.loadOp = load_op,
+				.storeOp = vk::AttachmentStoreOp::eStore,
+				.clearValue = vk::ClearColorValue(
+					std::to_array<uint32_t>({VisibilityAttachment::INVALID_ID, 0, 0, 0})
+				)
+			};
+
+			const auto depth_attachment_info = vk::RenderingAttachmentInfo{
+				.imageView = attachment.depth.view,
+				.imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+				.loadOp = load_op,
+				.storeOp = vk::AttachmentStoreOp::eStore,
+				.clearValue = vk::ClearDepthStencilValue{.depth = 0.0f, .stencil = 0}
+			};
+
+			const auto rendering_rect = vk::Rect2D{
+				.offset = vk::Offset2D{.x = 0, .y = 0},
+				.extent = vulkan::to<vk::Extent2D>(attachment.extent)
+			};
+
+			const auto rendering_info =
+				vk::RenderingInfo()
+					.setRenderArea(rendering_rect)
+					.setLayerCount(1)
+					.setColorAttachments(visibility_attachment_info)
+					.setPDepthAttachment(&depth_attachment_info);
+
+			command_buffer.beginRendering(rendering_info);
+
+			command_buffer.setViewport(
+				0,
+				vk::Viewport{
+					.x = 0.0f,
+					.y = 0.0f,
+					.width = static_cast<float>(attachment.extent.x),
+					.height = static_cast<float>(attachment.extent.y),
+					.minDepth = 0.0f,
+					.maxDepth = 1.0f
+				}
+			);
+			command_buffer.setScissor(0, rendering_rect);
+		}
+
+		void end_visibility_rendering(
+			const vk::raii::CommandBuffer& command_buffer,
+			vulkan::AttachmentView visibility,
+			const gbuffer::Attachment& attachment,
+			DrawPhase phase
+		) noexcept
+		{
+			command_buffer.endRendering();
+
+			/*===== Post-rendering Layout Transitions =====*/
+
+			const auto post_depth_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+					| vk::PipelineStageFlagBits2::eLateFragmentTests,
+				.srcAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+					| vk::AccessFlagBits2::eDepthStencilAttachmentRead,
+				.dstStageMask =
+					vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderRead,
+				.oldLayout = vk::ImageLayout::eDepthAttachmentOptimal,
+				.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = attachment.depth.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eDepth)
+			};
+
+			if (phase == DrawPhase::Early)
+			{
+				const auto dependency_info = vk::DependencyInfo().setImageMemoryBarriers(post_depth_barrier);
+				command_buffer.pipelineBarrier2(dependency_info);
+				return;
+			}
+
+			// Visibility buffer is complete after the late phase, and read by the resolve pass
+			const auto post_visibility_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+				.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+				.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = visibility.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+
+			const auto post_barriers = std::to_array({post_visibility_barrier, post_depth_barrier});
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barriers));
+		}
+
+		// Color attachments are written once per frame by the resolve pass, previous contents are discarded
+		void begin_resolve_rendering(
+			const vk::raii::CommandBuffer& command_buffer,
+			const gbuffer::Attachment& attachment
+		) noexcept
+		{
+			const auto color_attachments = std::to_array({
+				attachment.albedo,
+				attachment.normal,
+				attachment.pbr,
+				attachment.velocity,
+				attachment.hdr,
+			});
+
+			/*===== Pre-rendering Layout Transitions =====*/
+
+			const auto barrier_attachments = util::array_concat(color_attachments, attachment.object_id);
+			const auto pre_barriers =
+				barrier_attachments | util::map_array([](const vulkan::AttachmentView& color_attachment) {
+					return vk::ImageMemoryBarrier2{
+						.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+						.srcAccessMask = vk::AccessFlagBits2::eNone,
+						.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+						.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+						.oldLayout = vk::ImageLayout::eUndefined,
+						.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+						.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+						.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+						.image = color_attachment.image,
+						.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+					};
+				});
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+
+			/*===== Begin Rendering =====*/
+
+			// Clear values match `gbuffer::begin_rendering`, for pixels not covered by geometry
+			const auto float_attachment_infos =
+				color_attachments | util::map_array([](const vulkan::AttachmentView& color_attachment) {
+					return vk::RenderingAttachmentInfo{
+						.imageView = color_attachment.view,
+						.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+						.loadOp = vk::AttachmentLoadOp::eClear,
+						.storeOp = vk::AttachmentStoreOp::eStore,
+						.clearValue = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 0.0f)
+					};
+				});
+
+			const auto object_id_attachment_info = vk::RenderingAttachmentInfo{
+				.imageView = attachment.object_id.view,
+				.imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.loadOp = vk::AttachmentLoadOp::eClear,
+				.storeOp = vk::AttachmentStoreOp::eStore,
+				.clearValue = vk::ClearColorValue(
+					std::to_array<uint32_t>({DeferredAttachment::INVALID_OBJECT_ID, 0, 0, 0})
+				)
+			};
+
+			const auto color_attachment_infos =
+				util::array_concat(float_attachment_infos, object_id_attachment_info);
+
+			const auto rendering_rect = vk::Rect2D{
+				.offset = vk::Offset2D{.x = 0, .y = 0},
+				.extent = vulkan::to<vk::Extent2D>(attachment.extent)
+			};
+
+			const auto rendering_info =
+				vk::RenderingInfo()
+					.setRenderArea(rendering_rect)
+					.setLayerCount(1)
+					.setColorAttachments(color_attachment_infos);
+
+			command_buffer.beginRendering(rendering_info);
+
+			command_buffer.setViewport(
+				0,
+				vk::Viewport{
+					.x = 0.0f,
+					.y = 0.0f,
+					.width = static_cast<float>(attachment.extent.x),
+					.height = static_cast<float>(attachment.extent.y),
+					.minDepth = 0.0f,
+					.maxDepth = 1.0f
+				}
+			);
+			command_buffer.setScissor(0, rendering_rect);
+		}
+
+		// Leaves the attachments in the same layouts as `gbuffer::end_rendering`
+		void end_resolve_rendering(
+			const vk::raii::CommandBuffer& command_buffer,
+			const gbuffer::Attachment& attachment
+		) noexcept
+		{
+			command_buffer.endRendering();
+
+			/*===== Post-rendering Layout Transitions =====*/
+
+			const auto color_attachments = std::to_array({
+				attachment.albedo,
+				attachment.normal,
+				attachment.pbr,
+				attachment.velocity,
+				attachment.object_id,
+			});
+
+			const auto post_color_barriers =
+				color_attachments | util::map_array([](const vulkan::AttachmentView& color_attachment) {
+					return vk::ImageMemoryBarrier2{
+						.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+						.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+						.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader
+							| vk::PipelineStageFlagBits2::eComputeShader,
+						.dstAccessMask = vk::AccessFlagBits2::eShaderRead,
+						.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+						.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+						.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+						.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+						.image = color_attachment.image,
+						.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+					};
+				});
+
+			const auto post_hdr_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+				.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+				.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+				.oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = attachment.hdr.image,
+				.subresourceRange = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor)
+			};
+
+			const auto post_barriers = util::array_concat(post_color_barriers, post_hdr_barrier);
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barriers));
+		}
+	}
+
+	std::expected<vk::raii::Pipeline, Error> VisibilityPipeline::create_draw_pipeline(
+		const vulkan::Context& context,
+		const vk::raii::PipelineLayout& pipeline_layout,
+		const vk::raii::ShaderModule& shader_module,
+		VertexFormat vertex_format,
+		bool alpha_mask_enabled,
+		bool double_sided
+	) noexcept
+	{
+		/*===== Shaders =====*/
+
+		const auto spec_data = SpecializationConstant{
+			.alpha_mask_enabled = alpha_mask_enabled ? vk::True : vk::False,
+			.double_sided = double_sided ? vk::True : vk::False
+		};
+
+		const auto spec_entries = std::to_array({
+			vk::SpecializationMapEntry{
+				.constantID = 0,
+				.offset = offsetof(SpecializationConstant, alpha_mask_enabled),
+				.size = sizeof(vk::Bool32),
+			},
+			vk::SpecializationMapEntry{
+				.constantID = 1,
+				.offset = offsetof(SpecializationConstant, double_sided),
+				.size = sizeof(vk::Bool32),
+			},
+		});
+
+		const auto specialization_info =
+			vk::SpecializationInfo().setMapEntries(spec_entries).setData<SpecializationConstant>(spec_data);
+
+		const auto shader_stage_create_infos = std::to_array({
+			vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eVertex,
+				.module = shader_module,
+				.pName = vertex_format == VertexFormat::Packed ? "main_vertex_packed" : "main_vertex",
+			},
+			vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eFragment,
+				.module = shader_module,
+				.pName = "main_fragment",
+				.pSpecializationInfo = &specialization_info
+			},
+		});
+
+		/*===== Input =====*/
+
+		const auto vertex_input_binding_desc = vk::VertexInputBindingDescription{
+			.binding = 0,
+			.stride = static_cast<uint32_t>(vertex_stride(vertex_format)),
+			.inputRate = vk::VertexInputRate::eVertex
+		};
+
+		const auto vertex_input_attribute_descs = gbuffer::get_vertex_input_attribute_descs(vertex_format);
+
+		const auto vertex_input_state_create_info =
+			vk::PipelineVertexInputStateCreateInfo()
+				.setVertexBindingDescriptions(vertex_input_binding_desc)
+				.setVertexAttributeDescriptions(vertex_input_attribute_descs);
+
+		/*===== Fixed Function =====*/
+
+		const auto rasterization_info = gbuffer::get_rasterization_state(double_sided);
+		const auto color_blend_info =
+			vk::PipelineColorBlendStateCreateInfo().setAttachments(constant::DEFAULT_BLEND_STATE);
+
+		/*===== Output =====*/
+
+		const auto pipeline_rendering_create_info =
+			vk::PipelineRenderingCreateInfo()
+				.setColorAttachmentFormats(VisibilityAttachment::VISIBILITY_FORMAT)
+				.setDepthAttachmentFormat(DeferredAttachment::DEPTH_FORMAT);
+
+		/*===== Dynamic States =====*/
+
+		const auto dynamic_state_info =
+			vk::PipelineDynamicStateCreateInfo().setDynamicStates(constant::DYNAMIC_VIEWPORT_DYNSTATE);
+
+		/*===== Pipeline Creation =====*/
+
+		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
+			vk::GraphicsPipelineCreateInfo()
+				.setStages(shader_stage_create_infos)
+				.setPVertexInputState(&vertex_input_state_create_info)
+				.setPInputAssemblyState(&constant::TRIANGLE_LIST_INPUT_ASSEMBLY_STATE)
+				.setPRasterizationState(&rasterization_info)
+				.setPMultisampleState(&constant::BASIC_MULTISAMPLE_STATE)
+				.setPDepthStencilState(&gbuffer::DEPTH_STENCIL_STATE)
+				.setPColorBlendState(&color_blend_info)
+				.setPViewportState(&constant::DYNAMIC_VIEWPORT_STATE)
+				.setPDynamicState(&dynamic_state_info)
+				.setLayout(pipeline_layout);
+		pipeline_create_info.push(pipeline_rendering_create_info);
+
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
+		if (!pipeline_result)
+		{
+			return Error::from(pipeline_result)
+				.forward(
+					"Create graphics pipeline failed",
+					std::format("alpha_mask_enabled={}, double_sided={}", alpha_mask_enabled, double_sided)
+				);
+		}
+
+		return std::move(*pipeline_result);
+	}
+
+	std::expected<vk::raii::Pipeline, Error> VisibilityPipeline::create_resolve_pipeline(
+		const vulkan::Context& context,
+		const vk::raii::PipelineLayout& pipeline_layout,
+		VertexFormat vertex_format,
+		vk::Format hdr_format
+	) noexcept
+	{
+		/*===== Shaders =====*/
+
+		auto vertex_shader_result = fullscreen::get_vertex_shader(context.device);
+		auto fragment_shader_result = vulkan::create_shader(context.device, shader::visibility_resolve);
+
+		if (!vertex_shader_result) return vertex_shader_result.error().forward("Create vertex shader failed");
+		if (!fragment_shader_result)
+			return fragment_shader_result.error().forward("Create fragment shader failed");
+
+		auto vertex_shader = std::move(*vertex_shader_result);
+		auto fragment_shader = std::move(*fragment_shader_result);
+
+		const vk::Bool32 packed_vertex = vertex_format == VertexFormat::Packed ? vk::True : vk::False;
+		const auto spec_entry = vk::SpecializationMapEntry{
+			.constantID = 0,
+			.offset = 0,
+			.size = sizeof(vk::Bool32),
+		};
+		const auto specialization_info =
+			vk::SpecializationInfo().setMapEntries(spec_entry).setData<vk::Bool32>(packed_vertex);
+
+		const auto shader_stages = std::to_array({
+			vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eVertex,
+				.module = vertex_shader,
+				.pName = "main"
+			},
+			vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eFragment,
+				.module = fragment_shader,
+				.pName = "main",
+				.pSpecializationInfo = &specialization_info
+			},
+		});
+
+		/*===== Pipeline =====*/
+
+		const auto color_blend_state =
+			vk::PipelineColorBlendStateCreateInfo().setAttachments(gbuffer::COLOR_BLEND_ATTACHMENT_STATES);
+
+		const auto color_formats = gbuffer::get_color_formats(hdr_format);
+		const auto pipeline_rendering_create_info =
+			vk::PipelineRenderingCreateInfo().setColorAttachmentFormats(color_formats);
+
+		vulkan::LinkedStruct<vk::GraphicsPipelineCreateInfo> pipeline_create_info =
+			vk::GraphicsPipelineCreateInfo()
+				.setStages(shader_stages)
+				.setPVertexInputState(&fullscreen::VERTEX_INPUT_STATE)
+				.setPInputAssemblyState(&constant::TRIANGLE_LIST_INPUT_ASSEMBLY_STATE)
+				.setPRasterizationState(&constant::NO_CULL_RASTERIZATION_STATE)
+				.setPMultisampleState(&constant::BASIC_MULTISAMPLE_STATE)
+				.setPDepthStencilState(&constant::NO_DEPTH_TEST_STATE)
+				.setPColorBlendState(&color_blend_state)
+				.setPViewportState(&constant::DYNAMIC_VIEWPORT_STATE)
+				.setPDynamicState(&fullscreen::DYNAMIC_STATE_INFO)
+				.setLayout(pipeline_layout);
+		pipeline_create_info.push(pipeline_rendering_create_info);
+
+		auto pipeline_result =
+			context.device.createGraphicsPipeline(context.pipeline_cache, pipeline_create_info.get());
+		if (!pipeline_result) return Error::from(pipeline_result);
+
+		return std::move(*pipeline_result);
+	}
+
+	std::expected<VisibilityPipeline, Error> VisibilityPipeline::create(
+		const vulkan::Context& context,
+		const render::MaterialLayout& material_layout,
+		VertexFormat vertex_format,
+		vk::Format hdr_format
+	) noexcept
+	{
+		auto shader_module_result = vulkan::create_shader(context.device, shader::visibility);
+		if (!shader_module_result) return shader_module_result.error().forward("Create shader module failed");
+		auto shader_module = std::move(*shader_module_result);
+
+		/*===== Descriptor Set Layouts =====*/
+
+		constexpr auto draw_bindings = get_draw_descriptor_set_bindings();
+		constexpr auto resolve_bindings = get_resolve_descriptor_set_bindings();
+
+		auto draw_descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(draw_bindings)
+		);
+		if (!draw_descriptor_set_layout_result) return Error::from(draw_descriptor_set_layout_result);
+		auto draw_descriptor_set_layout = std::move(*draw_descriptor_set_layout_result);
+
+		auto resolve_descriptor_set_layout_result = context.device.createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo().setBindings(resolve_bindings)
+		);
+		if (!resolve_descriptor_set_layout_result) return Error::from(resolve_descriptor_set_layout_result);
+		auto resolve_descriptor_set_layout = std::move(*resolve_descriptor_set_layout_result);
+
+		/*===== Pipeline Layouts =====*/
+
+		auto draw_pipeline_layout_result =
+			create_pipeline_layout(context, material_layout.layout, draw_descriptor_set_layout);
+		if (!draw_pipeline_layout_result)
+			return draw_pipeline_layout_result.error().forward("Create draw pipeline layout failed");
+		auto draw_pipeline_layout = std::move(*draw_pipeline_layout_result);
+
+		auto resolve_pipeline_layout_result =
+			create_pipeline_layout(context, material_layout.layout, resolve_descriptor_set_layout);
+		if (!resolve_pipeline_layout_result)
+			return resolve_pipeline_layout_result.error().forward("Create resolve pipeline layout failed");
+		auto resolve_pipeline_layout = std::move(*resolve_pipeline_layout_result);
+
+		/*===== Pipelines =====*/
+
+		auto draw_pipelines_result = PerRenderState<vk::raii::Pipeline>::from_ctor(
+			[&](model::AlphaMode alpha_mode, bool double_sided) {
+				return create_draw_pipeline(
+					context,
+					draw_pipeline_layout,
+					shader_module,
+					vertex_format,
+					alpha_mode == model::AlphaMode::Mask,
+					double_sided
+				);
+			}
+		);
+		if (!draw_pipelines_result)
+			return draw_pipelines_result.error().forward("Create draw pipelines failed");
+		auto draw_pipelines = std::move(*draw_pipelines_result);
+
+		auto resolve_pipeline_result =
+			create_resolve_pipeline(context, resolve_pipeline_layout, vertex_format, hdr_format);
+		if (!resolve_pipeline_result)
+			return resolve_pipeline_result.error().forward("Create resolve pipeline failed");
+		auto resolve_pipeline = std::move(*resolve_pipeline_result);
+
+		return VisibilityPipeline(
+			std::move(draw_descriptor_set_layout),
+			std::move(resolve_descriptor_set_layout),
+			std::move(draw_pipeline_layout),
+			std::move(resolve_pipeline_layout),
+			std::move(draw_pipelines),
+			std::move(resolve_pipeline),
+			vertex_format
+		);
+	}
+
+	std::expected<std::vector<VisibilityPipeline::ResourceSet>, Error> VisibilityPipeline::
+		create_resource_sets(const vulkan::Context& context, uint32_t count) const noexcept
+	{
+		/*
+		 * NOTE: Each resource set contains 4 draw descriptor sets for each material variant, and a single
+		 * resolve descriptor set
+		 */
+
+		constexpr auto draw_bindings = get_draw_descriptor_set_bindings();
+		constexpr auto resolve_bindings = get_resolve_descriptor_set_bindings();
+
+		auto descriptor_pool_sizes = vulkan::calc_pool_sizes(draw_bindings, count * RENDER_STATE_COUNT);
+		descriptor_pool_sizes.append_range(vulkan::calc_pool_sizes(resolve_bindings, count));
+
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(count * (RENDER_STATE_COUNT + 1))
+				.setPoolSizes(descriptor_pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		auto descriptor_pool = std::make_shared<vk::raii::DescriptorPool>(std::move(*descriptor_pool_result));
+
+		const auto layouts = std::to_array<vk::DescriptorSetLayout>({
+			draw_descriptor_set_layout,
+			draw_descriptor_set_layout,
+			draw_descriptor_set_layout,
+			draw_descriptor_set_layout,
+			resolve_descriptor_set_layout,
+		});
+		const auto set_alloc_info =
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(*descriptor_pool).setSetLayouts(layouts);
+
+		const auto create_resource_set_fn =
+			[&set_alloc_info, &context, &descriptor_pool] -> std::expected<ResourceSet, Error> {
+			auto sets_result = context.device.allocateDescriptorSets(set_alloc_info);
+			if (!sets_result) return Error::from(sets_result);
+			auto sets = std::move(*sets_result);
+
+			return ResourceSet(
+				descriptor_pool,
+				{
+					.opaque_single_sided = std::move(sets[0]),
+					.opaque_double_sided = std::move(sets[1]),
+					.masked_single_sided = std::move(sets[2]),
+					.masked_double_sided = std::move(sets[3]),
+				},
+				std::move(sets[4])
+			);
+		};
+
+		return std::views::repeat(create_resource_set_fn, count)
+			| std::views::transform([](auto&& f) { return f(); })
+			| Error::collect();
+	}
+
+	void VisibilityPipeline::render(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set,
+		DrawPhase phase
+	) const noexcept
+	{
+		const auto* label_name = phase == DrawPhase::Early ? "Visibility (Early)" : "Visibility (Late)";
+		const auto label = vulkan::DebugLabel(command_buffer, label_name);
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+		DEBUG_ASSERT(resource_set->vertex_format == vertex_format, "Model vertex format mismatches pipeline");
+
+		begin_visibility_rendering(command_buffer, resource_set->visibility, resource_set->attachment, phase);
+
+		/*===== Draw =====*/
+
+		command_buffer.bindVertexBuffers(0, resource_set.resource->vertex_buffer, {0});
+		command_buffer.bindIndexBuffer(
+			resource_set.resource->index_buffer,
+			0,
+			index_type(resource_set.resource->index_format)
+		);
+
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eGraphics,
+			*draw_pipeline_layout,
+			0,
+			resource_set.resource->material_descriptor_set,
+			{}
+		);
+
+		for (
+			const auto& [pipeline, data_descriptor_set, indirect_buffer, instanced_commands, count_buffer] :
+			std::views::zip(
+				draw_pipelines.all(),
+				resource_set.draw_descriptor_set.all(),
+				resource_set.resource->indirect_buffers.all(),
+				resource_set.resource->command_buffers.all(),
+				resource_set.resource->count_buffers.all()
+			)
+		)
+		{
+			const auto phase_capacity = IndirectResource::phase_capacity(indirect_buffer);
+			if (phase_capacity == 0) continue;
+
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
+
+			command_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				*draw_pipeline_layout,
+				1,
+				*data_descriptor_set,
+				{}
+			);
+
+			// Instanced commands are in the front of each phase, actual count is written by indirect pass
+			const auto command_offset = IndirectResource::phase_offset(indirect_buffer, phase)
+				* sizeof(vk::DrawIndexedIndirectCommand);
+			const auto count_offset = phase == DrawPhase::Early
+				? offsetof(IndirectCount, early_command_count)
+				: offsetof(IndirectCount, late_command_count);
+
+			command_buffer.drawIndexedIndirectCount(
+				instanced_commands,
+				command_offset,
+				count_buffer,
+				count_offset,
+				phase_capacity,
+				sizeof(vk::DrawIndexedIndirectCommand)
+			);
+		}
+
+		end_visibility_rendering(command_buffer, resource_set->visibility, resource_set->attachment, phase);
+	}
+
+	void VisibilityPipeline::resolve(
+		const vk::raii::CommandBuffer& command_buffer,
+		const ResourceSet& resource_set
+	) const noexcept
+	{
+		const auto label = vulkan::DebugLabel(command_buffer, "Visibility Resolve");
+
+		DEBUG_ASSERT(resource_set.resource.has_value());
+
+		begin_resolve_rendering(command_buffer, resource_set->attachment);
+
+		command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *resolve_pipeline);
+		command_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eGraphics,
+			*resolve_pipeline_layout,
+			0,
+			{resource_set.resource->material_descriptor_set, *resource_set.resolve_descriptor_set},
+			{}
+		);
+		command_buffer.draw(6, 1, 0, 0);
+
+		end_resolve_rendering(command_buffer, resource_set->attachment);
+	}
+
+	void VisibilityPipeline::ResourceSet::update(
+		const vulkan::Context& context,
+		const Model& model,
+		const TransformResource& transform,
+		const TransformResource& prev_transform,
+		const IndirectResource& indirect_resource,
+		DeferredAttachment::View deferred_attachment,
+		HdrAttachment::View hdr_attachment,
+		VisibilityAttachment::View visibility_attachment,
+		vulkan::ElementBufferRef<Camera> camera_param,
+		vulkan::ArrayBufferRef<uint32_t> material_feedback
+	) noexcept
+	{
+		DEBUG_ASSERT(visibility_attachment.extent == deferred_attachment.extent);
+
+		/* Buffer infos */
+
+		const auto whole_buffer_info = [](vk::Buffer buffer) {
+			return vk::DescriptorBufferInfo{.buffer = buffer, .offset = 0, .range = vk::WholeSize};
+		};
+
+		const auto primitive_attr_buffer_info = whole_buffer_info(model.mesh_list->primitive_attr_buffer);
+		const auto transform_buffer_info = whole_buffer_info(transform->world_transform);
+		const auto prev_transform_buffer_info = whole_buffer_info(prev_transform->world_transform);
+		const auto camera_buffer_info = whole_buffer_info(camera_param);
+		const auto index_buffer_info = whole_buffer_info(model.mesh_list->index_buffer);
+		const auto vertex_buffer_info = whole_buffer_info(model.mesh_list->vertex_buffer);
+		const auto material_feedback_buffer_info = whole_buffer_info(material_feedback);
+
+		// In the order of `PerRenderState::all()`, which the resolve shader indexes by render state
+		const auto indirect_buffer_infos = indirect_resource.ref().as_array()
+			| util::map_array([&whole_buffer_info](vulkan::ArrayBufferRef<IndirectDrawcall> buffer) {
+				  return whole_buffer_info(buffer);
+			  });
+
+		const auto visibility_image_info = vk::DescriptorImageInfo{
+			.imageView = visibility_attachment.attachment.view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+
+		const auto buffer_write = [](vk::DescriptorSet set,
+									 uint32_t binding,
+									 vk::DescriptorType type,
+									 const vk::DescriptorBufferInfo& info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = type,
+				.pBufferInfo = &info
+			};
+		};
+
+		/* Draw descriptor sets */
+
+		for (
+			const auto& [descriptor_set, indirect_buffer_info] :
+			std::views::zip(draw_descriptor_set.all(), indirect_buffer_infos)
+		)
+		{
+			const auto write_sets = std::to_array({
+				buffer_write(
+					descriptor_set,
+					0,
+					vk::DescriptorType::eStorageBuffer,
+					primitive_attr_buffer_info
+				),
+				buffer_write(descriptor_set, 1, vk::DescriptorType::eStorageBuffer, indirect_buffer_info),
+				buffer_write(descriptor_set, 2, vk::DescriptorType::eStorageBuffer, transform_buffer_info),
+				buffer_write(descriptor_set, 3, vk::DescriptorType::eUniformBuffer, camera_buffer_info),
+			});
+
+			descriptor_cache.update(context.device, write_sets);
+		}
+
+		/* Resolve descriptor set */
+
+		const auto resolve_set = *resolve_descriptor_set;
+		const auto resolve_write_sets = std::to_array({
+			buffer_write(resolve_set, 0, vk::DescriptorType::eStorageBuffer, primitive_attr_buffer_info),
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_set,
+				.dstBinding = 1,
+				.dstArrayElement = 0,
+				.descriptorCount = RENDER_STATE_COUNT,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = indirect_buffer_infos.data()
+			},
+			buffer_write(resolve_set, 2, vk::DescriptorType::eStorageBuffer, transform_buffer_info),
+			buffer_write(resolve_set, 3, vk::DescriptorType::eStorageBuffer, prev_transform_buffer_info),
+			buffer_write(resolve_set, 4, vk::DescriptorType::eUniformBuffer, camera_buffer_info),
+			buffer_write(resolve_set, 5, vk::DescriptorType::eStorageBuffer, index_buffer_info),
+			buffer_write(resolve_set, 6, vk::DescriptorType::eStorageBuffer, vertex_buffer_info),
+			vk::WriteDescriptorSet{
+				.dstSet = resolve_set,
+				.dstBinding = 7,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eSampledImage,
+				.pImageInfo = &visibility_image_info
+			},
+			buffer_write(resolve_set, 8, vk::DescriptorType::eStorageBuffer, material_feedback_buffer_info),
+		});
+
+		descriptor_cache.update(context.device, resolve_write_sets);
+
+		/* Store infos */
+
+		DEBUG_ASSERT(deferred_attachment.view_count == 1, "Multiview is only supported by `DeferredPipeline`");
+
+		resource = Resource{
+			.material_descriptor_set = model.material_list.get_descriptor_set(),
+
+			.vertex_buffer = model.mesh_list->vertex_buffer,
+			.vertex_format = model.mesh_list->vertex_format,
+			.index_buffer = model.mesh_list->index_buffer,
+			.index_format = model.mesh_list->index_format,
+			.indirect_buffers = indirect_resource.ref(),
+			.command_buffers = indirect_resource.command_ref(),
+			.count_buffers = indirect_resource.count_ref(),
+
+			.visibility = visibility_attachment.attachment,
+			.attachment = gbuffer::Attachment::from(deferred_attachment, hdr_attachment)
+		};
+	}
+}
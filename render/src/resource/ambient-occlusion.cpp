@@ -0,0 +1,37 @@
+#include "render/resource/ambient-occlusion.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<AmbientOcclusionAttachment, Error> AmbientOcclusionAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent,
+		Resolution resolution
+	) noexcept
+	{
+		const auto downscale = static_cast<uint32_t>(resolution);
+		const auto reduced_extent = (extent + downscale - 1u) / downscale;
+
+		auto attachment_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			reduced_extent,
+			AMBIENT_OCCLUSION_FORMAT,
+			vk::ImageUsageFlagBits::eStorage,
+			{},
+			"Ambient Occlusion"
+		);
+		if (!attachment_result)
+			return attachment_result.error().forward("Create ambient occlusion image failed");
+
+		return AmbientOcclusionAttachment(reduced_extent, downscale, std::move(*attachment_result));
+	}
+}
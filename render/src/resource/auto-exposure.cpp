@@ -5,6 +5,7 @@
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <utility>
 #include <vulkan/vulkan.hpp>
@@ -21,9 +22,16 @@ namespace render
 				vulkan::MemoryUsage::GpuOnly
 			);
 
+		// Result may be computed on the compute queue and consumed on the main queue. Transfer usage for
+		// filling a default result before the first computation
+		const auto queue_families = device.unique_families();
 		auto exposure_result_buffer_result = device.allocator.create_element_buffer<ExposureResult>(
-			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eUniformBuffer,
-			vulkan::MemoryUsage::GpuOnly
+			vk::BufferUsageFlagBits::eStorageBuffer
+				| vk::BufferUsageFlagBits::eUniformBuffer
+				| vk::BufferUsageFlagBits::eTransferDst,
+			vulkan::MemoryUsage::GpuOnly,
+			device.multi_queue_sharing_mode(),
+			queue_families
 		);
 
 		auto exposure_frame_buffer_result = device.allocator.create_element_buffer<ExposureFrame>(
@@ -31,17 +39,25 @@ namespace render
 			vulkan::MemoryUsage::GpuOnly
 		);
 
+		auto pyramid_counter_buffer_result = device.allocator.create_element_buffer<uint32_t>(
+			vk::BufferUsageFlagBits::eStorageBuffer,
+			vulkan::MemoryUsage::GpuOnly
+		);
+
 		if (!histogram_buffer_result)
 			return histogram_buffer_result.error().forward("Create histogram buffer failed");
 		if (!exposure_result_buffer_result)
 			return exposure_result_buffer_result.error().forward("Create exposure result buffer failed");
 		if (!exposure_frame_buffer_result)
 			return exposure_frame_buffer_result.error().forward("Create exposure frame buffer failed");
+		if (!pyramid_counter_buffer_result)
+			return pyramid_counter_buffer_result.error().forward("Create pyramid counter buffer failed");
 
 		return AutoExposureResource(
 			std::move(*histogram_buffer_result),
 			std::move(*exposure_result_buffer_result),
-			std::move(*exposure_frame_buffer_result)
+			std::move(*exposure_frame_buffer_result),
+			std::move(*pyramid_counter_buffer_result)
 		);
 	}
 }
@@ -0,0 +1,92 @@
+#include "render/resource/bloom.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <glm/common.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	static uint32_t calc_level_count(glm::u32vec2 level0_extent) noexcept
+	{
+		uint32_t level_count = 1;
+		for (auto size = std::max(level0_extent.x, level0_extent.y); size > 1; size = (size + 1) / 2)
+			level_count++;
+		return std::min(level_count, BloomAttachment::MAX_LEVELS);
+	}
+
+	std::expected<BloomAttachment, Error> BloomAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		const auto level0_extent = glm::max((extent + 1u) / 2u, glm::u32vec2(1));
+		const auto level_count = calc_level_count(level0_extent);
+
+		const auto image_create_info = vk::ImageCreateInfo{
+			.imageType = vk::ImageType::e2D,
+			.format = BLOOM_FORMAT,
+			.extent = {.width = level0_extent.x, .height = level0_extent.y, .depth = 1},
+			.mipLevels = level_count,
+			.arrayLayers = 1,
+			.samples = vk::SampleCountFlagBits::e1,
+			.tiling = vk::ImageTiling::eOptimal,
+			.usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+		};
+
+		auto image_result = context.allocator.create_image(
+			image_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Attachment,
+			"Bloom"
+		);
+		if (!image_result) return image_result.error().forward("Create bloom image failed");
+		auto image = std::move(*image_result);
+
+		std::vector<vk::raii::ImageView> level_views;
+		level_views.reserve(level_count);
+		for (const auto level : std::views::iota(0u, level_count))
+		{
+			auto view_result = context.device.createImageView({
+				.image = image,
+				.viewType = vk::ImageViewType::e2D,
+				.format = BLOOM_FORMAT,
+				.subresourceRange = {
+					.aspectMask = vk::ImageAspectFlagBits::eColor,
+					.baseMipLevel = level,
+					.levelCount = 1,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+			});
+			if (!view_result) return Error::from(view_result);
+			level_views.emplace_back(std::move(*view_result));
+		}
+
+		return BloomAttachment(extent, std::move(image), std::move(level_views));
+	}
+
+	BloomAttachment::operator View() const noexcept
+	{
+		auto view = View{
+			.extent = extent,
+			.level_count = static_cast<uint32_t>(level_views.size()),
+			.image = image,
+			.level_views = {},
+		};
+
+		for (const auto [idx, level_view] : level_views | std::views::enumerate)
+			view.level_views[idx] = level_view;
+
+		return view;
+	}
+}
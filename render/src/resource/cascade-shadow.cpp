@@ -0,0 +1,131 @@
+#include "render/resource/cascade-shadow.hpp"
+#include "common/util/error.hpp"
+#include "render/util/cascade.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <libassert/assert.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	std::expected<CascadeShadowAttachment, Error> CascadeShadowAttachment::create(
+		const vulkan::Context& context,
+		uint32_t resolution,
+		uint32_t cascade_count
+	) noexcept
+	{
+		if (cascade_count == 0 || cascade_count > MAX_CASCADES)
+			return Error("Invalid cascade count", std::format("{} (max {})", cascade_count, MAX_CASCADES));
+
+		const auto image_create_info = vk::ImageCreateInfo{
+			.imageType = vk::ImageType::e2D,
+			.format = DEPTH_FORMAT,
+			.extent = {.width = resolution, .height = resolution, .depth = 1},
+			.mipLevels = 1,
+			.arrayLayers = cascade_count,
+			.samples = vk::SampleCountFlagBits::e1,
+			.tiling = vk::ImageTiling::eOptimal,
+			.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled
+		};
+
+		auto image_result = context.allocator.create_image(
+			image_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Attachment,
+			"Cascade Shadow Map"
+		);
+		if (!image_result) return image_result.error().forward("Create cascade shadow image failed");
+		auto image = std::move(*image_result);
+
+		const auto create_view = [&](vk::ImageViewType type, uint32_t base_layer, uint32_t count) {
+			return context.device.createImageView({
+				.image = image,
+				.viewType = type,
+				.format = DEPTH_FORMAT,
+				.subresourceRange = {
+					.aspectMask = vk::ImageAspectFlagBits::eDepth,
+					.baseMipLevel = 0,
+					.levelCount = 1,
+					.baseArrayLayer = base_layer,
+					.layerCount = count,
+				},
+			});
+		};
+
+		auto array_view_result = create_view(vk::ImageViewType::e2DArray, 0, cascade_count);
+		if (!array_view_result) return Error::from(array_view_result);
+		auto array_view = std::move(*array_view_result);
+
+		std::vector<vk::raii::ImageView> layer_views;
+		layer_views.reserve(cascade_count);
+		for (const auto layer : std::views::iota(0u, cascade_count))
+		{
+			auto view_result = create_view(vk::ImageViewType::e2D, layer, 1);
+			if (!view_result) return Error::from(view_result);
+			layer_views.emplace_back(std::move(*view_result));
+		}
+
+		return CascadeShadowAttachment(
+			resolution,
+			std::move(image),
+			std::move(array_view),
+			std::move(layer_views)
+		);
+	}
+
+	CascadeShadowAttachment::operator View() const noexcept
+	{
+		auto view = View{
+			.resolution = resolution,
+			.cascade_count = cascade_count(),
+			.image = image,
+			.array_view = array_view,
+			.layer_views = {},
+		};
+
+		for (const auto [idx, layer_view] : layer_views | std::views::enumerate)
+			view.layer_views[idx] = layer_view;
+
+		return view;
+	}
+
+	uint32_t CascadeShadowAttachment::acquire_dirty_cascades(
+		std::span<const ShadowCascade> cascades,
+		uint64_t geometry_version,
+		bool cached
+	) noexcept
+	{
+		DEBUG_ASSERT(cascades.size() == cached_cascades.size(), "Cascade count mismatches attachment");
+
+		uint32_t dirty_mask = 0;
+
+		for (
+			const auto& [idx, cascade, cached_cascade] :
+			std::views::zip(std::views::iota(0u), cascades, cached_cascades)
+		)
+		{
+			// Matrices are compared exactly, snapping keeps them bitwise identical while nothing changes
+			const bool unchanged = cached && cached_cascade.has_value()
+				&& cached_cascade->view_projection == cascade.view_projection
+				&& cached_cascade->geometry_version == geometry_version;
+			if (unchanged) continue;
+
+			cached_cascade = CachedCascade{
+				.view_projection = cascade.view_projection,
+				.geometry_version = geometry_version,
+			};
+			dirty_mask |= 1u << idx;
+		}
+
+		return dirty_mask;
+	}
+}
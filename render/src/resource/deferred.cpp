@@ -3,6 +3,7 @@
 #include "vulkan/container/device/attachment.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <utility>
@@ -11,30 +12,91 @@ namespace render
 {
 	std::expected<DeferredAttachment, Error> DeferredAttachment::create(
 		const vulkan::Context& context,
-		glm::u32vec2 extent
+		glm::u32vec2 extent,
+		uint32_t view_count
 	) noexcept
 	{
-		auto albedo_result =
-			vulkan::Attachment::create(context.device, context.allocator, extent, ALBEDO_FORMAT);
+		auto albedo_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			ALBEDO_FORMAT,
+			{},
+			{},
+			"G-Buffer Albedo",
+			view_count
+		);
 		if (!albedo_result) return albedo_result.error().forward("Create depth buffer failed");
 
-		auto normal_result =
-			vulkan::Attachment::create(context.device, context.allocator, extent, NORMAL_FORMAT);
+		auto normal_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			NORMAL_FORMAT,
+			{},
+			{},
+			"G-Buffer Normal",
+			view_count
+		);
 		if (!normal_result) return normal_result.error().forward("Create depth buffer failed");
 
-		auto pbr_result = vulkan::Attachment::create(context.device, context.allocator, extent, PBR_FORMAT);
+		auto pbr_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			PBR_FORMAT,
+			{},
+			{},
+			"G-Buffer PBR",
+			view_count
+		);
 		if (!pbr_result) return pbr_result.error().forward("Create depth buffer failed");
 
-		auto depth_result =
-			vulkan::Attachment::create(context.device, context.allocator, extent, DEPTH_FORMAT);
+		auto depth_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			DEPTH_FORMAT,
+			{},
+			{},
+			"G-Buffer Depth",
+			view_count
+		);
 		if (!depth_result) return depth_result.error().forward("Create depth buffer failed");
 
+		auto velocity_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			VELOCITY_FORMAT,
+			{},
+			{},
+			"G-Buffer Velocity",
+			view_count
+		);
+		if (!velocity_result) return velocity_result.error().forward("Create velocity buffer failed");
+
+		auto object_id_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			OBJECT_ID_FORMAT,
+			{},
+			{},
+			"G-Buffer Object ID",
+			view_count
+		);
+		if (!object_id_result) return object_id_result.error().forward("Create object ID buffer failed");
+
 		return DeferredAttachment(
 			extent,
+			view_count,
 			std::move(*albedo_result),
 			std::move(*normal_result),
 			std::move(*pbr_result),
-			std::move(*depth_result)
+			std::move(*depth_result),
+			std::move(*velocity_result),
+			std::move(*object_id_result)
 		);
 	}
 }
@@ -0,0 +1,86 @@
+#include "render/resource/deform.hpp"
+#include "common/util/error.hpp"
+#include "render/model/deform-list.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/container/device/dyn-buffer.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <span>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	// (Helper) Resize a parameter buffer and write or schedule the upload of its data
+	template <typename T>
+	[[nodiscard]]
+	static std::expected<void, Error> upload_parameter(
+		const vulkan::Context& context,
+		vulkan::UploadRing& upload_ring,
+		vulkan::DynArrayBuffer<T>& buffer,
+		std::span<const T> data,
+		bool direct_upload
+	) noexcept
+	{
+		// Descriptors can't reference empty buffers, keep at least one element
+		if (const auto result = buffer.resize(context, std::max<size_t>(data.size(), 1)); !result)
+			return result.error().forward("Resize buffer failed");
+
+		if (data.empty()) return {};
+
+		if (direct_upload)
+		{
+			if (const auto result = buffer->upload(std::as_bytes(data)); !result)
+				return result.error().forward("Write buffer failed");
+		}
+		else if (const auto result = upload_ring.push(context, data, buffer.ref()); !result)
+			return result.error().forward("Schedule buffer upload failed");
+
+		return {};
+	}
+
+	DeformResource::DeformResource(const vulkan::Context& context) noexcept :
+		direct_upload(context.allocator.supports_direct_upload()),
+		joint_matrix_buffer(
+			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+			direct_upload ? vulkan::MemoryUsage::CpuToGpuDirect : vulkan::MemoryUsage::GpuOnly
+		),
+		morph_weight_buffer(
+			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+			direct_upload ? vulkan::MemoryUsage::CpuToGpuDirect : vulkan::MemoryUsage::GpuOnly
+		)
+	{}
+
+	std::expected<void, Error> DeformResource::update(
+		const vulkan::Context& context,
+		vulkan::UploadRing& upload_ring,
+		const DeformList::Parameters& parameters
+	) noexcept
+	{
+		const auto joint_matrix_result = upload_parameter<glm::mat4>(
+			context,
+			upload_ring,
+			joint_matrix_buffer,
+			parameters.joint_matrices,
+			direct_upload
+		);
+		if (!joint_matrix_result)
+			return joint_matrix_result.error().forward("Update joint matrix buffer failed");
+
+		const auto morph_weight_result = upload_parameter<float>(
+			context,
+			upload_ring,
+			morph_weight_buffer,
+			parameters.morph_weights,
+			direct_upload
+		);
+		if (!morph_weight_result)
+			return morph_weight_result.error().forward("Update morph weight buffer failed");
+
+		return {};
+	}
+}
@@ -0,0 +1,56 @@
+#include "render/resource/denoise.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<DenoiseAttachment, Error> DenoiseAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent,
+		uint32_t downscale
+	) noexcept
+	{
+		downscale = std::max(downscale, 1u);
+		const auto signal_extent = (extent + downscale - 1u) / downscale;
+
+		const auto create_image = [&context, signal_extent](const char* name) {
+			return vulkan::Attachment::create(
+				context.device,
+				context.allocator,
+				signal_extent,
+				DENOISE_FORMAT,
+				vk::ImageUsageFlagBits::eStorage,
+				{},
+				name
+			);
+		};
+
+		auto history_result = create_image("Denoise History");
+		if (!history_result) return history_result.error().forward("Create denoise history image failed");
+
+		auto moments_result = create_image("Denoise Moments");
+		if (!moments_result) return moments_result.error().forward("Create denoise moments image failed");
+
+		auto filtered0_result = create_image("Denoise Filtered 0");
+		auto filtered1_result = create_image("Denoise Filtered 1");
+		if (!filtered0_result) return filtered0_result.error().forward("Create denoise filter image failed");
+		if (!filtered1_result) return filtered1_result.error().forward("Create denoise filter image failed");
+
+		return DenoiseAttachment(
+			signal_extent,
+			downscale,
+			std::move(*history_result),
+			std::move(*moments_result),
+			{std::move(*filtered0_result), std::move(*filtered1_result)}
+		);
+	}
+}
@@ -0,0 +1,700 @@
+#include "render/resource/environment.hpp"
+#include "common/util/error.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "shader/environment/brdf-lut.hpp"
+#include "shader/environment/cubemap.hpp"
+#include "shader/environment/irradiance.hpp"
+#include "shader/environment/prefilter.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/util/command-runner.hpp"
+#include "vulkan/util/shader.hpp"
+#include "vulkan/util/static-resource-creator.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	namespace
+	{
+		constexpr auto SOURCE_FORMAT = vk::Format::eR16G16B16A16Sfloat;
+		constexpr auto EQUIRECT_FORMAT = vk::Format::eR32G32B32A32Sfloat;
+
+		constexpr uint32_t SOURCE_LEVELS = std::bit_width(EnvironmentLighting::SOURCE_SIZE);
+		constexpr uint32_t WORKGROUP_SIZE = 8;  // Must match `cubemap`, `prefilter` and `brdf-lut` shader
+
+		// Stages of the direct lighting, fragment or compute path, reading the baked outputs
+		constexpr auto LIGHTING_STAGES =
+			vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+
+		struct CubemapPushConstant
+		{
+			uint32_t face_size;
+		};
+
+		struct IrradiancePushConstant
+		{
+			uint32_t face_size;
+			uint32_t level;
+		};
+
+		struct PrefilterPushConstant
+		{
+			uint32_t face_size;
+			float roughness;
+			uint32_t source_size;
+		};
+
+		consteval vk::DescriptorSetLayoutBinding compute_binding(
+			uint32_t binding,
+			vk::DescriptorType type
+		) noexcept
+		{
+			return {
+				.binding = binding,
+				.descriptorType = type,
+				.descriptorCount = 1,
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+			};
+		}
+
+		constexpr auto CUBEMAP_BINDINGS = std::to_array({
+			compute_binding(0, vk::DescriptorType::eSampledImage),
+			compute_binding(1, vk::DescriptorType::eStorageImage),
+		});
+
+		constexpr auto IRRADIANCE_BINDINGS = std::to_array({
+			compute_binding(0, vk::DescriptorType::eCombinedImageSampler),
+			compute_binding(1, vk::DescriptorType::eStorageBuffer),
+		});
+
+		constexpr auto PREFILTER_BINDINGS = std::to_array({
+			compute_binding(0, vk::DescriptorType::eCombinedImageSampler),
+			compute_binding(1, vk::DescriptorType::eStorageImage),
+		});
+
+		constexpr auto BRDF_LUT_BINDINGS = std::to_array({
+			compute_binding(0, vk::DescriptorType::eStorageImage),
+		});
+
+		// Compute program used once while baking
+		struct BakeProgram
+		{
+			vk::raii::DescriptorSetLayout set_layout;
+			vk::raii::PipelineLayout pipeline_layout;
+			vk::raii::Pipeline pipeline;
+		};
+
+		[[nodiscard]]
+		std::expected<BakeProgram, Error> create_bake_program(
+			const vulkan::Context& context,
+			std::span<const std::byte> code,
+			std::span<const vk::DescriptorSetLayoutBinding> bindings,
+			uint32_t push_constant_size
+		) noexcept
+		{
+			auto shader_result = vulkan::create_shader(context.device, code);
+			if (!shader_result) return shader_result.error().forward("Create shader module failed");
+			const auto shader_module = std::move(*shader_result);
+
+			auto set_layout_result = context.device.createDescriptorSetLayout(
+				vk::DescriptorSetLayoutCreateInfo().setBindings(bindings)
+			);
+			if (!set_layout_result) return Error::from(set_layout_result);
+			auto set_layout = std::move(*set_layout_result);
+
+			const auto push_constant_range = vk::PushConstantRange{
+				.stageFlags = vk::ShaderStageFlagBits::eCompute,
+				.offset = 0,
+				.size = push_constant_size
+			};
+			auto pipeline_layout_result = context.device.createPipelineLayout(
+				push_constant_size > 0
+					? vk::PipelineLayoutCreateInfo().setSetLayouts(*set_layout).setPushConstantRanges(
+						  push_constant_range
+					  )
+					: vk::PipelineLayoutCreateInfo().setSetLayouts(*set_layout)
+			);
+			if (!pipeline_layout_result) return Error::from(pipeline_layout_result);
+			auto pipeline_layout = std::move(*pipeline_layout_result);
+
+			const auto stage_info = vk::PipelineShaderStageCreateInfo{
+				.stage = vk::ShaderStageFlagBits::eCompute,
+				.module = shader_module,
+				.pName = "main"
+			};
+			auto pipeline_result = context.device.createComputePipeline(
+				context.pipeline_cache,
+				vk::ComputePipelineCreateInfo{.stage = stage_info, .layout = pipeline_layout}
+			);
+			if (!pipeline_result) return Error::from(pipeline_result);
+			auto pipeline = std::move(*pipeline_result);
+
+			return BakeProgram{
+				.set_layout = std::move(set_layout),
+				.pipeline_layout = std::move(pipeline_layout),
+				.pipeline = std::move(pipeline),
+			};
+		}
+
+		[[nodiscard]]
+		std::expected<vulkan::Image, Error> create_cubemap(
+			const vulkan::Context& context,
+			uint32_t size,
+			uint32_t level_count,
+			vk::ImageUsageFlags usage,
+			vulkan::MemoryCategory category,
+			const char* debug_name
+		) noexcept
+		{
+			return context.allocator.create_image(
+				vk::ImageCreateInfo{
+					.flags = vk::ImageCreateFlagBits::eCubeCompatible,
+					.imageType = vk::ImageType::e2D,
+					.format = SOURCE_FORMAT,
+					.extent = {.width = size, .height = size, .depth = 1},
+					.mipLevels = level_count,
+					.arrayLayers = 6,
+					.samples = vk::SampleCountFlagBits::e1,
+					.tiling = vk::ImageTiling::eOptimal,
+					.usage = usage,
+					.sharingMode = vk::SharingMode::eExclusive,
+				},
+				vulkan::MemoryUsage::GpuOnly,
+				category,
+				debug_name
+			);
+		}
+
+		[[nodiscard]]
+		std::expected<vk::raii::ImageView, Error> create_view(
+			const vulkan::Context& context,
+			vk::Image image,
+			vk::ImageViewType type,
+			vk::Format format,
+			uint32_t base_level,
+			uint32_t level_count
+		) noexcept
+		{
+			const auto layer_count = type == vk::ImageViewType::e2D ? 1u : 6u;
+			auto view_result = context.device.createImageView({
+				.image = image,
+				.viewType = type,
+				.format = format,
+				.subresourceRange = {
+					.aspectMask = vk::ImageAspectFlagBits::eColor,
+					.baseMipLevel = base_level,
+					.levelCount = level_count,
+					.baseArrayLayer = 0,
+					.layerCount = layer_count,
+				},
+			});
+			if (!view_result) return Error::from(view_result);
+			return std::move(*view_result);
+		}
+	}
+
+	std::expected<EnvironmentLighting, Error> EnvironmentLighting::create(
+		const vulkan::Context& context,
+		const EquirectImage& equirect
+	) noexcept
+	{
+		/*===== Upload =====*/
+
+		auto resource_creator_result = vulkan::StaticResourceCreator::create(context);
+		if (!resource_creator_result)
+			return resource_creator_result.error().forward("Create resource creator failed");
+		auto resource_creator = std::move(*resource_creator_result);
+
+		auto equirect_image_result = resource_creator.create_image(
+			context,
+			equirect,
+			EQUIRECT_FORMAT,
+			vk::ImageUsageFlagBits::eSampled
+		);
+		if (!equirect_image_result)
+			return equirect_image_result.error().forward("Create equirectangular image failed");
+		const auto equirect_image = std::move(*equirect_image_result);
+
+		if (const auto result = resource_creator.execute_uploads(context); !result)
+			return result.error().forward("Upload equirectangular image failed");
+
+		/*===== Images & Buffers =====*/
+
+		auto source_result = create_cubemap(
+			context,
+			SOURCE_SIZE,
+			SOURCE_LEVELS,
+			vk::ImageUsageFlagBits::eStorage
+				| vk::ImageUsageFlagBits::eSampled
+				| vk::ImageUsageFlagBits::eTransferSrc
+				| vk::ImageUsageFlagBits::eTransferDst,
+			vulkan::MemoryCategory::Other,
+			"Environment Source Cubemap"
+		);
+		if (!source_result) return source_result.error().forward("Create source cubemap failed");
+		const auto source = std::move(*source_result);
+
+		auto specular_result = create_cubemap(
+			context,
+			SPECULAR_SIZE,
+			SPECULAR_LEVELS,
+			vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+			vulkan::MemoryCategory::Texture,
+			"Environment Specular"
+		);
+		if (!specular_result) return specular_result.error().forward("Create specular cubemap failed");
+		auto specular = std::move(*specular_result);
+
+		auto brdf_lut_result = context.allocator.create_image(
+			vk::ImageCreateInfo{
+				.imageType = vk::ImageType::e2D,
+				.format = BRDF_LUT_FORMAT,
+				.extent = {.width = BRDF_LUT_SIZE, .height = BRDF_LUT_SIZE, .depth = 1},
+				.mipLevels = 1,
+				.arrayLayers = 1,
+				.samples = vk::SampleCountFlagBits::e1,
+				.tiling = vk::ImageTiling::eOptimal,
+				.usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+				.sharingMode = vk::SharingMode::eExclusive,
+			},
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Texture,
+			"Environment BRDF LUT"
+		);
+		if (!brdf_lut_result) return brdf_lut_result.error().forward("Create BRDF LUT failed");
+		auto brdf_lut = std::move(*brdf_lut_result);
+
+		auto irradiance_sh_result = context.allocator.create_array_buffer<glm::vec4>(
+			SH_COEFFICIENT_COUNT,
+			vk::BufferUsageFlagBits::eStorageBuffer,
+			vulkan::MemoryUsage::GpuOnly,
+			vk::SharingMode::eExclusive,
+			{},
+			vulkan::MemoryCategory::Other,
+			"Environment Irradiance SH"
+		);
+		if (!irradiance_sh_result) return irradiance_sh_result.error().forward("Create SH buffer failed");
+		auto irradiance_sh = std::move(*irradiance_sh_result);
+
+		/*===== Views & Sampler =====*/
+
+		auto equirect_view_result =
+			create_view(context, equirect_image, vk::ImageViewType::e2D, EQUIRECT_FORMAT, 0, 1);
+		auto source_storage_view_result =
+			create_view(context, source, vk::ImageViewType::e2DArray, SOURCE_FORMAT, 0, 1);
+		auto source_view_result =
+			create_view(context, source, vk::ImageViewType::eCube, SOURCE_FORMAT, 0, SOURCE_LEVELS);
+		auto specular_view_result =
+			create_view(context, specular, vk::ImageViewType::eCube, SPECULAR_FORMAT, 0, SPECULAR_LEVELS);
+		auto brdf_lut_view_result =
+			create_view(context, brdf_lut, vk::ImageViewType::e2D, BRDF_LUT_FORMAT, 0, 1);
+
+		if (!equirect_view_result) return equirect_view_result.error().forward("Create view failed");
+		if (!source_storage_view_result)
+			return source_storage_view_result.error().forward("Create view failed");
+		if (!source_view_result) return source_view_result.error().forward("Create view failed");
+		if (!specular_view_result) return specular_view_result.error().forward("Create view failed");
+		if (!brdf_lut_view_result) return brdf_lut_view_result.error().forward("Create view failed");
+
+		const auto equirect_view = std::move(*equirect_view_result);
+		const auto source_storage_view = std::move(*source_storage_view_result);
+		const auto source_view = std::move(*source_view_result);
+		auto specular_view = std::move(*specular_view_result);
+		auto brdf_lut_view = std::move(*brdf_lut_view_result);
+
+		std::vector<vk::raii::ImageView> specular_level_views;
+		specular_level_views.reserve(SPECULAR_LEVELS);
+		for (const auto level : std::views::iota(0u, SPECULAR_LEVELS))
+		{
+			auto view_result =
+				create_view(context, specular, vk::ImageViewType::e2DArray, SPECULAR_FORMAT, level, 1);
+			if (!view_result) return view_result.error().forward("Create view failed");
+			specular_level_views.emplace_back(std::move(*view_result));
+		}
+
+		// Source levels are read with trilinear filtering, see `prefilter.slang`
+		constexpr auto sampler_create_info = vk::SamplerCreateInfo{
+			.magFilter = vk::Filter::eLinear,
+			.minFilter = vk::Filter::eLinear,
+			.mipmapMode = vk::SamplerMipmapMode::eLinear,
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+			.mipLodBias = 0.0f,
+			.minLod = 0.0f,
+			.maxLod = vk::LodClampNone,
+		};
+		auto sampler_result = context.device.createSampler(sampler_create_info);
+		if (!sampler_result) return Error::from(sampler_result);
+		const auto sampler = std::move(*sampler_result);
+
+		/*===== Programs =====*/
+
+		auto cubemap_program_result = create_bake_program(
+			context,
+			shader::environment::cubemap,
+			CUBEMAP_BINDINGS,
+			sizeof(CubemapPushConstant)
+		);
+		auto irradiance_program_result = create_bake_program(
+			context,
+			shader::environment::irradiance,
+			IRRADIANCE_BINDINGS,
+			sizeof(IrradiancePushConstant)
+		);
+		auto prefilter_program_result = create_bake_program(
+			context,
+			shader::environment::prefilter,
+			PREFILTER_BINDINGS,
+			sizeof(PrefilterPushConstant)
+		);
+		auto brdf_lut_program_result =
+			create_bake_program(context, shader::environment::brdf_lut, BRDF_LUT_BINDINGS, 0);
+
+		if (!cubemap_program_result)
+			return cubemap_program_result.error().forward("Create cubemap program failed");
+		if (!irradiance_program_result)
+			return irradiance_program_result.error().forward("Create irradiance program failed");
+		if (!prefilter_program_result)
+			return prefilter_program_result.error().forward("Create prefilter program failed");
+		if (!brdf_lut_program_result)
+			return brdf_lut_program_result.error().forward("Create BRDF LUT program failed");
+
+		const auto cubemap_program = std::move(*cubemap_program_result);
+		const auto irradiance_program = std::move(*irradiance_program_result);
+		const auto prefilter_program = std::move(*prefilter_program_result);
+		const auto brdf_lut_program = std::move(*brdf_lut_program_result);
+
+		/*===== Descriptor Sets =====*/
+
+		// One set for each program, except one for each level of the prefiltering
+		const auto pool_sizes = std::to_array<vk::DescriptorPoolSize>({
+			{.type = vk::DescriptorType::eSampledImage, .descriptorCount = 1},
+			{.type = vk::DescriptorType::eCombinedImageSampler, .descriptorCount = 1 + SPECULAR_LEVELS},
+			{.type = vk::DescriptorType::eStorageImage, .descriptorCount = 2 + SPECULAR_LEVELS},
+			{.type = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1},
+		});
+		auto descriptor_pool_result = context.device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+				.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+				.setMaxSets(3 + SPECULAR_LEVELS)
+				.setPoolSizes(pool_sizes)
+		);
+		if (!descriptor_pool_result) return Error::from(descriptor_pool_result);
+		const auto descriptor_pool = std::move(*descriptor_pool_result);
+
+		std::vector<vk::DescriptorSetLayout> set_layouts = {
+			cubemap_program.set_layout,
+			irradiance_program.set_layout,
+			brdf_lut_program.set_layout,
+		};
+		set_layouts.insert(set_layouts.end(), SPECULAR_LEVELS, prefilter_program.set_layout);
+
+		auto sets_result = context.device.allocateDescriptorSets(
+			vk::DescriptorSetAllocateInfo().setDescriptorPool(descriptor_pool).setSetLayouts(set_layouts)
+		);
+		if (!sets_result) return Error::from(sets_result);
+		const auto sets = std::move(*sets_result);
+
+		const auto& cubemap_set = sets[0];
+		const auto& irradiance_set = sets[1];
+		const auto& brdf_lut_set = sets[2];
+		const auto prefilter_sets = std::span(sets).subspan(3);
+
+		const auto equirect_info = vk::DescriptorImageInfo{
+			.imageView = equirect_view,
+			.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+		};
+		const auto source_storage_info = vk::DescriptorImageInfo{
+			.imageView = source_storage_view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+		const auto source_sampled_info = vk::DescriptorImageInfo{
+			.sampler = sampler,
+			.imageView = source_view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+		const auto irradiance_sh_info = vk::DescriptorBufferInfo{
+			.buffer = irradiance_sh,
+			.offset = 0,
+			.range = vk::WholeSize,
+		};
+		const auto brdf_lut_info = vk::DescriptorImageInfo{
+			.imageView = brdf_lut_view,
+			.imageLayout = vk::ImageLayout::eGeneral,
+		};
+		const auto specular_level_infos =
+			specular_level_views
+			| std::views::transform([](const vk::raii::ImageView& view) {
+				  return vk::DescriptorImageInfo{.imageView = view, .imageLayout = vk::ImageLayout::eGeneral};
+			  })
+			| std::ranges::to<std::vector>();
+
+		const auto write_image = [](const vk::raii::DescriptorSet& set,
+									uint32_t binding,
+									vk::DescriptorType type,
+									const vk::DescriptorImageInfo& info) {
+			return vk::WriteDescriptorSet{
+				.dstSet = set,
+				.dstBinding = binding,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = type,
+				.pImageInfo = &info,
+			};
+		};
+
+		std::vector<vk::WriteDescriptorSet> writes = {
+			write_image(cubemap_set, 0, vk::DescriptorType::eSampledImage, equirect_info),
+			write_image(cubemap_set, 1, vk::DescriptorType::eStorageImage, source_storage_info),
+			write_image(irradiance_set, 0, vk::DescriptorType::eCombinedImageSampler, source_sampled_info),
+			vk::WriteDescriptorSet{
+				.dstSet = irradiance_set,
+				.dstBinding = 1,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = vk::DescriptorType::eStorageBuffer,
+				.pBufferInfo = &irradiance_sh_info,
+			},
+			write_image(brdf_lut_set, 0, vk::DescriptorType::eStorageImage, brdf_lut_info),
+		};
+		for (const auto& [set, level_info] : std::views::zip(prefilter_sets, specular_level_infos))
+		{
+			writes.push_back(
+				write_image(set, 0, vk::DescriptorType::eCombinedImageSampler, source_sampled_info)
+			);
+			writes.push_back(write_image(set, 1, vk::DescriptorType::eStorageImage, level_info));
+		}
+		context.device.updateDescriptorSets(writes, {});
+
+		/*===== Bake =====*/
+
+		auto runner_result = vulkan::CommandRunner::create(context);
+		if (!runner_result) return runner_result.error().forward("Create command runner failed");
+		const auto runner = std::move(*runner_result);
+
+		const auto record_bake = [&](const vk::raii::CommandBuffer& command_buffer) {
+			const auto all_levels = vk::ImageSubresourceRange{
+				.aspectMask = vk::ImageAspectFlagBits::eColor,
+				.baseMipLevel = 0,
+				.levelCount = vk::RemainingMipLevels,
+				.baseArrayLayer = 0,
+				.layerCount = vk::RemainingArrayLayers,
+			};
+
+			const auto bind = [&command_buffer](
+								  const BakeProgram& program,
+								  const vk::raii::DescriptorSet& set
+							  ) {
+				command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, program.pipeline);
+				command_buffer.bindDescriptorSets(
+					vk::PipelineBindPoint::eCompute,
+					program.pipeline_layout,
+					0,
+					{set},
+					{}
+				);
+			};
+
+			const auto memory_barrier = [&command_buffer](
+											vk::PipelineStageFlags2 src_stage,
+											vk::AccessFlags2 src_access,
+											vk::PipelineStageFlags2 dst_stage,
+											vk::AccessFlags2 dst_access
+										) {
+				const auto barrier = vk::MemoryBarrier2{
+					.srcStageMask = src_stage,
+					.srcAccessMask = src_access,
+					.dstStageMask = dst_stage,
+					.dstAccessMask = dst_access,
+				};
+				command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(barrier));
+			};
+
+			/* Everything is written and read in general layout */
+
+			const auto to_general = [&all_levels](vk::Image image) {
+				return vk::ImageMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eNone,
+					.srcAccessMask = vk::AccessFlagBits2::eNone,
+					.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+					.dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+					.oldLayout = vk::ImageLayout::eUndefined,
+					.newLayout = vk::ImageLayout::eGeneral,
+					.image = image,
+					.subresourceRange = all_levels,
+				};
+			};
+			const auto general_barriers = std::to_array({
+				to_general(source),
+				to_general(specular),
+				to_general(brdf_lut),
+			});
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(general_barriers));
+
+			/* Source cubemap */
+
+			constexpr auto source_group_count = SOURCE_SIZE / WORKGROUP_SIZE;
+
+			bind(cubemap_program, cubemap_set);
+			command_buffer.pushConstants<CubemapPushConstant>(
+				*cubemap_program.pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				CubemapPushConstant{.face_size = SOURCE_SIZE}
+			);
+			command_buffer.dispatch(source_group_count, source_group_count, 6);
+
+			memory_barrier(
+				vk::PipelineStageFlagBits2::eComputeShader,
+				vk::AccessFlagBits2::eShaderStorageWrite,
+				vk::PipelineStageFlagBits2::eBlit,
+				vk::AccessFlagBits2::eTransferRead
+			);
+
+			// Each level is blitted from the previous one, which is complete by then
+			for (const auto level : std::views::iota(1u, SOURCE_LEVELS))
+			{
+				const auto src_size = static_cast<int32_t>(SOURCE_SIZE >> (level - 1));
+				const auto dst_size = static_cast<int32_t>(SOURCE_SIZE >> level);
+
+				const auto blit = vk::ImageBlit{
+					.srcSubresource = {
+						.aspectMask = vk::ImageAspectFlagBits::eColor,
+						.mipLevel = level - 1,
+						.baseArrayLayer = 0,
+						.layerCount = 6,
+					},
+					.srcOffsets = std::array{vk::Offset3D{0, 0, 0}, vk::Offset3D{src_size, src_size, 1}},
+					.dstSubresource = {
+						.aspectMask = vk::ImageAspectFlagBits::eColor,
+						.mipLevel = level,
+						.baseArrayLayer = 0,
+						.layerCount = 6,
+					},
+					.dstOffsets = std::array{vk::Offset3D{0, 0, 0}, vk::Offset3D{dst_size, dst_size, 1}},
+				};
+				command_buffer.blitImage(
+					source,
+					vk::ImageLayout::eGeneral,
+					source,
+					vk::ImageLayout::eGeneral,
+					blit,
+					vk::Filter::eLinear
+				);
+
+				memory_barrier(
+					vk::PipelineStageFlagBits2::eBlit,
+					vk::AccessFlagBits2::eTransferWrite,
+					vk::PipelineStageFlagBits2::eBlit | vk::PipelineStageFlagBits2::eComputeShader,
+					vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eShaderSampledRead
+				);
+			}
+
+			/* Irradiance */
+
+			bind(irradiance_program, irradiance_set);
+			command_buffer.pushConstants<IrradiancePushConstant>(
+				*irradiance_program.pipeline_layout,
+				vk::ShaderStageFlagBits::eCompute,
+				0,
+				IrradiancePushConstant{.face_size = SOURCE_SIZE >> SH_SOURCE_LEVEL, .level = SH_SOURCE_LEVEL}
+			);
+			command_buffer.dispatch(1, 1, 1);
+
+			/* Specular */
+
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, prefilter_program.pipeline);
+			for (const auto [level, set] : prefilter_sets | std::views::enumerate)
+			{
+				const auto face_size = SPECULAR_SIZE >> level;
+				const auto group_count = (face_size + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+				command_buffer.bindDescriptorSets(
+					vk::PipelineBindPoint::eCompute,
+					prefilter_program.pipeline_layout,
+					0,
+					{set},
+					{}
+				);
+				command_buffer.pushConstants<PrefilterPushConstant>(
+					*prefilter_program.pipeline_layout,
+					vk::ShaderStageFlagBits::eCompute,
+					0,
+					PrefilterPushConstant{
+						.face_size = face_size,
+						.roughness = float(level) / float(SPECULAR_LEVELS - 1),
+						.source_size = SOURCE_SIZE,
+					}
+				);
+				command_buffer.dispatch(group_count, group_count, 6);
+			}
+
+			/* BRDF LUT */
+
+			constexpr auto lut_group_count = BRDF_LUT_SIZE / WORKGROUP_SIZE;
+
+			bind(brdf_lut_program, brdf_lut_set);
+			command_buffer.dispatch(lut_group_count, lut_group_count, 1);
+
+			/* Outputs -> lighting */
+
+			const auto to_read_only = [&all_levels](vk::Image image) {
+				return vk::ImageMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+					.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+					.dstStageMask = LIGHTING_STAGES,
+					.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+					.oldLayout = vk::ImageLayout::eGeneral,
+					.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+					.image = image,
+					.subresourceRange = all_levels,
+				};
+			};
+			const auto read_only_barriers = std::to_array({to_read_only(specular), to_read_only(brdf_lut)});
+			const auto sh_barrier = vk::MemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+				.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+				.dstStageMask = LIGHTING_STAGES,
+				.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+			};
+			command_buffer.pipelineBarrier2(
+				vk::DependencyInfo().setMemoryBarriers(sh_barrier).setImageMemoryBarriers(read_only_barriers)
+			);
+		};
+		if (const auto result = runner.run(context, record_bake); !result)
+			return result.error().forward("Bake environment lighting failed");
+
+		return EnvironmentLighting(
+			std::move(irradiance_sh),
+			std::move(specular),
+			std::move(specular_view),
+			std::move(brdf_lut),
+			std::move(brdf_lut_view)
+		);
+	}
+
+	std::expected<EnvironmentLighting, Error> EnvironmentLighting::create_uniform(
+		const vulkan::Context& context,
+		glm::vec3 radiance
+	) noexcept
+	{
+		return create(context, EquirectImage({1, 1}, glm::vec4(radiance, 1.0f)));
+	}
+}
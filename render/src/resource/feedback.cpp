@@ -0,0 +1,101 @@
+#include "render/resource/feedback.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<void, Error> TextureFeedbackResource::resize(
+		const vulkan::Context& context,
+		size_t material_count
+	) noexcept
+	{
+		// Extra slot for the default material, two counters each
+		const auto counter_count = (material_count + 1) * 2;
+		if (buffer.has_value() && buffer->count() == counter_count) return {};
+
+		auto buffer_result = context.allocator.create_array_buffer<uint32_t>(
+			counter_count,
+			vk::BufferUsageFlagBits::eStorageBuffer,
+			vulkan::MemoryUsage::GpuToCpu
+		);
+		if (!buffer_result) return buffer_result.error().forward("Create feedback buffer failed");
+
+		if (const auto result = buffer_result->upload(std::vector<uint32_t>(counter_count, 0)); !result)
+			return result.error().forward("Clear feedback buffer failed");
+
+		buffer = std::move(*buffer_result);
+		return {};
+	}
+
+	std::expected<TextureFeedbackResource::Feedback, Error>
+	TextureFeedbackResource::read_and_clear() const noexcept
+	{
+		if (!buffer.has_value()) return Feedback();
+
+		std::vector<uint32_t> counters(buffer->count());
+		if (const auto result = buffer->download(counters); !result)
+			return result.error().forward("Read feedback buffer failed");
+
+		if (const auto result = buffer->upload(std::vector<uint32_t>(counters.size(), 0)); !result)
+			return result.error().forward("Clear feedback buffer failed");
+
+		const auto material_count = counters.size() / 2;
+		return Feedback{
+			.material_usage = std::vector(counters.begin(), counters.begin() + material_count),
+			.material_resolution = std::vector(counters.begin() + material_count, counters.end())
+		};
+	}
+
+	std::expected<void, Error> GeometryFeedbackResource::resize(
+		const vulkan::Context& context,
+		size_t primitive_count
+	) noexcept
+	{
+		// Storage buffers can't be empty
+		const auto size_count = std::max<size_t>(primitive_count, 1);
+		if (buffer.has_value() && buffer->count() == size_count) return {};
+
+		auto buffer_result = context.allocator.create_array_buffer<uint32_t>(
+			size_count,
+			vk::BufferUsageFlagBits::eStorageBuffer,
+			vulkan::MemoryUsage::GpuToCpu
+		);
+		if (!buffer_result) return buffer_result.error().forward("Create feedback buffer failed");
+
+		if (const auto result = buffer_result->upload(std::vector<uint32_t>(size_count, 0)); !result)
+			return result.error().forward("Clear feedback buffer failed");
+
+		buffer = std::move(*buffer_result);
+		return {};
+	}
+
+	std::expected<GeometryFeedbackResource::Feedback, Error>
+	GeometryFeedbackResource::read_and_clear() const noexcept
+	{
+		if (!buffer.has_value()) return Feedback();
+
+		std::vector<uint32_t> sizes(buffer->count());
+		if (const auto result = buffer->download(sizes); !result)
+			return result.error().forward("Read feedback buffer failed");
+
+		if (const auto result = buffer->upload(std::vector<uint32_t>(sizes.size(), 0)); !result)
+			return result.error().forward("Clear feedback buffer failed");
+
+		return Feedback{
+			.primitive_size = sizes
+				| std::views::transform([](uint32_t size) { return std::bit_cast<float>(size); })
+				| std::ranges::to<std::vector>()
+		};
+	}
+}
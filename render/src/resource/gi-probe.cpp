@@ -0,0 +1,204 @@
+#include "render/resource/gi-probe.hpp"
+#include "common/util/error.hpp"
+#include "render/model/model.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+#include "vulkan/numeric/base-level.hpp"
+#include "vulkan/util/command-runner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <glm/common.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <glm/ext/vector_uint3_sized.hpp>
+#include <glm/vector_relational.hpp>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	GiProbeVolume::Grid GiProbeVolume::fit_grid(
+		const Model& model,
+		std::span<const glm::mat4> transforms,
+		uint32_t max_count
+	) noexcept
+	{
+		max_count = std::max(max_count, 2u);
+
+		auto bound_min = glm::vec3(std::numeric_limits<float>::max());
+		auto bound_max = glm::vec3(std::numeric_limits<float>::lowest());
+
+		for (const auto& drawcall : model.hierarchy.get_renderables())
+		{
+			const auto& transform = transforms[drawcall.node_index];
+			const auto range = model.mesh_list->mesh_ranges_array[drawcall.mesh_index];
+
+			for (uint32_t primitive = range.offset; primitive < range.offset + range.count; ++primitive)
+			{
+				const auto& attr = model.mesh_list->primitive_attr_array[primitive];
+
+				// Bounds of the transformed box, from its eight corners
+				for (uint32_t corner = 0; corner < 8; ++corner)
+				{
+					const auto local = glm::vec3(
+						(corner & 1) != 0 ? attr.aabb_max.x : attr.aabb_min.x,
+						(corner & 2) != 0 ? attr.aabb_max.y : attr.aabb_min.y,
+						(corner & 4) != 0 ? attr.aabb_max.z : attr.aabb_min.z
+					);
+					const auto world = glm::vec3(transform * glm::vec4(local, 1.0));
+
+					bound_min = glm::min(bound_min, world);
+					bound_max = glm::max(bound_max, world);
+				}
+			}
+		}
+
+		if (glm::any(glm::greaterThan(bound_min, bound_max)))
+			return {.origin = glm::vec3(-0.5), .spacing = glm::vec3(1.0), .count = glm::u32vec3(2)};
+
+		const auto size = bound_max - bound_min;
+		const auto longest = std::max({size.x, size.y, size.z, std::numeric_limits<float>::epsilon()});
+		const auto spacing = longest / float(max_count - 1);
+
+		// Round each axis up, centering the extra coverage around the bounds
+		const auto count = glm::clamp(
+			glm::u32vec3(glm::ceil(size / spacing)) + 1u,
+			glm::u32vec3(2),
+			glm::u32vec3(max_count)
+		);
+		const auto covered = glm::vec3(count - 1u) * spacing;
+
+		return {
+			.origin = bound_min - (covered - size) * 0.5f,
+			.spacing = glm::vec3(spacing),
+			.count = count,
+		};
+	}
+
+	std::expected<GiProbeVolume, Error> GiProbeVolume::create(
+		const vulkan::Context& context,
+		const Grid& grid,
+		uint32_t ray_capacity
+	) noexcept
+	{
+		const auto irradiance_extent = atlas_extent(grid, IRRADIANCE_TILE_SIZE);
+		const auto distance_extent = atlas_extent(grid, DISTANCE_TILE_SIZE);
+
+		const auto max_dimension = context.phy_device.getProperties().limits.maxImageDimension2D;
+		if (glm::any(glm::greaterThan(distance_extent, glm::u32vec2(max_dimension))))
+			return Error(
+				"Probe atlas exceeds device limit",
+				std::format(
+					"Atlas {}x{}, device supports {}",
+					distance_extent.x,
+					distance_extent.y,
+					max_dimension
+				)
+			);
+
+		auto irradiance_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			irradiance_extent,
+			IRRADIANCE_FORMAT,
+			vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferDst,
+			{},
+			"GI Probe Irradiance"
+		);
+		if (!irradiance_result) return irradiance_result.error().forward("Create irradiance atlas failed");
+		auto irradiance = std::move(*irradiance_result);
+
+		auto distance_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			distance_extent,
+			DISTANCE_FORMAT,
+			vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferDst,
+			{},
+			"GI Probe Distance"
+		);
+		if (!distance_result) return distance_result.error().forward("Create distance atlas failed");
+		auto distance = std::move(*distance_result);
+
+		auto rays_result = context.allocator.create_array_buffer<glm::vec4>(
+			std::max(ray_capacity, 1u),
+			vk::BufferUsageFlagBits::eStorageBuffer,
+			vulkan::MemoryUsage::GpuOnly,
+			vk::SharingMode::eExclusive,
+			{},
+			vulkan::MemoryCategory::Other,
+			"GI Probe Rays"
+		);
+		if (!rays_result) return rays_result.error().forward("Create probe ray buffer failed");
+		auto rays = std::move(*rays_result);
+
+		/* Clear to untraced */
+
+		auto runner_result = vulkan::CommandRunner::create(context);
+		if (!runner_result) return runner_result.error().forward("Create command runner failed");
+		const auto runner = std::move(*runner_result);
+
+		const auto images = std::to_array<vk::Image>({
+			vulkan::AttachmentView(irradiance).image,
+			vulkan::AttachmentView(distance).image,
+		});
+
+		const auto record_clear = [&images](const vk::raii::CommandBuffer& command_buffer) {
+			const auto range = vulkan::base_level_image_range(vk::ImageAspectFlagBits::eColor);
+
+			const auto to_transfer = [&range](vk::Image image) {
+				return vk::ImageMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eNone,
+					.srcAccessMask = vk::AccessFlagBits2::eNone,
+					.dstStageMask = vk::PipelineStageFlagBits2::eClear,
+					.dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+					.oldLayout = vk::ImageLayout::eUndefined,
+					.newLayout = vk::ImageLayout::eTransferDstOptimal,
+					.image = image,
+					.subresourceRange = range,
+				};
+			};
+			const auto to_general = [&range](vk::Image image) {
+				return vk::ImageMemoryBarrier2{
+					.srcStageMask = vk::PipelineStageFlagBits2::eClear,
+					.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+					.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+					.dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
+					.oldLayout = vk::ImageLayout::eTransferDstOptimal,
+					.newLayout = vk::ImageLayout::eGeneral,
+					.image = image,
+					.subresourceRange = range,
+				};
+			};
+
+			const auto transfer_barriers = std::to_array({to_transfer(images[0]), to_transfer(images[1])});
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(transfer_barriers));
+
+			for (const auto image : images)
+				command_buffer.clearColorImage(
+					image,
+					vk::ImageLayout::eTransferDstOptimal,
+					vk::ClearColorValue(0.0f, 0.0f, 0.0f, 0.0f),
+					range
+				);
+
+			const auto general_barriers = std::to_array({to_general(images[0]), to_general(images[1])});
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(general_barriers));
+		};
+		if (const auto result = runner.run(context, record_clear); !result)
+			return result.error().forward("Clear probe atlases failed");
+
+		return GiProbeVolume(grid, ray_capacity, std::move(irradiance), std::move(distance), std::move(rays));
+	}
+}
@@ -3,21 +3,54 @@
 #include "vulkan/container/device/attachment.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
 
 namespace render
 {
+	bool HdrAttachment::is_format_supported(
+		const vk::raii::PhysicalDevice& phy_device,
+		vk::Format format
+	) noexcept
+	{
+		constexpr auto required_features = vk::FormatFeatureFlagBits::eColorAttachment
+			| vk::FormatFeatureFlagBits::eColorAttachmentBlend
+			| vk::FormatFeatureFlagBits::eStorageImage
+			| vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+
+		const auto features = phy_device.getFormatProperties(format).optimalTilingFeatures;
+		return (features & required_features) == required_features;
+	}
+
 	std::expected<HdrAttachment, Error> HdrAttachment::create(
 		const vulkan::Context& context,
-		glm::u32vec2 extent
+		glm::u32vec2 extent,
+		uint32_t view_count,
+		vk::Format format
 	) noexcept
 	{
-		auto albedo_result =
-			vulkan::Attachment::create(context.device, context.allocator, extent, HDR_FORMAT);
+		if (format != HDR_FORMAT && format != PACKED_HDR_FORMAT)
+			return Error("Unsupported HDR format", vk::to_string(format));
+
+		// Storage usage for the compute lighting path, see `DirectLightingPipeline::compute`. Shared with the
+		// compute queue, which may run auto-exposure asynchronously
+		const auto queue_families = context.unique_families();
+		auto albedo_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			format,
+			vk::ImageUsageFlagBits::eStorage,
+			queue_families,
+			"HDR",
+			view_count
+		);
 		if (!albedo_result) return albedo_result.error().forward("Create albedo buffer failed");
 
-		return HdrAttachment(extent, std::move(*albedo_result));
+		return HdrAttachment(extent, view_count, format, std::move(*albedo_result));
 	}
 }
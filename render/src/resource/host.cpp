@@ -1,19 +1,14 @@
 #include "render/resource/host.hpp"
-#include "common/util/array.hpp"
 #include "common/util/error.hpp"
 #include "render/interface/auto-exposure.hpp"
 #include "render/interface/camera.hpp"
 #include "render/interface/direct-light.hpp"
-#include "render/interface/primitive-drawcall.hpp"
-#include "render/util/per-render-state.hpp"
-#include "vulkan/container/device/staged-buffer.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
 #include "vulkan/interface/context.hpp"
 
-#include <array>
 #include <expected>
-#include <glm/ext/matrix_float4x4.hpp>
-#include <ranges>
-#include <span>
+#include <optional>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -22,112 +17,117 @@ namespace render
 {
 	std::expected<HostParamResource, Error> HostParamResource::create(const vulkan::Context& context) noexcept
 	{
-		auto camera_buffer_result =
-			vulkan::StagedBuffer<Camera>::create(context, vk::BufferUsageFlagBits::eUniformBuffer);
+		constexpr auto usage =
+			vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+		// Written in place on resizable BAR or unified memory, skipping the staging copy
+		const auto direct_upload = context.allocator.supports_direct_upload();
+		const auto memory_usage =
+			direct_upload ? vulkan::MemoryUsage::CpuToGpuDirect : vulkan::MemoryUsage::GpuOnly;
+
+		auto camera_buffer_result = context.allocator.create_element_buffer<Camera>(usage, memory_usage);
 		if (!camera_buffer_result) return camera_buffer_result.error().forward("Create camera buffer failed");
 
-		auto exposure_param_buffer_result =
-			vulkan::StagedBuffer<ExposureParam>::create(context, vk::BufferUsageFlagBits::eUniformBuffer);
+		// Uploaded on the main queue, and may be read by auto-exposure on the compute queue
+		const auto queue_families = context.unique_families();
+		auto exposure_param_buffer_result = context.allocator.create_element_buffer<ExposureParam>(
+			usage,
+			memory_usage,
+			context.multi_queue_sharing_mode(),
+			queue_families
+		);
 		if (!exposure_param_buffer_result)
 			return exposure_param_buffer_result.error().forward("Create exposure param buffer failed");
 
 		auto primary_light_buffer_result =
-			vulkan::StagedBuffer<DirectLight>::create(context, vk::BufferUsageFlagBits::eUniformBuffer);
+			context.allocator.create_element_buffer<DirectLight>(usage, memory_usage);
 		if (!primary_light_buffer_result)
 			return primary_light_buffer_result.error().forward("Create main light buffer failed");
 
+		// Persistently mapped, so that the camera stays writable until submit without the upload ring
+		auto camera_staging = std::optional<vulkan::ElementBuffer<Camera>>();
+		if (!direct_upload)
+		{
+			auto staging_result = context.allocator.create_element_buffer<Camera>(
+				vk::BufferUsageFlagBits::eTransferSrc,
+				vulkan::MemoryUsage::CpuToGpu
+			);
+			if (!staging_result) return staging_result.error().forward("Create camera staging buffer failed");
+			camera_staging = std::move(*staging_result);
+		}
+
 		return HostParamResource(
 			std::move(*camera_buffer_result),
 			std::move(*exposure_param_buffer_result),
-			std::move(*primary_light_buffer_result)
+			std::move(*primary_light_buffer_result),
+			direct_upload,
+			std::move(camera_staging)
 		);
 	}
 
 	std::expected<void, Error> HostParamResource::update(
+		const vulkan::Context& context,
+		vulkan::UploadRing& upload_ring,
 		const Camera& camera,
 		const ExposureParam& exposure_param,
 		const DirectLight& primary_light
 	) noexcept
 	{
-		auto camera_update_result = this->camera.update(camera);
-		if (!camera_update_result) return camera_update_result.error().forward("Update camera buffer failed");
+		if (const auto result = latch_camera(camera); !result)
+			return result.error().forward("Update camera buffer failed");
 
-		auto exposure_param_update_result = this->exposure_param.update(exposure_param);
-		if (!exposure_param_update_result)
-			return exposure_param_update_result.error().forward("Update exposure param buffer failed");
-
-		auto primary_light_update_result = this->primary_light.update(primary_light);
-		if (!primary_light_update_result)
-			return primary_light_update_result.error().forward("Update main light buffer failed");
-
-		return {};
-	}
+		if (direct_upload)
+		{
+			if (const auto result = this->exposure_param.upload(exposure_param); !result)
+				return result.error().forward("Update exposure param buffer failed");
 
-	std::array<vk::BufferMemoryBarrier2, 3> HostParamResource::upload(
-		const vk::raii::CommandBuffer& command_buffer
-	) const noexcept
-	{
-		// TODO: Raytrace pipeline stage flag bits
+			if (const auto result = this->primary_light.upload(primary_light); !result)
+				return result.error().forward("Update main light buffer failed");
 
-		const auto camera_barrier = camera.upload(
-			command_buffer,
-			vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader
-		);
+			return {};
+		}
 
-		const auto exposure_param_barrier = exposure_param.upload(
-			command_buffer,
-			vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader
-		);
+		if (const auto result = upload_ring.push(context, exposure_param, this->exposure_param); !result)
+			return result.error().forward("Update exposure param buffer failed");
 
-		const auto primary_light_barrier = primary_light.upload(
-			command_buffer,
-			vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader
-		);
+		if (const auto result = upload_ring.push(context, primary_light, this->primary_light); !result)
+			return result.error().forward("Update main light buffer failed");
 
-		return std::to_array({
-			camera_barrier,
-			exposure_param_barrier,
-			primary_light_barrier,
-		});
+		return {};
 	}
 
-	std::expected<void, Error> HostDrawcallResource::update(
-		const vulkan::Context& context,
-		PerRenderState<std::span<const PrimitiveDrawcall>> primitive_drawcalls,
-		std::span<const glm::mat4> transforms
-	) noexcept
+	std::expected<void, Error> HostParamResource::latch_camera(const Camera& camera) const noexcept
 	{
-		if (const auto result = transform_buffer.update(context, transforms); !result)
-			return result.error().forward("Update transform buffer failed");
-
-		for (
-			const auto& [data, buffer] :
-			std::views::zip(primitive_drawcalls.all(), primitive_drawcall_buffers.all())
-		)
-		{
-			if (const auto result = buffer.update(context, data); !result)
-				return result.error().forward("Update primitive drawcall buffer failed");
-		}
+		const auto& target = camera_staging.has_value() ? *camera_staging : this->camera;
+		if (const auto result = target.upload(camera); !result)
+			return result.error().forward("Write camera failed");
 
 		return {};
 	}
 
-	std::array<vk::BufferMemoryBarrier2, 5> HostDrawcallResource::upload(
-		const vk::raii::CommandBuffer& command_buffer
-	) const noexcept
+	void HostParamResource::record(const vk::raii::CommandBuffer& command_buffer) const noexcept
 	{
-		const auto transform_barrier = transform_buffer.upload(
-			command_buffer,
-			vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eComputeShader
-		);
+		if (!camera_staging.has_value()) return;
 
-		const auto primitive_drawcall_barriers =
-			primitive_drawcall_buffers
-				.map([&](const auto& buffer) {
-					return buffer.upload(command_buffer, vk::PipelineStageFlagBits2::eComputeShader);
-				})
-				.as_array();
+		command_buffer.copyBuffer(
+			static_cast<vk::Buffer>(*camera_staging),
+			static_cast<vk::Buffer>(camera),
+			vk::BufferCopy{.srcOffset = 0, .dstOffset = 0, .size = sizeof(Camera)}
+		);
 
-		return util::array_concat(transform_barrier, primitive_drawcall_barriers);
+		// TODO: Raytrace pipeline stage flag bits
+		const auto barrier = vk::BufferMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask =
+				vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader,
+			.dstAccessMask = vk::AccessFlagBits2::eUniformRead,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.buffer = camera,
+			.offset = 0,
+			.size = vk::WholeSize
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setBufferMemoryBarriers(barrier));
 	}
 }
@@ -1,28 +1,202 @@
 #include "render/resource/indirect.hpp"
 #include "common/util/error.hpp"
+#include "render/model/mesh.hpp"
 #include "render/util/per-render-state.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <expected>
+#include <format>
+#include <functional>
 #include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
 
 namespace render
 {
 	std::expected<void, Error> IndirectResource::resize(
 		const vulkan::Context& context,
-		render::PerRenderState<size_t> drawcall_counts
+		render::PerRenderState<size_t> drawcall_counts,
+		size_t primitive_count,
+		uint32_t view_count
 	) noexcept
 	{
+		const auto group_count = primitive_count * PrimitiveAttribute::MAX_LOD_COUNT;
+
+		if (const auto result = view_buffer.resize(context, view_count); !result)
+			return result.error().forward("Resize view buffer failed");
+
 		for (
-			const auto& [buffer, size] :
-			std::views::zip(indirect_drawcall_buffers.all(), drawcall_counts.all())
+			const auto& [buffer, candidate_buffer, command_buffer, group_buffer, state_buffer, size] :
+			std::views::zip(
+				indirect_drawcall_buffers.all(),
+				late_candidate_buffers.all(),
+				command_buffers.all(),
+				instance_group_buffers.all(),
+				instance_state_buffers.all(),
+				drawcall_counts.all()
+			)
 		)
 		{
-			if (const auto result = buffer.resize(context, size); !result)
+			// Early and late phase each takes half of the buffer
+			if (const auto result = buffer.resize(context, size * 2); !result)
 				return result.error().forward("Resize indirect buffer failed");
+
+			if (const auto result = candidate_buffer.resize(context, size); !result)
+				return result.error().forward("Resize late candidate buffer failed");
+
+			// Every command draws at least one drawcall
+			if (const auto result = command_buffer.resize(context, size * 2); !result)
+				return result.error().forward("Resize command buffer failed");
+
+			if (const auto result = group_buffer.resize(context, group_count * 2); !result)
+				return result.error().forward("Resize instance group buffer failed");
+
+			// Main camera and then each additional view
+			if (const auto result = state_buffer.resize(context, size * (view_count + 1)); !result)
+				return result.error().forward("Resize instance state buffer failed");
+		}
+
+		for (const auto& [buffer, size] : std::views::zip(bounds_buffers.all(), drawcall_counts.all()))
+		{
+			if (const auto result = buffer.resize(context, size); !result)
+				return result.error().forward("Resize bounds buffer failed");
+		}
+
+		for (
+			const auto& [buffer, command_buffer, group_buffer, size] : std::views::zip(
+				view_indirect_drawcall_buffers.all(),
+				view_command_buffers.all(),
+				view_instance_group_buffers.all(),
+				drawcall_counts.all()
+			)
+		)
+		{
+			if (const auto result = buffer.resize(context, size * view_count); !result)
+				return result.error().forward("Resize view indirect buffer failed");
+
+			if (const auto result = command_buffer.resize(context, size * view_count); !result)
+				return result.error().forward("Resize view command buffer failed");
+
+			if (const auto result = group_buffer.resize(context, group_count * view_count); !result)
+				return result.error().forward("Resize view instance group buffer failed");
+		}
+
+		for (
+			const auto& [depth_buffer, bucket_buffer] :
+			std::views::zip(group_depth_buffers.all(), sort_bucket_buffers.all())
+		)
+		{
+			if (const auto result = depth_buffer.resize(context, group_count * 2); !result)
+				return result.error().forward("Resize group depth buffer failed");
+
+			if (const auto result = bucket_buffer.resize(context, SORT_BUCKET_COUNT * 2); !result)
+				return result.error().forward("Resize sort bucket buffer failed");
+		}
+
+		for (auto& buffer : draw_count_buffers.all())
+		{
+			if (const auto result = buffer.resize(context, view_count + 1); !result)
+				return result.error().forward("Resize draw count buffer failed");
+		}
+
+		// Each node appends at most one impostor instance, at the first primitive of its mesh
+		const auto impostor_instance_count =
+			std::ranges::fold_left(drawcall_counts.all(), size_t(1), std::plus());
+
+		if (const auto result = impostor_instance_buffer.resize(context, impostor_instance_count); !result)
+			return result.error().forward("Resize impostor instance buffer failed");
+
+		if (const auto result = impostor_command_buffer.resize(context, 1); !result)
+			return result.error().forward("Resize impostor command buffer failed");
+
+		if (!stat_buffer.has_value())
+		{
+			auto buffer_result = context.allocator.create_array_buffer<IndirectCount>(
+				draw_count_buffers.as_ref_array().size(),
+				vk::BufferUsageFlagBits::eTransferDst,
+				vulkan::MemoryUsage::GpuToCpu
+			);
+			if (!buffer_result) return buffer_result.error().forward("Create stat buffer failed");
+
+			const auto zero_counts = std::vector<IndirectCount>(buffer_result->count(), IndirectCount{});
+			if (const auto result = buffer_result->upload(zero_counts); !result)
+				return result.error().forward("Clear stat buffer failed");
+
+			stat_buffer = std::move(*buffer_result);
+		}
+
+		return {};
+	}
+
+	void IndirectResource::record_stat_copy(const vk::raii::CommandBuffer& command_buffer) const noexcept
+	{
+		if (!stat_buffer.has_value()) return;
+
+		const auto pre_copy_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+			.srcAccessMask = vk::AccessFlagBits2::eShaderWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.dstAccessMask = vk::AccessFlagBits2::eTransferRead
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(pre_copy_barrier));
+
+		for (const auto [idx, buffer] : draw_count_buffers.all() | std::views::enumerate)
+		{
+			const auto region = vk::BufferCopy{
+				.srcOffset = 0,
+				.dstOffset = idx * sizeof(IndirectCount),
+				.size = sizeof(IndirectCount)
+			};
+			command_buffer.copyBuffer(static_cast<vk::Buffer>(buffer), *stat_buffer, region);
 		}
 
+		const auto post_copy_barrier = vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eHost,
+			.dstAccessMask = vk::AccessFlagBits2::eHostRead
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(post_copy_barrier));
+	}
+
+	std::expected<PerRenderState<IndirectCount>, Error> IndirectResource::read_stat() const noexcept
+	{
+		if (!stat_buffer.has_value()) return PerRenderState<IndirectCount>::from_args();
+
+		auto counts = std::array<IndirectCount, 4>();
+		if (const auto result = stat_buffer->download(counts); !result)
+			return result.error().forward("Read stat buffer failed");
+
+		return PerRenderState<IndirectCount>{
+			.opaque_single_sided = counts[0],
+			.opaque_double_sided = counts[1],
+			.masked_single_sided = counts[2],
+			.masked_double_sided = counts[3],
+		};
+	}
+
+	std::expected<void, Error> IndirectResource::upload_views(
+		const vulkan::Context& context,
+		vulkan::UploadRing& upload_ring,
+		std::span<const CullView> views
+	) noexcept
+	{
+		if (views.size() != view_buffer.count())
+			return Error("View count mismatches the resized view count", std::format("{}", views.size()));
+		if (views.empty()) return {};
+
+		if (const auto result = upload_ring.push(context, views, view_buffer.ref()); !result)
+			return result.error().forward("Upload views failed");
+
 		return {};
 	}
 }
@@ -0,0 +1,54 @@
+#include "render/resource/light-cluster.hpp"
+#include "common/util/error.hpp"
+#include "render/internal/light-cluster.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<LightClusterAttachment, Error> LightClusterAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		const auto tile_count = calc_tile_count(extent);
+		const auto cluster_count = size_t(tile_count.x) * tile_count.y * LIGHT_CLUSTER_SLICE_COUNT;
+
+		auto light_counts_result = context.allocator.create_array_buffer<uint32_t>(
+			cluster_count,
+			vk::BufferUsageFlagBits::eStorageBuffer,
+			vulkan::MemoryUsage::GpuOnly,
+			vk::SharingMode::eExclusive,
+			{},
+			vulkan::MemoryCategory::Other,
+			"Light Cluster Counts"
+		);
+		if (!light_counts_result)
+			return light_counts_result.error().forward("Create light count buffer failed");
+
+		auto light_indices_result = context.allocator.create_array_buffer<uint32_t>(
+			cluster_count * LIGHT_CLUSTER_MAX_LIGHTS,
+			vk::BufferUsageFlagBits::eStorageBuffer,
+			vulkan::MemoryUsage::GpuOnly,
+			vk::SharingMode::eExclusive,
+			{},
+			vulkan::MemoryCategory::Other,
+			"Light Cluster Indices"
+		);
+		if (!light_indices_result)
+			return light_indices_result.error().forward("Create light index buffer failed");
+
+		return LightClusterAttachment(
+			tile_count,
+			std::move(*light_counts_result),
+			std::move(*light_indices_result)
+		);
+	}
+}
@@ -0,0 +1,26 @@
+#include "render/resource/object-pick.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/primitive-drawcall.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<ObjectPickResource, Error> ObjectPickResource::create(
+		const vulkan::Context& context
+	) noexcept
+	{
+		auto result_buffer_result = context.allocator.create_element_buffer<PrimitiveDrawcall>(
+			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc,
+			vulkan::MemoryUsage::GpuOnly
+		);
+		if (!result_buffer_result)
+			return result_buffer_result.error().forward("Create object pick result buffer failed");
+
+		return ObjectPickResource(std::move(*result_buffer_result));
+	}
+}
@@ -0,0 +1,32 @@
+#include "render/resource/overlay.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<OverlayAttachment, Error> OverlayAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent,
+		vk::Format format
+	) noexcept
+	{
+		auto attachment_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			format,
+			{},
+			{},
+			"Overlay"
+		);
+		if (!attachment_result) return attachment_result.error().forward("Create overlay image failed");
+
+		return OverlayAttachment(extent, std::move(*attachment_result));
+	}
+}
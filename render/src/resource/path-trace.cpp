@@ -0,0 +1,32 @@
+#include "render/resource/path-trace.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<PathTraceAttachment, Error> PathTraceAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		auto accumulation_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			ACCUMULATION_FORMAT,
+			vk::ImageUsageFlagBits::eStorage,
+			{},
+			"Path Trace Accumulation"
+		);
+		if (!accumulation_result)
+			return accumulation_result.error().forward("Create path trace accumulation image failed");
+
+		return PathTraceAttachment(extent, std::move(*accumulation_result));
+	}
+}
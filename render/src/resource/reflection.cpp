@@ -0,0 +1,51 @@
+#include "render/resource/reflection.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<ReflectionAttachment, Error> ReflectionAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		const auto reduced_extent = (extent + DOWNSCALE - 1u) / DOWNSCALE;
+		const auto tile_count = (reduced_extent + TILE_SIZE - 1u) / TILE_SIZE;
+
+		auto signal_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			reduced_extent,
+			SIGNAL_FORMAT,
+			vk::ImageUsageFlagBits::eStorage,
+			{},
+			"Reflection Signal"
+		);
+		if (!signal_result) return signal_result.error().forward("Create reflection signal image failed");
+
+		auto tile_list_result = context.allocator.create_array_buffer<uint32_t>(
+			TILE_LIST_HEADER + size_t(tile_count.x) * tile_count.y,
+			vk::BufferUsageFlagBits::eStorageBuffer
+				| vk::BufferUsageFlagBits::eIndirectBuffer
+				| vk::BufferUsageFlagBits::eTransferDst,
+			vulkan::MemoryUsage::GpuOnly,
+			vk::SharingMode::eExclusive,
+			{},
+			vulkan::MemoryCategory::Attachment,
+			"Reflection Tile List"
+		);
+		if (!tile_list_result) return tile_list_result.error().forward("Create reflection tile list failed");
+
+		return ReflectionAttachment(reduced_extent, std::move(*signal_result), std::move(*tile_list_result));
+	}
+}
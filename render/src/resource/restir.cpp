@@ -0,0 +1,44 @@
+#include "render/resource/restir.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<RestirAttachment, Error> RestirAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		const auto pixel_count = size_t(extent.x) * extent.y;
+
+		const auto create_buffer = [&](const char* name) {
+			return context.allocator.create_array_buffer<Reservoir>(
+				pixel_count,
+				vk::BufferUsageFlagBits::eStorageBuffer,
+				vulkan::MemoryUsage::GpuOnly,
+				vk::SharingMode::eExclusive,
+				{},
+				vulkan::MemoryCategory::Attachment,
+				name
+			);
+		};
+
+		auto reservoirs_result = create_buffer("ReSTIR Reservoirs");
+		if (!reservoirs_result) return reservoirs_result.error().forward("Create reservoir buffer failed");
+
+		auto intermediate_result = create_buffer("ReSTIR Intermediate Reservoirs");
+		if (!intermediate_result)
+			return intermediate_result.error().forward("Create intermediate reservoir buffer failed");
+
+		return RestirAttachment(extent, std::move(*reservoirs_result), std::move(*intermediate_result));
+	}
+}
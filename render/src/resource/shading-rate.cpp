@@ -0,0 +1,63 @@
+#include "render/resource/shading-rate.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/common.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	// Tile size clamped into the texel size range of the device, which are powers of two
+	[[nodiscard]]
+	static glm::u32vec2 get_tile_size(const vulkan::Context& context) noexcept
+	{
+		const auto preferred_size = glm::u32vec2(ShadingRateAttachment::PREFERRED_TILE_SIZE);
+		if (!context.feature.fragment_shading_rate) return preferred_size;
+
+		const auto properties = context.phy_device.getProperties2<
+			vk::PhysicalDeviceProperties2,
+			vk::PhysicalDeviceFragmentShadingRatePropertiesKHR
+		>();
+		const auto& rate_properties = properties.get<vk::PhysicalDeviceFragmentShadingRatePropertiesKHR>();
+
+		const auto min_size = rate_properties.minFragmentShadingRateAttachmentTexelSize;
+		const auto max_size = rate_properties.maxFragmentShadingRateAttachmentTexelSize;
+
+		return glm::clamp(
+			preferred_size,
+			glm::u32vec2(min_size.width, min_size.height),
+			glm::u32vec2(max_size.width, max_size.height)
+		);
+	}
+
+	std::expected<ShadingRateAttachment, Error> ShadingRateAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		const auto tile_size = get_tile_size(context);
+		const auto tile_count = (extent + tile_size - 1u) / tile_size;
+
+		auto usage = vk::ImageUsageFlags(vk::ImageUsageFlagBits::eStorage);
+		if (context.feature.fragment_shading_rate)
+			usage |= vk::ImageUsageFlagBits::eFragmentShadingRateAttachmentKHR;
+
+		auto attachment_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			tile_count,
+			SHADING_RATE_FORMAT,
+			usage,
+			{},
+			"Shading Rate"
+		);
+		if (!attachment_result) return attachment_result.error().forward("Create shading rate image failed");
+
+		return ShadingRateAttachment(extent, tile_size, tile_count, std::move(*attachment_result));
+	}
+}
@@ -0,0 +1,36 @@
+#include "render/resource/shadow.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<ShadowMaskAttachment, Error> ShadowMaskAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent,
+		bool half_resolution
+	) noexcept
+	{
+		const uint32_t downscale = half_resolution ? 2 : 1;
+		const auto mask_extent = (extent + downscale - 1u) / downscale;
+
+		auto attachment_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			mask_extent,
+			SHADOW_MASK_FORMAT,
+			vk::ImageUsageFlagBits::eStorage,
+			{},
+			"Shadow Mask"
+		);
+		if (!attachment_result) return attachment_result.error().forward("Create shadow mask image failed");
+
+		return ShadowMaskAttachment(mask_extent, downscale, std::move(*attachment_result));
+	}
+}
@@ -0,0 +1,31 @@
+#include "render/resource/taa.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+
+namespace render
+{
+	std::expected<TaaAttachment, Error> TaaAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		auto attachment_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			TAA_FORMAT,
+			vk::ImageUsageFlagBits::eStorage,
+			{},
+			"TAA"
+		);
+		if (!attachment_result) return attachment_result.error().forward("Create TAA image failed");
+
+		return TaaAttachment(extent, std::move(*attachment_result));
+	}
+}
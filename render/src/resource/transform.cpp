@@ -0,0 +1,54 @@
+#include "render/resource/transform.hpp"
+#include "common/util/error.hpp"
+#include "render/interface/node-transform.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/container/device/upload-ring.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <span>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	TransformResource::TransformResource(const vulkan::Context& context) noexcept :
+		direct_upload(context.allocator.supports_direct_upload()),
+		update_buffer(
+			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+			direct_upload ? vulkan::MemoryUsage::CpuToGpuDirect : vulkan::MemoryUsage::GpuOnly
+		)
+	{}
+
+	std::expected<void, Error> TransformResource::update(
+		const vulkan::Context& context,
+		vulkan::UploadRing& upload_ring,
+		vulkan::DeletionQueue& deletion_queue,
+		size_t node_count,
+		std::span<const NodeTransformUpdate> updates,
+		const glm::mat4& root_transform
+	) noexcept
+	{
+		if (const auto result = update_buffer.resize(context, updates.size()); !result)
+			return result.error().forward("Resize transform update buffer failed");
+
+		if (direct_upload)
+		{
+			if (!updates.empty())
+				if (const auto result = update_buffer->upload(std::as_bytes(updates)); !result)
+					return result.error().forward("Update transform update buffer failed");
+		}
+		else if (const auto result = upload_ring.push(context, updates, update_buffer.ref()); !result)
+			return result.error().forward("Update transform update buffer failed");
+
+		if (const auto result = world_transform_buffer.resize(context, node_count, &deletion_queue); !result)
+			return result.error().forward("Resize world transform buffer failed");
+
+		this->root_transform = root_transform;
+
+		return {};
+	}
+}
@@ -0,0 +1,42 @@
+#include "render/resource/transparent.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+
+namespace render
+{
+	std::expected<TransparentAttachment, Error> TransparentAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		auto accumulation_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			ACCUMULATION_FORMAT,
+			{},
+			{},
+			"Transparent Accumulation"
+		);
+		if (!accumulation_result)
+			return accumulation_result.error().forward("Create accumulation buffer failed");
+
+		auto revealage_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			REVEALAGE_FORMAT,
+			{},
+			{},
+			"Transparent Revealage"
+		);
+		if (!revealage_result) return revealage_result.error().forward("Create revealage buffer failed");
+
+		return TransparentAttachment(extent, std::move(*accumulation_result), std::move(*revealage_result));
+	}
+}
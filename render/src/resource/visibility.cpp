@@ -0,0 +1,30 @@
+#include "render/resource/visibility.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/container/device/attachment.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+
+namespace render
+{
+	std::expected<VisibilityAttachment, Error> VisibilityAttachment::create(
+		const vulkan::Context& context,
+		glm::u32vec2 extent
+	) noexcept
+	{
+		auto visibility_result = vulkan::Attachment::create(
+			context.device,
+			context.allocator,
+			extent,
+			VISIBILITY_FORMAT,
+			{},
+			{},
+			"Visibility Buffer"
+		);
+		if (!visibility_result) return visibility_result.error().forward("Create visibility buffer failed");
+
+		return VisibilityAttachment(extent, std::move(*visibility_result));
+	}
+}
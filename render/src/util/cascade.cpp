@@ -0,0 +1,130 @@
+#include "render/util/cascade.hpp"
+#include "render/interface/camera.hpp"
+#include "scene/camera.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/geometric.hpp>
+#include <ranges>
+#include <vector>
+
+namespace render
+{
+	// (Helper) Direction from the camera through a point on the screen, in world space
+	[[nodiscard]]
+	static glm::vec3 get_view_ray(const Camera& camera, glm::vec2 ndc) noexcept
+	{
+		// Half depth is finite for both finite and infinite reverse-Z projections
+		const auto point = camera.inv_view_projection * glm::vec4(ndc, 0.5f, 1.0f);
+		return glm::normalize(glm::vec3(point) / point.w - camera.camera_pos);
+	}
+
+	// (Helper) Split distances of the practical split scheme, `cascade_count + 1` distances from near to far
+	[[nodiscard]]
+	static std::vector<float> get_split_distances(const CascadeOption& option) noexcept
+	{
+		const auto near = option.near_distance;
+		const auto far = std::max(option.shadow_distance, near);
+
+		const auto get_split = [&](uint32_t split) {
+			const auto ratio = static_cast<float>(split) / static_cast<float>(option.cascade_count);
+			const auto logarithmic = near * std::pow(far / near, ratio);
+			const auto uniform = near + (far - near) * ratio;
+			return std::lerp(uniform, logarithmic, option.split_lambda);
+		};
+
+		return std::views::iota(0u, option.cascade_count + 1)
+			| std::views::transform(get_split)
+			| std::ranges::to<std::vector>();
+	}
+
+	std::vector<ShadowCascade> fit_cascades(
+		const Camera& camera,
+		glm::vec3 light_direction,
+		const CascadeOption& option
+	) noexcept
+	{
+		if (option.cascade_count == 0) return {};
+
+		/* Frustum rays */
+
+		const auto forward = get_view_ray(camera, glm::vec2(0.0f));
+		const auto corner_rays = std::to_array({
+			get_view_ray(camera, {-1.0f, -1.0f}),
+			get_view_ray(camera, {1.0f, -1.0f}),
+			get_view_ray(camera, {-1.0f, 1.0f}),
+			get_view_ray(camera, {1.0f, 1.0f}),
+		});
+
+		// Point on a corner ray at a view depth
+		const auto get_corner = [&](glm::vec3 ray, float depth) {
+			return camera.camera_pos + ray * (depth / glm::dot(ray, forward));
+		};
+
+		/* Light space */
+
+		const auto to_light = glm::normalize(light_direction);
+		const auto up =
+			std::abs(to_light.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+		// Rotation only, so that snapping in light space is independent of the cascade position
+		const auto light_view = glm::lookAt(glm::vec3(0.0f), -to_light, up);
+
+		/* Cascades */
+
+		const auto split_distances = get_split_distances(option);
+		const auto resolution = static_cast<float>(std::max(option.resolution, 1u));
+
+		const auto fit_cascade = [&](uint32_t cascade_idx) {
+			const auto near = split_distances[cascade_idx];
+			const auto far = split_distances[cascade_idx + 1];
+
+			std::array<glm::vec3, 8> corners;
+			for (const auto [idx, ray] : corner_rays | std::views::enumerate)
+			{
+				corners[idx * 2] = get_corner(ray, near);
+				corners[idx * 2 + 1] = get_corner(ray, far);
+			}
+
+			auto center = glm::vec3(0.0f);
+			for (const auto& corner : corners) center += corner / 8.0f;
+
+			auto radius = 0.0f;
+			for (const auto& corner : corners) radius = std::max(radius, glm::distance(corner, center));
+
+			// Quantized, so that the extent doesn't flicker with floating point error
+			radius = std::ceil(radius * 16.0f) / 16.0f;
+
+			const auto texel_size = radius * 2.0f / resolution;
+			auto light_center = glm::vec3(light_view * glm::vec4(center, 1.0f));
+			light_center.x = std::floor(light_center.x / texel_size) * texel_size;
+			light_center.y = std::floor(light_center.y / texel_size) * texel_size;
+
+			// Light view looks along -Z, the near plane is extended toward the light to capture casters
+			const auto projection = glm::ortho(
+				light_center.x - radius,
+				light_center.x + radius,
+				light_center.y - radius,
+				light_center.y + radius,
+				-(light_center.z + radius + option.caster_distance),
+				-(light_center.z - radius)
+			);
+
+			return ShadowCascade{
+				.view_projection = glm::mat4(scene::camera::reverse_z()) * projection * light_view,
+				.far_distance = far,
+			};
+		};
+
+		return std::views::iota(0u, option.cascade_count)
+			| std::views::transform(fit_cascade)
+			| std::ranges::to<std::vector>();
+	}
+}
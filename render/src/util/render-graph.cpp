@@ -0,0 +1,649 @@
+#include "render/util/render-graph.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/numeric/base-level.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <libassert/assert.hpp>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_format_traits.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace render
+{
+	namespace
+	{
+		// Synchronization state of a resource, buffers always stay in `vk::ImageLayout::eUndefined`
+		struct ResourceState
+		{
+			vk::ImageLayout layout;
+			vk::PipelineStageFlags2 write_stage;  // Stages of the last write, or layout transition
+			vk::AccessFlags2 write_access;        // Accesses of the last write
+			vk::PipelineStageFlags2 read_stage;   // Stages the last write has been made visible to
+			vk::AccessFlags2 read_access;         // Accesses the last write has been made visible to
+		};
+
+		struct Dependency
+		{
+			vk::PipelineStageFlags2 src_stage;
+			vk::AccessFlags2 src_access;
+			vk::PipelineStageFlags2 dst_stage;
+			vk::AccessFlags2 dst_access;
+			vk::ImageLayout old_layout;
+			vk::ImageLayout new_layout;
+		};
+
+		// Advance the state of a resource by an access, and return the dependency the access requires
+		std::optional<Dependency> apply_access(
+			ResourceState& state,
+			vk::PipelineStageFlags2 stage,
+			vk::AccessFlags2 access,
+			vk::ImageLayout layout,
+			bool write
+		) noexcept
+		{
+			const auto layout_change = layout != state.layout;
+
+			if (write || layout_change)
+			{
+				// Reads only need an execution dependency (WAR), writes also need their memory made available
+				const auto dependency = Dependency{
+					.src_stage = state.write_stage | state.read_stage,
+					.src_access = state.write_access,
+					.dst_stage = stage,
+					.dst_access = access,
+					.old_layout = state.layout,
+					.new_layout = layout
+				};
+
+				// A layout transition by a read acts as a write, later reads chain after the reading stages
+				state = write
+					? ResourceState{.layout = layout, .write_stage = stage, .write_access = access}
+					: ResourceState{
+						  .layout = layout,
+						  .write_stage = stage,
+						  .write_access = vk::AccessFlagBits2::eNone,
+						  .read_stage = stage,
+						  .read_access = access
+					  };
+
+				if (!layout_change && !dependency.src_stage) return std::nullopt;
+				return dependency;
+			}
+
+			// Read after read, skip if the last write has already been made visible to the access
+			const auto visible = !(stage & ~state.read_stage) && !(access & ~state.read_access);
+			state.read_stage |= stage;
+			state.read_access |= access;
+
+			if (visible || !state.write_stage) return std::nullopt;
+
+			return Dependency{
+				.src_stage = state.write_stage,
+				.src_access = state.write_access,
+				.dst_stage = stage,
+				.dst_access = access,
+				.old_layout = layout,
+				.new_layout = layout
+			};
+		}
+
+		vk::ImageMemoryBarrier2 get_image_barrier(
+			const Dependency& dependency,
+			vk::Image image,
+			const vk::ImageSubresourceRange& range
+		) noexcept
+		{
+			return {
+				.srcStageMask = dependency.src_stage,
+				.srcAccessMask = dependency.src_access,
+				.dstStageMask = dependency.dst_stage,
+				.dstAccessMask = dependency.dst_access,
+				.oldLayout = dependency.old_layout,
+				.newLayout = dependency.new_layout,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = image,
+				.subresourceRange = range
+			};
+		}
+
+		vk::BufferMemoryBarrier2 get_buffer_barrier(const Dependency& dependency, vk::Buffer buffer) noexcept
+		{
+			return {
+				.srcStageMask = dependency.src_stage,
+				.srcAccessMask = dependency.src_access,
+				.dstStageMask = dependency.dst_stage,
+				.dstAccessMask = dependency.dst_access,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.buffer = buffer,
+				.offset = 0,
+				.size = vk::WholeSize
+			};
+		}
+
+		vk::ImageAspectFlags get_image_aspects(vk::Format format) noexcept
+		{
+			if (!vk::hasDepthComponent(format)) return vk::ImageAspectFlagBits::eColor;
+			if (!vk::hasStencilComponent(format)) return vk::ImageAspectFlagBits::eDepth;
+			return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+		}
+
+		vk::ImageCreateInfo get_image_create_info(const RenderGraph::TransientImageInfo& info) noexcept
+		{
+			return {
+				.imageType = vk::ImageType::e2D,
+				.format = info.format,
+				.extent = {.width = info.extent.width, .height = info.extent.height, .depth = 1},
+				.mipLevels = 1,
+				.arrayLayers = 1,
+				.samples = vk::SampleCountFlagBits::e1,
+				.tiling = vk::ImageTiling::eOptimal,
+				.usage = info.usage,
+				.sharingMode = vk::SharingMode::eExclusive
+			};
+		}
+	}
+
+	RenderGraph::ImageHandle RenderGraph::import_image(
+		vulkan::AttachmentView attachment,
+		vk::ImageSubresourceRange range,
+		ImageAccess initial_access,
+		std::optional<ImageAccess> final_access
+	) noexcept
+	{
+		images.push_back(
+			ImageNode{
+				.transient = std::nullopt,
+				.attachment = attachment,
+				.range = range,
+				.initial_access = initial_access,
+				.final_access = final_access
+			}
+		);
+
+		return {.index = static_cast<uint32_t>(images.size() - 1)};
+	}
+
+	RenderGraph::ImageHandle RenderGraph::create_image(const TransientImageInfo& info) noexcept
+	{
+		images.push_back(
+			ImageNode{
+				.transient = info,
+				.attachment = {.format = info.format},
+				.range = vulkan::base_level_image_range(get_image_aspects(info.format)),
+				.initial_access =
+					{.stage = vk::PipelineStageFlagBits2::eNone,
+					 .access = vk::AccessFlagBits2::eNone,
+					 .layout = vk::ImageLayout::eUndefined},
+				.final_access = std::nullopt
+			}
+		);
+
+		return {.index = static_cast<uint32_t>(images.size() - 1)};
+	}
+
+	RenderGraph::BufferHandle RenderGraph::import_buffer(
+		vk::Buffer buffer,
+		BufferAccess initial_access,
+		std::optional<BufferAccess> final_access
+	) noexcept
+	{
+		buffers.push_back(
+			BufferNode{.buffer = buffer, .initial_access = initial_access, .final_access = final_access}
+		);
+
+		return {.index = static_cast<uint32_t>(buffers.size() - 1)};
+	}
+
+	void RenderGraph::add_pass(std::string_view name, const SetupFunc& setup, ExecuteFunc execute) noexcept
+	{
+		passes.push_back(
+			Pass{
+				.name = std::pmr::string(name, memory_resource),
+				.image_uses = std::pmr::vector<ImageUse>(memory_resource),
+				.buffer_uses = std::pmr::vector<BufferUse>(memory_resource),
+				.side_effect = false,
+				.execute = std::move(execute)
+			}
+		);
+
+		auto builder = PassBuilder(passes.back());
+		setup(builder);
+	}
+
+	std::pmr::vector<bool> RenderGraph::find_live_passes() const noexcept
+	{
+		auto live = std::pmr::vector<bool>(passes.size(), false, memory_resource);
+		auto image_needed = std::pmr::vector<bool>(images.size(), false, memory_resource);
+
+		// Walk backwards, a pass is live if any of its writes is an output or is needed by a later live pass.
+		// Each access of a live pass conservatively needs the previous contents, as writes may also read
+		for (const auto pass_idx : std::views::iota(0zu, passes.size()) | std::views::reverse)
+		{
+			const auto& pass = passes[pass_idx];
+
+			const auto writes_needed_image = std::ranges::any_of(pass.image_uses, [&](const ImageUse& use) {
+				return use.write && (!images[use.index].transient.has_value() || image_needed[use.index]);
+			});
+			const auto writes_buffer = std::ranges::any_of(pass.buffer_uses, &BufferUse::write);
+
+			if (!pass.side_effect && !writes_needed_image && !writes_buffer) continue;
+
+			live[pass_idx] = true;
+			for (const auto& use : pass.image_uses) image_needed[use.index] = true;
+		}
+
+		return live;
+	}
+
+	std::expected<void, Error> RenderGraph::prepare_transients(
+		const vulkan::Context& context,
+		TransientCache& cache,
+		std::span<TransientPlacement> placements,
+		std::pmr::memory_resource& memory_resource
+	) noexcept
+	{
+		struct Block
+		{
+			vk::MemoryRequirements requirements;
+			std::pmr::vector<uint32_t> placements;
+		};
+
+		const auto create_infos =
+			placements
+			| std::views::transform([](const TransientPlacement& placement) {
+				  return get_image_create_info(placement.info);
+			  })
+			| std::ranges::to<std::pmr::vector<vk::ImageCreateInfo>>(&memory_resource);
+
+		const auto requirements =
+			create_infos
+			| std::views::transform([&context](const vk::ImageCreateInfo& create_info) {
+				  const auto query = vk::DeviceImageMemoryRequirements{.pCreateInfo = &create_info};
+				  return context.device.getImageMemoryRequirements(query).memoryRequirements;
+			  })
+			| std::ranges::to<std::pmr::vector<vk::MemoryRequirements>>(&memory_resource);
+
+		// Place the largest images first, so that smaller images fill the blocks left by them
+		auto order = std::views::iota(0u, static_cast<uint32_t>(placements.size()))
+			| std::ranges::to<std::pmr::vector<uint32_t>>(&memory_resource);
+		std::ranges::stable_sort(order, std::ranges::greater(), [&requirements](uint32_t idx) {
+			return requirements[idx].size;
+		});
+
+		auto blocks = std::pmr::vector<Block>(&memory_resource);
+
+		for (const auto placement_idx : order)
+		{
+			const auto& placement = placements[placement_idx];
+			const auto& requirement = requirements[placement_idx];
+
+			const auto overlaps = [&placements, &placement](uint32_t other_idx) {
+				const auto& other = placements[other_idx];
+				return placement.first_pass <= other.last_pass && other.first_pass <= placement.last_pass;
+			};
+
+			const auto block = std::ranges::find_if(blocks, [&](const Block& block) {
+				return (block.requirements.memoryTypeBits & requirement.memoryTypeBits) != 0
+					&& std::ranges::none_of(block.placements, overlaps);
+			});
+
+			if (block == blocks.end())
+			{
+				placements[placement_idx].block = static_cast<uint32_t>(blocks.size());
+				blocks.push_back(
+					Block{
+						.requirements = requirement,
+						.placements = std::pmr::vector<uint32_t>({placement_idx}, &memory_resource)
+					}
+				);
+				continue;
+			}
+
+			block->requirements.size = std::max(block->requirements.size, requirement.size);
+			block->requirements.alignment = std::max(block->requirements.alignment, requirement.alignment);
+			block->requirements.memoryTypeBits &= requirement.memoryTypeBits;
+			block->placements.push_back(placement_idx);
+			placements[placement_idx].block = static_cast<uint32_t>(block - blocks.begin());
+		}
+
+		if (std::ranges::equal(placements, cache.placements)) return {};
+
+		// Invalidate first, so that a failed recreation is retried on the next execution
+		cache.placements.clear();
+		cache.views.clear();
+		cache.images.clear();
+		cache.memory_blocks.clear();
+
+		for (const auto& block : blocks)
+		{
+			auto memory_result = context.allocator.allocate_memory(
+				block.requirements,
+				vulkan::MemoryUsage::GpuOnly,
+				vulkan::MemoryCategory::Attachment
+			);
+			if (!memory_result) return memory_result.error().forward("Allocate transient memory failed");
+			cache.memory_blocks.push_back(std::move(*memory_result));
+		}
+
+		for (const auto [placement, create_info] : std::views::zip(placements, create_infos))
+		{
+			auto image_result = context.allocator.create_aliasing_image(
+				context.device,
+				cache.memory_blocks[placement.block],
+				0,
+				create_info
+			);
+			if (!image_result) return image_result.error().forward("Create transient image failed");
+
+			const auto view_create_info = vk::ImageViewCreateInfo{
+				.image = *image_result.value(),
+				.viewType = vk::ImageViewType::e2D,
+				.format = placement.info.format,
+				.subresourceRange = vulkan::base_level_image_range(get_image_aspects(placement.info.format))
+			};
+
+			auto view_result = context.device.createImageView(view_create_info);
+			if (!view_result) return Error::from(view_result);
+
+			cache.images.push_back(std::move(*image_result));
+			cache.views.push_back(std::move(*view_result));
+		}
+
+		cache.placements.assign(placements.begin(), placements.end());
+
+		return {};
+	}
+
+	std::expected<void, Error> RenderGraph::execute(
+		const vulkan::Context& context,
+		const vk::raii::CommandBuffer& command_buffer,
+		TransientCache& transient_cache
+	) const noexcept
+	{
+		const auto live = find_live_passes();
+
+		/* Transient Lifetimes */
+
+		auto placement_indices =
+			std::pmr::vector<std::optional<uint32_t>>(images.size(), std::nullopt, memory_resource);
+		auto placements = std::pmr::vector<TransientPlacement>(memory_resource);
+
+		for (const auto pass_idx : std::views::iota(0u, static_cast<uint32_t>(passes.size())))
+		{
+			if (!live[pass_idx]) continue;
+
+			for (const auto& use : passes[pass_idx].image_uses)
+			{
+				const auto& image = images[use.index];
+				if (!image.transient.has_value()) continue;
+
+				auto& placement_idx = placement_indices[use.index];
+				if (!placement_idx.has_value())
+				{
+					placement_idx = static_cast<uint32_t>(placements.size());
+					placements.push_back(
+						TransientPlacement{
+							.info = *image.transient,
+							.first_pass = pass_idx,
+							.last_pass = pass_idx,
+							.block = 0
+						}
+					);
+				}
+
+				placements[*placement_idx].last_pass = pass_idx;
+			}
+		}
+
+		if (const auto result = prepare_transients(context, transient_cache, placements, *memory_resource);
+			!result)
+			return result.error().forward("Prepare transient images failed");
+
+		const auto& cached_placements = transient_cache.placements;
+
+		/* Resolve Resources */
+
+		auto attachments = std::pmr::vector<vulkan::AttachmentView>(images.size(), memory_resource);
+		auto image_states = std::pmr::vector<ResourceState>(images.size(), memory_resource);
+		auto buffer_states = std::pmr::vector<ResourceState>(buffers.size(), memory_resource);
+
+		for (const auto [image_idx, image] : std::views::enumerate(images))
+		{
+			attachments[image_idx] = image.attachment;
+			image_states[image_idx] = {
+				.layout = image.initial_access.layout,
+				.write_stage = image.initial_access.stage,
+				.write_access = image.initial_access.access
+			};
+
+			if (const auto placement_idx = placement_indices[image_idx]; placement_idx.has_value())
+			{
+				attachments[image_idx].image = *transient_cache.images[*placement_idx];
+				attachments[image_idx].view = *transient_cache.views[*placement_idx];
+			}
+		}
+
+		for (const auto [buffer_idx, buffer] : std::views::enumerate(buffers))
+		{
+			buffer_states[buffer_idx] = {
+				.layout = vk::ImageLayout::eUndefined,
+				.write_stage = buffer.initial_access.stage,
+				.write_access = buffer.initial_access.access
+			};
+		}
+
+		// Transient images taking over the memory of a previous image wait for all its accesses
+		const auto seed_transient = [&](uint32_t image_idx) {
+			const auto& placement = cached_placements[*placement_indices[image_idx]];
+
+			std::optional<uint32_t> predecessor_idx;
+			for (const auto [other_image_idx, other_placement_idx] : std::views::enumerate(placement_indices))
+			{
+				if (!other_placement_idx.has_value()) continue;
+
+				const auto& other = cached_placements[*other_placement_idx];
+				if (other.block != placement.block || other.last_pass >= placement.first_pass) continue;
+				if (predecessor_idx.has_value()
+					&& cached_placements[*placement_indices[*predecessor_idx]].last_pass >= other.last_pass)
+					continue;
+
+				predecessor_idx = static_cast<uint32_t>(other_image_idx);
+			}
+
+			if (!predecessor_idx.has_value()) return;
+
+			const auto& predecessor_state = image_states[*predecessor_idx];
+			auto& state = image_states[image_idx];
+			state.write_stage = predecessor_state.write_stage | predecessor_state.read_stage;
+			state.write_access = predecessor_state.write_access;
+		};
+
+		/* Record Passes */
+
+		const auto resources = Resources(attachments, buffers);
+
+		auto image_barriers = std::pmr::vector<vk::ImageMemoryBarrier2>(memory_resource);
+		auto buffer_barriers = std::pmr::vector<vk::BufferMemoryBarrier2>(memory_resource);
+
+		const auto flush_barriers = [&] {
+			if (image_barriers.empty() && buffer_barriers.empty()) return;
+
+			command_buffer.pipelineBarrier2(
+				vk::DependencyInfo()
+					.setImageMemoryBarriers(image_barriers)
+					.setBufferMemoryBarriers(buffer_barriers)
+			);
+
+			image_barriers.clear();
+			buffer_barriers.clear();
+		};
+
+		for (const auto pass_idx : std::views::iota(0u, static_cast<uint32_t>(passes.size())))
+		{
+			if (!live[pass_idx]) continue;
+
+			const auto& pass = passes[pass_idx];
+
+			for (const auto& use : pass.image_uses)
+			{
+				const auto placement_idx = placement_indices[use.index];
+				if (placement_idx.has_value() && cached_placements[*placement_idx].first_pass == pass_idx)
+					seed_transient(use.index);
+
+				const auto dependency = apply_access(
+					image_states[use.index],
+					use.access.stage,
+					use.access.access,
+					use.access.layout,
+					use.write
+				);
+
+				if (dependency.has_value())
+					image_barriers.push_back(
+						get_image_barrier(*dependency, attachments[use.index].image, images[use.index].range)
+					);
+			}
+
+			for (const auto& use : pass.buffer_uses)
+			{
+				const auto dependency = apply_access(
+					buffer_states[use.index],
+					use.access.stage,
+					use.access.access,
+					vk::ImageLayout::eUndefined,
+					use.write
+				);
+
+				if (dependency.has_value())
+					buffer_barriers.push_back(get_buffer_barrier(*dependency, buffers[use.index].buffer));
+			}
+
+			flush_barriers();
+
+			if (const auto result = pass.execute(command_buffer, resources); !result)
+				return result.error().forward(std::format("Execute pass \"{}\" failed", pass.name));
+		}
+
+		/* Final Accesses */
+
+		for (const auto [image_idx, image] : std::views::enumerate(images))
+		{
+			if (!image.final_access.has_value()) continue;
+
+			const auto dependency = apply_access(
+				image_states[image_idx],
+				image.final_access->stage,
+				image.final_access->access,
+				image.final_access->layout,
+				false
+			);
+
+			if (dependency.has_value())
+				image_barriers.push_back(
+					get_image_barrier(*dependency, attachments[image_idx].image, image.range)
+				);
+		}
+
+		for (const auto [buffer_idx, buffer] : std::views::enumerate(buffers))
+		{
+			if (!buffer.final_access.has_value()) continue;
+
+			const auto dependency = apply_access(
+				buffer_states[buffer_idx],
+				buffer.final_access->stage,
+				buffer.final_access->access,
+				vk::ImageLayout::eUndefined,
+				false
+			);
+
+			if (dependency.has_value())
+				buffer_barriers.push_back(get_buffer_barrier(*dependency, buffer.buffer));
+		}
+
+		flush_barriers();
+
+		return {};
+	}
+
+	void RenderGraph::PassBuilder::read(ImageHandle image, ImageAccess access) noexcept
+	{
+		add_use(image, access, false);
+	}
+
+	void RenderGraph::PassBuilder::write(ImageHandle image, ImageAccess access) noexcept
+	{
+		add_use(image, access, true);
+	}
+
+	void RenderGraph::PassBuilder::read(BufferHandle buffer, BufferAccess access) noexcept
+	{
+		add_use(buffer, access, false);
+	}
+
+	void RenderGraph::PassBuilder::write(BufferHandle buffer, BufferAccess access) noexcept
+	{
+		add_use(buffer, access, true);
+	}
+
+	void RenderGraph::PassBuilder::set_side_effect() noexcept
+	{
+		pass.side_effect = true;
+	}
+
+	void RenderGraph::PassBuilder::add_use(ImageHandle image, ImageAccess access, bool write) noexcept
+	{
+		const auto existing = std::ranges::find(pass.image_uses, image.index, &ImageUse::index);
+
+		if (existing == pass.image_uses.end())
+		{
+			pass.image_uses.push_back(ImageUse{.index = image.index, .access = access, .write = write});
+			return;
+		}
+
+		ASSERT(
+			existing->access.layout == access.layout && "Accesses of an image in a pass must share the layout"
+		);
+
+		existing->access.stage |= access.stage;
+		existing->access.access |= access.access;
+		existing->write = existing->write || write;
+	}
+
+	void RenderGraph::PassBuilder::add_use(BufferHandle buffer, BufferAccess access, bool write) noexcept
+	{
+		const auto existing = std::ranges::find(pass.buffer_uses, buffer.index, &BufferUse::index);
+
+		if (existing == pass.buffer_uses.end())
+		{
+			pass.buffer_uses.push_back(BufferUse{.index = buffer.index, .access = access, .write = write});
+			return;
+		}
+
+		existing->access.stage |= access.stage;
+		existing->access.access |= access.access;
+		existing->write = existing->write || write;
+	}
+
+	vulkan::AttachmentView RenderGraph::Resources::image(ImageHandle image) const noexcept
+	{
+		return images[image.index];
+	}
+
+	vk::Buffer RenderGraph::Resources::buffer(BufferHandle buffer) const noexcept
+	{
+		return buffers[buffer.index].buffer;
+	}
+}
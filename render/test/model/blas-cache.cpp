@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <doctest.h>
+#include <filesystem>
+#include <ranges>
+#include <vector>
+
+#include "common/file.hpp"
+#include "common/test-macro.hpp"
+#include "render/model/blas-cache.hpp"
+#include "render/model/blas.hpp"
+#include "render/model/model-cache.hpp"
+#include "render/model/model.hpp"
+
+// NOLINTBEGIN
+
+// Opaque blobs standing in for serialized BLASes, the cache never interprets them
+static render::BlasList::Serialized create_serialized()
+{
+	auto data = std::vector<std::byte>(768);
+	for (const auto idx : std::views::iota(0zu, data.size())) data[idx] = std::byte(idx * 7);
+
+	return render::BlasList::Serialized{
+		.data = std::move(data),
+		.offsets = {0, 256, 768},
+		.mesh_blas_index = {0, 1, 1, 0}
+	};
+}
+
+static std::filesystem::path get_cache_path()
+{
+	const auto os_tempdir = std::getenv("TEMP_DIR");
+	REQUIRE(os_tempdir != nullptr);
+	return std::filesystem::path(os_tempdir) / "render-blas-cache-test" / "model.vrtcache.blas";
+}
+
+static render::BlasCache::Key get_key(render::Model::Option option = {})
+{
+	const auto model_key = render::ModelCache::get_key(0x1234, option);
+	return render::BlasCache::get_key(model_key, option);
+}
+
+// NOLINTEND
+
+TEST_CASE("Round trip")
+{
+	const auto serialized = create_serialized();
+	const auto path = get_cache_path();
+	const auto key = get_key();
+
+	const auto write_result = render::BlasCache::write(path, key, serialized.view());
+	EXPECT_SUCCESS(write_result);
+
+	auto cache_result = render::BlasCache::open(path, key);
+	EXPECT_SUCCESS(cache_result);
+	const auto& view = cache_result->view();
+
+	CHECK(std::ranges::equal(view.data, serialized.data));
+	CHECK(std::ranges::equal(view.offsets, serialized.offsets));
+	CHECK(std::ranges::equal(view.mesh_blas_index, serialized.mesh_blas_index));
+}
+
+TEST_CASE("Invalidation")
+{
+	const auto serialized = create_serialized();
+	const auto path = get_cache_path();
+	const auto key = get_key();
+
+	const auto write_result = render::BlasCache::write(path, key, serialized.view());
+	EXPECT_SUCCESS(write_result);
+
+	SUBCASE("Model changed")
+	{
+		const auto other_key = get_key(render::Model::Option{.optimize_mesh = true});
+		const auto cache_result = render::BlasCache::open(path, other_key);
+		EXPECT_FAIL(cache_result);
+	}
+
+	SUBCASE("Option changed")
+	{
+		const auto other_key = render::BlasCache::get_key(
+			render::ModelCache::get_key(0x1234, render::Model::Option()),
+			render::Model::Option{.compact_blas = true}
+		);
+		const auto cache_result = render::BlasCache::open(path, other_key);
+		EXPECT_FAIL(cache_result);
+	}
+
+	SUBCASE("Truncated")
+	{
+		auto data_result = file::read(path);
+		EXPECT_SUCCESS(data_result);
+		data_result->resize(data_result->size() - 16);
+		const auto truncate_result = file::write(path, *data_result);
+		EXPECT_SUCCESS(truncate_result);
+
+		const auto cache_result = render::BlasCache::open(path, key);
+		EXPECT_FAIL(cache_result);
+	}
+
+	SUBCASE("Missing")
+	{
+		std::filesystem::remove(path);
+
+		const auto cache_result = render::BlasCache::open(path, key);
+		EXPECT_FAIL(cache_result);
+	}
+}
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <doctest.h>
+#include <filesystem>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "common/file.hpp"
+#include "common/test-macro.hpp"
+#include "common/util/span.hpp"
+#include "image/common.hpp"
+#include "image/image.hpp"
+#include "model/hierarchy.hpp"
+#include "model/light.hpp"
+#include "model/material.hpp"
+#include "model/model.hpp"
+#include "model/texture.hpp"
+#include "render/model/impostor-list.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/model-cache.hpp"
+#include "render/model/model.hpp"
+#include "render/model/texture-list.hpp"
+#include "render/model/texture.hpp"
+
+// NOLINTBEGIN
+
+static render::Model::Baked create_baked_model()
+{
+	const auto texture = model::Texture{
+		.source = image::Image<image::Format::Unorm8, image::Layout::RGBA>({16, 16}, {0x80, 0x80, 0x80, 0xFF})
+	};
+	auto baked_texture_result =
+		render::Texture::bake_color_texture(texture, render::Texture::ColorLoadStrategy::AllBC7);
+	REQUIRE(baked_texture_result.has_value());
+
+	const auto primitive_attr = render::PrimitiveAttribute{
+		.index_offset = 0,
+		.vertex_offset = 0,
+		.index_count = 3,
+		.vertex_count = 3,
+		.meshlet_offset = 0,
+		.meshlet_count = 0,
+		.material_index = 0,
+		.index_size = sizeof(uint16_t),
+		.aabb_min = glm::vec3(0.0f),
+		.aabb_max = glm::vec3(1.0f),
+		.lod_count = 1,
+		.lods = {render::PrimitiveLod{.index_offset = 0, .index_count = 3, .error = 0.0f}}
+	};
+
+	return render::Model::Baked{
+		.nodes = {
+			model::ParentOnlyNode{.parent_index = std::nullopt, .data = {.mesh_index = 0, .light_index = 0}},
+			model::ParentOnlyNode{.parent_index = 0, .data = {.mesh_index = 0}}
+		},
+		.materials = {model::Material()},
+		.textures = {render::TextureList::BakedTuple{
+			.color = std::move(*baked_texture_result),
+			.normal = std::nullopt,
+			.sample_mode = {.min_filter = model::Filter::Nearest}
+		}},
+		.mesh = render::MeshList::Baked{
+			.vertex_format = render::VertexFormat::Full,
+			.index_format = render::IndexFormat::Uint16,
+			.vertices = std::vector<model::FullVertex>(3),
+			.packed_vertices = {},
+			.positions = {},
+			.indices = {},
+			.short_indices = {0, 1, 2},
+			.primitive_attrs = {primitive_attr},
+			.mesh_primitive_index_ranges = {render::PrimitiveIndexRange{.offset = 0, .count = 1}},
+			.meshlets = {},
+			.meshlet_vertices = {},
+			.meshlet_triangles = {},
+			.max_meshlet_count = 0
+		},
+		.lights = {model::Light{.type = model::LightType::Spot, .intensity = 10.0f, .range = 5.0f}},
+		.hlod_clusters = {model::HlodCluster{
+			.proxy_node_index = 1,
+			.source_offset = 0,
+			.source_count = 1,
+			.aabb_min = glm::vec3(0.0f),
+			.aabb_max = glm::vec3(1.0f)
+		}},
+		.hlod_source_nodes = {0},
+		.impostor = render::ImpostorList::Baked{
+			.impostors = {render::ImpostorList::BakedImpostor{
+				.mesh_index = 0,
+				.center = glm::vec3(0.5f),
+				.radius = 1.0f,
+				.frame_count = 2,
+				.frame_size = 2
+			}},
+			.texels = std::vector<glm::u8vec4>(2 * 4 * 4, glm::u8vec4(1, 2, 3, 4))
+		}
+	};
+}
+
+static std::filesystem::path get_cache_path()
+{
+	const auto os_tempdir = std::getenv("TEMP_DIR");
+	REQUIRE(os_tempdir != nullptr);
+	return std::filesystem::path(os_tempdir) / "render-model-cache-test" / "model.vrtcache";
+}
+
+// NOLINTEND
+
+TEST_CASE("Round trip")
+{
+	const auto baked = create_baked_model();
+	const auto baked_view = baked.view();
+	const auto path = get_cache_path();
+	const auto key = render::ModelCache::get_key(0x1234, render::Model::Option());
+
+	const auto write_result = render::ModelCache::write(path, key, baked_view);
+	EXPECT_SUCCESS(write_result);
+
+	auto cache_result = render::ModelCache::open(path, key);
+	EXPECT_SUCCESS(cache_result);
+	const auto& view = cache_result->view();
+
+	REQUIRE_EQ(view.nodes.size(), 2);
+	CHECK_EQ(view.nodes[0].data.mesh_index, 0);
+	CHECK_FALSE(view.nodes[0].parent_index.has_value());
+	CHECK_EQ(view.materials.size(), 1);
+
+	REQUIRE_EQ(view.textures.size(), 1);
+	REQUIRE(view.textures[0].color.has_value());
+	CHECK_FALSE(view.textures[0].normal.has_value());
+	CHECK_EQ(view.textures[0].sample_mode, baked_view.textures[0].sample_mode);
+
+	const auto& color = *view.textures[0].color;
+	const auto& source_color = *baked_view.textures[0].color;
+	CHECK_EQ(color.format, render::Texture::Format::BC7);
+	CHECK_EQ(color.min_alpha, source_color.min_alpha);
+	CHECK_EQ(color.levels.size(), source_color.levels.size());
+	CHECK(std::ranges::equal(color.data, source_color.data));
+
+	CHECK_EQ(view.mesh.vertex_format, render::VertexFormat::Full);
+	CHECK_EQ(view.mesh.vertices.size(), 3);
+	CHECK_EQ(view.mesh.index_format, render::IndexFormat::Uint16);
+	CHECK(view.mesh.indices.empty());
+	CHECK(std::ranges::equal(view.mesh.short_indices, baked_view.mesh.short_indices));
+	CHECK_EQ(view.mesh.get_index(2), 2);
+	REQUIRE_EQ(view.mesh.primitive_attrs.size(), 1);
+	CHECK_EQ(view.mesh.primitive_attrs[0].material_index, 0);
+	CHECK_EQ(view.mesh.mesh_primitive_index_ranges.size(), 1);
+
+	REQUIRE_EQ(view.lights.size(), 1);
+	CHECK_EQ(view.nodes[0].data.light_index, 0);
+	CHECK_EQ(view.lights[0].type, model::LightType::Spot);
+	CHECK_EQ(view.lights[0].intensity, 10.0f);
+	CHECK_EQ(view.lights[0].range, 5.0f);
+
+	REQUIRE_EQ(view.hlod_clusters.size(), 1);
+	CHECK_EQ(view.hlod_clusters[0].proxy_node_index, 1);
+	CHECK_EQ(view.hlod_clusters[0].source_count, 1);
+	CHECK_EQ(view.hlod_clusters[0].aabb_max.x, 1.0f);
+	CHECK(std::ranges::equal(view.hlod_source_nodes, baked_view.hlod_source_nodes));
+
+	REQUIRE_EQ(view.impostor.impostors.size(), 1);
+	CHECK_EQ(view.impostor.impostors[0].mesh_index, 0);
+	CHECK_EQ(view.impostor.impostors[0].radius, 1.0f);
+	CHECK_EQ(view.impostor.impostors[0].frame_count, 2);
+	CHECK(std::ranges::equal(view.impostor.texels, baked_view.impostor.texels));
+}
+
+TEST_CASE("Compressed round trip")
+{
+	// Enough vertices for their blob to shrink, other blobs may be stored as-is
+	auto baked = create_baked_model();
+	baked.mesh.vertices = std::vector<model::FullVertex>(
+		4096,
+		{.position = {1.0f, 2.0f, 3.0f}, .texcoord = {}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {}}
+	);
+	const auto baked_view = baked.view();
+	const auto path = get_cache_path();
+	const auto key = render::ModelCache::get_key(0x1234, render::Model::Option());
+
+	const auto raw_write_result = render::ModelCache::write(path, key, baked_view);
+	EXPECT_SUCCESS(raw_write_result);
+	const auto raw_size = std::filesystem::file_size(path);
+
+	const auto write_result = render::ModelCache::write(path, key, baked_view, true);
+	EXPECT_SUCCESS(write_result);
+	CHECK_LT(std::filesystem::file_size(path), raw_size);
+
+	auto cache_result = render::ModelCache::open(path, key);
+	EXPECT_SUCCESS(cache_result);
+	const auto& view = cache_result->view();
+
+	CHECK_EQ(view.mesh.vertices.size(), baked_view.mesh.vertices.size());
+	CHECK(std::ranges::equal(util::as_bytes(view.mesh.vertices), util::as_bytes(baked_view.mesh.vertices)));
+	CHECK(std::ranges::equal(view.mesh.short_indices, baked_view.mesh.short_indices));
+	CHECK(std::ranges::equal(view.impostor.texels, baked_view.impostor.texels));
+
+	REQUIRE_EQ(view.textures.size(), 1);
+	REQUIRE(view.textures[0].color.has_value());
+	CHECK(std::ranges::equal(view.textures[0].color->data, baked_view.textures[0].color->data));
+}
+
+TEST_CASE("Invalidation")
+{
+	const auto baked = create_baked_model();
+	const auto path = get_cache_path();
+	const auto key = render::ModelCache::get_key(0x1234, render::Model::Option());
+
+	const auto write_result = render::ModelCache::write(path, key, baked.view());
+	EXPECT_SUCCESS(write_result);
+
+	SUBCASE("Source changed")
+	{
+		const auto other_key = render::ModelCache::get_key(0x5678, render::Model::Option());
+		const auto cache_result = render::ModelCache::open(path, other_key);
+		EXPECT_FAIL(cache_result);
+	}
+
+	SUBCASE("Option changed")
+	{
+		const auto other_key =
+			render::ModelCache::get_key(0x1234, render::Model::Option{.optimize_mesh = true});
+		const auto cache_result = render::ModelCache::open(path, other_key);
+		EXPECT_FAIL(cache_result);
+	}
+
+	SUBCASE("Truncated")
+	{
+		auto data_result = file::read(path);
+		EXPECT_SUCCESS(data_result);
+		data_result->resize(data_result->size() / 2);
+		const auto truncate_result = file::write(path, *data_result);
+		EXPECT_SUCCESS(truncate_result);
+
+		const auto cache_result = render::ModelCache::open(path, key);
+		EXPECT_FAIL(cache_result);
+	}
+
+	SUBCASE("Missing")
+	{
+		std::filesystem::remove(path);
+
+		const auto cache_result = render::ModelCache::open(path, key);
+		EXPECT_FAIL(cache_result);
+	}
+}
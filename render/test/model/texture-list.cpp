@@ -5,6 +5,7 @@
 #include <doctest.h>
 #include <filesystem>
 #include <span>
+#include <stop_token>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 
@@ -135,3 +136,57 @@ TEST_CASE("No exit on fail")
 
 	EXPECT_SUCCESS(texture_list_result);
 }
+
+TEST_CASE("GPU encode")
+{
+	const auto material_list = test::create_material_list();
+
+	auto texture_list_result = [&material_list] {
+		auto thread_pool = coro::thread_pool::make_unique();
+		const auto load_option = render::TextureList::LoadOption{
+			.color_load_strategy = render::Texture::ColorLoadStrategy::AllBC7,
+			.usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc,
+			.max_pending_data_size = 4 * 1048576,
+			.gpu_encode = true
+		};
+
+		return coro::sync_wait(
+			render::TextureList::create(
+				*thread_pool,
+				util::Progress(),
+				vulkan::get_test_context().get(),
+				material_list,
+				load_option
+			)
+		);
+	}();
+
+	EXPECT_SUCCESS(texture_list_result);
+	const auto texture_list = std::move(*texture_list_result);
+
+	const auto color_texture = texture_list.get_color_texture(0);
+	REQUIRE(color_texture.index.has_value());
+	CHECK_EQ(color_texture.texture.format, render::Texture::Format::BC7);
+	CHECK(color_texture.texture.min_alpha.has_value());
+}
+
+TEST_CASE("Stop before bake")
+{
+	const auto material_list = test::create_material_list();
+
+	auto stop_source = std::stop_source();
+	stop_source.request_stop();
+
+	auto thread_pool = coro::thread_pool::make_unique();
+	const auto bake_result = coro::sync_wait(
+		render::TextureList::bake(
+			*thread_pool,
+			util::Progress(),
+			material_list,
+			render::TextureList::LoadOption{},
+			stop_source.get_token()
+		)
+	);
+
+	EXPECT_FAIL(bake_result);
+}
@@ -1,4 +1,6 @@
 #include <doctest.h>
+#include <glm/ext/vector_uint4_sized.hpp>
+#include <ranges>
 #include <utility>
 
 #include "common/test-macro.hpp"
@@ -254,3 +256,46 @@ TEST_CASE("BalancedBC")
 	const auto upload_result_bal = resource_creator.execute_uploads(vulkan::get_test_context().get());
 	EXPECT_SUCCESS(upload_result_bal);
 }
+
+TEST_CASE("Adaptive")
+{
+	auto resource_creator_result = vulkan::StaticResourceCreator::create(vulkan::get_test_context().get());
+	EXPECT_SUCCESS(resource_creator_result);
+	auto resource_creator = std::move(*resource_creator_result);
+
+	// Adaptive: single-color textures collapse into 1x1 Unorm8
+
+	auto load_result_large_ada = render::Texture::load_color_texture(
+		vulkan::get_test_context().get(),
+		resource_creator,
+		texture_large,
+		render::Texture::ColorLoadStrategy::Adaptive
+	);
+	EXPECT_SUCCESS(load_result_large_ada);
+	auto loaded_texture_large_ada = std::move(*load_result_large_ada);
+	CHECK_EQ(loaded_texture_large_ada.format, render::Texture::Format::Rgba8Unorm);
+	CHECK_EQ(loaded_texture_large_ada.mipmap_levels, 1);
+
+	// Other textures are block-compressed
+
+	auto gradient_image = image::Image<image::Format::Unorm8, image::Layout::RGBA>({256, 256});
+	for (const auto [idx, pixel] : gradient_image.data | std::views::enumerate)
+		pixel = glm::u8vec4(idx % 256, idx / 256, 0x80, 0xFF);
+
+	auto load_result_gradient_ada = render::Texture::load_color_texture(
+		vulkan::get_test_context().get(),
+		resource_creator,
+		model::Texture{.source = gradient_image},
+		render::Texture::ColorLoadStrategy::Adaptive
+	);
+	EXPECT_SUCCESS(load_result_gradient_ada);
+	auto loaded_texture_gradient_ada = std::move(*load_result_gradient_ada);
+	CHECK(
+		(loaded_texture_gradient_ada.format == render::Texture::Format::BC3
+		 || loaded_texture_gradient_ada.format == render::Texture::Format::BC7)
+	);
+	CHECK_EQ(loaded_texture_gradient_ada.mipmap_levels, 7);
+
+	const auto upload_result_ada = resource_creator.execute_uploads(vulkan::get_test_context().get());
+	EXPECT_SUCCESS(upload_result_ada);
+}
@@ -0,0 +1,57 @@
+#include <array>
+#include <cstdint>
+#include <doctest.h>
+#include <ranges>
+#include <set>
+
+#include "model/hierarchy.hpp"
+#include "render/model/mesh.hpp"
+#include "render/model/tlas.hpp"
+
+TEST_CASE("Hit record offsets")
+{
+	constexpr uint32_t records_per_primitive = 2;  // e.g. primary and shadow rays
+
+	// Meshes of 2, 1 and 3 primitives
+	const auto mesh_ranges = std::to_array<render::PrimitiveIndexRange>({
+		{.offset = 0, .count = 2},
+		{.offset = 2, .count = 1},
+		{.offset = 3, .count = 3},
+	});
+
+	// Mesh 2 is instanced twice, mesh order differs from instance order
+	const auto renderables = std::to_array<model::Hierarchy::Drawcall>({
+		{.node_index = 0, .mesh_index = 2},
+		{.node_index = 1, .mesh_index = 0},
+		{.node_index = 3, .mesh_index = 2},
+		{.node_index = 4, .mesh_index = 1},
+	});
+
+	const auto offsets =
+		render::Tlas::get_hit_record_offsets(renderables, mesh_ranges, records_per_primitive);
+	REQUIRE_EQ(offsets.size(), renderables.size());
+
+	// Each instance points at the records of the first primitive of its mesh
+	CHECK_EQ(offsets[0], 6);
+	CHECK_EQ(offsets[1], 0);
+	CHECK_EQ(offsets[2], 6);
+	CHECK_EQ(offsets[3], 4);
+
+	// Record hit by a ray, `offset + geometry_index * records_per_primitive + ray_type`, is unique to each
+	// primitive and ray type, and all records of the table are reachable
+	std::set<uint32_t> records;
+	for (const auto [drawcall, offset] : std::views::zip(renderables, offsets))
+	{
+		const auto range = mesh_ranges[drawcall.mesh_index];
+		for (const auto geometry_index : std::views::iota(0u, range.count))
+			for (const auto ray_type : std::views::iota(0u, records_per_primitive))
+			{
+				const auto record = offset + geometry_index * records_per_primitive + ray_type;
+				CHECK_EQ(record, (range.offset + geometry_index) * records_per_primitive + ray_type);
+				records.insert(record);
+			}
+	}
+
+	CHECK_EQ(records.size(), 6 * records_per_primitive);
+	CHECK_EQ(*records.rbegin(), 6 * records_per_primitive - 1);
+}
@@ -0,0 +1,61 @@
+#include <cstddef>
+#include <doctest.h>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <utility>
+
+#include "common/test-macro.hpp"
+#include "render/resource/denoise.hpp"
+#include "render/resource/reflection.hpp"
+#include "vulkan/test-driver.hpp"
+
+TEST_CASE("Signal extent")
+{
+	const auto& context = vulkan::get_test_context().get();
+
+	// Odd extents round up, every pixel has a signal texel
+	auto reflection_result = render::ReflectionAttachment::create(context, {333, 201});
+	EXPECT_SUCCESS(reflection_result);
+	auto reflection = std::move(*reflection_result);
+
+	CHECK_EQ(reflection->extent, glm::u32vec2(167, 101));
+	CHECK_EQ(reflection->downscale, render::ReflectionAttachment::DOWNSCALE);
+
+	// Dispatch header, followed by room for every tile
+	const auto tile_count = size_t((167 + 7) / 8) * ((101 + 7) / 8);
+	CHECK_EQ(reflection->tile_list.count(), render::ReflectionAttachment::TILE_LIST_HEADER + tile_count);
+
+	CHECK(reflection.fits({333, 201}));
+	CHECK(reflection.fits({334, 202}));
+	CHECK_FALSE(reflection.fits({335, 201}));
+	CHECK_FALSE(reflection.fits({333, 203}));
+
+	reflection.set_extent({100, 51});
+	CHECK_EQ(reflection->extent, glm::u32vec2(50, 26));
+}
+
+TEST_CASE("Denoise pairing")
+{
+	const auto& context = vulkan::get_test_context().get();
+
+	auto reflection_result = render::ReflectionAttachment::create(context, {333, 201});
+	EXPECT_SUCCESS(reflection_result);
+	auto reflection = std::move(*reflection_result);
+
+	// The denoiser reads the signal texel by texel, both must agree on the extent at any render extent
+	auto denoise_result =
+		render::DenoiseAttachment::create(context, {333, 201}, render::ReflectionAttachment::DOWNSCALE);
+	EXPECT_SUCCESS(denoise_result);
+	auto denoise = std::move(*denoise_result);
+
+	CHECK_EQ(denoise->downscale, reflection->downscale);
+	CHECK_EQ(denoise->extent, reflection->extent);
+
+	for (const auto extent : {glm::u32vec2(333, 201), glm::u32vec2(1, 1), glm::u32vec2(257, 99)})
+	{
+		REQUIRE_EQ(denoise.fits(extent), reflection.fits(extent));
+
+		reflection.set_extent(extent);
+		denoise.set_extent(extent);
+		CHECK_EQ(denoise->extent, reflection->extent);
+	}
+}
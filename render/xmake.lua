@@ -22,6 +22,7 @@ target("render")
 		{public = true}
 	)
 	add_packages("libcoro", {public = true})
+	add_packages("mio")
 
 -- Common library for testing
 target("render.test.model.common")
@@ -47,4 +48,16 @@ target("render.test.model")
 
 	for _, testfile in ipairs(os.files("test/model/*.cpp")) do
 		add_tests(path.basename(testfile), {files = testfile})
+	end
+
+-- Unit tests for resource
+target("render.test.resource")
+	set_kind("binary")
+	set_default(false)
+
+	add_packages("doctest")
+	add_deps("render", "vulkan.test-driver")
+
+	for _, testfile in ipairs(os.files("test/resource/*.cpp")) do
+		add_tests(path.basename(testfile), {files = testfile})
 	end
\ No newline at end of file
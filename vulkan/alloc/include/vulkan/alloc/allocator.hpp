@@ -2,15 +2,20 @@
 
 #include "common/util/error.hpp"
 #include "vulkan/alloc/buffer.hpp"
+#include "vulkan/alloc/category.hpp"
+#include "vulkan/alloc/defragmentation.hpp"
 #include "vulkan/alloc/image.hpp"
+#include "vulkan/alloc/memory.hpp"
 #include "vulkan/alloc/wrapper.hpp"
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <memory>
 #include <span>
 #include <utility>
+#include <vector>
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_handles.hpp>
@@ -27,6 +32,16 @@ namespace vulkan
 		GpuOnly,
 		CpuToGpu,
 		GpuToCpu,
+		CpuToGpuDirect,  // Device-local and host-writable, see `Allocator::supports_direct_upload`
+	};
+
+	///
+	/// @brief Memory pool an allocation is placed into
+	///
+	enum class AllocationPool
+	{
+		Shared,     // Default pools, shared by all threads
+		PerThread,  // Pool of the calling thread, see `Allocator::create_image`
 	};
 
 	///
@@ -41,6 +56,24 @@ namespace vulkan
 	/// deconstruction. For buffers, there are also type-safe versions `ElementBuffer` and `ArrayBuffer` that
 	/// hold elements of type `T` and `T[]` respectively.
 	///
+	/// #### Accounting
+	/// Every allocation is tagged with a `MemoryCategory`, see `get_category_usage`. Per-heap budgets are
+	/// reported by the driver if `VK_EXT_memory_budget` is enabled, see `get_heap_budgets`.
+	///
+	/// #### Defragmentation
+	/// Images opted in through `Image::enable_relocation` can be compacted into fewer memory blocks, see
+	/// `begin_defragmentation`.
+	///
+	/// #### Per-Thread Pools
+	/// Allocations from the default pools of a memory type are serialized by VMA. Device-local images
+	/// created with `AllocationPool::PerThread` are instead placed into a pool of the calling thread, so
+	/// that the workers of a thread pool allocate concurrently. These images are never defragmented.
+	///
+	/// #### Direct Upload
+	/// On GPUs with resizable BAR or unified memory, device-local memory is host-writable in full. Buffers
+	/// created with `MemoryUsage::CpuToGpuDirect` can then be written by host in place, without a staging
+	/// copy, see `supports_direct_upload`.
+	///
 	class Allocator
 	{
 	  public:
@@ -51,13 +84,15 @@ namespace vulkan
 		/// @param instance Vulkan Instance
 		/// @param physical_device Vulkan Physical Device
 		/// @param device Vulkan Device
+		/// @param memory_budget Whether `VK_EXT_memory_budget` is enabled on @p device
 		/// @return An allocator or Error
 		///
 		[[nodiscard]]
 		static std::expected<Allocator, Error> create(
 			const vk::raii::Instance& instance,
 			const vk::raii::PhysicalDevice& physical_device,
-			const vk::raii::Device& device
+			const vk::raii::Device& device,
+			bool memory_budget = false
 		) noexcept;
 
 		///
@@ -65,12 +100,20 @@ namespace vulkan
 		///
 		/// @param create_info Vulkan create info
 		/// @param usage VMA memory usage
+		/// @param category Category the allocation is accounted to
+		/// @param debug_name Name of the image and its allocation in debug tools, copied. See
+		/// "vulkan/util/debug-utils.hpp"
+		/// @param pool Pool of the allocation, only `MemoryUsage::GpuOnly` images are placed into per-thread
+		/// pools. Falls back to the shared pools if the image doesn't fit the pool of the thread
 		/// @return An image or Error
 		///
 		[[nodiscard]]
 		std::expected<Image, Error> create_image(
 			const vk::ImageCreateInfo& create_info,
-			MemoryUsage usage
+			MemoryUsage usage,
+			MemoryCategory category = MemoryCategory::Other,
+			const char* debug_name = nullptr,
+			AllocationPool pool = AllocationPool::Shared
 		) const noexcept;
 
 		///
@@ -78,12 +121,51 @@ namespace vulkan
 		///
 		/// @param create_info Vulkan create info
 		/// @param usage VMA memory usage
+		/// @param category Category the allocation is accounted to
+		/// @param debug_name Name of the buffer and its allocation in debug tools, copied. See
+		/// "vulkan/util/debug-utils.hpp"
 		/// @return A buffer or Error
 		///
 		[[nodiscard]]
 		std::expected<Buffer, Error> create_buffer(
 			const vk::BufferCreateInfo& create_info,
-			MemoryUsage usage
+			MemoryUsage usage,
+			MemoryCategory category = MemoryCategory::Other,
+			const char* debug_name = nullptr
+		) const noexcept;
+
+		///
+		/// @brief Allocate device memory without binding it to any resource
+		///
+		/// @param requirements Combined memory requirements of all resources to be placed into the memory
+		/// @param usage VMA memory usage
+		/// @param category Category the allocation is accounted to
+		/// @return Allocated memory or Error
+		///
+		[[nodiscard]]
+		std::expected<Memory, Error> allocate_memory(
+			const vk::MemoryRequirements& requirements,
+			MemoryUsage usage,
+			MemoryCategory category = MemoryCategory::Other
+		) const noexcept;
+
+		///
+		/// @brief Create an image placed into existing memory, possibly aliasing other resources
+		/// @note Contents of the image are undefined whenever another resource aliasing the same range was
+		/// written after it, the image must be transitioned from `vk::ImageLayout::eUndefined` before use
+		///
+		/// @param device Vulkan device
+		/// @param memory Memory to place the image into
+		/// @param offset Offset of the image in @p memory, must satisfy the alignment of the image
+		/// @param create_info Vulkan create info
+		/// @return An image owning only the image handle, or Error
+		///
+		[[nodiscard]]
+		std::expected<vk::raii::Image, Error> create_aliasing_image(
+			const vk::raii::Device& device,
+			const Memory& memory,
+			vk::DeviceSize offset,
+			const vk::ImageCreateInfo& create_info
 		) const noexcept;
 
 		///
@@ -94,6 +176,8 @@ namespace vulkan
 		/// @param usage VMA memory usage
 		/// @param sharing_mode Vulkan buffer sharing mode
 		/// @param queue_family_indices Queue family indices for concurrent sharing mode
+		/// @param category Category the allocation is accounted to
+		/// @param debug_name Name of the buffer in debug tools, see `create_buffer`
 		/// @return An element buffer or Error
 		///
 		template <typename T>
@@ -102,7 +186,9 @@ namespace vulkan
 			vk::BufferUsageFlags usage_flags,
 			MemoryUsage usage,
 			vk::SharingMode sharing_mode = vk::SharingMode::eExclusive,
-			std::span<const uint32_t> queue_family_indices = {}
+			std::span<const uint32_t> queue_family_indices = {},
+			MemoryCategory category = MemoryCategory::Other,
+			const char* debug_name = nullptr
 		) const noexcept
 		{
 			auto buffer_result = create_buffer(
@@ -113,7 +199,9 @@ namespace vulkan
 					.queueFamilyIndexCount = static_cast<uint32_t>(queue_family_indices.size()),
 					.pQueueFamilyIndices = queue_family_indices.data(),
 				},
-				usage
+				usage,
+				category,
+				debug_name
 			);
 			if (!buffer_result) return buffer_result.error();
 			return ElementBuffer<T>(std::move(*buffer_result));
@@ -128,6 +216,8 @@ namespace vulkan
 		/// @param usage VMA memory usage
 		/// @param sharing_mode Vulkan buffer sharing mode
 		/// @param queue_family_indices Queue family indices for concurrent sharing mode
+		/// @param category Category the allocation is accounted to
+		/// @param debug_name Name of the buffer in debug tools, see `create_buffer`
 		/// @return An array buffer or Error
 		///
 		template <typename T>
@@ -137,7 +227,9 @@ namespace vulkan
 			vk::BufferUsageFlags usage_flags,
 			MemoryUsage usage,
 			vk::SharingMode sharing_mode = vk::SharingMode::eExclusive,
-			std::span<const uint32_t> queue_family_indices = {}
+			std::span<const uint32_t> queue_family_indices = {},
+			MemoryCategory category = MemoryCategory::Other,
+			const char* debug_name = nullptr
 		) const noexcept
 		{
 			auto buffer_result = create_buffer(
@@ -148,12 +240,108 @@ namespace vulkan
 					.queueFamilyIndexCount = static_cast<uint32_t>(queue_family_indices.size()),
 					.pQueueFamilyIndices = queue_family_indices.data(),
 				},
-				usage
+				usage,
+				category,
+				debug_name
 			);
 			if (!buffer_result) return buffer_result.error();
 			return ArrayBuffer<T>(std::move(*buffer_result), element_count);
 		}
 
+		///
+		/// @brief Memory usage summed over all device-local heaps
+		///
+		struct DeviceMemoryUsage
+		{
+			size_t allocation_bytes;  // Bytes occupied by live allocations made through this allocator
+			size_t usage_bytes;       // Bytes in use by the process, as reported by the driver if available
+			size_t budget_bytes;      // Bytes the process can allocate without degrading performance
+		};
+
+		///
+		/// @brief Query current device-local memory usage
+		/// @note Without `VK_EXT_memory_budget`, @p usage_bytes and @p budget_bytes are estimations by VMA
+		///
+		/// @return Current device-local memory usage
+		///
+		[[nodiscard]]
+		DeviceMemoryUsage get_device_memory_usage() const noexcept;
+
+		///
+		/// @brief Budget and usage of a memory heap
+		///
+		struct HeapBudget
+		{
+			bool device_local;        // Whether the heap is device-local
+			size_t heap_bytes;        // Total size of the heap
+			size_t allocation_bytes;  // Bytes occupied by live allocations made through this allocator
+			size_t usage_bytes;       // Bytes in use by the process, as reported by the driver if available
+			size_t budget_bytes;      // Bytes the process can allocate without degrading performance
+		};
+
+		///
+		/// @brief Query current budget and usage of each memory heap
+		/// @note Without `VK_EXT_memory_budget`, usage and budget are estimations by VMA
+		///
+		/// @return Budget of each heap, indexed by heap index
+		///
+		[[nodiscard]]
+		std::vector<HeapBudget> get_heap_budgets() const noexcept;
+
+		///
+		/// @brief Query live allocation bytes of each category
+		///
+		/// @return Allocation bytes, indexed by `MemoryCategory`
+		///
+		[[nodiscard]]
+		std::array<size_t, MEMORY_CATEGORY_COUNT> get_category_usage() const noexcept;
+
+		///
+		/// @brief Occupancy of the device-local memory blocks, summed over all device-local heaps
+		///
+		struct BlockUsage
+		{
+			size_t block_bytes;       // Bytes of the memory blocks allocated by VMA
+			size_t allocation_bytes;  // Bytes of the allocations placed in these blocks
+		};
+
+		///
+		/// @brief Query the occupancy of the device-local memory blocks
+		/// @details Free space inside blocks grows as allocations of mixed lifetimes come and go, see
+		/// `begin_defragmentation` to compact it
+		///
+		/// @return Block occupancy
+		///
+		[[nodiscard]]
+		BlockUsage get_device_block_usage() const noexcept;
+
+		///
+		/// @brief Begin an incremental defragmentation of the allocations
+		/// @note Only a single defragmentation may be in progress, it must not outlive the allocator
+		///
+		/// @param option Limits of each pass
+		/// @return Defragmentation, or Error
+		///
+		[[nodiscard]]
+		std::expected<Defragmentation, Error> begin_defragmentation(
+			Defragmentation::Option option = {}
+		) const noexcept;
+
+		///
+		/// @brief Whether usage and budget are reported by the driver through `VK_EXT_memory_budget`
+		///
+		[[nodiscard]]
+		bool has_memory_budget() const noexcept;
+
+		///
+		/// @brief Whether host-visible device-local memory is available beyond the legacy 256 MiB BAR window
+		/// @details If `true`, `MemoryUsage::CpuToGpuDirect` allocations are placed in device-local memory
+		/// and host writes to them bypass a staging copy. Otherwise they fall back to host memory, which is
+		/// still correct but read by the GPU over the bus, so staging is preferred.
+		///
+		[[nodiscard]]
+		bool supports_direct_upload() const noexcept;
+
 	  private:
 
 		std::unique_ptr<impl::AllocatorWrapper> wrapper;
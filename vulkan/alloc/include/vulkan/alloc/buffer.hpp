@@ -64,6 +64,39 @@ namespace vulkan
 		[[nodiscard]]
 		std::expected<void, Error> download(std::span<std::byte> data, size_t src_offset = 0) const noexcept;
 
+		///
+		/// @brief Get the persistently mapped memory of the buffer, to write data in place
+		/// @warning This function should be called if and only if the buffer is created mapped, i.e. with
+		/// `CpuToGpu`, `GpuToCpu` or `CpuToGpuDirect`. Write sequentially and avoid reading back, as the
+		/// memory may be write-combined. Call `flush` after writing.
+		///
+		/// @return Mapped memory, at least the size of the buffer
+		///
+		[[nodiscard]]
+		std::span<std::byte> mapped() const noexcept;
+
+		///
+		/// @brief Flush a range of mapped memory written in place, no-op if the memory is host-coherent
+		///
+		/// @param offset Offset of the range in buffer
+		/// @param size Size of the range in bytes
+		/// @return Void or Error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> flush(size_t offset, size_t size) const noexcept;
+
+		///
+		/// @brief Invalidate a range of mapped memory before reading device writes in place, no-op if the
+		/// memory is host-coherent
+		/// @note Only read mapped memory of `GpuToCpu` buffers in place, which is host-cached
+		///
+		/// @param offset Offset of the range in buffer
+		/// @param size Size of the range in bytes
+		/// @return Void or Error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> invalidate(size_t offset, size_t size) const noexcept;
+
 	  private:
 
 		std::unique_ptr<impl::BufferWrapper> wrapper;
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vulkan
+{
+	///
+	/// @brief Category of an allocation, for memory usage accounting
+	///
+	enum class MemoryCategory : uint8_t
+	{
+		Texture,                // Sampled images of models
+		Geometry,               // Vertex, index and meshlet buffers
+		AccelerationStructure,  // BLAS, TLAS and their build buffers
+		Attachment,             // Render targets
+		Staging,                // Intermediate resources of uploads, readbacks and copies
+		Other
+	};
+
+	static constexpr size_t MEMORY_CATEGORY_COUNT = static_cast<size_t>(MemoryCategory::Other) + 1;
+
+	///
+	/// @brief Get the display name of a memory category
+	///
+	[[nodiscard]]
+	constexpr std::string_view get_memory_category_name(MemoryCategory category) noexcept
+	{
+		switch (category)
+		{
+		case MemoryCategory::Texture:
+			return "Texture";
+		case MemoryCategory::Geometry:
+			return "Geometry";
+		case MemoryCategory::AccelerationStructure:
+			return "Acceleration Structure";
+		case MemoryCategory::Attachment:
+			return "Attachment";
+		case MemoryCategory::Staging:
+			return "Staging";
+		case MemoryCategory::Other:
+			return "Other";
+		}
+
+		return "Unknown";
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/wrapper.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <utility>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	class Allocator;
+
+	///
+	/// @brief Incremental defragmentation of the allocations of an allocator
+	/// @details Created by `Allocator::begin_defragmentation`. Each pass moves a bounded amount of
+	/// allocations into fewer memory blocks, releasing the blocks left empty. Only images opted in through
+	/// `Image::enable_relocation` are moved. Other allocations stay in place, as buffers are referenced by
+	/// device addresses and other images by views their owners don't track.
+	///
+	/// A pass:
+	/// 1. `record_pass` recreates the moved images at their destinations and records the copies
+	/// 2. The command buffer is submitted and waited for
+	/// 3. `end_pass` swaps the handles of the moved images and destroys the old ones, increasing their
+	/// generations (see `Image::get_generation`). Owners then recreate their views and descriptors.
+	///
+	/// @warning The moved images must not be used by the GPU from `record_pass` until `end_pass`, other than
+	/// by the recorded copies, e.g. run passes with the device idle
+	///
+	class Defragmentation
+	{
+	  public:
+
+		///
+		/// @brief Limits of a single pass
+		///
+		struct Option
+		{
+			size_t max_bytes_per_pass = 64 * 1048576;
+			uint32_t max_allocations_per_pass = 256;
+		};
+
+		///
+		/// @brief Statistics of a defragmentation
+		///
+		struct Stat
+		{
+			uint32_t pass_count;   // Count of ended passes
+			uint32_t moved_count;  // Count of moved images
+			size_t moved_bytes;    // Bytes of moved images
+			bool finished;         // Whether nothing is left to move
+		};
+
+		///
+		/// @brief Begin a pass, recording the copies of the moved images into @p command_buffer
+		///
+		/// @param device Vulkan device the allocator was created on
+		/// @param command_buffer Command buffer in recording state, of a queue supporting transfer
+		/// @return Whether a pass is begun, to be ended by `end_pass`. `false` once defragmentation is
+		/// finished, or Error
+		///
+		[[nodiscard]]
+		std::expected<bool, Error> record_pass(
+			const vk::raii::Device& device,
+			const vk::raii::CommandBuffer& command_buffer
+		) noexcept;
+
+		///
+		/// @brief End the pass begun by `record_pass`, once its copies have completed
+		/// @note No-op without a pass in progress
+		///
+		/// @param device Vulkan device the allocator was created on
+		/// @return `void` on success, or Error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> end_pass(const vk::raii::Device& device) noexcept;
+
+		///
+		/// @brief Get the statistics of the defragmentation
+		///
+		/// @return Statistics
+		///
+		[[nodiscard]]
+		Stat get_stat() const noexcept
+		{
+			return stat;
+		}
+
+	  private:
+
+		std::unique_ptr<impl::DefragmentationWrapper> wrapper;
+		Stat stat = {.pass_count = 0, .moved_count = 0, .moved_bytes = 0, .finished = false};
+
+		explicit Defragmentation(std::unique_ptr<impl::DefragmentationWrapper> wrapper) :
+			wrapper(std::move(wrapper))
+		{}
+
+		friend class ::vulkan::Allocator;
+
+	  public:
+
+		Defragmentation(const Defragmentation&) = delete;
+		Defragmentation(Defragmentation&&) = default;
+		Defragmentation& operator=(const Defragmentation&) = delete;
+		Defragmentation& operator=(Defragmentation&&) = default;
+	};
+}
@@ -2,6 +2,7 @@
 
 #include "vulkan/alloc/wrapper.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vk_mem_alloc.h>
@@ -25,6 +26,29 @@ namespace vulkan
 		operator vk::Image() const noexcept { return wrapper->image; }
 		vk::Image operator*() const noexcept { return wrapper->image; }
 
+		///
+		/// @brief Allow defragmentation to move the image, see `Defragmentation`
+		/// @details A moved image gets a new handle, with its content copied. Views and descriptors of the
+		/// image must then be recreated, check `get_generation` after each defragmentation pass. Images
+		/// lacking `eTransferSrc` or `eTransferDst` usage, with concurrent sharing or with a depth/stencil
+		/// aspect are never moved.
+		///
+		/// @param layout Layout of all subresources of the image between uses, kept when moved. Mustn't be
+		/// `eUndefined`
+		///
+		void enable_relocation(vk::ImageLayout layout) noexcept;
+
+		///
+		/// @brief Get the count of moves of the image by defragmentation
+		///
+		/// @return Generation, increased each time the handle changes
+		///
+		[[nodiscard]]
+		uint32_t get_generation() const noexcept
+		{
+			return wrapper->generation;
+		}
+
 	  private:
 
 		std::unique_ptr<impl::ImageWrapper> wrapper;
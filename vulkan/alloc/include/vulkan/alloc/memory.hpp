@@ -0,0 +1,38 @@
+#pragma once
+
+#include "vulkan/alloc/wrapper.hpp"
+
+#include <memory>
+#include <utility>
+#include <vk_mem_alloc.h>
+
+namespace vulkan
+{
+	class Allocator;
+
+	///
+	/// @brief Allocated device memory not bound to any resource, frees the memory on deconstruction
+	/// @details Resources are placed into the memory with `Allocator::create_aliasing_image`, multiple
+	/// resources may alias the same range as long as their usages don't overlap in time
+	/// @warning Resources placed into the memory must be destroyed before the memory itself
+	///
+	class Memory
+	{
+	  private:
+
+		std::unique_ptr<impl::MemoryWrapper> wrapper;
+
+		explicit Memory(std::unique_ptr<impl::MemoryWrapper> wrapper) :
+			wrapper(std::move(wrapper))
+		{}
+
+		friend class ::vulkan::Allocator;
+
+	  public:
+
+		Memory(const Memory&) = delete;
+		Memory(Memory&&) = default;
+		Memory& operator=(const Memory&) = delete;
+		Memory& operator=(Memory&&) = default;
+	};
+}
@@ -1,32 +1,123 @@
 #pragma once
 
+#include "common/util/profile.hpp"
+#include "vulkan/alloc/category.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <optional>
 #include <vk_mem_alloc.h>
+#include <vector>
 #include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
 
 namespace vulkan::impl
 {
 	struct AllocatorWrapper
 	{
 		VmaAllocator allocator;
+		bool memory_budget;  // Whether `VK_EXT_memory_budget` is enabled
+		bool direct_upload;  // Whether host-visible device-local memory is fully available
+
+		// Live allocation bytes of each `MemoryCategory`
+		std::array<std::atomic<size_t>, MEMORY_CATEGORY_COUNT> category_bytes = {};
+
+		// Count of per-thread image pools, threads beyond it share them round-robin
+		static constexpr size_t THREAD_POOL_COUNT = 16;
+
+		// Block size of per-thread pools, smaller than the default to bound the unused tail of each pool
+		static constexpr VkDeviceSize THREAD_POOL_BLOCK_SIZE = 64 * 1024 * 1024;
+
+		// Per-thread image pools, created on first use under `thread_pool_mutex`
+		std::array<std::atomic<VmaPool>, THREAD_POOL_COUNT> thread_pools = {};
+		std::mutex thread_pool_mutex;
 
-		AllocatorWrapper(VmaAllocator allocator) :
-			allocator(allocator)
+#ifdef VULKAN_DEBUG_UTILS
+		// Names created resources, null if the instance lacks `VK_EXT_debug_utils`
+		VkDevice device = VK_NULL_HANDLE;
+		PFN_vkSetDebugUtilsObjectNameEXT set_object_name = nullptr;
+#endif
+
+		AllocatorWrapper(VmaAllocator allocator, bool memory_budget, bool direct_upload) :
+			allocator(allocator),
+			memory_budget(memory_budget),
+			direct_upload(direct_upload)
 		{}
 
 		~AllocatorWrapper() noexcept;
 	};
 
+	// Profiler memory pool of all allocations, one definition so that its address is the same everywhere
+	inline constexpr const char* PROFILE_ALLOCATION_POOL = "Vulkan Allocations";
+
+	///
+	/// @brief Accounts the size of an allocation to its category during its lifetime
+	///
+	class CategoryUsage
+	{
+	  public:
+
+		CategoryUsage(std::atomic<size_t>& category_bytes, size_t size) noexcept :
+			category_bytes(category_bytes),
+			size(size)
+		{
+			category_bytes.fetch_add(size, std::memory_order_relaxed);
+			PROFILE_ALLOC(this, size, PROFILE_ALLOCATION_POOL);
+		}
+
+		~CategoryUsage() noexcept
+		{
+			PROFILE_FREE(this, PROFILE_ALLOCATION_POOL);
+			category_bytes.fetch_sub(size, std::memory_order_relaxed);
+		}
+
+	  private:
+
+		std::atomic<size_t>& category_bytes;
+		size_t size;
+
+	  public:
+
+		CategoryUsage(const CategoryUsage&) = delete;
+		CategoryUsage(CategoryUsage&&) = delete;
+		CategoryUsage& operator=(const CategoryUsage&) = delete;
+		CategoryUsage& operator=(CategoryUsage&&) = delete;
+	};
+
 	struct ImageWrapper
 	{
 		vk::Image image;
 		VmaAllocation allocation;
 		VmaAllocator allocator;
+		CategoryUsage category_usage;
+
+		// Create info of the image, without `pNext` and queue families. Recreates the image when relocated
+		vk::ImageCreateInfo create_info;
 
-		ImageWrapper(vk::Image image, VmaAllocation allocation, VmaAllocator allocator) :
+		// Layout the image is kept in between uses, set if defragmentation may relocate it
+		std::optional<vk::ImageLayout> relocation_layout = std::nullopt;
+		uint32_t generation = 0;  // Count of relocations
+
+		ImageWrapper(
+			vk::Image image,
+			VmaAllocation allocation,
+			VmaAllocator allocator,
+			std::atomic<size_t>& category_bytes,
+			size_t size,
+			const vk::ImageCreateInfo& create_info
+		) :
 			image(image),
 			allocation(allocation),
-			allocator(allocator)
-		{}
+			allocator(allocator),
+			category_usage(category_bytes, size),
+			create_info(create_info)
+		{
+			this->create_info.pNext = nullptr;
+			this->create_info.queueFamilyIndexCount = 0;
+			this->create_info.pQueueFamilyIndices = nullptr;
+		}
 
 		~ImageWrapper() noexcept;
 	};
@@ -36,13 +127,61 @@ namespace vulkan::impl
 		vk::Buffer buffer;
 		VmaAllocation allocation;
 		VmaAllocator allocator;
+		CategoryUsage category_usage;
 
-		BufferWrapper(vk::Buffer buffer, VmaAllocation allocation, VmaAllocator allocator) :
+		BufferWrapper(
+			vk::Buffer buffer,
+			VmaAllocation allocation,
+			VmaAllocator allocator,
+			std::atomic<size_t>& category_bytes,
+			size_t size
+		) :
 			buffer(buffer),
 			allocation(allocation),
-			allocator(allocator)
+			allocator(allocator),
+			category_usage(category_bytes, size)
 		{}
 
 		~BufferWrapper() noexcept;
 	};
+
+	struct MemoryWrapper
+	{
+		VmaAllocation allocation;
+		VmaAllocator allocator;
+		CategoryUsage category_usage;
+
+		MemoryWrapper(
+			VmaAllocation allocation,
+			VmaAllocator allocator,
+			std::atomic<size_t>& category_bytes,
+			size_t size
+		) :
+			allocation(allocation),
+			allocator(allocator),
+			category_usage(category_bytes, size)
+		{}
+
+		~MemoryWrapper() noexcept;
+	};
+
+	struct DefragmentationWrapper
+	{
+		VmaAllocator allocator;
+		VmaDefragmentationContext context;
+
+		// Moves of the pass in progress, owned by VMA until the pass ends
+		bool in_pass = false;
+		VmaDefragmentationPassMoveInfo pass = {};
+
+		// Images recreated at the destination of each move of the pass, null for ignored moves
+		std::vector<vk::raii::Image> relocated_images;
+
+		DefragmentationWrapper(VmaAllocator allocator, VmaDefragmentationContext context) :
+			allocator(allocator),
+			context(context)
+		{}
+
+		~DefragmentationWrapper() noexcept;
+	};
 }
@@ -1,11 +1,24 @@
 #include "vulkan/alloc/allocator.hpp"
 #include "common/util/error.hpp"
+#include "common/util/profile.hpp"
 #include "vulkan/alloc/buffer.hpp"
+#include "vulkan/alloc/category.hpp"
+#include "vulkan/alloc/defragmentation.hpp"
 #include "vulkan/alloc/image.hpp"
+#include "vulkan/alloc/memory.hpp"
 #include "vulkan/alloc/wrapper.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <memory>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_core.h>
 #include <vulkan/vulkan_raii.hpp>
@@ -34,15 +47,129 @@ namespace vulkan
 			create_info.flags =
 				VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
 			break;
+
+		case MemoryUsage::CpuToGpuDirect:
+			create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+			create_info.flags =
+				VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+			create_info.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			break;
 		}
 
 		return create_info;
 	}
 
+	// Check for a host-visible device-local memory type whose heap exceeds the legacy 256 MiB BAR window,
+	// which is the case with resizable BAR enabled and on unified memory architectures
+	static bool detect_direct_upload(const VkPhysicalDeviceMemoryProperties& properties) noexcept
+	{
+		constexpr VkDeviceSize LEGACY_BAR_SIZE = 256zu << 20;
+		constexpr VkMemoryPropertyFlags REQUIRED_FLAGS =
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+		const auto memory_types = std::span(properties.memoryTypes, properties.memoryTypeCount);
+
+		return std::ranges::any_of(memory_types, [&properties](const VkMemoryType& type) {
+			const auto& heap = properties.memoryHeaps[type.heapIndex];
+			return (type.propertyFlags & REQUIRED_FLAGS) == REQUIRED_FLAGS && heap.size > LEGACY_BAR_SIZE;
+		});
+	}
+
+	// Device memory blocks as seen by the driver, individual allocations are tracked by `impl::CategoryUsage`
+	[[maybe_unused]] static constexpr const char* DEVICE_MEMORY_POOL = "Vulkan Device Memory";
+
+	static void VKAPI_PTR on_allocate_device_memory(
+		[[maybe_unused]] VmaAllocator allocator,
+		[[maybe_unused]] uint32_t memory_type,
+		[[maybe_unused]] VkDeviceMemory memory,
+		[[maybe_unused]] VkDeviceSize size,
+		[[maybe_unused]] void* user_data
+	) noexcept
+	{
+		PROFILE_ALLOC(reinterpret_cast<void*>(memory), size, DEVICE_MEMORY_POOL);
+	}
+
+	static void VKAPI_PTR on_free_device_memory(
+		[[maybe_unused]] VmaAllocator allocator,
+		[[maybe_unused]] uint32_t memory_type,
+		[[maybe_unused]] VkDeviceMemory memory,
+		[[maybe_unused]] VkDeviceSize size,
+		[[maybe_unused]] void* user_data
+	) noexcept
+	{
+		PROFILE_FREE(reinterpret_cast<void*>(memory), DEVICE_MEMORY_POOL);
+	}
+
+	// Name a created resource and its allocation, no-op unless debug utils are enabled and available
+	static void set_debug_name(
+		[[maybe_unused]] const impl::AllocatorWrapper& wrapper,
+		[[maybe_unused]] VkObjectType object_type,
+		[[maybe_unused]] uint64_t handle,
+		[[maybe_unused]] VmaAllocation allocation,
+		[[maybe_unused]] const char* name
+	) noexcept
+	{
+#ifdef VULKAN_DEBUG_UTILS
+		if (name == nullptr) return;
+
+		vmaSetAllocationName(wrapper.allocator, allocation, name);
+		if (wrapper.set_object_name == nullptr) return;
+
+		const auto name_info = VkDebugUtilsObjectNameInfoEXT{
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+			.pNext = nullptr,
+			.objectType = object_type,
+			.objectHandle = handle,
+			.pObjectName = name,
+		};
+		wrapper.set_object_name(wrapper.device, &name_info);
+#endif
+	}
+
+	// Pool of the calling thread for images like @p create_info, null if it can't be created
+	static VmaPool get_thread_pool(
+		impl::AllocatorWrapper& wrapper,
+		const VkImageCreateInfo& create_info,
+		const VmaAllocationCreateInfo& allocation_create_info
+	) noexcept
+	{
+		static std::atomic<size_t> next_thread_index = 0;
+		thread_local const size_t thread_index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+
+		auto& slot = wrapper.thread_pools[thread_index % impl::AllocatorWrapper::THREAD_POOL_COUNT];
+		if (const auto pool = slot.load(std::memory_order_acquire); pool != VK_NULL_HANDLE) return pool;
+
+		const auto lock = std::scoped_lock(wrapper.thread_pool_mutex);
+		if (const auto pool = slot.load(std::memory_order_relaxed); pool != VK_NULL_HANDLE) return pool;
+
+		// Memory type of the first image, later images of incompatible types fall back to the shared pools
+		uint32_t memory_type;
+		if (vmaFindMemoryTypeIndexForImageInfo(
+				wrapper.allocator,
+				&create_info,
+				&allocation_create_info,
+				&memory_type
+			)
+			!= VK_SUCCESS)
+			return VK_NULL_HANDLE;
+
+		auto pool_create_info = VmaPoolCreateInfo{};
+		pool_create_info.memoryTypeIndex = memory_type;
+		pool_create_info.blockSize = impl::AllocatorWrapper::THREAD_POOL_BLOCK_SIZE;
+		pool_create_info.priority = allocation_create_info.priority;
+
+		VmaPool pool;
+		if (vmaCreatePool(wrapper.allocator, &pool_create_info, &pool) != VK_SUCCESS) return VK_NULL_HANDLE;
+
+		slot.store(pool, std::memory_order_release);
+		return pool;
+	}
+
 	std::expected<Allocator, Error> Allocator::create(
 		const vk::raii::Instance& instance,
 		const vk::raii::PhysicalDevice& physical_device,
-		const vk::raii::Device& device
+		const vk::raii::Device& device,
+		bool memory_budget
 	) noexcept
 	{
 		auto create_info = VmaAllocatorCreateInfo{};
@@ -53,65 +180,287 @@ namespace vulkan
 
 		create_info.vulkanApiVersion = vk::ApiVersion14;
 		create_info.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+		if (memory_budget) create_info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 
 		create_info.physicalDevice = *physical_device;
 		create_info.device = *device;
 		create_info.instance = *instance;
 		create_info.pVulkanFunctions = &vma_vulkan_funcs;
 
+		const auto device_memory_callbacks = VmaDeviceMemoryCallbacks{
+			.pfnAllocate = on_allocate_device_memory,
+			.pfnFree = on_free_device_memory,
+			.pUserData = nullptr,
+		};
+		create_info.pDeviceMemoryCallbacks = &device_memory_callbacks;
+
 		VmaAllocator allocator;
 		const auto result = vmaCreateAllocator(&create_info, &allocator);
 		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
 
-		return Allocator(std::make_unique<impl::AllocatorWrapper>(allocator));
+		const VkPhysicalDeviceMemoryProperties* memory_properties;
+		vmaGetMemoryProperties(allocator, &memory_properties);
+		const auto direct_upload = detect_direct_upload(*memory_properties);
+
+		auto wrapper = std::make_unique<impl::AllocatorWrapper>(allocator, memory_budget, direct_upload);
+
+#ifdef VULKAN_DEBUG_UTILS
+		// Not loaded if the instance lacks `VK_EXT_debug_utils`
+		wrapper->device = *device;
+		wrapper->set_object_name = device.getDispatcher()->vkSetDebugUtilsObjectNameEXT;
+#endif
+
+		return Allocator(std::move(wrapper));
 	}
 
 	std::expected<Image, Error> Allocator::create_image(
 		const vk::ImageCreateInfo& create_info,
-		MemoryUsage usage
+		MemoryUsage usage,
+		MemoryCategory category,
+		const char* debug_name,
+		AllocationPool pool
 	) const noexcept
 	{
 		const VkImageCreateInfo create_info_c = create_info;
-		const auto allocation_info = get_allocation_create_info(usage);
+		const auto allocation_create_info = get_allocation_create_info(usage);
 
 		VkImage image;
 		VmaAllocation allocation;
+		VmaAllocationInfo allocation_info;
 
-		const auto result = vmaCreateImage(
-			wrapper->allocator,
-			&create_info_c,
-			&allocation_info,
-			&image,
-			&allocation,
-			nullptr
-		);
+		const auto create = [&](const VmaAllocationCreateInfo& info) {
+			return vmaCreateImage(
+				wrapper->allocator,
+				&create_info_c,
+				&info,
+				&image,
+				&allocation,
+				&allocation_info
+			);
+		};
+
+		VkResult result = VK_ERROR_FEATURE_NOT_PRESENT;
+
+		// Fails if the memory type of the pool doesn't suit the image, or the image exceeds a block
+		if (pool == AllocationPool::PerThread && usage == MemoryUsage::GpuOnly)
+		{
+			auto pool_allocation_info = allocation_create_info;
+			pool_allocation_info.pool = get_thread_pool(*wrapper, create_info_c, allocation_create_info);
+			if (pool_allocation_info.pool != VK_NULL_HANDLE) result = create(pool_allocation_info);
+		}
+
+		if (result != VK_SUCCESS) result = create(allocation_create_info);
 		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
 
-		return Image(std::make_unique<impl::ImageWrapper>(image, allocation, wrapper->allocator));
+		const auto handle = reinterpret_cast<uint64_t>(image);
+		set_debug_name(*wrapper, VK_OBJECT_TYPE_IMAGE, handle, allocation, debug_name);
+
+		return Image(
+			std::make_unique<impl::ImageWrapper>(
+				image,
+				allocation,
+				wrapper->allocator,
+				wrapper->category_bytes[static_cast<size_t>(category)],
+				allocation_info.size,
+				create_info
+			)
+		);
 	}
 
 	std::expected<Buffer, Error> Allocator::create_buffer(
 		const vk::BufferCreateInfo& create_info,
-		MemoryUsage usage
+		MemoryUsage usage,
+		MemoryCategory category,
+		const char* debug_name
 	) const noexcept
 	{
 		const VkBufferCreateInfo create_info_c = create_info;
-		const auto allocation_info = get_allocation_create_info(usage);
+		const auto allocation_create_info = get_allocation_create_info(usage);
 
 		VkBuffer buffer;
 		VmaAllocation allocation;
+		VmaAllocationInfo allocation_info;
 
 		const auto result = vmaCreateBuffer(
 			wrapper->allocator,
 			&create_info_c,
-			&allocation_info,
+			&allocation_create_info,
 			&buffer,
 			&allocation,
-			nullptr
+			&allocation_info
+		);
+		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
+
+		const auto handle = reinterpret_cast<uint64_t>(buffer);
+		set_debug_name(*wrapper, VK_OBJECT_TYPE_BUFFER, handle, allocation, debug_name);
+
+		return Buffer(
+			std::make_unique<impl::BufferWrapper>(
+				buffer,
+				allocation,
+				wrapper->allocator,
+				wrapper->category_bytes[static_cast<size_t>(category)],
+				allocation_info.size
+			)
+		);
+	}
+
+	std::expected<Memory, Error> Allocator::allocate_memory(
+		const vk::MemoryRequirements& requirements,
+		MemoryUsage usage,
+		MemoryCategory category
+	) const noexcept
+	{
+		const VkMemoryRequirements requirements_c = requirements;
+		const auto allocation_create_info = get_allocation_create_info(usage);
+
+		VmaAllocation allocation;
+		VmaAllocationInfo allocation_info;
+
+		const auto result = vmaAllocateMemory(
+			wrapper->allocator,
+			&requirements_c,
+			&allocation_create_info,
+			&allocation,
+			&allocation_info
+		);
+		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
+
+		return Memory(
+			std::make_unique<impl::MemoryWrapper>(
+				allocation,
+				wrapper->allocator,
+				wrapper->category_bytes[static_cast<size_t>(category)],
+				allocation_info.size
+			)
+		);
+	}
+
+	std::expected<vk::raii::Image, Error> Allocator::create_aliasing_image(
+		const vk::raii::Device& device,
+		const Memory& memory,
+		vk::DeviceSize offset,
+		const vk::ImageCreateInfo& create_info
+	) const noexcept
+	{
+		const VkImageCreateInfo create_info_c = create_info;
+
+		VkImage image;
+
+		const auto result = vmaCreateAliasingImage2(
+			wrapper->allocator,
+			memory.wrapper->allocation,
+			offset,
+			&create_info_c,
+			&image
 		);
 		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
 
-		return Buffer(std::make_unique<impl::BufferWrapper>(buffer, allocation, wrapper->allocator));
+		return vk::raii::Image(device, image);
 	}
 
+	Allocator::DeviceMemoryUsage Allocator::get_device_memory_usage() const noexcept
+	{
+		const VkPhysicalDeviceMemoryProperties* memory_properties = nullptr;
+		vmaGetMemoryProperties(wrapper->allocator, &memory_properties);
+
+		auto budgets = std::array<VmaBudget, VK_MAX_MEMORY_HEAPS>{};
+		vmaGetHeapBudgets(wrapper->allocator, budgets.data());
+
+		auto usage = DeviceMemoryUsage{.allocation_bytes = 0, .usage_bytes = 0, .budget_bytes = 0};
+
+		for (const auto heap_idx : std::views::iota(0u, memory_properties->memoryHeapCount))
+		{
+			if ((memory_properties->memoryHeaps[heap_idx].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0)
+				continue;
+
+			usage.allocation_bytes += budgets[heap_idx].statistics.allocationBytes;
+			usage.usage_bytes += budgets[heap_idx].usage;
+			usage.budget_bytes += budgets[heap_idx].budget;
+		}
+
+		return usage;
+	}
+
+	Allocator::BlockUsage Allocator::get_device_block_usage() const noexcept
+	{
+		const VkPhysicalDeviceMemoryProperties* memory_properties = nullptr;
+		vmaGetMemoryProperties(wrapper->allocator, &memory_properties);
+
+		auto budgets = std::array<VmaBudget, VK_MAX_MEMORY_HEAPS>{};
+		vmaGetHeapBudgets(wrapper->allocator, budgets.data());
+
+		auto usage = BlockUsage{.block_bytes = 0, .allocation_bytes = 0};
+
+		for (const auto heap_idx : std::views::iota(0u, memory_properties->memoryHeapCount))
+		{
+			if ((memory_properties->memoryHeaps[heap_idx].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0)
+				continue;
+
+			usage.block_bytes += budgets[heap_idx].statistics.blockBytes;
+			usage.allocation_bytes += budgets[heap_idx].statistics.allocationBytes;
+		}
+
+		return usage;
+	}
+
+	std::expected<Defragmentation, Error> Allocator::begin_defragmentation(
+		Defragmentation::Option option
+	) const noexcept
+	{
+		const auto info = VmaDefragmentationInfo{
+			.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+			.pool = VK_NULL_HANDLE,
+			.maxBytesPerPass = option.max_bytes_per_pass,
+			.maxAllocationsPerPass = option.max_allocations_per_pass,
+			.pfnBreakCallback = nullptr,
+			.pBreakCallbackUserData = nullptr
+		};
+
+		VmaDefragmentationContext context;
+		const auto result = vmaBeginDefragmentation(wrapper->allocator, &info, &context);
+		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
+
+		return Defragmentation(std::make_unique<impl::DefragmentationWrapper>(wrapper->allocator, context));
+	}
+
+	std::vector<Allocator::HeapBudget> Allocator::get_heap_budgets() const noexcept
+	{
+		const VkPhysicalDeviceMemoryProperties* memory_properties = nullptr;
+		vmaGetMemoryProperties(wrapper->allocator, &memory_properties);
+
+		auto budgets = std::array<VmaBudget, VK_MAX_MEMORY_HEAPS>{};
+		vmaGetHeapBudgets(wrapper->allocator, budgets.data());
+
+		return std::views::iota(0u, memory_properties->memoryHeapCount)
+			| std::views::transform([memory_properties, &budgets](uint32_t heap_idx) {
+				  const auto& heap = memory_properties->memoryHeaps[heap_idx];
+				  return HeapBudget{
+					  .device_local = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0,
+					  .heap_bytes = heap.size,
+					  .allocation_bytes = budgets[heap_idx].statistics.allocationBytes,
+					  .usage_bytes = budgets[heap_idx].usage,
+					  .budget_bytes = budgets[heap_idx].budget
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+	}
+
+	std::array<size_t, MEMORY_CATEGORY_COUNT> Allocator::get_category_usage() const noexcept
+	{
+		auto usage = std::array<size_t, MEMORY_CATEGORY_COUNT>{};
+		for (const auto [bytes, category_bytes] : std::views::zip(usage, wrapper->category_bytes))
+			bytes = category_bytes.load(std::memory_order_relaxed);
+		return usage;
+	}
+
+	bool Allocator::has_memory_budget() const noexcept
+	{
+		return wrapper->memory_budget;
+	}
+
+	bool Allocator::supports_direct_upload() const noexcept
+	{
+		return wrapper->direct_upload;
+	}
 }
@@ -4,6 +4,7 @@
 
 #include <cstddef>
 #include <expected>
+#include <libassert/assert.hpp>
 #include <span>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_core.h>
@@ -38,4 +39,27 @@ namespace vulkan
 		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
 		return {};
 	}
+
+	std::span<std::byte> Buffer::mapped() const noexcept
+	{
+		VmaAllocationInfo info;
+		vmaGetAllocationInfo(wrapper->allocator, wrapper->allocation, &info);
+		ASSERT(info.pMappedData != nullptr && "Buffer is not mapped");
+
+		return {static_cast<std::byte*>(info.pMappedData), static_cast<size_t>(info.size)};
+	}
+
+	std::expected<void, Error> Buffer::flush(size_t offset, size_t size) const noexcept
+	{
+		const auto result = vmaFlushAllocation(wrapper->allocator, wrapper->allocation, offset, size);
+		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
+		return {};
+	}
+
+	std::expected<void, Error> Buffer::invalidate(size_t offset, size_t size) const noexcept
+	{
+		const auto result = vmaInvalidateAllocation(wrapper->allocator, wrapper->allocation, offset, size);
+		if (result != VK_SUCCESS) return Error::from(static_cast<vk::Result>(result));
+		return {};
+	}
 }
@@ -0,0 +1,206 @@
+#include "vulkan/alloc/defragmentation.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/wrapper.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <ranges>
+#include <span>
+#include <vector>
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	// Image moved by a defragmentation move, null if the allocation isn't relocatable
+	static impl::ImageWrapper* get_relocatable_image(
+		VmaAllocator allocator,
+		const VmaDefragmentationMove& move
+	) noexcept
+	{
+		VmaAllocationInfo allocation_info;
+		vmaGetAllocationInfo(allocator, move.srcAllocation, &allocation_info);
+
+		// User data is only set by `Image::enable_relocation`
+		return static_cast<impl::ImageWrapper*>(allocation_info.pUserData);
+	}
+
+	static void record_copy(
+		const vk::raii::CommandBuffer& command_buffer,
+		const impl::ImageWrapper& image,
+		vk::Image new_image
+	) noexcept
+	{
+		const auto& create_info = image.create_info;
+		const auto layout = *image.relocation_layout;
+
+		const auto subresource_range = vk::ImageSubresourceRange{
+			.aspectMask = vk::ImageAspectFlagBits::eColor,
+			.baseMipLevel = 0,
+			.levelCount = vk::RemainingMipLevels,
+			.baseArrayLayer = 0,
+			.layerCount = vk::RemainingArrayLayers
+		};
+
+		const auto pre_barriers = std::array{
+			vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+				.srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eCopy,
+				.dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+				.oldLayout = layout,
+				.newLayout = vk::ImageLayout::eTransferSrcOptimal,
+				.image = image.image,
+				.subresourceRange = subresource_range
+			},
+			vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eNone,
+				.srcAccessMask = vk::AccessFlagBits2::eNone,
+				.dstStageMask = vk::PipelineStageFlagBits2::eCopy,
+				.dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+				.oldLayout = vk::ImageLayout::eUndefined,
+				.newLayout = vk::ImageLayout::eTransferDstOptimal,
+				.image = new_image,
+				.subresourceRange = subresource_range
+			},
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barriers));
+
+		const auto regions =
+			std::views::iota(0u, create_info.mipLevels)
+			| std::views::transform([&create_info](uint32_t level) {
+				  const auto subresource = vk::ImageSubresourceLayers{
+					  .aspectMask = vk::ImageAspectFlagBits::eColor,
+					  .mipLevel = level,
+					  .baseArrayLayer = 0,
+					  .layerCount = create_info.arrayLayers
+				  };
+				  const auto extent = vk::Extent3D{
+					  .width = std::max(create_info.extent.width >> level, 1u),
+					  .height = std::max(create_info.extent.height >> level, 1u),
+					  .depth = std::max(create_info.extent.depth >> level, 1u)
+				  };
+
+				  return vk::ImageCopy{
+					  .srcSubresource = subresource,
+					  .srcOffset = {0, 0, 0},
+					  .dstSubresource = subresource,
+					  .dstOffset = {0, 0, 0},
+					  .extent = extent
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+		command_buffer.copyImage(
+			image.image,
+			vk::ImageLayout::eTransferSrcOptimal,
+			new_image,
+			vk::ImageLayout::eTransferDstOptimal,
+			regions
+		);
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+			.dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
+			.oldLayout = vk::ImageLayout::eTransferDstOptimal,
+			.newLayout = layout,
+			.image = new_image,
+			.subresourceRange = subresource_range
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
+	}
+
+	std::expected<bool, Error> Defragmentation::record_pass(
+		const vk::raii::Device& device,
+		const vk::raii::CommandBuffer& command_buffer
+	) noexcept
+	{
+		if (wrapper->in_pass) return Error("Defragmentation pass already in progress");
+		if (stat.finished) return false;
+
+		auto pass = VmaDefragmentationPassMoveInfo{};
+		const auto begin_result = vmaBeginDefragmentationPass(wrapper->allocator, wrapper->context, &pass);
+		if (begin_result == VK_SUCCESS)
+		{
+			stat.finished = true;
+			return false;
+		}
+		if (begin_result != VK_INCOMPLETE) return Error::from(static_cast<vk::Result>(begin_result));
+
+		wrapper->in_pass = true;
+		wrapper->pass = pass;
+		wrapper->relocated_images.clear();
+
+		for (auto& move : std::span(pass.pMoves, pass.moveCount))
+		{
+			// Moves of non-relocatable allocations are ignored, VMA then leaves them in place
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+			auto& relocated_image = wrapper->relocated_images.emplace_back(nullptr);
+
+			const auto* const image = get_relocatable_image(wrapper->allocator, move);
+			if (image == nullptr) continue;
+
+			// Failing to recreate only keeps the image in place
+			auto image_result = device.createImage(image->create_info);
+			if (!image_result) continue;
+
+			const auto bind_result = vmaBindImageMemory(
+				wrapper->allocator,
+				move.dstTmpAllocation,
+				static_cast<VkImage>(**image_result)
+			);
+			if (bind_result != VK_SUCCESS) continue;
+
+			record_copy(command_buffer, *image, **image_result);
+
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+			relocated_image = std::move(*image_result);
+		}
+
+		return true;
+	}
+
+	std::expected<void, Error> Defragmentation::end_pass(const vk::raii::Device& device) noexcept
+	{
+		if (!wrapper->in_pass) return {};
+
+		auto& pass = wrapper->pass;
+		const auto moves = std::span(pass.pMoves, pass.moveCount);
+
+		for (auto [move, relocated_image] : std::views::zip(moves, wrapper->relocated_images))
+		{
+			if (move.operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY) continue;
+
+			auto* const image = get_relocatable_image(wrapper->allocator, move);
+
+			VmaAllocationInfo allocation_info;
+			vmaGetAllocationInfo(wrapper->allocator, move.srcAllocation, &allocation_info);
+
+			// VMA rebinds the allocation to the destination when the pass ends, the old image is destroyed
+			const auto old_image = vk::raii::Image(device, static_cast<VkImage>(image->image));
+			image->image = relocated_image.release();
+			image->generation++;
+
+			stat.moved_count++;
+			stat.moved_bytes += allocation_info.size;
+		}
+
+		const auto end_result = vmaEndDefragmentationPass(wrapper->allocator, wrapper->context, &pass);
+
+		wrapper->in_pass = false;
+		wrapper->pass = {};
+		wrapper->relocated_images.clear();
+		stat.pass_count++;
+
+		if (end_result == VK_SUCCESS)
+			stat.finished = true;
+		else if (end_result != VK_INCOMPLETE)
+			return Error::from(static_cast<vk::Result>(end_result));
+
+		return {};
+	}
+}
@@ -0,0 +1,23 @@
+#include "vulkan/alloc/image.hpp"
+#include "vulkan/alloc/wrapper.hpp"
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.hpp>
+
+namespace vulkan
+{
+	void Image::enable_relocation(vk::ImageLayout layout) noexcept
+	{
+		const auto& create_info = wrapper->create_info;
+
+		// Copies need both transfer usages, and address the color aspect of a single queue family
+		constexpr auto copy_usage =
+			vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
+		if ((create_info.usage & copy_usage) != copy_usage) return;
+		if (create_info.usage & vk::ImageUsageFlagBits::eDepthStencilAttachment) return;
+		if (create_info.sharingMode != vk::SharingMode::eExclusive) return;
+
+		wrapper->relocation_layout = layout;
+		vmaSetAllocationUserData(wrapper->allocator, wrapper->allocation, wrapper.get());
+	}
+}
@@ -1,9 +1,16 @@
 #include "vulkan/alloc/wrapper.hpp"
 
+#include <atomic>
+#include <span>
+
 namespace vulkan::impl
 {
 	AllocatorWrapper::~AllocatorWrapper() noexcept
 	{
+		for (const auto& pool : thread_pools)
+			if (const auto handle = pool.load(std::memory_order_relaxed); handle != VK_NULL_HANDLE)
+				vmaDestroyPool(allocator, handle);
+
 		vmaDestroyAllocator(allocator);
 	}
 
@@ -16,4 +23,22 @@ namespace vulkan::impl
 	{
 		vmaDestroyBuffer(allocator, buffer, allocation);
 	}
+
+	MemoryWrapper::~MemoryWrapper() noexcept
+	{
+		vmaFreeMemory(allocator, allocation);
+	}
+
+	DefragmentationWrapper::~DefragmentationWrapper() noexcept
+	{
+		// Abandoned pass, the recreated images are dropped and the moved images stay in place
+		if (in_pass)
+		{
+			for (auto& move : std::span(pass.pMoves, pass.moveCount))
+				move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+			vmaEndDefragmentationPass(allocator, context, &pass);
+		}
+
+		vmaEndDefragmentation(allocator, context, nullptr);
+	}
 }
@@ -4,9 +4,11 @@
 #include "vulkan/alloc/image.hpp"
 #include "vulkan/interface/attachment.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <glm/glm.hpp>
+#include <span>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -30,6 +32,11 @@ namespace vulkan
 		/// @param format Vulkan format of the frame buffer
 		/// @param additional_usage Additional usage flags for the frame buffer image (No need to include
 		/// `eXxxAttachment` or `eSampled` bit)
+		/// @param queue_family_indices Queue families accessing the image, the image is shared concurrently
+		/// if there are more than one, otherwise exclusively
+		/// @param debug_name Name of the image in debug tools, see `vulkan::Allocator::create_image`
+		/// @param layer_count Array layers of the image, e.g. one for each view of a multiview rendering.
+		/// The view is a 2D array view of all layers if more than one.
 		/// @return Created frame buffer, or error
 		///
 		[[nodiscard]]
@@ -38,7 +45,10 @@ namespace vulkan
 			const vulkan::Allocator& allocator,
 			glm::u32vec2 extent,
 			vk::Format format,
-			vk::ImageUsageFlags additional_usage = {}
+			vk::ImageUsageFlags additional_usage = {},
+			std::span<const uint32_t> queue_family_indices = {},
+			const char* debug_name = nullptr,
+			uint32_t layer_count = 1
 		) noexcept;
 
 		operator AttachmentView() const noexcept
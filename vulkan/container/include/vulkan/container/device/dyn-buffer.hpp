@@ -4,6 +4,7 @@
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/alloc/buffer-ref.hpp"
 #include "vulkan/alloc/buffer.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
 #include "vulkan/interface/context.hpp"
 
 #include <cstddef>
@@ -46,10 +47,16 @@ namespace vulkan
 		///
 		/// @param context Device context
 		/// @param new_size Requested size in bytes
+		/// @param deletion_queue If given, a replaced buffer is retired into it instead of being destroyed
+		/// immediately, for buffers that may still be used by frames in flight
 		/// @return Success, or error if resize failed
 		///
 		[[nodiscard]]
-		std::expected<void, Error> resize(const vulkan::Context& context, size_t new_size) noexcept;
+		std::expected<void, Error> resize(
+			const vulkan::Context& context,
+			size_t new_size,
+			DeletionQueue* deletion_queue = nullptr
+		) noexcept;
 
 		operator const Buffer&() const noexcept
 		{
@@ -175,12 +182,17 @@ namespace vulkan
 		///
 		/// @param context Device context
 		/// @param new_size_items Requested item count
+		/// @param deletion_queue If given, a replaced buffer is retired into it, see `DynBuffer::resize`
 		/// @return Success, or error if resize failed
 		///
 		[[nodiscard]]
-		std::expected<void, Error> resize(const vulkan::Context& context, size_t new_size_items) noexcept
+		std::expected<void, Error> resize(
+			const vulkan::Context& context,
+			size_t new_size_items,
+			DeletionQueue* deletion_queue = nullptr
+		) noexcept
 		{
-			auto result = buffer.resize(context, new_size_items * sizeof(T));
+			auto result = buffer.resize(context, new_size_items * sizeof(T), deletion_queue);
 			if (!result) return result.error().forward("Resize dynamic structured buffer failed");
 
 			item_count = new_size_items;
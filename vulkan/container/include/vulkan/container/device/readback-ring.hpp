@@ -0,0 +1,187 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief Per-frame readback allocator, copies device data to host without stalling the frame loop
+	/// @details
+	/// - The ring holds one slot per frame in flight, each with a persistently host-visible buffer
+	/// - `read_buffer` and `read_image` record a copy into the frame command buffer, bump-allocated in the
+	/// slot of the current frame. The data is delivered to the callback of the request once the slot comes
+	/// around again, i.e. `slot_count` frames later
+	/// - `host_barrier` returns the barrier making the copies of the current frame visible to the host,
+	/// record it after all copies of the frame
+	/// - Like `UploadRing`, a slot outgrowing its capacity allocates a larger buffer, and keeps the previous
+	/// one until the slot is recycled
+	///
+	/// #### Usage
+	/// ```cpp
+	/// // After waiting for the fence of the frame about to be reused
+	/// ring.begin_frame();
+	///
+	/// ring.read_buffer(context, command_buffer, stat_buffer, 0, sizeof(Stat), [](auto data) { ... });
+	/// if (const auto barrier = ring.host_barrier()) command_buffer.pipelineBarrier2(...);
+	/// ```
+	///
+	/// @warning The sources of the copies must be synchronized for transfer reads by the caller, images must
+	/// be in `eTransferSrcOptimal` or `eGeneral` layout
+	///
+	class ReadbackRing
+	{
+	  public:
+
+		// Alignment of each request in the readback buffer, also a multiple of all non-compressed texel sizes
+		// up to 16 bytes
+		static constexpr size_t ALIGNMENT = 16;
+
+		///
+		/// @brief Callback receiving the read back data of a request
+		/// @note The span is only valid during the call
+		///
+		using Callback = std::function<void(std::span<const std::byte> data)>;
+
+		///
+		/// @brief Create a readback ring
+		///
+		/// @param context Vulkan context
+		/// @param slot_count Number of slots, typically the number of frames in flight
+		/// @param capacity Initial capacity of each slot in bytes
+		/// @return Created readback ring, or error if creation failed
+		///
+		[[nodiscard]]
+		static std::expected<ReadbackRing, Error> create(
+			const Context& context,
+			size_t slot_count,
+			size_t capacity
+		) noexcept;
+
+		///
+		/// @brief Advance to the next slot, delivering the data of its requests to their callbacks
+		/// @warning Caller must ensure the frame that last used the slot, i.e. `slot_count` frames ago, has
+		/// completed on the GPU. E.g. call right after waiting for its fence
+		///
+		/// @return Void, or error if downloading failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> begin_frame() noexcept;
+
+		///
+		/// @brief Record a copy of a buffer region to host
+		///
+		/// @param context Vulkan context, used if the slot has to grow
+		/// @param command_buffer Command buffer of the current frame
+		/// @param src_buffer Source buffer, must have `eTransferSrc` usage
+		/// @param src_offset Source offset in bytes
+		/// @param size Size in bytes
+		/// @param callback Callback receiving the data
+		/// @return Void, or error if growing the slot failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> read_buffer(
+			const Context& context,
+			const vk::raii::CommandBuffer& command_buffer,
+			vk::Buffer src_buffer,
+			size_t src_offset,
+			size_t size,
+			Callback callback
+		) noexcept;
+
+		///
+		/// @brief Record a copy of the base level of an image to host, tightly packed
+		///
+		/// @param context Vulkan context, used if the slot has to grow
+		/// @param command_buffer Command buffer of the current frame
+		/// @param src_image Source image, must have `eTransferSrc` usage
+		/// @param src_layout Layout of the source image, `eTransferSrcOptimal` or `eGeneral`
+		/// @param aspect Aspect to read back
+		/// @param extent Extent of the region to read back, from the origin
+		/// @param texel_size Size of a texel in bytes, must divide `ALIGNMENT`
+		/// @param callback Callback receiving the data
+		/// @return Void, or error if growing the slot failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> read_image(
+			const Context& context,
+			const vk::raii::CommandBuffer& command_buffer,
+			vk::Image src_image,
+			vk::ImageLayout src_layout,
+			vk::ImageAspectFlagBits aspect,
+			glm::u32vec2 extent,
+			size_t texel_size,
+			Callback callback
+		) noexcept;
+
+		///
+		/// @brief Get the barrier making the copies of the current frame visible to the host
+		///
+		/// @return Memory barrier, or `std::nullopt` if nothing was read back in the current frame
+		///
+		[[nodiscard]]
+		std::optional<vk::MemoryBarrier2> host_barrier() const noexcept;
+
+		///
+		/// @brief Drop all pending requests without calling their callbacks, e.g. before destruction
+		///
+		void discard() noexcept;
+
+	  private:
+
+		struct Request
+		{
+			size_t buffer_index;  // Index into `Slot::buffers`
+			size_t offset;
+			size_t size;
+			Callback callback;
+		};
+
+		struct Slot
+		{
+			std::vector<Buffer> buffers;  // The last one is the current buffer, others are outgrown
+			size_t capacity;
+			size_t offset = 0;
+			std::vector<Request> requests;
+		};
+
+		std::vector<Slot> slots;
+		size_t current = 0;
+
+		static std::expected<Buffer, Error> create_readback_buffer(
+			const Context& context,
+			size_t capacity
+		) noexcept;
+
+		// Allocate a region in the current slot, returns `(buffer index, offset)`
+		[[nodiscard]]
+		std::expected<std::pair<size_t, size_t>, Error> allocate(
+			const Context& context,
+			size_t size
+		) noexcept;
+
+		explicit ReadbackRing(std::vector<Slot> slots) :
+			slots(std::move(slots))
+		{}
+
+	  public:
+
+		ReadbackRing(const ReadbackRing&) = delete;
+		ReadbackRing(ReadbackRing&&) = default;
+		ReadbackRing& operator=(const ReadbackRing&) = delete;
+		ReadbackRing& operator=(ReadbackRing&&) = default;
+	};
+}
@@ -7,7 +7,9 @@
 #include "vulkan/alloc/buffer.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstdint>
 #include <expected>
+#include <optional>
 #include <span>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
@@ -17,6 +19,10 @@ namespace vulkan
 {
 	///
 	/// @brief Two-stage host-uploadable buffer. Holds a single item of type T.
+	/// @details If `Allocator::supports_direct_upload`, the device buffer is host-writable device-local
+	/// memory, `update` writes it in place and `upload` records no copy
+	/// @warning In direct mode, `update` becomes visible to all commands reading the buffer, caller must
+	/// ensure none of them is in flight
 	///
 	/// @tparam T Type of the buffer data
 	///
@@ -30,27 +36,40 @@ namespace vulkan
 		///
 		/// @param device_context Vulkan device
 		/// @param usage_flags Buffer usage flags. `eTransferDst` is automatically added
+		/// @param queue_family_indices Queue families reading the device buffer, the device buffer is shared
+		/// concurrently if there are more than one, otherwise exclusively
 		/// @return Created StagedBuffer, or error if creation failed
 		///
 		[[nodiscard]]
 		static std::expected<StagedBuffer, Error> create(
 			const Context& device_context,
-			vk::BufferUsageFlags usage_flags
+			vk::BufferUsageFlags usage_flags,
+			std::span<const uint32_t> queue_family_indices = {}
 		) noexcept
 		{
-			auto staging_buffer_result = device_context.allocator.create_element_buffer<T>(
-				vk::BufferUsageFlagBits::eTransferSrc,
-				vulkan::MemoryUsage::CpuToGpu
-			);
+			const auto concurrent = queue_family_indices.size() > 1;
+			const auto direct = device_context.allocator.supports_direct_upload();
+
 			auto device_buffer_result = device_context.allocator.create_element_buffer<T>(
 				usage_flags | vk::BufferUsageFlagBits::eTransferDst,
-				vulkan::MemoryUsage::GpuOnly
+				direct ? vulkan::MemoryUsage::CpuToGpuDirect : vulkan::MemoryUsage::GpuOnly,
+				concurrent ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+				concurrent ? queue_family_indices : std::span<const uint32_t>()
 			);
+			if (!device_buffer_result)
+				return device_buffer_result.error().forward("Create device buffer failed");
 
+			if (direct) return StagedBuffer(std::nullopt, std::move(*device_buffer_result));
+
+			auto staging_buffer_result = device_context.allocator.create_element_buffer<T>(
+				vk::BufferUsageFlagBits::eTransferSrc,
+				vulkan::MemoryUsage::CpuToGpu,
+				vk::SharingMode::eExclusive,
+				{},
+				vulkan::MemoryCategory::Staging
+			);
 			if (!staging_buffer_result)
 				return staging_buffer_result.error().forward("Create staging buffer failed");
-			if (!device_buffer_result)
-				return device_buffer_result.error().forward("Create device buffer failed");
 
 			return StagedBuffer(std::move(*staging_buffer_result), std::move(*device_buffer_result));
 		}
@@ -65,7 +84,8 @@ namespace vulkan
 		[[nodiscard]]
 		std::expected<void, Error> update(const T& data) noexcept
 		{
-			return staging_buffer.upload(data);
+			if (!staging_buffer.has_value()) return device_buffer.upload(data);
+			return staging_buffer->upload(data);
 		}
 
 		///
@@ -76,11 +96,13 @@ namespace vulkan
 		///
 		void upload_direct(const vk::raii::CommandBuffer& command_buffer) const noexcept
 		{
+			if (!staging_buffer.has_value()) return;
+
 			const auto copy_region = vk::BufferCopy2{.srcOffset = 0, .dstOffset = 0, .size = sizeof(T)};
 
 			command_buffer.copyBuffer2(
 				vk::CopyBufferInfo2()
-					.setSrcBuffer(staging_buffer)
+					.setSrcBuffer(*staging_buffer)
 					.setDstBuffer(device_buffer)
 					.setRegions(copy_region)
 			);
@@ -88,6 +110,7 @@ namespace vulkan
 
 		///
 		/// @brief Upload the data to GPU and return a buffer memory barrier for the uploaded buffer
+		/// @note In direct mode the barrier is empty, host writes are made visible by the queue submission
 		///
 		/// @param command_buffer Command buffer
 		/// @param dst_stage_mask Destination pipeline stage mask for the buffer memory barrier
@@ -104,7 +127,7 @@ namespace vulkan
 		{
 			upload_direct(command_buffer);
 
-			return vk::BufferMemoryBarrier2{
+			auto barrier = vk::BufferMemoryBarrier2{
 				.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
 				.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
 				.dstStageMask = dst_stage_mask,
@@ -115,6 +138,12 @@ namespace vulkan
 				.offset = 0,
 				.size = vk::WholeSize
 			};
+
+			if (!staging_buffer.has_value())
+				barrier.setSrcStageMask(vk::PipelineStageFlagBits2::eNone)
+					.setSrcAccessMask(vk::AccessFlagBits2::eNone);
+
+			return barrier;
 		}
 
 		operator vk::Buffer() const noexcept { return device_buffer; }
@@ -122,9 +151,10 @@ namespace vulkan
 
 	  private:
 
-		ElementBuffer<T> staging_buffer, device_buffer;
+		std::optional<ElementBuffer<T>> staging_buffer;  // Absent in direct mode
+		ElementBuffer<T> device_buffer;
 
-		StagedBuffer(ElementBuffer<T> staging_buffer, ElementBuffer<T> device_buffer) :
+		StagedBuffer(std::optional<ElementBuffer<T>> staging_buffer, ElementBuffer<T> device_buffer) :
 			staging_buffer(std::move(staging_buffer)),
 			device_buffer(std::move(device_buffer))
 		{}
@@ -139,6 +169,8 @@ namespace vulkan
 
 	///
 	/// @brief Dynamic-length host-uploadable buffer. Holds an array of type T.
+	/// @details Same as `StagedBuffer`, writes the device buffer in place if
+	/// `Allocator::supports_direct_upload`. The mode is selected on the first `update`.
 	///
 	/// @tparam T Type of the buffer data
 	///
@@ -153,8 +185,9 @@ namespace vulkan
 		/// @param usage_flags Buffer usage flags. `eTransferDst` is automatically added
 		///
 		DynArrayStagedBuffer(vk::BufferUsageFlags usage_flags) noexcept :
+			usage_flags(usage_flags | vk::BufferUsageFlagBits::eTransferDst),
 			staging_buffer(vk::BufferUsageFlagBits::eTransferSrc, vulkan::MemoryUsage::CpuToGpu),
-			device_buffer(usage_flags | vk::BufferUsageFlagBits::eTransferDst, vulkan::MemoryUsage::GpuOnly)
+			device_buffer(this->usage_flags, vulkan::MemoryUsage::GpuOnly)
 		{}
 
 		operator vk::Buffer() const noexcept { return device_buffer; }
@@ -174,9 +207,27 @@ namespace vulkan
 			std::span<const T> data
 		) noexcept
 		{
+			if (!direct.has_value())
+			{
+				direct = device_context.allocator.supports_direct_upload();
+				if (*direct)
+					device_buffer =
+						vulkan::DynArrayBuffer<T>(usage_flags, vulkan::MemoryUsage::CpuToGpuDirect);
+			}
+
 			if (const auto result = device_buffer.resize(device_context, data.size()); !result)
 				return result.error().forward("Resize device buffer failed");
 
+			if (*direct)
+			{
+				if (data.empty()) return {};
+
+				if (const auto result = device_buffer->upload(std::as_bytes(data)); !result)
+					return result.error().forward("Upload device buffer failed");
+
+				return {};
+			}
+
 			if (const auto result = staging_buffer.resize(device_context, data.size()); !result)
 				return result.error().forward("Resize staging buffer failed");
 
@@ -196,6 +247,8 @@ namespace vulkan
 		///
 		void upload_direct(const vk::raii::CommandBuffer& command_buffer) const noexcept
 		{
+			if (direct.value_or(false)) return;
+
 			const auto copy_region =
 				vk::BufferCopy2{.srcOffset = 0, .dstOffset = 0, .size = staging_buffer.size_bytes()};
 
@@ -226,7 +279,7 @@ namespace vulkan
 		{
 			upload_direct(command_buffer);
 
-			return vk::BufferMemoryBarrier2{
+			auto barrier = vk::BufferMemoryBarrier2{
 				.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
 				.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
 				.dstStageMask = dst_stage_mask,
@@ -237,10 +290,18 @@ namespace vulkan
 				.offset = 0,
 				.size = device_buffer.size_bytes() == 0 ? vk::WholeSize : device_buffer.size_bytes()
 			};
+
+			if (direct.value_or(false))
+				barrier.setSrcStageMask(vk::PipelineStageFlagBits2::eNone)
+					.setSrcAccessMask(vk::AccessFlagBits2::eNone);
+
+			return barrier;
 		}
 
 	  private:
 
+		vk::BufferUsageFlags usage_flags;
+		std::optional<bool> direct = std::nullopt;  // Selected on first update
 		vulkan::DynArrayBuffer<T> staging_buffer, device_buffer;
 
 	  public:
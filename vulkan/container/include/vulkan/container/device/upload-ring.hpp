@@ -0,0 +1,177 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+#include "vulkan/alloc/buffer-ref.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <libassert/assert.hpp>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief Per-frame linear upload allocator, replacing a dedicated staging buffer per uploaded resource
+	/// @details
+	/// - Host data is bump-allocated into a single persistently mapped staging buffer with `push`, each push
+	/// schedules a copy into a device buffer
+	/// - `record` records all scheduled copies, grouped into one copy command per destination buffer, and
+	/// returns a single memory barrier covering all of them
+	/// - When a frame pushes more than the capacity, a larger staging buffer is allocated and the previous
+	/// one is kept alive until the next `reset`, so the capacity converges to the peak per-frame upload size
+	///
+	/// @warning The staging memory is reused on `reset`, so a ring must not be shared by command buffers in
+	/// flight, e.g. keep one ring per frame in flight (see `vulkan::Cycle`)
+	///
+	class UploadRing
+	{
+	  public:
+
+		// Alignment of each push in the staging buffer
+		static constexpr size_t ALIGNMENT = 16;
+
+		///
+		/// @brief Create an upload ring
+		///
+		/// @param context Vulkan context
+		/// @param capacity Initial capacity of the staging buffer in bytes
+		/// @return Created upload ring, or error if creation failed
+		///
+		[[nodiscard]]
+		static std::expected<UploadRing, Error> create(const Context& context, size_t capacity) noexcept;
+
+		///
+		/// @brief Start a new frame, discarding all pushed data and scheduled copies
+		/// @warning Caller must ensure the command buffer of the previous frame using this ring has finished
+		///
+		void reset() noexcept;
+
+		///
+		/// @brief Push host data and schedule a copy of it into a device buffer
+		///
+		/// @param context Vulkan context, used if the staging buffer has to grow
+		/// @param data Host data
+		/// @param dst_buffer Destination buffer, must have `eTransferDst` usage
+		/// @param dst_offset Destination offset in bytes
+		/// @return Void, or error if growing or writing the staging buffer failed
+		///
+		[[nodiscard]]
+		std::expected<void, Error> push(
+			const Context& context,
+			std::span<const std::byte> data,
+			vk::Buffer dst_buffer,
+			size_t dst_offset = 0
+		) noexcept;
+
+		///
+		/// @brief Push an element and schedule a copy of it into an element buffer
+		///
+		/// @param context Vulkan context
+		/// @param element Element to upload
+		/// @param dst_buffer Destination buffer
+		/// @return Void, or error if push failed
+		///
+		template <typename T>
+		[[nodiscard]]
+		std::expected<void, Error> push(
+			const Context& context,
+			const T& element,
+			std::type_identity_t<ElementBufferRef<T>> dst_buffer
+		) noexcept
+		{
+			return push(context, util::object_as_bytes(element), dst_buffer);
+		}
+
+		///
+		/// @brief Push an array of elements and schedule a copy of it into an array buffer
+		///
+		/// @param context Vulkan context
+		/// @param elements Elements to upload
+		/// @param dst_buffer Destination buffer
+		/// @param dst_offset Destination offset in number of elements (not bytes)
+		/// @return Void, or error if push failed
+		///
+		template <typename T>
+		[[nodiscard]]
+		std::expected<void, Error> push(
+			const Context& context,
+			std::span<const T> elements,
+			std::type_identity_t<ArrayBufferRef<T>> dst_buffer,
+			size_t dst_offset = 0
+		) noexcept
+		{
+			ASSUME(dst_offset + elements.size() <= dst_buffer.count());
+			return push(context, std::as_bytes(elements), dst_buffer, dst_offset * sizeof(T));
+		}
+
+		///
+		/// @brief Record the scheduled copies, which are then cleared
+		///
+		/// @param command_buffer Command buffer
+		/// @param dst_stage_mask Destination pipeline stage mask of the barrier
+		/// @param dst_access_mask Destination access mask of the barrier. Default is `eShaderRead`
+		/// @return Memory barrier making the copies visible, or `std::nullopt` if nothing was pushed
+		///
+		[[nodiscard]]
+		std::optional<vk::MemoryBarrier2> record(
+			const vk::raii::CommandBuffer& command_buffer,
+			vk::PipelineStageFlags2 dst_stage_mask,
+			vk::AccessFlags2 dst_access_mask = vk::AccessFlagBits2::eShaderRead
+		) noexcept;
+
+		///
+		/// @brief Get the capacity of the current staging buffer in bytes
+		///
+		/// @return Capacity in bytes
+		///
+		[[nodiscard]]
+		size_t capacity_bytes() const noexcept
+		{
+			return capacity;
+		}
+
+	  private:
+
+		struct Copy
+		{
+			vk::Buffer src_buffer;
+			vk::Buffer dst_buffer;
+			vk::BufferCopy2 region;
+		};
+
+		Buffer buffer;
+		size_t capacity;
+		size_t offset = 0;
+
+		// Staging buffers outgrown in the current frame, still read by its scheduled copies
+		std::vector<Buffer> retired_buffers;
+
+		std::vector<Copy> copies;
+
+		static std::expected<Buffer, Error> create_staging_buffer(
+			const Context& context,
+			size_t capacity
+		) noexcept;
+
+		explicit UploadRing(Buffer buffer, size_t capacity) :
+			buffer(std::move(buffer)),
+			capacity(capacity)
+		{}
+
+	  public:
+
+		UploadRing(const UploadRing&) = delete;
+		UploadRing(UploadRing&&) = default;
+		UploadRing& operator=(const UploadRing&) = delete;
+		UploadRing& operator=(UploadRing&&) = default;
+	};
+}
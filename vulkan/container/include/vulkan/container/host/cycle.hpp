@@ -110,6 +110,20 @@ namespace vulkan
 			return *self.items.front();
 		}
 
+		///
+		/// @brief Item used a number of frames before the current one
+		///
+		/// @param age Number of frames before the current one, `0` for @p current and `1` for @p prev. Must
+		/// be less than the number of items
+		/// @return Reference to the item
+		///
+		[[nodiscard]]
+		auto&& history(this auto&& self, size_t age) noexcept
+		{
+			// `front()` is one frame old, older items follow it towards `back()`
+			return *self.items[(age + self.items.size() - 1) % self.items.size()];
+		}
+
 		///
 		/// @brief Cycle to the next item, often called at the end of a frames
 		///
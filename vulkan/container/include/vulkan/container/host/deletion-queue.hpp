@@ -0,0 +1,102 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace vulkan
+{
+	///
+	/// @brief Defers the destruction of GPU objects until the frames that may use them have completed
+	/// @details
+	/// #### Usage
+	/// - Call @p advance once per frame, right after waiting for the frame resources about to be reused
+	/// - Call @p retire instead of destroying an object that may still be used by frames in flight, e.g. old
+	/// attachments replaced on resize. The object is destroyed on the @p advance call `latency` frames later.
+	///
+	/// With `N` frames in flight, a latency of `N` guarantees that every frame recorded before or during the
+	/// retiring frame has completed, since each `advance` follows the wait of the frame submitted `N`
+	/// frames before.
+	///
+	/// @warning **NOT** thread-safe. Retired objects still alive when the queue is destroyed are destroyed
+	/// immediately, caller must ensure the device is idle by then.
+	///
+	class DeletionQueue
+	{
+	  public:
+
+		///
+		/// @brief Create a deletion queue
+		///
+		/// @param latency Number of `advance` calls a retired object survives, typically the number of
+		/// frames in flight
+		///
+		explicit DeletionQueue(size_t latency) noexcept :
+			latency(latency)
+		{}
+
+		///
+		/// @brief Retire an object, destroying it once the frames in flight have completed
+		///
+		/// @param object Object to retire
+		///
+		template <typename T>
+			requires(std::move_constructible<T> && !std::is_reference_v<T>)
+		void retire(T object) noexcept
+		{
+			entries.push_back({
+				.release_frame = frame + latency,
+				.object = std::make_shared<T>(std::move(object)),
+			});
+		}
+
+		///
+		/// @brief Advance to the next frame, destroying the objects whose latency has elapsed
+		///
+		void advance() noexcept
+		{
+			frame++;
+			while (!entries.empty() && entries.front().release_frame <= frame) entries.pop_front();
+		}
+
+		///
+		/// @brief Destroy all retired objects immediately
+		/// @warning Caller must ensure none of them is used by the device, e.g. after `waitIdle`
+		///
+		void flush() noexcept { entries.clear(); }
+
+		///
+		/// @brief Get the number of retired objects pending destruction
+		///
+		/// @return Number of objects
+		///
+		[[nodiscard]]
+		size_t size() const noexcept
+		{
+			return entries.size();
+		}
+
+	  private:
+
+		struct Entry
+		{
+			uint64_t release_frame;
+			std::shared_ptr<void> object;  // Type-erased, destroyed with the deleter of its actual type
+		};
+
+		size_t latency;
+		uint64_t frame = 0;
+		std::deque<Entry> entries;  // Sorted by release frame, as the latency is constant
+
+	  public:
+
+		DeletionQueue(const DeletionQueue&) = delete;
+		DeletionQueue(DeletionQueue&&) = default;
+		DeletionQueue& operator=(const DeletionQueue&) = delete;
+		DeletionQueue& operator=(DeletionQueue&&) = default;
+	};
+}
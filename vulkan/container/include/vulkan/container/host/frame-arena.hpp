@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace vulkan
+{
+	///
+	/// @brief Per-frame monotonic arena for host-side scratch data, e.g. drawcalls, barriers and strings
+	/// @details
+	/// - Allocations bump a pointer in a single buffer, deallocations are no-ops, and `reset` releases
+	/// everything at once
+	/// - When a frame allocates more than the capacity, the excess falls back to the upstream resource until
+	/// the next `reset`, which then grows the buffer to the peak usage of the frame. The capacity converges
+	/// to the peak per-frame usage, after which a frame performs no heap allocation.
+	///
+	/// #### Usage
+	/// Keep one arena per frame in flight (see `vulkan::Cycle`), and call @p reset right after waiting for
+	/// the frame about to be reused.
+	///
+	/// @warning **NOT** thread-safe. Every object allocated from the arena must be destroyed before @p reset.
+	///
+	class FrameArena final : public std::pmr::memory_resource
+	{
+	  public:
+
+		///
+		/// @brief Create a frame arena
+		///
+		/// @param capacity Initial capacity of the buffer in bytes
+		/// @param upstream Upstream resource for the buffer and the overflowing allocations
+		///
+		explicit FrameArena(
+			size_t capacity,
+			std::pmr::memory_resource& upstream = *std::pmr::new_delete_resource()
+		) :
+			upstream(&upstream),
+			buffer(allocate_buffer(upstream, capacity)),
+			capacity(capacity)
+		{}
+
+		~FrameArena() noexcept override
+		{
+			release_overflows();
+			free_buffer();
+		}
+
+		///
+		/// @brief Start a new frame, releasing all allocations at once
+		/// @note Grows the buffer if the previous frame overflowed
+		///
+		void reset()
+		{
+			const auto peak = offset + overflow_bytes;
+			release_overflows();
+			offset = 0;
+
+			if (peak <= capacity) return;
+
+			const auto new_capacity = std::max(std::bit_ceil(peak), capacity * 2);
+			free_buffer();
+			buffer = allocate_buffer(*upstream, new_capacity);
+			capacity = new_capacity;
+		}
+
+		///
+		/// @brief Get the capacity of the buffer in bytes
+		///
+		/// @return Capacity in bytes
+		///
+		[[nodiscard]]
+		size_t capacity_bytes() const noexcept
+		{
+			return capacity;
+		}
+
+		///
+		/// @brief Get the number of bytes allocated since the last @p reset, including alignment padding and
+		/// overflowing allocations
+		///
+		/// @return Allocated bytes
+		///
+		[[nodiscard]]
+		size_t used_bytes() const noexcept
+		{
+			return offset + overflow_bytes;
+		}
+
+	  private:
+
+		static constexpr size_t BUFFER_ALIGNMENT = alignof(std::max_align_t);
+
+		struct Overflow
+		{
+			void* ptr;
+			size_t bytes;
+			size_t alignment;
+		};
+
+		std::pmr::memory_resource* upstream;
+
+		std::byte* buffer;
+		size_t capacity;
+		size_t offset = 0;
+
+		// Allocations not fitting the buffer in the current frame
+		std::vector<Overflow> overflows;
+		size_t overflow_bytes = 0;
+
+		static std::byte* allocate_buffer(std::pmr::memory_resource& upstream, size_t capacity)
+		{
+			if (capacity == 0) return nullptr;
+			return static_cast<std::byte*>(upstream.allocate(capacity, BUFFER_ALIGNMENT));
+		}
+
+		void free_buffer() noexcept
+		{
+			if (buffer != nullptr) upstream->deallocate(buffer, capacity, BUFFER_ALIGNMENT);
+			buffer = nullptr;
+		}
+
+		void release_overflows() noexcept
+		{
+			for (const auto& overflow : overflows)
+				upstream->deallocate(overflow.ptr, overflow.bytes, overflow.alignment);
+			overflows.clear();
+			overflow_bytes = 0;
+		}
+
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			void* ptr = buffer + offset;
+			auto space = capacity - offset;
+
+			if (buffer != nullptr && std::align(alignment, bytes, ptr, space) != nullptr)
+			{
+				offset = capacity - space + bytes;
+				return ptr;
+			}
+
+			void* const overflow = upstream->allocate(bytes, alignment);
+			overflows.push_back({.ptr = overflow, .bytes = bytes, .alignment = alignment});
+			overflow_bytes += bytes + alignment - 1;  // Reserve the worst-case padding after growing
+
+			return overflow;
+		}
+
+		void do_deallocate(void*, size_t, size_t) noexcept override {}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+	  public:
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena(FrameArena&&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+		FrameArena& operator=(FrameArena&&) = delete;
+	};
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <libassert/assert.hpp>
+#include <map>
+#include <optional>
+
+namespace vulkan
+{
+	///
+	/// @brief Suballocates ranges of a fixed-size region, e.g. elements of a shared device buffer
+	/// @details
+	/// - Allocations are placed first-fit in the lowest free range that fits them after alignment
+	/// - Freed ranges are merged with adjacent free ranges, so freeing everything restores a single free
+	/// range covering the whole region
+	/// - The allocator only tracks offsets, it doesn't own any memory
+	///
+	/// @warning **NOT** thread-safe
+	///
+	class RangeAllocator
+	{
+	  public:
+
+		///
+		/// @brief Range allocated from the region
+		///
+		struct Range
+		{
+			uint64_t offset;
+			uint64_t size;
+
+			bool operator==(const Range&) const noexcept = default;
+		};
+
+		///
+		/// @brief Create a range allocator
+		///
+		/// @param capacity Size of the region
+		///
+		explicit RangeAllocator(uint64_t capacity) :
+			capacity(capacity),
+			free_size(capacity)
+		{
+			if (capacity > 0) free_ranges.emplace(0, capacity);
+		}
+
+		///
+		/// @brief Allocate a range
+		///
+		/// @param size Size of the range, must be non-zero
+		/// @param alignment Alignment of the offset, must be non-zero
+		/// @return Allocated range, or `std::nullopt` if no free range fits
+		///
+		[[nodiscard]]
+		std::optional<Range> allocate(uint64_t size, uint64_t alignment = 1) noexcept
+		{
+			ASSUME(size > 0);
+			ASSUME(alignment > 0);
+
+			for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it)
+			{
+				const auto [free_offset, free_range_size] = *it;
+				const auto offset = (free_offset + alignment - 1) / alignment * alignment;
+				const auto padding = offset - free_offset;
+				if (padding + size > free_range_size) continue;
+
+				free_ranges.erase(it);
+				if (padding > 0) free_ranges.emplace(free_offset, padding);
+				if (padding + size < free_range_size)
+					free_ranges.emplace(offset + size, free_range_size - padding - size);
+
+				free_size -= size;
+				return Range{.offset = offset, .size = size};
+			}
+
+			return std::nullopt;
+		}
+
+		///
+		/// @brief Free a range allocated by @p allocate
+		///
+		/// @param range Range to free
+		///
+		void free(Range range) noexcept
+		{
+			ASSUME(range.offset + range.size <= capacity);
+
+			auto begin = range.offset;
+			auto end = range.offset + range.size;
+
+			// Merge with the following free range
+			const auto next = free_ranges.lower_bound(begin);
+			DEBUG_ASSERT(next == free_ranges.end() || next->first >= end, "Range freed twice");
+			if (next != free_ranges.end() && next->first == end)
+			{
+				end += next->second;
+				free_ranges.erase(next);
+			}
+
+			// Merge with the preceding free range
+			const auto upper = free_ranges.lower_bound(begin);
+			if (upper != free_ranges.begin())
+			{
+				const auto prev = std::prev(upper);
+				DEBUG_ASSERT(prev->first + prev->second <= begin, "Range freed twice");
+				if (prev->first + prev->second == begin)
+				{
+					begin = prev->first;
+					free_ranges.erase(prev);
+				}
+			}
+
+			free_ranges.emplace(begin, end - begin);
+			free_size += range.size;
+		}
+
+		///
+		/// @brief Get the size of the region
+		///
+		/// @return Size of the region
+		///
+		[[nodiscard]]
+		uint64_t get_capacity() const noexcept
+		{
+			return capacity;
+		}
+
+		///
+		/// @brief Get the total size of the free ranges, which may be fragmented
+		///
+		/// @return Free size
+		///
+		[[nodiscard]]
+		uint64_t get_free_size() const noexcept
+		{
+			return free_size;
+		}
+
+		///
+		/// @brief Get the number of free ranges, `1` when nothing is allocated
+		///
+		/// @return Number of free ranges
+		///
+		[[nodiscard]]
+		size_t get_free_range_count() const noexcept
+		{
+			return free_ranges.size();
+		}
+
+	  private:
+
+		uint64_t capacity;
+		uint64_t free_size;
+
+		// Offset -> size of the free ranges, never adjacent to each other
+		std::map<uint64_t, uint64_t> free_ranges;
+	};
+}
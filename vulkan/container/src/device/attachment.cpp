@@ -3,9 +3,11 @@
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/numeric/base-level.hpp"
 
+#include <cstdint>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <libassert/assert.hpp>
+#include <span>
 #include <string>
 #include <utility>
 #include <vulkan/vulkan.hpp>
@@ -38,29 +40,44 @@ namespace vulkan
 		const vulkan::Allocator& allocator,
 		glm::u32vec2 extent,
 		vk::Format format,
-		vk::ImageUsageFlags additional_usage
+		vk::ImageUsageFlags additional_usage,
+		std::span<const uint32_t> queue_family_indices,
+		const char* debug_name,
+		uint32_t layer_count
 	) noexcept
 	{
+		DEBUG_ASSERT(layer_count >= 1);
+
+		const auto concurrent = queue_family_indices.size() > 1;
+
 		const auto image_create_info = vk::ImageCreateInfo{
 			.imageType = vk::ImageType::e2D,
 			.format = format,
 			.extent = {.width = extent.x, .height = extent.y, .depth = 1},
 			.mipLevels = 1,
-			.arrayLayers = 1,
+			.arrayLayers = layer_count,
 			.samples = vk::SampleCountFlagBits::e1,
 			.tiling = vk::ImageTiling::eOptimal,
-			.usage = get_image_usages(format, additional_usage)
+			.usage = get_image_usages(format, additional_usage),
+			.sharingMode = concurrent ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+			.queueFamilyIndexCount = concurrent ? static_cast<uint32_t>(queue_family_indices.size()) : 0,
+			.pQueueFamilyIndices = concurrent ? queue_family_indices.data() : nullptr
 		};
 
-		auto image_result = allocator.create_image(image_create_info, vulkan::MemoryUsage::GpuOnly);
+		auto image_result = allocator.create_image(
+			image_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Attachment,
+			debug_name
+		);
 		if (!image_result) return image_result.error().forward("Create image failed");
 		auto image = std::move(image_result.value());
 
 		const auto image_view_create_info = vk::ImageViewCreateInfo{
 			.image = image,
-			.viewType = vk::ImageViewType::e2D,
+			.viewType = layer_count > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D,
 			.format = format,
-			.subresourceRange = vulkan::base_level_image_range(get_image_aspects(format))
+			.subresourceRange = vulkan::base_level_image_range(get_image_aspects(format), layer_count)
 		};
 
 		auto view_result = device.createImageView(image_view_create_info);
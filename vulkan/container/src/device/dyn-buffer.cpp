@@ -1,5 +1,6 @@
 #include "vulkan/container/device/dyn-buffer.hpp"
 #include "common/util/error.hpp"
+#include "vulkan/container/host/deletion-queue.hpp"
 #include "vulkan/interface/context.hpp"
 
 #include <algorithm>
@@ -12,8 +13,18 @@
 
 namespace vulkan
 {
-	std::expected<void, Error> DynBuffer::resize(const vulkan::Context& context, size_t new_size) noexcept
+	std::expected<void, Error> DynBuffer::resize(
+		const vulkan::Context& context,
+		size_t new_size,
+		DeletionQueue* deletion_queue
+	) noexcept
 	{
+		// Destroy or retire the current buffer
+		const auto release_buffer = [this, deletion_queue] {
+			if (deletion_queue != nullptr && buffer.has_value()) deletion_queue->retire(std::move(*buffer));
+			buffer.reset();
+		};
+
 		// Note: exact power of 2 will be rounded up to 3/4 of next power of 2
 		const auto determine_size = [](size_t requested_size) {
 			const size_t lowest_bigger_pow2 = std::bit_ceil(requested_size + 1);
@@ -28,7 +39,7 @@ namespace vulkan
 
 		if (clamped_size > MAX_SIZE)
 		{
-			buffer.reset();
+			release_buffer();
 			capacity = 0;
 			size = 0;
 			shrink_counter = 0;
@@ -49,13 +60,14 @@ namespace vulkan
 			);
 			if (!new_buffer_result)
 			{
-				buffer.reset();
+				release_buffer();
 				capacity = 0;
 				size = 0;
 				shrink_counter = 0;
 				return new_buffer_result.error().forward("Create buffer failed");
 			}
 
+			release_buffer();
 			buffer = std::move(*new_buffer_result);
 			capacity = determined_size;
 			size = new_size;
@@ -86,13 +98,14 @@ namespace vulkan
 			);
 			if (!new_buffer_result)
 			{
-				buffer.reset();
+				release_buffer();
 				capacity = 0;
 				size = 0;
 				shrink_counter = 0;
 				return new_buffer_result.error().forward("Create buffer failed");
 			}
 
+			release_buffer();
 			buffer = std::move(*new_buffer_result);
 			capacity = determined_size;
 			size = new_size;
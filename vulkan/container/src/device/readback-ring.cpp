@@ -0,0 +1,207 @@
+#include "vulkan/container/device/readback-ring.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/category.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <libassert/assert.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	std::expected<Buffer, Error> ReadbackRing::create_readback_buffer(
+		const Context& context,
+		size_t capacity
+	) noexcept
+	{
+		return context.allocator.create_buffer(
+			vk::BufferCreateInfo{.size = capacity, .usage = vk::BufferUsageFlagBits::eTransferDst},
+			MemoryUsage::GpuToCpu,
+			MemoryCategory::Staging
+		);
+	}
+
+	std::expected<ReadbackRing, Error> ReadbackRing::create(
+		const Context& context,
+		size_t slot_count,
+		size_t capacity
+	) noexcept
+	{
+		ASSUME(slot_count > 0);
+
+		const auto aligned_capacity = std::max((capacity + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, ALIGNMENT);
+
+		std::vector<Slot> slots;
+		slots.reserve(slot_count);
+		for (size_t i = 0; i < slot_count; i++)
+		{
+			auto buffer_result = create_readback_buffer(context, aligned_capacity);
+			if (!buffer_result) return buffer_result.error().forward("Create readback ring buffer failed");
+
+			std::vector<Buffer> buffers;
+			buffers.emplace_back(std::move(*buffer_result));
+			slots.push_back({.buffers = std::move(buffers), .capacity = aligned_capacity});
+		}
+
+		return ReadbackRing(std::move(slots));
+	}
+
+	std::expected<void, Error> ReadbackRing::begin_frame() noexcept
+	{
+		current = (current + 1) % slots.size();
+		auto& slot = slots[current];
+
+		std::vector<std::byte> data;
+		for (const auto& request : slot.requests)
+		{
+			data.resize(request.size);
+			const auto download_result = slot.buffers[request.buffer_index].download(data, request.offset);
+			if (!download_result)
+			{
+				slot.requests.clear();
+				return download_result.error().forward("Download readback ring buffer failed");
+			}
+
+			request.callback(data);
+		}
+
+		// Outgrown buffers are no longer referenced
+		if (slot.buffers.size() > 1) slot.buffers.erase(slot.buffers.begin(), slot.buffers.end() - 1);
+		slot.requests.clear();
+		slot.offset = 0;
+
+		return {};
+	}
+
+	std::expected<std::pair<size_t, size_t>, Error> ReadbackRing::allocate(
+		const Context& context,
+		size_t size
+	) noexcept
+	{
+		auto& slot = slots[current];
+		const auto aligned_size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+		// Outgrown, keep the current buffer alive for the copies already recorded into it
+		if (slot.offset + aligned_size > slot.capacity)
+		{
+			const auto new_capacity = std::max(slot.capacity * 2, aligned_size);
+
+			auto buffer_result = create_readback_buffer(context, new_capacity);
+			if (!buffer_result) return buffer_result.error().forward("Grow readback ring buffer failed");
+
+			slot.buffers.emplace_back(std::move(*buffer_result));
+			slot.capacity = new_capacity;
+			slot.offset = 0;
+		}
+
+		const auto offset = slot.offset;
+		slot.offset += aligned_size;
+
+		return std::make_pair(slot.buffers.size() - 1, offset);
+	}
+
+	std::expected<void, Error> ReadbackRing::read_buffer(
+		const Context& context,
+		const vk::raii::CommandBuffer& command_buffer,
+		vk::Buffer src_buffer,
+		size_t src_offset,
+		size_t size,
+		Callback callback
+	) noexcept
+	{
+		if (size == 0) return {};
+
+		const auto allocate_result = allocate(context, size);
+		if (!allocate_result) return allocate_result.error();
+		const auto [buffer_index, offset] = *allocate_result;
+
+		auto& slot = slots[current];
+
+		command_buffer.copyBuffer(
+			src_buffer,
+			slot.buffers[buffer_index],
+			vk::BufferCopy{.srcOffset = src_offset, .dstOffset = offset, .size = size}
+		);
+
+		slot.requests.push_back({
+			.buffer_index = buffer_index,
+			.offset = offset,
+			.size = size,
+			.callback = std::move(callback),
+		});
+
+		return {};
+	}
+
+	std::expected<void, Error> ReadbackRing::read_image(
+		const Context& context,
+		const vk::raii::CommandBuffer& command_buffer,
+		vk::Image src_image,
+		vk::ImageLayout src_layout,
+		vk::ImageAspectFlagBits aspect,
+		glm::u32vec2 extent,
+		size_t texel_size,
+		Callback callback
+	) noexcept
+	{
+		ASSUME(texel_size > 0 && ALIGNMENT % texel_size == 0);
+
+		const auto size = size_t(extent.x) * extent.y * texel_size;
+		if (size == 0) return {};
+
+		const auto allocate_result = allocate(context, size);
+		if (!allocate_result) return allocate_result.error();
+		const auto [buffer_index, offset] = *allocate_result;
+
+		auto& slot = slots[current];
+
+		const auto copy_region = vk::BufferImageCopy{
+			.bufferOffset = offset,
+			.imageSubresource = {.aspectMask = aspect, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1},
+			.imageOffset = {.x = 0,            .y = 0,             .z = 0    },
+			.imageExtent = {.width = extent.x, .height = extent.y, .depth = 1}
+		};
+		command_buffer.copyImageToBuffer(src_image, src_layout, slot.buffers[buffer_index], copy_region);
+
+		slot.requests.push_back({
+			.buffer_index = buffer_index,
+			.offset = offset,
+			.size = size,
+			.callback = std::move(callback),
+		});
+
+		return {};
+	}
+
+	std::optional<vk::MemoryBarrier2> ReadbackRing::host_barrier() const noexcept
+	{
+		if (slots[current].requests.empty()) return std::nullopt;
+
+		return vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eHost,
+			.dstAccessMask = vk::AccessFlagBits2::eHostRead
+		};
+	}
+
+	void ReadbackRing::discard() noexcept
+	{
+		for (auto& slot : slots)
+		{
+			if (slot.buffers.size() > 1) slot.buffers.erase(slot.buffers.begin(), slot.buffers.end() - 1);
+			slot.requests.clear();
+			slot.offset = 0;
+		}
+	}
+}
@@ -0,0 +1,128 @@
+#include "vulkan/container/device/upload-ring.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/alloc/category.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	std::expected<Buffer, Error> UploadRing::create_staging_buffer(
+		const Context& context,
+		size_t capacity
+	) noexcept
+	{
+		return context.allocator.create_buffer(
+			vk::BufferCreateInfo{.size = capacity, .usage = vk::BufferUsageFlagBits::eTransferSrc},
+			MemoryUsage::CpuToGpu,
+			MemoryCategory::Staging
+		);
+	}
+
+	std::expected<UploadRing, Error> UploadRing::create(const Context& context, size_t capacity) noexcept
+	{
+		const auto aligned_capacity = std::max((capacity + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, ALIGNMENT);
+
+		auto buffer_result = create_staging_buffer(context, aligned_capacity);
+		if (!buffer_result) return buffer_result.error().forward("Create upload ring buffer failed");
+
+		return UploadRing(std::move(*buffer_result), aligned_capacity);
+	}
+
+	void UploadRing::reset() noexcept
+	{
+		offset = 0;
+		retired_buffers.clear();
+		copies.clear();
+	}
+
+	std::expected<void, Error> UploadRing::push(
+		const Context& context,
+		std::span<const std::byte> data,
+		vk::Buffer dst_buffer,
+		size_t dst_offset
+	) noexcept
+	{
+		if (data.empty()) return {};
+
+		const auto aligned_size = (data.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+		// Outgrown, keep the current buffer alive for the copies already scheduled from it
+		if (offset + aligned_size > capacity)
+		{
+			const auto new_capacity = std::max(capacity * 2, aligned_size);
+
+			auto buffer_result = create_staging_buffer(context, new_capacity);
+			if (!buffer_result) return buffer_result.error().forward("Grow upload ring buffer failed");
+
+			retired_buffers.emplace_back(std::exchange(buffer, std::move(*buffer_result)));
+			capacity = new_capacity;
+			offset = 0;
+		}
+
+		if (const auto result = buffer.upload(data, offset); !result)
+			return result.error().forward("Write upload ring buffer failed");
+
+		copies.push_back({
+			.src_buffer = buffer,
+			.dst_buffer = dst_buffer,
+			.region = {.srcOffset = offset, .dstOffset = dst_offset, .size = data.size()}
+		});
+		offset += aligned_size;
+
+		return {};
+	}
+
+	std::optional<vk::MemoryBarrier2> UploadRing::record(
+		const vk::raii::CommandBuffer& command_buffer,
+		vk::PipelineStageFlags2 dst_stage_mask,
+		vk::AccessFlags2 dst_access_mask
+	) noexcept
+	{
+		if (copies.empty()) return std::nullopt;
+
+		// Group the copies sharing source and destination buffers into a single command
+		std::ranges::stable_sort(copies, {}, [](const Copy& copy) {
+			return std::pair(
+				static_cast<VkBuffer>(copy.src_buffer),
+				static_cast<VkBuffer>(copy.dst_buffer)
+			);
+		});
+
+		const auto same_buffers = [](const Copy& a, const Copy& b) {
+			return a.src_buffer == b.src_buffer && a.dst_buffer == b.dst_buffer;
+		};
+
+		std::vector<vk::BufferCopy2> regions;
+		for (const auto& group : copies | std::views::chunk_by(same_buffers))
+		{
+			regions.assign_range(group | std::views::transform(&Copy::region));
+
+			command_buffer.copyBuffer2(
+				vk::CopyBufferInfo2()
+					.setSrcBuffer(group.front().src_buffer)
+					.setDstBuffer(group.front().dst_buffer)
+					.setRegions(regions)
+			);
+		}
+
+		copies.clear();
+
+		return vk::MemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = dst_stage_mask,
+			.dstAccessMask = dst_access_mask
+		};
+	}
+}
@@ -110,6 +110,26 @@ TEST_CASE("Cycle")
 	CHECK_EQ(cycle.prev(), 2);
 }
 
+TEST_CASE("History")
+{
+	const std::vector<int> items = {1, 2, 3};
+	auto cycle = vulkan::Cycle(items);
+
+	cycle.cycle();
+
+	// [3, 1, 2]
+	CHECK_EQ(cycle.history(0), cycle.current());
+	CHECK_EQ(cycle.history(1), cycle.prev());
+	CHECK_EQ(cycle.history(2), 1);
+
+	cycle.cycle();
+
+	// [2, 3, 1]
+	CHECK_EQ(cycle.history(0), 1);
+	CHECK_EQ(cycle.history(1), 2);
+	CHECK_EQ(cycle.history(2), 3);
+}
+
 TEST_CASE("Iterate")
 {
 	SUBCASE("Iterate through items")
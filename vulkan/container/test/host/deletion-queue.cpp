@@ -0,0 +1,89 @@
+#include "vulkan/container/host/deletion-queue.hpp"
+
+#include <doctest.h>
+#include <memory>
+#include <utility>
+
+namespace
+{
+	struct DestroyCounter
+	{
+		std::shared_ptr<int> counter;
+
+		explicit DestroyCounter(std::shared_ptr<int> counter) :
+			counter(std::move(counter))
+		{}
+
+		DestroyCounter(const DestroyCounter&) = delete;
+		DestroyCounter& operator=(const DestroyCounter&) = delete;
+		DestroyCounter(DestroyCounter&&) = default;
+		DestroyCounter& operator=(DestroyCounter&&) = default;
+
+		~DestroyCounter()
+		{
+			if (counter) (*counter)++;
+		}
+	};
+}
+
+TEST_CASE("Latency")
+{
+	const auto counter = std::make_shared<int>(0);
+	auto queue = vulkan::DeletionQueue(2);
+
+	queue.retire(DestroyCounter(counter));
+	CHECK_EQ(*counter, 0);
+	CHECK_EQ(queue.size(), 1);
+
+	queue.advance();
+	CHECK_EQ(*counter, 0);
+
+	queue.advance();
+	CHECK_EQ(*counter, 1);
+	CHECK_EQ(queue.size(), 0);
+}
+
+TEST_CASE("Retired in different frames")
+{
+	const auto counter = std::make_shared<int>(0);
+	auto queue = vulkan::DeletionQueue(2);
+
+	queue.retire(DestroyCounter(counter));
+	queue.advance();
+	queue.retire(DestroyCounter(counter));
+	queue.retire(DestroyCounter(counter));
+	CHECK_EQ(queue.size(), 3);
+
+	queue.advance();
+	CHECK_EQ(*counter, 1);
+	CHECK_EQ(queue.size(), 2);
+
+	queue.advance();
+	CHECK_EQ(*counter, 3);
+	CHECK_EQ(queue.size(), 0);
+}
+
+TEST_CASE("Flush")
+{
+	const auto counter = std::make_shared<int>(0);
+	auto queue = vulkan::DeletionQueue(3);
+
+	queue.retire(DestroyCounter(counter));
+	queue.retire(DestroyCounter(counter));
+	queue.flush();
+
+	CHECK_EQ(*counter, 2);
+	CHECK_EQ(queue.size(), 0);
+}
+
+TEST_CASE("Destroyed with queue")
+{
+	const auto counter = std::make_shared<int>(0);
+
+	{
+		auto queue = vulkan::DeletionQueue(2);
+		queue.retire(DestroyCounter(counter));
+	}
+
+	CHECK_EQ(*counter, 1);
+}
@@ -0,0 +1,116 @@
+#include "vulkan/container/host/frame-arena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <memory_resource>
+#include <ranges>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Upstream resource counting the live allocations
+	class CountingResource final : public std::pmr::memory_resource
+	{
+	  public:
+
+		size_t live = 0;
+		size_t total = 0;
+
+	  private:
+
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			live++;
+			total++;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) noexcept override
+		{
+			live--;
+			std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+}
+
+TEST_CASE("Bump allocation")
+{
+	CountingResource upstream;
+	vulkan::FrameArena arena(1024, upstream);
+	CHECK_EQ(upstream.live, 1);
+
+	const auto* const first = static_cast<std::byte*>(arena.allocate(10, 1));
+	const auto* const second = static_cast<std::byte*>(arena.allocate(10, 1));
+	CHECK_EQ(second, first + 10);
+	CHECK_EQ(arena.used_bytes(), 20);
+	CHECK_EQ(upstream.live, 1);
+
+	arena.reset();
+	CHECK_EQ(arena.used_bytes(), 0);
+	CHECK_EQ(arena.allocate(10, 1), first);
+}
+
+TEST_CASE("Alignment")
+{
+	vulkan::FrameArena arena(1024);
+
+	[[maybe_unused]] const auto* const unaligned = arena.allocate(1, 1);
+	for (const auto alignment : {2zu, 8zu, 64zu})
+	{
+		const auto* const ptr = arena.allocate(1, alignment);
+		CHECK_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+	}
+}
+
+TEST_CASE("Overflow and growth")
+{
+	CountingResource upstream;
+	vulkan::FrameArena arena(64, upstream);
+
+	[[maybe_unused]] const auto* const fit = arena.allocate(48, 8);
+	[[maybe_unused]] const auto* const overflow = arena.allocate(48, 8);
+	CHECK_EQ(upstream.live, 2);
+
+	// Buffer grows to the peak usage of the previous frame
+	arena.reset();
+	CHECK_EQ(upstream.live, 1);
+	CHECK_GE(arena.capacity_bytes(), 96);
+
+	// Same usage no longer allocates
+	const auto total = upstream.total;
+	[[maybe_unused]] const auto* const first = arena.allocate(48, 8);
+	[[maybe_unused]] const auto* const second = arena.allocate(48, 8);
+	CHECK_EQ(upstream.total, total);
+}
+
+TEST_CASE("Polymorphic containers")
+{
+	CountingResource upstream;
+	vulkan::FrameArena arena(0, upstream);
+
+	for (const auto frame : std::views::iota(0, 4))
+	{
+		arena.reset();
+		const auto total = upstream.total;
+
+		{
+			std::pmr::vector<int> values(&arena);
+			for (const auto i : std::views::iota(0, 1000)) values.push_back(i + frame);
+			std::pmr::string text("a string too long for small string optimization", &arena);
+
+			CHECK_EQ(values.back(), 999 + frame);
+		}
+
+		// Steady state after the first frame grows the buffer
+		if (frame > 1) CHECK_EQ(upstream.total, total);
+	}
+
+	CHECK_EQ(upstream.live, 1);
+}
@@ -0,0 +1,74 @@
+#include "vulkan/container/host/range-allocator.hpp"
+
+#include <cstdint>
+#include <doctest.h>
+#include <tuple>
+
+namespace
+{
+	vulkan::RangeAllocator::Range range(uint64_t offset, uint64_t size)
+	{
+		return {.offset = offset, .size = size};
+	}
+}
+
+TEST_CASE("First fit")
+{
+	auto allocator = vulkan::RangeAllocator(100);
+
+	CHECK_EQ(allocator.allocate(30), range(0, 30));
+	CHECK_EQ(allocator.allocate(30), range(30, 30));
+	CHECK_EQ(allocator.get_free_size(), 40);
+
+	CHECK_FALSE(allocator.allocate(50).has_value());
+	CHECK_EQ(allocator.allocate(40), range(60, 40));
+	CHECK_EQ(allocator.get_free_size(), 0);
+	CHECK_EQ(allocator.get_free_range_count(), 0);
+}
+
+TEST_CASE("Alignment")
+{
+	auto allocator = vulkan::RangeAllocator(64);
+
+	CHECK_EQ(allocator.allocate(3), range(0, 3));
+	CHECK_EQ(allocator.allocate(8, 16), range(16, 8));
+
+	// Padding in front of the aligned range stays free
+	CHECK_EQ(allocator.allocate(13), range(3, 13));
+	CHECK_EQ(allocator.get_free_size(), 64 - 3 - 8 - 13);
+}
+
+TEST_CASE("Free and merge")
+{
+	auto allocator = vulkan::RangeAllocator(90);
+
+	const auto a = allocator.allocate(30).value();
+	const auto b = allocator.allocate(30).value();
+	const auto c = allocator.allocate(30).value();
+
+	allocator.free(a);
+	allocator.free(c);
+	CHECK_EQ(allocator.get_free_range_count(), 2);
+	CHECK_FALSE(allocator.allocate(60).has_value());
+
+	// Freeing the middle range merges with both neighbours
+	allocator.free(b);
+	CHECK_EQ(allocator.get_free_range_count(), 1);
+	CHECK_EQ(allocator.get_free_size(), 90);
+	CHECK_EQ(allocator.allocate(90), range(0, 90));
+}
+
+TEST_CASE("Reuse freed range")
+{
+	auto allocator = vulkan::RangeAllocator(100);
+
+	const auto a = allocator.allocate(40).value();
+	std::ignore = allocator.allocate(40).value();
+	allocator.free(a);
+
+	CHECK_EQ(allocator.allocate(10), range(0, 10));
+	CHECK_EQ(allocator.allocate(20), range(10, 20));
+	CHECK_EQ(allocator.allocate(20), range(80, 20));
+	CHECK_EQ(allocator.allocate(10), range(30, 10));
+	CHECK_FALSE(allocator.allocate(1).has_value());
+}
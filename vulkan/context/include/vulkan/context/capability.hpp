@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief Capabilities of a physical device, probed without creating a logical device
+	/// @details Unlike `DeviceFeature`, nothing is required here. Used to scale the rendering settings to the
+	/// device, see `get_tier`.
+	///
+	struct DeviceCapability
+	{
+		///
+		/// @brief Coarse performance class of a device
+		///
+		enum class Tier
+		{
+			Low,     // Integrated or small discrete GPUs
+			Medium,  // Mainstream discrete GPUs
+			High     // High-end discrete GPUs with every optional feature
+		};
+
+		bool integrated = false;             // Integrated GPU, device-local memory is shared with the host
+		bool ray_query = false;              // Acceleration structures and ray queries
+		bool mesh_shader = false;            // Task and mesh shaders
+		bool fragment_shading_rate = false;  // Pipeline and attachment fragment shading rate
+		bool resizable_bar = false;          // Host-visible device-local memory beyond the 256 MiB window
+		uint32_t subgroup_size = 0;          // Default subgroup size
+		uint64_t device_local_size = 0;      // Total size of the device-local heaps, in bytes
+
+		///
+		/// @brief Probe the capabilities of a physical device
+		///
+		/// @param phy_device Physical device to probe
+		/// @return Probed capabilities
+		///
+		[[nodiscard]]
+		static DeviceCapability probe(const vk::raii::PhysicalDevice& phy_device) noexcept;
+
+		///
+		/// @brief Classify the device into a tier
+		/// @details
+		/// - `Low`: integrated, without ray queries, or under 4 GiB of device-local memory
+		/// - `High`: at least 8 GiB of device-local memory, with mesh shaders and fragment shading rate
+		/// - `Medium`: otherwise
+		///
+		/// @return Tier of the device
+		///
+		[[nodiscard]]
+		Tier get_tier() const noexcept;
+	};
+}
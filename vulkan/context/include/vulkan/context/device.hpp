@@ -3,17 +3,26 @@
 #include "common/util/error.hpp"
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/context/instance.hpp"
+#include "vulkan/context/pipeline-cache.hpp"
 #include "vulkan/interface/context.hpp"
 
 #include <cstdint>
 #include <expected>
+#include <filesystem>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <utility>
+#include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace vulkan
 {
+	namespace impl
+	{
+		struct HeadlessDeviceInfo;
+	}
+
 	struct DeviceQueue
 	{
 		std::shared_ptr<const vk::raii::Queue> queue;
@@ -28,10 +37,38 @@ namespace vulkan
 	{
 	  public:
 
+		///
+		/// @brief Create a headless device context
+		///
+		/// @param context Headless instance
+		/// @param feature Device features
+		/// @param pipeline_cache_dir Directory to persist the pipeline cache, `std::nullopt` for in-memory
+		/// cache
+		/// @return Created context, or error
+		///
 		[[nodiscard]]
 		static std::expected<HeadlessDeviceContext, Error> create(
 			const HeadlessInstanceContext& context,
-			const DeviceFeature& feature
+			const DeviceFeature& feature,
+			std::optional<std::filesystem::path> pipeline_cache_dir = std::nullopt
+		) noexcept;
+
+		///
+		/// @brief Create a headless device context on every suitable physical device
+		/// @details Contexts are ordered by rank, best device first. Each context is fully independent, so
+		/// work can be distributed across devices by giving every context its own resources.
+		///
+		/// @param context Headless instance
+		/// @param feature Device features, required on every device
+		/// @param pipeline_cache_dir Directory to persist the pipeline caches, `std::nullopt` for in-memory
+		/// caches. Devices of the same model and driver share a cache file.
+		/// @return Created contexts, at least one, or error
+		///
+		[[nodiscard]]
+		static std::expected<std::vector<HeadlessDeviceContext>, Error> create_all(
+			const HeadlessInstanceContext& context,
+			const DeviceFeature& feature,
+			std::optional<std::filesystem::path> pipeline_cache_dir = std::nullopt
 		) noexcept;
 
 		///
@@ -46,21 +83,37 @@ namespace vulkan
 				.phy_device = *phy_device,
 				.device = *device,
 				.allocator = *allocator,
+				.pipeline_cache = pipeline_cache.get(),
 				.queue = *render_queue.queue,
 				.submit_mutex = *submit_mutex,
 				.family = render_queue.family_index,
+				.compute_queue = *compute_queue.queue,
+				.compute_family = compute_queue.family_index,
+				.transfer_queue = *transfer_queue.queue,
+				.transfer_family = transfer_queue.family_index,
 				.feature = device_feature,
 			};
 		}
 
 	  private:
 
+		[[nodiscard]]
+		static std::expected<HeadlessDeviceContext, Error> create_from(
+			const HeadlessInstanceContext& context,
+			const impl::HeadlessDeviceInfo& device_info,
+			const DeviceFeature& feature,
+			std::optional<std::filesystem::path> pipeline_cache_dir
+		) noexcept;
+
 		std::unique_ptr<vk::raii::PhysicalDevice> phy_device;
 		std::unique_ptr<vk::raii::Device> device;
 		std::unique_ptr<vulkan::Allocator> allocator;
+		PipelineCache pipeline_cache;
 		std::unique_ptr<std::mutex> submit_mutex;
 
 		DeviceQueue render_queue;
+		DeviceQueue compute_queue;
+		DeviceQueue transfer_queue;
 
 		DeviceFeature device_feature;
 
@@ -68,14 +121,20 @@ namespace vulkan
 			vk::raii::PhysicalDevice phy_device,
 			vk::raii::Device device,
 			vulkan::Allocator allocator,
+			PipelineCache pipeline_cache,
 			DeviceQueue render_queue,
+			DeviceQueue compute_queue,
+			DeviceQueue transfer_queue,
 			DeviceFeature device_option
 		) :
 			phy_device(std::make_unique<vk::raii::PhysicalDevice>(std::move(phy_device))),
 			device(std::make_unique<vk::raii::Device>(std::move(device))),
 			allocator(std::make_unique<vulkan::Allocator>(std::move(allocator))),
+			pipeline_cache(std::move(pipeline_cache)),
 			submit_mutex(std::make_unique<std::mutex>()),
 			render_queue(std::move(render_queue)),
+			compute_queue(std::move(compute_queue)),
+			transfer_queue(std::move(transfer_queue)),
 			device_feature(device_option)
 		{}
 
@@ -100,12 +159,15 @@ namespace vulkan
 		///
 		/// @param context Surface instance
 		/// @param config Device config
+		/// @param pipeline_cache_dir Directory to persist the pipeline cache, `std::nullopt` for in-memory
+		/// cache
 		/// @return Create context, or error
 		///
 		[[nodiscard]]
 		static std::expected<SurfaceDeviceContext, Error> create(
 			const SurfaceInstanceContext& context,
-			const DeviceFeature& feature
+			const DeviceFeature& feature,
+			std::optional<std::filesystem::path> pipeline_cache_dir = std::nullopt
 		) noexcept;
 
 		///
@@ -131,13 +193,40 @@ namespace vulkan
 				.phy_device = *phy_device,
 				.device = *device,
 				.allocator = *allocator,
+				.pipeline_cache = pipeline_cache.get(),
 				.queue = *render_queue.queue,
 				.submit_mutex = *submit_mutex,
 				.family = render_queue.family_index,
+				.compute_queue = *compute_queue.queue,
+				.compute_family = compute_queue.family_index,
+				.transfer_queue = *transfer_queue.queue,
+				.transfer_family = transfer_queue.family_index,
 				.feature = device_feature,
 			};
 		}
 
+		///
+		/// @brief Whether `VK_KHR_present_id` and `VK_KHR_present_wait` are enabled
+		///
+		/// @return `true` if presents can be tagged with IDs and waited on, see `SwapchainContext`
+		///
+		[[nodiscard]]
+		bool supports_present_wait() const noexcept
+		{
+			return present_wait;
+		}
+
+		///
+		/// @brief Whether `VK_EXT_swapchain_maintenance1` is enabled
+		///
+		/// @return `true` if presents can signal fences, so that old swapchains are retired without idling
+		///
+		[[nodiscard]]
+		bool supports_swapchain_maintenance() const noexcept
+		{
+			return swapchain_maintenance;
+		}
+
 		[[nodiscard]]
 		const vk::raii::Device* operator->() const noexcept
 		{
@@ -149,28 +238,43 @@ namespace vulkan
 		std::unique_ptr<vk::raii::PhysicalDevice> phy_device;
 		std::unique_ptr<vk::raii::Device> device;
 		std::unique_ptr<vulkan::Allocator> allocator;
+		PipelineCache pipeline_cache;
 		std::unique_ptr<std::mutex> submit_mutex;
 
 		DeviceQueue render_queue;
 		DeviceQueue present_queue;
+		DeviceQueue compute_queue;
+		DeviceQueue transfer_queue;
 
 		DeviceFeature device_feature;
+		bool present_wait;
+		bool swapchain_maintenance;
 
 		explicit SurfaceDeviceContext(
 			vk::raii::PhysicalDevice phy_device,
 			vk::raii::Device device,
 			vulkan::Allocator allocator,
+			PipelineCache pipeline_cache,
 			DeviceQueue render_queue,
 			DeviceQueue present_queue,
-			DeviceFeature device_feature
+			DeviceQueue compute_queue,
+			DeviceQueue transfer_queue,
+			DeviceFeature device_feature,
+			bool present_wait,
+			bool swapchain_maintenance
 		) :
 			phy_device(std::make_unique<vk::raii::PhysicalDevice>(std::move(phy_device))),
 			device(std::make_unique<vk::raii::Device>(std::move(device))),
 			allocator(std::make_unique<vulkan::Allocator>(std::move(allocator))),
+			pipeline_cache(std::move(pipeline_cache)),
 			submit_mutex(std::make_unique<std::mutex>()),
 			render_queue(std::move(render_queue)),
 			present_queue(std::move(present_queue)),
-			device_feature(device_feature)
+			compute_queue(std::move(compute_queue)),
+			transfer_queue(std::move(transfer_queue)),
+			device_feature(device_feature),
+			present_wait(present_wait),
+			swapchain_maintenance(swapchain_maintenance)
 		{}
 
 	  public:
@@ -177,18 +177,21 @@ namespace vulkan
 		std::unique_ptr<Window> window;
 		std::unique_ptr<vk::raii::Instance> instance;
 		std::unique_ptr<Surface> surface;
+		bool surface_maintenance;
 
 		explicit SurfaceInstanceContext(
 			vk::raii::Context context,
 			std::unique_ptr<Window> window,
 			vk::raii::Instance instance,
-			std::unique_ptr<Surface> surface
+			std::unique_ptr<Surface> surface,
+			bool surface_maintenance
 		) noexcept :
 			context_destroyer(std::make_unique<SDLContextDestroyer>()),
 			context(std::move(context)),
 			window(std::move(window)),
 			instance(std::make_unique<vk::raii::Instance>(std::move(instance))),
-			surface(std::move(surface))
+			surface(std::move(surface)),
+			surface_maintenance(surface_maintenance)
 		{}
 
 		struct VisitProxy
@@ -196,6 +199,7 @@ namespace vulkan
 			const vk::raii::Instance& instance;
 			SDL_Window* window;
 			vk::SurfaceKHR surface;
+			bool surface_maintenance;  // Whether `VK_EXT_surface_maintenance1` is enabled
 
 			const VisitProxy* operator->() const noexcept { return this; }
 		};
@@ -204,7 +208,12 @@ namespace vulkan
 
 		VisitProxy operator->() const noexcept
 		{
-			return VisitProxy{.instance = *instance, .window = window->get(), .surface = surface->get()};
+			return VisitProxy{
+				.instance = *instance,
+				.window = window->get(),
+				.surface = surface->get(),
+				.surface_maintenance = surface_maintenance
+			};
 		}
 
 		SurfaceInstanceContext(const SurfaceInstanceContext&) = delete;
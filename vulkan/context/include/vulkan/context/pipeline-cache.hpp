@@ -0,0 +1,80 @@
+#pragma once
+
+#include "common/util/error.hpp"
+
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief Pipeline cache, optionally persisted on disk
+	/// @details
+	/// - Cache file is keyed by the pipeline cache UUID and driver version of the physical device, stored as
+	/// `<directory>/pipeline-<uuid>-<driver version>.bin`. Files from other devices or drivers are never
+	/// loaded.
+	/// - The loaded data is validated against the device before being handed to the driver; mismatched or
+	/// corrupted data is discarded and an empty cache is created instead.
+	/// - The cache is saved on destruction when a directory is given, errors are ignored in that case. Use
+	/// `save()` to handle these errors.
+	///
+	class PipelineCache
+	{
+	  public:
+
+		///
+		/// @brief Create a pipeline cache
+		///
+		/// @param phy_device Physical device
+		/// @param device Logical device
+		/// @param directory Directory to load and save the cache file, `std::nullopt` for in-memory cache
+		/// @return Created pipeline cache or error
+		///
+		[[nodiscard]]
+		static std::expected<PipelineCache, Error> create(
+			const vk::raii::PhysicalDevice& phy_device,
+			const vk::raii::Device& device,
+			std::optional<std::filesystem::path> directory = std::nullopt
+		) noexcept;
+
+		///
+		/// @brief Save the cache to disk, does nothing if no directory is given
+		///
+		/// @return `void` if success, or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> save() const noexcept;
+
+		[[nodiscard]]
+		const vk::raii::PipelineCache& get() const noexcept
+		{
+			return *cache;
+		}
+
+		~PipelineCache() noexcept;
+
+	  private:
+
+		std::unique_ptr<vk::raii::PipelineCache> cache;
+		std::optional<std::filesystem::path> path;
+
+		explicit PipelineCache(
+			std::unique_ptr<vk::raii::PipelineCache> cache,
+			std::optional<std::filesystem::path> path
+		) :
+			cache(std::move(cache)),
+			path(std::move(path))
+		{}
+
+	  public:
+
+		PipelineCache(const PipelineCache&) = delete;
+		PipelineCache(PipelineCache&&) = default;
+		PipelineCache& operator=(const PipelineCache&) = delete;
+		PipelineCache& operator=(PipelineCache&&) = default;
+	};
+}
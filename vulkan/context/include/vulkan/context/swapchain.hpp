@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
 #include <expected>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <glm/glm.hpp>
@@ -51,9 +52,22 @@ namespace vulkan
 	/// acquisition. If `true`, resources dependent on the extent should be recreated.
 	/// - Access the latest extent through `swapchain_context->extent`
 	///
+	/// #### Recreation
+	/// The swapchain is recreated on resize or when it becomes out of date, passing the old one as
+	/// `oldSwapchain`. If the device supports swapchain maintenance (see
+	/// `SurfaceDeviceContext::supports_swapchain_maintenance`), each present signals a fence and the old
+	/// swapchain is destroyed once all of its presents have released their images, so frames in flight keep
+	/// rendering. Otherwise, the device is waited idle before recreation.
+	///
 	/// #### Presenting Frames
 	/// Call @p present to present a rendered frame. See the function for details.
 	///
+	/// #### Frame Pacing
+	/// If the device supports present wait (see `SurfaceDeviceContext::supports_present_wait`), each present
+	/// is tagged with a monotonically increasing ID, retrieve it with @p last_present_id after presenting.
+	/// Call @p wait_present to block until a tagged present has reached the display, e.g. to start the CPU
+	/// work of a frame just in time instead of queueing frames ahead.
+	///
 	class SwapchainContext
 	{
 	  public:
@@ -127,6 +141,31 @@ namespace vulkan
 			std::optional<vk::Semaphore> wait_semaphore = std::nullopt
 		) noexcept;
 
+		///
+		/// @brief Get the ID of the latest present
+		///
+		/// @return Present ID, or `std::nullopt` if present wait is not supported or nothing was presented
+		///
+		[[nodiscard]]
+		std::optional<uint64_t> last_present_id() const noexcept
+		{
+			if (!present_wait || present_count == 0) return std::nullopt;
+			return present_count;
+		}
+
+		///
+		/// @brief Wait until a present has reached the display
+		///
+		/// @param present_id Present ID acquired from @p last_present_id
+		/// @param timeout Timeout in nanoseconds
+		///
+		/// @retval true Present completed, or will never complete as the swapchain has been recreated since
+		/// @retval false Timed out
+		/// @retval Error Error occurred during waiting
+		///
+		[[nodiscard]]
+		std::expected<bool, Error> wait_present(uint64_t present_id, uint64_t timeout) const noexcept;
+
 	  private:
 
 		/* Swapchain Configuration */
@@ -136,6 +175,10 @@ namespace vulkan
 		vk::SurfaceFormatKHR surface_format;
 		vk::PresentModeKHR present_mode;
 		uint32_t image_count;
+		bool present_wait;
+		bool swapchain_maintenance;
+
+		uint64_t present_count = 0;  // Also the ID of the latest present, IDs start from 1
 
 		/* Swapchain State Machine */
 
@@ -147,22 +190,39 @@ namespace vulkan
 			std::vector<vk::Image> images;
 			std::vector<vk::raii::ImageView> image_views;
 
+			uint64_t first_present_id;  // Presents before it belong to retired swapchains
 			bool extent_changed = true;
+
+			// Signaled when presents have released their images, in present order. Swapchain maintenance only
+			std::deque<vk::raii::Fence> present_fences = {};
+		};
+
+		struct RetiredSwapchain
+		{
+			vk::raii::SwapchainKHR swapchain;
+			std::vector<vk::raii::ImageView> image_views;
+			std::deque<vk::raii::Fence> present_fences;
 		};
 
 		struct InvalidatedState
 		{
-			vk::raii::SwapchainKHR old_swapchain;
+			RetiredSwapchain old_swapchain;
 		};
 
 		std::variant<std::monostate, RuntimeState, InvalidatedState> state = std::monostate();
 
+		// Replaced swapchains still used by pending presents, destroyed once their fences are signaled
+		std::vector<RetiredSwapchain> retired_swapchains;
+		std::vector<vk::raii::Fence> free_present_fences;
+
 		explicit SwapchainContext(
 			vk::SharingMode sharing_mode,
 			std::vector<uint32_t> queue_family_indices,
 			vk::SurfaceFormatKHR surface_format,
 			vk::PresentModeKHR present_mode,
-			uint32_t image_count
+			uint32_t image_count,
+			bool present_wait,
+			bool swapchain_maintenance
 		) noexcept :
 			sharing_mode(sharing_mode),
 			queue_family_indices(
@@ -170,7 +230,9 @@ namespace vulkan
 			),
 			surface_format(surface_format),
 			present_mode(present_mode),
-			image_count(image_count)
+			image_count(image_count),
+			present_wait(present_wait),
+			swapchain_maintenance(swapchain_maintenance)
 		{}
 
 		[[nodiscard]]
@@ -180,6 +242,28 @@ namespace vulkan
 			glm::u32vec2 extent
 		) noexcept;
 
+		// Invalidate the current swapchain, waits idle if present fences are not supported
+		[[nodiscard]]
+		std::expected<void, Error> invalidate(const SurfaceDeviceContext& device_context) noexcept;
+
+		// Move the signaled fences at the front of `fences` into the free list
+		[[nodiscard]]
+		std::expected<void, Error> recycle_present_fences(
+			const SurfaceDeviceContext& device_context,
+			std::deque<vk::raii::Fence>& fences
+		) noexcept;
+
+		// Destroy the retired swapchains whose presents have all completed
+		[[nodiscard]]
+		std::expected<void, Error> collect_retired_swapchains(
+			const SurfaceDeviceContext& device_context
+		) noexcept;
+
+		[[nodiscard]]
+		std::expected<vk::raii::Fence, Error> take_present_fence(
+			const SurfaceDeviceContext& device_context
+		) noexcept;
+
 		struct ReadonlyWrapper
 		{
 			vk::SharingMode sharing_mode;
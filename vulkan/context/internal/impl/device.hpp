@@ -27,15 +27,20 @@ namespace vulkan::impl
 		vulkan::LinkedStruct<vk::PhysicalDeviceFeatures2> features;
 		std::vector<std::string> extensions;
 		uint32_t render_family_index;
+		uint32_t compute_family_index;
+		uint32_t transfer_family_index;
 		float rank;
 
 		///
-		/// @brief Create a headless device and a render queue
+		/// @brief Create a headless device and render+compute+transfer queue
 		///
-		/// @return `(Device, Render Queue)` or error
+		/// @return `(Device, Render Queue, Compute Queue, Transfer Queue)` or error
 		///
 		[[nodiscard]]
-		std::expected<std::pair<vk::raii::Device, DeviceQueue>, Error> create_device() const noexcept;
+		std::expected<
+			std::tuple<vk::raii::Device, DeviceQueue, DeviceQueue, DeviceQueue>,
+			Error
+		> create_device() const noexcept;
 	};
 
 	///
@@ -49,16 +54,18 @@ namespace vulkan::impl
 		std::vector<std::string> extensions;
 		uint32_t render_family_index;
 		uint32_t present_family_index;
+		uint32_t compute_family_index;
+		uint32_t transfer_family_index;
 		float rank;
 
 		///
-		/// @brief Create a surface device and render+present queue
+		/// @brief Create a surface device and render+present+compute+transfer queue
 		///
-		/// @return `(Device, Render Queue, Present Queue)` or error
+		/// @return `(Device, Render Queue, Present Queue, Compute Queue, Transfer Queue)` or error
 		///
 		[[nodiscard]]
 		std::expected<
-			std::tuple<vk::raii::Device, DeviceQueue, DeviceQueue>,
+			std::tuple<vk::raii::Device, DeviceQueue, DeviceQueue, DeviceQueue, DeviceQueue>,
 			Error
 		> create_device() const noexcept;
 	};
@@ -41,16 +41,25 @@ namespace vulkan::impl
 		const InstanceConfig& instance_config
 	) noexcept;
 
+	///
+	/// @brief Stores the result of creating a surface instance
+	///
+	struct SurfaceInstanceInfo
+	{
+		vk::raii::Instance instance;
+		bool surface_maintenance;  // Whether `VK_EXT_surface_maintenance1` is enabled
+	};
+
 	///
 	/// @brief Create a surface instance
 	///
 	/// @param context Vulkan context
 	/// @param instance_config Instance config
 	/// @param window_config Window config
-	/// @return Created instance or error
+	/// @return Created instance with its optional extensions, or error
 	///
 	[[nodiscard]]
-	std::expected<vk::raii::Instance, Error> create_instance_surface(
+	std::expected<SurfaceInstanceInfo, Error> create_instance_surface(
 		const vk::raii::Context& context,
 		const InstanceConfig& instance_config,
 		const WindowConfig& window_config
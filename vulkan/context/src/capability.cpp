@@ -0,0 +1,133 @@
+#include "vulkan/context/capability.hpp"
+#include "common/number-literals.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <ranges>
+#include <set>
+#include <span>
+#include <string>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	namespace
+	{
+		// Size of the host-visible device-local heap without resizable BAR
+		constexpr uint64_t LEGACY_BAR_SIZE = 256_u64 * 1024 * 1024;
+
+		constexpr uint64_t LOW_TIER_MEMORY = 4_u64 * 1024 * 1024 * 1024;
+		constexpr uint64_t HIGH_TIER_MEMORY = 8_u64 * 1024 * 1024 * 1024;
+
+		bool supports_resizable_bar(const vk::PhysicalDeviceMemoryProperties& memory_properties) noexcept
+		{
+			constexpr auto required_flags =
+				vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible;
+
+			const auto memory_types =
+				std::span(memory_properties.memoryTypes).first(memory_properties.memoryTypeCount);
+
+			return std::ranges::any_of(memory_types, [&memory_properties](const vk::MemoryType& type) {
+				return (type.propertyFlags & required_flags) == required_flags
+					&& memory_properties.memoryHeaps[type.heapIndex].size > LEGACY_BAR_SIZE;
+			});
+		}
+
+		uint64_t get_device_local_size(const vk::PhysicalDeviceMemoryProperties& memory_properties) noexcept
+		{
+			const auto heaps =
+				std::span(memory_properties.memoryHeaps).first(memory_properties.memoryHeapCount);
+
+			return std::ranges::fold_left(
+				heaps
+					| std::views::filter([](const vk::MemoryHeap& heap) {
+						  return static_cast<bool>(heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+					  })
+					| std::views::transform(&vk::MemoryHeap::size),
+				0_u64,
+				std::plus()
+			);
+		}
+
+		bool supports_ray_query(const vk::raii::PhysicalDevice& phy_device) noexcept
+		{
+			const auto features = phy_device.getFeatures2<
+				vk::PhysicalDeviceFeatures2,
+				vk::PhysicalDeviceAccelerationStructureFeaturesKHR,
+				vk::PhysicalDeviceRayQueryFeaturesKHR
+			>();
+
+			return features.get<vk::PhysicalDeviceAccelerationStructureFeaturesKHR>().accelerationStructure
+				== vk::True
+				&& features.get<vk::PhysicalDeviceRayQueryFeaturesKHR>().rayQuery == vk::True;
+		}
+
+		bool supports_mesh_shader(const vk::raii::PhysicalDevice& phy_device) noexcept
+		{
+			const auto features = phy_device
+				.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceMeshShaderFeaturesEXT>()
+				.get<vk::PhysicalDeviceMeshShaderFeaturesEXT>();
+
+			return features.taskShader == vk::True && features.meshShader == vk::True;
+		}
+
+		bool supports_fragment_shading_rate(const vk::raii::PhysicalDevice& phy_device) noexcept
+		{
+			const auto available_features = phy_device.getFeatures2<
+				vk::PhysicalDeviceFeatures2,
+				vk::PhysicalDeviceFragmentShadingRateFeaturesKHR
+			>();
+
+			const auto& features = available_features.get<vk::PhysicalDeviceFragmentShadingRateFeaturesKHR>();
+			return features.pipelineFragmentShadingRate == vk::True
+				&& features.attachmentFragmentShadingRate == vk::True;
+		}
+	}
+
+	DeviceCapability DeviceCapability::probe(const vk::raii::PhysicalDevice& phy_device) noexcept
+	{
+		const auto properties = phy_device.getProperties2<
+			vk::PhysicalDeviceProperties2,
+			vk::PhysicalDeviceVulkan11Properties
+		>();
+		const auto memory_properties = phy_device.getMemoryProperties();
+
+		const auto extensions_result = phy_device.enumerateDeviceExtensionProperties();
+		const auto extensions = extensions_result
+			? *extensions_result
+				| std::views::transform([](const vk::ExtensionProperties& extension) {
+					  return std::string(extension.extensionName.data());
+				  })
+				| std::ranges::to<std::set<std::string>>()
+			: std::set<std::string>();
+
+		// Feature structures of the extensions are only queried if the extensions are available
+		const auto ray_query = extensions.contains(vk::KHRAccelerationStructureExtensionName)
+			&& extensions.contains(vk::KHRRayQueryExtensionName)
+			&& supports_ray_query(phy_device);
+		const auto mesh_shader =
+			extensions.contains(vk::EXTMeshShaderExtensionName) && supports_mesh_shader(phy_device);
+		const auto fragment_shading_rate = extensions.contains(vk::KHRFragmentShadingRateExtensionName)
+			&& supports_fragment_shading_rate(phy_device);
+
+		return {
+			.integrated = properties.get<vk::PhysicalDeviceProperties2>().properties.deviceType
+				== vk::PhysicalDeviceType::eIntegratedGpu,
+			.ray_query = ray_query,
+			.mesh_shader = mesh_shader,
+			.fragment_shading_rate = fragment_shading_rate,
+			.resizable_bar = supports_resizable_bar(memory_properties),
+			.subgroup_size = properties.get<vk::PhysicalDeviceVulkan11Properties>().subgroupSize,
+			.device_local_size = get_device_local_size(memory_properties),
+		};
+	}
+
+	DeviceCapability::Tier DeviceCapability::get_tier() const noexcept
+	{
+		if (integrated || !ray_query || device_local_size < LOW_TIER_MEMORY) return Tier::Low;
+		if (device_local_size >= HIGH_TIER_MEMORY && mesh_shader && fragment_shading_rate) return Tier::High;
+		return Tier::Medium;
+	}
+}
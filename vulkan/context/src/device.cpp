@@ -4,12 +4,17 @@
 #include "impl/device.hpp"
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/context/instance.hpp"
+#include "vulkan/context/pipeline-cache.hpp"
 
 #include <algorithm>
 #include <expected>
+#include <filesystem>
+#include <format>
+#include <functional>
 #include <libassert/assert.hpp>
 #include <optional>
 #include <span>
+#include <string>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -26,7 +31,9 @@ namespace vulkan
 		return json;
 	}
 
-	std::expected<HeadlessDeviceContext, Error> HeadlessDeviceContext::create(
+	// Check every physical device, returning the suitable ones
+	[[nodiscard]]
+	static std::expected<std::vector<impl::HeadlessDeviceInfo>, Error> check_headless_devices(
 		const HeadlessInstanceContext& context,
 		const DeviceFeature& feature
 	) noexcept
@@ -54,35 +61,108 @@ namespace vulkan
 		if (pass_devices.empty())
 			return Error("No suitable device found", std::nullopt, fail_info_list_to_json(fail_devices));
 
+		return pass_devices;
+	}
+
+	std::expected<HeadlessDeviceContext, Error> HeadlessDeviceContext::create(
+		const HeadlessInstanceContext& context,
+		const DeviceFeature& feature,
+		std::optional<std::filesystem::path> pipeline_cache_dir
+	) noexcept
+	{
+		auto pass_devices_result = check_headless_devices(context, feature);
+		if (!pass_devices_result) return pass_devices_result.error();
+		auto pass_devices = std::move(*pass_devices_result);
+
 		/* Find best device and create */
 
 		auto best_device_iter = std::ranges::max_element(pass_devices, {}, &impl::HeadlessDeviceInfo::rank);
 		ASSERT(best_device_iter != pass_devices.end());
-		auto best_device = std::move(*best_device_iter);
 
-		auto device_result = best_device.create_device();
+		return create_from(context, *best_device_iter, feature, std::move(pipeline_cache_dir));
+	}
+
+	std::expected<std::vector<HeadlessDeviceContext>, Error> HeadlessDeviceContext::create_all(
+		const HeadlessInstanceContext& context,
+		const DeviceFeature& feature,
+		std::optional<std::filesystem::path> pipeline_cache_dir
+	) noexcept
+	{
+		auto pass_devices_result = check_headless_devices(context, feature);
+		if (!pass_devices_result) return pass_devices_result.error();
+		auto pass_devices = std::move(*pass_devices_result);
+
+		/* Create every device, best first */
+
+		std::ranges::sort(pass_devices, std::ranges::greater(), &impl::HeadlessDeviceInfo::rank);
+
+		std::vector<HeadlessDeviceContext> contexts;
+		contexts.reserve(pass_devices.size());
+
+		for (const auto& device_info : pass_devices)
+		{
+			auto context_result = create_from(context, device_info, feature, pipeline_cache_dir);
+			if (!context_result)
+			{
+				const auto device_name = std::string(device_info.phy_device.getProperties().deviceName);
+				return context_result.error().forward(std::format("Create device '{}' failed", device_name));
+			}
+			contexts.emplace_back(std::move(*context_result));
+		}
+
+		return contexts;
+	}
+
+	std::expected<HeadlessDeviceContext, Error> HeadlessDeviceContext::create_from(
+		const HeadlessInstanceContext& context,
+		const impl::HeadlessDeviceInfo& device_info,
+		const DeviceFeature& feature,
+		std::optional<std::filesystem::path> pipeline_cache_dir
+	) noexcept
+	{
+		auto device_result = device_info.create_device();
 		if (!device_result) return device_result.error().forward("Create device failed");
-		auto [device, render_queue] = std::move(*device_result);
-		const auto phy_device = best_device.phy_device;
+		auto [device, render_queue, compute_queue, transfer_queue] = std::move(*device_result);
+		const auto phy_device = device_info.phy_device;
 
 		/* Create allocator */
 
-		auto allocator_result = vulkan::Allocator::create(context->instance, phy_device, device);
+		const auto memory_budget =
+			std::ranges::contains(device_info.extensions, vk::EXTMemoryBudgetExtensionName);
+
+		auto allocator_result =
+			vulkan::Allocator::create(context->instance, phy_device, device, memory_budget);
 		if (!allocator_result) return allocator_result.error().forward("Create VMA allocator failed");
 		auto allocator = std::move(*allocator_result);
 
+		/* Create pipeline cache */
+
+		auto pipeline_cache_result = PipelineCache::create(phy_device, device, std::move(pipeline_cache_dir));
+		if (!pipeline_cache_result)
+			return pipeline_cache_result.error().forward("Create pipeline cache failed");
+		auto pipeline_cache = std::move(*pipeline_cache_result);
+
+		// Report the on-demand features actually enabled
+		auto enabled_feature = feature;
+		enabled_feature.fragment_shading_rate =
+			std::ranges::contains(device_info.extensions, vk::KHRFragmentShadingRateExtensionName);
+
 		return HeadlessDeviceContext(
 			phy_device,
 			std::move(device),
 			std::move(allocator),
+			std::move(pipeline_cache),
 			std::move(render_queue),
-			feature
+			std::move(compute_queue),
+			std::move(transfer_queue),
+			enabled_feature
 		);
 	}
 
 	std::expected<SurfaceDeviceContext, Error> SurfaceDeviceContext::create(
 		const SurfaceInstanceContext& context,
-		const DeviceFeature& feature
+		const DeviceFeature& feature,
+		std::optional<std::filesystem::path> pipeline_cache_dir
 	) noexcept
 	{
 		/* Enumerate physical devices */
@@ -116,22 +196,43 @@ namespace vulkan
 
 		auto device_result = best_device.create_device();
 		if (!device_result) return device_result.error().forward("Create device failed");
-		auto [device, render_queue, present_queue] = std::move(*device_result);
+		auto [device, render_queue, present_queue, compute_queue, transfer_queue] = std::move(*device_result);
 		const auto phy_device = best_device.phy_device;
 
 		/* Create allocator */
 
-		auto allocator_result = vulkan::Allocator::create(context->instance, phy_device, device);
+		const auto memory_budget =
+			std::ranges::contains(best_device.extensions, vk::EXTMemoryBudgetExtensionName);
+
+		auto allocator_result =
+			vulkan::Allocator::create(context->instance, phy_device, device, memory_budget);
 		if (!allocator_result) return allocator_result.error().forward("Create VMA allocator failed");
 		auto allocator = std::move(*allocator_result);
 
+		/* Create pipeline cache */
+
+		auto pipeline_cache_result = PipelineCache::create(phy_device, device, std::move(pipeline_cache_dir));
+		if (!pipeline_cache_result)
+			return pipeline_cache_result.error().forward("Create pipeline cache failed");
+		auto pipeline_cache = std::move(*pipeline_cache_result);
+
+		// Report the on-demand features actually enabled
+		auto enabled_feature = feature;
+		enabled_feature.fragment_shading_rate =
+			std::ranges::contains(best_device.extensions, vk::KHRFragmentShadingRateExtensionName);
+
 		return SurfaceDeviceContext(
 			phy_device,
 			std::move(device),
 			std::move(allocator),
+			std::move(pipeline_cache),
 			std::move(render_queue),
 			std::move(present_queue),
-			feature
+			std::move(compute_queue),
+			std::move(transfer_queue),
+			enabled_feature,
+			std::ranges::contains(best_device.extensions, vk::KHRPresentWaitExtensionName),
+			std::ranges::contains(best_device.extensions, vk::EXTSwapchainMaintenance1ExtensionName)
 		);
 	}
 }
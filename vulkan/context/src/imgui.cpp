@@ -117,7 +117,7 @@ namespace vulkan
 			.DescriptorPoolSize = IMGUI_IMPL_VULKAN_MINIMUM_IMAGE_SAMPLER_POOL_SIZE,
 			.MinImageCount = 2,
 			.ImageCount = 3,
-			.PipelineCache = nullptr,
+			.PipelineCache = *device_context.pipeline_cache,
 			.PipelineInfoMain = pipeline_info,
 			.PipelineInfoForViewports = empty_pipeline_info,
 			.UseDynamicRendering = std::holds_alternative<Config::DynamicRendering>(config.render_scheme),
@@ -58,9 +58,17 @@ namespace vulkan::impl
 
 		CHECK_FIELD(available, result, robustBufferAccess);
 		CHECK_FIELD(available, result, samplerAnisotropy);
-		CHECK_FIELD(available, result, textureCompressionBC);
 		CHECK_FIELD(available, result, pipelineStatisticsQuery);
 		CHECK_FIELD(available, result, multiDrawIndirect);
+		CHECK_FIELD(available, result, fragmentStoresAndAtomics);
+		CHECK_FIELD(available, result, shaderStorageImageExtendedFormats);
+
+		// Either BC (desktop) or ETC2 (mobile) textures, ASTC is used for KTX2 textures where available
+		if (available.textureCompressionBC == vk::False && available.textureCompressionETC2 == vk::False)
+			return Error("Missing feature", "Neither BC nor ETC2 textures are supported by the device");
+		result.textureCompressionBC = available.textureCompressionBC;
+		result.textureCompressionETC2 = available.textureCompressionETC2;
+		result.textureCompressionASTC_LDR = available.textureCompressionASTC_LDR;
 
 		return result;
 	}
@@ -73,6 +81,7 @@ namespace vulkan::impl
 	{
 		vk::PhysicalDeviceVulkan11Features result = {};
 		CHECK_FIELD(available, result, shaderDrawParameters);
+		CHECK_FIELD(available, result, multiview);
 
 		return result;
 	}
@@ -85,6 +94,8 @@ namespace vulkan::impl
 	{
 		vk::PhysicalDeviceVulkan12Features result = {};
 		CHECK_FIELD(available, result, shaderFloat16);
+		CHECK_FIELD(available, result, drawIndirectCount);
+		CHECK_FIELD(available, result, timelineSemaphore);
 		CHECK_FIELD(available, result, scalarBlockLayout);
 		CHECK_FIELD(available, result, runtimeDescriptorArray);
 		CHECK_FIELD(available, result, bufferDeviceAddress);
@@ -96,6 +107,7 @@ namespace vulkan::impl
 		if (feature.descriptor_indexing.sampled_image)
 		{
 			CHECK_FIELD(available, result, descriptorBindingSampledImageUpdateAfterBind);
+			CHECK_FIELD(available, result, descriptorBindingUpdateUnusedWhilePending);
 			CHECK_FIELD(available, result, shaderSampledImageArrayNonUniformIndexing);
 		}
 
@@ -152,6 +164,55 @@ namespace vulkan::impl
 		return result;
 	}
 
+	[[nodiscard]]
+	static std::expected<vk::PhysicalDeviceRayQueryFeaturesKHR, Error> find_ray_query_features(
+		const vk::raii::PhysicalDevice& phy_device
+	) noexcept
+	{
+		const auto available_features =
+			phy_device
+				.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceRayQueryFeaturesKHR>()
+				.get<vk::PhysicalDeviceRayQueryFeaturesKHR>();
+
+		vk::PhysicalDeviceRayQueryFeaturesKHR result = {};
+		CHECK_FIELD(available_features, result, rayQuery);
+
+		return result;
+	}
+
+	[[nodiscard]]
+	static std::expected<vk::PhysicalDeviceRayTracingPipelineFeaturesKHR, Error> find_rt_pipeline_features(
+		const vk::raii::PhysicalDevice& phy_device
+	) noexcept
+	{
+		const auto available_features =
+			phy_device
+				.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceRayTracingPipelineFeaturesKHR>()
+				.get<vk::PhysicalDeviceRayTracingPipelineFeaturesKHR>();
+
+		vk::PhysicalDeviceRayTracingPipelineFeaturesKHR result = {};
+		CHECK_FIELD(available_features, result, rayTracingPipeline);
+
+		return result;
+	}
+
+	[[nodiscard]]
+	static std::expected<vk::PhysicalDeviceMeshShaderFeaturesEXT, Error> find_mesh_shader_features(
+		const vk::raii::PhysicalDevice& phy_device
+	) noexcept
+	{
+		const auto available_features =
+			phy_device
+				.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceMeshShaderFeaturesEXT>()
+				.get<vk::PhysicalDeviceMeshShaderFeaturesEXT>();
+
+		vk::PhysicalDeviceMeshShaderFeaturesEXT result = {};
+		CHECK_FIELD(available_features, result, taskShader);
+		CHECK_FIELD(available_features, result, meshShader);
+
+		return result;
+	}
+
 	[[nodiscard]]
 	static std::expected<void, Error> check_device_constraints(
 		const vk::raii::PhysicalDevice& phy_device,
@@ -199,6 +260,9 @@ namespace vulkan::impl
 		const DeviceFeature& feature
 	) noexcept
 	{
+		if (feature.raytracing_pipeline && !feature.raytracing)
+			return Error("Invalid device feature", "Ray tracing pipeline requires the raytracing feature");
+
 		const auto available_features2 = phy_device.getFeatures2<
 			vk::PhysicalDeviceFeatures2,
 			vk::PhysicalDeviceVulkan11Features,
@@ -238,29 +302,100 @@ namespace vulkan::impl
 			if (!required_features_as) return required_features_as.error();
 
 			features.push(*required_features_as);
+
+			const auto required_features_ray_query = find_ray_query_features(phy_device);
+			if (!required_features_ray_query) return required_features_ray_query.error();
+
+			features.push(*required_features_ray_query);
+
+			if (feature.raytracing_pipeline)
+			{
+				const auto required_features_rt_pipeline = find_rt_pipeline_features(phy_device);
+				if (!required_features_rt_pipeline) return required_features_rt_pipeline.error();
+
+				features.push(*required_features_rt_pipeline);
+			}
+		}
+
+		if (feature.mesh_shader)
+		{
+			const auto required_features_mesh_shader = find_mesh_shader_features(phy_device);
+			if (!required_features_mesh_shader) return required_features_mesh_shader.error();
+
+			features.push(*required_features_mesh_shader);
 		}
 
 		return features;
 	}
 
+	[[nodiscard]]
+	static bool supports_present_wait_features(const vk::raii::PhysicalDevice& phy_device) noexcept
+	{
+		const auto available_features = phy_device.getFeatures2<
+			vk::PhysicalDeviceFeatures2,
+			vk::PhysicalDevicePresentIdFeaturesKHR,
+			vk::PhysicalDevicePresentWaitFeaturesKHR
+		>();
+
+		return available_features.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId == vk::True
+			&& available_features.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait == vk::True;
+	}
+
+	[[nodiscard]]
+	static bool supports_swapchain_maintenance_features(const vk::raii::PhysicalDevice& phy_device) noexcept
+	{
+		const auto available_features = phy_device.getFeatures2<
+			vk::PhysicalDeviceFeatures2,
+			vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT
+		>();
+
+		return available_features.get<vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT>()
+				   .swapchainMaintenance1
+			== vk::True;
+	}
+
+	[[nodiscard]]
+	static bool supports_fragment_shading_rate_features(const vk::raii::PhysicalDevice& phy_device) noexcept
+	{
+		const auto available_features = phy_device.getFeatures2<
+			vk::PhysicalDeviceFeatures2,
+			vk::PhysicalDeviceFragmentShadingRateFeaturesKHR
+		>();
+
+		const auto& shading_rate_features =
+			available_features.get<vk::PhysicalDeviceFragmentShadingRateFeaturesKHR>();
+		return shading_rate_features.pipelineFragmentShadingRate == vk::True
+			&& shading_rate_features.attachmentFragmentShadingRate == vk::True;
+	}
+
 	constexpr auto MANDATORY_EXT = std::to_array({vk::KHRShaderNonSemanticInfoExtensionName});
 	constexpr auto PRESENT_MANDATORY_EXT = std::to_array({vk::KHRSwapchainExtensionName});
 	constexpr auto RAYTRACE_EXT = std::to_array({
 		vk::KHRDeferredHostOperationsExtensionName,
 		vk::KHRAccelerationStructureExtensionName,
+		vk::KHRRayQueryExtensionName,
+	});
+	constexpr auto RAYTRACE_PIPELINE_EXT = std::to_array({vk::KHRRayTracingPipelineExtensionName});
+	constexpr auto MESH_SHADER_EXT = std::to_array({vk::EXTMeshShaderExtensionName});
+	constexpr auto PRESENT_WAIT_EXT = std::to_array({
+		vk::KHRPresentIdExtensionName,
+		vk::KHRPresentWaitExtensionName,
 	});
 
 	[[nodiscard]]
 	static std::expected<std::vector<std::string>, Error> find_device_extensions(
 		const vk::raii::PhysicalDevice& phy_device,
 		const DeviceFeature& feature [[maybe_unused]],
-		bool support_present
+		bool support_present,
+		bool surface_maintenance
 	) noexcept
 	{
 		std::set<std::string> extensions;
 		extensions.insert_range(MANDATORY_EXT);
 		if (support_present) extensions.insert_range(PRESENT_MANDATORY_EXT);
 		if (feature.raytracing) extensions.insert_range(RAYTRACE_EXT);
+		if (feature.raytracing && feature.raytracing_pipeline) extensions.insert_range(RAYTRACE_PIPELINE_EXT);
+		if (feature.mesh_shader) extensions.insert_range(MESH_SHADER_EXT);
 
 		const auto available_extensions_result = phy_device.enumerateDeviceExtensionProperties();
 		if (!available_extensions_result) return Error::from(available_extensions_result);
@@ -278,9 +413,47 @@ namespace vulkan::impl
 		if (available_extensions.contains(vk::EXTDeviceFaultExtensionName))
 			extensions.insert(vk::EXTDeviceFaultExtensionName);
 
+		if (available_extensions.contains(vk::EXTMemoryBudgetExtensionName))
+			extensions.insert(vk::EXTMemoryBudgetExtensionName);
+
+		// Optional variable rate shading, falls back to full rate shading
+		if (feature.fragment_shading_rate
+			&& available_extensions.contains(vk::KHRFragmentShadingRateExtensionName)
+			&& supports_fragment_shading_rate_features(phy_device))
+			extensions.insert(vk::KHRFragmentShadingRateExtensionName);
+
+		// Optional frame pacing, enabled only as a pair since waiting requires the IDs attached on present
+		const auto present_wait_available = std::ranges::all_of(PRESENT_WAIT_EXT, [&](const char* name) {
+			return available_extensions.contains(name);
+		});
+		if (support_present && present_wait_available && supports_present_wait_features(phy_device))
+			extensions.insert_range(PRESENT_WAIT_EXT);
+
+		// Optional present fences for retiring old swapchains, requires `VK_EXT_surface_maintenance1`
+		if (support_present
+			&& surface_maintenance
+			&& available_extensions.contains(vk::EXTSwapchainMaintenance1ExtensionName)
+			&& supports_swapchain_maintenance_features(phy_device))
+			extensions.insert(vk::EXTSwapchainMaintenance1ExtensionName);
+
 		return extensions | std::ranges::to<std::vector>();
 	}
 
+	// Enable the features of the on-demand extensions found by `find_device_extensions`
+	static void push_optional_features(
+		vulkan::LinkedStruct<vk::PhysicalDeviceFeatures2>& features,
+		const std::vector<std::string>& extensions
+	) noexcept
+	{
+		if (std::ranges::contains(extensions, vk::KHRFragmentShadingRateExtensionName))
+			features.push(
+				vk::PhysicalDeviceFragmentShadingRateFeaturesKHR{
+					.pipelineFragmentShadingRate = vk::True,
+					.attachmentFragmentShadingRate = vk::True,
+				}
+			);
+	}
+
 	[[nodiscard]]
 	static std::optional<uint32_t> find_queue_family_index(
 		const vk::raii::PhysicalDevice& device,
@@ -313,6 +486,58 @@ namespace vulkan::impl
 		return render_index.value();
 	}
 
+	[[nodiscard]]
+	static std::optional<uint32_t> find_dedicated_queue_family_index(
+		const vk::raii::PhysicalDevice& device,
+		vk::QueueFlags required_flags,
+		vk::QueueFlags excluded_flags
+	)
+	{
+		const auto queue_families = device.getQueueFamilyProperties();
+		for (const auto [idx, queue_family] : std::views::enumerate(queue_families))
+			if ((queue_family.queueFlags & required_flags) == required_flags
+				&& !(queue_family.queueFlags & excluded_flags))
+				return idx;
+		return std::nullopt;
+	}
+
+	///
+	/// @brief Find a compute-only queue family for async compute, fallback to render queue family
+	///
+	[[nodiscard]]
+	static uint32_t find_compute_queue(
+		const vk::raii::PhysicalDevice& phy_device,
+		uint32_t render_queue
+	) noexcept
+	{
+		const auto compute_index = find_dedicated_queue_family_index(
+			phy_device,
+			vk::QueueFlagBits::eCompute | vk::QueueFlagBits::eTransfer,
+			vk::QueueFlagBits::eGraphics
+		);
+
+		return compute_index.value_or(render_queue);
+	}
+
+	///
+	/// @brief Find a transfer-only queue family (usually backed by DMA engines), fallback to render queue
+	/// family
+	///
+	[[nodiscard]]
+	static uint32_t find_transfer_queue(
+		const vk::raii::PhysicalDevice& phy_device,
+		uint32_t render_queue
+	) noexcept
+	{
+		const auto transfer_index = find_dedicated_queue_family_index(
+			phy_device,
+			vk::QueueFlagBits::eTransfer,
+			vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute
+		);
+
+		return transfer_index.value_or(render_queue);
+	}
+
 	[[nodiscard]]
 	static std::expected<uint32_t, Error> find_present_queue(
 		const vk::raii::PhysicalDevice& phy_device,
@@ -385,15 +610,43 @@ namespace vulkan::impl
 		return rank_device_by_type(phy_device) + rank_device_by_memory(phy_device);
 	}
 
-	std::expected<std::pair<vk::raii::Device, DeviceQueue>, Error>
+	[[nodiscard]]
+	static std::vector<vk::DeviceQueueCreateInfo> get_queue_create_infos(
+		const std::set<uint32_t>& unique_families,
+		const float& queue_priority
+	) noexcept
+	{
+		return unique_families
+			| std::views::transform([&queue_priority](uint32_t family_index) {
+				   return vk::DeviceQueueCreateInfo{
+					   .queueFamilyIndex = family_index,
+					   .queueCount = 1,
+					   .pQueuePriorities = &queue_priority
+				   };
+			   })
+			| std::ranges::to<std::vector>();
+	}
+
+	[[nodiscard]]
+	static std::map<uint32_t, std::shared_ptr<const vk::raii::Queue>> get_queue_map(
+		const vk::raii::Device& device,
+		const std::set<uint32_t>& unique_families
+	) noexcept
+	{
+		std::map<uint32_t, std::shared_ptr<const vk::raii::Queue>> queue_map;
+		for (const auto family : unique_families)
+			queue_map.emplace(family, std::make_shared<vk::raii::Queue>(device.getQueue(family, 0)));
+		return queue_map;
+	}
+
+	std::expected<std::tuple<vk::raii::Device, DeviceQueue, DeviceQueue, DeviceQueue>, Error>
 	HeadlessDeviceInfo::create_device() const noexcept
 	{
 		const float queue_priority = 1.0f;
-		const auto render_queue_create_info = vk::DeviceQueueCreateInfo{
-			.queueFamilyIndex = render_family_index,
-			.queueCount = 1,
-			.pQueuePriorities = &queue_priority
-		};
+
+		const std::set<uint32_t> unique_families =
+			{render_family_index, compute_family_index, transfer_family_index};
+		const auto queue_create_infos = get_queue_create_infos(unique_families, queue_priority);
 
 		const auto extensions_cstr = extensions
 			| std::views::transform([](const auto& str) { return str.c_str(); })
@@ -402,37 +655,36 @@ namespace vulkan::impl
 		const auto device_create_info =
 			vk::DeviceCreateInfo()
 				.setPNext(&features.get())
-				.setQueueCreateInfos(render_queue_create_info)
+				.setQueueCreateInfos(queue_create_infos)
 				.setPEnabledExtensionNames(extensions_cstr);
 
 		auto device_result = phy_device.createDevice(device_create_info);
 		if (!device_result) return Error::from(device_result);
 		auto device = std::move(*device_result);
 
-		auto queue = std::make_shared<vk::raii::Queue>(device.getQueue(render_family_index, 0));
+		const auto queue_map = get_queue_map(device, unique_families);
 
-		return std::make_pair(
-			std::move(device),
-			DeviceQueue{.queue = queue, .family_index = render_family_index}
-		);
+		const auto render_queue =
+			DeviceQueue{.queue = queue_map.at(render_family_index), .family_index = render_family_index};
+		const auto compute_queue =
+			DeviceQueue{.queue = queue_map.at(compute_family_index), .family_index = compute_family_index};
+		const auto transfer_queue =
+			DeviceQueue{.queue = queue_map.at(transfer_family_index), .family_index = transfer_family_index};
+
+		return std::make_tuple(std::move(device), render_queue, compute_queue, transfer_queue);
 	}
 
-	std::expected<std::tuple<vk::raii::Device, DeviceQueue, DeviceQueue>, Error>
+	std::expected<
+		std::tuple<vk::raii::Device, DeviceQueue, DeviceQueue, DeviceQueue, DeviceQueue>,
+		Error
+	>
 	SurfaceDeviceInfo::create_device() const noexcept
 	{
 		const float queue_priority = 1.0f;
 
-		const std::set<uint32_t> unique_families = {render_family_index, present_family_index};
-		const auto queue_create_infos =
-			unique_families
-			| std::views::transform([&queue_priority](uint32_t family_index) {
-				  return vk::DeviceQueueCreateInfo{
-					  .queueFamilyIndex = family_index,
-					  .queueCount = 1,
-					  .pQueuePriorities = &queue_priority
-				  };
-			  })
-			| std::ranges::to<std::vector>();
+		const std::set<uint32_t> unique_families =
+			{render_family_index, present_family_index, compute_family_index, transfer_family_index};
+		const auto queue_create_infos = get_queue_create_infos(unique_families, queue_priority);
 
 		const auto extensions_cstr = extensions
 			| std::views::transform([](const auto& str) { return str.c_str(); })
@@ -448,16 +700,18 @@ namespace vulkan::impl
 		if (!device_result) return Error::from(device_result);
 		auto device = std::move(*device_result);
 
-		std::map<uint32_t, std::shared_ptr<const vk::raii::Queue>> queue_map;
-		for (const auto family : unique_families)
-			queue_map.emplace(family, std::make_shared<vk::raii::Queue>(device.getQueue(family, 0)));
+		const auto queue_map = get_queue_map(device, unique_families);
 
 		const auto render_queue =
 			DeviceQueue{.queue = queue_map.at(render_family_index), .family_index = render_family_index};
 		const auto present_queue =
 			DeviceQueue{.queue = queue_map.at(present_family_index), .family_index = present_family_index};
+		const auto compute_queue =
+			DeviceQueue{.queue = queue_map.at(compute_family_index), .family_index = compute_family_index};
+		const auto transfer_queue =
+			DeviceQueue{.queue = queue_map.at(transfer_family_index), .family_index = transfer_family_index};
 
-		return std::make_tuple(std::move(device), render_queue, present_queue);
+		return std::make_tuple(std::move(device), render_queue, present_queue, compute_queue, transfer_queue);
 	}
 
 	std::expected<HeadlessDeviceInfo, FailInfo> check_headless_device(
@@ -471,7 +725,7 @@ namespace vulkan::impl
 				.error = check_result.error(),
 			});
 
-		auto extensions_result = find_device_extensions(phy_device, feature, false);
+		auto extensions_result = find_device_extensions(phy_device, feature, false, false);
 		if (!extensions_result)
 			return std::unexpected<FailInfo>({
 				.phy_device = phy_device,
@@ -486,6 +740,7 @@ namespace vulkan::impl
 				.error = extensions_result.error(),
 			});
 		auto features = std::move(*features_result);
+		push_optional_features(features, extensions);
 
 		auto render_queue_result = find_render_queue(phy_device);
 		if (!render_queue_result)
@@ -494,6 +749,8 @@ namespace vulkan::impl
 				.error = extensions_result.error(),
 			});
 		const auto render_queue = *render_queue_result;
+		const auto compute_queue = find_compute_queue(phy_device, render_queue);
+		const auto transfer_queue = find_transfer_queue(phy_device, render_queue);
 
 		const auto rank = rank_device(phy_device);
 
@@ -502,6 +759,8 @@ namespace vulkan::impl
 			.features = std::move(features),
 			.extensions = std::move(extensions),
 			.render_family_index = render_queue,
+			.compute_family_index = compute_queue,
+			.transfer_family_index = transfer_queue,
 			.rank = rank
 		};
 	}
@@ -518,7 +777,12 @@ namespace vulkan::impl
 				.error = check_result.error(),
 			});
 
-		auto extensions_result = find_device_extensions(phy_device, feature, true);
+		auto extensions_result = find_device_extensions(
+			phy_device,
+			feature,
+			true,
+			instance->surface_maintenance
+		);
 		if (!extensions_result)
 			return std::unexpected<FailInfo>({
 				.phy_device = phy_device,
@@ -533,6 +797,18 @@ namespace vulkan::impl
 				.error = extensions_result.error(),
 			});
 		auto features = std::move(*features_result);
+		push_optional_features(features, extensions);
+
+		if (std::ranges::contains(extensions, vk::KHRPresentWaitExtensionName))
+		{
+			features.push(vk::PhysicalDevicePresentIdFeaturesKHR{.presentId = vk::True});
+			features.push(vk::PhysicalDevicePresentWaitFeaturesKHR{.presentWait = vk::True});
+		}
+
+		if (std::ranges::contains(extensions, vk::EXTSwapchainMaintenance1ExtensionName))
+			features.push(
+				vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT{.swapchainMaintenance1 = vk::True}
+			);
 
 		auto render_queue_result = find_render_queue(phy_device);
 		if (!render_queue_result)
@@ -549,6 +825,8 @@ namespace vulkan::impl
 				.error = present_queue_result.error(),
 			});
 		const auto present_queue = *present_queue_result;
+		const auto compute_queue = find_compute_queue(phy_device, render_queue);
+		const auto transfer_queue = find_transfer_queue(phy_device, render_queue);
 
 		const auto rank = rank_device(phy_device);
 
@@ -558,6 +836,8 @@ namespace vulkan::impl
 			.extensions = std::move(extensions),
 			.render_family_index = render_queue,
 			.present_family_index = present_queue,
+			.compute_family_index = compute_queue,
+			.transfer_family_index = transfer_queue,
 			.rank = rank
 		};
 	}
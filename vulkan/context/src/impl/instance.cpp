@@ -8,12 +8,14 @@
 #include <SDL3/SDL_init.h>
 #include <SDL3/SDL_video.h>
 #include <SDL3/SDL_vulkan.h>
+#include <algorithm>
 #include <expected>
 #include <format>
 #include <ranges>
 #include <set>
 #include <span>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -69,6 +71,51 @@ namespace vulkan::impl
 		return std::set<std::string>(std::from_range, std::span(extensions, extension_count));
 	}
 
+	// Get available optional instance extensions for both headless and surface instance
+	static std::expected<std::set<std::string>, Error> get_optional_instance_extensions(
+		const vk::raii::Context& context [[maybe_unused]]
+	) noexcept
+	{
+#ifdef VULKAN_DEBUG_UTILS
+		const auto available_extensions_result = context.enumerateInstanceExtensionProperties();
+		if (!available_extensions_result) return Error::from(available_extensions_result);
+
+		// Object names and labels, see "vulkan/util/debug-utils.hpp". Usually provided by capture tools
+		const auto debug_utils =
+			std::ranges::any_of(*available_extensions_result, [](const vk::ExtensionProperties& properties) {
+				return std::string_view(properties.extensionName.data()) == vk::EXTDebugUtilsExtensionName;
+			});
+		if (debug_utils) return std::set<std::string>{vk::EXTDebugUtilsExtensionName};
+#endif
+
+		return std::set<std::string>();
+	}
+
+	// Get available optional instance extensions for surface instance
+	static std::expected<std::set<std::string>, Error> get_optional_instance_extensions_surface(
+		const vk::raii::Context& context
+	) noexcept
+	{
+		const auto available_extensions_result = context.enumerateInstanceExtensionProperties();
+		if (!available_extensions_result) return Error::from(available_extensions_result);
+
+		const auto available_extensions = *available_extensions_result
+			| std::views::transform([](const vk::ExtensionProperties& properties) {
+				  return std::string(properties.extensionName.data());
+			  })
+			| std::ranges::to<std::set<std::string>>();
+
+		// Required by `VK_EXT_swapchain_maintenance1` on the device
+		const auto surface_maintenance_extensions = std::set<std::string>{
+			vk::KHRGetSurfaceCapabilities2ExtensionName,
+			vk::EXTSurfaceMaintenance1ExtensionName,
+		};
+		if (std::ranges::includes(available_extensions, surface_maintenance_extensions))
+			return surface_maintenance_extensions;
+
+		return std::set<std::string>();
+	}
+
 	// Create a vulkan instance by providing layers and extensions
 	static std::expected<vk::raii::Instance, Error> create_instance(
 		const vk::raii::Context& context,
@@ -175,10 +222,19 @@ namespace vulkan::impl
 		const auto instance_layers = get_instance_layers(instance_config);
 		const auto instance_extensions = get_instance_extensions(instance_config);
 
-		return create_instance(context, instance_config, instance_layers, instance_extensions);
+		const auto optional_extensions_result = get_optional_instance_extensions(context);
+		if (!optional_extensions_result)
+			return optional_extensions_result.error().forward("Get optional instance extensions failed");
+
+		return create_instance(
+			context,
+			instance_config,
+			instance_layers,
+			instance_extensions + *optional_extensions_result
+		);
 	}
 
-	std::expected<vk::raii::Instance, Error> create_instance_surface(
+	std::expected<SurfaceInstanceInfo, Error> create_instance_surface(
 		const vk::raii::Context& context,
 		const InstanceConfig& instance_config,
 		const WindowConfig& window_config
@@ -189,15 +245,30 @@ namespace vulkan::impl
 
 		const auto instance_layers_sdl_result = get_instance_layers_sdl(window_config);
 		const auto instance_extensions_sdl_result = get_instance_extensions_sdl(window_config);
+		const auto optional_extensions_result = get_optional_instance_extensions(context);
+		const auto optional_surface_extensions_result = get_optional_instance_extensions_surface(context);
 
 		if (!instance_layers_sdl_result)
 			return instance_layers_sdl_result.error().forward("Get instance layers from SDL failed");
 		if (!instance_extensions_sdl_result)
 			return instance_extensions_sdl_result.error().forward("Get instance extensions from SDL failed");
+		if (!optional_extensions_result)
+			return optional_extensions_result.error().forward("Get optional instance extensions failed");
+		if (!optional_surface_extensions_result)
+			return optional_surface_extensions_result.error().forward(
+				"Get optional surface instance extensions failed"
+			);
 
 		const auto layers = instance_layers + *instance_layers_sdl_result;
-		const auto extensions = instance_extensions + *instance_extensions_sdl_result;
+		const auto extensions = instance_extensions + *instance_extensions_sdl_result
+			+ *optional_extensions_result + *optional_surface_extensions_result;
+
+		auto instance_result = create_instance(context, instance_config, layers, extensions);
+		if (!instance_result) return instance_result.error();
 
-		return create_instance(context, instance_config, layers, extensions);
+		return SurfaceInstanceInfo{
+			.instance = std::move(*instance_result),
+			.surface_maintenance = extensions.contains(vk::EXTSurfaceMaintenance1ExtensionName)
+		};
 	}
 }
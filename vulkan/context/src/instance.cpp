@@ -61,7 +61,7 @@ namespace vulkan
 
 		auto instance_result = impl::create_instance_surface(context, instance_config, window_config);
 		if (!instance_result) return instance_result.error().forward("Create Vulkan instance failed");
-		auto instance = std::move(*instance_result);
+		auto [instance, surface_maintenance] = std::move(*instance_result);
 
 		/* Step 4: Surface */
 
@@ -74,7 +74,8 @@ namespace vulkan
 			std::move(context),
 			std::move(window),
 			std::move(instance),
-			std::move(surface)
+			std::move(surface),
+			surface_maintenance
 		);
 	}
 
@@ -0,0 +1,125 @@
+#include "vulkan/context/pipeline-cache.hpp"
+#include "common/file.hpp"
+#include "common/util/error.hpp"
+#include "common/util/span.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	[[nodiscard]]
+	static std::filesystem::path get_cache_path(
+		const std::filesystem::path& directory,
+		const vk::PhysicalDeviceProperties& properties
+	) noexcept
+	{
+		std::string uuid;
+		for (const auto byte : properties.pipelineCacheUUID) uuid += std::format("{:02x}", byte);
+
+		return directory / std::format("pipeline-{}-{:08x}.bin", uuid, properties.driverVersion);
+	}
+
+	///
+	/// @brief Check if the cache data is created by the same device, see `VkPipelineCacheHeaderVersionOne`
+	///
+	[[nodiscard]]
+	static bool validate_cache_data(
+		std::span<const std::byte> data,
+		const vk::PhysicalDeviceProperties& properties
+	) noexcept
+	{
+		vk::PipelineCacheHeaderVersionOne header;
+		if (data.size() < sizeof(header)) return false;
+		std::memcpy(&header, data.data(), sizeof(header));
+
+		return header.headerSize >= sizeof(header)
+			&& header.headerSize <= data.size()
+			&& header.headerVersion == vk::PipelineCacheHeaderVersion::eOne
+			&& header.vendorID == properties.vendorID
+			&& header.deviceID == properties.deviceID
+			&& std::ranges::equal(header.pipelineCacheUUID, properties.pipelineCacheUUID);
+	}
+
+	std::expected<PipelineCache, Error> PipelineCache::create(
+		const vk::raii::PhysicalDevice& phy_device,
+		const vk::raii::Device& device,
+		std::optional<std::filesystem::path> directory
+	) noexcept
+	{
+		const auto properties = phy_device.getProperties();
+		const auto path = directory.transform([&properties](const std::filesystem::path& dir) {
+			return get_cache_path(dir, properties);
+		});
+
+		// Missing or invalid cache file is not an error, start with an empty cache
+		std::vector<std::byte> initial_data;
+		if (path.has_value())
+		{
+			auto data_result = file::read(*path);
+			if (data_result && validate_cache_data(*data_result, properties))
+				initial_data = std::move(*data_result);
+		}
+
+		auto cache_result = device.createPipelineCache(
+			vk::PipelineCacheCreateInfo()
+				.setInitialDataSize(initial_data.size())
+				.setPInitialData(initial_data.data())
+		);
+		if (!cache_result) return Error::from(cache_result).forward("Create pipeline cache failed");
+
+		return PipelineCache(std::make_unique<vk::raii::PipelineCache>(std::move(*cache_result)), path);
+	}
+
+	std::expected<void, Error> PipelineCache::save() const noexcept
+	{
+		if (!path.has_value() || cache == nullptr) return {};
+
+		auto data_result = cache->getData();
+		if (!data_result) return Error::from(data_result).forward("Get pipeline cache data failed");
+
+		std::error_code error_code;
+		std::filesystem::create_directories(path->parent_path(), error_code);
+		if (error_code)
+			return Error(
+				std::format("Create directory '{}' failed", path->parent_path().string()),
+				error_code.message()
+			);
+
+		// Write to a temporary file first, so that a crash during writing never leaves a broken cache
+		auto temp_path = *path;
+		temp_path += ".tmp";
+
+		if (const auto write_result = file::write(temp_path, util::as_bytes(*data_result)); !write_result)
+			return write_result.error().forward("Write pipeline cache failed");
+
+		std::filesystem::rename(temp_path, *path, error_code);
+		if (error_code)
+			return Error(
+				std::format("Rename pipeline cache to '{}' failed", path->string()),
+				error_code.message()
+			);
+
+		return {};
+	}
+
+	PipelineCache::~PipelineCache() noexcept
+	{
+		// Errors are ignored, the cache is only an optimization
+		[[maybe_unused]] const auto result = save();
+	}
+}
@@ -12,6 +12,7 @@
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <deque>
 #include <expected>
 #include <format>
 #include <glm/common.hpp>
@@ -182,7 +183,15 @@ namespace vulkan
 			}
 		}();
 
-		return SwapchainContext(sharing_mode, queue_family_indices, surface_format, present_mode, 3);
+		return SwapchainContext(
+			sharing_mode,
+			queue_family_indices,
+			surface_format,
+			present_mode,
+			3,
+			device_context.supports_present_wait(),
+			device_context.supports_swapchain_maintenance()
+		);
 	}
 
 	std::expected<std::optional<SwapchainContext::Frame>, Error> SwapchainContext::acquire_next(
@@ -206,21 +215,23 @@ namespace vulkan
 		ASSERT(window_width >= 0 && window_height >= 0);
 		const auto window_size = glm::u32vec2(window_width, window_height);
 
+		if (const auto result = collect_retired_swapchains(device_context); !result)
+			return result.error().forward("Collect retired swapchains failed");
+
 		/* Resize */
 
-		if (std::holds_alternative<RuntimeState>(state))
+		if (std::holds_alternative<RuntimeState>(state)
+			&& std::get<RuntimeState>(state).extent != window_size)
 		{
-			auto& runtime_state = std::get<RuntimeState>(state);
-			if (runtime_state.extent != window_size)
-			{
-				if (const auto result = device_context->waitIdle(); !result) return Error::from(result);
-				state = InvalidatedState{.old_swapchain = std::move(std::get<RuntimeState>(state).swapchain)};
-				return std::nullopt;
-			}
+			if (const auto result = invalidate(device_context); !result)
+				return result.error().forward("Invalidate swapchain failed");
 		}
-		else if (auto result = recreate_swapchain(instance_context, device_context, window_size); !result)
+
+		if (!std::holds_alternative<RuntimeState>(state))
 		{
-			return result.error().forward("Recreate swapchain failed");
+			if (const auto result = recreate_swapchain(instance_context, device_context, window_size);
+				!result)
+				return result.error().forward("Recreate swapchain failed");
 		}
 
 		/* Get Swapchain */
@@ -250,8 +261,8 @@ namespace vulkan
 
 		case vk::Result::eErrorOutOfDateKHR:
 		case vk::Result::eSuboptimalKHR:
-			if (const auto result = device_context->waitIdle(); !result) return Error::from(result);
-			state = InvalidatedState{.old_swapchain = std::move(runtime_state.swapchain)};
+			if (const auto result = invalidate(device_context); !result)
+				return result.error().forward("Invalidate swapchain failed");
 			return std::nullopt;
 
 		default:
@@ -265,8 +276,8 @@ namespace vulkan
 		std::optional<vk::Semaphore> wait_semaphore
 	) noexcept
 	{
-		if (!std::holds_alternative<RuntimeState>(state))
-			return Error("Present failed", "Swapchain is not in a valid state");
+		static const Error::Interned invalid_state("Present failed", "Swapchain is not in a valid state");
+		if (!std::holds_alternative<RuntimeState>(state)) return Error(invalid_state);
 
 		auto& runtime_state = std::get<RuntimeState>(state);
 
@@ -276,13 +287,50 @@ namespace vulkan
 		const auto swapchains = std::to_array({*runtime_state.swapchain});
 		const auto image_indices = std::to_array({frame.index});
 
-		const auto present_info =
+		auto present_info =
 			vk::PresentInfoKHR{}
 				.setImageIndices(image_indices)
 				.setWaitSemaphores(wait_semaphores)
 				.setSwapchains(swapchains);
 
+		const auto present_ids = std::to_array({present_count + 1});
+		auto present_id_info = vk::PresentIdKHR().setPresentIds(present_ids);
+		if (present_wait)
+		{
+			present_id_info.setPNext(present_info.pNext);
+			present_info.setPNext(&present_id_info);
+			present_count++;
+		}
+
+		std::optional<vk::raii::Fence> present_fence;
+		if (swapchain_maintenance)
+		{
+			if (const auto result = recycle_present_fences(device_context, runtime_state.present_fences);
+				!result)
+				return result.error().forward("Recycle present fences failed");
+
+			auto fence_result = take_present_fence(device_context);
+			if (!fence_result) return fence_result.error().forward("Get present fence failed");
+			present_fence = std::move(*fence_result);
+		}
+
+		const auto present_fences = std::to_array({present_fence ? **present_fence : vk::Fence()});
+		auto present_fence_info = vk::SwapchainPresentFenceInfoEXT().setFences(present_fences);
+		if (swapchain_maintenance)
+		{
+			present_fence_info.setPNext(present_info.pNext);
+			present_info.setPNext(&present_fence_info);
+		}
+
 		const auto present_result = device_context.get_present_queue().queue->presentKHR(present_info);
+
+		// The fence is signaled as long as the present was queued, including when out of date
+		if (present_fence
+			&& (present_result == vk::Result::eSuccess
+				|| present_result == vk::Result::eSuboptimalKHR
+				|| present_result == vk::Result::eErrorOutOfDateKHR))
+			runtime_state.present_fences.push_back(std::move(*present_fence));
+
 		switch (present_result)
 		{
 		case vk::Result::eSuccess:
@@ -290,8 +338,8 @@ namespace vulkan
 
 		case vk::Result::eErrorOutOfDateKHR:
 		case vk::Result::eSuboptimalKHR:
-			if (const auto result = device_context->waitIdle(); !result) return Error::from(result);
-			state = InvalidatedState{.old_swapchain = std::move(runtime_state.swapchain)};
+			if (const auto result = invalidate(device_context); !result)
+				return result.error().forward("Invalidate swapchain failed");
 			return {};
 
 		default:
@@ -299,16 +347,44 @@ namespace vulkan
 		}
 	}
 
+	std::expected<bool, Error> SwapchainContext::wait_present(uint64_t present_id, uint64_t timeout)
+		const noexcept
+	{
+		ASSUME(present_wait);
+
+		if (!std::holds_alternative<RuntimeState>(state)) return true;
+
+		const auto& runtime_state = std::get<RuntimeState>(state);
+		if (present_id < runtime_state.first_present_id) return true;
+
+		const auto wait_result = runtime_state.swapchain.waitForPresent(present_id, timeout);
+		switch (wait_result)
+		{
+		case vk::Result::eSuccess:
+		case vk::Result::eSuboptimalKHR:
+			return true;
+
+		case vk::Result::eTimeout:
+			return false;
+
+		// Recreated on the next acquisition, the present will never complete
+		case vk::Result::eErrorOutOfDateKHR:
+			return true;
+
+		default:
+			return Error::from(wait_result);
+		}
+	}
+
 	std::expected<void, Error> SwapchainContext::recreate_swapchain(
 		const SurfaceInstanceContext& instance_context,
 		const SurfaceDeviceContext& device_context,
 		glm::u32vec2 extent
 	) noexcept
 	{
-		const auto prev_swapchain =
+		auto prev_swapchain =
 			util::get_variant<InvalidatedState>(state)
-				.transform([](InvalidatedState& invalid) { return std::move(invalid.old_swapchain); })
-				.value_or(nullptr);
+				.transform([](InvalidatedState& invalid) { return std::move(invalid.old_swapchain); });
 
 		const auto surface_capability_result =
 			device_context.get().phy_device.getSurfaceCapabilitiesKHR(instance_context->surface);
@@ -348,7 +424,7 @@ namespace vulkan
 			.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque,
 			.presentMode = present_mode,
 			.clipped = vk::True,
-			.oldSwapchain = prev_swapchain
+			.oldSwapchain = prev_swapchain ? *prev_swapchain->swapchain : vk::SwapchainKHR()
 		};
 		swapchain_create_info.setQueueFamilyIndices(*queue_family_indices);
 
@@ -376,9 +452,87 @@ namespace vulkan
 			.swapchain = std::move(swapchain),
 			.extent = clamped_extent,
 			.images = images,
-			.image_views = std::move(image_views)
+			.image_views = std::move(image_views),
+			.first_present_id = present_count + 1
+		};
+
+		// Otherwise the device has been waited idle on invalidation, and the old swapchain is destroyed here
+		if (swapchain_maintenance && prev_swapchain) retired_swapchains.push_back(std::move(*prev_swapchain));
+
+		return {};
+	}
+
+	std::expected<void, Error> SwapchainContext::invalidate(
+		const SurfaceDeviceContext& device_context
+	) noexcept
+	{
+		ASSERT(std::holds_alternative<RuntimeState>(state));
+		auto& runtime_state = std::get<RuntimeState>(state);
+
+		// Without present fences, there is no way to tell when the old images are released
+		if (!swapchain_maintenance)
+			if (const auto result = device_context->waitIdle(); !result) return Error::from(result);
+
+		auto old_swapchain = RetiredSwapchain{
+			.swapchain = std::move(runtime_state.swapchain),
+			.image_views = std::move(runtime_state.image_views),
+			.present_fences = std::move(runtime_state.present_fences)
 		};
+		state = InvalidatedState{.old_swapchain = std::move(old_swapchain)};
+
+		return {};
+	}
+
+	std::expected<void, Error> SwapchainContext::recycle_present_fences(
+		const SurfaceDeviceContext& device_context,
+		std::deque<vk::raii::Fence>& fences
+	) noexcept
+	{
+		// Checked in present order, stop at the first pending one
+		while (!fences.empty())
+		{
+			const auto status = fences.front().getStatus();
+			if (status == vk::Result::eNotReady) break;
+			if (status != vk::Result::eSuccess) return Error::from(status);
+
+			if (const auto result = device_context->resetFences(*fences.front()); !result)
+				return Error::from(result);
+
+			free_present_fences.push_back(std::move(fences.front()));
+			fences.pop_front();
+		}
+
+		return {};
+	}
+
+	std::expected<void, Error> SwapchainContext::collect_retired_swapchains(
+		const SurfaceDeviceContext& device_context
+	) noexcept
+	{
+		for (auto& retired : retired_swapchains)
+			if (const auto result = recycle_present_fences(device_context, retired.present_fences); !result)
+				return result;
+
+		std::erase_if(retired_swapchains, [](const RetiredSwapchain& retired) {
+			return retired.present_fences.empty();
+		});
 
 		return {};
 	}
+
+	std::expected<vk::raii::Fence, Error> SwapchainContext::take_present_fence(
+		const SurfaceDeviceContext& device_context
+	) noexcept
+	{
+		if (!free_present_fences.empty())
+		{
+			auto fence = std::move(free_present_fences.back());
+			free_present_fences.pop_back();
+			return fence;
+		}
+
+		auto fence_result = device_context->createFence({});
+		if (!fence_result) return Error::from(fence_result);
+		return std::move(*fence_result);
+	}
 }
@@ -0,0 +1,74 @@
+#include "vulkan/context/capability.hpp"
+#include "common/test-macro.hpp"
+#include "vulkan/context/device.hpp"
+#include "vulkan/context/instance.hpp"
+
+#include <cstdint>
+#include <doctest.h>
+#include <utility>
+
+static constexpr uint64_t GIB = 1024ull * 1024 * 1024;
+
+static constexpr auto HIGH_END = vulkan::DeviceCapability{
+	.integrated = false,
+	.ray_query = true,
+	.mesh_shader = true,
+	.fragment_shading_rate = true,
+	.resizable_bar = true,
+	.subgroup_size = 32,
+	.device_local_size = 16 * GIB,
+};
+
+TEST_CASE("Device tier")
+{
+	using Tier = vulkan::DeviceCapability::Tier;
+
+	CHECK_EQ(HIGH_END.get_tier(), Tier::High);
+
+	SUBCASE("Integrated")
+	{
+		auto capability = HIGH_END;
+		capability.integrated = true;
+		CHECK_EQ(capability.get_tier(), Tier::Low);
+	}
+
+	SUBCASE("No ray query")
+	{
+		auto capability = HIGH_END;
+		capability.ray_query = false;
+		CHECK_EQ(capability.get_tier(), Tier::Low);
+	}
+
+	SUBCASE("Small memory")
+	{
+		auto capability = HIGH_END;
+		capability.device_local_size = 2 * GIB;
+		CHECK_EQ(capability.get_tier(), Tier::Low);
+	}
+
+	SUBCASE("Mainstream")
+	{
+		auto capability = HIGH_END;
+		capability.device_local_size = 6 * GIB;
+		CHECK_EQ(capability.get_tier(), Tier::Medium);
+
+		capability.device_local_size = 12 * GIB;
+		capability.mesh_shader = false;
+		CHECK_EQ(capability.get_tier(), Tier::Medium);
+	}
+}
+
+TEST_CASE("Probe device capability")
+{
+	auto instance_context_result = vulkan::HeadlessInstanceContext::create(vulkan::InstanceConfig());
+	EXPECT_SUCCESS(instance_context_result);
+	auto instance_context = std::move(*instance_context_result);
+
+	auto device_context_result =
+		vulkan::HeadlessDeviceContext::create(instance_context, vulkan::DeviceFeature());
+	EXPECT_SUCCESS(device_context_result);
+
+	const auto capability = vulkan::DeviceCapability::probe(device_context_result->get().phy_device);
+	CHECK_GT(capability.subgroup_size, 0);
+	CHECK_GT(capability.device_local_size, 0);
+}
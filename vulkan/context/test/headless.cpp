@@ -34,3 +34,15 @@ TEST_CASE("Validation layer")
 
 	test_create(instance_config, device_config);
 }
+
+TEST_CASE("All devices")
+{
+	auto instance_context_result = vulkan::HeadlessInstanceContext::create(vulkan::InstanceConfig());
+	EXPECT_SUCCESS(instance_context_result);
+	auto instance_context = std::move(*instance_context_result);
+
+	auto device_contexts_result =
+		vulkan::HeadlessDeviceContext::create_all(instance_context, vulkan::DeviceFeature());
+	EXPECT_SUCCESS(device_contexts_result);
+	CHECK_FALSE(device_contexts_result->empty());
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <mutex>
+#include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
 #include "vulkan/alloc/allocator.hpp"
@@ -29,18 +31,20 @@ namespace vulkan
 	/// #### Vulkan 1.0
 	/// - Robust buffer access
 	/// - Sampler anisotropy
-	/// - BC textures
+	/// - BC or ETC2 textures, all that the device supports along with ASTC LDR
 	/// - Pipeline statistics
 	/// - Multi draw indirect
+	/// - Fragment stores and atomics
 	///
 	/// #### Vulkan 1.1
 	/// - Shader draw parameters (required by slang)
 	///
 	/// #### Vulkan 1.2
 	/// - Half-precision float in shader
+	/// - Timeline semaphore
 	/// - Scalar shader block layout
 	/// - Runtime descriptor array
-	/// - Descriptor indexing (basic supports)
+	/// - Descriptor indexing (basic supports, updating unused descriptors while pending)
 	/// - Buffer device address
 	///
 	/// #### Vulkan 1.3
@@ -58,13 +62,39 @@ namespace vulkan
 		/// @brief Raytracing feature
 		/// @details Implies:
 		/// - Acceleration structure (BLAS/TLAS)
+		/// - Ray query (inline ray tracing in any shader stage)
 		///
 		/// and also their dependencies
 		///
 		bool raytracing = false;
 
+		///
+		/// @brief Ray tracing pipeline feature, requires `raytracing`
+		/// @details Implies:
+		/// - Ray tracing pipeline (`vkCmdTraceRaysKHR` with shader binding tables)
+		///
+		bool raytracing_pipeline = false;
+
+		///
+		/// @brief Mesh shader feature
+		/// @details Implies:
+		/// - Task shader
+		/// - Mesh shader
+		///
+		bool mesh_shader = false;
+
 		/* On-demand Features */
 		// Runs on fallback policies if not present
+
+		///
+		/// @brief Attachment fragment shading rate feature
+		/// @details Implies:
+		/// - Pipeline fragment shading rate
+		/// - Attachment fragment shading rate (`VK_KHR_fragment_shading_rate`)
+		///
+		/// Enabled only if requested and supported, check `Context::feature` for the outcome
+		///
+		bool fragment_shading_rate = false;
 	};
 
 	///
@@ -77,6 +107,9 @@ namespace vulkan
 		const vk::raii::Device& device;
 		const vulkan::Allocator& allocator;
 
+		// Pipeline cache, pass it to all pipeline creations
+		const vk::raii::PipelineCache& pipeline_cache;
+
 		// Main queue, available for compute, transfer and graphics
 		const vk::raii::Queue& queue;
 
@@ -86,7 +119,43 @@ namespace vulkan
 		// Queue family of the main queue
 		uint32_t family;
 
+		// Async compute queue, aliases the main queue if the device has no dedicated compute family
+		const vk::raii::Queue& compute_queue;
+		uint32_t compute_family;
+
+		// Transfer queue, aliases the main queue if the device has no dedicated transfer family
+		const vk::raii::Queue& transfer_queue;
+		uint32_t transfer_family;
+
 		// Device Feature
 		DeviceFeature feature;
+
+		///
+		/// @brief Get the distinct queue families of the main, compute and transfer queues
+		/// @details Use it as the queue family indices of resources with `eConcurrent` sharing mode, which
+		/// are accessed from multiple queues
+		///
+		/// @return Sorted distinct queue family indices, main family is always included
+		///
+		[[nodiscard]]
+		std::vector<uint32_t> unique_families() const noexcept
+		{
+			std::vector<uint32_t> families = {family, compute_family, transfer_family};
+			std::ranges::sort(families);
+			const auto [first, last] = std::ranges::unique(families);
+			families.erase(first, last);
+			return families;
+		}
+
+		///
+		/// @brief Get the sharing mode for resources accessed from multiple queues
+		///
+		/// @return `eConcurrent` if the queues span multiple families, `eExclusive` otherwise
+		///
+		[[nodiscard]]
+		vk::SharingMode multi_queue_sharing_mode() const noexcept
+		{
+			return unique_families().size() > 1 ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
+		}
 	};
 }
@@ -1,25 +1,30 @@
 #pragma once
 
+#include <cstdint>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
 namespace vulkan
 {
 	///
-	/// @brief Get the image subresource range for an image with 1 mip-level and 1 layer
+	/// @brief Get the image subresource range for an image with 1 mip-level, 1 layer by default
 	///
 	/// @param aspect_flags The aspect flags of the image, e.g. `vk::ImageAspectFlagBits::eColor` for a color
 	/// image
+	/// @param layer_count Layers from the first one, for layered attachments
 	/// @return The image subresource range for the given aspect flags
 	///
-	constexpr vk::ImageSubresourceRange base_level_image_range(vk::ImageAspectFlags aspect_flags) noexcept
+	constexpr vk::ImageSubresourceRange base_level_image_range(
+		vk::ImageAspectFlags aspect_flags,
+		uint32_t layer_count = 1
+	) noexcept
 	{
 		return vk::ImageSubresourceRange{
 			.aspectMask = aspect_flags,
 			.baseMipLevel = 0,
 			.levelCount = 1,
 			.baseArrayLayer = 0,
-			.layerCount = 1,
+			.layerCount = layer_count,
 		};
 	}
 
@@ -3,55 +3,201 @@
 #include "common/util/error.hpp"
 #include "vulkan/interface/context.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <expected>
 #include <functional>
 #include <limits>
+#include <span>
 #include <utility>
+#include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace vulkan
 {
 	///
 	/// @brief Simple command runner, contains all necessary stuffs to run commands on GPU easily
+	/// @details
+	/// - @p run submits and blocks until the commands complete
+	/// - @p submit_async submits and returns a `Ticket` backed by a timeline semaphore, so that the caller
+	/// can record the next submission while the GPU executes the previous ones. Wait on the ticket with
+	/// @p wait, or poll it with @p is_complete, e.g. between `co_await`s of a coroutine
+	///
 	/// @note Not suitable for render-loop, as it frequently allocates and deallocates command buffers
+	/// @warning Wait for the last ticket before destroying the runner, as it frees the command buffers
 	///
 	class CommandRunner
 	{
 	  public:
 
+		///
+		/// @brief Queue to submit commands to
+		///
+		enum class QueueType
+		{
+			Main,      // Main queue, supports graphics, compute and transfer
+			Compute,   // Async compute queue, supports compute and transfer
+			Transfer,  // Transfer queue, supports transfer only
+		};
+
+		///
+		/// @brief Ticket of an asynchronous submission
+		///
+		struct Ticket
+		{
+			uint64_t value = 0;  // Timeline value signaled on completion, zero is always complete
+		};
+
+		// Maximum async submissions in flight, submitting more waits for the oldest one
+		static constexpr size_t MAX_ASYNC_IN_FLIGHT = 3;
+
 		///
 		/// @brief Create a command runner
 		///
 		/// @param context Vulkan context
+		/// @param queue_type Queue to submit commands to. Aliases the main queue if the device has no
+		/// dedicated family for it
 		/// @return Created command runner or error
 		///
-		static std::expected<CommandRunner, Error> create(const vulkan::Context& context) noexcept;
+		static std::expected<CommandRunner, Error> create(
+			const vulkan::Context& context,
+			QueueType queue_type = QueueType::Main
+		) noexcept;
 
 		///
-		/// @brief Run given action
+		/// @brief Run given action, and wait for it to complete
 		///
 		/// @param context Vulkan context
 		/// @param action Action, returns void
 		/// @param timeout Timeout for waiting on fence
+		/// @param wait_semaphores Semaphores to wait on before executing the action
 		/// @return `void` if success or error
 		///
 		std::expected<void, Error> run(
 			const vulkan::Context& context,
 			const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action,
+			uint64_t timeout = std::numeric_limits<uint64_t>::max(),
+			std::span<const vk::SemaphoreSubmitInfo> wait_semaphores = {}
+		) const noexcept;
+
+		///
+		/// @brief Submit given action without waiting for it to complete
+		/// @note The returned command buffer must be kept alive until the signal semaphores are reached
+		///
+		/// @param context Vulkan context
+		/// @param action Action, returns void
+		/// @param signal_semaphores Semaphores to signal after the action completes
+		/// @return Submitted command buffer or error
+		///
+		[[nodiscard]]
+		std::expected<vk::raii::CommandBuffer, Error> submit(
+			const vulkan::Context& context,
+			const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action,
+			std::span<const vk::SemaphoreSubmitInfo> signal_semaphores
+		) const noexcept;
+
+		///
+		/// @brief Submit given action without waiting for it, the runner keeps the command buffer alive
+		/// @details Submissions execute in submission order on the queue, but are not synchronized with
+		/// each other. Insert barriers in @p action if it accesses resources used by previous submissions.
+		///
+		/// @param context Vulkan context
+		/// @param action Action, returns void
+		/// @param wait_semaphores Semaphores to wait on before executing the action
+		/// @return Ticket completing with the action, or error
+		///
+		[[nodiscard]]
+		std::expected<Ticket, Error> submit_async(
+			const vulkan::Context& context,
+			const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action,
+			std::span<const vk::SemaphoreSubmitInfo> wait_semaphores = {}
+		) noexcept;
+
+		///
+		/// @brief Wait for an async submission, and release the command buffers of completed ones
+		///
+		/// @param context Vulkan context
+		/// @param ticket Ticket returned by @p submit_async
+		/// @param timeout Timeout for waiting on the timeline semaphore
+		/// @return `void` if success or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> wait(
+			const vulkan::Context& context,
+			Ticket ticket,
 			uint64_t timeout = std::numeric_limits<uint64_t>::max()
+		) noexcept;
+
+		///
+		/// @brief Check whether an async submission has completed, without blocking
+		///
+		/// @param ticket Ticket returned by @p submit_async
+		/// @return Whether the submission has completed, or error
+		///
+		[[nodiscard]]
+		std::expected<bool, Error> is_complete(Ticket ticket) const noexcept;
+
+		///
+		/// @brief Get a semaphore submit info waiting for an async submission, to make another submission,
+		/// possibly on another queue, depend on it
+		///
+		/// @param ticket Ticket returned by @p submit_async
+		/// @param stage_mask Stages of the other submission waiting for the ticket
+		/// @return Semaphore submit info, to be passed as a wait semaphore
+		///
+		[[nodiscard]]
+		vk::SemaphoreSubmitInfo get_wait_info(
+			Ticket ticket,
+			vk::PipelineStageFlags2 stage_mask = vk::PipelineStageFlagBits2::eAllCommands
 		) const noexcept;
 
+		///
+		/// @brief Get the queue family of the queue this runner submits to
+		///
+		/// @param context Vulkan context
+		/// @return Queue family index
+		///
+		[[nodiscard]]
+		uint32_t family(const vulkan::Context& context) const noexcept;
+
 	  private:
 
+		struct InFlight
+		{
+			uint64_t value;
+			vk::raii::CommandBuffer command_buffer;
+		};
+
+		QueueType queue_type;
 		vk::raii::CommandPool command_pool;
 		vk::raii::Fence fence;
 
-		explicit CommandRunner(vk::raii::CommandPool command_pool, vk::raii::Fence fence) :
+		vk::raii::Semaphore timeline;
+		uint64_t timeline_value = 0;     // Value of the latest async submission
+		std::deque<InFlight> in_flight;  // Async submissions, sorted by value
+
+		explicit CommandRunner(
+			QueueType queue_type,
+			vk::raii::CommandPool command_pool,
+			vk::raii::Fence fence,
+			vk::raii::Semaphore timeline
+		) :
+			queue_type(queue_type),
 			command_pool(std::move(command_pool)),
-			fence(std::move(fence))
+			fence(std::move(fence)),
+			timeline(std::move(timeline))
 		{}
 
+		[[nodiscard]]
+		const vk::raii::Queue& queue(const vulkan::Context& context) const noexcept;
+
+		[[nodiscard]]
+		std::expected<vk::raii::CommandBuffer, Error> record(
+			const vulkan::Context& context,
+			const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action
+		) const noexcept;
+
 	  public:
 
 		CommandRunner(const CommandRunner&) = delete;
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+// Object names and command buffer labels through `VK_EXT_debug_utils`, shown in frame captures of RenderDoc
+// or Nsight and in validation messages. Enabled by `VULKAN_DEBUG_UTILS`, which is defined in all but release
+// mode. Without it, all calls are inline no-ops. With it, calls are ignored if the instance lacks the
+// extension.
+
+namespace vulkan
+{
+	///
+	/// @brief Scoped debug label of a command buffer region, ends on destruction
+	/// @note Labels may nest, but must begin and end in the same command buffer
+	///
+	class DebugLabel
+	{
+	  public:
+
+		///
+		/// @brief Begin a debug label
+		///
+		/// @param command_buffer Command buffer to label
+		/// @param name Name of the label, must outlive the recording of the command buffer
+		///
+		DebugLabel(const vk::raii::CommandBuffer& command_buffer, const char* name) noexcept;
+
+		~DebugLabel() noexcept;
+
+	  private:
+
+#ifdef VULKAN_DEBUG_UTILS
+		const vk::raii::CommandBuffer* command_buffer;  // Null if debug utils are unavailable
+#endif
+
+	  public:
+
+		DebugLabel(const DebugLabel&) = delete;
+		DebugLabel(DebugLabel&&) = delete;
+		DebugLabel& operator=(const DebugLabel&) = delete;
+		DebugLabel& operator=(DebugLabel&&) = delete;
+	};
+
+	///
+	/// @brief Name a Vulkan object
+	///
+	/// @tparam HandleType Vulkan-hpp handle type, e.g. `vk::Buffer`
+	/// @param device Vulkan device owning the object
+	/// @param handle Object to name
+	/// @param name Name of the object, copied
+	///
+	template <typename HandleType>
+	void set_debug_name(
+		[[maybe_unused]] const vk::raii::Device& device,
+		[[maybe_unused]] HandleType handle,
+		[[maybe_unused]] const char* name
+	) noexcept
+	{
+#ifdef VULKAN_DEBUG_UTILS
+		if (device.getDispatcher()->vkSetDebugUtilsObjectNameEXT == nullptr) return;
+
+		std::ignore = device.setDebugUtilsObjectNameEXT({
+			.objectType = HandleType::objectType,
+			.objectHandle = reinterpret_cast<uint64_t>(static_cast<typename HandleType::CType>(handle)),
+			.pObjectName = name,
+		});
+#endif
+	}
+
+#ifndef VULKAN_DEBUG_UTILS
+
+	inline DebugLabel::DebugLabel(const vk::raii::CommandBuffer&, const char*) noexcept {}
+
+	inline DebugLabel::~DebugLabel() noexcept = default;
+
+#endif
+}
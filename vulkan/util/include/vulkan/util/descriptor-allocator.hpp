@@ -0,0 +1,134 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief Growable allocator of transient descriptor sets, freed all at once by `reset`
+	/// @details
+	/// - Allocates from a chain of descriptor pools. When the current pool runs out of memory or gets
+	/// fragmented, moves on to the next pool, creating one with twice the capacity if none is left
+	/// - Pools are sized by per-set ratios of each descriptor type, so any layout can be allocated from them
+	/// - Meant for descriptor sets rewritten every frame. Create one for each in-flight frame, and call
+	/// `reset()` after waiting for the fence of the frame, instead of freeing the sets one by one
+	///
+	/// @note Sets with fixed resources never rewritten after creation are better kept in the resource sets
+	/// of their pipelines, whose `DescriptorWriteCache` skips redundant writes
+	///
+	class DescriptorAllocator
+	{
+	  public:
+
+		///
+		/// @brief Average number of descriptors of a type per set, used to size the pools
+		///
+		struct Ratio
+		{
+			vk::DescriptorType type;
+			float count;
+		};
+
+		///
+		/// @brief Default ratios, covering the descriptor types used by the renderer
+		/// @note Acceleration structure descriptors are only added when ray tracing is enabled
+		///
+		static constexpr auto DEFAULT_RATIOS = std::to_array<Ratio>({
+			{.type = vk::DescriptorType::eUniformBuffer,        .count = 2.0f},
+			{.type = vk::DescriptorType::eStorageBuffer,        .count = 4.0f},
+			{.type = vk::DescriptorType::eCombinedImageSampler, .count = 4.0f},
+			{.type = vk::DescriptorType::eSampledImage,         .count = 2.0f},
+			{.type = vk::DescriptorType::eStorageImage,         .count = 2.0f},
+			{.type = vk::DescriptorType::eSampler,              .count = 1.0f},
+		});
+
+		///
+		/// @brief Create a descriptor allocator
+		///
+		/// @param context Vulkan context
+		/// @param initial_set_count Number of sets the first pool can hold
+		/// @param ratios Descriptors of each type per set, see `DEFAULT_RATIOS`
+		/// @return Created descriptor allocator or error
+		///
+		[[nodiscard]]
+		static std::expected<DescriptorAllocator, Error> create(
+			const vulkan::Context& context,
+			uint32_t initial_set_count = 64,
+			std::span<const Ratio> ratios = DEFAULT_RATIOS
+		) noexcept;
+
+		///
+		/// @brief Allocate descriptor sets, valid until the next `reset()`
+		///
+		/// @param device Vulkan device
+		/// @param layouts Layout of each set
+		/// @return Allocated descriptor sets, in the order of @p layouts, or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<vk::DescriptorSet>, Error> allocate(
+			const vk::raii::Device& device,
+			std::span<const vk::DescriptorSetLayout> layouts
+		) noexcept;
+
+		///
+		/// @brief Allocate a single descriptor set, valid until the next `reset()`
+		///
+		/// @param device Vulkan device
+		/// @param layout Layout of the set
+		/// @return Allocated descriptor set or error
+		///
+		[[nodiscard]]
+		std::expected<vk::DescriptorSet, Error> allocate(
+			const vk::raii::Device& device,
+			vk::DescriptorSetLayout layout
+		) noexcept;
+
+		///
+		/// @brief Free all sets allocated since the last reset, keeping the pools for reuse
+		/// @warning The sets must no longer be in use by the GPU
+		///
+		void reset() noexcept;
+
+	  private:
+
+		std::vector<Ratio> ratios;
+		std::vector<vk::raii::DescriptorPool> pools;
+		size_t current_pool = 0;
+		uint32_t next_set_count;  // Capacity of the next pool to be created
+
+		explicit DescriptorAllocator(
+			std::vector<Ratio> ratios,
+			vk::raii::DescriptorPool first_pool,
+			uint32_t next_set_count
+		) noexcept :
+			ratios(std::move(ratios)),
+			next_set_count(next_set_count)
+		{
+			pools.push_back(std::move(first_pool));
+		}
+
+		[[nodiscard]]
+		static std::expected<vk::raii::DescriptorPool, Error> create_pool(
+			const vk::raii::Device& device,
+			std::span<const Ratio> ratios,
+			uint32_t set_count
+		) noexcept;
+
+	  public:
+
+		DescriptorAllocator(const DescriptorAllocator&) = delete;
+		DescriptorAllocator(DescriptorAllocator&&) = default;
+		DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+		DescriptorAllocator& operator=(DescriptorAllocator&&) = default;
+	};
+}
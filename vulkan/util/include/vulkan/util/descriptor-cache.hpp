@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief Skips descriptor writes whose contents are already in the descriptor sets
+	/// @details
+	/// - Remembers the resources last written to each `(set, binding, array element)`, and only forwards the
+	/// writes referencing different resources (handles, offsets, ranges and layouts) to
+	/// `updateDescriptorSets`
+	/// - Meant for resource sets updated every frame, whose bound resources rarely change, e.g. only on
+	/// resize. After the first update, a frame with unchanged resources writes no descriptor at all
+	/// - Writes with unrecognized `pNext` chains are always forwarded. Acceleration structure writes are
+	/// tracked.
+	///
+	/// @warning Writes to the same set must address the same bindings and array elements on every update,
+	/// and the tracked descriptor sets must stay alive. Call @p clear after freeing or resetting them.
+	///
+	class DescriptorWriteCache
+	{
+	  public:
+
+		DescriptorWriteCache() = default;
+
+		///
+		/// @brief Write the descriptors that changed since the last update
+		///
+		/// @param device Vulkan device
+		/// @param writes Descriptor writes, as passed to `updateDescriptorSets`
+		///
+		void update(const vk::raii::Device& device, std::span<const vk::WriteDescriptorSet> writes) noexcept;
+
+		///
+		/// @brief Forget all written descriptors, the next update writes everything
+		///
+		void clear() noexcept;
+
+	  private:
+
+		struct Entry
+		{
+			vk::DescriptorSet set;
+			uint32_t binding;
+			uint32_t array_element;
+			std::vector<uint64_t> key;
+		};
+
+		std::vector<Entry> entries;
+
+		// Scratch, kept to avoid allocations in steady state
+		std::vector<uint64_t> key_scratch;
+		std::vector<vk::WriteDescriptorSet> changed_writes;
+
+	  public:
+
+		DescriptorWriteCache(const DescriptorWriteCache&) = delete;
+		DescriptorWriteCache(DescriptorWriteCache&&) = default;
+		DescriptorWriteCache& operator=(const DescriptorWriteCache&) = delete;
+		DescriptorWriteCache& operator=(DescriptorWriteCache&&) = default;
+	};
+}
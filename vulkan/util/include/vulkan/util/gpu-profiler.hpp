@@ -0,0 +1,115 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#ifdef TRACY_ENABLE
+#include <optional>
+#include <tracy/TracyVulkan.hpp>
+#endif
+
+namespace vulkan
+{
+	///
+	/// @brief GPU zones of the Tracy profiler on the main queue, see "common/util/profile.hpp"
+	/// @details Create one for the main queue, shared by all frames in flight. In each frame:
+	/// 1. Call `collect()` at the start of the command buffer, outside of any render pass
+	/// 2. Wrap passes with `zone()`, the zone ends when the returned object is destroyed
+	///
+	/// @note Without the "tracy" build option, creation always succeeds and all calls are no-ops
+	///
+	class GpuProfiler
+	{
+	  public:
+
+		///
+		/// @brief Scoped GPU zone, ends on destruction
+		///
+		class Zone
+		{
+		  private:
+
+#ifdef TRACY_ENABLE
+			std::optional<tracy::VkCtxScope> scope;
+#endif
+
+			explicit Zone(
+				const GpuProfiler& profiler,
+				const vk::raii::CommandBuffer& command_buffer,
+				std::string_view name
+			) noexcept;
+
+			friend class GpuProfiler;
+
+		  public:
+
+			Zone(const Zone&) = delete;
+			Zone(Zone&&) = delete;
+			Zone& operator=(const Zone&) = delete;
+			Zone& operator=(Zone&&) = delete;
+		};
+
+		///
+		/// @brief Create a GPU profiler
+		/// @note Submits to and waits for the main queue for calibration, holding `context.submit_mutex`
+		///
+		/// @param instance Vulkan instance of @p context
+		/// @param context Vulkan context
+		/// @return Created GPU profiler or error
+		///
+		[[nodiscard]]
+		static std::expected<GpuProfiler, Error> create(
+			const vk::raii::Instance& instance,
+			const vulkan::Context& context
+		) noexcept;
+
+		///
+		/// @brief Read back the zones of completed frames, and reset their queries
+		///
+		/// @param command_buffer Command buffer on the main queue, must be outside of any render pass
+		///
+		void collect(const vk::raii::CommandBuffer& command_buffer) const noexcept;
+
+		///
+		/// @brief Begin a named zone
+		/// @note Zones may nest, but must not outlive the command buffer recording
+		///
+		/// @param command_buffer Command buffer
+		/// @param name Name of the zone, copied
+		/// @return Zone object, ends the zone when destroyed
+		///
+		[[nodiscard]]
+		Zone zone(const vk::raii::CommandBuffer& command_buffer, std::string_view name) const noexcept;
+
+	  private:
+
+#ifdef TRACY_ENABLE
+		struct ContextDeleter
+		{
+			void operator()(tracy::VkCtx* context) const noexcept;
+		};
+
+		std::unique_ptr<tracy::VkCtx, ContextDeleter> tracy_context;
+
+		explicit GpuProfiler(std::unique_ptr<tracy::VkCtx, ContextDeleter> tracy_context) :
+			tracy_context(std::move(tracy_context))
+		{}
+#else
+		GpuProfiler() = default;
+#endif
+
+	  public:
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler(GpuProfiler&&) = default;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(GpuProfiler&&) = default;
+	};
+}
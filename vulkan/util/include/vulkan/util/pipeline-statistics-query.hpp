@@ -0,0 +1,142 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief Pipeline statistics query for a single frame, counts the work of named slots
+	/// @details Create one for each in-flight frame. Each slot is queried at most once per frame, so that
+	/// slots can be recorded concurrently into different secondary command buffers. In each frame:
+	/// 1. Wait for the fence of the frame, then call `read_results()` to get the statistics of last time
+	/// 2. Call `begin_frame()` in the primary command buffer, before any of the slots are executed
+	/// 3. Wrap passes with `scope()`, the query ends when the returned object is destroyed
+	///
+	/// @note Queries of the same type can't nest, and can't be active in a primary command buffer while it
+	/// executes secondary command buffers. Record the scopes in the command buffers holding the passes.
+	///
+	class PipelineStatisticsQuery
+	{
+	  public:
+
+		///
+		/// @brief Statistics of a named slot
+		///
+		struct Result
+		{
+			std::string name;
+			uint64_t input_primitives;      // Primitives assembled from the vertices
+			uint64_t vertex_invocations;    // Vertex shader invocations
+			uint64_t clipping_primitives;   // Primitives output by the clipping stage
+			uint64_t fragment_invocations;  // Fragment shader invocations
+			uint64_t compute_invocations;   // Compute shader invocations
+		};
+
+		///
+		/// @brief Scoped query, ends the query on destruction
+		///
+		class Scope
+		{
+		  public:
+
+			~Scope() noexcept;
+
+		  private:
+
+			const vk::raii::CommandBuffer* command_buffer;
+			const vk::raii::QueryPool* query_pool;
+			uint32_t query;
+
+			explicit Scope(
+				const vk::raii::CommandBuffer* command_buffer,
+				const vk::raii::QueryPool* query_pool,
+				uint32_t query
+			) noexcept :
+				command_buffer(command_buffer),
+				query_pool(query_pool),
+				query(query)
+			{}
+
+			friend class PipelineStatisticsQuery;
+
+		  public:
+
+			Scope(const Scope&) = delete;
+			Scope(Scope&&) = delete;
+			Scope& operator=(const Scope&) = delete;
+			Scope& operator=(Scope&&) = delete;
+		};
+
+		///
+		/// @brief Create a pipeline statistics query
+		///
+		/// @param context Vulkan context, the `pipelineStatisticsQuery` device feature must be enabled
+		/// @param slot_names Names of the slots, indexed by `scope()`
+		/// @return Created pipeline statistics query or error
+		///
+		[[nodiscard]]
+		static std::expected<PipelineStatisticsQuery, Error> create(
+			const vulkan::Context& context,
+			std::span<const std::string_view> slot_names
+		) noexcept;
+
+		///
+		/// @brief Reset the queries of all slots
+		///
+		/// @param command_buffer Primary command buffer, must be outside of any render pass
+		///
+		void begin_frame(const vk::raii::CommandBuffer& command_buffer) noexcept;
+
+		///
+		/// @brief Begin the query of a slot
+		/// @note Thread-safe, as long as each slot is used once per frame
+		///
+		/// @param command_buffer Command buffer, must be outside of any render pass
+		/// @param slot Index of the slot, out-of-range slots are ignored
+		/// @return Scope object, ends the query when destroyed
+		///
+		[[nodiscard]]
+		Scope scope(const vk::raii::CommandBuffer& command_buffer, uint32_t slot) const noexcept;
+
+		///
+		/// @brief Read the statistics of the slots queried since the last `begin_frame()`
+		/// @warning Call it only after the command buffers have finished execution
+		///
+		/// @return Statistics of the queried slots in slot order, or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<Result>, Error> read_results() const noexcept;
+
+	  private:
+
+		vk::raii::QueryPool query_pool;
+		std::vector<std::string> slot_names;
+		bool reset = false;
+
+		explicit PipelineStatisticsQuery(
+			vk::raii::QueryPool query_pool,
+			std::vector<std::string> slot_names
+		) :
+			query_pool(std::move(query_pool)),
+			slot_names(std::move(slot_names))
+		{}
+
+	  public:
+
+		PipelineStatisticsQuery(const PipelineStatisticsQuery&) = delete;
+		PipelineStatisticsQuery(PipelineStatisticsQuery&&) = default;
+		PipelineStatisticsQuery& operator=(const PipelineStatisticsQuery&) = delete;
+		PipelineStatisticsQuery& operator=(PipelineStatisticsQuery&&) = default;
+	};
+}
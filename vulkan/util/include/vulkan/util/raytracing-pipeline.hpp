@@ -0,0 +1,303 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/alloc/buffer.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	class ShaderBindingTable;
+
+	///
+	/// @brief Ray tracing pipeline, traced with `vkCmdTraceRaysKHR` through a `ShaderBindingTable`
+	/// @details
+	/// - Shader groups are laid out by kind: ray generation, miss, hit and callable groups. Each kind is
+	/// indexed from zero, records of a shader binding table refer to groups by these indices.
+	/// - Hit groups are meant to be specialized per material class. A stage may be listed several times with
+	/// different specialization constants, e.g. a closest hit shader with and without alpha testing, and the
+	/// hit record of each primitive selects the group of its material.
+	/// - Group handles are queried once on creation
+	///
+	/// @note Requires the `raytracing_pipeline` device feature. See `vulkan::DeviceFeature`.
+	///
+	class RaytracingPipeline
+	{
+	  public:
+
+		///
+		/// @brief Stages of a hit group, as indices into `CreateInfo::stages`
+		///
+		struct HitGroup
+		{
+			std::optional<uint32_t> closest_hit = std::nullopt;
+			std::optional<uint32_t> any_hit = std::nullopt;
+			std::optional<uint32_t> intersection = std::nullopt;  // Procedural hit group if set
+		};
+
+		///
+		/// @brief Stages and groups of a ray tracing pipeline
+		///
+		struct CreateInfo
+		{
+			std::span<const vk::PipelineShaderStageCreateInfo> stages;
+			std::span<const uint32_t> raygen_groups;    // Stage index of each ray generation group
+			std::span<const uint32_t> miss_groups;      // Stage index of each miss group
+			std::span<const HitGroup> hit_groups;       // Stages of each hit group
+			std::span<const uint32_t> callable_groups;  // Stage index of each callable group
+			uint32_t max_recursion_depth = 1;           // Depth of nested `TraceRay` calls in the shaders
+		};
+
+		///
+		/// @brief Count of shader groups of each kind
+		///
+		struct GroupCount
+		{
+			uint32_t raygen;
+			uint32_t miss;
+			uint32_t hit;
+			uint32_t callable;
+
+			[[nodiscard]]
+			uint32_t total() const noexcept
+			{
+				return raygen + miss + hit + callable;
+			}
+		};
+
+		///
+		/// @brief Create a ray tracing pipeline
+		///
+		/// @param context Vulkan context, must have the `raytracing_pipeline` feature enabled
+		/// @param layout Pipeline layout
+		/// @param create_info Stages and groups
+		/// @return Created pipeline, or error
+		///
+		[[nodiscard]]
+		static std::expected<RaytracingPipeline, Error> create(
+			const Context& context,
+			vk::PipelineLayout layout,
+			const CreateInfo& create_info
+		) noexcept;
+
+		///
+		/// @brief Get the count of shader groups of each kind
+		///
+		/// @return Group count
+		///
+		[[nodiscard]]
+		GroupCount get_group_count() const noexcept
+		{
+			return group_count;
+		}
+
+		///
+		/// @brief Get the handle of a shader group
+		///
+		/// @param group Index of the group in the whole pipeline, kinds laid out in order
+		/// @return Opaque handle, `shaderGroupHandleSize` bytes
+		///
+		[[nodiscard]]
+		std::span<const std::byte> get_group_handle(uint32_t group) const noexcept;
+
+		operator vk::Pipeline() const noexcept { return pipeline; }
+
+	  private:
+
+		vk::raii::Pipeline pipeline;
+		GroupCount group_count;
+		uint32_t handle_size;
+		std::vector<std::byte> group_handles;  // Handles of all groups, tightly packed
+
+		explicit RaytracingPipeline(
+			vk::raii::Pipeline pipeline,
+			GroupCount group_count,
+			uint32_t handle_size,
+			std::vector<std::byte> group_handles
+		) :
+			pipeline(std::move(pipeline)),
+			group_count(group_count),
+			handle_size(handle_size),
+			group_handles(std::move(group_handles))
+		{}
+
+	  public:
+
+		RaytracingPipeline(const RaytracingPipeline&) = delete;
+		RaytracingPipeline(RaytracingPipeline&&) = default;
+		RaytracingPipeline& operator=(const RaytracingPipeline&) = delete;
+		RaytracingPipeline& operator=(RaytracingPipeline&&) = default;
+	};
+
+	///
+	/// @brief Shader binding table of a ray tracing pipeline
+	/// @details
+	/// - Each record holds the handle of a shader group, followed by optional data read in the shader through
+	/// `[[vk::shader_record]]`, e.g. device addresses of the buffers or the material index of a primitive
+	/// - Records of a region share a stride, fitting the handle and the largest data of the region, aligned
+	/// to `shaderGroupHandleAlignment`. Shorter data is zero padded.
+	/// - Regions start at `shaderGroupBaseAlignment` in a host-visible buffer, written once on creation
+	///
+	/// With the hit records laid out per primitive, see `render::Tlas::get_hit_record_params`, the record hit
+	/// by a ray is `primitive_index * stride + ray_type`, for `sbtRecordStride = stride` and
+	/// `sbtRecordOffset = ray_type` in `TraceRay`.
+	///
+	class ShaderBindingTable
+	{
+	  public:
+
+		///
+		/// @brief Record of a shader binding table
+		///
+		struct Record
+		{
+			uint32_t group;                         // Group index within the kind of the region
+			std::span<const std::byte> data = {};  // Shader record data
+		};
+
+		///
+		/// @brief Records of each region
+		///
+		struct Records
+		{
+			std::span<const Record> raygen;
+			std::span<const Record> miss;
+			std::span<const Record> hit;
+			std::span<const Record> callable;
+		};
+
+		///
+		/// @brief Placement of a region in the table, relative to the table base
+		///
+		struct RegionLayout
+		{
+			vk::DeviceSize offset;  // Multiple of `shaderGroupBaseAlignment`
+			vk::DeviceSize stride;  // Multiple of `shaderGroupHandleAlignment`
+			vk::DeviceSize size;    // `stride` times the record count
+		};
+
+		///
+		/// @brief Placement of all regions, laid out in the order of `Records`
+		///
+		struct Layout
+		{
+			RegionLayout raygen;
+			RegionLayout miss;
+			RegionLayout hit;
+			RegionLayout callable;
+			vk::DeviceSize size;  // End of the last region
+		};
+
+		///
+		/// @brief Compute the layout of a shader binding table, without checking the group indices
+		///
+		/// @param properties Ray tracing pipeline properties of the device
+		/// @param records Records of each region
+		/// @return Layout of the table, or error if a stride exceeds the device limit
+		///
+		[[nodiscard]]
+		static std::expected<Layout, Error> get_layout(
+			const vk::PhysicalDeviceRayTracingPipelinePropertiesKHR& properties,
+			const Records& records
+		) noexcept;
+
+		///
+		/// @brief Create a shader binding table
+		///
+		/// @param context Vulkan context, must have the `raytracing_pipeline` feature enabled
+		/// @param pipeline Pipeline providing the group handles
+		/// @param records Records of each region
+		/// @return Created shader binding table, or error if a record refers to a missing group or a stride
+		/// exceeds the device limit
+		///
+		[[nodiscard]]
+		static std::expected<ShaderBindingTable, Error> create(
+			const Context& context,
+			const RaytracingPipeline& pipeline,
+			const Records& records
+		) noexcept;
+
+		///
+		/// @brief Get the region of a ray generation record
+		///
+		/// @param index Index of the ray generation record
+		/// @return Region of the single record, as `vkCmdTraceRaysKHR` requires
+		///
+		[[nodiscard]]
+		vk::StridedDeviceAddressRegionKHR raygen_region(uint32_t index) const noexcept;
+
+		[[nodiscard]]
+		const vk::StridedDeviceAddressRegionKHR& miss_region() const noexcept
+		{
+			return miss;
+		}
+
+		[[nodiscard]]
+		const vk::StridedDeviceAddressRegionKHR& hit_region() const noexcept
+		{
+			return hit;
+		}
+
+		[[nodiscard]]
+		const vk::StridedDeviceAddressRegionKHR& callable_region() const noexcept
+		{
+			return callable;
+		}
+
+		///
+		/// @brief Trace rays with a ray generation record
+		/// @note The pipeline and its descriptor sets must be bound to `eRayTracingKHR` beforehand
+		///
+		/// @param command_buffer Command buffer
+		/// @param raygen_index Index of the ray generation record
+		/// @param width Launch width
+		/// @param height Launch height
+		/// @param depth Launch depth
+		///
+		void trace(
+			const vk::raii::CommandBuffer& command_buffer,
+			uint32_t raygen_index,
+			uint32_t width,
+			uint32_t height,
+			uint32_t depth = 1
+		) const noexcept;
+
+	  private:
+
+		Buffer buffer;
+		vk::StridedDeviceAddressRegionKHR raygen;  // All ray generation records
+		vk::StridedDeviceAddressRegionKHR miss;
+		vk::StridedDeviceAddressRegionKHR hit;
+		vk::StridedDeviceAddressRegionKHR callable;
+
+		explicit ShaderBindingTable(
+			Buffer buffer,
+			vk::StridedDeviceAddressRegionKHR raygen,
+			vk::StridedDeviceAddressRegionKHR miss,
+			vk::StridedDeviceAddressRegionKHR hit,
+			vk::StridedDeviceAddressRegionKHR callable
+		) :
+			buffer(std::move(buffer)),
+			raygen(raygen),
+			miss(miss),
+			hit(hit),
+			callable(callable)
+		{}
+
+	  public:
+
+		ShaderBindingTable(const ShaderBindingTable&) = delete;
+		ShaderBindingTable(ShaderBindingTable&&) = default;
+		ShaderBindingTable& operator=(const ShaderBindingTable&) = delete;
+		ShaderBindingTable& operator=(ShaderBindingTable&&) = default;
+	};
+}
@@ -28,7 +28,8 @@ namespace vulkan
 
 	///
 	/// @brief Read back an image from GPU to CPU, designed to use in testing and verification
-	/// @warning Do not use it in frame-loops, this is not designed to be efficient
+	/// @warning Do not use it in frame-loops, this is not designed to be efficient. Use
+	/// `vulkan::ReadbackRing` for per-frame readbacks instead
 	/// @note Make sure the target GPU image to readback from is created with
 	/// `vk::ImageUsageFlagBits::eTransferSrc`. The validation layer will warn if not.
 	///
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief Records passes into secondary command buffers in parallel, executed in order by a primary
+	/// @details
+	/// - Each slot owns a command pool and a secondary command buffer on the main queue family. Command pools
+	/// require external synchronization, so a pool per slot lets different slots record concurrently
+	/// - @p record re-records the secondary buffer of a slot, @p execute stitches it into the primary. The
+	/// secondary buffers inherit no state, each pass binds its own pipelines and descriptor sets and may
+	/// record barriers or whole dynamic rendering scopes
+	///
+	/// @warning The secondary buffers are reset on @p record, so a recorder must not be shared by command
+	/// buffers in flight, e.g. keep one recorder per frame in flight (see `vulkan::Cycle`)
+	///
+	class SecondaryRecorder
+	{
+	  public:
+
+		///
+		/// @brief Create a secondary recorder
+		///
+		/// @param context Vulkan context
+		/// @param slot_count Number of secondary command buffers, i.e. passes recorded in parallel
+		/// @return Created recorder or error
+		///
+		[[nodiscard]]
+		static std::expected<SecondaryRecorder, Error> create(
+			const vulkan::Context& context,
+			uint32_t slot_count
+		) noexcept;
+
+		///
+		/// @brief Record the secondary command buffer of a slot with given action
+		/// @note Thread-safe for different slots
+		///
+		/// @param slot Slot index
+		/// @param action Action recording into the secondary command buffer, outside of any render pass
+		/// @return `void` if success or error
+		///
+		[[nodiscard]]
+		std::expected<void, Error> record(
+			uint32_t slot,
+			const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action
+		) noexcept;
+
+		///
+		/// @brief Execute the secondary command buffer of a slot
+		///
+		/// @param primary Primary command buffer, must be outside of any render pass
+		/// @param slot Slot index, recorded since the last submission of @p primary
+		///
+		void execute(const vk::raii::CommandBuffer& primary, uint32_t slot) const noexcept;
+
+		///
+		/// @brief Get the number of slots
+		///
+		/// @return Number of slots
+		///
+		[[nodiscard]]
+		uint32_t slot_count() const noexcept
+		{
+			return static_cast<uint32_t>(command_buffers.size());
+		}
+
+	  private:
+
+		// Command buffers must be destroyed before the pools they are allocated from
+		std::vector<vk::raii::CommandPool> command_pools;
+		std::vector<vk::raii::CommandBuffer> command_buffers;
+
+		explicit SecondaryRecorder(
+			std::vector<vk::raii::CommandPool> command_pools,
+			std::vector<vk::raii::CommandBuffer> command_buffers
+		) :
+			command_pools(std::move(command_pools)),
+			command_buffers(std::move(command_buffers))
+		{}
+
+	  public:
+
+		SecondaryRecorder(const SecondaryRecorder&) = delete;
+		SecondaryRecorder(SecondaryRecorder&&) = default;
+		SecondaryRecorder& operator=(const SecondaryRecorder&) = delete;
+		SecondaryRecorder& operator=(SecondaryRecorder&&) = default;
+	};
+}
@@ -1,26 +1,35 @@
 #pragma once
 
+#include "common/formatter.hpp"
 #include "common/number-literals.hpp"
 #include "common/util/error.hpp"
+#include "common/util/mpsc-queue.hpp"
+#include "common/util/profile.hpp"
 #include "common/util/span.hpp"
 #include "image/bc-image.hpp"
 #include "image/common.hpp"
 #include "image/image.hpp"
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/alloc/buffer.hpp"
+#include "vulkan/alloc/category.hpp"
 #include "vulkan/alloc/image.hpp"
 #include "vulkan/interface/context.hpp"
 #include "vulkan/numeric/base-level.hpp"
 #include "vulkan/util/command-runner.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <expected>
+#include <format>
 #include <functional>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <type_traits>
@@ -36,27 +45,69 @@ namespace vulkan
 	///
 	/// @brief Static resource creator, designed for creating buffers and images at initialization/loading
 	/// stage
+	/// @details
+	/// #### Staging
+	/// Data is suballocated from a pool of at most `STAGING_CHUNK_COUNT` persistently mapped staging chunks
+	/// instead of a staging buffer per resource:
+	/// - Once the open chunk can't fit the next data, it's closed and its copies are submitted without
+	/// waiting, and the next data is written into another chunk while the GPU executes them
+	/// - A submitted chunk is reused once its copies complete, so creating resources blocks only when all
+	/// chunks are in flight. This bounds the staging memory to `STAGING_CHUNK_COUNT * STAGING_CHUNK_SIZE`
+	/// - Chunks are allocated lazily and grow up to `STAGING_CHUNK_SIZE`, so small loads stay small.
+	/// Data of a single resource larger than a chunk is staged in a dedicated buffer, submitted right away
+	///
+	/// #### Concurrency
+	/// Producers (the `create_*` functions) never block each other on the upload tasks:
+	/// - A producer only locks to reserve a range of the open chunk, then writes its data and pushes its
+	/// tasks to a lock-free queue without holding any lock. Pending counters are atomic.
+	/// - A single consumer at a time drains the queue and submits it: the thread calling `execute_uploads`,
+	/// or the producer that closed a chunk if no other thread is consuming.
+	/// - A closed chunk is reused only after all producers that reserved from it have queued their tasks,
+	/// and their copies have completed
 	///
 	/// @warning
 	/// - Do not create multiple upload tasks for the same image subresource layer
 	/// - Make sure to call `execute_uploads()` after creating resources and before deconstructing the
-	/// creator. No checks are made for pending tasks in the destructor.
+	/// creator, which also waits for the chunks already submitted. No checks are made for pending tasks in
+	/// the destructor.
 	/// - Do not use it in frame loops, as this is not designed to be highly efficient. Manually upload in
 	/// such scenarios.
 	///
-	/// @note All resosurces are created as `GpuOnly`
+	/// @note
+	/// - All resosurces are created as `GpuOnly`
+	/// - Images are accounted to `MemoryCategory::Texture`, staging buffers to `MemoryCategory::Staging`
+	/// - If the device has a dedicated transfer queue, copies are executed on it. Buffers are created with
+	/// `eConcurrent` sharing mode across `Context::unique_families()`, images are transferred to the main
+	/// queue family after upload.
 	///
 	class StaticResourceCreator
 	{
 	  public:
 
+		// Maximum size of a staging chunk in bytes
+		static constexpr size_t STAGING_CHUNK_SIZE = 64 * 1024 * 1024;
+
+		// Size of the first staging chunk in bytes, later chunks double in size
+		static constexpr size_t STAGING_CHUNK_MIN_SIZE = 1024 * 1024;
+
+		// Maximum count of staging chunks, one being written while the others are in flight
+		static constexpr size_t STAGING_CHUNK_COUNT = 3;
+
+		// Alignment of each suballocation in a staging chunk, a multiple of all texel block sizes used
+		static constexpr size_t STAGING_ALIGNMENT = 16;
+
 		///
 		/// @brief Create a static resource creator
 		///
 		/// @param context Vulkan context
+		/// @param image_pool Pool of the created images. `AllocationPool::PerThread` lets concurrent
+		/// producers allocate in parallel, but excludes the images from defragmentation
 		/// @return Created instance or failed
 		///
-		static std::expected<StaticResourceCreator, Error> create(const vulkan::Context& context) noexcept;
+		static std::expected<StaticResourceCreator, Error> create(
+			const vulkan::Context& context,
+			AllocationPool image_pool = AllocationPool::Shared
+		) noexcept;
 
 		///
 		/// @brief Create a buffer
@@ -65,13 +116,15 @@ namespace vulkan
 		/// @param context Vulkan context
 		/// @param data Data to upload to the buffer
 		/// @param usage Buffer usage flags (No need to include `TransferDst` bit)
+		/// @param category Category the buffer is accounted to
 		/// @return Created buffer, or error
 		///
 		[[nodiscard]]
 		std::expected<Buffer, Error> create_buffer(
 			const Context& context,
 			std::span<const std::byte> data,
-			vk::BufferUsageFlags usage
+			vk::BufferUsageFlags usage,
+			MemoryCategory category = MemoryCategory::Other
 		) noexcept;
 
 		///
@@ -81,6 +134,7 @@ namespace vulkan
 		/// @param context Vulkan context
 		/// @param element Element to upload to the buffer
 		/// @param usage Buffer usage flags (No need to include `TransferDst` bit)
+		/// @param category Category the buffer is accounted to
 		/// @return Created element buffer, or error
 		///
 		template <typename T>
@@ -88,12 +142,12 @@ namespace vulkan
 		std::expected<ElementBuffer<T>, Error> create_element_buffer(
 			const Context& context,
 			const T& element,
-			vk::BufferUsageFlags usage
+			vk::BufferUsageFlags usage,
+			MemoryCategory category = MemoryCategory::Other
 		) noexcept
 		{
-			return create_buffer(context, util::object_as_bytes(element), usage).transform([](Buffer buffer) {
-				return ElementBuffer<T>(std::move(buffer));
-			});
+			return create_buffer(context, util::object_as_bytes(element), usage, category)
+				.transform([](Buffer buffer) { return ElementBuffer<T>(std::move(buffer)); });
 		}
 
 		///
@@ -103,6 +157,7 @@ namespace vulkan
 		/// @param context Vulkan context
 		/// @param data Array of elements to upload to the buffer
 		/// @param usage Buffer usage flags (No need to include `TransferDst` bit)
+		/// @param category Category the buffer is accounted to
 		/// @return Created array buffer, or error
 		///
 		template <typename T>
@@ -110,10 +165,11 @@ namespace vulkan
 		std::expected<ArrayBuffer<T>, Error> create_array_buffer(
 			const Context& context,
 			std::span<const T> data,
-			vk::BufferUsageFlags usage
+			vk::BufferUsageFlags usage,
+			MemoryCategory category = MemoryCategory::Other
 		) noexcept
 		{
-			return create_buffer(context, util::as_bytes(data), usage)
+			return create_buffer(context, util::as_bytes(data), usage, category)
 				.transform([item_count = data.size()](Buffer buffer) {
 					return ArrayBuffer<T>(std::move(buffer), item_count);
 				});
@@ -126,6 +182,7 @@ namespace vulkan
 		/// @param context Vulkan context
 		/// @param data Array of elements to upload to the buffer
 		/// @param usage Buffer usage flags (No need to include `TransferDst` bit)
+		/// @param category Category the buffer is accounted to
 		/// @return Created array buffer, or error
 		///
 		template <std::ranges::contiguous_range T>
@@ -133,13 +190,31 @@ namespace vulkan
 		std::expected<ArrayBuffer<std::decay_t<std::ranges::range_value_t<T>>>, Error> create_array_buffer(
 			const Context& context,
 			T&& data,
-			vk::BufferUsageFlags usage
+			vk::BufferUsageFlags usage,
+			MemoryCategory category = MemoryCategory::Other
 		) noexcept
 		{
 			using ValueType = std::decay_t<std::ranges::range_value_t<T>>;
-			return create_array_buffer(context, std::span<const ValueType>(data), usage);
+			return create_array_buffer(context, std::span<const ValueType>(data), usage, category);
 		}
 
+		///
+		/// @brief Create a buffer without uploading any data, to be filled with `write_buffers_in_place`
+		///
+		/// @param context Vulkan context
+		/// @param size Size of the buffer in bytes
+		/// @param usage Buffer usage flags (No need to include `TransferDst` bit)
+		/// @param category Category the buffer is accounted to
+		/// @return Created buffer, or error
+		///
+		[[nodiscard]]
+		static std::expected<Buffer, Error> create_empty_buffer(
+			const Context& context,
+			size_t size,
+			vk::BufferUsageFlags usage,
+			MemoryCategory category = MemoryCategory::Other
+		) noexcept;
+
 		///
 		/// @brief Create a image from CPU-side image
 		/// @note This function is multi-threading safe
@@ -152,6 +227,9 @@ namespace vulkan
 		/// format
 		/// @param usage Vulkan image usage flags (No need to include `TransferDst` bit)
 		/// @param layout Vulkan image layout to transition the created image to after upload
+		/// @param mipmap_levels Mipmap levels of the created image. Only the base level is uploaded, other
+		/// levels are generated on device by linear blits, so @p format must support linear filtering and
+		/// blitting. See `get_mipmap_levels`
 		/// @return Created image, or error
 		///
 		template <image::Format T, image::Layout L>
@@ -162,9 +240,21 @@ namespace vulkan
 			vk::Format format,
 			vk::ImageUsageFlags usage,
 			vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal,
-			vk::ImageCreateFlags create_flags = {}
+			vk::ImageCreateFlags create_flags = {},
+			uint32_t mipmap_levels = 1
 		) noexcept;
 
+		///
+		/// @brief Get the count of mipmap levels down to a minimum size, for generating mipmaps on device
+		/// @details Matches the chain of `image::Image::generate_mipmap` for POT sizes
+		///
+		/// @param size Size of the base level
+		/// @param min_size_log `log2` of the minimum size of the smaller dimension
+		/// @return Count of mipmap levels, at least 1
+		///
+		[[nodiscard]]
+		static uint32_t get_mipmap_levels(glm::u32vec2 size, uint32_t min_size_log = 0) noexcept;
+
 		///
 		/// @brief Create a image from CPU-side BCn image
 		/// @note This function is multi-threading safe
@@ -268,7 +358,139 @@ namespace vulkan
 		) noexcept;
 
 		///
-		/// @brief Execute all upload tasks
+		/// @brief A mipmap level of pre-encoded image data
+		///
+		struct RawLevel
+		{
+			glm::u32vec2 extent;              // Extent of the level in texels
+			std::span<const std::byte> data;  // Tightly packed texel or block data of the level
+		};
+
+		///
+		/// @brief Create a image with multiple mipmap levels from pre-encoded data of any format
+		/// @details Data of each level is copied as-is into the image, the caller is responsible for matching
+		/// the data layout with @p format. Useful for uploading cached data without decoding it.
+		/// @note This function is multi-threading safe
+		///
+		/// @param context Vulkan context
+		/// @param mipmap_chain Data for each mipmap level, ordered from largest to smallest
+		/// @param format Vulkan format of the created image
+		/// @param usage Vulkan image usage flags (No need to include `TransferDst` bit)
+		/// @param layout Vulkan image layout to transition the created image to after upload
+		/// @return Created image, or error
+		///
+		[[nodiscard]]
+		std::expected<Image, Error> create_image_mipmap_raw(
+			const Context& context,
+			std::span<const RawLevel> mipmap_chain,
+			vk::Format format,
+			vk::ImageUsageFlags usage,
+			vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageCreateFlags create_flags = {}
+		) noexcept;
+
+		///
+		/// @brief Create a 2D array image, each layer with multiple mipmap levels from pre-encoded data
+		/// @details Same as `create_image_mipmap_raw`, with one mipmap chain per array layer. Packing images
+		/// of the same format and extent into layers saves an image and allocation per image.
+		/// @note This function is multi-threading safe
+		///
+		/// @param context Vulkan context
+		/// @param layers Mipmap chain of each array layer, all layers must have identical level extents and
+		/// data sizes
+		/// @param format Vulkan format of the created image
+		/// @param usage Vulkan image usage flags (No need to include `TransferDst` bit)
+		/// @param layout Vulkan image layout to transition the created image to after upload
+		/// @return Created image, or error
+		///
+		[[nodiscard]]
+		std::expected<Image, Error> create_image_array_raw(
+			const Context& context,
+			std::span<const std::span<const RawLevel>> layers,
+			vk::Format format,
+			vk::ImageUsageFlags usage,
+			vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageCreateFlags create_flags = {}
+		) noexcept;
+
+		///
+		/// @brief Writes data into mapped staging memory, given a destination span for each staged data
+		///
+		using StagingWriter =
+			std::function<std::expected<void, Error>(std::span<const std::span<std::byte>> destinations)>;
+
+		///
+		/// @brief A mipmap level whose data is written in place, see `create_image_mipmap_in_place`
+		///
+		struct InPlaceLevel
+		{
+			glm::u32vec2 extent;  // Extent of the level in texels
+			size_t size;          // Size of the tightly packed texel or block data of the level in bytes
+		};
+
+		///
+		/// @brief Create a image with multiple mipmap levels, whose data is written directly into staging
+		/// memory
+		/// @details Like `create_image_mipmap_raw`, but @p write is handed the mapped staging memory of every
+		/// level up front instead of copying host data into it. The last stage producing the data (e.g. a
+		/// block encoder) writes there directly, which saves a full-size copy and the host memory holding it.
+		/// @note This function is multi-threading safe, @p write is called without holding any lock
+		/// @warning
+		/// - The staging memory may be write-combined, write it sequentially and never read it back
+		/// - The staging chunk can't be submitted until @p write returns, keep heavy work out of it when
+		/// possible
+		///
+		/// @param context Vulkan context
+		/// @param mipmap_chain Extent and data size of each mipmap level, ordered from largest to smallest
+		/// @param format Vulkan format of the created image
+		/// @param write Writer of the level data, called once with a destination span per level
+		/// @param usage Vulkan image usage flags (No need to include `TransferDst` bit)
+		/// @param layout Vulkan image layout to transition the created image to after upload
+		/// @return Created image, or error (including errors returned by @p write)
+		///
+		[[nodiscard]]
+		std::expected<Image, Error> create_image_mipmap_in_place(
+			const Context& context,
+			std::span<const InPlaceLevel> mipmap_chain,
+			vk::Format format,
+			const StagingWriter& write,
+			vk::ImageUsageFlags usage,
+			vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageCreateFlags create_flags = {}
+		) noexcept;
+
+		///
+		/// @brief A region of an existing buffer written in place, see `write_buffers_in_place`
+		///
+		struct BufferRegion
+		{
+			vk::Buffer buffer;      // Destination buffer, created with `TransferDst` usage
+			vk::DeviceSize offset;  // Offset of the region into the destination buffer in bytes
+			size_t size;            // Size of the region in bytes, empty regions are skipped
+		};
+
+		///
+		/// @brief Write regions of existing buffers with data written directly into staging memory
+		/// @details The regions are staged together and uploaded as one batch, so a large buffer can be
+		/// filled piece by piece, with the host memory held bounded by the staging chunks instead of the
+		/// whole data.
+		/// @note This function is multi-threading safe, @p write is called without holding any lock
+		/// @warning Same as `create_image_mipmap_in_place`, the staging memory may be write-combined
+		///
+		/// @param context Vulkan context
+		/// @param regions Destination regions, must not overlap any other region being written
+		/// @param write Writer of the region data, called once with a destination span per region
+		/// @return Success, or error (including errors returned by @p write)
+		///
+		[[nodiscard]]
+		std::expected<void, Error> write_buffers_in_place(
+			const Context& context,
+			std::span<const BufferRegion> regions,
+			const StagingWriter& write
+		) noexcept;
+
+		///
+		/// @brief Execute all upload tasks, and wait for them along with the staging chunks already submitted
 		/// @note
 		/// - No matter success or fail, tasks will be cleared after this call
 		/// - This function is multi-threading safe
@@ -298,10 +520,10 @@ namespace vulkan
 		) noexcept;
 
 		///
-		/// @brief Get number of pending upload tasks
+		/// @brief Get number of pending upload tasks, including those submitted but not yet waited for
 		/// @note This function is multi-threading safe
 		///
-		/// @return
+		/// @return Number of pending upload tasks
 		///
 		[[nodiscard]]
 		size_t num_pending() const noexcept;
@@ -329,52 +551,291 @@ namespace vulkan
 
 	  private:
 
+		///
+		/// @brief Range of staged data, suballocated from a staging chunk or its dedicated buffers
+		///
+		struct StagingRange
+		{
+			vk::Buffer buffer;
+			size_t offset;
+		};
+
 		struct BufferUploadTask
 		{
 			vk::Buffer dst_buffer;
-			vulkan::Buffer staging_buffer;
+			StagingRange staging;
 			size_t data_size;
+			vk::DeviceSize dst_offset = 0;
 		};
 
 		struct ImageUploadTask
 		{
 			vk::Image dst_image;
-			Buffer staging_buffer;
+			StagingRange staging;
 			vk::ImageSubresourceLayers subresource_layers;
 			vk::Extent3D image_extent;
 			vk::ImageLayout dst_layout;
 
+			// Levels after `subresource_layers.mipLevel` to generate on device from the uploaded level
+			uint32_t generated_levels = 0;
+
 			[[nodiscard]]
 			vk::ImageMemoryBarrier2 get_barrier_pre() const;
 
+			///
+			/// @brief Get the barrier after the copy, releases the ownership if the queue families differ
+			///
+			/// @param src_family Queue family the copy is executed on
+			/// @param dst_family Queue family the image is used on
+			///
+			[[nodiscard]]
+			vk::ImageMemoryBarrier2 get_barrier_post(
+				uint32_t src_family = vk::QueueFamilyIgnored,
+				uint32_t dst_family = vk::QueueFamilyIgnored
+			) const;
+
+			///
+			/// @brief Get the barrier acquiring the ownership on @p dst_family, pairs with
+			/// `get_barrier_post(src_family, dst_family)`
+			///
 			[[nodiscard]]
-			vk::ImageMemoryBarrier2 get_barrier_post() const;
+			vk::ImageMemoryBarrier2 get_barrier_acquire(uint32_t src_family, uint32_t dst_family) const;
+
+			///
+			/// @brief Record generation of `generated_levels`, and transition all levels to `dst_layout`
+			/// @note Must be recorded on a graphics-capable queue, after the post or acquire barrier
+			///
+			void record_generate_mipmap(const vk::raii::CommandBuffer& command_buffer) const;
+		};
+
+		///
+		/// @brief Tickets of a submission, zero tickets are always complete
+		///
+		struct Submission
+		{
+			CommandRunner::Ticket transfer;  // Copies on the transfer queue
+			CommandRunner::Ticket main;      // Copies, or ownership acquire and mipmap generation
+
+			///
+			/// @brief Merge with a later submission, so that waiting for the result waits for both
+			///
+			void merge(Submission other) noexcept
+			{
+				transfer.value = std::max(transfer.value, other.transfer.value);
+				main.value = std::max(main.value, other.main.value);
+			}
+		};
+
+		struct StagingChunk
+		{
+			Buffer buffer;
+			size_t capacity;
+			size_t offset = 0;  // Guarded by `staging_mutex`
+
+			// Producers that reserved a range of the chunk, but haven't queued their batch yet
+			std::atomic<size_t> writers = 0;
+
+			// Latest submission reading the chunk, accessed by the consumer only
+			Submission submission = {};
+		};
+
+		///
+		/// @brief Data of a single resource staged by @p stage, to be queued with @p enqueue
+		///
+		struct Staging
+		{
+			std::vector<StagingRange> ranges;        // Range of each staged data
+			StagingChunk* chunk;                     // Chunk holding the ranges, `nullptr` if dedicated
+			std::optional<Buffer> dedicated_buffer;  // Buffer holding the ranges if larger than a chunk
+			bool flush;                              // Whether the queue should be flushed once queued
+		};
+
+		///
+		/// @brief Upload tasks of a single resource, queued by producers and drained by the consumer
+		///
+		struct UploadBatch
+		{
+			std::vector<BufferUploadTask> buffer_tasks;
+			std::vector<ImageUploadTask> image_tasks;
+			StagingChunk* chunk;
+			std::optional<Buffer> dedicated_buffer;
+			size_t data_size;
 		};
 
-		std::unique_ptr<std::mutex> execution_mutex;
+		///
+		/// @brief Dedicated staging buffer kept alive until its submission completes
+		///
+		struct RetiredBuffer
+		{
+			Buffer buffer;
+			Submission submission;
+		};
+
+		///
+		/// @brief State shared by producers and the consumer, kept at a stable address
+		///
+		struct SharedState
+		{
+			// Guards the chunk lists of producers, only held to reserve ranges and rotate chunks
+			PROFILE_LOCKABLE(std::mutex, staging_mutex, "Static resource staging");
+
+			// Held by the single consumer draining `queue`, guards the runners and the chunks in flight
+			PROFILE_LOCKABLE(std::mutex, consumer_mutex, "Static resource consumer");
+
+			util::MpscQueue<UploadBatch> queue;
+
+			// Queued since the last `execute_uploads`, including submitted batches
+			std::atomic<size_t> pending_data_size = 0;
+			std::atomic<size_t> pending_task_count = 0;
+		};
+
+		std::unique_ptr<SharedState> shared;
+
+		AllocationPool image_pool;
+
+		/* Guarded by `staging_mutex` */
+
+		std::unique_ptr<StagingChunk> open_chunk;                  // Chunk being reserved from
+		std::vector<std::unique_ptr<StagingChunk>> closed_chunks;  // Full, possibly still being written
+		std::vector<std::unique_ptr<StagingChunk>> free_chunks;    // Chunks with completed copies
+		size_t chunk_count = 0;                                    // Count of all allocated chunks
+		size_t next_chunk_capacity = STAGING_CHUNK_MIN_SIZE;
+
+		/* Guarded by `consumer_mutex` */
+
 		CommandRunner command_runner;
 
-		std::vector<BufferUploadTask> buffer_upload_tasks;
-		std::vector<ImageUploadTask> image_upload_tasks;
-		size_t pending_data_size = 0;
+		// Only present when the device has a dedicated transfer queue
+		std::optional<CommandRunner> transfer_runner;
+
+		std::deque<std::unique_ptr<StagingChunk>> submitted_chunks;  // Sealed chunks, sorted by submission
+		std::deque<RetiredBuffer> retired_buffers;                   // Sorted by submission
+		Submission latest_submission = {};
+
+		// Drained since the last `execute_uploads`, subtracted from the pending counters once waited
+		size_t drained_data_size = 0;
+		size_t drained_task_count = 0;
+
+		// Failure of a flush triggered by a producer, reported by the next `execute_uploads`
+		std::optional<Error> deferred_error;
 
-		explicit StaticResourceCreator(CommandRunner command_runner) :
-			execution_mutex(std::make_unique<std::mutex>()),
-			command_runner(std::move(command_runner))
+		explicit StaticResourceCreator(
+			AllocationPool image_pool,
+			CommandRunner command_runner,
+			std::optional<CommandRunner> transfer_runner
+		) :
+			shared(std::make_unique<SharedState>()),
+			image_pool(image_pool),
+			command_runner(std::move(command_runner)),
+			transfer_runner(std::move(transfer_runner))
 		{}
 
 		///
-		/// @brief Create a staging buffer and upload data to it.
+		/// @brief Reserve and write staging memory for the data of a single resource
+		/// @details
+		/// - All @p data are staged in the same chunk, so that a resource is never split across chunks
+		/// - Only the reservation holds `staging_mutex`, data is written without holding any lock
+		/// - Closes the open chunk if the data doesn't fit, and reclaims a chunk in flight as the consumer
+		/// if all chunks are in use
+		/// @note Must be followed by @p enqueue on success, which releases the reservation
+		///
+		/// @param data Data to stage
+		/// @return Staged data, or error
+		///
+		[[nodiscard]]
+		std::expected<Staging, Error> stage(
+			const Context& context,
+			std::span<const std::span<const std::byte>> data
+		) noexcept;
+
+		///
+		/// @brief Reserve staging memory for the data of a single resource, and write it in place
+		/// @details Same as `stage`, except that @p write is handed the mapped range of each size
 		///
-		/// @param data Data to upload to the staging buffer
-		/// @return Created staging buffer, or error
+		/// @param sizes Size of each data to stage
+		/// @param write Writer of the data, called without holding any lock
+		/// @return Staged data, or error
 		///
 		[[nodiscard]]
-		std::expected<Buffer, Error> create_staging_buffer(
+		std::expected<Staging, Error> stage(
 			const Context& context,
-			std::span<const std::byte> data
+			std::span<const size_t> sizes,
+			const StagingWriter& write
 		) noexcept;
 
+		///
+		/// @brief Reserve a range of the open chunk, opening a free or new chunk if it doesn't fit
+		/// @note Requires `staging_mutex`
+		///
+		/// @param size Size of the range in bytes, at most `STAGING_CHUNK_SIZE`
+		/// @param closed Set if the open chunk got closed
+		/// @return Chunk and offset of the range, `std::nullopt` if all chunks are in use, or error
+		///
+		[[nodiscard]]
+		std::expected<std::optional<std::pair<StagingChunk*, size_t>>, Error> reserve(
+			const Context& context,
+			size_t size,
+			bool& closed
+		) noexcept;
+
+		///
+		/// @brief Queue the upload tasks of a staged resource, without blocking other producers
+		///
+		void enqueue(
+			const Context& context,
+			Staging staging,
+			std::vector<BufferUploadTask> buffer_tasks,
+			std::vector<ImageUploadTask> image_tasks,
+			size_t data_size
+		) noexcept;
+
+		///
+		/// @brief Flush the queue if no other thread is consuming it, failure is deferred to the next
+		/// `execute_uploads`
+		///
+		void try_flush(const Context& context) noexcept;
+
+		///
+		/// @brief Drain and submit the queue without waiting, and free the chunks whose copies completed
+		/// @note
+		/// - Requires `consumer_mutex`
+		/// - No matter success or fail, drained tasks will be cleared after this call
+		///
+		[[nodiscard]]
+		std::expected<void, Error> flush(const Context& context) noexcept;
+
+		///
+		/// @brief Free a chunk in use for reserving, waiting for the oldest submitted chunk if needed
+		/// @note Requires `consumer_mutex`
+		///
+		[[nodiscard]]
+		std::expected<void, Error> reclaim_chunk(const Context& context) noexcept;
+
+		///
+		/// @brief Flush the queue and wait for all submissions
+		/// @note Requires `consumer_mutex`
+		///
+		[[nodiscard]]
+		std::expected<void, Error> execute_uploads_locked(const Context& context) noexcept;
+
+		///
+		/// @brief Return a chunk to the free chunks
+		///
+		void free_chunk(std::unique_ptr<StagingChunk> chunk) noexcept;
+
+		///
+		/// @brief Wait for a submission
+		/// @note Requires `consumer_mutex`
+		///
+		[[nodiscard]]
+		std::expected<void, Error> wait_submission(const Context& context, Submission submission) noexcept;
+
+		///
+		/// @brief Check whether a submission has completed, without blocking
+		///
+		[[nodiscard]]
+		std::expected<bool, Error> is_submission_complete(Submission submission) const noexcept;
+
 		///
 		/// @brief Check mipmap chain sizes for validity.
 		///
@@ -384,8 +845,32 @@ namespace vulkan
 		[[nodiscard]]
 		static std::expected<void, Error> check_mipmap_chain_sizes(std::vector<glm::u32vec2> sizes) noexcept;
 
+		///
+		/// @brief Create a 2D array image whose layers share a mipmap chain layout, with the data written
+		/// directly into staging memory
+		/// @details @p write is handed the destinations in layer-major order, i.e. level `l` of layer `i` is
+		/// at `i * mipmap_chain.size() + l`
+		///
+		[[nodiscard]]
+		std::expected<Image, Error> create_image_layers_in_place(
+			const Context& context,
+			std::span<const InPlaceLevel> mipmap_chain,
+			uint32_t layer_count,
+			vk::Format format,
+			const StagingWriter& write,
+			vk::ImageUsageFlags usage,
+			vk::ImageLayout layout,
+			vk::ImageCreateFlags create_flags
+		) noexcept;
+
+		///
+		/// @brief Record and submit upload tasks without waiting for them
+		/// @note Requires `consumer_mutex`
+		///
+		/// @return Submission of the tasks, or error
+		///
 		[[nodiscard]]
-		std::expected<void, Error> execute_uploads_impl(
+		std::expected<Submission, Error> submit_uploads(
 			const Context& context,
 			const std::vector<BufferUploadTask>& buffer_tasks,
 			const std::vector<ImageUploadTask>& image_tasks
@@ -408,39 +893,59 @@ namespace vulkan
 		vk::Format format,
 		vk::ImageUsageFlags usage,
 		vk::ImageLayout layout,
-		vk::ImageCreateFlags create_flags
+		vk::ImageCreateFlags create_flags,
+		uint32_t mipmap_levels
 	) noexcept
 	{
+		if (mipmap_levels == 0) return Error("Mipmap level count is zero");
+		if (mipmap_levels > get_mipmap_levels(image.size))
+			return Error(
+				"Too many mipmap levels",
+				std::format("{} levels for size {}", mipmap_levels, image.size)
+			);
+
 		const auto extent = vk::Extent3D{.width = image.size.x, .height = image.size.y, .depth = 1};
 		const auto subresource_layer = vulkan::base_level_image_layer(vk::ImageAspectFlagBits::eColor);
 
+		// Generated levels are blitted from their upper level
+		const auto blit_usage = mipmap_levels > 1
+			? vk::ImageUsageFlags(vk::ImageUsageFlagBits::eTransferSrc)
+			: vk::ImageUsageFlags();
+
 		const auto image_create_info = vk::ImageCreateInfo{
 			.flags = create_flags,
 			.imageType = vk::ImageType::e2D,
 			.format = format,
 			.extent = extent,
-			.mipLevels = 1,
+			.mipLevels = mipmap_levels,
 			.arrayLayers = 1,
-			.usage = usage | vk::ImageUsageFlagBits::eTransferDst
+			.usage = usage | vk::ImageUsageFlagBits::eTransferDst | blit_usage
 		};
-		auto image_result = context.allocator.create_image(image_create_info, vulkan::MemoryUsage::GpuOnly);
+		auto image_result = context.allocator.create_image(
+			image_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Texture
+		);
 		if (!image_result) return image_result.error().forward("Create gpu image failed");
 		auto dst_image = std::move(*image_result);
 
-		auto staging_buffer_result = create_staging_buffer(context, util::as_bytes(image.data));
-		if (!staging_buffer_result)
-			return staging_buffer_result.error().forward("Create staging buffer failed");
-
-		const std::scoped_lock lock(*execution_mutex);
-		pending_data_size += std::span(image.data).size_bytes();
-		image_upload_tasks.push_back(
-			ImageUploadTask{
-				.dst_image = dst_image,
-				.staging_buffer = std::move(*staging_buffer_result),
-				.subresource_layers = subresource_layer,
-				.image_extent = extent,
-				.dst_layout = layout
-			}
+		auto staging_result = stage(context, std::array{util::as_bytes(image.data)});
+		if (!staging_result) return staging_result.error().forward("Stage image data failed");
+
+		auto image_task = ImageUploadTask{
+			.dst_image = dst_image,
+			.staging = staging_result->ranges.front(),
+			.subresource_layers = subresource_layer,
+			.image_extent = extent,
+			.dst_layout = layout,
+			.generated_levels = mipmap_levels - 1
+		};
+		enqueue(
+			context,
+			std::move(*staging_result),
+			{},
+			{std::move(image_task)},
+			std::span(image.data).size_bytes()
 		);
 
 		return dst_image;
@@ -491,22 +996,14 @@ namespace vulkan
 			.arrayLayers = 1,
 			.usage = usage | vk::ImageUsageFlagBits::eTransferDst
 		};
-		auto image_result = context.allocator.create_image(image_create_info, vulkan::MemoryUsage::GpuOnly);
+		auto image_result = context.allocator.create_image(
+			image_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Texture
+		);
 		if (!image_result) return image_result.error().forward("Create gpu image failed");
 		auto dst_image = std::move(*image_result);
 
-		/* Create staging buffers */
-
-		auto staging_buffer_result =
-			mipmap_chain
-			| std::views::transform([this, &context](const auto& image) {
-				  return create_staging_buffer(context, util::as_bytes(image.data));
-			  })
-			| Error::collect();
-		if (!staging_buffer_result)
-			return staging_buffer_result.error().forward("Create staging buffers failed");
-		std::vector<Buffer> staging_buffers = std::move(*staging_buffer_result);
-
 		/* Append task */
 
 		const std::vector<vk::ImageSubresourceLayers> subresource_layers =
@@ -522,28 +1019,33 @@ namespace vulkan
 			| std::ranges::to<std::vector>();
 
 		const auto as_upload_task =
-			[&dst_image, layout](const auto& extent, const auto& subresource_layer, auto& staging_buffer) {
+			[&dst_image, layout](const auto& extent, const auto& subresource_layer, const auto& staging) {
 				return ImageUploadTask{
 					.dst_image = dst_image,
-					.staging_buffer = std::move(staging_buffer),
+					.staging = staging,
 					.subresource_layers = subresource_layer,
 					.image_extent = extent,
 					.dst_layout = layout
 				};
 			};
 
-		const std::scoped_lock lock(*execution_mutex);
-		pending_data_size +=
-			std::ranges::fold_left_first(
-				mipmap_chain | std::views::transform([](const auto& image) {
-					return std::span(image.data).size_bytes();
-				}),
-				std::plus()
-			)
-				.value_or(0);
-		image_upload_tasks.append_range(
-			std::views::zip_transform(as_upload_task, extents, subresource_layers, staging_buffers)
+		const std::vector<std::span<const std::byte>> level_data =
+			mipmap_chain
+			| std::views::transform([](const auto& image) { return util::as_bytes(image.data); })
+			| std::ranges::to<std::vector>();
+
+		auto staging_result = stage(context, level_data);
+		if (!staging_result) return staging_result.error().forward("Stage image data failed");
+
+		auto image_tasks =
+			std::views::zip_transform(as_upload_task, extents, subresource_layers, staging_result->ranges)
+			| std::ranges::to<std::vector>();
+		const auto data_size = std::ranges::fold_left(
+			level_data | std::views::transform([](const auto& data) { return data.size(); }),
+			0zu,
+			std::plus()
 		);
+		enqueue(context, std::move(*staging_result), {}, std::move(image_tasks), data_size);
 
 		return dst_image;
 	}
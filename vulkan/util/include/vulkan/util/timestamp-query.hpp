@@ -0,0 +1,142 @@
+#pragma once
+
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	///
+	/// @brief GPU timestamp query for a single command buffer, measures the duration of named scopes
+	/// @details Create one for each in-flight frame. In each frame:
+	/// 1. Wait for the fence of the frame, then call `read_results()` to get the timings recorded last time
+	/// 2. Call `begin_frame()` at the start of the command buffer, outside of any render pass
+	/// 3. Wrap passes with `scope()`, the scope ends when the returned object is destroyed
+	///
+	/// @note If the main queue doesn't support timestamps, all scopes are no-ops and no results are returned
+	///
+	class TimestampQuery
+	{
+	  public:
+
+		///
+		/// @brief Duration of a named scope
+		///
+		struct Result
+		{
+			std::string name;
+			double duration_ms;
+		};
+
+		///
+		/// @brief Scoped marker, writes the end timestamp on destruction
+		///
+		class Scope
+		{
+		  public:
+
+			~Scope() noexcept;
+
+		  private:
+
+			const vk::raii::CommandBuffer* command_buffer;
+			const vk::raii::QueryPool* query_pool;
+			uint32_t end_query;
+
+			explicit Scope(
+				const vk::raii::CommandBuffer* command_buffer,
+				const vk::raii::QueryPool* query_pool,
+				uint32_t end_query
+			) noexcept :
+				command_buffer(command_buffer),
+				query_pool(query_pool),
+				end_query(end_query)
+			{}
+
+			friend class TimestampQuery;
+
+		  public:
+
+			Scope(const Scope&) = delete;
+			Scope(Scope&&) = delete;
+			Scope& operator=(const Scope&) = delete;
+			Scope& operator=(Scope&&) = delete;
+		};
+
+		///
+		/// @brief Create a timestamp query
+		///
+		/// @param context Vulkan context
+		/// @param max_scopes Maximum number of scopes in a frame, extra scopes are ignored
+		/// @return Created timestamp query or error
+		///
+		[[nodiscard]]
+		static std::expected<TimestampQuery, Error> create(
+			const vulkan::Context& context,
+			uint32_t max_scopes = 32
+		) noexcept;
+
+		///
+		/// @brief Reset the queries and discard the scopes recorded before
+		///
+		/// @param command_buffer Command buffer, must be outside of any render pass
+		///
+		void begin_frame(const vk::raii::CommandBuffer& command_buffer) noexcept;
+
+		///
+		/// @brief Begin a named scope
+		/// @note Scopes may nest, but must not outlive the command buffer recording
+		///
+		/// @param command_buffer Command buffer
+		/// @param name Name of the scope
+		/// @return Scope object, ends the scope when destroyed
+		///
+		[[nodiscard]]
+		Scope scope(const vk::raii::CommandBuffer& command_buffer, std::string_view name) noexcept;
+
+		///
+		/// @brief Read the durations of the scopes recorded since the last `begin_frame()`
+		/// @warning Call it only after the command buffer has finished execution
+		///
+		/// @return Durations in recording order, or error
+		///
+		[[nodiscard]]
+		std::expected<std::vector<Result>, Error> read_results() const noexcept;
+
+	  private:
+
+		vk::raii::QueryPool query_pool;
+		uint32_t max_scopes;
+		double timestamp_period_ns;
+		uint64_t timestamp_mask;
+
+		std::vector<std::string> scope_names;
+
+		explicit TimestampQuery(
+			vk::raii::QueryPool query_pool,
+			uint32_t max_scopes,
+			double timestamp_period_ns,
+			uint64_t timestamp_mask
+		) :
+			query_pool(std::move(query_pool)),
+			max_scopes(max_scopes),
+			timestamp_period_ns(timestamp_period_ns),
+			timestamp_mask(timestamp_mask)
+		{}
+
+	  public:
+
+		TimestampQuery(const TimestampQuery&) = delete;
+		TimestampQuery(TimestampQuery&&) = default;
+		TimestampQuery& operator=(const TimestampQuery&) = delete;
+		TimestampQuery& operator=(TimestampQuery&&) = default;
+	};
+}
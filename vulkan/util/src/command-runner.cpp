@@ -3,20 +3,41 @@
 #include "vulkan/interface/context.hpp"
 
 #include <cstdint>
+#include <deque>
 #include <expected>
 #include <functional>
 #include <mutex>
+#include <span>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace vulkan
 {
-	std::expected<CommandRunner, Error> CommandRunner::create(const vulkan::Context& context) noexcept
+	static uint32_t get_queue_family(
+		const vulkan::Context& context,
+		CommandRunner::QueueType queue_type
+	) noexcept
+	{
+		switch (queue_type)
+		{
+		case CommandRunner::QueueType::Compute:
+			return context.compute_family;
+		case CommandRunner::QueueType::Transfer:
+			return context.transfer_family;
+		default:
+			return context.family;
+		}
+	}
+
+	std::expected<CommandRunner, Error> CommandRunner::create(
+		const vulkan::Context& context,
+		QueueType queue_type
+	) noexcept
 	{
 		auto command_pool_result = context.device.createCommandPool({
 			.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-			.queueFamilyIndex = context.family,
+			.queueFamilyIndex = get_queue_family(context, queue_type),
 		});
 		if (!command_pool_result) return Error::from(command_pool_result);
 		auto command_pool = std::move(*command_pool_result);
@@ -25,13 +46,39 @@ namespace vulkan
 		if (!fence_result) return Error::from(fence_result);
 		auto fence = std::move(*fence_result);
 
-		return CommandRunner(std::move(command_pool), std::move(fence));
+		const auto semaphore_type_info = vk::SemaphoreTypeCreateInfo{
+			.semaphoreType = vk::SemaphoreType::eTimeline,
+			.initialValue = 0,
+		};
+		auto timeline_result =
+			context.device.createSemaphore(vk::SemaphoreCreateInfo().setPNext(&semaphore_type_info));
+		if (!timeline_result) return Error::from(timeline_result);
+		auto timeline = std::move(*timeline_result);
+
+		return CommandRunner(queue_type, std::move(command_pool), std::move(fence), std::move(timeline));
 	}
 
-	std::expected<void, Error> CommandRunner::run(
+	uint32_t CommandRunner::family(const vulkan::Context& context) const noexcept
+	{
+		return get_queue_family(context, queue_type);
+	}
+
+	const vk::raii::Queue& CommandRunner::queue(const vulkan::Context& context) const noexcept
+	{
+		switch (queue_type)
+		{
+		case QueueType::Compute:
+			return context.compute_queue;
+		case QueueType::Transfer:
+			return context.transfer_queue;
+		default:
+			return context.queue;
+		}
+	}
+
+	std::expected<vk::raii::CommandBuffer, Error> CommandRunner::record(
 		const vulkan::Context& context,
-		const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action,
-		uint64_t timeout
+		const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action
 	) const noexcept
 	{
 		auto command_buffer_result = context.device.allocateCommandBuffers({
@@ -48,13 +95,29 @@ namespace vulkan
 
 		if (const auto result = command_buffer.end(); !result) return Error::from(result);
 
+		return command_buffer;
+	}
+
+	std::expected<void, Error> CommandRunner::run(
+		const vulkan::Context& context,
+		const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action,
+		uint64_t timeout,
+		std::span<const vk::SemaphoreSubmitInfo> wait_semaphores
+	) const noexcept
+	{
+		auto command_buffer_result = record(context, action);
+		if (!command_buffer_result) return command_buffer_result.error();
+		const auto command_buffer = std::move(*command_buffer_result);
+
 		const auto command_buffer_info = vk::CommandBufferSubmitInfo{.commandBuffer = command_buffer};
-		const auto submit_info = vk::SubmitInfo2().setCommandBufferInfos(command_buffer_info);
+		const auto submit_info = vk::SubmitInfo2()
+									 .setWaitSemaphoreInfos(wait_semaphores)
+									 .setCommandBufferInfos(command_buffer_info);
 
 		{
 			const std::scoped_lock lock(context.submit_mutex);
 
-			if (const auto submit_result = context.queue.submit2(submit_info, fence); !submit_result)
+			if (const auto submit_result = queue(context).submit2(submit_info, fence); !submit_result)
 				return Error::from(submit_result);
 		}
 
@@ -66,4 +129,109 @@ namespace vulkan
 
 		return {};
 	}
+
+	std::expected<vk::raii::CommandBuffer, Error> CommandRunner::submit(
+		const vulkan::Context& context,
+		const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action,
+		std::span<const vk::SemaphoreSubmitInfo> signal_semaphores
+	) const noexcept
+	{
+		auto command_buffer_result = record(context, action);
+		if (!command_buffer_result) return command_buffer_result.error();
+		auto command_buffer = std::move(*command_buffer_result);
+
+		const auto command_buffer_info = vk::CommandBufferSubmitInfo{.commandBuffer = command_buffer};
+		const auto submit_info = vk::SubmitInfo2()
+									 .setCommandBufferInfos(command_buffer_info)
+									 .setSignalSemaphoreInfos(signal_semaphores);
+
+		{
+			const std::scoped_lock lock(context.submit_mutex);
+
+			if (const auto submit_result = queue(context).submit2(submit_info); !submit_result)
+				return Error::from(submit_result);
+		}
+
+		return command_buffer;
+	}
+
+	std::expected<CommandRunner::Ticket, Error> CommandRunner::submit_async(
+		const vulkan::Context& context,
+		const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action,
+		std::span<const vk::SemaphoreSubmitInfo> wait_semaphores
+	) noexcept
+	{
+		// Bound the in-flight depth, recording continues once the oldest submission completes
+		if (in_flight.size() >= MAX_ASYNC_IN_FLIGHT)
+			if (const auto result = wait(context, {.value = in_flight.front().value}); !result)
+				return result.error().forward("Wait for oldest submission failed");
+
+		auto command_buffer_result = record(context, action);
+		if (!command_buffer_result) return command_buffer_result.error();
+		auto command_buffer = std::move(*command_buffer_result);
+
+		const auto value = timeline_value + 1;
+
+		const auto command_buffer_info = vk::CommandBufferSubmitInfo{.commandBuffer = command_buffer};
+		const auto signal_semaphore_info = vk::SemaphoreSubmitInfo{
+			.semaphore = timeline,
+			.value = value,
+			.stageMask = vk::PipelineStageFlagBits2::eAllCommands,
+		};
+		const auto submit_info = vk::SubmitInfo2()
+									 .setWaitSemaphoreInfos(wait_semaphores)
+									 .setCommandBufferInfos(command_buffer_info)
+									 .setSignalSemaphoreInfos(signal_semaphore_info);
+
+		{
+			const std::scoped_lock lock(context.submit_mutex);
+
+			if (const auto submit_result = queue(context).submit2(submit_info); !submit_result)
+				return Error::from(submit_result);
+		}
+
+		timeline_value = value;
+		in_flight.push_back({.value = value, .command_buffer = std::move(command_buffer)});
+
+		return Ticket{.value = value};
+	}
+
+	std::expected<void, Error> CommandRunner::wait(
+		const vulkan::Context& context,
+		Ticket ticket,
+		uint64_t timeout
+	) noexcept
+	{
+		const auto semaphore = *timeline;
+		if (const auto result = context.device.waitSemaphores(
+				vk::SemaphoreWaitInfo().setSemaphores(semaphore).setValues(ticket.value),
+				timeout
+			);
+			result != vk::Result::eSuccess)
+			return Error::from(result);
+
+		while (!in_flight.empty() && in_flight.front().value <= ticket.value) in_flight.pop_front();
+
+		return {};
+	}
+
+	std::expected<bool, Error> CommandRunner::is_complete(Ticket ticket) const noexcept
+	{
+		const auto value_result = timeline.getCounterValue();
+		if (!value_result) return Error::from(value_result);
+
+		return *value_result >= ticket.value;
+	}
+
+	vk::SemaphoreSubmitInfo CommandRunner::get_wait_info(
+		Ticket ticket,
+		vk::PipelineStageFlags2 stage_mask
+	) const noexcept
+	{
+		return vk::SemaphoreSubmitInfo{
+			.semaphore = timeline,
+			.value = ticket.value,
+			.stageMask = stage_mask,
+		};
+	}
 }
@@ -0,0 +1,27 @@
+#include "vulkan/util/debug-utils.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+#ifdef VULKAN_DEBUG_UTILS
+
+	DebugLabel::DebugLabel(const vk::raii::CommandBuffer& command_buffer, const char* name) noexcept :
+		command_buffer(nullptr)
+	{
+		// Not loaded if the instance lacks `VK_EXT_debug_utils`
+		if (command_buffer.getDispatcher()->vkCmdBeginDebugUtilsLabelEXT == nullptr) return;
+
+		command_buffer.beginDebugUtilsLabelEXT({.pLabelName = name});
+		this->command_buffer = &command_buffer;
+	}
+
+	DebugLabel::~DebugLabel() noexcept
+	{
+		if (command_buffer == nullptr) return;
+		command_buffer->endDebugUtilsLabelEXT();
+	}
+
+#endif
+}
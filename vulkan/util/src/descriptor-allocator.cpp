@@ -0,0 +1,127 @@
+#include "vulkan/util/descriptor-allocator.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <expected>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	std::expected<DescriptorAllocator, Error> DescriptorAllocator::create(
+		const vulkan::Context& context,
+		uint32_t initial_set_count,
+		std::span<const Ratio> ratios
+	) noexcept
+	{
+		if (initial_set_count == 0) return Error("Initial set count of descriptor allocator is zero");
+
+		auto ratio_list = std::vector(ratios.begin(), ratios.end());
+		const bool has_acceleration_structure =
+			std::ranges::contains(ratio_list, vk::DescriptorType::eAccelerationStructureKHR, &Ratio::type);
+		if (context.feature.raytracing && !has_acceleration_structure)
+			ratio_list.push_back({.type = vk::DescriptorType::eAccelerationStructureKHR, .count = 1.0f});
+
+		auto pool_result = create_pool(context.device, ratio_list, initial_set_count);
+		if (!pool_result) return pool_result.error().forward("Create first descriptor pool failed");
+
+		return DescriptorAllocator(std::move(ratio_list), std::move(*pool_result), initial_set_count * 2);
+	}
+
+	std::expected<vk::raii::DescriptorPool, Error> DescriptorAllocator::create_pool(
+		const vk::raii::Device& device,
+		std::span<const Ratio> ratios,
+		uint32_t set_count
+	) noexcept
+	{
+		const auto pool_sizes =
+			ratios
+			| std::views::transform([set_count](const Ratio& ratio) {
+				  const auto count = std::ceil(ratio.count * static_cast<float>(set_count));
+				  return vk::DescriptorPoolSize{
+					  .type = ratio.type,
+					  .descriptorCount = std::max(static_cast<uint32_t>(count), 1u),
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+
+		auto pool_result = device.createDescriptorPool(
+			vk::DescriptorPoolCreateInfo().setMaxSets(set_count).setPoolSizes(pool_sizes)
+		);
+		if (!pool_result) return Error::from(pool_result);
+
+		return std::move(*pool_result);
+	}
+
+	std::expected<std::vector<vk::DescriptorSet>, Error> DescriptorAllocator::allocate(
+		const vk::raii::Device& device,
+		std::span<const vk::DescriptorSetLayout> layouts
+	) noexcept
+	{
+		if (layouts.empty()) return std::vector<vk::DescriptorSet>();
+
+		const auto set_count = static_cast<uint32_t>(layouts.size());
+
+		while (true)
+		{
+			bool created = false;
+			if (current_pool == pools.size())
+			{
+				next_set_count = std::max(next_set_count, set_count);
+				auto pool_result = create_pool(device, ratios, next_set_count);
+				if (!pool_result) return pool_result.error().forward("Grow descriptor allocator failed");
+
+				pools.push_back(std::move(*pool_result));
+				next_set_count *= 2;
+				created = true;
+			}
+
+			auto sets_result = device.allocateDescriptorSets(
+				vk::DescriptorSetAllocateInfo().setDescriptorPool(*pools[current_pool]).setSetLayouts(layouts)
+			);
+
+			if (sets_result)
+			{
+				// Sets are reclaimed by resetting the pool, never freed individually
+				return *sets_result
+					| std::views::transform([](vk::raii::DescriptorSet& set) { return set.release(); })
+					| std::ranges::to<std::vector>();
+			}
+
+			const auto result = sets_result.error();
+			if (result != vk::Result::eErrorOutOfPoolMemory && result != vk::Result::eErrorFragmentedPool)
+				return Error::from(result);
+
+			// An empty pool with enough sets failing means the ratios are too low for the layouts
+			if (created)
+				return Error(
+					"Descriptor sets don't fit in an empty pool",
+					"Check the ratios of the allocator"
+				);
+
+			current_pool++;
+		}
+	}
+
+	std::expected<vk::DescriptorSet, Error> DescriptorAllocator::allocate(
+		const vk::raii::Device& device,
+		vk::DescriptorSetLayout layout
+	) noexcept
+	{
+		return allocate(device, std::span(&layout, 1))
+			.transform([](const std::vector<vk::DescriptorSet>& sets) { return sets[0]; });
+	}
+
+	void DescriptorAllocator::reset() noexcept
+	{
+		for (const auto& pool : pools) pool.reset();
+		current_pool = 0;
+	}
+}
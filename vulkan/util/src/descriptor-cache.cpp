@@ -0,0 +1,130 @@
+#include "vulkan/util/descriptor-cache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	namespace
+	{
+		template <typename T>
+		uint64_t handle_bits(T handle) noexcept
+		{
+			return std::bit_cast<uint64_t>(static_cast<typename T::CType>(handle));
+		}
+
+		// Encode the resources referenced by a write into `key`, `false` if the write can't be tracked
+		bool encode_write(const vk::WriteDescriptorSet& write, std::vector<uint64_t>& key) noexcept
+		{
+			key.clear();
+			key.push_back(static_cast<uint64_t>(write.descriptorType));
+			key.push_back(write.descriptorCount);
+
+			switch (write.descriptorType)
+			{
+			case vk::DescriptorType::eSampler:
+			case vk::DescriptorType::eCombinedImageSampler:
+			case vk::DescriptorType::eSampledImage:
+			case vk::DescriptorType::eStorageImage:
+			case vk::DescriptorType::eInputAttachment:
+				if (write.pNext != nullptr || write.pImageInfo == nullptr) return false;
+				for (const auto& info : std::span(write.pImageInfo, write.descriptorCount))
+				{
+					key.push_back(handle_bits(info.sampler));
+					key.push_back(handle_bits(info.imageView));
+					key.push_back(static_cast<uint64_t>(info.imageLayout));
+				}
+				return true;
+
+			case vk::DescriptorType::eUniformBuffer:
+			case vk::DescriptorType::eStorageBuffer:
+			case vk::DescriptorType::eUniformBufferDynamic:
+			case vk::DescriptorType::eStorageBufferDynamic:
+				if (write.pNext != nullptr || write.pBufferInfo == nullptr) return false;
+				for (const auto& info : std::span(write.pBufferInfo, write.descriptorCount))
+				{
+					key.push_back(handle_bits(info.buffer));
+					key.push_back(info.offset);
+					key.push_back(info.range);
+				}
+				return true;
+
+			case vk::DescriptorType::eUniformTexelBuffer:
+			case vk::DescriptorType::eStorageTexelBuffer:
+				if (write.pNext != nullptr || write.pTexelBufferView == nullptr) return false;
+				for (const auto& view : std::span(write.pTexelBufferView, write.descriptorCount))
+					key.push_back(handle_bits(view));
+				return true;
+
+			case vk::DescriptorType::eAccelerationStructureKHR:
+			{
+				const auto* const as_write =
+					static_cast<const vk::WriteDescriptorSetAccelerationStructureKHR*>(write.pNext);
+				if (as_write == nullptr
+					|| as_write->sType != vk::StructureType::eWriteDescriptorSetAccelerationStructureKHR
+					|| as_write->pNext != nullptr)
+					return false;
+
+				for (const auto& structure :
+					 std::span(as_write->pAccelerationStructures, as_write->accelerationStructureCount))
+					key.push_back(handle_bits(structure));
+				return true;
+			}
+
+			default:
+				return false;
+			}
+		}
+	}
+
+	void DescriptorWriteCache::update(
+		const vk::raii::Device& device,
+		std::span<const vk::WriteDescriptorSet> writes
+	) noexcept
+	{
+		changed_writes.clear();
+
+		for (const auto& write : writes)
+		{
+			const auto entry = std::ranges::find_if(entries, [&write](const Entry& entry) {
+				return entry.set == write.dstSet
+					&& entry.binding == write.dstBinding
+					&& entry.array_element == write.dstArrayElement;
+			});
+
+			if (!encode_write(write, key_scratch))
+			{
+				// Untracked writes invalidate what was remembered for the same descriptors
+				if (entry != entries.end()) entries.erase(entry);
+				changed_writes.push_back(write);
+				continue;
+			}
+
+			if (entry == entries.end())
+				entries.push_back({
+					.set = write.dstSet,
+					.binding = write.dstBinding,
+					.array_element = write.dstArrayElement,
+					.key = key_scratch,
+				});
+			else if (entry->key == key_scratch)
+				continue;
+			else
+				entry->key.assign(key_scratch.begin(), key_scratch.end());
+
+			changed_writes.push_back(write);
+		}
+
+		if (!changed_writes.empty()) device.updateDescriptorSets(changed_writes, {});
+	}
+
+	void DescriptorWriteCache::clear() noexcept
+	{
+		entries.clear();
+	}
+}
@@ -0,0 +1,113 @@
+#include "vulkan/util/gpu-profiler.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+#ifdef TRACY_ENABLE
+
+	GpuProfiler::Zone::Zone(
+		const GpuProfiler& profiler,
+		const vk::raii::CommandBuffer& command_buffer,
+		std::string_view name
+	) noexcept
+	{
+		// Zones are named at runtime by the caller, the source location only identifies the profiler
+		static constexpr std::string_view SOURCE = TracyFile;
+		static constexpr std::string_view FUNCTION = "GPU";
+
+		scope.emplace(
+			profiler.tracy_context.get(),
+			TracyLine,
+			SOURCE.data(),
+			SOURCE.size(),
+			FUNCTION.data(),
+			FUNCTION.size(),
+			name.data(),
+			name.size(),
+			*command_buffer,
+			true
+		);
+	}
+
+	void GpuProfiler::ContextDeleter::operator()(tracy::VkCtx* context) const noexcept
+	{
+		TracyVkDestroy(context);
+	}
+
+	std::expected<GpuProfiler, Error> GpuProfiler::create(
+		const vk::raii::Instance& instance,
+		const vulkan::Context& context
+	) noexcept
+	{
+		// Only used for the calibration in `TracyVkContext`, zones are recorded into frame command buffers
+		auto command_pool_result = context.device.createCommandPool({
+			.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+			.queueFamilyIndex = context.family,
+		});
+		if (!command_pool_result) return Error::from(command_pool_result);
+		const auto command_pool = std::move(*command_pool_result);
+
+		auto command_buffers_result = context.device.allocateCommandBuffers({
+			.commandPool = command_pool,
+			.level = vk::CommandBufferLevel::ePrimary,
+			.commandBufferCount = 1,
+		});
+		if (!command_buffers_result) return Error::from(command_buffers_result);
+		const auto command_buffers = std::move(*command_buffers_result);
+
+		const std::scoped_lock lock(context.submit_mutex);
+
+		auto* tracy_context = TracyVkContext(
+			*instance,
+			*context.phy_device,
+			*context.device,
+			*context.queue,
+			*command_buffers.front(),
+			instance.getDispatcher()->vkGetInstanceProcAddr,
+			context.device.getDispatcher()->vkGetDeviceProcAddr
+		);
+		if (tracy_context == nullptr) return Error("Create Tracy Vulkan context failed");
+
+		static constexpr std::string_view CONTEXT_NAME = "Main Queue";
+		TracyVkContextName(tracy_context, CONTEXT_NAME.data(), CONTEXT_NAME.size());
+
+		return GpuProfiler(std::unique_ptr<tracy::VkCtx, ContextDeleter>(tracy_context));
+	}
+
+	void GpuProfiler::collect(const vk::raii::CommandBuffer& command_buffer) const noexcept
+	{
+		TracyVkCollect(tracy_context.get(), *command_buffer);
+	}
+
+#else
+
+	GpuProfiler::Zone::Zone(const GpuProfiler&, const vk::raii::CommandBuffer&, std::string_view) noexcept {}
+
+	std::expected<GpuProfiler, Error> GpuProfiler::create(
+		const vk::raii::Instance&,
+		const vulkan::Context&
+	) noexcept
+	{
+		return GpuProfiler();
+	}
+
+	void GpuProfiler::collect(const vk::raii::CommandBuffer&) const noexcept {}
+
+#endif
+
+	GpuProfiler::Zone GpuProfiler::zone(
+		const vk::raii::CommandBuffer& command_buffer,
+		std::string_view name
+	) const noexcept
+	{
+		return Zone(*this, command_buffer, name);
+	}
+}
@@ -0,0 +1,119 @@
+#include "vulkan/util/pipeline-statistics-query.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	namespace
+	{
+		// Written in bit order, see `PipelineStatisticsQuery::Result`
+		constexpr auto STATISTIC_FLAGS = vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives
+			| vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations
+			| vk::QueryPipelineStatisticFlagBits::eClippingPrimitives
+			| vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations
+			| vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+
+		// Five statistics followed by the availability
+		constexpr uint32_t RESULT_STRIDE = 6;
+	}
+
+	PipelineStatisticsQuery::Scope::~Scope() noexcept
+	{
+		if (query_pool == nullptr) return;
+		command_buffer->endQuery(*query_pool, query);
+	}
+
+	std::expected<PipelineStatisticsQuery, Error> PipelineStatisticsQuery::create(
+		const vulkan::Context& context,
+		std::span<const std::string_view> slot_names
+	) noexcept
+	{
+		if (slot_names.empty()) return Error("Pipeline statistics query has no slot");
+
+		auto query_pool_result = context.device.createQueryPool({
+			.queryType = vk::QueryType::ePipelineStatistics,
+			.queryCount = static_cast<uint32_t>(slot_names.size()),
+			.pipelineStatistics = STATISTIC_FLAGS,
+		});
+		if (!query_pool_result) return Error::from(query_pool_result).forward("Create query pool failed");
+
+		return PipelineStatisticsQuery(
+			std::move(*query_pool_result),
+			slot_names | std::views::transform([](std::string_view name) { return std::string(name); })
+				| std::ranges::to<std::vector>()
+		);
+	}
+
+	void PipelineStatisticsQuery::begin_frame(const vk::raii::CommandBuffer& command_buffer) noexcept
+	{
+		reset = true;
+		command_buffer.resetQueryPool(query_pool, 0, static_cast<uint32_t>(slot_names.size()));
+	}
+
+	PipelineStatisticsQuery::Scope PipelineStatisticsQuery::scope(
+		const vk::raii::CommandBuffer& command_buffer,
+		uint32_t slot
+	) const noexcept
+	{
+		if (slot >= slot_names.size()) return Scope(&command_buffer, nullptr, 0);
+
+		command_buffer.beginQuery(query_pool, slot, {});
+
+		return Scope(&command_buffer, &query_pool, slot);
+	}
+
+	std::expected<std::vector<PipelineStatisticsQuery::Result>, Error>
+	PipelineStatisticsQuery::read_results() const noexcept
+	{
+		// Queries must be reset before their results are read
+		if (!reset) return std::vector<Result>();
+
+		const auto query_count = static_cast<uint32_t>(slot_names.size());
+
+		// Slots skipped in the frame are never available, and make the whole read report not-ready
+		const auto [query_result, values] = query_pool.getResults<uint64_t>(
+			0,
+			query_count,
+			query_count * RESULT_STRIDE * sizeof(uint64_t),
+			RESULT_STRIDE * sizeof(uint64_t),
+			vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability
+		);
+		if (query_result != vk::Result::eSuccess && query_result != vk::Result::eNotReady)
+			return Error::from(query_result).forward("Get pipeline statistics query results failed");
+
+		std::vector<Result> results;
+		results.reserve(slot_names.size());
+
+		for (const auto [idx, name] : slot_names | std::views::enumerate)
+		{
+			const auto offset = static_cast<size_t>(idx) * RESULT_STRIDE;
+			const auto slot_values = std::span(values).subspan(offset, RESULT_STRIDE);
+			if (slot_values[5] == 0) continue;
+
+			results.push_back(
+				Result{
+					.name = name,
+					.input_primitives = slot_values[0],
+					.vertex_invocations = slot_values[1],
+					.clipping_primitives = slot_values[2],
+					.fragment_invocations = slot_values[3],
+					.compute_invocations = slot_values[4],
+				}
+			);
+		}
+
+		return results;
+	}
+}
@@ -0,0 +1,323 @@
+#include "vulkan/util/raytracing-pipeline.hpp"
+#include "common/util/align.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/alloc/allocator.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <libassert/assert.hpp>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	namespace
+	{
+		[[nodiscard]]
+		vk::PhysicalDeviceRayTracingPipelinePropertiesKHR get_properties(
+			const vk::raii::PhysicalDevice& phy_device
+		) noexcept
+		{
+			return phy_device
+				.getProperties2<
+					vk::PhysicalDeviceProperties2,
+					vk::PhysicalDeviceRayTracingPipelinePropertiesKHR
+				>()
+				.get<vk::PhysicalDeviceRayTracingPipelinePropertiesKHR>();
+		}
+
+		// Lay out a region of @p records starting at or after @p min_offset
+		[[nodiscard]]
+		std::expected<ShaderBindingTable::RegionLayout, Error> get_region_layout(
+			const vk::PhysicalDeviceRayTracingPipelinePropertiesKHR& properties,
+			std::span<const ShaderBindingTable::Record> records,
+			vk::DeviceSize min_offset
+		) noexcept
+		{
+			size_t max_data_size = 0;
+			for (const auto& record : records) max_data_size = std::max(max_data_size, record.data.size());
+
+			const auto stride = util::align_address(
+				properties.shaderGroupHandleSize + max_data_size,
+				properties.shaderGroupHandleAlignment
+			);
+			if (stride > properties.maxShaderGroupStride)
+				return Error(
+					"Shader binding table stride exceeds device limit",
+					std::format("Stride {}, device supports {}", stride, properties.maxShaderGroupStride)
+				);
+
+			return ShaderBindingTable::RegionLayout{
+				.offset = util::align_address(min_offset, properties.shaderGroupBaseAlignment),
+				.stride = stride,
+				.size = stride * records.size(),
+			};
+		}
+
+		[[nodiscard]]
+		vk::DeviceSize get_region_end(const ShaderBindingTable::RegionLayout& region) noexcept
+		{
+			return region.offset + region.size;
+		}
+	}
+
+	std::expected<RaytracingPipeline, Error> RaytracingPipeline::create(
+		const Context& context,
+		vk::PipelineLayout layout,
+		const CreateInfo& create_info
+	) noexcept
+	{
+		if (!context.feature.raytracing_pipeline)
+			return Error(
+				"Ray tracing pipeline feature not enabled",
+				"Ray tracing pipeline requires raytracing_pipeline feature"
+			);
+
+		const auto properties = get_properties(context.phy_device);
+
+		if (create_info.max_recursion_depth > properties.maxRayRecursionDepth)
+			return Error(
+				"Ray recursion depth exceeds device limit",
+				std::format(
+					"Requested {}, device supports {}",
+					create_info.max_recursion_depth,
+					properties.maxRayRecursionDepth
+				)
+			);
+
+		const auto general_group = [](uint32_t stage) {
+			return vk::RayTracingShaderGroupCreateInfoKHR{
+				.type = vk::RayTracingShaderGroupTypeKHR::eGeneral,
+				.generalShader = stage,
+				.closestHitShader = vk::ShaderUnusedKHR,
+				.anyHitShader = vk::ShaderUnusedKHR,
+				.intersectionShader = vk::ShaderUnusedKHR,
+			};
+		};
+
+		const auto hit_group = [](const HitGroup& group) {
+			return vk::RayTracingShaderGroupCreateInfoKHR{
+				.type = group.intersection.has_value()
+					? vk::RayTracingShaderGroupTypeKHR::eProceduralHitGroup
+					: vk::RayTracingShaderGroupTypeKHR::eTrianglesHitGroup,
+				.generalShader = vk::ShaderUnusedKHR,
+				.closestHitShader = group.closest_hit.value_or(vk::ShaderUnusedKHR),
+				.anyHitShader = group.any_hit.value_or(vk::ShaderUnusedKHR),
+				.intersectionShader = group.intersection.value_or(vk::ShaderUnusedKHR),
+			};
+		};
+
+		// Same order as the kinds in `GroupCount`
+		std::vector<vk::RayTracingShaderGroupCreateInfoKHR> groups;
+		groups.append_range(create_info.raygen_groups | std::views::transform(general_group));
+		groups.append_range(create_info.miss_groups | std::views::transform(general_group));
+		groups.append_range(create_info.hit_groups | std::views::transform(hit_group));
+		groups.append_range(create_info.callable_groups | std::views::transform(general_group));
+
+		const auto group_count = GroupCount{
+			.raygen = static_cast<uint32_t>(create_info.raygen_groups.size()),
+			.miss = static_cast<uint32_t>(create_info.miss_groups.size()),
+			.hit = static_cast<uint32_t>(create_info.hit_groups.size()),
+			.callable = static_cast<uint32_t>(create_info.callable_groups.size()),
+		};
+
+		const auto pipeline_create_info =
+			vk::RayTracingPipelineCreateInfoKHR{
+				.maxPipelineRayRecursionDepth = create_info.max_recursion_depth,
+				.layout = layout,
+			}
+				.setStages(create_info.stages)
+				.setGroups(groups);
+
+		auto pipeline_result =
+			context.device.createRayTracingPipelineKHR(nullptr, context.pipeline_cache, pipeline_create_info);
+		if (!pipeline_result) return Error::from(pipeline_result);
+		auto pipeline = std::move(*pipeline_result);
+
+		const auto handle_size = properties.shaderGroupHandleSize;
+		auto handles_result = pipeline.getRayTracingShaderGroupHandlesKHR<std::byte>(
+			0,
+			group_count.total(),
+			static_cast<size_t>(group_count.total()) * handle_size
+		);
+		if (!handles_result) return Error::from(handles_result).forward("Get shader group handles failed");
+
+		return RaytracingPipeline(std::move(pipeline), group_count, handle_size, std::move(*handles_result));
+	}
+
+	std::span<const std::byte> RaytracingPipeline::get_group_handle(uint32_t group) const noexcept
+	{
+		ASSUME(group < group_count.total());
+		return std::span(group_handles).subspan(static_cast<size_t>(group) * handle_size, handle_size);
+	}
+
+	std::expected<ShaderBindingTable::Layout, Error> ShaderBindingTable::get_layout(
+		const vk::PhysicalDeviceRayTracingPipelinePropertiesKHR& properties,
+		const Records& records
+	) noexcept
+	{
+		// Regions are placed in order, each after the previous one
+		auto raygen_result = get_region_layout(properties, records.raygen, 0);
+		if (!raygen_result) return raygen_result.error().forward("Lay out ray generation region failed");
+
+		auto miss_result = get_region_layout(properties, records.miss, get_region_end(*raygen_result));
+		if (!miss_result) return miss_result.error().forward("Lay out miss region failed");
+
+		auto hit_result = get_region_layout(properties, records.hit, get_region_end(*miss_result));
+		if (!hit_result) return hit_result.error().forward("Lay out hit region failed");
+
+		auto callable_result = get_region_layout(properties, records.callable, get_region_end(*hit_result));
+		if (!callable_result) return callable_result.error().forward("Lay out callable region failed");
+
+		return Layout{
+			.raygen = *raygen_result,
+			.miss = *miss_result,
+			.hit = *hit_result,
+			.callable = *callable_result,
+			.size = get_region_end(*callable_result),
+		};
+	}
+
+	std::expected<ShaderBindingTable, Error> ShaderBindingTable::create(
+		const Context& context,
+		const RaytracingPipeline& pipeline,
+		const Records& records
+	) noexcept
+	{
+		const auto properties = get_properties(context.phy_device);
+
+		auto layout_result = get_layout(properties, records);
+		if (!layout_result) return layout_result.error().forward("Get shader binding table layout failed");
+		const auto layout = *layout_result;
+
+		const auto group_count = pipeline.get_group_count();
+
+		struct Region
+		{
+			std::span<const Record> records;
+			uint32_t first_group;  // Index of the first group of the kind in the pipeline
+			uint32_t group_count;
+			RegionLayout layout;
+		};
+
+		const auto regions = std::to_array<Region>({
+			{.records = records.raygen,
+			 .first_group = 0,
+			 .group_count = group_count.raygen,
+			 .layout = layout.raygen},
+			{.records = records.miss,
+			 .first_group = group_count.raygen,
+			 .group_count = group_count.miss,
+			 .layout = layout.miss},
+			{.records = records.hit,
+			 .first_group = group_count.raygen + group_count.miss,
+			 .group_count = group_count.hit,
+			 .layout = layout.hit},
+			{.records = records.callable,
+			 .first_group = group_count.raygen + group_count.miss + group_count.hit,
+			 .group_count = group_count.callable,
+			 .layout = layout.callable},
+		});
+
+		for (const auto& region : regions)
+			for (const auto& record : region.records)
+				if (record.group >= region.group_count)
+					return Error(
+						"Shader binding table record refers to a missing group",
+						std::format("Group {} of {}", record.group, region.group_count)
+					);
+
+		/* Records, padding stays zero */
+
+		std::vector<std::byte> table(std::max(layout.size, vk::DeviceSize(1)), std::byte(0));
+
+		for (const auto& region : regions)
+			for (const auto [index, record] : std::views::enumerate(region.records))
+			{
+				const auto record_offset = region.layout.offset + index * region.layout.stride;
+				const auto dst = std::span(table).subspan(record_offset, region.layout.stride);
+				const auto handle = pipeline.get_group_handle(region.first_group + record.group);
+
+				std::ranges::copy(handle, dst.begin());
+				std::ranges::copy(record.data, dst.begin() + handle.size());
+			}
+
+		// The buffer base must be aligned too, over-allocate and offset into it
+		auto buffer_result = context.allocator.create_buffer(
+			{
+				.size = table.size() + properties.shaderGroupBaseAlignment,
+				.usage = vk::BufferUsageFlagBits::eShaderBindingTableKHR
+					| vk::BufferUsageFlagBits::eShaderDeviceAddress,
+			},
+			MemoryUsage::CpuToGpu
+		);
+		if (!buffer_result) return buffer_result.error().forward("Create shader binding table buffer failed");
+		auto buffer = std::move(*buffer_result);
+
+		const auto buffer_address = context.device.getBufferAddress({.buffer = buffer});
+		const auto base_address = util::align_address(buffer_address, properties.shaderGroupBaseAlignment);
+
+		if (const auto result = buffer.upload(table, base_address - buffer_address); !result)
+			return result.error().forward("Upload shader binding table failed");
+
+		const auto to_device_region = [base_address](const Region& region) {
+			// Unused regions must have a zero address
+			if (region.records.empty()) return vk::StridedDeviceAddressRegionKHR{};
+
+			return vk::StridedDeviceAddressRegionKHR{
+				.deviceAddress = base_address + region.layout.offset,
+				.stride = region.layout.stride,
+				.size = region.layout.size,
+			};
+		};
+
+		return ShaderBindingTable(
+			std::move(buffer),
+			to_device_region(regions[0]),
+			to_device_region(regions[1]),
+			to_device_region(regions[2]),
+			to_device_region(regions[3])
+		);
+	}
+
+	vk::StridedDeviceAddressRegionKHR ShaderBindingTable::raygen_region(uint32_t index) const noexcept
+	{
+		ASSUME(raygen.stride > 0);
+		ASSUME(index < raygen.size / raygen.stride);
+
+		return {
+			.deviceAddress = raygen.deviceAddress + index * raygen.stride,
+			.stride = raygen.stride,
+			.size = raygen.stride,
+		};
+	}
+
+	void ShaderBindingTable::trace(
+		const vk::raii::CommandBuffer& command_buffer,
+		uint32_t raygen_index,
+		uint32_t width,
+		uint32_t height,
+		uint32_t depth
+	) const noexcept
+	{
+		command_buffer.traceRaysKHR(
+			raygen_region(raygen_index),
+			miss,
+			hit,
+			callable,
+			width,
+			height,
+			depth
+		);
+	}
+}
@@ -41,8 +41,11 @@ namespace vulkan::impl
 					.arrayLayers = 1,
 					.usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc
 				};
-				auto blit_dst_image_result =
-					allocator.create_image(image_create_info, vulkan::MemoryUsage::GpuOnly);
+				auto blit_dst_image_result = allocator.create_image(
+					image_create_info,
+					vulkan::MemoryUsage::GpuOnly,
+					vulkan::MemoryCategory::Staging
+				);
 				if (!blit_dst_image_result)
 					return blit_dst_image_result.error().forward("Create blit destination image failed");
 
@@ -50,8 +53,11 @@ namespace vulkan::impl
 					.size = buffer_size,
 					.usage = vk::BufferUsageFlagBits::eTransferDst,
 				};
-				auto readback_buffer_result =
-					allocator.create_buffer(buffer_create_info, vulkan::MemoryUsage::GpuToCpu);
+				auto readback_buffer_result = allocator.create_buffer(
+					buffer_create_info,
+					vulkan::MemoryUsage::GpuToCpu,
+					vulkan::MemoryCategory::Staging
+				);
 				if (!readback_buffer_result)
 					return readback_buffer_result.error().forward("Create readback buffer failed");
 
@@ -72,6 +78,7 @@ namespace vulkan::impl
 		std::span<std::byte> output_data
 	) noexcept
 	{
+		// Writes to the source image may come from any queue, readbacks are rare enough to drain the device
 		if (const auto result = context.device.waitIdle(); !result) return Error::from(result);
 
 		/* Create resources */
@@ -200,11 +207,10 @@ namespace vulkan::impl
 
 		/* Download data */
 
+		// `CommandRunner::run` has waited for the copy
 		const auto download_result = transfer_resource.readback_buffer.download(output_data);
 		if (!download_result) return download_result.error().forward("Download readback buffer failed");
 
-		if (const auto result = context.device.waitIdle(); !result) return Error::from(result);
-
 		return {};
 	}
 }
@@ -0,0 +1,79 @@
+#include "vulkan/util/secondary-recorder.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <libassert/assert.hpp>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	std::expected<SecondaryRecorder, Error> SecondaryRecorder::create(
+		const vulkan::Context& context,
+		uint32_t slot_count
+	) noexcept
+	{
+		std::vector<vk::raii::CommandPool> command_pools;
+		std::vector<vk::raii::CommandBuffer> command_buffers;
+		command_pools.reserve(slot_count);
+		command_buffers.reserve(slot_count);
+
+		for ([[maybe_unused]] const auto slot : std::views::iota(0u, slot_count))
+		{
+			auto command_pool_result = context.device.createCommandPool({
+				.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+				.queueFamilyIndex = context.family,
+			});
+			if (!command_pool_result) return Error::from(command_pool_result);
+			auto command_pool = std::move(*command_pool_result);
+
+			auto command_buffer_result = context.device.allocateCommandBuffers({
+				.commandPool = command_pool,
+				.level = vk::CommandBufferLevel::eSecondary,
+				.commandBufferCount = 1,
+			});
+			if (!command_buffer_result) return Error::from(command_buffer_result);
+
+			command_buffers.push_back(std::move(command_buffer_result->at(0)));
+			command_pools.push_back(std::move(command_pool));
+		}
+
+		return SecondaryRecorder(std::move(command_pools), std::move(command_buffers));
+	}
+
+	std::expected<void, Error> SecondaryRecorder::record(
+		uint32_t slot,
+		const std::function<void(const vk::raii::CommandBuffer& command_buffer)>& action
+	) noexcept
+	{
+		ASSUME(slot < command_buffers.size());
+		const auto& command_buffer = command_buffers[slot];
+
+		// Not continuing any render pass, the secondary buffer begins and ends its own rendering if needed
+		const auto inheritance_info = vk::CommandBufferInheritanceInfo{};
+		const auto begin_info = vk::CommandBufferBeginInfo{
+			.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+			.pInheritanceInfo = &inheritance_info,
+		};
+
+		if (const auto result = command_buffer.begin(begin_info); !result) return Error::from(result);
+
+		action(command_buffer);
+
+		if (const auto result = command_buffer.end(); !result) return Error::from(result);
+
+		return {};
+	}
+
+	void SecondaryRecorder::execute(const vk::raii::CommandBuffer& primary, uint32_t slot) const noexcept
+	{
+		ASSUME(slot < command_buffers.size());
+		primary.executeCommands(*command_buffers[slot]);
+	}
+}
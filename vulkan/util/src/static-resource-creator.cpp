@@ -3,6 +3,7 @@
 #include "common/number-literals.hpp"
 #include "common/util/error.hpp"
 #include "common/util/span.hpp"
+#include "common/util/trace.hpp"
 #include "image/bc-image.hpp"
 #include "vulkan/alloc/allocator.hpp"
 #include "vulkan/alloc/buffer.hpp"
@@ -12,15 +13,23 @@
 #include "vulkan/util/command-runner.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <expected>
 #include <functional>
 #include <glm/ext/vector_uint2_sized.hpp>
 #include <glm/vector_relational.hpp>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <ranges>
 #include <span>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -31,36 +40,387 @@ namespace vulkan
 {
 
 	std::expected<StaticResourceCreator, Error> StaticResourceCreator::create(
-		const vulkan::Context& context
+		const vulkan::Context& context,
+		AllocationPool image_pool
 	) noexcept
 	{
 		auto command_runner_result = CommandRunner::create(context);
 		if (!command_runner_result)
 			return command_runner_result.error().forward("Create command runner failed");
-		return StaticResourceCreator(std::move(*command_runner_result));
+
+		if (context.transfer_family == context.family)
+			return StaticResourceCreator(image_pool, std::move(*command_runner_result), std::nullopt);
+
+		auto transfer_runner_result = CommandRunner::create(context, CommandRunner::QueueType::Transfer);
+		if (!transfer_runner_result)
+			return transfer_runner_result.error().forward("Create transfer command runner failed");
+
+		return StaticResourceCreator(
+			image_pool,
+			std::move(*command_runner_result),
+			std::move(*transfer_runner_result)
+		);
 	}
 
-#pragma region Utility
+#pragma region Staging
+
+	static std::expected<Buffer, Error> create_staging_buffer(const Context& context, size_t size) noexcept
+	{
+		return context.allocator.create_buffer(
+			vk::BufferCreateInfo{.size = size, .usage = vk::BufferUsageFlagBits::eTransferSrc},
+			MemoryUsage::CpuToGpu,
+			MemoryCategory::Staging
+		);
+	}
+
+	static size_t align_staging_size(size_t size) noexcept
+	{
+		return (size + StaticResourceCreator::STAGING_ALIGNMENT - 1)
+			/ StaticResourceCreator::STAGING_ALIGNMENT
+			* StaticResourceCreator::STAGING_ALIGNMENT;
+	}
+
+	std::expected<StaticResourceCreator::Staging, Error> StaticResourceCreator::stage(
+		const Context& context,
+		std::span<const std::span<const std::byte>> data
+	) noexcept
+	{
+		const auto sizes = data
+			| std::views::transform([](const auto& item) { return item.size(); })
+			| std::ranges::to<std::vector>();
+
+		return stage(context, sizes, [data](std::span<const std::span<std::byte>> destinations) {
+			for (const auto [item, destination] : std::views::zip(data, destinations))
+				std::ranges::copy(item, destination.begin());
+			return std::expected<void, Error>();
+		});
+	}
+
+	std::expected<StaticResourceCreator::Staging, Error> StaticResourceCreator::stage(
+		const Context& context,
+		std::span<const size_t> sizes,
+		const StagingWriter& write
+	) noexcept
+	{
+		const auto total_size = std::ranges::fold_left(
+			sizes | std::views::transform(align_staging_size),
+			0zu,
+			std::plus()
+		);
+
+		auto staging = Staging{
+			.ranges = {},
+			.chunk = nullptr,
+			.dedicated_buffer = std::nullopt,
+			.flush = false,
+		};
+
+		/* Reserve */
+
+		size_t base_offset = 0;
+		if (total_size > STAGING_CHUNK_SIZE)
+		{
+			auto buffer_result = create_staging_buffer(context, total_size);
+			if (!buffer_result)
+				return buffer_result.error().forward("Create dedicated staging buffer failed");
+
+			// Submit right away, as it holds a full chunk worth of data
+			staging.dedicated_buffer = std::move(*buffer_result);
+			staging.flush = true;
+		}
+		else
+		{
+			while (true)
+			{
+				std::expected<std::optional<std::pair<StagingChunk*, size_t>>, Error> reserve_result;
+				{
+					const std::scoped_lock lock(shared->staging_mutex);
+					reserve_result = reserve(context, total_size, staging.flush);
+				}
+				if (!reserve_result) return reserve_result.error().forward("Reserve staging memory failed");
+
+				if (reserve_result->has_value())
+				{
+					std::tie(staging.chunk, base_offset) = **reserve_result;
+					break;
+				}
+
+				// All chunks in use, become the consumer to free one
+				const std::scoped_lock lock(shared->consumer_mutex);
+				if (const auto result = reclaim_chunk(context); !result)
+					return result.error().forward("Reclaim staging chunk failed");
+			}
+		}
+
+		/* Write in place without holding any lock */
+
+		const auto& buffer = staging.chunk != nullptr ? staging.chunk->buffer : *staging.dedicated_buffer;
+		const auto mapped = buffer.mapped();
+
+		std::vector<std::span<std::byte>> destinations;
+		staging.ranges.reserve(sizes.size());
+		destinations.reserve(sizes.size());
+
+		auto offset = base_offset;
+		for (const auto size : sizes)
+		{
+			staging.ranges.push_back({.buffer = buffer, .offset = offset});
+			destinations.push_back(mapped.subspan(offset, size));
+			offset += align_staging_size(size);
+		}
+
+		const auto write_result = write(destinations).and_then([&] {
+			return buffer.flush(base_offset, total_size);
+		});
+		if (!write_result)
+		{
+			if (staging.chunk != nullptr) staging.chunk->writers.fetch_sub(1, std::memory_order_release);
+			return write_result.error().forward("Write staging buffer failed");
+		}
+
+		return staging;
+	}
+
+	std::expected<std::optional<std::pair<StaticResourceCreator::StagingChunk*, size_t>>, Error>
+	StaticResourceCreator::reserve(const Context& context, size_t size, bool& closed) noexcept
+	{
+		const auto reserve_from = [size](StagingChunk& chunk) {
+			const auto offset = chunk.offset;
+			chunk.offset += size;
+			chunk.writers.fetch_add(1, std::memory_order_relaxed);
+			return std::pair(&chunk, offset);
+		};
+
+		if (open_chunk != nullptr && open_chunk->offset + size <= open_chunk->capacity)
+			return reserve_from(*open_chunk);
+
+		// Close the open chunk, the consumer seals it once all its writers are done
+		if (open_chunk != nullptr)
+		{
+			closed_chunks.push_back(std::move(open_chunk));
+			closed = true;
+		}
+
+		const auto new_capacity =
+			std::min(std::max(next_chunk_capacity, std::bit_ceil(size)), STAGING_CHUNK_SIZE);
+
+		if (!free_chunks.empty())
+		{
+			open_chunk = std::move(free_chunks.back());
+			free_chunks.pop_back();
+
+			open_chunk->offset = 0;
 
-	std::expected<Buffer, Error> StaticResourceCreator::create_staging_buffer(
+			// Replace a chunk too small
+			if (open_chunk->capacity < size)
+			{
+				auto buffer_result = create_staging_buffer(context, new_capacity);
+				if (!buffer_result)
+				{
+					free_chunks.push_back(std::move(open_chunk));
+					return buffer_result.error().forward("Grow staging chunk failed");
+				}
+
+				open_chunk->buffer = std::move(*buffer_result);
+				open_chunk->capacity = new_capacity;
+				next_chunk_capacity = std::min(new_capacity * 2, STAGING_CHUNK_SIZE);
+			}
+
+			return reserve_from(*open_chunk);
+		}
+
+		if (chunk_count >= STAGING_CHUNK_COUNT) return std::nullopt;
+
+		auto buffer_result = create_staging_buffer(context, new_capacity);
+		if (!buffer_result) return buffer_result.error().forward("Create staging chunk failed");
+
+		open_chunk = std::make_unique<StagingChunk>(std::move(*buffer_result), new_capacity);
+		chunk_count++;
+		next_chunk_capacity = std::min(new_capacity * 2, STAGING_CHUNK_SIZE);
+
+		return reserve_from(*open_chunk);
+	}
+
+	void StaticResourceCreator::enqueue(
 		const Context& context,
-		std::span<const std::byte> data
+		Staging staging,
+		std::vector<BufferUploadTask> buffer_tasks,
+		std::vector<ImageUploadTask> image_tasks,
+		size_t data_size
 	) noexcept
 	{
-		auto staging_buffer_result = context.allocator.create_buffer(
-			vk::BufferCreateInfo{.size = data.size_bytes(), .usage = vk::BufferUsageFlagBits::eTransferSrc},
-			MemoryUsage::CpuToGpu
+		shared->pending_data_size.fetch_add(data_size, std::memory_order_relaxed);
+		shared->pending_task_count.fetch_add(
+			buffer_tasks.size() + image_tasks.size(),
+			std::memory_order_relaxed
 		);
-		if (!staging_buffer_result)
-			return staging_buffer_result.error().forward("Create staging buffer failed");
-		auto staging_buffer = std::move(*staging_buffer_result);
 
-		const auto upload_result = staging_buffer.upload(data);
-		if (!upload_result) return upload_result.error().forward("Upload data to staging buffer failed");
+		shared->queue.push(
+			UploadBatch{
+				.buffer_tasks = std::move(buffer_tasks),
+				.image_tasks = std::move(image_tasks),
+				.chunk = staging.chunk,
+				.dedicated_buffer = std::move(staging.dedicated_buffer),
+				.data_size = data_size
+			}
+		);
+
+		// Released after the push, so that the consumer sealing the chunk sees the batch
+		if (staging.chunk != nullptr) staging.chunk->writers.fetch_sub(1, std::memory_order_release);
+
+		if (staging.flush) try_flush(context);
+	}
+
+	void StaticResourceCreator::try_flush(const Context& context) noexcept
+	{
+		// Another thread consuming will submit the batch, or the next flush will
+		const std::unique_lock lock(shared->consumer_mutex, std::try_to_lock);
+		if (!lock.owns_lock()) return;
+
+		if (auto result = flush(context); !result && !deferred_error)
+			deferred_error = std::move(result.error());
+	}
+
+	std::expected<void, Error> StaticResourceCreator::flush(const Context& context) noexcept
+	{
+		/* Seal closed chunks without writers, all of their batches are queued by then */
+
+		std::vector<std::unique_ptr<StagingChunk>> sealed_chunks;
+		{
+			const std::scoped_lock lock(shared->staging_mutex);
+
+			const auto [first, last] = std::ranges::partition(closed_chunks, [](const auto& chunk) {
+				return chunk->writers.load(std::memory_order_acquire) != 0;
+			});
+			sealed_chunks.append_range(std::ranges::subrange(first, last) | std::views::as_rvalue);
+			closed_chunks.erase(first, last);
+		}
+
+		/* Drain and submit */
+
+		auto batches = shared->queue.take_all();
+		if (!batches.empty())
+		{
+			std::vector<BufferUploadTask> buffer_tasks;
+			std::vector<ImageUploadTask> image_tasks;
+			for (const auto& batch : batches)
+			{
+				buffer_tasks.append_range(batch.buffer_tasks);
+				image_tasks.append_range(batch.image_tasks);
+				drained_data_size += batch.data_size;
+				drained_task_count += batch.buffer_tasks.size() + batch.image_tasks.size();
+			}
+
+			auto submission_result = submit_uploads(context, buffer_tasks, image_tasks);
+
+			// Nothing of the batches is in flight when the submission fails, see `submit_uploads`
+			const auto submission = submission_result.value_or(Submission{});
+			latest_submission.merge(submission);
+
+			for (auto& batch : batches)
+			{
+				if (batch.chunk != nullptr) batch.chunk->submission.merge(submission);
+				if (batch.dedicated_buffer)
+					retired_buffers.push_back({
+						.buffer = std::move(*batch.dedicated_buffer),
+						.submission = submission,
+					});
+			}
+
+			if (!submission_result)
+			{
+				for (auto& chunk : sealed_chunks) submitted_chunks.push_back(std::move(chunk));
+				return submission_result.error().forward("Submit upload tasks failed");
+			}
+		}
+
+		for (auto& chunk : sealed_chunks) submitted_chunks.push_back(std::move(chunk));
+
+		/* Free completed chunks and buffers */
+
+		while (!submitted_chunks.empty())
+		{
+			const auto complete_result = is_submission_complete(submitted_chunks.front()->submission);
+			if (!complete_result) return complete_result.error().forward("Query staging chunk failed");
+			if (!*complete_result) break;
+
+			free_chunk(std::move(submitted_chunks.front()));
+			submitted_chunks.pop_front();
+		}
+
+		while (!retired_buffers.empty())
+		{
+			const auto complete_result = is_submission_complete(retired_buffers.front().submission);
+			if (!complete_result) return complete_result.error().forward("Query staging buffer failed");
+			if (!*complete_result) break;
+
+			retired_buffers.pop_front();
+		}
 
-		return staging_buffer;
+		return {};
 	}
 
+	std::expected<void, Error> StaticResourceCreator::reclaim_chunk(const Context& context) noexcept
+	{
+		if (const auto result = flush(context); !result) return result;
+
+		// Chunks closed by other producers may still be written, retry once they are sealed
+		if (submitted_chunks.empty())
+		{
+			std::this_thread::yield();
+			return {};
+		}
+
+		if (const auto result = wait_submission(context, submitted_chunks.front()->submission); !result)
+			return result.error().forward("Wait for oldest staging chunk failed");
+
+		free_chunk(std::move(submitted_chunks.front()));
+		submitted_chunks.pop_front();
+
+		return {};
+	}
+
+	void StaticResourceCreator::free_chunk(std::unique_ptr<StagingChunk> chunk) noexcept
+	{
+		chunk->submission = {};
+
+		const std::scoped_lock lock(shared->staging_mutex);
+		free_chunks.push_back(std::move(chunk));
+	}
+
+	std::expected<void, Error> StaticResourceCreator::wait_submission(
+		const Context& context,
+		Submission submission
+	) noexcept
+	{
+		if (transfer_runner)
+			if (const auto result = transfer_runner->wait(context, submission.transfer); !result)
+				return result.error().forward("Wait for transfer queue failed");
+
+		if (const auto result = command_runner.wait(context, submission.main); !result)
+			return result.error().forward("Wait for main queue failed");
+
+		return {};
+	}
+
+	std::expected<bool, Error> StaticResourceCreator::is_submission_complete(
+		Submission submission
+	) const noexcept
+	{
+		if (transfer_runner)
+		{
+			const auto transfer_result = transfer_runner->is_complete(submission.transfer);
+			if (!transfer_result) return transfer_result.error();
+			if (!*transfer_result) return false;
+		}
+
+		return command_runner.is_complete(submission.main);
+	}
+
+#pragma endregion
+
+#pragma region Utility
+
 	std::expected<void, Error> StaticResourceCreator::check_mipmap_chain_sizes(
 		std::vector<glm::u32vec2> sizes
 	) noexcept
@@ -80,6 +440,13 @@ namespace vulkan
 		return {};
 	}
 
+	uint32_t StaticResourceCreator::get_mipmap_levels(glm::u32vec2 size, uint32_t min_size_log) noexcept
+	{
+		const auto min_dim = std::max(std::min(size.x, size.y), 1_u32);
+		const auto min_dim_log = static_cast<uint32_t>(std::bit_width(min_dim)) - 1;
+		return min_dim_log > min_size_log ? min_dim_log - min_size_log + 1 : 1;
+	}
+
 	static vk::Format get_bcn_format(image::BCnFormat format, bool srgb)
 	{
 		switch (format)
@@ -92,6 +459,15 @@ namespace vulkan
 
 		case image::BCnFormat::BC7:
 			return srgb ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock;
+
+		case image::BCnFormat::ETC2:
+			return srgb ? vk::Format::eEtc2R8G8B8A8SrgbBlock : vk::Format::eEtc2R8G8B8A8UnormBlock;
+
+		case image::BCnFormat::EAC_RG11:
+			return vk::Format::eEacR11G11UnormBlock;
+
+		case image::BCnFormat::ASTC4x4:
+			return srgb ? vk::Format::eAstc4x4SrgbBlock : vk::Format::eAstc4x4UnormBlock;
 		}
 
 		return vk::Format::eUndefined;
@@ -121,7 +497,10 @@ namespace vulkan
 		};
 	}
 
-	vk::ImageMemoryBarrier2 StaticResourceCreator::ImageUploadTask::get_barrier_post() const
+	vk::ImageMemoryBarrier2 StaticResourceCreator::ImageUploadTask::get_barrier_post(
+		uint32_t src_family,
+		uint32_t dst_family
+	) const
 	{
 		const auto subresource_range = vk::ImageSubresourceRange{
 			.aspectMask = subresource_layers.aspectMask,
@@ -131,58 +510,216 @@ namespace vulkan
 			.layerCount = 1
 		};
 
+		// Levels to generate are blitted from the uploaded level, see `record_generate_mipmap`
+		const bool generate = generated_levels > 0;
+
 		return vk::ImageMemoryBarrier2{
 			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
 			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
 			.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
-			.dstAccessMask = vk::AccessFlagBits2::eNone,
+			.dstAccessMask = generate ? vk::AccessFlagBits2::eTransferRead : vk::AccessFlagBits2::eNone,
 			.oldLayout = vk::ImageLayout::eTransferDstOptimal,
+			.newLayout = generate ? vk::ImageLayout::eTransferSrcOptimal : dst_layout,
+			.srcQueueFamilyIndex = src_family,
+			.dstQueueFamilyIndex = dst_family,
+			.image = dst_image,
+			.subresourceRange = subresource_range,
+		};
+	}
+
+	vk::ImageMemoryBarrier2 StaticResourceCreator::ImageUploadTask::get_barrier_acquire(
+		uint32_t src_family,
+		uint32_t dst_family
+	) const
+	{
+		// Layout transition must be identical to the release barrier
+		auto barrier = get_barrier_post(src_family, dst_family);
+		barrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+		barrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+		barrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+		barrier.dstAccessMask = vk::AccessFlagBits2::eMemoryRead;
+		return barrier;
+	}
+
+	void StaticResourceCreator::ImageUploadTask::record_generate_mipmap(
+		const vk::raii::CommandBuffer& command_buffer
+	) const
+	{
+		if (generated_levels == 0) return;
+
+		const auto base_level = subresource_layers.mipLevel;
+		const auto get_range = [this](uint32_t level, uint32_t level_count) {
+			return vk::ImageSubresourceRange{
+				.aspectMask = subresource_layers.aspectMask,
+				.baseMipLevel = level,
+				.levelCount = level_count,
+				.baseArrayLayer = subresource_layers.baseArrayLayer,
+				.layerCount = subresource_layers.layerCount,
+			};
+		};
+		const auto get_layers = [this](uint32_t level) {
+			auto layers = subresource_layers;
+			layers.mipLevel = level;
+			return layers;
+		};
+		const auto get_corner = [this](uint32_t level_offset) {
+			return vk::Offset3D{
+				.x = static_cast<int32_t>(std::max(image_extent.width >> level_offset, 1u)),
+				.y = static_cast<int32_t>(std::max(image_extent.height >> level_offset, 1u)),
+				.z = 1
+			};
+		};
+
+		/* Discard generated levels */
+
+		const auto pre_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTopOfPipe,
+			.srcAccessMask = vk::AccessFlagBits2::eNone,
+			.dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.oldLayout = vk::ImageLayout::eUndefined,
+			.newLayout = vk::ImageLayout::eTransferDstOptimal,
+			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+			.image = dst_image,
+			.subresourceRange = get_range(base_level + 1, generated_levels)
+		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(pre_barrier));
+
+		/* Blit each level from the upper level */
+
+		for (const auto level_offset : std::views::iota(1_u32, generated_levels + 1))
+		{
+			const auto level = base_level + level_offset;
+
+			const auto blit = vk::ImageBlit{
+				.srcSubresource = get_layers(level - 1),
+				.srcOffsets = std::array{vk::Offset3D{.x = 0, .y = 0, .z = 0}, get_corner(level_offset - 1)},
+				.dstSubresource = get_layers(level),
+				.dstOffsets = std::array{vk::Offset3D{.x = 0, .y = 0, .z = 0}, get_corner(level_offset)}
+			};
+			command_buffer.blitImage(
+				dst_image,
+				vk::ImageLayout::eTransferSrcOptimal,
+				dst_image,
+				vk::ImageLayout::eTransferDstOptimal,
+				blit,
+				vk::Filter::eLinear
+			);
+
+			const auto level_barrier = vk::ImageMemoryBarrier2{
+				.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+				.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+				.dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+				.dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+				.oldLayout = vk::ImageLayout::eTransferDstOptimal,
+				.newLayout = vk::ImageLayout::eTransferSrcOptimal,
+				.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+				.image = dst_image,
+				.subresourceRange = get_range(level, 1)
+			};
+			command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(level_barrier));
+		}
+
+		/* All levels -> destination layout */
+
+		const auto post_barrier = vk::ImageMemoryBarrier2{
+			.srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+			.srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+			.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+			.dstAccessMask = vk::AccessFlagBits2::eNone,
+			.oldLayout = vk::ImageLayout::eTransferSrcOptimal,
 			.newLayout = dst_layout,
 			.srcQueueFamilyIndex = vk::QueueFamilyIgnored,
 			.dstQueueFamilyIndex = vk::QueueFamilyIgnored,
 			.image = dst_image,
-			.subresourceRange = subresource_range,
+			.subresourceRange = get_range(base_level, generated_levels + 1)
 		};
+		command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(post_barrier));
 	}
 
 #pragma endregion
 
 #pragma region Creation
 
-	std::expected<Buffer, Error> StaticResourceCreator::create_buffer(
+	std::expected<Buffer, Error> StaticResourceCreator::create_empty_buffer(
 		const Context& context,
-		std::span<const std::byte> data,
-		vk::BufferUsageFlags usage
+		size_t size,
+		vk::BufferUsageFlags usage,
+		MemoryCategory category
 	) noexcept
 	{
-		auto staging_buffer_result = create_staging_buffer(context, data);
-		if (!staging_buffer_result)
-			return staging_buffer_result.error().forward("Create staging buffer failed");
-		auto staging_buffer = std::move(*staging_buffer_result);
-
-		auto dst_buffer_result = context.allocator.create_buffer(
+		// Buffers may be written by the transfer queue and read by the compute queue, see class notes
+		const auto queue_families = context.unique_families();
+		return context.allocator.create_buffer(
 			vk::BufferCreateInfo{
-				.size = data.size_bytes(),
-				.usage = usage | vk::BufferUsageFlagBits::eTransferDst
+				.size = size,
+				.usage = usage | vk::BufferUsageFlagBits::eTransferDst,
+				.sharingMode = context.multi_queue_sharing_mode(),
+				.queueFamilyIndexCount = static_cast<uint32_t>(queue_families.size()),
+				.pQueueFamilyIndices = queue_families.data(),
 			},
-			MemoryUsage::GpuOnly
+			MemoryUsage::GpuOnly,
+			category
 		);
+	}
+
+	std::expected<Buffer, Error> StaticResourceCreator::create_buffer(
+		const Context& context,
+		std::span<const std::byte> data,
+		vk::BufferUsageFlags usage,
+		MemoryCategory category
+	) noexcept
+	{
+		auto dst_buffer_result = create_empty_buffer(context, data.size_bytes(), usage, category);
 		if (!dst_buffer_result) return dst_buffer_result.error().forward("Create gpu buffer failed");
 		auto dst_buffer = std::move(*dst_buffer_result);
 
-		const std::scoped_lock lock(*execution_mutex);
-		pending_data_size += data.size_bytes();
-		buffer_upload_tasks.push_back(
-			BufferUploadTask{
-				.dst_buffer = dst_buffer,
-				.staging_buffer = std::move(staging_buffer),
-				.data_size = data.size_bytes()
-			}
-		);
+		auto staging_result = stage(context, std::array{data});
+		if (!staging_result) return staging_result.error().forward("Stage buffer data failed");
+
+		auto buffer_task = BufferUploadTask{
+			.dst_buffer = dst_buffer,
+			.staging = staging_result->ranges.front(),
+			.data_size = data.size_bytes()
+		};
+		enqueue(context, std::move(*staging_result), {std::move(buffer_task)}, {}, data.size_bytes());
 
 		return dst_buffer;
 	}
 
+	std::expected<void, Error> StaticResourceCreator::write_buffers_in_place(
+		const Context& context,
+		std::span<const BufferRegion> regions,
+		const StagingWriter& write
+	) noexcept
+	{
+		const auto sizes =
+			regions | std::views::transform(&BufferRegion::size) | std::ranges::to<std::vector>();
+
+		auto staging_result = stage(context, sizes, write);
+		if (!staging_result) return staging_result.error().forward("Stage buffer data failed");
+
+		auto buffer_tasks =
+			std::views::zip(regions, staging_result->ranges)
+			| std::views::filter([](const auto& pair) { return std::get<0>(pair).size > 0; })
+			| std::views::transform([](const auto& pair) {
+				  const auto& [region, staging] = pair;
+				  return BufferUploadTask{
+					  .dst_buffer = region.buffer,
+					  .staging = staging,
+					  .data_size = region.size,
+					  .dst_offset = region.offset
+				  };
+			  })
+			| std::ranges::to<std::vector>();
+		const auto data_size = std::ranges::fold_left(sizes, 0zu, std::plus());
+		enqueue(context, std::move(*staging_result), std::move(buffer_tasks), {}, data_size);
+
+		return {};
+	}
+
 	std::expected<Image, Error> StaticResourceCreator::create_image_bcn(
 		const Context& context,
 		const image::BCnImage& image,
@@ -204,24 +741,32 @@ namespace vulkan
 			.arrayLayers = 1,
 			.usage = usage | vk::ImageUsageFlagBits::eTransferDst
 		};
-		auto image_result = context.allocator.create_image(image_create_info, vulkan::MemoryUsage::GpuOnly);
+		auto image_result = context.allocator.create_image(
+			image_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Texture,
+			nullptr,
+			image_pool
+		);
 		if (!image_result) return image_result.error().forward("Create gpu image failed");
 		auto dst_image = std::move(*image_result);
 
-		auto staging_buffer_result = create_staging_buffer(context, util::as_bytes(image.data));
-		if (!staging_buffer_result)
-			return staging_buffer_result.error().forward("Create staging buffer failed");
-
-		const std::scoped_lock lock(*execution_mutex);
-		pending_data_size += std::span(image.data).size_bytes();
-		image_upload_tasks.push_back(
-			ImageUploadTask{
-				.dst_image = dst_image,
-				.staging_buffer = std::move(*staging_buffer_result),
-				.subresource_layers = subresource_layer,
-				.image_extent = extent,
-				.dst_layout = layout
-			}
+		auto staging_result = stage(context, std::array{util::as_bytes(image.data)});
+		if (!staging_result) return staging_result.error().forward("Stage image data failed");
+
+		auto image_task = ImageUploadTask{
+			.dst_image = dst_image,
+			.staging = staging_result->ranges.front(),
+			.subresource_layers = subresource_layer,
+			.image_extent = extent,
+			.dst_layout = layout
+		};
+		enqueue(
+			context,
+			std::move(*staging_result),
+			{},
+			{std::move(image_task)},
+			std::span(image.data).size_bytes()
 		);
 
 		return dst_image;
@@ -280,23 +825,16 @@ namespace vulkan
 			.arrayLayers = 1,
 			.usage = usage | vk::ImageUsageFlagBits::eTransferDst
 		};
-		auto image_result = context.allocator.create_image(image_create_info, vulkan::MemoryUsage::GpuOnly);
+		auto image_result = context.allocator.create_image(
+			image_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Texture,
+			nullptr,
+			image_pool
+		);
 		if (!image_result) return image_result.error().forward("Create gpu image failed");
 		auto dst_image = std::move(*image_result);
 
-		/* Create staging buffers */
-
-		auto staging_buffer_result =
-			mipmap_chain
-			| std::views::transform([](const auto& image) { return util::as_bytes(image.data); })
-			| std::views::transform([this, &context](auto data) {
-				  return create_staging_buffer(context, data);
-			  })
-			| Error::collect();
-		if (!staging_buffer_result)
-			return staging_buffer_result.error().forward("Create staging buffers failed");
-		std::vector<Buffer> staging_buffers = std::move(*staging_buffer_result);
-
 		/* Append tasks */
 
 		const std::vector<vk::ImageSubresourceLayers> subresource_layers =
@@ -312,28 +850,240 @@ namespace vulkan
 			| std::ranges::to<std::vector>();
 
 		const auto as_upload_task =
-			[&dst_image, layout](const auto& extent, const auto& subresource_layer, auto& staging_buffer) {
+			[&dst_image, layout](const auto& extent, const auto& subresource_layer, const auto& staging) {
 				return ImageUploadTask{
 					.dst_image = dst_image,
-					.staging_buffer = std::move(staging_buffer),
+					.staging = staging,
 					.subresource_layers = subresource_layer,
 					.image_extent = extent,
 					.dst_layout = layout
 				};
 			};
 
-		const std::scoped_lock lock(*execution_mutex);
-		pending_data_size +=
-			std::ranges::fold_left_first(
-				mipmap_chain | std::views::transform([](const auto& image) {
-					return std::span(image.data).size_bytes();
-				}),
-				std::plus()
-			)
-				.value_or(0);
-		image_upload_tasks.append_range(
-			std::views::zip_transform(as_upload_task, extents, subresource_layers, staging_buffers)
+		const std::vector<std::span<const std::byte>> level_data =
+			mipmap_chain
+			| std::views::transform([](const auto& image) { return util::as_bytes(image.data); })
+			| std::ranges::to<std::vector>();
+
+		auto staging_result = stage(context, level_data);
+		if (!staging_result) return staging_result.error().forward("Stage image data failed");
+
+		auto image_tasks =
+			std::views::zip_transform(as_upload_task, extents, subresource_layers, staging_result->ranges)
+			| std::ranges::to<std::vector>();
+		const auto data_size = std::ranges::fold_left(
+			level_data | std::views::transform([](const auto& data) { return data.size(); }),
+			0zu,
+			std::plus()
 		);
+		enqueue(context, std::move(*staging_result), {}, std::move(image_tasks), data_size);
+
+		return dst_image;
+	}
+
+	std::expected<Image, Error> StaticResourceCreator::create_image_mipmap_raw(
+		const Context& context,
+		std::span<const RawLevel> mipmap_chain,
+		vk::Format format,
+		vk::ImageUsageFlags usage,
+		vk::ImageLayout layout,
+		vk::ImageCreateFlags create_flags
+	) noexcept
+	{
+		const auto levels =
+			mipmap_chain
+			| std::views::transform([](const RawLevel& level) {
+				  return InPlaceLevel{.extent = level.extent, .size = level.data.size()};
+			  })
+			| std::ranges::to<std::vector>();
+
+		const auto copy_levels = [mipmap_chain](std::span<const std::span<std::byte>> destinations) {
+			for (const auto [level, destination] : std::views::zip(mipmap_chain, destinations))
+				std::ranges::copy(level.data, destination.begin());
+			return std::expected<void, Error>();
+		};
+
+		return create_image_mipmap_in_place(
+			context,
+			levels,
+			format,
+			copy_levels,
+			usage,
+			layout,
+			create_flags
+		);
+	}
+
+	std::expected<Image, Error> StaticResourceCreator::create_image_array_raw(
+		const Context& context,
+		std::span<const std::span<const RawLevel>> layers,
+		vk::Format format,
+		vk::ImageUsageFlags usage,
+		vk::ImageLayout layout,
+		vk::ImageCreateFlags create_flags
+	) noexcept
+	{
+		if (layers.empty()) return Error("Input layer list is empty");
+
+		const auto levels =
+			layers.front()
+			| std::views::transform([](const RawLevel& level) {
+				  return InPlaceLevel{.extent = level.extent, .size = level.data.size()};
+			  })
+			| std::ranges::to<std::vector>();
+
+		const auto is_same_chain = [&levels](std::span<const RawLevel> chain) {
+			const auto is_same_level = [](const RawLevel& level, const InPlaceLevel& expected) {
+				return level.extent == expected.extent && level.data.size() == expected.size;
+			};
+			return std::ranges::equal(chain, levels, is_same_level);
+		};
+		if (!std::ranges::all_of(layers, is_same_chain))
+			return Error("Mipmap chains of array layers mismatch");
+
+		const auto copy_layers = [layers](std::span<const std::span<std::byte>> destinations) {
+			for (const auto [level, destination] : std::views::zip(layers | std::views::join, destinations))
+				std::ranges::copy(level.data, destination.begin());
+			return std::expected<void, Error>();
+		};
+
+		return create_image_layers_in_place(
+			context,
+			levels,
+			static_cast<uint32_t>(layers.size()),
+			format,
+			copy_layers,
+			usage,
+			layout,
+			create_flags
+		);
+	}
+
+	std::expected<Image, Error> StaticResourceCreator::create_image_mipmap_in_place(
+		const Context& context,
+		std::span<const InPlaceLevel> mipmap_chain,
+		vk::Format format,
+		const StagingWriter& write,
+		vk::ImageUsageFlags usage,
+		vk::ImageLayout layout,
+		vk::ImageCreateFlags create_flags
+	) noexcept
+	{
+		return create_image_layers_in_place(
+			context,
+			mipmap_chain,
+			1,
+			format,
+			write,
+			usage,
+			layout,
+			create_flags
+		);
+	}
+
+	std::expected<Image, Error> StaticResourceCreator::create_image_layers_in_place(
+		const Context& context,
+		std::span<const InPlaceLevel> mipmap_chain,
+		uint32_t layer_count,
+		vk::Format format,
+		const StagingWriter& write,
+		vk::ImageUsageFlags usage,
+		vk::ImageLayout layout,
+		vk::ImageCreateFlags create_flags
+	) noexcept
+	{
+		/* Verify inputs */
+
+		if (mipmap_chain.empty()) return Error("Input mipmap chain is empty");
+		if (layer_count == 0) return Error("Image has no array layer");
+
+		if (const auto size_check_result = check_mipmap_chain_sizes(
+				mipmap_chain | std::views::transform(&InPlaceLevel::extent) | std::ranges::to<std::vector>()
+			);
+			!size_check_result)
+		{
+			return size_check_result.error();
+		}
+
+		/* Create image */
+
+		const std::vector<vk::Extent3D> extents =
+			mipmap_chain
+			| std::views::transform([](const InPlaceLevel& level) {
+				  return vk::Extent3D{.width = level.extent.x, .height = level.extent.y, .depth = 1};
+			  })
+			| std::ranges::to<std::vector>();
+		const uint32_t mipmap_levels = mipmap_chain.size();
+
+		const auto image_create_info = vk::ImageCreateInfo{
+			.flags = create_flags,
+			.imageType = vk::ImageType::e2D,
+			.format = format,
+			.extent = extents[0],
+			.mipLevels = mipmap_levels,
+			.arrayLayers = layer_count,
+			.usage = usage | vk::ImageUsageFlagBits::eTransferDst
+		};
+		auto image_result = context.allocator.create_image(
+			image_create_info,
+			vulkan::MemoryUsage::GpuOnly,
+			vulkan::MemoryCategory::Texture,
+			nullptr,
+			image_pool
+		);
+		if (!image_result) return image_result.error().forward("Create gpu image failed");
+		auto dst_image = std::move(*image_result);
+
+		/* Append tasks, one per level of each layer in layer-major order */
+
+		const auto get_subresource_layers = [](const auto& layer_and_level) {
+			const auto [layer, mip_level] = layer_and_level;
+			return vk::ImageSubresourceLayers{
+				.aspectMask = vk::ImageAspectFlagBits::eColor,
+				.mipLevel = mip_level,
+				.baseArrayLayer = layer,
+				.layerCount = 1,
+			};
+		};
+		const std::vector<vk::ImageSubresourceLayers> subresource_layers =
+			std::views::cartesian_product(
+				std::views::iota(0_u32, layer_count),
+				std::views::iota(0_u32, mipmap_levels)
+			)
+			| std::views::transform(get_subresource_layers)
+			| std::ranges::to<std::vector>();
+		const auto layer_extents = std::views::repeat(extents, layer_count) | std::views::join;
+
+		const auto as_upload_task =
+			[&dst_image, layout](const auto& extent, const auto& subresource_layer, const auto& staging) {
+				return ImageUploadTask{
+					.dst_image = dst_image,
+					.staging = staging,
+					.subresource_layers = subresource_layer,
+					.image_extent = extent,
+					.dst_layout = layout
+				};
+			};
+
+		const std::vector<size_t> level_sizes =
+			std::views::repeat(mipmap_chain, layer_count)
+			| std::views::join
+			| std::views::transform(&InPlaceLevel::size)
+			| std::ranges::to<std::vector>();
+
+		auto staging_result = stage(context, level_sizes, write);
+		if (!staging_result) return staging_result.error().forward("Stage image data failed");
+
+		auto image_tasks =
+			std::views::zip_transform(
+				as_upload_task,
+				layer_extents,
+				subresource_layers,
+				staging_result->ranges
+			)
+			| std::ranges::to<std::vector>();
+		const auto data_size = std::ranges::fold_left(level_sizes, 0zu, std::plus());
+		enqueue(context, std::move(*staging_result), {}, std::move(image_tasks), data_size);
 
 		return dst_image;
 	}
@@ -342,14 +1092,12 @@ namespace vulkan
 
 	size_t StaticResourceCreator::num_pending() const noexcept
 	{
-		const std::scoped_lock lock(*execution_mutex);
-		return buffer_upload_tasks.size() + image_upload_tasks.size();
+		return shared->pending_task_count.load(std::memory_order_relaxed);
 	}
 
 	size_t StaticResourceCreator::size_pending() const noexcept
 	{
-		const std::scoped_lock lock(*execution_mutex);
-		return pending_data_size;
+		return shared->pending_data_size.load(std::memory_order_relaxed);
 	}
 
 	std::expected<void, Error> StaticResourceCreator::execute_uploads_with_size_thres(
@@ -357,49 +1105,57 @@ namespace vulkan
 		size_t size_thres
 	) noexcept
 	{
-		// Note: these buffers has 0 size before use, no extra alloc
-		std::vector<BufferUploadTask> buffer_tasks;
-		std::vector<ImageUploadTask> image_tasks;
+		if (size_pending() < size_thres) return {};
 
-		{
-			const std::scoped_lock lock(*execution_mutex);
-			if (pending_data_size < size_thres) return {};
-
-			// Use std::exchange instead of std::move to avoid leaving moved-away objects
-			buffer_tasks = std::exchange(buffer_upload_tasks, {});
-			image_tasks = std::exchange(image_upload_tasks, {});
-			pending_data_size = 0;
-		}
+		// Another thread consuming already executes the uploads, don't block on it
+		const std::unique_lock lock(shared->consumer_mutex, std::try_to_lock);
+		if (!lock.owns_lock()) return {};
 
-		return execute_uploads_impl(context, buffer_tasks, image_tasks);
+		return execute_uploads_locked(context);
 	}
 
 	std::expected<void, Error> StaticResourceCreator::execute_uploads(const Context& context) noexcept
 	{
-		// Note: these buffers has 0 size before use, no extra alloc
-		std::vector<BufferUploadTask> buffer_tasks;
-		std::vector<ImageUploadTask> image_tasks;
+		// Includes waiting for the consumer lock, see `execute_uploads_locked` for the flush itself
+		const auto trace = util::trace::Scope("Execute uploads");
 
-		{
-			const std::scoped_lock lock(*execution_mutex);
+		const std::scoped_lock lock(shared->consumer_mutex);
+		return execute_uploads_locked(context);
+	}
+
+	std::expected<void, Error> StaticResourceCreator::execute_uploads_locked(const Context& context) noexcept
+	{
+		const auto trace = util::trace::Scope("Flush uploads");
+
+		const auto flush_result = flush(context);
+
+		// Submitted uploads must complete regardless, as the caller may destroy the creator on failure
+		if (const auto result = wait_submission(context, latest_submission); !result)
+			return result.error().forward("Wait for upload tasks failed");
 
-			// Use std::exchange instead of std::move to avoid leaving moved-away objects
-			buffer_tasks = std::exchange(buffer_upload_tasks, {});
-			image_tasks = std::exchange(image_upload_tasks, {});
-			pending_data_size = 0;
+		while (!submitted_chunks.empty())
+		{
+			free_chunk(std::move(submitted_chunks.front()));
+			submitted_chunks.pop_front();
 		}
+		retired_buffers.clear();
+
+		shared->pending_data_size.fetch_sub(std::exchange(drained_data_size, 0), std::memory_order_relaxed);
+		shared->pending_task_count.fetch_sub(std::exchange(drained_task_count, 0), std::memory_order_relaxed);
+
+		if (!flush_result) return flush_result.error();
+		if (deferred_error)
+			return std::exchange(deferred_error, std::nullopt)->forward("Previous upload tasks failed");
 
-		return execute_uploads_impl(context, buffer_tasks, image_tasks);
+		return {};
 	}
 
-	std::expected<void, Error> StaticResourceCreator::execute_uploads_impl(
+	std::expected<StaticResourceCreator::Submission, Error> StaticResourceCreator::submit_uploads(
 		const Context& context,
 		const std::vector<BufferUploadTask>& buffer_tasks,
 		const std::vector<ImageUploadTask>& image_tasks
 	) noexcept
 	{
-		if (buffer_tasks.empty() && image_tasks.empty()) return {};
-
 		/* Synchronization infos */
 
 		const auto buffer_barrier_post = vk::MemoryBarrier2{
@@ -413,8 +1169,15 @@ namespace vulkan
 			| std::views::transform([](const auto& task) { return task.get_barrier_pre(); })
 			| std::ranges::to<std::vector>();
 
-		const auto image_barriers_post = image_tasks
-			| std::views::transform([](const auto& task) { return task.get_barrier_post(); })
+		// Ownership of images is transferred to the main queue family when using the transfer queue
+		const auto src_family = transfer_runner ? context.transfer_family : vk::QueueFamilyIgnored;
+		const auto dst_family = transfer_runner ? context.family : vk::QueueFamilyIgnored;
+
+		const auto image_barriers_post =
+			image_tasks
+			| std::views::transform([src_family, dst_family](const auto& task) {
+				  return task.get_barrier_post(src_family, dst_family);
+			  })
 			| std::ranges::to<std::vector>();
 
 		/* Record commands */
@@ -423,11 +1186,11 @@ namespace vulkan
 			for (const auto& task : buffer_tasks)
 			{
 				const auto copy_region = vk::BufferCopy{
-					.srcOffset = 0,
-					.dstOffset = 0,
+					.srcOffset = task.staging.offset,
+					.dstOffset = task.dst_offset,
 					.size = task.data_size,
 				};
-				command_buffer.copyBuffer(task.staging_buffer, task.dst_buffer, copy_region);
+				command_buffer.copyBuffer(task.staging.buffer, task.dst_buffer, copy_region);
 			}
 
 			// Barrier after buffer copies and before image copies
@@ -442,7 +1205,7 @@ namespace vulkan
 			for (const auto& task : image_tasks)
 			{
 				const auto buffer_image_copy = vk::BufferImageCopy{
-					.bufferOffset = 0,
+					.bufferOffset = task.staging.offset,
 					.bufferRowLength = 0,
 					.bufferImageHeight = 0,
 					.imageSubresource = task.subresource_layers,
@@ -450,7 +1213,7 @@ namespace vulkan
 					.imageExtent = task.image_extent,
 				};
 				command_buffer.copyBufferToImage(
-					task.staging_buffer,
+					task.staging.buffer,
 					task.dst_image,
 					vk::ImageLayout::eTransferDstOptimal,
 					buffer_image_copy
@@ -464,6 +1227,62 @@ namespace vulkan
 				);
 		};
 
-		return command_runner.run(context, command_func);
+		// Blits need a graphics-capable queue, mipmaps are generated on the main queue
+		const auto generate_mipmap_func = [&image_tasks](const vk::raii::CommandBuffer& command_buffer) {
+			for (const auto& task : image_tasks) task.record_generate_mipmap(command_buffer);
+		};
+
+		if (!transfer_runner)
+		{
+			auto ticket_result =
+				command_runner.submit_async(context, [&](const vk::raii::CommandBuffer& command_buffer) {
+					command_func(command_buffer);
+					generate_mipmap_func(command_buffer);
+				});
+			if (!ticket_result) return ticket_result.error().forward("Submit upload commands failed");
+
+			return Submission{.transfer = {}, .main = *ticket_result};
+		}
+
+		/* Execute on transfer queue */
+
+		const auto transfer_ticket_result = transfer_runner->submit_async(context, command_func);
+		if (!transfer_ticket_result)
+			return transfer_ticket_result.error().forward("Submit transfer commands failed");
+		const auto transfer_ticket = *transfer_ticket_result;
+
+		// Buffers are shared concurrently, no ownership transfer needed
+		if (image_tasks.empty()) return Submission{.transfer = transfer_ticket, .main = {}};
+
+		/* Acquire images on main queue */
+
+		const auto image_barriers_acquire =
+			image_tasks
+			| std::views::transform([src_family, dst_family](const auto& task) {
+				  return task.get_barrier_acquire(src_family, dst_family);
+			  })
+			| std::ranges::to<std::vector>();
+
+		const auto wait_infos = std::to_array({transfer_runner->get_wait_info(transfer_ticket)});
+
+		const auto acquire_ticket_result = command_runner.submit_async(
+			context,
+			[&image_barriers_acquire, &generate_mipmap_func](const vk::raii::CommandBuffer& command_buffer) {
+				command_buffer.pipelineBarrier2(
+					vk::DependencyInfo{}.setImageMemoryBarriers(image_barriers_acquire)
+				);
+				generate_mipmap_func(command_buffer);
+			},
+			wait_infos
+		);
+		if (!acquire_ticket_result)
+		{
+			// Staging chunk must outlive the transfer
+			if (const auto wait_result = transfer_runner->wait(context, transfer_ticket); !wait_result)
+				return wait_result.error().forward("Wait for transfer queue failed");
+			return acquire_ticket_result.error().forward("Acquire images on main queue failed");
+		}
+
+		return Submission{.transfer = transfer_ticket, .main = *acquire_ticket_result};
 	}
 }
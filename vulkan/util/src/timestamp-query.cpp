@@ -0,0 +1,105 @@
+#include "vulkan/util/timestamp-query.hpp"
+#include "common/number-literals.hpp"
+#include "common/util/error.hpp"
+#include "vulkan/interface/context.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace vulkan
+{
+	TimestampQuery::Scope::~Scope() noexcept
+	{
+		if (query_pool == nullptr) return;
+		command_buffer->writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, *query_pool, end_query);
+	}
+
+	std::expected<TimestampQuery, Error> TimestampQuery::create(
+		const vulkan::Context& context,
+		uint32_t max_scopes
+	) noexcept
+	{
+		const auto queue_families = context.phy_device.getQueueFamilyProperties();
+		const auto valid_bits = queue_families[context.family].timestampValidBits;
+		const auto timestamp_period = context.phy_device.getProperties().limits.timestampPeriod;
+
+		// Zero query count is not allowed, create a minimal pool and never use it
+		const auto query_count = valid_bits == 0 ? 1 : max_scopes * 2;
+
+		auto query_pool_result = context.device.createQueryPool({
+			.queryType = vk::QueryType::eTimestamp,
+			.queryCount = query_count,
+		});
+		if (!query_pool_result) return Error::from(query_pool_result).forward("Create query pool failed");
+
+		const auto timestamp_mask = valid_bits >= 64 ? ~0_u64 : (1_u64 << valid_bits) - 1;
+
+		return TimestampQuery(
+			std::move(*query_pool_result),
+			valid_bits == 0 ? 0 : max_scopes,
+			static_cast<double>(timestamp_period),
+			timestamp_mask
+		);
+	}
+
+	void TimestampQuery::begin_frame(const vk::raii::CommandBuffer& command_buffer) noexcept
+	{
+		scope_names.clear();
+		if (max_scopes == 0) return;
+
+		command_buffer.resetQueryPool(query_pool, 0, max_scopes * 2);
+	}
+
+	TimestampQuery::Scope TimestampQuery::scope(
+		const vk::raii::CommandBuffer& command_buffer,
+		std::string_view name
+	) noexcept
+	{
+		if (scope_names.size() >= max_scopes) return Scope(&command_buffer, nullptr, 0);
+
+		const auto begin_query = static_cast<uint32_t>(scope_names.size() * 2);
+		scope_names.emplace_back(name);
+
+		command_buffer.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, query_pool, begin_query);
+
+		return Scope(&command_buffer, &query_pool, begin_query + 1);
+	}
+
+	std::expected<std::vector<TimestampQuery::Result>, Error> TimestampQuery::read_results() const noexcept
+	{
+		if (scope_names.empty()) return std::vector<Result>();
+
+		const auto query_count = static_cast<uint32_t>(scope_names.size() * 2);
+		const auto [query_result, timestamps] = query_pool.getResults<uint64_t>(
+			0,
+			query_count,
+			query_count * sizeof(uint64_t),
+			sizeof(uint64_t),
+			vk::QueryResultFlagBits::e64
+		);
+		if (query_result != vk::Result::eSuccess)
+			return Error::from(query_result).forward("Get timestamp query results failed");
+
+		std::vector<Result> results;
+		results.reserve(scope_names.size());
+
+		for (const auto [idx, name] : scope_names | std::views::enumerate)
+		{
+			const auto begin = timestamps[idx * 2] & timestamp_mask;
+			const auto end = timestamps[idx * 2 + 1] & timestamp_mask;
+			const auto ticks = (end - begin) & timestamp_mask;  // Handles wrap-around
+			const auto duration_ms = static_cast<double>(ticks) * timestamp_period_ns * 1.0e-6;
+
+			results.push_back(Result{.name = name, .duration_ms = duration_ms});
+		}
+
+		return results;
+	}
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <doctest.h>
+#include <set>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "common/test-macro.hpp"
+#include "vulkan/test-driver.hpp"
+#include "vulkan/util/descriptor-allocator.hpp"
+
+static constexpr auto RATIOS = std::to_array<vulkan::DescriptorAllocator::Ratio>({
+	{.type = vk::DescriptorType::eStorageBuffer, .count = 1.0f},
+});
+
+static vk::raii::DescriptorSetLayout create_layout(const vk::raii::Device& device)
+{
+	const auto binding = vk::DescriptorSetLayoutBinding{
+		.binding = 0,
+		.descriptorType = vk::DescriptorType::eStorageBuffer,
+		.descriptorCount = 1,
+		.stageFlags = vk::ShaderStageFlagBits::eCompute,
+	};
+
+	auto layout_result =
+		device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo().setBindings(binding));
+	REQUIRE(layout_result.has_value());
+	return std::move(*layout_result);
+}
+
+// Sets of one generation are all live at once, so they must be distinct
+static void check_distinct(const std::vector<vk::DescriptorSet>& sets)
+{
+	CHECK_FALSE(std::ranges::contains(sets, vk::DescriptorSet()));
+	CHECK_EQ(std::set(sets.begin(), sets.end()).size(), sets.size());
+}
+
+TEST_CASE("Zero initial set count")
+{
+	const auto& context = vulkan::get_test_context().get();
+
+	auto allocator_result = vulkan::DescriptorAllocator::create(context, 0, RATIOS);
+	EXPECT_FAIL(allocator_result);
+}
+
+TEST_CASE("Grow on exhausted pool")
+{
+	const auto& context = vulkan::get_test_context().get();
+	const auto layout = create_layout(context.device);
+
+	// The first pool holds a single set, every further allocation runs it out of memory
+	auto allocator_result = vulkan::DescriptorAllocator::create(context, 1, RATIOS);
+	EXPECT_SUCCESS(allocator_result);
+	auto allocator = std::move(*allocator_result);
+
+	std::vector<vk::DescriptorSet> sets;
+	for (uint32_t i = 0; i < 7; i++)
+	{
+		auto set_result = allocator.allocate(context.device, *layout);
+		EXPECT_SUCCESS(set_result);
+		sets.push_back(*set_result);
+	}
+
+	// Batch larger than the next pool, which is sized up to fit it
+	const auto layouts = std::vector(32, *layout);
+	auto batch_result = allocator.allocate(context.device, layouts);
+	EXPECT_SUCCESS(batch_result);
+	CHECK_EQ(batch_result->size(), layouts.size());
+	sets.append_range(*batch_result);
+
+	check_distinct(sets);
+
+	auto empty_result = allocator.allocate(context.device, std::vector<vk::DescriptorSetLayout>());
+	EXPECT_SUCCESS(empty_result);
+	CHECK(empty_result->empty());
+}
+
+TEST_CASE("Reset")
+{
+	const auto& context = vulkan::get_test_context().get();
+	const auto layout = create_layout(context.device);
+
+	auto allocator_result = vulkan::DescriptorAllocator::create(context, 4, RATIOS);
+	EXPECT_SUCCESS(allocator_result);
+	auto allocator = std::move(*allocator_result);
+
+	// Generations larger than the first pool grow the chain, smaller ones are served by the kept pools
+	for (const auto count : {6u, 6u, 12u, 1u})
+	{
+		const auto layouts = std::vector(count, *layout);
+		auto sets_result = allocator.allocate(context.device, layouts);
+		EXPECT_SUCCESS(sets_result);
+		CHECK_EQ(sets_result->size(), count);
+		check_distinct(*sets_result);
+
+		allocator.reset();
+	}
+}
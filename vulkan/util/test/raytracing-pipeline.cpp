@@ -0,0 +1,117 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "common/test-macro.hpp"
+#include "vulkan/util/raytracing-pipeline.hpp"
+
+// NOLINTBEGIN
+
+// Limits of a typical desktop device, base alignment larger than the handle alignment
+static vk::PhysicalDeviceRayTracingPipelinePropertiesKHR get_properties()
+{
+	vk::PhysicalDeviceRayTracingPipelinePropertiesKHR properties;
+	properties.shaderGroupHandleSize = 32;
+	properties.shaderGroupHandleAlignment = 32;
+	properties.shaderGroupBaseAlignment = 64;
+	properties.maxShaderGroupStride = 4096;
+	return properties;
+}
+
+static void check_region(
+	const vulkan::ShaderBindingTable::RegionLayout& region,
+	const vk::PhysicalDeviceRayTracingPipelinePropertiesKHR& properties,
+	size_t record_count,
+	size_t max_data_size
+)
+{
+	CHECK_EQ(region.offset % properties.shaderGroupBaseAlignment, 0);
+	CHECK_EQ(region.stride % properties.shaderGroupHandleAlignment, 0);
+	CHECK_GE(region.stride, properties.shaderGroupHandleSize + max_data_size);
+	CHECK_LT(
+		region.stride,
+		properties.shaderGroupHandleSize + max_data_size + properties.shaderGroupHandleAlignment
+	);
+	CHECK_EQ(region.size, region.stride * record_count);
+}
+
+// NOLINTEND
+
+TEST_CASE("Region layout")
+{
+	const auto properties = get_properties();
+
+	// Data sizes off the handle alignment, so the strides need padding
+	const auto short_data = std::vector<std::byte>(4);
+	const auto long_data = std::vector<std::byte>(40);
+
+	const auto raygen = std::to_array<vulkan::ShaderBindingTable::Record>({{.group = 0}});
+	const auto miss = std::to_array<vulkan::ShaderBindingTable::Record>({
+		{.group = 0},
+		{.group = 1, .data = short_data},
+	});
+	const auto hit = std::to_array<vulkan::ShaderBindingTable::Record>({
+		{.group = 0, .data = short_data},
+		{.group = 1, .data = long_data},
+		{.group = 0},
+	});
+
+	const auto layout_result = vulkan::ShaderBindingTable::get_layout(
+		properties,
+		{.raygen = raygen, .miss = miss, .hit = hit, .callable = {}}
+	);
+	EXPECT_SUCCESS(layout_result);
+	const auto& layout = *layout_result;
+
+	check_region(layout.raygen, properties, raygen.size(), 0);
+	check_region(layout.miss, properties, miss.size(), short_data.size());
+	check_region(layout.hit, properties, hit.size(), long_data.size());
+	check_region(layout.callable, properties, 0, 0);
+
+	// Tight strides: handle alone, handle plus 4 bytes, handle plus 40 bytes
+	CHECK_EQ(layout.raygen.stride, 32);
+	CHECK_EQ(layout.miss.stride, 64);
+	CHECK_EQ(layout.hit.stride, 96);
+
+	// Regions follow each other at the next base alignment, never overlapping
+	CHECK_EQ(layout.raygen.offset, 0);
+	CHECK_EQ(layout.miss.offset, 64);
+	CHECK_EQ(layout.hit.offset, 192);
+	CHECK_EQ(layout.callable.offset, 512);
+	CHECK_EQ(layout.size, 512);
+}
+
+TEST_CASE("Stride exceeds device limit")
+{
+	auto properties = get_properties();
+	properties.maxShaderGroupStride = 64;
+
+	const auto data = std::vector<std::byte>(33);
+	const auto hit = std::to_array<vulkan::ShaderBindingTable::Record>({{.group = 0, .data = data}});
+
+	SUBCASE("Exceeding")
+	{
+		const auto layout_result = vulkan::ShaderBindingTable::get_layout(
+			properties,
+			{.raygen = {}, .miss = {}, .hit = hit, .callable = {}}
+		);
+		EXPECT_FAIL(layout_result);
+	}
+
+	SUBCASE("At limit")
+	{
+		const auto fitting = std::to_array<vulkan::ShaderBindingTable::Record>(
+			{{.group = 0, .data = std::span(data).first(32)}}
+		);
+		const auto layout_result = vulkan::ShaderBindingTable::get_layout(
+			properties,
+			{.raygen = {}, .miss = {}, .hit = fitting, .callable = {}}
+		);
+		EXPECT_SUCCESS(layout_result);
+		CHECK_EQ(layout_result->hit.stride, 64);
+	}
+}
@@ -13,4 +13,14 @@ target("vulkan.util")
 		"vulkan.interface",
 		"vulkan.numeric",
 		{public = true}
-	)
\ No newline at end of file
+	)
+target("vulkan.util.test")
+	set_kind("binary")
+	set_default(false)
+
+	add_packages("doctest")
+	add_deps("vulkan.util", "vulkan.test-driver")
+
+	for _, testfile in ipairs(os.files("test/*.cpp")) do
+		add_tests(path.basename(testfile), {files = testfile})
+	end
@@ -4,6 +4,25 @@ set_project("Vulkan RT")
 -- Compile modes
 add_rules("mode.debug", "mode.release", "mode.releasedbg", "mode.profile")
 
+-- Options
+option("tracy")
+	set_default(false)
+	set_showmenu(true)
+	set_description("Enable the Tracy profiler integration, best combined with the profile mode")
+option_end()
+
+option("http")
+	set_default(false)
+	set_showmenu(true)
+	set_description("Load glTF models and their buffers from HTTP URLs with libcurl")
+option_end()
+
+option("io_uring")
+	set_default(true)
+	set_showmenu(true)
+	set_description("Back asynchronous file reads with io_uring on Linux, instead of blocking I/O threads")
+option_end()
+
 -- Compile policies
 set_policy("build.warning", true)
 set_policy("build.intermediate_directory", false)
@@ -43,6 +62,7 @@ add_requires(
 	-- Utilities
 	"gzip-hpp v0.1.0",
 	"doctest 2.4.12",
+	"nanobench v4.3.11",
 	"argparse v3.2",
 	"mio 2023.3.3",
 	"libassert[magic_enum=n] v2.2.1",
@@ -65,12 +85,29 @@ add_requireconfs("**libsdl3", {version = "3.4.2", override = true, system = fals
 
 add_requires("libcoro-alt v0.16.0", {alias = "libcoro"})
 
+if has_config("tracy") then
+	add_requires("tracy v0.11.1")
+end
+
+if is_plat("linux") and has_config("io_uring") then
+	add_requires("liburing")
+end
+
+if has_config("http") then
+	add_requires("libcurl")
+end
+
 -- Global defines
 add_defines(
 	"GLM_FORCE_DEPTH_ZERO_TO_ONE", 
 	"GLM_ENABLE_EXPERIMENTAL"
 )
 
+-- Debug labels and object names for frame captures, see "vulkan/util/debug-utils.hpp"
+if not is_mode("release") then
+	add_defines("VULKAN_DEBUG_UTILS")
+end
+
 -- Vulkan specific
 add_defines(
 	"VK_NO_PROTOTYPES",
@@ -86,6 +123,9 @@ add_defines(
 -- Rules
 includes("rule")
 
+-- Plugins
+includes("plugin")
+
 -- Targets
 includes("shader")
 includes("lib")